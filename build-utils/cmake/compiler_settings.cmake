@@ -34,11 +34,37 @@ if(ozz_build_cpp11)
   set(CMAKE_CXX_STANDARD_REQUIRED ON)
 endif()
 
+# Profiling zones
+if(ozz_build_profile)
+  set_property(DIRECTORY APPEND PROPERTY COMPILE_DEFINITIONS OZZ_BUILD_PROFILE)
+endif()
+
+# Maximum logging level compiled in
+if(ozz_build_log_level STREQUAL "silent")
+  set_property(DIRECTORY APPEND PROPERTY COMPILE_DEFINITIONS OZZ_LOG_MAX_LEVEL=0)
+elseif(ozz_build_log_level STREQUAL "standard")
+  set_property(DIRECTORY APPEND PROPERTY COMPILE_DEFINITIONS OZZ_LOG_MAX_LEVEL=1)
+elseif(NOT ozz_build_log_level STREQUAL "verbose")
+  message(FATAL_ERROR "Invalid ozz_build_log_level: ${ozz_build_log_level}")
+endif()
+
 # Simd math force ref
 if(ozz_build_simd_ref)
   set_property(DIRECTORY APPEND PROPERTY COMPILE_DEFINITIONS OZZ_BUILD_SIMD_REF)
 endif()
 
+# Simd math deterministic mode. Compiler is also prevented from contracting
+# floating point operations (aka fusing multiply-adds), which would break
+# determinism.
+if(ozz_build_simd_deterministic)
+  set_property(DIRECTORY APPEND PROPERTY COMPILE_DEFINITIONS OZZ_BUILD_SIMD_DETERMINISTIC)
+  if(MSVC)
+    set_property(DIRECTORY APPEND PROPERTY COMPILE_OPTIONS "/fp:precise")
+  else()
+    set_property(DIRECTORY APPEND PROPERTY COMPILE_OPTIONS "-ffp-contract=off")
+  endif()
+endif()
+
 #--------------------------------------
 # Modify default MSVC compilation flags
 if(MSVC)
@@ -103,9 +129,10 @@ else()
   if(EMSCRIPTEN)
     SET(CMAKE_EXECUTABLE_SUFFIX ".html")
 
-    #if(NOT ozz_build_simd_ref)
-    #  set_property(DIRECTORY APPEND PROPERTY COMPILE_OPTIONS "-msse2")
-    #endif()
+    # Enables WebAssembly SIMD128 instructions, used by simd math library.
+    if(NOT ozz_build_simd_ref)
+      set_property(DIRECTORY APPEND PROPERTY COMPILE_OPTIONS "-msimd128")
+    endif()
   endif()
 
 endif()
@@ -28,6 +28,7 @@
 #ifndef OZZ_OZZ_ANIMATION_OFFLINE_ADDITIVE_ANIMATION_BUILDER_H_
 #define OZZ_OZZ_ANIMATION_OFFLINE_ADDITIVE_ANIMATION_BUILDER_H_
 
+#include "ozz/base/containers/vector.h"
 #include "ozz/base/platform.h"
 
 namespace ozz {
@@ -68,6 +69,28 @@ class AdditiveAnimationBuilder {
   bool operator()(const RawAnimation& _input,
                   const Range<const math::Transform>& _reference_pose,
                   RawAnimation* _output) const;
+
+  // Builds a sparse version of _additive delta animation (usually built with
+  // one of the functions above), which only stores joints whose delta isn't
+  // identity, as most joints of typical layered additives (breathing,
+  // recoil...) aren't affected. Joints are kept per group of 4 (aka per SoA
+  // joint), which is the granularity of sampling and blending jobs. _sparse
+  // receives the 4 tracks of every SoA joint with a non identity track,
+  // padded with empty tracks if needed, and _soa_joints the index of every
+  // SoA joint that was kept, in increasing order.
+  // _sparse is a regular animation that can be built with AnimationBuilder,
+  // whose sampled output is used along with _soa_joints as
+  // BlendingJob::Layer transform and transform_indices of an additive layer,
+  // so that identity joints are neither sampled nor added.
+  // Returns false if _additive is invalid, or if any output is NULL.
+  bool BuildSparse(const RawAnimation& _additive, RawAnimation* _sparse,
+                   ozz::Vector<int>::Std* _soa_joints) const;
+
+  // Tolerance below which a delta is considered as identity by BuildSparse().
+  // It's a distance for translations and scales, and an angle in radians for
+  // rotations.
+  // Default value is 1e-5.
+  float identity_tolerance;
 };
 }  // namespace offline
 }  // namespace animation
@@ -29,27 +29,198 @@
 #define OZZ_OZZ_ANIMATION_OFFLINE_ANIMATION_BUILDER_H_
 
 namespace ozz {
+namespace memory {
+class Allocator;
+}  // namespace memory
 namespace animation {
 
-// Forward declares the runtime animation type.
+// Forward declares the runtime animation and skeleton types.
 class Animation;
+class Skeleton;
 
 namespace offline {
 
 // Forward declares the offline animation type.
 struct RawAnimation;
 
+namespace internal {
+// Forward declares AnimationBuilder scratch buffers, which are private to the
+// builder implementation.
+struct AnimationBuilderBuffers;
+
+// Forward declares the key times storage of an animation being built.
+struct AnimationKeyTimes;
+}  // namespace internal
+
+// Keeps AnimationBuilder scratch buffers alive across successive builds, so
+// that building a batch of animations doesn't re-allocate key sorting buffers
+// for every animation. Buffers grow to fit the biggest animation built with
+// the context, and are released when the context is destroyed.
+// A context can't be used by concurrent builds.
+class AnimationBuilderContext {
+ public:
+  AnimationBuilderContext();
+  ~AnimationBuilderContext();
+
+ private:
+  // Disables copy and assignment.
+  AnimationBuilderContext(const AnimationBuilderContext&);
+  void operator=(const AnimationBuilderContext&);
+
+  friend class AnimationBuilder;
+  internal::AnimationBuilderBuffers* buffers_;
+};
+
 // Defines the class responsible of building runtime animation instances from
 // offline raw animations.
 // No optimization at all is performed on the raw animation.
 class AnimationBuilder {
  public:
+  // Initializes the builder with default parameters.
+  AnimationBuilder();
+
   // Creates an Animation based on _raw_animation and *this builder parameters.
   // Returns a valid Animation on success
   // The returned animation will then need to be deleted using the default
   // allocator Delete() function.
   // See RawAnimation::Validate() for more details about failure reasons.
+  // Building also fails if bounds are requested without a skeleton, or if the
+  // skeleton number of joints doesn't match _raw_animation number of tracks,
+  // see bounds_interval and bounds_skeleton, or if precision lods settings
+  // are invalid, see precision_lods, or if quantization tolerances are
+  // negative. Key times that don't fit 16 bits frame indices are stored as
+  // floats (see Animation::num_frames()), so building only fails if two keys
+  // of a track are too close to be distinguished as float time ratios.
   Animation* operator()(const RawAnimation& _raw_animation) const;
+
+  // Creates an Animation like the function above, but allocates the animation
+  // object and its data from _allocator (see Animation::allocator()), like a
+  // dedicated arena. The returned animation will then need to be deleted
+  // using _allocator Delete() function.
+  Animation* operator()(const RawAnimation& _raw_animation,
+                        memory::Allocator* _allocator) const;
+
+  // Builds _raw_animation into an existing _animation, replacing its content.
+  // _animation data buffer is reused if it's big enough, otherwise it's
+  // reallocated from _animation allocator. Along with a context (see
+  // AnimationBuilderContext), this allows to build a batch of animations
+  // without any allocation once buffers have grown.
+  // Returns false and leaves _animation unchanged if building fails, for the
+  // same reasons as the functions above.
+  bool operator()(const RawAnimation& _raw_animation,
+                  Animation* _animation) const;
+
+  // Interval of time (in seconds) between two consecutive animation seek
+  // points. Seek points allow the SamplingJob to re-seed its cache at any time
+  // in O(number of tracks), instead of scanning all keyframes from the
+  // beginning of the animation. This is useful when an animation is played
+  // backward or scrubbed. Every seek point costs 4 + 4 * 3 * 2 * num_tracks
+  // bytes though.
+  // Default value is 0, meaning that no seek point is built.
+  float seek_interval;
+
+  // Builds a spline animation, whose keys are interpolated with cubic Hermite
+  // splines instead of linearly. Key tangents are computed from neighbor keys
+  // slopes, and cost 6 bytes per translation and scale key, 8 bytes per
+  // rotation key. Smooth motions require less keys to be represented though,
+  // see AnimationOptimizer::spline. A spline animation can only be sampled with
+  // a SamplingCache in spline mode.
+  // Default value is false.
+  bool spline;
+
+  // Builds a sparse animation, which only stores the soa joints (groups of 4
+  // joints) with at least a keyed track. Partial clips (face, hands, upper
+  // body...) leave the tracks of the joints they don't animate empty, so their
+  // memory and sampling cost scale with animated joints rather than with the
+  // skeleton size. The indices of the stored soa joints are recorded in the
+  // animation, see Animation::soa_joints(). Empty tracks of a stored soa joint
+  // are sampled as identity, like for any animation. Sparse animations can't
+  // have bounds.
+  // Default value is false.
+  bool sparse;
+
+  // Number of coarser precision levels of detail to build, in range [0, 254].
+  // Every key of a track is tagged with the coarsest precision lod that still
+  // samples it (see Animation::translation_key_lods()), from the error of
+  // removing it: keys are removed greedily in increasing error order, the error
+  // being the maximum distance between the original keys and the
+  // interpolation of the remaining ones. Precision lod l (from 1) skips the
+  // keys whose removal error is lower than the lod tolerance, which is doubled
+  // every lod. SamplingJob::precision_lod then allows to sample distant
+  // characters with less keys. Every key costs 5 more bytes. Precision lods
+  // can't be combined with spline animations.
+  // Default value is 0, meaning that no precision lod is built.
+  int precision_lods;
+
+  // Tolerances of precision lod 1, doubled for every coarser lod. Translation
+  // and scale tolerances are distances (in meters for translations), rotation
+  // tolerance is an angle in radians.
+  // Default values are 1mm, 1mrad and 0.001.
+  float precision_translation_tolerance;
+  float precision_rotation_tolerance;
+  float precision_scale_tolerance;
+
+  // Maximum quantization error of translation (in meters) and scale key
+  // values. Every component of every track is quantized with the smallest
+  // number of bits, up to 16, whose quantization step over the range of values
+  // of the track is lower than twice the tolerance. Values are then bit packed
+  // (see Animation::translation_values()), so tracks that barely move take
+  // a few bits per key instead of 48. Components that don't vary take no bit,
+  // whatever the tolerance. Rotations are always quantized to 16 bits.
+  // Default values are 0, meaning that varying components are quantized to 16
+  // bits.
+  float quantization_translation_tolerance;
+  float quantization_scale_tolerance;
+
+  // Interval of time (in seconds) covered by each precomputed bounds (see
+  // Animation::bounds()). Bounds contain model-space positions of skeleton
+  // joints, which allows to cull an animated object without sampling its
+  // animation. They are computed by sampling the built animation at all
+  // its keyframes times and at least at 60Hz in between, so they include
+  // joints origins only: skinned meshes still need to inflate them by their
+  // extent around joints. Every bounds costs 24 bytes.
+  // Default value is 0, meaning that no bounds are built. bounds_skeleton must
+  // be set otherwise.
+  float bounds_interval;
+
+  // The skeleton the animation is built for, used to compute bounds in model
+  // space. Its joints must match animation tracks. If specified, even without
+  // bounds, its fingerprint is also recorded in the animation, so that it can
+  // be verified at load time, see Animation::skeleton_fingerprint().
+  // Default value is NULL.
+  const Skeleton* bounds_skeleton;
+
+  // Number of threads used to build keyframes. Translation, rotation and scale
+  // channels are built concurrently, and their keys are sorted with a parallel
+  // merge sort, so output is the same whatever the number of threads. Small
+  // animations are always built on the calling thread. 0 selects hardware
+  // concurrency. Threads are only available with C++11 and above, when the
+  // library is built with threads support, otherwise building is always single
+  // threaded.
+  // Default value is 0.
+  int num_threads;
+
+  // Optional context whose scratch buffers are reused across builds, see
+  // AnimationBuilderContext. Buffers are allocated for every build otherwise.
+  // Default value is NULL.
+  AnimationBuilderContext* context;
+
+ private:
+  // Tests _raw_animation validity, and that *this builder parameters match.
+  // Outputs how key times are stored on success, see Animation::num_frames().
+  bool Validate(const RawAnimation& _raw_animation,
+                internal::AnimationKeyTimes* _times) const;
+
+  // Fills _animation from a validated _raw_animation.
+  void Build(const RawAnimation& _raw_animation,
+             const internal::AnimationKeyTimes& _times,
+             Animation* _animation) const;
+
+  // Fills _animation with all _raw_animation tracks. _soa_joints are the
+  // skeleton indices of the soa tracks of a sparse animation, or NULL.
+  void BuildTracks(const RawAnimation& _raw_animation, const int* _soa_joints,
+                   const internal::AnimationKeyTimes& _times,
+                   Animation* _animation) const;
 };
 }  // namespace offline
 }  // namespace animation
@@ -0,0 +1,81 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#ifndef OZZ_OZZ_ANIMATION_OFFLINE_ANIMATION_LIBRARY_BUILDER_H_
+#define OZZ_OZZ_ANIMATION_OFFLINE_ANIMATION_LIBRARY_BUILDER_H_
+
+#include "ozz/base/platform.h"
+
+namespace ozz {
+namespace animation {
+
+// Forward declares the runtime animation library type.
+class AnimationLibrary;
+
+namespace offline {
+
+// Forward declares the offline animation type.
+struct RawAnimation;
+
+// Defines the class responsible of building runtime animation libraries from a
+// set of offline raw animations. Every raw animation becomes a clip of the
+// library, and every translation, rotation and scale track of every clip is
+// compared to the channels already in the library: a track whose values never
+// differ from an existing channel by more than the tolerance references it
+// instead of storing its own keys. Tracks are compared at all the keyframes of
+// both tracks, which bounds the error of linearly interpolated values.
+// Every track is compared to all the channels of the library, so building
+// cost is quadratic in the number of distinct channels.
+class AnimationLibraryBuilder {
+ public:
+  // Initializes the builder with default tolerances.
+  AnimationLibraryBuilder();
+
+  // Creates an AnimationLibrary based on _clips and *this builder parameters.
+  // Returns a valid AnimationLibrary on success, or NULL if any raw animation
+  // is invalid (see RawAnimation::Validate()) or if a tolerance is negative.
+  // The returned library will then need to be deleted using the default
+  // allocator Delete() function.
+  AnimationLibrary* operator()(const Range<const RawAnimation>& _clips) const;
+
+  // Translation sharing tolerance, defined as the distance between two
+  // translation values in meters. Default value is 1e-3 (1 mm).
+  float translation_tolerance;
+
+  // Rotation sharing tolerance, ie: the angle between two rotation values in
+  // radian. Default value is 0.1 degree.
+  float rotation_tolerance;
+
+  // Scale sharing tolerance, ie: the norm of the difference of two scales.
+  // Default value is 1e-3 (0.1%).
+  float scale_tolerance;
+};
+}  // namespace offline
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_OFFLINE_ANIMATION_LIBRARY_BUILDER_H_
@@ -28,6 +28,8 @@
 #ifndef OZZ_OZZ_ANIMATION_OFFLINE_ANIMATION_OPTIMIZER_H_
 #define OZZ_OZZ_ANIMATION_OFFLINE_ANIMATION_OPTIMIZER_H_
 
+#include "ozz/base/containers/map.h"
+
 namespace ozz {
 namespace animation {
 
@@ -61,6 +63,8 @@ class AnimationOptimizer {
   // *_output must be a valid RawAnimation instance.
   // Returns false on failure and resets _output to an empty animation.
   // See RawAnimation::Validate() for more details about failure reasons.
+  // Optimization also fails if joints_setting_override references a joint
+  // that isn't in _skeleton.
   bool operator()(const RawAnimation& _input, const Skeleton& _skeleton,
                   RawAnimation* _output) const;
 
@@ -79,6 +83,132 @@ class AnimationOptimizer {
   // (distance) that an optimization is allowed to generate on a whole joint
   // hierarchy.
   float hierarchical_tolerance;
+
+  // Optimizes for spline animations (see AnimationBuilder::spline), meaning
+  // that keys are removed if they can be interpolated with cubic Hermite
+  // splines, instead of linearly. This allows to remove more keys from smooth
+  // motions. Key tangents are estimated from neighbor keys, the way the
+  // AnimationBuilder computes them. The output animation must then be built
+  // as a spline animation.
+  // Default value is false.
+  bool spline;
+
+  // Size of the sliding window of keys that can be replaced by a single
+  // interpolation. Each key is then tested against at most window_size keys,
+  // bounding optimization cost to O(n * window_size), instead of O(n^2) for
+  // long interpolable sequences of keys (like static or linear motions in long
+  // mocap takes). A small window reduces optimization ratio. 0 means no limit.
+  // Default value is 0.
+  int window_size;
+
+  // Number of threads used to optimize joint tracks. Translation, rotation and
+  // scale channels of every track are optimized independently, so output is
+  // the same whatever the number of threads. 0 selects hardware concurrency.
+  // Threads are only available with C++11 and above, when the library is built
+  // with threads support, otherwise optimization is always single threaded.
+  // Default value is 0.
+  int num_threads;
+
+  // Enables model-space error driven optimization. Instead of estimating error
+  // propagation from joint hierarchy lengths, the optimizer samples the
+  // animation at every key time and measures the actual model-space error on
+  // joint positions, and on virtual skinning points (see skinning_distance).
+  // Keys are greedily removed, joint after joint, as long as the error of
+  // every joint of the affected hierarchy stays below model_space_tolerance
+  // compared to the input animation. Local-space and hierarchical tolerances
+  // are ignored in this mode. Error is measured with linear interpolation, so
+  // spline is ignored too. Joints are optimized in sequence, as each key
+  // removal accounts for the error already introduced by the previous ones,
+  // so num_threads is also ignored.
+  // Default value is false.
+  bool model_space;
+
+  // Model-space optimization tolerance, ie: the maximum distance in meters
+  // between input and optimized joints and skinning points model-space
+  // positions.
+  float model_space_tolerance;
+
+  // Distance in meters from a joint of its virtual skinning points, along each
+  // of the joint axes. It allows to measure the error on vertices skinned to a
+  // joint, that the joint position doesn't reveal (like a rotation of a leaf
+  // joint). 0 only measures joints positions.
+  float skinning_distance;
+
+  // Per joint optimization tolerances, overriding global ones for a joint.
+  struct JointSetting {
+    // Initializes the setting with optimizer default tolerances.
+    JointSetting();
+
+    // See AnimationOptimizer::translation_tolerance.
+    float translation_tolerance;
+
+    // See AnimationOptimizer::rotation_tolerance.
+    float rotation_tolerance;
+
+    // See AnimationOptimizer::scale_tolerance.
+    float scale_tolerance;
+
+    // See AnimationOptimizer::hierarchical_tolerance. As the error of a joint
+    // optimization is propagated to its whole child hierarchy, a joint is
+    // optimized with the lowest hierarchical tolerance of its hierarchy.
+    float hierarchical_tolerance;
+
+    // See AnimationOptimizer::model_space_tolerance. The error measured on a
+    // joint and its skinning points must be within its own tolerance, whatever
+    // the joint whose keys are removed.
+    float model_space_tolerance;
+  };
+
+  // Per joint tolerances, indexed by skeleton joint index, overriding global
+  // tolerances for these joints. This allows for example to use tight
+  // tolerances for face and hand joints, while helper joints use loose ones.
+  // Joints that aren't in the map use global tolerances.
+  typedef ozz::Map<int, JointSetting>::Std JointsSetting;
+  JointsSetting joints_setting_override;
+};
+
+// Runs an AnimationOptimizer in time slices, optimizing a bounded number of
+// channels (the translations, rotations or scales of a track) per Resume()
+// call. This allows to interleave optimization of a long animation with other
+// work, like keeping an editor responsive. Once complete, output is the same
+// as AnimationOptimizer::operator() output.
+// Channels are optimized sequentially by the calling thread of Resume(),
+// whatever AnimationOptimizer::num_threads.
+class ResumableAnimationOptimizer {
+ public:
+  ResumableAnimationOptimizer();
+  ~ResumableAnimationOptimizer();
+
+  // Starts optimizing _input with _optimizer parameters, which are copied.
+  // Any previous optimization is abandoned. _input, _skeleton and _output must
+  // stay alive and unchanged until optimization is done. In model-space mode
+  // (see AnimationOptimizer::model_space), input animation is sampled by
+  // Start() itself, which isn't bounded.
+  // Returns false and resets _output to an empty animation on failure, for the
+  // same reasons as AnimationOptimizer::operator().
+  bool Start(const AnimationOptimizer& _optimizer, const RawAnimation& _input,
+             const Skeleton& _skeleton, RawAnimation* _output);
+
+  // Optimizes at most _max_channels channels of the started optimization.
+  // Returns false if no optimization is in progress, if _max_channels is lower
+  // or equal to 0, or if output animation isn't valid once complete.
+  bool Resume(int _max_channels);
+
+  // Tells if there's no optimization in progress, either because it's
+  // complete, or because none was successfully started.
+  bool done() const;
+
+  // Gets the number of channels that remain to be optimized.
+  int num_remaining_channels() const;
+
+ private:
+  // Disables copy and assignment.
+  ResumableAnimationOptimizer(const ResumableAnimationOptimizer&);
+  void operator=(const ResumableAnimationOptimizer&);
+
+  // Optimization state, private to the implementation. NULL when done.
+  struct Impl;
+  Impl* impl_;
 };
 }  // namespace offline
 }  // namespace animation
@@ -0,0 +1,127 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#ifndef OZZ_OZZ_ANIMATION_OFFLINE_ANIMATION_RECORDER_H_
+#define OZZ_OZZ_ANIMATION_OFFLINE_ANIMATION_RECORDER_H_
+
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/platform.h"
+
+namespace ozz {
+namespace math {
+struct SoaTransform;
+}  // namespace math
+namespace animation {
+
+// Forward declares the runtime animation type.
+class Animation;
+
+namespace offline {
+
+// Records live local-space poses (like SamplingJob or BlendingJob outputs)
+// into a runtime animation, for killcams or gameplay capture.
+// Keys are reduced while frames are recorded: a frame value is dropped as long
+// as interpolating the last retained key and the newest frame reproduces all
+// the frames in between within tolerances. Only retained keys, and the frames
+// since the last retained key (at most max_key_interval per track), are kept
+// in memory. Finalizing then only builds the retained keys, instead of
+// optimizing a whole raw animation.
+// Once buffers have grown, recording doesn't allocate memory.
+class AnimationRecorder {
+ public:
+  // Initializes the recorder with default tolerances, matching
+  // AnimationOptimizer ones.
+  AnimationRecorder();
+
+  // Starts a new recording of _num_tracks tracks, discarding the previous
+  // one. Returns false if _num_tracks isn't in range [1, Skeleton::kMaxJoints].
+  bool Begin(int _num_tracks);
+
+  // Records _pose at _time (in seconds). The first recorded frame defines the
+  // beginning of the animation, and times of successive frames must be
+  // strictly increasing.
+  // Returns false and ignores the frame if no recording was begun, if _pose is
+  // smaller than the number of soa tracks, or if _time isn't increasing.
+  bool Record(const Range<const math::SoaTransform>& _pose, float _time);
+
+  // Builds a runtime animation from the recorded keys, named _name. The
+  // recording can continue afterward.
+  // Returns NULL if no frame was recorded. The returned animation will then
+  // need to be deleted using the default allocator Delete() function.
+  Animation* Finalize(const char* _name = "") const;
+
+  // Gets the number of tracks of the current recording.
+  int num_tracks() const { return static_cast<int>(raw_.tracks.size()); }
+
+  // Gets the number of recorded frames.
+  int num_frames() const { return num_frames_; }
+
+  // Gets the number of keys retained so far, for all tracks and channels.
+  int num_keys() const;
+
+  // Translation tolerance, the distance between a frame and its interpolated
+  // value, in meters. See AnimationOptimizer::translation_tolerance.
+  float translation_tolerance;
+
+  // Rotation tolerance, the angle between a frame and its interpolated value,
+  // in radian. See AnimationOptimizer::rotation_tolerance.
+  float rotation_tolerance;
+
+  // Scale tolerance, the norm of the difference between a frame and its
+  // interpolated value. See AnimationOptimizer::scale_tolerance.
+  float scale_tolerance;
+
+  // Maximum number of frames between 2 retained keys. This bounds memory and
+  // the cost of recording a frame, which is proportional to this interval.
+  // Default value is 16.
+  int max_key_interval;
+
+ private:
+  // Frames recorded since the last retained key of every channel of a track.
+  struct TrackFrames {
+    RawAnimation::JointTrack::Translations translations;
+    RawAnimation::JointTrack::Rotations rotations;
+    RawAnimation::JointTrack::Scales scales;
+  };
+
+  // Retained keys, with times relative to the first frame.
+  RawAnimation raw_;
+
+  // Frames that weren't retained yet, per track.
+  ozz::Vector<TrackFrames>::Std frames_;
+
+  // Time of the first and last recorded frames.
+  float begin_time_;
+  float last_time_;
+  int num_frames_;
+};
+}  // namespace offline
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_OFFLINE_ANIMATION_RECORDER_H_
@@ -0,0 +1,89 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_ANIMATION_OFFLINE_ANIMATION_RETARGETER_H_
+#define OZZ_OZZ_ANIMATION_OFFLINE_ANIMATION_RETARGETER_H_
+
+#include "ozz/base/platform.h"
+
+namespace ozz {
+namespace animation {
+
+// Forward declares the runtime skeleton type.
+class Skeleton;
+
+namespace offline {
+
+// Forward declare offline animation type.
+struct RawAnimation;
+
+// Defines the class responsible for retargeting an offline raw animation,
+// authored for a source skeleton, to a target skeleton whose proportions and
+// bind pose can differ.
+// Target joints are mapped to source joints with a precomputed joint map, like
+// the one built by ozz::animation::BuildJointRemap(_source, _target). Every
+// mapped target joint receives source joint motion relative to the source bind
+// pose, applied on top of its own bind pose:
+// - rotations are target_bind * conjugate(source_bind) * source,
+// - translations are target_bind + ratio * (source - source_bind), where ratio
+// scales motion by the proportion between target and source bind translations
+// (see scale_translations),
+// - scales are target_bind * source / source_bind.
+// These are linear transformations of key values, so they're applied to every
+// source key rather than to resampled frames: output has the same keys as the
+// input, and sampling it matches retargeting the sampled input exactly.
+// Unmapped target joints are set to their bind pose.
+class AnimationRetargeter {
+ public:
+  // Initializes the retargeter with default parameters.
+  AnimationRetargeter();
+
+  // Retargets _input animation, whose tracks match _source skeleton joints, to
+  // _output animation, whose tracks match _target skeleton joints.
+  // _joint_map must contain an entry per _target joint, which is the index of
+  // the _source joint it is mapped to, or -1 if it's unmapped.
+  // Returns true on success. Returns false and resets _output to an empty
+  // animation on failure, which happens if _input is invalid (see
+  // RawAnimation::Validate()), if its number of tracks doesn't match _source,
+  // or if _joint_map is too small or contains invalid source joint indices.
+  bool operator()(const RawAnimation& _input, const Skeleton& _source,
+                  const Skeleton& _target, const Range<const int>& _joint_map,
+                  RawAnimation* _output) const;
+
+  // Scales translations motion of each joint by the ratio between target and
+  // source bind translation lengths, so that a longer leg also strides
+  // further. Joints whose source bind translation length is nearly 0 (like a
+  // root at the origin) use the ratio between the total bind translation
+  // lengths of all mapped target and source joints.
+  // Translations motion is copied unchanged otherwise.
+  // Default value is true.
+  bool scale_translations;
+};
+}  // namespace offline
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_OFFLINE_ANIMATION_RETARGETER_H_
@@ -0,0 +1,329 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#ifndef OZZ_OZZ_ANIMATION_OFFLINE_ASYNC_PIPELINE_H_
+#define OZZ_OZZ_ANIMATION_OFFLINE_ASYNC_PIPELINE_H_
+
+// Awaitable wrappers of offline loading, optimization and building stages.
+// This header is optional and header-only: it requires C++20 coroutines, and
+// is empty otherwise. OZZ_ASYNC_PIPELINE is defined when it's available.
+#if defined(__cpp_impl_coroutine) && defined(__has_include)
+#if __has_include(<coroutine>)
+#define OZZ_ASYNC_PIPELINE
+#endif  // __has_include(<coroutine>)
+#endif  // __cpp_impl_coroutine
+
+#ifdef OZZ_ASYNC_PIPELINE
+
+#include <atomic>
+#include <condition_variable>
+#include <coroutine>
+#include <exception>
+#include <mutex>
+
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/animation_optimizer.h"
+#include "ozz/base/io/archive.h"
+#include "ozz/base/io/stream.h"
+#include "ozz/base/platform.h"
+
+namespace ozz {
+namespace animation {
+namespace offline {
+
+// Defines the interface used by async stages to resume coroutines on the
+// application's threads. ozz doesn't own any thread: implementations are
+// expected to forward coroutines to the application's own thread pool, I/O
+// threads or job system. Using different executors for I/O and CPU bound
+// stages allows them to overlap across assets.
+class AsyncExecutor {
+ public:
+  // Default virtual destructor.
+  virtual ~AsyncExecutor() {}
+
+  // Resumes _coroutine, from any thread. Post can resume _coroutine before
+  // returning, but this prevents stages from overlapping.
+  virtual void Post(std::coroutine_handle<> _coroutine) = 0;
+};
+
+// Awaitable that resumes the awaiting coroutine on _executor. The coroutine
+// isn't suspended if _executor is NULL, so it continues on the current thread.
+class ScheduleOn {
+ public:
+  explicit ScheduleOn(AsyncExecutor* _executor) : executor_(_executor) {}
+
+  bool await_ready() const noexcept { return executor_ == NULL; }
+  void await_suspend(std::coroutine_handle<> _coroutine) {
+    executor_->Post(_coroutine);
+  }
+  void await_resume() const noexcept {}
+
+ private:
+  AsyncExecutor* executor_;
+};
+
+namespace internal {
+// Stores coroutine result, specialized below for void coroutines.
+template <typename _Ty>
+struct AsyncResult {
+  AsyncResult() : value() {}
+  void return_value(const _Ty& _value) { value = _value; }
+  _Ty get() const { return value; }
+  _Ty value;
+};
+
+template <>
+struct AsyncResult<void> {
+  void return_void() {}
+  void get() const {}
+};
+}  // namespace internal
+
+// Lazy coroutine type returned by async stages. A task doesn't start until
+// it's awaited, and resumes its awaiting coroutine when it completes, from
+// the thread that completed it. Use SyncWait() to run a task from a thread
+// which isn't a coroutine, and WhenAll() to await a batch of tasks.
+// As for any coroutine, arguments passed by reference or pointer must outlive
+// the task.
+template <typename _Ty = void>
+class AsyncTask {
+ public:
+  struct promise_type : internal::AsyncResult<_Ty> {
+    AsyncTask get_return_object() {
+      return AsyncTask(
+          std::coroutine_handle<promise_type>::from_promise(*this));
+    }
+    std::suspend_always initial_suspend() const noexcept { return {}; }
+
+    // Transfers execution to the awaiting coroutine, if any.
+    struct FinalAwaiter {
+      bool await_ready() const noexcept { return false; }
+      std::coroutine_handle<> await_suspend(
+          std::coroutine_handle<promise_type> _coroutine) const noexcept {
+        const std::coroutine_handle<> continuation =
+            _coroutine.promise().continuation;
+        return continuation ? continuation : std::noop_coroutine();
+      }
+      void await_resume() const noexcept {}
+    };
+    FinalAwaiter final_suspend() const noexcept { return {}; }
+
+    // ozz doesn't use exceptions.
+    void unhandled_exception() const { std::terminate(); }
+
+    std::coroutine_handle<> continuation;
+  };
+
+  AsyncTask() : coroutine_() {}
+  AsyncTask(AsyncTask&& _other) noexcept : coroutine_(_other.coroutine_) {
+    _other.coroutine_ = nullptr;
+  }
+  AsyncTask& operator=(AsyncTask&& _other) noexcept {
+    if (this != &_other) {
+      if (coroutine_) {
+        coroutine_.destroy();
+      }
+      coroutine_ = _other.coroutine_;
+      _other.coroutine_ = nullptr;
+    }
+    return *this;
+  }
+  ~AsyncTask() {
+    if (coroutine_) {
+      coroutine_.destroy();
+    }
+  }
+
+  // Tests if the task is bound to a coroutine.
+  bool valid() const { return static_cast<bool>(coroutine_); }
+
+  // Tests if the task has completed.
+  bool done() const { return coroutine_ && coroutine_.done(); }
+
+  // Gets the result of a completed task.
+  _Ty result() const {
+    assert(done());
+    return coroutine_.promise().get();
+  }
+
+  // Awaiter interface. Awaiting a completed task returns its result
+  // immediately.
+  bool await_ready() const noexcept { return done(); }
+  std::coroutine_handle<> await_suspend(
+      std::coroutine_handle<> _continuation) const noexcept {
+    coroutine_.promise().continuation = _continuation;
+    return coroutine_;
+  }
+  _Ty await_resume() const { return result(); }
+
+ private:
+  explicit AsyncTask(std::coroutine_handle<promise_type> _coroutine)
+      : coroutine_(_coroutine) {}
+
+  // Disables copy and assignment.
+  AsyncTask(const AsyncTask&);
+  void operator=(const AsyncTask&);
+
+  std::coroutine_handle<promise_type> coroutine_;
+};
+
+namespace internal {
+// Eager coroutine type, whose frame is destroyed when it completes. Used to
+// start tasks from non-coroutine code.
+struct DetachedTask {
+  struct promise_type {
+    DetachedTask get_return_object() const { return DetachedTask(); }
+    std::suspend_never initial_suspend() const noexcept { return {}; }
+    std::suspend_never final_suspend() const noexcept { return {}; }
+    void return_void() const {}
+    void unhandled_exception() const { std::terminate(); }
+  };
+};
+
+// Blocks the waiting thread until Set() is called.
+class AsyncEvent {
+ public:
+  AsyncEvent() : set_(false) {}
+  void Set() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    set_ = true;
+    condition_.notify_all();
+  }
+  void Wait() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    condition_.wait(lock, [this] { return set_; });
+  }
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable condition_;
+  bool set_;
+};
+
+template <typename _Ty>
+DetachedTask SignalWhenDone(AsyncTask<_Ty>* _task, AsyncEvent* _event) {
+  co_await *_task;
+  _event->Set();
+}
+
+// Awaits all tasks, and resumes the awaiting coroutine when the last one
+// completes. Counter is initialized to count + 1, so that the awaiting
+// coroutine isn't resumed before all tasks are started.
+template <typename _Ty>
+class WhenAllAwaiter {
+ public:
+  explicit WhenAllAwaiter(const Range<AsyncTask<_Ty> >& _tasks)
+      : tasks_(_tasks), pending_(0) {}
+
+  bool await_ready() const noexcept { return tasks_.count() == 0; }
+  bool await_suspend(std::coroutine_handle<> _continuation) {
+    continuation_ = _continuation;
+    const int count = static_cast<int>(tasks_.count());
+    pending_.store(count + 1, std::memory_order_relaxed);
+    for (int i = 0; i < count; ++i) {
+      Await(&tasks_.begin[i], this);
+    }
+    // Doesn't suspend if all tasks have already completed.
+    return pending_.fetch_sub(1, std::memory_order_acq_rel) != 1;
+  }
+  void await_resume() const noexcept {}
+
+ private:
+  static DetachedTask Await(AsyncTask<_Ty>* _task, WhenAllAwaiter* _awaiter) {
+    co_await *_task;
+    if (_awaiter->pending_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      _awaiter->continuation_.resume();
+    }
+  }
+
+  Range<AsyncTask<_Ty> > tasks_;
+  std::atomic<int> pending_;
+  std::coroutine_handle<> continuation_;
+};
+}  // namespace internal
+
+// Runs _task and blocks the calling thread until it completes, then returns
+// its result. Must not be called from a thread _task depends on to complete.
+template <typename _Ty>
+_Ty SyncWait(AsyncTask<_Ty>& _task) {
+  internal::AsyncEvent event;
+  internal::SignalWhenDone(&_task, &event);
+  event.Wait();
+  return _task.result();
+}
+
+// Starts all _tasks concurrently and completes when they're all completed.
+// Tasks results can then be read with AsyncTask::result().
+template <typename _Ty>
+AsyncTask<> WhenAll(Range<AsyncTask<_Ty> > _tasks) {
+  co_await internal::WhenAllAwaiter<_Ty>(_tasks);
+}
+
+// Loads an object of type _Ty from file _filename, on _executor. _Ty can be
+// any serializable type, like RawAnimation, RawSkeleton, Animation or
+// Skeleton. Completes with false if the file can't be opened or doesn't
+// contain an object of type _Ty.
+template <typename _Ty>
+AsyncTask<bool> AsyncLoad(AsyncExecutor* _executor, const char* _filename,
+                          _Ty* _object) {
+  co_await ScheduleOn(_executor);
+  io::File file(_filename, "rb");
+  if (!file.opened()) {
+    co_return false;
+  }
+  io::IArchive archive(&file);
+  if (!archive.template TestTag<_Ty>()) {
+    co_return false;
+  }
+  archive >> *_object;
+  co_return true;
+}
+
+// Runs _optimizer on _executor, see AnimationOptimizer::operator().
+inline AsyncTask<bool> AsyncOptimize(AsyncExecutor* _executor,
+                                     const AnimationOptimizer& _optimizer,
+                                     const RawAnimation& _input,
+                                     const Skeleton& _skeleton,
+                                     RawAnimation* _output) {
+  co_await ScheduleOn(_executor);
+  co_return _optimizer(_input, _skeleton, _output);
+}
+
+// Runs _builder on _executor, see AnimationBuilder::operator(). Completes with
+// NULL on failure.
+inline AsyncTask<Animation*> AsyncBuild(AsyncExecutor* _executor,
+                                        const AnimationBuilder& _builder,
+                                        const RawAnimation& _input) {
+  co_await ScheduleOn(_executor);
+  co_return _builder(_input);
+}
+}  // namespace offline
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_ASYNC_PIPELINE
+#endif  // OZZ_OZZ_ANIMATION_OFFLINE_ASYNC_PIPELINE_H_
@@ -53,9 +53,12 @@ namespace fbx {
 
 OzzImporter::AnimationNames GetAnimationNames(FbxSceneLoader& _scene_loader);
 
+// Extracts _animation_name joints animation. The animation is sampled at
+// _sampling_rate, or at curves keyframes times if _keyframes is true.
 bool ExtractAnimation(const char* _animation_name,
                       FbxSceneLoader& _scene_loader, const Skeleton& _skeleton,
-                      float _sampling_rate, RawAnimation* _animation);
+                      float _sampling_rate, bool _keyframes,
+                      RawAnimation* _animation);
 
 OzzImporter::NodeProperties GetNodeProperties(FbxSceneLoader& _scene_loader,
                                               const char* _node_name);
@@ -0,0 +1,108 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#ifndef OZZ_OZZ_ANIMATION_OFFLINE_MOTION_DATABASE_BUILDER_H_
+#define OZZ_OZZ_ANIMATION_OFFLINE_MOTION_DATABASE_BUILDER_H_
+
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/maths/vec_float.h"
+#include "ozz/base/platform.h"
+
+namespace ozz {
+namespace animation {
+
+// Forward declares the runtime animation, skeleton and database types.
+class Animation;
+class MotionDatabase;
+class Skeleton;
+
+namespace offline {
+
+// Defines the class responsible of building a MotionDatabase from a set of
+// animation clips. Every clip is sampled at frequency, with the SamplingJob and
+// the LocalToModelJob, and the features of every frame are computed in
+// character space: relative to the root joint projected on the ground plane
+// (y = 0), and oriented by root joint forward axis projected on the ground
+// plane. Features of a frame are, in this order:
+// - model-space positions of joints (x, y, z per joint).
+// - model-space velocities of joints (x, y, z per joint).
+// - future root positions at trajectory_times (x, z per time).
+// - future root forward directions at trajectory_times (x, z per time).
+// The same layout must be used to build runtime queries, before normalizing
+// them with MotionDatabase::Normalize(). Each group of features is normalized
+// by its mean and average standard deviation, and weighted by its weight.
+class MotionDatabaseBuilder {
+ public:
+  // Initializes the builder with default parameters.
+  MotionDatabaseBuilder();
+
+  // Creates a MotionDatabase based on _animations, _skeleton and *this builder
+  // parameters. Clips are stored in _animations order.
+  // Returns a valid MotionDatabase on success, which will then need to be
+  // deleted using the default allocator Delete() function.
+  // Returns NULL on failure, if an animation is NULL or doesn't match
+  // _skeleton number of joints, if a joint index is invalid, or if frequency
+  // isn't strictly positive.
+  MotionDatabase* operator()(const Range<const Animation* const>& _animations,
+                             const Skeleton& _skeleton) const;
+
+  // Gets the number of features of a frame, given *this builder parameters.
+  int num_features() const;
+
+  // Number of frames per second clips are sampled at.
+  // Default value is 30.
+  float frequency;
+
+  // Index of the joint that defines character space.
+  // Default value is 0.
+  int root_joint;
+
+  // Forward axis of the root joint, in root joint local space.
+  // Default value is z axis.
+  math::Float3 root_forward;
+
+  // Joints whose positions and velocities are features.
+  // Default value is empty.
+  ozz::Vector<int>::Std joints;
+
+  // Times in seconds, relative to the current frame, of future trajectory
+  // samples. Trajectory is clamped to the end of the clip.
+  // Default value is {1/3, 2/3, 1}.
+  ozz::Vector<float>::Std trajectory_times;
+
+  // Weights of each feature group.
+  // Default values are 1.
+  float position_weight;
+  float velocity_weight;
+  float trajectory_position_weight;
+  float trajectory_direction_weight;
+};
+}  // namespace offline
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_OFFLINE_MOTION_DATABASE_BUILDER_H_
@@ -0,0 +1,87 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_ANIMATION_OFFLINE_PALETTE_ANIMATION_BUILDER_H_
+#define OZZ_OZZ_ANIMATION_OFFLINE_PALETTE_ANIMATION_BUILDER_H_
+
+#include "ozz/base/platform.h"
+
+namespace ozz {
+namespace math {
+struct Float4x4;
+}  // namespace math
+namespace animation {
+
+// Forward declares the runtime types.
+class Animation;
+class PaletteAnimation;
+class Skeleton;
+
+namespace offline {
+
+// Defines the class responsible of baking runtime animations to palette
+// animations (see PaletteAnimation). The animation is sampled at a fixed
+// frequency, and every frame stores the skinning matrices palette computed
+// from the skeleton model-space matrices, in a GPU texture friendly layout.
+class PaletteAnimationBuilder {
+ public:
+  // Initializes the builder with default parameters.
+  PaletteAnimationBuilder();
+
+  // Creates a PaletteAnimation based on _animation, _skeleton and *this
+  // builder parameters.
+  // Returns a valid PaletteAnimation on success, or NULL if _animation and
+  // _skeleton number of joints don't match, if frequency isn't strictly
+  // positive, or if joint_remaps and inverse_bind_poses are invalid.
+  // The returned animation will then need to be deleted using the default
+  // allocator Delete() function.
+  PaletteAnimation* operator()(const Animation& _animation,
+                               const Skeleton& _skeleton) const;
+
+  // Sampling frequency, in frames per second. The number of frames is rounded
+  // up so that they evenly cover the whole animation duration, from its
+  // beginning to its end.
+  // Default value is 30.
+  float frequency;
+
+  // Inverse bind-pose matrices of the skinned mesh, multiplied with joints
+  // model-space matrices to compute the palette. Palettes store skeleton
+  // model-space matrices if it's empty, one per skeleton joint.
+  // Default value is empty.
+  Range<const math::Float4x4> inverse_bind_poses;
+
+  // Skeleton joint index of every inverse_bind_poses matrix, as a skinned
+  // mesh only uses part of the skeleton. Palettes then match mesh joint
+  // indices, like SkinningJob palette. If it's empty, inverse_bind_poses
+  // matrices match the first skeleton joints.
+  // Default value is empty.
+  Range<const uint16_t> joint_remaps;
+};
+}  // namespace offline
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_OFFLINE_PALETTE_ANIMATION_BUILDER_H_
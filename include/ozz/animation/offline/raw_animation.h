@@ -53,6 +53,7 @@ namespace offline {
 //  1. Animation duration is greater than 0.
 //  2. Keyframes' time are sorted in a strict ascending order.
 //  3. Keyframes' time are all within [0,animation duration] range.
+//  4. Synchronization markers' time follow the same rules as keyframes.
 // Animations that would fail this validation will fail to be converted by the
 // AnimationBuilder.
 struct RawAnimation {
@@ -67,6 +68,7 @@ struct RawAnimation {
   //  1. Animation duration is greater than 0.
   //  2. Keyframes' time are sorted in a strict ascending order.
   //  3. Keyframes' time are all within [0,animation duration] range.
+  //  4. Synchronization markers' time follow the same rules as keyframes.
   bool Validate() const;
 
   // Defines a raw translation key frame.
@@ -111,12 +113,23 @@ struct RawAnimation {
   // Defines a track of key frames for a bone, including translation, rotation
   // and scale.
   struct JointTrack {
+    // Constructs a linearly interpolated track.
+    JointTrack() : step(false) {}
+
     typedef ozz::Vector<TranslationKey>::Std Translations;
     Translations translations;
     typedef ozz::Vector<RotationKey>::Std Rotations;
     Rotations rotations;
     typedef ozz::Vector<ScaleKey>::Std Scales;
     Scales scales;
+
+    // Step interpolation of all track channels: every key value is held until
+    // the next key, instead of being linearly (or spline) interpolated. This
+    // is intended for discrete motions, like snapping props or stop-motion
+    // clips, which would otherwise need duplicated keys. Key values are
+    // output from their key time on, including a key at the end of the
+    // animation.
+    bool step;
   };
 
   // Returns the number of tracks of this animation.
@@ -132,11 +145,17 @@ struct RawAnimation {
 
   // Name of the animation.
   ozz::String::Std name;
+
+  // Times of the synchronization markers of the animation, like foot plants of
+  // a locomotion cycle. Markers allow to synchronize the phase of animations
+  // that are blended together, see SyncSamplingJob. They can be extracted from
+  // a float track with ExtractSyncMarkers().
+  ozz::Vector<float>::Std sync_markers;
 };
 }  // namespace offline
 }  // namespace animation
 namespace io {
-OZZ_IO_TYPE_VERSION(3, animation::offline::RawAnimation)
+OZZ_IO_TYPE_VERSION(6, animation::offline::RawAnimation)
 OZZ_IO_TYPE_TAG("ozz-raw_animation", animation::offline::RawAnimation)
 
 // Should not be called directly but through io::Archive << and >> operators.
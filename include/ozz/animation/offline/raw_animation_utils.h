@@ -29,8 +29,10 @@
 #define OZZ_OZZ_ANIMATION_OFFLINE_RAW_ANIMATION_UTILS_H_
 
 #include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/raw_track.h"
 
 #include "ozz/base/maths/transform.h"
+#include "ozz/base/platform.h"
 
 namespace ozz {
 namespace animation {
@@ -47,6 +49,67 @@ math::Quaternion LerpRotation(const math::Quaternion& _a,
 // Scale interpolation method.
 math::Float3 LerpScale(const math::Float3& _a, const math::Float3& _b,
                        float _alpha);
+
+// Cubic Hermite interpolation methods, matching spline animations sampling
+// (see AnimationBuilder::spline). _ta and _tb are _a and _b tangents,
+// multiplied by the time interval between _a and _b.
+math::Float3 HermiteTranslation(const math::Float3& _a, const math::Float3& _ta,
+                                const math::Float3& _b, const math::Float3& _tb,
+                                float _alpha);
+math::Quaternion HermiteRotation(const math::Quaternion& _a,
+                                 const math::Quaternion& _ta,
+                                 const math::Quaternion& _b,
+                                 const math::Quaternion& _tb, float _alpha);
+math::Float3 HermiteScale(const math::Float3& _a, const math::Float3& _ta,
+                          const math::Float3& _b, const math::Float3& _tb,
+                          float _alpha);
+
+// Samples _animation at _time, using the same interpolation as the runtime
+// linear sampling job, and outputs one local-space transform per track to
+// _transforms. Tracks without key output identity.
+// Returns false if _animation is invalid or if _transforms is too small.
+bool SampleAnimation(const RawAnimation& _animation, float _time,
+                     const Range<math::Transform>& _transforms);
+
+// Samples _animation at every time of _times, using the same interpolation as
+// SampleAnimation(). _times must be sorted in increasing order, which allows
+// iterating track keys with a forward cursor: sampling the whole batch costs
+// O(keys + times) per track, instead of a key search per time and track.
+// Transforms are output time major, the transform of track i at _times[t]
+// being _transforms[t * num_tracks + i].
+// Returns false if _animation is invalid, if _times isn't sorted, or if
+// _transforms is too small.
+bool SampleRawAnimation(const RawAnimation& _animation,
+                        const Range<const float>& _times,
+                        const Range<math::Transform>& _transforms);
+
+// Extracts the [_begin,_end] time interval of _input animation to _output.
+// _output duration is _end - _begin, and its keys are shifted by -_begin. Keys
+// are added at both interval bounds (interpolated from _input keys), so that
+// _output is self sufficient: sampling _output at time t gives the same
+// transforms as sampling _input at time _begin + t, apart from rotations in
+// between bounds keys as nlerp isn't linear.
+// Returns false if _input is invalid, or if [_begin,_end] isn't a non empty
+// interval included in [0,_input.duration].
+bool ExtractSegment(const RawAnimation& _input, float _begin, float _end,
+                    RawAnimation* _output);
+
+// Splits _input animation in consecutive segments of _segment_duration (the
+// last one can be shorter), see ExtractSegment(). Each segment can then be
+// built and serialized independently, so that only the segment containing
+// the current time needs to be resident (see SegmentedSamplingJob).
+// Returns false if _input is invalid or _segment_duration isn't strictly
+// positive.
+bool SplitAnimation(const RawAnimation& _input, float _segment_duration,
+                    ozz::Vector<RawAnimation>::Std* _segments);
+
+// Extracts _animation synchronization markers from _track, a float track that
+// matches _animation (like a foot contact curve). A marker is added at every
+// rising edge of _track, aka every time its value crosses _threshold upward.
+// Markers are stored to _animation sync_markers, in place of existing ones.
+// Returns false if _track is invalid.
+bool ExtractSyncMarkers(const RawFloatTrack& _track, float _threshold,
+                        RawAnimation* _animation);
 }  // namespace offline
 }  // namespace animation
 }  // namespace ozz
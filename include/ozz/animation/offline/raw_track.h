@@ -120,6 +120,26 @@ struct RawFloat2Track : public internal::RawTrack<math::Float2> {};
 struct RawFloat3Track : public internal::RawTrack<math::Float3> {};
 struct RawFloat4Track : public internal::RawTrack<math::Float4> {};
 struct RawQuaternionTrack : public internal::RawTrack<math::Quaternion> {};
+
+// Offline set of float user-channel tracks, to be converted to a runtime
+// TrackSet by the TrackBuilder. Each channel is a RawFloatTrack with its own
+// keyframes. The builder merges all channels keyframe ratios into a shared,
+// deduplicated time axis. Channels that don't have a keyframe at a merged
+// ratio are resampled at this ratio, which doesn't alter their curve. Channels
+// that already share the same keyframe ratios, which is the usual case for
+// tracks exported from a DCC tool at a fixed sampling rate, don't get any
+// additional keyframe.
+struct RawTrackSet {
+  // Validates that all channels are valid, see RawTrack::Validate().
+  bool Validate() const;
+
+  // Channels of the track set.
+  typedef ozz::Vector<RawFloatTrack>::Std Channels;
+  Channels channels;
+
+  // Name of the track set.
+  String::Std name;
+};
 }  // namespace offline
 }  // namespace animation
 
@@ -0,0 +1,82 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_ANIMATION_OFFLINE_ROOT_MOTION_EXTRACTOR_H_
+#define OZZ_OZZ_ANIMATION_OFFLINE_ROOT_MOTION_EXTRACTOR_H_
+
+namespace ozz {
+namespace animation {
+namespace offline {
+
+// Forward declare offline animation and track types.
+struct RawAnimation;
+struct RawFloat3Track;
+struct RawQuaternionTrack;
+
+// Defines the class responsible for extracting root motion from an offline raw
+// animation. Root joint translation (on selected axes) and yaw (rotation
+// around y axis) are extracted to a RawFloat3Track and a RawQuaternionTrack,
+// which can be built with the TrackBuilder. At runtime, RootMotionJob computes
+// the motion between two ratios from these tracks, without sampling the
+// animation. Extracted motion can also be baked out of the animation root
+// joint, so that the animation plays in place while the character is moved by
+// root motion.
+class RootMotionExtractor {
+ public:
+  // Initializes the extractor with default values: ground plane translation
+  // (x and z axes) and yaw are extracted from joint 0, and baked.
+  RootMotionExtractor();
+
+  // Extracts root motion from _input, and fills _translation and _rotation
+  // tracks. Track ratios are key times divided by _input duration. If _output
+  // isn't NULL, it's filled with a copy of _input, from which extracted motion
+  // is removed if bake is true.
+  // Returns false on failure, if _input isn't valid, if root_joint isn't a
+  // valid track index, or if _translation or _rotation are NULL.
+  bool operator()(const RawAnimation& _input, RawFloat3Track* _translation,
+                  RawQuaternionTrack* _rotation, RawAnimation* _output) const;
+
+  // Index of the root joint track whose motion is extracted.
+  int root_joint;
+
+  // Selects translation axes to extract. Translation along other axes remains
+  // in the animation.
+  bool translation_x;
+  bool translation_y;
+  bool translation_z;
+
+  // Extracts root joint rotation around y axis (yaw). Extracted rotation
+  // remains identity otherwise.
+  bool yaw;
+
+  // Removes extracted motion from _output animation root joint.
+  bool bake;
+};
+}  // namespace offline
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_OFFLINE_ROOT_MOTION_EXTRACTOR_H_
@@ -44,15 +44,96 @@ namespace offline {
 // Forward declares the offline skeleton type.
 struct RawSkeleton;
 
+// Defines the rules selecting the joints of a skeleton level of detail, see
+// SkeletonBuilder::lods. Rules are applied to the joints of the previous LOD,
+// so that every LOD is a subset of the previous one. A joint is always removed
+// along with its whole hierarchy.
+struct SkeletonLOD {
+  // Initializes rules with default values, that remove no joint.
+  SkeletonLOD();
+
+  // Names of the joints to remove. Names can contain wildcards: a ? sign
+  // matches any character, a * sign matches any string, like "*Finger*".
+  ozz::Vector<ozz::String::Std>::Std excluded_joints;
+
+  // Maximum depth of the joints to keep, roots having a depth of 0. Deeper
+  // joints are removed.
+  // Default value is -1, meaning that depth is unlimited.
+  int max_depth;
+
+  // Number of times leaf joints are removed. Every pass removes the leaves left
+  // by the previous one, so it removes hierarchy end chains (like fingers and
+  // toes end joints) which are usually of little visual impact.
+  // Default value is 0.
+  int prune_leaves;
+};
+
 // Defines the class responsible of building Skeleton instances.
 class SkeletonBuilder {
  public:
+  // Initializes the builder with default parameters.
+  SkeletonBuilder();
+
   // Creates a Skeleton based on _raw_skeleton and *this builder parameters.
   // Returns a Skeleton instance on success which will then be deleted using
   // the default allocator Delete() function.
   // Returns NULL on failure. See RawSkeleton::Validate() for more details about
-  // failure reasons.
+  // failure reasons. Building also fails if there are too many lods.
   Skeleton* operator()(const RawSkeleton& _raw_skeleton) const;
+
+  // Creates a Skeleton like the function above, but allocates the skeleton
+  // object and its data from _allocator (see Skeleton::allocator()). The
+  // returned skeleton will then need to be deleted using _allocator Delete()
+  // function.
+  Skeleton* operator()(const RawSkeleton& _raw_skeleton,
+                       memory::Allocator* _allocator) const;
+
+  // Builds _raw_skeleton into an existing _skeleton, replacing its content.
+  // _skeleton data buffer is reused if it's big enough, otherwise it's
+  // reallocated from _skeleton allocator.
+  // Returns false and leaves _skeleton unchanged on failure.
+  bool operator()(const RawSkeleton& _raw_skeleton, Skeleton* _skeleton) const;
+
+  // Computes the joints order of a skeleton built from _raw_skeleton with
+  // *this builder parameters. Every entry i of _order receives the depth-first
+  // index (see RawSkeleton::IterateJointsDF()) of the raw joint built at index
+  // i. The table follows BuildJointRemap() convention, so it can be used by a
+  // RemapJob to convert poses (or animation tracks) ordered like
+  // _raw_skeleton to the built skeleton order, when optimize_joints_order is
+  // enabled or lods are specified.
+  // Returns false if _raw_skeleton is invalid or if _order is smaller than its
+  // number of joints.
+  bool BuildJointsOrder(const RawSkeleton& _raw_skeleton,
+                        const Range<int>& _order) const;
+
+  // Reorders joints to improve memory locality of skeleton traversals, like
+  // LocalToModelJob reading each joint parent. Joints remain in depth-first
+  // order, but siblings are ordered by increasing hierarchy size instead of
+  // RawSkeleton order. This minimizes the total distance between joints and
+  // their parent, and keeps long chains (spine, limbs, fingers) contiguous at
+  // the end of their parent hierarchy. Use BuildJointsOrder() to find where
+  // each raw joint is built.
+  // Default value is false, meaning that joints are built in RawSkeleton
+  // depth-first order.
+  bool optimize_joints_order;
+
+  // Levels of detail rules. Entry i defines LOD i + 1 joints from LOD i ones,
+  // LOD 0 being the whole skeleton (see Skeleton::joint_lods()). Joints remain
+  // in depth-first order, but siblings are ordered so that the ones kept by
+  // the coarsest LODs come first. This way each LOD fits in the smallest
+  // possible prefix of the skeleton (see Skeleton::lod_num_joints()), which
+  // runtime jobs can be limited to. Use BuildJointsOrder() to find where each
+  // raw joint is built.
+  // There can be at most Skeleton::kMaxLODs - 1 entries.
+  // Default value is empty, meaning that the skeleton has a single LOD.
+  ozz::Vector<SkeletonLOD>::Std lods;
+
+ private:
+  // Tests _raw_skeleton validity, and that *this builder parameters match.
+  bool Validate(const RawSkeleton& _raw_skeleton) const;
+
+  // Fills _skeleton from a validated _raw_skeleton.
+  void Build(const RawSkeleton& _raw_skeleton, Skeleton* _skeleton) const;
 };
 }  // namespace offline
 }  // namespace animation
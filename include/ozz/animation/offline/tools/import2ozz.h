@@ -94,6 +94,18 @@ class OzzImporter {
                       const ozz::animation::Skeleton& _skeleton,
                       float _sampling_rate, RawAnimation* _animation) = 0;
 
+  // Import animation "_animation_name" like the function above, but extracts
+  // source keyframes instead of resampling the animation uniformly, so sparse
+  // authored keys don't produce redundant keys the optimizer has to remove.
+  // Curve segments that can't be represented by linearly interpolated keys
+  // (stepped, cubic...) are subdivided, but never more finely than
+  // _sampling_rate.
+  // Default implementation falls back to uniform sampling.
+  // Returning false will report and error.
+  virtual bool ImportKeyframes(const char* _animation_name,
+                               const ozz::animation::Skeleton& _skeleton,
+                               float _sampling_rate, RawAnimation* _animation);
+
   // Tracks / properties management.
 
   // Defines properties, aka user-channel data: animations that aren't only
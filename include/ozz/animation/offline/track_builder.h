@@ -37,6 +37,11 @@ class Float2Track;
 class Float3Track;
 class Float4Track;
 class QuaternionTrack;
+class TrackSet;
+class QuantizedFloatTrack;
+class QuantizedFloat2Track;
+class QuantizedFloat3Track;
+class QuantizedFloat4Track;
 
 namespace offline {
 
@@ -46,6 +51,7 @@ struct RawFloat2Track;
 struct RawFloat3Track;
 struct RawFloat4Track;
 struct RawQuaternionTrack;
+struct RawTrackSet;
 
 // Defines the class responsible of building runtime track instances from
 // offline tracks.The input raw track is first validated. Runtime conversion of
@@ -53,6 +59,9 @@ struct RawQuaternionTrack;
 // the data at all.
 class TrackBuilder {
  public:
+  // Initializes the builder with default quantization tolerance.
+  TrackBuilder();
+
   // Creates a Track based on _raw_track and *this builder
   // parameters.
   // The returned instance will then need to be deleted using the default
@@ -64,9 +73,48 @@ class TrackBuilder {
   Float4Track* operator()(const RawFloat4Track& _input) const;
   QuaternionTrack* operator()(const RawQuaternionTrack& _input) const;
 
+  // Builds _input into an existing _track, replacing its content. _track data
+  // buffer is reused if it's big enough, otherwise it's reallocated.
+  // Returns false and leaves _track unchanged on failure.
+  bool operator()(const RawFloatTrack& _input, FloatTrack* _track) const;
+  bool operator()(const RawFloat2Track& _input, Float2Track* _track) const;
+  bool operator()(const RawFloat3Track& _input, Float3Track* _track) const;
+  bool operator()(const RawFloat4Track& _input, Float4Track* _track) const;
+  bool operator()(const RawQuaternionTrack& _input,
+                  QuaternionTrack* _track) const;
+
+  // Creates a TrackSet based on _input channels, merging their keyframe ratios
+  // into a shared time axis. See RawTrackSet for more details.
+  TrackSet* operator()(const RawTrackSet& _input) const;
+
+  // Creates a quantized track based on _input and *this builder parameters.
+  // Ratios are quantized to 16 bits. Values are quantized to 8 bits if it
+  // fits tolerance, or 16 bits otherwise.
+  // Returns NULL if _input is invalid, or if keyframes are too close to each
+  // other to be distinguished once quantized.
+  QuantizedFloatTrack* Quantize(const RawFloatTrack& _input) const;
+  QuantizedFloat2Track* Quantize(const RawFloat2Track& _input) const;
+  QuantizedFloat3Track* Quantize(const RawFloat3Track& _input) const;
+  QuantizedFloat4Track* Quantize(const RawFloat4Track& _input) const;
+
+  // Maximum value error tolerated by quantization, which uses 8 bits values
+  // when the error is below this tolerance. Default is 1e-3, like
+  // TrackOptimizer tolerance.
+  float tolerance;
+
  private:
   template <typename _RawTrack, typename _Track>
   _Track* Build(const _RawTrack& _input) const;
+
+  template <typename _RawTrack, typename _Track>
+  bool Build(const _RawTrack& _input, _Track* _track) const;
+
+  // Fills _track from a validated _input.
+  template <typename _RawTrack, typename _Track>
+  void Fill(const _RawTrack& _input, _Track* _track) const;
+
+  template <typename _RawTrack, typename _Track>
+  _Track* BuildQuantized(const _RawTrack& _input) const;
 };
 }  // namespace offline
 }  // namespace animation
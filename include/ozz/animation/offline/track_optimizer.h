@@ -64,6 +64,14 @@ class TrackOptimizer {
 
   // Optimization tolerance.
   float tolerance;
+
+  // Size of the sliding window of keyframes that can be replaced by a single
+  // interpolation. Each keyframe is then tested against at most window_size
+  // keyframes, bounding optimization cost to O(n * window_size), instead of
+  // O(n^2) for long interpolable sequences of keyframes. A small window
+  // reduces optimization ratio. 0 means no limit.
+  // Default value is 0.
+  int window_size;
 };
 }  // namespace offline
 }  // namespace animation
@@ -0,0 +1,69 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_ANIMATION_OFFLINE_UNIFORM_ANIMATION_BUILDER_H_
+#define OZZ_OZZ_ANIMATION_OFFLINE_UNIFORM_ANIMATION_BUILDER_H_
+
+namespace ozz {
+namespace animation {
+
+// Forward declares the runtime uniform animation type.
+class UniformAnimation;
+
+namespace offline {
+
+// Forward declares the offline animation type.
+struct RawAnimation;
+
+// Defines the class responsible of building runtime uniform animations from
+// offline raw animations. The raw animation is sampled at a fixed frequency,
+// every frame storing the pose of all tracks (see UniformAnimation).
+class UniformAnimationBuilder {
+ public:
+  // Initializes the builder with default parameters.
+  UniformAnimationBuilder();
+
+  // Creates a UniformAnimation based on _raw_animation and *this builder
+  // parameters.
+  // Returns a valid UniformAnimation on success, or NULL if _raw_animation is
+  // invalid (see RawAnimation::Validate()) or frequency isn't strictly
+  // positive.
+  // The returned animation will then need to be deleted using the default
+  // allocator Delete() function.
+  UniformAnimation* operator()(const RawAnimation& _raw_animation) const;
+
+  // Sampling frequency, in frames per second. The number of frames is rounded
+  // up so that they evenly cover the whole animation duration, from its
+  // beginning to its end. A frame is required at least every 1 / frequency
+  // second then.
+  // Default value is 30.
+  float frequency;
+};
+}  // namespace offline
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_OFFLINE_UNIFORM_ANIMATION_BUILDER_H_
@@ -0,0 +1,106 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_ACCUMULATED_BLENDING_JOB_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_ACCUMULATED_BLENDING_JOB_H_
+
+#include "ozz/animation/runtime/blending_job.h"
+#include "ozz/base/maths/soa_float.h"
+#include "ozz/base/maths/soa_quaternion.h"
+#include "ozz/base/platform.h"
+
+namespace ozz {
+namespace animation {
+
+// Sum of weighted local-space transforms of 4 joints, as accumulated by a
+// SamplingJob (see SamplingJob::accumulator). Rotations are accumulated along
+// the shortest path, like BlendingJob layers are. A zeroed accumulator
+// contains nothing, see ResetBlendAccumulators().
+struct SoaBlendAccumulator {
+  math::SoaFloat3 translation;
+  math::SoaQuaternion rotation;
+  math::SoaFloat3 scale;
+  math::SimdFloat4 weight;
+};
+
+// Zeroes all _accumulators, which must be done before the first accumulation.
+// AccumulatedBlendingJob resets the accumulators it normalizes.
+void ResetBlendAccumulators(const Range<SoaBlendAccumulator>& _accumulators);
+
+// ozz::animation::AccumulatedBlendingJob completes a blend whose layers were
+// accumulated by sampling jobs, see SamplingJob::accumulator. It outputs the
+// same pose as a BlendingJob (without additive layers) whose layers would be
+// the accumulated sampled poses: the bind pose is blended to joints whose
+// accumulated weight is less than the threshold, then translations and scales
+// are normalized by the accumulated weight, and rotations are normalized.
+// Accumulators are reset once read, so they're ready for the next blend.
+// The number of transforms/joints processed by the job is defined by the
+// number of transforms of the bind pose, so all buffers must be at least as
+// big as the bind pose buffer.
+// The job does not owned any buffers (input/output) and will thus not delete
+// them during job's destruction.
+struct AccumulatedBlendingJob {
+  // Default constructor, initializes default values.
+  AccumulatedBlendingJob();
+
+  // Validates job parameters.
+  // Returns true for a valid job, false otherwise:
+  // -if bind pose, accumulator or output range is not valid.
+  // -if accumulator or output is smaller than the bind pose buffer.
+  // -if the threshold value is less than or equal to 0.f.
+  bool Validate() const;
+
+  // Runs job's normalization task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // The job blends the bind pose to the output when the accumulated weight of
+  // a joint is less than this threshold value, see BlendingJob::threshold.
+  // Must be greater than 0.f.
+  float threshold;
+
+  // Rotations normalization quality, kStandard by default. See
+  // BlendingJob::Quality.
+  BlendingJob::Quality quality;
+
+  // The skeleton bind pose, which defines the number of soa joints processed.
+  Range<const math::SoaTransform> bind_pose;
+
+  // Accumulated layers, read and then reset by the job.
+  Range<SoaBlendAccumulator> accumulator;
+
+  // Job output.
+  // The range of output transforms to be filled with blended joint
+  // transforms during job execution.
+  Range<math::SoaTransform> output;
+};
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_ACCUMULATED_BLENDING_JOB_H_
@@ -36,6 +36,12 @@ namespace io {
 class IArchive;
 class OArchive;
 }  // namespace io
+namespace math {
+struct Box;
+}  // namespace math
+namespace memory {
+class Allocator;
+}  // namespace memory
 namespace animation {
 
 // Forward declares the AnimationBuilder, used to instantiate an Animation.
@@ -47,6 +53,9 @@ class AnimationBuilder;
 struct TranslationKey;
 struct RotationKey;
 struct ScaleKey;
+struct KeyRange;
+struct Float3Tangent;
+struct QuaternionTangent;
 
 // Defines a runtime skeletal animation clip.
 // The runtime animation data structure stores animation keyframes, for all the
@@ -57,19 +66,65 @@ struct ScaleKey;
 // required to animate all the joints of a skeleton, matching breadth-first
 // joints order of the runtime skeleton structure. In order to optimize cache
 // coherency when sampling the animation, Keyframes in this array are sorted by
-// time, then by track number.
+// time, then by track number. Constant tracks (tracks whose keyframes all have
+// the same value) are stored once, using a single keyframe placed at the
+// beginning of the array, before the time sorted keyframes.
+// Spline animations additionally store a tangent per keyframe, so keyframes are
+// interpolated with cubic Hermite splines instead of linearly. Smooth motions
+// can then be represented with less keyframes.
 class Animation {
  public:
-  // Builds a default animation.
+  // Builds a default animation. Animation data is allocated from the default
+  // allocator, as set when constructing the animation.
   Animation();
 
+  // Builds a default animation which data are allocated from _allocator, like
+  // a dedicated arena. _allocator must outlive the animation.
+  explicit Animation(memory::Allocator* _allocator);
+
   // Declares the public non-virtual destructor.
   ~Animation();
 
+#if __cplusplus >= 201103L
+  // Moves _other content to *this, transferring its single owned buffer and
+  // allocator without reallocating. _other is left empty.
+  Animation(Animation&& _other);
+  Animation& operator=(Animation&& _other);
+#endif  // __cplusplus
+
+  // Replaces *this animation content with a copy of _other, allocated from
+  // *this animation allocator. This allows to replicate an animation to memory
+  // that's local to the threads that sample it, like a per NUMA node
+  // allocator. The owned buffer is reused if it's big enough. The copy gets a
+  // new uid(), and isn't mapped even if _other is.
+  void CopyFrom(const Animation& _other);
+
   // Gets the animation clip duration.
   float duration() const { return duration_; }
 
-  // Gets the number of animated tracks.
+  // Gets the number of frames the animation duration is divided in. Key times
+  // are stored as frame indices in range [0, num_frames]. AnimationBuilder
+  // selects the smallest number of frames that matches all key times, so clips
+  // sampled at a fixed rate are stored exactly. Animations whose key times
+  // don't match a coarser frame rate are divided in 65535 frames. Key times
+  // that don't fit 16 bits frame indices, because there are more than 65535
+  // frames or because keys are too close to be stored at distinct frames, are
+  // stored as floats, see has_key_times().
+  int num_frames() const { return num_frames_; }
+
+  // Tells if *this animation stores key times as floats, see
+  // translation_times().
+  bool has_key_times() const { return translation_times_.begin != NULL; }
+
+  // Gets the time of every key, in frames (in range [0, num_frames]), or empty
+  // buffers if key times are stored in keys ratio member. Element i of a buffer
+  // belongs to key i of the matching key buffer, whose ratio member is unused.
+  Range<const float> translation_times() const { return translation_times_; }
+  Range<const float> rotation_times() const { return rotation_times_; }
+  Range<const float> scale_times() const { return scale_times_; }
+
+  // Gets the number of animated tracks. For sparse animations, this is the
+  // number of stored tracks, which is a multiple of 4, see soa_joints().
   int num_tracks() const { return num_tracks_; }
 
   // Returns the number of SoA elements matching the number of tracks of *this
@@ -79,6 +134,17 @@ class Animation {
   // Gets animation name.
   const char* name() const { return name_ ? name_ : ""; }
 
+  // Gets the unique identifier of *this animation content. A new identifier is
+  // generated every time an animation is built or loaded, so that caches can
+  // detect an animation that was destroyed and reallocated at the same
+  // address. 0 is the identifier of empty animations.
+  uint32_t uid() const { return uid_; }
+
+  // Gets the fingerprint of the skeleton *this animation was built for (see
+  // Skeleton::fingerprint()), or 0 if it's unknown, as no skeleton was given
+  // to the AnimationBuilder. See IsCompatible().
+  uint32_t skeleton_fingerprint() const { return skeleton_fingerprint_; }
+
   // Gets the buffer of translations keys.
   ozz::Range<const TranslationKey> translations() const {
     return translations_;
@@ -90,14 +156,193 @@ class Animation {
   // Gets the buffer of scale keys.
   Range<const ScaleKey> scales() const { return scales_; }
 
+  // Tells if *this is a spline animation, see AnimationBuilder::spline. Spline
+  // animations can only be sampled by a SamplingCache in spline mode.
+  bool spline() const { return translation_tangents_.begin != NULL; }
+
+  // Gets the buffers of key tangents of spline animations, empty otherwise.
+  // Tangent i of a buffer belongs to key i of the matching key buffer.
+  Range<const Float3Tangent> translation_tangents() const {
+    return translation_tangents_;
+  }
+  Range<const QuaternionTangent> rotation_tangents() const {
+    return rotation_tangents_;
+  }
+  Range<const Float3Tangent> scale_tangents() const { return scale_tangents_; }
+
+  // Tells if *this animation has step tracks, see steps().
+  bool has_steps() const { return steps_.begin != NULL; }
+
+  // Gets step tracks flags, one bit per track (bit i & 7 of byte i / 8 is
+  // track i), or an empty buffer if no track is a step track. Step tracks keys
+  // aren't interpolated: every key value is held until the next key, see
+  // offline::RawAnimation::JointTrack::step.
+  Range<const uint8_t> steps() const { return steps_; }
+
+  // Tells if *this is a sparse animation, see soa_joints().
+  bool sparse() const { return soa_joints_.begin != NULL; }
+
+  // Gets the skeleton soa joint (aka group of 4 joints) index of every soa
+  // track of a sparse animation, in strictly increasing order, or an empty
+  // buffer otherwise. Sparse animations only store the soa joints animated by
+  // a partial clip (face, hands...), see AnimationBuilder::sparse. They can be
+  // sampled to a full skeleton pose (see SamplingJob::scatter), or to a dense
+  // pose used with soa_joints() as an additive BlendingJob::Layer
+  // transform_indices.
+  Range<const int> soa_joints() const { return soa_joints_; }
+
+  // Tells if *this animation has precision levels of detail, see
+  // AnimationBuilder::precision_lods and SamplingJob::precision_lod.
+  bool has_precision_lods() const {
+    return translation_key_lods_.begin != NULL;
+  }
+
+  // Gets the precision level of detail of every key, or empty buffers if the
+  // animation has no precision lod. Element i of a buffer belongs to key i of
+  // the matching key buffer. A key is sampled by precision lods lower or equal
+  // to its own, keys that are sampled at any precision lod (first and last
+  // keys of a track, constant and step tracks keys, and keys sampled by the
+  // coarsest lod built) are kKeepKeyLod.
+  Range<const uint8_t> translation_key_lods() const {
+    return translation_key_lods_;
+  }
+  Range<const uint8_t> rotation_key_lods() const { return rotation_key_lods_; }
+  Range<const uint8_t> scale_key_lods() const { return scale_key_lods_; }
+
+  // Precision lod of the keys that are never skipped, see
+  // translation_key_lods().
+  enum { kKeepKeyLod = 255 };
+
+  // Gets the index of the next key of the same track whose precision lod is
+  // higher than key i one, for every key i, or -1 for kKeepKeyLod keys. This
+  // allows the SamplingJob to jump over the keys of a track that a precision
+  // lod skips, while scanning all keys in their sorted order. Buffers are
+  // empty if the animation has no precision lod.
+  Range<const int> translation_lod_next() const {
+    return translation_lod_next_;
+  }
+  Range<const int> rotation_lod_next() const { return rotation_lod_next_; }
+  Range<const int> scale_lod_next() const { return scale_lod_next_; }
+
+  // Gets the number of constant translation, rotation and scale tracks. Their
+  // single keyframe is stored at the beginning of translations(), rotations()
+  // and scales() buffers respectively, sorted by track number.
+  int num_constant_translations() const { return num_constant_translations_; }
+  int num_constant_rotations() const { return num_constant_rotations_; }
+  int num_constant_scales() const { return num_constant_scales_; }
+
+  // Gets the buffer of translation keys quantization ranges, one per soa
+  // track.
+  Range<const KeyRange> translation_ranges() const {
+    return translation_ranges_;
+  }
+
+  // Gets the buffer of scale keys quantization ranges, one per soa track.
+  Range<const KeyRange> scale_ranges() const { return scale_ranges_; }
+
+  // Gets the bit packed quantized values of translation and scale keys, whose
+  // number of bits is selected per track (see
+  // AnimationBuilder::quantization_translation_tolerance).
+  Range<const uint8_t> translation_values() const {
+    return translation_values_;
+  }
+  Range<const uint8_t> scale_values() const { return scale_values_; }
+
+  // Gets the bit offset, in translation_values() and scale_values() buffers, of
+  // the values of every 16th key, which allows to locate the values of any
+  // key.
+  Range<const uint32_t> translation_value_offsets() const {
+    return translation_value_offsets_;
+  }
+  Range<const uint32_t> scale_value_offsets() const {
+    return scale_value_offsets_;
+  }
+
+  // Gets the number of seek points. Seek points are optional, they are built
+  // by the AnimationBuilder (see AnimationBuilder::seek_interval) and allow a
+  // SamplingCache to be re-seeded at any ratio without scanning keyframes from
+  // the beginning of the animation.
+  int num_seek_points() const { return static_cast<int>(seek_ratios_.count()); }
+
+  // Gets the buffer of seek point ratios, sorted in ascending order.
+  Range<const float> seek_ratios() const { return seek_ratios_; }
+
+  // Gets the buffer of seek point key indices. For each seek point, this buffer
+  // stores translation, rotation and scale keyframe cursors, followed by the
+  // indices of the 2 keys (left and right) for every soa aligned track (see
+  // num_soa_tracks()), respectively for translations, rotations and scales.
+  // See seek_point_stride() for the number of elements per seek point.
+  Range<const int> seek_keys() const { return seek_keys_; }
+
+  // Gets the number of elements of seek_keys() buffer used by a seek point.
+  int seek_point_stride() const { return 3 + 3 * 2 * num_soa_tracks() * 4; }
+
+  // Gets the number of synchronization markers. Markers are optional, they are
+  // built from RawAnimation::sync_markers by the AnimationBuilder and allow to
+  // synchronize animations phase (see SyncSamplingJob).
+  int num_sync_markers() const {
+    return static_cast<int>(sync_ratios_.count());
+  }
+
+  // Gets the buffer of synchronization markers ratios, sorted in ascending
+  // order.
+  Range<const float> sync_ratios() const { return sync_ratios_; }
+
+  // Gets the number of precomputed bounds. Bounds are optional, they are built
+  // by the AnimationBuilder (see AnimationBuilder::bounds_interval) and allow
+  // to cull an animated object without sampling its animation.
+  int num_bounds() const;
+
+  // Gets the buffer of precomputed bounds. Bounds i contains skeleton joints
+  // model-space positions for any ratio of interval
+  // [i / num_bounds(), (i + 1) / num_bounds()].
+  Range<const math::Box> bounds() const { return bounds_; }
+
+  // Gets the precomputed bounds of the interval that contains _ratio, which is
+  // clamped to the unit interval [0,1]. Returns NULL if *this animation has no
+  // bounds.
+  const math::Box* GetBounds(float _ratio) const;
+
   // Get the estimated animation's size in bytes.
   size_t size() const;
 
+  // Gets the allocator used to allocate animation data.
+  memory::Allocator* allocator() const { return allocator_; }
+
   // Serialization functions.
   // Should not be called directly but through io::Archive << and >> operators.
   void Save(ozz::io::OArchive& _archive) const;
   void Load(ozz::io::IArchive& _archive, uint32_t _version);
 
+  // Flat representation functions.
+  // The flat representation is a relocatable copy of the animation, a header
+  // followed by its single data buffer, that contains no pointer. It can be
+  // written once to a shared memory segment, then mapped read-only by any
+  // number of animations (of any process) without copying nor allocating.
+  // Unlike archives, the flat representation is only valid for the same
+  // library version, endianness and ABI that wrote it.
+
+  // Required flat buffer alignment.
+  enum { kFlatAlignment = 16 };
+
+  // Gets the size in bytes of *this animation flat representation.
+  size_t flat_size() const;
+
+  // Writes *this animation flat representation to _buffer, which must be
+  // aligned to kFlatAlignment and at least flat_size() bytes long. Returns
+  // false if _buffer is invalid.
+  bool WriteFlat(void* _buffer, size_t _size) const;
+
+  // Releases current content and maps *this animation to the flat
+  // representation stored in _buffer. _buffer isn't copied nor modified, it
+  // must outlive *this animation (or its next Load/MapFlat) and can be
+  // read-only. Returns false and leaves *this animation empty if _buffer isn't
+  // a valid flat representation.
+  bool MapFlat(const void* _buffer, size_t _size);
+
+  // Tells if *this animation is mapped to an external flat buffer.
+  bool mapped() const { return mapped_; }
+
  protected:
  private:
   // Disables copy and assignation.
@@ -107,14 +352,48 @@ class Animation {
   // AnimationBuilder class is allowed to instantiate an Animation.
   friend class offline::AnimationBuilder;
 
-  // Internal destruction function.
+  // Internal allocation and destruction functions. Allocate replaces current
+  // content, reusing the owned buffer if it's big enough, so rebuilding an
+  // animation doesn't reallocate.
   void Allocate(size_t _name_len, size_t _translation_count,
-                size_t _rotation_count, size_t _scale_count);
+                size_t _rotation_count, size_t _scale_count,
+                size_t _translation_value_size, size_t _scale_value_size,
+                size_t _seek_point_count, size_t _sync_count,
+                size_t _bounds_count, bool _spline, bool _steps,
+                bool _sparse, bool _lods, bool _times);
   void Deallocate();
 
+  // Computes the size of the single buffer used to store animation data. It
+  // depends on num_tracks_, which must be set.
+  size_t BufferSize(size_t _name_len, size_t _translation_count,
+                    size_t _rotation_count, size_t _scale_count,
+                    size_t _translation_value_size,
+                    size_t _scale_value_size, size_t _seek_point_count,
+                    size_t _sync_count, size_t _bounds_count, bool _spline,
+                    bool _steps, bool _sparse, bool _lods,
+                    bool _times) const;
+
+  // Fixes up all data ranges and name to _buffer, whose layout is the same
+  // for allocated and mapped flat buffers.
+  void FixUp(char* _buffer, size_t _name_len, size_t _translation_count,
+             size_t _rotation_count, size_t _scale_count,
+             size_t _translation_value_size, size_t _scale_value_size,
+             size_t _seek_point_count, size_t _sync_count,
+             size_t _bounds_count, bool _spline, bool _steps,
+             bool _sparse, bool _lods, bool _times);
+
+  // Swaps all members with _other, used to implement move semantic.
+  void Swap(Animation& _other);
+
+  // Allocator used for animation data.
+  memory::Allocator* allocator_;
+
   // Duration of the animation clip.
   float duration_;
 
+  // Number of frames key times are stored in, see num_frames().
+  int num_frames_;
+
   // The number of joint tracks. Can differ from the data stored in translation/
   // rotation/scale buffers because of SoA requirements.
   int num_tracks_;
@@ -122,15 +401,85 @@ class Animation {
   // Animation name.
   char* name_;
 
+  // Unique identifier of the animation content, see uid().
+  uint32_t uid_;
+
+  // Fingerprint of the skeleton the animation was built for, see
+  // skeleton_fingerprint().
+  uint32_t skeleton_fingerprint_;
+
   // Stores all translation/rotation/scale keys begin and end of buffers.
   Range<TranslationKey> translations_;
   Range<RotationKey> rotations_;
   Range<ScaleKey> scales_;
+
+  // Stores spline animations key tangents. Buffers are empty (NULL) for
+  // linear animations.
+  Range<Float3Tangent> translation_tangents_;
+  Range<QuaternionTangent> rotation_tangents_;
+  Range<Float3Tangent> scale_tangents_;
+
+  // Stores the number of constant tracks, whose single key is stored at the
+  // beginning of translations_, rotations_ and scales_ buffers.
+  int num_constant_translations_;
+  int num_constant_rotations_;
+  int num_constant_scales_;
+
+  // Stores translation and scale quantization ranges, one per soa track.
+  Range<KeyRange> translation_ranges_;
+  Range<KeyRange> scale_ranges_;
+
+  // Stores translation and scale bit packed values and value offsets, see
+  // translation_values().
+  Range<uint8_t> translation_values_;
+  Range<uint8_t> scale_values_;
+  Range<uint32_t> translation_value_offsets_;
+  Range<uint32_t> scale_value_offsets_;
+
+  // Stores seek points ratios and key indices, see seek_keys() for the layout.
+  Range<float> seek_ratios_;
+  Range<int> seek_keys_;
+
+  // Stores synchronization markers ratios, see sync_ratios().
+  Range<float> sync_ratios_;
+
+  // Stores keys time, see translation_times(). Buffers are empty if key times
+  // are stored as frame indices.
+  Range<float> translation_times_;
+  Range<float> rotation_times_;
+  Range<float> scale_times_;
+
+  // Stores precomputed model-space bounds, see bounds().
+  Range<math::Box> bounds_;
+
+  // Stores step tracks flags, see steps(). Empty if there's no step track.
+  Range<uint8_t> steps_;
+
+  // Stores sparse animations soa joints, see soa_joints(). Empty if the
+  // animation isn't sparse.
+  Range<int> soa_joints_;
+
+  // Stores keys precision lods and next key indices, see
+  // translation_key_lods() and translation_lod_next(). Buffers are empty if
+  // the animation has no precision lod.
+  Range<uint8_t> translation_key_lods_;
+  Range<uint8_t> rotation_key_lods_;
+  Range<uint8_t> scale_key_lods_;
+  Range<int> translation_lod_next_;
+  Range<int> rotation_lod_next_;
+  Range<int> scale_lod_next_;
+
+  // Size in bytes of the owned data buffer. It's 0 if there's no buffer, or
+  // if it's mapped.
+  size_t capacity_;
+
+  // Data buffer is an external flat buffer, not owned by *this animation.
+  bool mapped_;
 };
 }  // namespace animation
 
 namespace io {
-OZZ_IO_TYPE_VERSION(6, animation::Animation)
+OZZ_IO_TYPE_VERSION(21, animation::Animation)
 OZZ_IO_TYPE_TAG("ozz-animation", animation::Animation)
 }  // namespace io
 }  // namespace ozz
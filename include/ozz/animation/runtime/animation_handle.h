@@ -0,0 +1,131 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_ANIMATION_HANDLE_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_ANIMATION_HANDLE_H_
+
+#include "ozz/base/platform.h"
+
+namespace ozz {
+namespace animation {
+
+// Forward declares the animation type.
+class Animation;
+
+// Owns an animation that can be replaced (hot reloaded) while worker threads
+// are sampling it, without locks on the sampling path.
+// Readers (worker threads) acquire the current animation with Acquire(), and
+// release it with Release() once they're done sampling. The writer (loading
+// thread) publishes a new animation with Publish(). The previous one is
+// retired, and deleted by Publish() or Collect() once all readers that could
+// have acquired it have released it (epoch based reclamation). Readers never
+// wait for the writer, and the writer never waits for readers.
+// Sampling caches don't need to be invalidated by hand when an animation is
+// replaced: a published animation has a new Animation::uid(), which the
+// SamplingJob checks to invalidate caches, even if the new animation is
+// allocated at the address of a deleted one.
+// Each concurrent reader must use its own reader index, in range
+// [0, num_readers()[, like a worker thread index. There can be a single
+// writer. Synchronization requires c++11 atomics. In c++98 builds, readers and
+// writer must be synchronized externally.
+class AnimationHandle {
+ public:
+  // Constructs an empty handle for _num_readers concurrent readers.
+  explicit AnimationHandle(int _num_readers);
+
+  // Deletes current and retired animations. No reader must be active.
+  ~AnimationHandle();
+
+  // Reader side.
+
+  // Acquires the current animation for reader _reader. The returned animation
+  // (NULL if none was published) remains alive until Release(_reader), even if
+  // a new animation is published in the meantime. A reader can't acquire
+  // twice without releasing.
+  const Animation* Acquire(int _reader);
+
+  // Releases the animation acquired by reader _reader.
+  void Release(int _reader);
+
+  // Acquires and releases an animation for the lifetime of the scope.
+  class ScopedAcquire {
+   public:
+    ScopedAcquire(AnimationHandle* _handle, int _reader)
+        : handle_(_handle),
+          reader_(_reader),
+          animation_(_handle->Acquire(_reader)) {}
+    ~ScopedAcquire() { handle_->Release(reader_); }
+
+    // Gets the acquired animation, NULL if none was published.
+    const Animation* animation() const { return animation_; }
+
+   private:
+    // Disables copy and assignment.
+    ScopedAcquire(const ScopedAcquire&);
+    void operator=(const ScopedAcquire&);
+
+    AnimationHandle* handle_;
+    int reader_;
+    const Animation* animation_;
+  };
+
+  // Writer side.
+
+  // Publishes _animation (can be NULL), which becomes the animation acquired by
+  // readers. The handle takes ownership of _animation, which will be deleted
+  // using its allocator Delete() function (see Animation::allocator()), as
+  // returned by AnimationBuilder. The previously published animation is
+  // retired, and deleted as soon as no reader uses it anymore, see Collect().
+  void Publish(Animation* _animation);
+
+  // Deletes retired animations that no reader uses anymore. This is also done
+  // by Publish(), but can be called periodically to release memory earlier.
+  // Returns the number of retired animations that are still in use.
+  int Collect();
+
+  // Gets the number of animations published so far, which allows readers to
+  // detect a new animation (to restart playback for example).
+  uint32_t generation() const;
+
+  // Gets the number of readers.
+  int num_readers() const { return num_readers_; }
+
+ private:
+  // Disables copy and assignment.
+  AnimationHandle(const AnimationHandle&);
+  void operator=(const AnimationHandle&);
+
+  // Handle state, private to the implementation.
+  struct State;
+  State* state_;
+
+  int num_readers_;
+};
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_ANIMATION_HANDLE_H_
@@ -0,0 +1,137 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_ANIMATION_INSTANCE_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_ANIMATION_INSTANCE_H_
+
+#include "ozz/animation/runtime/sampling_job.h"
+#include "ozz/base/memory/allocator.h"
+#include "ozz/base/platform.h"
+
+namespace ozz {
+namespace math {
+struct SoaTransform;
+struct Float4x4;
+}  // namespace math
+namespace animation {
+
+// Forward declares runtime types.
+class Animation;
+class Skeleton;
+
+// Gathers all the per character runtime state required to sample and convert
+// a pose to model-space: a SamplingCache, a local-space pose, model-space
+// matrices and a skinning palette. Everything, including the instance object
+// itself, is laid out in a single aligned contiguous memory block. Updating a
+// large number of instances thus streams linearly through memory, instead of
+// jumping between separate allocations.
+// Instances are created with New() and destroyed with Delete(). Buffers
+// content isn't initialized.
+class AnimationInstance {
+ public:
+  // Allocates an instance from _allocator, able to sample any animation of
+  // _animations for _skeleton. Cache mode is kSpline if any of the animations
+  // is a spline one, kFull otherwise.
+  // Returns NULL if allocation failed.
+  static AnimationInstance* New(
+      const Skeleton& _skeleton,
+      const Range<const Animation* const>& _animations,
+      memory::Allocator* _allocator = memory::default_allocator());
+
+  // Allocates an instance from _allocator, for a skeleton of _num_joints
+  // and animations of at most _max_tracks tracks, with a cache in _mode.
+  // Returns NULL if allocation failed.
+  static AnimationInstance* New(int _num_joints, int _max_tracks,
+                                SamplingCache::Mode _mode,
+                                memory::Allocator* _allocator);
+
+  // Destroys and deallocates an instance created with New(). _instance can be
+  // NULL.
+  static void Delete(AnimationInstance* _instance);
+
+  // Gets the sampling cache.
+  SamplingCache* cache() { return &cache_; }
+
+  // Gets the local-space pose buffer, of num_soa_joints() elements.
+  Range<math::SoaTransform> locals() const;
+
+  // Gets the model-space matrices buffer, of num_joints() elements.
+  Range<math::Float4x4> models() const;
+
+  // Gets the skinning matrices palette buffer, of num_joints() elements.
+  Range<math::Float4x4> skinning_palette() const;
+
+  int num_joints() const { return num_joints_; }
+  int num_soa_joints() const { return (num_joints_ + 3) / 4; }
+
+  // Gets the size in bytes of the instance memory block.
+  size_t size() const { return size_; }
+
+ private:
+  AnimationInstance(int _num_joints, int _max_tracks, SamplingCache::Mode _mode,
+                    memory::Allocator* _allocator, size_t _size,
+                    size_t _cache_offset);
+  ~AnimationInstance() {}
+
+  // Disables copy and assignment.
+  AnimationInstance(AnimationInstance const&);
+  void operator=(AnimationInstance const&);
+
+  // Serves the cache its memory from the instance block.
+  class CacheAllocator : public memory::Allocator {
+   public:
+    CacheAllocator(char* _buffer, size_t _size)
+        : buffer_(_buffer), size_(_size) {}
+    virtual void* Allocate(size_t _size, size_t _alignment);
+    virtual void Deallocate(void* _block);
+    virtual void* Reallocate(void* _block, size_t _size, size_t _alignment);
+
+   private:
+    char* buffer_;
+    size_t size_;
+  };
+
+  // Allocator the instance block was allocated from.
+  memory::Allocator* allocator_;
+
+  // Size of the instance block.
+  size_t size_;
+
+  // Number of joints.
+  int num_joints_;
+
+  // Buffers, within instance block.
+  math::SoaTransform* locals_;
+  math::Float4x4* models_;
+  math::Float4x4* skinning_palette_;
+
+  // Cache allocator must be constructed before the cache.
+  CacheAllocator cache_allocator_;
+  SamplingCache cache_;
+};
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_ANIMATION_INSTANCE_H_
@@ -0,0 +1,179 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_ANIMATION_LIBRARY_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_ANIMATION_LIBRARY_H_
+
+#include "ozz/base/io/archive_traits.h"
+#include "ozz/base/platform.h"
+
+namespace ozz {
+namespace io {
+class IArchive;
+class OArchive;
+}  // namespace io
+namespace animation {
+
+// Forward declares the AnimationLibraryBuilder, used to instantiate an
+// AnimationLibrary.
+namespace offline {
+class AnimationLibraryBuilder;
+}
+
+// Defines a library keyframe of a translation or scale channel.
+struct LibraryFloat3Key {
+  float time;
+  float value[3];
+};
+
+// Defines a library keyframe of a rotation channel.
+struct LibraryQuaternionKey {
+  float time;
+  float value[4];
+};
+
+// Defines a channel of a library, as a range of its keyframes buffer. Keys are
+// sorted by time. A channel with no key is an identity channel.
+struct LibraryChannel {
+  uint32_t first_key;
+  uint32_t num_keys;
+};
+
+// Defines a clip of a library.
+struct LibraryClip {
+  // Clip duration, in seconds.
+  float duration;
+
+  // Number of joint tracks.
+  int num_tracks;
+
+  // Index of the clip first track, in tracks() buffer.
+  uint32_t first_track;
+
+  // Offset of the clip name, in the names buffer.
+  uint32_t name;
+};
+
+// Defines a set of runtime animation clips that share their channels. Clips
+// of a library (idle variants, facial or body clips of the same skeleton...)
+// often have identical (or nearly identical) joint tracks, which are stored
+// once per library instead of once per clip. Every clip track references a
+// translation, a rotation and a scale channel, each one being a sorted array
+// of keyframes (in seconds) that can be referenced by any number of tracks of
+// any clip.
+// Unlike Animation, keyframes aren't interleaved by time, so a channel is
+// sampled with a binary search on its own keys (see LibrarySamplingJob), with
+// no cache.
+// This structure is filled by the AnimationLibraryBuilder and deserialized/
+// loaded at runtime.
+class AnimationLibrary {
+ public:
+  // Builds a default (empty) library.
+  AnimationLibrary();
+
+  // Declares the public non-virtual destructor.
+  ~AnimationLibrary();
+
+  // Gets the number of clips.
+  int num_clips() const { return static_cast<int>(clips_.count()); }
+
+  // Gets clip _clip descriptor, _clip must be in range [0,num_clips()[.
+  const LibraryClip& clip(int _clip) const;
+
+  // Gets clip _clip name.
+  const char* clip_name(int _clip) const;
+
+  // Finds the clip named _name. Returns its index, or -1 if there's none.
+  int FindClip(const char* _name) const;
+
+  // Gets the channels of clip _clip tracks: 3 channel indices per track, for
+  // translation, rotation and scale channels respectively.
+  Range<const uint32_t> clip_channels(int _clip) const;
+
+  // Gets the buffers of channels, and the buffers of keys they index.
+  Range<const LibraryChannel> translations() const { return translations_; }
+  Range<const LibraryChannel> rotations() const { return rotations_; }
+  Range<const LibraryChannel> scales() const { return scales_; }
+  Range<const LibraryFloat3Key> translation_keys() const {
+    return translation_keys_;
+  }
+  Range<const LibraryQuaternionKey> rotation_keys() const {
+    return rotation_keys_;
+  }
+  Range<const LibraryFloat3Key> scale_keys() const { return scale_keys_; }
+
+  // Get the estimated library's size in bytes.
+  size_t size() const;
+
+  // Serialization functions.
+  // Should not be called directly but through io::Archive << and >> operators.
+  void Save(ozz::io::OArchive& _archive) const;
+  void Load(ozz::io::IArchive& _archive, uint32_t _version);
+
+ private:
+  // Disables copy and assignation.
+  AnimationLibrary(AnimationLibrary const&);
+  void operator=(AnimationLibrary const&);
+
+  // AnimationLibraryBuilder class is allowed to instantiate an
+  // AnimationLibrary.
+  friend class offline::AnimationLibraryBuilder;
+
+  // Internal allocation and destruction functions.
+  void Allocate(size_t _num_clips, size_t _num_clip_channels,
+                size_t _num_translations, size_t _num_rotations,
+                size_t _num_scales, size_t _num_translation_keys,
+                size_t _num_rotation_keys, size_t _num_scale_keys,
+                size_t _names_size);
+  void Deallocate();
+
+  // Clips descriptors.
+  Range<LibraryClip> clips_;
+
+  // Channel indices of all clips tracks, 3 per track.
+  Range<uint32_t> channels_;
+
+  // Channels and their keys.
+  Range<LibraryChannel> translations_;
+  Range<LibraryChannel> rotations_;
+  Range<LibraryChannel> scales_;
+  Range<LibraryFloat3Key> translation_keys_;
+  Range<LibraryQuaternionKey> rotation_keys_;
+  Range<LibraryFloat3Key> scale_keys_;
+
+  // Null terminated clip names, concatenated.
+  Range<char> names_;
+};
+}  // namespace animation
+
+namespace io {
+OZZ_IO_TYPE_VERSION(1, animation::AnimationLibrary)
+OZZ_IO_TYPE_TAG("ozz-animation_library", animation::AnimationLibrary)
+}  // namespace io
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_ANIMATION_LIBRARY_H_
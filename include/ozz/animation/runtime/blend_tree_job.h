@@ -0,0 +1,197 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_BLEND_TREE_JOB_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_BLEND_TREE_JOB_H_
+
+#include "ozz/animation/runtime/blending_job.h"
+#include "ozz/base/platform.h"
+
+namespace ozz {
+
+// Forward declaration of math structures.
+namespace math {
+struct SoaTransform;
+}
+
+namespace animation {
+
+// Forward declares types used by the blend tree.
+class Animation;
+class SamplingCache;
+class Skeleton;
+
+// Provides the pooled intermediate pose buffers used by BlendTreeJob to
+// evaluate a blend tree.
+// Buffers are allocated as a stack while the tree is traversed depth first, so
+// the number of buffers required is bounded by the sum of nodes' number of
+// children along the deepest path of the tree, rather than by the number of
+// nodes. See BlendTreeJob::RequiredBuffers().
+class BlendTreeCache {
+ public:
+  // Constructs an empty cache. The cache needs to be resized before it can be
+  // used.
+  BlendTreeCache();
+
+  // Constructs a cache of _num_buffers poses of _num_joints joints.
+  BlendTreeCache(int _num_joints, int _num_buffers);
+
+  // Deallocates cache.
+  ~BlendTreeCache();
+
+  // Resizes the cache.
+  void Resize(int _num_joints, int _num_buffers);
+
+  // Number of buffers and number of SoA joints of each buffer.
+  int num_buffers() const { return num_buffers_; }
+  int num_soa_joints() const { return num_soa_joints_; }
+
+ private:
+  // Disables copy and assignation.
+  BlendTreeCache(BlendTreeCache const&);
+  void operator=(BlendTreeCache const&);
+
+  // BlendTreeJob is allowed to use buffers and layers.
+  friend struct BlendTreeJob;
+
+  // Deallocates buffers.
+  void Deallocate();
+
+  // Number of buffers and number of SoA joints of each buffer.
+  int num_buffers_;
+  int num_soa_joints_;
+
+  // num_buffers_ * num_soa_joints_ transforms.
+  math::SoaTransform* buffers_;
+
+  // One blending layer per buffer.
+  BlendingJob::Layer* layers_;
+};
+
+// ozz::animation::BlendTreeJob evaluates a blend tree, made of sampling nodes
+// (leaves) that sample an animation, and blending nodes that blend (and add)
+// the result of their children nodes. Nodes are indexed in the job's nodes
+// range, which must be sorted such that children indices are greater than
+// their parent index. This makes the graph acyclic, even though a node can be
+// a child of multiple parents, in which case it's evaluated for each of its
+// parents. The first node is the root of the tree.
+// Children nodes that don't contribute to their parent (see
+// BlendingJob::IsLayerContributing()) are pruned, so the animations of their
+// branches aren't sampled.
+// The job does not owned any buffers (input/output) and will thus not delete
+// them during job's destruction.
+struct BlendTreeJob {
+  // Default constructor, initializes default values.
+  BlendTreeJob();
+
+  // Validates job parameters.
+  // Returns true for a valid job, false otherwise:
+  // -if skeleton, cache or output are NULL.
+  // -if nodes range is empty.
+  // -if a sampling node has a NULL animation or cache, or if its animation
+  // doesn't have the same number of tracks as the skeleton.
+  // -if a blending node child index isn't greater than its own index, or out
+  // of nodes range.
+  // -if the cache has too few buffers, or smaller buffers than the skeleton.
+  // -if output is smaller than the skeleton.
+  // -if the threshold value is less than or equal to 0.f.
+  // -if the weight epsilon value is less than 0.f.
+  bool Validate() const;
+
+  // Runs job's blend tree evaluation task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid, or if any sampling or blending
+  // task failed.
+  bool Run() const;
+
+  // Computes the number of cache buffers required to evaluate nodes, without
+  // considering weights, aka the maximum number of buffers used at the same
+  // time during tree traversal.
+  // Nodes topology must be valid.
+  int RequiredBuffers() const;
+
+  // Defines a node of the tree.
+  struct Node {
+    // Default constructor, initializes default values.
+    Node();
+
+    // Defines node types.
+    enum Type {
+      kSample,  // Samples an animation.
+      kBlend,   // Blends children nodes, and adds additive children nodes.
+    };
+    Type type;
+
+    // Weight of this node in its parent blending node. It's used as a blending
+    // layer weight, or an additive layer weight if this node is an additive
+    // child (a negative weight is then subtractive). See BlendingJob::Layer.
+    // The weight of the root node is ignored.
+    float weight;
+
+    // Optional per-joint weights of this node in its parent blending node, see
+    // BlendingJob::Layer::joint_weights and joint_indices.
+    Range<const math::SimdFloat4> joint_weights;
+    Range<const int> joint_indices;
+
+    // kSample node parameters, see SamplingJob.
+    const Animation* animation;
+    SamplingCache* sampling_cache;
+    float ratio;
+
+    // kBlend node parameters.
+    // Indices of children nodes to blend and to add, that must be greater than
+    // this node index.
+    Range<const int> children;
+    Range<const int> additive_children;
+  };
+
+  // The range of nodes of the tree, the first one being the root.
+  Range<const Node> nodes;
+
+  // The skeleton used for the bind pose, and to size buffers.
+  const Skeleton* skeleton;
+
+  // The cache providing intermediate pose buffers. It's used as a stack during
+  // evaluation, so it can be shared by multiple sequential jobs, but not by
+  // concurrent ones.
+  BlendTreeCache* cache;
+
+  // Bind pose threshold of all blending nodes, see BlendingJob::threshold.
+  float threshold;
+
+  // Weight epsilon of all blending nodes, under which children are pruned. See
+  // BlendingJob::weight_epsilon.
+  float weight_epsilon;
+
+  // Job output, sized for the skeleton at least.
+  Range<math::SoaTransform> output;
+};
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_BLEND_TREE_JOB_H_
@@ -34,6 +34,7 @@ namespace ozz {
 
 // Forward declaration of math structures.
 namespace math {
+struct SoaHalfTransform;
 struct SoaTransform;
 }
 
@@ -55,23 +56,74 @@ struct BlendingJob {
   // Default constructor, initializes default values.
   BlendingJob();
 
+  enum Constants {
+    // Maximum number of contributing sparse layers (layers and additive
+    // layers with joint_indices or transform_indices). Sparse layers indices
+    // cursors are stored on the stack while blending, so jobs don't allocate.
+    kMaxSparseLayers = 64,
+  };
+
   // Validates job parameters.
   // Returns true for a valid job, false otherwise:
   // -if layer range is not valid (can be empty though).
   // -if additive layer range is not valid (can be empty though).
   // -if any layer is not valid.
+  // -if any layer specifies both transform and half_transform, or none.
   // -if output range is not valid.
   // -if any buffer (including layers' content : transform, joint weights...) is
   // smaller than the bind pose buffer.
+  // -if any layer joint indices aren't sorted, or don't match joint weights
+  // size.
+  // -if any layer transform indices aren't sorted, are used by a non additive
+  // layer, or don't match transform and joint weights sizes.
+  // -if more than kMaxSparseLayers contributing layers are sparse.
   // -if the threshold value is less than or equal to 0.f.
+  // -if the weight epsilon value is less than 0.f.
+  // Layers that aren't contributing (see IsLayerContributing()) aren't
+  // validated, so their buffers can be left empty.
   bool Validate() const;
 
+  // Tells if a blending layer of weight _weight contributes to the output, aka
+  // if its weight is greater than weight_epsilon. Non contributing layers are
+  // skipped by the job, so this function can be used before running the job,
+  // to avoid sampling animations of non contributing layers.
+  bool IsLayerContributing(float _weight) const {
+    return _weight > weight_epsilon;
+  }
+
+  // Tells if an additive layer of weight _weight contributes to the output, aka
+  // if its absolute weight is greater than weight_epsilon.
+  bool IsAdditiveLayerContributing(float _weight) const {
+    return _weight > weight_epsilon || _weight < -weight_epsilon;
+  }
+
   // Runs job's blending task.
   // The job is validated before any operation is performed, see Validate() for
   // more details.
   // Returns false if *this job is not valid.
   bool Run() const;
 
+  // Runs job's blending task without validating the job first, for jobs that
+  // were validated once (see Validate() and ozz::PreparedJob), and whose
+  // buffers haven't changed since. As non contributing layers aren't
+  // validated, the job must also be validated again when a layer starts
+  // contributing. Validation is only asserted in debug builds, the behavior
+  // is undefined if *this job isn't valid.
+  void RunUnchecked() const;
+
+  // Runs job's blending task for at most _max_soa_joints soa joints, starting
+  // from soa joint *_cursor. *_cursor is then moved to the next soa joint to
+  // blend, and blending is complete once it reaches the bind pose size. This
+  // allows to split a large blending job in time slices, that can be
+  // interleaved with other work. Soa joints are blended independently, so
+  // output is the same as Run() once complete, as long as job's inputs don't
+  // change in the meantime.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid, if _cursor is NULL or out of
+  // range, or if _max_soa_joints is lower or equal to 0.
+  bool Resume(int* _cursor, int _max_soa_joints) const;
+
   // Defines a layer of blending input data (local space transforms) and
   // parameters (weights).
   struct Layer {
@@ -90,6 +142,14 @@ struct BlendingJob {
     // processed.
     Range<const math::SoaTransform> transform;
 
+    // Half precision layer posture, which can be specified instead of
+    // transform (but not along with it), with the same semantic. This is
+    // intended for intermediate poses of blend trees, that are usually
+    // outputted from a sampling job (see SamplingJob::half_output): each
+    // joint is converted back to single precision while it's blended, halving
+    // the memory traffic of reading layers.
+    Range<const math::SoaHalfTransform> half_transform;
+
     // Optional range [begin,end[ of blending weight for each joint in this
     // layer.
     // If both pointers are NULL (default case) then per joint weight blending
@@ -104,7 +164,39 @@ struct BlendingJob {
     // Negative weight values are considered as 0, but positive ones aren't
     // clamped because they could exceed 1.f if all layers contains valid joint
     // weights.
+    // If joint_indices is specified, joint_weights is sparse and only needs to
+    // be as big as joint_indices range.
     Range<const math::SimdFloat4> joint_weights;
+
+    // Optional range [begin,end[ of SoA joint indices, allowing to specify
+    // sparse joint weights for partial layers.
+    // If both pointers are NULL (default case), joint_weights is a dense buffer
+    // covering the whole bind pose. Otherwise each index identifies the SoA
+    // joint affected by the joint weight at the same position in
+    // joint_weights buffer, and SoA joints that aren't listed are considered
+    // as having a weight of 0.f. They are skipped entirely by the blending
+    // loop, so a layer that affects a few joints only (upper body...) is
+    // cheaper than a full layer.
+    // Indices must be sorted in strictly increasing order. Indices that are
+    // not in the range of the bind pose are ignored.
+    Range<const int> joint_indices;
+
+    // Optional range [begin,end[ of SoA joint indices, allowing to specify a
+    // sparse transform buffer for additive layers.
+    // If both pointers are NULL (default case), transform is a dense buffer
+    // covering the whole bind pose. Otherwise each index identifies the SoA
+    // joint of the transform at the same position in transform buffer, and
+    // SoA joints that aren't listed are skipped, as if their additive
+    // transform was identity. This is intended for sparse additive animations
+    // (see offline::AdditiveAnimationBuilder::BuildSparse()), which only
+    // store joints that aren't identity, so that identity joints are neither
+    // sampled nor added.
+    // joint_weights, if specified, is then sparse too and indexed like
+    // transform, so joint_indices must be NULL.
+    // Indices must be sorted in strictly increasing order. Indices that are
+    // not in the range of the bind pose are ignored. Only additive layers can
+    // be sparse.
+    Range<const int> transform_indices;
   };
 
   // The job blends the bind pose to the output when the accumulated weight of
@@ -112,12 +204,40 @@ struct BlendingJob {
   // Must be greater than 0.f.
   float threshold;
 
+  // Layers whose weight (or absolute weight for additive layers) is less than
+  // or equal to this epsilon value are skipped, as if their weight was 0.f.
+  // Must be greater than or equal to 0.f.
+  float weight_epsilon;
+
+  // Defines blending quality, which is a tradeoff between blended rotations
+  // precision and performance. Each quality runs a specialized blending kernel.
+  enum Quality {
+    // Normalizes blended rotations with a single reciprocal square root
+    // estimation. This is the cheapest and least precise mode, intended for
+    // crowds for example.
+    kFast,
+    // Normalizes blended rotations with a refined reciprocal square root
+    // estimation. This is the default mode.
+    kStandard,
+    // Normalizes blended rotations with a full precision square root and
+    // division. This is the most precise and expensive mode, intended for
+    // close-up characters or cinematics.
+    kAccurate,
+  };
+
+  // Blending quality, kStandard by default.
+  Quality quality;
+
   // Job input layers, can be empty or NULL.
   // The range of layers that must be blended.
   Range<const Layer> layers;
 
   // Job input additive layers, can be empty or NULL.
   // The range of layers that must be added to the output.
+  // When all contributing additive layers have a weight of exactly 1.f and
+  // neither joint weights nor transform indices, the job uses a fast path that
+  // concatenates them without weighting. Their rotations must be normalized
+  // then, which is the case of SamplingJob outputs.
   Range<const Layer> additive_layers;
 
   // The skeleton bind pose. The size of this buffer defines the number of
@@ -0,0 +1,77 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_CORRECTION_JOB_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_CORRECTION_JOB_H_
+
+#include "ozz/base/platform.h"
+
+namespace ozz {
+// Forward declaration of math structures.
+namespace math {
+struct SimdQuaternion;
+struct SoaTransform;
+}  // namespace math
+
+namespace animation {
+
+// ozz::animation::CorrectionJob applies local-space rotation corrections, like
+// the ones output by IK jobs, to a local-space soa pose. Each correction is
+// multiplied with its joint local-space rotation (rotation * correction).
+// Corrections are applied using soa maths, without converting soa transforms
+// back and forth, and corrections of joints sharing the same soa transform are
+// applied at once. Corrections targeting the same joint are applied in order.
+struct CorrectionJob {
+  // Validates job parameters. Returns true for a valid job, or false otherwise:
+  // -if corrections range is smaller than joints range.
+  // -if any joint index is out of output range.
+  bool Validate() const;
+
+  // Runs job's execution task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // Job input.
+
+  // Indices of the joints to correct. Joints sharing the same soa transform
+  // should be consecutive to benefit from grouping.
+  Range<const int> joints;
+
+  // Local-space correction quaternions, one per joint.
+  Range<const math::SimdQuaternion> corrections;
+
+  // Job input and output.
+
+  // Local-space soa transforms to correct.
+  Range<math::SoaTransform> output;
+};
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_CORRECTION_JOB_H_
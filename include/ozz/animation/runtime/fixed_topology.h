@@ -0,0 +1,350 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_FIXED_TOPOLOGY_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_FIXED_TOPOLOGY_H_
+
+#include <cassert>
+
+#include "ozz/animation/runtime/blending_job.h"
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/soa_float4x4.h"
+#include "ozz/base/maths/soa_transform.h"
+
+// Fixed topology jobs are specialized at compile time for a single skeleton
+// hierarchy. Joints parents and loop bounds are template constants, so that
+// the hierarchy update is fully unrolled, without reading parents nor
+// branching on them at runtime.
+// A topology is a type that defines:
+// - enum { kNumJoints = n }, the number of joints of the skeleton.
+// - static uint32_t fingerprint(), the skeleton fingerprint (see
+// Skeleton::fingerprint()), used by IsFixedTopology() to verify that a
+// skeleton matches.
+// - template <int _Joint> struct Parent, specialized for every joint with an
+// enum { kValue = parent } (or Skeleton::kNoParent).
+// Topologies are generated offline from a skeleton, see
+// offline::GenerateFixedTopology() and ozzfixed tool. Runtime jobs remain
+// the way to go for skeletons that aren't known at compile time.
+
+namespace ozz {
+namespace animation {
+
+// Tells if _skeleton matches _Topology, which must then be verified once, when
+// the skeleton is loaded, before running fixed topology jobs for it.
+template <typename _Topology>
+inline bool IsFixedTopology(const Skeleton& _skeleton) {
+  return _skeleton.num_joints() == _Topology::kNumJoints &&
+         _skeleton.fingerprint() == _Topology::fingerprint();
+}
+
+namespace internal {
+
+// Computes model-space matrix of joint _Joint from its parent _Parent one.
+template <int _Joint, int _Parent>
+struct FixedJointToModel {
+  static OZZ_INLINE void Run(const math::Float4x4* _locals,
+                             const math::Float4x4& /*_root*/,
+                             math::Float4x4* _models) {
+    _models[_Joint] = _models[_Parent] * _locals[_Joint & 3];
+  }
+};
+
+// Computes model-space matrix of root joint _Joint.
+template <int _Joint>
+struct FixedJointToModel<_Joint, Skeleton::kNoParent> {
+  static OZZ_INLINE void Run(const math::Float4x4* _locals,
+                             const math::Float4x4& _root,
+                             math::Float4x4* _models) {
+    _models[_Joint] = _root * _locals[_Joint & 3];
+  }
+};
+
+// Computes model-space matrix of joint _Joint, if it isn't a padding joint of
+// the last soa element.
+template <typename _Topology, int _Joint,
+          bool _Valid = (_Joint < _Topology::kNumJoints)>
+struct FixedJoint {
+  static OZZ_INLINE void Run(const math::Float4x4* _locals,
+                             const math::Float4x4& _root,
+                             math::Float4x4* _models) {
+    FixedJointToModel<_Joint, _Topology::template Parent<_Joint>::kValue>::Run(
+        _locals, _root, _models);
+  }
+};
+
+template <typename _Topology, int _Joint>
+struct FixedJoint<_Topology, _Joint, false> {
+  static OZZ_INLINE void Run(const math::Float4x4* /*_locals*/,
+                             const math::Float4x4& /*_root*/,
+                             math::Float4x4* /*_models*/) {}
+};
+
+// Computes model-space matrices of soa joints [_Begin, _End[. The range is
+// split in halves rather than iterated recursively, so that template
+// instantiation depth remains logarithmic with the number of joints. Joints
+// are still processed in order, parents before their children.
+template <typename _Topology, int _Begin, int _End,
+          int _Count = _End - _Begin>
+struct FixedSoaRange {
+  static OZZ_INLINE void Run(const math::SoaTransform* _input,
+                             const math::Float4x4& _root,
+                             math::Float4x4* _models) {
+    FixedSoaRange<_Topology, _Begin, (_Begin + _End) / 2>::Run(_input, _root,
+                                                               _models);
+    FixedSoaRange<_Topology, (_Begin + _End) / 2, _End>::Run(_input, _root,
+                                                             _models);
+  }
+};
+
+template <typename _Topology, int _Begin, int _End>
+struct FixedSoaRange<_Topology, _Begin, _End, 0> {
+  static OZZ_INLINE void Run(const math::SoaTransform* /*_input*/,
+                             const math::Float4x4& /*_root*/,
+                             math::Float4x4* /*_models*/) {}
+};
+
+template <typename _Topology, int _Begin, int _End>
+struct FixedSoaRange<_Topology, _Begin, _End, 1> {
+  static OZZ_INLINE void Run(const math::SoaTransform* _input,
+                             const math::Float4x4& _root,
+                             math::Float4x4* _models) {
+    // Builds the 4 aos local matrices of the soa joint.
+    const math::SoaTransform& transform = _input[_Begin];
+    const math::SoaFloat4x4 local_soa_matrices = math::SoaFloat4x4::FromAffine(
+        transform.translation, transform.rotation, transform.scale);
+    math::Float4x4 local_aos_matrices[4];
+    math::Transpose16x16(&local_soa_matrices.cols[0].x,
+                         local_aos_matrices->cols);
+
+    FixedJoint<_Topology, _Begin * 4 + 0>::Run(local_aos_matrices, _root,
+                                               _models);
+    FixedJoint<_Topology, _Begin * 4 + 1>::Run(local_aos_matrices, _root,
+                                               _models);
+    FixedJoint<_Topology, _Begin * 4 + 2>::Run(local_aos_matrices, _root,
+                                               _models);
+    FixedJoint<_Topology, _Begin * 4 + 3>::Run(local_aos_matrices, _root,
+                                               _models);
+  }
+};
+}  // namespace internal
+
+// LocalToModelJob specialized for _Topology. It converts the whole hierarchy
+// of local-space soa transforms to model-space matrices, like a
+// LocalToModelJob with default parameters does.
+template <typename _Topology>
+struct FixedLocalToModelJob {
+  // Number of soa joints of _Topology.
+  enum { kNumSoaJoints = (_Topology::kNumJoints + 3) / 4 };
+
+  // Default constructor, initializes default values.
+  FixedLocalToModelJob() : root(NULL) {}
+
+  // Validates job parameters. Returns true for a valid job, or false if input
+  // or output ranges are smaller than the topology.
+  bool Validate() const {
+    bool valid = true;
+    valid &= input.begin != NULL && input.end >= input.begin + kNumSoaJoints;
+    valid &= output.begin != NULL &&
+             output.end >= output.begin + _Topology::kNumJoints;
+    return valid;
+  }
+
+  // Runs job's local-to-model task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const {
+    if (!Validate()) {
+      return false;
+    }
+    RunUnchecked();
+    return true;
+  }
+
+  // Runs job's local-to-model task without validating the job first, see
+  // LocalToModelJob::RunUnchecked().
+  void RunUnchecked() const {
+    assert(Validate() && "Invalid job, see FixedLocalToModelJob::Validate().");
+    const math::Float4x4 identity = math::Float4x4::identity();
+    internal::FixedSoaRange<_Topology, 0, kNumSoaJoints>::Run(
+        input.begin, root ? *root : identity, output.begin);
+  }
+
+  // Optional root matrix, identity if NULL. See LocalToModelJob::root.
+  const math::Float4x4* root;
+
+  // Job input, local-space soa transforms of all _Topology joints.
+  Range<const math::SoaTransform> input;
+
+  // Job output, model-space matrices of all _Topology joints.
+  Range<math::Float4x4> output;
+};
+
+// BlendingJob specialized for _Topology. It blends full body layers, whose
+// weights are global, with the bind pose when their accumulated weight is less
+// than the threshold. The number of soa joints to blend is a compile time
+// constant. Output matches a BlendingJob of standard quality.
+// Partial, half precision and additive layers require a BlendingJob.
+template <typename _Topology>
+struct FixedBlendingJob {
+  // Number of soa joints of _Topology.
+  enum { kNumSoaJoints = (_Topology::kNumJoints + 3) / 4 };
+
+  // Default constructor, initializes default values.
+  FixedBlendingJob() : threshold(.1f) {}
+
+  // Validates job parameters. Returns true for a valid job, or false:
+  // -if bind pose or output ranges are smaller than the topology.
+  // -if any contributing layer transform range is smaller than the topology,
+  // or if it specifies half precision transforms, joint weights, joint indices
+  // or transform indices.
+  // -if the threshold value is less than or equal to 0.f.
+  bool Validate() const {
+    bool valid = threshold > 0.f;
+    valid &= bind_pose.begin != NULL &&
+             bind_pose.end >= bind_pose.begin + kNumSoaJoints;
+    valid &=
+        output.begin != NULL && output.end >= output.begin + kNumSoaJoints;
+    valid &= layers.end >= layers.begin;
+    for (const BlendingJob::Layer* layer = layers.begin;
+         valid && layer < layers.end; ++layer) {
+      if (layer->weight <= 0.f) {
+        continue;
+      }
+      valid &= layer->transform.begin != NULL &&
+               layer->transform.end >= layer->transform.begin + kNumSoaJoints;
+      valid &= layer->half_transform.begin == NULL;
+      valid &= layer->joint_weights.begin == NULL;
+      valid &= layer->joint_indices.begin == NULL;
+      valid &= layer->transform_indices.begin == NULL;
+    }
+    return valid;
+  }
+
+  // Runs job's blending task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const {
+    if (!Validate()) {
+      return false;
+    }
+    RunUnchecked();
+    return true;
+  }
+
+  // Runs job's blending task without validating the job first, see
+  // BlendingJob::RunUnchecked().
+  void RunUnchecked() const {
+    assert(Validate() && "Invalid job, see FixedBlendingJob::Validate().");
+
+    // Accumulates global weights of contributing layers. The bind pose fills
+    // up the accumulated weight to the threshold.
+    float accumulated_weight = 0.f;
+    for (const BlendingJob::Layer* layer = layers.begin; layer < layers.end;
+         ++layer) {
+      accumulated_weight += layer->weight > 0.f ? layer->weight : 0.f;
+    }
+    const float bp_weight = threshold - accumulated_weight;
+    const math::SimdFloat4 simd_bp_weight = math::simd_float4::Load1(bp_weight);
+    const math::SimdFloat4 ratio = math::simd_float4::Load1(
+        accumulated_weight == 0.f
+            ? 1.f
+            : 1.f / (bp_weight > 0.f ? threshold : accumulated_weight));
+
+    // Each soa joint is read once from every layer, blended, and written once
+    // to the output.
+    for (int i = 0; i < kNumSoaJoints; ++i) {
+      math::SoaTransform blended = bind_pose.begin[i];
+      bool first_pass = true;
+      for (const BlendingJob::Layer* layer = layers.begin; layer < layers.end;
+           ++layer) {
+        if (layer->weight > 0.f) {
+          Accumulate(layer->transform.begin[i],
+                     math::simd_float4::Load1(layer->weight), first_pass,
+                     &blended);
+          first_pass = false;
+        }
+      }
+      if (!first_pass && bp_weight > 0.f) {
+        Accumulate(bind_pose.begin[i], simd_bp_weight, false, &blended);
+      }
+
+      // Normalizes output.
+      blended.translation = blended.translation * ratio;
+      blended.rotation = math::NormalizeEstNR<1>(blended.rotation);
+      blended.scale = blended.scale * ratio;
+      output.begin[i] = blended;
+    }
+  }
+
+  // The job blends the bind pose to the output when the accumulated weight of
+  // all layers is less than this threshold value. Must be greater than 0.f.
+  float threshold;
+
+  // Job input layers, can be empty or NULL. Layers whose weight is less than
+  // or equal to 0.f are skipped.
+  Range<const BlendingJob::Layer> layers;
+
+  // The skeleton bind pose, of _Topology size.
+  Range<const math::SoaTransform> bind_pose;
+
+  // Job output, of _Topology size.
+  Range<math::SoaTransform> output;
+
+ private:
+  // Accumulates _src weighted by _weight to _blended, which is initialized
+  // instead if _first is true.
+  static OZZ_INLINE void Accumulate(const math::SoaTransform& _src,
+                                    math::SimdFloat4 _weight, bool _first,
+                                    math::SoaTransform* _blended) {
+    if (_first) {
+      _blended->translation = _src.translation * _weight;
+      _blended->rotation = _src.rotation * _weight;
+      _blended->scale = _src.scale * _weight;
+      return;
+    }
+    _blended->translation = _blended->translation + _src.translation * _weight;
+    // Negates opposed quaternions to take the shortest path.
+    const math::SoaQuaternion& rot = _blended->rotation;
+    const math::SimdFloat4 dot = rot.x * _src.rotation.x +
+                                 rot.y * _src.rotation.y +
+                                 rot.z * _src.rotation.z +
+                                 rot.w * _src.rotation.w;
+    const math::SimdInt4 sign = math::Sign(dot);
+    const math::SoaQuaternion rotation = {
+        math::Xor(_src.rotation.x, sign), math::Xor(_src.rotation.y, sign),
+        math::Xor(_src.rotation.z, sign), math::Xor(_src.rotation.w, sign)};
+    _blended->rotation = _blended->rotation + rotation * _weight;
+    _blended->scale = _blended->scale + _src.scale * _weight;
+  }
+};
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_FIXED_TOPOLOGY_H_
@@ -0,0 +1,108 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_IK_AIM_CHAIN_JOB_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_IK_AIM_CHAIN_JOB_H_
+
+#include "ozz/base/platform.h"
+
+#include "ozz/base/maths/simd_math.h"
+
+namespace ozz {
+// Forward declaration of math structures.
+namespace math {
+struct SimdQuaternion;
+}
+
+namespace animation {
+
+// ozz::animation::IKAimChainJob distributes an aim IK over a chain of joints,
+// like the spine, neck and head of a character looking at a target. It runs
+// ozz::animation::IKAimJob on each joint of the chain, from the child-iest
+// (usually the head) up to its ancestors. Forward vector and offset of each
+// joint are deduced from the correction computed for its child, so model-space
+// matrices don't need to be updated (with LocalToModelJob) between joints.
+// Weights allow to distribute the correction along the chain: if the first
+// joint has a weight lower than 1, its ancestors will complete the rotation.
+// The last joint should be given a weight of 1 to ensure target is aimed.
+struct IKAimChainJob {
+  // Default constructor, initializes default values.
+  IKAimChainJob();
+
+  // Validates job parameters. Returns true for a valid job, or false otherwise:
+  // -if ups, weights or joint_corrections ranges are smaller than joints range.
+  // -if any joint matrix pointer is NULL.
+  // -if forward isn't normalized.
+  bool Validate() const;
+
+  // Runs job's execution task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // Job input.
+
+  // Target position to aim at, in model-space.
+  math::SimdFloat4 target;
+
+  // First joint forward axis, in its local-space, to be aimed at target
+  // position. This vector shall be normalized. Default is x axis.
+  math::SimdFloat4 forward;
+
+  // Offset position from the first joint in its local-space, that will aim at
+  // target.
+  math::SimdFloat4 offset;
+
+  // Pole vector, in model-space, shared by all joints. See
+  // IKAimJob::pole_vector.
+  math::SimdFloat4 pole_vector;
+
+  // Model-space matrices of the chain joints, ordered from child to parent.
+  // Joints must be ancestors, but don't need to be direct parent and child.
+  Range<const math::Float4x4* const> joints;
+
+  // Per joint up axis, in each joint local-space. See IKAimJob::up.
+  Range<const math::SimdFloat4> ups;
+
+  // Per joint weight, clamped in range [0,1]. See IKAimJob::weight.
+  Range<const float> weights;
+
+  // Job output.
+
+  // Per joint local-space correction quaternions. They need to be multiplied
+  // with joints local-space quaternions.
+  Range<math::SimdQuaternion> joint_corrections;
+
+  // Optional boolean output value, set to true if the last joint of the chain
+  // could aim the target. See IKAimJob::reached.
+  bool* reached;
+};
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_IK_AIM_CHAIN_JOB_H_
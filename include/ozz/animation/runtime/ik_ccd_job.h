@@ -0,0 +1,110 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_IK_CCD_JOB_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_IK_CCD_JOB_H_
+
+#include "ozz/base/platform.h"
+
+#include "ozz/base/maths/simd_math.h"
+
+namespace ozz {
+// Forward declaration of math structures.
+namespace math {
+struct SimdQuaternion;
+}
+
+namespace animation {
+
+// ozz::animation::IKCCDJob performs inverse kinematic on a chain of any number
+// of joints (tails, tentacles, spines...), using the iterative Cyclic
+// Coordinate Descent algorithm. Each iteration rotates chain joints, from the
+// child-iest to the parent-iest, so the end joint gets closer to the target.
+// Iterations stop as soon as the end joint is closer to the target than the
+// tolerance distance, or when the maximum number of iterations is reached.
+// The job works on model-space matrices and outputs local-space correction
+// quaternions, the same way as ozz::animation::IKTwoBoneJob and
+// ozz::animation::IKAimJob. Model-space matrices don't need to be updated
+// between iterations, as the job internally propagates corrections down
+// the chain.
+// Joints are expected to have uniform scales.
+struct IKCCDJob {
+  // Default constructor, initializes default values.
+  IKCCDJob();
+
+  // Validates job parameters. Returns true for a valid job, or false otherwise:
+  // -if end joint matrix pointer is NULL.
+  // -if joint_corrections range is smaller than joints range.
+  // -if any joint matrix pointer is NULL.
+  bool Validate() const;
+
+  // Runs job's execution task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // Job input.
+
+  // Target position to reach, in model-space.
+  math::SimdFloat4 target;
+
+  // Distance to the target below which the target is considered reached, and
+  // iterations are stopped. Default is 1e-3.
+  float tolerance;
+
+  // Maximum number of iterations. Each iteration updates all joints of the
+  // chain once. Default is 16.
+  int max_iterations;
+
+  // Weight given to the IK correction clamped in range [0,1]. This allows to
+  // blend / interpolate from no IK applied (0 weight) to full IK (1).
+  float weight;
+
+  // Model-space matrix of the end joint of the chain, aka the one that should
+  // reach the target.
+  const math::Float4x4* end_joint;
+
+  // Model-space matrices of the chain joints that are rotated by the IK,
+  // ordered from child to parent (the first one being end joint ancestor).
+  // Joints must be ancestors, but don't need to be direct parent and child.
+  Range<const math::Float4x4* const> joints;
+
+  // Job output.
+
+  // Per joint local-space correction quaternions. They need to be multiplied
+  // with joints local-space quaternions.
+  Range<math::SimdQuaternion> joint_corrections;
+
+  // Optional boolean output value, set to true if end joint is closer to the
+  // target than the tolerance distance.
+  bool* reached;
+};
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_IK_CCD_JOB_H_
@@ -0,0 +1,108 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_IK_TWO_BONE_BATCH_JOB_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_IK_TWO_BONE_BATCH_JOB_H_
+
+#include "ozz/base/platform.h"
+
+#include "ozz/base/maths/simd_math.h"
+
+namespace ozz {
+// Forward declaration of math structures.
+namespace math {
+struct SimdQuaternion;
+}
+
+namespace animation {
+
+// ozz::animation::IKTwoBoneBatchJob performs two bone inverse kinematic on
+// many three joints chains, like foot IK of every character of a crowd. It
+// computes the same corrections as ozz::animation::IKTwoBoneJob, see its
+// documentation for more details. Chains are processed four by four: matrices
+// dependent setup is computed per chain, but the solver itself (soften target,
+// mid joint angle, start joint rotation and weighting) runs on four chains at
+// once using soa maths.
+// All chains share the same middle joint axis and soften ratio, as they are
+// usually set per skeleton.
+struct IKTwoBoneBatchJob {
+  // Constructor, initializes default values.
+  IKTwoBoneBatchJob();
+
+  // Validates job parameters. Returns true for a valid job, or false otherwise:
+  // -if any input or output range is smaller than the number of chains (aka
+  // targets count). Optional ranges are only tested when not empty.
+  // -if any joint matrix pointer is NULL.
+  // -if mid_axis isn't normalized.
+  bool Validate() const;
+
+  // Runs job's execution task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // Job input.
+
+  // Normalized middle joint rotation axis, in middle joint local-space, shared
+  // by all chains. See IKTwoBoneJob::mid_axis.
+  math::SimdFloat4 mid_axis;
+
+  // Soften ratio, shared by all chains. See IKTwoBoneJob::soften.
+  float soften;
+
+  // Per chain model-space target positions. The number of targets defines the
+  // number of chains to solve.
+  Range<const math::SimdFloat4> targets;
+
+  // Per chain model-space pole vectors.
+  Range<const math::SimdFloat4> pole_vectors;
+
+  // Optional per chain twist angles. Default is 0.
+  Range<const float> twist_angles;
+
+  // Optional per chain weights, clamped in range [0,1]. Default is 1.
+  Range<const float> weights;
+
+  // Per chain model-space matrices of the start, middle and end joints.
+  Range<const math::Float4x4* const> start_joints;
+  Range<const math::Float4x4* const> mid_joints;
+  Range<const math::Float4x4* const> end_joints;
+
+  // Job output.
+
+  // Per chain local-space corrections to apply to start and middle joints.
+  Range<math::SimdQuaternion> start_joint_corrections;
+  Range<math::SimdQuaternion> mid_joint_corrections;
+
+  // Optional per chain reached output. See IKTwoBoneJob::reached.
+  Range<bool> reached;
+};
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_IK_TWO_BONE_BATCH_JOB_H_
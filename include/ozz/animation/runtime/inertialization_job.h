@@ -0,0 +1,130 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_INERTIALIZATION_JOB_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_INERTIALIZATION_JOB_H_
+
+#include "ozz/base/maths/soa_float.h"
+#include "ozz/base/platform.h"
+
+namespace ozz {
+// Forward declaration of math structures.
+namespace math {
+struct SoaTransform;
+}  // namespace math
+
+namespace animation {
+
+// Inertialization state of 4 joints, the ones of a soa transform. It's
+// captured at transition time, and must be kept until the transition is over,
+// one per soa joint.
+struct SoaInertializationState {
+  // Translation and scale offsets unit directions, and rotation offset axis.
+  math::SoaFloat3 translation_axis;
+  math::SoaFloat3 rotation_axis;
+  math::SoaFloat3 scale_axis;
+
+  // Initial translation, rotation (angle in radian) and scale offsets
+  // magnitudes, in this order.
+  math::SimdFloat4 offsets[3];
+
+  // Initial offsets velocities along their axis, per second.
+  math::SimdFloat4 velocities[3];
+
+  // Durations of offsets decay, in seconds. Shorter than the transition
+  // duration for offsets that would otherwise overshoot.
+  math::SimdFloat4 durations[3];
+
+  // Time elapsed since the transition started, in seconds.
+  float elapsed;
+};
+
+// ozz::animation::InertializationJob transitions from a source animation to a
+// target one without sampling the source animation during the transition.
+// Instead of cross-fading both animations, the offset between the last source
+// pose and the target pose (along with source velocity) is captured when the
+// transition starts. This offset is then added to the target pose, and decays
+// to zero with a quintic polynomial whose initial value, velocity and
+// acceleration match the source motion. Each joint translation, rotation and
+// scale offset decays along a constant direction (or axis), 4 joints at a time.
+// Output is a local-space soa pose, like the ones sampled or blended by
+// SamplingJob and BlendingJob, and usually converted to model-space by
+// LocalToModelJob afterward.
+struct InertializationJob {
+  // Default constructor, initializes default values.
+  InertializationJob();
+
+  // Validates job parameters. Returns true for a valid job, or false otherwise:
+  // -if dt is negative.
+  // -if states range is smaller than output range.
+  // -when capturing, if duration or source_dt isn't strictly positive, or if
+  // source or previous_source range is smaller than output range.
+  bool Validate() const;
+
+  // Runs job's execution task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // Job input.
+
+  // Time step in seconds since the last update. At capture, it's the time
+  // between the last source pose and the target pose.
+  float dt;
+
+  // Captures the transition into states, from source, previous_source and the
+  // target pose (output input value). Must be set the first frame of a
+  // transition only.
+  bool capture;
+
+  // Duration of the transition in seconds, used at capture only. Default
+  // value is .2.
+  float duration;
+
+  // Last pose of the source animation (usually the pose of the previous
+  // frame), and the pose before, source_dt seconds earlier. These are used at
+  // capture only, to compute source offsets and velocities.
+  Range<const math::SoaTransform> source;
+  Range<const math::SoaTransform> previous_source;
+  float source_dt;
+
+  // Job input and output.
+
+  // Transition states, one per soa joint. They are initialized by capture,
+  // which must happen before any other update.
+  Range<SoaInertializationState> states;
+
+  // Local-space target pose, sampled (or blended) from the target animation.
+  // Decayed offsets are added to it. Once the transition is over, the pose
+  // isn't modified anymore.
+  Range<math::SoaTransform> output;
+};
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_INERTIALIZATION_JOB_H_
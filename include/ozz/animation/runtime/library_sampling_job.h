@@ -0,0 +1,91 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_LIBRARY_SAMPLING_JOB_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_LIBRARY_SAMPLING_JOB_H_
+
+#include "ozz/base/platform.h"
+
+namespace ozz {
+
+// Forward declaration of math structures.
+namespace math {
+struct SoaTransform;
+}
+
+namespace animation {
+
+// Forward declares the library type to sample.
+class AnimationLibrary;
+
+// Samples a clip of an AnimationLibrary at a given time ratio in the unit
+// interval [0,1]. Every track channel is sampled with a binary search of the
+// keys surrounding the sampled time, so no cache is required: the job is
+// stateless, and its cost is logarithmic in the number of keys of each channel.
+// Translations and scales are linearly interpolated, rotations are nlerp-ed.
+// The job does not owned the buffers (in/output) and will thus not delete
+// them during job's destruction.
+struct LibrarySamplingJob {
+  // Default constructor, initializes default values.
+  LibrarySamplingJob();
+
+  // Validates job parameters. Returns true for a valid job, or false otherwise:
+  // -if library pointer is NULL.
+  // -if clip isn't a valid clip index of the library.
+  // -if output range is smaller than the clip's number of soa tracks.
+  bool Validate() const;
+
+  // Runs job's sampling task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // Time ratio in the unit interval [0,1] used to sample the clip (where 0 is
+  // the beginning of the clip, 1 is the end). It should be computed as the
+  // current time in the clip, divided by clip duration.
+  // This ratio is clamped before job execution in order to resolves any
+  // approximation issue on range bounds.
+  float ratio;
+
+  // The library the clip to sample belongs to.
+  const AnimationLibrary* library;
+
+  // Index of the clip to sample, see AnimationLibrary::FindClip().
+  int clip;
+
+  // Job output.
+  // The output range to be filled with sampled joints during job execution.
+  // Lanes of the last soa transform that have no track are set to identity.
+  // If there are more soa transforms in the output range, they are left
+  // unchanged.
+  Range<ozz::math::SoaTransform> output;
+};
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_LIBRARY_SAMPLING_JOB_H_
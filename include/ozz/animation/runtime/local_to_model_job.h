@@ -38,6 +38,8 @@ struct SoaTransform;
 }
 namespace math {
 struct Float4x4;
+struct Float3x4;
+struct SoaFloat4x4;
 }
 
 namespace animation {
@@ -54,6 +56,9 @@ class Skeleton;
 // ordered like skeleton's joints. Output are matrices, because the combination
 // of affine transformations can contain shearing or complex transformation
 // that cannot be represented as Transform object.
+// Independent subtrees of the hierarchy can be updated concurrently by multiple
+// jobs, using "from" and "to" parameters. See GetIndependentSubtrees() from
+// skeleton_utils.h.
 struct LocalToModelJob {
   // Default constructor, initializes default values.
   LocalToModelJob();
@@ -64,6 +69,20 @@ struct LocalToModelJob {
   // Note that this input has a SoA format.
   // -if the size of of the output is smaller than the skeleton's number of
   // joints.
+  // -if soa_output is used and its size is smaller than the skeleton's number
+  // of soa joints, or if from, to or from_excluded parameters aren't set to
+  // their default values.
+  // -if affine_output is used and its size is smaller than the skeleton's
+  // number of joints.
+  // -if skinning_output is used with soa_output, or if skinning_output or
+  // inverse_bind_poses are smaller than the skeleton's number of joints (or
+  // than joint_remaps size if it's used), or if joint_remaps isn't sorted or
+  // contains invalid joint indices.
+  // -if dirty_joints is used and it isn't sorted in strictly increasing
+  // order, contains invalid joint indices, or if soa_output is used, or from,
+  // to or from_excluded parameters aren't set to their default values.
+  // -if required_joints is used with soa_output, or if it's smaller than the
+  // skeleton's number of joints.
   bool Validate() const;
 
   // Runs job's local-to-model task.
@@ -72,6 +91,12 @@ struct LocalToModelJob {
   // Returns false if job is not valid. See Validate() function.
   bool Run() const;
 
+  // Runs job's local-to-model task without validating the job first, for jobs
+  // that were validated once (see Validate() and ozz::PreparedJob), and whose
+  // skeleton and buffers haven't changed since. Validation is only asserted in
+  // debug builds, the behavior is undefined if *this job isn't valid.
+  void RunUnchecked() const;
+
   // Job input.
 
   // The Skeleton object describing the joint hierarchy used for local to
@@ -109,10 +134,64 @@ struct LocalToModelJob {
   // The input range that store local transforms.
   Range<const ozz::math::SoaTransform> input;
 
+  // Optional range of joints whose local transform was modified since last
+  // update (after ik corrections for example). When set, only dirty joints and
+  // their descendants are updated, in a single pass over the union of their
+  // subtrees. This replaces "from", "to" and "from_excluded" parameters, which
+  // must keep their default values. Joint indices must be sorted in strictly
+  // increasing order, and parents of dirty joints must be valid matrices of
+  // the output.
+  Range<const int> dirty_joints;
+
+  // Optional range of flags, one per skeleton joint, set to true for joints
+  // whose model-space matrix is required. Other joints are skipped, and their
+  // outputs (including skinning ones) aren't written. Required joints
+  // ancestors must also be required. This allows to skip leaf joints that no
+  // mesh uses for example, see GetRequiredJoints() from skeleton_utils.h.
+  // Not supported with soa_output.
+  Range<const bool> required_joints;
+
   // Job output.
 
   // The output range to be filled with model-space matrices.
+  // Not used if soa_output or affine_output is set.
   Range<ozz::math::Float4x4> output;
+
+  // Optional output range to be filled with model-space 3x4 affine matrices,
+  // ordered like skeleton's joints. When set, output isn't used and can be
+  // empty. 3x4 matrices use 25% less memory than 4x4 ones, and can be uploaded
+  // as is for gpu skinning. Joint "from" parent must be a valid matrix of this
+  // range, as for output.
+  // See ozz/base/maths/simd_affine.h to convert them to and from Float4x4, or
+  // to dual quaternions.
+  Range<ozz::math::Float3x4> affine_output;
+
+  // Optional output range to be filled with model-space matrices in soa format,
+  // ordered like skeleton's joints (see SoaTransform input). When set, output
+  // aren't used and can be empty, and the whole hierarchy is updated.
+  // Joints are processed four at a time in soa format when they share the
+  // same parent, which avoids transposing them to aos format. This is common
+  // for skeletons with many siblings joints (fingers, toes, cloth joints...).
+  Range<ozz::math::SoaFloat4x4> soa_output;
+
+  // Optional output range to be filled with skinning matrices, computed in the
+  // same pass as model-space matrices by multiplying them with
+  // inverse_bind_poses. This avoids reading back the whole model-space output
+  // to build skinning palette. Model-space output is still required, as it's
+  // used to compute children matrices. Only skinning matrices of updated
+  // joints are written. Not supported with soa_output.
+  // If joint_remaps is empty, skinning matrices and inverse_bind_poses are
+  // ordered like skeleton's joints. Otherwise skinning_output[i] is computed
+  // for skeleton joint joint_remaps[i], using inverse_bind_poses[i].
+  Range<ozz::math::Float4x4> skinning_output;
+
+  // Inverse bind pose matrices used to compute skinning_output.
+  Range<const ozz::math::Float4x4> inverse_bind_poses;
+
+  // Optional remapping table from skinning_output indices to skeleton joints,
+  // sorted in increasing order. This is usually the mesh's joint remapping
+  // table, which allows a mesh to use only a subset of the skeleton joints.
+  Range<const uint16_t> joint_remaps;
 };
 }  // namespace animation
 }  // namespace ozz
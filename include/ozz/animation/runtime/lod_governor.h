@@ -0,0 +1,173 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_LOD_GOVERNOR_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_LOD_GOVERNOR_H_
+
+#include "ozz/base/platform.h"
+
+namespace ozz {
+namespace animation {
+
+// Forward declares the skeleton type.
+class Skeleton;
+
+// Fits the animation update of a set of instances (aka characters) to a per
+// frame time budget, by degrading their quality gracefully instead of
+// overrunning the frame. Quality is described by a list of levels, from the
+// best and most expensive one to the cheapest one. A level selects a skeleton
+// LOD (and the matching SamplingJob mask and LocalToModelJob joints range, see
+// Skeleton::lod_num_joints() and GetLODSamplingMask()), an update interval,
+// and a user defined skinning path.
+// The governor keeps an estimated cost of updating an instance at each level,
+// refined with measured costs (see Measure()). These can come from the
+// application timers, or from ozz::profile zones callbacks (see
+// ozz/base/profile.h). Every frame, Run() decides each instance level:
+// instances are degraded one level at a time, lowest priority ones first, until
+// the estimated frame cost fits the budget. An instance of priority p is
+// degraded a level every time an instance of priority 1 is degraded p levels,
+// and instances of priority 0 are degraded first to the cheapest level.
+class LODGovernor {
+ public:
+  // Defines a quality level.
+  struct Level {
+    // Skeleton level of detail, in range [0, Skeleton::num_lods()[.
+    int lod;
+
+    // Instances are updated every update_interval frames, which must be at
+    // least 1.
+    int update_interval;
+
+    // User defined skinning path (like a maximum number of influences, or a
+    // cpu/gpu switch), returned as is by decisions.
+    int skinning;
+  };
+
+  // Defines the decision taken for an instance by Run().
+  struct Decision {
+    // Selected level index.
+    int level;
+
+    // Skeleton LOD of the level.
+    int lod;
+
+    // Number of joints to update with LocalToModelJob (see
+    // Skeleton::lod_num_joints()), aka LocalToModelJob::to + 1.
+    int num_joints;
+
+    // SamplingJob mask of the level LOD (see SamplingJob::mask).
+    Range<const uint8_t> mask;
+
+    // Skinning path of the level.
+    int skinning;
+
+    // Tells if instance must be updated this frame, according to level update
+    // interval. Updates of instances sharing the same interval are spread
+    // across frames. Skipped instances should accumulate elapsed time.
+    bool update;
+  };
+
+  // Constructs an uninitialized governor. Initialize() must be called before
+  // the governor can be used.
+  LODGovernor();
+
+  // Deallocates governor data.
+  ~LODGovernor();
+
+  // Initializes the governor with _levels of _skeleton, ordered from the most
+  // expensive to the cheapest. _initial_cost is the estimated cost (in
+  // seconds) of updating an instance at LOD 0, other levels initial cost being
+  // estimated from their number of joints.
+  // Returns false if _levels is empty, or if a level is invalid.
+  bool Initialize(const Skeleton& _skeleton, const Range<const Level>& _levels,
+                  float _initial_cost);
+
+  // Updates the estimated cost of updating an instance at _level with a
+  // measure of _count instances updates that lasted _seconds.
+  // Returns false if _level is invalid or _count is not strictly positive.
+  bool Measure(int _level, int _count, float _seconds);
+
+  // Decides the level of every instance, whose priority is given by
+  // _priorities, and outputs decisions to _decisions. Advances the frame
+  // counter used to spread instances updates.
+  // Returns false if the governor isn't initialized, if _decisions is smaller
+  // than _priorities, or if a priority is negative.
+  bool Run(const Range<const float>& _priorities,
+           const Range<Decision>& _decisions);
+
+  // Per frame time budget, in seconds. Default value is 1/500s.
+  float budget;
+
+  // Weight of new measures in the estimated costs, in range [0,1]. Default
+  // value is .1.
+  float smoothing;
+
+  // Gets the number of levels.
+  int num_levels() const { return num_levels_; }
+
+  // Gets the estimated cost (in seconds) of updating an instance at _level.
+  float cost(int _level) const;
+
+  // Gets the estimated frame cost of the decisions taken by last Run(), which
+  // can exceed budget if all instances are at the cheapest level already.
+  float planned_cost() const { return planned_cost_; }
+
+ private:
+  // Disables copy and assignation.
+  LODGovernor(LODGovernor const&);
+  void operator=(LODGovernor const&);
+
+  // Deallocates all levels.
+  void Deallocate();
+
+  // Computes the estimated frame cost if every instance of priority p is at
+  // level floor(_threshold / p). Outputs levels to _decisions if not NULL.
+  float Plan(const Range<const float>& _priorities, float _threshold,
+             Decision* _decisions) const;
+
+  // Describes a level and its estimated cost.
+  struct Entry {
+    Level level;
+    int num_joints;
+    float cost;
+  };
+
+  // Levels, and their sampling masks, mask_size bytes each.
+  int num_levels_;
+  Entry* entries_;
+  uint8_t* masks_;
+  int mask_size_;
+
+  // Incremented on every Run().
+  unsigned int frame_;
+
+  // Estimated cost of last Run() decisions.
+  float planned_cost_;
+};
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_LOD_GOVERNOR_H_
@@ -0,0 +1,105 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_MEMORY_USAGE_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_MEMORY_USAGE_H_
+
+#include "ozz/animation/runtime/track.h"
+#include "ozz/base/platform.h"
+
+#include <cstddef>
+
+namespace ozz {
+namespace animation {
+
+// Forward declares runtime types.
+class Animation;
+class AnimationInstance;
+class SamplingCache;
+class Skeleton;
+
+// Reports the memory used by a runtime object, in bytes, split between key
+// data and metadata. Key data is what scales with the content (animation keys
+// and tangents, track keyframes, skeleton bind poses, cache and job buffers),
+// metadata is everything else (object itself, names, hierarchy, quantization
+// ranges, seek points, bounds...). Memory usages can be accumulated, to
+// budget a whole set of objects.
+struct MemoryUsage {
+  MemoryUsage() : data(0), metadata(0) {}
+
+  // Key data size in bytes.
+  size_t data;
+
+  // Metadata size in bytes.
+  size_t metadata;
+
+  // Gets overall size in bytes.
+  size_t total() const { return data + metadata; }
+
+  MemoryUsage& operator+=(const MemoryUsage& _other) {
+    data += _other.data;
+    metadata += _other.metadata;
+    return *this;
+  }
+};
+
+// Gets the memory used by _animation. Total is Animation::size() plus the
+// animation name.
+MemoryUsage GetMemoryUsage(const Animation& _animation);
+
+// Gets the estimated memory used by _skeleton. Joint names are counted as
+// metadata.
+MemoryUsage GetMemoryUsage(const Skeleton& _skeleton);
+
+// Gets the memory used by _cache, which is allocated for
+// SamplingCache::max_tracks() tracks in SamplingCache::mode().
+MemoryUsage GetMemoryUsage(const SamplingCache& _cache);
+
+// Gets the memory used by _instance single memory block, see
+// AnimationInstance::size().
+MemoryUsage GetMemoryUsage(const AnimationInstance& _instance);
+
+// Gets the memory used by tracks. Total is Track::size() plus the track name.
+MemoryUsage GetMemoryUsage(const FloatTrack& _track);
+MemoryUsage GetMemoryUsage(const Float2Track& _track);
+MemoryUsage GetMemoryUsage(const Float3Track& _track);
+MemoryUsage GetMemoryUsage(const Float4Track& _track);
+MemoryUsage GetMemoryUsage(const QuaternionTrack& _track);
+
+// Computes the working set required to update a character of _skeleton
+// animated by _num_layers layers of _animation, before allocating anything.
+// It includes, for every layer, a SamplingCache and a local-space pose
+// sampling output, plus a blended local-space pose and model-space matrices
+// (see BlendingJob and LocalToModelJob). The working set of a single layer
+// doesn't include blending output, as sampling output can be converted to
+// model-space directly. Returns an empty usage if _num_layers is less than 1.
+MemoryUsage ComputeWorkingSetUsage(const Skeleton& _skeleton,
+                                   const Animation& _animation,
+                                   int _num_layers);
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_MEMORY_USAGE_H_
@@ -0,0 +1,99 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_MIRROR_JOB_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_MIRROR_JOB_H_
+
+#include "ozz/base/platform.h"
+
+namespace ozz {
+// Forward declaration of math structures.
+namespace math {
+struct SoaTransform;
+}
+
+namespace animation {
+
+// Mirrors a local-space pose with respect to a model-space plane, so a single
+// animation can be played on both sides (like left and right foot locomotion
+// clips). Every output joint receives the transform of its mirror joint (see
+// BuildJointMirror()), reflected by the plane. Joints on the plane (spine,
+// head...) are their own mirror.
+// Reflection is computed in local-space, which is exact as long as the
+// skeleton bind pose is itself symmetric: mirrored joints local frames are
+// reflections of one another, and joints on the plane have a frame symmetric
+// by the plane. Reflecting translations only negates their component along the
+// plane normal, and reflecting rotations negates the 2 quaternion components
+// orthogonal to it, which is done for all soa joints at once.
+// Soa blocks of 4 joints that are their own mirror are reflected without
+// swapping lanes.
+// The job does not owned the buffers (in/output) and will thus not delete
+// them during job's destruction.
+struct MirrorJob {
+  // Default constructor, initializes default values.
+  MirrorJob();
+
+  // Validates job parameters. Returns true for a valid job, or false otherwise:
+  // -if any range is invalid or input and output are the same buffer.
+  // -if output range is smaller than the number of soa joints of mirror table.
+  // -if any mirror entry is out of input range.
+  bool Validate() const;
+
+  // Runs job's mirroring task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // Model-space axes, defining the normal of the mirror plane.
+  enum Axis {
+    kX,
+    kY,
+    kZ,
+  };
+
+  // Normal of the mirror plane, kX by default (aka left/right mirroring of
+  // characters facing z axis).
+  Axis axis;
+
+  // Mirror table, one entry per joint, see BuildJointMirror(). Every entry is
+  // the index of the mirror joint, or the joint itself for joints on the
+  // plane.
+  Range<const int> mirror;
+
+  // Local-space pose to mirror, in soa format.
+  Range<const ozz::math::SoaTransform> input;
+
+  // Job output.
+
+  // Mirrored local-space pose, in soa format.
+  Range<ozz::math::SoaTransform> output;
+};
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_MIRROR_JOB_H_
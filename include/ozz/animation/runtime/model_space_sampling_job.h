@@ -0,0 +1,114 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_MODEL_SPACE_SAMPLING_JOB_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_MODEL_SPACE_SAMPLING_JOB_H_
+
+#include "ozz/base/platform.h"
+
+namespace ozz {
+
+// Forward declaration of math structures.
+namespace math {
+struct SoaTransform;
+struct Float4x4;
+}  // namespace math
+
+namespace animation {
+
+// Forward declares the animation type to sample.
+class Animation;
+
+// Forward declares the cache object used by the SamplingJob.
+class SamplingCache;
+
+// Forward declares the Skeleton object used to describe joint hierarchy.
+class Skeleton;
+
+// Samples an animation and computes model-space matrices of a set of target
+// joints only. This is equivalent to running a SamplingJob followed by a
+// LocalToModelJob, but only the soa tracks of target joints and their
+// ancestors are sampled (see SamplingJob::mask), and only the model-space
+// matrices of these joints are computed. This drastically reduces the cost of
+// querying a few joints (like root, hit boxes or attachment sockets) of a big
+// hierarchy.
+// Buffers are ordered like skeleton's joints, like for LocalToModelJob. Local
+// transforms and model-space matrices of joints that aren't required by any
+// target are left unchanged. The job does not owned the buffers (in/output)
+// and will thus not delete them during job's destruction.
+struct ModelSpaceSamplingJob {
+  // Default constructor, initializes default values.
+  ModelSpaceSamplingJob();
+
+  // Validates job parameters. Returns true for a valid job, or false otherwise:
+  // -if any input pointer is NULL.
+  // -if animation and skeleton don't have the same number of joints.
+  // -if any target joint index is out of skeleton's joints range.
+  // -if locals range is smaller than the skeleton's number of soa joints.
+  // -if output range is smaller than the skeleton's number of joints.
+  // -if the sampling job isn't valid, see SamplingJob::Validate().
+  bool Validate() const;
+
+  // Runs job's sampling and local-to-model tasks.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // Time ratio in the unit interval [0,1] used to sample animation, see
+  // SamplingJob::ratio.
+  float ratio;
+
+  // The animation to sample.
+  const Animation* animation;
+
+  // A cache object that must be big enough to sample *this animation.
+  SamplingCache* cache;
+
+  // The Skeleton object describing the joint hierarchy.
+  const Skeleton* skeleton;
+
+  // The root matrix will multiply to every model space matrices, default NULL
+  // means an identity matrix. See LocalToModelJob::root.
+  const ozz::math::Float4x4* root;
+
+  // Indices of the joints whose model-space matrix is required. Ancestors of
+  // these joints are computed as well.
+  Range<const int> joints;
+
+  // Intermediate local-space transforms buffer, filled with sampled soa
+  // tracks. Its size must be at least skeleton's number of soa joints.
+  Range<ozz::math::SoaTransform> locals;
+
+  // Job output.
+  // The output range to be filled with model-space matrices of target joints
+  // and their ancestors.
+  Range<ozz::math::Float4x4> output;
+};
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_MODEL_SPACE_SAMPLING_JOB_H_
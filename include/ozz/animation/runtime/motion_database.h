@@ -0,0 +1,172 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_MOTION_DATABASE_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_MOTION_DATABASE_H_
+
+#include "ozz/base/io/archive_traits.h"
+#include "ozz/base/platform.h"
+
+namespace ozz {
+namespace animation {
+
+// Forward declares the MotionDatabaseBuilder, used to instantiate a
+// MotionDatabase.
+namespace offline {
+class MotionDatabaseBuilder;
+}
+
+// Runtime motion matching feature database. It stores a feature vector (like
+// joint positions, velocities and future trajectory) for every frame of a set
+// of animation clips, and is searched for the frame that best matches a query
+// feature vector with the MotionMatchingJob. A database is built from
+// animations and a skeleton by the offline::MotionDatabaseBuilder, which
+// documents the features layout.
+// Features are normalized: feature i of a frame is stored as
+// (value - offsets()[i]) * scales()[i], so that the squared euclidean distance
+// between two normalized vectors is the weighted matching cost. Frames are
+// stored row major in a contiguous matrix, whose rows are padded with zeros to
+// a multiple of 4 floats and aligned to 16 bytes, so they can be read with
+// simd loads. Frames are also grouped by blocks of kBlockSize, themselves
+// grouped by large blocks of kLargeBlockSize frames. This two levels bounding
+// box hierarchy of normalized features allows the search to skip whole blocks.
+class MotionDatabase {
+ public:
+  enum {
+    // Number of consecutive frames whose bounds are stored together.
+    kBlockSize = 16,
+
+    // Number of consecutive frames of a large block, a multiple of
+    // kBlockSize.
+    kLargeBlockSize = 64,
+  };
+
+  MotionDatabase();
+  ~MotionDatabase();
+
+  // Gets the number of frames of all clips.
+  int num_frames() const { return num_frames_; }
+
+  // Gets the number of features of a frame.
+  int num_features() const { return num_features_; }
+
+  // Gets the number of floats of a frame row, num_features() rounded up to a
+  // multiple of 4.
+  int stride() const { return (num_features_ + 3) & ~3; }
+
+  // Gets the number of clips.
+  int num_clips() const {
+    return clip_begins_.count() > 1 ? static_cast<int>(clip_begins_.count()) - 1
+                                    : 0;
+  }
+
+  // Gets the number of frames per second clips were sampled at.
+  float frequency() const { return frequency_; }
+
+  // Normalized features matrix, num_frames() rows of stride() floats.
+  Range<const float> features() const { return features_; }
+
+  // Normalized features bounds of each block of kBlockSize frames: a row of
+  // minimum values followed by a row of maximum values per block.
+  Range<const float> bounds() const { return bounds_; }
+
+  // Normalized features bounds of each large block of kLargeBlockSize frames,
+  // with the same layout as bounds().
+  Range<const float> large_bounds() const { return large_bounds_; }
+
+  // Per feature normalization offsets and scales, stride() floats each. Scales
+  // of padding features are 0.
+  Range<const float> offsets() const { return offsets_; }
+  Range<const float> scales() const { return scales_; }
+
+  // Index of the first frame of every clip, plus the total number of frames.
+  // Frames of clip c are [clip_begins()[c], clip_begins()[c + 1][.
+  Range<const int> clip_begins() const { return clip_begins_; }
+
+  // Finds the clip _frame belongs to, and its time in seconds within the clip.
+  // Returns the clip index, or -1 if _frame is out of range, in which case
+  // _time isn't modified. _time can be NULL.
+  int FindClip(int _frame, float* _time) const;
+
+  // Normalizes _raw features (num_features() floats) to _normalized (stride()
+  // floats), so it can be used as a MotionMatchingJob query. Padding features
+  // are set to 0.
+  // Returns false if _raw or _normalized are too small.
+  bool Normalize(const Range<const float>& _raw,
+                 const Range<float>& _normalized) const;
+
+  // Get the estimated database's size in bytes.
+  size_t size() const;
+
+  // Serialization functions.
+  // Should not be called directly but through io::Archive << and >> operators.
+  void Save(ozz::io::OArchive& _archive) const;
+  void Load(ozz::io::IArchive& _archive, uint32_t _version);
+
+ private:
+  // Disables copy and assignation.
+  MotionDatabase(MotionDatabase const&);
+  void operator=(MotionDatabase const&);
+
+  // MotionDatabaseBuilder class is allowed to allocate a MotionDatabase.
+  friend class offline::MotionDatabaseBuilder;
+
+  // Internal allocation and destruction functions.
+  void Allocate(int _num_frames, int _num_features, int _num_clips);
+  void Deallocate();
+
+  // Computes blocks bounds_ and large_bounds_ from features_.
+  void ComputeBounds();
+
+  // Normalized features matrix, row major.
+  Range<float> features_;
+
+  // Blocks bounds, minimum then maximum row per block.
+  Range<float> bounds_;
+  Range<float> large_bounds_;
+
+  // Normalization offsets and scales.
+  Range<float> offsets_;
+  Range<float> scales_;
+
+  // First frame of every clip, plus the total number of frames.
+  Range<int> clip_begins_;
+
+  // Number of frames and features.
+  int num_frames_;
+  int num_features_;
+
+  // Clips sampling frequency.
+  float frequency_;
+};
+}  // namespace animation
+namespace io {
+OZZ_IO_TYPE_VERSION(1, animation::MotionDatabase)
+OZZ_IO_TYPE_TAG("ozz-motion_database", animation::MotionDatabase)
+}  // namespace io
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_MOTION_DATABASE_H_
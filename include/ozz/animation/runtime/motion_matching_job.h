@@ -0,0 +1,100 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_MOTION_MATCHING_JOB_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_MOTION_MATCHING_JOB_H_
+
+#include "ozz/base/platform.h"
+
+namespace ozz {
+namespace animation {
+
+// Forward declares the motion database.
+class MotionDatabase;
+
+// ozz::animation::MotionMatchingJob searches a MotionDatabase for the frame
+// whose features best match a query, that is with the lowest (optionally
+// weighted) squared euclidean distance between normalized features. Distances
+// are computed 4 features at a time with simd maths, and a frame is rejected as
+// soon as its partial distance exceeds the best one found so far. The database
+// bounding box hierarchy is used to skip large blocks, then blocks of frames
+// whose bounds can't contain a better frame.
+struct MotionMatchingJob {
+  // Default constructor, initializes default values.
+  MotionMatchingJob();
+
+  // Validates job parameters. Returns true for a valid job, or false otherwise:
+  // -if any input or output pointer is NULL.
+  // -if query is smaller than database stride().
+  // -if weights are specified but are smaller than database stride().
+  bool Validate() const;
+
+  // Runs job's search task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // Job input.
+
+  // The database to search.
+  const MotionDatabase* database;
+
+  // Normalized query features, stride() floats, see
+  // MotionDatabase::Normalize().
+  Range<const float> query;
+
+  // Optional per feature weights, stride() floats, multiplied with squared
+  // differences of normalized features. They allow to change features
+  // importance at runtime (like trajectory versus pose), without rebuilding
+  // the database. Weights must be positive or zero.
+  // Default empty range weights all features by 1.
+  Range<const float> weights;
+
+  // Uses database bounding box hierarchy to skip blocks of frames. All frames
+  // are tested otherwise (brute force), which is only useful to test or
+  // profile the hierarchy.
+  // Default value is true.
+  bool accelerate;
+
+  // Maximum cost of the frame to find. Setting it to the cost of the frame
+  // currently playing allows to search only for better frames.
+  // Default value is the maximum float value.
+  float max_cost;
+
+  // Job output.
+
+  // Index of the best frame, or -1 if no frame costs less than max_cost.
+  int* frame;
+
+  // Cost of the best frame, or max_cost if no frame was found.
+  float* cost;
+};
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_MOTION_MATCHING_JOB_H_
@@ -0,0 +1,147 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_PALETTE_ANIMATION_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_PALETTE_ANIMATION_H_
+
+#include "ozz/base/io/archive_traits.h"
+#include "ozz/base/platform.h"
+
+namespace ozz {
+namespace io {
+class IArchive;
+class OArchive;
+}  // namespace io
+namespace math {
+struct Float4x4;
+}  // namespace math
+namespace animation {
+
+// Forward declares the PaletteAnimationBuilder, used to instantiate a
+// PaletteAnimation.
+namespace offline {
+class PaletteAnimationBuilder;
+}
+
+// Defines an animation clip baked to skinning matrices palettes, one palette
+// per frame, sampled at a fixed frequency. It's designed to be uploaded as is
+// to a GPU texture (or buffer), so that crowd shaders sample animations and
+// skin meshes directly, with no CPU cost per instance.
+// Layout is a 2D array of RGBA 32 bits floats texels, one row per frame:
+// - height() rows, the first frame at ratio 0 and the last one at ratio 1.
+// - width() texels per row, kTexelsPerJoint consecutive texels per palette
+// joint. Each texel stores a row of the joint affine 4x3 matrix, so a
+// position p is transformed as (dot(t0, p), dot(t1, p), dot(t2, p)), with
+// p = (x, y, z, 1).
+// A shader samples frame ratio * (height() - 1) and interpolates the 2 rows
+// surrounding it.
+// This is memory intensive (48 bytes per joint and per frame), but matches
+// texture-baked crowds needs: short looping clips played by many instances.
+// This structure is filled by the PaletteAnimationBuilder and deserialized/
+// loaded at runtime.
+class PaletteAnimation {
+ public:
+  // Number of RGBA texels per joint.
+  enum { kTexelsPerJoint = 3 };
+
+  // Builds a default (empty) animation.
+  PaletteAnimation();
+
+  // Declares the public non-virtual destructor.
+  ~PaletteAnimation();
+
+  // Gets the animation clip duration.
+  float duration() const { return duration_; }
+
+  // Gets the number of joints of each palette.
+  int num_joints() const { return num_joints_; }
+
+  // Gets the number of frames. Frames are evenly spread over the animation
+  // duration, the first one is at ratio 0 and the last one at ratio 1.
+  int num_frames() const { return num_frames_; }
+
+  // Gets texture width, in texels.
+  int width() const { return num_joints_ * kTexelsPerJoint; }
+
+  // Gets texture height, in texels.
+  int height() const { return num_frames_; }
+
+  // Gets animation name.
+  const char* name() const { return name_ ? name_ : ""; }
+
+  // Gets texels buffer, 4 floats per texel, width() * height() texels.
+  Range<const float> texels() const { return texels_; }
+
+  // Gets texels of frame _frame, which must be in range [0,num_frames()[.
+  const float* frame(int _frame) const;
+
+  // Unpacks _joint matrix of frame _frame to _matrix. _joint must be in range
+  // [0,num_joints()[ and _frame in range [0,num_frames()[.
+  void GetMatrix(int _frame, int _joint, math::Float4x4* _matrix) const;
+
+  // Get the estimated animation's size in bytes.
+  size_t size() const;
+
+  // Serialization functions.
+  // Should not be called directly but through io::Archive << and >> operators.
+  void Save(ozz::io::OArchive& _archive) const;
+  void Load(ozz::io::IArchive& _archive, uint32_t _version);
+
+ private:
+  // Disables copy and assignation.
+  PaletteAnimation(PaletteAnimation const&);
+  void operator=(PaletteAnimation const&);
+
+  // PaletteAnimationBuilder class is allowed to instantiate a
+  // PaletteAnimation.
+  friend class offline::PaletteAnimationBuilder;
+
+  // Internal allocation and destruction functions.
+  void Allocate(size_t _name_len, int _num_joints, int _num_frames);
+  void Deallocate();
+
+  // Duration of the animation clip.
+  float duration_;
+
+  // Number of palette joints and frames.
+  int num_joints_;
+  int num_frames_;
+
+  // Animation name.
+  char* name_;
+
+  // Stores all texels, 4 floats per texel.
+  Range<float> texels_;
+};
+}  // namespace animation
+
+namespace io {
+OZZ_IO_TYPE_VERSION(1, animation::PaletteAnimation)
+OZZ_IO_TYPE_TAG("ozz-palette_animation", animation::PaletteAnimation)
+}  // namespace io
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_PALETTE_ANIMATION_H_
@@ -0,0 +1,139 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_PIPELINE_BUFFERS_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_PIPELINE_BUFFERS_H_
+
+#include "ozz/base/platform.h"
+
+namespace ozz {
+namespace math {
+struct Float4x4;
+}  // namespace math
+namespace animation {
+
+// Forward declares the job whose outputs are buffered.
+struct PipelineJob;
+
+// Multi-buffers a character's model-space matrices and skinning palette, so
+// that the animation update of frame N+1 can overlap with the rendering of
+// frame N, without copying outputs from one thread to the other.
+// The animation thread (producer) writes to a buffer acquired with
+// BeginWrite(), and publishes it with EndWrite(). The render thread (consumer)
+// gets the latest published buffer with AcquireRead(), and releases it with
+// ReleaseRead() once rendering is done. A buffer is never written while it's
+// being read, nor while it's the latest published one, so the consumer always
+// sees a complete frame. These functions act as fences: buffer content written
+// before EndWrite() is visible to the consumer after AcquireRead().
+// With 3 buffers (triple buffering, default), BeginWrite() always succeeds.
+// With 2 buffers, it fails while the consumer reads the previous frame, so
+// the producer must wait for ReleaseRead() or skip the frame.
+// There can be a single producer, and any number of consumers. Fences require
+// c++11 atomics. In c++98 builds, producer and consumer must be synchronized
+// externally.
+class PipelineBuffers {
+ public:
+  enum {
+    // Maximum number of buffers.
+    kMaxBuffers = 4,
+  };
+
+  // Constructs empty buffers. They need to be resized before they can be
+  // used.
+  PipelineBuffers();
+
+  // Constructs _num_buffers buffers of _num_joints model-space matrices, and
+  // _palette_size skinning matrices (can be 0 if no palette is needed).
+  // _num_buffers is clamped to range [2, kMaxBuffers].
+  PipelineBuffers(int _num_joints, int _palette_size, int _num_buffers = 3);
+
+  // Deallocates buffers.
+  ~PipelineBuffers();
+
+  // Resizes buffers, whose previous content is lost. No buffer must be
+  // acquired.
+  void Resize(int _num_joints, int _palette_size, int _num_buffers = 3);
+
+  // Producer side.
+
+  // Acquires a buffer to write the next frame to. Returns its index, or -1 if
+  // all buffers are either being read or the latest published one.
+  int BeginWrite();
+
+  // Publishes buffer _index, which becomes the latest one. _index must have
+  // been returned by BeginWrite().
+  void EndWrite(int _index);
+
+  // Sets _job models and skinning_palette outputs to buffer _index.
+  void SetupOutputs(int _index, PipelineJob* _job) const;
+
+  // Consumer side.
+
+  // Acquires the latest published buffer for reading. Returns its index, or
+  // -1 if no buffer was published yet.
+  int AcquireRead();
+
+  // Releases buffer _index returned by AcquireRead().
+  void ReleaseRead(int _index);
+
+  // Buffers access.
+
+  // Gets model-space matrices of buffer _index.
+  Range<math::Float4x4> models(int _index) const;
+
+  // Gets skinning palette of buffer _index.
+  Range<math::Float4x4> skinning_palette(int _index) const;
+
+  // Gets the frame number buffer _index was published for. Frames are
+  // numbered from 1 by EndWrite(), 0 means the buffer was never published.
+  uint32_t frame(int _index) const;
+
+  int num_buffers() const { return num_buffers_; }
+  int num_joints() const { return num_joints_; }
+  int palette_size() const { return palette_size_; }
+
+ private:
+  // Disables copy and assignment.
+  PipelineBuffers(const PipelineBuffers&);
+  void operator=(const PipelineBuffers&);
+
+  // Buffers states, private to the implementation.
+  struct State;
+  State* state_;
+
+  int num_buffers_;
+  int num_joints_;
+  int palette_size_;
+
+  // Matrices of all buffers, allocated in a single block. Each buffer is
+  // num_joints_ models followed by palette_size_ skinning matrices.
+  math::Float4x4* matrices_;
+};
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_PIPELINE_BUFFERS_H_
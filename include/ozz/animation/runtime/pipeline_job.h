@@ -0,0 +1,235 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_PIPELINE_JOB_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_PIPELINE_JOB_H_
+
+#include "ozz/animation/runtime/sampling_job.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/platform.h"
+
+namespace ozz {
+namespace math {
+struct SoaTransform;
+struct Float4x4;
+}  // namespace math
+namespace animation {
+
+// Forward declares runtime types.
+class Animation;
+class Skeleton;
+
+// Keeps PipelineJob intermediate buffers (sampled layers poses) alive across
+// runs, so that they don't need to be managed by the application. A context is
+// sized for a maximum number of joints and layers. It can be reused by any
+// number of characters, as long as they aren't run concurrently: a context
+// per worker thread is enough.
+class PipelineContext {
+ public:
+  // Constructs an empty context. It needs to be resized before it can be used
+  // by a job that blends layers.
+  PipelineContext();
+
+  // Constructs a context for skeletons of up to _max_joints joints, blending
+  // up to _max_layers layers.
+  PipelineContext(int _max_joints, int _max_layers);
+
+  // Deallocates context buffers.
+  ~PipelineContext();
+
+  // Resizes context buffers, whose previous content is lost.
+  void Resize(int _max_joints, int _max_layers);
+
+  // Gets the maximum number of soa joints and layers the context supports.
+  int max_soa_joints() const { return max_soa_joints_; }
+  int max_layers() const { return max_layers_; }
+
+ private:
+  // Disables copy and assignment.
+  PipelineContext(const PipelineContext&);
+  void operator=(const PipelineContext&);
+
+  friend struct PipelineJob;
+
+  // Gets the pose buffer of layer _layer.
+  Range<math::SoaTransform> pose(int _layer) const;
+
+  int max_soa_joints_;
+  int max_layers_;
+  math::SoaTransform* poses_;
+};
+
+// Runs the whole per-character animation pipeline in a single job: samples
+// animation layers, blends them, applies two-bone IK chains, and converts the
+// pose to model-space matrices and skinning palette. The palette can finally
+// be handed to a skinning stage callback, while it's still hot in cache.
+// The job is validated once as a whole, then layers are sampled without any
+// further validation. Stages are also fused when possible:
+// -a single layer is sampled directly to the local-space output, without
+// blending.
+// -the skinning palette is computed in the same pass as model-space matrices
+// (see LocalToModelJob::skinning_output), and IK chains only update their own
+// sub-hierarchy.
+// Configuration (skeleton, layers animations, IK chains joints...) is usually
+// setup once per type of character, while the per-character state (caches,
+// ratios, IK targets and outputs) is updated every frame. A PipelineJob can be
+// run as a single task, see RunJobs() from ozz/base/task_scheduler.h.
+// The job does not own any buffer (in/output).
+struct PipelineJob {
+  enum {
+    // Maximum number of layers that can be blended.
+    kMaxLayers = 8,
+  };
+
+  // Default constructor, initializes default values.
+  PipelineJob();
+
+  // Defines an animation layer to sample and blend.
+  struct Layer {
+    // Default constructor, initializes default values.
+    Layer();
+
+    // Animation to sample. It must have as many tracks as the skeleton has
+    // joints.
+    const Animation* animation;
+
+    // Sampling cache of this layer, which can't be shared with another layer
+    // or character. See SamplingJob::cache.
+    SamplingCache* cache;
+
+    // Time ratio in the unit interval [0,1], see SamplingJob::ratio.
+    float ratio;
+
+    // Blending weight of this layer, see BlendingJob::Layer::weight.
+    // Default value is 1.
+    float weight;
+
+    // Optional per-joint weights, see BlendingJob::Layer::joint_weights.
+    Range<const math::SimdFloat4> joint_weights;
+  };
+
+  // Defines a two-bone IK chain, see IKTwoBoneJob for parameters details.
+  // Chains are solved in order, after model-space matrices are computed. Each
+  // chain correction is applied to the local-space output, before the chain
+  // sub-hierarchy is updated, so a chain can depend on a previous one.
+  struct TwoBoneIK {
+    // Default constructor, initializes default values.
+    TwoBoneIK();
+
+    // Chain joints indices, in skeleton order: start joint must be an
+    // ancestor of mid joint, which must be an ancestor of end joint.
+    int start_joint;
+    int mid_joint;
+    int end_joint;
+
+    // Target position in model-space.
+    math::SimdFloat4 target;
+
+    // See IKTwoBoneJob::mid_axis, pole_vector, twist_angle, soften and weight.
+    math::SimdFloat4 mid_axis;
+    math::SimdFloat4 pole_vector;
+    float twist_angle;
+    float soften;
+    float weight;
+  };
+
+  // Defines the skinning stage callback. _palette contains skinning matrices,
+  // ordered like skinning_palette. Returning false fails the job.
+  typedef bool (*SkinningStage)(void* _user_data,
+                                const Range<const math::Float4x4>& _palette);
+
+  // Validates job parameters. Returns true for a valid job, or false
+  // otherwise:
+  // -if skeleton is NULL.
+  // -if there are more than kMaxLayers layers.
+  // -if any layer can't be sampled (see SamplingJob::Validate()), or if its
+  // animation doesn't have as many tracks as skeleton joints.
+  // -if layers need to be blended, and context is NULL or too small.
+  // -if any IK chain joint is out of skeleton range or not in order.
+  // -if any output is too small.
+  // -if skinning_palette, inverse_bind_poses and joint_remaps sizes don't
+  // match (see LocalToModelJob::skinning_output).
+  // -if skinning_stage is set without a skinning palette.
+  bool Validate() const;
+
+  // Runs the pipeline.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid, or if the skinning stage failed.
+  bool Run() const;
+
+  // Job input.
+
+  // The skeleton of the character.
+  const Skeleton* skeleton;
+
+  // Layers to sample and blend. If empty, output is the skeleton bind pose.
+  Range<const Layer> layers;
+
+  // Blending threshold, see BlendingJob::threshold.
+  float threshold;
+
+  // Sampling and blending quality, see SamplingJob::Quality.
+  SamplingJob::Quality quality;
+
+  // Two-bone IK chains, solved after layers are blended.
+  Range<const TwoBoneIK> two_bone_iks;
+
+  // Inverse bind poses and optional joint remapping table, used to compute
+  // skinning_palette. See LocalToModelJob::inverse_bind_poses and
+  // joint_remaps.
+  Range<const math::Float4x4> inverse_bind_poses;
+  Range<const uint16_t> joint_remaps;
+
+  // Optional skinning stage, called with skinning_palette once it's computed.
+  SkinningStage skinning_stage;
+  void* skinning_user_data;
+
+  // Context providing intermediate buffers. It's only required to blend
+  // layers, aka when there's more than one layer, or when the single layer
+  // has joint weights or a weight lower than threshold.
+  PipelineContext* context;
+
+  // Job output.
+
+  // Local-space pose, of at least skeleton num_soa_joints() elements.
+  Range<math::SoaTransform> locals;
+
+  // Model-space matrices, of at least skeleton num_joints() elements.
+  Range<math::Float4x4> models;
+
+  // Optional skinning matrices palette, computed if set.
+  Range<math::Float4x4> skinning_palette;
+
+ private:
+  // Tests if layers need to be blended.
+  bool NeedsBlending() const;
+};
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_PIPELINE_JOB_H_
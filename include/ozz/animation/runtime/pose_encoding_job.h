@@ -0,0 +1,135 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_POSE_ENCODING_JOB_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_POSE_ENCODING_JOB_H_
+
+#include "ozz/base/platform.h"
+
+namespace ozz {
+// Forward declaration of math structures.
+namespace math {
+struct SoaTransform;
+}  // namespace math
+
+namespace animation {
+
+// ozz::animation::PoseEncodingJob encodes a local-space soa pose to a compact
+// byte buffer, without archive overhead, for replay recording or network pose
+// synchronization. Decoding is done with PoseDecodingJob.
+// Every component (translation, rotation and scale) is quantized with a fixed
+// precision, delta-encoded against a reference pose (like the previous frame
+// or skeleton bind pose), and bit-packed: each group of 4 soa lanes is written
+// with the number of bits required by its biggest delta. A component that
+// didn't change costs 5 bits for 4 joints.
+// Encoder and decoder must use the same precisions and reference pose.
+// Encoding against the previous decoded pose doesn't accumulate quantization
+// errors, as the reference is quantized identically on both sides.
+struct PoseEncodingJob {
+  // Default constructor, initializes default precisions.
+  PoseEncodingJob();
+
+  // Validates job parameters. Returns true for a valid job, or false otherwise:
+  // -if reference isn't empty and is smaller than pose.
+  // -if any precision isn't strictly positive.
+  // -if size is NULL.
+  bool Validate() const;
+
+  // Runs job's execution task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid, or if buffer is too small. Use
+  // MaxSize() to allocate a buffer that is always big enough.
+  bool Run() const;
+
+  // Gets the maximum encoded size in bytes of a pose of _num_soa_transforms.
+  static size_t MaxSize(size_t _num_soa_transforms);
+
+  // Quantization precisions. Translations and scales are quantized with steps
+  // of the given precision (in the pose unit). Rotations quaternion components
+  // are quantized with a step of rotation_precision.
+  float translation_precision;
+  float rotation_precision;
+  float scale_precision;
+
+  // Job input.
+
+  // Local-space soa pose to encode.
+  Range<const math::SoaTransform> pose;
+
+  // Optional reference pose, at least as big as pose. An identity pose is
+  // used if empty.
+  Range<const math::SoaTransform> reference;
+
+  // Job output.
+
+  // Buffer receiving encoded pose.
+  Range<char> buffer;
+
+  // Number of bytes written to buffer.
+  size_t* size;
+};
+
+// ozz::animation::PoseDecodingJob decodes a pose encoded by PoseEncodingJob.
+// See PoseEncodingJob for details.
+struct PoseDecodingJob {
+  // Default constructor, initializes default precisions.
+  PoseDecodingJob();
+
+  // Validates job parameters. Returns true for a valid job, or false otherwise:
+  // -if reference isn't empty and is smaller than output.
+  // -if any precision isn't strictly positive.
+  bool Validate() const;
+
+  // Runs job's execution task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid, or if buffer is too small to
+  // decode output.
+  bool Run() const;
+
+  // Quantization precisions, must match encoding ones.
+  float translation_precision;
+  float rotation_precision;
+  float scale_precision;
+
+  // Job input.
+
+  // Encoded pose.
+  Range<const char> buffer;
+
+  // Optional reference pose, the one used for encoding.
+  Range<const math::SoaTransform> reference;
+
+  // Job output.
+
+  // Decoded local-space soa pose. Its size must match encoded pose one.
+  Range<math::SoaTransform> output;
+};
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_POSE_ENCODING_JOB_H_
@@ -0,0 +1,145 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_POSE_INTERPOLATION_JOB_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_POSE_INTERPOLATION_JOB_H_
+
+#include "ozz/animation/runtime/blending_job.h"
+#include "ozz/base/platform.h"
+
+namespace ozz {
+
+// Forward declaration of math structures.
+namespace math {
+struct SoaTransform;
+struct Float4x4;
+}  // namespace math
+
+namespace animation {
+
+// Interpolates between two poses, to animate characters whose animation is
+// updated at a reduced rate (like 10Hz instead of 60Hz for far away
+// characters) without stuttering. Full updates sample the pose of the next
+// update time, so intermediate frames interpolate from the previous pose to
+// this one (see UpdateRateScheduler).
+// Local-space poses are interpolated in soa format, like BlendingJob does:
+// translations and scales are linearly interpolated and rotations are
+// normalized-lerped along the shortest path. Model-space matrices can also be
+// interpolated, which skips local-to-model conversion on intermediate frames.
+// Matrices columns are linearly interpolated, which is only accurate for the
+// small motions happening between two updates.
+// The job does not owned the buffers (in/output) and will thus not delete
+// them during job's destruction. Output buffers can be the same as input ones.
+struct PoseInterpolationJob {
+  // Default constructor, initializes default values.
+  PoseInterpolationJob();
+
+  // Validates job parameters. Returns true for a valid job, or false otherwise:
+  // -if both output and model_output are empty.
+  // -if from or to are smaller than output.
+  // -if model_from or model_to are smaller than model_output.
+  bool Validate() const;
+
+  // Runs job's interpolation task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // Interpolation ratio, 0 outputs from poses and 1 outputs to poses. Ratio is
+  // clamped in range [0,1].
+  float ratio;
+
+  // Rotations normalization quality, see BlendingJob::Quality. kStandard by
+  // default.
+  BlendingJob::Quality quality;
+
+  // Local-space poses to interpolate, in soa format.
+  Range<const ozz::math::SoaTransform> from;
+  Range<const ozz::math::SoaTransform> to;
+
+  // Job output, can be empty if only model-space matrices are interpolated.
+  // The interpolated local-space pose. Its size defines the number of soa
+  // joints to interpolate.
+  Range<ozz::math::SoaTransform> output;
+
+  // Model-space matrices to interpolate.
+  Range<const ozz::math::Float4x4> model_from;
+  Range<const ozz::math::Float4x4> model_to;
+
+  // Job output, can be empty if only local-space poses are interpolated.
+  // The interpolated model-space matrices. Its size defines the number of
+  // matrices to interpolate.
+  Range<ozz::math::Float4x4> model_output;
+};
+
+// Staggers reduced rate updates of a set of instances over frames, so that
+// every frame does the same amount of full updates. Instance i is fully
+// updated on frames where (frame + i) is a multiple of the interval, and
+// interpolated otherwise (see PoseInterpolationJob).
+// A full update should sample the animation at the time of the next full
+// update (current time plus interval frames), and keep the previous full
+// update pose. Intermediate frames then interpolate between the two with
+// ratio().
+class UpdateRateScheduler {
+ public:
+  // Constructs a scheduler that fully updates instances every _interval
+  // frames. _interval is clamped to 1 or more.
+  explicit UpdateRateScheduler(int _interval = 1)
+      : interval_(_interval > 1 ? _interval : 1), frame_(0) {}
+
+  // Tells if _instance must be fully updated this frame.
+  bool full_update(int _instance) const { return phase(_instance) == 0; }
+
+  // Gets the ratio to interpolate _instance poses this frame, in range
+  // [0,1[. It's 0 on full update frames.
+  float ratio(int _instance) const {
+    return static_cast<float>(phase(_instance)) / interval_;
+  }
+
+  // Advances to next frame.
+  void Advance() { ++frame_; }
+
+  // Gets the number of frames between two full updates of an instance.
+  int interval() const { return interval_; }
+
+  // Gets current frame.
+  unsigned int frame() const { return frame_; }
+
+ private:
+  // Number of frames since _instance last full update.
+  int phase(int _instance) const {
+    return static_cast<int>((frame_ + static_cast<unsigned int>(_instance)) %
+                            static_cast<unsigned int>(interval_));
+  }
+
+  int interval_;
+  unsigned int frame_;
+};
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_POSE_INTERPOLATION_JOB_H_
@@ -0,0 +1,254 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_POSE_STREAM_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_POSE_STREAM_H_
+
+#include "ozz/base/io/archive_traits.h"
+#include "ozz/base/platform.h"
+
+namespace ozz {
+namespace math {
+struct Float3;
+struct SoaTransform;
+}  // namespace math
+namespace animation {
+
+// Forward declarations.
+class Animation;
+class Skeleton;
+class SamplingCache;
+
+// Animation state of a pose stream frame layer: the index of the sampled clip,
+// its time ratio and its blending weight.
+struct PoseStreamLayer {
+  int clip;
+  float ratio;
+  float weight;
+};
+
+// Records the animation state of a character every frame, for replay systems.
+// Instead of poses, a frame stores its animation layers (clip, ratio, weight)
+// and IK targets, which is enough to reconstruct the pose deterministically
+// with the same animations, using PoseStreamDecodingJob. Floats are stored
+// exactly, so decoded poses are bit identical to the recorded ones.
+// Every snapshot_interval frames, the final local-space pose is also recorded
+// as a snapshot, encoded with PoseEncodingJob. Snapshots correct whatever
+// animation state doesn't capture (procedural or physics driven joints), and
+// allow to display a pose when seeking without the animations.
+// Frames are indexed, so seeking is O(1).
+class PoseStream {
+ public:
+  enum {
+    // Maximum number of layers of a frame.
+    kMaxLayers = 16,
+
+    // Maximum number of IK targets of a frame.
+    kMaxIKTargets = 255,
+  };
+
+  // Stream recording settings.
+  struct Settings {
+    // Initializes default settings: a snapshot every 60 frames, with
+    // PoseEncodingJob default precisions.
+    Settings();
+
+    // Number of frames between two snapshots. 0 disables snapshots.
+    int snapshot_interval;
+
+    // Snapshots quantization precisions, see PoseEncodingJob.
+    float translation_precision;
+    float rotation_precision;
+    float scale_precision;
+  };
+
+  PoseStream();
+  ~PoseStream();
+
+  // Clears all recorded frames and snapshots, and sets recording _settings.
+  // Returns false if settings are invalid, leaving the stream empty with its
+  // previous settings.
+  bool Reset(const Settings& _settings);
+
+  // Appends a frame to the stream. _pose is the final local-space pose, only
+  // required (and used) if the frame is a snapshot one, see IsSnapshotFrame.
+  // All snapshots must have the same number of soa transforms.
+  // Returns false and leaves the stream unchanged if there are more than
+  // kMaxLayers layers or kMaxIKTargets targets, if a layer clip isn't in range
+  // [0,65535], or if _pose is missing or invalid for a snapshot frame.
+  bool Record(const Range<const PoseStreamLayer>& _layers,
+              const Range<const math::Float3>& _ik_targets,
+              const Range<const math::SoaTransform>& _pose);
+
+  // Gets recording settings.
+  const Settings& settings() const { return settings_; }
+
+  // Gets the number of recorded frames.
+  int num_frames() const { return num_frames_; }
+
+  // Gets the number of recorded snapshots.
+  int num_snapshots() const { return num_snapshots_; }
+
+  // Gets the number of soa transforms of snapshots, 0 if there's none.
+  int num_soa_transforms() const { return num_soa_transforms_; }
+
+  // Tells if _frame is (or will be when recorded) a snapshot frame.
+  bool IsSnapshotFrame(int _frame) const {
+    return settings_.snapshot_interval > 0 &&
+           _frame % settings_.snapshot_interval == 0;
+  }
+
+  // Reads _frame animation state. Layers are written to _layers and IK
+  // targets to _ik_targets, their number to _num_layers and _num_ik_targets.
+  // Returns false if _frame isn't in range [0,num_frames()[ or if output
+  // ranges are too small. _ik_targets and _num_ik_targets can be empty and
+  // NULL if IK targets aren't needed.
+  bool ReadFrame(int _frame, const Range<PoseStreamLayer>& _layers,
+                 int* _num_layers, const Range<math::Float3>& _ik_targets,
+                 int* _num_ik_targets) const;
+
+  // Finds the latest snapshot recorded at or before _frame, for seeking.
+  // Returns its index, or -1 if there's none.
+  int FindSnapshot(int _frame) const;
+
+  // Gets the frame of snapshot _snapshot.
+  int snapshot_frame(int _snapshot) const {
+    return _snapshot * settings_.snapshot_interval;
+  }
+
+  // Decodes snapshot _snapshot to _pose, which must contain
+  // num_soa_transforms() elements.
+  // Returns false if _snapshot isn't in range [0,num_snapshots()[ or if _pose
+  // is too small.
+  bool ReadSnapshot(int _snapshot,
+                    const Range<math::SoaTransform>& _pose) const;
+
+  // Gets the recorded data size in bytes, excluding growth slack.
+  size_t size() const;
+
+  // Serialization functions.
+  // Should not be called directly but through io::Archive << and >> operators.
+  void Save(ozz::io::OArchive& _archive) const;
+  void Load(ozz::io::IArchive& _archive, uint32_t _version);
+
+ private:
+  // Disables copy and assignation.
+  PoseStream(PoseStream const&);
+  void operator=(PoseStream const&);
+
+  // Releases all buffers.
+  void Deallocate();
+
+  // Recording settings.
+  Settings settings_;
+
+  // Number of frames and snapshots.
+  int num_frames_;
+  int num_snapshots_;
+
+  // Number of soa transforms of snapshots.
+  int num_soa_transforms_;
+
+  // Frames data, and offset of every frame (plus the end of the last one) in
+  // frames_. Buffers capacity is their count, used sizes are deduced from the
+  // number of frames.
+  Range<char> frames_;
+  Range<uint32_t> frame_offsets_;
+
+  // Snapshots encoded data, and offset of every snapshot (plus the end of the
+  // last one).
+  Range<char> snapshots_;
+  Range<uint32_t> snapshot_offsets_;
+};
+
+// ozz::animation::PoseStreamDecodingJob reconstructs the local-space pose of a
+// PoseStream frame. Every frame layer is sampled with a SamplingJob, using the
+// animations the stream was recorded with, and layers are blended with a
+// BlendingJob. Snapshot frames output their recorded pose instead, unless
+// use_snapshots is false.
+// Frame IK targets are output as-is, applying IK remains the user's choice.
+struct PoseStreamDecodingJob {
+  // Default constructor, initializes default values.
+  PoseStreamDecodingJob();
+
+  // Validates job parameters. Returns true for a valid job, or false otherwise:
+  // -if any input pointer is NULL.
+  // -if output is smaller than skeleton number of soa joints.
+  // -if frame isn't in range [0,stream->num_frames()[.
+  bool Validate() const;
+
+  // Runs job's execution task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid, if a frame layer clip isn't in
+  // animations range, if scratch is smaller than the number of frame layers
+  // times skeleton number of soa joints, or if a job fails.
+  bool Run() const;
+
+  // Job input.
+
+  // Stream to decode.
+  const PoseStream* stream;
+
+  // Frame to decode.
+  int frame;
+
+  // Outputs recorded snapshot pose for snapshot frames. Default is true.
+  bool use_snapshots;
+
+  // Animations indexed by layer clips.
+  Range<const Animation* const> animations;
+
+  // Skeleton whose bind pose is used for blending.
+  const Skeleton* skeleton;
+
+  // Cache used to sample every layer.
+  SamplingCache* cache;
+
+  // Layers sampling buffer, of at least the number of frame layers times
+  // skeleton number of soa joints elements.
+  Range<math::SoaTransform> scratch;
+
+  // Job output.
+
+  // Decoded local-space pose.
+  Range<math::SoaTransform> output;
+
+  // Optional IK targets output, and their number. Targets exceeding the range
+  // are skipped.
+  Range<math::Float3> ik_targets;
+  int* num_ik_targets;
+};
+}  // namespace animation
+
+namespace io {
+OZZ_IO_TYPE_VERSION(1, animation::PoseStream)
+OZZ_IO_TYPE_TAG("ozz-pose_stream", animation::PoseStream)
+}  // namespace io
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_POSE_STREAM_H_
@@ -0,0 +1,160 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_QUANTIZED_TRACK_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_QUANTIZED_TRACK_H_
+
+#include "ozz/base/io/archive_traits.h"
+#include "ozz/base/platform.h"
+
+#include "ozz/base/maths/vec_float.h"
+
+namespace ozz {
+namespace animation {
+
+// Forward declares the TrackBuilder, used to instantiate a QuantizedTrack.
+namespace offline {
+class TrackBuilder;
+}
+
+namespace internal {
+// Runtime quantized user-channel track internal implementation.
+// The quantized track data structure exists for 1 to 4 float types
+// (QuantizedFloatTrack, ..., QuantizedFloat4Track). It's built from the same
+// raw tracks as Track, see TrackBuilder::Quantize(). Keyframe ratios are
+// quantized to 16 bits. Each value component is quantized to 8 or 16 bits,
+// normalized in the [min,max] range of this component over the track. Value
+// precision is chosen by the builder according to its tolerance. Quantized
+// tracks are sampled by the same TrackSamplingJob as Track, decoding keys
+// transparently.
+template <typename _ValueType>
+class QuantizedTrack {
+ public:
+  typedef _ValueType ValueType;
+
+  enum {
+    // Number of float components of a ValueType.
+    kComponents = sizeof(_ValueType) / sizeof(float),
+    // Maximum quantized ratio, matching ratio 1.
+    kMaxRatio = 65535
+  };
+
+  QuantizedTrack();
+  ~QuantizedTrack();
+
+  // Keyframe accessors.
+  // Ratios are quantized in range [0,kMaxRatio].
+  Range<const uint16_t> ratios() const { return ratios_; }
+  // Values buffer, kComponents values of value_size() bytes per keyframe.
+  Range<const uint8_t> values() const { return values_; }
+  Range<const uint8_t> steps() const { return steps_; }
+
+  // Gets the size in bytes of each quantized value component, 1 or 2.
+  int value_size() const { return value_size_; }
+
+  // Decodes _key value.
+  ValueType value(size_t _key) const {
+    ValueType decoded;
+    float* components = reinterpret_cast<float*>(&decoded);
+    const size_t begin = _key * kComponents;
+    if (value_size_ == 1) {
+      for (int c = 0; c < kComponents; ++c) {
+        components[c] = offsets_[c] + values_[begin + c] * scales_[c];
+      }
+    } else {
+      const uint16_t* values = reinterpret_cast<const uint16_t*>(values_.begin);
+      for (int c = 0; c < kComponents; ++c) {
+        components[c] = offsets_[c] + values[begin + c] * scales_[c];
+      }
+    }
+    return decoded;
+  }
+
+  // Get the estimated track's size in bytes.
+  size_t size() const;
+
+  // Get track name.
+  const char* name() const { return name_ ? name_ : ""; }
+
+  // Serialization functions.
+  // Should not be called directly but through io::Archive << and >> operators.
+  void Save(ozz::io::OArchive& _archive) const;
+  void Load(ozz::io::IArchive& _archive, uint32_t _version);
+
+ private:
+  // Disables copy and assignation.
+  QuantizedTrack(QuantizedTrack const&);
+  void operator=(QuantizedTrack const&);
+
+  // TrackBuilder class is allowed to allocate a QuantizedTrack.
+  friend class offline::TrackBuilder;
+
+  // Internal destruction function.
+  void Allocate(size_t _keys_count, int _value_size, size_t _name_len);
+  void Deallocate();
+
+  // Quantized keyframe ratios.
+  Range<uint16_t> ratios_;
+
+  // Quantized keyframe values.
+  Range<uint8_t> values_;
+
+  // Keyframe modes (1 bit per key): 1 for step, 0 for linear.
+  Range<uint8_t> steps_;
+
+  // Size in byte of each value component.
+  int value_size_;
+
+  // Per component decoding parameters: value = offset + quantized * scale.
+  float offsets_[kComponents];
+  float scales_[kComponents];
+
+  // Track name.
+  char* name_;
+};
+}  // namespace internal
+
+// Runtime quantized track data structure instantiation.
+class QuantizedFloatTrack : public internal::QuantizedTrack<float> {};
+class QuantizedFloat2Track : public internal::QuantizedTrack<math::Float2> {};
+class QuantizedFloat3Track : public internal::QuantizedTrack<math::Float3> {};
+class QuantizedFloat4Track : public internal::QuantizedTrack<math::Float4> {};
+
+}  // namespace animation
+namespace io {
+OZZ_IO_TYPE_VERSION(1, animation::QuantizedFloatTrack)
+OZZ_IO_TYPE_TAG("ozz-quantized_float_track", animation::QuantizedFloatTrack)
+OZZ_IO_TYPE_VERSION(1, animation::QuantizedFloat2Track)
+OZZ_IO_TYPE_TAG("ozz-quantized_float2_track", animation::QuantizedFloat2Track)
+OZZ_IO_TYPE_VERSION(1, animation::QuantizedFloat3Track)
+OZZ_IO_TYPE_TAG("ozz-quantized_float3_track", animation::QuantizedFloat3Track)
+OZZ_IO_TYPE_VERSION(1, animation::QuantizedFloat4Track)
+OZZ_IO_TYPE_TAG("ozz-quantized_float4_track", animation::QuantizedFloat4Track)
+}  // namespace io
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_QUANTIZED_TRACK_H_
@@ -0,0 +1,85 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_REMAP_JOB_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_REMAP_JOB_H_
+
+#include "ozz/base/platform.h"
+
+namespace ozz {
+
+// Forward declaration of math structures.
+namespace math {
+struct SoaTransform;
+}
+
+namespace animation {
+
+// Remaps a local-space pose from a source skeleton joints order to a target
+// skeleton joints order, using a joint remap table (see BuildJointRemap()).
+// This allows to share a single Animation between compatible skeletons (like
+// skeleton variants that differ by a few extra joints): the animation is
+// sampled for the skeleton it was built for, and the sampled pose is then
+// remapped to each variant.
+// Output joints whose remap entry is negative aren't written, which means they
+// keep the value of the output buffer. Output is usually initialized with the
+// target skeleton bind pose for these joints.
+// Soa blocks of 4 joints that are remapped to a matching source block (same
+// order, soa aligned) are copied at once.
+// The job does not owned the buffers (in/output) and will thus not delete
+// them during job's destruction.
+struct RemapJob {
+  // Default constructor, initializes default values.
+  RemapJob();
+
+  // Validates job parameters. Returns true for a valid job, or false otherwise:
+  // -if any range is invalid or input and output are the same buffer.
+  // -if output range is smaller than the number of soa joints of remap table.
+  // -if any remap entry is out of input range.
+  bool Validate() const;
+
+  // Runs job's remapping task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // Remap table, one entry per target (output) joint. Every entry is the index
+  // of the source (input) joint to copy, or a negative value to leave the
+  // output joint unchanged.
+  Range<const int> remap;
+
+  // Source local-space pose, in soa format, ordered like the source skeleton.
+  Range<const ozz::math::SoaTransform> input;
+
+  // Job output.
+  // Target local-space pose, in soa format, ordered like the target skeleton.
+  Range<ozz::math::SoaTransform> output;
+};
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_REMAP_JOB_H_
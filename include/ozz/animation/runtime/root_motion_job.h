@@ -0,0 +1,99 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_ROOT_MOTION_JOB_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_ROOT_MOTION_JOB_H_
+
+#include "ozz/base/platform.h"
+
+namespace ozz {
+
+// Forward declaration of math structures.
+namespace math {
+struct Float3;
+struct Quaternion;
+}  // namespace math
+
+namespace animation {
+
+// Forward declares root motion track types.
+class Float3Track;
+class QuaternionTrack;
+
+// Computes root motion delta between two ratios, from root motion translation
+// and rotation tracks (see offline::RootMotionExtractor). This allows to move
+// a character by its animation root motion, without sampling the animation
+// pose twice and diffing root joint transforms.
+// Ratios aren't clamped to [0,1], as each unit interval of ratio is a loop of
+// the animation: ratio 1.2 is 20% of the second loop. Looping wrap is thus
+// handled by accumulating ratios over time (from .9 to 1.1 plays the end of
+// the first loop and the beginning of the second one). Whole loops motion is
+// accumulated, so that a turning animation keeps turning. A non looping
+// animation should clamp ratios to [0,1] instead. to can be smaller than
+// from, when playing backward.
+// The delta is expressed in root motion space at ratio from: a character
+// whose transform is T at from should be at T * delta at to, aka translated
+// by T.rotation * delta_translation, and rotated by delta_rotation.
+struct RootMotionJob {
+  // Default constructor, initializes default values.
+  RootMotionJob();
+
+  // Validates job parameters. Returns true for a valid job, or false otherwise:
+  // -if any input or output pointer is NULL.
+  bool Validate() const;
+
+  // Runs root motion job's task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // Ratio from which root motion is computed, usually the ratio sampled by the
+  // previous frame.
+  float from;
+
+  // Ratio to which root motion is computed, usually the ratio sampled by the
+  // current frame.
+  float to;
+
+  // Root motion translation track.
+  const Float3Track* translation;
+
+  // Root motion rotation track.
+  const QuaternionTrack* rotation;
+
+  // Job output.
+
+  // Translation from ratio from to ratio to.
+  math::Float3* delta_translation;
+
+  // Rotation from ratio from to ratio to.
+  math::Quaternion* delta_rotation;
+};
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_ROOT_MOTION_JOB_H_
@@ -0,0 +1,123 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_SAMPLING_CACHE_POOL_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_SAMPLING_CACHE_POOL_H_
+
+#include "ozz/animation/runtime/sampling_job.h"
+#include "ozz/base/platform.h"
+
+namespace ozz {
+namespace animation {
+
+// Forward declares the animation type to sample.
+class Animation;
+
+// Stores warm SamplingCache state for the most recently sampled animations of
+// an instance (like a character whose state machine or blend tree switches
+// between many animations). A single SamplingCache is invalidated, and thus
+// re-seeded, every time it samples a different animation. The pool instead
+// dedicates a cache to each of the last sampled animations, so that
+// re-entering an animation resumes from its cache state. Least recently used
+// caches are recycled first.
+// Caches are keyed by animation address and unique identifier (see
+// Animation::uid()), so a cache is never reused for a different animation
+// allocated at the same address.
+class SamplingCachePool {
+ public:
+  // Constructs an empty pool. The pool needs to be resized before it can be
+  // used.
+  SamplingCachePool();
+
+  // Constructs a pool of _num_caches caches, in _mode, that can sample
+  // animations with at most _max_tracks tracks.
+  SamplingCachePool(int _max_tracks, int _num_caches,
+                    SamplingCache::Mode _mode = SamplingCache::kFull);
+
+  // Deallocates pool and its caches.
+  ~SamplingCachePool();
+
+  // Resizes the pool, invalidating all caches.
+  void Resize(int _max_tracks, int _num_caches,
+              SamplingCache::Mode _mode = SamplingCache::kFull);
+
+  // Invalidates all caches.
+  void Invalidate();
+
+  // Gets the cache to use to sample _animation, aka the cache that sampled
+  // _animation last, or the least recently used one otherwise (which is
+  // invalidated). The returned cache must be used for _animation only, until
+  // next call to Get().
+  // Returns NULL if the pool is empty or if _animation has more tracks than
+  // the pool supports.
+  SamplingCache* Get(const Animation& _animation);
+
+  // Tells if _animation currently has a cache in the pool.
+  bool Contains(const Animation& _animation) const;
+
+  // The number of caches and maximum number of tracks that the pool can
+  // handle.
+  int num_caches() const { return num_caches_; }
+  int max_tracks() const { return max_soa_tracks_ * 4; }
+  int max_soa_tracks() const { return max_soa_tracks_; }
+
+ private:
+  // Disables copy and assignation.
+  SamplingCachePool(SamplingCachePool const&);
+  void operator=(SamplingCachePool const&);
+
+  // Deallocates all caches.
+  void Deallocate();
+
+  // Describes a pool slot.
+  struct Entry {
+    // The cache of this slot.
+    SamplingCache* cache;
+
+    // The animation this cache was last used for, and its unique identifier.
+    // NULL if the cache is unused.
+    const Animation* animation;
+    uint32_t uid;
+
+    // Last time this entry was used, used to recycle least recently used
+    // entries first.
+    unsigned int last_use;
+  };
+
+  // Number of caches and maximum number of soa tracks.
+  int num_caches_;
+  int max_soa_tracks_;
+
+  // Incremented on every Get().
+  unsigned int use_counter_;
+
+  // Pool entries.
+  Entry* entries_;
+};
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_SAMPLING_CACHE_POOL_H_
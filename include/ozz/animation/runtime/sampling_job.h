@@ -28,15 +28,26 @@
 #ifndef OZZ_OZZ_ANIMATION_RUNTIME_SAMPLING_JOB_H_
 #define OZZ_OZZ_ANIMATION_RUNTIME_SAMPLING_JOB_H_
 
+#include "ozz/base/maths/simd_math.h"
 #include "ozz/base/platform.h"
 
 namespace ozz {
 
+// Forward declares the task scheduler used by BatchSamplingJob.
+class TaskScheduler;
+
 // Forward declaration of math structures.
 namespace math {
+struct SoaFloat3;
+struct SoaHalfTransform;
 struct SoaTransform;
 }
 
+// Forward declaration of memory allocator.
+namespace memory {
+class Allocator;
+}
+
 namespace animation {
 
 // Forward declares the animation type to sample.
@@ -45,6 +56,50 @@ class Animation;
 // Forward declares the cache object used by the SamplingJob.
 class SamplingCache;
 
+// Forward declares the weighted accumulation output of the SamplingJob.
+struct SoaBlendAccumulator;
+
+// Sampling performance counters, incremented by sampling jobs when provided
+// (see SamplingJob::counters). They tell how much work sampling an animation
+// costs, so clip compression and cache policies can be tuned from real data.
+// Counters aren't atomic: concurrent jobs must use their own counters (like
+// one per thread, or one per character), which can then be aggregated.
+struct SamplingCounters {
+  // Default constructor, initializes all counters to 0.
+  SamplingCounters();
+
+  // Resets all counters to 0.
+  void Reset();
+
+  // Aggregates _other counters to *this ones.
+  SamplingCounters& operator+=(const SamplingCounters& _other);
+
+  // Number of animations sampled, or cache updated.
+  int64_t samples;
+
+  // Number of translation, rotation and scale keyframes scanned by cache
+  // cursors, including the keys read when a cache is (re-)seeded.
+  int64_t keys_scanned;
+
+  // Number of outdated soa entries (4 translations, rotations or scales)
+  // decompressed.
+  int64_t decompressed;
+
+  // Number of cache invalidations, because animation changed or was sampled
+  // backward.
+  int64_t invalidations;
+
+  // Number of times the cache was re-seeded from an animation seek point.
+  int64_t seeks;
+
+  // Number of times a looping cache wrapped back to the beginning of the
+  // animation without being invalidated, see SamplingJob::loop.
+  int64_t wraps;
+};
+
+// Aggregates a range of counters, like per-thread counters.
+SamplingCounters Aggregate(const Range<const SamplingCounters>& _counters);
+
 // Samples an animation at a given time ratio in the unit interval [0,1] (where
 // 0 is the beginning of the animation, 1 is the end), to output the
 // corresponding posture in local-space.
@@ -52,15 +107,28 @@ class SamplingCache;
 // (decompressed animation keyframes...) while sampling. This cache also stores
 // pre-computed values that allows drastic optimization while playing/sampling
 // the animation forward. Backward sampling works, but isn't optimized through
-// the cache. The job does not owned the buffers (in/output) and will thus not
-// delete them during job's destruction.
+// the cache, unless the animation was built with seek points (see
+// AnimationBuilder::seek_interval), in which case the cache is re-seeded from
+// the closest seek point. The job does not owned the buffers (in/output) and
+// will thus not delete them during job's destruction.
 struct SamplingJob {
   // Default constructor, initializes default values.
   SamplingJob();
 
   // Validates job parameters. Returns true for a valid job, or false otherwise:
   // -if any input pointer is NULL
-  // -if output range is invalid.
+  // -if output range is invalid, or more than one of output, half_output and
+  // accumulator are specified.
+  // -if accumulator is specified along with changed, if weight is negative or
+  // if joint_weights is specified but is too small for the animation.
+  // -if a sparse animation is scattered along with velocities.
+  // -if precision_lod is negative.
+  // -if mask is specified but is too small for the animation.
+  // -if changed is specified but is too small for the animation.
+  // -if velocities ranges are specified but are too small for the animation.
+  // -if cache is in compact mode, but animation has too many keys, or float
+  //  key times (see Animation::has_key_times()).
+  // -if animation is a spline animation, but cache isn't in spline mode.
   bool Validate() const;
 
   // Runs job's sampling task.
@@ -69,6 +137,14 @@ struct SamplingJob {
   // Returns false if *this job is not valid.
   bool Run() const;
 
+  // Runs job's sampling task without validating the job first. This removes
+  // validation cost from jobs that run every frame with the same animation,
+  // cache and buffers: such a job can be validated once (see Validate() and
+  // ozz::PreparedJob), and then be run with an updated ratio. Validation is
+  // only asserted in debug builds, the behavior is undefined if *this job
+  // isn't valid.
+  void RunUnchecked() const;
+
   // Time ratio in the unit interval [0,1] used to sample animation (where 0 is
   // the beginning of the animation, 1 is the end). It should be computed as the
   // current time in the animation , divided by animation duration.
@@ -76,12 +152,55 @@ struct SamplingJob {
   // approximation issue on range bounds.
   float ratio;
 
+  // Defines sampling quality, which is a tradeoff between interpolated
+  // rotations precision and performance. Each quality runs a specialized
+  // interpolation kernel.
+  enum Quality {
+    // Normalizes interpolated rotations with a single reciprocal square root
+    // estimation. This is the cheapest and least precise mode, intended for
+    // crowds for example.
+    kFast,
+    // Normalizes interpolated rotations with a refined reciprocal square root
+    // estimation. This is the default mode.
+    kStandard,
+    // Normalizes interpolated rotations with a full precision square root and
+    // division. This is the most precise and expensive mode, intended for
+    // close-up characters or cinematics.
+    kAccurate,
+  };
+
+  // Sampling quality, kStandard by default.
+  Quality quality;
+
+  // Tells that the animation is played in loop. A ratio lower than the
+  // previous one sampled with the cache is then considered as wrapping back
+  // to the beginning of the animation: instead of invalidating the cache,
+  // keys are re-seeded from the first key frames of the animation, and only
+  // the soa entries whose keys differ are decompressed again. Entries of
+  // tracks whose keys are the same at both ends of the animation (constant
+  // tracks, or tracks with only a first and last key) are kept. This smooths
+  // the cost of looping clips, which would otherwise decompress all entries
+  // every cycle. Playing backward remains supported, but is as costly as
+  // without loop mode. Default is false.
+  bool loop;
+
   // The animation to sample.
   const Animation* animation;
 
   // A cache object that must be big enough to sample *this animation.
   SamplingCache* cache;
 
+  // Optional soa tracks mask, one bit per soa track (aka 4 joints), lowest bit
+  // first: bit i & 7 of byte i / 8 is soa track i. Only soa tracks whose bit is
+  // set are decompressed and interpolated, output of other soa tracks is left
+  // unchanged. This allows to implement level of details, by sampling only a
+  // subset of the joints (like root, spine and head) of distant characters.
+  // Masked out tracks are kept outdated by the cache, so they can be unmasked
+  // at any time. If specified, mask must contain at least
+  // (animation->num_soa_tracks() + 7) / 8 bytes. Default empty mask samples all
+  // tracks.
+  Range<const uint8_t> mask;
+
   // Job output.
   // The output range to be filled with sampled joints during job execution.
   // If there are less joints in the animation compared to the output range,
@@ -89,6 +208,307 @@ struct SamplingJob {
   // If there are more joints in the animation, then the last joints are not
   // sampled.
   Range<ozz::math::SoaTransform> output;
+
+  // Half precision job output, which can be specified instead of output (but
+  // not along with it). It has the same semantic as output, but sampled
+  // joints are converted to half precision by the interpolation kernels,
+  // halving the memory footprint and bandwidth of intermediate poses. This is
+  // intended for blend trees, whose BlendingJob layers can read half precision
+  // poses, see BlendingJob::Layer::half_transform.
+  Range<ozz::math::SoaHalfTransform> half_output;
+
+  // Weighted accumulation output, which can be specified instead of output or
+  // half_output. Sampled joints are multiplied by weight (and joint_weights)
+  // and added to the accumulator by the interpolation kernels, the same way a
+  // BlendingJob layer is. Blend tree leaves can thus be sampled directly to a
+  // single accumulator, without storing intermediate poses, which are then
+  // normalized with an AccumulatedBlendingJob. Accumulation can't be
+  // incremental, so it can't be used along with changed. Masked out soa
+  // tracks aren't accumulated.
+  Range<SoaBlendAccumulator> accumulator;
+
+  // Weight of the sampled pose, when accumulated to accumulator. It must be
+  // positive or null. Default value is 1.
+  float weight;
+
+  // Optional per joint weights, when accumulated to accumulator. They have the
+  // same semantic as BlendingJob::Layer::joint_weights and are multiplied by
+  // weight. If specified, joint_weights must contain at least
+  // animation->num_soa_tracks() elements.
+  Range<const math::SimdFloat4> joint_weights;
+
+  // Scatters sparse animations (see Animation::soa_joints()) to a full
+  // skeleton pose: soa track i is stored to soa track
+  // animation->soa_joints()[i] of output, half_output or accumulator, and
+  // joint_weights are read at the same index. Other output soa tracks are left
+  // unchanged, so a partial clip can be sampled over a base pose, or
+  // accumulated with an implicit mask (its joints only gain weight). Output,
+  // half_output or accumulator, and joint_weights, must then contain at least
+  // the last soa joint + 1 elements. mask and changed remain per animation soa
+  // track. It has no effect on animations that aren't sparse.
+  // Default value is false.
+  bool scatter;
+
+  // Precision level of detail, which skips the keys whose precision lod (see
+  // Animation::translation_key_lods()) is lower, so that distant characters
+  // are sampled with less keys. Coarser keys also mean less soa entries to
+  // decompress, as the cache jumps over skipped keys instead of stepping
+  // through them. 0 samples all keys, lods higher than the coarsest one built
+  // (see AnimationBuilder::precision_lods) are the same as it. The lod can
+  // change from a job run to the next, the cache switches without
+  // invalidation. It has no effect on animations without precision lod.
+  // Default value is 0.
+  int precision_lod;
+
+  // Optional changed soa tracks output, with the same layout as mask. If
+  // specified, the job runs incrementally: output is expected to be the same
+  // persistent pose as the previous incremental run with this cache, and soa
+  // tracks whose value can't have changed since then (all their keys are
+  // constant over the current interval) aren't interpolated again. The bits of
+  // the soa tracks that were written are set, others (unchanged or masked out)
+  // are cleared. This allows downstream jobs to skip unchanged work. If
+  // specified, changed must contain at least (animation->num_soa_tracks() + 7)
+  // / 8 bytes.
+  Range<uint8_t> changed;
+
+  // Optional local-space velocities outputs, one SoaFloat3 per soa track like
+  // output. They are computed analytically from the same cached keys as the
+  // sampled pose, at a fraction of its cost, instead of sampling the animation
+  // twice and differentiating the results. linear_velocities receives
+  // translations derivative, and angular_velocities the angular velocity of
+  // rotations (the axis scaled by the rate, in radian per second), both
+  // expressed in parent joint space. Velocities are per second of animation
+  // time, they must be scaled by the playback speed if any. They're the
+  // derivatives of the interpolation curves: piecewise constant translations
+  // velocities for linear animations, continuous ones for splines. Only soa
+  // tracks that are written to output (see mask and changed) are written, as
+  // incrementally unchanged tracks have steady keys, hence null velocities. If
+  // specified, ranges must be at least as big as output.
+  Range<ozz::math::SoaFloat3> linear_velocities;
+  Range<ozz::math::SoaFloat3> angular_velocities;
+
+  // Optional performance counters, incremented by the job. Default value is
+  // NULL, meaning nothing is counted.
+  SamplingCounters* counters;
+};
+
+// Samples a single animation for a batch of instances (like crowd characters)
+// sharing the same animation clip, each with its own time ratio, cache and
+// output. This is equivalent to running a SamplingJob per instance, but
+// animation related validation and setup are done once for the whole batch.
+// Moreover, an instance sampled at the same ratio as the previous instance of
+// the batch reuses its output instead of decompressing and interpolating
+// keyframes again. Sorting instances by ratio (or grouping identical ratios
+// together) thus maximizes sharing.
+// Instances can be sampled concurrently, by groups of grain_size instances
+// dispatched to a TaskScheduler.
+// The job does not owned the buffers (in/output) and will thus not delete
+// them during job's destruction.
+struct BatchSamplingJob {
+  // Default constructor, initializes default values.
+  BatchSamplingJob();
+
+  // Validates job parameters. Returns true for a valid job, or false otherwise:
+  // -if animation pointer is NULL.
+  // -if ratios, caches and outputs ranges don't have the same number of
+  // elements, or if counters isn't empty and doesn't either.
+  // -if any cache is NULL or can't sample the animation.
+  // -if any output range is invalid.
+  // -if grain_size is lower or equal to 0, or prefetch_distance is negative.
+  bool Validate() const;
+
+  // Runs job's sampling task, using scheduler if any, or sequentially from the
+  // calling thread otherwise.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // The animation to sample, shared by all instances.
+  const Animation* animation;
+
+  // Sampling quality shared by all instances, see SamplingJob::Quality.
+  // SamplingJob::kStandard by default.
+  SamplingJob::Quality quality;
+
+  // Per-instance time ratio in the unit interval [0,1], with the same
+  // semantic as SamplingJob::ratio.
+  Range<const float> ratios;
+
+  // Per-instance cache objects. Each one must be big enough to sample *this
+  // animation. A cache can't be used twice in the same batch.
+  Range<SamplingCache* const> caches;
+
+  // Job output.
+  // Per-instance output range, with the same semantic as SamplingJob::output.
+  Range<const Range<ozz::math::SoaTransform> > outputs;
+
+  // Optional per-instance performance counters, see SamplingJob::counters.
+  // Must be empty or have the same number of elements as ratios. Instances
+  // sharing a previous instance output don't count any sample.
+  Range<SamplingCounters> counters;
+
+  // Scheduler used to dispatch groups of instances. Default value is NULL,
+  // meaning all instances are sampled sequentially by the calling thread.
+  TaskScheduler* scheduler;
+
+  // Number of instances sampled by each task dispatched to scheduler. Output
+  // sharing between instances with the same ratio only happens within a
+  // group, so the bigger the better as long as there are enough groups to
+  // feed all threads. Unused if scheduler is NULL.
+  // Default value is 16.
+  int grain_size;
+
+  // Number of instances ahead of the one being sampled whose cache, animation
+  // keys at cache cursors and output are prefetched. Instances of a crowd are
+  // usually cold in memory, so prefetching hides memory latency behind the
+  // sampling of previous instances. The optimal distance depends on the
+  // platform and on the animation size: too short and data don't arrive in
+  // time, too long and they are evicted before being used. 2 to 4 is a good
+  // start. Prefetching doesn't cross grain_size groups boundaries.
+  // Default value is 0, meaning that nothing is prefetched.
+  int prefetch_distance;
+
+ private:
+  // Samples instances in range [_begin, _end[.
+  void Sample(int _begin, int _end) const;
+
+  // TaskScheduler task that samples group _index of grain_size instances.
+  static void SampleTask(void* _context, int _index);
+};
+
+// Samples a batch of instances (like crowd characters) that each play their
+// own animation, amongst a set of shared animations. Instances are sorted by
+// animation and ratio before being sampled, so that each worker streams
+// through one animation's keyframes for many instances, instead of jumping
+// from one animation to another. Like BatchSamplingJob, an instance sampled at
+// the same animation and ratio as the previous sorted instance reuses its
+// output.
+// Sorted instances are dispatched to scheduler by groups of grain_size.
+// The job does not owned the buffers (in/output) and will thus not delete
+// them during job's destruction.
+struct GroupedSamplingJob {
+  // Default constructor, initializes default values.
+  GroupedSamplingJob();
+
+  // Validates job parameters. Returns true for a valid job, or false otherwise:
+  // -if animations, ratios, caches and outputs ranges don't have the same
+  // number of elements, or if counters isn't empty and doesn't either.
+  // -if any animation or cache is NULL, or if a cache can't sample its
+  // instance animation.
+  // -if any output range is invalid.
+  // -if order range is smaller than the number of instances.
+  // -if grain_size is lower or equal to 0, or prefetch_distance is negative.
+  bool Validate() const;
+
+  // Runs job's sampling task, using scheduler if any, or sequentially from the
+  // calling thread otherwise.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // Per-instance animation to sample.
+  Range<const Animation* const> animations;
+
+  // Sampling quality shared by all instances, see SamplingJob::Quality.
+  // SamplingJob::kStandard by default.
+  SamplingJob::Quality quality;
+
+  // Per-instance time ratio in the unit interval [0,1], with the same
+  // semantic as SamplingJob::ratio.
+  Range<const float> ratios;
+
+  // Per-instance cache objects. Each one must be big enough to sample its
+  // instance animation. A cache can't be used twice in the same batch.
+  Range<SamplingCache* const> caches;
+
+  // Scheduler used to dispatch groups of sorted instances. Default value is
+  // NULL, meaning all instances are sampled sequentially by the calling
+  // thread.
+  TaskScheduler* scheduler;
+
+  // Number of sorted instances sampled by each task dispatched to scheduler.
+  // Unused if scheduler is NULL.
+  // Default value is 16.
+  int grain_size;
+
+  // Number of sorted instances ahead of the one being sampled that are
+  // prefetched, see BatchSamplingJob::prefetch_distance.
+  // Default value is 0, meaning that nothing is prefetched.
+  int prefetch_distance;
+
+  // Job output.
+
+  // Per-instance output range, with the same semantic as SamplingJob::output.
+  Range<const Range<ozz::math::SoaTransform> > outputs;
+
+  // Optional per-instance performance counters, see
+  // BatchSamplingJob::counters. Must be empty or have the same number of
+  // elements as animations.
+  Range<SamplingCounters> counters;
+
+  // Receives instances indices, in the order they were sampled (sorted by
+  // animation, then by ratio). Must be at least as big as the number of
+  // instances. This is also the scratch buffer used for sorting.
+  Range<int> order;
+
+ private:
+  // Samples sorted instances in range [_begin, _end[.
+  void Sample(int _begin, int _end) const;
+
+  // TaskScheduler task that samples group _index of grain_size instances.
+  static void SampleTask(void* _context, int _index);
+};
+
+// Warms up a cache for sampling an animation at a given ratio, without
+// interpolating any output: animation keys are seeked (or re-seeded from seek
+// points) and decompressed to the cache, so that the next SamplingJob at this
+// ratio only interpolates. A cache used for the first time otherwise pays for
+// this full seed, which makes for spikes when many characters spawn during
+// the same frame.
+// The cache can optionally be cloned from a source cache already warm for the
+// same animation, which is cheaper than seeking keys when source ratio is
+// close to (and lower or equal than) the requested one.
+// The job only writes to cache, and reads from animation and source, so it
+// can be run from a worker thread (see ozz::RunJobs() to warm a batch of
+// caches concurrently) ahead of the frame the cache is needed, as long as no
+// other job uses the cache concurrently. A source cache can be shared by
+// concurrent warm up jobs.
+struct CacheWarmUpJob {
+  // Default constructor, initializes default values.
+  CacheWarmUpJob();
+
+  // Validates job parameters. Returns true for a valid job, or false otherwise:
+  // -if animation or cache pointer is NULL.
+  // -if cache can't sample animation, see SamplingJob::Validate().
+  // -if source is the same object as cache.
+  bool Validate() const;
+
+  // Runs job's warm up task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // Time ratio in the unit interval [0,1] at which the cache is warmed up,
+  // with the same semantic as SamplingJob::ratio.
+  float ratio;
+
+  // The animation the cache is warmed up for.
+  const Animation* animation;
+
+  // Optional cache to clone cache state from. It's only used if it's warm for
+  // animation at a ratio lower or equal to *this job ratio, and if it can be
+  // copied to cache (see SamplingCache::CopyFrom()). Default value is NULL.
+  const SamplingCache* source;
+
+  // Job output.
+  // The cache to warm up.
+  SamplingCache* cache;
+
+  // Optional performance counters, see SamplingJob::counters.
+  SamplingCounters* counters;
 };
 
 namespace internal {
@@ -96,12 +516,23 @@ namespace internal {
 struct InterpSoaTranslation;
 struct InterpSoaRotation;
 struct InterpSoaScale;
+struct PackedSoaFloat3;
+struct PackedSoaRotation;
+struct InterpSoaFloat3Tangent;
+struct InterpSoaQuaternionTangent;
 }  // namespace internal
 
 // Declares the cache object used by the workload to take advantage of the
 // frame coherency of animation sampling.
 class SamplingCache {
  public:
+  // Defines cache modes, see Resize().
+  enum Mode {
+    kFull,     // Full precision interpolation key frames.
+    kCompact,  // Quantized interpolation key frames and 16 bits key indices.
+    kSpline,   // Full precision, including tangents of spline animations.
+  };
+
   // Constructs an empty cache. The cache needs to be resized with the
   // appropriate number of tracks before it can be used with a SamplingJob.
   SamplingCache();
@@ -109,63 +540,196 @@ class SamplingCache {
   // Constructs a cache that can be used to sample any animation with at most
   // _max_tracks tracks. _num_tracks is internally aligned to a multiple of
   // soa size, which means max_tracks() can return a different (but bigger)
-  // value than _max_tracks.
-  explicit SamplingCache(int _max_tracks);
+  // value than _max_tracks. See Resize() for cache modes.
+  explicit SamplingCache(int _max_tracks, Mode _mode = kFull);
+
+  // Constructs a cache like the constructor above, with cache data allocated
+  // from _allocator instead of the default allocator, like a per-thread pool.
+  // _allocator must outlive the cache.
+  SamplingCache(int _max_tracks, Mode _mode, memory::Allocator* _allocator);
 
   // Deallocates cache.
   ~SamplingCache();
 
-  // Resize the number of joints that the cache can support.
-  // This also implicitly invalidate the cache.
-  void Resize(int _max_tracks);
+  // Resize the number of joints that the cache can support, and sets cache
+  // _mode. This also implicitly invalidate the cache.
+  // In kCompact mode, the cache stores key indices on 16 bits, and
+  // interpolation key frames in their quantized form instead of full precision
+  // SoA values. This halves cache memory footprint, at the cost of restoring
+  // values on every sampling. A compact cache can only sample animations with
+  // at most 65536 keys per transformation type, whose key times are stored as
+  // frame indices (see SamplingJob::Validate()).
+  // In kSpline mode, the cache also stores interpolation key frames tangents,
+  // which is required to sample spline animations (see Animation::spline()).
+  // Only spline mode caches can sample spline animations, but they can sample
+  // linear ones too.
+  void Resize(int _max_tracks, Mode _mode = kFull);
+
+  // Gets the size in bytes of the single memory block a cache allocates to
+  // support _max_tracks in _mode. The block is allocated with
+  // kAllocationAlignment alignment.
+  static size_t AllocationSize(int _max_tracks, Mode _mode);
+
+  // Alignment of the cache memory block.
+  enum { kAllocationAlignment = 16 };
+
+  // Copies _other cache state (animation, ratio, keys and decompressed key
+  // frames) to *this cache, so that *this cache is as warm as _other one. This
+  // is cheaper than warming up a new cache from scratch when many instances
+  // play the same animation, see CacheWarmUpJob.
+  // Returns false and leaves *this cache unchanged if modes differ, or if
+  // *this cache is too small for _other animation. An invalid _other cache
+  // invalidates *this cache. _other animation must still be alive.
+  bool CopyFrom(const SamplingCache& _other);
 
   // Invalidate the cache.
   // The SamplingJob automatically invalidates a cache when required
   // during sampling. This automatic mechanism is based on the animation
-  // address and sampling time ratio. The weak point is that it can result in a
-  // crash if ever the address of an animation is used again with another
-  // animation (could be the result of successive call to delete / new).
-  // Therefore it is recommended to manually invalidate a cache when it is
-  // known that this cache will not be used for with an animation again.
+  // address, its unique identifier (see Animation::uid()) and sampling time
+  // ratio. The identifier allows to detect an animation that was destroyed
+  // and another one allocated at the same address (could be the result of
+  // successive call to delete / new). It is still recommended to manually
+  // invalidate a cache when it is known that this cache will not be used for
+  // with an animation again.
   void Invalidate();
 
   // The maximum number of tracks that the cache can handle.
   int max_tracks() const { return max_soa_tracks_ * 4; }
   int max_soa_tracks() const { return max_soa_tracks_; }
 
+  // Gets cache mode, see Resize().
+  Mode mode() const { return mode_; }
+
+  // Tells if the cache is in compact mode, see Resize().
+  bool compact() const { return mode_ == kCompact; }
+
+  // Gets the allocator used to allocate cache data.
+  memory::Allocator* allocator() const { return allocator_; }
+
  private:
   // Disables copy and assignation.
   SamplingCache(SamplingCache const&);
   void operator=(SamplingCache const&);
 
   friend struct SamplingJob;
+  friend struct BatchSamplingJob;
+  friend struct GroupedSamplingJob;
+  friend struct PipelineJob;
+  friend struct CacheWarmUpJob;
+
+  // Samples _animation at _ratio (in unit interval) to _output, using *this
+  // cache. Only soa tracks set in the optional _mask are sampled (see
+  // SamplingJob::mask). Sampling is incremental if _changed is specified (see
+  // SamplingJob::changed). Rotations are normalized according to _quality.
+  // Job parameters must have been validated by the caller.
+  // Optional _counters are incremented. The cache wraps instead of being
+  // invalidated when sampled backward if _loop is true, see SamplingJob::loop.
+  // Soa track i is stored to _output soa track _scatter[i] if _scatter isn't
+  // NULL, see SamplingJob::scatter. Keys are skipped according to _lod, see
+  // SamplingJob::precision_lod.
+  void Sample(const Animation& _animation, float _ratio, const uint8_t* _mask,
+              uint8_t* _changed, math::SoaTransform* _output,
+              SamplingJob::Quality _quality,
+              SamplingCounters* _counters = NULL, bool _loop = false,
+              const int* _scatter = NULL, int _lod = 0);
+
+  // Half precision version of the function above, see SamplingJob::half_output.
+  void Sample(const Animation& _animation, float _ratio, const uint8_t* _mask,
+              uint8_t* _changed, math::SoaHalfTransform* _output,
+              SamplingJob::Quality _quality,
+              SamplingCounters* _counters = NULL, bool _loop = false,
+              const int* _scatter = NULL, int _lod = 0);
+
+  // Interpolates the keys decompressed by Update() to _output, which is either
+  // a SoaTransform or a SoaHalfTransform buffer, and updates incremental steady
+  // flags. Parameters have the same semantic as Sample() ones.
+  template <typename _Output>
+  void Interpolate(const Animation& _animation, float _ratio,
+                   const uint8_t* _mask, uint8_t* _changed, _Output* _output,
+                   SamplingJob::Quality _quality);
+
+  // Prefetches the cache data that sampling _animation reads, animation keys
+  // following cache cursors, and _output buffer. Doesn't modify the cache.
+  // _animation must be valid for *this cache, but doesn't need to be the one
+  // the cache currently refers to.
+  void Prefetch(const Animation& _animation,
+                const math::SoaTransform* _output) const;
+
+  // Computes the velocities of _animation at _ratio, from the keys of the last
+  // Sample() or Update() of _animation and _ratio with *this cache. Only soa
+  // tracks set in the optional _mask are computed. _linear or _angular
+  // velocities can be NULL, see SamplingJob::linear_velocities.
+  void Differentiate(const Animation& _animation, float _ratio,
+                     const uint8_t* _mask, math::SoaFloat3* _linear,
+                     math::SoaFloat3* _angular) const;
+
+  // Steps the cache to _animation and _ratio, and decompresses animation key
+  // frames of the soa tracks set in the optional _mask. This is the part of
+  // Sample() that doesn't depend on the output. Incremental changed tracks are
+  // selected if _changed is specified, see SamplingJob::changed. Keys are
+  // skipped according to _lod, see SamplingJob::precision_lod.
+  void Update(const Animation& _animation, float _ratio, const uint8_t* _mask,
+              uint8_t* _changed, SamplingCounters* _counters,
+              bool _loop = false, int _lod = 0);
 
   // Steps the cache in order to use it for a potentially new animation and
   // ratio. If the _animation is different from the animation currently cached,
   // or if the _ratio shows that the animation is played backward, then the
-  // cache is invalidated and reseted for the new _animation and _ratio.
-  void Step(const Animation& _animation, float _ratio);
+  // cache is invalidated and reseted for the new _animation and _ratio. If
+  // _loop is true, playing the same animation backward wraps the cache
+  // instead, see SamplingJob::loop.
+  // Invalidations, seeks and wraps are counted in optional _counters.
+  void Step(const Animation& _animation, float _ratio,
+            SamplingCounters* _counters, bool _loop);
 
   // The animation this cache refers to. NULL means that the cache is invalid.
   const Animation* animation_;
 
+  // Unique identifier of the animation this cache refers to.
+  uint32_t animation_uid_;
+
   // The current time ratio in the animation.
   float ratio_;
 
   // The number of soa tracks that can store this cache.
   int max_soa_tracks_;
 
+  // Cache mode, see Resize(). Hot data and key indices pointers of the other
+  // modes are NULL.
+  Mode mode_;
+
+  // Allocator used for cache data.
+  memory::Allocator* allocator_;
+
+  // The single allocation of all the cache data.
+  void* allocation_;
+
   // Soa hot data to interpolate.
   internal::InterpSoaTranslation* soa_translations_;
   internal::InterpSoaRotation* soa_rotations_;
   internal::InterpSoaScale* soa_scales_;
 
+  // Soa hot data tangents, in spline mode.
+  internal::InterpSoaFloat3Tangent* soa_translation_tangents_;
+  internal::InterpSoaQuaternionTangent* soa_rotation_tangents_;
+  internal::InterpSoaFloat3Tangent* soa_scale_tangents_;
+
+  // Soa hot data to interpolate, in compact mode.
+  internal::PackedSoaFloat3* packed_translations_;
+  internal::PackedSoaRotation* packed_rotations_;
+  internal::PackedSoaFloat3* packed_scales_;
+
   // Points to the keys in the animation that are valid for the current time
   // ratio.
   int* translation_keys_;
   int* rotation_keys_;
   int* scale_keys_;
 
+  // Same as above, in compact mode.
+  uint16_t* packed_translation_keys_;
+  uint16_t* packed_rotation_keys_;
+  uint16_t* packed_scale_keys_;
+
   // Current cursors in the animation. 0 means that the cache is invalid.
   int translation_cursor_;
   int rotation_cursor_;
@@ -175,6 +739,11 @@ class SamplingCache {
   uint8_t* outdated_translations_;
   uint8_t* outdated_rotations_;
   uint8_t* outdated_scales_;
+
+  // Soa entries whose interpolated value is independent of the ratio, as
+  // their keys are constant over the current interval. Only maintained by
+  // incremental sampling, see SamplingJob::changed.
+  uint8_t* steady_;
 };
 }  // namespace animation
 }  // namespace ozz
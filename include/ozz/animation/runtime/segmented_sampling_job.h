@@ -0,0 +1,105 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_SEGMENTED_SAMPLING_JOB_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_SEGMENTED_SAMPLING_JOB_H_
+
+#include "ozz/base/platform.h"
+
+namespace ozz {
+
+// Forward declaration of math structures.
+namespace math {
+struct SoaTransform;
+}
+
+namespace animation {
+
+// Forward declares the animation type to sample.
+class Animation;
+
+// Forward declares the cache object used by the SamplingJob.
+class SamplingCache;
+
+// Samples an animation that was split in consecutive fixed duration segments
+// (see offline::SplitAnimation()), each built as an independent Animation.
+// Only the segment containing the sampled time needs to be resident, which
+// allows to stream long animations (like cinematics) from disk, while both
+// seek cost and memory working set are bounded by the segment duration
+// rather than the whole animation duration. segment() tells which segment is
+// required for the current ratio, so that it (and the next one) can be
+// loaded ahead of time.
+// The cache is re-seeded when the sampled segment changes, as for any other
+// animation switch. The job does not owned the buffers (in/output) and will
+// thus not delete them during job's destruction.
+struct SegmentedSamplingJob {
+  // Default constructor, initializes default values.
+  SegmentedSamplingJob();
+
+  // Validates job parameters. Returns true for a valid job, or false otherwise:
+  // -if duration or segment_duration isn't strictly positive.
+  // -if segments range is empty.
+  // -if the segment required to sample ratio is NULL (not resident).
+  // -if the resulting SamplingJob isn't valid, see SamplingJob::Validate().
+  bool Validate() const;
+
+  // Runs job's sampling task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // Returns the index of the segment required to sample ratio, or -1 if
+  // duration, segment_duration or segments are invalid.
+  int segment() const;
+
+  // Time ratio in the unit interval [0,1] used to sample the whole animation
+  // (where 0 is the beginning of the first segment, 1 is the end of the last
+  // one). This ratio is clamped before job execution.
+  float ratio;
+
+  // Duration of the whole (unsplit) animation.
+  float duration;
+
+  // Duration of each segment, as used to split the animation. The last segment
+  // can be shorter.
+  float segment_duration;
+
+  // Segments of the animation, in order. Segments that aren't required by the
+  // current ratio can be NULL, aka not resident.
+  Range<const Animation* const> segments;
+
+  // A cache object that must be big enough to sample segments.
+  SamplingCache* cache;
+
+  // Job output, see SamplingJob::output.
+  Range<ozz::math::SoaTransform> output;
+};
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_SEGMENTED_SAMPLING_JOB_H_
@@ -0,0 +1,144 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_SHARED_POSE_CACHE_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_SHARED_POSE_CACHE_H_
+
+#include "ozz/animation/runtime/sampling_job.h"
+#include "ozz/base/platform.h"
+
+namespace ozz {
+namespace animation {
+
+// Forward declares the animation type to sample.
+class Animation;
+
+// Stores sampled poses, shared by all the instances (like crowd agents) that
+// play the same animation at the same (quantized) time ratio. Poses are keyed
+// by animation and quantized ratio. The first Acquire() of a key samples the
+// animation, next ones only increment the reference count of the already
+// sampled pose. This saves both the sampling cost and the per instance
+// SamplingCache memory, as a single internal SamplingCache is used.
+// An acquired pose is immutable and remains valid until it's released. Once
+// unreferenced, its slot can be recycled for another key (least recently used
+// first), but it's still found by Acquire() until then.
+// This cache isn't thread safe: Acquire() and Release() must not be called
+// concurrently, while acquired poses can be read from any thread.
+class SharedPoseCache {
+ public:
+  // Constructs an empty cache. The cache needs to be resized before it can be
+  // used.
+  SharedPoseCache();
+
+  // Constructs a cache that can store up to _max_poses poses of animations
+  // with at most _max_tracks tracks.
+  SharedPoseCache(int _max_tracks, int _max_poses);
+
+  // Deallocates cache. All acquired poses are invalidated.
+  ~SharedPoseCache();
+
+  // Resizes the cache, invalidating all poses, including acquired ones.
+  void Resize(int _max_tracks, int _max_poses);
+
+  // Invalidates all poses, including acquired ones. Poses are keyed by
+  // animation address and unique identifier (see Animation::uid()), so poses of
+  // a destroyed animation are never returned for another one. Calling this
+  // function allows to recycle their slots immediately though.
+  void Invalidate();
+
+  // Sets the number of quantization steps of the unit ratio interval. Ratios
+  // are rounded to the closest step, so that instances playing at close
+  // ratios share the same pose. 0 (default) means that ratios are not
+  // quantized, so only exactly matching ratios are shared.
+  // This invalidates all poses, including acquired ones.
+  void set_ratio_steps(int _ratio_steps);
+  int ratio_steps() const { return ratio_steps_; }
+
+  // Gets the pose of _animation at _ratio (clamped to unit interval and
+  // quantized, see set_ratio_steps()), sampling it if it's not already in the
+  // cache. The reference count of the pose is incremented, so it must be
+  // released with Release() once it's not used anymore.
+  // Returns an empty range if _animation has more tracks than the cache
+  // supports, or if all poses are referenced.
+  Range<const math::SoaTransform> Acquire(const Animation& _animation,
+                                          float _ratio);
+
+  // Decrements the reference count of a pose returned by Acquire().
+  void Release(const Range<const math::SoaTransform>& _pose);
+
+  // Gets the number of currently referenced poses.
+  int num_acquired_poses() const;
+
+  // The maximum number of poses and tracks that the cache can handle.
+  int max_poses() const { return max_poses_; }
+  int max_tracks() const { return max_soa_tracks_ * 4; }
+  int max_soa_tracks() const { return max_soa_tracks_; }
+
+ private:
+  // Disables copy and assignation.
+  SharedPoseCache(SharedPoseCache const&);
+  void operator=(SharedPoseCache const&);
+
+  // Describes a pose slot.
+  struct Entry {
+    // The sampled animation and its unique identifier. NULL if *this entry is
+    // empty.
+    const Animation* animation;
+    uint32_t uid;
+
+    // The quantized ratio the pose was sampled at.
+    float ratio;
+
+    // Number of references to the pose.
+    int references;
+
+    // Last time this entry was acquired, used to recycle least recently used
+    // entries first.
+    unsigned int last_use;
+  };
+
+  // The sampling cache used to sample all poses.
+  SamplingCache sampling_cache_;
+
+  // Number of quantization steps of the unit ratio interval.
+  int ratio_steps_;
+
+  // Maximum number of poses and soa tracks.
+  int max_poses_;
+  int max_soa_tracks_;
+
+  // Incremented on every Acquire().
+  unsigned int use_counter_;
+
+  // Poses (max_soa_tracks_ SoaTransform each) and their entries. Both are
+  // allocated in a single buffer, poses_ being the allocation pointer.
+  math::SoaTransform* poses_;
+  Entry* entries_;
+};
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_SHARED_POSE_CACHE_H_
@@ -39,6 +39,9 @@ class OArchive;
 namespace math {
 struct SoaTransform;
 }
+namespace memory {
+class Allocator;
+}
 namespace animation {
 
 // Forward declaration of SkeletonBuilder, used to instantiate a skeleton.
@@ -63,10 +66,11 @@ class Skeleton {
 
     // Defines the maximum number of joints.
     // This is limited in order to control the number of bits required to store
-    // a joint index. Limiting the number of joints also helps handling worst
-    // size cases, like when it is required to allocate an array of joints on
-    // the stack.
-    kMaxJoints = 1024,
+    // a joint index. Animation rotation keys store their track index on 13
+    // bits, which is the tightest limit. Limiting the number of joints also
+    // helps handling worst size cases, like when it is required to allocate an
+    // array of joints on the stack.
+    kMaxJoints = 8192,
 
     // Defines the maximum number of SoA elements required to store the maximum
     // number of joints.
@@ -75,14 +79,30 @@ class Skeleton {
     // Defines the index of the parent of the root joint (which has no parent in
     // fact).
     kNoParent = -1,
+
+    // Defines the maximum number of levels of detail, including LOD 0 (the
+    // whole skeleton).
+    kMaxLODs = 8,
   };
 
-  // Builds a default skeleton.
+  // Builds a default skeleton. Skeleton data is allocated from the default
+  // allocator, as set when constructing the skeleton.
   Skeleton();
 
+  // Builds a default skeleton which data are allocated from _allocator.
+  // _allocator must outlive the skeleton.
+  explicit Skeleton(memory::Allocator* _allocator);
+
   // Declares the public non-virtual destructor.
   ~Skeleton();
 
+#if __cplusplus >= 201103L
+  // Moves _other content to *this, transferring its single owned buffer and
+  // allocator without reallocating. _other is left empty.
+  Skeleton(Skeleton&& _other);
+  Skeleton& operator=(Skeleton&& _other);
+#endif  // __cplusplus
+
   // Returns the number of joints of *this skeleton.
   int num_joints() const { return static_cast<int>(joint_parents_.count()); }
 
@@ -98,29 +118,173 @@ class Skeleton {
   // Returns joint's parent indices range.
   Range<const int16_t> joint_parents() const { return joint_parents_; }
 
-  // Returns joint's name collection.
+  // Returns joint's subtree end indices range. As joints are stored in
+  // depth-first order, the subtree of joint i is the contiguous range of joints
+  // [i, joint_subtree_ends()[i][. It's computed when the skeleton is built or
+  // loaded, so that independent subtrees can be found without traversing the
+  // hierarchy. See GetIndependentSubtrees() from skeleton_utils.h.
+  Range<const int16_t> joint_subtree_ends() const {
+    return joint_subtree_ends_;
+  }
+
+  // Returns joint's depth range. Roots have a depth of 0, and every other
+  // joint the depth of its parent plus 1. Like subtree ends, depths are
+  // computed when the skeleton is built or loaded.
+  Range<const int16_t> joint_depths() const { return joint_depths_; }
+
+  // Returns joint's number of children range, which allows to test whether a
+  // joint is a leaf in O(1), see IsLeaf() from skeleton_utils.h.
+  Range<const int16_t> joint_child_counts() const {
+    return joint_child_counts_;
+  }
+
+  // Returns the number of depth levels of *this skeleton, aka its maximum
+  // joint depth plus 1, or 0 if it's empty.
+  int num_levels() const { return num_levels_; }
+
+  // Returns the joints of depth _level, in increasing order. All parents of a
+  // level's joints belong to the previous level, so joints of a level can be
+  // processed concurrently (or as a batch by soa kernels) once the previous
+  // level has been processed.
+  // _level must be in range [0, num_levels()[.
+  Range<const int16_t> level_joints(int _level) const {
+    assert(_level >= 0 && _level < num_levels_ && "_level index out of range");
+    const int begin = _level == 0 ? 0 : level_ends_[_level - 1];
+    return Range<const int16_t>(level_joints_.begin + begin,
+                                level_joints_.begin + level_ends_[_level]);
+  }
+
+  // Returns joint's level of detail range. Levels of detail are nested joint
+  // subsets, LOD 0 being the whole skeleton and every next LOD a subset of the
+  // previous one (see offline::SkeletonBuilder::lods). Entry i is the coarsest
+  // LOD joint i belongs to, meaning that joint i is part of LODs [0, lod]. A
+  // joint's LOD is always lower or equal to its parent's.
+  Range<const uint8_t> joint_lods() const { return joint_lods_; }
+
+  // Returns the number of levels of detail of *this skeleton, at least 1.
+  int num_lods() const { return num_lods_; }
+
+  // Returns the number of joints of the smallest prefix of the skeleton that
+  // contains all joints of LOD _lod. As joints are stored in depth-first
+  // order, a LOD can't always be a contiguous prefix, but the builder orders
+  // joints so that prefixes are as tight as possible. Jobs can be limited to
+  // this prefix, like LocalToModelJob "to" parameter, or SamplingJob output
+  // range. Joints of the prefix that aren't part of the LOD can be skipped with
+  // masks, see GetLODJoints() and GetLODSamplingMask() from skeleton_utils.h.
+  // _lod must be in range [0, num_lods()[.
+  int lod_num_joints(int _lod) const {
+    assert(_lod >= 0 && _lod < num_lods_ && "_lod index out of range");
+    return lod_ends_[_lod];
+  }
+
+  // Returns joint's name collection. It's empty if names weren't loaded, see
+  // set_load_names().
   Range<const char* const> joint_names() const {
     return Range<const char* const>(joint_names_.begin, joint_names_.end);
   }
 
+  // Returns joint's name hashes, see HashJointName(). They are available even
+  // if names weren't loaded.
+  Range<const uint32_t> joint_name_hashes() const {
+    return joint_name_hashes_;
+  }
+
+  // Finds the joint named _name, using a hash table. Returns its index, or -1
+  // if there's none. If names weren't loaded, only _name hash is compared.
+  int FindJoint(const char* _name) const;
+
+  // Finds the joint whose name hash is _hash. Returns its index, or -1 if
+  // there's none.
+  int FindJointByHash(uint32_t _hash) const;
+
+  // Computes _name hash (32 bits FNV-1a).
+  static uint32_t HashJointName(const char* _name);
+
+  // Computes a fingerprint of *this skeleton hierarchy, from joints parents
+  // and name hashes (32 bits FNV-1a). Animations record the fingerprint of the
+  // skeleton they're built for (see Animation::skeleton_fingerprint()), which
+  // allows to cheaply verify that they match once loaded, see IsCompatible().
+  // The fingerprint is never 0. It's computed in O(num_joints) by every call.
+  uint32_t fingerprint() const;
+
+  // Enables or disables joint names loading, for next Load() calls. Names are
+  // loaded by default. When disabled, names memory is saved and joint_names()
+  // is empty, but joints can still be found with FindJoint(), thanks to name
+  // hashes. Saving a skeleton loaded without names outputs empty names.
+  void set_load_names(bool _load_names) { load_names_ = _load_names; }
+  bool load_names() const { return load_names_; }
+
+  // Gets the allocator used to allocate skeleton data.
+  memory::Allocator* allocator() const { return allocator_; }
+
   // Serialization functions.
   // Should not be called directly but through io::Archive << and >> operators.
   void Save(ozz::io::OArchive& _archive) const;
   void Load(ozz::io::IArchive& _archive, uint32_t _version);
 
+  // Flat representation functions, see Animation::WriteFlat() for details.
+  // Bind poses, hierarchy and names of a mapped skeleton are read from the
+  // flat buffer. Only the array of joint names pointers is allocated.
+
+  // Required flat buffer alignment.
+  enum { kFlatAlignment = 16 };
+
+  // Gets the size in bytes of *this skeleton flat representation.
+  size_t flat_size() const;
+
+  // Writes *this skeleton flat representation to _buffer, which must be
+  // aligned to kFlatAlignment and at least flat_size() bytes long. Returns
+  // false if _buffer is invalid.
+  bool WriteFlat(void* _buffer, size_t _size) const;
+
+  // Releases current content and maps *this skeleton to the flat
+  // representation stored in _buffer, which must outlive *this skeleton and
+  // can be read-only. Returns false and leaves *this skeleton empty if _buffer
+  // isn't a valid flat representation.
+  bool MapFlat(const void* _buffer, size_t _size);
+
+  // Tells if *this skeleton is mapped to an external flat buffer.
+  bool mapped() const { return mapped_; }
+
  private:
   // Disables copy and assignation.
   Skeleton(Skeleton const&);
   void operator=(Skeleton const&);
 
   // Internal allocation/deallocation function.
-  // Allocate returns the beginning of the contiguous buffer of names.
+  // Allocate returns the beginning of the contiguous buffer of names. Names
+  // aren't allocated if _char_count is 0. Allocate replaces current content,
+  // reusing the owned buffer if it's big enough.
   char* Allocate(size_t _char_count, size_t _num_joints);
   void Deallocate();
 
+  // Distributes _buffer to joint_depths_, joint_child_counts_, level_joints_
+  // and level_ends_. Returns the end of the used buffer.
+  char* AllocateLevels(char* _buffer, size_t _num_joints);
+
+  // Swaps all members with _other, used to implement move semantic.
+  void Swap(Skeleton& _other);
+
+  // Computes joint_subtree_ends_ from joint_parents_.
+  void ComputeSubtreeEnds();
+
+  // Computes joint_depths_, joint_child_counts_, and levels from
+  // joint_parents_.
+  void ComputeLevels();
+
+  // Computes num_lods_ and lod_ends_ from joint_lods_.
+  void ComputeLODEnds();
+
+  // Computes joint_name_hashes_ from names stored contiguously in _chars, and
+  // builds joint_name_table_.
+  void ComputeNameHashes(const char* _chars);
+
   // SkeletonBuilder class is allowed to instantiate an Skeleton.
   friend class offline::SkeletonBuilder;
 
+  // Allocator used for skeleton data.
+  memory::Allocator* allocator_;
+
   // Buffers below store joint informations in joing depth first order. Their
   // size is equal to the number of joints of the skeleton.
 
@@ -130,13 +294,53 @@ class Skeleton {
   // Array of joint parent indexes.
   Range<int16_t> joint_parents_;
 
-  // Stores the name of every joint in an array of c-strings.
+  // Array of joint subtree end indexes, computed from joint_parents_.
+  Range<int16_t> joint_subtree_ends_;
+
+  // Arrays of joint depths and number of children, computed from
+  // joint_parents_.
+  Range<int16_t> joint_depths_;
+  Range<int16_t> joint_child_counts_;
+
+  // Joints sorted by depth level, and the end of every level in this array.
+  // Only the num_levels_ first level ends are used.
+  Range<int16_t> level_joints_;
+  Range<int16_t> level_ends_;
+  int num_levels_;
+
+  // Stores the name of every joint in an array of c-strings. Empty if names
+  // weren't loaded.
   Range<char*> joint_names_;
+
+  // Array of joint name hashes.
+  Range<uint32_t> joint_name_hashes_;
+
+  // Open addressing hash table of joint indices, indexed by name hash. Its size
+  // is a power of 2, and empty slots are set to kNoParent.
+  Range<int16_t> joint_name_table_;
+
+  // Array of joint levels of detail.
+  Range<uint8_t> joint_lods_;
+
+  // Number of levels of detail, and their number of joints, computed from
+  // joint_lods_.
+  int num_lods_;
+  int16_t lod_ends_[kMaxLODs];
+
+  // Loads joint names, see set_load_names().
+  bool load_names_;
+
+  // Size in bytes of the owned data buffer. It's 0 if there's no buffer, or
+  // if it's mapped.
+  size_t capacity_;
+
+  // Buffers are mapped to an external flat buffer, see MapFlat().
+  bool mapped_;
 };
 }  // namespace animation
 
 namespace io {
-OZZ_IO_TYPE_VERSION(2, animation::Skeleton)
+OZZ_IO_TYPE_VERSION(3, animation::Skeleton)
 OZZ_IO_TYPE_TAG("ozz-skeleton", animation::Skeleton)
 }  // namespace io
 }  // namespace ozz
@@ -36,19 +36,93 @@
 namespace ozz {
 namespace animation {
 
+// Forward declares the animation type, see IsCompatible().
+class Animation;
+
 // Get bind-pose of a skeleton joint.
 ozz::math::Transform GetJointLocalBindPose(const Skeleton& _skeleton,
                                            int _joint);
 
+// Tells if _animation can be sampled for _skeleton: its number of tracks must
+// match _skeleton number of joints (sparse animations soa joints must be
+// _skeleton soa joints, see Animation::soa_joints()), and the fingerprint of
+// the skeleton it was built for (if known, see
+// Animation::skeleton_fingerprint()) must match _skeleton one. This is
+// intended to be verified once, when animations and skeletons are loaded,
+// rather than every time they're used by jobs.
+bool IsCompatible(const Skeleton& _skeleton, const Animation& _animation);
+
+// Builds the table that remaps joints of _from skeleton to joints of _to
+// skeleton, matching joints by name. Every entry i of _remap receives the
+// index of the _from joint named like _to joint i, or -1 if there's none. Joint
+// name hashes are matched instead if either skeleton was loaded without names.
+// The table can then be used by a RemapJob to share animations built for _from
+// skeleton with _to skeleton.
+// Returns the number of joints that were matched, or -1 if _remap is smaller
+// than _to number of joints.
+int BuildJointRemap(const Skeleton& _from, const Skeleton& _to,
+                    const Range<int>& _remap);
+
+// Builds the mirror table of _skeleton, used by a MirrorJob. Joints are paired
+// by name: every entry i of _mirror receives the index of the joint whose name
+// is joint i name where the first occurrence of _left is replaced by _right, or
+// _right by _left. Joints without such a counterpart (like spine or head) are
+// their own mirror. _left and _right must not be empty.
+// Returns the number of joints that were paired with another joint, or -1 if
+// _mirror is smaller than _skeleton number of joints or if _skeleton was
+// loaded without names.
+int BuildJointMirror(const Skeleton& _skeleton, const char* _left,
+                     const char* _right, const Range<int>& _mirror);
+
+// Finds the independent subtrees of joints [_split, num_joints[. Because
+// joints are stored in depth-first order, those joints are made of subtrees
+// whose root parent is before _split. Each subtree only depends on joints
+// [0, _split[, so once they've been updated (LocalToModelJob with "from" set
+// to kNoParent and "to" set to _split - 1), subtrees can be updated
+// concurrently (a LocalToModelJob per subtree with "from" set to its root).
+// Every entry of _roots receives the root joint of a subtree, whose joints are
+// [root, joint_subtree_ends()[root][.
+// Returns the number of independent subtrees, which can be greater than the
+// size of _roots, in which case only the first subtrees are output.
+int GetIndependentSubtrees(const Skeleton& _skeleton, int _split,
+                           const Range<int>& _roots);
+
+// Marks the joints of _skeleton required to compute model-space matrices of
+// _joints, that is _joints and all their ancestors. _joints is usually a mesh
+// joint remapping table. Entries of _required are set to true for required
+// joints, others are left unchanged, so that the joints required by multiple
+// meshes can be accumulated. The output can then be used as
+// LocalToModelJob::required_joints, to skip joints that no mesh uses.
+// Returns the number of joints marked by this call, or -1 if _required is
+// smaller than _skeleton number of joints, or if a joint index is invalid.
+int GetRequiredJoints(const Skeleton& _skeleton,
+                      const Range<const uint16_t>& _joints,
+                      const Range<bool>& _required);
+
+// Fills _required with the joints of _skeleton level of detail _lod (see
+// Skeleton::joint_lods()): entries are set to true for joints of the LOD and to
+// false for others. Only the first Skeleton::lod_num_joints() entries can be
+// true. The output can be used as LocalToModelJob::required_joints, with "to"
+// set to the last joint of the LOD prefix.
+// Returns the number of joints of the LOD, or -1 if _lod is invalid or if
+// _required is smaller than _skeleton number of joints.
+int GetLODJoints(const Skeleton& _skeleton, int _lod,
+                 const Range<bool>& _required);
+
+// Fills SamplingJob soa tracks _mask (see SamplingJob::mask) with the joints
+// of _skeleton level of detail _lod. A soa track bit is set if any of its 4
+// joints is part of the LOD, and cleared otherwise.
+// Returns the number of soa tracks set, or -1 if _lod is invalid or if _mask is
+// smaller than (_skeleton.num_soa_joints() + 7) / 8 bytes.
+int GetLODSamplingMask(const Skeleton& _skeleton, int _lod,
+                       const Range<uint8_t>& _mask);
+
 // Test if a joint is a leaf. _joint number must be in range [0, num joints].
-// "_joint" is a leaf if it's the last joint, or next joint's parent isn't
-// "_joint".
+// "_joint" is a leaf if it has no child, see Skeleton::joint_child_counts().
 inline bool IsLeaf(const Skeleton& _skeleton, int _joint) {
-  const int num_joints = _skeleton.num_joints();
-  assert(_joint >= 0 && _joint < num_joints && "_joint index out of range");
-  const Range<const int16_t>& parents = _skeleton.joint_parents();
-  const int next = _joint + 1;
-  return next == num_joints || parents[next] != _joint;
+  assert(_joint >= 0 && _joint < _skeleton.num_joints() &&
+         "_joint index out of range");
+  return _skeleton.joint_child_counts()[_joint] == 0;
 }
 
 // Applies a specified functor to each joint in a depth-first order.
@@ -61,11 +135,16 @@ template <typename _Fct>
 inline _Fct IterateJointsDF(const Skeleton& _skeleton, int _from, _Fct _fct) {
   const Range<const int16_t>& parents = _skeleton.joint_parents();
   const int num_joints = _skeleton.num_joints();
-  //
-  // parents[i] >= _from is true as long as "i" is a child of "_from".
+
+  // _from subtree is the contiguous range [_from, joint_subtree_ends()[_from][
+  // of joints.
   OZZ_STATIC_ASSERT(Skeleton::kNoParent < 0);
-  for (int i = _from < 0 ? 0 : _from, process = i < num_joints; process;
-       ++i, process = i < num_joints && parents[i] >= _from) {
+  if (_from >= num_joints) {
+    return _fct;
+  }
+  const int end =
+      _from < 0 ? num_joints : _skeleton.joint_subtree_ends()[_from];
+  for (int i = _from < 0 ? 0 : _from; i < end; ++i) {
     _fct(i, parents[i]);
   }
   return _fct;
@@ -0,0 +1,94 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_SOCKET_JOB_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_SOCKET_JOB_H_
+
+#include "ozz/base/platform.h"
+
+namespace ozz {
+// Forward declaration of math structures.
+namespace math {
+struct Float4x4;
+}
+
+namespace animation {
+
+// ozz::animation::SocketJob computes the matrices of many sockets (weapons,
+// props, vfx attachment points...) of many characters at once. A socket is
+// attached to a joint of a character, with an offset transform relative to
+// the joint. Its matrix is the character transform multiplied by the joint
+// model-space matrix (as output by LocalToModelJob), multiplied by the socket
+// offset.
+// Sockets are processed in a single pass. Sorting them by character and joint
+// keeps palette accesses cache friendly.
+struct SocketJob {
+  // Identifies the joint a socket is attached to.
+  struct Socket {
+    // Index of the character in models and transforms ranges.
+    int character;
+
+    // Index of the joint in character models range.
+    int joint;
+  };
+
+  // Validates job parameters. Returns true for a valid job, or false otherwise:
+  // -if offsets or output range is smaller than sockets range.
+  // -if transforms isn't empty and smaller than models range.
+  // -if any socket character or joint index is out of range.
+  bool Validate() const;
+
+  // Runs job's execution task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // Job input.
+
+  // Sockets to evaluate.
+  Range<const Socket> sockets;
+
+  // Per socket offset transforms, relative to their joint.
+  Range<const math::Float4x4> offsets;
+
+  // Per character model-space matrices, aka LocalToModelJob output.
+  Range<const Range<const math::Float4x4> > models;
+
+  // Optional per character transforms (usually model to world). Sockets
+  // matrices are output in model-space if empty.
+  Range<const math::Float4x4> transforms;
+
+  // Job output.
+
+  // Per socket matrices.
+  Range<math::Float4x4> output;
+};
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_SOCKET_JOB_H_
@@ -0,0 +1,110 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_SPRING_JOB_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_SPRING_JOB_H_
+
+#include "ozz/base/maths/soa_float.h"
+#include "ozz/base/maths/soa_quaternion.h"
+#include "ozz/base/platform.h"
+
+namespace ozz {
+// Forward declaration of math structures.
+namespace math {
+struct SoaTransform;
+}  // namespace math
+
+namespace animation {
+
+// Simulation state of 4 spring joints, the ones of a soa transform. It must be
+// kept from one update to the next, one per soa joint.
+struct SoaSpringState {
+  // Simulated local-space rotations and translations.
+  math::SoaQuaternion rotation;
+  math::SoaFloat3 translation;
+
+  // Rotations quaternion components and translations velocities.
+  math::SoaQuaternion angular_velocity;
+  math::SoaFloat3 velocity;
+};
+
+// ozz::animation::SpringJob adds secondary motion (jiggle bones, tails,
+// springs...) to a local-space soa pose. Every joint with a positive stiffness
+// is simulated by a damped spring, pulling its rotation and translation toward
+// the animated ones. Springs are simulated in local-space, 4 joints at a time,
+// before converting the pose to model-space. A simulated joint lag propagates
+// to its children during local-to-model conversion, so chains (like tails)
+// bend without any other hierarchy pass. Motions inherited from parents that
+// aren't simulated (and from the character itself) don't excite springs.
+// Springs are integrated with implicit Euler, so simulation is stable whatever
+// the stiffness and time step.
+struct SpringJob {
+  // Default constructor, initializes default values.
+  SpringJob();
+
+  // Validates job parameters. Returns true for a valid job, or false otherwise:
+  // -if stiffness, damping or states range is smaller than output range.
+  // -if dt is negative.
+  bool Validate() const;
+
+  // Runs job's execution task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // Job input.
+
+  // Time step in seconds since the last update.
+  float dt;
+
+  // Resets springs states to the animated pose, with no velocity. Must be set
+  // for the first update, or after a discontinuity (teleportation...).
+  bool reset;
+
+  // Per-joint spring stiffness (in s^-2), one SimdFloat4 per soa joint. Joints
+  // with a stiffness lower or equal to zero aren't simulated, and output their
+  // animated transform.
+  Range<const math::SimdFloat4> stiffness;
+
+  // Per-joint spring damping (in s^-1), one SimdFloat4 per soa joint. Damping
+  // of 2*sqrt(stiffness) is critical, lower values overshoot.
+  Range<const math::SimdFloat4> damping;
+
+  // Job input and output.
+
+  // Springs simulation states, one per soa joint.
+  Range<SoaSpringState> states;
+
+  // Local-space animated soa pose, where simulated joints transforms are
+  // replaced with springs rotations and translations. Scales aren't simulated.
+  Range<math::SoaTransform> output;
+};
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_SPRING_JOB_H_
@@ -0,0 +1,152 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_STREAMED_ANIMATION_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_STREAMED_ANIMATION_H_
+
+#include "ozz/base/platform.h"
+
+namespace ozz {
+namespace io {
+class OArchive;
+class Stream;
+}  // namespace io
+namespace animation {
+
+// Forward declares the animation type.
+class Animation;
+
+// Loads the segments of a segmented animation (see offline::SplitAnimation())
+// on demand from a stream, keeping only a sliding window of segments resident
+// instead of the whole animation. This allows to play very long animations
+// (like cinematics) with a bounded memory footprint.
+// Segments are written to the stream with Save(). Once opened, Update() must
+// be called with the playback ratio before sampling: it synchronously loads
+// the required segment if it's not resident yet, unloads segments that left
+// the window and queues the next ones for prefetching. Queued segments are
+// loaded by Prefetch(), one per call, so that the application can spread
+// loading on frames (or on a loading thread) according to its time budget.
+// Playback is considered looping, the window wraps to the first segments.
+// segments() can be used as SegmentedSamplingJob::segments, with duration()
+// and segment_duration().
+// StreamedAnimation isn't thread safe: Update() and Prefetch() must not be
+// called concurrently, nor while segments are being sampled.
+class StreamedAnimation {
+ public:
+  // Constructs an unopened streamed animation.
+  StreamedAnimation();
+
+  // Closes stream and unloads all segments.
+  ~StreamedAnimation();
+
+  // Writes _segments of an animation of _duration, split in segments of
+  // _segment_duration, to _archive. Segments are written in order, along with
+  // a table of their offsets in the stream.
+  // Returns false if arguments are invalid (at least a segment is required,
+  // none can be NULL), or if the archive stream isn't seekable.
+  static bool Save(io::OArchive& _archive, float _duration,
+                   float _segment_duration,
+                   const Range<const Animation* const>& _segments);
+
+  // Opens _stream, which must be positioned at the beginning of a streamed
+  // animation written with Save(). Only the segment offsets table is read, no
+  // segment is loaded. _stream isn't owned and must remain valid and opened
+  // until Close() is called. _window_size is the number of segments kept
+  // resident, the required one and the _window_size - 1 following ones.
+  // Returns false if _stream doesn't contain a valid streamed animation, or if
+  // _window_size is lower than 1.
+  bool Open(io::Stream* _stream, int _window_size = 2);
+
+  // Unloads all segments and releases stream.
+  void Close();
+
+  // Returns true if a stream is opened.
+  bool opened() const { return stream_ != NULL; }
+
+  // Makes the segment required to sample _ratio (in the unit interval [0,1])
+  // resident, loading it synchronously if needed. Segments out of the window
+  // are unloaded, and the missing ones are queued for prefetching.
+  // Returns false if the required segment couldn't be loaded.
+  bool Update(float _ratio);
+
+  // Loads the next segment queued by Update(). Returns true if a segment was
+  // loaded, false if there was nothing to prefetch (or loading failed).
+  bool Prefetch();
+
+  // Returns all segments, the ones that aren't resident are NULL.
+  Range<const Animation* const> segments() const;
+
+  // Returns the number of segments currently resident.
+  int num_resident_segments() const;
+
+  // Gets the duration of the whole animation.
+  float duration() const { return duration_; }
+
+  // Gets the duration of segments (the last one can be shorter).
+  float segment_duration() const { return segment_duration_; }
+
+  // Gets the number of segments of the animation.
+  int num_segments() const { return num_segments_; }
+
+  // Gets the number of segments kept resident.
+  int window_size() const { return window_size_; }
+
+ private:
+  // Disables copy and assignation.
+  StreamedAnimation(StreamedAnimation const&);
+  void operator=(StreamedAnimation const&);
+
+  // Loads segment _index if it's not resident already.
+  bool LoadSegment(int _index);
+
+  // Tests if segment _index is part of the window starting at segment _first.
+  bool InWindow(int _first, int _index) const;
+
+  // The stream segments are read from, NULL if not opened.
+  io::Stream* stream_;
+
+  // Stream position of the streamed animation header, which segment offsets
+  // are relative to.
+  int64_t origin_;
+
+  float duration_;
+  float segment_duration_;
+  int num_segments_;
+  int window_size_;
+
+  // First segment of the current window, -1 before the first Update().
+  int window_first_;
+
+  // Per segment stream offset and resident animation (NULL if unloaded),
+  // allocated at once.
+  int* offsets_;
+  Animation** animations_;
+};
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_STREAMED_ANIMATION_H_
@@ -0,0 +1,123 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_SYNC_SAMPLING_JOB_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_SYNC_SAMPLING_JOB_H_
+
+#include "ozz/base/platform.h"
+
+namespace ozz {
+
+// Forward declaration of math structures.
+namespace math {
+struct SoaTransform;
+}
+
+namespace animation {
+
+// Forward declares the animation type to sample.
+class Animation;
+
+// Forward declares the cache object used by the SamplingJob.
+class SamplingCache;
+
+// Converts a synchronized phase to _animation ratio. The phase is expressed in
+// cycles: its integer part is ignored, and its fractional part is evenly
+// distributed between _animation synchronization markers (see
+// Animation::sync_ratios()), so that phase 0 matches the first marker and
+// phase k / num_sync_markers() matches marker k. Phase is warped linearly in
+// between markers. An animation without marker is considered to have a single
+// marker at ratio 0: ratio is the same as phase.
+// The returned ratio is in the unit interval [0,1[.
+float PhaseToRatio(const Animation& _animation, float _phase);
+
+// Converts _animation ratio to a synchronized phase, which is the inverse of
+// PhaseToRatio(). _ratio integer part is ignored. The returned phase is in
+// the unit interval [0,1[.
+float RatioToPhase(const Animation& _animation, float _ratio);
+
+// Samples a group of looping animations at the same synchronized phase, so
+// that their synchronization markers (like locomotion foot plants) match
+// whatever their duration. This is required to blend animations like walk and
+// run without artifacts. Every layer is sampled at the ratio that matches the
+// shared phase (see PhaseToRatio()), using its own cache. Layers whose weight
+// is 0 aren't sampled.
+// The group phase should be advanced by the elapsed time divided by
+// CycleDuration(), which is the weighted average of layers durations, so that
+// playback speed is continuous when layers weights change.
+// All layers must have the same number of synchronization markers.
+// The job does not owned the buffers (in/output) and will thus not delete
+// them during job's destruction.
+struct SyncSamplingJob {
+  // Default constructor, initializes default values.
+  SyncSamplingJob();
+
+  // Validates job parameters. Returns true for a valid job, or false otherwise:
+  // -if any layer animation or cache pointer is NULL.
+  // -if layers don't have the same number of synchronization markers.
+  // -if any layer weight is negative.
+  // -if any layer sampling job isn't valid, see SamplingJob::Validate().
+  bool Validate() const;
+
+  // Runs job's sampling task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // Computes the duration of a synchronized cycle, as the weighted average of
+  // layers animations duration. Returns 0 if all weights are 0.
+  float CycleDuration() const;
+
+  // Defines a layer of the synchronized group.
+  struct Layer {
+    // Default constructor, initializes default values.
+    Layer();
+
+    // The animation to sample.
+    const Animation* animation;
+
+    // A cache object that must be big enough to sample animation.
+    SamplingCache* cache;
+
+    // Layer blending weight, used to compute the group cycle duration. Layers
+    // with a weight of 0 aren't sampled.
+    float weight;
+
+    // Layer output, see SamplingJob::output.
+    Range<ozz::math::SoaTransform> output;
+  };
+
+  // Synchronized phase of the group, in cycles. See PhaseToRatio().
+  float phase;
+
+  // Layers to sample.
+  Range<const Layer> layers;
+};
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_SYNC_SAMPLING_JOB_H_
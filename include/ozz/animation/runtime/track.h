@@ -60,6 +60,13 @@ class Track {
   Track();
   ~Track();
 
+#if __cplusplus >= 201103L
+  // Moves _other content to *this, transferring its single owned buffer
+  // without reallocating. _other is left empty.
+  Track(Track&& _other);
+  Track& operator=(Track&& _other);
+#endif  // __cplusplus
+
   // Keyframe accessors.
   Range<const float> ratios() const { return ratios_; }
   Range<const _ValueType> values() const { return values_; }
@@ -76,6 +83,28 @@ class Track {
   void Save(ozz::io::OArchive& _archive) const;
   void Load(ozz::io::IArchive& _archive, uint32_t _version);
 
+  // Flat representation functions, see Animation::WriteFlat() for details.
+
+  // Required flat buffer alignment.
+  enum { kFlatAlignment = 16 };
+
+  // Gets the size in bytes of *this track flat representation.
+  size_t flat_size() const;
+
+  // Writes *this track flat representation to _buffer, which must be aligned
+  // to kFlatAlignment and at least flat_size() bytes long. Returns false if
+  // _buffer is invalid.
+  bool WriteFlat(void* _buffer, size_t _size) const;
+
+  // Releases current content and maps *this track to the flat representation
+  // stored in _buffer, which must outlive *this track and can be read-only.
+  // Returns false and leaves *this track empty if _buffer isn't a valid flat
+  // representation of the same track type.
+  bool MapFlat(const void* _buffer, size_t _size);
+
+  // Tells if *this track is mapped to an external flat buffer.
+  bool mapped() const { return mapped_; }
+
  private:
   // Disables copy and assignation.
   Track(Track const&);
@@ -84,10 +113,21 @@ class Track {
   // TrackBuilder class is allowed to allocate a Track.
   friend class offline::TrackBuilder;
 
-  // Internal destruction function.
+  // Internal allocation and destruction functions. Allocate replaces current
+  // content, reusing the owned buffer if it's big enough.
   void Allocate(size_t _keys_count, size_t _name_len);
   void Deallocate();
 
+  // Computes the size of the single buffer used to store track data.
+  static size_t BufferSize(size_t _keys_count, size_t _name_len);
+
+  // Fixes up all data ranges and name to _buffer, whose layout is the same
+  // for allocated and mapped flat buffers.
+  void FixUp(char* _buffer, size_t _keys_count, size_t _name_len);
+
+  // Swaps all members with _other, used to implement move semantic.
+  void Swap(Track& _other);
+
   // Keyframe ratios (0 is the beginning of the track, 1 is the end).
   Range<float> ratios_;
 
@@ -99,6 +139,13 @@ class Track {
 
   // Track name.
   char* name_;
+
+  // Size in bytes of the owned data buffer. It's 0 if there's no buffer, or
+  // if it's mapped.
+  size_t capacity_;
+
+  // Data buffer is an external flat buffer, not owned by *this track.
+  bool mapped_;
 };
 
 // Definition of operations policies per track value type.
@@ -28,8 +28,12 @@
 #ifndef OZZ_OZZ_ANIMATION_RUNTIME_TRACK_SAMPLING_JOB_H_
 #define OZZ_OZZ_ANIMATION_RUNTIME_TRACK_SAMPLING_JOB_H_
 
+#include "ozz/animation/runtime/quantized_track.h"
 #include "ozz/animation/runtime/track.h"
 
+#include "ozz/base/maths/soa_float.h"
+#include "ozz/base/maths/soa_quaternion.h"
+
 namespace ozz {
 namespace animation {
 
@@ -60,6 +64,72 @@ struct TrackSamplingJob {
   // Job output.
   typename _Track::ValueType* result;
 };
+
+// TrackBatchSamplingJob internal implementation. See *TrackBatchSamplingJob
+// for more details.
+template <typename _Track>
+struct TrackBatchSamplingJob {
+  typedef typename _Track::ValueType ValueType;
+
+  TrackBatchSamplingJob();
+
+  // Validates all parameters:
+  // - if there are less results than tracks, or if any track is NULL.
+  // - if cursors are used, and there are less cursors than tracks.
+  bool Validate() const;
+
+  // Validates and executes sampling.
+  bool Run() const;
+
+  // Ratio used to sample all tracks, clamped in range [0,1] before job
+  // execution.
+  float ratio;
+
+  // Tracks to sample.
+  Range<const _Track* const> tracks;
+
+  // Optional per-track cursors, caching the keyframe found by the previous
+  // sampling of the track. When the ratio moves forward (or backward) by less
+  // than a few keyframes, which is the usual case during playback, the
+  // keyframe is found from the cursor without any search. Cursors must be
+  // initialized to 0, and reset to 0 when a track changes.
+  Range<int> cursors;
+
+  // Job output, receiving the sampled value of each track.
+  Range<ValueType> results;
+};
+
+// TrackSoaSamplingJob internal implementation. See *TrackSoaSamplingJob for
+// more details.
+template <typename _Track, typename _SoaValueType>
+struct TrackSoaSamplingJob {
+  typedef typename _Track::ValueType ValueType;
+  typedef _SoaValueType SoaValueType;
+
+  TrackSoaSamplingJob();
+
+  // Validates all parameters:
+  // - if result is NULL.
+  // - if cursors are used, and there are less than 4 cursors.
+  bool Validate() const;
+
+  // Validates and executes sampling.
+  bool Run() const;
+
+  // Ratio used to sample all tracks, clamped in range [0,1] before job
+  // execution.
+  float ratio;
+
+  // The 4 tracks to sample, one per soa lane. A NULL track is allowed, and
+  // outputs identity in its lane.
+  const _Track* tracks[4];
+
+  // Optional per-track cursors, see TrackBatchSamplingJob::cursors.
+  Range<int> cursors;
+
+  // Job output, receiving the 4 sampled values in soa format.
+  SoaValueType* result;
+};
 }  // namespace internal
 
 // Track sampling job implementation. Track sampling allows to query a track
@@ -75,6 +145,82 @@ struct Float4TrackSamplingJob : public internal::TrackSamplingJob<Float4Track> {
 struct QuaternionTrackSamplingJob
     : public internal::TrackSamplingJob<QuaternionTrack> {};
 
+// Quantized track sampling job implementation. Keyframes are decoded
+// transparently.
+struct QuantizedFloatTrackSamplingJob
+    : public internal::TrackSamplingJob<QuantizedFloatTrack> {};
+struct QuantizedFloat2TrackSamplingJob
+    : public internal::TrackSamplingJob<QuantizedFloat2Track> {};
+struct QuantizedFloat3TrackSamplingJob
+    : public internal::TrackSamplingJob<QuantizedFloat3Track> {};
+struct QuantizedFloat4TrackSamplingJob
+    : public internal::TrackSamplingJob<QuantizedFloat4Track> {};
+
+// Track batch sampling job implementation. Samples multiple tracks at the same
+// ratio, like the many user-channel tracks of a character. Per-track cursors
+// allow to find keyframes in constant time during playback.
+struct FloatTrackBatchSamplingJob
+    : public internal::TrackBatchSamplingJob<FloatTrack> {};
+struct Float2TrackBatchSamplingJob
+    : public internal::TrackBatchSamplingJob<Float2Track> {};
+struct Float3TrackBatchSamplingJob
+    : public internal::TrackBatchSamplingJob<Float3Track> {};
+struct Float4TrackBatchSamplingJob
+    : public internal::TrackBatchSamplingJob<Float4Track> {};
+struct QuaternionTrackBatchSamplingJob
+    : public internal::TrackBatchSamplingJob<QuaternionTrack> {};
+struct QuantizedFloatTrackBatchSamplingJob
+    : public internal::TrackBatchSamplingJob<QuantizedFloatTrack> {};
+struct QuantizedFloat2TrackBatchSamplingJob
+    : public internal::TrackBatchSamplingJob<QuantizedFloat2Track> {};
+struct QuantizedFloat3TrackBatchSamplingJob
+    : public internal::TrackBatchSamplingJob<QuantizedFloat3Track> {};
+struct QuantizedFloat4TrackBatchSamplingJob
+    : public internal::TrackBatchSamplingJob<QuantizedFloat4Track> {};
+
+// Track soa sampling job implementation. Samples 4 tracks at the same ratio,
+// and outputs their values in soa format. Keyframes are found independently for
+// each track, but interpolation is done for the 4 tracks at once using soa
+// maths.
+struct Float3TrackSoaSamplingJob
+    : public internal::TrackSoaSamplingJob<Float3Track, math::SoaFloat3> {};
+struct QuaternionTrackSoaSamplingJob
+    : public internal::TrackSoaSamplingJob<QuaternionTrack,
+                                           math::SoaQuaternion> {};
+
+// Forward declares the track set type.
+class TrackSet;
+
+// Track set sampling job implementation. Samples all the channels of a
+// TrackSet at the same ratio. As channels share their keyframe ratios, a
+// single keyframe lookup serves all of them.
+struct TrackSetSamplingJob {
+  TrackSetSamplingJob();
+
+  // Validates all parameters:
+  // - if track_set is NULL.
+  // - if there are less results than track set channels.
+  bool Validate() const;
+
+  // Validates and executes sampling.
+  bool Run() const;
+
+  // Ratio used to sample the track set, clamped in range [0,1] before job
+  // execution.
+  float ratio;
+
+  // Track set to sample.
+  const TrackSet* track_set;
+
+  // Optional cursor, caching the keyframe found by the previous sampling. See
+  // TrackBatchSamplingJob::cursors for more details. Must be initialized to 0,
+  // and reset to 0 when the track set changes.
+  int* cursor;
+
+  // Job output, receiving the sampled value of each channel.
+  Range<float> results;
+};
+
 }  // namespace animation
 }  // namespace ozz
 #endif  // OZZ_OZZ_ANIMATION_RUNTIME_TRACK_SAMPLING_JOB_H_
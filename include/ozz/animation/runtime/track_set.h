@@ -0,0 +1,115 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_TRACK_SET_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_TRACK_SET_H_
+
+#include "ozz/base/io/archive_traits.h"
+#include "ozz/base/platform.h"
+
+namespace ozz {
+namespace animation {
+
+// Forward declares the TrackBuilder, used to instantiate a TrackSet.
+namespace offline {
+class TrackBuilder;
+}
+
+// Runtime set of float user-channel tracks, sharing a single time axis.
+// A TrackSet is built from a RawTrackSet by the TrackBuilder, which merges and
+// deduplicates all channels keyframe ratios. Keyframe ratios are thus stored
+// once for all channels, and a single keyframe lookup is enough to sample all
+// of them (see ozz::animation::TrackSetSamplingJob). Values are stored key
+// major: the values of all channels for a keyframe are contiguous, so sampling
+// reads only two rows of values whatever the number of channels. Interpolation
+// mode is still stored per channel and per keyframe.
+class TrackSet {
+ public:
+  TrackSet();
+  ~TrackSet();
+
+  // Gets the number of channels of the set.
+  int num_channels() const { return num_channels_; }
+
+  // Gets the number of keyframes, shared by all channels.
+  int num_keys() const { return static_cast<int>(ratios_.count()); }
+
+  // Keyframe accessors.
+  // Keyframe ratios, shared by all channels.
+  Range<const float> ratios() const { return ratios_; }
+  // Keyframe values, value of channel c at keyframe k is at index
+  // k * num_channels() + c.
+  Range<const float> values() const { return values_; }
+  // Keyframe modes, 1 bit per value, indexed as values.
+  Range<const uint8_t> steps() const { return steps_; }
+
+  // Get the estimated track set's size in bytes.
+  size_t size() const;
+
+  // Get track set name.
+  const char* name() const { return name_ ? name_ : ""; }
+
+  // Serialization functions.
+  // Should not be called directly but through io::Archive << and >> operators.
+  void Save(ozz::io::OArchive& _archive) const;
+  void Load(ozz::io::IArchive& _archive, uint32_t _version);
+
+ private:
+  // Disables copy and assignation.
+  TrackSet(TrackSet const&);
+  void operator=(TrackSet const&);
+
+  // TrackBuilder class is allowed to allocate a TrackSet.
+  friend class offline::TrackBuilder;
+
+  // Internal destruction function.
+  void Allocate(size_t _keys_count, int _num_channels, size_t _name_len);
+  void Deallocate();
+
+  // Keyframe ratios (0 is the beginning of the track, 1 is the end).
+  Range<float> ratios_;
+
+  // Keyframe values, key major.
+  Range<float> values_;
+
+  // Keyframe modes (1 bit per value): 1 for step, 0 for linear.
+  Range<uint8_t> steps_;
+
+  // Number of channels (values per keyframe).
+  int num_channels_;
+
+  // Track set name.
+  char* name_;
+};
+}  // namespace animation
+namespace io {
+OZZ_IO_TYPE_VERSION(1, animation::TrackSet)
+OZZ_IO_TYPE_TAG("ozz-track_set", animation::TrackSet)
+}  // namespace io
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_TRACK_SET_H_
@@ -49,6 +49,12 @@ class FloatTrack;
 struct TrackTriggeringJob {
   TrackTriggeringJob();
 
+  // Structure of an edge as detected by the job.
+  struct Edge {
+    float ratio;  // Ratio at which track value crossed threshold.
+    bool rising;  // true is edge is rising (getting higher than threshold).
+  };
+
   // Validates job parameters.
   bool Validate() const;
 
@@ -76,6 +82,14 @@ struct TrackTriggeringJob {
   // Track to sample.
   const FloatTrack* track;
 
+  // Optional edge index of track for this threshold, as computed by
+  // ComputeTrackEdges(). When provided, the iterator binary searches the first
+  // edge and then iterates edges only, instead of testing every keyframe of
+  // every loop between from and to. This is much faster for long ranges, like
+  // when catching up after a hitch or fast-forwarding over many loops.
+  // The index must be recomputed if track or threshold change.
+  Range<const Edge> edges;
+
   // Job output iterator.
   class Iterator;
   Iterator* iterator;
@@ -84,12 +98,6 @@ struct TrackTriggeringJob {
   // be used to test if iterator loop reached the end (using operator !=), and
   // shall not be dereferenced.
   Iterator end() const;
-
-  // Structure of an edge as detected by the job.
-  struct Edge {
-    float ratio;  // Ratio at which track value crossed threshold.
-    bool rising;  // true is edge is rising (getting higher than threshold).
-  };
 };
 
 // Iterator implementation. Calls to ++ operator will compute the next edge. It
@@ -132,6 +140,9 @@ class TrackTriggeringJob::Iterator {
 
   // Constructors used by the job.
   explicit Iterator(const TrackTriggeringJob* _job);
+
+  // Evaluates next edge from job's edge index.
+  const Iterator& IncrementIndexed();
   struct End {};
   Iterator(const TrackTriggeringJob* _job, End)
       : job_(_job),
@@ -156,6 +167,60 @@ class TrackTriggeringJob::Iterator {
 inline TrackTriggeringJob::Iterator TrackTriggeringJob::end() const {
   return Iterator(this, Iterator::End());
 }
+
+// Track batch triggering job implementation. Runs multiple edge triggering
+// queries, like footsteps or vfx tracks of many characters, and extracts all
+// their edges to a single contiguous events buffer. Events are output in
+// queries order, and in iteration order for each query. Each event is tagged
+// with the index of its query. Batches can be processed in parallel by
+// splitting queries in sub-ranges, each with its own events buffer.
+struct TrackBatchTriggeringJob {
+  TrackBatchTriggeringJob();
+
+  // Triggering query, see TrackTriggeringJob members for more details.
+  struct Query {
+    const FloatTrack* track;
+    float from;
+    float to;
+    float threshold;
+    // Optional edge index.
+    Range<const TrackTriggeringJob::Edge> edges;
+  };
+
+  // Event, aka an edge detected by the query at index query.
+  struct Event {
+    int query;
+    float ratio;
+    bool rising;
+  };
+
+  // Validates job parameters:
+  // - if num_events is NULL.
+  // - if any query track is NULL.
+  bool Validate() const;
+
+  // Validates and executes job. Returns false if validation failed, or if
+  // events buffer is too small to receive all edges. Events that fit are still
+  // output in that case.
+  bool Run() const;
+
+  // Queries to process.
+  Range<const Query> queries;
+
+  // Job output events buffer.
+  Range<Event> events;
+
+  // Job output, number of events written to events buffer.
+  size_t* num_events;
+};
+
+// Computes _track edge index for _threshold, to be used as
+// TrackTriggeringJob::edges. Edges are those a forward iteration meets during
+// a single loop of the track, sorted by ratio. _edges must be at least as big
+// as the number of _track keyframes.
+// Returns the number of edges written to _edges, or -1 if _edges is too small.
+int ComputeTrackEdges(const FloatTrack& _track, float _threshold,
+                      const Range<TrackTriggeringJob::Edge>& _edges);
 }  // namespace animation
 }  // namespace ozz
 #endif  // OZZ_OZZ_ANIMATION_RUNTIME_TRACK_TRIGGERING_JOB_H_
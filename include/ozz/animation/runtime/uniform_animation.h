@@ -0,0 +1,133 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_UNIFORM_ANIMATION_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_UNIFORM_ANIMATION_H_
+
+#include "ozz/base/io/archive_traits.h"
+#include "ozz/base/platform.h"
+
+namespace ozz {
+namespace io {
+class IArchive;
+class OArchive;
+}  // namespace io
+namespace math {
+struct SoaTransform;
+}  // namespace math
+namespace animation {
+
+// Forward declares the UniformAnimationBuilder, used to instantiate a
+// UniformAnimation.
+namespace offline {
+class UniformAnimationBuilder;
+}
+
+// Defines a runtime skeletal animation clip sampled at a fixed frequency.
+// Unlike Animation, which stores sparse keyframes that must be searched for,
+// a uniform animation stores a dense pose for every frame, as soa transforms
+// ready to be interpolated. Sampling (see UniformSamplingJob) directly indexes
+// the 2 frames surrounding the sampled ratio, with no key search and no cache.
+// This is memory intensive (40 bytes per track and per frame), but well suited
+// for short baked animations (rigid bodies simulations, destruction sequences)
+// that are played by many instances, possibly at random ratios.
+// This structure is filled by the UniformAnimationBuilder and deserialized/
+// loaded at runtime.
+class UniformAnimation {
+ public:
+  // Builds a default (empty) animation.
+  UniformAnimation();
+
+  // Declares the public non-virtual destructor.
+  ~UniformAnimation();
+
+  // Gets the animation clip duration.
+  float duration() const { return duration_; }
+
+  // Gets the number of animated tracks.
+  int num_tracks() const { return num_tracks_; }
+
+  // Returns the number of SoA elements matching the number of tracks of *this
+  // animation. This value is useful to allocate SoA runtime data structures.
+  int num_soa_tracks() const { return (num_tracks_ + 3) / 4; }
+
+  // Gets the number of frames. Frames are evenly spread over the animation
+  // duration, the first one is at ratio 0 and the last one at ratio 1.
+  int num_frames() const { return num_frames_; }
+
+  // Gets animation name.
+  const char* name() const { return name_ ? name_ : ""; }
+
+  // Gets the buffer of frames, num_soa_tracks() soa transforms per frame.
+  Range<const math::SoaTransform> frames() const { return frames_; }
+
+  // Gets the soa transforms of frame _frame, which must be in range
+  // [0,num_frames()[.
+  const math::SoaTransform* frame(int _frame) const;
+
+  // Get the estimated animation's size in bytes.
+  size_t size() const;
+
+  // Serialization functions.
+  // Should not be called directly but through io::Archive << and >> operators.
+  void Save(ozz::io::OArchive& _archive) const;
+  void Load(ozz::io::IArchive& _archive, uint32_t _version);
+
+ private:
+  // Disables copy and assignation.
+  UniformAnimation(UniformAnimation const&);
+  void operator=(UniformAnimation const&);
+
+  // UniformAnimationBuilder class is allowed to instantiate a
+  // UniformAnimation.
+  friend class offline::UniformAnimationBuilder;
+
+  // Internal allocation and destruction functions.
+  void Allocate(size_t _name_len, int _num_tracks, int _num_frames);
+  void Deallocate();
+
+  // Duration of the animation clip.
+  float duration_;
+
+  // Number of joint tracks and frames.
+  int num_tracks_;
+  int num_frames_;
+
+  // Animation name.
+  char* name_;
+
+  // Stores all frames, num_soa_tracks() soa transforms per frame.
+  Range<math::SoaTransform> frames_;
+};
+}  // namespace animation
+
+namespace io {
+OZZ_IO_TYPE_VERSION(1, animation::UniformAnimation)
+OZZ_IO_TYPE_TAG("ozz-uniform_animation", animation::UniformAnimation)
+}  // namespace io
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_UNIFORM_ANIMATION_H_
@@ -0,0 +1,87 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_UNIFORM_SAMPLING_JOB_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_UNIFORM_SAMPLING_JOB_H_
+
+#include "ozz/base/platform.h"
+
+namespace ozz {
+
+// Forward declaration of math structures.
+namespace math {
+struct SoaTransform;
+}
+
+namespace animation {
+
+// Forward declares the uniform animation type to sample.
+class UniformAnimation;
+
+// Samples a uniform animation at a given time ratio in the unit interval
+// [0,1]. The 2 frames surrounding the ratio are directly indexed, and their
+// transforms are interpolated (nlerp for rotations), so no cache is required:
+// the job is stateless and costs the same whatever the ratio, or the ratio of
+// the previous sampling.
+// The job does not owned the buffers (in/output) and will thus not delete
+// them during job's destruction.
+struct UniformSamplingJob {
+  // Default constructor, initializes default values.
+  UniformSamplingJob();
+
+  // Validates job parameters. Returns true for a valid job, or false otherwise:
+  // -if animation pointer is NULL.
+  // -if output range is smaller than the animation's number of soa tracks.
+  bool Validate() const;
+
+  // Runs job's sampling task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // Time ratio in the unit interval [0,1] used to sample animation (where 0 is
+  // the beginning of the animation, 1 is the end). It should be computed as the
+  // current time in the animation, divided by animation duration.
+  // This ratio is clamped before job execution in order to resolves any
+  // approximation issue on range bounds.
+  float ratio;
+
+  // The animation to sample.
+  const UniformAnimation* animation;
+
+  // Job output.
+  // The output range to be filled with sampled joints during job execution.
+  // If there are less joints in the animation compared to the output range,
+  // then remaining SoaTransform are left unchanged.
+  // If there are more joints in the animation, then the last joints are not
+  // sampled.
+  Range<ozz::math::SoaTransform> output;
+};
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_UNIFORM_SAMPLING_JOB_H_
@@ -0,0 +1,252 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_BASE_CONTAINERS_ALIGNED_VECTOR_H_
+#define OZZ_OZZ_BASE_CONTAINERS_ALIGNED_VECTOR_H_
+
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <new>
+
+#include "ozz/base/memory/allocator.h"
+#include "ozz/base/platform.h"
+
+namespace ozz {
+
+// Implements a vector which elements are aligned on _Alignment bytes
+// boundaries (like 16, 32 or 64, typically to match SIMD registers or cache
+// lines), whatever _Ty alignment requirement is. It's meant for SoA runtime
+// buffers (math::SoaTransform, math::Float4x4...) that are resized often:
+// resize_uninitialized() changes the size without value-initializing new
+// elements, which std::vector::resize() can't avoid.
+// Elements are relocated with memcpy when the vector grows, so _Ty must be
+// trivially copyable and destructible, like all ozz SoA and math types.
+// Memory is allocated from the allocator given at construction time (default
+// allocator by default).
+template <typename _Ty, size_t _Alignment = 16>
+class AlignedVector {
+ public:
+  typedef _Ty value_type;
+  typedef _Ty* iterator;
+  typedef const _Ty* const_iterator;
+
+  // Gets elements alignment.
+  static size_t alignment() {
+    return _Alignment > OZZ_ALIGN_OF(_Ty) ? _Alignment : OZZ_ALIGN_OF(_Ty);
+  }
+
+  // Builds an empty vector, which will allocate from _allocator.
+  explicit AlignedVector(
+      memory::Allocator* _allocator = memory::default_allocator())
+      : allocator_(_allocator), begin_(NULL), size_(0), capacity_(0) {
+    OZZ_STATIC_ASSERT((_Alignment & (_Alignment - 1)) == 0);
+    assert(_allocator && "Invalid allocator");
+  }
+
+  AlignedVector(const AlignedVector& _other)
+      : allocator_(_other.allocator_), begin_(NULL), size_(0), capacity_(0) {
+    *this = _other;
+  }
+
+  ~AlignedVector() { allocator_->Deallocate(begin_); }
+
+  AlignedVector& operator=(const AlignedVector& _other) {
+    if (this != &_other) {
+      resize_uninitialized(_other.size_);
+      if (size_ != 0) {
+        std::memcpy(begin_, _other.begin_, sizeof(_Ty) * size_);
+      }
+    }
+    return *this;
+  }
+
+#if __cplusplus >= 201103L
+  // Moves _other buffer and allocator to *this, without reallocating.
+  AlignedVector(AlignedVector&& _other)
+      : allocator_(_other.allocator_),
+        begin_(_other.begin_),
+        size_(_other.size_),
+        capacity_(_other.capacity_) {
+    _other.begin_ = NULL;
+    _other.size_ = 0;
+    _other.capacity_ = 0;
+  }
+
+  AlignedVector& operator=(AlignedVector&& _other) {
+    if (this != &_other) {
+      allocator_->Deallocate(begin_);
+      allocator_ = _other.allocator_;
+      begin_ = _other.begin_;
+      size_ = _other.size_;
+      capacity_ = _other.capacity_;
+      _other.begin_ = NULL;
+      _other.size_ = 0;
+      _other.capacity_ = 0;
+    }
+    return *this;
+  }
+#endif  // __cplusplus
+
+  // Ensures capacity is at least _capacity elements, reallocating if needed.
+  void reserve(size_t _capacity) {
+    if (_capacity <= capacity_) {
+      return;
+    }
+    _Ty* elements = reinterpret_cast<_Ty*>(
+        allocator_->Allocate(sizeof(_Ty) * _capacity, alignment()));
+    if (size_ != 0) {
+      std::memcpy(elements, begin_, sizeof(_Ty) * size_);
+    }
+    allocator_->Deallocate(begin_);
+    begin_ = elements;
+    capacity_ = _capacity;
+  }
+
+  // Resizes to _size elements, without initializing new elements. This is the
+  // fastest way to size a buffer that's about to be entirely written (like a
+  // job output).
+  void resize_uninitialized(size_t _size) {
+    if (_size > capacity_) {
+      reserve(_size);
+    }
+    size_ = _size;
+  }
+
+  // Resizes to _size elements, new elements are copies of _value.
+  void resize(size_t _size, const _Ty& _value) {
+    const size_t size = size_;
+    resize_uninitialized(_size);
+    for (size_t i = size; i < _size; ++i) {
+      new (begin_ + i) _Ty(_value);
+    }
+  }
+
+  // Resizes to _size elements, new elements are value-initialized, like
+  // std::vector::resize().
+  void resize(size_t _size) { resize(_size, _Ty()); }
+
+  void push_back(const _Ty& _value) {
+    if (size_ == capacity_) {
+      // _value might belong to *this, so it's copied before reallocating.
+      const _Ty copy(_value);
+      reserve(capacity_ != 0 ? capacity_ * 2 : 4);
+      new (begin_ + size_) _Ty(copy);
+    } else {
+      new (begin_ + size_) _Ty(_value);
+    }
+    ++size_;
+  }
+
+  void pop_back() {
+    assert(size_ != 0 && "Vector is empty");
+    --size_;
+  }
+
+  // Sets size to 0. Capacity isn't affected.
+  void clear() { size_ = 0; }
+
+  // Releases unused capacity.
+  void shrink_to_fit() {
+    if (size_ == capacity_) {
+      return;
+    }
+    AlignedVector shrunk(allocator_);
+    shrunk.resize_uninitialized(size_);
+    if (size_ != 0) {
+      std::memcpy(shrunk.begin_, begin_, sizeof(_Ty) * size_);
+    }
+    swap(shrunk);
+  }
+
+  // Swaps content, including allocators, with _other.
+  void swap(AlignedVector& _other) {
+    memory::Allocator* allocator = allocator_;
+    allocator_ = _other.allocator_;
+    _other.allocator_ = allocator;
+    _Ty* begin = begin_;
+    begin_ = _other.begin_;
+    _other.begin_ = begin;
+    const size_t size = size_;
+    size_ = _other.size_;
+    _other.size_ = size;
+    const size_t capacity = capacity_;
+    capacity_ = _other.capacity_;
+    _other.capacity_ = capacity;
+  }
+
+  _Ty& operator[](size_t _index) {
+    assert(_index < size_ && "Index out of range");
+    return begin_[_index];
+  }
+  const _Ty& operator[](size_t _index) const {
+    assert(_index < size_ && "Index out of range");
+    return begin_[_index];
+  }
+
+  iterator begin() { return begin_; }
+  const_iterator begin() const { return begin_; }
+  iterator end() { return begin_ + size_; }
+  const_iterator end() const { return begin_ + size_; }
+
+  _Ty* data() { return begin_; }
+  const _Ty* data() const { return begin_; }
+
+  size_t size() const { return size_; }
+  size_t capacity() const { return capacity_; }
+  bool empty() const { return size_ == 0; }
+
+  memory::Allocator* allocator() const { return allocator_; }
+
+ private:
+  // Allocator used for elements memory.
+  memory::Allocator* allocator_;
+
+  // Begin of the elements, NULL if nothing's allocated.
+  _Ty* begin_;
+
+  // Number of elements.
+  size_t size_;
+
+  // Number of elements that fit in begin_ memory.
+  size_t capacity_;
+};
+
+// Returns a mutable ozz::Range from an AlignedVector.
+template <typename _Ty, size_t _Alignment>
+inline Range<_Ty> make_range(AlignedVector<_Ty, _Alignment>& _vector) {
+  return Range<_Ty>(_vector.data(), _vector.size());
+}
+
+// Returns a non mutable ozz::Range from an AlignedVector.
+template <typename _Ty, size_t _Alignment>
+inline Range<const _Ty> make_range(
+    const AlignedVector<_Ty, _Alignment>& _vector) {
+  return Range<const _Ty>(_vector.data(), _vector.size());
+}
+}  // namespace ozz
+#endif  // OZZ_OZZ_BASE_CONTAINERS_ALIGNED_VECTOR_H_
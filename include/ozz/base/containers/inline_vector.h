@@ -0,0 +1,216 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_BASE_CONTAINERS_INLINE_VECTOR_H_
+#define OZZ_OZZ_BASE_CONTAINERS_INLINE_VECTOR_H_
+
+#include <cassert>
+#include <cstddef>
+#include <new>
+
+#include "ozz/base/memory/allocator.h"
+#include "ozz/base/platform.h"
+
+namespace ozz {
+
+// Implements a vector with an inline capacity of _Capacity elements, stored
+// within the object itself. Elements are only moved to memory allocated
+// from the default allocator when the size exceeds _Capacity. Choosing
+// _Capacity to fit typical rigs (ex: skeleton's num_soa_joints()) ensures SoA
+// runtime buffers can live on the stack and never hit the heap.
+// Inline storage is aligned on 16 bytes, which is enough for all ozz types
+// including math::SoaTransform. Types requiring a stronger alignment aren't
+// supported.
+template <typename _Ty, size_t _Capacity>
+class InlineVector {
+ public:
+  typedef _Ty value_type;
+  typedef _Ty* iterator;
+  typedef const _Ty* const_iterator;
+
+  // Builds an empty vector, using inline storage.
+  InlineVector() : begin_(inline_begin()), size_(0), capacity_(_Capacity) {}
+
+  // Builds a vector of _size default constructed elements.
+  explicit InlineVector(size_t _size)
+      : begin_(inline_begin()), size_(0), capacity_(_Capacity) {
+    resize(_size);
+  }
+
+  InlineVector(const InlineVector& _other)
+      : begin_(inline_begin()), size_(0), capacity_(_Capacity) {
+    *this = _other;
+  }
+
+  ~InlineVector() {
+    clear();
+    if (!is_inline()) {
+      memory::default_allocator()->Deallocate(begin_);
+    }
+  }
+
+  InlineVector& operator=(const InlineVector& _other) {
+    if (this != &_other) {
+      clear();
+      reserve(_other.size_);
+      for (size_t i = 0; i < _other.size_; ++i) {
+        new (begin_ + i) _Ty(_other.begin_[i]);
+      }
+      size_ = _other.size_;
+    }
+    return *this;
+  }
+
+  // Ensures capacity is at least _capacity. Allocates from the default
+  // allocator if _capacity exceeds current capacity.
+  void reserve(size_t _capacity) {
+    if (_capacity <= capacity_) {
+      return;
+    }
+    memory::Allocator* allocator = memory::default_allocator();
+    _Ty* elements = reinterpret_cast<_Ty*>(
+        allocator->Allocate(sizeof(_Ty) * _capacity, OZZ_ALIGN_OF(_Ty)));
+    for (size_t i = 0; i < size_; ++i) {
+      new (elements + i) _Ty(begin_[i]);
+      begin_[i].~_Ty();
+    }
+    if (!is_inline()) {
+      allocator->Deallocate(begin_);
+    }
+    begin_ = elements;
+    capacity_ = _capacity;
+  }
+
+  // Resizes to _size elements, default constructing new ones.
+  void resize(size_t _size) { resize(_size, _Ty()); }
+
+  // Resizes to _size elements, copy constructing new ones from _value.
+  void resize(size_t _size, const _Ty& _value) {
+    if (_size > capacity_) {
+      reserve(grow(_size));
+    }
+    for (size_t i = size_; i < _size; ++i) {
+      new (begin_ + i) _Ty(_value);
+    }
+    for (size_t i = _size; i < size_; ++i) {
+      begin_[i].~_Ty();
+    }
+    size_ = _size;
+  }
+
+  void push_back(const _Ty& _value) {
+    if (size_ == capacity_) {
+      // _value might belong to *this, so it's copied before reallocating.
+      const _Ty copy(_value);
+      reserve(grow(size_ + 1));
+      new (begin_ + size_) _Ty(copy);
+    } else {
+      new (begin_ + size_) _Ty(_value);
+    }
+    ++size_;
+  }
+
+  void pop_back() {
+    assert(size_ != 0 && "Vector is empty");
+    begin_[--size_].~_Ty();
+  }
+
+  // Destroys all elements. Capacity isn't affected.
+  void clear() {
+    for (size_t i = 0; i < size_; ++i) {
+      begin_[i].~_Ty();
+    }
+    size_ = 0;
+  }
+
+  _Ty& operator[](size_t _index) {
+    assert(_index < size_ && "Index out of range");
+    return begin_[_index];
+  }
+  const _Ty& operator[](size_t _index) const {
+    assert(_index < size_ && "Index out of range");
+    return begin_[_index];
+  }
+
+  iterator begin() { return begin_; }
+  const_iterator begin() const { return begin_; }
+  iterator end() { return begin_ + size_; }
+  const_iterator end() const { return begin_ + size_; }
+
+  _Ty* data() { return begin_; }
+  const _Ty* data() const { return begin_; }
+
+  size_t size() const { return size_; }
+  size_t capacity() const { return capacity_; }
+  bool empty() const { return size_ == 0; }
+
+  // Returns true if elements are stored inline, meaning no memory was
+  // allocated.
+  bool is_inline() const { return begin_ == inline_begin(); }
+
+  // Gets inline capacity.
+  static size_t inline_capacity() { return _Capacity; }
+
+ private:
+  _Ty* inline_begin() { return reinterpret_cast<_Ty*>(storage_); }
+  const _Ty* inline_begin() const {
+    return reinterpret_cast<const _Ty*>(storage_);
+  }
+
+  // Computes new capacity, growing geometrically to amortize reallocations.
+  size_t grow(size_t _min) const {
+    const size_t doubled = capacity_ * 2;
+    return doubled > _min ? doubled : _min;
+  }
+
+  // Inline storage. Elements are constructed in place.
+  OZZ_ALIGN(16) char storage_[sizeof(_Ty) * _Capacity];
+
+  // Begin of the elements, either inline storage or allocated memory.
+  _Ty* begin_;
+
+  // Number of constructed elements.
+  size_t size_;
+
+  // Number of elements that fit in begin_ memory.
+  size_t capacity_;
+};
+
+// Returns a mutable ozz::Range from an InlineVector.
+template <typename _Ty, size_t _Capacity>
+inline Range<_Ty> make_range(InlineVector<_Ty, _Capacity>& _vector) {
+  return Range<_Ty>(_vector.data(), _vector.size());
+}
+
+// Returns a non mutable ozz::Range from an InlineVector.
+template <typename _Ty, size_t _Capacity>
+inline Range<const _Ty> make_range(
+    const InlineVector<_Ty, _Capacity>& _vector) {
+  return Range<const _Ty>(_vector.data(), _vector.size());
+}
+}  // namespace ozz
+#endif  // OZZ_OZZ_BASE_CONTAINERS_INLINE_VECTOR_H_
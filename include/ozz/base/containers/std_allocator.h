@@ -29,6 +29,7 @@
 #define OZZ_OZZ_BASE_CONTAINERS_STD_ALLOCATOR_H_
 
 #include <new>
+#include <utility>
 
 #include "ozz/base/memory/allocator.h"
 
@@ -89,11 +90,20 @@ class StdAllocator {
     memory::default_allocator()->Deallocate(_ptr);
   }
 
+#if __cplusplus >= 201103L
+  // Constructs object at _Ptr from _args, allowing move construction.
+  template <class _Other, class... _Args>
+  void construct(_Other* _ptr, _Args&&... _args) {
+    void* vptr = _ptr;
+    ::new (vptr) _Other(std::forward<_Args>(_args)...);
+  }
+#else   // __cplusplus
   // Constructs object at _Ptr with value _val.
   void construct(pointer _ptr, const _Ty& _val) {
     void* vptr = _ptr;
     ::new (vptr) _Ty(_val);
   }
+#endif  // __cplusplus
 
   // Destroys object at _Ptr.
   void destroy(pointer _ptr) {
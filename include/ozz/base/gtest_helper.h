@@ -90,22 +90,22 @@ inline int AbortHook(int, char*, int*) { exit(EXIT_FAILURE); }
 // Specialises EXPECT_EQ_LOG* for verbose clog output type.
 #define EXPECT_EQ_LOG_LOGV(_expression, _eq, _re) \
   EXPECT_EQ_LOG(_expression, _eq, std::clog,      \
-                ozz::log::kVerbose <= ozz::log::GetLevel() ? _re : NULL)
+                ozz::log::IsEnabled(ozz::log::kVerbose) ? _re : NULL)
 
 // Specialises EXPECT_EQ_LOG* for standard clog output type.
 #define EXPECT_EQ_LOG_LOG(_expression, _eq, _re) \
   EXPECT_EQ_LOG(_expression, _eq, std::clog,     \
-                ozz::log::kStandard <= ozz::log::GetLevel() ? _re : NULL)
+                ozz::log::IsEnabled(ozz::log::kStandard) ? _re : NULL)
 
 // Specialises EXPECT_EQ_LOG* for standard cout output type.
 #define EXPECT_EQ_LOG_OUT(_expression, _eq, _re) \
   EXPECT_EQ_LOG(_expression, _eq, std::cout,     \
-                ozz::log::kStandard <= ozz::log::GetLevel() ? _re : NULL)
+                ozz::log::IsEnabled(ozz::log::kStandard) ? _re : NULL)
 
 // Specialises EXPECT_EQ_LOG* for standard cerr output type.
 #define EXPECT_EQ_LOG_ERR(_expression, _eq, _re) \
   EXPECT_EQ_LOG(_expression, _eq, std::cerr,     \
-                ozz::log::kStandard <= ozz::log::GetLevel() ? _re : NULL)
+                ozz::log::IsEnabled(ozz::log::kStandard) ? _re : NULL)
 
 // EXPECT_EQ_LOG* executes _expression while redirecting _output (ex:
 // std::clog) and then expects that the output matched the regular expression
@@ -123,22 +123,22 @@ inline int AbortHook(int, char*, int*) { exit(EXIT_FAILURE); }
 // Specialises EXPECT_LOG* for verbose clog output type.
 #define EXPECT_LOG_LOGV(_expression, _re) \
   EXPECT_LOG(_expression, std::clog,      \
-             ozz::log::kVerbose <= ozz::log::GetLevel() ? _re : NULL)
+             ozz::log::IsEnabled(ozz::log::kVerbose) ? _re : NULL)
 
 // Specialises EXPECT_LOG* for standard clog output type.
 #define EXPECT_LOG_LOG(_expression, _re) \
   EXPECT_LOG(_expression, std::clog,     \
-             ozz::log::kStandard <= ozz::log::GetLevel() ? _re : NULL)
+             ozz::log::IsEnabled(ozz::log::kStandard) ? _re : NULL)
 
 // Specialises EXPECT_LOG* for standard cout output type.
 #define EXPECT_LOG_OUT(_expression, _re) \
   EXPECT_LOG(_expression, std::cout,     \
-             ozz::log::kStandard <= ozz::log::GetLevel() ? _re : NULL)
+             ozz::log::IsEnabled(ozz::log::kStandard) ? _re : NULL)
 
 // Specialises EXPECT_LOG* for standard cerr output type.
 #define EXPECT_LOG_ERR(_expression, _re) \
   EXPECT_LOG(_expression, std::cerr,     \
-             ozz::log::kStandard <= ozz::log::GetLevel() ? _re : NULL)
+             ozz::log::IsEnabled(ozz::log::kStandard) ? _re : NULL)
 
 namespace internal {
 class RedirectOuputTester {
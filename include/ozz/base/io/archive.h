@@ -225,12 +225,29 @@ class IArchive {
     // mean the file containing tag declaration is not included.
     OZZ_STATIC_ASSERT(internal::Tag<const _Ty>::kTagLength != 0);
 
-    const int tell = stream_->Tell();
+    const int64_t tell = stream_->Tell();
     bool valid = internal::Tagger<const _Ty>::Validate(*this);
     stream_->Seek(tell, Stream::kSet);  // Rewinds before the tag test.
     return valid;
   }
 
+  // Returns the version of the _Ty object stored at the current stream
+  // position, without consuming it. This allows to detect archives written
+  // with an older version of a type before loading them. Returns 0 if stream
+  // doesn't contain a _Ty object, or if _Ty isn't versioned.
+  template <typename _Ty>
+  uint32_t PeekVersion() {
+    OZZ_STATIC_ASSERT(internal::Tag<const _Ty>::kTagLength != 0);
+
+    const int64_t tell = stream_->Tell();
+    uint32_t version = 0;
+    if (internal::Tagger<const _Ty>::Validate(*this)) {
+      version = LoadVersion<_Ty>();
+    }
+    stream_->Seek(tell, Stream::kSet);  // Rewinds before the tag test.
+    return version;
+  }
+
   // Returns input stream.
   Stream* stream() const { return stream_; }
 
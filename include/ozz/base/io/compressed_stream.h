@@ -0,0 +1,173 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_BASE_IO_COMPRESSED_STREAM_H_
+#define OZZ_OZZ_BASE_IO_COMPRESSED_STREAM_H_
+
+// Provides a Stream decorator that compresses or decompresses data with a fast
+// LZ4 class block compression.
+
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/io/stream.h"
+#include "ozz/base/platform.h"
+
+#include <cstddef>
+
+namespace ozz {
+namespace io {
+
+// Implements a Stream decorator that compresses data written to, or
+// decompresses data read from, an underlying stream. OArchive and IArchive can
+// be layered on top of it, the same way as any other stream.
+// Data are split in blocks of up to block_size() bytes, each compressed
+// independently with an LZ4 class algorithm (byte oriented LZ77, designed for
+// decompression speed). Blocks independence allows streaming, random access,
+// and decompressing blocks concurrently (see DecompressBlock()). Blocks that
+// don't compress are stored raw.
+// Frame layout is: "OZLZ" magic and block size, then for each block its raw
+// size, stored size and data, and finally an empty end block. All integers are
+// 32 bits little endian.
+// In compression mode, data can only be written sequentially. In decompression
+// mode, the blocks index is read at opening, so the stream is seekable.
+class CompressedStream : public Stream {
+ public:
+  // Compression or decompression mode.
+  enum Mode { kCompress, kDecompress };
+
+  // Default and maximum size of uncompressed blocks.
+  enum { kDefaultBlockSize = 64 << 10, kMaxBlockSize = 4 << 20 };
+
+  // Tests whether _stream, at its current position, starts with a compressed
+  // frame. _stream position is restored.
+  static bool IsCompressed(Stream* _stream);
+
+  // Constructs a decorator compressing to, or decompressing from, _stream
+  // starting at its current position. _stream must outlive this object.
+  // In compression mode, frame header is written immediately, _block_size being
+  // clamped to [1, kMaxBlockSize]. In decompression mode, _block_size is
+  // ignored as it's read from frame header, and underlying _stream is left
+  // positioned at the end of the frame. Use opened() to test result.
+  CompressedStream(Stream* _stream, Mode _mode,
+                   int _block_size = kDefaultBlockSize);
+
+  // Closes the stream, see Close().
+  virtual ~CompressedStream();
+
+  // In compression mode, flushes pending data and writes end of frame. Data
+  // can't be read or written afterward. Returns false if writing failed.
+  bool Close();
+
+  // Gets stream mode.
+  Mode mode() const { return mode_; }
+
+  // Gets maximum uncompressed size of a block.
+  int block_size() const { return static_cast<int>(block_size_); }
+
+  // See Stream::opened for details.
+  virtual bool opened() const;
+
+  // See Stream::Read for details. Fails in compression mode.
+  virtual size_t Read(void* _buffer, size_t _size);
+
+  // See Stream::Write for details. Fails in decompression mode.
+  virtual size_t Write(const void* _buffer, size_t _size);
+
+  // See Stream::Seek for details. In compression mode, seeking is only
+  // supported to the current position.
+  virtual int Seek(int64_t _offset, Origin _origin);
+
+  // See Stream::Tell for details. Position is in uncompressed data.
+  virtual int64_t Tell() const;
+
+  // See Stream::Size for details. Size is the uncompressed data size.
+  virtual uint64_t Size() const;
+
+  // Gets the maximum compressed size of _size bytes block.
+  static size_t CompressBound(size_t _size);
+
+  // Compresses _src_size bytes from _src to _dest buffer of _dest_size bytes.
+  // Returns compressed size, or 0 if _dest isn't big enough.
+  static size_t CompressBlock(const void* _src, size_t _src_size, void* _dest,
+                              size_t _dest_size);
+
+  // Decompresses _src_size bytes from _src to exactly _dest_size bytes of
+  // _dest. Returns false if _src is corrupted.
+  static bool DecompressBlock(const void* _src, size_t _src_size, void* _dest,
+                              size_t _dest_size);
+
+ private:
+  // Reads frame header and blocks index.
+  bool OpenFrame();
+
+  // Compresses and writes pending data.
+  bool FlushBlock();
+
+  // Ensures block _index is decompressed to raw_ buffer.
+  bool LoadBlock(int _index);
+
+  // Finds index of the block containing uncompressed position _position.
+  int FindBlock(uint64_t _position) const;
+
+  // Block index entry.
+  struct Block {
+    // Offset of block data in the underlying stream.
+    int64_t offset;
+    // Offset of block data in uncompressed data.
+    uint64_t position;
+    // Uncompressed size.
+    uint32_t size;
+    // Stored size, including kStoredRaw flag.
+    uint32_t stored;
+  };
+
+  Stream* stream_;
+  Mode mode_;
+  size_t block_size_;
+
+  // Tells if stream is usable.
+  bool valid_;
+
+  // Uncompressed block buffer, and compressed block buffer.
+  char* raw_;
+  char* packed_;
+
+  // Number of pending bytes in raw_, in compression mode.
+  size_t pending_;
+
+  // Index of the block decompressed in raw_, or -1.
+  int current_;
+
+  // Blocks index, in decompression mode.
+  ozz::Vector<Block>::Std blocks_;
+
+  // Uncompressed position and size.
+  uint64_t tell_;
+  uint64_t size_;
+};
+}  // namespace io
+}  // namespace ozz
+#endif  // OZZ_OZZ_BASE_IO_COMPRESSED_STREAM_H_
@@ -0,0 +1,129 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_BASE_IO_MAPPED_FILE_H_
+#define OZZ_OZZ_BASE_IO_MAPPED_FILE_H_
+
+// Provides read-only memory-mapped file access.
+
+#include "ozz/base/io/stream.h"
+#include "ozz/base/platform.h"
+
+#include <cstddef>
+
+namespace ozz {
+namespace io {
+
+// Maps a whole file read-only to memory. Pages are loaded lazily by the
+// operating system when they are first accessed, and are shared by all the
+// processes mapping the same file. This allows, through flat representations
+// (see Animation::MapFlat()), to use runtime data directly from the file
+// without loading nor copying it: unused data never touch RAM.
+// Content address is aligned to a page boundary (or 16 bytes when read to
+// memory), which satisfies flat representations alignment requirements.
+// On platforms without file mapping support, the file is read to a buffer
+// allocated from the default allocator, see mapped().
+class MappedFile {
+ public:
+  // Maps file at path _filename. Use opened() function to test result.
+  explicit MappedFile(const char* _filename);
+
+  // Unmaps the file if it is opened.
+  ~MappedFile();
+
+  // Unmaps the file if it is opened. Data returned by data() becomes invalid.
+  void Close();
+
+  // Tests whether the file is opened.
+  bool opened() const { return data_ != NULL; }
+
+  // Tells if the file is actually memory-mapped, rather than read to memory.
+  bool mapped() const { return mapped_; }
+
+  // Gets file content, NULL if file isn't opened.
+  const void* data() const { return data_; }
+
+  // Gets file size in bytes.
+  size_t size() const { return size_; }
+
+ private:
+  MappedFile(const MappedFile&);
+  void operator=(const MappedFile&);
+
+  // File content.
+  const void* data_;
+
+  // File size in bytes.
+  size_t size_;
+
+  // Content is mapped, not read to an allocated buffer.
+  bool mapped_;
+};
+
+// Implements a read-only Stream over a MappedFile, so archives can be read
+// straight from a memory-mapped file (or pack of files). Reading copies data
+// from file pages to the output buffer only, with no intermediate buffering.
+class MappedFileStream : public Stream {
+ public:
+  // Maps file at path _filename. Use opened() function to test result.
+  explicit MappedFileStream(const char* _filename);
+
+  // Unmaps the file.
+  virtual ~MappedFileStream();
+
+  // Gets the mapped file, whose data can be accessed directly.
+  const MappedFile& file() const { return file_; }
+
+  // See Stream::opened for details.
+  virtual bool opened() const;
+
+  // See Stream::Read for details.
+  virtual size_t Read(void* _buffer, size_t _size);
+
+  // Writing to a read-only stream always fails, returning 0.
+  virtual size_t Write(const void* _buffer, size_t _size);
+
+  // See Stream::Seek for details.
+  virtual int Seek(int64_t _offset, Origin _origin);
+
+  // See Stream::Tell for details.
+  virtual int64_t Tell() const;
+
+  // See Stream::Tell for details.
+  virtual uint64_t Size() const;
+
+ private:
+  // The mapped file, must be declared before stream_ as it's initialized
+  // from it.
+  MappedFile file_;
+
+  // Stream over mapped file content.
+  ExternalMemoryStream stream_;
+};
+}  // namespace io
+}  // namespace ozz
+#endif  // OZZ_OZZ_BASE_IO_MAPPED_FILE_H_
@@ -0,0 +1,222 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_BASE_IO_PACK_H_
+#define OZZ_OZZ_BASE_IO_PACK_H_
+
+// Provides a pack (aka bundle) format, that stores many archived objects
+// (skeletons, animations, tracks...) in a single stream, indexed by a table
+// of contents.
+//
+// Pack layout is:
+// - A header archive: "ozz-pack" tag, version, number of entries and offset
+//   of the table of contents.
+// - Entries payloads, each aligned to PackWriter::kAlignment bytes relatively
+//   to the beginning of the pack. An entry is usually a complete archive, with
+//   its own endianness, tag and version, like a whole .ozz file. It can also
+//   be raw binary data, like a flat representation (see Animation::MapFlat)
+//   accessed directly from a mapped pack.
+// - The table of contents archive: name, offset and size of every entry.
+
+#include "ozz/base/containers/string.h"
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/endianness.h"
+#include "ozz/base/io/archive.h"
+#include "ozz/base/platform.h"
+
+namespace ozz {
+namespace io {
+
+namespace internal {
+// Pack entry description, stored in the table of contents. Offset is relative
+// to the beginning of the pack.
+struct PackEntry {
+  String::Std name;
+  uint64_t offset;
+  uint64_t size;
+};
+}  // namespace internal
+
+// Writes a pack to a stream. Entries are added one after the other, then the
+// table of contents is written by Finalize().
+class PackWriter {
+ public:
+  // Alignment of entries payloads, relatively to the beginning of the pack.
+  enum { kAlignment = 16 };
+
+  // Starts writing a pack at the current position of _stream, which must be
+  // valid and opened for writing. _endianness applies to the header, table of
+  // contents, and objects archived by Add().
+  explicit PackWriter(Stream* _stream,
+                      Endianness _endianness = GetNativeEndianness());
+
+  // Archives _object to a new entry named _name. Returns false if _name is
+  // empty or already used, or if writing failed.
+  template <typename _Ty>
+  bool Add(const char* _name, const _Ty& _object) {
+    if (!BeginEntry(_name)) {
+      return false;
+    }
+    OArchive archive(stream_, endianness_);
+    archive << _object;
+    return EndEntry();
+  }
+
+  // Copies _size bytes of _data to a new entry named _name, like an existing
+  // .ozz file content or a flat representation. Returns false if _name is
+  // empty or already used, or if writing failed.
+  bool AddBinary(const char* _name, const void* _data, size_t _size);
+
+  // Writes the table of contents and updates the header. The stream is left
+  // positioned at the end of the pack. No entry can be added afterward.
+  bool Finalize();
+
+  // Gets the number of entries added so far.
+  int num_entries() const { return static_cast<int>(entries_.size()); }
+
+ private:
+  PackWriter(const PackWriter&);
+  void operator=(const PackWriter&);
+
+  // Adds an entry and aligns stream position for its payload.
+  bool BeginEntry(const char* _name);
+
+  // Computes payload size of the last entry.
+  bool EndEntry();
+
+  // Writes header at the beginning of the pack.
+  bool WriteHeader(uint64_t _toc_offset);
+
+  Stream* stream_;
+  Endianness endianness_;
+
+  // Position of the beginning of the pack in stream_.
+  int64_t origin_;
+
+  // Entries added so far.
+  ozz::Vector<internal::PackEntry>::Std entries_;
+
+  // Tells if writing failed, or if Finalize() was called.
+  bool failed_;
+  bool finalized_;
+};
+
+// Reads a pack from a stream, which can be any stream type (File,
+// MappedFileStream, ExternalMemoryStream...). Objects are loaded by name or
+// index, one at a time or in batch, without reopening the stream.
+class PackReader {
+ public:
+  PackReader();
+
+  // Opens the pack starting at the current position of _stream, reading its
+  // table of contents. _stream must outlive the reader, or until Close() is
+  // called. Returns false if _stream isn't a valid pack.
+  bool Open(Stream* _stream);
+
+  // Releases table of contents. Doesn't close the stream.
+  void Close();
+
+  // Tells if a pack is opened.
+  bool opened() const { return stream_ != NULL; }
+
+  // Gets the number of entries.
+  int num_entries() const { return static_cast<int>(entries_.size()); }
+
+  // Gets name, offset (relative to the beginning of the pack) and size in
+  // bytes of entry _index payload.
+  const char* name(int _index) const;
+  uint64_t offset(int _index) const;
+  uint64_t size(int _index) const;
+
+  // Finds entry named _name, using a binary search. Returns -1 if not found.
+  int Find(const char* _name) const;
+
+  // Loads entry _index to _object. Returns false if _index is invalid, or if
+  // entry isn't an archive of type _Ty.
+  template <typename _Ty>
+  bool Load(int _index, _Ty* _object) {
+    if (!SeekEntry(_index)) {
+      return false;
+    }
+    IArchive archive(stream_);
+    if (!archive.TestTag<_Ty>()) {
+      return false;
+    }
+    archive >> *_object;
+    return true;
+  }
+
+  // Loads entry named _name to _object. See Load(int, _Ty*).
+  template <typename _Ty>
+  bool Load(const char* _name, _Ty* _object) {
+    return Load(Find(_name), _object);
+  }
+
+  // Loads entries _indices[i] to _objects[i], visiting entries in stream order
+  // so that reading remains sequential. _objects must be at least as big as
+  // _indices. Returns the number of objects successfully loaded.
+  template <typename _Ty>
+  int Load(const Range<const int>& _indices, const Range<_Ty>& _objects) {
+    if (_objects.count() < _indices.count()) {
+      return 0;
+    }
+    const int count = static_cast<int>(_indices.count());
+    ozz::Vector<int>::Std order(count);
+    SortByOffset(_indices, ozz::make_range(order));
+    int loaded = 0;
+    for (int i = 0; i < count; ++i) {
+      const int slot = order[i];
+      loaded += Load(_indices[slot], &_objects[slot]);
+    }
+    return loaded;
+  }
+
+ private:
+  PackReader(const PackReader&);
+  void operator=(const PackReader&);
+
+  // Seeks stream to entry _index payload.
+  bool SeekEntry(int _index);
+
+  // Fills _order with indices of _indices elements, sorted by entry offset.
+  void SortByOffset(const Range<const int>& _indices,
+                    const Range<int>& _order) const;
+
+  Stream* stream_;
+
+  // Position of the beginning of the pack in stream_.
+  int64_t origin_;
+
+  // Entries, in stream order.
+  ozz::Vector<internal::PackEntry>::Std entries_;
+
+  // Entries indices sorted by name, for binary search.
+  ozz::Vector<int>::Std sorted_;
+};
+}  // namespace io
+}  // namespace ozz
+#endif  // OZZ_OZZ_BASE_IO_PACK_H_
@@ -64,15 +64,16 @@ class Stream {
   };
   // Sets the position indicator associated with the stream to a new position
   // defined by adding _offset to a reference position specified by _origin.
+  // Offsets are 64 bits, so streams larger than 2GB can be randomly accessed.
   // Returns a zero value if successful, otherwise returns a non-zero value.
-  virtual int Seek(int _offset, Origin _origin) = 0;
+  virtual int Seek(int64_t _offset, Origin _origin) = 0;
 
   // Returns the current value of the position indicator of the stream.
   // Returns -1 if an error occurs.
-  virtual int Tell() const = 0;
+  virtual int64_t Tell() const = 0;
 
   // Returns the current size of the stream.
-  virtual size_t Size() const = 0;
+  virtual uint64_t Size() const = 0;
 
  protected:
   Stream() {}
@@ -118,13 +119,13 @@ class File : public Stream {
   virtual size_t Write(const void* _buffer, size_t _size);
 
   // See Stream::Seek for details.
-  virtual int Seek(int _offset, Origin _origin);
+  virtual int Seek(int64_t _offset, Origin _origin);
 
   // See Stream::Tell for details.
-  virtual int Tell() const;
+  virtual int64_t Tell() const;
 
   // See Stream::Tell for details.
-  virtual size_t Size() const;
+  virtual uint64_t Size() const;
 
  private:
   // The CRT file pointer.
@@ -151,13 +152,13 @@ class MemoryStream : public Stream {
   virtual size_t Write(const void* _buffer, size_t _size);
 
   // See Stream::Seek for details.
-  virtual int Seek(int _offset, Origin _origin);
+  virtual int Seek(int64_t _offset, Origin _origin);
 
   // See Stream::Tell for details.
-  virtual int Tell() const;
+  virtual int64_t Tell() const;
 
   // See Stream::Tell for details.
-  virtual size_t Size() const;
+  virtual uint64_t Size() const;
 
  private:
   // Resizes buffers size to _size bytes. If _size is less than the actual
@@ -179,10 +180,58 @@ class MemoryStream : public Stream {
   size_t alloc_size_;
 
   // The effective size of the data in the buffer.
-  int end_;
+  size_t end_;
 
   // The cursor position in the buffer of data.
-  int tell_;
+  size_t tell_;
+};
+
+// Implements a read-only Stream over an external memory buffer, like a buffer
+// already loaded by an asynchronous io system. The buffer is neither copied
+// nor owned, it must outlive the stream. The opening mode is equivalent to
+// fopen rb, so writing always fails.
+class ExternalMemoryStream : public Stream {
+ public:
+  // Constructs a stream reading _size bytes from _buffer. The stream isn't
+  // opened if _buffer is NULL or _size exceeds the maximum stream size.
+  ExternalMemoryStream(const void* _buffer, size_t _size);
+
+  // Doesn't deallocate the external buffer.
+  virtual ~ExternalMemoryStream();
+
+  // Gets the external buffer.
+  const void* data() const { return buffer_; }
+
+  // See Stream::opened for details.
+  virtual bool opened() const;
+
+  // See Stream::Read for details.
+  virtual size_t Read(void* _buffer, size_t _size);
+
+  // Writing to a read-only stream always fails, returning 0.
+  virtual size_t Write(const void* _buffer, size_t _size);
+
+  // See Stream::Seek for details.
+  virtual int Seek(int64_t _offset, Origin _origin);
+
+  // See Stream::Tell for details.
+  virtual int64_t Tell() const;
+
+  // See Stream::Tell for details.
+  virtual uint64_t Size() const;
+
+ private:
+  // Maximum stream size.
+  static const size_t kMaxSize;
+
+  // External buffer of data.
+  const char* buffer_;
+
+  // The size of the data in the buffer.
+  size_t end_;
+
+  // The cursor position in the buffer of data.
+  size_t tell_;
 };
 }  // namespace io
 }  // namespace ozz
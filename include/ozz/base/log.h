@@ -39,6 +39,20 @@
 // kStandard, kVerbose) to the std API, which can be set using
 // ozz::log::GetLevel function.
 // Usage conforms to std stream usage: ozz::log::OUT() << "something to log."...
+// Every logger formats to its own buffer, which is written to the output
+// stream at once when the logger is destroyed or flushed (std::endl...), so
+// concurrent logs don't contend on output streams, nor interleave. Disabled
+// loggers don't format at all.
+// OZZ_LOG* macros additionally skip evaluating logged expressions when level is
+// disabled, and are compiled out when level is above OZZ_LOG_MAX_LEVEL (see
+// ozz_build_log_level cmake option). They should be preferred in loops.
+
+// Maximum logging level compiled in: logs of higher levels are compiled out by
+// OZZ_LOG* macros, and discarded by loggers whatever the global logging level.
+// Values are 0 (kSilent), 1 (kStandard) or 2 (kVerbose, default).
+#ifndef OZZ_LOG_MAX_LEVEL
+#define OZZ_LOG_MAX_LEVEL 2
+#endif  // OZZ_LOG_MAX_LEVEL
 
 namespace ozz {
 namespace log {
@@ -55,13 +69,45 @@ Level SetLevel(Level _level);
 // Gets the global logging level.
 Level GetLevel();
 
+// Tells if logs of _level are enabled, according to the global logging level
+// and OZZ_LOG_MAX_LEVEL.
+inline bool IsEnabled(Level _level) {
+  return _level <= OZZ_LOG_MAX_LEVEL && _level <= GetLevel();
+}
+
 namespace internal {
 
+// Implements a fixed size stream buffer, which writes its content to a target
+// stream buffer when it's full or synchronized. A NULL target discards
+// everything, which sets the formatting stream in a failed state so that it
+// doesn't format anymore.
+class LogBuffer : public std::streambuf {
+ public:
+  explicit LogBuffer(std::streambuf* _target);
+  virtual ~LogBuffer();
+
+ protected:
+  virtual int_type overflow(int_type _c);
+  virtual int sync();
+
+ private:
+  // Disables copy and assignment.
+  LogBuffer(const LogBuffer&);
+  void operator=(const LogBuffer&);
+
+  // Writes buffer content to the target.
+  bool Flush();
+
+  std::streambuf* target_;
+  char buffer_[256];
+};
+
 // Implements logging base class.
 // This class is not intended to be used publicly, it is derived by user
 // classes LogV, Log, Out, Err...
-// Forwards ostream::operator << to a standard ostream or a silent
-// ostringstream according to the logging level at construction time.
+// Forwards ostream::operator << to a stream writing to a standard ostream
+// buffer, or to a silent stream according to the logging level at
+// construction time.
 class Logger {
  public:
   // Forwards ostream::operator << for any type.
@@ -85,7 +131,7 @@ class Logger {
   // the current global logging level.
   Logger(std::ostream& _stream, Level _level);
 
-  // Destructor, deletes the internal "silent" stream.
+  // Destructor, writes remaining logs to the standard ostream.
   ~Logger();
 
  private:
@@ -93,12 +139,11 @@ class Logger {
   Logger(const Logger&);
   void operator=(Logger&);
 
-  // Selected output stream.
-  std::ostream& stream_;
+  // Buffers logs, before writing them to the selected output stream.
+  LogBuffer buffer_;
 
-  // Stores whether the stream is local one, in which case it must be deleted
-  // in the destructor.
-  bool local_stream_;
+  // Formatting stream, writing to buffer_.
+  std::ostream stream_;
 };
 }  // namespace internal
 
@@ -131,4 +176,19 @@ class Err : public internal::Logger {
 };
 }  // namespace log
 }  // namespace ozz
+
+// Declares a logger of class _Logger (LogV, Log, Out or Err), enabled at
+// _level, to be used as a stream: OZZ_LOG_TO(ozz::log::Out, ...) << "log".
+// Logged expressions aren't evaluated if _level is disabled, and are compiled
+// out if _level is higher than OZZ_LOG_MAX_LEVEL.
+#define OZZ_LOG_TO(_Logger, _level) \
+  if (!ozz::log::IsEnabled(_level)) { \
+  } else                              \
+    _Logger().stream()
+
+// Declares LogV, Log, Out and Err loggers, see OZZ_LOG_TO.
+#define OZZ_LOGV OZZ_LOG_TO(ozz::log::LogV, ozz::log::kVerbose)
+#define OZZ_LOG OZZ_LOG_TO(ozz::log::Log, ozz::log::kStandard)
+#define OZZ_LOG_OUT OZZ_LOG_TO(ozz::log::Out, ozz::log::kStandard)
+#define OZZ_LOG_ERR OZZ_LOG_TO(ozz::log::Err, ozz::log::kStandard)
 #endif  // OZZ_OZZ_BASE_LOG_H_
@@ -0,0 +1,75 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_BASE_MATHS_BOX_UTILS_H_
+#define OZZ_OZZ_BASE_MATHS_BOX_UTILS_H_
+
+#include "ozz/base/maths/box.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/platform.h"
+
+// Implements batched bounding box computation and frustum culling, meant to
+// process many characters per frame.
+namespace ozz {
+namespace math {
+
+// Computes the smallest box that contains the translation part (last column)
+// of all _matrices. Returns an invalid box if _matrices is empty.
+Box ComputeBounds(const Range<const Float4x4>& _matrices);
+
+// Computes the bounds of _boxes.count() poses, stored consecutively in
+// _matrices, each pose being made of _pose_size matrices. _boxes[i] receives
+// the bounds of matrices [i * _pose_size, (i + 1) * _pose_size[.
+// Returns false if _matrices is smaller than _pose_size * _boxes.count(), in
+// which case _boxes is left unchanged.
+bool ComputeBounds(const Range<const Float4x4>& _matrices, size_t _pose_size,
+                   const Range<Box>& _boxes);
+
+// Defines a view frustum with 6 planes, which normals point inward. Each
+// plane is stored as a SimdFloat4 {nx, ny, nz, d}, a point p being on the
+// inner side of the plane if dot(n, p) + d >= 0. Planes aren't required to be
+// normalized.
+struct Frustum {
+  // Extracts frustum planes from a view-projection matrix, using OpenGL clip
+  // space convention (-w <= z <= w).
+  static Frustum FromMatrix(const Float4x4& _view_proj);
+
+  enum Planes { kLeft, kRight, kBottom, kTop, kNear, kFar, kNumPlanes };
+  SimdFloat4 planes[kNumPlanes];
+};
+
+// Tests _boxes against _frustum, 4 boxes at a time. _visible[i] is set to
+// true if _boxes[i] intersects or is inside _frustum. The test is
+// conservative, some boxes outside of the frustum (close to its corners) can
+// be reported visible. _boxes must be valid.
+// Returns false if _visible is smaller than _boxes, in which case _visible is
+// left unchanged.
+bool TestFrustum(const Frustum& _frustum, const Range<const Box>& _boxes,
+                 const Range<bool>& _visible);
+}  // namespace math
+}  // namespace ozz
+#endif  // OZZ_OZZ_BASE_MATHS_BOX_UTILS_H_
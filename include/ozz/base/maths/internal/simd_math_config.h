@@ -30,11 +30,47 @@
 
 #include "ozz/base/platform.h"
 
+// Deterministic mode guarantees bit-identical results across platforms and SIMD
+// implementations (including the reference one), for lockstep simulations for
+// example. Hardware estimations (reciprocal, reciprocal square root) are
+// replaced by IEEE correctly rounded division and square root, multiply-adds
+// aren't fused and horizontal operations sum components in the same order.
+// AVX and FMA kernels are disabled, as they don't share these properties. The
+// compiler must also be prevented from contracting floating point operations,
+// see ozz_build_simd_deterministic cmake option. Denormals are flushed to zero
+// by ARMv7 NEON, which isn't bit-identical with other implementations for
+// denormal numbers.
+#if defined(OZZ_BUILD_SIMD_DETERMINISTIC)
+#define OZZ_SIMD_DETERMINISTIC
+#endif  // OZZ_BUILD_SIMD_DETERMINISTIC
+
 // Avoid SIMD instruction detection if reference (aka scalar) implementation is
 // forced.
 #if !defined(OZZ_BUILD_SIMD_REF)
 
+// Try to match an ARM NEON version. AArch64 (OZZ_SIMD_NEON_A64) adds vector
+// division, square root and fused multiply-add instructions.
+#if defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM) || \
+    defined(_M_ARM64) || defined(OZZ_SIMD_NEON)
+#include <arm_neon.h>
+#define OZZ_SIMD_NEON
+#if defined(__aarch64__) || defined(_M_ARM64) || defined(OZZ_SIMD_NEON_A64)
+#define OZZ_SIMD_NEON_A64
+#endif
+#endif
+
+// Try to match WebAssembly SIMD128, aka emscripten -msimd128 option.
+#if defined(__wasm_simd128__) || defined(OZZ_SIMD_WASM)
+#include <wasm_simd128.h>
+#define OZZ_SIMD_WASM
+#endif
+
+// NEON, WASM and SSE are exclusive.
+#if !defined(OZZ_SIMD_NEON) && !defined(OZZ_SIMD_WASM)
+
 // Try to match a SSE2+ version.
+// AVX and FMA aren't used in deterministic mode.
+#if !defined(OZZ_SIMD_DETERMINISTIC)
 #if defined(__AVX2__) || defined(OZZ_SIMD_AVX2)
 #include <immintrin.h>
 #define OZZ_SIMD_AVX2
@@ -45,8 +81,15 @@
 #include <immintrin.h>
 #define OZZ_SIMD_FMA
 #endif
+#endif  // !OZZ_SIMD_DETERMINISTIC
 
-#if defined(__AVX__) || defined(OZZ_SIMD_AVX)
+#if defined(__F16C__) || defined(OZZ_SIMD_F16C)
+#include <immintrin.h>
+#define OZZ_SIMD_F16C
+#endif
+
+#if (defined(__AVX__) || defined(OZZ_SIMD_AVX)) && \
+    !defined(OZZ_SIMD_DETERMINISTIC)
 #include <immintrin.h>
 #define OZZ_SIMD_AVX
 #define OZZ_SIMD_SSE4_2  // SSE4.2 is available if avx is.
@@ -84,10 +127,29 @@
 #define OZZ_SIMD_SSE2
 #define OZZ_SIMD_SSEx  // OZZ_SIMD_SSEx is the generic flag for SSE support
 #endif
+#endif  // !OZZ_SIMD_NEON && !OZZ_SIMD_WASM
+
+// Runtime dispatch of AVX2 and FMA kernels. When the build doesn't natively
+// target AVX, hot kernels can still be compiled for AVX2 and FMA using
+// OZZ_SIMD_AVX2_TARGET attribute, and selected at runtime if the cpu supports
+// them, see math::CpuSupportsAvx2Fma().
+#if defined(OZZ_SIMD_SSEx) && !defined(OZZ_SIMD_AVX) && \
+    (defined(__GNUC__) || defined(__clang__)) &&        \
+    (defined(__x86_64__) || defined(__i386__)) &&       \
+    !defined(OZZ_BUILD_SIMD_NO_DISPATCH) && !defined(OZZ_SIMD_DETERMINISTIC)
+#include <immintrin.h>
+#define OZZ_SIMD_AVX2_DISPATCH
+#endif
 
 // End of SIMD instruction detection
 #endif  // !OZZ_BUILD_SIMD_REF
 
+#if defined(OZZ_SIMD_AVX2_DISPATCH)
+#define OZZ_SIMD_AVX2_TARGET __attribute__((target("avx2,fma")))
+#else  // OZZ_SIMD_AVX2_DISPATCH
+#define OZZ_SIMD_AVX2_TARGET
+#endif  // OZZ_SIMD_AVX2_DISPATCH
+
 // SEE* intrinsics available
 #if defined(OZZ_SIMD_SSEx)
 
@@ -108,6 +170,48 @@ typedef const __m128i _SimdInt4;
 }  // namespace math
 }  // namespace ozz
 
+// NEON intrinsics available
+#elif defined(OZZ_SIMD_NEON)
+
+namespace ozz {
+namespace math {
+
+// Vector of four floating point values.
+typedef float32x4_t SimdFloat4;
+
+// Argument type for Float4.
+typedef const float32x4_t _SimdFloat4;
+
+// Vector of four integer values.
+typedef int32x4_t SimdInt4;
+
+// Argument type for Int4.
+typedef const int32x4_t _SimdInt4;
+}  // namespace math
+}  // namespace ozz
+
+// WebAssembly SIMD128 intrinsics available
+#elif defined(OZZ_SIMD_WASM)
+
+namespace ozz {
+namespace math {
+
+// Vector of four floating point values.
+// wasm_simd128.h exposes a single v128_t type, so a float vector type is
+// declared in order to overload SimdFloat4 and SimdInt4 functions.
+typedef float SimdFloat4 __attribute__((__vector_size__(16), __aligned__(16)));
+
+// Argument type for Float4.
+typedef const SimdFloat4 _SimdFloat4;
+
+// Vector of four integer values.
+typedef v128_t SimdInt4;
+
+// Argument type for Int4.
+typedef const v128_t _SimdInt4;
+}  // namespace math
+}  // namespace ozz
+
 #else  // No builtin simd available
 
 // No simd instruction set detected, switch back to reference implementation.
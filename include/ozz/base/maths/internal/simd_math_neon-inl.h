@@ -0,0 +1,1967 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#ifndef OZZ_OZZ_BASE_MATHS_INTERNAL_SIMD_MATH_NEON_INL_H_
+#define OZZ_OZZ_BASE_MATHS_INTERNAL_SIMD_MATH_NEON_INL_H_
+
+// SIMD ARM NEON implementation, mirroring SSE2+ implementation.
+// AArch64 specific instructions (vector division, square root, fused
+// multiply-add, rounding conversion) are used when OZZ_SIMD_NEON_A64 is
+// defined. ARMv7 falls back to Newton-Raphson refined estimates.
+
+#include <stdint.h>
+#include <cassert>
+
+// Temporarly needed while trigonometric functions aren't implemented.
+#include <cmath>
+
+#include "ozz/base/maths/math_constant.h"
+
+namespace ozz {
+namespace math {
+
+#if defined(OZZ_SIMD_DETERMINISTIC) && !defined(OZZ_SIMD_NEON_A64)
+namespace internal {
+// ARMv7 NEON has no division nor square root instructions. Deterministic mode
+// computes them with IEEE correctly rounded scalar (VFP) instructions.
+OZZ_INLINE float32x4_t DivVfp(float32x4_t _a, float32x4_t _b) {
+  float a[4], b[4];
+  vst1q_f32(a, _a);
+  vst1q_f32(b, _b);
+  for (int i = 0; i < 4; ++i) {
+    a[i] /= b[i];
+  }
+  return vld1q_f32(a);
+}
+
+OZZ_INLINE float32x4_t SqrtVfp(float32x4_t _v) {
+  float v[4];
+  vst1q_f32(v, _v);
+  for (int i = 0; i < 4; ++i) {
+    v[i] = std::sqrt(v[i]);
+  }
+  return vld1q_f32(v);
+}
+}  // namespace internal
+#endif  // OZZ_SIMD_DETERMINISTIC && !OZZ_SIMD_NEON_A64
+
+namespace simd_float4 {
+
+// Internal macros.
+// Unused components of the result vector are replicated from the first input
+// argument.
+
+#ifdef OZZ_SIMD_NEON_A64
+#define OZZ_NEON_SPLAT_F(_v, _i) vdupq_laneq_f32(_v, _i)
+#define OZZ_NEON_SPLAT_I(_v, _i) vdupq_laneq_s32(_v, _i)
+#else  // OZZ_SIMD_NEON_A64
+#define OZZ_NEON_SPLAT_F(_v, _i) vdupq_n_f32(vgetq_lane_f32(_v, _i))
+#define OZZ_NEON_SPLAT_I(_v, _i) vdupq_n_s32(vgetq_lane_s32(_v, _i))
+#endif  // OZZ_SIMD_NEON_A64
+
+// Builds _a[_x], _a[_y], _b[_z], _b[_w], aka _mm_shuffle_ps equivalent.
+#define OZZ_NEON_SHUFFLE_F(_a, _b, _x, _y, _z, _w)                          \
+  vsetq_lane_f32(                                                           \
+      vgetq_lane_f32(_b, _w),                                               \
+      vsetq_lane_f32(vgetq_lane_f32(_b, _z),                                \
+                     vsetq_lane_f32(vgetq_lane_f32(_a, _y),                 \
+                                    vdupq_n_f32(vgetq_lane_f32(_a, _x)), 1), \
+                     2),                                                    \
+      3)
+
+// _v.x + _v.y, ?
+#define OZZ_NEON_HADD2_F(_v) vpadd_f32(vget_low_f32(_v), vget_low_f32(_v))
+
+// _v.x + _v.y + _v.z, ?
+#define OZZ_NEON_HADD3_F(_v) vadd_f32(OZZ_NEON_HADD2_F(_v), vget_high_f32(_v))
+
+// _v.x + _v.y + _v.z + _v.w, ?
+#define OZZ_NEON_HADD4_F(_v, _r)                                         \
+  do {                                                                   \
+    const float32x2_t haddxyzw =                                         \
+        vadd_f32(vget_low_f32(_v), vget_high_f32(_v));                   \
+    _r = vpadd_f32(haddxyzw, haddxyzw);                                  \
+  } while (void(0), 0)
+
+// dot2, ?
+#define OZZ_NEON_DOT2_F(_a, _b, _r)           \
+  do {                                        \
+    const float32x4_t ab = vmulq_f32(_a, _b); \
+    _r = OZZ_NEON_HADD2_F(ab);                \
+  } while (void(0), 0)
+
+// dot3, ?
+#define OZZ_NEON_DOT3_F(_a, _b, _r)           \
+  do {                                        \
+    const float32x4_t ab = vmulq_f32(_a, _b); \
+    _r = OZZ_NEON_HADD3_F(ab);                \
+  } while (void(0), 0)
+
+// dot4, ?
+#define OZZ_NEON_DOT4_F(_a, _b, _r)           \
+  do {                                        \
+    const float32x4_t ab = vmulq_f32(_a, _b); \
+    OZZ_NEON_HADD4_F(ab, _r);                 \
+  } while (void(0), 0)
+
+// Multiply-add operations, fused on AArch64. Deterministic mode never fuses
+// them, as other implementations don't.
+#if defined(OZZ_SIMD_DETERMINISTIC)
+#define OZZ_MADD(_a, _b, _c) vaddq_f32(vmulq_f32(_a, _b), _c)
+#define OZZ_NMADD(_a, _b, _c) vsubq_f32(_c, vmulq_f32(_a, _b))
+#define OZZ_MSUB(_a, _b, _c) vsubq_f32(vmulq_f32(_a, _b), _c)
+#define OZZ_NMSUB(_a, _b, _c) vsubq_f32(vnegq_f32(vmulq_f32(_a, _b)), _c)
+#else  // OZZ_SIMD_DETERMINISTIC
+#ifdef OZZ_SIMD_NEON_A64
+#define OZZ_MADD(_a, _b, _c) vfmaq_f32(_c, _a, _b)
+#define OZZ_NMADD(_a, _b, _c) vfmsq_f32(_c, _a, _b)
+#else  // OZZ_SIMD_NEON_A64
+#define OZZ_MADD(_a, _b, _c) vmlaq_f32(_c, _a, _b)
+#define OZZ_NMADD(_a, _b, _c) vmlsq_f32(_c, _a, _b)
+#endif  // OZZ_SIMD_NEON_A64
+#define OZZ_MSUB(_a, _b, _c) vnegq_f32(OZZ_NMADD(_a, _b, _c))
+#define OZZ_NMSUB(_a, _b, _c) vnegq_f32(OZZ_MADD(_a, _b, _c))
+#endif  // OZZ_SIMD_DETERMINISTIC
+
+// Division, a Newton-Raphson refined reciprocal on ARMv7. Deterministic mode
+// requires IEEE correctly rounded division, which ARMv7 only provides with
+// scalar (VFP) instructions.
+#ifdef OZZ_SIMD_NEON_A64
+#define OZZ_NEON_DIV(_a, _b) vdivq_f32(_a, _b)
+#elif defined(OZZ_SIMD_DETERMINISTIC)
+#define OZZ_NEON_DIV(_a, _b) ozz::math::internal::DivVfp(_a, _b)
+#else  // OZZ_SIMD_NEON_A64
+#define OZZ_NEON_DIV(_a, _b) vmulq_f32(_a, RcpEstNR(_b))
+#endif  // OZZ_SIMD_NEON_A64
+
+#define OZZ_NEON_SELECT_F(_b, _true, _false) \
+  vbslq_f32(vreinterpretq_u32_s32(_b), _true, _false)
+
+#define OZZ_NEON_SELECT_I(_b, _true, _false) \
+  vbslq_s32(vreinterpretq_u32_s32(_b), _true, _false)
+
+#define OZZ_NEON_CAST_I(_v) vreinterpretq_s32_u32(_v)
+
+OZZ_INLINE SimdFloat4 DivX(_SimdFloat4 _a, _SimdFloat4 _b) {
+  return vsetq_lane_f32(vgetq_lane_f32(_a, 0) / vgetq_lane_f32(_b, 0), _a, 0);
+}
+
+OZZ_INLINE SimdFloat4 zero() { return vdupq_n_f32(0.f); }
+
+OZZ_INLINE SimdFloat4 one() { return vdupq_n_f32(1.f); }
+
+OZZ_INLINE SimdFloat4 x_axis() {
+  return vsetq_lane_f32(1.f, vdupq_n_f32(0.f), 0);
+}
+
+OZZ_INLINE SimdFloat4 y_axis() {
+  return vsetq_lane_f32(1.f, vdupq_n_f32(0.f), 1);
+}
+
+OZZ_INLINE SimdFloat4 z_axis() {
+  return vsetq_lane_f32(1.f, vdupq_n_f32(0.f), 2);
+}
+
+OZZ_INLINE SimdFloat4 w_axis() {
+  return vsetq_lane_f32(1.f, vdupq_n_f32(0.f), 3);
+}
+
+OZZ_INLINE SimdFloat4 Load(float _x, float _y, float _z, float _w) {
+  OZZ_ALIGN(16) const float f[4] = {_x, _y, _z, _w};
+  return vld1q_f32(f);
+}
+
+OZZ_INLINE SimdFloat4 LoadX(float _x) {
+  return vsetq_lane_f32(_x, vdupq_n_f32(0.f), 0);
+}
+
+OZZ_INLINE SimdFloat4 Load1(float _x) { return vdupq_n_f32(_x); }
+
+OZZ_INLINE SimdFloat4 LoadPtr(const float* _f) {
+  assert(!(reinterpret_cast<uintptr_t>(_f) & 0xf) && "Invalid alignment");
+  return vld1q_f32(_f);
+}
+
+OZZ_INLINE SimdFloat4 LoadPtrU(const float* _f) {
+  assert(!(reinterpret_cast<uintptr_t>(_f) & 0x3) && "Invalid alignment");
+  return vld1q_f32(_f);
+}
+
+OZZ_INLINE SimdFloat4 LoadXPtrU(const float* _f) {
+  assert(!(reinterpret_cast<uintptr_t>(_f) & 0x3) && "Invalid alignment");
+  return vld1q_lane_f32(_f, vdupq_n_f32(0.f), 0);
+}
+
+OZZ_INLINE SimdFloat4 Load1PtrU(const float* _f) {
+  assert(!(reinterpret_cast<uintptr_t>(_f) & 0x3) && "Invalid alignment");
+  return vld1q_dup_f32(_f);
+}
+
+OZZ_INLINE SimdFloat4 Load2PtrU(const float* _f) {
+  assert(!(reinterpret_cast<uintptr_t>(_f) & 0x3) && "Invalid alignment");
+  return vcombine_f32(vld1_f32(_f), vdup_n_f32(0.f));
+}
+
+OZZ_INLINE SimdFloat4 Load3PtrU(const float* _f) {
+  assert(!(reinterpret_cast<uintptr_t>(_f) & 0x3) && "Invalid alignment");
+  return vcombine_f32(vld1_f32(_f), vld1_lane_f32(_f + 2, vdup_n_f32(0.f), 0));
+}
+
+OZZ_INLINE SimdFloat4 FromInt(_SimdInt4 _i) { return vcvtq_f32_s32(_i); }
+}  // namespace simd_float4
+
+OZZ_INLINE float GetX(_SimdFloat4 _v) { return vgetq_lane_f32(_v, 0); }
+
+OZZ_INLINE float GetY(_SimdFloat4 _v) { return vgetq_lane_f32(_v, 1); }
+
+OZZ_INLINE float GetZ(_SimdFloat4 _v) { return vgetq_lane_f32(_v, 2); }
+
+OZZ_INLINE float GetW(_SimdFloat4 _v) { return vgetq_lane_f32(_v, 3); }
+
+OZZ_INLINE SimdFloat4 SetX(_SimdFloat4 _v, _SimdFloat4 _f) {
+  return vsetq_lane_f32(vgetq_lane_f32(_f, 0), _v, 0);
+}
+
+OZZ_INLINE SimdFloat4 SetY(_SimdFloat4 _v, _SimdFloat4 _f) {
+  return vsetq_lane_f32(vgetq_lane_f32(_f, 0), _v, 1);
+}
+
+OZZ_INLINE SimdFloat4 SetZ(_SimdFloat4 _v, _SimdFloat4 _f) {
+  return vsetq_lane_f32(vgetq_lane_f32(_f, 0), _v, 2);
+}
+
+OZZ_INLINE SimdFloat4 SetW(_SimdFloat4 _v, _SimdFloat4 _f) {
+  return vsetq_lane_f32(vgetq_lane_f32(_f, 0), _v, 3);
+}
+
+OZZ_INLINE SimdFloat4 SetI(_SimdFloat4 _v, _SimdFloat4 _f, int _ith) {
+  assert(_ith >= 0 && _ith <= 3 && "Invalid index, out of range.");
+  OZZ_ALIGN(16) float af[4];
+  vst1q_f32(af, _v);
+  af[_ith] = vgetq_lane_f32(_f, 0);
+  return vld1q_f32(af);
+}
+
+OZZ_INLINE void StorePtr(_SimdFloat4 _v, float* _f) {
+  assert(!(reinterpret_cast<uintptr_t>(_f) & 0xf) && "Invalid alignment");
+  vst1q_f32(_f, _v);
+}
+
+OZZ_INLINE void Store1Ptr(_SimdFloat4 _v, float* _f) {
+  assert(!(reinterpret_cast<uintptr_t>(_f) & 0xf) && "Invalid alignment");
+  vst1q_lane_f32(_f, _v, 0);
+}
+
+OZZ_INLINE void Store2Ptr(_SimdFloat4 _v, float* _f) {
+  assert(!(reinterpret_cast<uintptr_t>(_f) & 0xf) && "Invalid alignment");
+  vst1_f32(_f, vget_low_f32(_v));
+}
+
+OZZ_INLINE void Store3Ptr(_SimdFloat4 _v, float* _f) {
+  assert(!(reinterpret_cast<uintptr_t>(_f) & 0xf) && "Invalid alignment");
+  vst1_f32(_f, vget_low_f32(_v));
+  vst1q_lane_f32(_f + 2, _v, 2);
+}
+
+OZZ_INLINE void StorePtrU(_SimdFloat4 _v, float* _f) {
+  assert(!(reinterpret_cast<uintptr_t>(_f) & 0x3) && "Invalid alignment");
+  vst1q_f32(_f, _v);
+}
+
+OZZ_INLINE void Store1PtrU(_SimdFloat4 _v, float* _f) {
+  assert(!(reinterpret_cast<uintptr_t>(_f) & 0x3) && "Invalid alignment");
+  vst1q_lane_f32(_f, _v, 0);
+}
+
+OZZ_INLINE void Store2PtrU(_SimdFloat4 _v, float* _f) {
+  assert(!(reinterpret_cast<uintptr_t>(_f) & 0x3) && "Invalid alignment");
+  vst1_f32(_f, vget_low_f32(_v));
+}
+
+OZZ_INLINE void Store3PtrU(_SimdFloat4 _v, float* _f) {
+  assert(!(reinterpret_cast<uintptr_t>(_f) & 0x3) && "Invalid alignment");
+  vst1_f32(_f, vget_low_f32(_v));
+  vst1q_lane_f32(_f + 2, _v, 2);
+}
+
+OZZ_INLINE SimdFloat4 SplatX(_SimdFloat4 _v) { return OZZ_NEON_SPLAT_F(_v, 0); }
+
+OZZ_INLINE SimdFloat4 SplatY(_SimdFloat4 _v) { return OZZ_NEON_SPLAT_F(_v, 1); }
+
+OZZ_INLINE SimdFloat4 SplatZ(_SimdFloat4 _v) { return OZZ_NEON_SPLAT_F(_v, 2); }
+
+OZZ_INLINE SimdFloat4 SplatW(_SimdFloat4 _v) { return OZZ_NEON_SPLAT_F(_v, 3); }
+
+template <size_t _X, size_t _Y, size_t _Z, size_t _W>
+OZZ_INLINE SimdFloat4 Swizzle(_SimdFloat4 _v) {
+  OZZ_STATIC_ASSERT(_X <= 3 && _Y <= 3 && _Z <= 3 && _W <= 3);
+  return OZZ_NEON_SHUFFLE_F(_v, _v, _X, _Y, _Z, _W);
+}
+
+template <>
+OZZ_INLINE SimdFloat4 Swizzle<0, 1, 2, 3>(_SimdFloat4 _v) {
+  return _v;
+}
+
+template <>
+OZZ_INLINE SimdFloat4 Swizzle<0, 1, 0, 1>(_SimdFloat4 _v) {
+  return vcombine_f32(vget_low_f32(_v), vget_low_f32(_v));
+}
+
+template <>
+OZZ_INLINE SimdFloat4 Swizzle<2, 3, 2, 3>(_SimdFloat4 _v) {
+  return vcombine_f32(vget_high_f32(_v), vget_high_f32(_v));
+}
+
+template <>
+OZZ_INLINE SimdFloat4 Swizzle<2, 3, 0, 1>(_SimdFloat4 _v) {
+  return vextq_f32(_v, _v, 2);
+}
+
+template <>
+OZZ_INLINE SimdFloat4 Swizzle<1, 0, 3, 2>(_SimdFloat4 _v) {
+  return vrev64q_f32(_v);
+}
+
+template <>
+OZZ_INLINE SimdFloat4 Swizzle<0, 0, 1, 1>(_SimdFloat4 _v) {
+  return vzipq_f32(_v, _v).val[0];
+}
+
+template <>
+OZZ_INLINE SimdFloat4 Swizzle<2, 2, 3, 3>(_SimdFloat4 _v) {
+  return vzipq_f32(_v, _v).val[1];
+}
+
+OZZ_INLINE void Transpose4x1(const SimdFloat4 _in[4], SimdFloat4 _out[1]) {
+  const float32x4_t xz = vzipq_f32(_in[0], _in[2]).val[0];
+  const float32x4_t yw = vzipq_f32(_in[1], _in[3]).val[0];
+  _out[0] = vzipq_f32(xz, yw).val[0];
+}
+
+OZZ_INLINE void Transpose1x4(const SimdFloat4 _in[1], SimdFloat4 _out[4]) {
+  const float32x4_t zero = vdupq_n_f32(0.f);
+  _out[0] = vsetq_lane_f32(vgetq_lane_f32(_in[0], 0), zero, 0);
+  _out[1] = vsetq_lane_f32(vgetq_lane_f32(_in[0], 1), zero, 0);
+  _out[2] = vsetq_lane_f32(vgetq_lane_f32(_in[0], 2), zero, 0);
+  _out[3] = vsetq_lane_f32(vgetq_lane_f32(_in[0], 3), zero, 0);
+}
+
+OZZ_INLINE void Transpose4x2(const SimdFloat4 _in[4], SimdFloat4 _out[2]) {
+  const float32x4_t tmp0 = vzipq_f32(_in[0], _in[2]).val[0];
+  const float32x4_t tmp1 = vzipq_f32(_in[1], _in[3]).val[0];
+  const float32x4x2_t out = vzipq_f32(tmp0, tmp1);
+  _out[0] = out.val[0];
+  _out[1] = out.val[1];
+}
+
+OZZ_INLINE void Transpose2x4(const SimdFloat4 _in[2], SimdFloat4 _out[4]) {
+  const float32x4x2_t tmp = vzipq_f32(_in[0], _in[1]);
+  const float32x2_t zero = vdup_n_f32(0.f);
+  _out[0] = vcombine_f32(vget_low_f32(tmp.val[0]), zero);
+  _out[1] = vcombine_f32(vget_high_f32(tmp.val[0]), zero);
+  _out[2] = vcombine_f32(vget_low_f32(tmp.val[1]), zero);
+  _out[3] = vcombine_f32(vget_high_f32(tmp.val[1]), zero);
+}
+
+OZZ_INLINE void Transpose4x3(const SimdFloat4 _in[4], SimdFloat4 _out[3]) {
+  const float32x4x2_t tmp02 = vzipq_f32(_in[0], _in[2]);
+  const float32x4x2_t tmp13 = vzipq_f32(_in[1], _in[3]);
+  const float32x4x2_t out01 = vzipq_f32(tmp02.val[0], tmp13.val[0]);
+  _out[0] = out01.val[0];
+  _out[1] = out01.val[1];
+  _out[2] = vzipq_f32(tmp02.val[1], tmp13.val[1]).val[0];
+}
+
+OZZ_INLINE void Transpose3x4(const SimdFloat4 _in[3], SimdFloat4 _out[4]) {
+  const float32x4x2_t tmp02 = vzipq_f32(_in[0], _in[2]);
+  const float32x4x2_t tmp13 = vzipq_f32(_in[1], vdupq_n_f32(0.f));
+  const float32x4x2_t out01 = vzipq_f32(tmp02.val[0], tmp13.val[0]);
+  const float32x4x2_t out23 = vzipq_f32(tmp02.val[1], tmp13.val[1]);
+  _out[0] = out01.val[0];
+  _out[1] = out01.val[1];
+  _out[2] = out23.val[0];
+  _out[3] = out23.val[1];
+}
+
+OZZ_INLINE void Transpose4x4(const SimdFloat4 _in[4], SimdFloat4 _out[4]) {
+  const float32x4x2_t tmp02 = vzipq_f32(_in[0], _in[2]);
+  const float32x4x2_t tmp13 = vzipq_f32(_in[1], _in[3]);
+  const float32x4x2_t out01 = vzipq_f32(tmp02.val[0], tmp13.val[0]);
+  const float32x4x2_t out23 = vzipq_f32(tmp02.val[1], tmp13.val[1]);
+  _out[0] = out01.val[0];
+  _out[1] = out01.val[1];
+  _out[2] = out23.val[0];
+  _out[3] = out23.val[1];
+}
+
+OZZ_INLINE void Transpose16x16(const SimdFloat4 _in[16], SimdFloat4 _out[16]) {
+  for (int i = 0; i < 4; ++i) {
+    const float32x4x2_t tmp02 = vzipq_f32(_in[i * 4 + 0], _in[i * 4 + 2]);
+    const float32x4x2_t tmp13 = vzipq_f32(_in[i * 4 + 1], _in[i * 4 + 3]);
+    const float32x4x2_t out01 = vzipq_f32(tmp02.val[0], tmp13.val[0]);
+    const float32x4x2_t out23 = vzipq_f32(tmp02.val[1], tmp13.val[1]);
+    _out[i + 0] = out01.val[0];
+    _out[i + 4] = out01.val[1];
+    _out[i + 8] = out23.val[0];
+    _out[i + 12] = out23.val[1];
+  }
+}
+
+OZZ_INLINE SimdFloat4 MAdd(_SimdFloat4 _a, _SimdFloat4 _b, _SimdFloat4 _c) {
+  return OZZ_MADD(_a, _b, _c);
+}
+
+OZZ_INLINE SimdFloat4 MSub(_SimdFloat4 _a, _SimdFloat4 _b, _SimdFloat4 _c) {
+  return OZZ_MSUB(_a, _b, _c);
+}
+
+OZZ_INLINE SimdFloat4 NMAdd(_SimdFloat4 _a, _SimdFloat4 _b, _SimdFloat4 _c) {
+  return OZZ_NMADD(_a, _b, _c);
+}
+
+OZZ_INLINE SimdFloat4 NMSub(_SimdFloat4 _a, _SimdFloat4 _b, _SimdFloat4 _c) {
+  return OZZ_NMSUB(_a, _b, _c);
+}
+
+OZZ_INLINE SimdFloat4 DivX(_SimdFloat4 _a, _SimdFloat4 _b) {
+  return vsetq_lane_f32(vgetq_lane_f32(_a, 0) / vgetq_lane_f32(_b, 0), _a, 0);
+}
+
+OZZ_INLINE SimdFloat4 HAdd2(_SimdFloat4 _v) {
+  return vsetq_lane_f32(vget_lane_f32(OZZ_NEON_HADD2_F(_v), 0), _v, 0);
+}
+
+OZZ_INLINE SimdFloat4 HAdd3(_SimdFloat4 _v) {
+  return vsetq_lane_f32(vget_lane_f32(OZZ_NEON_HADD3_F(_v), 0), _v, 0);
+}
+
+OZZ_INLINE SimdFloat4 HAdd4(_SimdFloat4 _v) {
+  float32x2_t hadd4;
+  OZZ_NEON_HADD4_F(_v, hadd4);
+  return vcombine_f32(hadd4, hadd4);
+}
+
+OZZ_INLINE SimdFloat4 Dot2(_SimdFloat4 _a, _SimdFloat4 _b) {
+  float32x2_t dot2;
+  OZZ_NEON_DOT2_F(_a, _b, dot2);
+  return vcombine_f32(dot2, dot2);
+}
+
+OZZ_INLINE SimdFloat4 Dot3(_SimdFloat4 _a, _SimdFloat4 _b) {
+  float32x2_t dot3;
+  OZZ_NEON_DOT3_F(_a, _b, dot3);
+  return vcombine_f32(dot3, dot3);
+}
+
+OZZ_INLINE SimdFloat4 Dot4(_SimdFloat4 _a, _SimdFloat4 _b) {
+  float32x2_t dot4;
+  OZZ_NEON_DOT4_F(_a, _b, dot4);
+  return vcombine_f32(dot4, dot4);
+}
+
+OZZ_INLINE SimdFloat4 Cross3(_SimdFloat4 _a, _SimdFloat4 _b) {
+  const float32x4_t left1 = Swizzle<1, 2, 0, 3>(_b);
+  const float32x4_t right0 = Swizzle<2, 0, 1, 3>(_a);
+  const float32x4_t left0 = Swizzle<1, 2, 0, 3>(_a);
+  const float32x4_t right1 = Swizzle<2, 0, 1, 3>(_b);
+  return OZZ_MSUB(left0, right1, vmulq_f32(left1, right0));
+}
+
+#if defined(OZZ_SIMD_DETERMINISTIC)
+OZZ_INLINE SimdFloat4 Sqrt(_SimdFloat4 _v) {
+#ifdef OZZ_SIMD_NEON_A64
+  return vsqrtq_f32(_v);
+#else   // OZZ_SIMD_NEON_A64
+  return internal::SqrtVfp(_v);
+#endif  // OZZ_SIMD_NEON_A64
+}
+
+// Deterministic mode doesn't use hardware estimations, whose precision differs
+// from a cpu to another. IEEE correctly rounded division and square root are
+// used instead, which makes Est and EstNR functions equivalent.
+OZZ_INLINE SimdFloat4 RcpEst(_SimdFloat4 _v) {
+  return OZZ_NEON_DIV(vdupq_n_f32(1.f), _v);
+}
+
+OZZ_INLINE SimdFloat4 RcpEstNR(_SimdFloat4 _v) { return RcpEst(_v); }
+
+OZZ_INLINE SimdFloat4 RSqrtEst(_SimdFloat4 _v) {
+  return OZZ_NEON_DIV(vdupq_n_f32(1.f), Sqrt(_v));
+}
+
+OZZ_INLINE SimdFloat4 RSqrtEstNR(_SimdFloat4 _v) { return RSqrtEst(_v); }
+#else  // OZZ_SIMD_DETERMINISTIC
+// NEON estimates are only 8 bits accurate, where SSE ones are 12 bits. Est
+// functions thus do one Newton-Raphson step to provide a similar precision.
+OZZ_INLINE SimdFloat4 RcpEst(_SimdFloat4 _v) {
+  const float32x4_t est = vrecpeq_f32(_v);
+  return vmulq_f32(vrecpsq_f32(_v, est), est);
+}
+
+OZZ_INLINE SimdFloat4 RcpEstNR(_SimdFloat4 _v) {
+  const float32x4_t nr = RcpEst(_v);
+  // Do one more Newton-Raphson step to improve precision.
+  return vmulq_f32(vrecpsq_f32(_v, nr), nr);
+}
+
+OZZ_INLINE SimdFloat4 RSqrtEst(_SimdFloat4 _v) {
+  const float32x4_t est = vrsqrteq_f32(_v);
+  return vmulq_f32(vrsqrtsq_f32(vmulq_f32(_v, est), est), est);
+}
+
+OZZ_INLINE SimdFloat4 RSqrtEstNR(_SimdFloat4 _v) {
+  const float32x4_t nr = RSqrtEst(_v);
+  // Do one more Newton-Raphson step to improve precision.
+  return vmulq_f32(vrsqrtsq_f32(vmulq_f32(_v, nr), nr), nr);
+}
+
+OZZ_INLINE SimdFloat4 Sqrt(_SimdFloat4 _v) {
+#ifdef OZZ_SIMD_NEON_A64
+  return vsqrtq_f32(_v);
+#else   // OZZ_SIMD_NEON_A64
+  // _v * 1/sqrt(_v) is undefined for 0 and +inf, which are their own sqrt.
+  const uint32x4_t inf = vdupq_n_u32(0x7f800000u);
+  const uint32x4_t own = vorrq_u32(vceqq_f32(_v, vdupq_n_f32(0.f)),
+                                   vceqq_u32(vreinterpretq_u32_f32(_v), inf));
+  return vbslq_f32(own, _v, vmulq_f32(_v, RSqrtEstNR(_v)));
+#endif  // OZZ_SIMD_NEON_A64
+}
+#endif  // OZZ_SIMD_DETERMINISTIC
+
+OZZ_INLINE SimdFloat4 RcpEstX(_SimdFloat4 _v) {
+  return vsetq_lane_f32(vgetq_lane_f32(RcpEst(_v), 0), _v, 0);
+}
+
+OZZ_INLINE SimdFloat4 RcpEstXNR(_SimdFloat4 _v) {
+  return vsetq_lane_f32(vgetq_lane_f32(RcpEstNR(_v), 0), _v, 0);
+}
+
+OZZ_INLINE SimdFloat4 RSqrtEstX(_SimdFloat4 _v) {
+  return vsetq_lane_f32(vgetq_lane_f32(RSqrtEst(_v), 0), _v, 0);
+}
+
+OZZ_INLINE SimdFloat4 RSqrtEstXNR(_SimdFloat4 _v) {
+  return vsetq_lane_f32(vgetq_lane_f32(RSqrtEstNR(_v), 0), _v, 0);
+}
+
+OZZ_INLINE SimdFloat4 SqrtX(_SimdFloat4 _v) {
+  return vsetq_lane_f32(vgetq_lane_f32(Sqrt(_v), 0), _v, 0);
+}
+
+OZZ_INLINE SimdFloat4 Abs(_SimdFloat4 _v) { return vabsq_f32(_v); }
+
+OZZ_INLINE SimdInt4 Sign(_SimdFloat4 _v) {
+  return OZZ_NEON_CAST_I(
+      vandq_u32(vreinterpretq_u32_f32(_v), vdupq_n_u32(0x80000000u)));
+}
+
+OZZ_INLINE SimdFloat4 Length2(_SimdFloat4 _v) {
+  float32x2_t sq_len;
+  OZZ_NEON_DOT2_F(_v, _v, sq_len);
+  return Sqrt(vcombine_f32(sq_len, sq_len));
+}
+
+OZZ_INLINE SimdFloat4 Length3(_SimdFloat4 _v) {
+  float32x2_t sq_len;
+  OZZ_NEON_DOT3_F(_v, _v, sq_len);
+  return Sqrt(vcombine_f32(sq_len, sq_len));
+}
+
+OZZ_INLINE SimdFloat4 Length4(_SimdFloat4 _v) {
+  float32x2_t sq_len;
+  OZZ_NEON_DOT4_F(_v, _v, sq_len);
+  return Sqrt(vcombine_f32(sq_len, sq_len));
+}
+
+OZZ_INLINE SimdFloat4 Length2Sqr(_SimdFloat4 _v) {
+  float32x2_t sq_len;
+  OZZ_NEON_DOT2_F(_v, _v, sq_len);
+  return vcombine_f32(sq_len, sq_len);
+}
+
+OZZ_INLINE SimdFloat4 Length3Sqr(_SimdFloat4 _v) {
+  float32x2_t sq_len;
+  OZZ_NEON_DOT3_F(_v, _v, sq_len);
+  return vcombine_f32(sq_len, sq_len);
+}
+
+OZZ_INLINE SimdFloat4 Length4Sqr(_SimdFloat4 _v) {
+  float32x2_t sq_len;
+  OZZ_NEON_DOT4_F(_v, _v, sq_len);
+  return vcombine_f32(sq_len, sq_len);
+}
+
+OZZ_INLINE SimdFloat4 Normalize2(_SimdFloat4 _v) {
+  float32x2_t sq_len;
+  OZZ_NEON_DOT2_F(_v, _v, sq_len);
+  assert(vget_lane_f32(sq_len, 0) != 0.f && "_v is not normalizable");
+  const float32x4_t inv_lenxxxx =
+      OZZ_NEON_DIV(vdupq_n_f32(1.f), Sqrt(vdupq_lane_f32(sq_len, 0)));
+  const float32x4_t norm = vmulq_f32(_v, inv_lenxxxx);
+  return vcombine_f32(vget_low_f32(norm), vget_high_f32(_v));
+}
+
+OZZ_INLINE SimdFloat4 Normalize3(_SimdFloat4 _v) {
+  float32x2_t sq_len;
+  OZZ_NEON_DOT3_F(_v, _v, sq_len);
+  assert(vget_lane_f32(sq_len, 0) != 0.f && "_v is not normalizable");
+  const float32x4_t inv_lenxxxx =
+      OZZ_NEON_DIV(vdupq_n_f32(1.f), Sqrt(vdupq_lane_f32(sq_len, 0)));
+  const float32x4_t norm = vmulq_f32(_v, inv_lenxxxx);
+  return vsetq_lane_f32(vgetq_lane_f32(_v, 3), norm, 3);
+}
+
+OZZ_INLINE SimdFloat4 Normalize4(_SimdFloat4 _v) {
+  float32x2_t sq_len;
+  OZZ_NEON_DOT4_F(_v, _v, sq_len);
+  assert(vget_lane_f32(sq_len, 0) != 0.f && "_v is not normalizable");
+  const float32x4_t inv_lenxxxx =
+      OZZ_NEON_DIV(vdupq_n_f32(1.f), Sqrt(vdupq_lane_f32(sq_len, 0)));
+  return vmulq_f32(_v, inv_lenxxxx);
+}
+
+OZZ_INLINE SimdFloat4 NormalizeEst2(_SimdFloat4 _v) {
+  float32x2_t sq_len;
+  OZZ_NEON_DOT2_F(_v, _v, sq_len);
+  assert(vget_lane_f32(sq_len, 0) != 0.f && "_v is not normalizable");
+  const float32x4_t inv_lenxxxx = RSqrtEst(vdupq_lane_f32(sq_len, 0));
+  const float32x4_t norm = vmulq_f32(_v, inv_lenxxxx);
+  return vcombine_f32(vget_low_f32(norm), vget_high_f32(_v));
+}
+
+OZZ_INLINE SimdFloat4 NormalizeEst3(_SimdFloat4 _v) {
+  float32x2_t sq_len;
+  OZZ_NEON_DOT3_F(_v, _v, sq_len);
+  assert(vget_lane_f32(sq_len, 0) != 0.f && "_v is not normalizable");
+  const float32x4_t inv_lenxxxx = RSqrtEst(vdupq_lane_f32(sq_len, 0));
+  const float32x4_t norm = vmulq_f32(_v, inv_lenxxxx);
+  return vsetq_lane_f32(vgetq_lane_f32(_v, 3), norm, 3);
+}
+
+OZZ_INLINE SimdFloat4 NormalizeEst4(_SimdFloat4 _v) {
+  float32x2_t sq_len;
+  OZZ_NEON_DOT4_F(_v, _v, sq_len);
+  assert(vget_lane_f32(sq_len, 0) != 0.f && "_v is not normalizable");
+  const float32x4_t inv_lenxxxx = RSqrtEst(vdupq_lane_f32(sq_len, 0));
+  return vmulq_f32(_v, inv_lenxxxx);
+}
+
+// Compares x component of _sq_len against [_min,_max] range, others are false.
+#define OZZ_NEON_IS_NORMALIZED(_sq_len, _min, _max)                         \
+  OZZ_NEON_CAST_I(vandq_u32(                                                \
+      vcltq_f32(vcombine_f32(_sq_len, vdup_n_f32(0.f)), vdupq_n_f32(_max)), \
+      vcgtq_f32(vcombine_f32(_sq_len, vdup_n_f32(0.f)), vdupq_n_f32(_min))))
+
+OZZ_INLINE SimdInt4 IsNormalized2(_SimdFloat4 _v) {
+  float32x2_t dot;
+  OZZ_NEON_DOT2_F(_v, _v, dot);
+  dot = vset_lane_f32(0.f, dot, 1);
+  return OZZ_NEON_IS_NORMALIZED(dot, 1.f - kNormalizationToleranceSq,
+                                1.f + kNormalizationToleranceSq);
+}
+
+OZZ_INLINE SimdInt4 IsNormalized3(_SimdFloat4 _v) {
+  float32x2_t dot;
+  OZZ_NEON_DOT3_F(_v, _v, dot);
+  dot = vset_lane_f32(0.f, dot, 1);
+  return OZZ_NEON_IS_NORMALIZED(dot, 1.f - kNormalizationToleranceSq,
+                                1.f + kNormalizationToleranceSq);
+}
+
+OZZ_INLINE SimdInt4 IsNormalized4(_SimdFloat4 _v) {
+  float32x2_t dot;
+  OZZ_NEON_DOT4_F(_v, _v, dot);
+  dot = vset_lane_f32(0.f, dot, 1);
+  return OZZ_NEON_IS_NORMALIZED(dot, 1.f - kNormalizationToleranceSq,
+                                1.f + kNormalizationToleranceSq);
+}
+
+OZZ_INLINE SimdInt4 IsNormalizedEst2(_SimdFloat4 _v) {
+  float32x2_t dot;
+  OZZ_NEON_DOT2_F(_v, _v, dot);
+  dot = vset_lane_f32(0.f, dot, 1);
+  return OZZ_NEON_IS_NORMALIZED(dot, 1.f - kNormalizationToleranceEstSq,
+                                1.f + kNormalizationToleranceEstSq);
+}
+
+OZZ_INLINE SimdInt4 IsNormalizedEst3(_SimdFloat4 _v) {
+  float32x2_t dot;
+  OZZ_NEON_DOT3_F(_v, _v, dot);
+  dot = vset_lane_f32(0.f, dot, 1);
+  return OZZ_NEON_IS_NORMALIZED(dot, 1.f - kNormalizationToleranceEstSq,
+                                1.f + kNormalizationToleranceEstSq);
+}
+
+OZZ_INLINE SimdInt4 IsNormalizedEst4(_SimdFloat4 _v) {
+  float32x2_t dot;
+  OZZ_NEON_DOT4_F(_v, _v, dot);
+  dot = vset_lane_f32(0.f, dot, 1);
+  return OZZ_NEON_IS_NORMALIZED(dot, 1.f - kNormalizationToleranceEstSq,
+                                1.f + kNormalizationToleranceEstSq);
+}
+
+OZZ_INLINE SimdFloat4 NormalizeSafe2(_SimdFloat4 _v, _SimdFloat4 _safe) {
+  // assert(AreAllTrue1(IsNormalized2(_safe)) && "_safe is not normalized");
+  float32x2_t sq_len;
+  OZZ_NEON_DOT2_F(_v, _v, sq_len);
+  const float32x4_t sq_lenxxxx = vdupq_lane_f32(sq_len, 0);
+  const float32x4_t inv_lenxxxx =
+      OZZ_NEON_DIV(vdupq_n_f32(1.f), Sqrt(sq_lenxxxx));
+  const float32x4_t norm = vmulq_f32(_v, inv_lenxxxx);
+  const uint32x4_t cond = vcleq_f32(sq_lenxxxx, vdupq_n_f32(0.f));
+  const float32x4_t cfalse =
+      vcombine_f32(vget_low_f32(norm), vget_high_f32(_v));
+  return vbslq_f32(cond, _safe, cfalse);
+}
+
+OZZ_INLINE SimdFloat4 NormalizeSafe3(_SimdFloat4 _v, _SimdFloat4 _safe) {
+  // assert(AreAllTrue1(IsNormalized3(_safe)) && "_safe is not normalized");
+  float32x2_t sq_len;
+  OZZ_NEON_DOT3_F(_v, _v, sq_len);
+  const float32x4_t sq_lenxxxx = vdupq_lane_f32(sq_len, 0);
+  const float32x4_t inv_lenxxxx =
+      OZZ_NEON_DIV(vdupq_n_f32(1.f), Sqrt(sq_lenxxxx));
+  const float32x4_t norm = vmulq_f32(_v, inv_lenxxxx);
+  const uint32x4_t cond = vcleq_f32(sq_lenxxxx, vdupq_n_f32(0.f));
+  const float32x4_t cfalse = vsetq_lane_f32(vgetq_lane_f32(_v, 3), norm, 3);
+  return vbslq_f32(cond, _safe, cfalse);
+}
+
+OZZ_INLINE SimdFloat4 NormalizeSafe4(_SimdFloat4 _v, _SimdFloat4 _safe) {
+  // assert(AreAllTrue1(IsNormalized4(_safe)) && "_safe is not normalized");
+  float32x2_t sq_len;
+  OZZ_NEON_DOT4_F(_v, _v, sq_len);
+  const float32x4_t sq_lenxxxx = vdupq_lane_f32(sq_len, 0);
+  const float32x4_t inv_lenxxxx =
+      OZZ_NEON_DIV(vdupq_n_f32(1.f), Sqrt(sq_lenxxxx));
+  const uint32x4_t cond = vcleq_f32(sq_lenxxxx, vdupq_n_f32(0.f));
+  const float32x4_t cfalse = vmulq_f32(_v, inv_lenxxxx);
+  return vbslq_f32(cond, _safe, cfalse);
+}
+
+OZZ_INLINE SimdFloat4 NormalizeSafeEst2(_SimdFloat4 _v, _SimdFloat4 _safe) {
+  // assert(AreAllTrue1(IsNormalizedEst2(_safe)) && "_safe is not normalized");
+  float32x2_t sq_len;
+  OZZ_NEON_DOT2_F(_v, _v, sq_len);
+  const float32x4_t sq_lenxxxx = vdupq_lane_f32(sq_len, 0);
+  const float32x4_t inv_lenxxxx = RSqrtEst(sq_lenxxxx);
+  const float32x4_t norm = vmulq_f32(_v, inv_lenxxxx);
+  const uint32x4_t cond = vcleq_f32(sq_lenxxxx, vdupq_n_f32(0.f));
+  const float32x4_t cfalse =
+      vcombine_f32(vget_low_f32(norm), vget_high_f32(_v));
+  return vbslq_f32(cond, _safe, cfalse);
+}
+
+OZZ_INLINE SimdFloat4 NormalizeSafeEst3(_SimdFloat4 _v, _SimdFloat4 _safe) {
+  // assert(AreAllTrue1(IsNormalizedEst3(_safe)) && "_safe is not normalized");
+  float32x2_t sq_len;
+  OZZ_NEON_DOT3_F(_v, _v, sq_len);
+  const float32x4_t sq_lenxxxx = vdupq_lane_f32(sq_len, 0);
+  const float32x4_t inv_lenxxxx = RSqrtEst(sq_lenxxxx);
+  const float32x4_t norm = vmulq_f32(_v, inv_lenxxxx);
+  const uint32x4_t cond = vcleq_f32(sq_lenxxxx, vdupq_n_f32(0.f));
+  const float32x4_t cfalse = vsetq_lane_f32(vgetq_lane_f32(_v, 3), norm, 3);
+  return vbslq_f32(cond, _safe, cfalse);
+}
+
+OZZ_INLINE SimdFloat4 NormalizeSafeEst4(_SimdFloat4 _v, _SimdFloat4 _safe) {
+  // assert(AreAllTrue1(IsNormalizedEst4(_safe)) && "_safe is not normalized");
+  float32x2_t sq_len;
+  OZZ_NEON_DOT4_F(_v, _v, sq_len);
+  const float32x4_t sq_lenxxxx = vdupq_lane_f32(sq_len, 0);
+  const float32x4_t inv_lenxxxx = RSqrtEst(sq_lenxxxx);
+  const uint32x4_t cond = vcleq_f32(sq_lenxxxx, vdupq_n_f32(0.f));
+  const float32x4_t cfalse = vmulq_f32(_v, inv_lenxxxx);
+  return vbslq_f32(cond, _safe, cfalse);
+}
+
+OZZ_INLINE SimdFloat4 Lerp(_SimdFloat4 _a, _SimdFloat4 _b, _SimdFloat4 _alpha) {
+  return OZZ_MADD(_alpha, vsubq_f32(_b, _a), _a);
+}
+
+OZZ_INLINE SimdFloat4 Min(_SimdFloat4 _a, _SimdFloat4 _b) {
+  return vminq_f32(_a, _b);
+}
+
+OZZ_INLINE SimdFloat4 Max(_SimdFloat4 _a, _SimdFloat4 _b) {
+  return vmaxq_f32(_a, _b);
+}
+
+OZZ_INLINE SimdFloat4 Min0(_SimdFloat4 _v) {
+  return vminq_f32(vdupq_n_f32(0.f), _v);
+}
+
+OZZ_INLINE SimdFloat4 Max0(_SimdFloat4 _v) {
+  return vmaxq_f32(vdupq_n_f32(0.f), _v);
+}
+
+OZZ_INLINE SimdFloat4 Clamp(_SimdFloat4 _a, _SimdFloat4 _v, _SimdFloat4 _b) {
+  return vmaxq_f32(_a, vminq_f32(_v, _b));
+}
+
+OZZ_INLINE SimdFloat4 Select(_SimdInt4 _b, _SimdFloat4 _true,
+                             _SimdFloat4 _false) {
+  return OZZ_NEON_SELECT_F(_b, _true, _false);
+}
+
+OZZ_INLINE SimdInt4 CmpEq(_SimdFloat4 _a, _SimdFloat4 _b) {
+  return OZZ_NEON_CAST_I(vceqq_f32(_a, _b));
+}
+
+OZZ_INLINE SimdInt4 CmpNe(_SimdFloat4 _a, _SimdFloat4 _b) {
+  return OZZ_NEON_CAST_I(vmvnq_u32(vceqq_f32(_a, _b)));
+}
+
+OZZ_INLINE SimdInt4 CmpLt(_SimdFloat4 _a, _SimdFloat4 _b) {
+  return OZZ_NEON_CAST_I(vcltq_f32(_a, _b));
+}
+
+OZZ_INLINE SimdInt4 CmpLe(_SimdFloat4 _a, _SimdFloat4 _b) {
+  return OZZ_NEON_CAST_I(vcleq_f32(_a, _b));
+}
+
+OZZ_INLINE SimdInt4 CmpGt(_SimdFloat4 _a, _SimdFloat4 _b) {
+  return OZZ_NEON_CAST_I(vcgtq_f32(_a, _b));
+}
+
+OZZ_INLINE SimdInt4 CmpGe(_SimdFloat4 _a, _SimdFloat4 _b) {
+  return OZZ_NEON_CAST_I(vcgeq_f32(_a, _b));
+}
+
+OZZ_INLINE SimdFloat4 And(_SimdFloat4 _a, _SimdFloat4 _b) {
+  return vreinterpretq_f32_u32(
+      vandq_u32(vreinterpretq_u32_f32(_a), vreinterpretq_u32_f32(_b)));
+}
+
+OZZ_INLINE SimdFloat4 Or(_SimdFloat4 _a, _SimdFloat4 _b) {
+  return vreinterpretq_f32_u32(
+      vorrq_u32(vreinterpretq_u32_f32(_a), vreinterpretq_u32_f32(_b)));
+}
+
+OZZ_INLINE SimdFloat4 Xor(_SimdFloat4 _a, _SimdFloat4 _b) {
+  return vreinterpretq_f32_u32(
+      veorq_u32(vreinterpretq_u32_f32(_a), vreinterpretq_u32_f32(_b)));
+}
+
+OZZ_INLINE SimdFloat4 And(_SimdFloat4 _a, _SimdInt4 _b) {
+  return vreinterpretq_f32_s32(vandq_s32(vreinterpretq_s32_f32(_a), _b));
+}
+
+OZZ_INLINE SimdFloat4 AndNot(_SimdFloat4 _a, _SimdInt4 _b) {
+  return vreinterpretq_f32_s32(vbicq_s32(vreinterpretq_s32_f32(_a), _b));
+}
+
+OZZ_INLINE SimdFloat4 Or(_SimdFloat4 _a, _SimdInt4 _b) {
+  return vreinterpretq_f32_s32(vorrq_s32(vreinterpretq_s32_f32(_a), _b));
+}
+
+OZZ_INLINE SimdFloat4 Xor(_SimdFloat4 _a, _SimdInt4 _b) {
+  return vreinterpretq_f32_s32(veorq_s32(vreinterpretq_s32_f32(_a), _b));
+}
+
+OZZ_INLINE SimdFloat4 Cos(_SimdFloat4 _v) {
+  return simd_float4::Load(std::cos(GetX(_v)), std::cos(GetY(_v)),
+                           std::cos(GetZ(_v)), std::cos(GetW(_v)));
+}
+
+OZZ_INLINE SimdFloat4 CosX(_SimdFloat4 _v) {
+  return vsetq_lane_f32(std::cos(GetX(_v)), _v, 0);
+}
+
+OZZ_INLINE SimdFloat4 ACos(_SimdFloat4 _v) {
+  return simd_float4::Load(std::acos(GetX(_v)), std::acos(GetY(_v)),
+                           std::acos(GetZ(_v)), std::acos(GetW(_v)));
+}
+
+OZZ_INLINE SimdFloat4 ACosX(_SimdFloat4 _v) {
+  return vsetq_lane_f32(std::acos(GetX(_v)), _v, 0);
+}
+
+OZZ_INLINE SimdFloat4 Sin(_SimdFloat4 _v) {
+  return simd_float4::Load(std::sin(GetX(_v)), std::sin(GetY(_v)),
+                           std::sin(GetZ(_v)), std::sin(GetW(_v)));
+}
+
+OZZ_INLINE SimdFloat4 SinX(_SimdFloat4 _v) {
+  return vsetq_lane_f32(std::sin(GetX(_v)), _v, 0);
+}
+
+OZZ_INLINE SimdFloat4 ASin(_SimdFloat4 _v) {
+  return simd_float4::Load(std::asin(GetX(_v)), std::asin(GetY(_v)),
+                           std::asin(GetZ(_v)), std::asin(GetW(_v)));
+}
+
+OZZ_INLINE SimdFloat4 ASinX(_SimdFloat4 _v) {
+  return vsetq_lane_f32(std::asin(GetX(_v)), _v, 0);
+}
+
+OZZ_INLINE SimdFloat4 Tan(_SimdFloat4 _v) {
+  return simd_float4::Load(std::tan(GetX(_v)), std::tan(GetY(_v)),
+                           std::tan(GetZ(_v)), std::tan(GetW(_v)));
+}
+
+OZZ_INLINE SimdFloat4 TanX(_SimdFloat4 _v) {
+  return vsetq_lane_f32(std::tan(GetX(_v)), _v, 0);
+}
+
+OZZ_INLINE SimdFloat4 ATan(_SimdFloat4 _v) {
+  return simd_float4::Load(std::atan(GetX(_v)), std::atan(GetY(_v)),
+                           std::atan(GetZ(_v)), std::atan(GetW(_v)));
+}
+
+OZZ_INLINE SimdFloat4 ATanX(_SimdFloat4 _v) {
+  return vsetq_lane_f32(std::atan(GetX(_v)), _v, 0);
+}
+
+namespace simd_int4 {
+
+OZZ_INLINE SimdInt4 zero() { return vdupq_n_s32(0); }
+
+OZZ_INLINE SimdInt4 one() { return vdupq_n_s32(1); }
+
+OZZ_INLINE SimdInt4 x_axis() { return vsetq_lane_s32(1, vdupq_n_s32(0), 0); }
+
+OZZ_INLINE SimdInt4 y_axis() { return vsetq_lane_s32(1, vdupq_n_s32(0), 1); }
+
+OZZ_INLINE SimdInt4 z_axis() { return vsetq_lane_s32(1, vdupq_n_s32(0), 2); }
+
+OZZ_INLINE SimdInt4 w_axis() { return vsetq_lane_s32(1, vdupq_n_s32(0), 3); }
+
+OZZ_INLINE SimdInt4 all_true() { return vdupq_n_s32(-1); }
+
+OZZ_INLINE SimdInt4 all_false() { return vdupq_n_s32(0); }
+
+OZZ_INLINE SimdInt4 mask_sign() {
+  return vreinterpretq_s32_u32(vdupq_n_u32(0x80000000u));
+}
+
+OZZ_INLINE SimdInt4 mask_sign_xyz() {
+  return vreinterpretq_s32_u32(
+      vsetq_lane_u32(0, vdupq_n_u32(0x80000000u), 3));
+}
+
+OZZ_INLINE SimdInt4 mask_sign_w() {
+  return vreinterpretq_s32_u32(
+      vsetq_lane_u32(0x80000000u, vdupq_n_u32(0), 3));
+}
+
+OZZ_INLINE SimdInt4 mask_not_sign() { return vdupq_n_s32(0x7fffffff); }
+
+OZZ_INLINE SimdInt4 mask_ffff() { return vdupq_n_s32(-1); }
+
+OZZ_INLINE SimdInt4 mask_0000() { return vdupq_n_s32(0); }
+
+OZZ_INLINE SimdInt4 mask_fff0() {
+  return vsetq_lane_s32(0, vdupq_n_s32(-1), 3);
+}
+
+OZZ_INLINE SimdInt4 mask_f000() {
+  return vsetq_lane_s32(-1, vdupq_n_s32(0), 0);
+}
+
+OZZ_INLINE SimdInt4 mask_0f00() {
+  return vsetq_lane_s32(-1, vdupq_n_s32(0), 1);
+}
+
+OZZ_INLINE SimdInt4 mask_00f0() {
+  return vsetq_lane_s32(-1, vdupq_n_s32(0), 2);
+}
+
+OZZ_INLINE SimdInt4 mask_000f() {
+  return vsetq_lane_s32(-1, vdupq_n_s32(0), 3);
+}
+
+OZZ_INLINE SimdInt4 Load(int _x, int _y, int _z, int _w) {
+  OZZ_ALIGN(16) const int i[4] = {_x, _y, _z, _w};
+  return vld1q_s32(i);
+}
+
+OZZ_INLINE SimdInt4 LoadX(int _x) {
+  return vsetq_lane_s32(_x, vdupq_n_s32(0), 0);
+}
+
+OZZ_INLINE SimdInt4 Load1(int _x) { return vdupq_n_s32(_x); }
+
+OZZ_INLINE SimdInt4 Load(bool _x, bool _y, bool _z, bool _w) {
+  return vnegq_s32(Load(static_cast<int>(_x), static_cast<int>(_y),
+                        static_cast<int>(_z), static_cast<int>(_w)));
+}
+
+OZZ_INLINE SimdInt4 LoadX(bool _x) {
+  return vsetq_lane_s32(-static_cast<int>(_x), vdupq_n_s32(0), 0);
+}
+
+OZZ_INLINE SimdInt4 Load1(bool _x) {
+  return vdupq_n_s32(-static_cast<int>(_x));
+}
+
+OZZ_INLINE SimdInt4 LoadPtr(const int* _i) {
+  assert(!(uintptr_t(_i) & 0xf) && "Invalid alignment");
+  return vld1q_s32(_i);
+}
+
+OZZ_INLINE SimdInt4 LoadXPtr(const int* _i) {
+  assert(!(uintptr_t(_i) & 0xf) && "Invalid alignment");
+  return vld1q_lane_s32(_i, vdupq_n_s32(0), 0);
+}
+
+OZZ_INLINE SimdInt4 Load1Ptr(const int* _i) {
+  assert(!(uintptr_t(_i) & 0xf) && "Invalid alignment");
+  return vld1q_dup_s32(_i);
+}
+
+OZZ_INLINE SimdInt4 Load2Ptr(const int* _i) {
+  assert(!(uintptr_t(_i) & 0xf) && "Invalid alignment");
+  return vcombine_s32(vld1_s32(_i), vdup_n_s32(0));
+}
+
+OZZ_INLINE SimdInt4 Load3Ptr(const int* _i) {
+  assert(!(uintptr_t(_i) & 0xf) && "Invalid alignment");
+  return vcombine_s32(vld1_s32(_i), vld1_lane_s32(_i + 2, vdup_n_s32(0), 0));
+}
+
+OZZ_INLINE SimdInt4 LoadPtrU(const int* _i) {
+  assert(!(uintptr_t(_i) & 0x3) && "Invalid alignment");
+  return vld1q_s32(_i);
+}
+
+OZZ_INLINE SimdInt4 LoadXPtrU(const int* _i) {
+  assert(!(uintptr_t(_i) & 0x3) && "Invalid alignment");
+  return vld1q_lane_s32(_i, vdupq_n_s32(0), 0);
+}
+
+OZZ_INLINE SimdInt4 Load1PtrU(const int* _i) {
+  assert(!(uintptr_t(_i) & 0x3) && "Invalid alignment");
+  return vld1q_dup_s32(_i);
+}
+
+OZZ_INLINE SimdInt4 Load2PtrU(const int* _i) {
+  assert(!(uintptr_t(_i) & 0x3) && "Invalid alignment");
+  return vcombine_s32(vld1_s32(_i), vdup_n_s32(0));
+}
+
+OZZ_INLINE SimdInt4 Load3PtrU(const int* _i) {
+  assert(!(uintptr_t(_i) & 0x3) && "Invalid alignment");
+  return vcombine_s32(vld1_s32(_i), vld1_lane_s32(_i + 2, vdup_n_s32(0), 0));
+}
+
+OZZ_INLINE SimdInt4 FromFloatRound(_SimdFloat4 _f) {
+#ifdef OZZ_SIMD_NEON_A64
+  return vcvtnq_s32_f32(_f);
+#else   // OZZ_SIMD_NEON_A64
+  // Rounds to nearest even by adding and subtracting 2^23, which pushes the
+  // fractional part out of the mantissa. Bigger values are already integers.
+  const float32x4_t abs = vabsq_f32(_f);
+  const float32x4_t two23 = vdupq_n_f32(8388608.f);
+  const float32x4_t rounded = vsubq_f32(vaddq_f32(abs, two23), two23);
+  const uint32x4_t sign =
+      vandq_u32(vreinterpretq_u32_f32(_f), vdupq_n_u32(0x80000000u));
+  const float32x4_t srounded =
+      vreinterpretq_f32_u32(vorrq_u32(vreinterpretq_u32_f32(rounded), sign));
+  return vcvtq_s32_f32(vbslq_f32(vcltq_f32(abs, two23), srounded, _f));
+#endif  // OZZ_SIMD_NEON_A64
+}
+
+OZZ_INLINE SimdInt4 FromFloatTrunc(_SimdFloat4 _f) {
+  return vcvtq_s32_f32(_f);
+}
+}  // namespace simd_int4
+
+OZZ_INLINE int GetX(_SimdInt4 _v) { return vgetq_lane_s32(_v, 0); }
+
+OZZ_INLINE int GetY(_SimdInt4 _v) { return vgetq_lane_s32(_v, 1); }
+
+OZZ_INLINE int GetZ(_SimdInt4 _v) { return vgetq_lane_s32(_v, 2); }
+
+OZZ_INLINE int GetW(_SimdInt4 _v) { return vgetq_lane_s32(_v, 3); }
+
+OZZ_INLINE SimdInt4 SetX(_SimdInt4 _v, _SimdInt4 _i) {
+  return vsetq_lane_s32(vgetq_lane_s32(_i, 0), _v, 0);
+}
+
+OZZ_INLINE SimdInt4 SetY(_SimdInt4 _v, _SimdInt4 _i) {
+  return vsetq_lane_s32(vgetq_lane_s32(_i, 0), _v, 1);
+}
+
+OZZ_INLINE SimdInt4 SetZ(_SimdInt4 _v, _SimdInt4 _i) {
+  return vsetq_lane_s32(vgetq_lane_s32(_i, 0), _v, 2);
+}
+
+OZZ_INLINE SimdInt4 SetW(_SimdInt4 _v, _SimdInt4 _i) {
+  return vsetq_lane_s32(vgetq_lane_s32(_i, 0), _v, 3);
+}
+
+OZZ_INLINE SimdInt4 SetI(_SimdInt4 _v, _SimdInt4 _i, int _ith) {
+  assert(_ith >= 0 && _ith <= 3 && "Invalid index, out of range.");
+  OZZ_ALIGN(16) int ai[4];
+  vst1q_s32(ai, _v);
+  ai[_ith] = vgetq_lane_s32(_i, 0);
+  return vld1q_s32(ai);
+}
+
+OZZ_INLINE void StorePtr(_SimdInt4 _v, int* _i) {
+  assert(!(uintptr_t(_i) & 0xf) && "Invalid alignment");
+  vst1q_s32(_i, _v);
+}
+
+OZZ_INLINE void Store1Ptr(_SimdInt4 _v, int* _i) {
+  assert(!(uintptr_t(_i) & 0xf) && "Invalid alignment");
+  vst1q_lane_s32(_i, _v, 0);
+}
+
+OZZ_INLINE void Store2Ptr(_SimdInt4 _v, int* _i) {
+  assert(!(uintptr_t(_i) & 0xf) && "Invalid alignment");
+  vst1_s32(_i, vget_low_s32(_v));
+}
+
+OZZ_INLINE void Store3Ptr(_SimdInt4 _v, int* _i) {
+  assert(!(uintptr_t(_i) & 0xf) && "Invalid alignment");
+  vst1_s32(_i, vget_low_s32(_v));
+  vst1q_lane_s32(_i + 2, _v, 2);
+}
+
+OZZ_INLINE void StorePtrU(_SimdInt4 _v, int* _i) {
+  assert(!(uintptr_t(_i) & 0x3) && "Invalid alignment");
+  vst1q_s32(_i, _v);
+}
+
+OZZ_INLINE void Store1PtrU(_SimdInt4 _v, int* _i) {
+  assert(!(uintptr_t(_i) & 0x3) && "Invalid alignment");
+  vst1q_lane_s32(_i, _v, 0);
+}
+
+OZZ_INLINE void Store2PtrU(_SimdInt4 _v, int* _i) {
+  assert(!(uintptr_t(_i) & 0x3) && "Invalid alignment");
+  vst1_s32(_i, vget_low_s32(_v));
+}
+
+OZZ_INLINE void Store3PtrU(_SimdInt4 _v, int* _i) {
+  assert(!(uintptr_t(_i) & 0x3) && "Invalid alignment");
+  vst1_s32(_i, vget_low_s32(_v));
+  vst1q_lane_s32(_i + 2, _v, 2);
+}
+
+OZZ_INLINE SimdInt4 SplatX(_SimdInt4 _a) { return OZZ_NEON_SPLAT_I(_a, 0); }
+
+OZZ_INLINE SimdInt4 SplatY(_SimdInt4 _a) { return OZZ_NEON_SPLAT_I(_a, 1); }
+
+OZZ_INLINE SimdInt4 SplatZ(_SimdInt4 _a) { return OZZ_NEON_SPLAT_I(_a, 2); }
+
+OZZ_INLINE SimdInt4 SplatW(_SimdInt4 _a) { return OZZ_NEON_SPLAT_I(_a, 3); }
+
+template <size_t _X, size_t _Y, size_t _Z, size_t _W>
+OZZ_INLINE SimdInt4 Swizzle(_SimdInt4 _v) {
+  OZZ_STATIC_ASSERT(_X <= 3 && _Y <= 3 && _Z <= 3 && _W <= 3);
+  return vsetq_lane_s32(
+      vgetq_lane_s32(_v, _W),
+      vsetq_lane_s32(vgetq_lane_s32(_v, _Z),
+                     vsetq_lane_s32(vgetq_lane_s32(_v, _Y),
+                                    vdupq_n_s32(vgetq_lane_s32(_v, _X)), 1),
+                     2),
+      3);
+}
+
+template <>
+OZZ_INLINE SimdInt4 Swizzle<0, 1, 2, 3>(_SimdInt4 _v) {
+  return _v;
+}
+
+OZZ_INLINE int MoveMask(_SimdInt4 _v) {
+  // Moves each sign bit to its lane index bit, and merges them.
+  const uint32x4_t bits =
+      vshlq_u32(vshrq_n_u32(vreinterpretq_u32_s32(_v), 31),
+                simd_int4::Load(0, 1, 2, 3));
+  const uint32x2_t pair = vorr_u32(vget_low_u32(bits), vget_high_u32(bits));
+  return static_cast<int>(vget_lane_u32(pair, 0) | vget_lane_u32(pair, 1));
+}
+
+OZZ_INLINE bool AreAllTrue(_SimdInt4 _v) { return MoveMask(_v) == 0xf; }
+
+OZZ_INLINE bool AreAllTrue3(_SimdInt4 _v) {
+  return (MoveMask(_v) & 0x7) == 0x7;
+}
+
+OZZ_INLINE bool AreAllTrue2(_SimdInt4 _v) {
+  return (MoveMask(_v) & 0x3) == 0x3;
+}
+
+OZZ_INLINE bool AreAllTrue1(_SimdInt4 _v) {
+  return (MoveMask(_v) & 0x1) == 0x1;
+}
+
+OZZ_INLINE bool AreAllFalse(_SimdInt4 _v) { return MoveMask(_v) == 0; }
+
+OZZ_INLINE bool AreAllFalse3(_SimdInt4 _v) { return (MoveMask(_v) & 0x7) == 0; }
+
+OZZ_INLINE bool AreAllFalse2(_SimdInt4 _v) { return (MoveMask(_v) & 0x3) == 0; }
+
+OZZ_INLINE bool AreAllFalse1(_SimdInt4 _v) { return (MoveMask(_v) & 0x1) == 0; }
+
+OZZ_INLINE SimdInt4 HAdd2(_SimdInt4 _v) {
+  const int32x2_t low = vget_low_s32(_v);
+  return vsetq_lane_s32(vget_lane_s32(vpadd_s32(low, low), 0), _v, 0);
+}
+
+OZZ_INLINE SimdInt4 HAdd3(_SimdInt4 _v) {
+  const int32x2_t low = vget_low_s32(_v);
+  const int32x2_t hadd = vadd_s32(vpadd_s32(low, low), vget_high_s32(_v));
+  return vsetq_lane_s32(vget_lane_s32(hadd, 0), _v, 0);
+}
+
+OZZ_INLINE SimdInt4 HAdd4(_SimdInt4 _v) {
+  const int32x2_t haddxyzw = vadd_s32(vget_low_s32(_v), vget_high_s32(_v));
+  const int32x2_t hadd = vpadd_s32(haddxyzw, haddxyzw);
+  return vsetq_lane_s32(vget_lane_s32(hadd, 0), _v, 0);
+}
+
+OZZ_INLINE SimdInt4 Abs(_SimdInt4 _v) { return vabsq_s32(_v); }
+
+OZZ_INLINE SimdInt4 Sign(_SimdInt4 _v) {
+  return vreinterpretq_s32_u32(
+      vandq_u32(vreinterpretq_u32_s32(_v), vdupq_n_u32(0x80000000u)));
+}
+
+OZZ_INLINE SimdInt4 Min(_SimdInt4 _a, _SimdInt4 _b) {
+  return vminq_s32(_a, _b);
+}
+
+OZZ_INLINE SimdInt4 Max(_SimdInt4 _a, _SimdInt4 _b) {
+  return vmaxq_s32(_a, _b);
+}
+
+OZZ_INLINE SimdInt4 Min0(_SimdInt4 _v) { return vminq_s32(vdupq_n_s32(0), _v); }
+
+OZZ_INLINE SimdInt4 Max0(_SimdInt4 _v) { return vmaxq_s32(vdupq_n_s32(0), _v); }
+
+OZZ_INLINE SimdInt4 Clamp(_SimdInt4 _a, _SimdInt4 _v, _SimdInt4 _b) {
+  return vminq_s32(vmaxq_s32(_a, _v), _b);
+}
+
+OZZ_INLINE SimdInt4 Select(_SimdInt4 _b, _SimdInt4 _true, _SimdInt4 _false) {
+  return OZZ_NEON_SELECT_I(_b, _true, _false);
+}
+
+OZZ_INLINE SimdInt4 And(_SimdInt4 _a, _SimdInt4 _b) {
+  return vandq_s32(_a, _b);
+}
+
+OZZ_INLINE SimdInt4 AndNot(_SimdInt4 _a, _SimdInt4 _b) {
+  return vbicq_s32(_a, _b);
+}
+
+OZZ_INLINE SimdInt4 Or(_SimdInt4 _a, _SimdInt4 _b) { return vorrq_s32(_a, _b); }
+
+OZZ_INLINE SimdInt4 Xor(_SimdInt4 _a, _SimdInt4 _b) {
+  return veorq_s32(_a, _b);
+}
+
+OZZ_INLINE SimdInt4 Not(_SimdInt4 _v) { return vmvnq_s32(_v); }
+
+OZZ_INLINE SimdInt4 ShiftL(_SimdInt4 _v, int _bits) {
+  return vshlq_s32(_v, vdupq_n_s32(_bits));
+}
+
+OZZ_INLINE SimdInt4 ShiftR(_SimdInt4 _v, int _bits) {
+  return vshlq_s32(_v, vdupq_n_s32(-_bits));
+}
+
+OZZ_INLINE SimdInt4 ShiftRu(_SimdInt4 _v, int _bits) {
+  return vreinterpretq_s32_u32(
+      vshlq_u32(vreinterpretq_u32_s32(_v), vdupq_n_s32(-_bits)));
+}
+
+OZZ_INLINE SimdInt4 CmpEq(_SimdInt4 _a, _SimdInt4 _b) {
+  return OZZ_NEON_CAST_I(vceqq_s32(_a, _b));
+}
+
+OZZ_INLINE SimdInt4 CmpNe(_SimdInt4 _a, _SimdInt4 _b) {
+  return OZZ_NEON_CAST_I(vmvnq_u32(vceqq_s32(_a, _b)));
+}
+
+OZZ_INLINE SimdInt4 CmpLt(_SimdInt4 _a, _SimdInt4 _b) {
+  return OZZ_NEON_CAST_I(vcltq_s32(_a, _b));
+}
+
+OZZ_INLINE SimdInt4 CmpLe(_SimdInt4 _a, _SimdInt4 _b) {
+  return OZZ_NEON_CAST_I(vcleq_s32(_a, _b));
+}
+
+OZZ_INLINE SimdInt4 CmpGt(_SimdInt4 _a, _SimdInt4 _b) {
+  return OZZ_NEON_CAST_I(vcgtq_s32(_a, _b));
+}
+
+OZZ_INLINE SimdInt4 CmpGe(_SimdInt4 _a, _SimdInt4 _b) {
+  return OZZ_NEON_CAST_I(vcgeq_s32(_a, _b));
+}
+
+OZZ_INLINE Float4x4 Float4x4::identity() {
+  const Float4x4 ret = {{simd_float4::x_axis(), simd_float4::y_axis(),
+                         simd_float4::z_axis(), simd_float4::w_axis()}};
+  return ret;
+}
+
+OZZ_INLINE Float4x4 Transpose(const Float4x4& _m) {
+  Float4x4 ret;
+  Transpose4x4(_m.cols, ret.cols);
+  return ret;
+}
+
+inline Float4x4 Invert(const Float4x4& _m, SimdInt4* _invertible) {
+  const float32x4_t _t0 =
+      vcombine_f32(vget_low_f32(_m.cols[0]), vget_low_f32(_m.cols[1]));
+  const float32x4_t _t1 =
+      vcombine_f32(vget_low_f32(_m.cols[2]), vget_low_f32(_m.cols[3]));
+  const float32x4_t _t2 =
+      vcombine_f32(vget_high_f32(_m.cols[0]), vget_high_f32(_m.cols[1]));
+  const float32x4_t _t3 =
+      vcombine_f32(vget_high_f32(_m.cols[2]), vget_high_f32(_m.cols[3]));
+  const float32x4_t c0 = vuzpq_f32(_t0, _t1).val[0];
+  const float32x4_t c1 = vuzpq_f32(_t1, _t0).val[1];
+  const float32x4_t c2 = vuzpq_f32(_t2, _t3).val[0];
+  const float32x4_t c3 = vuzpq_f32(_t3, _t2).val[1];
+
+  float32x4_t minor0, minor1, minor2, minor3, tmp1, tmp2;
+  tmp1 = vmulq_f32(c2, c3);
+  tmp1 = vrev64q_f32(tmp1);
+  minor0 = vmulq_f32(c1, tmp1);
+  minor1 = vmulq_f32(c0, tmp1);
+  tmp1 = vextq_f32(tmp1, tmp1, 2);
+  minor0 = OZZ_MSUB(c1, tmp1, minor0);
+  minor1 = OZZ_MSUB(c0, tmp1, minor1);
+  minor1 = vextq_f32(minor1, minor1, 2);
+
+  tmp1 = vmulq_f32(c1, c2);
+  tmp1 = vrev64q_f32(tmp1);
+  minor0 = OZZ_MADD(c3, tmp1, minor0);
+  minor3 = vmulq_f32(c0, tmp1);
+  tmp1 = vextq_f32(tmp1, tmp1, 2);
+  minor0 = OZZ_NMADD(c3, tmp1, minor0);
+  minor3 = OZZ_MSUB(c0, tmp1, minor3);
+  minor3 = vextq_f32(minor3, minor3, 2);
+
+  tmp1 = vmulq_f32(vextq_f32(c1, c1, 2), c3);
+  tmp1 = vrev64q_f32(tmp1);
+  tmp2 = vextq_f32(c2, c2, 2);
+  minor0 = OZZ_MADD(tmp2, tmp1, minor0);
+  minor2 = vmulq_f32(c0, tmp1);
+  tmp1 = vextq_f32(tmp1, tmp1, 2);
+  minor0 = OZZ_NMADD(tmp2, tmp1, minor0);
+  minor2 = OZZ_MSUB(c0, tmp1, minor2);
+  minor2 = vextq_f32(minor2, minor2, 2);
+
+  tmp1 = vmulq_f32(c0, c1);
+  tmp1 = vrev64q_f32(tmp1);
+  minor2 = OZZ_MADD(c3, tmp1, minor2);
+  minor3 = OZZ_MSUB(tmp2, tmp1, minor3);
+  tmp1 = vextq_f32(tmp1, tmp1, 2);
+  minor2 = OZZ_MSUB(c3, tmp1, minor2);
+  minor3 = OZZ_NMADD(tmp2, tmp1, minor3);
+
+  tmp1 = vmulq_f32(c0, c3);
+  tmp1 = vrev64q_f32(tmp1);
+  minor1 = OZZ_NMADD(tmp2, tmp1, minor1);
+  minor2 = OZZ_MADD(c1, tmp1, minor2);
+  tmp1 = vextq_f32(tmp1, tmp1, 2);
+  minor1 = OZZ_MADD(tmp2, tmp1, minor1);
+  minor2 = OZZ_NMADD(c1, tmp1, minor2);
+
+  tmp1 = vmulq_f32(c0, tmp2);
+  tmp1 = vrev64q_f32(tmp1);
+  minor1 = OZZ_MADD(c3, tmp1, minor1);
+  minor3 = OZZ_NMADD(c1, tmp1, minor3);
+  tmp1 = vextq_f32(tmp1, tmp1, 2);
+  minor1 = OZZ_NMADD(c3, tmp1, minor1);
+  minor3 = OZZ_MADD(c1, tmp1, minor3);
+
+  // Determinant is summed in all components.
+  float32x4_t det;
+  det = vmulq_f32(c0, minor0);
+  det = vaddq_f32(vextq_f32(det, det, 2), det);
+  det = vaddq_f32(vrev64q_f32(det), det);
+  const SimdInt4 invertible = CmpNe(det, simd_float4::zero());
+  assert((_invertible || AreAllTrue1(invertible)) &&
+         "Matrix is not invertible");
+  if (_invertible != NULL) {
+    *_invertible = invertible;
+  }
+  tmp1 = OZZ_NEON_SELECT_F(invertible, RcpEstNR(det), simd_float4::zero());
+  det = OZZ_NMADD(det, vmulq_f32(tmp1, tmp1), vaddq_f32(tmp1, tmp1));
+
+  // Copy the final columns
+  const Float4x4 ret = {{vmulq_f32(det, minor0), vmulq_f32(det, minor1),
+                         vmulq_f32(det, minor2), vmulq_f32(det, minor3)}};
+  return ret;
+}
+
+Float4x4 Float4x4::Translation(_SimdFloat4 _v) {
+  const Float4x4 ret = {{simd_float4::x_axis(), simd_float4::y_axis(),
+                         simd_float4::z_axis(), vsetq_lane_f32(1.f, _v, 3)}};
+  return ret;
+}
+
+Float4x4 Float4x4::Scaling(_SimdFloat4 _v) {
+  const float32x4_t zero = vdupq_n_f32(0.f);
+  const Float4x4 ret = {{vsetq_lane_f32(vgetq_lane_f32(_v, 0), zero, 0),
+                         vsetq_lane_f32(vgetq_lane_f32(_v, 1), zero, 1),
+                         vsetq_lane_f32(vgetq_lane_f32(_v, 2), zero, 2),
+                         simd_float4::w_axis()}};
+  return ret;
+}
+
+OZZ_INLINE Float4x4 Translate(const Float4x4& _m, _SimdFloat4 _v) {
+  const float32x4_t a01 =
+      OZZ_MADD(_m.cols[0], OZZ_NEON_SPLAT_F(_v, 0),
+               vmulq_f32(_m.cols[1], OZZ_NEON_SPLAT_F(_v, 1)));
+  const float32x4_t m3 =
+      OZZ_MADD(_m.cols[2], OZZ_NEON_SPLAT_F(_v, 2), _m.cols[3]);
+  const Float4x4 ret = {
+      {_m.cols[0], _m.cols[1], _m.cols[2], vaddq_f32(a01, m3)}};
+  return ret;
+}
+
+OZZ_INLINE Float4x4 Scale(const Float4x4& _m, _SimdFloat4 _v) {
+  const Float4x4 ret = {{vmulq_f32(_m.cols[0], OZZ_NEON_SPLAT_F(_v, 0)),
+                         vmulq_f32(_m.cols[1], OZZ_NEON_SPLAT_F(_v, 1)),
+                         vmulq_f32(_m.cols[2], OZZ_NEON_SPLAT_F(_v, 2)),
+                         _m.cols[3]}};
+  return ret;
+}
+
+OZZ_INLINE Float4x4 ColumnMultiply(const Float4x4& _m, _SimdFloat4 _v) {
+  const Float4x4 ret = {{vmulq_f32(_m.cols[0], _v), vmulq_f32(_m.cols[1], _v),
+                         vmulq_f32(_m.cols[2], _v), vmulq_f32(_m.cols[3], _v)}};
+  return ret;
+}
+
+OZZ_INLINE Float4x4 ColumnMultiplyAdd(const Float4x4& _m, _SimdFloat4 _v,
+                                      const Float4x4& _c) {
+  const Float4x4 ret = {{OZZ_MADD(_m.cols[0], _v, _c.cols[0]),
+                         OZZ_MADD(_m.cols[1], _v, _c.cols[1]),
+                         OZZ_MADD(_m.cols[2], _v, _c.cols[2]),
+                         OZZ_MADD(_m.cols[3], _v, _c.cols[3])}};
+  return ret;
+}
+
+inline SimdInt4 IsNormalized(const Float4x4& _m) {
+  const float32x4_t max = vdupq_n_f32(1.f + kNormalizationToleranceSq);
+  const float32x4_t min = vdupq_n_f32(1.f - kNormalizationToleranceSq);
+
+  SimdFloat4 rows[4];
+  Transpose4x4(_m.cols, rows);
+
+  const float32x4_t dot =
+      OZZ_MADD(rows[0], rows[0],
+               OZZ_MADD(rows[1], rows[1], vmulq_f32(rows[2], rows[2])));
+  const uint32x4_t normalized =
+      vandq_u32(vcltq_f32(dot, max), vcgtq_f32(dot, min));
+  return vandq_s32(OZZ_NEON_CAST_I(normalized), simd_int4::mask_fff0());
+}
+
+inline SimdInt4 IsNormalizedEst(const Float4x4& _m) {
+  const float32x4_t max = vdupq_n_f32(1.f + kNormalizationToleranceEstSq);
+  const float32x4_t min = vdupq_n_f32(1.f - kNormalizationToleranceEstSq);
+
+  SimdFloat4 rows[4];
+  Transpose4x4(_m.cols, rows);
+
+  const float32x4_t dot =
+      OZZ_MADD(rows[0], rows[0],
+               OZZ_MADD(rows[1], rows[1], vmulq_f32(rows[2], rows[2])));
+  const uint32x4_t normalized =
+      vandq_u32(vcltq_f32(dot, max), vcgtq_f32(dot, min));
+  return vandq_s32(OZZ_NEON_CAST_I(normalized), simd_int4::mask_fff0());
+}
+
+OZZ_INLINE SimdInt4 IsOrthogonal(const Float4x4& _m) {
+  const float32x4_t zero = vdupq_n_f32(0.f);
+
+  // Use simd_float4::zero() if one of the normalization fails. _m will then be
+  // considered not orthogonal.
+  const SimdFloat4 cross = NormalizeSafe3(Cross3(_m.cols[0], _m.cols[1]), zero);
+  const SimdFloat4 at = NormalizeSafe3(_m.cols[2], zero);
+
+  float32x2_t dot;
+  OZZ_NEON_DOT3_F(cross, at, dot);
+  dot = vset_lane_f32(0.f, dot, 1);
+  return OZZ_NEON_IS_NORMALIZED(dot, 1.f - kNormalizationToleranceSq,
+                                1.f + kNormalizationToleranceSq);
+}
+
+inline SimdFloat4 ToQuaternion(const Float4x4& _m) {
+  assert(AreAllTrue3(IsNormalizedEst(_m)));
+  assert(AreAllTrue1(IsOrthogonal(_m)));
+
+  // Prepares constants.
+  const float32x4_t zero = vdupq_n_f32(0.f);
+  const float32x4_t half = vdupq_n_f32(.5f);
+  const float32x4_t one = vdupq_n_f32(1.f);
+  const SimdInt4 mask_f000 = simd_int4::mask_f000();
+  const SimdInt4 mask_0f00 = simd_int4::mask_0f00();
+  const SimdInt4 mask_00f0 = simd_int4::mask_00f0();
+  const SimdInt4 mask_000f = simd_int4::mask_000f();
+
+  const float32x4_t xx_yy =
+      OZZ_NEON_SELECT_F(mask_0f00, _m.cols[1], _m.cols[0]);
+  const float32x4_t xx_yy_0010 = Swizzle<0, 1, 0, 0>(xx_yy);
+  const float32x4_t xx_yy_zz_xx =
+      OZZ_NEON_SELECT_F(mask_00f0, _m.cols[2], xx_yy_0010);
+  const float32x4_t yy_zz_xx_yy = Swizzle<1, 2, 0, 1>(xx_yy_zz_xx);
+  const float32x4_t zz_xx_yy_zz = Swizzle<2, 0, 1, 2>(xx_yy_zz_xx);
+
+  const float32x4_t diag_sum =
+      vaddq_f32(vaddq_f32(xx_yy_zz_xx, yy_zz_xx_yy), zz_xx_yy_zz);
+  const float32x4_t diag_diff =
+      vsubq_f32(vsubq_f32(xx_yy_zz_xx, yy_zz_xx_yy), zz_xx_yy_zz);
+  const float32x4_t radicand =
+      vaddq_f32(OZZ_NEON_SELECT_F(mask_000f, diag_sum, diag_diff), one);
+  const float32x4_t invSqrt = OZZ_NEON_DIV(one, Sqrt(radicand));
+
+  float32x4_t zy_xz_yx = OZZ_NEON_SELECT_F(mask_00f0, _m.cols[1], _m.cols[0]);
+  zy_xz_yx = Swizzle<2, 2, 1, 0>(zy_xz_yx);
+  zy_xz_yx =
+      OZZ_NEON_SELECT_F(mask_0f00, OZZ_NEON_SPLAT_F(_m.cols[2], 0), zy_xz_yx);
+  float32x4_t yz_zx_xy = OZZ_NEON_SELECT_F(mask_f000, _m.cols[1], _m.cols[0]);
+  yz_zx_xy = Swizzle<0, 2, 0, 0>(yz_zx_xy);
+  yz_zx_xy =
+      OZZ_NEON_SELECT_F(mask_f000, OZZ_NEON_SPLAT_F(_m.cols[2], 1), yz_zx_xy);
+  const float32x4_t sum = vaddq_f32(zy_xz_yx, yz_zx_xy);
+  const float32x4_t diff = vsubq_f32(zy_xz_yx, yz_zx_xy);
+  const float32x4_t scale = vmulq_f32(invSqrt, half);
+
+  const float32x4_t sum0 = Swizzle<0, 2, 1, 0>(sum);
+  const float32x4_t sum1 = Swizzle<2, 0, 0, 0>(sum);
+  const float32x4_t sum2 = Swizzle<1, 0, 0, 0>(sum);
+  float32x4_t res0 =
+      OZZ_NEON_SELECT_F(mask_000f, OZZ_NEON_SPLAT_F(diff, 0), sum0);
+  float32x4_t res1 =
+      OZZ_NEON_SELECT_F(mask_000f, OZZ_NEON_SPLAT_F(diff, 1), sum1);
+  float32x4_t res2 =
+      OZZ_NEON_SELECT_F(mask_000f, OZZ_NEON_SPLAT_F(diff, 2), sum2);
+  res0 = vmulq_f32(OZZ_NEON_SELECT_F(mask_f000, radicand, res0),
+                   OZZ_NEON_SPLAT_F(scale, 0));
+  res1 = vmulq_f32(OZZ_NEON_SELECT_F(mask_0f00, radicand, res1),
+                   OZZ_NEON_SPLAT_F(scale, 1));
+  res2 = vmulq_f32(OZZ_NEON_SELECT_F(mask_00f0, radicand, res2),
+                   OZZ_NEON_SPLAT_F(scale, 2));
+  const float32x4_t res3 =
+      vmulq_f32(OZZ_NEON_SELECT_F(mask_000f, radicand, diff),
+                OZZ_NEON_SPLAT_F(scale, 3));
+
+  const float32x4_t xx = OZZ_NEON_SPLAT_F(_m.cols[0], 0);
+  const float32x4_t yy = OZZ_NEON_SPLAT_F(_m.cols[1], 1);
+  const float32x4_t zz = OZZ_NEON_SPLAT_F(_m.cols[2], 2);
+  const uint32x4_t cond0 = vcgtq_f32(yy, xx);
+  const uint32x4_t cond1 = vandq_u32(vcgtq_f32(zz, xx), vcgtq_f32(zz, yy));
+  const uint32x4_t cond2 =
+      vcgtq_f32(OZZ_NEON_SPLAT_F(diag_sum, 0), zero);
+  float32x4_t res = vbslq_f32(cond0, res1, res0);
+  res = vbslq_f32(cond1, res2, res);
+  res = vbslq_f32(cond2, res3, res);
+
+  assert(AreAllTrue1(IsNormalizedEst4(res)));
+  return res;
+}
+
+inline bool ToAffine(const Float4x4& _m, SimdFloat4* _translation,
+                     SimdFloat4* _quaternion, SimdFloat4* _scale) {
+  const float32x4_t zero = vdupq_n_f32(0.f);
+  const float32x4_t one = vdupq_n_f32(1.f);
+  const SimdInt4 fff0 = simd_int4::mask_fff0();
+  const float32x4_t max = vdupq_n_f32(kOrthogonalisationToleranceSq);
+  const float32x4_t min = vdupq_n_f32(-kOrthogonalisationToleranceSq);
+
+  // Extracts translation.
+  *_translation = vsetq_lane_f32(1.f, _m.cols[3], 3);
+
+  // Extracts scale.
+  SimdFloat4 m_rows[4];
+  Transpose4x4(_m.cols, m_rows);
+
+  const float32x4_t dot =
+      OZZ_MADD(m_rows[0], m_rows[0],
+               OZZ_MADD(m_rows[1], m_rows[1], vmulq_f32(m_rows[2], m_rows[2])));
+  const float32x4_t abs_scale = Sqrt(dot);
+
+  const SimdInt4 zero_axis =
+      OZZ_NEON_CAST_I(vandq_u32(vcltq_f32(dot, max), vcgtq_f32(dot, min)));
+
+  // Builds an orthonormal matrix in order to support quaternion extraction.
+  Float4x4 orthonormal;
+  int mask = MoveMask(zero_axis);
+  if (mask & 1) {
+    if (mask & 6) {
+      return false;
+    }
+    orthonormal.cols[1] =
+        OZZ_NEON_DIV(_m.cols[1], OZZ_NEON_SPLAT_F(abs_scale, 1));
+    orthonormal.cols[0] = Normalize3(Cross3(orthonormal.cols[1], _m.cols[2]));
+    orthonormal.cols[2] =
+        Normalize3(Cross3(orthonormal.cols[0], orthonormal.cols[1]));
+  } else if (mask & 4) {
+    if (mask & 3) {
+      return false;
+    }
+    orthonormal.cols[0] =
+        OZZ_NEON_DIV(_m.cols[0], OZZ_NEON_SPLAT_F(abs_scale, 0));
+    orthonormal.cols[2] = Normalize3(Cross3(orthonormal.cols[0], _m.cols[1]));
+    orthonormal.cols[1] =
+        Normalize3(Cross3(orthonormal.cols[2], orthonormal.cols[0]));
+  } else {  // Favor z axis in the default case
+    if (mask & 5) {
+      return false;
+    }
+    orthonormal.cols[2] =
+        OZZ_NEON_DIV(_m.cols[2], OZZ_NEON_SPLAT_F(abs_scale, 2));
+    orthonormal.cols[1] = Normalize3(Cross3(orthonormal.cols[2], _m.cols[0]));
+    orthonormal.cols[0] =
+        Normalize3(Cross3(orthonormal.cols[1], orthonormal.cols[2]));
+  }
+  orthonormal.cols[3] = simd_float4::w_axis();
+
+  // Get back scale signs in case of reflexions
+  SimdFloat4 o_rows[4];
+  Transpose4x4(orthonormal.cols, o_rows);
+
+  const float32x4_t scale_dot =
+      OZZ_MADD(o_rows[0], m_rows[0],
+               OZZ_MADD(o_rows[1], m_rows[1], vmulq_f32(o_rows[2], m_rows[2])));
+
+  const uint32x4_t cond = vcgtq_f32(scale_dot, zero);
+  const float32x4_t cfalse = vnegq_f32(abs_scale);
+  const float32x4_t scale = vbslq_f32(cond, abs_scale, cfalse);
+  *_scale = OZZ_NEON_SELECT_F(fff0, scale, one);
+
+  // Extracts quaternion.
+  *_quaternion = ToQuaternion(orthonormal);
+  return true;
+}
+
+inline Float4x4 Float4x4::FromEuler(_SimdFloat4 _v) {
+  const float32x4_t cos = Cos(_v);
+  const float32x4_t sin = Sin(_v);
+
+  const float cx = GetX(cos);
+  const float sx = GetX(sin);
+  const float cy = GetY(cos);
+  const float sy = GetY(sin);
+  const float cz = GetZ(cos);
+  const float sz = GetZ(sin);
+
+  const float sycz = sy * cz;
+  const float sysz = sy * sz;
+
+  const Float4x4 ret = {{simd_float4::Load(cx * cy, sx * sz - cx * sycz,
+                                           cx * sysz + sx * cz, 0.f),
+                         simd_float4::Load(sy, cy * cz, -cy * sz, 0.f),
+                         simd_float4::Load(-sx * cy, sx * sycz + cx * sz,
+                                           -sx * sysz + cx * cz, 0.f),
+                         simd_float4::w_axis()}};
+  return ret;
+}
+
+inline Float4x4 Float4x4::FromAxisAngle(_SimdFloat4 _axis, _SimdFloat4 _angle) {
+  assert(AreAllTrue1(IsNormalizedEst3(_axis)));
+
+  const float32x4_t one = vdupq_n_f32(1.f);
+
+  const float32x4_t sin = SplatX(SinX(_angle));
+  const float32x4_t cos = SplatX(CosX(_angle));
+  const float32x4_t one_minus_cos = vsubq_f32(one, cos);
+
+  const float32x4_t v0 =
+      vmulq_f32(vmulq_f32(one_minus_cos, Swizzle<1, 2, 0, 3>(_axis)),
+                Swizzle<2, 0, 1, 3>(_axis));
+  const float32x4_t r0 =
+      vaddq_f32(vmulq_f32(vmulq_f32(one_minus_cos, _axis), _axis), cos);
+  const float32x4_t r1 = vaddq_f32(vmulq_f32(sin, _axis), v0);
+  const float32x4_t r2 = vsubq_f32(v0, vmulq_f32(sin, _axis));
+  const float32x4_t r0fff0 = vsetq_lane_f32(0.f, r0, 3);
+  const float32x4_t r1r22120 = OZZ_NEON_SHUFFLE_F(r1, r2, 0, 2, 1, 2);
+  const float32x4_t v1 = Swizzle<1, 2, 3, 0>(r1r22120);
+  const float32x4_t r1r20011 = OZZ_NEON_SHUFFLE_F(r1, r2, 1, 1, 0, 0);
+  const float32x4_t v2 = Swizzle<0, 2, 0, 2>(r1r20011);
+
+  const float32x4_t t0 = OZZ_NEON_SHUFFLE_F(r0fff0, v1, 0, 3, 0, 1);
+  const float32x4_t t1 = OZZ_NEON_SHUFFLE_F(r0fff0, v1, 1, 3, 2, 3);
+  const Float4x4 ret = {
+      {Swizzle<0, 2, 3, 1>(t0), Swizzle<2, 0, 3, 1>(t1),
+       vcombine_f32(vget_low_f32(v2), vget_high_f32(r0fff0)),
+       simd_float4::w_axis()}};
+  return ret;
+}
+
+inline Float4x4 Float4x4::FromQuaternion(_SimdFloat4 _quaternion) {
+  assert(AreAllTrue1(IsNormalizedEst4(_quaternion)));
+
+  const SimdInt4 fff0 = simd_int4::mask_fff0();
+  const float32x4_t c1110 = vsetq_lane_f32(0.f, vdupq_n_f32(1.f), 3);
+
+  const float32x4_t vsum = vaddq_f32(_quaternion, _quaternion);
+  const float32x4_t vms = vmulq_f32(_quaternion, vsum);
+
+  const float32x4_t r0 =
+      vsubq_f32(vsubq_f32(c1110, And(Swizzle<1, 0, 0, 3>(vms), fff0)),
+                And(Swizzle<2, 2, 1, 3>(vms), fff0));
+  const float32x4_t v0 = vmulq_f32(Swizzle<0, 0, 1, 3>(_quaternion),
+                                   Swizzle<2, 1, 2, 3>(vsum));
+  const float32x4_t v1 = vmulq_f32(Swizzle<3, 3, 3, 3>(_quaternion),
+                                   Swizzle<1, 2, 0, 3>(vsum));
+
+  const float32x4_t r1 = vaddq_f32(v0, v1);
+  const float32x4_t r2 = vsubq_f32(v0, v1);
+
+  const float32x4_t r1r21021 = OZZ_NEON_SHUFFLE_F(r1, r2, 1, 2, 0, 1);
+  const float32x4_t v2 = Swizzle<0, 2, 3, 1>(r1r21021);
+  const float32x4_t r1r22200 = OZZ_NEON_SHUFFLE_F(r1, r2, 0, 0, 2, 2);
+  const float32x4_t v3 = Swizzle<0, 2, 0, 2>(r1r22200);
+
+  const float32x4_t q0 = OZZ_NEON_SHUFFLE_F(r0, v2, 0, 3, 0, 1);
+  const float32x4_t q1 = OZZ_NEON_SHUFFLE_F(r0, v2, 1, 3, 2, 3);
+  const Float4x4 ret = {{Swizzle<0, 2, 3, 1>(q0), Swizzle<2, 0, 3, 1>(q1),
+                         vcombine_f32(vget_low_f32(v3), vget_high_f32(r0)),
+                         simd_float4::w_axis()}};
+  return ret;
+}
+
+inline Float4x4 Float4x4::FromAffine(_SimdFloat4 _translation,
+                                     _SimdFloat4 _quaternion,
+                                     _SimdFloat4 _scale) {
+  assert(AreAllTrue1(IsNormalizedEst4(_quaternion)));
+
+  const SimdInt4 fff0 = simd_int4::mask_fff0();
+  const float32x4_t c1110 = vsetq_lane_f32(0.f, vdupq_n_f32(1.f), 3);
+
+  const float32x4_t vsum = vaddq_f32(_quaternion, _quaternion);
+  const float32x4_t vms = vmulq_f32(_quaternion, vsum);
+
+  const float32x4_t r0 =
+      vsubq_f32(vsubq_f32(c1110, And(Swizzle<1, 0, 0, 3>(vms), fff0)),
+                And(Swizzle<2, 2, 1, 3>(vms), fff0));
+  const float32x4_t v0 = vmulq_f32(Swizzle<0, 0, 1, 3>(_quaternion),
+                                   Swizzle<2, 1, 2, 3>(vsum));
+  const float32x4_t v1 = vmulq_f32(Swizzle<3, 3, 3, 3>(_quaternion),
+                                   Swizzle<1, 2, 0, 3>(vsum));
+
+  const float32x4_t r1 = vaddq_f32(v0, v1);
+  const float32x4_t r2 = vsubq_f32(v0, v1);
+
+  const float32x4_t r1r21021 = OZZ_NEON_SHUFFLE_F(r1, r2, 1, 2, 0, 1);
+  const float32x4_t v2 = Swizzle<0, 2, 3, 1>(r1r21021);
+  const float32x4_t r1r22200 = OZZ_NEON_SHUFFLE_F(r1, r2, 0, 0, 2, 2);
+  const float32x4_t v3 = Swizzle<0, 2, 0, 2>(r1r22200);
+
+  const float32x4_t q0 = OZZ_NEON_SHUFFLE_F(r0, v2, 0, 3, 0, 1);
+  const float32x4_t q1 = OZZ_NEON_SHUFFLE_F(r0, v2, 1, 3, 2, 3);
+
+  const Float4x4 ret = {
+      {vmulq_f32(Swizzle<0, 2, 3, 1>(q0), OZZ_NEON_SPLAT_F(_scale, 0)),
+       vmulq_f32(Swizzle<2, 0, 3, 1>(q1), OZZ_NEON_SPLAT_F(_scale, 1)),
+       vmulq_f32(vcombine_f32(vget_low_f32(v3), vget_high_f32(r0)),
+                 OZZ_NEON_SPLAT_F(_scale, 2)),
+       vsetq_lane_f32(1.f, _translation, 3)}};
+  return ret;
+}
+
+OZZ_INLINE ozz::math::SimdFloat4 TransformPoint(const ozz::math::Float4x4& _m,
+                                                ozz::math::_SimdFloat4 _v) {
+  const float32x4_t xxxx = vmulq_f32(OZZ_NEON_SPLAT_F(_v, 0), _m.cols[0]);
+  const float32x4_t a23 =
+      OZZ_MADD(OZZ_NEON_SPLAT_F(_v, 2), _m.cols[2], _m.cols[3]);
+  const float32x4_t a01 = OZZ_MADD(OZZ_NEON_SPLAT_F(_v, 1), _m.cols[1], xxxx);
+  return vaddq_f32(a01, a23);
+}
+
+OZZ_INLINE ozz::math::SimdFloat4 TransformVector(const ozz::math::Float4x4& _m,
+                                                 ozz::math::_SimdFloat4 _v) {
+  const float32x4_t xxxx = vmulq_f32(_m.cols[0], OZZ_NEON_SPLAT_F(_v, 0));
+  const float32x4_t zzzz = vmulq_f32(_m.cols[1], OZZ_NEON_SPLAT_F(_v, 1));
+  const float32x4_t a21 = OZZ_MADD(_m.cols[2], OZZ_NEON_SPLAT_F(_v, 2), xxxx);
+  return vaddq_f32(zzzz, a21);
+}
+
+OZZ_INLINE ozz::math::SimdFloat4 operator*(const ozz::math::Float4x4& _m,
+                                           ozz::math::_SimdFloat4 _v) {
+  const float32x4_t xxxx = vmulq_f32(OZZ_NEON_SPLAT_F(_v, 0), _m.cols[0]);
+  const float32x4_t zzzz = vmulq_f32(OZZ_NEON_SPLAT_F(_v, 2), _m.cols[2]);
+  const float32x4_t a01 = OZZ_MADD(OZZ_NEON_SPLAT_F(_v, 1), _m.cols[1], xxxx);
+  const float32x4_t a23 = OZZ_MADD(OZZ_NEON_SPLAT_F(_v, 3), _m.cols[3], zzzz);
+  return vaddq_f32(a01, a23);
+}
+
+inline ozz::math::Float4x4 operator*(const ozz::math::Float4x4& _a,
+                                     const ozz::math::Float4x4& _b) {
+  ozz::math::Float4x4 ret;
+  for (int i = 0; i < 4; ++i) {
+    const float32x4_t col = _b.cols[i];
+    const float32x4_t xxxx = vmulq_f32(OZZ_NEON_SPLAT_F(col, 0), _a.cols[0]);
+    const float32x4_t zzzz = vmulq_f32(OZZ_NEON_SPLAT_F(col, 2), _a.cols[2]);
+    const float32x4_t a01 =
+        OZZ_MADD(OZZ_NEON_SPLAT_F(col, 1), _a.cols[1], xxxx);
+    const float32x4_t a23 =
+        OZZ_MADD(OZZ_NEON_SPLAT_F(col, 3), _a.cols[3], zzzz);
+    ret.cols[i] = vaddq_f32(a01, a23);
+  }
+  return ret;
+}
+
+OZZ_INLINE ozz::math::Float4x4 operator+(const ozz::math::Float4x4& _a,
+                                         const ozz::math::Float4x4& _b) {
+  const ozz::math::Float4x4 ret = {
+      {vaddq_f32(_a.cols[0], _b.cols[0]), vaddq_f32(_a.cols[1], _b.cols[1]),
+       vaddq_f32(_a.cols[2], _b.cols[2]), vaddq_f32(_a.cols[3], _b.cols[3])}};
+  return ret;
+}
+
+OZZ_INLINE ozz::math::Float4x4 operator-(const ozz::math::Float4x4& _a,
+                                         const ozz::math::Float4x4& _b) {
+  const ozz::math::Float4x4 ret = {
+      {vsubq_f32(_a.cols[0], _b.cols[0]), vsubq_f32(_a.cols[1], _b.cols[1]),
+       vsubq_f32(_a.cols[2], _b.cols[2]), vsubq_f32(_a.cols[3], _b.cols[3])}};
+  return ret;
+}
+}  // namespace math
+}  // namespace ozz
+
+#if !defined(__GNUC__)
+OZZ_INLINE ozz::math::SimdFloat4 operator+(ozz::math::_SimdFloat4 _a,
+                                           ozz::math::_SimdFloat4 _b) {
+  return vaddq_f32(_a, _b);
+}
+
+OZZ_INLINE ozz::math::SimdFloat4 operator-(ozz::math::_SimdFloat4 _a,
+                                           ozz::math::_SimdFloat4 _b) {
+  return vsubq_f32(_a, _b);
+}
+
+OZZ_INLINE ozz::math::SimdFloat4 operator-(ozz::math::_SimdFloat4 _v) {
+  return vnegq_f32(_v);
+}
+
+OZZ_INLINE ozz::math::SimdFloat4 operator*(ozz::math::_SimdFloat4 _a,
+                                           ozz::math::_SimdFloat4 _b) {
+  return vmulq_f32(_a, _b);
+}
+
+OZZ_INLINE ozz::math::SimdFloat4 operator/(ozz::math::_SimdFloat4 _a,
+                                           ozz::math::_SimdFloat4 _b) {
+  using ozz::math::RcpEstNR;
+  return OZZ_NEON_DIV(_a, _b);
+}
+#endif  // !defined(__GNUC__)
+
+namespace ozz {
+namespace math {
+OZZ_INLINE uint16_t FloatToHalf(float _f) {
+  const int h = vgetq_lane_s32(FloatToHalf(vdupq_n_f32(_f)), 0);
+  return static_cast<uint16_t>(h);
+}
+
+OZZ_INLINE float HalfToFloat(uint16_t _h) {
+  return vgetq_lane_f32(HalfToFloat(vdupq_n_s32(_h)), 0);
+}
+
+// Half <-> Float implementation is based on:
+// http://fgiesen.wordpress.com/2012/03/28/half-to-float-done-quic/.
+// Note that ARMv7 NEON flushes denormals to zero, so do half denormals.
+inline SimdInt4 FloatToHalf(_SimdFloat4 _f) {
+  const uint32x4_t mask_sign = vdupq_n_u32(0x80000000u);
+  const uint32x4_t mask_round = vdupq_n_u32(~0xfffu);
+  const int32x4_t f32infty = vdupq_n_s32(255 << 23);
+  const float32x4_t magic = vreinterpretq_f32_s32(vdupq_n_s32(15 << 23));
+  const int32x4_t nanbit = vdupq_n_s32(0x200);
+  const int32x4_t infty_as_fp16 = vdupq_n_s32(0x7c00);
+  const float32x4_t clamp =
+      vreinterpretq_f32_s32(vdupq_n_s32((31 << 23) - 0x1000));
+
+  const uint32x4_t f = vreinterpretq_u32_f32(_f);
+  const uint32x4_t justsign = vandq_u32(mask_sign, f);
+  const uint32x4_t absf = veorq_u32(f, justsign);
+  const int32x4_t absf_int = vreinterpretq_s32_u32(absf);
+  const uint32x4_t b_isnan = vcgtq_s32(absf_int, f32infty);
+  const int32x4_t b_isnormal = OZZ_NEON_CAST_I(vcgtq_s32(f32infty, absf_int));
+  const int32x4_t inf_or_nan =
+      vorrq_s32(vandq_s32(OZZ_NEON_CAST_I(b_isnan), nanbit), infty_as_fp16);
+  const float32x4_t fnosticky =
+      vreinterpretq_f32_u32(vandq_u32(absf, mask_round));
+  const float32x4_t scaled = vmulq_f32(fnosticky, magic);
+  // Logically, we want PMINSD on "biased", but this should gen better code
+  const float32x4_t clamped = vminq_f32(scaled, clamp);
+  const int32x4_t biased = vsubq_s32(vreinterpretq_s32_f32(clamped),
+                                     vreinterpretq_s32_u32(mask_round));
+  const int32x4_t shifted =
+      vreinterpretq_s32_u32(vshrq_n_u32(vreinterpretq_u32_s32(biased), 13));
+  const int32x4_t normal = vandq_s32(shifted, b_isnormal);
+  const int32x4_t not_normal = vbicq_s32(inf_or_nan, b_isnormal);
+  const int32x4_t joined = vorrq_s32(normal, not_normal);
+
+  const int32x4_t sign_shift = vreinterpretq_s32_u32(vshrq_n_u32(justsign, 16));
+  return vorrq_s32(joined, sign_shift);
+}
+
+OZZ_INLINE SimdFloat4 HalfToFloat(_SimdInt4 _h) {
+  const int32x4_t mask_nosign = vdupq_n_s32(0x7fff);
+  const float32x4_t magic =
+      vreinterpretq_f32_s32(vdupq_n_s32((254 - 15) << 23));
+  const int32x4_t was_infnan = vdupq_n_s32(0x7bff);
+  const uint32x4_t exp_infnan = vdupq_n_u32(255 << 23);
+
+  const int32x4_t expmant = vandq_s32(mask_nosign, _h);
+  const int32x4_t shifted = vshlq_n_s32(expmant, 13);
+  const float32x4_t scaled =
+      vmulq_f32(vreinterpretq_f32_s32(shifted), magic);
+  const uint32x4_t b_wasinfnan = vcgtq_s32(expmant, was_infnan);
+  const uint32x4_t sign =
+      vreinterpretq_u32_s32(vshlq_n_s32(veorq_s32(_h, expmant), 16));
+  const uint32x4_t infnanexp = vandq_u32(b_wasinfnan, exp_infnan);
+  const uint32x4_t sign_inf = vorrq_u32(sign, infnanexp);
+  return vreinterpretq_f32_u32(
+      vorrq_u32(vreinterpretq_u32_f32(scaled), sign_inf));
+}
+}  // namespace math
+}  // namespace ozz
+
+#undef OZZ_NEON_SPLAT_F
+#undef OZZ_NEON_SPLAT_I
+#undef OZZ_NEON_SHUFFLE_F
+#undef OZZ_NEON_HADD2_F
+#undef OZZ_NEON_HADD3_F
+#undef OZZ_NEON_HADD4_F
+#undef OZZ_NEON_DOT2_F
+#undef OZZ_NEON_DOT3_F
+#undef OZZ_NEON_DOT4_F
+#undef OZZ_MADD
+#undef OZZ_MSUB
+#undef OZZ_NMADD
+#undef OZZ_NMSUB
+#undef OZZ_NEON_DIV
+#undef OZZ_NEON_SELECT_F
+#undef OZZ_NEON_SELECT_I
+#undef OZZ_NEON_CAST_I
+#undef OZZ_NEON_IS_NORMALIZED
+#endif  // OZZ_OZZ_BASE_MATHS_INTERNAL_SIMD_MATH_NEON_INL_H_
@@ -53,6 +53,24 @@ union SimdIF4 {
 };
 }  // namespace internal
 
+#if defined(OZZ_SIMD_DETERMINISTIC)
+// Deterministic mode doesn't use estimations, as simd implementations
+// estimations precision differs from a cpu to another. IEEE correctly rounded
+// division and square root are used instead.
+#define OZZ_RCP_EST(_in, _out) \
+  do {                         \
+    _out = 1.f / (_in);        \
+  } while (void(0), 0)
+
+#define OZZ_RCP_EST_NR(_in, _out) OZZ_RCP_EST(_in, _out)
+
+#define OZZ_RSQRT_EST(_in, _out) \
+  do {                           \
+    _out = 1.f / std::sqrt(_in); \
+  } while (void(0), 0)
+
+#define OZZ_RSQRT_EST_NR(_in, _out) OZZ_RSQRT_EST(_in, _out)
+#else  // OZZ_SIMD_DETERMINISTIC
 #define OZZ_RCP_EST(_in, _out)                 \
   do {                                         \
     const float in = _in;                      \
@@ -96,6 +114,7 @@ union SimdIF4 {
     OZZ_RSQRT_EST(_in, fp2);                       \
     _out = fp2 * (1.5f - (_in * .5f * fp2 * fp2)); \
   } while (void(0), 0)
+#endif  // OZZ_SIMD_DETERMINISTIC
 
 namespace simd_float4 {
 
@@ -460,7 +479,7 @@ OZZ_INLINE SimdFloat4 HAdd3(_SimdFloat4 _v) {
 }
 
 OZZ_INLINE SimdFloat4 HAdd4(_SimdFloat4 _v) {
-  const SimdFloat4 ret = {_v.x + _v.y + _v.z + _v.w, _v.x, _v.x, _v.x};
+  const SimdFloat4 ret = {(_v.x + _v.z) + (_v.y + _v.w), _v.x, _v.x, _v.x};
   return ret;
 }
 
@@ -476,8 +495,9 @@ OZZ_INLINE SimdFloat4 Dot3(_SimdFloat4 _a, _SimdFloat4 _b) {
 }
 
 OZZ_INLINE SimdFloat4 Dot4(_SimdFloat4 _a, _SimdFloat4 _b) {
-  const SimdFloat4 ret = {_a.x * _b.x + _a.y * _b.y + _a.z * _b.z + _a.w * _b.w,
-                          _a.x, _a.x, _a.x};
+  const SimdFloat4 ret = {
+      (_a.x * _b.x + _a.z * _b.z) + (_a.y * _b.y + _a.w * _b.w), _a.x, _a.x,
+      _a.x};
   return ret;
 }
 
@@ -598,7 +618,8 @@ OZZ_INLINE SimdFloat4 Length3(_SimdFloat4 _v) {
 }
 
 OZZ_INLINE SimdFloat4 Length4(_SimdFloat4 _v) {
-  const float sq_len = _v.x * _v.x + _v.y * _v.y + _v.z * _v.z + _v.w * _v.w;
+  const float sq_len =
+      (_v.x * _v.x + _v.z * _v.z) + (_v.y * _v.y + _v.w * _v.w);
   const SimdFloat4 ret = {std::sqrt(sq_len), _v.x, _v.x, _v.x};
   return ret;
 }
@@ -616,7 +637,8 @@ OZZ_INLINE SimdFloat4 Length3Sqr(_SimdFloat4 _v) {
 }
 
 OZZ_INLINE SimdFloat4 Length4Sqr(_SimdFloat4 _v) {
-  const float sq_len = _v.x * _v.x + _v.y * _v.y + _v.z * _v.z + _v.w * _v.w;
+  const float sq_len =
+      (_v.x * _v.x + _v.z * _v.z) + (_v.y * _v.y + _v.w * _v.w);
   const SimdFloat4 ret = {sq_len, _v.x, _v.x, _v.x};
   return ret;
 }
@@ -638,7 +660,8 @@ OZZ_INLINE SimdFloat4 Normalize3(_SimdFloat4 _v) {
 }
 
 OZZ_INLINE SimdFloat4 Normalize4(_SimdFloat4 _v) {
-  const float sq_len = _v.x * _v.x + _v.y * _v.y + _v.z * _v.z + _v.w * _v.w;
+  const float sq_len =
+      (_v.x * _v.x + _v.z * _v.z) + (_v.y * _v.y + _v.w * _v.w);
   assert(sq_len != 0.f && "_v is not normalizable");
   const float inv_len = 1.f / std::sqrt(sq_len);
   const SimdFloat4 ret = {_v.x * inv_len, _v.y * inv_len, _v.z * inv_len,
@@ -665,7 +688,8 @@ OZZ_INLINE SimdFloat4 NormalizeEst3(_SimdFloat4 _v) {
 }
 
 OZZ_INLINE SimdFloat4 NormalizeEst4(_SimdFloat4 _v) {
-  const float sq_len = _v.x * _v.x + _v.y * _v.y + _v.z * _v.z + _v.w * _v.w;
+  const float sq_len =
+      (_v.x * _v.x + _v.z * _v.z) + (_v.y * _v.y + _v.w * _v.w);
   assert(sq_len != 0.f && "_v is not normalizable");
   float inv_len;
   OZZ_RSQRT_EST(sq_len, inv_len);
@@ -689,7 +713,8 @@ OZZ_INLINE SimdInt4 IsNormalized3(_SimdFloat4 _v) {
 }
 
 OZZ_INLINE SimdInt4 IsNormalized4(_SimdFloat4 _v) {
-  const float sq_len = _v.x * _v.x + _v.y * _v.y + _v.z * _v.z + _v.w * _v.w;
+  const float sq_len =
+      (_v.x * _v.x + _v.z * _v.z) + (_v.y * _v.y + _v.w * _v.w);
   const bool normalized = std::abs(sq_len - 1.f) < kNormalizationToleranceSq;
   const SimdInt4 ret = {-static_cast<int>(normalized), 0, 0, 0};
   return ret;
@@ -710,7 +735,8 @@ OZZ_INLINE SimdInt4 IsNormalizedEst3(_SimdFloat4 _v) {
 }
 
 OZZ_INLINE SimdInt4 IsNormalizedEst4(_SimdFloat4 _v) {
-  const float sq_len = _v.x * _v.x + _v.y * _v.y + _v.z * _v.z + _v.w * _v.w;
+  const float sq_len =
+      (_v.x * _v.x + _v.z * _v.z) + (_v.y * _v.y + _v.w * _v.w);
   const bool normalized = std::abs(sq_len - 1.f) < kNormalizationToleranceEstSq;
   const SimdInt4 ret = {-static_cast<int>(normalized), 0, 0, 0};
   return ret;
@@ -742,7 +768,8 @@ OZZ_INLINE SimdFloat4 NormalizeSafe3(_SimdFloat4 _v, _SimdFloat4 _safe) {
 
 OZZ_INLINE SimdFloat4 NormalizeSafe4(_SimdFloat4 _v, _SimdFloat4 _safe) {
   // assert(AreAllTrue1(IsNormalized4(_safe)) && "_safe is not normalized");
-  const float sq_len = _v.x * _v.x + _v.y * _v.y + _v.z * _v.z + _v.w * _v.w;
+  const float sq_len =
+      (_v.x * _v.x + _v.z * _v.z) + (_v.y * _v.y + _v.w * _v.w);
   if (sq_len == 0.f) {
     return _safe;
   }
@@ -780,7 +807,8 @@ OZZ_INLINE SimdFloat4 NormalizeSafeEst3(_SimdFloat4 _v, _SimdFloat4 _safe) {
 
 OZZ_INLINE SimdFloat4 NormalizeSafeEst4(_SimdFloat4 _v, _SimdFloat4 _safe) {
   // assert(AreAllTrue1(IsNormalizedEst4(_safe)) && "_safe is not normalized");
-  const float sq_len = _v.x * _v.x + _v.y * _v.y + _v.z * _v.z + _v.w * _v.w;
+  const float sq_len =
+      (_v.x * _v.x + _v.z * _v.z) + (_v.y * _v.y + _v.w * _v.w);
   if (sq_len == 0.f) {
     return _safe;
   }
@@ -1680,6 +1708,14 @@ OZZ_INLINE Float4x4 ColumnMultiply(const Float4x4& _m, _SimdFloat4 _v) {
   return ret;
 }
 
+OZZ_INLINE Float4x4 ColumnMultiplyAdd(const Float4x4& _m, _SimdFloat4 _v,
+                                      const Float4x4& _c) {
+  const Float4x4 ret = {
+      {MAdd(_m.cols[0], _v, _c.cols[0]), MAdd(_m.cols[1], _v, _c.cols[1]),
+       MAdd(_m.cols[2], _v, _c.cols[2]), MAdd(_m.cols[3], _v, _c.cols[3])}};
+  return ret;
+}
+
 OZZ_INLINE SimdInt4 IsNormalized(const Float4x4& _m) {
   const SimdInt4 ret = {IsNormalized3(_m.cols[0]).x,
                         IsNormalized3(_m.cols[1]).x,
@@ -1907,38 +1943,39 @@ OZZ_INLINE Float4x4 Float4x4::FromAffine(_SimdFloat4 _translation,
 
 OZZ_INLINE ozz::math::SimdFloat4 TransformPoint(const ozz::math::Float4x4& _m,
                                                 ozz::math::_SimdFloat4 _v) {
-  const ozz::math::SimdFloat4 ret = {_m.cols[0].x * _v.x + _m.cols[1].x * _v.y +
-                                         _m.cols[2].x * _v.z + _m.cols[3].x,
-                                     _m.cols[0].y * _v.x + _m.cols[1].y * _v.y +
-                                         _m.cols[2].y * _v.z + _m.cols[3].y,
-                                     _m.cols[0].z * _v.x + _m.cols[1].z * _v.y +
-                                         _m.cols[2].z * _v.z + _m.cols[3].z,
-                                     _m.cols[0].w * _v.x + _m.cols[1].w * _v.y +
-                                         _m.cols[2].w * _v.z + _m.cols[3].w};
+  const ozz::math::SimdFloat4 ret = {
+      (_m.cols[0].x * _v.x + _m.cols[1].x * _v.y) +
+          (_m.cols[2].x * _v.z + _m.cols[3].x),
+      (_m.cols[0].y * _v.x + _m.cols[1].y * _v.y) +
+          (_m.cols[2].y * _v.z + _m.cols[3].y),
+      (_m.cols[0].z * _v.x + _m.cols[1].z * _v.y) +
+          (_m.cols[2].z * _v.z + _m.cols[3].z),
+      (_m.cols[0].w * _v.x + _m.cols[1].w * _v.y) +
+          (_m.cols[2].w * _v.z + _m.cols[3].w)};
   return ret;
 }
 
 OZZ_INLINE ozz::math::SimdFloat4 TransformVector(const ozz::math::Float4x4& _m,
                                                  ozz::math::_SimdFloat4 _v) {
   const ozz::math::SimdFloat4 ret = {
-      _m.cols[0].x * _v.x + _m.cols[1].x * _v.y + _m.cols[2].x * _v.z,
-      _m.cols[0].y * _v.x + _m.cols[1].y * _v.y + _m.cols[2].y * _v.z,
-      _m.cols[0].z * _v.x + _m.cols[1].z * _v.y + _m.cols[2].z * _v.z,
-      _m.cols[0].w * _v.x + _m.cols[1].w * _v.y + _m.cols[2].w * _v.z};
+      (_m.cols[0].x * _v.x + _m.cols[2].x * _v.z) + _m.cols[1].x * _v.y,
+      (_m.cols[0].y * _v.x + _m.cols[2].y * _v.z) + _m.cols[1].y * _v.y,
+      (_m.cols[0].z * _v.x + _m.cols[2].z * _v.z) + _m.cols[1].z * _v.y,
+      (_m.cols[0].w * _v.x + _m.cols[2].w * _v.z) + _m.cols[1].w * _v.y};
   return ret;
 }
 
 OZZ_INLINE ozz::math::SimdFloat4 operator*(const ozz::math::Float4x4& _m,
                                            ozz::math::_SimdFloat4 _v) {
   const ozz::math::SimdFloat4 ret = {
-      _m.cols[0].x * _v.x + _m.cols[1].x * _v.y + _m.cols[2].x * _v.z +
-          _m.cols[3].x * _v.w,
-      _m.cols[0].y * _v.x + _m.cols[1].y * _v.y + _m.cols[2].y * _v.z +
-          _m.cols[3].y * _v.w,
-      _m.cols[0].z * _v.x + _m.cols[1].z * _v.y + _m.cols[2].z * _v.z +
-          _m.cols[3].z * _v.w,
-      _m.cols[0].w * _v.x + _m.cols[1].w * _v.y + _m.cols[2].w * _v.z +
-          _m.cols[3].w * _v.w};
+      (_m.cols[0].x * _v.x + _m.cols[1].x * _v.y) +
+          (_m.cols[2].x * _v.z + _m.cols[3].x * _v.w),
+      (_m.cols[0].y * _v.x + _m.cols[1].y * _v.y) +
+          (_m.cols[2].y * _v.z + _m.cols[3].y * _v.w),
+      (_m.cols[0].z * _v.x + _m.cols[1].z * _v.y) +
+          (_m.cols[2].z * _v.z + _m.cols[3].z * _v.w),
+      (_m.cols[0].w * _v.x + _m.cols[1].w * _v.y) +
+          (_m.cols[2].w * _v.z + _m.cols[3].w * _v.w)};
   return ret;
 }
 
@@ -62,11 +62,12 @@ namespace simd_float4 {
 // _v.x + _v.y, _v.y, _v.z, _v.w
 #define OZZ_SSE_HADD2_F(_v) _mm_add_ss(_v, OZZ_SSE_SPLAT_F(_v, 1))
 
-// _v.x + _v.y + _v.z, _v.y, _v.z, _v.w
+// (_v.x + _v.y) + _v.z, _v.y, _v.z, _v.w
+// Components are summed in the same order as all other implementations.
 #define OZZ_SSE_HADD3_F(_v) \
-  _mm_add_ss(_mm_add_ss(_v, OZZ_SSE_SPLAT_F(_v, 2)), OZZ_SSE_SPLAT_F(_v, 1))
+  _mm_add_ss(_mm_add_ss(_v, OZZ_SSE_SPLAT_F(_v, 1)), OZZ_SSE_SPLAT_F(_v, 2))
 
-// _v.x + _v.y + _v.z + _v.w, ?, ?, ?
+// (_v.x + _v.z) + (_v.y + _v.w), ?, ?, ?
 #define OZZ_SSE_HADD4_F(_v, _r)                                    \
   do {                                                             \
     const __m128 haddxyzw = _mm_add_ps(_v, _mm_movehl_ps(_v, _v)); \
@@ -81,7 +82,9 @@ namespace simd_float4 {
                                                  \
   } while (void(0), 0)
 
-#ifdef OZZ_SIMD_SSE4_1
+// _mm_dp_ps sums components in a different order, which is avoided in
+// deterministic mode.
+#if defined(OZZ_SIMD_SSE4_1) && !defined(OZZ_SIMD_DETERMINISTIC)
 // dot3, ?, ?, ?
 #define OZZ_SSE_DOT3_F(_a, _b, _r) \
   do {                             \
@@ -94,7 +97,7 @@ namespace simd_float4 {
     _r = _mm_dp_ps(_a, _b, 0xff);  \
   } while (void(0), 0)
 
-#else  // OZZ_SIMD_SSE4_1
+#else  // OZZ_SIMD_SSE4_1 && !OZZ_SIMD_DETERMINISTIC
 // dot3, ?, ?, ?
 #define OZZ_SSE_DOT3_F(_a, _b, _r)        \
   do {                                    \
@@ -108,7 +111,7 @@ namespace simd_float4 {
     const __m128 ab = _mm_mul_ps(_a, _b); \
     OZZ_SSE_HADD4_F(ab, _r);              \
   } while (void(0), 0)
-#endif  // OZZ_SIMD_SSE4_1
+#endif  // OZZ_SIMD_SSE4_1 && !OZZ_SIMD_DETERMINISTIC
 
 // FMA operations
 #ifdef OZZ_SIMD_FMA
@@ -124,11 +127,11 @@ namespace simd_float4 {
 #define OZZ_MADD(_a, _b, _c) _mm_add_ps(_mm_mul_ps(_a, _b), _c)
 #define OZZ_MSUB(_a, _b, _c) _mm_sub_ps(_mm_mul_ps(_a, _b), _c)
 #define OZZ_NMADD(_a, _b, _c) _mm_sub_ps(_c, _mm_mul_ps(_a, _b))
-#define OZZ_NMSUB(_a, _b, _c) (-_mm_add_ps(_mm_mul_ps(_a, _b), _c))
+#define OZZ_NMSUB(_a, _b, _c) _mm_sub_ps(-_mm_mul_ps(_a, _b), _c)
 #define OZZ_MADDX(_a, _b, _c) _mm_add_ss(_mm_mul_ss(_a, _b), _c)
 #define OZZ_MSUBX(_a, _b, _c) _mm_sub_ss(_mm_mul_ss(_a, _b), _c)
 #define OZZ_NMADDX(_a, _b, _c) _mm_sub_ss(_c, _mm_mul_ss(_a, _b))
-#define OZZ_NMSUBX(_a, _b, _c) (-_mm_add_ss(_mm_mul_ss(_a, _b), _c))
+#define OZZ_NMSUBX(_a, _b, _c) _mm_sub_ss(-_mm_mul_ss(_a, _b), _c)
 #endif  // OZZ_SIMD_FMA
 
 OZZ_INLINE SimdFloat4 DivX(_SimdFloat4 _a, _SimdFloat4 _b) {
@@ -516,6 +519,22 @@ OZZ_INLINE SimdFloat4 Cross3(_SimdFloat4 _a, _SimdFloat4 _b) {
   return OZZ_MSUB(left0, right1, _mm_mul_ps(left1, right0));
 }
 
+#if defined(OZZ_SIMD_DETERMINISTIC)
+// Deterministic mode doesn't use hardware estimations, whose precision differs
+// from a cpu to another. IEEE correctly rounded division and square root are
+// used instead, which makes Est and EstNR functions equivalent.
+OZZ_INLINE SimdFloat4 RcpEst(_SimdFloat4 _v) {
+  return _mm_div_ps(_mm_set_ps1(1.f), _v);
+}
+
+OZZ_INLINE SimdFloat4 RcpEstNR(_SimdFloat4 _v) { return RcpEst(_v); }
+
+OZZ_INLINE SimdFloat4 RcpEstX(_SimdFloat4 _v) {
+  return _mm_move_ss(_v, _mm_div_ss(_mm_set_ps1(1.f), _v));
+}
+
+OZZ_INLINE SimdFloat4 RcpEstXNR(_SimdFloat4 _v) { return RcpEstX(_v); }
+#else   // OZZ_SIMD_DETERMINISTIC
 OZZ_INLINE SimdFloat4 RcpEst(_SimdFloat4 _v) { return _mm_rcp_ps(_v); }
 
 OZZ_INLINE SimdFloat4 RcpEstNR(_SimdFloat4 _v) {
@@ -531,11 +550,25 @@ OZZ_INLINE SimdFloat4 RcpEstXNR(_SimdFloat4 _v) {
   // Do one more Newton-Raphson step to improve precision.
   return OZZ_NMADDX(_mm_mul_ss(nr, nr), _v, _mm_add_ss(nr, nr));
 }
+#endif  // OZZ_SIMD_DETERMINISTIC
 
 OZZ_INLINE SimdFloat4 Sqrt(_SimdFloat4 _v) { return _mm_sqrt_ps(_v); }
 
 OZZ_INLINE SimdFloat4 SqrtX(_SimdFloat4 _v) { return _mm_sqrt_ss(_v); }
 
+#if defined(OZZ_SIMD_DETERMINISTIC)
+OZZ_INLINE SimdFloat4 RSqrtEst(_SimdFloat4 _v) {
+  return _mm_div_ps(_mm_set_ps1(1.f), _mm_sqrt_ps(_v));
+}
+
+OZZ_INLINE SimdFloat4 RSqrtEstNR(_SimdFloat4 _v) { return RSqrtEst(_v); }
+
+OZZ_INLINE SimdFloat4 RSqrtEstX(_SimdFloat4 _v) {
+  return _mm_move_ss(_v, _mm_div_ss(_mm_set_ps1(1.f), _mm_sqrt_ss(_v)));
+}
+
+OZZ_INLINE SimdFloat4 RSqrtEstXNR(_SimdFloat4 _v) { return RSqrtEstX(_v); }
+#else   // OZZ_SIMD_DETERMINISTIC
 OZZ_INLINE SimdFloat4 RSqrtEst(_SimdFloat4 _v) { return _mm_rsqrt_ps(_v); }
 
 OZZ_INLINE SimdFloat4 RSqrtEstNR(_SimdFloat4 _v) {
@@ -553,6 +586,7 @@ OZZ_INLINE SimdFloat4 RSqrtEstXNR(_SimdFloat4 _v) {
   return _mm_mul_ss(_mm_mul_ss(_mm_set_ps1(.5f), nr),
                     OZZ_NMADDX(_mm_mul_ss(_v, nr), nr, _mm_set_ps1(3.f)));
 }
+#endif  // OZZ_SIMD_DETERMINISTIC
 
 OZZ_INLINE SimdFloat4 Abs(_SimdFloat4 _v) {
   const __m128i zero = _mm_setzero_si128();
@@ -634,7 +668,7 @@ OZZ_INLINE SimdFloat4 NormalizeEst2(_SimdFloat4 _v) {
   __m128 sq_len;
   OZZ_SSE_DOT2_F(_v, _v, sq_len);
   assert(_mm_cvtss_f32(sq_len) != 0.f && "_v is not normalizable");
-  const __m128 inv_len = _mm_rsqrt_ss(sq_len);
+  const __m128 inv_len = RSqrtEstX(sq_len);
   const __m128 inv_lenxxxx = OZZ_SSE_SPLAT_F(inv_len, 0);
   const __m128 norm = _mm_mul_ps(_v, inv_lenxxxx);
   return _mm_movelh_ps(norm, _mm_movehl_ps(_v, _v));
@@ -644,7 +678,7 @@ OZZ_INLINE SimdFloat4 NormalizeEst3(_SimdFloat4 _v) {
   __m128 sq_len;
   OZZ_SSE_DOT3_F(_v, _v, sq_len);
   assert(_mm_cvtss_f32(sq_len) != 0.f && "_v is not normalizable");
-  const __m128 inv_len = _mm_rsqrt_ss(sq_len);
+  const __m128 inv_len = RSqrtEstX(sq_len);
   const __m128 vwxyz = OZZ_SHUFFLE_PS1(_v, _MM_SHUFFLE(0, 1, 2, 3));
   const __m128 inv_lenxxxx = OZZ_SSE_SPLAT_F(inv_len, 0);
   const __m128 normwxyz = _mm_move_ss(_mm_mul_ps(vwxyz, inv_lenxxxx), vwxyz);
@@ -655,7 +689,7 @@ OZZ_INLINE SimdFloat4 NormalizeEst4(_SimdFloat4 _v) {
   __m128 sq_len;
   OZZ_SSE_DOT4_F(_v, _v, sq_len);
   assert(_mm_cvtss_f32(sq_len) != 0.f && "_v is not normalizable");
-  const __m128 inv_len = _mm_rsqrt_ss(sq_len);
+  const __m128 inv_len = RSqrtEstX(sq_len);
   const __m128 inv_lenxxxx = OZZ_SSE_SPLAT_F(inv_len, 0);
   return _mm_mul_ps(_v, inv_lenxxxx);
 }
@@ -763,7 +797,7 @@ OZZ_INLINE SimdFloat4 NormalizeSafeEst2(_SimdFloat4 _v, _SimdFloat4 _safe) {
   // assert(AreAllTrue1(IsNormalizedEst2(_safe)) && "_safe is not normalized");
   __m128 sq_len;
   OZZ_SSE_DOT2_F(_v, _v, sq_len);
-  const __m128 inv_len = _mm_rsqrt_ss(sq_len);
+  const __m128 inv_len = RSqrtEstX(sq_len);
   const __m128 inv_lenxxxx = OZZ_SSE_SPLAT_F(inv_len, 0);
   const __m128 norm = _mm_mul_ps(_v, inv_lenxxxx);
   const __m128i cond = _mm_castps_si128(
@@ -776,7 +810,7 @@ OZZ_INLINE SimdFloat4 NormalizeSafeEst3(_SimdFloat4 _v, _SimdFloat4 _safe) {
   // assert(AreAllTrue1(IsNormalizedEst3(_safe)) && "_safe is not normalized");
   __m128 sq_len;
   OZZ_SSE_DOT3_F(_v, _v, sq_len);
-  const __m128 inv_len = _mm_rsqrt_ss(sq_len);
+  const __m128 inv_len = RSqrtEstX(sq_len);
   const __m128 vwxyz = OZZ_SHUFFLE_PS1(_v, _MM_SHUFFLE(0, 1, 2, 3));
   const __m128 inv_lenxxxx = OZZ_SSE_SPLAT_F(inv_len, 0);
   const __m128 normwxyz = _mm_move_ss(_mm_mul_ps(vwxyz, inv_lenxxxx), vwxyz);
@@ -790,7 +824,7 @@ OZZ_INLINE SimdFloat4 NormalizeSafeEst4(_SimdFloat4 _v, _SimdFloat4 _safe) {
   // assert(AreAllTrue1(IsNormalizedEst4(_safe)) && "_safe is not normalized");
   __m128 sq_len;
   OZZ_SSE_DOT4_F(_v, _v, sq_len);
-  const __m128 inv_len = _mm_rsqrt_ss(sq_len);
+  const __m128 inv_len = RSqrtEstX(sq_len);
   const __m128 inv_lenxxxx = OZZ_SSE_SPLAT_F(inv_len, 0);
   const __m128i cond = _mm_castps_si128(
       _mm_cmple_ps(OZZ_SSE_SPLAT_F(sq_len, 0), _mm_setzero_ps()));
@@ -1555,6 +1589,15 @@ OZZ_INLINE Float4x4 ColumnMultiply(const Float4x4& _m, _SimdFloat4 _v) {
   return ret;
 }
 
+OZZ_INLINE Float4x4 ColumnMultiplyAdd(const Float4x4& _m, _SimdFloat4 _v,
+                                      const Float4x4& _c) {
+  const Float4x4 ret = {{OZZ_MADD(_m.cols[0], _v, _c.cols[0]),
+                         OZZ_MADD(_m.cols[1], _v, _c.cols[1]),
+                         OZZ_MADD(_m.cols[2], _v, _c.cols[2]),
+                         OZZ_MADD(_m.cols[3], _v, _c.cols[3])}};
+  return ret;
+}
+
 inline SimdInt4 IsNormalized(const Float4x4& _m) {
   const __m128 max = _mm_set_ps1(1.f + kNormalizationToleranceSq);
   const __m128 min = _mm_set_ps1(1.f - kNormalizationToleranceSq);
@@ -1922,6 +1965,41 @@ inline Float4x4 Float4x4::FromAffine(_SimdFloat4 _translation,
   return ret;
 }
 
+// When FMA is available, matrix products are computed as a single chain of
+// fused multiply-adds, which requires less instructions than the default
+// version. The default version splits the computation in two independent
+// chains to reduce latency.
+#if defined(OZZ_SIMD_FMA)
+OZZ_INLINE ozz::math::SimdFloat4 TransformPoint(const ozz::math::Float4x4& _m,
+                                                ozz::math::_SimdFloat4 _v) {
+  const __m128 a3 = OZZ_MADD(OZZ_SSE_SPLAT_F(_v, 2), _m.cols[2], _m.cols[3]);
+  const __m128 a2 = OZZ_MADD(OZZ_SSE_SPLAT_F(_v, 1), _m.cols[1], a3);
+  return OZZ_MADD(OZZ_SSE_SPLAT_F(_v, 0), _m.cols[0], a2);
+}
+
+OZZ_INLINE ozz::math::SimdFloat4 TransformVector(const ozz::math::Float4x4& _m,
+                                                 ozz::math::_SimdFloat4 _v) {
+  const __m128 zzzz = _mm_mul_ps(_m.cols[2], OZZ_SSE_SPLAT_F(_v, 2));
+  const __m128 a2 = OZZ_MADD(_m.cols[1], OZZ_SSE_SPLAT_F(_v, 1), zzzz);
+  return OZZ_MADD(_m.cols[0], OZZ_SSE_SPLAT_F(_v, 0), a2);
+}
+
+OZZ_INLINE ozz::math::SimdFloat4 operator*(const ozz::math::Float4x4& _m,
+                                           ozz::math::_SimdFloat4 _v) {
+  const __m128 wwww = _mm_mul_ps(OZZ_SSE_SPLAT_F(_v, 3), _m.cols[3]);
+  const __m128 a3 = OZZ_MADD(OZZ_SSE_SPLAT_F(_v, 2), _m.cols[2], wwww);
+  const __m128 a2 = OZZ_MADD(OZZ_SSE_SPLAT_F(_v, 1), _m.cols[1], a3);
+  return OZZ_MADD(OZZ_SSE_SPLAT_F(_v, 0), _m.cols[0], a2);
+}
+
+inline ozz::math::Float4x4 operator*(const ozz::math::Float4x4& _a,
+                                     const ozz::math::Float4x4& _b) {
+  // Columns are independent, so latency is hidden by interleaving them.
+  const ozz::math::Float4x4 ret = {
+      {_a * _b.cols[0], _a * _b.cols[1], _a * _b.cols[2], _a * _b.cols[3]}};
+  return ret;
+}
+#else   // OZZ_SIMD_FMA
 OZZ_INLINE ozz::math::SimdFloat4 TransformPoint(const ozz::math::Float4x4& _m,
                                                 ozz::math::_SimdFloat4 _v) {
   const __m128 xxxx = _mm_mul_ps(OZZ_SSE_SPLAT_F(_v, 0), _m.cols[0]);
@@ -1988,6 +2066,7 @@ inline ozz::math::Float4x4 operator*(const ozz::math::Float4x4& _a,
   }
   return ret;
 }
+#endif  // OZZ_SIMD_FMA
 
 OZZ_INLINE ozz::math::Float4x4 operator+(const ozz::math::Float4x4& _a,
                                          const ozz::math::Float4x4& _b) {
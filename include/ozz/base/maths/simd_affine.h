@@ -0,0 +1,93 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#ifndef OZZ_OZZ_BASE_MATHS_SIMD_AFFINE_H_
+#define OZZ_OZZ_BASE_MATHS_SIMD_AFFINE_H_
+
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/simd_quaternion.h"
+
+// Implements compact representations of affine transformations, which require
+// less memory and bandwidth than Float4x4 matrices (when uploading to gpu for
+// skinning for example).
+namespace ozz {
+namespace math {
+
+// Declares the 3x4 affine matrix type. It stores the 3 first rows of a Float4x4
+// matrix, as the last one is always (0, 0, 0, 1) for affine matrices. This is
+// the row major layout usually expected by gpu constant buffers.
+// [ m.rows[0].x m.rows[0].y m.rows[0].z m.rows[0].w ]
+// | m.rows[1].x m.rows[1].y m.rows[1].z m.rows[1].w |
+// | m.rows[2].x m.rows[2].y m.rows[2].z m.rows[2].w |
+// [ 0           0           0           1           ]
+struct Float3x4 {
+  // Matrix rows.
+  SimdFloat4 rows[3];
+};
+
+// Converts affine matrix _m to a 3x4 matrix. Last row of _m is ignored.
+OZZ_INLINE Float3x4 ToFloat3x4(const Float4x4& _m) {
+  SimdFloat4 rows[4];
+  Transpose4x4(_m.cols, rows);
+  const Float3x4 ret = {{rows[0], rows[1], rows[2]}};
+  return ret;
+}
+
+// Converts 3x4 matrix _m to a Float4x4 matrix.
+OZZ_INLINE Float4x4 ToFloat4x4(const Float3x4& _m) {
+  const SimdFloat4 rows[4] = {_m.rows[0], _m.rows[1], _m.rows[2],
+                              simd_float4::w_axis()};
+  Float4x4 ret;
+  Transpose4x4(rows, ret.cols);
+  return ret;
+}
+
+// Declares the dual quaternion type, which represents a rigid transformation
+// (rotation and translation) with two quaternions.
+struct DualQuaternion {
+  // Real part, which is the rotation.
+  SimdQuaternion real;
+
+  // Dual part, which is half the translation (as a pure quaternion) times the
+  // rotation.
+  SimdQuaternion dual;
+};
+
+// Converts matrix _m to a dual quaternion.
+// _m must be a rigid transformation, meaning its upper 3x3 matrix must be
+// orthogonal, as scale and shearing cannot be represented by dual quaternions.
+OZZ_INLINE DualQuaternion ToDualQuaternion(const Float4x4& _m) {
+  const SimdQuaternion real = {ToQuaternion(_m)};
+  const SimdQuaternion translation = {
+      SetW(_m.cols[3] * simd_float4::Load1(.5f), simd_float4::zero())};
+  const DualQuaternion ret = {real, translation * real};
+  return ret;
+}
+}  // namespace math
+}  // namespace ozz
+#endif  // OZZ_OZZ_BASE_MATHS_SIMD_AFFINE_H_
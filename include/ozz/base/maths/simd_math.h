@@ -37,6 +37,11 @@ namespace math {
 // Returns SIMDimplementation name has decided at library build time.
 const char* SimdImplementationName();
 
+// Returns true if AVX2 and FMA instructions can be used. This is detected at
+// runtime when OZZ_SIMD_AVX2_DISPATCH is defined, and is otherwise decided at
+// library build time.
+bool CpuSupportsAvx2Fma();
+
 namespace simd_float4 {
 // Returns a SimdFloat4 vector with all components set to 0.
 OZZ_INLINE SimdFloat4 zero();
@@ -1123,6 +1128,11 @@ OZZ_INLINE Float4x4 Scale(const Float4x4& _m, _SimdFloat4 _v);
 // Multiply each column of matrix _m with vector _v.
 OZZ_INLINE Float4x4 ColumnMultiply(const Float4x4& _m, _SimdFloat4 _v);
 
+// Multiply each column of matrix _m with vector _v, then adds matrix _c.
+// This uses fused multiply-add instructions when available.
+OZZ_INLINE Float4x4 ColumnMultiplyAdd(const Float4x4& _m, _SimdFloat4 _v,
+                                      const Float4x4& _c);
+
 // Tests if each 3 column of upper 3x3 matrix of _m is a normal matrix.
 // Returns the result in the x, y and z component of the returned vector. w is
 // set to 0.
@@ -1217,11 +1227,24 @@ OZZ_INLINE SimdInt4 FloatToHalf(_SimdFloat4 _f);
 
 // Converts from a half to a float.
 OZZ_INLINE SimdFloat4 HalfToFloat(_SimdInt4 _h);
+
+// Converts _count floats from _src to halves in _dest.
+// Uses F16C instructions (if OZZ_SIMD_F16C is defined), which round to
+// nearest even, so ties might differ from the scalar conversion by one ulp.
+void FloatToHalf(const float* _src, size_t _count, uint16_t* _dest);
+
+// Converts _count halves from _src to floats in _dest.
+// Uses F16C instructions if OZZ_SIMD_F16C is defined.
+void HalfToFloat(const uint16_t* _src, size_t _count, float* _dest);
 }  // namespace math
 }  // namespace ozz
 
 #if defined(OZZ_SIMD_SSEx)
 #include "ozz/base/maths/internal/simd_math_sse-inl.h"
+#elif defined(OZZ_SIMD_NEON)
+#include "ozz/base/maths/internal/simd_math_neon-inl.h"
+#elif defined(OZZ_SIMD_WASM)
+#include "ozz/base/maths/internal/simd_math_wasm-inl.h"
 #elif defined(OZZ_SIMD_REF)
 #include "ozz/base/maths/internal/simd_math_ref-inl.h"
 #else
@@ -106,25 +106,30 @@ struct SoaFloat4x4 {
 
     const SimdFloat4 zero = simd_float4::zero();
     const SimdFloat4 one = simd_float4::one();
-    const SimdFloat4 two = one + one;
 
-    const SimdFloat4 xx = _quaternion.x * _quaternion.x;
-    const SimdFloat4 xy = _quaternion.x * _quaternion.y;
-    const SimdFloat4 xz = _quaternion.x * _quaternion.z;
-    const SimdFloat4 xw = _quaternion.x * _quaternion.w;
-    const SimdFloat4 yy = _quaternion.y * _quaternion.y;
-    const SimdFloat4 yz = _quaternion.y * _quaternion.z;
-    const SimdFloat4 yw = _quaternion.y * _quaternion.w;
-    const SimdFloat4 zz = _quaternion.z * _quaternion.z;
-    const SimdFloat4 zw = _quaternion.z * _quaternion.w;
+    // Products are expressed as multiply-adds, which are fused when the simd
+    // implementation supports it.
+    const SimdFloat4 x2 = _quaternion.x + _quaternion.x;
+    const SimdFloat4 y2 = _quaternion.y + _quaternion.y;
+    const SimdFloat4 z2 = _quaternion.z + _quaternion.z;
+
+    const SimdFloat4 xy2 = _quaternion.x * y2;
+    const SimdFloat4 xz2 = _quaternion.x * z2;
+    const SimdFloat4 yz2 = _quaternion.y * z2;
+
+    const SimdFloat4 one_zz2 = NMAdd(_quaternion.z, z2, one);
+    const SimdFloat4 one_yy2 = NMAdd(_quaternion.y, y2, one);
 
     const SoaFloat4x4 ret = {
-        {{_scale.x * (one - two * (yy + zz)), _scale.x * two * (xy + zw),
-          _scale.x * two * (xz - yw), zero},
-         {_scale.y * two * (xy - zw), _scale.y * (one - two * (xx + zz)),
-          _scale.y * two * (yz + xw), zero},
-         {_scale.z * two * (xz + yw), _scale.z * two * (yz - xw),
-          _scale.z * (one - two * (xx + yy)), zero},
+        {{_scale.x * NMAdd(_quaternion.y, y2, one_zz2),
+          _scale.x * MAdd(_quaternion.w, z2, xy2),
+          _scale.x * NMAdd(_quaternion.w, y2, xz2), zero},
+         {_scale.y * NMAdd(_quaternion.w, z2, xy2),
+          _scale.y * NMAdd(_quaternion.x, x2, one_zz2),
+          _scale.y * MAdd(_quaternion.w, x2, yz2), zero},
+         {_scale.z * MAdd(_quaternion.w, y2, xz2),
+          _scale.z * NMAdd(_quaternion.w, x2, yz2),
+          _scale.z * NMAdd(_quaternion.x, x2, one_yy2), zero},
          {_translation.x, _translation.y, _translation.z, one}}};
     return ret;
   }
@@ -225,14 +230,26 @@ OZZ_INLINE SoaFloat4x4 Scale(const SoaFloat4x4& _m, const SoaFloat4& _v) {
 OZZ_INLINE ozz::math::SoaFloat4 operator*(const ozz::math::SoaFloat4x4& _m,
                                           const ozz::math::SoaFloat4& _v) {
   const ozz::math::SoaFloat4 ret = {
-      _m.cols[0].x * _v.x + _m.cols[1].x * _v.y + _m.cols[2].x * _v.z +
-          _m.cols[3].x * _v.w,
-      _m.cols[0].y * _v.x + _m.cols[1].y * _v.y + _m.cols[2].y * _v.z +
-          _m.cols[3].y * _v.w,
-      _m.cols[0].z * _v.x + _m.cols[1].z * _v.y + _m.cols[2].z * _v.z +
-          _m.cols[3].z * _v.w,
-      _m.cols[0].w * _v.x + _m.cols[1].w * _v.y + _m.cols[2].w * _v.z +
-          _m.cols[3].w * _v.w};
+      ozz::math::MAdd(
+          _m.cols[3].x, _v.w,
+          ozz::math::MAdd(_m.cols[2].x, _v.z,
+                          ozz::math::MAdd(_m.cols[1].x, _v.y,
+                                          _m.cols[0].x * _v.x))),
+      ozz::math::MAdd(
+          _m.cols[3].y, _v.w,
+          ozz::math::MAdd(_m.cols[2].y, _v.z,
+                          ozz::math::MAdd(_m.cols[1].y, _v.y,
+                                          _m.cols[0].y * _v.x))),
+      ozz::math::MAdd(
+          _m.cols[3].z, _v.w,
+          ozz::math::MAdd(_m.cols[2].z, _v.z,
+                          ozz::math::MAdd(_m.cols[1].z, _v.y,
+                                          _m.cols[0].z * _v.x))),
+      ozz::math::MAdd(
+          _m.cols[3].w, _v.w,
+          ozz::math::MAdd(_m.cols[2].w, _v.z,
+                          ozz::math::MAdd(_m.cols[1].w, _v.y,
+                                          _m.cols[0].w * _v.x)))};
   return ret;
 }
 
@@ -0,0 +1,100 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_BASE_MATHS_SOA_HALF_TRANSFORM_H_
+#define OZZ_OZZ_BASE_MATHS_SOA_HALF_TRANSFORM_H_
+
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/platform.h"
+
+namespace ozz {
+namespace math {
+
+// Stores a SoaTransform with half precision floating point components, using
+// half the memory (80 bytes instead of 160). It's intended for intermediate
+// poses, like the output of a SamplingJob consumed by a BlendingJob, whose
+// memory traffic dominates deep blend trees.
+// Every SimdInt4 member packs two soa components: each of its 4 integers
+// stores the half of the first component in its lower 16 bits, and the half
+// of the second one in its upper 16 bits.
+// Half precision floats have a 11 bits mantissa (relative precision of
+// 1/2048) and can't represent values whose magnitude is above 65504, which is
+// enough for rotations, scales and joint local translations, but not for
+// translations far away from their parent.
+struct SoaHalfTransform {
+  SimdInt4 translation_xy;
+  SimdInt4 translation_z_scale_z;
+  SimdInt4 rotation_xy;
+  SimdInt4 rotation_zw;
+  SimdInt4 scale_xy;
+};
+
+namespace internal {
+// Packs _lo and _hi to halves, see SoaHalfTransform.
+OZZ_INLINE SimdInt4 PackHalf2(_SimdFloat4 _lo, _SimdFloat4 _hi) {
+  return Or(FloatToHalf(_lo), ShiftL(FloatToHalf(_hi), 16));
+}
+
+// Unpacks lower 16 bits halves of _v. HalfToFloat ignores upper bits.
+OZZ_INLINE SimdFloat4 UnpackHalfLo(_SimdInt4 _v) { return HalfToFloat(_v); }
+
+// Unpacks upper 16 bits halves of _v.
+OZZ_INLINE SimdFloat4 UnpackHalfHi(_SimdInt4 _v) {
+  return HalfToFloat(ShiftRu(_v, 16));
+}
+}  // namespace internal
+
+// Converts _transform to half precision.
+OZZ_INLINE SoaHalfTransform PackHalf(const SoaTransform& _transform) {
+  const SoaHalfTransform ret = {
+      internal::PackHalf2(_transform.translation.x, _transform.translation.y),
+      internal::PackHalf2(_transform.translation.z, _transform.scale.z),
+      internal::PackHalf2(_transform.rotation.x, _transform.rotation.y),
+      internal::PackHalf2(_transform.rotation.z, _transform.rotation.w),
+      internal::PackHalf2(_transform.scale.x, _transform.scale.y)};
+  return ret;
+}
+
+// Converts _transform back to single precision.
+OZZ_INLINE SoaTransform UnpackHalf(const SoaHalfTransform& _transform) {
+  const SoaTransform ret = {
+      {internal::UnpackHalfLo(_transform.translation_xy),
+       internal::UnpackHalfHi(_transform.translation_xy),
+       internal::UnpackHalfLo(_transform.translation_z_scale_z)},
+      {internal::UnpackHalfLo(_transform.rotation_xy),
+       internal::UnpackHalfHi(_transform.rotation_xy),
+       internal::UnpackHalfLo(_transform.rotation_zw),
+       internal::UnpackHalfHi(_transform.rotation_zw)},
+      {internal::UnpackHalfLo(_transform.scale_xy),
+       internal::UnpackHalfHi(_transform.scale_xy),
+       internal::UnpackHalfHi(_transform.translation_z_scale_z)}};
+  return ret;
+}
+}  // namespace math
+}  // namespace ozz
+#endif  // OZZ_OZZ_BASE_MATHS_SOA_HALF_TRANSFORM_H_
@@ -140,6 +140,50 @@ OZZ_INLINE SoaQuaternion NLerpEst(const SoaQuaternion& _a,
                            lerp.w * inv_len};
   return r;
 }
+
+// Returns the estimated normalized SoaQuaternion _q, using a reciprocal square
+// root estimation refined with _NRSteps Newton-Raphson steps. _NRSteps = 1 is
+// equivalent to NormalizeEst().
+template <int _NRSteps>
+OZZ_INLINE SoaQuaternion NormalizeEstNR(const SoaQuaternion& _q) {
+  const SimdFloat4 len2 = _q.x * _q.x + _q.y * _q.y + _q.z * _q.z + _q.w * _q.w;
+  SimdFloat4 inv_len = _NRSteps > 0 ? RSqrtEstNR(len2) : RSqrtEst(len2);
+  for (int i = 1; i < _NRSteps; ++i) {
+    inv_len = simd_float4::Load1(.5f) * inv_len *
+              (simd_float4::Load1(3.f) - len2 * inv_len * inv_len);
+  }
+  const SoaQuaternion r = {_q.x * inv_len, _q.y * inv_len, _q.z * inv_len,
+                           _q.w * inv_len};
+  return r;
+}
+
+// Quaternion normalization precision policies. They allow algorithms (like
+// animation jobs) to be specialized for a precision chosen by the user, from
+// the cheapest estimation to full precision.
+// Normalizes with a full precision square root and division, see Normalize().
+struct ExactNormalization {
+  static OZZ_INLINE SoaQuaternion Normalize(const SoaQuaternion& _q) {
+    return math::Normalize(_q);
+  }
+};
+
+// Normalizes with a reciprocal square root estimation refined with _NRSteps
+// Newton-Raphson steps, see NormalizeEstNR().
+template <int _NRSteps>
+struct EstimatedNormalization {
+  static OZZ_INLINE SoaQuaternion Normalize(const SoaQuaternion& _q) {
+    return NormalizeEstNR<_NRSteps>(_q);
+  }
+};
+
+// Returns the linear interpolation of SoaQuaternion _a and _b with coefficient
+// _f, normalized according to _Policy (ExactNormalization or
+// EstimatedNormalization).
+template <typename _Policy>
+OZZ_INLINE SoaQuaternion NLerp(const SoaQuaternion& _a, const SoaQuaternion& _b,
+                               _SimdFloat4 _f) {
+  return _Policy::Normalize(Lerp(_a, _b, _f));
+}
 }  // namespace math
 }  // namespace ozz
 
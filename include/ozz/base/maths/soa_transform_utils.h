@@ -0,0 +1,58 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_BASE_MATHS_SOA_TRANSFORM_UTILS_H_
+#define OZZ_OZZ_BASE_MATHS_SOA_TRANSFORM_UTILS_H_
+
+#include "ozz/base/platform.h"
+
+// Implements bulk conversions of whole poses between aos math::Transform and
+// soa math::SoaTransform formats.
+namespace ozz {
+namespace math {
+
+struct Transform;
+struct SoaTransform;
+
+// Packs _transforms to soa format in _soa_transforms. Each SoaTransform of
+// _soa_transforms receives 4 consecutive transforms. Lanes of the last
+// SoaTransform that have no matching transform are set to identity.
+// Rotations aren't normalized.
+// Returns false if _soa_transforms is smaller than (_transforms.count() + 3) /
+// 4 elements, in which case _soa_transforms is left unchanged.
+bool PackSoaTransforms(const Range<const Transform>& _transforms,
+                       const Range<SoaTransform>& _soa_transforms);
+
+// Unpacks the _transforms.count() first transforms stored in _soa_transforms
+// to aos format in _transforms.
+// Returns false if _soa_transforms is smaller than (_transforms.count() + 3) /
+// 4 elements, in which case _transforms is left unchanged.
+bool UnpackSoaTransforms(const Range<const SoaTransform>& _soa_transforms,
+                         const Range<Transform>& _transforms);
+}  // namespace math
+}  // namespace ozz
+#endif  // OZZ_OZZ_BASE_MATHS_SOA_TRANSFORM_UTILS_H_
@@ -46,6 +46,66 @@ Allocator* default_allocator();
 // Returns current memory allocator, such that in can be restored if needed.
 Allocator* SetDefaulAllocator(Allocator* _allocator);
 
+// Gets the calling thread scratch allocator, meant for short lived (per frame)
+// allocations, like a LinearAllocator instance dedicated to a worker thread.
+// Returns default_allocator() if no scratch allocator was set for the calling
+// thread.
+Allocator* thread_scratch_allocator();
+
+// Sets the scratch allocator of the calling thread only. Setting NULL restores
+// default_allocator() as the scratch allocator.
+// Returns the previous scratch allocator of the calling thread (NULL if none
+// was set), such that it can be restored if needed. _allocator must outlive
+// its use as a scratch allocator.
+Allocator* SetThreadScratchAllocator(Allocator* _allocator);
+
+// Gets whether allocations are allowed for the calling thread, aka it's not
+// within a ScopedNoAllocation scope.
+bool allocations_allowed();
+
+// Marks a scope where the calling thread isn't allowed to allocate, like a
+// shipping frame update where any heap allocation is a bug. In debug builds,
+// using default_allocator() (or thread_scratch_allocator() when it falls back
+// to the default allocator) within such a scope asserts. Scopes can be nested.
+class ScopedNoAllocation {
+ public:
+  ScopedNoAllocation();
+  ~ScopedNoAllocation();
+
+ private:
+  ScopedNoAllocation(const ScopedNoAllocation&);
+  void operator=(const ScopedNoAllocation&);
+};
+
+// Defines the categories ozz allocations are tagged with, so that memory usage
+// can be profiled per subsystem (see TrackingAllocator).
+enum AllocationTag {
+  kTagUntagged,       // Allocations done out of any tagged scope.
+  kTagAnimation,      // Animation data.
+  kTagSkeleton,       // Skeleton data.
+  kTagSamplingCache,  // SamplingCache data.
+  kTagTrack,          // Track data.
+  kTagBuilder,        // Offline builders temporary data.
+  kNumAllocationTags
+};
+
+// Gets the calling thread current allocation tag.
+AllocationTag allocation_tag();
+
+// Sets the calling thread allocation tag for the lifetime of the object. The
+// previous tag is restored on destruction.
+class ScopedAllocationTag {
+ public:
+  explicit ScopedAllocationTag(AllocationTag _tag);
+  ~ScopedAllocationTag();
+
+ private:
+  ScopedAllocationTag(const ScopedAllocationTag&);
+  void operator=(const ScopedAllocationTag&);
+
+  AllocationTag previous_;
+};
+
 // Defines an abstract allocator class.
 // Implements helper methods to allocate/deallocate POD typed objects instead of
 // raw memory.
@@ -80,8 +140,7 @@ class Allocator {
   // New function conforms with standard operator new specifications.
   template <typename _Ty>
   _Ty* New() {
-    void* alloc =
-        memory::default_allocator()->Allocate(sizeof(_Ty), OZZ_ALIGN_OF(_Ty));
+    void* alloc = Allocate(sizeof(_Ty), OZZ_ALIGN_OF(_Ty));
     if (alloc) {
       return new (alloc) _Ty;
     }
@@ -92,8 +151,7 @@ class Allocator {
   // New function conforms with standard operator new specifications.
   template <typename _Ty, typename _Arg0>
   _Ty* New(const _Arg0& _arg0) {
-    void* alloc =
-        memory::default_allocator()->Allocate(sizeof(_Ty), OZZ_ALIGN_OF(_Ty));
+    void* alloc = Allocate(sizeof(_Ty), OZZ_ALIGN_OF(_Ty));
     if (alloc) {
       return new (alloc) _Ty(_arg0);
     }
@@ -104,8 +162,7 @@ class Allocator {
   // New function conforms with standard operator new specifications.
   template <typename _Ty, typename _Arg0, typename _Arg1>
   _Ty* New(const _Arg0& _arg0, const _Arg1& _arg1) {
-    void* alloc =
-        memory::default_allocator()->Allocate(sizeof(_Ty), OZZ_ALIGN_OF(_Ty));
+    void* alloc = Allocate(sizeof(_Ty), OZZ_ALIGN_OF(_Ty));
     if (alloc) {
       return new (alloc) _Ty(_arg0, _arg1);
     }
@@ -116,8 +173,7 @@ class Allocator {
   // New function conforms with standard operator new specifications.
   template <typename _Ty, typename _Arg0, typename _Arg1, typename _Arg2>
   _Ty* New(const _Arg0& _arg0, const _Arg1& _arg1, const _Arg2& _arg2) {
-    void* alloc =
-        memory::default_allocator()->Allocate(sizeof(_Ty), OZZ_ALIGN_OF(_Ty));
+    void* alloc = Allocate(sizeof(_Ty), OZZ_ALIGN_OF(_Ty));
     if (alloc) {
       return new (alloc) _Ty(_arg0, _arg1, _arg2);
     }
@@ -130,8 +186,7 @@ class Allocator {
             typename _Arg3>
   _Ty* New(const _Arg0& _arg0, const _Arg1& _arg1, const _Arg2& _arg2,
            const _Arg3& _arg3) {
-    void* alloc =
-        memory::default_allocator()->Allocate(sizeof(_Ty), OZZ_ALIGN_OF(_Ty));
+    void* alloc = Allocate(sizeof(_Ty), OZZ_ALIGN_OF(_Ty));
     if (alloc) {
       return new (alloc) _Ty(_arg0, _arg1, _arg2, _arg3);
     }
@@ -0,0 +1,106 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+#ifndef OZZ_OZZ_BASE_MEMORY_LARGE_PAGE_ALLOCATOR_H_
+#define OZZ_OZZ_BASE_MEMORY_LARGE_PAGE_ALLOCATOR_H_
+
+#include "ozz/base/memory/allocator.h"
+
+namespace ozz {
+namespace memory {
+
+// Implements an allocator for bulk, long lived and mostly read-only data, like
+// large animation databases. Memory is mapped from the OS in big regions,
+// backed by large pages when possible, which reduces TLB misses when scanning
+// through gigabytes of keys:
+// - Linux: mmap with MAP_HUGETLB, or transparent huge pages (madvise) if no
+// huge page is reserved.
+// - Windows: VirtualAlloc with MEM_LARGE_PAGES, which requires the process to
+// hold SeLockMemoryPrivilege.
+// - Other platforms: regular pages (mmap), or the default allocator if there's
+// no virtual memory support.
+// Blocks are sub-allocated linearly within regions. A region is unmapped once
+// all its blocks are deallocated. Blocks bigger than the region size get their
+// own region.
+// Use it through objects allocator injection, like Animation(Allocator*) or
+// AnimationBuilder::operator()(raw, Allocator*).
+// A LargePageAllocator isn't thread safe.
+class LargePageAllocator : public Allocator {
+ public:
+  // Constructs an allocator that maps regions of at least _region_size bytes,
+  // rounded up to large page size.
+  explicit LargePageAllocator(size_t _region_size = 64 << 20);
+
+  // Unmaps all regions. Asserts all blocks were deallocated.
+  virtual ~LargePageAllocator();
+
+  // Gets the total size of the mapped regions.
+  size_t mapped_bytes() const { return mapped_bytes_; }
+
+  // Gets the size of the mapped regions that are backed by large pages. Huge
+  // pages requested with madvise are not accounted, as the kernel could decide
+  // not to use them.
+  size_t large_page_bytes() const { return large_page_bytes_; }
+
+  // Gets large page size of the platform, or 0 if unsupported.
+  static size_t large_page_size();
+
+  // Allocates _size bytes, from the current region if it has enough space.
+  virtual void* Allocate(size_t _size, size_t _alignment);
+
+  // Deallocates _block. Its region is unmapped if it has no more live block.
+  virtual void Deallocate(void* _block);
+
+  // Reallocates _block, by allocating a new block and copying content.
+  virtual void* Reallocate(void* _block, size_t _size, size_t _alignment);
+
+ private:
+  // Disables copy and assignment.
+  LargePageAllocator(const LargePageAllocator&);
+  void operator=(const LargePageAllocator&);
+
+  // Region header, stored at the beginning of each region.
+  struct Region;
+
+  // Maps a region of at least _size bytes.
+  Region* MapRegion(size_t _size);
+
+  // Unmaps _region.
+  void UnmapRegion(Region* _region);
+
+  // Minimum regions size.
+  size_t region_size_;
+
+  // Region blocks are currently allocated from.
+  Region* current_;
+
+  // Statistics.
+  size_t mapped_bytes_;
+  size_t large_page_bytes_;
+};
+}  // namespace memory
+}  // namespace ozz
+#endif  // OZZ_OZZ_BASE_MEMORY_LARGE_PAGE_ALLOCATOR_H_
@@ -0,0 +1,97 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_BASE_MEMORY_LINEAR_ALLOCATOR_H_
+#define OZZ_OZZ_BASE_MEMORY_LINEAR_ALLOCATOR_H_
+
+#include "ozz/base/memory/allocator.h"
+
+namespace ozz {
+namespace memory {
+
+// Implements a linear (aka frame or arena) allocator. Blocks are allocated
+// sequentially from a single fixed size buffer, in O(1) and without any lock.
+// Memory is released all at once with Reset(), typically at the end of a
+// frame. Deallocating a block has no effect, unless it's the last allocated
+// one, in which case its memory is released (last-in-first-out).
+// A LinearAllocator isn't thread safe, so the intended usage is one instance
+// per thread, see SetThreadScratchAllocator().
+class LinearAllocator : public Allocator {
+ public:
+  // Constructs an allocator that uses the _size bytes of _buffer. _buffer
+  // isn't owned by the allocator, and must outlive it.
+  LinearAllocator(void* _buffer, size_t _size);
+
+  // Constructs an allocator that owns a _size bytes buffer, allocated from the
+  // default allocator.
+  explicit LinearAllocator(size_t _size);
+
+  virtual ~LinearAllocator();
+
+  // Releases all blocks at once. Previously allocated blocks must not be used
+  // anymore.
+  void Reset();
+
+  // Gets buffer size in bytes.
+  size_t capacity() const { return static_cast<size_t>(end_ - begin_); }
+
+  // Gets the number of bytes currently in use, including alignment padding
+  // and block headers.
+  size_t used() const { return static_cast<size_t>(current_ - begin_); }
+
+  // Allocates _size bytes on the specified _alignment boundaries.
+  // Returns NULL if the buffer is exhausted.
+  virtual void* Allocate(size_t _size, size_t _alignment);
+
+  // Releases _block memory if it's the last allocated block, does nothing
+  // otherwise. _block can be NULL.
+  virtual void Deallocate(void* _block);
+
+  // Resizes _block in place if it's the last allocated block, otherwise
+  // allocates a new block and copies _block content.
+  // Returns NULL if the buffer is exhausted, in which case _block is left
+  // unchanged.
+  virtual void* Reallocate(void* _block, size_t _size, size_t _alignment);
+
+ private:
+  // Disables copy and assignment.
+  LinearAllocator(const LinearAllocator&);
+  void operator=(const LinearAllocator&);
+
+  // Buffer range.
+  char* begin_;
+  char* end_;
+
+  // Beginning of buffer free space.
+  char* current_;
+
+  // Is the buffer owned by the allocator.
+  bool owned_;
+};
+}  // namespace memory
+}  // namespace ozz
+#endif  // OZZ_OZZ_BASE_MEMORY_LINEAR_ALLOCATOR_H_
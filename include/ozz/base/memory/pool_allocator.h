@@ -0,0 +1,89 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_BASE_MEMORY_POOL_ALLOCATOR_H_
+#define OZZ_OZZ_BASE_MEMORY_POOL_ALLOCATOR_H_
+
+#include "ozz/base/memory/allocator.h"
+
+namespace ozz {
+namespace memory {
+
+// Implements a pool of fixed size blocks. Allocation and deallocation pop and
+// push blocks from a free list, in O(1) and without any lock.
+// A PoolAllocator isn't thread safe, so the intended usage is one instance
+// per thread, see SetThreadScratchAllocator().
+class PoolAllocator : public Allocator {
+ public:
+  // Constructs a pool of _block_count blocks of _block_size bytes, each
+  // aligned on _alignment boundaries. _alignment must be a power of two.
+  // Pool memory is allocated from the default allocator.
+  PoolAllocator(size_t _block_size, size_t _block_count, size_t _alignment);
+
+  virtual ~PoolAllocator();
+
+  // Gets the size in bytes of a block.
+  size_t block_size() const { return block_size_; }
+
+  // Gets the number of blocks of the pool.
+  size_t block_count() const { return block_count_; }
+
+  // Gets the number of blocks currently allocated.
+  size_t allocated_count() const { return allocated_count_; }
+
+  // Allocates a block. Returns NULL if the pool is exhausted, or if _size or
+  // _alignment are bigger than pool blocks ones.
+  virtual void* Allocate(size_t _size, size_t _alignment);
+
+  // Returns _block to the pool. _block can be NULL.
+  virtual void Deallocate(void* _block);
+
+  // Returns _block unchanged if _size and _alignment fit in a pool block, or
+  // allocates a new block if _block is NULL. Returns NULL otherwise, in which
+  // case _block is left unchanged.
+  virtual void* Reallocate(void* _block, size_t _size, size_t _alignment);
+
+ private:
+  // Disables copy and assignment.
+  PoolAllocator(const PoolAllocator&);
+  void operator=(const PoolAllocator&);
+
+  // Pool buffer.
+  char* buffer_;
+
+  // Head of the free blocks list. Each free block stores a pointer to the
+  // next one.
+  void* free_list_;
+
+  size_t block_size_;
+  size_t block_count_;
+  size_t alignment_;
+  size_t allocated_count_;
+};
+}  // namespace memory
+}  // namespace ozz
+#endif  // OZZ_OZZ_BASE_MEMORY_POOL_ALLOCATOR_H_
@@ -0,0 +1,104 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+#ifndef OZZ_OZZ_BASE_MEMORY_THREAD_CACHING_ALLOCATOR_H_
+#define OZZ_OZZ_BASE_MEMORY_THREAD_CACHING_ALLOCATOR_H_
+
+#include "ozz/base/memory/allocator.h"
+
+namespace ozz {
+namespace memory {
+
+// Implements an allocator decorator that caches freed small blocks, so that
+// they can be reused without going back to the decorated allocator. Caches are
+// sharded: each thread is assigned a shard (round-robin) on its first
+// allocation, and only locks this shard, so concurrent threads (ex: job system
+// workers creating and destroying SamplingCache or builders temporaries)
+// rarely contend with each other.
+// Blocks up to kMaxCachedSize bytes are rounded up to power of two size
+// classes. Larger blocks, or blocks requiring an alignment greater than
+// kMinAlignment, are forwarded to the decorated allocator. All blocks are at
+// least kMinAlignment aligned, which fits SIMD types requirements.
+// It can be installed as ozz default allocator:
+//   ThreadCachingAllocator caching(default_allocator());
+//   SetDefaulAllocator(&caching);
+// Caching requires c++11 atomics. In c++98 builds, all allocations are
+// forwarded to the decorated allocator.
+class ThreadCachingAllocator : public Allocator {
+ public:
+  enum {
+    // Minimum alignment of all blocks.
+    kMinAlignment = 16,
+    // Largest block size that's cached.
+    kMaxCachedSize = 4096,
+    // Number of shards threads are distributed on.
+    kNumShards = 16,
+    // Maximum number of cached blocks per size class and shard.
+    kMaxCachedBlocks = 64
+  };
+
+  // Constructs an allocator that forwards allocations to _allocator, which
+  // must outlive *this allocator and be thread safe.
+  explicit ThreadCachingAllocator(Allocator* _allocator);
+
+  // Releases all cached blocks to the decorated allocator.
+  virtual ~ThreadCachingAllocator();
+
+  // Releases all cached blocks to the decorated allocator. Can be called
+  // concurrently to allocations.
+  void Trim();
+
+  // Gets the number of blocks currently cached, from all shards.
+  size_t cached_count() const;
+
+  // Allocates _size bytes, from the calling thread shard cache if possible.
+  virtual void* Allocate(size_t _size, size_t _alignment);
+
+  // Deallocates _block to the calling thread shard cache, or to the decorated
+  // allocator if the cache is full.
+  virtual void Deallocate(void* _block);
+
+  // Reallocates _block, by allocating a new block and copying content.
+  virtual void* Reallocate(void* _block, size_t _size, size_t _alignment);
+
+ private:
+  // Disables copy and assignment.
+  ThreadCachingAllocator(const ThreadCachingAllocator&);
+  void operator=(const ThreadCachingAllocator&);
+
+  // Releases _block to the decorated allocator.
+  void Release(void* _block);
+
+  // Decorated allocator.
+  Allocator* allocator_;
+
+  // Per shard caches, allocated from the decorated allocator.
+  struct Shard;
+  Shard* shards_;
+};
+}  // namespace memory
+}  // namespace ozz
+#endif  // OZZ_OZZ_BASE_MEMORY_THREAD_CACHING_ALLOCATOR_H_
@@ -0,0 +1,124 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_BASE_MEMORY_TRACKING_ALLOCATOR_H_
+#define OZZ_OZZ_BASE_MEMORY_TRACKING_ALLOCATOR_H_
+
+#include "ozz/base/memory/allocator.h"
+
+#if __cplusplus >= 201103L
+#include <atomic>
+#endif  // __cplusplus
+
+namespace ozz {
+namespace memory {
+
+// Defines memory usage statistics of a TrackingAllocator.
+struct AllocationStats {
+  // Number of bytes currently allocated, as requested by users (excluding
+  // alignment and tracking overheads).
+  size_t live_bytes;
+
+  // Highest value of live_bytes.
+  size_t peak_bytes;
+
+  // Number of blocks currently allocated.
+  size_t live_count;
+
+  // Total number of allocations, reallocations included. Measures allocation
+  // churn when compared over time.
+  size_t allocation_count;
+};
+
+// Implements an allocator decorator that forwards allocations to another
+// allocator, while recording memory usage statistics, globally and per
+// AllocationTag. Every block is tagged with the calling thread
+// allocation_tag() when it's allocated.
+// A typical usage is to decorate the default allocator:
+//   TrackingAllocator tracking(default_allocator());
+//   SetDefaulAllocator(&tracking);
+// Statistics are updated atomically in c++11 builds, so *this allocator can be
+// used from multiple threads if the decorated allocator can.
+class TrackingAllocator : public Allocator {
+ public:
+  // Constructs an allocator that forwards allocations to _allocator, which
+  // must outlive *this allocator.
+  explicit TrackingAllocator(Allocator* _allocator);
+
+  // Asserts all blocks were deallocated.
+  virtual ~TrackingAllocator();
+
+  // Gets global statistics.
+  AllocationStats stats() const;
+
+  // Gets statistics of allocations done with _tag.
+  AllocationStats stats(AllocationTag _tag) const;
+
+  // Resets peak_bytes to live_bytes and allocation_count to 0, for all the
+  // statistics, so that a new profiling period can start.
+  void ResetCounters();
+
+  // Allocates _size bytes from the decorated allocator.
+  virtual void* Allocate(size_t _size, size_t _alignment);
+
+  // Deallocates _block to the decorated allocator.
+  virtual void Deallocate(void* _block);
+
+  // Reallocates _block, by allocating a new block and copying content.
+  virtual void* Reallocate(void* _block, size_t _size, size_t _alignment);
+
+ private:
+  // Disables copy and assignment.
+  TrackingAllocator(const TrackingAllocator&);
+  void operator=(const TrackingAllocator&);
+
+#if __cplusplus >= 201103L
+  typedef std::atomic<size_t> Counter;
+#else   // __cplusplus
+  typedef size_t Counter;
+#endif  // __cplusplus
+
+  // Counters matching AllocationStats members.
+  struct Counters {
+    Counter live_bytes;
+    Counter peak_bytes;
+    Counter live_count;
+    Counter allocation_count;
+  };
+
+  static AllocationStats ToStats(const Counters& _counters);
+
+  // Decorated allocator.
+  Allocator* allocator_;
+
+  // Global and per tag counters.
+  Counters global_;
+  Counters tags_[kNumAllocationTags];
+};
+}  // namespace memory
+}  // namespace ozz
+#endif  // OZZ_OZZ_BASE_MEMORY_TRACKING_ALLOCATOR_H_
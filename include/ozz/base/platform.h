@@ -32,6 +32,10 @@
 #include <cassert>
 #include <cstddef>
 
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+#include <xmmintrin.h>
+#endif  // _MSC_VER
+
 namespace ozz {
 
 // Compile time string concatenation.
@@ -116,6 +120,35 @@ struct _AlignOf {
 // Syntax is: void function(int* OZZ_RESTRICT _p);"
 #define OZZ_RESTRICT __restrict
 
+// Hints the processor to fetch the cache line containing _address, before
+// it's read (OZZ_PREFETCH) or written (OZZ_PREFETCH_WRITE). This is only a
+// hint: it doesn't fault on invalid addresses, and compiles to nothing on
+// unsupported compilers.
+// Syntax is: "OZZ_PREFETCH(pointer);"
+#if defined(__GNUC__) || defined(__clang__)
+#define OZZ_PREFETCH(_address) __builtin_prefetch(_address, 0)
+#define OZZ_PREFETCH_WRITE(_address) __builtin_prefetch(_address, 1)
+#elif defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+#define OZZ_PREFETCH(_address) \
+  _mm_prefetch(reinterpret_cast<const char*>(_address), _MM_HINT_T0)
+#define OZZ_PREFETCH_WRITE(_address) OZZ_PREFETCH(_address)
+#else
+#define OZZ_PREFETCH(_address) static_cast<void>(_address)
+#define OZZ_PREFETCH_WRITE(_address) static_cast<void>(_address)
+#endif
+
+// Declares a thread local variable, every thread having its own instance.
+// Variable type must be a POD, as non-trivial construction and destruction
+// aren't supported by all compilers in c++98 mode.
+// Syntax is: "static OZZ_THREAD_LOCAL int i;"
+#if __cplusplus >= 201103L
+#define OZZ_THREAD_LOCAL thread_local
+#elif defined(_MSC_VER)
+#define OZZ_THREAD_LOCAL __declspec(thread)
+#else
+#define OZZ_THREAD_LOCAL __thread
+#endif
+
 // Defines macro to help with DEBUG/NDEBUG syntax.
 #if defined(NDEBUG)
 #define OZZ_IF_DEBUG(...)
@@ -0,0 +1,91 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_BASE_PREPARED_JOB_H_
+#define OZZ_OZZ_BASE_PREPARED_JOB_H_
+
+#include "ozz/base/platform.h"
+
+namespace ozz {
+
+// Wraps a job (like ozz::animation::SamplingJob, BlendingJob, LocalToModelJob
+// or ozz::geometry::SkinningJob) whose configuration is validated once, when
+// it's prepared, instead of every time it runs. Run() then executes the job
+// with _Job::RunUnchecked(), which removes validation cost from batches of
+// small jobs that run every frame with the same buffers.
+// Parameters that aren't validated (like SamplingJob::ratio, or layers weights
+// of a BlendingJob as long as contributing layers don't change) can be
+// updated through job(). Prepare() must be called again whenever a validated
+// parameter (buffers, ranges...) changes.
+template <typename _Job>
+class PreparedJob {
+ public:
+  // Constructs an invalid prepared job, that needs to be prepared before
+  // running.
+  PreparedJob() : valid_(false) {}
+
+  // Constructs a prepared job from _job, see Prepare().
+  explicit PreparedJob(const _Job& _job)
+      : job_(_job), valid_(_job.Validate()) {}
+
+  // Copies _job and validates it. Returns validation result, which is also
+  // returned by valid().
+  bool Prepare(const _Job& _job) {
+    job_ = _job;
+    return Prepare();
+  }
+
+  // Validates job() again, after validated parameters were changed.
+  bool Prepare() {
+    valid_ = job_.Validate();
+    return valid_;
+  }
+
+  // Tells if job is valid, as validated by the latest Prepare().
+  bool valid() const { return valid_; }
+
+  // Gives access to the prepared job, in order to update its non validated
+  // parameters.
+  _Job& job() { return job_; }
+  const _Job& job() const { return job_; }
+
+  // Runs the job without validating it again. Returns false if the job wasn't
+  // valid when it was prepared, in which case nothing is run.
+  bool Run() const {
+    if (!valid_) {
+      return false;
+    }
+    job_.RunUnchecked();
+    return true;
+  }
+
+ private:
+  _Job job_;
+  bool valid_;
+};
+}  // namespace ozz
+#endif  // OZZ_OZZ_BASE_PREPARED_JOB_H_
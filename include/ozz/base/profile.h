@@ -0,0 +1,103 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#ifndef OZZ_OZZ_BASE_PROFILE_H_
+#define OZZ_OZZ_BASE_PROFILE_H_
+
+#include "ozz/base/platform.h"
+
+// Proposes an instrumentation interface, so that runtime jobs phases can be
+// seen in an external profiler (like Tracy, Superluminal or PIX). Jobs
+// declare scoped zones with OZZ_PROFILE_ZONE macro, which are forwarded to
+// user installed callbacks (see SetCallbacks). Zones are compiled out
+// by default, and compiled in only when OZZ_BUILD_PROFILE is defined (see
+// ozz_build_profile cmake option).
+
+namespace ozz {
+namespace profile {
+
+// Defines callbacks invoked when a zone is entered and left. _name is a
+// static string, whose address is the same for every instance of a zone, so
+// it can be used as a zone identifier. Zones are strictly nested per thread.
+// Callbacks are invoked from the thread running the job, so they must be
+// thread safe if jobs are run concurrently.
+struct Callbacks {
+  Callbacks() : begin(NULL), end(NULL), user_data(NULL) {}
+
+  void (*begin)(const char* _name, void* _user_data);
+  void (*end)(const char* _name, void* _user_data);
+  void* user_data;
+};
+
+// Installs zone callbacks, and returns previous ones. Default callbacks are
+// NULL, in which case zones do nothing. Callbacks shouldn't be changed while
+// jobs are running.
+Callbacks SetCallbacks(const Callbacks& _callbacks);
+
+// Gets installed zone callbacks.
+const Callbacks& GetCallbacks();
+
+// Scoped zone, invoking begin callback on construction and end callback on
+// destruction. Prefer OZZ_PROFILE_ZONE macro, which is compiled out by
+// default.
+class Zone {
+ public:
+  explicit Zone(const char* _name) : name_(_name) {
+    const Callbacks& callbacks = GetCallbacks();
+    if (callbacks.begin) {
+      callbacks.begin(_name, callbacks.user_data);
+    }
+  }
+  ~Zone() {
+    const Callbacks& callbacks = GetCallbacks();
+    if (callbacks.end) {
+      callbacks.end(name_, callbacks.user_data);
+    }
+  }
+
+ private:
+  // Disables copy and assignment.
+  Zone(const Zone&);
+  void operator=(const Zone&);
+
+  const char* name_;
+};
+}  // namespace profile
+}  // namespace ozz
+
+// Declares a zone named _name (a string literal), lasting until the end of
+// the enclosing scope.
+#ifdef OZZ_BUILD_PROFILE
+#define OZZ_PROFILE_ZONE(_name) \
+  const ozz::profile::Zone OZZ_JOIN(ozz_profile_zone_, __LINE__)(_name)
+#else  // OZZ_BUILD_PROFILE
+#define OZZ_PROFILE_ZONE(_name) \
+  do {                          \
+  } while (void(0), 0)
+#endif  // OZZ_BUILD_PROFILE
+#endif  // OZZ_OZZ_BASE_PROFILE_H_
@@ -0,0 +1,148 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#ifndef OZZ_OZZ_BASE_TASK_SCHEDULER_H_
+#define OZZ_OZZ_BASE_TASK_SCHEDULER_H_
+
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/platform.h"
+
+namespace ozz {
+
+// Defines the task scheduler interface used by ozz jobs to dispatch tasks
+// concurrently. ozz doesn't own any thread: implementations are expected to
+// forward tasks to the application's own thread pool or job system.
+class TaskScheduler {
+ public:
+  // Defines the task function type. _index is the index of the task to run, in
+  // range [0, _count[ of ParallelFor call.
+  typedef void (*Task)(void* _context, int _index);
+
+  // Default virtual destructor.
+  virtual ~TaskScheduler() {}
+
+  // Runs _task(_context, i) for each i in range [0, _count[. Tasks can be run
+  // concurrently and in any order, but all of them must be completed when the
+  // function returns.
+  virtual void ParallelFor(Task _task, void* _context, int _count) = 0;
+};
+
+// Runs _task(_context, i) for each i in range [0, _count[, using _scheduler if
+// any, or sequentially (in order) from the calling thread if _scheduler is
+// NULL. Nothing is run if _count is lower or equal to 0.
+void ParallelFor(TaskScheduler* _scheduler, TaskScheduler::Task _task,
+                 void* _context, int _count);
+
+// Gathers heterogeneous tasks (each with its own function and context), that
+// are dispatched concurrently with a single ParallelFor call when Wait() is
+// called. A group can be reused once waited.
+class TaskGroup {
+ public:
+  // Constructs a group whose tasks are dispatched to _scheduler. _scheduler
+  // can be NULL, in which case tasks are run sequentially by Wait().
+  explicit TaskGroup(TaskScheduler* _scheduler);
+
+  // Runs any pending task before destruction.
+  ~TaskGroup();
+
+  // Pushes _task to the group. _task will be called with _context and index
+  // 0. Nothing is run until Wait() is called.
+  void Add(TaskScheduler::Task _task, void* _context);
+
+  // Runs all pending tasks and waits for their completion. Tasks are cleared
+  // afterward.
+  void Wait();
+
+  // Gets the number of pending tasks.
+  int size() const { return static_cast<int>(tasks_.size()); }
+
+ private:
+  // Disables copy and assignment.
+  TaskGroup(const TaskGroup&);
+  void operator=(const TaskGroup&);
+
+  // ParallelFor task that runs the pending task at _index.
+  static void RunTask(void* _context, int _index);
+
+  struct Entry {
+    TaskScheduler::Task task;
+    void* context;
+  };
+  ozz::Vector<Entry>::Std tasks_;
+
+  TaskScheduler* scheduler_;
+};
+
+namespace internal {
+// ParallelFor context of RunJobs function.
+template <typename _Job>
+struct RunJobsContext {
+  const _Job* jobs;
+  int count;
+  int grain_size;
+
+  static void Run(void* _context, int _index) {
+    const RunJobsContext& context = *static_cast<RunJobsContext*>(_context);
+    const int begin = _index * context.grain_size;
+    const int end = begin + context.grain_size < context.count
+                        ? begin + context.grain_size
+                        : context.count;
+    for (int i = begin; i < end; ++i) {
+      context.jobs[i].Run();
+    }
+  }
+};
+}  // namespace internal
+
+// Runs a batch of jobs concurrently, using _scheduler if any, or sequentially
+// from the calling thread otherwise. _jobs can be a range of any ozz job type
+// with Validate() and Run() functions, like SamplingJob, BatchSamplingJob,
+// BlendingJob, LocalToModelJob or SkinningJob. Jobs are dispatched by groups of
+// _grain_size, which amortizes scheduling cost of small jobs.
+// Jobs are all validated from the calling thread before any of them is run.
+// Returns false, without running any job, if any of them is invalid, or if
+// _grain_size is lower or equal to 0.
+template <typename _Job>
+bool RunJobs(const Range<_Job>& _jobs, TaskScheduler* _scheduler,
+             int _grain_size = 1) {
+  if (_grain_size <= 0) {
+    return false;
+  }
+  const int count = static_cast<int>(_jobs.count());
+  for (int i = 0; i < count; ++i) {
+    if (!_jobs.begin[i].Validate()) {
+      return false;
+    }
+  }
+  internal::RunJobsContext<_Job> context = {_jobs.begin, count, _grain_size};
+  ParallelFor(_scheduler, &internal::RunJobsContext<_Job>::Run, &context,
+              (count + _grain_size - 1) / _grain_size);
+  return true;
+}
+}  // namespace ozz
+#endif  // OZZ_OZZ_BASE_TASK_SCHEDULER_H_
@@ -0,0 +1,106 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#ifndef OZZ_OZZ_BASE_THREAD_POOL_H_
+#define OZZ_OZZ_BASE_THREAD_POOL_H_
+
+#include "ozz/base/task_scheduler.h"
+
+namespace ozz {
+
+// Implements TaskScheduler with a pool of persistent worker threads, for tools
+// and applications that don't have their own job system. Threads are created
+// once by the constructor, and sleep while there's no task to run, so no
+// thread is created or destroyed by ParallelFor calls.
+// The calling thread of ParallelFor also runs tasks. Task range is initially
+// split in contiguous blocks, one per thread, that are stored in per-thread
+// queues. A thread pops tasks from the front of its own queue, and steals the
+// upper half of another thread queue once its own is empty (work stealing),
+// which balances load when tasks don't have the same cost.
+// Initial distribution also serves as an affinity hint: as long as the number
+// of tasks doesn't change from one call to the next, a task keeps being run by
+// the same thread (unless stolen), so data it touches is likely to still be in
+// that core caches.
+// ParallelFor must not be called concurrently, nor from a task of the same
+// pool. It can be called from a task of another pool though, which allows to
+// partition work across pools, like one pool per NUMA node whose threads are
+// pinned to the node (see ThreadInit), each sampling instances whose data were
+// allocated from node local memory.
+// Threads require c++11 and threading support when ozz is built, see
+// num_threads(). Otherwise all tasks are run sequentially by the calling
+// thread.
+class ThreadPool : public TaskScheduler {
+ public:
+  enum {
+    // Maximum number of threads of the pool, including the calling thread.
+    kMaxThreads = 64
+  };
+
+  // Defines the function called by each worker thread when it starts, before
+  // running any task. _thread_index is in range [1, num_threads()[, 0 being
+  // the calling thread of ParallelFor. This allows applications to name
+  // threads, set their priority, or pin them to a set of cores (like a NUMA
+  // node), with the platform API.
+  typedef void (*ThreadInit)(void* _user_data, int _thread_index);
+
+  // Constructs a pool of _num_threads threads, including the calling thread of
+  // ParallelFor (so _num_threads - 1 worker threads are created). 0 selects
+  // hardware concurrency. Number of threads is clamped to range [1,
+  // kMaxThreads]. _thread_init, if not NULL, is called with _user_data by
+  // each worker thread when it starts.
+  explicit ThreadPool(int _num_threads = 0, ThreadInit _thread_init = NULL,
+                      void* _user_data = NULL);
+
+  // Stops and joins all worker threads.
+  virtual ~ThreadPool();
+
+  // Runs _task(_context, i) for each i in range [0, _count[ with all pool
+  // threads, and returns once all tasks are completed.
+  virtual void ParallelFor(Task _task, void* _context, int _count);
+
+  // Gets the number of threads tasks are run on, including the calling
+  // thread. This is always 1 if ozz was built without threading support.
+  int num_threads() const;
+
+  // Gets the number of times a thread stole tasks from another thread queue,
+  // since the pool was created. This allows to monitor load balancing: a low
+  // number means initial distribution was already balanced.
+  int num_steals() const;
+
+ private:
+  // Disables copy and assignment.
+  ThreadPool(const ThreadPool&);
+  void operator=(const ThreadPool&);
+
+  // Threads, queues and synchronization primitives, private to the
+  // implementation. NULL if pool has a single thread.
+  struct Impl;
+  Impl* impl_;
+};
+}  // namespace ozz
+#endif  // OZZ_OZZ_BASE_THREAD_POOL_H_
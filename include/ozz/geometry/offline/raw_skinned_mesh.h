@@ -0,0 +1,106 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_GEOMETRY_OFFLINE_RAW_SKINNED_MESH_H_
+#define OZZ_OZZ_GEOMETRY_OFFLINE_RAW_SKINNED_MESH_H_
+
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/maths/vec_float.h"
+
+namespace ozz {
+namespace geometry {
+namespace offline {
+
+// Off-line skinned mesh type.
+// This mesh type is not intended to be used at runtime. It is used to define
+// the offline indexed triangle mesh that can be converted to SkinningJob ready
+// vertex streams using the SkinnedMeshBuilder. Vertex attributes and skinning
+// data are exposed as public std::vector's, one element per vertex (or
+// influences_count elements for joint indices and weights), that can be filled
+// freely as long as the mesh satisfies Validate() requirements.
+struct RawSkinnedMesh {
+  // Constructs a valid RawSkinnedMesh, with a single influence per vertex.
+  RawSkinnedMesh();
+
+  // Deallocates mesh vectors.
+  ~RawSkinnedMesh();
+
+  // Tests for *this validity.
+  // Returns true on success or false on failure if:
+  // - influences_count is less than 1.
+  // - normals, tangents, uvs or colors are not empty and don't have the same
+  // number of elements as positions (4 colors components per vertex).
+  // - tangents are provided without normals.
+  // - joint_indices or joint_weights don't have influences_count elements per
+  // vertex.
+  // - a joint weight is negative, or the sum of the weights of a vertex is
+  // zero.
+  // - the number of triangle indices isn't a multiple of 3, or an index is out
+  // of vertices range.
+  bool Validate() const;
+
+  // Returns the number of vertices of *this mesh.
+  int vertex_count() const { return static_cast<int>(positions.size()); }
+
+  // Returns the number of triangles of *this mesh.
+  int triangle_count() const {
+    return static_cast<int>(triangle_indices.size() / 3);
+  }
+
+  // Number of joint indices and weights per vertex. Unused influences of a
+  // vertex have a 0 weight, whatever their order.
+  int influences_count;
+
+  // Vertex positions.
+  ozz::Vector<math::Float3>::Std positions;
+
+  // Optional vertex normals.
+  ozz::Vector<math::Float3>::Std normals;
+
+  // Optional vertex tangents, w being the handedness (-1 or 1).
+  ozz::Vector<math::Float4>::Std tangents;
+
+  // Optional vertex texture coordinates.
+  ozz::Vector<math::Float2>::Std uvs;
+
+  // Optional vertex colors, 4 rgba components per vertex.
+  ozz::Vector<uint8_t>::Std colors;
+
+  // Joint indices, influences_count per vertex.
+  ozz::Vector<uint16_t>::Std joint_indices;
+
+  // Joint weights, influences_count per vertex. Weights don't need to be sorted
+  // nor normalized.
+  ozz::Vector<float>::Std joint_weights;
+
+  // Triangle list indices, 3 per triangle.
+  ozz::Vector<uint32_t>::Std triangle_indices;
+};
+}  // namespace offline
+}  // namespace geometry
+}  // namespace ozz
+#endif  // OZZ_OZZ_GEOMETRY_OFFLINE_RAW_SKINNED_MESH_H_
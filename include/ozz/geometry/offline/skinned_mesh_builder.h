@@ -0,0 +1,192 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_GEOMETRY_OFFLINE_SKINNED_MESH_BUILDER_H_
+#define OZZ_OZZ_GEOMETRY_OFFLINE_SKINNED_MESH_BUILDER_H_
+
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/maths/vec_float.h"
+#include "ozz/geometry/runtime/skinning_job.h"
+
+namespace ozz {
+namespace geometry {
+namespace offline {
+
+// Forward declares the offline mesh type.
+struct RawSkinnedMesh;
+
+// Defines the output of the SkinnedMeshBuilder: vertex streams ready to be
+// bound to a SkinningJob (or uploaded to the gpu), and optimized triangle
+// indices.
+// Vertices are sorted by increasing number of influences, as described by
+// influences_buckets, so that the whole mesh can be skinned by a single job.
+// All streams are tightly packed byte buffers, whose format is specified by
+// the builder.
+struct SkinnedMesh {
+  SkinnedMesh();
+  ~SkinnedMesh();
+
+  // Number of vertices.
+  int vertex_count;
+
+  // Maximum number of influences per vertex, see
+  // SkinningJob::influences_count.
+  int influences_count;
+
+  // Number of consecutive vertices per number of influences, see
+  // SkinningJob::influences_buckets.
+  ozz::Vector<int>::Std influences_buckets;
+
+  // Ranges of consecutive single influence vertices bound to the same joint,
+  // covering the first vertices of the mesh, see SkinningJob::rigid_ranges.
+  ozz::Vector<SkinningJob::RigidRange>::Std rigid_ranges;
+
+  // Index of the RawSkinnedMesh vertex each vertex is built from. This allows
+  // to reorder any other per-vertex data (like morph targets) the same way.
+  ozz::Vector<uint32_t>::Std vertex_remap;
+
+  // Triangle list indices, 3 per triangle, reordered for post-transform
+  // vertex cache efficiency.
+  ozz::Vector<uint32_t>::Std triangle_indices;
+
+  // Vertex positions, normals and tangents streams, with their format. Streams
+  // are empty if the RawSkinnedMesh doesn't have the corresponding attribute.
+  // kSnorm10x3_2 tangents store handedness in the 2 bits w component (1 or -1
+  // as a signed 2 bits integer).
+  ozz::Vector<uint8_t>::Std positions;
+  SkinningJob::Format positions_format;
+  ozz::Vector<uint8_t>::Std normals;
+  SkinningJob::Format normals_format;
+  ozz::Vector<uint8_t>::Std tangents;
+  SkinningJob::Format tangents_format;
+
+  // Vertex texture coordinates and colors (4 components per vertex), which
+  // aren't skinned, reordered from the RawSkinnedMesh.
+  ozz::Vector<math::Float2>::Std uvs;
+  ozz::Vector<uint8_t>::Std colors;
+
+  // Joint indices stream, as uint16_t or uint8_t values depending on the
+  // builder joint_indices_format. Every vertex has influences_count indices,
+  // sorted by decreasing weight.
+  ozz::Vector<uint8_t>::Std joint_indices;
+  size_t joint_indices_stride;
+
+  // Joint weights stream, as float, uint8_t or uint16_t values depending on the
+  // builder joint_weights_format. Every vertex has influences_count - 1
+  // weights, the last one being restored by the SkinningJob.
+  ozz::Vector<uint8_t>::Std joint_weights;
+  size_t joint_weights_stride;
+};
+
+// Defines the class responsible of building SkinningJob ready vertex streams
+// from an offline raw skinned mesh. The builder:
+// - limits the number of influences per vertex and renormalizes weights.
+// - reorders triangles to maximize post-transform vertex cache hits, using
+// Tom Forsyth's linear-speed vertex cache optimization algorithm.
+// - sorts vertices by increasing number of influences, then by dominant
+// (highest weight) joint, then by first use in the triangle list. Vertices
+// skinned consecutively share the same joint matrices, improving palette
+// locality, while triangles keep fetching vertices from a compact range.
+// - groups single influence vertices bound to the same joint in rigid ranges,
+// which are moved first.
+// - quantizes vertex streams to SkinningJob supported formats.
+class SkinnedMeshBuilder {
+ public:
+  // Joint indices output formats.
+  enum JointIndicesFormat {
+    kIndicesUint16,  // Matches SkinningJob::joint_indices.
+    kIndicesUint8,   // Matches SkinningJob::joint_indices_u8.
+  };
+
+  // Joint weights output formats.
+  enum JointWeightsFormat {
+    kWeightsFloat,    // Matches SkinningJob::joint_weights.
+    kWeightsUnorm8,   // Matches SkinningJob::joint_weights_u8.
+    kWeightsUnorm16,  // Matches SkinningJob::joint_weights_u16.
+  };
+
+  // Initializes the builder with default parameters.
+  SkinnedMeshBuilder();
+
+  // Builds _output from _input mesh and *this builder parameters.
+  // Returns true on success, or false if:
+  // - _input isn't valid, see RawSkinnedMesh::Validate().
+  // - a format isn't supported by the SkinningJob, like snorm positions.
+  // - compact joint indices or weights are requested with more than
+  // SkinningJob::kMaxCompactInfluences influences, or if a joint index
+  // doesn't fit in 8 bits.
+  // _output is left unchanged on failure.
+  bool operator()(const RawSkinnedMesh& _input, SkinnedMesh* _output) const;
+
+  // Maximum number of influences per vertex. Less significant influences are
+  // removed and weights renormalized. 0 means no limit.
+  // Default value is 0.
+  int max_influences;
+
+  // Minimum number of vertices of an influences bucket. Vertices of smaller
+  // buckets are moved to the next bucket (with a 0 weight extra influence),
+  // limiting SkinningJob per-bucket overhead.
+  // Default value is 0.
+  int min_bucket_size;
+
+  // Reorders triangles for post-transform vertex cache efficiency.
+  // Default value is true.
+  bool optimize_vertex_cache;
+
+  // Size of the simulated vertex cache used to optimize triangles order.
+  // Default value is 32.
+  int vertex_cache_size;
+
+  // Sorts vertices of an influences bucket by dominant joint. Vertices are
+  // sorted by first use in the triangle list only otherwise.
+  // Default value is true.
+  bool sort_by_joint;
+
+  // Minimum number of single influence vertices bound to a joint to build a
+  // rigid range for this joint (see SkinningJob::rigid_ranges). Rigid ranges
+  // are moved to the front of the single influence bucket. Other single
+  // influence vertices are skinned with the generic code path, as very small
+  // ranges would cost more than they save. Rigid ranges require
+  // sort_by_joint. 0 disables rigid ranges.
+  // Default value is 16.
+  int min_rigid_range_size;
+
+  // Output vertex streams formats. Positions can only be kFloat3 or kHalf3.
+  // Default values are kFloat3.
+  SkinningJob::Format positions_format;
+  SkinningJob::Format normals_format;
+  SkinningJob::Format tangents_format;
+
+  // Output joint indices and weights formats.
+  // Default values are kIndicesUint16 and kWeightsFloat.
+  JointIndicesFormat joint_indices_format;
+  JointWeightsFormat joint_weights_format;
+};
+}  // namespace offline
+}  // namespace geometry
+}  // namespace ozz
+#endif  // OZZ_OZZ_GEOMETRY_OFFLINE_SKINNED_MESH_BUILDER_H_
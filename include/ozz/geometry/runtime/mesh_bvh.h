@@ -0,0 +1,188 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#ifndef OZZ_OZZ_GEOMETRY_RUNTIME_MESH_BVH_H_
+#define OZZ_OZZ_GEOMETRY_RUNTIME_MESH_BVH_H_
+
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/maths/box.h"
+#include "ozz/base/maths/vec_float.h"
+#include "ozz/base/platform.h"
+
+namespace ozz {
+namespace math {
+struct Float4x4;
+}  // namespace math
+namespace geometry {
+namespace internal {
+// Triangle description used while building the hierarchy.
+struct BvhTriangle;
+}  // namespace internal
+
+// Describes the closest triangle hit by a ray, see MeshBvh::Raycast().
+struct MeshBvhHit {
+  // Distance from ray origin to the hit point, in ray direction length unit.
+  float distance;
+
+  // Index of the triangle hit, in mesh triangles order.
+  int triangle;
+
+  // Hit point and unit triangle normal. Normal follows triangle winding.
+  math::Float3 point;
+  math::Float3 normal;
+};
+
+// Bounding volume hierarchy over the triangles of a mesh, for ray and overlap
+// queries faster than testing every triangle.
+// The hierarchy is built once, usually from the bind pose, as its topology
+// only depends on triangles repartition. Animated (skinned) meshes then refit
+// the bounds of the hierarchy every frame, bottom-up, which is linear in the
+// number of triangles and much cheaper than building. Refitting is either
+// exact, from skinned vertices (like SkinningJob output), or conservative,
+// from the skinning matrices of the joints influencing each leaf. The quality
+// of the hierarchy decreases as the pose gets far from the one it was built
+// with, but queries remain correct.
+// Queries aren't thread safe with build and refit, but can run concurrently.
+class MeshBvh {
+ public:
+  enum {
+    // Maximum number of triangles per leaf.
+    kMaxLeafTriangles = 4,
+  };
+
+  // Constructs an empty hierarchy, with invalid bounds.
+  MeshBvh();
+
+  // Builds the hierarchy over _indices triangles (3 vertex indices per
+  // triangle) whose vertices are read from _positions (3 float values per
+  // vertex), with _positions_stride bytes between each vertex. Any joint
+  // refit setup is reset.
+  // Returns false and leaves the hierarchy empty if _indices count isn't a
+  // multiple of 3, if _positions_stride is lower than 3 floats, or if any
+  // index is outside of _positions.
+  bool Build(const Range<const uint16_t>& _indices,
+             const Range<const float>& _positions, size_t _positions_stride);
+
+  // Sets up conservative refitting from joint matrices, see Refit(). Every
+  // vertex is influenced by _influences_count joint indices, read from
+  // _joint_indices with _joint_indices_stride bytes between each vertex (like
+  // SkinningJob::joint_indices). Joints with a null weight can be included, at
+  // the cost of looser bounds. Bounds are computed from the positions the
+  // hierarchy was built with, which must thus be the bind pose.
+  // Returns false if the hierarchy is empty, if _influences_count isn't
+  // strictly positive, or if _joint_indices is too small for the vertices
+  // used by triangles.
+  bool SetupJointRefit(const Range<const uint16_t>& _joint_indices,
+                       size_t _joint_indices_stride, int _influences_count);
+
+  // Refits hierarchy bounds to skinned _positions, whose layout matches the
+  // one used to build the hierarchy.
+  // Returns false if _positions is too small, or if _positions_stride is
+  // lower than 3 floats.
+  bool Refit(const Range<const float>& _positions, size_t _positions_stride);
+
+  // Conservatively refits hierarchy bounds from skinning _joint_matrices (like
+  // SkinningJob::joint_matrices). A skinned vertex lies within the convex hull
+  // of its bind position transformed by each of its joints, so each leaf is
+  // bounded by the union of its bind pose bounds transformed by each joint
+  // influencing it. Cost only depends on the number of leaves and influences,
+  // and no vertex needs to be skinned.
+  // Returns false if joint refit wasn't setup, or if _joint_matrices doesn't
+  // contain all the joints used.
+  bool Refit(const Range<const math::Float4x4>& _joint_matrices);
+
+  // Finds the closest triangle intersected by the ray starting at _origin,
+  // along _direction (which doesn't need to be normalized). Triangles are
+  // hit from both sides. Triangle vertices are read from _positions, which
+  // must be enclosed by the current hierarchy bounds, like the positions of
+  // the last refit. Hits further than _max_distance are ignored.
+  // Returns true and fills _hit if a triangle is intersected, false
+  // otherwise.
+  bool Raycast(const math::Float3& _origin, const math::Float3& _direction,
+               const Range<const float>& _positions, size_t _positions_stride,
+               float _max_distance, MeshBvhHit* _hit) const;
+
+  // Finds the triangles whose leaf bounds overlap _box. This is a
+  // conservative query, as triangles themselves aren't tested, which also
+  // makes it usable after a joint refit, without skinned positions.
+  // Triangle indices are written to _triangles, up to its capacity.
+  // Returns the number of triangles found, which can be greater than
+  // _triangles capacity.
+  int Overlap(const math::Box& _box, const Range<int>& _triangles) const;
+
+  // Gets hierarchy root bounds, aka mesh bounds. Invalid if empty.
+  math::Box bounds() const;
+
+  // Gets the number of triangles and nodes of the hierarchy.
+  int num_triangles() const { return static_cast<int>(triangles_.size()); }
+  int num_nodes() const { return static_cast<int>(nodes_.size()); }
+
+  // Tells if conservative joint refit is setup, see SetupJointRefit().
+  bool joint_refit() const { return !node_joints_.empty(); }
+
+ private:
+  // Hierarchy node. Leaves (count > 0) reference count triangles starting at
+  // first. Internal nodes (count == 0) first child immediately follows them,
+  // and second child index is first. Nodes are stored in depth-first order,
+  // so children always come after their parent.
+  struct Node {
+    math::Float3 min;
+    int first;
+    math::Float3 max;
+    int count;
+  };
+
+  // Builds nodes of _triangles range [_begin, _end[, recursively.
+  void BuildNode(internal::BvhTriangle* _triangles, int _begin, int _end);
+
+  // Hierarchy nodes, root first.
+  ozz::Vector<Node>::Std nodes_;
+
+  // Triangles vertex indices, in leaves order.
+  ozz::Vector<uint16_t>::Std indices_;
+
+  // Mesh index of each triangle, in leaves order.
+  ozz::Vector<int>::Std triangles_;
+
+  // Number of vertices required by indices.
+  int vertex_count_;
+
+  // Bounds of each leaf at build time, used by joint refit.
+  ozz::Vector<math::Box>::Std bind_bounds_;
+
+  // Joint refit setup: joints influencing each node are in range
+  // [node_joints_[i], node_joints_[i + 1][ of joints_.
+  ozz::Vector<int>::Std node_joints_;
+  ozz::Vector<uint16_t>::Std joints_;
+
+  // Number of joint matrices required by joint refit.
+  int joint_count_;
+};
+}  // namespace geometry
+}  // namespace ozz
+#endif  // OZZ_OZZ_GEOMETRY_RUNTIME_MESH_BVH_H_
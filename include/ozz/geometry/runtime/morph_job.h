@@ -0,0 +1,129 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#ifndef OZZ_OZZ_GEOMETRY_RUNTIME_MORPH_JOB_H_
+#define OZZ_OZZ_GEOMETRY_RUNTIME_MORPH_JOB_H_
+
+#include "ozz/base/platform.h"
+#include "ozz/base/maths/simd_math.h"
+
+namespace ozz {
+namespace geometry {
+
+// Defines a block of 4 morph target deltas, stored as soa to be applied with
+// simd instructions.
+// Blocks of a target must be sorted by increasing vertex indices, including
+// vertices of a block. Unused entries of the last block of a target must have
+// zero deltas and a valid vertex index, like the last used one.
+struct MorphDeltaBlock {
+  // Indices of the 4 vertices modified by the block.
+  int vertices[4];
+
+  // x, y and z position deltas of the 4 vertices.
+  math::SimdFloat4 positions[3];
+
+  // x, y and z normal deltas of the 4 vertices. Should be zero if the target
+  // doesn't modify normals.
+  math::SimdFloat4 normals[3];
+};
+
+// Defines a sparse morph target (aka blend shape), whose delta blocks only
+// store the vertices modified by the target.
+struct MorphTarget {
+  Range<const MorphDeltaBlock> blocks;
+};
+
+// Provides sparse morph targets blending job implementation.
+// The job copies input vertices to outputs, and adds every target deltas
+// scaled by the target weight. Only vertices stored by targets are accessed
+// once inputs are copied, and targets whose weight is 0 are skipped. Inputs
+// and outputs can be the same buffers, in which case the copy is skipped.
+// Output positions and normals can be used directly as SkinningJob inputs.
+// Morphing can also be fused with skinning, see SkinningJob::morph_targets.
+// The job processes vertices [first_vertex, first_vertex + vertex_count[ of
+// targets, which allows morphing a mesh by chunks.
+// The job does not owned the buffers (in/output) and will thus not delete them
+// during job's destruction.
+struct MorphJob {
+  // Default constructor, initializes default values.
+  MorphJob();
+
+  // Validates job parameters.
+  // Returns true for a valid job, false otherwise:
+  // - if any range is invalid. See each range description.
+  // - if first_vertex or vertex_count is negative.
+  // - if there are less weights than targets.
+  // - if positions aren't provided, or if input normals are provided without
+  // output normals.
+  bool Validate() const;
+
+  // Runs job's morphing task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // Index of the first vertex, in targets indexing, of input and output
+  // buffers. Deltas of vertices outside of [first_vertex, first_vertex +
+  // vertex_count[ are ignored.
+  int first_vertex;
+
+  // Number of vertices to process. All input and output arrays must store at
+  // least this number of vertices.
+  int vertex_count;
+
+  // Morph targets to blend.
+  Range<const MorphTarget> targets;
+
+  // Weight of each target, at least as many as targets.
+  Range<const float> weights;
+
+  // Input vertex positions array (3 float values per vertex) and stride
+  // (number of bytes between each position).
+  // Array length must be at least vertex_count * in_positions_stride.
+  Range<const float> in_positions;
+  size_t in_positions_stride;
+
+  // Optional input vertex normals array (3 float values per vertex) and
+  // stride.
+  Range<const float> in_normals;
+  size_t in_normals_stride;
+
+  // Output vertex positions array (3 float values per vertex) and stride.
+  Range<float> out_positions;
+  size_t out_positions_stride;
+
+  // Output vertex normals array (3 float values per vertex) and stride.
+  // Required if input normals are provided. Note that output normals are not
+  // normalized by the job.
+  Range<float> out_normals;
+  size_t out_normals_stride;
+};
+}  // namespace geometry
+}  // namespace ozz
+#endif  // OZZ_OZZ_GEOMETRY_RUNTIME_MORPH_JOB_H_
@@ -0,0 +1,105 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#ifndef OZZ_OZZ_GEOMETRY_RUNTIME_PARALLEL_SKINNING_JOB_H_
+#define OZZ_OZZ_GEOMETRY_RUNTIME_PARALLEL_SKINNING_JOB_H_
+
+#include "ozz/base/task_scheduler.h"
+#include "ozz/geometry/runtime/skinning_job.h"
+
+namespace ozz {
+namespace geometry {
+
+// TaskScheduler used to be declared by ozz geometry library. It's now shared
+// by all ozz jobs, see ozz/base/task_scheduler.h.
+using ozz::TaskScheduler;
+
+// Splits a SkinningJob in chunks of vertices, that can be skinned
+// concurrently.
+// Chunks are sized so that they fit in cpu caches, and their boundaries are
+// aligned on cache lines, so that no cache line of the output buffers is
+// written by two chunks (false sharing). Boundaries are computed from
+// out_positions address and all output strides. This guarantee thus holds
+// for interleaved outputs (out_positions first), and for separate output
+// buffers with the same cache line alignment as out_positions.
+// Chunks can be dispatched to a TaskScheduler with Run() function, or
+// retrieved with GetChunk() to be dispatched by the application itself.
+struct ParallelSkinningJob {
+  // Default constructor, initializes default values.
+  ParallelSkinningJob();
+
+  // Validates job parameters.
+  // Returns true for a valid job, false otherwise:
+  // -if skinning job isn't valid, see SkinningJob::Validate().
+  // -if chunk_size is lower or equal to 0.
+  // -if skinning job uses influences_buckets or rigid_ranges, which can't be
+  // split in chunks. Buckets should be split in separate jobs instead.
+  bool Validate() const;
+
+  // Runs all chunks, using scheduler if any, or sequentially from the calling
+  // thread otherwise.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if job is not valid. See Validate() function.
+  bool Run() const;
+
+  // Runs at most _max_chunks chunks, starting from chunk *_cursor, using
+  // scheduler if any, or sequentially from the calling thread otherwise.
+  // *_cursor is then moved to the next chunk to run, and skinning is complete
+  // once it reaches NumChunks(). This allows to split skinning of a large mesh
+  // in time slices, that can be interleaved with other work. The amount of
+  // work of a slice is bounded by _max_chunks * chunk_size vertices.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if job is not valid, if _cursor is NULL or out of range, or
+  // if _max_chunks is lower or equal to 0.
+  bool Resume(int* _cursor, int _max_chunks) const;
+
+  // Gets the number of chunks the skinning job is split into. Returns 0 if job
+  // isn't valid.
+  int NumChunks() const;
+
+  // Fills _chunk with the skinning job of chunk _index, in range
+  // [0, NumChunks()[. Returns false if the job isn't valid or _index is out of
+  // range.
+  bool GetChunk(int _index, SkinningJob* _chunk) const;
+
+  // The skinning job to split, covering all vertices.
+  SkinningJob job;
+
+  // Minimum number of vertices per chunk. It's rounded up to respect
+  // cache lines alignment. Default value is 512 vertices.
+  int chunk_size;
+
+  // Scheduler used to dispatch chunks. Default value is NULL, meaning chunks
+  // are run sequentially by the calling thread.
+  TaskScheduler* scheduler;
+};
+}  // namespace geometry
+}  // namespace ozz
+#endif  // OZZ_OZZ_GEOMETRY_RUNTIME_PARALLEL_SKINNING_JOB_H_
@@ -33,8 +33,10 @@
 namespace ozz {
 namespace math {
 struct Float4x4;
+struct DualQuaternion;
 }
 namespace geometry {
+struct MorphTarget;
 
 // Provides per-vertex matrix palette skinning job implementation.
 // Skinning is the process of creating the association of skeleton joints with
@@ -61,7 +63,11 @@ namespace geometry {
 // the same depending on the number of joints influencing a vertex (or if there
 // are normals to transform). To maximize performances, application should
 // partition its vertices based on their number of joints influences, and call
-// a different job for every vertices set.
+// a different job for every vertices set. Alternatively, vertices sorted by
+// influences count can be skinned with a single job, using influences_buckets
+// to describe the partition. Single influence vertices can further be grouped
+// in rigid_ranges, which are transformed by a single joint matrix without
+// reading any per-vertex joint index.
 // Joint matrices are accessed using the per-vertex joints indices provided as
 // input. These matrices must be pre-multiplied with the inverse of the skeleton
 // bind-pose matrices. This allows to transform vertices to joints local space.
@@ -76,6 +82,41 @@ struct SkinningJob {
   // Default constructor, initializes default values.
   SkinningJob();
 
+  enum Constants {
+    // Maximum number of influences supported with compact joint indices and
+    // weights formats.
+    kMaxCompactInfluences = 32,
+  };
+
+  // Defines vertex positions, normals and tangents formats, for inputs and
+  // outputs. Formats other than kFloat3 are converted by the job, so that
+  // vertices can be skinned directly from and to gpu vertex buffers. For these
+  // formats, float ranges are only used as byte buffers, whose size must fit
+  // vertex_count vertices of the specified format.
+  enum Format {
+    // 3 32 bits floats. This is the default.
+    kFloat3,
+    // 3 16 bits half floats.
+    kHalf3,
+    // 3 signed normalized 16 bits integers, in range [-1,1]. Only supported by
+    // normals and tangents.
+    kSnorm16x3,
+    // A 32 bits integer packing 3 signed normalized 10 bits integers (x in the
+    // least significant bits), and a 2 bits w component (usually tangents
+    // handedness). w is copied from input to output if both use this format,
+    // or set to 0 otherwise. Only supported by normals and tangents.
+    kSnorm10x3_2,
+  };
+
+  // Defines a range of consecutive vertices rigidly bound to a single joint,
+  // see rigid_ranges.
+  struct RigidRange {
+    // Index of the joint transforming all vertices of the range.
+    int joint;
+    // Number of vertices of the range.
+    int vertex_count;
+  };
+
   // Validates job parameters.
   // Returns true for a valid job, false otherwise:
   // - if any range is invalid. See each range description.
@@ -83,6 +124,19 @@ struct SkinningJob {
   // - if tangents are provided but normals aren't.
   // - if no output is provided while an input is. For example, if input normals
   // are provided, then output normals must also.
+  // - if joint indices or weights are provided in more than one format.
+  // - if compact joint indices or weights are used with more than
+  // kMaxCompactInfluences influences.
+  // - if positions use kSnorm16x3 or kSnorm10x3_2 formats.
+  // - if influences_buckets has more than influences_count entries, or if
+  // its vertex counts don't sum up to vertex_count.
+  // - if rigid_ranges cover more vertices than the leading single influence
+  // ones, or if a rigid range joint is out of joints range.
+  // - if there are less morph_weights than morph_targets, or if
+  // morph_first_vertex is negative.
+  // - if neither or both joint_matrices and joint_dual_quaternions are
+  // provided, or if joint_inverse_transpose_matrices is provided with
+  // joint_dual_quaternions.
   bool Validate() const;
 
   // Runs job's skinning task.
@@ -91,6 +145,13 @@ struct SkinningJob {
   // Returns false if *this job is not valid.
   bool Run() const;
 
+  // Runs job's skinning task without validating the job first, for jobs that
+  // were validated once (see Validate() and ozz::PreparedJob), and whose
+  // vertex count, strides and buffers haven't changed since. Validation is
+  // only asserted in debug builds, the behavior is undefined if *this job
+  // isn't valid.
+  void RunUnchecked() const;
+
   // Number of vertices to transform. All input and output arrays must store at
   // least this number of vertices.
   int vertex_count;
@@ -104,9 +165,40 @@ struct SkinningJob {
   // vertex. The weight of the last joint is restored (weights are normalized).
   int influences_count;
 
+  // Optional table of influence buckets, for vertices sorted by increasing
+  // number of influences. Entry i is the number of consecutive vertices
+  // influenced by i + 1 joints, starting after the vertices of the previous
+  // buckets. The table can't have more than influences_count entries, and
+  // its vertex counts must sum up to vertex_count. Each bucket is internally
+  // skinned with the function specialized for its number of influences.
+  // Joint indices and weights strides are common to all buckets, meaning
+  // they're usually sized for influences_count.
+  Range<const int> influences_buckets;
+
+  // Optional table of rigid ranges, partitioning the first vertices of the
+  // job in consecutive ranges of vertices bound to a single joint. These
+  // vertices must be single influence ones, that is the first vertices of the
+  // job if influences_count is 1, or of the first influences bucket. The
+  // remaining vertices are skinned as usual. Each range is skinned by a
+  // streaming kernel that loads its joint matrix once, instead of reading a
+  // joint index and fetching a matrix for every vertex, which is much faster
+  // for rigid meshes (mechanical or armored parts). Joint indices are still
+  // required, and must match rigid ranges, as they're used for dual
+  // quaternion skinning. See SkinnedMeshBuilder::min_rigid_range_size.
+  Range<const RigidRange> rigid_ranges;
+
   // Array of matrices for each joint. Joint are indexed through indices array.
+  // Must be empty if joint_dual_quaternions is used.
   Range<const math::Float4x4> joint_matrices;
 
+  // Optional array of dual quaternions for each joint, used instead of
+  // joint_matrices to enable dual quaternion skinning. Joint dual quaternions
+  // are blended (and normalized) per vertex, which preserves volume around
+  // twisting joints (no "candy-wrapper" artifact) and requires 2 times smaller
+  // palettes than matrices. Dual quaternions can't represent scale though. See
+  // math::ToDualQuaternion() to convert rigid joint matrices.
+  Range<const math::DualQuaternion> joint_dual_quaternions;
+
   // Optional array of inverse transposed matrices for each joint. If provided,
   // this array is used to transform vectors (normals and tangents), otherwise
   // joint_matrices array is used.
@@ -126,6 +218,11 @@ struct SkinningJob {
   Range<const uint16_t> joint_indices;
   size_t joint_indices_stride;
 
+  // Optional array of 8 bits joints indices, used instead of joint_indices for
+  // meshes using less than 256 joints. joint_indices must be empty if it's
+  // used. Stride is specified with joint_indices_stride.
+  Range<const uint8_t> joint_indices_u8;
+
   // Array of joints weights. This array is used to associate a weight to every
   // joint that influences a vertex. The number of weights required per vertex
   // is "influences_max - 1". The weight for the last joint (for each vertex) is
@@ -136,29 +233,57 @@ struct SkinningJob {
   Range<const float> joint_weights;
   size_t joint_weights_stride;
 
+  // Optional arrays of normalized 8 or 16 bits joints weights, used instead of
+  // joint_weights. Weights are decoded as value / 255 and value / 65535
+  // respectively. Only one weights format can be used at a time. Stride is
+  // specified with joint_weights_stride.
+  // Compact indices and weights reduce skinning input size, and are decoded by
+  // the job into small cache resident buffers.
+  Range<const uint8_t> joint_weights_u8;
+  Range<const uint16_t> joint_weights_u16;
+
   // Input vertex positions array (3 float values per vertex) and stride (number
   // of bytes between each position).
   // Array length must be at least vertex_count * in_positions_stride.
   Range<const float> in_positions;
   size_t in_positions_stride;
+  // Input positions format, default is kFloat3.
+  Format in_positions_format;
 
   // Input vertex normals (3 float values per vertex) array and stride (number
   // of bytes between each normal).
   // Array length must be at least vertex_count * in_normals_stride.
   Range<const float> in_normals;
   size_t in_normals_stride;
+  // Input normals format, default is kFloat3.
+  Format in_normals_format;
 
   // Input vertex tangents (3 float values per vertex) array and stride (number
   // of bytes between each tangent).
   // Array length must be at least vertex_count * in_tangents_stride.
   Range<const float> in_tangents;
   size_t in_tangents_stride;
+  // Input tangents format, default is kFloat3.
+  Format in_tangents_format;
+
+  // Optional morph targets, blended to input positions and normals before
+  // skinning, and their weights (at least as many as targets). Morphing is
+  // fused with skinning: vertices are morphed by batches to cache resident
+  // buffers that are skinned right away, avoiding an intermediate pass over
+  // memory. See MorphJob for morph targets description.
+  Range<const MorphTarget> morph_targets;
+  Range<const float> morph_weights;
+  // Index of the first job vertex in morph targets vertex indexing, allowing
+  // to skin a mesh by chunks. Default is 0.
+  int morph_first_vertex;
 
   // Output vertex positions (3 float values per vertex) array and stride
   // (number of bytes between each position).
   // Array length must be at least vertex_count * out_positions_stride.
   Range<float> out_positions;
   size_t out_positions_stride;
+  // Output positions format, default is kFloat3.
+  Format out_positions_format;
 
   // Output vertex normals (3 float values per vertex) array and stride (number
   // of bytes between each normal).
@@ -169,6 +294,8 @@ struct SkinningJob {
   // Array length must be at least vertex_count * out_normals_stride.
   Range<float> out_normals;
   size_t out_normals_stride;
+  // Output normals format, default is kFloat3.
+  Format out_normals_format;
 
   // Output vertex positions (3 float values per vertex) array and stride
   // (number of bytes between each tangent).
@@ -177,6 +304,18 @@ struct SkinningJob {
   // Array length must be at least vertex_count * out_tangents_stride.
   Range<float> out_tangents;
   size_t out_tangents_stride;
+  // Output tangents format, default is kFloat3.
+  Format out_tangents_format;
+
+  // Enables streaming output mode, for outputs written directly to write
+  // combined memory, like mapped gpu vertex buffers. Default is false.
+  // Vertices are skinned by batches to cache resident buffers, which are then
+  // written to outputs vertex after vertex (positions, normals and then
+  // tangents), so interleaved outputs are written sequentially. Outputs are
+  // never read, and every 4 bytes aligned word is written with a non-temporal
+  // store when available (sse2), bypassing cpu caches. A store fence is
+  // issued before Run() returns.
+  bool streaming_output;
 };
 }  // namespace geometry
 }  // namespace ozz
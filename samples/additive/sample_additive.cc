@@ -353,6 +353,7 @@ class AdditiveBlendSampleApplication : public ozz::sample::Application {
         _im_gui->DoCheckBox("Show binormals", &render_options_.binormals);
         _im_gui->DoCheckBox("Show colors", &render_options_.colors);
         _im_gui->DoCheckBox("Skip skinning", &render_options_.skip_skinning);
+        _im_gui->DoCheckBox("CPU skinning", &render_options_.cpu_skinning);
       }
     }
 
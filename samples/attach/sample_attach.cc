@@ -29,6 +29,7 @@
 #include "ozz/animation/runtime/local_to_model_job.h"
 #include "ozz/animation/runtime/sampling_job.h"
 #include "ozz/animation/runtime/skeleton.h"
+#include "ozz/animation/runtime/socket_job.h"
 
 #include "ozz/base/log.h"
 
@@ -93,17 +94,28 @@ class AttachSampleApplication : public ozz::sample::Application {
       return false;
     }
 
-    // Prepares attached object transformation.
-    // Gets model space transformation of the joint.
-    const ozz::math::Float4x4& joint = models_[attachment_];
-
+    // Prepares attached object transformation, using a SocketJob. Many sockets
+    // of many characters could be evaluated at once the same way.
     // Builds offset transformation matrix.
     const ozz::math::SimdFloat4 translation =
         ozz::math::simd_float4::Load3PtrU(&offset_.x);
+    const ozz::math::Float4x4 offset =
+        ozz::math::Float4x4::Translation(translation);
 
     // Concatenates joint and offset transformations.
-    const ozz::math::Float4x4 transform =
-        joint * ozz::math::Float4x4::Translation(translation);
+    const ozz::animation::SocketJob::Socket socket = {0, attachment_};
+    const ozz::Range<const ozz::math::Float4x4> models = make_range(models_);
+    ozz::math::Float4x4 transform;
+    ozz::animation::SocketJob socket_job;
+    socket_job.sockets = ozz::Range<const ozz::animation::SocketJob::Socket>(
+        &socket, 1);
+    socket_job.offsets = ozz::Range<const ozz::math::Float4x4>(&offset, 1);
+    socket_job.models =
+        ozz::Range<const ozz::Range<const ozz::math::Float4x4> >(&models, 1);
+    socket_job.output = ozz::Range<ozz::math::Float4x4>(&transform, 1);
+    if (!socket_job.Run()) {
+      return false;
+    }
 
     // Prepare rendering.
     const float thickness = .01f;
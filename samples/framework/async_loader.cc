@@ -0,0 +1,120 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "framework/async_loader.h"
+
+#if EMSCRIPTEN
+#include <emscripten/threading.h>
+#endif  // EMSCRIPTEN
+
+namespace ozz {
+namespace sample {
+
+namespace {
+// Checks if platform has threading support.
+bool HasThreadingSupport() {
+#ifdef EMSCRIPTEN
+  return emscripten_has_threading_support();
+#else   // EMSCRIPTEN
+  return true;
+#endif  // EMSCRIPTEN
+}
+}  // namespace
+
+AsyncLoader::AsyncLoader(int _num_threads) : pending_(0), exit_(false) {
+  if (!HasThreadingSupport()) {
+    return;
+  }
+  int num_threads = _num_threads;
+  if (num_threads <= 0) {
+    num_threads = static_cast<int>(std::thread::hardware_concurrency());
+  }
+  if (num_threads <= 0) {
+    num_threads = 1;
+  }
+  for (int i = 0; i < num_threads; ++i) {
+    threads_.push_back(std::thread(&AsyncLoader::Work, this));
+  }
+}
+
+AsyncLoader::~AsyncLoader() {
+  Wait();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    exit_ = true;
+  }
+  wake_.notify_all();
+  for (size_t i = 0; i < threads_.size(); ++i) {
+    threads_[i].join();
+  }
+}
+
+std::future<bool> AsyncLoader::Push(std::packaged_task<bool()> _task) {
+  std::future<bool> future = _task.get_future();
+  if (threads_.empty()) {
+    _task();
+    return future;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    queue_.push_back(std::move(_task));
+    ++pending_;
+  }
+  wake_.notify_one();
+  return future;
+}
+
+void AsyncLoader::Wait() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  idle_.wait(lock, [this] { return pending_ == 0; });
+}
+
+void AsyncLoader::Work() {
+  for (;;) {
+    std::packaged_task<bool()> task;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      wake_.wait(lock, [this] { return exit_ || !queue_.empty(); });
+      if (queue_.empty()) {
+        return;
+      }
+      task = std::move(queue_.front());
+      queue_.pop_front();
+    }
+
+    task();
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (--pending_ == 0) {
+        idle_.notify_all();
+      }
+    }
+  }
+}
+}  // namespace sample
+}  // namespace ozz
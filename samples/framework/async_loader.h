@@ -0,0 +1,162 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_SAMPLES_FRAMEWORK_ASYNC_LOADER_H_
+#define OZZ_SAMPLES_FRAMEWORK_ASYNC_LOADER_H_
+
+#include <cassert>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+
+#include "ozz/base/containers/deque.h"
+#include "ozz/base/containers/string.h"
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/io/archive.h"
+#include "ozz/base/io/stream.h"
+#include "ozz/base/log.h"
+#include "ozz/base/platform.h"
+
+namespace ozz {
+namespace sample {
+
+// Loads an object of type _Ty (skeleton, animation, track, mesh...) from an
+// ozz archive file named _filename. Fails and returns false if the file cannot
+// be opened or if it is not a valid _Ty archive.
+template <typename _Ty>
+bool LoadArchive(const char* _filename, _Ty* _object) {
+  assert(_filename && _object);
+  ozz::io::File file(_filename, "rb");
+  if (!file.opened()) {
+    ozz::log::Err() << "Failed to open file " << _filename << "."
+                    << std::endl;
+    return false;
+  }
+  ozz::io::IArchive archive(&file);
+  if (!archive.TestTag<_Ty>()) {
+    ozz::log::Err() << "Failed to load instance from file " << _filename
+                    << "." << std::endl;
+    return false;
+  }
+
+  // Once the tag is validated, reading cannot fail.
+  archive >> *_object;
+  return true;
+}
+
+// Loads archives asynchronously, decoding them on a pool of worker threads.
+// Objects are preallocated by the caller, and must remain valid until their
+// loading completes. Completion can be waited for through the returned
+// futures, notified with a callback (invoked from the worker thread), or
+// waited for globally with Wait().
+// Loads are executed synchronously by the calling thread if the platform
+// doesn't support threading.
+class AsyncLoader {
+ public:
+  // Completion callback, receiving load success.
+  typedef std::function<void(bool)> Callback;
+
+  // Starts _num_threads worker threads, or as many as hardware threads if
+  // _num_threads is 0.
+  explicit AsyncLoader(int _num_threads = 0);
+
+  // Waits for all queued loads to complete, and stops worker threads.
+  ~AsyncLoader();
+
+  // Gets the number of worker threads.
+  int num_threads() const { return static_cast<int>(threads_.size()); }
+
+  // Queues loading of archive file _filename to _object.
+  template <typename _Ty>
+  std::future<bool> Load(const char* _filename, _Ty* _object,
+                         const Callback& _callback = Callback()) {
+    assert(_filename && _object);
+    const ozz::String::Std filename(_filename);
+    return Push(std::packaged_task<bool()>([filename, _object, _callback] {
+      const bool success = LoadArchive(filename.c_str(), _object);
+      if (_callback) {
+        _callback(success);
+      }
+      return success;
+    }));
+  }
+
+  // Loads archive files _filenames[i] to _objects[i] in parallel, and waits
+  // for all of them to complete. _objects must be at least as big as
+  // _filenames. Returns the number of objects successfully loaded.
+  template <typename _Ty>
+  int LoadAll(const Range<const char* const>& _filenames,
+              const Range<_Ty>& _objects) {
+    if (_objects.count() < _filenames.count()) {
+      return 0;
+    }
+    ozz::Vector<std::future<bool> >::Std futures;
+    futures.reserve(_filenames.count());
+    for (size_t i = 0; i < _filenames.count(); ++i) {
+      futures.push_back(Load(_filenames[i], &_objects[i]));
+    }
+    int loaded = 0;
+    for (size_t i = 0; i < futures.size(); ++i) {
+      loaded += futures[i].get();
+    }
+    return loaded;
+  }
+
+  // Waits for all queued loads to complete.
+  void Wait();
+
+ private:
+  AsyncLoader(const AsyncLoader&);
+  void operator=(const AsyncLoader&);
+
+  // Queues _task, or runs it immediately if there's no worker thread.
+  std::future<bool> Push(std::packaged_task<bool()> _task);
+
+  // Worker threads loop.
+  void Work();
+
+  ozz::Vector<std::thread>::Std threads_;
+
+  // Protects the queue and counters below.
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::condition_variable idle_;
+
+  // Loads waiting for a worker thread.
+  ozz::Deque<std::packaged_task<bool()> >::Std queue_;
+
+  // Number of loads queued or being executed.
+  int pending_;
+
+  // Requests worker threads to exit.
+  bool exit_;
+};
+}  // namespace sample
+}  // namespace ozz
+#endif  // OZZ_SAMPLES_FRAMEWORK_ASYNC_LOADER_H_
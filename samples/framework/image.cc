@@ -64,8 +64,7 @@ bool WriteTGA(const char* _filename, int _width, int _height,
 
   assert(_filename && _src_buffer);
 
-  ozz::log::LogV() << "Write image to TGA file \"" << _filename << "\"."
-                   << std::endl;
+  OZZ_LOGV << "Write image to TGA file \"" << _filename << "\"." << std::endl;
 
   // Opens output file.
   ozz::io::File file(_filename, "wb");
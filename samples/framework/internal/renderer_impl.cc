@@ -89,6 +89,8 @@ RendererImpl::RendererImpl(Camera* _camera)
       ambient_shader(NULL),
       ambient_textured_shader(NULL),
       ambient_shader_instanced(NULL),
+      skinned_shader(NULL),
+      skinned_textured_shader(NULL),
       checkered_texture_(0) {}
 
 RendererImpl::~RendererImpl() {
@@ -104,6 +106,8 @@ RendererImpl::~RendererImpl() {
     dynamic_index_bo_ = 0;
   }
 
+  streaming_buffer_.Release();
+
   allocator->Delete(immediate_);
   immediate_ = NULL;
 
@@ -116,6 +120,12 @@ RendererImpl::~RendererImpl() {
   allocator->Delete(ambient_shader_instanced);
   ambient_shader_instanced = NULL;
 
+  allocator->Delete(skinned_shader);
+  skinned_shader = NULL;
+
+  allocator->Delete(skinned_textured_shader);
+  skinned_textured_shader = NULL;
+
   if (checkered_texture_) {
     GL(DeleteTextures(1, &checkered_texture_));
     checkered_texture_ = 0;
@@ -163,6 +173,24 @@ bool RendererImpl::Initialize() {
     }
   }
 
+  // Instantiate GPU skinning shaders, whose palette size is limited by the
+  // number of vertex uniforms, minus a few vectors kept for other uniforms.
+  // GPU skinning is optional, skinning falls back to the CPU if it fails.
+  GLint uniform_vectors = 0;
+#ifdef EMSCRIPTEN
+  glGetIntegerv(GL_MAX_VERTEX_UNIFORM_VECTORS, &uniform_vectors);
+#else   // EMSCRIPTEN
+  glGetIntegerv(GL_MAX_VERTEX_UNIFORM_COMPONENTS, &uniform_vectors);
+  uniform_vectors /= 4;
+#endif  // EMSCRIPTEN
+  const int palette_size = math::Min((uniform_vectors - 16) / 4, 256);
+  skinned_shader = SkinnedShader::Build(palette_size, false);
+  skinned_textured_shader = SkinnedShader::Build(palette_size, true);
+  if (!skinned_shader || !skinned_textured_shader) {
+    log::Log() << "GPU skinning isn't supported, skinning falls back to CPU."
+               << std::endl;
+  }
+
   return true;
 }
 
@@ -1333,6 +1361,15 @@ bool RendererImpl::DrawSkinnedMesh(
   if (_options.skip_skinning) {
     return DrawMesh(_mesh, _transform, _options);
   }
+
+  // Skins on the GPU whenever possible.
+  if (CanSkinOnGpu(_mesh, static_cast<int>(_skinning_matrices.count()),
+                   _options)) {
+    return DrawSkinnedMesh_GpuImpl(
+        _mesh, _skinning_matrices,
+        Range<const math::Float4x4>(&_transform, 1), _options);
+  }
+
   const int vertex_count = _mesh.vertex_count();
 
   // Positions and normals are interleaved to improve caching while executing
@@ -1357,9 +1394,19 @@ bool RendererImpl::DrawSkinnedMesh(
   const GLsizei uvs_size = vertex_count * uvs_stride;
   const GLsizei fixed_data_size = colors_size + uvs_size;
 
-  // Reallocate vertex buffer.
+  // Reallocate vertex buffer. Skinned vertices are written straight to the
+  // streaming buffer when it's available, unless debug vectors need to read
+  // them back.
   const GLsizei vbo_size = skinned_data_size + fixed_data_size;
-  void* vbo_map = scratch_buffer_.Resize(vbo_size);
+  GLsizei vbo_offset = 0;
+  void* vbo_map = NULL;
+  if (!_options.normals && !_options.tangents && !_options.binormals) {
+    vbo_map = streaming_buffer_.Allocate(vbo_size, &vbo_offset);
+  }
+  const bool streamed = vbo_map != NULL;
+  if (!streamed) {
+    vbo_map = scratch_buffer_.Resize(vbo_size);
+  }
 
   // Iterate mesh parts and fills vbo.
   // Runs a skinning job per mesh part. Triangle indices are shared
@@ -1553,26 +1600,33 @@ bool RendererImpl::DrawSkinnedMesh(
     processed_vertex_count += part_vertex_count;
   }
 
-  // Updates dynamic vertex buffer with skinned data.
-  GL(BindBuffer(GL_ARRAY_BUFFER, dynamic_array_bo_));
-  GL(BufferData(GL_ARRAY_BUFFER, vbo_size, NULL, GL_STREAM_DRAW));
-  GL(BufferSubData(GL_ARRAY_BUFFER, 0, vbo_size, vbo_map));
+  // Updates dynamic vertex buffer with skinned data, unless it was written
+  // to the streaming buffer already.
+  if (streamed) {
+    GL(BindBuffer(GL_ARRAY_BUFFER, streaming_buffer_.bo()));
+  } else {
+    GL(BindBuffer(GL_ARRAY_BUFFER, dynamic_array_bo_));
+    GL(BufferData(GL_ARRAY_BUFFER, vbo_size, NULL, GL_STREAM_DRAW));
+    GL(BufferSubData(GL_ARRAY_BUFFER, 0, vbo_size, vbo_map));
+  }
 
   // Binds shader with this array buffer, depending on rendering options.
   Shader* shader = NULL;
   if (_options.texture) {
-    ambient_textured_shader->Bind(_transform, camera()->view_proj(),
-                                  positions_stride, positions_offset,
-                                  normals_stride, normals_offset, colors_stride,
-                                  colors_offset, uvs_stride, uvs_offset);
+    ambient_textured_shader->Bind(
+        _transform, camera()->view_proj(), positions_stride,
+        vbo_offset + positions_offset, normals_stride,
+        vbo_offset + normals_offset, colors_stride, vbo_offset + colors_offset,
+        uvs_stride, vbo_offset + uvs_offset);
     shader = ambient_textured_shader;
 
     // Binds default texture
     GL(BindTexture(GL_TEXTURE_2D, checkered_texture_));
   } else {
     ambient_shader->Bind(_transform, camera()->view_proj(), positions_stride,
-                         positions_offset, normals_stride, normals_offset,
-                         colors_stride, colors_offset);
+                         vbo_offset + positions_offset, normals_stride,
+                         vbo_offset + normals_offset, colors_stride,
+                         vbo_offset + colors_offset);
     shader = ambient_shader;
   }
 
@@ -1597,6 +1651,260 @@ bool RendererImpl::DrawSkinnedMesh(
   return true;
 }
 
+bool RendererImpl::DrawSkinnedMeshes(
+    const Mesh& _mesh, const Range<math::Float4x4> _skinning_matrices,
+    Range<const ozz::math::Float4x4> _transforms, const Options& _options) {
+  const size_t instance_count = _transforms.count();
+  if (instance_count == 0) {
+    return true;
+  }
+  // Palettes must all have the same number of matrices.
+  if (_skinning_matrices.count() % instance_count != 0) {
+    return false;
+  }
+  const size_t palette_count = _skinning_matrices.count() / instance_count;
+
+  // Vertex streams are uploaded once for all instances when skinning on the
+  // GPU.
+  if (!_options.skip_skinning &&
+      CanSkinOnGpu(_mesh, static_cast<int>(palette_count), _options)) {
+    return DrawSkinnedMesh_GpuImpl(_mesh, _skinning_matrices, _transforms,
+                                   _options);
+  }
+
+  // Falls back to drawing instances one by one.
+  bool success = true;
+  for (size_t i = 0; i < instance_count; ++i) {
+    const Range<math::Float4x4> palette(
+        _skinning_matrices.begin + i * palette_count, palette_count);
+    success &= DrawSkinnedMesh(_mesh, palette, _transforms[i], _options);
+  }
+  return success;
+}
+
+bool RendererImpl::CanSkinOnGpu(const Mesh& _mesh, int _num_joints,
+                                const Options& _options) const {
+  // Debug vectors rendering requires skinned vertices on the CPU.
+  if (_options.cpu_skinning || _options.normals || _options.tangents ||
+      _options.binormals) {
+    return false;
+  }
+  const SkinnedShader* shader =
+      _options.texture ? skinned_textured_shader : skinned_shader;
+  if (!shader || _num_joints == 0 || _num_joints > shader->palette_size()) {
+    return false;
+  }
+  for (size_t i = 0; i < _mesh.parts.size(); ++i) {
+    if (_mesh.parts[i].influences_count() > SkinnedShader::kMaxInfluences) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool RendererImpl::DrawSkinnedMesh_GpuImpl(
+    const Mesh& _mesh, Range<const math::Float4x4> _skinning_matrices,
+    Range<const ozz::math::Float4x4> _transforms, const Options& _options) {
+  const size_t instance_count = _transforms.count();
+  const size_t palette_count = _skinning_matrices.count() / instance_count;
+  const int vertex_count = _mesh.vertex_count();
+  const int kMaxInfluences = SkinnedShader::kMaxInfluences;
+
+  // Vertex buffer isn't interleaved, as bind-pose data are copied from the
+  // source mesh which is non-interleaved as-well. Colors will be filled with
+  // white if _options.colors is false. UVs will be skipped if _options.texture
+  // is false.
+  const GLsizei positions_offset = 0;
+  const GLsizei positions_stride =
+      sizeof(float) * ozz::sample::Mesh::Part::kPositionsCpnts;
+  const GLsizei positions_size = vertex_count * positions_stride;
+  const GLsizei normals_offset = positions_offset + positions_size;
+  const GLsizei normals_stride =
+      sizeof(float) * ozz::sample::Mesh::Part::kNormalsCpnts;
+  const GLsizei normals_size = vertex_count * normals_stride;
+  const GLsizei colors_offset = normals_offset + normals_size;
+  const GLsizei colors_stride =
+      sizeof(uint8_t) * ozz::sample::Mesh::Part::kColorsCpnts;
+  const GLsizei colors_size = vertex_count * colors_stride;
+  const GLsizei uvs_offset = colors_offset + colors_size;
+  const GLsizei uvs_stride =
+      _options.texture ? sizeof(float) * ozz::sample::Mesh::Part::kUVsCpnts : 0;
+  const GLsizei uvs_size = vertex_count * uvs_stride;
+  const GLsizei weights_offset = uvs_offset + uvs_size;
+  const GLsizei weights_stride = sizeof(float) * (kMaxInfluences - 1);
+  const GLsizei weights_size = vertex_count * weights_stride;
+  const GLsizei joints_offset = weights_offset + weights_size;
+  const GLsizei joints_stride = sizeof(uint16_t) * kMaxInfluences;
+  const GLsizei joints_size = vertex_count * joints_stride;
+
+  // Reallocate vertex buffer, from the streaming buffer when it's available.
+  const GLsizei vbo_size = joints_offset + joints_size;
+  GLsizei vbo_offset = 0;
+  void* vbo_map = streaming_buffer_.Allocate(vbo_size, &vbo_offset);
+  const bool streamed = vbo_map != NULL;
+  if (!streamed) {
+    vbo_map = scratch_buffer_.Resize(vbo_size);
+  }
+
+  // Iterate mesh parts and fills vbo.
+  size_t vertex_offset = 0;
+  for (size_t i = 0; i < _mesh.parts.size(); ++i) {
+    const Mesh::Part& part = _mesh.parts[i];
+    const size_t part_vertex_count = part.vertex_count();
+    if (part_vertex_count == 0) {
+      continue;
+    }
+
+    // Handles positions.
+    memcpy(ozz::PointerStride(
+               vbo_map, positions_offset + vertex_offset * positions_stride),
+           array_begin(part.positions), part_vertex_count * positions_stride);
+
+    // Handles normals.
+    if (part_vertex_count ==
+        part.normals.size() / ozz::sample::Mesh::Part::kNormalsCpnts) {
+      // Optimal path used when the right number of normals is provided.
+      memcpy(ozz::PointerStride(
+                 vbo_map, normals_offset + vertex_offset * normals_stride),
+             array_begin(part.normals), part_vertex_count * normals_stride);
+    } else {
+      // Un-optimal path used when the right number of normals is not provided.
+      OZZ_STATIC_ASSERT(sizeof(kDefaultNormalsArray[0]) == normals_stride);
+      for (size_t j = 0; j < part_vertex_count;
+           j += OZZ_ARRAY_SIZE(kDefaultNormalsArray)) {
+        const size_t this_loop_count = math::Min(
+            OZZ_ARRAY_SIZE(kDefaultNormalsArray), part_vertex_count - j);
+        memcpy(ozz::PointerStride(
+                   vbo_map,
+                   normals_offset + (vertex_offset + j) * normals_stride),
+               kDefaultNormalsArray, normals_stride * this_loop_count);
+      }
+    }
+
+    // Handles colors.
+    if (_options.colors &&
+        part_vertex_count ==
+            part.colors.size() / ozz::sample::Mesh::Part::kColorsCpnts) {
+      // Optimal path used when the right number of colors is provided.
+      memcpy(ozz::PointerStride(
+                 vbo_map, colors_offset + vertex_offset * colors_stride),
+             array_begin(part.colors), part_vertex_count * colors_stride);
+    } else {
+      // Un-optimal path used when the right number of colors is not provided.
+      OZZ_STATIC_ASSERT(sizeof(kDefaultColorsArray[0]) == colors_stride);
+      for (size_t j = 0; j < part_vertex_count;
+           j += OZZ_ARRAY_SIZE(kDefaultColorsArray)) {
+        const size_t this_loop_count = math::Min(
+            OZZ_ARRAY_SIZE(kDefaultColorsArray), part_vertex_count - j);
+        memcpy(ozz::PointerStride(
+                   vbo_map,
+                   colors_offset + (vertex_offset + j) * colors_stride),
+               kDefaultColorsArray, colors_stride * this_loop_count);
+      }
+    }
+
+    // Handles uvs.
+    if (_options.texture) {
+      if (part_vertex_count ==
+          part.uvs.size() / ozz::sample::Mesh::Part::kUVsCpnts) {
+        // Optimal path used when the right number of uvs is provided.
+        memcpy(ozz::PointerStride(vbo_map,
+                                  uvs_offset + vertex_offset * uvs_stride),
+               array_begin(part.uvs), part_vertex_count * uvs_stride);
+      } else {
+        // Un-optimal path used when the right number of uvs is not provided.
+        assert(sizeof(kDefaultUVsArray[0]) == uvs_stride);
+        for (size_t j = 0; j < part_vertex_count;
+             j += OZZ_ARRAY_SIZE(kDefaultUVsArray)) {
+          const size_t this_loop_count = math::Min(
+              OZZ_ARRAY_SIZE(kDefaultUVsArray), part_vertex_count - j);
+          memcpy(ozz::PointerStride(
+                     vbo_map, uvs_offset + (vertex_offset + j) * uvs_stride),
+                 kDefaultUVsArray, uvs_stride * this_loop_count);
+        }
+      }
+    }
+
+    // Expands joint indices and weights to kMaxInfluences. Like SkinningJob,
+    // the last influence weight is implicit, so the part last joint is moved
+    // to the last influence. Unused influences have a zero weight.
+    const int influences_count = part.influences_count();
+    uint16_t* joints = reinterpret_cast<uint16_t*>(ozz::PointerStride(
+        vbo_map, joints_offset + vertex_offset * joints_stride));
+    float* weights = reinterpret_cast<float*>(ozz::PointerStride(
+        vbo_map, weights_offset + vertex_offset * weights_stride));
+    for (size_t j = 0; j < part_vertex_count; ++j) {
+      const uint16_t* in_joints = &part.joint_indices[j * influences_count];
+      for (int k = 0; k < kMaxInfluences - 1; ++k) {
+        const bool used = k < influences_count - 1;
+        joints[k] = used ? in_joints[k] : 0;
+        weights[k] =
+            used ? part.joint_weights[j * (influences_count - 1) + k] : 0.f;
+      }
+      joints[kMaxInfluences - 1] = in_joints[influences_count - 1];
+      joints += kMaxInfluences;
+      weights += kMaxInfluences - 1;
+    }
+
+    // Computes next loop offset.
+    vertex_offset += part_vertex_count;
+  }
+
+  // Updates dynamic vertex buffer with bind-pose data, unless it was written
+  // to the streaming buffer already. Vertices are transformed by the shader,
+  // from the skinning matrices palette.
+  if (streamed) {
+    GL(BindBuffer(GL_ARRAY_BUFFER, streaming_buffer_.bo()));
+  } else {
+    GL(BindBuffer(GL_ARRAY_BUFFER, dynamic_array_bo_));
+    GL(BufferData(GL_ARRAY_BUFFER, vbo_size, NULL, GL_STREAM_DRAW));
+    GL(BufferSubData(GL_ARRAY_BUFFER, 0, vbo_size, vbo_map));
+  }
+
+  SkinnedShader* shader =
+      _options.texture ? skinned_textured_shader : skinned_shader;
+  const Range<const math::Float4x4> first_palette(_skinning_matrices.begin,
+                                                  palette_count);
+  shader->Bind(_transforms[0], camera()->view_proj(), first_palette,
+               positions_stride, vbo_offset + positions_offset, normals_stride,
+               vbo_offset + normals_offset, colors_stride,
+               vbo_offset + colors_offset, uvs_stride, vbo_offset + uvs_offset,
+               joints_stride, vbo_offset + joints_offset, weights_stride,
+               vbo_offset + weights_offset);
+  if (_options.texture) {
+    // Binds default texture
+    GL(BindTexture(GL_TEXTURE_2D, checkered_texture_));
+  }
+
+  // Maps the index dynamic buffer and update it.
+  GL(BindBuffer(GL_ELEMENT_ARRAY_BUFFER, dynamic_index_bo_));
+  const Mesh::TriangleIndices& indices = _mesh.triangle_indices;
+  GL(BufferData(GL_ELEMENT_ARRAY_BUFFER,
+                indices.size() * sizeof(Mesh::TriangleIndices::value_type),
+                array_begin(indices), GL_STREAM_DRAW));
+
+  // Draws all instances. Vertex and index buffers are shared, only model
+  // matrix and palette uniforms are updated for every instance.
+  OZZ_STATIC_ASSERT(sizeof(Mesh::TriangleIndices::value_type) == 2);
+  for (size_t i = 0; i < instance_count; ++i) {
+    if (i != 0) {
+      const Range<const math::Float4x4> palette(
+          _skinning_matrices.begin + i * palette_count, palette_count);
+      shader->BindInstance(_transforms[i], palette);
+    }
+    GL(DrawElements(GL_TRIANGLES, static_cast<GLsizei>(indices.size()),
+                    GL_UNSIGNED_SHORT, 0));
+  }
+
+  // Unbinds.
+  GL(BindBuffer(GL_ARRAY_BUFFER, 0));
+  GL(BindTexture(GL_TEXTURE_2D, 0));
+  GL(BindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0));
+  shader->Unbind();
+
+  return true;
+}
+
 // Helper macro used to initialize extension function pointer.
 #define OZZ_INIT_GL_EXT_N(_fct, _fct_name, _fct_type, _success)               \
   do {                                                                        \
@@ -1719,6 +2027,35 @@ bool RendererImpl::InitOpenGLExtensions() {
     log::Log() << "Optional GL_ARB_instanced_arrays extensions not found."
                << std::endl;
   }
+
+  GL_ARB_buffer_storage_supported =
+      glfwExtensionSupported("GL_ARB_buffer_storage") != 0 &&
+      glfwExtensionSupported("GL_ARB_map_buffer_range") != 0 &&
+      glfwExtensionSupported("GL_ARB_sync") != 0;
+  if (GL_ARB_buffer_storage_supported) {
+    log::Log() << "Optional GL_ARB_buffer_storage extensions found."
+               << std::endl;
+    success = true;
+    OZZ_INIT_GL_EXT_N(glBufferStorage_, "glBufferStorage",
+                      PFNGLBUFFERSTORAGEPROC, success);
+    OZZ_INIT_GL_EXT_N(glMapBufferRange_, "glMapBufferRange",
+                      PFNGLMAPBUFFERRANGEPROC, success);
+    OZZ_INIT_GL_EXT_N(glFenceSync_, "glFenceSync", PFNGLFENCESYNCPROC,
+                      success);
+    OZZ_INIT_GL_EXT_N(glClientWaitSync_, "glClientWaitSync",
+                      PFNGLCLIENTWAITSYNCPROC, success);
+    OZZ_INIT_GL_EXT_N(glDeleteSync_, "glDeleteSync", PFNGLDELETESYNCPROC,
+                      success);
+    if (!success) {
+      log::Err()
+          << "Failed to setup GL_ARB_buffer_storage, feature is disabled."
+          << std::endl;
+      GL_ARB_buffer_storage_supported = false;
+    }
+  } else {
+    log::Log() << "Optional GL_ARB_buffer_storage extensions not found."
+               << std::endl;
+  }
   return true;
 }
 
@@ -1735,6 +2072,97 @@ void* RendererImpl::ScratchBuffer::Resize(size_t _size) {
   }
   return buffer_;
 }
+
+RendererImpl::StreamingBuffer::StreamingBuffer()
+    : bo_(0), map_(NULL), section_size_(0), head_(0) {
+  for (int i = 0; i < kSections; ++i) {
+    fences_[i] = NULL;
+  }
+}
+
+RendererImpl::StreamingBuffer::~StreamingBuffer() {
+  assert(bo_ == 0 && "Release must be called while GL context is alive.");
+}
+
+void RendererImpl::StreamingBuffer::Release() {
+  for (int i = 0; i < kSections; ++i) {
+    if (fences_[i]) {
+      GL(DeleteSync_(fences_[i]));
+      fences_[i] = NULL;
+    }
+  }
+  if (bo_) {
+    // Deleting the buffer also unmaps it.
+    GL(DeleteBuffers(1, &bo_));
+    bo_ = 0;
+  }
+  map_ = NULL;
+  section_size_ = 0;
+  head_ = 0;
+}
+
+bool RendererImpl::StreamingBuffer::Grow(size_t _size) {
+  Release();
+
+  // Sections are big enough for many allocations, so the ring doesn't wrap
+  // and wait for the GPU within a frame.
+  const size_t kMinSectionSize = 4 << 20;
+  section_size_ = math::Max(_size * 2, kMinSectionSize);
+  const GLsizeiptr capacity =
+      static_cast<GLsizeiptr>(section_size_ * kSections);
+  const GLbitfield flags =
+      GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+  GL(GenBuffers(1, &bo_));
+  GL(BindBuffer(GL_ARRAY_BUFFER, bo_));
+  GL(BufferStorage_(GL_ARRAY_BUFFER, capacity, NULL, flags));
+  map_ = static_cast<char*>(glMapBufferRange_(GL_ARRAY_BUFFER, 0, capacity,
+                                                flags));
+  GL(BindBuffer(GL_ARRAY_BUFFER, 0));
+  if (!map_) {
+    Release();
+    return false;
+  }
+  return true;
+}
+
+void* RendererImpl::StreamingBuffer::Allocate(size_t _size,
+                                              GLsizei* _offset) {
+  if (!GL_ARB_buffer_storage_supported) {
+    return NULL;
+  }
+
+  // Keeps allocations 16 bytes aligned.
+  const size_t size = (_size + 15) & ~static_cast<size_t>(15);
+  if (size > section_size_ && !Grow(size)) {
+    return NULL;
+  }
+
+  // Moves to the next section if the allocation doesn't fit in the current
+  // one.
+  const size_t section = head_ / section_size_;
+  if (head_ + size > (section + 1) * section_size_) {
+    // Fences GPU commands reading the section being left.
+    fences_[section] = glFenceSync_(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    // Waits for the GPU to be done with the next section before writing it.
+    const size_t next = (section + 1) % kSections;
+    if (fences_[next]) {
+      GLenum status;
+      do {
+        status = glClientWaitSync_(fences_[next], GL_SYNC_FLUSH_COMMANDS_BIT,
+                                   1000000000);
+      } while (status == GL_TIMEOUT_EXPIRED);
+      GL(DeleteSync_(fences_[next]));
+      fences_[next] = NULL;
+    }
+    head_ = next * section_size_;
+  }
+
+  *_offset = static_cast<GLsizei>(head_);
+  void* allocation = map_ + head_;
+  head_ += size;
+  return allocation;
+}
 }  // namespace internal
 }  // namespace sample
 }  // namespace ozz
@@ -1819,3 +2247,10 @@ bool GL_ARB_instanced_arrays_supported = false;
 OZZ_DECL_GL_EXT(glVertexAttribDivisor_, PFNGLVERTEXATTRIBDIVISORARBPROC);
 OZZ_DECL_GL_EXT(glDrawArraysInstanced_, PFNGLDRAWARRAYSINSTANCEDARBPROC);
 OZZ_DECL_GL_EXT(glDrawElementsInstanced_, PFNGLDRAWELEMENTSINSTANCEDARBPROC);
+
+bool GL_ARB_buffer_storage_supported = false;
+OZZ_DECL_GL_EXT(glBufferStorage_, PFNGLBUFFERSTORAGEPROC);
+OZZ_DECL_GL_EXT(glMapBufferRange_, PFNGLMAPBUFFERRANGEPROC);
+OZZ_DECL_GL_EXT(glFenceSync_, PFNGLFENCESYNCPROC);
+OZZ_DECL_GL_EXT(glClientWaitSync_, PFNGLCLIENTWAITSYNCPROC);
+OZZ_DECL_GL_EXT(glDeleteSync_, PFNGLDELETESYNCPROC);
@@ -94,6 +94,7 @@ class SkeletonShader;
 class AmbientShader;
 class AmbientTexturedShader;
 class AmbientShaderInstanced;
+class SkinnedShader;
 class GlImmediateRenderer;
 
 // Implements Renderer interface.
@@ -139,6 +140,11 @@ class RendererImpl : public Renderer {
                                const ozz::math::Float4x4& _transform,
                                const Options& _options = Options());
 
+  virtual bool DrawSkinnedMeshes(const Mesh& _mesh,
+                                 const Range<math::Float4x4> _skinning_matrices,
+                                 Range<const ozz::math::Float4x4> _transforms,
+                                 const Options& _options = Options());
+
   virtual bool DrawMesh(const Mesh& _mesh,
                         const ozz::math::Float4x4& _transform,
                         const Options& _options = Options());
@@ -201,6 +207,17 @@ class RendererImpl : public Renderer {
                                  const float* _uniforms, int _instance_count,
                                  bool _draw_joints);
 
+  // Tests if _mesh can be skinned on the GPU with a _num_joints palette.
+  bool CanSkinOnGpu(const Mesh& _mesh, int _num_joints,
+                    const Options& _options) const;
+
+  // Draw skinned mesh internal GPU skinning implementation. Draws an instance
+  // per _transforms, each consuming its own palette from _skinning_matrices.
+  bool DrawSkinnedMesh_GpuImpl(const Mesh& _mesh,
+                               Range<const math::Float4x4> _skinning_matrices,
+                               Range<const ozz::math::Float4x4> _transforms,
+                               const Options& _options);
+
   // Array of matrices used to store model space matrices during DrawSkeleton
   // execution.
   ozz::Vector<ozz::math::Float4x4>::Std prealloc_models_;
@@ -233,6 +250,41 @@ class RendererImpl : public Renderer {
   };
   ScratchBuffer scratch_buffer_;
 
+  // Dynamic vertex buffer persistently mapped, used as a ring to stream
+  // skinned vertices without any driver synchronization. The ring is split in
+  // kSections sections, a fence being inserted when the write head leaves a
+  // section and waited for before writing it again. It's only available if
+  // GL_ARB_buffer_storage is supported.
+  class StreamingBuffer {
+   public:
+    StreamingBuffer();
+    ~StreamingBuffer();
+
+    // Releases GL buffer and fences.
+    void Release();
+
+    // Allocates _size bytes from the ring, and returns their mapped address.
+    // *_offset receives the offset of the allocation in the buffer object.
+    // The ring grows if _size doesn't fit in a section.
+    // Returns NULL if persistent mapping isn't supported.
+    void* Allocate(size_t _size, GLsizei* _offset);
+
+    // Buffer object containing allocations.
+    GLuint bo() const { return bo_; }
+
+   private:
+    // Reallocates the ring so that sections are at least _size bytes.
+    bool Grow(size_t _size);
+
+    enum { kSections = 3 };
+    GLuint bo_;
+    char* map_;
+    size_t section_size_;
+    size_t head_;
+    GLsync fences_[kSections];
+  };
+  StreamingBuffer streaming_buffer_;
+
   // Immediate renderer implementation.
   GlImmediateRenderer* immediate_;
 
@@ -241,6 +293,10 @@ class RendererImpl : public Renderer {
   AmbientTexturedShader* ambient_textured_shader;
   AmbientShaderInstanced* ambient_shader_instanced;
 
+  // GPU skinning shaders, NULL if GPU skinning isn't supported.
+  SkinnedShader* skinned_shader;
+  SkinnedShader* skinned_textured_shader;
+
   // Checkered texture
   unsigned int checkered_texture_;
 };
@@ -328,4 +384,13 @@ extern bool GL_ARB_instanced_arrays_supported;
 extern PFNGLVERTEXATTRIBDIVISORARBPROC glVertexAttribDivisor_;
 extern PFNGLDRAWARRAYSINSTANCEDARBPROC glDrawArraysInstanced_;
 extern PFNGLDRAWELEMENTSINSTANCEDARBPROC glDrawElementsInstanced_;
+
+// OpenGL ARB_buffer_storage extension, along with ARB_map_buffer_range and
+// ARB_sync, optional.
+extern bool GL_ARB_buffer_storage_supported;
+extern PFNGLBUFFERSTORAGEPROC glBufferStorage_;
+extern PFNGLMAPBUFFERRANGEPROC glMapBufferRange_;
+extern PFNGLFENCESYNCPROC glFenceSync_;
+extern PFNGLCLIENTWAITSYNCPROC glClientWaitSync_;
+extern PFNGLDELETESYNCPROC glDeleteSync_;
 #endif  // OZZ_SAMPLES_FRAMEWORK_INTERNAL_RENDERER_IMPL_H_
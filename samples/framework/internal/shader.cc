@@ -771,6 +771,117 @@ void AmbientTexturedShader::Bind(const math::Float4x4& _model,
   GL(VertexAttribPointer(uv_attrib, 2, GL_FLOAT, GL_FALSE, _uv_stride,
                          GL_PTR_OFFSET(_uv_offset)));
 }
+
+SkinnedShader* SkinnedShader::Build(int _palette_size, bool _textured) {
+  if (_palette_size <= 0) {
+    return NULL;
+  }
+
+  // Palette size is specified at compile time, as glsl arrays can't be sized
+  // dynamically.
+  char palette[64];
+  std::sprintf(palette, "uniform mat4 u_palette[%d];\n", _palette_size);
+  const char* vs_skinning =
+      "uniform mat4 u_mw;\n"
+      "attribute vec4 a_joints;\n"
+      "attribute vec3 a_weights;\n"
+      "mat4 GetWorldMatrix() {\n"
+      "  // Last weight is implicit, like SkinningJob.\n"
+      "  float last = 1. - a_weights.x - a_weights.y - a_weights.z;\n"
+      "  mat4 skinning =\n"
+      "    u_palette[int(a_joints.x)] * a_weights.x +\n"
+      "    u_palette[int(a_joints.y)] * a_weights.y +\n"
+      "    u_palette[int(a_joints.z)] * a_weights.z +\n"
+      "    u_palette[int(a_joints.w)] * last;\n"
+      "  return u_mw * skinning;\n"
+      "}\n";
+  const char* vs[] = {kPlatformSpecivicVSHeader,
+                      _textured ? kPassUv : kPassNoUv, palette, vs_skinning,
+                      kShaderUberVS};
+  const char* fs[] = {
+      kPlatformSpecivicFSHeader, kShaderAmbientFct,
+      _textured ? kShaderAmbientTexturedFS : kShaderAmbientFS};
+
+  SkinnedShader* shader = memory::default_allocator()->New<SkinnedShader>();
+  shader->palette_size_ = _palette_size;
+  shader->textured_ = _textured;
+  bool success =
+      shader->InternalBuild(OZZ_ARRAY_SIZE(vs), vs, OZZ_ARRAY_SIZE(fs), fs);
+
+  if (_textured) {
+    success &= shader->FindAttrib("a_uv");
+  }
+  success &= shader->FindAttrib("a_joints");
+  success &= shader->FindAttrib("a_weights");
+  success &= shader->BindUniform("u_palette");
+
+  if (!success) {
+    memory::default_allocator()->Delete(shader);
+    shader = NULL;
+  }
+
+  return shader;
+}
+
+void SkinnedShader::Bind(const math::Float4x4& _model,
+                         const math::Float4x4& _view_proj,
+                         Range<const math::Float4x4> _palette,
+                         GLsizei _pos_stride, GLsizei _pos_offset,
+                         GLsizei _normal_stride, GLsizei _normal_offset,
+                         GLsizei _color_stride, GLsizei _color_offset,
+                         GLsizei _uv_stride, GLsizei _uv_offset,
+                         GLsizei _joints_stride, GLsizei _joints_offset,
+                         GLsizei _weights_stride, GLsizei _weights_offset) {
+  assert(_palette.count() <= static_cast<size_t>(palette_size_));
+
+  AmbientShader::Bind(_model, _view_proj, _pos_stride, _pos_offset,
+                      _normal_stride, _normal_offset, _color_stride,
+                      _color_offset);
+
+  int next_attrib = 3;
+  if (textured_) {
+    const GLint uv_attrib = attrib(next_attrib++);
+    GL(EnableVertexAttribArray(uv_attrib));
+    GL(VertexAttribPointer(uv_attrib, 2, GL_FLOAT, GL_FALSE, _uv_stride,
+                           GL_PTR_OFFSET(_uv_offset)));
+  }
+
+  // Joint indices are converted to float, not normalized.
+  const GLint joints_attrib = attrib(next_attrib++);
+  GL(EnableVertexAttribArray(joints_attrib));
+  GL(VertexAttribPointer(joints_attrib, kMaxInfluences, GL_UNSIGNED_SHORT,
+                         GL_FALSE, _joints_stride,
+                         GL_PTR_OFFSET(_joints_offset)));
+
+  const GLint weights_attrib = attrib(next_attrib++);
+  GL(EnableVertexAttribArray(weights_attrib));
+  GL(VertexAttribPointer(weights_attrib, kMaxInfluences - 1, GL_FLOAT,
+                         GL_FALSE, _weights_stride,
+                         GL_PTR_OFFSET(_weights_offset)));
+
+  // Binds palette uniform. Float4x4 columns are contiguous floats.
+  OZZ_STATIC_ASSERT(sizeof(math::Float4x4) == sizeof(float) * 16);
+  const GLint palette_uniform = uniform(2);
+  GL(UniformMatrix4fv(palette_uniform, static_cast<GLsizei>(_palette.count()),
+                      false, reinterpret_cast<const float*>(_palette.begin)));
+}
+
+void SkinnedShader::BindInstance(const math::Float4x4& _model,
+                                 Range<const math::Float4x4> _palette) {
+  assert(_palette.count() <= static_cast<size_t>(palette_size_));
+
+  float values[16];
+  const GLint mw_uniform = uniform(0);
+  math::StorePtrU(_model.cols[0], values + 0);
+  math::StorePtrU(_model.cols[1], values + 4);
+  math::StorePtrU(_model.cols[2], values + 8);
+  math::StorePtrU(_model.cols[3], values + 12);
+  GL(UniformMatrix4fv(mw_uniform, 1, false, values));
+
+  const GLint palette_uniform = uniform(2);
+  GL(UniformMatrix4fv(palette_uniform, static_cast<GLsizei>(_palette.count()),
+                      false, reinterpret_cast<const float*>(_palette.begin)));
+}
 }  // internal
 }  // namespace sample
 }  // namespace ozz
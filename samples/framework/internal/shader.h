@@ -223,6 +223,56 @@ class AmbientTexturedShader : public AmbientShader {
             GLsizei _normal_offset, GLsizei _color_stride,
             GLsizei _color_offset, GLsizei _uv_stride, GLsizei _uv_offset);
 };
+
+// Skins vertices on the GPU, mirroring ozz::geometry::SkinningJob: it consumes
+// the same skinning matrices palette (model-space matrices multiplied by
+// inverse bind-pose matrices), and the same joint indices and weights
+// conventions. Vertex buffer layout contract is:
+// - a_position and a_normal: 3 floats, bind-pose position and normal.
+// - a_joints: kMaxInfluences unsigned shorts, palette indices of the joints
+// influencing the vertex.
+// - a_weights: kMaxInfluences - 1 floats, weights of the first influences.
+// The last influence weight is implicit (1 - sum of the others), like
+// SkinningJob::joint_weights. Unused influences have a zero weight and any
+// valid palette index.
+class SkinnedShader : public AmbientShader {
+ public:
+  SkinnedShader() : palette_size_(0), textured_(false) {}
+  virtual ~SkinnedShader() {}
+
+  // Maximum number of joints influencing a vertex.
+  enum { kMaxInfluences = 4 };
+
+  // Constructs the shader, whose palette can contain up to _palette_size
+  // matrices. Uvs are consumed and the default texture sampled if _textured
+  // is true.
+  // Returns NULL if shader compilation failed or a valid Shader pointer on
+  // success. The shader must then be deleted using default allocator Delete
+  // function.
+  static SkinnedShader* Build(int _palette_size, bool _textured);
+
+  // Binds the shader. _palette size must be lower or equal to palette_size().
+  // Uvs strides and offsets are ignored if the shader isn't textured.
+  void Bind(const math::Float4x4& _model, const math::Float4x4& _view_proj,
+            Range<const math::Float4x4> _palette, GLsizei _pos_stride,
+            GLsizei _pos_offset, GLsizei _normal_stride, GLsizei _normal_offset,
+            GLsizei _color_stride, GLsizei _color_offset, GLsizei _uv_stride,
+            GLsizei _uv_offset, GLsizei _joints_stride, GLsizei _joints_offset,
+            GLsizei _weights_stride, GLsizei _weights_offset);
+
+  // Updates model matrix and palette uniforms of a bound shader, to draw
+  // another instance with the same vertex attributes.
+  void BindInstance(const math::Float4x4& _model,
+                    Range<const math::Float4x4> _palette);
+
+  // Maximum number of matrices in the palette.
+  int palette_size() const { return palette_size_; }
+
+ private:
+  int palette_size_;
+  bool textured_;
+};
+
 /*
 class AmbientTexturedShaderInstanced : public AmbientShaderInstanced {
 public:
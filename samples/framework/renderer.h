@@ -121,6 +121,7 @@ class Renderer {
     bool binormals;  // Show binormals, computed from the normal and tangent.
     bool colors;     // Show vertex colors.
     bool skip_skinning;  // Show texture (default checkered texture).
+    bool cpu_skinning;   // Skins with SkinningJob instead of on the GPU.
 
     Options()
         : texture(false),
@@ -128,7 +129,8 @@ class Renderer {
           tangents(false),
           binormals(false),
           colors(false),
-          skip_skinning(false) {}
+          skip_skinning(false),
+          cpu_skinning(false) {}
 
     Options(bool _texture, bool _normals, bool _tangents, bool _binormals,
             bool _colors, bool _skip_skinning)
@@ -137,15 +139,30 @@ class Renderer {
           tangents(_tangents),
           binormals(_binormals),
           colors(_colors),
-          skip_skinning(_skip_skinning) {}
+          skip_skinning(_skip_skinning),
+          cpu_skinning(false) {}
   };
 
   // Renders a skinned mesh at a specified location.
+  // Skinning runs on the GPU when supported, consuming _skinning_matrices
+  // palette and mesh joint indices and weights as SkinningJob does. It falls
+  // back to SkinningJob if the mesh exceeds GPU skinning limits, if normals,
+  // tangents or binormals are displayed, or if cpu_skinning option is set.
   virtual bool DrawSkinnedMesh(const Mesh& _mesh,
                                const Range<math::Float4x4> _skinning_matrices,
                                const ozz::math::Float4x4& _transform,
                                const Options& _options = Options()) = 0;
 
+  // Renders a skinned mesh instance per _transforms. _skinning_matrices
+  // contains all instances palettes, contiguously and with the same number of
+  // matrices. Mesh vertices are uploaded once for all instances when skinning
+  // on the GPU, only palettes and transforms are uploaded per instance.
+  // Otherwise instances are rendered one by one, like DrawSkinnedMesh.
+  virtual bool DrawSkinnedMeshes(const Mesh& _mesh,
+                                 const Range<math::Float4x4> _skinning_matrices,
+                                 Range<const ozz::math::Float4x4> _transforms,
+                                 const Options& _options = Options()) = 0;
+
   // Renders a mesh at a specified location.
   virtual bool DrawMesh(const Mesh& _mesh,
                         const ozz::math::Float4x4& _transform,
@@ -0,0 +1,256 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+// Compares benchmark json results (as written by sample_jobs_benchmark or
+// sample_math_benchmark) against a baseline, and fails if any measure
+// regressed. Baseline and current results can both be made of repeated runs,
+// whose median is compared. A measure is reported as a regression only if it
+// slowed down by more than a relative threshold, and by more than the
+// measurement noise, estimated from the median absolute deviation (MAD) of
+// runs. This allows to use benchmarks as a performance gate.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <json/json.h>
+
+#include "ozz/base/log.h"
+#include "ozz/options/options.h"
+
+OZZ_OPTIONS_DECLARE_STRING(
+    baseline,
+    "Comma separated list of baseline json results files, one per run.", "",
+    true)
+
+OZZ_OPTIONS_DECLARE_STRING(
+    current, "Comma separated list of current json results files, one per run.",
+    "", true)
+
+OZZ_OPTIONS_DECLARE_STRING(metric, "Name of the compared result field.",
+                           "median_us", false)
+
+OZZ_OPTIONS_DECLARE_FLOAT(
+    threshold, "Relative slow down above which a measure is a regression.",
+    .05f, false)
+
+OZZ_OPTIONS_DECLARE_FLOAT(
+    mad_factor,
+    "Number of noise deviations a slow down must exceed to be a regression.",
+    3.f, false)
+
+namespace {
+
+// Scales MAD to a standard deviation estimate, for normally distributed runs.
+const double kMadScale = 1.4826;
+
+// Values of a measure, one per run.
+struct Samples {
+  std::vector<double> values;  // Metric values.
+  std::vector<double> mads;    // Runs "mad_us" field, when available.
+};
+
+// Measures samples, indexed by name.
+typedef std::map<std::string, Samples> Measures;
+
+// Splits comma separated _list.
+std::vector<std::string> Split(const char* _list) {
+  std::vector<std::string> items;
+  std::string item;
+  for (const char* c = _list;; ++c) {
+    if (*c == ',' || *c == 0) {
+      if (!item.empty()) {
+        items.push_back(item);
+      }
+      item.clear();
+      if (*c == 0) {
+        break;
+      }
+    } else {
+      item += *c;
+    }
+  }
+  return items;
+}
+
+// Returns the median of _values, or 0 if it's empty.
+double Median(std::vector<double> _values) {
+  if (_values.empty()) {
+    return 0.;
+  }
+  std::sort(_values.begin(), _values.end());
+  const size_t half = _values.size() / 2;
+  return _values.size() % 2 ? _values[half]
+                            : (_values[half - 1] + _values[half]) * .5;
+}
+
+// Estimates the noise (standard deviation) of _samples, as the biggest of
+// runs dispersion and of the dispersion measured within runs.
+double Noise(const Samples& _samples) {
+  const double median = Median(_samples.values);
+  std::vector<double> deviations;
+  for (size_t i = 0; i < _samples.values.size(); ++i) {
+    deviations.push_back(std::abs(_samples.values[i] - median));
+  }
+  return kMadScale * std::max(Median(deviations), Median(_samples.mads));
+}
+
+// Loads _filename results and appends them to _measures.
+bool LoadResults(const std::string& _filename, Measures* _measures) {
+  std::ifstream file(_filename.c_str());
+  if (!file.is_open()) {
+    ozz::log::Err() << "Failed to open file " << _filename << "." << std::endl;
+    return false;
+  }
+  const std::string content((std::istreambuf_iterator<char>(file)),
+                            std::istreambuf_iterator<char>());
+  Json::Value document;
+  Json::Reader reader;
+  if (!reader.parse(content, document, false) || !document.isObject() ||
+      !document["results"].isArray()) {
+    ozz::log::Err() << "Failed to parse benchmark results file " << _filename
+                    << ". " << reader.getFormattedErrorMessages() << std::endl;
+    return false;
+  }
+  const Json::Value& results = document["results"];
+  for (Json::ArrayIndex i = 0; i < results.size(); ++i) {
+    const Json::Value& name = results[i]["name"];
+    const Json::Value& value = results[i][OPTIONS_metric.value()];
+    if (!name.isString() || !value.isNumeric()) {
+      ozz::log::Err() << "Invalid result " << i << " in file " << _filename
+                      << ", which must have a name and a numeric \""
+                      << OPTIONS_metric.value() << "\" field." << std::endl;
+      return false;
+    }
+    Samples& samples = (*_measures)[name.asString()];
+    samples.values.push_back(value.asDouble());
+    const Json::Value& mad = results[i]["mad_us"];
+    if (mad.isNumeric()) {
+      samples.mads.push_back(mad.asDouble());
+    }
+  }
+  return true;
+}
+
+// Loads all _list files results to _measures.
+bool LoadAllResults(const char* _list, Measures* _measures) {
+  const std::vector<std::string> files = Split(_list);
+  if (files.empty()) {
+    ozz::log::Err() << "No results file to compare." << std::endl;
+    return false;
+  }
+  for (size_t i = 0; i < files.size(); ++i) {
+    if (!LoadResults(files[i], _measures)) {
+      return false;
+    }
+  }
+  return true;
+}
+}  // namespace
+
+int main(int _argc, const char** _argv) {
+  // Parses arguments.
+  ozz::options::ParseResult parse_result = ozz::options::ParseCommandLine(
+      _argc, _argv, "1.0", "Compares benchmark results against a baseline");
+  if (parse_result != ozz::options::kSuccess) {
+    return parse_result == ozz::options::kExitSuccess ? EXIT_SUCCESS
+                                                      : EXIT_FAILURE;
+  }
+  if (OPTIONS_threshold < 0.f || OPTIONS_mad_factor < 0.f) {
+    ozz::log::Err() << "Invalid negative threshold or mad factor."
+                    << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  Measures baseline;
+  Measures current;
+  if (!LoadAllResults(OPTIONS_baseline, &baseline) ||
+      !LoadAllResults(OPTIONS_current, &current)) {
+    return EXIT_FAILURE;
+  }
+
+  ozz::log::Out() << std::left << std::setw(28) << "measure" << std::setw(14)
+                  << "baseline" << std::setw(14) << "current" << std::setw(12)
+                  << "delta %" << std::setw(12) << "noise" << "status"
+                  << std::endl;
+
+  int regressions = 0;
+  for (Measures::const_iterator it = baseline.begin(); it != baseline.end();
+       ++it) {
+    Measures::const_iterator found = current.find(it->first);
+    if (found == current.end()) {
+      ozz::log::Out() << std::left << std::setw(28) << it->first
+                      << "missing" << std::endl;
+      continue;
+    }
+    const double reference = Median(it->second.values);
+    const double value = Median(found->second.values);
+    const double delta = value - reference;
+    const double noise =
+        std::max(Noise(it->second), Noise(found->second));
+
+    // Slow downs must exceed both thresholds to be reported, so that noisy
+    // measures don't fail the comparison.
+    const char* status = "ok";
+    if (delta > OPTIONS_threshold * reference &&
+        delta > OPTIONS_mad_factor * noise) {
+      status = "REGRESSION";
+      ++regressions;
+    } else if (-delta > OPTIONS_threshold * reference &&
+               -delta > OPTIONS_mad_factor * noise) {
+      status = "faster";
+    }
+
+    ozz::log::Out() << std::left << std::setw(28) << it->first << std::fixed
+                    << std::setprecision(3) << std::setw(14) << reference
+                    << std::setw(14) << value << std::setprecision(1)
+                    << std::setw(12)
+                    << (reference > 0. ? delta * 100. / reference : 0.)
+                    << std::setprecision(3) << std::setw(12) << noise
+                    << status << std::endl;
+  }
+  for (Measures::const_iterator it = current.begin(); it != current.end();
+       ++it) {
+    if (baseline.find(it->first) == baseline.end()) {
+      ozz::log::Out() << std::left << std::setw(28) << it->first << "new"
+                      << std::endl;
+    }
+  }
+
+  if (regressions != 0) {
+    ozz::log::Err() << regressions << " measure(s) regressed." << std::endl;
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -40,9 +40,13 @@
 #include "ozz/base/maths/simd_math.h"
 #include "ozz/base/memory/allocator.h"
 
+#include "ozz/geometry/offline/raw_skinned_mesh.h"
+#include "ozz/geometry/offline/skinned_mesh_builder.h"
+
 #include "ozz/options/options.h"
 
 #include <algorithm>
+#include <cstring>
 #include <limits>
 
 #include "fbxsdk/utils/fbxgeometryconverter.h"
@@ -61,6 +65,10 @@ OZZ_OPTIONS_DECLARE_INT(
     max_influences,
     "Maximum number of joint influences per vertex (0 means no limitation).", 0,
     false)
+OZZ_OPTIONS_DECLARE_BOOL(optimize,
+                         "Optimizes triangles order for vertex cache, and "
+                         "sorts vertices by dominant joint.",
+                         true, false)
 
 namespace {
 
@@ -863,6 +871,127 @@ bool SplitParts(const ozz::sample::Mesh& _skinned_mesh,
   return true;
 }
 
+// Builds an optimized mesh, using ozz::geometry::offline::SkinnedMeshBuilder.
+// Triangles are reordered for vertex cache efficiency, and vertices are sorted
+// by number of influences (split into parts if _split is true) and then by
+// dominant joint. This replaces SplitParts and StripWeights steps.
+bool OptimizeMesh(const ozz::sample::Mesh& _skinned_mesh, bool _split,
+                  ozz::sample::Mesh* _optimized_mesh) {
+  assert(_skinned_mesh.parts.size() == 1);
+  assert(_optimized_mesh->parts.size() == 0);
+
+  const ozz::sample::Mesh::Part& in_part = _skinned_mesh.parts.front();
+  const int vertex_count = in_part.vertex_count();
+  if (vertex_count == 0) {
+    *_optimized_mesh = _skinned_mesh;
+    return true;
+  }
+
+  // Fills raw mesh.
+  ozz::geometry::offline::RawSkinnedMesh raw_mesh;
+  raw_mesh.influences_count = in_part.influences_count();
+  for (int i = 0; i < vertex_count; ++i) {
+    const float* position = &in_part.positions[i * 3];
+    raw_mesh.positions.push_back(
+        ozz::math::Float3(position[0], position[1], position[2]));
+    if (!in_part.normals.empty()) {
+      const float* normal = &in_part.normals[i * 3];
+      raw_mesh.normals.push_back(
+          ozz::math::Float3(normal[0], normal[1], normal[2]));
+    }
+    if (!in_part.tangents.empty()) {
+      const float* tangent = &in_part.tangents[i * 4];
+      raw_mesh.tangents.push_back(
+          ozz::math::Float4(tangent[0], tangent[1], tangent[2], tangent[3]));
+    }
+    if (!in_part.uvs.empty()) {
+      const float* uv = &in_part.uvs[i * 2];
+      raw_mesh.uvs.push_back(ozz::math::Float2(uv[0], uv[1]));
+    }
+  }
+  raw_mesh.colors = in_part.colors;
+  raw_mesh.joint_indices = in_part.joint_indices;
+  raw_mesh.joint_weights = in_part.joint_weights;
+  raw_mesh.triangle_indices.assign(_skinned_mesh.triangle_indices.begin(),
+                                   _skinned_mesh.triangle_indices.end());
+
+  // Builds optimized mesh. Mesh parts use float formats.
+  ozz::geometry::offline::SkinnedMeshBuilder builder;
+  builder.min_bucket_size = _split ? 32 : 0;
+  ozz::geometry::offline::SkinnedMesh mesh;
+  if (!builder(raw_mesh, &mesh)) {
+    return false;
+  }
+
+  // Fills one part per influences bucket, or a single part if mesh isn't
+  // split.
+  const float* positions = reinterpret_cast<const float*>(&mesh.positions[0]);
+  const float* normals =
+      mesh.normals.empty() ? NULL
+                           : reinterpret_cast<const float*>(&mesh.normals[0]);
+  const float* tangents =
+      mesh.tangents.empty() ? NULL
+                            : reinterpret_cast<const float*>(&mesh.tangents[0]);
+  const uint16_t* joint_indices =
+      reinterpret_cast<const uint16_t*>(&mesh.joint_indices[0]);
+  const float* joint_weights =
+      mesh.joint_weights.empty()
+          ? NULL
+          : reinterpret_cast<const float*>(&mesh.joint_weights[0]);
+  const int buckets_count =
+      _split ? static_cast<int>(mesh.influences_buckets.size()) : 1;
+  for (int b = 0, first = 0; b < buckets_count; ++b) {
+    const int count = _split ? mesh.influences_buckets[b] : vertex_count;
+    if (count == 0) {
+      continue;
+    }
+    const int influences = _split ? b + 1 : mesh.influences_count;
+
+    _optimized_mesh->parts.resize(_optimized_mesh->parts.size() + 1);
+    ozz::sample::Mesh::Part& out_part = _optimized_mesh->parts.back();
+    for (int i = first; i < first + count; ++i) {
+      out_part.positions.insert(out_part.positions.end(), positions + i * 3,
+                                positions + i * 3 + 3);
+      if (normals) {
+        out_part.normals.insert(out_part.normals.end(), normals + i * 3,
+                                normals + i * 3 + 3);
+      }
+      if (tangents) {
+        out_part.tangents.insert(out_part.tangents.end(), tangents + i * 3,
+                                 tangents + i * 3 + 3);
+        out_part.tangents.push_back(raw_mesh.tangents[mesh.vertex_remap[i]].w);
+      }
+      if (!mesh.uvs.empty()) {
+        out_part.uvs.push_back(mesh.uvs[i].x);
+        out_part.uvs.push_back(mesh.uvs[i].y);
+      }
+      if (!mesh.colors.empty()) {
+        out_part.colors.insert(out_part.colors.end(), &mesh.colors[i * 4],
+                               &mesh.colors[i * 4] + 4);
+      }
+      const uint16_t* indices = joint_indices + i * mesh.influences_count;
+      out_part.joint_indices.insert(out_part.joint_indices.end(), indices,
+                                    indices + influences);
+      if (influences > 1) {
+        const float* weights = joint_weights + i * (mesh.influences_count - 1);
+        out_part.joint_weights.insert(out_part.joint_weights.end(), weights,
+                                      weights + influences - 1);
+      }
+    }
+    first += count;
+  }
+
+  // Remaps triangle indices.
+  _optimized_mesh->triangle_indices.assign(mesh.triangle_indices.begin(),
+                                           mesh.triangle_indices.end());
+
+  // Copy bind pose matrices
+  _optimized_mesh->inverse_bind_poses = _skinned_mesh.inverse_bind_poses;
+  _optimized_mesh->joint_remaps = _skinned_mesh.joint_remaps;
+
+  return true;
+}
+
 // Removes the less significant weight, which is recomputed at runtime (sum of
 // weights equals 1).
 bool StripWeights(ozz::sample::Mesh* _mesh) {
@@ -893,7 +1022,7 @@ bool StripWeights(ozz::sample::Mesh* _mesh) {
 int main(int _argc, const char** _argv) {
   // Parses arguments.
   ozz::options::ParseResult parse_result = ozz::options::ParseCommandLine(
-      _argc, _argv, "1.1",
+      _argc, _argv, "1.2",
       "Imports a skin from a fbx file and converts it to ozz binary format");
   if (parse_result != ozz::options::kSuccess) {
     return parse_result == ozz::options::kExitSuccess ? EXIT_SUCCESS
@@ -946,7 +1075,7 @@ int main(int _argc, const char** _argv) {
   }
 
   {  // Clean and triangulates the scene.
-    ozz::log::LogV() << "Triangulating scene." << std::endl;
+    OZZ_LOGV << "Triangulating scene." << std::endl;
     FbxGeometryConverter converter(fbx_manager);
     converter.RemoveBadPolygonsFromMeshes(scene_loader.scene());
     if (!converter.Triangulate(scene_loader.scene(), true)) {
@@ -998,21 +1127,33 @@ int main(int _argc, const char** _argv) {
         return EXIT_FAILURE;
       }
 
-      // Split the mesh if option is true (default)
-      if (OPTIONS_split) {
-        ozz::sample::Mesh partitioned_meshes;
-        if (!SplitParts(output_mesh, &partitioned_meshes)) {
-          ozz::log::Err() << "Failed to partitioned meshes." << std::endl;
+      if (OPTIONS_optimize) {
+        // Optimizes, splits and strips weights in a single pass.
+        ozz::sample::Mesh optimized_mesh;
+        if (!OptimizeMesh(output_mesh, OPTIONS_split, &optimized_mesh)) {
+          ozz::log::Err() << "Failed to optimize mesh." << std::endl;
           return EXIT_FAILURE;
         }
 
-        // Copy partitioned mesh back to the output.
-        output_mesh = partitioned_meshes;
-      }
+        // Copy optimized mesh back to the output.
+        output_mesh = optimized_mesh;
+      } else {
+        // Split the mesh if option is true (default)
+        if (OPTIONS_split) {
+          ozz::sample::Mesh partitioned_meshes;
+          if (!SplitParts(output_mesh, &partitioned_meshes)) {
+            ozz::log::Err() << "Failed to partitioned meshes." << std::endl;
+            return EXIT_FAILURE;
+          }
 
-      if (!StripWeights(&output_mesh)) {
-        ozz::log::Err() << "Failed to strip weights." << std::endl;
-        return EXIT_FAILURE;
+          // Copy partitioned mesh back to the output.
+          output_mesh = partitioned_meshes;
+        }
+
+        if (!StripWeights(&output_mesh)) {
+          ozz::log::Err() << "Failed to strip weights." << std::endl;
+          return EXIT_FAILURE;
+        }
       }
 
       assert(OPTIONS_max_influences <= 0 ||
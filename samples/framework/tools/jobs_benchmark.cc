@@ -0,0 +1,464 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+// Benchmarks runtime jobs on a skeleton and an animation, reporting throughput
+// and latency of sampling (forward, backward and random seeking), blending (1
+// to 16 layers, partial), local-to-model, two-bone and aim IK, and optionally
+// track sampling and triggering. Results can also be written as json, for
+// performance regression tracking.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/blending_job.h"
+#include "ozz/animation/runtime/ik_aim_job.h"
+#include "ozz/animation/runtime/ik_two_bone_job.h"
+#include "ozz/animation/runtime/local_to_model_job.h"
+#include "ozz/animation/runtime/sampling_job.h"
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/animation/runtime/track.h"
+#include "ozz/animation/runtime/track_sampling_job.h"
+#include "ozz/animation/runtime/track_triggering_job.h"
+#include "ozz/base/io/archive.h"
+#include "ozz/base/io/stream.h"
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/log.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/simd_quaternion.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/options/options.h"
+
+OZZ_OPTIONS_DECLARE_STRING(skeleton,
+                           "Path to the skeleton (ozz archive format).",
+                           "media/skeleton.ozz", false)
+
+OZZ_OPTIONS_DECLARE_STRING(animation,
+                           "Path to the animation (ozz archive format).",
+                           "media/animation.ozz", false)
+
+OZZ_OPTIONS_DECLARE_STRING(
+    track,
+    "Optional path to a float track (ozz archive format), used to benchmark "
+    "track sampling and triggering.",
+    "", false)
+
+OZZ_OPTIONS_DECLARE_STRING(json, "Optional path to the json results file.", "",
+                           false)
+
+OZZ_OPTIONS_DECLARE_FLOAT(duration,
+                          "Minimum duration of each measure, in seconds.", .1f,
+                          false)
+
+namespace {
+
+// Loads an object of type _Type from _filename.
+template <typename _Type>
+bool Load(const char* _filename, _Type* _object) {
+  ozz::io::File file(_filename, "rb");
+  if (!file.opened()) {
+    ozz::log::Err() << "Failed to open file " << _filename << "." << std::endl;
+    return false;
+  }
+  ozz::io::IArchive archive(&file);
+  if (!archive.TestTag<_Type>()) {
+    ozz::log::Err() << "Failed to load object from file " << _filename << "."
+                    << std::endl;
+    return false;
+  }
+  archive >> *_object;
+  return true;
+}
+
+// Defines how ratios are updated from one run to the next.
+enum Seek {
+  kForward,   // Ratio increases by a frame.
+  kBackward,  // Ratio decreases by a frame.
+  kRandom     // Ratio is randomly chosen.
+};
+
+// Updates _ratio according to _seek, looping in range [0,1].
+float NextRatio(Seek _seek, float _ratio, float _step, unsigned int* _seed) {
+  switch (_seek) {
+    case kForward: {
+      const float ratio = _ratio + _step;
+      return ratio > 1.f ? ratio - 1.f : ratio;
+    }
+    case kBackward: {
+      const float ratio = _ratio - _step;
+      return ratio < 0.f ? ratio + 1.f : ratio;
+    }
+    default: {
+      // Linear congruential generator, so sequences are the same on every run
+      // and platform.
+      *_seed = *_seed * 1664525u + 1013904223u;
+      return static_cast<float>(*_seed >> 8) / static_cast<float>(1 << 24);
+    }
+  }
+}
+
+// Runs any job which doesn't need to be updated between runs.
+template <typename _Job>
+struct JobBench {
+  bool Run() { return job.Run(); }
+  _Job job;
+};
+
+// Runs a job with a ratio, updated between runs according to seek.
+template <typename _Job>
+struct RatioBench {
+  RatioBench() : seek(kForward), step(0.f), seed(0) {}
+  bool Run() {
+    job.ratio = NextRatio(seek, job.ratio, step, &seed);
+    return job.Run();
+  }
+  _Job job;
+  Seek seek;
+  float step;
+  unsigned int seed;
+};
+
+// Runs a triggering job on a time range moving forward by step, and iterates
+// all the edges.
+struct TriggeringBench {
+  TriggeringBench() : step(0.f), num_edges(0) {}
+  bool Run() {
+    job.from = job.to;
+    job.to += step;
+    if (!job.Run()) {
+      return false;
+    }
+    const ozz::animation::TrackTriggeringJob::Iterator end = job.end();
+    for (; iterator != end; ++iterator) {
+      ++num_edges;
+    }
+    return true;
+  }
+  ozz::animation::TrackTriggeringJob job;
+  ozz::animation::TrackTriggeringJob::Iterator iterator;
+  float step;
+  int num_edges;
+};
+
+// Measure result.
+struct Result {
+  std::string name;
+  int items;  // Number of items (joints, layers...) processed by a run.
+  long long runs;
+  double mean;    // Mean run duration, in microseconds.
+  double median;  // Median run duration, in microseconds.
+  double p99;     // 99th percentile run duration, in microseconds.
+  double mad;     // Median absolute deviation of runs, in microseconds.
+};
+
+// Runs _bench during at least _duration seconds (and at least once), timing
+// every run. Returns false if a run fails.
+template <typename _Bench>
+bool Measure(const char* _name, int _items, float _duration, _Bench* _bench,
+             std::vector<Result>* _results) {
+  typedef std::chrono::high_resolution_clock Clock;
+  std::vector<double> timings;
+  double elapsed = 0.;
+  do {
+    const Clock::time_point begin = Clock::now();
+    if (!_bench->Run()) {
+      ozz::log::Err() << "Failed to run " << _name << " benchmark."
+                      << std::endl;
+      return false;
+    }
+    const double timing =
+        std::chrono::duration<double, std::micro>(Clock::now() - begin).count();
+    timings.push_back(timing);
+    elapsed += timing * 1e-6;
+  } while (elapsed < _duration);
+
+  std::sort(timings.begin(), timings.end());
+  Result result;
+  result.name = _name;
+  result.items = _items;
+  result.runs = static_cast<long long>(timings.size());
+  result.mean = elapsed * 1e6 / timings.size();
+  result.median = timings[timings.size() / 2];
+  result.p99 = timings[(timings.size() * 99) / 100];
+  for (size_t i = 0; i < timings.size(); ++i) {
+    timings[i] = std::abs(timings[i] - result.median);
+  }
+  std::sort(timings.begin(), timings.end());
+  result.mad = timings[timings.size() / 2];
+  _results->push_back(result);
+
+  ozz::log::Out() << std::left << std::setw(20) << _name << std::setw(8)
+                  << _items << std::setw(12) << result.runs << std::fixed
+                  << std::setprecision(3) << std::setw(12) << result.mean
+                  << std::setw(12) << result.median << std::setw(12)
+                  << result.p99 << std::setprecision(2)
+                  << _items / result.mean << std::endl;
+  return true;
+}
+
+// Writes _results to json file _filename.
+bool WriteJson(const char* _filename, const ozz::animation::Skeleton& _skeleton,
+               const std::vector<Result>& _results) {
+  std::ofstream file(_filename);
+  if (!file) {
+    ozz::log::Err() << "Failed to open json file " << _filename << "."
+                    << std::endl;
+    return false;
+  }
+  file << "{\n  \"skeleton\": \"" << OPTIONS_skeleton.value() << "\",\n"
+       << "  \"animation\": \"" << OPTIONS_animation.value() << "\",\n"
+       << "  \"joints\": " << _skeleton.num_joints() << ",\n"
+       << "  \"results\": [";
+  for (size_t i = 0; i < _results.size(); ++i) {
+    const Result& result = _results[i];
+    file << (i == 0 ? "\n" : ",\n") << "    {\"name\": \"" << result.name
+         << "\", \"items\": " << result.items << ", \"runs\": " << result.runs
+         << ", \"mean_us\": " << result.mean
+         << ", \"median_us\": " << result.median
+         << ", \"p99_us\": " << result.p99
+         << ", \"mad_us\": " << result.mad
+         << ", \"items_per_us\": " << result.items / result.mean << "}";
+  }
+  file << "\n  ]\n}\n";
+  return file.good();
+}
+}  // namespace
+
+int main(int _argc, const char** _argv) {
+  // Parses arguments.
+  ozz::options::ParseResult parse_result = ozz::options::ParseCommandLine(
+      _argc, _argv, "1.0", "Benchmarks runtime jobs");
+  if (parse_result != ozz::options::kSuccess) {
+    return parse_result == ozz::options::kExitSuccess ? EXIT_SUCCESS
+                                                      : EXIT_FAILURE;
+  }
+
+  // Loads data.
+  ozz::animation::Skeleton skeleton;
+  ozz::animation::Animation animation;
+  if (!Load(OPTIONS_skeleton.value(), &skeleton) ||
+      !Load(OPTIONS_animation.value(), &animation)) {
+    return EXIT_FAILURE;
+  }
+  const int num_joints = skeleton.num_joints();
+  const int num_soa_joints = skeleton.num_soa_joints();
+  if (num_joints == 0 || animation.num_tracks() != num_joints) {
+    ozz::log::Err() << "Animation doesn't match skeleton." << std::endl;
+    return EXIT_FAILURE;
+  }
+  ozz::animation::FloatTrack track;
+  const bool has_track = OPTIONS_track.value()[0] != 0;
+  if (has_track && !Load(OPTIONS_track.value(), &track)) {
+    return EXIT_FAILURE;
+  }
+
+  ozz::log::Out() << "Skeleton " << OPTIONS_skeleton.value() << ", "
+                  << num_joints << " joints." << std::endl;
+  ozz::log::Out() << std::left << std::setw(20) << "job" << std::setw(8)
+                  << "items" << std::setw(12) << "runs" << std::setw(12)
+                  << "mean(us)" << std::setw(12) << "median(us)"
+                  << std::setw(12) << "p99(us)"
+                  << "items/us" << std::endl;
+
+  std::vector<Result> results;
+  const float duration = OPTIONS_duration;
+
+  // Sampling, one frame at 60Hz per run when seeking forward or backward.
+  ozz::animation::SamplingCache cache(num_joints);
+  ozz::Vector<ozz::math::SoaTransform>::Std locals(num_soa_joints);
+  const float frame =
+      animation.duration() > 0.f ? 1.f / (60.f * animation.duration()) : 0.f;
+  {
+    const Seek seeks[] = {kForward, kBackward, kRandom};
+    const char* names[] = {"sampling_forward", "sampling_backward",
+                           "sampling_random"};
+    for (int i = 0; i < 3; ++i) {
+      RatioBench<ozz::animation::SamplingJob> bench;
+      bench.seek = seeks[i];
+      bench.step = frame;
+      bench.job.animation = &animation;
+      bench.job.cache = &cache;
+      bench.job.output = ozz::make_range(locals);
+      cache.Invalidate();
+      if (!Measure(names[i], num_joints, duration, &bench, &results)) {
+        return EXIT_FAILURE;
+      }
+    }
+  }
+
+  // Samples poses to blend, spread over the animation.
+  const int kMaxLayers = 16;
+  ozz::Vector<ozz::math::SoaTransform>::Std poses(num_soa_joints * kMaxLayers);
+  for (int i = 0; i < kMaxLayers; ++i) {
+    ozz::animation::SamplingJob job;
+    job.animation = &animation;
+    job.cache = &cache;
+    job.ratio = static_cast<float>(i) / kMaxLayers;
+    job.output = ozz::Range<ozz::math::SoaTransform>(
+        &poses[num_soa_joints * i], num_soa_joints);
+    if (!job.Run()) {
+      return EXIT_FAILURE;
+    }
+  }
+
+  // Per joint weights for partial blending.
+  ozz::Vector<ozz::math::SimdFloat4>::Std joint_weights(num_soa_joints);
+  for (int i = 0; i < num_soa_joints; ++i) {
+    joint_weights[i] = ozz::math::simd_float4::Load(
+        i % 2 ? 1.f : 0.f, .5f, i % 3 ? .2f : 0.f, 1.f);
+  }
+
+  // Blending.
+  {
+    ozz::animation::BlendingJob::Layer layers[kMaxLayers];
+    for (int i = 0; i < kMaxLayers; ++i) {
+      layers[i].weight = 1.f / (i + 1);
+      layers[i].transform = ozz::Range<const ozz::math::SoaTransform>(
+          &poses[num_soa_joints * i], num_soa_joints);
+    }
+    ozz::Vector<ozz::math::SoaTransform>::Std blended(num_soa_joints);
+    JobBench<ozz::animation::BlendingJob> bench;
+    bench.job.bind_pose = skeleton.joint_bind_poses();
+    bench.job.output = ozz::make_range(blended);
+    for (int n = 1; n <= kMaxLayers; n *= 2) {
+      char name[32];
+      std::sprintf(name, "blending_%d", n);
+      bench.job.layers =
+          ozz::Range<const ozz::animation::BlendingJob::Layer>(layers, n);
+      if (!Measure(name, n * num_joints, duration, &bench, &results)) {
+        return EXIT_FAILURE;
+      }
+    }
+
+    // Partial blending, with half of the layers using joint weights.
+    const int kPartialLayers = 4;
+    for (int i = 0; i < kPartialLayers; i += 2) {
+      layers[i].joint_weights = ozz::make_range(joint_weights);
+    }
+    bench.job.layers = ozz::Range<const ozz::animation::BlendingJob::Layer>(
+        layers, kPartialLayers);
+    if (!Measure("blending_partial_4", kPartialLayers * num_joints, duration,
+                 &bench, &results)) {
+      return EXIT_FAILURE;
+    }
+  }
+
+  // Local to model.
+  ozz::Vector<ozz::math::Float4x4>::Std models(num_joints);
+  {
+    JobBench<ozz::animation::LocalToModelJob> bench;
+    bench.job.skeleton = &skeleton;
+    bench.job.input = ozz::Range<const ozz::math::SoaTransform>(
+        &poses[0], num_soa_joints);
+    bench.job.output = ozz::make_range(models);
+    if (!Measure("local_to_model", num_joints, duration, &bench, &results)) {
+      return EXIT_FAILURE;
+    }
+  }
+
+  // IK, on the deepest joint of the hierarchy.
+  {
+    const ozz::Range<const int16_t> parents = skeleton.joint_parents();
+    int end = 0;
+    int end_depth = 0;
+    std::vector<int> depths(num_joints);
+    for (int i = 0; i < num_joints; ++i) {
+      const int parent = parents[i];
+      depths[i] = parent == ozz::animation::Skeleton::kNoParent
+                      ? 0
+                      : depths[parent] + 1;
+      if (depths[i] > end_depth) {
+        end = i;
+        end_depth = depths[i];
+      }
+    }
+    if (end_depth >= 2) {
+      const int mid = parents[end];
+      const int start = parents[mid];
+      const ozz::math::SimdFloat4 target = ozz::math::simd_float4::Load(
+          .5f, 1.f, .5f, 0.f);
+
+      ozz::math::SimdQuaternion start_correction;
+      ozz::math::SimdQuaternion mid_correction;
+      JobBench<ozz::animation::IKTwoBoneJob> two_bone;
+      two_bone.job.target = target;
+      two_bone.job.start_joint = &models[start];
+      two_bone.job.mid_joint = &models[mid];
+      two_bone.job.end_joint = &models[end];
+      two_bone.job.start_joint_correction = &start_correction;
+      two_bone.job.mid_joint_correction = &mid_correction;
+      if (!Measure("ik_two_bone", 1, duration, &two_bone, &results)) {
+        return EXIT_FAILURE;
+      }
+
+      ozz::math::SimdQuaternion correction;
+      JobBench<ozz::animation::IKAimJob> aim;
+      aim.job.target = target;
+      aim.job.joint = &models[end];
+      aim.job.joint_correction = &correction;
+      if (!Measure("ik_aim", 1, duration, &aim, &results)) {
+        return EXIT_FAILURE;
+      }
+    }
+  }
+
+  // Tracks.
+  if (has_track) {
+    float value;
+    RatioBench<ozz::animation::FloatTrackSamplingJob> sampling;
+    sampling.step = 1.f / 60.f;
+    sampling.job.track = &track;
+    sampling.job.result = &value;
+    if (!Measure("track_sampling", 1, duration, &sampling, &results)) {
+      return EXIT_FAILURE;
+    }
+
+    TriggeringBench triggering;
+    triggering.step = 1.f / 60.f;
+    triggering.job.track = &track;
+    triggering.job.threshold = .5f;
+    triggering.job.iterator = &triggering.iterator;
+    if (!Measure("track_triggering", 1, duration, &triggering, &results)) {
+      return EXIT_FAILURE;
+    }
+  }
+
+  if (OPTIONS_json.value()[0] != 0 &&
+      !WriteJson(OPTIONS_json.value(), skeleton, results)) {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
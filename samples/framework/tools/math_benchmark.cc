@@ -0,0 +1,394 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+// Benchmarks core simd math library primitives (vectors normalization,
+// transpositions, half floats conversions, quaternions and matrices), as
+// implemented by the SIMD backend selected when the library was built (see
+// ozz::math::SimdImplementationName()). Results can also be written as json,
+// which include the backend name, so they can be compared across backends and
+// releases.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/log.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/simd_quaternion.h"
+#include "ozz/base/maths/soa_quaternion.h"
+#include "ozz/options/options.h"
+
+OZZ_OPTIONS_DECLARE_STRING(json, "Optional path to the json results file.", "",
+                           false)
+
+OZZ_OPTIONS_DECLARE_FLOAT(duration,
+                          "Minimum duration of each measure, in seconds.", .1f,
+                          false)
+
+namespace {
+
+// Number of elements processed by each run.
+const int kCount = 1024;
+
+// Input and output buffers shared by all measures. Every measure reads inputs
+// and writes outputs to memory, so the compiler can't discard computations.
+struct Data {
+  Data()
+      : floats(kCount),
+        floats_out(kCount),
+        halves(kCount),
+        quaternions(kCount),
+        quaternions_out(kCount),
+        soa_quaternions(kCount / 4),
+        soa_quaternions_out(kCount / 4),
+        matrices(kCount),
+        matrices_out(kCount),
+        scalars(kCount * 4),
+        scalar_halves(kCount * 4) {}
+
+  ozz::Vector<ozz::math::SimdFloat4>::Std floats;
+  ozz::Vector<ozz::math::SimdFloat4>::Std floats_out;
+  ozz::Vector<ozz::math::SimdInt4>::Std halves;
+  ozz::Vector<ozz::math::SimdQuaternion>::Std quaternions;
+  ozz::Vector<ozz::math::SimdQuaternion>::Std quaternions_out;
+  ozz::Vector<ozz::math::SoaQuaternion>::Std soa_quaternions;
+  ozz::Vector<ozz::math::SoaQuaternion>::Std soa_quaternions_out;
+  ozz::Vector<ozz::math::Float4x4>::Std matrices;
+  ozz::Vector<ozz::math::Float4x4>::Std matrices_out;
+  ozz::Vector<float>::Std scalars;
+  ozz::Vector<uint16_t>::Std scalar_halves;
+};
+
+// Returns a pseudo random value in range [-1,1]. Uses a linear congruential
+// generator, so sequences are the same on every run and platform.
+float Random(unsigned int* _seed) {
+  *_seed = *_seed * 1664525u + 1013904223u;
+  return static_cast<float>(*_seed >> 8) / static_cast<float>(1 << 23) - 1.f;
+}
+
+// Fills _data inputs.
+void Initialize(Data* _data) {
+  using ozz::math::SimdFloat4;
+  unsigned int seed = 0;
+  for (int i = 0; i < kCount; ++i) {
+    const SimdFloat4 v = ozz::math::simd_float4::Load(
+        Random(&seed), Random(&seed), Random(&seed), Random(&seed) + 2.f);
+    _data->floats[i] = v;
+    _data->quaternions[i].xyzw = ozz::math::Normalize4(v);
+    _data->matrices[i] = ozz::math::Float4x4::FromAffine(
+        v, _data->quaternions[i].xyzw, ozz::math::simd_float4::one());
+  }
+  for (int i = 0; i < kCount / 4; ++i) {
+    const ozz::math::SimdQuaternion* q = &_data->quaternions[i * 4];
+    SimdFloat4 soa[4];
+    const SimdFloat4 aos[4] = {q[0].xyzw, q[1].xyzw, q[2].xyzw, q[3].xyzw};
+    ozz::math::Transpose4x4(aos, soa);
+    const ozz::math::SoaQuaternion soa_q = {soa[0], soa[1], soa[2], soa[3]};
+    _data->soa_quaternions[i] = soa_q;
+  }
+  for (int i = 0; i < kCount * 4; ++i) {
+    _data->scalars[i] = Random(&seed) * 1000.f;
+  }
+  ozz::math::FloatToHalf(&_data->scalars[0], _data->scalars.size(),
+                         &_data->scalar_halves[0]);
+  for (int i = 0; i < kCount; ++i) {
+    _data->halves[i] = ozz::math::FloatToHalf(_data->floats[i]);
+  }
+}
+
+void Normalize4(Data* _data) {
+  for (int i = 0; i < kCount; ++i) {
+    _data->floats_out[i] = ozz::math::Normalize4(_data->floats[i]);
+  }
+}
+
+void NormalizeEst4(Data* _data) {
+  for (int i = 0; i < kCount; ++i) {
+    _data->floats_out[i] = ozz::math::NormalizeEst4(_data->floats[i]);
+  }
+}
+
+void RSqrtEstNR(Data* _data) {
+  for (int i = 0; i < kCount; ++i) {
+    _data->floats_out[i] = ozz::math::RSqrtEstNR(_data->floats[i]);
+  }
+}
+
+void SinCos(Data* _data) {
+  for (int i = 0; i < kCount; ++i) {
+    _data->floats_out[i] =
+        ozz::math::Sin(_data->floats[i]) + ozz::math::Cos(_data->floats[i]);
+  }
+}
+
+void Transpose4x4(Data* _data) {
+  for (int i = 0; i < kCount; i += 4) {
+    ozz::math::Transpose4x4(&_data->floats[i], &_data->floats_out[i]);
+  }
+}
+
+void Transpose16x16(Data* _data) {
+  for (int i = 0; i < kCount; i += 16) {
+    ozz::math::Transpose16x16(&_data->floats[i], &_data->floats_out[i]);
+  }
+}
+
+void FloatToHalf(Data* _data) {
+  for (int i = 0; i < kCount; ++i) {
+    _data->halves[i] = ozz::math::FloatToHalf(_data->floats[i]);
+  }
+}
+
+void HalfToFloat(Data* _data) {
+  for (int i = 0; i < kCount; ++i) {
+    _data->floats_out[i] = ozz::math::HalfToFloat(_data->halves[i]);
+  }
+}
+
+void FloatToHalfBatch(Data* _data) {
+  ozz::math::FloatToHalf(&_data->scalars[0], _data->scalars.size(),
+                         &_data->scalar_halves[0]);
+}
+
+void HalfToFloatBatch(Data* _data) {
+  ozz::math::HalfToFloat(&_data->scalar_halves[0],
+                         _data->scalar_halves.size(), &_data->scalars[0]);
+}
+
+void QuaternionMultiply(Data* _data) {
+  for (int i = 0; i < kCount; ++i) {
+    _data->quaternions_out[i] =
+        _data->quaternions[i] * _data->quaternions[kCount - 1 - i];
+  }
+}
+
+void QuaternionNormalize(Data* _data) {
+  for (int i = 0; i < kCount; ++i) {
+    _data->quaternions_out[i] = ozz::math::Normalize(_data->quaternions[i]);
+  }
+}
+
+void QuaternionNormalizeEst(Data* _data) {
+  for (int i = 0; i < kCount; ++i) {
+    _data->quaternions_out[i] = ozz::math::NormalizeEst(_data->quaternions[i]);
+  }
+}
+
+void SoaQuaternionNLerp(Data* _data) {
+  const ozz::math::SimdFloat4 alpha = ozz::math::simd_float4::Load1(.3f);
+  for (int i = 0; i < kCount / 4; ++i) {
+    _data->soa_quaternions_out[i] =
+        NLerp(_data->soa_quaternions[i],
+              _data->soa_quaternions[kCount / 4 - 1 - i], alpha);
+  }
+}
+
+void SoaQuaternionNLerpEst(Data* _data) {
+  const ozz::math::SimdFloat4 alpha = ozz::math::simd_float4::Load1(.3f);
+  for (int i = 0; i < kCount / 4; ++i) {
+    _data->soa_quaternions_out[i] =
+        NLerpEst(_data->soa_quaternions[i],
+                 _data->soa_quaternions[kCount / 4 - 1 - i], alpha);
+  }
+}
+
+void Float4x4Multiply(Data* _data) {
+  for (int i = 0; i < kCount; ++i) {
+    _data->matrices_out[i] =
+        _data->matrices[i] * _data->matrices[kCount - 1 - i];
+  }
+}
+
+void Float4x4Invert(Data* _data) {
+  for (int i = 0; i < kCount; ++i) {
+    _data->matrices_out[i] = ozz::math::Invert(_data->matrices[i]);
+  }
+}
+
+void Float4x4TransformPoint(Data* _data) {
+  for (int i = 0; i < kCount; ++i) {
+    _data->floats_out[i] =
+        TransformPoint(_data->matrices[i], _data->floats[i]);
+  }
+}
+
+void Float4x4ToQuaternion(Data* _data) {
+  for (int i = 0; i < kCount; ++i) {
+    _data->floats_out[i] = ozz::math::ToQuaternion(_data->matrices[i]);
+  }
+}
+
+// Declares a measure.
+struct Bench {
+  const char* name;
+  void (*fn)(Data*);
+  int items;  // Number of items (vectors, quaternions...) processed by a run.
+};
+
+// Measure result.
+struct Result {
+  std::string name;
+  int items;
+  long long runs;
+  double mean;    // Mean run duration, in microseconds.
+  double median;  // Median run duration, in microseconds.
+  double p99;     // 99th percentile run duration, in microseconds.
+  double mad;     // Median absolute deviation of runs, in microseconds.
+};
+
+// Runs _bench during at least _duration seconds (and at least once), timing
+// every run.
+void Measure(const Bench& _bench, float _duration, Data* _data,
+             std::vector<Result>* _results) {
+  typedef std::chrono::high_resolution_clock Clock;
+  std::vector<double> timings;
+  double elapsed = 0.;
+  do {
+    const Clock::time_point begin = Clock::now();
+    _bench.fn(_data);
+    const double timing =
+        std::chrono::duration<double, std::micro>(Clock::now() - begin).count();
+    timings.push_back(timing);
+    elapsed += timing * 1e-6;
+  } while (elapsed < _duration);
+
+  std::sort(timings.begin(), timings.end());
+  Result result;
+  result.name = _bench.name;
+  result.items = _bench.items;
+  result.runs = static_cast<long long>(timings.size());
+  result.mean = elapsed * 1e6 / timings.size();
+  result.median = timings[timings.size() / 2];
+  result.p99 = timings[(timings.size() * 99) / 100];
+  for (size_t i = 0; i < timings.size(); ++i) {
+    timings[i] = std::abs(timings[i] - result.median);
+  }
+  std::sort(timings.begin(), timings.end());
+  result.mad = timings[timings.size() / 2];
+  _results->push_back(result);
+
+  ozz::log::Out() << std::left << std::setw(28) << _bench.name << std::setw(8)
+                  << _bench.items << std::setw(12) << result.runs
+                  << std::fixed << std::setprecision(3) << std::setw(12)
+                  << result.mean << std::setw(12) << result.median
+                  << std::setw(12) << result.p99 << std::setprecision(2)
+                  << _bench.items / result.median << std::endl;
+}
+
+// Writes _results to json file _filename.
+bool WriteJson(const char* _filename, const std::vector<Result>& _results) {
+  std::ofstream file(_filename);
+  if (!file) {
+    ozz::log::Err() << "Failed to open json file " << _filename << "."
+                    << std::endl;
+    return false;
+  }
+  file << "{\n  \"simd\": \"" << ozz::math::SimdImplementationName()
+       << "\",\n  \"avx2_fma\": "
+       << (ozz::math::CpuSupportsAvx2Fma() ? "true" : "false") << ",\n"
+       << "  \"results\": [";
+  for (size_t i = 0; i < _results.size(); ++i) {
+    const Result& result = _results[i];
+    file << (i == 0 ? "\n" : ",\n") << "    {\"name\": \"" << result.name
+         << "\", \"items\": " << result.items << ", \"runs\": " << result.runs
+         << ", \"mean_us\": " << result.mean
+         << ", \"median_us\": " << result.median
+         << ", \"p99_us\": " << result.p99
+         << ", \"mad_us\": " << result.mad
+         << ", \"items_per_us\": " << result.items / result.median << "}";
+  }
+  file << "\n  ]\n}\n";
+  return file.good();
+}
+}  // namespace
+
+int main(int _argc, const char** _argv) {
+  // Parses arguments.
+  ozz::options::ParseResult parse_result = ozz::options::ParseCommandLine(
+      _argc, _argv, "1.0", "Benchmarks simd math library primitives");
+  if (parse_result != ozz::options::kSuccess) {
+    return parse_result == ozz::options::kExitSuccess ? EXIT_SUCCESS
+                                                      : EXIT_FAILURE;
+  }
+  if (OPTIONS_duration < 0.f) {
+    ozz::log::Err() << "Invalid negative duration." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  const Bench benches[] = {
+      {"float4_normalize", Normalize4, kCount},
+      {"float4_normalize_est", NormalizeEst4, kCount},
+      {"float4_rsqrt_est_nr", RSqrtEstNR, kCount},
+      {"float4_sin_cos", SinCos, kCount},
+      {"transpose4x4", Transpose4x4, kCount},
+      {"transpose16x16", Transpose16x16, kCount},
+      {"float_to_half", FloatToHalf, kCount * 4},
+      {"half_to_float", HalfToFloat, kCount * 4},
+      {"float_to_half_batch", FloatToHalfBatch, kCount * 4},
+      {"half_to_float_batch", HalfToFloatBatch, kCount * 4},
+      {"quaternion_multiply", QuaternionMultiply, kCount},
+      {"quaternion_normalize", QuaternionNormalize, kCount},
+      {"quaternion_normalize_est", QuaternionNormalizeEst, kCount},
+      {"soa_quaternion_nlerp", SoaQuaternionNLerp, kCount},
+      {"soa_quaternion_nlerp_est", SoaQuaternionNLerpEst, kCount},
+      {"float4x4_multiply", Float4x4Multiply, kCount},
+      {"float4x4_invert", Float4x4Invert, kCount},
+      {"float4x4_transform_point", Float4x4TransformPoint, kCount},
+      {"float4x4_to_quaternion", Float4x4ToQuaternion, kCount}};
+
+  Data data;
+  Initialize(&data);
+
+  ozz::log::Out() << "SIMD implementation "
+                  << ozz::math::SimdImplementationName()
+                  << (ozz::math::CpuSupportsAvx2Fma() ? ", AVX2 and FMA." : ".")
+                  << std::endl;
+  ozz::log::Out() << std::left << std::setw(28) << "primitive" << std::setw(8)
+                  << "items" << std::setw(12) << "runs" << std::setw(12)
+                  << "mean(us)" << std::setw(12) << "median(us)"
+                  << std::setw(12) << "p99(us)"
+                  << "items/us" << std::endl;
+
+  std::vector<Result> results;
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(benches); ++i) {
+    Measure(benches[i], OPTIONS_duration, &data, &results);
+  }
+
+  if (OPTIONS_json.value()[0] != 0 &&
+      !WriteJson(OPTIONS_json.value(), results)) {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,383 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+// Sweeps AnimationOptimizer tolerances over a library of raw animations, and
+// reports for every setting the resulting runtime animations memory size,
+// sampling cost, and maximum and mean model-space joints error compared to
+// the unoptimized animations. Results can also be written as json, to choose
+// a size, speed and accuracy trade-off from data.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/animation_optimizer.h"
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/local_to_model_job.h"
+#include "ozz/animation/runtime/sampling_job.h"
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/io/archive.h"
+#include "ozz/base/io/stream.h"
+#include "ozz/base/log.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/allocator.h"
+#include "ozz/options/options.h"
+
+OZZ_OPTIONS_DECLARE_STRING(skeleton,
+                           "Path to the skeleton (ozz archive format).",
+                           "media/skeleton.ozz", false)
+
+OZZ_OPTIONS_DECLARE_STRING(
+    animations,
+    "Comma separated list of raw animations files (ozz archive format). A "
+    "file can contain many raw animations.",
+    "media/animation_raw.ozz", false)
+
+OZZ_OPTIONS_DECLARE_STRING(
+    factors,
+    "Comma separated list of factors applied to optimizer default tolerances, "
+    "one setting per factor.",
+    "0,.25,.5,1,2,4", false)
+
+OZZ_OPTIONS_DECLARE_BOOL(
+    model_space,
+    "Sweeps model-space optimization tolerance instead of local-space ones.",
+    false, false)
+
+OZZ_OPTIONS_DECLARE_STRING(json, "Optional path to the json results file.", "",
+                           false)
+
+OZZ_OPTIONS_DECLARE_FLOAT(
+    duration, "Minimum duration of each sampling cost measure, in seconds.",
+    .1f, false)
+
+namespace {
+
+// Frequency at which animations are sampled, to measure error and cost.
+const float kFrequency = 60.f;
+
+// Splits comma separated _list.
+std::vector<std::string> Split(const char* _list) {
+  std::vector<std::string> items;
+  std::string item;
+  for (const char* c = _list;; ++c) {
+    if (*c == ',' || *c == 0) {
+      if (!item.empty()) {
+        items.push_back(item);
+      }
+      item.clear();
+      if (*c == 0) {
+        break;
+      }
+    } else {
+      item += *c;
+    }
+  }
+  return items;
+}
+
+// Loads all the raw animations of file _filename.
+bool LoadRawAnimations(
+    const char* _filename,
+    ozz::Vector<ozz::animation::offline::RawAnimation>::Std* _animations) {
+  ozz::io::File file(_filename, "rb");
+  if (!file.opened()) {
+    ozz::log::Err() << "Failed to open file " << _filename << "." << std::endl;
+    return false;
+  }
+  ozz::io::IArchive archive(&file);
+  const size_t count = _animations->size();
+  while (archive.TestTag<ozz::animation::offline::RawAnimation>()) {
+    _animations->resize(_animations->size() + 1);
+    archive >> _animations->back();
+  }
+  if (_animations->size() == count) {
+    ozz::log::Err() << "Failed to load raw animation from file " << _filename
+                    << "." << std::endl;
+    return false;
+  }
+  return true;
+}
+
+// Samples _animation at _ratio, and computes model-space matrices.
+bool SampleModels(const ozz::animation::Skeleton& _skeleton,
+                  const ozz::animation::Animation& _animation, float _ratio,
+                  ozz::animation::SamplingCache* _cache,
+                  ozz::Vector<ozz::math::SoaTransform>::Std* _locals,
+                  ozz::Vector<ozz::math::Float4x4>::Std* _models) {
+  ozz::animation::SamplingJob sampling_job;
+  sampling_job.animation = &_animation;
+  sampling_job.cache = _cache;
+  sampling_job.ratio = _ratio;
+  sampling_job.output = ozz::make_range(*_locals);
+  ozz::animation::LocalToModelJob ltm_job;
+  ltm_job.skeleton = &_skeleton;
+  ltm_job.input = ozz::make_range(*_locals);
+  ltm_job.output = ozz::make_range(*_models);
+  return sampling_job.Run() && ltm_job.Run();
+}
+
+// Result of a clip for a setting.
+struct Result {
+  size_t size;           // Runtime animation size, in bytes.
+  double sampling;       // Mean sampling duration, in microseconds.
+  float max_error;       // Maximum joint error, in millimeters.
+  double mean_error;     // Mean joint error, in millimeters.
+  long long num_errors;  // Number of joint errors accumulated in mean_error.
+};
+
+// Measures _optimized against _reference, on every joint at kFrequency.
+bool Measure(const ozz::animation::Skeleton& _skeleton,
+             const ozz::animation::Animation& _reference,
+             const ozz::animation::Animation& _optimized, float _duration,
+             Result* _result) {
+  const int num_joints = _skeleton.num_joints();
+  ozz::animation::SamplingCache reference_cache(num_joints);
+  ozz::animation::SamplingCache optimized_cache(num_joints);
+  ozz::Vector<ozz::math::SoaTransform>::Std locals(_skeleton.num_soa_joints());
+  ozz::Vector<ozz::math::Float4x4>::Std reference_models(num_joints);
+  ozz::Vector<ozz::math::Float4x4>::Std optimized_models(num_joints);
+
+  // Error, on every frame.
+  const int num_frames =
+      std::max(1, static_cast<int>(_reference.duration() * kFrequency));
+  float max_error = 0.f;
+  double sum_error = 0.;
+  for (int f = 0; f <= num_frames; ++f) {
+    const float ratio = static_cast<float>(f) / num_frames;
+    if (!SampleModels(_skeleton, _reference, ratio, &reference_cache, &locals,
+                      &reference_models) ||
+        !SampleModels(_skeleton, _optimized, ratio, &optimized_cache, &locals,
+                      &optimized_models)) {
+      return false;
+    }
+    for (int i = 0; i < num_joints; ++i) {
+      const ozz::math::SimdFloat4 diff =
+          reference_models[i].cols[3] - optimized_models[i].cols[3];
+      const float error =
+          ozz::math::GetX(ozz::math::Length3(diff)) * 1000.f;  // mm
+      max_error = std::max(max_error, error);
+      sum_error += error;
+    }
+  }
+  _result->size = _optimized.size();
+  _result->max_error = max_error;
+  _result->num_errors = static_cast<long long>(num_frames + 1) * num_joints;
+  _result->mean_error = sum_error / _result->num_errors;
+
+  // Sampling cost, playing the animation forward at kFrequency.
+  typedef std::chrono::high_resolution_clock Clock;
+  ozz::animation::SamplingJob job;
+  job.animation = &_optimized;
+  job.cache = &optimized_cache;
+  job.output = ozz::make_range(locals);
+  optimized_cache.Invalidate();
+  long long runs = 0;
+  double elapsed = 0.;
+  const Clock::time_point begin = Clock::now();
+  do {
+    job.ratio = static_cast<float>(runs % (num_frames + 1)) / num_frames;
+    if (!job.Run()) {
+      return false;
+    }
+    ++runs;
+    elapsed = std::chrono::duration<double, std::micro>(Clock::now() - begin)
+                  .count();
+  } while (elapsed < _duration * 1e6);
+  _result->sampling = elapsed / runs;
+
+  return true;
+}
+}  // namespace
+
+int main(int _argc, const char** _argv) {
+  // Parses arguments.
+  ozz::options::ParseResult parse_result = ozz::options::ParseCommandLine(
+      _argc, _argv, "1.0",
+      "Benchmarks animation optimizer settings over a library of animations");
+  if (parse_result != ozz::options::kSuccess) {
+    return parse_result == ozz::options::kExitSuccess ? EXIT_SUCCESS
+                                                      : EXIT_FAILURE;
+  }
+
+  // Loads skeleton and animations library.
+  ozz::animation::Skeleton skeleton;
+  {
+    ozz::io::File file(OPTIONS_skeleton.value(), "rb");
+    if (!file.opened()) {
+      ozz::log::Err() << "Failed to open file " << OPTIONS_skeleton.value()
+                      << "." << std::endl;
+      return EXIT_FAILURE;
+    }
+    ozz::io::IArchive archive(&file);
+    if (!archive.TestTag<ozz::animation::Skeleton>()) {
+      ozz::log::Err() << "Failed to load skeleton from file "
+                      << OPTIONS_skeleton.value() << "." << std::endl;
+      return EXIT_FAILURE;
+    }
+    archive >> skeleton;
+  }
+  ozz::Vector<ozz::animation::offline::RawAnimation>::Std raw_animations;
+  const std::vector<std::string> files = Split(OPTIONS_animations);
+  for (size_t i = 0; i < files.size(); ++i) {
+    if (!LoadRawAnimations(files[i].c_str(), &raw_animations)) {
+      return EXIT_FAILURE;
+    }
+  }
+  if (raw_animations.empty()) {
+    ozz::log::Err() << "No animation to benchmark." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // Parses settings.
+  std::vector<float> factors;
+  const std::vector<std::string> factor_strings = Split(OPTIONS_factors);
+  for (size_t i = 0; i < factor_strings.size(); ++i) {
+    const float factor =
+        static_cast<float>(std::atof(factor_strings[i].c_str()));
+    if (factor < 0.f) {
+      ozz::log::Err() << "Invalid negative tolerance factor." << std::endl;
+      return EXIT_FAILURE;
+    }
+    factors.push_back(factor);
+  }
+
+  // Builds unoptimized reference animations.
+  const ozz::animation::offline::AnimationBuilder builder;
+  ozz::Vector<ozz::animation::Animation*>::Std references;
+  bool success = true;
+  for (size_t i = 0; success && i < raw_animations.size(); ++i) {
+    ozz::animation::Animation* animation = builder(raw_animations[i]);
+    success = animation != NULL &&
+              animation->num_tracks() == skeleton.num_joints();
+    references.push_back(animation);
+  }
+
+  ozz::log::Out() << std::left << std::setw(8) << "factor" << std::setw(8)
+                  << "clip" << std::setw(12) << "size(B)" << std::setw(14)
+                  << "sampling(us)" << std::setw(14) << "max_err(mm)"
+                  << "mean_err(mm)" << std::endl;
+
+  std::ofstream json;
+  if (OPTIONS_json.value()[0] != 0) {
+    json.open(OPTIONS_json.value());
+    success &= static_cast<bool>(json);
+    json << "{\n  \"skeleton\": \"" << OPTIONS_skeleton.value() << "\",\n"
+         << "  \"model_space\": "
+         << (OPTIONS_model_space ? "true" : "false") << ",\n"
+         << "  \"settings\": [";
+  }
+
+  const ozz::animation::offline::AnimationOptimizer defaults;
+  for (size_t s = 0; success && s < factors.size(); ++s) {
+    const float factor = factors[s];
+    ozz::animation::offline::AnimationOptimizer optimizer;
+    optimizer.model_space = OPTIONS_model_space;
+    optimizer.translation_tolerance = defaults.translation_tolerance * factor;
+    optimizer.rotation_tolerance = defaults.rotation_tolerance * factor;
+    optimizer.scale_tolerance = defaults.scale_tolerance * factor;
+    optimizer.hierarchical_tolerance = defaults.hierarchical_tolerance * factor;
+    optimizer.model_space_tolerance = defaults.model_space_tolerance * factor;
+
+    Result total = {0, 0., 0.f, 0., 0};
+    if (json.is_open()) {
+      json << (s == 0 ? "\n" : ",\n") << "    {\"factor\": " << factor
+           << ", \"clips\": [";
+    }
+    for (size_t c = 0; success && c < raw_animations.size(); ++c) {
+      ozz::animation::offline::RawAnimation optimized_raw;
+      ozz::animation::Animation* optimized = NULL;
+      Result result = {0, 0., 0.f, 0., 0};
+      success = optimizer(raw_animations[c], skeleton, &optimized_raw) &&
+                (optimized = builder(optimized_raw)) != NULL &&
+                Measure(skeleton, *references[c], *optimized,
+                        OPTIONS_duration, &result);
+      ozz::memory::default_allocator()->Delete(optimized);
+      if (!success) {
+        break;
+      }
+      total.size += result.size;
+      total.sampling += result.sampling;
+      total.max_error = std::max(total.max_error, result.max_error);
+      total.mean_error += result.mean_error * result.num_errors;
+      total.num_errors += result.num_errors;
+
+      ozz::log::Out() << std::left << std::setw(8) << factor << std::setw(8)
+                      << c << std::setw(12) << result.size << std::fixed
+                      << std::setprecision(3) << std::setw(14)
+                      << result.sampling << std::setw(14) << result.max_error
+                      << result.mean_error << std::endl;
+      if (json.is_open()) {
+        json << (c == 0 ? "\n" : ",\n") << "      {\"name\": \""
+             << raw_animations[c].name.c_str() << "\", \"size\": "
+             << result.size << ", \"sampling_us\": " << result.sampling
+             << ", \"max_error_mm\": " << result.max_error
+             << ", \"mean_error_mm\": " << result.mean_error << "}";
+      }
+    }
+    if (!success) {
+      break;
+    }
+    total.mean_error /= total.num_errors;
+
+    ozz::log::Out() << std::left << std::setw(8) << factor << std::setw(8)
+                    << "all" << std::setw(12) << total.size << std::fixed
+                    << std::setprecision(3) << std::setw(14)
+                    << total.sampling << std::setw(14) << total.max_error
+                    << total.mean_error << std::endl;
+    if (json.is_open()) {
+      json << "\n      ], \"size\": " << total.size
+           << ", \"sampling_us\": " << total.sampling
+           << ", \"max_error_mm\": " << total.max_error
+           << ", \"mean_error_mm\": " << total.mean_error << "}";
+    }
+  }
+
+  if (json.is_open()) {
+    json << "\n  ]\n}\n";
+    success &= json.good();
+  }
+
+  for (size_t i = 0; i < references.size(); ++i) {
+    ozz::memory::default_allocator()->Delete(references[i]);
+  }
+
+  if (!success) {
+    ozz::log::Err() << "Failed to benchmark optimizer settings." << std::endl;
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,330 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+// Benchmarks SkinningJob kernels on a skinned mesh, reporting the number of
+// vertices skinned per second for every kernel variant (positions, normals and
+// tangents, with or without inverse transpose matrices), every mesh part
+// (number of influences), buffers layout and number of threads.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <thread>
+#include <vector>
+
+#include "framework/mesh.h"
+
+#include "ozz/base/io/archive.h"
+#include "ozz/base/io/stream.h"
+#include "ozz/base/log.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/thread_pool.h"
+#include "ozz/geometry/runtime/parallel_skinning_job.h"
+#include "ozz/geometry/runtime/skinning_job.h"
+#include "ozz/options/options.h"
+
+OZZ_OPTIONS_DECLARE_STRING(mesh,
+                           "Path to the skinned mesh (ozz archive format).",
+                           "media/mesh.ozz", false)
+
+OZZ_OPTIONS_DECLARE_FLOAT(duration,
+                          "Minimum duration of each measure, in seconds.", .1f,
+                          false)
+
+OZZ_OPTIONS_DECLARE_INT(
+    max_threads,
+    "Maximum number of threads (0 means hardware concurrency).", 0, false)
+
+namespace {
+
+// Defines vertex buffers layouts.
+enum Layout {
+  kSeparate,    // One buffer per vertex component, as stored in the mesh.
+  kInterleaved  // A single buffer of vertices.
+};
+
+// Interleaved vertex formats.
+struct VertexIn {
+  float position[3];
+  float normal[3];
+  float tangent[4];
+};
+struct VertexOut {
+  float position[3];
+  float normal[3];
+  float tangent[3];
+};
+
+// Skinning kernel variants.
+struct Variant {
+  const char* name;
+  bool normals;
+  bool tangents;
+  bool it;
+};
+const Variant kVariants[] = {{"P", false, false, false},
+                             {"PN", true, false, false},
+                             {"PNT", true, true, false},
+                             {"PN_IT", true, false, true},
+                             {"PNT_IT", true, true, true}};
+
+// Mesh part buffers for every layout.
+struct PartBuffers {
+  std::vector<VertexIn> in;
+  std::vector<VertexOut> out;
+  std::vector<float> out_positions;
+  std::vector<float> out_normals;
+  std::vector<float> out_tangents;
+};
+
+// Setups _job to skin _part with _variant and _layout.
+void SetupJob(const ozz::sample::Mesh& _mesh,
+              const ozz::sample::Mesh::Part& _part, PartBuffers* _buffers,
+              const ozz::math::Float4x4* _matrices,
+              const ozz::math::Float4x4* _it_matrices, const Variant& _variant,
+              Layout _layout, ozz::geometry::SkinningJob* _job) {
+  const int vertex_count = _part.vertex_count();
+  const int influences = _part.influences_count();
+  const size_t num_joints = _mesh.num_joints();
+
+  ozz::geometry::SkinningJob& job = *_job;
+  job = ozz::geometry::SkinningJob();
+  job.vertex_count = vertex_count;
+  job.influences_count = influences;
+  job.joint_matrices =
+      ozz::Range<const ozz::math::Float4x4>(_matrices, num_joints);
+  if (_variant.it) {
+    job.joint_inverse_transpose_matrices =
+        ozz::Range<const ozz::math::Float4x4>(_it_matrices, num_joints);
+  }
+  job.joint_indices = make_range(_part.joint_indices);
+  job.joint_indices_stride = sizeof(uint16_t) * influences;
+  if (influences > 1) {
+    job.joint_weights = make_range(_part.joint_weights);
+    job.joint_weights_stride = sizeof(float) * (influences - 1);
+  }
+
+  if (_layout == kSeparate) {
+    job.in_positions = make_range(_part.positions);
+    job.in_positions_stride = sizeof(float) * 3;
+    job.out_positions = ozz::Range<float>(&_buffers->out_positions[0],
+                                          _buffers->out_positions.size());
+    job.out_positions_stride = sizeof(float) * 3;
+    if (_variant.normals) {
+      job.in_normals = make_range(_part.normals);
+      job.in_normals_stride = sizeof(float) * 3;
+      job.out_normals = ozz::Range<float>(&_buffers->out_normals[0],
+                                          _buffers->out_normals.size());
+      job.out_normals_stride = sizeof(float) * 3;
+    }
+    if (_variant.tangents) {
+      job.in_tangents = make_range(_part.tangents);
+      job.in_tangents_stride = sizeof(float) * 4;
+      job.out_tangents = ozz::Range<float>(&_buffers->out_tangents[0],
+                                           _buffers->out_tangents.size());
+      job.out_tangents_stride = sizeof(float) * 3;
+    }
+  } else {
+    const VertexIn* in_begin = &_buffers->in[0];
+    const VertexIn* in_end = in_begin + vertex_count;
+    VertexOut* out_begin = &_buffers->out[0];
+    VertexOut* out_end = out_begin + vertex_count;
+    job.in_positions = ozz::Range<const float>(
+        in_begin->position, reinterpret_cast<const float*>(in_end));
+    job.in_positions_stride = sizeof(VertexIn);
+    job.out_positions = ozz::Range<float>(out_begin->position,
+                                          reinterpret_cast<float*>(out_end));
+    job.out_positions_stride = sizeof(VertexOut);
+    if (_variant.normals) {
+      job.in_normals = ozz::Range<const float>(
+          in_begin->normal, reinterpret_cast<const float*>(in_end));
+      job.in_normals_stride = sizeof(VertexIn);
+      job.out_normals = ozz::Range<float>(out_begin->normal,
+                                          reinterpret_cast<float*>(out_end));
+      job.out_normals_stride = sizeof(VertexOut);
+    }
+    if (_variant.tangents) {
+      job.in_tangents = ozz::Range<const float>(
+          in_begin->tangent, reinterpret_cast<const float*>(in_end));
+      job.in_tangents_stride = sizeof(VertexIn);
+      job.out_tangents = ozz::Range<float>(out_begin->tangent,
+                                           reinterpret_cast<float*>(out_end));
+      job.out_tangents_stride = sizeof(VertexOut);
+    }
+  }
+}
+
+// Runs _job during at least _duration seconds (and at least once), and
+// returns the number of vertices skinned per second.
+double Measure(const ozz::geometry::ParallelSkinningJob& _job,
+               float _duration) {
+  typedef std::chrono::high_resolution_clock Clock;
+  const Clock::time_point begin = Clock::now();
+  double elapsed = 0.;
+  long long runs = 0;
+  do {
+    if (!_job.Run()) {
+      return 0.;
+    }
+    ++runs;
+    elapsed = std::chrono::duration<double>(Clock::now() - begin).count();
+  } while (elapsed < _duration);
+  return elapsed > 0. ? runs * _job.job.vertex_count / elapsed : 0.;
+}
+}  // namespace
+
+int main(int _argc, const char** _argv) {
+  // Parses arguments.
+  ozz::options::ParseResult parse_result = ozz::options::ParseCommandLine(
+      _argc, _argv, "1.0", "Benchmarks skinning job kernels on a mesh");
+  if (parse_result != ozz::options::kSuccess) {
+    return parse_result == ozz::options::kExitSuccess ? EXIT_SUCCESS
+                                                      : EXIT_FAILURE;
+  }
+
+  // Loads the mesh.
+  ozz::Vector<ozz::sample::Mesh>::Std meshes;
+  {
+    ozz::io::File file(OPTIONS_mesh.value(), "rb");
+    if (!file.opened()) {
+      ozz::log::Err() << "Failed to open mesh file " << OPTIONS_mesh.value()
+                      << "." << std::endl;
+      return EXIT_FAILURE;
+    }
+    ozz::io::IArchive archive(&file);
+    while (archive.TestTag<ozz::sample::Mesh>()) {
+      meshes.resize(meshes.size() + 1);
+      archive >> meshes.back();
+    }
+    if (meshes.empty()) {
+      ozz::log::Err() << "Failed to load mesh instance from file "
+                      << OPTIONS_mesh.value() << "." << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  // Computes threads counts to benchmark, by powers of 2.
+  int max_threads = OPTIONS_max_threads;
+  if (max_threads <= 0) {
+    max_threads = std::max(1, static_cast<int>(
+                                  std::thread::hardware_concurrency()));
+  }
+  std::vector<int> threads;
+  for (int i = 1; i < max_threads; i *= 2) {
+    threads.push_back(i);
+  }
+  threads.push_back(max_threads);
+
+  ozz::log::Out() << std::left << std::setw(8) << "mesh" << std::setw(8)
+                  << "part" << std::setw(12) << "influences" << std::setw(10)
+                  << "vertices" << std::setw(9) << "kernel" << std::setw(13)
+                  << "layout" << std::setw(9) << "threads"
+                  << "Mvertices/s" << std::endl;
+
+  for (size_t m = 0; m < meshes.size(); ++m) {
+    const ozz::sample::Mesh& mesh = meshes[m];
+
+    // Builds realistic joints matrices, with rotations, translations and non
+    // uniform scales.
+    const int num_joints = mesh.num_joints();
+    std::vector<ozz::math::Float4x4> matrices(std::max(num_joints, 1));
+    std::vector<ozz::math::Float4x4> it_matrices(matrices.size());
+    for (size_t i = 0; i < matrices.size(); ++i) {
+      const float f = static_cast<float>(i);
+      matrices[i] =
+          ozz::math::Float4x4::Translation(ozz::math::simd_float4::Load(
+              .1f * f, -.05f * f, .02f * f, 0.f)) *
+          ozz::math::Float4x4::FromEuler(ozz::math::simd_float4::Load(
+              .3f * f, -.2f * f, .1f * f, 0.f)) *
+          ozz::math::Float4x4::Scaling(ozz::math::simd_float4::Load(
+              1.f, 1.f + .01f * f, 1.f - .01f * f, 0.f));
+      it_matrices[i] = Transpose(Invert(matrices[i]));
+    }
+
+    for (size_t p = 0; p < mesh.parts.size(); ++p) {
+      const ozz::sample::Mesh::Part& part = mesh.parts[p];
+      const int vertex_count = part.vertex_count();
+      const int influences = part.influences_count();
+      if (vertex_count == 0 || influences == 0 ||
+          part.normals.size() != part.positions.size() ||
+          part.tangents.size() != static_cast<size_t>(vertex_count) * 4) {
+        continue;
+      }
+
+      // Prepares buffers for all layouts.
+      PartBuffers buffers;
+      buffers.in.resize(vertex_count);
+      buffers.out.resize(vertex_count);
+      buffers.out_positions.resize(vertex_count * 3);
+      buffers.out_normals.resize(vertex_count * 3);
+      buffers.out_tangents.resize(vertex_count * 3);
+      for (int v = 0; v < vertex_count; ++v) {
+        std::copy(&part.positions[v * 3], &part.positions[v * 3] + 3,
+                  buffers.in[v].position);
+        std::copy(&part.normals[v * 3], &part.normals[v * 3] + 3,
+                  buffers.in[v].normal);
+        std::copy(&part.tangents[v * 4], &part.tangents[v * 4] + 4,
+                  buffers.in[v].tangent);
+      }
+
+      for (int l = 0; l < 2; ++l) {
+        const Layout layout = static_cast<Layout>(l);
+        for (size_t k = 0; k < OZZ_ARRAY_SIZE(kVariants); ++k) {
+          for (size_t t = 0; t < threads.size(); ++t) {
+            ozz::geometry::ParallelSkinningJob job;
+            SetupJob(mesh, part, &buffers, &matrices[0], &it_matrices[0],
+                     kVariants[k], layout, &job.job);
+            ozz::ThreadPool pool(threads[t]);
+            if (threads[t] > 1) {
+              job.scheduler = &pool;
+            } else {
+              job.chunk_size = vertex_count;  // Single chunk.
+            }
+
+            const double vps = Measure(job, OPTIONS_duration);
+            if (vps == 0.) {
+              ozz::log::Err() << "Failed to run skinning job." << std::endl;
+              return EXIT_FAILURE;
+            }
+            ozz::log::Out()
+                << std::left << std::setw(8) << m << std::setw(8) << p
+                << std::setw(12) << influences << std::setw(10)
+                << vertex_count << std::setw(9) << kVariants[k].name
+                << std::setw(13)
+                << (layout == kSeparate ? "separate" : "interleaved")
+                << std::setw(9) << threads[t] << std::fixed
+                << std::setprecision(2) << vps * 1e-6 << std::endl;
+          }
+        }
+      }
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
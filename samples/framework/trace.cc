@@ -0,0 +1,270 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#include "framework/trace.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+
+#include "ozz/base/log.h"
+
+namespace ozz {
+namespace sample {
+
+namespace {
+// Maximum zones nesting recorded per thread. Deeper zones are dropped.
+const int kMaxTraceDepth = 64;
+
+// Per thread stack of open zones. A zone is only recorded if it was entered
+// during the current recording session.
+struct TraceStack {
+  int thread;  // Trace thread identifier, 0 until assigned.
+  int depth;
+  const char* names[kMaxTraceDepth];
+  double begins[kMaxTraceDepth];
+  unsigned int sessions[kMaxTraceDepth];
+};
+thread_local TraceStack trace_stack = {};
+
+// Gets calling thread trace identifier, assigned in order of first use.
+int TraceThread() {
+  static std::atomic<int> num_threads(0);
+  if (trace_stack.thread == 0) {
+    trace_stack.thread = ++num_threads;
+  }
+  return trace_stack.thread;
+}
+
+// The recording recorder, and its session identifier.
+std::atomic<TraceRecorder*> active_recorder(nullptr);
+std::atomic<unsigned int> active_session(0);
+
+void TraceBeginCallback(const char* _name, void* _user_data) {
+  static_cast<TraceRecorder*>(_user_data)->Begin(_name);
+}
+
+void TraceEndCallback(const char*, void* _user_data) {
+  static_cast<TraceRecorder*>(_user_data)->End();
+}
+
+// Writes _name to _file as a json string.
+void WriteJsonString(std::FILE* _file, const char* _name) {
+  std::fputc('"', _file);
+  for (const char* c = _name; *c; ++c) {
+    const unsigned char u = static_cast<unsigned char>(*c);
+    if (u == '"' || u == '\\') {
+      std::fputc('\\', _file);
+      std::fputc(u, _file);
+    } else if (u < 0x20) {
+      std::fprintf(_file, "\\u%04x", u);
+    } else {
+      std::fputc(u, _file);
+    }
+  }
+  std::fputc('"', _file);
+}
+}  // namespace
+
+TraceRecorder::TraceRecorder(size_t _max_events)
+    : max_events_(_max_events), dropped_(0), has_origin_(false) {}
+
+TraceRecorder::~TraceRecorder() { Stop(); }
+
+bool TraceRecorder::Start() {
+  if (!has_origin_) {
+    origin_ = Clock::now();
+    has_origin_ = true;
+  }
+  TraceRecorder* expected = nullptr;
+  if (!active_recorder.compare_exchange_strong(expected, this)) {
+    return expected == this;
+  }
+  ++active_session;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    events_.reserve(max_events_);
+  }
+  SetThreadName("main");
+
+  ozz::profile::Callbacks callbacks;
+  callbacks.begin = &TraceBeginCallback;
+  callbacks.end = &TraceEndCallback;
+  callbacks.user_data = this;
+  previous_callbacks_ = ozz::profile::SetCallbacks(callbacks);
+  return true;
+}
+
+void TraceRecorder::Stop() {
+  if (!recording()) {
+    return;
+  }
+  ozz::profile::SetCallbacks(previous_callbacks_);
+  ++active_session;
+  active_recorder.store(nullptr);
+}
+
+bool TraceRecorder::recording() const { return active_recorder.load() == this; }
+
+void TraceRecorder::Begin(const char* _name) {
+  if (!recording()) {
+    return;
+  }
+  TraceStack& stack = trace_stack;
+  if (stack.depth < kMaxTraceDepth) {
+    stack.names[stack.depth] = _name;
+    stack.sessions[stack.depth] = active_session.load();
+    stack.begins[stack.depth] = Now();
+  }
+  ++stack.depth;
+}
+
+void TraceRecorder::End() {
+  TraceStack& stack = trace_stack;
+  if (stack.depth == 0) {
+    return;  // Zone was entered before recording started.
+  }
+  const int depth = --stack.depth;
+  if (!recording()) {
+    return;
+  }
+  if (depth >= kMaxTraceDepth) {
+    ++dropped_;
+    return;
+  }
+  if (stack.sessions[depth] != active_session.load()) {
+    return;  // Zone was entered during a previous session.
+  }
+  Push(stack.names[depth], TraceThread(), stack.begins[depth], Now());
+}
+
+void TraceRecorder::SetThreadName(const char* _name) {
+  const int thread = TraceThread();
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (size_t i = 0; i < thread_names_.size(); ++i) {
+    if (thread_names_[i].thread == thread) {
+      thread_names_[i].name = _name;
+      return;
+    }
+  }
+  const ThreadName name = {thread, _name};
+  thread_names_.push_back(name);
+}
+
+size_t TraceRecorder::num_events() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return events_.size();
+}
+
+void TraceRecorder::Clear() {
+  assert(!recording() && "Can't clear a recording trace.");
+  std::lock_guard<std::mutex> lock(mutex_);
+  events_.clear();
+  thread_names_.clear();
+  dropped_.store(0);
+  has_origin_ = false;
+}
+
+double TraceRecorder::Now() const {
+  return std::chrono::duration<double, std::micro>(Clock::now() - origin_)
+      .count();
+}
+
+void TraceRecorder::Push(const char* _name, int _thread, double _begin,
+                         double _end) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (events_.size() >= max_events_) {
+    ++dropped_;
+    return;
+  }
+  const Event event = {_name, _thread, _begin, _end - _begin};
+  events_.push_back(event);
+}
+
+bool TraceRecorder::Export(const char* _filename) const {
+  std::FILE* file = std::fopen(_filename, "w");
+  if (!file) {
+    ozz::log::Err() << "Failed to open trace file " << _filename << "."
+                    << std::endl;
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  // Lists threads that recorded zones, to name them all.
+  ozz::Vector<int>::Std threads;
+  for (size_t i = 0; i < events_.size(); ++i) {
+    threads.push_back(events_[i].thread);
+  }
+  for (size_t i = 0; i < thread_names_.size(); ++i) {
+    threads.push_back(thread_names_[i].thread);
+  }
+  std::sort(threads.begin(), threads.end());
+  threads.erase(std::unique(threads.begin(), threads.end()), threads.end());
+
+  std::fprintf(file, "{\"traceEvents\":[\n");
+  const char* separator = "";
+  for (size_t i = 0; i < threads.size(); ++i) {
+    char buffer[32];
+    const char* name = buffer;
+    std::sprintf(buffer, "thread %d", threads[i]);
+    for (size_t j = 0; j < thread_names_.size(); ++j) {
+      if (thread_names_[j].thread == threads[i]) {
+        name = thread_names_[j].name;
+      }
+    }
+    std::fprintf(file,
+                 "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,"
+                 "\"tid\":%d,\"args\":{\"name\":",
+                 separator, threads[i]);
+    WriteJsonString(file, name);
+    std::fprintf(file, "}}");
+    separator = ",\n";
+  }
+  for (size_t i = 0; i < events_.size(); ++i) {
+    const Event& event = events_[i];
+    std::fprintf(file, "%s{\"name\":", separator);
+    WriteJsonString(file, event.name);
+    std::fprintf(file,
+                 ",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,"
+                 "\"dur\":%.3f}",
+                 event.thread, event.begin, event.duration);
+    separator = ",\n";
+  }
+  std::fprintf(file, "\n],\"displayTimeUnit\":\"ms\"}\n");
+
+  const bool success = std::ferror(file) == 0;
+  std::fclose(file);
+  if (!success) {
+    ozz::log::Err() << "Failed to write trace file " << _filename << "."
+                    << std::endl;
+  }
+  return success;
+}
+}  // namespace sample
+}  // namespace ozz
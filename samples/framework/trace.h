@@ -0,0 +1,143 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#ifndef OZZ_SAMPLES_FRAMEWORK_TRACE_H_
+#define OZZ_SAMPLES_FRAMEWORK_TRACE_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/profile.h"
+
+namespace ozz {
+namespace sample {
+
+// Records timed zones of all threads, and exports them to Chrome trace event
+// json format, which can be loaded in chrome://tracing or Perfetto
+// (ui.perfetto.dev) to inspect scheduling gaps.
+// While recording, the recorder is installed as ozz::profile callbacks, so it
+// records jobs zones (when ozz_build_profile is enabled), along with any zone
+// declared with ozz::profile::Zone. Zones can also be recorded manually with
+// Begin and End functions. Zones names must be static strings, as only their
+// address is recorded.
+// Zones are strictly nested per thread. Only one recorder can record at a
+// time.
+class TraceRecorder {
+ public:
+  // Records up to _max_events zones, whose memory is reserved by Start. Zones
+  // ended once the recorder is full are dropped, see num_dropped().
+  explicit TraceRecorder(size_t _max_events = 1 << 20);
+
+  // Stops recording.
+  ~TraceRecorder();
+
+  // Starts recording, and installs the recorder as ozz::profile callbacks.
+  // Timestamps are relative to the first call to Start since construction or
+  // Clear. The calling thread is named "main".
+  // Returns false if another recorder is already recording.
+  bool Start();
+
+  // Stops recording, restoring ozz::profile callbacks that were installed
+  // before Start. Zones that are still open are discarded.
+  void Stop();
+
+  // Tells if this recorder is recording.
+  bool recording() const;
+
+  // Enters a zone named _name on the calling thread. Does nothing if not
+  // recording.
+  void Begin(const char* _name);
+
+  // Leaves the innermost zone of the calling thread.
+  void End();
+
+  // Names the calling thread in the exported trace. _name must be a static
+  // string. Unnamed threads are named after their trace identifier.
+  void SetThreadName(const char* _name);
+
+  // Gets the number of recorded zones.
+  size_t num_events() const;
+
+  // Gets the number of zones that were dropped, because the recorder was full
+  // or zones were too deeply nested.
+  size_t num_dropped() const { return dropped_.load(); }
+
+  // Clears recorded zones and thread names. Can't be called while recording.
+  void Clear();
+
+  // Exports recorded zones to _filename, in Chrome trace event json format.
+  // Returns false if file can't be written.
+  bool Export(const char* _filename) const;
+
+ private:
+  // Disables copy and assignment.
+  TraceRecorder(const TraceRecorder&);
+  void operator=(const TraceRecorder&);
+
+  // Gets elapsed time since recording started, in microseconds.
+  double Now() const;
+
+  // Adds a zone, or drops it if the recorder is full.
+  void Push(const char* _name, int _thread, double _begin, double _end);
+
+  // A recorded zone, with timings in microseconds.
+  struct Event {
+    const char* name;
+    int thread;
+    double begin;
+    double duration;
+  };
+
+  // Names a trace thread.
+  struct ThreadName {
+    int thread;
+    const char* name;
+  };
+
+  typedef std::chrono::steady_clock Clock;
+
+  // Protects events_ and thread_names_.
+  mutable std::mutex mutex_;
+  ozz::Vector<Event>::Std events_;
+  ozz::Vector<ThreadName>::Std thread_names_;
+  size_t max_events_;
+  std::atomic<size_t> dropped_;
+
+  // Time origin of the trace, and whether it's set.
+  Clock::time_point origin_;
+  bool has_origin_;
+
+  // Callbacks installed before Start.
+  ozz::profile::Callbacks previous_callbacks_;
+};
+}  // namespace sample
+}  // namespace ozz
+#endif  // OZZ_SAMPLES_FRAMEWORK_TRACE_H_
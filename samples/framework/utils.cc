@@ -31,6 +31,7 @@
 #include <limits>
 
 #include "ozz/base/maths/box.h"
+#include "ozz/base/maths/box_utils.h"
 #include "ozz/base/maths/simd_math.h"
 #include "ozz/base/maths/simd_quaternion.h"
 #include "ozz/base/maths/soa_transform.h"
@@ -235,39 +236,11 @@ void ComputeSkeletonBounds(const animation::Skeleton& _skeleton,
   }
 }
 
-// Loop through matrices and collect min and max bounds.
+// Collects min and max bounds of matrices translations.
 void ComputePostureBounds(ozz::Range<const ozz::math::Float4x4> _matrices,
                           math::Box* _bound) {
   assert(_bound);
-
-  // Set a default box.
-  *_bound = ozz::math::Box();
-
-  if (!_matrices.begin || !_matrices.end) {
-    return;
-  }
-  if (_matrices.begin > _matrices.end) {
-    return;
-  }
-
-  // Loops through matrices and stores min/max.
-  // Matrices array cannot be empty, it was checked at the beginning of the
-  // function.
-  const ozz::math::Float4x4* current = _matrices.begin;
-  math::SimdFloat4 min = current->cols[3];
-  math::SimdFloat4 max = current->cols[3];
-  ++current;
-  while (current < _matrices.end) {
-    min = math::Min(min, current->cols[3]);
-    max = math::Max(max, current->cols[3]);
-    ++current;
-  }
-
-  // Stores in math::Box structure.
-  math::Store3PtrU(min, &_bound->min.x);
-  math::Store3PtrU(max, &_bound->max.x);
-
-  return;
+  *_bound = math::ComputeBounds(_matrices);
 }
 
 void MultiplySoATransformQuaternion(
@@ -26,7 +26,8 @@
 //----------------------------------------------------------------------------//
 
 #include "ozz/animation/runtime/animation.h"
-#include "ozz/animation/runtime/ik_aim_job.h"
+#include "ozz/animation/runtime/correction_job.h"
+#include "ozz/animation/runtime/ik_aim_chain_job.h"
 #include "ozz/animation/runtime/local_to_model_job.h"
 #include "ozz/animation/runtime/sampling_job.h"
 #include "ozz/animation/runtime/skeleton.h"
@@ -126,85 +127,62 @@ class LookAtSampleApplication : public ozz::sample::Application {
       return true;
     }
 
-    // IK aim job setup.
-    ozz::animation::IKAimJob ik_job;
+    // Early out if chain is empty.
+    if (chain_length_ == 0) {
+      return true;
+    }
+
+    // IK aim chain job setup.
+    ozz::animation::IKAimChainJob ik_job;
 
     // Pole vector and target position are constant for the whole algorithm, in
     // model-space.
     ik_job.pole_vector = ozz::math::simd_float4::y_axis();
     ik_job.target = ozz::math::simd_float4::Load3PtrU(&target_.x);
 
-    // The same quaternion will be used each time the job is run.
-    ozz::math::SimdQuaternion correction;
-    ik_job.joint_correction = &correction;
-
-    // The algorithm iteratively updates from the first joint (closer to the
-    // head) to the last (the further ancestor, closer to the pelvis). Joints
-    // order is already validated. For the first joint, aim IK is applied with
-    // the global forward and offset, so the forward vector aligns in direction
-    // of the target. If a weight lower that 1 is provided to the first joint,
-    // then it will not fully align to the target. In this case further joint
-    // will need to be updated. For the remaining joints, forward vector and
-    // offset position are computed in each joint local-space, before IK is
-    // applied:
-    // 1. Rotates forward and offset position based on the result of the
-    // previous joint IK.
-    // 2. Brings forward and offset back in joint local-space.
-    // Aim is iteratively applied up to the last selected joint of the
-    // hierarchy. A weight of 1 is given to the last joint so we can guarantee
-    // target is reached. Note that model-space transform of each joint doesn't
-    // need to be updated between each pass, as joints are ordered from child to
-    // parent.
-    int previous_joint = ozz::animation::Skeleton::kNoParent;
-    for (int i = 0, joint = joints_chain_[0]; i < chain_length_;
-         ++i, previous_joint = joint, joint = joints_chain_[i]) {
-      // Setups the model-space matrix of the joint being processed by IK.
-      ik_job.joint = &models_[joint];
-
-      // Setups joint local-space up vector.
-      ik_job.up = kJointUpVectors[i];
-
-      // Setups weights of IK job.
-      // the last joint being processed needs a full weight (1.f) to ensure
-      // target is reached.
+    // Global forward and offset are expressed in the first joint local-space
+    // (the head), so the forward vector aligns in direction of the target.
+    ik_job.offset = ozz::math::simd_float4::Load3PtrU(&eyes_offset_.x);
+    ik_job.forward = kHeadForward;
+
+    // The job iteratively updates from the first joint (closer to the head) to
+    // the last (the further ancestor, closer to the pelvis). Joints order is
+    // already validated. If a weight lower that 1 is provided to the first
+    // joint, then it will not fully align to the target. In this case further
+    // joints complete the rotation. A weight of 1 is given to the last joint
+    // so we can guarantee target is reached.
+    const ozz::math::Float4x4* joints[kMaxChainLength];
+    float weights[kMaxChainLength];
+    for (int i = 0; i < chain_length_; ++i) {
+      joints[i] = &models_[joints_chain_[i]];
       const bool last = i == chain_length_ - 1;
-      ik_job.weight = chain_weight_ * (last ? 1.f : joint_weight_);
-
-      // Setup offset and forward vector for the current joint being processed.
-      if (i == 0) {
-        // First joint, uses global forward and offset.
-        ik_job.offset = ozz::math::simd_float4::Load3PtrU(&eyes_offset_.x);
-        ik_job.forward = kHeadForward;
-      } else {
-        // Applies previous correction to "forward" and "offset", before
-        // bringing them to model-space (_ms).
-        const ozz::math::SimdFloat4 corrected_forward_ms =
-            TransformVector(models_[previous_joint],
-                            TransformVector(correction, ik_job.forward));
-        const ozz::math::SimdFloat4 corrected_offset_ms =
-            TransformPoint(models_[previous_joint],
-                           TransformVector(correction, ik_job.offset));
-
-        // Brings "forward" and "offset" to joint local-space
-        const ozz::math::Float4x4 inv_joint = Invert(models_[joint]);
-        ik_job.forward = TransformVector(inv_joint, corrected_forward_ms);
-        ik_job.offset = TransformPoint(inv_joint, corrected_offset_ms);
-      }
-
-      // Runs IK aim job.
-      if (!ik_job.Run()) {
-        return false;
-      }
+      weights[i] = chain_weight_ * (last ? 1.f : joint_weight_);
+    }
+    ik_job.joints = ozz::Range<const ozz::math::Float4x4* const>(
+        joints, chain_length_);
+    ik_job.ups = ozz::Range<const ozz::math::SimdFloat4>(kJointUpVectors,
+                                                         chain_length_);
+    ik_job.weights = ozz::Range<const float>(weights, chain_length_);
+    ozz::math::SimdQuaternion corrections[kMaxChainLength];
+    ik_job.joint_corrections =
+        ozz::Range<ozz::math::SimdQuaternion>(corrections, chain_length_);
+    if (!ik_job.Run()) {
+      return false;
+    }
 
-      // Apply IK quaternion to its respective local-space transforms.
-      ozz::sample::MultiplySoATransformQuaternion(joint, correction,
-                                                  make_range(locals_));
+    // Apply IK quaternions to their respective local-space transforms.
+    ozz::animation::CorrectionJob correction_job;
+    correction_job.joints = ozz::Range<const int>(joints_chain_, chain_length_);
+    correction_job.corrections = ik_job.joint_corrections;
+    correction_job.output = make_range(locals_);
+    if (!correction_job.Run()) {
+      return false;
     }
 
     // Skeleton model-space matrices need to be updated again. This re-uses the
     // already setup job, but limits the update to childs of the last joint (the
     // parent-iest of the chain).
-    ltm_job.from = previous_joint;
+    ltm_job.from = joints_chain_[chain_length_ - 1];
     if (!ltm_job.Run()) {
       return false;
     }
@@ -31,6 +31,7 @@
 #include <cstring>
 
 #include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/animation_instance.h"
 #include "ozz/animation/runtime/local_to_model_job.h"
 #include "ozz/animation/runtime/sampling_job.h"
 #include "ozz/animation/runtime/skeleton.h"
@@ -40,13 +41,18 @@
 #include "ozz/animation/offline/raw_skeleton.h"
 #include "ozz/animation/offline/skeleton_builder.h"
 
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/maths/box.h"
 #include "ozz/base/maths/quaternion.h"
 #include "ozz/base/maths/simd_math.h"
 #include "ozz/base/maths/soa_transform.h"
 #include "ozz/base/maths/vec_float.h"
 
+#include "ozz/options/options.h"
+
 #include "framework/application.h"
 #include "framework/imgui.h"
+#include "framework/profile.h"
 #include "framework/renderer.h"
 #include "framework/utils.h"
 
@@ -114,38 +120,102 @@ const RawAnimation::TranslationKey kPrecomputedKeys[] = {
     {.98f * kDuration, Float3(.17f * kWalkCycleLength, .3f, 0.f)}};
 const int kPrecomputedKeyCount = OZZ_ARRAY_SIZE(kPrecomputedKeys);
 
+// Maximum number of millipede instances, and distance between them.
+const int kMaxInstances = 64;
+const float kInstanceSpacing = 6.f;
+
+// Checks joints argument is within 8 - Skeleton::kMaxJoints.
+static bool JointsCheck(const ozz::options::Option& _option, int /*_argc*/) {
+  const ozz::options::IntOption& option =
+      static_cast<const ozz::options::IntOption&>(_option);
+  return option >= 8 && option <= ozz::animation::Skeleton::kMaxJoints;
+}
+
+OZZ_OPTIONS_DECLARE_INT_FN(joints,
+                           "Initial number of joints of the millipede "
+                           "skeleton (8 to Skeleton::kMaxJoints).",
+                           183, false, &JointsCheck)
+
+// Checks instances argument is within 1 - kMaxInstances.
+static bool InstancesCheck(const ozz::options::Option& _option,
+                           int /*_argc*/) {
+  const ozz::options::IntOption& option =
+      static_cast<const ozz::options::IntOption&>(_option);
+  return option >= 1 && option <= kMaxInstances;
+}
+
+OZZ_OPTIONS_DECLARE_INT_FN(instances,
+                           "Initial number of millipede instances (1 to 64).",
+                           1, false, &InstancesCheck)
+
 class MillipedeSampleApplication : public ozz::sample::Application {
  public:
   MillipedeSampleApplication()
-      : slice_count_(26), skeleton_(NULL), animation_(NULL) {}
+      : slice_count_((OPTIONS_joints - 1) / 7),
+        num_instances_(OPTIONS_instances),
+        skeleton_(NULL),
+        animation_(NULL),
+        sampling_time_(64),
+        ltm_time_(64) {}
 
  protected:
   virtual bool OnUpdate(float _dt, float) {
     // Updates current animation time
     controller_.Update(*animation_, _dt);
 
-    // Samples animation at t = animation_time_.
-    ozz::animation::SamplingJob sampling_job;
-    sampling_job.animation = animation_;
-    sampling_job.cache = &cache_;
-    sampling_job.ratio = controller_.time_ratio();
-    sampling_job.output = make_range(locals_);
-    if (!sampling_job.Run()) {
-      return false;
+    // Samples animation of all instances. Instances are dephased so their
+    // caches don't all seek the same keys. Each job phase is profiled
+    // independently.
+    {
+      ozz::sample::Profiler profile(&sampling_time_);
+      for (int i = 0; i < num_instances_; ++i) {
+        ozz::animation::AnimationInstance* instance = instances_[i];
+        ozz::animation::SamplingJob sampling_job;
+        sampling_job.animation = animation_;
+        sampling_job.cache = instance->cache();
+        sampling_job.ratio = std::fmod(
+            controller_.time_ratio() + static_cast<float>(i) / num_instances_,
+            1.f);
+        sampling_job.output = instance->locals();
+        if (!sampling_job.Run()) {
+          return false;
+        }
+      }
     }
 
     // Converts from local space to model space matrices.
-    ozz::animation::LocalToModelJob ltm_job;
-    ltm_job.skeleton = skeleton_;
-    ltm_job.input = make_range(locals_);
-    ltm_job.output = make_range(models_);
-    return ltm_job.Run();
+    {
+      ozz::sample::Profiler profile(&ltm_time_);
+      for (int i = 0; i < num_instances_; ++i) {
+        ozz::animation::AnimationInstance* instance = instances_[i];
+        ozz::animation::LocalToModelJob ltm_job;
+        ltm_job.skeleton = skeleton_;
+        ltm_job.input = instance->locals();
+        ltm_job.output = instance->models();
+        if (!ltm_job.Run()) {
+          return false;
+        }
+      }
+    }
+    return true;
   }
 
   virtual bool OnDisplay(ozz::sample::Renderer* _renderer) {
-    // Renders the animated posture.
-    return _renderer->DrawPosture(*skeleton_, make_range(models_),
-                                  ozz::math::Float4x4::identity());
+    // Renders the animated postures, side by side.
+    bool success = true;
+    for (int i = 0; success && i < num_instances_; ++i) {
+      success &= _renderer->DrawPosture(*skeleton_, instances_[i]->models(),
+                                        GetInstanceTransform(i));
+    }
+    return success;
+  }
+
+  // Computes instance _i rendering transform, instances being centered
+  // around the origin.
+  ozz::math::Float4x4 GetInstanceTransform(int _i) const {
+    const float x = (_i - (num_instances_ - 1) * .5f) * kInstanceSpacing;
+    return ozz::math::Float4x4::Translation(
+        ozz::math::simd_float4::Load(x, 0.f, 0.f, 0.f));
   }
 
   virtual bool OnInitialize() { return Build(); }
@@ -173,19 +243,55 @@ class MillipedeSampleApplication : public ozz::sample::Application {
       }
     }
 
+    // Reallocates instances if their number has changed.
+    int num_instances = num_instances_;
+    std::sprintf(label, "Instances count: %d", num_instances);
+    if (_im_gui->DoSlider(label, 1, kMaxInstances, &num_instances, .5f,
+                          true) &&
+        num_instances != num_instances_) {
+      num_instances_ = num_instances;
+      if (!AllocateInstances()) {
+        return false;
+      }
+    }
+
+    // Exposes jobs costs, total and per joint.
+    {
+      static bool oc_open = true;
+      ozz::sample::ImGui::OpenClose oc(_im_gui, "Jobs profiling", &oc_open);
+      if (oc_open) {
+        const float num_total_joints =
+            static_cast<float>(skeleton_->num_joints() * num_instances_);
+        DoProfileGui(_im_gui, "Sampling", &sampling_time_, num_total_joints);
+        DoProfileGui(_im_gui, "Local-to-model", &ltm_time_, num_total_joints);
+      }
+    }
+
     // Updates controller Gui.
     controller_.OnGui(*animation_, _im_gui);
 
     return true;
   }
 
+  // Displays _record mean time graph, and its mean cost per joint.
+  static void DoProfileGui(ozz::sample::ImGui* _im_gui, const char* _name,
+                           ozz::sample::Record* _record, float _num_joints) {
+    const ozz::sample::Record::Statistics stats = _record->GetStatistics();
+    char label[64];
+    std::sprintf(label, "%s: %.3f ms", _name, stats.mean);
+    _im_gui->DoGraph(label, 0.f, stats.max, stats.latest, _record->cursor(),
+                     _record->record_begin(), _record->record_end());
+    std::sprintf(label, "%s: %.1f ns/joint", _name,
+                 stats.mean * 1e6f / _num_joints);
+    _im_gui->DoLabel(label);
+  }
+
   // Procedurally builds millipede skeleton and walk animation
   bool Build() {
     // Initializes the root. The root pointer will change from a spine to the
     // next for each slice.
     RawSkeleton raw_skeleton;
     CreateSkeleton(&raw_skeleton);
-    const int num_joints = raw_skeleton.num_joints();
 
     // Build the run time skeleton.
     ozz::animation::offline::SkeletonBuilder skeleton_builder;
@@ -205,18 +311,35 @@ class MillipedeSampleApplication : public ozz::sample::Application {
       return false;
     }
 
-    // Allocates runtime buffers.
-    const int num_soa_joints = skeleton_->num_soa_joints();
-    locals_.resize(num_soa_joints);
-    models_.resize(num_joints);
-
-    // Allocates a cache that matches new animation requirements.
-    cache_.Resize(num_joints);
+    // Allocates runtime buffers and caches of all instances.
+    return AllocateInstances();
+  }
 
+  // Reallocates num_instances_ instances, each with its own cache, local and
+  // model space buffers, in a single memory block.
+  bool AllocateInstances() {
+    DeleteInstances();
+    const ozz::animation::Animation* animations[] = {animation_};
+    instances_.resize(num_instances_);
+    for (int i = 0; i < num_instances_; ++i) {
+      instances_[i] =
+          ozz::animation::AnimationInstance::New(*skeleton_, animations);
+      if (!instances_[i]) {
+        return false;
+      }
+    }
     return true;
   }
 
+  void DeleteInstances() {
+    for (size_t i = 0; i < instances_.size(); ++i) {
+      ozz::animation::AnimationInstance::Delete(instances_[i]);
+    }
+    instances_.clear();
+  }
+
   void Destroy() {
+    DeleteInstances();
     ozz::memory::Allocator* allocator = ozz::memory::default_allocator();
     allocator->Delete(skeleton_);
     allocator->Delete(animation_);
@@ -413,7 +536,11 @@ class MillipedeSampleApplication : public ozz::sample::Application {
   }
 
   virtual void GetSceneBounds(ozz::math::Box* _bound) const {
-    ozz::sample::ComputePostureBounds(make_range(models_), _bound);
+    // Extends first instance bounds to the last one.
+    ozz::sample::ComputePostureBounds(instances_[0]->models(), _bound);
+    const float extent = (num_instances_ - 1) * .5f * kInstanceSpacing;
+    _bound->min.x -= extent;
+    _bound->max.x += extent;
   }
 
  private:
@@ -424,21 +551,23 @@ class MillipedeSampleApplication : public ozz::sample::Application {
   // Millipede skeleton number of slices. 7 joints per slice.
   int slice_count_;
 
+  // Number of millipede instances.
+  int num_instances_;
+
   // The millipede skeleton.
   ozz::animation::Skeleton* skeleton_;
 
   // The millipede procedural walk animation.
   ozz::animation::Animation* animation_;
 
-  // Sampling cache, as used by SamplingJob.
-  ozz::animation::SamplingCache cache_;
-
-  // Buffer of local transforms as sampled from animation_.
-  // These are shared between sampling output and local-to-model input.
-  ozz::Vector<ozz::math::SoaTransform>::Std locals_;
+  // Millipede instances, each owning its sampling cache, local transforms
+  // (sampling output and local-to-model input) and model matrices
+  // (local-to-model output).
+  ozz::Vector<ozz::animation::AnimationInstance*>::Std instances_;
 
-  // Buffer of model matrices (local-to-model output).
-  ozz::Vector<ozz::math::Float4x4>::Std models_;
+  // Sampling and local-to-model jobs time records, for all instances.
+  ozz::sample::Record sampling_time_;
+  ozz::sample::Record ltm_time_;
 };
 
 int main(int _argc, const char** _argv) {
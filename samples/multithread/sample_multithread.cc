@@ -27,15 +27,23 @@
 
 #include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <cstdlib>
+#include <fstream>
 #include <future>
+#include <thread>
+#include <vector>
 
 #include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/animation_instance.h"
 #include "ozz/animation/runtime/local_to_model_job.h"
 #include "ozz/animation/runtime/sampling_job.h"
 #include "ozz/animation/runtime/skeleton.h"
 
 #include "ozz/base/log.h"
+#include "ozz/base/profile.h"
+#include "ozz/base/task_scheduler.h"
+#include "ozz/base/thread_pool.h"
 
 #include "ozz/base/containers/vector.h"
 
@@ -48,8 +56,11 @@
 #include "ozz/options/options.h"
 
 #include "framework/application.h"
+#include "framework/async_loader.h"
 #include "framework/imgui.h"
+#include "framework/mesh.h"
 #include "framework/renderer.h"
+#include "framework/trace.h"
 #include "framework/utils.h"
 
 #if EMSCRIPTEN
@@ -67,6 +78,55 @@ OZZ_OPTIONS_DECLARE_STRING(animation,
                            "Path to the first animation (ozz archive format).",
                            "media/animation.ozz", false)
 
+// Mesh archive can be specified as an option.
+OZZ_OPTIONS_DECLARE_STRING(mesh,
+                           "Path to the skinned mesh (ozz archive format).",
+                           "media/mesh.ozz", false)
+
+// Rendering mode can be specified as an option.
+OZZ_OPTIONS_DECLARE_BOOL(
+    render_meshes,
+    "Renders characters skinned meshes instead of their skeletons.", false,
+    false)
+
+// Benchmark mode options.
+OZZ_OPTIONS_DECLARE_BOOL(
+    benchmark,
+    "Runs a headless scalability benchmark instead of the interactive sample, "
+    "sweeping characters, threads and grain sizes, and exits.",
+    false, false)
+
+OZZ_OPTIONS_DECLARE_STRING(
+    characters, "Comma separated numbers of characters benchmarked.",
+    "1000,10000,100000", false)
+
+OZZ_OPTIONS_DECLARE_STRING(
+    threads,
+    "Comma separated numbers of threads benchmarked. Defaults to powers of "
+    "two up to hardware concurrency.",
+    "", false)
+
+OZZ_OPTIONS_DECLARE_STRING(grain_sizes,
+                           "Comma separated grain sizes benchmarked.",
+                           "32,128,512", false)
+
+OZZ_OPTIONS_DECLARE_INT(frames,
+                        "Number of updates measured per benchmark setting.",
+                        60, false)
+
+OZZ_OPTIONS_DECLARE_STRING(
+    csv,
+    "Optional path to the benchmark csv results file. Results are written to "
+    "the standard output otherwise.",
+    "", false)
+
+OZZ_OPTIONS_DECLARE_STRING(
+    trace,
+    "Optional path to a Chrome trace event json file (see chrome://tracing or "
+    "ui.perfetto.dev), recording the update of every frame and task of every "
+    "thread. Jobs zones are also recorded if ozz_build_profile is enabled.",
+    "", false)
+
 // Interval between each character.
 const float kInterval = 2.f;
 
@@ -89,13 +149,66 @@ bool HasThreadingSupport() {
 #endif  // EMSCRIPTEN
 }
 
+// Parses _list, a comma separated list of strictly positive integers, to
+// _values. Returns false if _list is empty or a value is invalid.
+bool ParseList(const char* _list, std::vector<int>* _values) {
+  _values->clear();
+  for (const char* it = _list; *it != 0;) {
+    char* end;
+    const long value = std::strtol(it, &end, 10);
+    if (end == it || value <= 0 || (*end != ',' && *end != 0)) {
+      ozz::log::Err() << "Invalid list \"" << _list << "\"." << std::endl;
+      return false;
+    }
+    _values->push_back(static_cast<int>(value));
+    it = *end == ',' ? end + 1 : end;
+  }
+  if (_values->empty()) {
+    ozz::log::Err() << "Invalid empty list." << std::endl;
+    return false;
+  }
+  return true;
+}
+
+// Implements ozz task scheduler interface with std::async. Task range is split
+// recursively in halves, one half being run by an async task, possibly on
+// another thread, and the other half by the calling thread. Async tasks are
+// created (and possibly threads) on every call, which ozz::ThreadPool avoids.
+// An application would rather forward tasks to its own job system.
+class AsyncScheduler : public ozz::TaskScheduler {
+ public:
+  virtual void ParallelFor(Task _task, void* _context, int _count) {
+    Run(_task, _context, 0, _count);
+  }
+
+ private:
+  static void Run(Task _task, void* _context, int _begin, int _end) {
+    if (_end - _begin == 1) {
+      _task(_context, _begin);
+    } else {
+      // Run half the tasks on an async task, possibly another thread.
+      const int half = (_begin + _end) / 2;
+      auto handle =
+          std::async(std::launch::async, Run, _task, _context, half, _end);
+
+      // The other half is processed by this thread.
+      Run(_task, _context, _begin, half);
+
+      // Waits for the async task, or process it if it's not started yet.
+      handle.get();
+    }
+  }
+};
+
 class MultithreadSampleApplication : public ozz::sample::Application {
  public:
   MultithreadSampleApplication()
       : characters_(kMaxCharacters),
         num_characters_(kMaxCharacters / 4),
+        render_meshes_(OPTIONS_render_meshes),
         has_threading_support_(HasThreadingSupport()),
         enable_theading_(has_threading_support_),
+        scheduler_type_(kThreadPool),
         grain_size_(128) {
     if (has_threading_support_) {
       ozz::log::Out() << "Platform has threading support." << std::endl;
@@ -105,47 +218,57 @@ class MultithreadSampleApplication : public ozz::sample::Application {
     }
   }
 
+  // Runs the headless scalability benchmark. Every combination of characters,
+  // threads and grain sizes is updated during OPTIONS_frames frames, timing
+  // sampling and local-to-model phases separately. Parallel efficiency is
+  // computed against a sequential update of the same characters.
+  static int Benchmark();
+
  private:
   // Nested Character struct forward declaration.
   struct Character;
 
-  static bool UpdateCharacter(const ozz::animation::Animation& _animation,
-                              const ozz::animation::Skeleton& _skeleton,
-                              float _dt, Character* _character) {
-    // Samples animation.
+  // Updates _character playback and samples its animation.
+  static bool SampleCharacter(const ozz::animation::Animation& _animation,
+                              const ozz::animation::Skeleton&, float _dt,
+                              Character* _character) {
+    // Updates playback time.
     _character->controller.Update(_animation, _dt);
 
     // Setup sampling job.
     ozz::animation::SamplingJob sampling_job;
     sampling_job.animation = &_animation;
-    sampling_job.cache = &_character->cache;
+    sampling_job.cache = _character->instance->cache();
     sampling_job.ratio = _character->controller.time_ratio();
-    sampling_job.output = make_range(_character->locals);
+    sampling_job.output = _character->instance->locals();
 
     // Samples animation.
-    if (!sampling_job.Run()) {
-      return false;
-    }
+    return sampling_job.Run();
+  }
 
-    // Converts from local space to model space matrices.
+  // Converts _character from local space to model space matrices.
+  static bool ConvertCharacter(const ozz::animation::Animation&,
+                               const ozz::animation::Skeleton& _skeleton,
+                               float, Character* _character) {
     ozz::animation::LocalToModelJob ltm_job;
     ltm_job.skeleton = &_skeleton;
-    ltm_job.input = make_range(_character->locals);
-    ltm_job.output = make_range(_character->models);
-    if (!ltm_job.Run()) {
-      return false;
-    }
-    return true;
+    ltm_job.input = _character->instance->locals();
+    ltm_job.output = _character->instance->models();
+    return ltm_job.Run();
   }
 
-  // Data structure used to pass const arguments to parallel tasks.
-  struct ParallelArgs {
-    const ozz::animation::Animation* animation;
-    const ozz::animation::Skeleton* skeleton;
-    float dt;
-    int grain_size;  // Maximum number of characters that can be processed by a
-                     // task.
-  };
+  // Runs all update phases of _character.
+  static bool UpdateCharacter(const ozz::animation::Animation& _animation,
+                              const ozz::animation::Skeleton& _skeleton,
+                              float _dt, Character* _character) {
+    return SampleCharacter(_animation, _skeleton, _dt, _character) &&
+           ConvertCharacter(_animation, _skeleton, _dt, _character);
+  }
+
+  // Signature of a character update phase.
+  typedef bool (*UpdatePhase)(const ozz::animation::Animation& _animation,
+                              const ozz::animation::Skeleton& _skeleton,
+                              float _dt, Character* _character);
 
   // Data used to monitor and analyze threading.
   // Every task will push its thread id to an array. We can then process it to
@@ -154,95 +277,160 @@ class MultithreadSampleApplication : public ozz::sample::Application {
     ParallelMonitor() {
       // Finds the maximum possible number of tasks considering kMinGrain grain
       // size for kMaxCharacters characters.
-      int max_tasks = 1;
-      for (int processed = kMinGrainSize; processed < kMaxCharacters;
-           processed *= 2, max_tasks *= 2) {
-      }
-      thread_ids_.resize(max_tasks);
+      thread_ids_.resize((kMaxCharacters + kMinGrainSize - 1) / kMinGrainSize);
       num_async_tasks.store(0);
     }
     ozz::Vector<std::thread::id>::Std thread_ids_;
     std::atomic_uint num_async_tasks;
   };
 
-  static bool ParallelUpdate(const ParallelArgs& _args, Character* _characters,
-                             int _num, ParallelMonitor* _monitor) {
-    bool success = true;
-    if (_num <= _args.grain_size) {
-      // Stores this thread identifier to a new task slot.
-      _monitor->thread_ids_[_monitor->num_async_tasks++] =
-          std::this_thread::get_id();
-
-      for (int i = 0; i < _num; ++i) {
-        success &= UpdateCharacter(*_args.animation, *_args.skeleton, _args.dt,
-                                   &_characters[i]);
-      }
-    } else {
-      // Run half the job on an async task, possibly another thread.
-      const int half = _num / 2;
-      auto handle = std::async(std::launch::async, ParallelUpdate, _args,
-                               _characters + half, _num - half, _monitor);
+  // Data structure used to pass arguments to parallel tasks.
+  struct ParallelArgs {
+    UpdatePhase update;
+    const ozz::animation::Animation* animation;
+    const ozz::animation::Skeleton* skeleton;
+    float dt;
+    Character* characters;
+    int num_characters;
+    int grain_size;  // Maximum number of characters that can be processed by a
+                     // task.
+    ParallelMonitor* monitor;
+    std::atomic_bool success;
+  };
 
-      // The other half is processed by this thread.
-      success &= ParallelUpdate(_args, _characters, half, _monitor);
+  // Task run by the scheduler, updating _index group of characters.
+  static void ParallelUpdate(void* _context, int _index) {
+    ParallelArgs& args = *static_cast<ParallelArgs*>(_context);
+    const ozz::profile::Zone zone("ParallelUpdate");
 
-      // Get result of the async task or process it if it's not started yet.
-      success &= handle.get();
+    // Stores this thread identifier to a new task slot.
+    args.monitor->thread_ids_[args.monitor->num_async_tasks++] =
+        std::this_thread::get_id();
+
+    const int begin = _index * args.grain_size;
+    const int end = std::min(begin + args.grain_size, args.num_characters);
+    bool success = true;
+    for (int i = begin; i < end; ++i) {
+      success &= args.update(*args.animation, *args.skeleton, args.dt,
+                             &args.characters[i]);
+    }
+    if (!success) {
+      args.success.store(false);
     }
-    return success;
   }
 
+  // Times _frames frames of _phase on _characters, dispatched to _scheduler
+  // (possibly NULL) by _grain_size characters tasks. Returns the mean
+  // duration of a frame, in milliseconds, or a negative value on failure.
+  static double TimePhase(UpdatePhase _phase, ozz::TaskScheduler* _scheduler,
+                          const ozz::animation::Animation& _animation,
+                          const ozz::animation::Skeleton& _skeleton,
+                          ozz::Range<Character> _characters, int _grain_size,
+                          int _frames);
+
   // Updates current animation time.
   virtual bool OnUpdate(float _dt, float) {
-    bool success = true;
+    const ozz::profile::Zone zone("Update");
+
+    // Initialize task counter. It's only used to monitor threading behavior.
+    monitor_.num_async_tasks.store(0);
+
+    ParallelArgs args;
+    args.update = &UpdateCharacter;
+    args.animation = &animation_;
+    args.skeleton = &skeleton_;
+    args.dt = _dt;
+    args.characters = array_begin(characters_);
+    args.num_characters = num_characters_;
+    args.grain_size = grain_size_;
+    args.monitor = &monitor_;
+    args.success.store(true);
+
+    // Tasks are run sequentially by the calling thread if no scheduler is
+    // provided.
+    const int num_tasks = (num_characters_ + grain_size_ - 1) / grain_size_;
+    ozz::TaskScheduler* scheduler = NULL;
     if (enable_theading_) {
-      // Initialize task counter. It's only used to monitor threading behavior.
-      monitor_.num_async_tasks.store(0);
-
-      const ParallelArgs args = {&animation_, &skeleton_, _dt, grain_size_};
-      success = ParallelUpdate(args, array_begin(characters_), num_characters_,
-                               &monitor_);
-    } else {
-      for (int i = 0; i < num_characters_; ++i) {
-        success &= UpdateCharacter(animation_, skeleton_, _dt,
-                                   array_begin(characters_) + i);
+      if (scheduler_type_ == kThreadPool) {
+        scheduler = &thread_pool_;
+      } else {
+        scheduler = &async_scheduler_;
       }
     }
-    return success;
+    ozz::ParallelFor(scheduler, &ParallelUpdate, &args, num_tasks);
+    return args.success.load();
   }
 
-  // Renders all skeletons.
+  // Renders all skeletons, or all skinned meshes.
   virtual bool OnDisplay(ozz::sample::Renderer* _renderer) {
-    bool success = true;
-    for (int c = 0; success && c < num_characters_; ++c) {
+    for (int c = 0; c < num_characters_; ++c) {
       const ozz::math::Float4 position(
           ((c % kWidth) - kWidth / 2) * kInterval,
           ((c / kWidth) / kDepth) * kInterval,
           (((c / kWidth) % kDepth) - kDepth / 2) * kInterval, 1.f);
-      const ozz::math::Float4x4 transform = ozz::math::Float4x4::Translation(
+      transforms_[c] = ozz::math::Float4x4::Translation(
           ozz::math::simd_float4::LoadPtrU(&position.x));
-      success &= _renderer->DrawPosture(
-          skeleton_, make_range(characters_[c].models), transform, false);
     }
 
-    return true;
+    if (!render_meshes_) {
+      bool success = true;
+      for (int c = 0; success && c < num_characters_; ++c) {
+        success &= _renderer->DrawPosture(
+            skeleton_, characters_[c].instance->models(), transforms_[c],
+            false);
+      }
+      return true;
+    }
+
+    // Builds all characters skinning matrices palettes in a single buffer, so
+    // they can be rendered with a single call. The mesh might not use all
+    // skeleton joints, so the joint remapping table is used to reorder model
+    // space matrices.
+    const size_t num_palette_joints = mesh_.joint_remaps.size();
+    for (int c = 0; c < num_characters_; ++c) {
+      const ozz::Range<ozz::math::Float4x4> models =
+          characters_[c].instance->models();
+      ozz::math::Float4x4* palette =
+          &skinning_matrices_[c * num_palette_joints];
+      for (size_t i = 0; i < num_palette_joints; ++i) {
+        palette[i] =
+            models[mesh_.joint_remaps[i]] * mesh_.inverse_bind_poses[i];
+      }
+    }
+    return _renderer->DrawSkinnedMeshes(
+        mesh_,
+        ozz::Range<ozz::math::Float4x4>(array_begin(skinning_matrices_),
+                                        num_characters_ * num_palette_joints),
+        ozz::Range<const ozz::math::Float4x4>(array_begin(transforms_),
+                                              num_characters_));
   }
 
   virtual bool OnInitialize() {
-    // Reading skeleton.
-    if (!ozz::sample::LoadSkeleton(OPTIONS_skeleton, &skeleton_)) {
+    if (OPTIONS_trace.value()[0] != 0) {
+      trace_.Start();
+    }
+
+    // Reads skeleton and animation in parallel.
+    ozz::sample::AsyncLoader loader;
+    std::future<bool> skeleton = loader.Load(OPTIONS_skeleton, &skeleton_);
+    std::future<bool> animation = loader.Load(OPTIONS_animation, &animation_);
+    std::future<bool> mesh = loader.Load(OPTIONS_mesh, &mesh_);
+    if (!skeleton.get() || !animation.get() || !mesh.get()) {
       return false;
     }
 
-    // Reading animations.
-    if (!ozz::sample::LoadAnimation(OPTIONS_animation, &animation_)) {
+    // The number of joints of the mesh needs to match skeleton.
+    if (skeleton_.num_joints() < mesh_.highest_joint_index()) {
+      ozz::log::Err() << "The provided mesh doesn't match skeleton "
+                         "(joint count mismatch)."
+                      << std::endl;
       return false;
     }
+    skinning_matrices_.resize(kMaxCharacters * mesh_.joint_remaps.size());
+    transforms_.resize(kMaxCharacters);
 
     // Allocate a default number of characters.
-    AllocateCharaters();
-
-    return true;
+    return AllocateCharaters();
   }
 
   bool AllocateCharaters() {
@@ -254,15 +442,30 @@ class MultithreadSampleApplication : public ozz::sample::Application {
       character.controller.set_time_ratio(animation_.duration() * kWidth * c /
                                           kMaxCharacters);
 
-      character.locals.resize(skeleton_.num_soa_joints());
-      character.models.resize(skeleton_.num_joints());
-      character.cache.Resize(animation_.num_tracks());
+      // Allocates all character runtime data in a single memory block.
+      ozz::animation::AnimationInstance::Delete(character.instance);
+      const ozz::animation::Animation* animations[] = {&animation_};
+      character.instance = ozz::animation::AnimationInstance::New(
+          skeleton_, animations);
+      if (!character.instance) {
+        return false;
+      }
     }
 
     return true;
   }
 
-  virtual void OnDestroy() {}
+  virtual void OnDestroy() {
+    for (size_t c = 0; c < kMaxCharacters; ++c) {
+      ozz::animation::AnimationInstance::Delete(characters_[c].instance);
+      characters_[c].instance = NULL;
+    }
+
+    if (trace_.recording()) {
+      trace_.Stop();
+      trace_.Export(OPTIONS_trace);
+    }
+  }
 
   virtual bool OnGui(ozz::sample::ImGui* _im_gui) {
     // Exposes number of characters.
@@ -276,6 +479,17 @@ class MultithreadSampleApplication : public ozz::sample::Application {
         const int num_joints = num_characters_ * skeleton_.num_joints();
         std::sprintf(label, "Number of joints: %d", num_joints);
         _im_gui->DoLabel(label);
+
+        // Skinning matrices palettes are uploaded to the GPU every frame.
+        _im_gui->DoCheckBox("Render meshes", &render_meshes_);
+        if (render_meshes_) {
+          const size_t palette_size = num_characters_ *
+                                      mesh_.joint_remaps.size() *
+                                      sizeof(ozz::math::Float4x4);
+          std::sprintf(label, "Palettes upload: %.1f KB/frame",
+                       palette_size / 1024.f);
+          _im_gui->DoLabel(label);
+        }
       }
     }
     // Exposes multi-threading parameters.
@@ -286,7 +500,17 @@ class MultithreadSampleApplication : public ozz::sample::Application {
         _im_gui->DoCheckBox("Enables threading", &enable_theading_,
                             has_threading_support_);
         if (enable_theading_) {
+          _im_gui->DoRadioButton(kThreadPool, "Thread pool", &scheduler_type_);
+          _im_gui->DoRadioButton(kAsync, "std::async", &scheduler_type_);
+
           char label[64];
+          if (scheduler_type_ == kThreadPool) {
+            std::sprintf(label, "Pool threads/steals: %d/%d",
+                         thread_pool_.num_threads(),
+                         thread_pool_.num_steals());
+            _im_gui->DoLabel(label);
+          }
+
           std::sprintf(label, "Grain size: %d", grain_size_);
           _im_gui->DoSlider(label, kMinGrainSize, kMaxCharacters, &grain_size_,
                             .2f);
@@ -327,22 +551,27 @@ class MultithreadSampleApplication : public ozz::sample::Application {
   // Runtime animation.
   ozz::animation::Animation animation_;
 
+  // The mesh rendered for every character.
+  ozz::sample::Mesh mesh_;
+
+  // Skinning matrices palettes of all characters, contiguously.
+  ozz::Vector<ozz::math::Float4x4>::Std skinning_matrices_;
+
+  // Rendering transforms of all characters.
+  ozz::Vector<ozz::math::Float4x4>::Std transforms_;
+
   // Character structure contains all the data required to sample and blend a
   // character.
   struct Character {
+    Character() : instance(NULL) {}
+
     // Playback animation controller. This is a utility class that helps with
     // controlling animation playback time.
     ozz::sample::PlaybackController controller;
 
-    // Sampling cache.
-    ozz::animation::SamplingCache cache;
-
-    // Buffer of local transforms which stores the blending result.
-    ozz::Vector<ozz::math::SoaTransform>::Std locals;
-
-    // Buffer of model space matrices. These are computed by the local-to-model
-    // job after the blending stage.
-    ozz::Vector<ozz::math::Float4x4>::Std models;
+    // Sampling cache, local transforms and model space matrices, all laid out
+    // in a single memory block.
+    ozz::animation::AnimationInstance* instance;
   };
 
   // Array of characters of the sample.
@@ -351,20 +580,196 @@ class MultithreadSampleApplication : public ozz::sample::Application {
   // Number of used characters.
   int num_characters_;
 
+  // Renders skinned meshes instead of skeletons.
+  bool render_meshes_;
+
   // Does the current plateform actually has threading support.
   bool has_threading_support_;
 
   // Enable or disable threading.
   bool enable_theading_;
 
+  // Selects the scheduler used when threading is enabled.
+  enum SchedulerType {
+    kThreadPool,  // ozz::ThreadPool, with persistent worker threads.
+    kAsync,       // AsyncScheduler, creating async tasks on every update.
+  };
+  int scheduler_type_;
+
   // Define the number of characters that a task can handle.
   int grain_size_;
 
   // Data used to monitor and analyze threading.
   ParallelMonitor monitor_;
+
+  // Schedulers used to dispatch tasks when threading is enabled.
+  ozz::ThreadPool thread_pool_;
+  AsyncScheduler async_scheduler_;
+
+  // Records frames and tasks zones, when a trace file is specified.
+  ozz::sample::TraceRecorder trace_;
 };
 
+double MultithreadSampleApplication::TimePhase(
+    UpdatePhase _phase, ozz::TaskScheduler* _scheduler,
+    const ozz::animation::Animation& _animation,
+    const ozz::animation::Skeleton& _skeleton,
+    ozz::Range<Character> _characters, int _grain_size, int _frames) {
+  const int num_characters = static_cast<int>(_characters.count());
+  const int num_tasks = (num_characters + _grain_size - 1) / _grain_size;
+
+  ParallelMonitor monitor;
+  monitor.thread_ids_.resize(num_tasks);
+
+  ParallelArgs args;
+  args.update = _phase;
+  args.animation = &_animation;
+  args.skeleton = &_skeleton;
+  args.dt = 1.f / 60.f;
+  args.characters = _characters.begin;
+  args.num_characters = num_characters;
+  args.grain_size = _grain_size;
+  args.monitor = &monitor;
+  args.success.store(true);
+
+  // Runs a first frame outside of timing, to warm up caches and threads.
+  ozz::ParallelFor(_scheduler, &ParallelUpdate, &args, num_tasks);
+
+  typedef std::chrono::steady_clock Clock;
+  const Clock::time_point begin = Clock::now();
+  for (int i = 0; i < _frames; ++i) {
+    const ozz::profile::Zone zone("Frame");
+    monitor.num_async_tasks.store(0);
+    ozz::ParallelFor(_scheduler, &ParallelUpdate, &args, num_tasks);
+  }
+  const double elapsed =
+      std::chrono::duration<double, std::milli>(Clock::now() - begin).count();
+  return args.success.load() ? elapsed / _frames : -1.;
+}
+
+int MultithreadSampleApplication::Benchmark() {
+  std::vector<int> characters;
+  std::vector<int> threads;
+  std::vector<int> grain_sizes;
+  if (!ParseList(OPTIONS_characters, &characters) ||
+      !ParseList(OPTIONS_grain_sizes, &grain_sizes)) {
+    return EXIT_FAILURE;
+  }
+  if (OPTIONS_threads.value()[0] != 0) {
+    if (!ParseList(OPTIONS_threads, &threads)) {
+      return EXIT_FAILURE;
+    }
+  } else {
+    const int concurrency =
+        std::max(static_cast<int>(std::thread::hardware_concurrency()), 1);
+    for (int n = 1; n < concurrency; n *= 2) {
+      threads.push_back(n);
+    }
+    threads.push_back(concurrency);
+  }
+  if (OPTIONS_frames <= 0) {
+    ozz::log::Err() << "Invalid number of frames." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  ozz::animation::Skeleton skeleton;
+  ozz::animation::Animation animation;
+  if (!ozz::sample::LoadSkeleton(OPTIONS_skeleton, &skeleton) ||
+      !ozz::sample::LoadAnimation(OPTIONS_animation, &animation)) {
+    return EXIT_FAILURE;
+  }
+
+  // Allocates the biggest number of characters once, smaller settings use the
+  // first ones.
+  const int max_characters =
+      *std::max_element(characters.begin(), characters.end());
+  ozz::Vector<Character>::Std all_characters(max_characters);
+  bool success = true;
+  for (int c = 0; success && c < max_characters; ++c) {
+    Character& character = all_characters[c];
+    character.controller.set_time_ratio(static_cast<float>(c) /
+                                        max_characters);
+    const ozz::animation::Animation* animations[] = {&animation};
+    character.instance =
+        ozz::animation::AnimationInstance::New(skeleton, animations);
+    success = character.instance != NULL;
+  }
+
+  std::ofstream file;
+  if (success && OPTIONS_csv.value()[0] != 0) {
+    file.open(OPTIONS_csv);
+    if (!file) {
+      ozz::log::Err() << "Failed to open csv file " << OPTIONS_csv.value()
+                      << "." << std::endl;
+      success = false;
+    }
+  }
+  ozz::sample::TraceRecorder trace;
+  if (success && OPTIONS_trace.value()[0] != 0) {
+    trace.Start();
+  }
+
+  ozz::log::Out out;
+  std::ostream& csv = file.is_open() ? file : out.stream();
+  csv << "characters,threads,grain_size,tasks,sampling_ms,local_to_model_ms,"
+         "frame_ms,sequential_ms,speedup,efficiency"
+      << std::endl;
+
+  for (size_t c = 0; success && c < characters.size(); ++c) {
+    const ozz::Range<Character> range(&all_characters[0], characters[c]);
+
+    // Sequential reference.
+    const double sequential =
+        TimePhase(&UpdateCharacter, NULL, animation, skeleton, range,
+                  characters[c], OPTIONS_frames);
+    success &= sequential >= 0.;
+
+    for (size_t t = 0; success && t < threads.size(); ++t) {
+      ozz::ThreadPool pool(threads[t]);
+      for (size_t g = 0; success && g < grain_sizes.size(); ++g) {
+        const double sampling =
+            TimePhase(&SampleCharacter, &pool, animation, skeleton, range,
+                      grain_sizes[g], OPTIONS_frames);
+        const double ltm =
+            TimePhase(&ConvertCharacter, &pool, animation, skeleton, range,
+                      grain_sizes[g], OPTIONS_frames);
+        success &= sampling >= 0. && ltm >= 0.;
+
+        const double frame = sampling + ltm;
+        const double speedup = frame > 0. ? sequential / frame : 0.;
+        csv << characters[c] << ',' << pool.num_threads() << ','
+            << grain_sizes[g] << ','
+            << (characters[c] + grain_sizes[g] - 1) / grain_sizes[g] << ','
+            << sampling << ',' << ltm << ',' << frame << ',' << sequential
+            << ',' << speedup << ',' << speedup / pool.num_threads()
+            << std::endl;
+      }
+    }
+  }
+
+  if (trace.recording()) {
+    trace.Stop();
+    success &= trace.Export(OPTIONS_trace);
+  }
+
+  for (int c = 0; c < max_characters; ++c) {
+    ozz::animation::AnimationInstance::Delete(all_characters[c].instance);
+  }
+  return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
 int main(int _argc, const char** _argv) {
   const char* title = "Ozz-animation sample: Multi-threading";
+
+  // Benchmark mode runs headless, without the sample application.
+  ozz::options::ParseResult result =
+      ozz::options::ParseCommandLine(_argc, _argv, "1.0", title);
+  if (result != ozz::options::kSuccess) {
+    return result == ozz::options::kExitSuccess ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+  if (OPTIONS_benchmark) {
+    return MultithreadSampleApplication::Benchmark();
+  }
+
   return MultithreadSampleApplication().Run(_argc, _argv, "1.0", title);
 }
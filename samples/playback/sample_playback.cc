@@ -32,6 +32,8 @@
 
 #include "ozz/base/log.h"
 
+#include "ozz/base/containers/aligned_vector.h"
+
 #include "ozz/base/maths/simd_math.h"
 #include "ozz/base/maths/soa_transform.h"
 #include "ozz/base/maths/vec_float.h"
@@ -68,6 +70,8 @@ class LoadSampleApplication : public ozz::sample::Application {
     sampling_job.animation = &animation_;
     sampling_job.cache = &cache_;
     sampling_job.ratio = controller_.time_ratio();
+    // Looping playback wraps the cache instead of invalidating it.
+    sampling_job.loop = controller_.loop();
     sampling_job.output = make_range(locals_);
     if (!sampling_job.Run()) {
       return false;
@@ -102,11 +106,12 @@ class LoadSampleApplication : public ozz::sample::Application {
       return false;
     }
 
-    // Allocates runtime buffers.
+    // Allocates runtime buffers. They don't need to be initialized as they
+    // are entirely written by the jobs.
     const int num_soa_joints = skeleton_.num_soa_joints();
-    locals_.resize(num_soa_joints);
+    locals_.resize_uninitialized(num_soa_joints);
     const int num_joints = skeleton_.num_joints();
-    models_.resize(num_joints);
+    models_.resize_uninitialized(num_joints);
 
     // Allocates a cache that matches animation requirements.
     cache_.Resize(num_joints);
@@ -147,10 +152,10 @@ class LoadSampleApplication : public ozz::sample::Application {
   ozz::animation::SamplingCache cache_;
 
   // Buffer of local transforms as sampled from animation_.
-  ozz::Vector<ozz::math::SoaTransform>::Std locals_;
+  ozz::AlignedVector<ozz::math::SoaTransform> locals_;
 
   // Buffer of model space matrices.
-  ozz::Vector<ozz::math::Float4x4>::Std models_;
+  ozz::AlignedVector<ozz::math::Float4x4> models_;
 };
 
 int main(int _argc, const char** _argv) {
@@ -25,6 +25,7 @@
 //                                                                            //
 //----------------------------------------------------------------------------//
 
+#include "ozz/animation/runtime/correction_job.h"
 #include "ozz/animation/runtime/ik_two_bone_job.h"
 #include "ozz/animation/runtime/local_to_model_job.h"
 #include "ozz/animation/runtime/skeleton.h"
@@ -107,10 +108,9 @@ class TwoBoneIKSampleApplication : public ozz::sample::Application {
     ik_job.end_joint = &models_[end_joint_];
 
     // Setup output pointers.
-    ozz::math::SimdQuaternion start_correction;
-    ik_job.start_joint_correction = &start_correction;
-    ozz::math::SimdQuaternion mid_correction;
-    ik_job.mid_joint_correction = &mid_correction;
+    ozz::math::SimdQuaternion corrections[2];
+    ik_job.start_joint_correction = &corrections[0];
+    ik_job.mid_joint_correction = &corrections[1];
     ik_job.reached = &reached_;
 
     if (!ik_job.Run()) {
@@ -118,10 +118,14 @@ class TwoBoneIKSampleApplication : public ozz::sample::Application {
     }
 
     // Apply IK quaternions to their respective local-space transforms.
-    ozz::sample::MultiplySoATransformQuaternion(start_joint_, start_correction,
-                                                make_range(locals_));
-    ozz::sample::MultiplySoATransformQuaternion(mid_joint_, mid_correction,
-                                                make_range(locals_));
+    const int joints[2] = {start_joint_, mid_joint_};
+    ozz::animation::CorrectionJob correction_job;
+    correction_job.joints = joints;
+    correction_job.corrections = corrections;
+    correction_job.output = make_range(locals_);
+    if (!correction_job.Run()) {
+      return false;
+    }
 
     // Updates model-space matrices now IK has been applied to local transforms.
     // All the ancestors of the start of the IK chain must be computed.
@@ -70,10 +70,23 @@ math::Float3 MakeDeltaScale(const math::Float3& _reference,
                             const math::Float3& _value) {
   return _value / _reference;
 }
+
+// Tests if all _track keys are identity, according to _tolerance.
+template <typename _Track>
+bool IsIdentity(const _Track& _track, float _tolerance) {
+  typedef typename _Track::value_type Key;
+  for (size_t i = 0; i < _track.size(); ++i) {
+    if (!Compare(_track[i].value, Key::identity(), _tolerance)) {
+      return false;
+    }
+  }
+  return true;
+}
 }  // namespace
 
 // Setup default values (favoring quality).
-AdditiveAnimationBuilder::AdditiveAnimationBuilder() {}
+AdditiveAnimationBuilder::AdditiveAnimationBuilder()
+    : identity_tolerance(1e-5f) {}
 
 bool AdditiveAnimationBuilder::operator()(const RawAnimation& _input,
                                           RawAnimation* _output) const {
@@ -95,6 +108,7 @@ bool AdditiveAnimationBuilder::operator()(const RawAnimation& _input,
   for (size_t i = 0; i < _input.tracks.size(); ++i) {
     const RawAnimation::JointTrack& track_in = _input.tracks[i];
     RawAnimation::JointTrack& track_out = _output->tracks[i];
+    track_out.step = track_in.step;
 
     const RawAnimation::JointTrack::Translations& translations =
         track_in.translations;
@@ -147,6 +161,7 @@ bool AdditiveAnimationBuilder::operator()(
   _output->tracks.resize(_input.tracks.size());
 
   for (size_t i = 0; i < _input.tracks.size(); ++i) {
+    _output->tracks[i].step = _input.tracks[i].step;
     MakeDelta(_input.tracks[i].translations, _reference_pose[i].translation,
               MakeDeltaTranslation, &_output->tracks[i].translations);
     MakeDelta(_input.tracks[i].rotations, _reference_pose[i].rotation,
@@ -159,6 +174,52 @@ bool AdditiveAnimationBuilder::operator()(
   return _output->Validate();
 }
 
+bool AdditiveAnimationBuilder::BuildSparse(
+    const RawAnimation& _additive, RawAnimation* _sparse,
+    ozz::Vector<int>::Std* _soa_joints) const {
+  if (!_sparse || !_soa_joints) {
+    return false;
+  }
+
+  // Reset outputs to default.
+  *_sparse = RawAnimation();
+  _soa_joints->clear();
+
+  // Validate animation.
+  if (!_additive.Validate()) {
+    return false;
+  }
+
+  _sparse->duration = _additive.duration;
+  _sparse->name = _additive.name;
+  _sparse->sync_markers = _additive.sync_markers;
+
+  // Keeps SoA joints with at least a non identity track.
+  const int num_tracks = _additive.num_tracks();
+  for (int soa = 0; soa < (num_tracks + 3) / 4; ++soa) {
+    const int begin = soa * 4;
+    const int end = begin + 4 < num_tracks ? begin + 4 : num_tracks;
+    bool identity = true;
+    for (int i = begin; i < end && identity; ++i) {
+      const RawAnimation::JointTrack& track = _additive.tracks[i];
+      identity = IsIdentity(track.translations, identity_tolerance) &&
+                 IsIdentity(track.rotations, identity_tolerance) &&
+                 IsIdentity(track.scales, identity_tolerance);
+    }
+    if (identity) {
+      continue;
+    }
+    _soa_joints->push_back(soa);
+    _sparse->tracks.insert(_sparse->tracks.end(),
+                           _additive.tracks.begin() + begin,
+                           _additive.tracks.begin() + end);
+    _sparse->tracks.resize(_soa_joints->size() * 4);
+  }
+
+  // Output animation is always valid though.
+  return _sparse->Validate();
+}
+
 }  // namespace offline
 }  // namespace animation
 }  // namespace ozz
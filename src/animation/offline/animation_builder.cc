@@ -29,18 +29,29 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <cstddef>
 #include <cstring>
 #include <limits>
 
+#ifdef OZZ_OFFLINE_THREADS
+#include <atomic>
+#include <thread>
+#endif  // OZZ_OFFLINE_THREADS
+
 #include "ozz/base/containers/vector.h"
 #include "ozz/base/memory/allocator.h"
 
+#include "ozz/base/maths/box.h"
 #include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/soa_transform.h"
 
 #include "ozz/animation/offline/raw_animation.h"
 
 #include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/local_to_model_job.h"
+#include "ozz/animation/runtime/sampling_job.h"
+#include "ozz/animation/runtime/skeleton.h"
 
 // Internal include file
 #define OZZ_INCLUDE_PRIVATE_HEADER  // Allows to include private headers.
@@ -55,19 +66,82 @@ struct SortingTranslationKey {
   uint16_t track;
   float prev_key_time;
   RawAnimation::TranslationKey key;
+  math::Float3 tangent;  // Only computed for spline animations.
+  uint8_t lod;  // Only computed for precision lods.
 };
 
 struct SortingRotationKey {
   uint16_t track;
   float prev_key_time;
   RawAnimation::RotationKey key;
+  math::Quaternion tangent;  // Only computed for spline animations.
+  uint8_t lod;  // Only computed for precision lods.
 };
 
 struct SortingScaleKey {
   uint16_t track;
   float prev_key_time;
   RawAnimation::ScaleKey key;
+  math::Float3 tangent;  // Only computed for spline animations.
+  uint8_t lod;  // Only computed for precision lods.
+};
+}  // namespace
+
+namespace internal {
+// Key sorting buffers of every channel, and their merge sort buffers.
+struct AnimationBuilderBuffers {
+  ozz::Vector<SortingTranslationKey>::Std translations;
+  ozz::Vector<SortingTranslationKey>::Std translations_merge;
+  ozz::Vector<SortingRotationKey>::Std rotations;
+  ozz::Vector<SortingRotationKey>::Std rotations_merge;
+  ozz::Vector<SortingScaleKey>::Std scales;
+  ozz::Vector<SortingScaleKey>::Std scales_merge;
+  ozz::Vector<KeyRange>::Std translation_ranges;
+  ozz::Vector<KeyRange>::Std scale_ranges;
+};
+
+// Key times storage of the animation being built, see Animation::num_frames()
+// and Animation::has_key_times().
+struct AnimationKeyTimes {
+  // Animation duration.
+  float duration;
+
+  // Number of frames key times are stored in.
+  int num_frames;
+
+  // Key times are stored as floats if true, as 16 bits frame indices
+  // otherwise.
+  bool floats;
+
+  // Key times are rounded to the nearest frame if true. Frame indices are
+  // always rounded, float key times only if they match a frame rate.
+  bool rounded;
+
+  // Gets the time, in frames, a key at time _time is stored at.
+  float Frame(float _time) const {
+    const double frame = static_cast<double>(_time) * num_frames / duration;
+    if (!rounded) {
+      return static_cast<float>(frame);
+    }
+    const double nearest = std::floor(frame + .5);
+    return static_cast<float>(
+        nearest < 0. ? 0. : (nearest > num_frames ? num_frames : nearest));
+  }
 };
+}  // namespace internal
+
+namespace {
+
+// Minimum number of raw keys of an animation for its channels to be built
+// concurrently.
+const size_t kMinParallelBuildKeys = 8192;
+
+// Minimum number of keys sorted by each thread of the parallel merge sort.
+const size_t kMinParallelSortKeys = 4096;
+
+// Previous key time of constant track single keys. It's lower than any other
+// previous key time, so sorting stores constant keys first.
+const float kConstantPrevKeyTime = -2.f;
 
 // Keyframe sorting. Stores first by time and then track number.
 template <typename _Key>
@@ -77,6 +151,81 @@ bool SortingKeyLess(const _Key& _left, const _Key& _right) {
           _left.track < _right.track);
 }
 
+#ifdef OZZ_OFFLINE_THREADS
+template <typename _Key>
+void SortKeyRange(_Key* _begin, _Key* _end) {
+  std::sort(_begin, _end, &SortingKeyLess<_Key>);
+}
+
+// Merges sorted [_begin,_middle[ and [_middle,_end[ ranges of _src to _dest.
+template <typename _Key>
+void MergeKeyRanges(const _Key* _src, size_t _begin, size_t _middle,
+                    size_t _end, _Key* _dest) {
+  std::merge(_src + _begin, _src + _middle, _src + _middle, _src + _end,
+             _dest + _begin, &SortingKeyLess<_Key>);
+}
+#endif  // OZZ_OFFLINE_THREADS
+
+// Sorts _keys, see SortingKeyLess. Up to _num_threads threads sort chunks of
+// keys concurrently, that are then merged by pairs, concurrently too, using
+// _buffer as an intermediate destination. As keys (previous key time and
+// track) are unique, output doesn't depend on the number of threads.
+template <typename _Key>
+void SortKeys(typename ozz::Vector<_Key>::Std* _keys,
+              typename ozz::Vector<_Key>::Std* _buffer, int _num_threads) {
+  _Key* keys = array_begin(*_keys);
+  const size_t count = _keys->size();
+#ifdef OZZ_OFFLINE_THREADS
+  const size_t num_chunks = math::Min(static_cast<size_t>(_num_threads),
+                                      count / kMinParallelSortKeys);
+  if (num_chunks > 1) {
+    ozz::Vector<size_t>::Std bounds(num_chunks + 1);
+    for (size_t i = 0; i <= num_chunks; ++i) {
+      bounds[i] = count * i / num_chunks;
+    }
+
+    // Sorts chunks, the calling thread sorting the first one.
+    ozz::Vector<std::thread>::Std threads;
+    threads.reserve(num_chunks);
+    for (size_t i = 1; i < num_chunks; ++i) {
+      threads.emplace_back(SortKeyRange<_Key>, keys + bounds[i],
+                           keys + bounds[i + 1]);
+    }
+    SortKeyRange(keys, keys + bounds[1]);
+    for (size_t i = 0; i < threads.size(); ++i) {
+      threads[i].join();
+    }
+
+    // Merges chunks by pairs, swapping source and destination buffers every
+    // pass.
+    _buffer->resize(count);
+    _Key* src = keys;
+    _Key* dest = array_begin(*_buffer);
+    for (size_t width = 1; width < num_chunks; width *= 2) {
+      threads.clear();
+      for (size_t i = 0; i < num_chunks; i += width * 2) {
+        const size_t middle = bounds[math::Min(i + width, num_chunks)];
+        const size_t end = bounds[math::Min(i + width * 2, num_chunks)];
+        threads.emplace_back(MergeKeyRanges<_Key>, src, bounds[i], middle, end,
+                             dest);
+      }
+      for (size_t i = 0; i < threads.size(); ++i) {
+        threads[i].join();
+      }
+      std::swap(src, dest);
+    }
+    if (src != keys) {
+      std::copy(src, src + count, keys);
+    }
+    return;
+  }
+#else   // OZZ_OFFLINE_THREADS
+  (void)_buffer;
+  (void)_num_threads;
+#endif  // OZZ_OFFLINE_THREADS
+  std::sort(keys, keys + count, &SortingKeyLess<_Key>);
+}
+
 template <typename _SrcKey, typename _DestTrack>
 void PushBackIdentityKey(uint16_t _track, float _time, _DestTrack* _dest) {
   typedef typename _DestTrack::value_type DestKey;
@@ -88,23 +237,58 @@ void PushBackIdentityKey(uint16_t _track, float _time, _DestTrack* _dest) {
   _dest->push_back(key);
 }
 
+// Removes keys of the track starting at index _first in _dest, whose frame
+// (see AnimationKeyTimes::Frame) is the same as the previous key, as two keys
+// of the same track can't have the same frame at runtime. First and last keys
+// (at t = 0 and t = duration) are always kept. Validate() selects key times
+// storage so that raw keys don't share a frame, so only the first and last keys
+// added by CopyRaw() can collide, with the raw key whose value they copy: no
+// information is lost. Previous key times are fixed-up accordingly.
+template <typename _DestTrack>
+void FilterQuantizedKeys(size_t _first,
+                         const internal::AnimationKeyTimes& _times,
+                         _DestTrack* _dest) {
+  const size_t last = _dest->size() - 1;
+  assert(_first < last);
+  size_t out = _first;
+  for (size_t i = _first + 1; i <= last; ++i) {
+    if (_times.Frame((*_dest)[i].key.time) !=
+        _times.Frame((*_dest)[out].key.time)) {
+      (*_dest)[++out] = (*_dest)[i];
+    } else if (i == last) {
+      // Ratio 0 and 1 can't collide, so out can't be the first key.
+      assert(out != _first);
+      (*_dest)[out] = (*_dest)[i];
+    }
+  }
+  _dest->resize(out + 1);
+
+  // Fixes up previous key times.
+  (*_dest)[_first].prev_key_time = -1.f;
+  for (size_t i = _first + 1; i <= out; ++i) {
+    (*_dest)[i].prev_key_time = (*_dest)[i - 1].key.time;
+  }
+}
+
 // Copies a track from a RawAnimation to an Animation.
 // Also fixes up the front (t = 0) and back keys (t = duration).
 template <typename _SrcTrack, typename _DestTrack>
-void CopyRaw(const _SrcTrack& _src, uint16_t _track, float _duration,
-             _DestTrack* _dest) {
+void CopyRaw(const _SrcTrack& _src, uint16_t _track,
+             const internal::AnimationKeyTimes& _times, _DestTrack* _dest) {
   typedef typename _SrcTrack::value_type SrcKey;
   typedef typename _DestTrack::value_type DestKey;
+  const size_t track_begin = _dest->size();
+  const float duration = _times.duration;
 
   if (_src.size() == 0) {  // Adds 2 new keys.
     PushBackIdentityKey<SrcKey, _DestTrack>(_track, 0.f, _dest);
-    PushBackIdentityKey<SrcKey, _DestTrack>(_track, _duration, _dest);
+    PushBackIdentityKey<SrcKey, _DestTrack>(_track, duration, _dest);
   } else if (_src.size() == 1) {  // Adds 1 new key.
     const SrcKey& raw_key = _src.front();
-    assert(raw_key.time >= 0 && raw_key.time <= _duration);
+    assert(raw_key.time >= 0 && raw_key.time <= duration);
     const DestKey first = {_track, -1.f, {0.f, raw_key.value}};
     _dest->push_back(first);
-    const DestKey last = {_track, 0.f, {_duration, raw_key.value}};
+    const DestKey last = {_track, 0.f, {duration, raw_key.value}};
     _dest->push_back(last);
   } else {  // Copies all keys, and fixes up first and last keys.
     float prev_time = -1.f;
@@ -115,62 +299,450 @@ void CopyRaw(const _SrcTrack& _src, uint16_t _track, float _duration,
     }
     for (size_t k = 0; k < _src.size(); ++k) {  // Copies all keys.
       const SrcKey& raw_key = _src[k];
-      assert(raw_key.time >= 0 && raw_key.time <= _duration);
+      assert(raw_key.time >= 0 && raw_key.time <= duration);
       const DestKey key = {_track, prev_time, {raw_key.time, raw_key.value}};
       _dest->push_back(key);
       prev_time = raw_key.time;
     }
-    if (_src.back().time != _duration) {  // Needs a key at t = _duration.
-      const DestKey last = {_track, prev_time, {_duration, _src.back().value}};
+    if (_src.back().time != duration) {  // Needs a key at t = duration.
+      const DestKey last = {_track, prev_time, {duration, _src.back().value}};
       _dest->push_back(last);
     }
   }
-  assert(_dest->front().key.time == 0.f && _dest->back().key.time == _duration);
+  FilterQuantizedKeys(track_begin, _times, _dest);
+  assert((*_dest)[track_begin].key.time == 0.f &&
+         _dest->back().key.time == duration);
 }
 
-void CopyToAnimation(ozz::Vector<SortingTranslationKey>::Std* _src,
-                     ozz::Range<TranslationKey>* _dest, float _inv_duration) {
-  const size_t src_count = _src->size();
-  if (!src_count) {
-    return;
+// Collapses tracks of _keys whose key values are all the same to a single key,
+// flagged with kConstantPrevKeyTime. Keys are expected to be sorted per track.
+// Returns the number of constant tracks.
+template <typename _SortingKey>
+int StripConstantTracks(typename ozz::Vector<_SortingKey>::Std* _keys) {
+  int num_constants = 0;
+  size_t out = 0;
+  const size_t count = _keys->size();
+  for (size_t begin = 0, end = 0; begin < count; begin = end) {
+    // Finds track keys end, and compares all values with the first one.
+    const _SortingKey first = (*_keys)[begin];
+    bool constant = true;
+    for (end = begin + 1; end < count && (*_keys)[end].track == first.track;
+         ++end) {
+      constant &= (*_keys)[end].key.value == first.key.value;
+    }
+    if (constant) {
+      (*_keys)[out] = first;
+      (*_keys)[out++].prev_key_time = kConstantPrevKeyTime;
+      ++num_constants;
+    } else {
+      for (size_t i = begin; i < end; ++i) {
+        (*_keys)[out++] = (*_keys)[i];
+      }
+    }
   }
+  _keys->resize(out);
+  return num_constants;
+}
 
-  // Sort animation keys to favor cache coherency.
-  std::sort(&_src->front(), (&_src->back()) + 1,
-            &SortingKeyLess<SortingTranslationKey>);
+// Copies the keys of _input channel selected by _member (translations,
+// rotations or scales) to _dest, which is cleared first. Adds enough identity
+// keys to match soa requirements, and stores constant tracks once, out of the
+// time sorted keys. Returns the number of constant tracks.
+template <typename _SrcTrack, typename _DestTrack>
+int PrepareKeys(const RawAnimation& _input,
+                _SrcTrack RawAnimation::JointTrack::*_member,
+                uint16_t _num_soa_tracks,
+                const internal::AnimationKeyTimes& _times,
+                _DestTrack* _dest) {
+  typedef typename _SrcTrack::value_type SrcKey;
+  typedef typename _DestTrack::value_type DestKey;
+  const float duration = _input.duration;
+  const uint16_t num_tracks = static_cast<uint16_t>(_input.num_tracks());
 
-  // Fills output.
-  const SortingTranslationKey* src = &_src->front();
-  for (size_t i = 0; i < src_count; ++i) {
-    TranslationKey& key = _dest->begin[i];
-    key.ratio = src[i].key.time * _inv_duration;
-    key.track = src[i].track;
-    key.value[0] = ozz::math::FloatToHalf(src[i].key.value.x);
-    key.value[1] = ozz::math::FloatToHalf(src[i].key.value.y);
-    key.value[2] = ozz::math::FloatToHalf(src[i].key.value.z);
+  // Preallocates keys, +2 per track because worst case needs to add the first
+  // and last keys.
+  size_t count = 0;
+  for (uint16_t i = 0; i < _num_soa_tracks; ++i) {
+    count += (i < num_tracks ? (_input.tracks[i].*_member).size() : 0) + 2;
+  }
+  _dest->clear();
+  _dest->reserve(count);
+
+  // Filters RawAnimation keys and copies them to the output sorting structure.
+  uint16_t i = 0;
+  for (; i < num_tracks; ++i) {
+    CopyRaw(_input.tracks[i].*_member, i, _times, _dest);
+  }
+
+  // Add enough identity keys to match soa requirements.
+  for (; i < _num_soa_tracks; ++i) {
+    PushBackIdentityKey<SrcKey>(i, 0.f, _dest);
+    PushBackIdentityKey<SrcKey>(i, duration, _dest);
+  }
+
+  return StripConstantTracks<DestKey>(_dest);
+}
+
+// Computes the tangent of a _curr key from its _prev and _next neighbor
+// values, distant from _prev_span and _next_span time ratios. Neighbor slopes
+// are weighted by the opposite span, which keeps tangents accurate when keys
+// aren't evenly spaced. A null span means there's no neighbor on this side.
+template <typename _Value>
+_Value Tangent(const _Value& _prev, const _Value& _curr, const _Value& _next,
+               float _prev_span, float _next_span) {
+  if (_prev_span <= 0.f) {
+    return (_next + _curr * -1.f) * (1.f / _next_span);
+  } else if (_next_span <= 0.f) {
+    return (_curr + _prev * -1.f) * (1.f / _prev_span);
+  }
+  const _Value prev_slope = (_curr + _prev * -1.f) * (1.f / _prev_span);
+  const _Value next_slope = (_next + _curr * -1.f) * (1.f / _next_span);
+  return (prev_slope * _next_span + next_slope * _prev_span) *
+         (1.f / (_prev_span + _next_span));
+}
+
+// Computes tangents of _keys, which are expected to be sorted per track.
+// Tangents are derivatives relatively to key time ratios restored from stored
+// key times, so they match runtime interpolation. First and last keys of a
+// track use their only neighbor, while constant tracks single key and step
+// tracks keys (see RawAnimation::JointTrack::step) have a null tangent.
+template <typename _SortingKey>
+void ComputeTangents(const RawAnimation& _input,
+                     typename ozz::Vector<_SortingKey>::Std* _keys,
+                     const internal::AnimationKeyTimes& _times) {
+  const size_t num_tracks = _input.tracks.size();
+  const size_t count = _keys->size();
+  for (size_t begin = 0, end = 0; begin < count; begin = end) {
+    for (end = begin + 1;
+         end < count && (*_keys)[end].track == (*_keys)[begin].track; ++end) {
+    }
+    for (size_t i = begin; i < end; ++i) {
+      _SortingKey& key = (*_keys)[i];
+      if (end - begin < 2 ||
+          (key.track < num_tracks && _input.tracks[key.track].step)) {
+        key.tangent = key.key.value * 0.f;
+        continue;
+      }
+      const _SortingKey& prev = (*_keys)[i > begin ? i - 1 : i];
+      const _SortingKey& next = (*_keys)[i + 1 < end ? i + 1 : i];
+      const float frame = _times.Frame(key.key.time);
+      const float prev_span = frame - _times.Frame(prev.key.time);
+      const float next_span = _times.Frame(next.key.time) - frame;
+      assert(prev_span > 0.f || next_span > 0.f);
+      const float frames = static_cast<float>(_times.num_frames);
+      key.tangent = Tangent(prev.key.value, key.key.value, next.key.value,
+                            prev_span / frames, next_span / frames);
+    }
+  }
+}
+
+// Precision lods building settings of a channel, see
+// AnimationBuilder::precision_lods.
+struct KeyLodsBuild {
+  // Number of precision lods, 0 if none is built.
+  int lods;
+
+  // Tolerance of precision lod 1.
+  float tolerance;
+
+  // Number of tracks, including soa padding ones.
+  int num_tracks;
+
+  // Animation buffers.
+  ozz::Range<uint8_t>* key_lods;
+  ozz::Range<int>* lod_next;
+};
+
+// Computes the distance between the interpolation of _a and _b values at
+// _alpha and _value, which is a translation or scale.
+float LodDistance(const math::Float3& _a, const math::Float3& _b, float _alpha,
+                  const math::Float3& _value) {
+  return Length(Lerp(_a, _b, _alpha) - _value);
+}
+
+// Rotations distance is the angle between the normalized lerp of _a and _b
+// and _value. Like at runtime, interpolation doesn't check for the shortest
+// path, as consecutive keys were fixed-up to the same hemisphere.
+float LodDistance(const math::Quaternion& _a, const math::Quaternion& _b,
+                  float _alpha, const math::Quaternion& _value) {
+  const math::Quaternion interp = NLerp(_a, _b, _alpha);
+  const float cos_half_angle =
+      std::abs(interp.x * _value.x + interp.y * _value.y +
+               interp.z * _value.z + interp.w * _value.w);
+  return 2.f * std::acos(math::Min(cos_half_angle, 1.f));
+}
+
+// Computes the error of removing all keys of _keys between _prev and _next,
+// as the maximum distance between their original value and the
+// interpolation of _prev and _next keys.
+template <typename _SortingKey>
+float RemovalError(const typename ozz::Vector<_SortingKey>::Std& _keys,
+                   size_t _prev, size_t _next) {
+  const _SortingKey& prev = _keys[_prev];
+  const _SortingKey& next = _keys[_next];
+  const float inv_span = 1.f / (next.key.time - prev.key.time);
+  float error = 0.f;
+  for (size_t i = _prev + 1; i < _next; ++i) {
+    const float alpha = (_keys[i].key.time - prev.key.time) * inv_span;
+    error = math::Max(error, LodDistance(prev.key.value, next.key.value,
+                                         alpha, _keys[i].key.value));
+  }
+  return error;
+}
+
+// Key removal candidate, ordered by removal error. Stamp allows to ignore
+// candidates whose error was updated since they were pushed.
+struct LodCandidate {
+  float error;
+  size_t index;
+  int stamp;
+};
+
+// Heap ordering, so that the lowest error candidate is at the top. Index
+// breaks ties, which keeps building deterministic.
+bool LodCandidateGreater(const LodCandidate& _left,
+                         const LodCandidate& _right) {
+  return _left.error > _right.error ||
+         (_left.error == _right.error && _left.index > _right.index);
+}
+
+// Gets the coarsest precision lod that samples a key removed with _error.
+// Precision lod l (from 1) skips keys whose error is lower or equal to its
+// tolerance, _tolerance * 2^(l-1). Keys sampled by the coarsest lod are
+// sampled by any higher lod too.
+uint8_t ErrorToKeyLod(float _error, const KeyLodsBuild& _lods) {
+  int lod = 0;
+  for (float tolerance = _lods.tolerance;
+       lod < _lods.lods && _error > tolerance; tolerance *= 2.f) {
+    ++lod;
   }
+  return static_cast<uint8_t>(lod < _lods.lods ? lod : Animation::kKeepKeyLod);
 }
 
-void CopyToAnimation(ozz::Vector<SortingScaleKey>::Std* _src,
-                     ozz::Range<ScaleKey>* _dest, float _inv_duration) {
+// Computes the precision lod of _keys, which are expected to be sorted per
+// track. Interior keys of a track are removed greedily, lowest error first,
+// the error being measured against all the original keys removed so far.
+// Removal errors are made monotonic, so the keys sampled by a lod are a
+// subset of the ones sampled by finer lods. First and last keys of a track,
+// constant tracks single key and step tracks keys are never skipped.
+template <typename _SortingKey>
+void ComputeKeyLods(const RawAnimation& _input,
+                    typename ozz::Vector<_SortingKey>::Std* _keys,
+                    const KeyLodsBuild& _lods) {
+  const size_t num_tracks = _input.tracks.size();
+  const size_t count = _keys->size();
+  ozz::Vector<size_t>::Std prevs(count);
+  ozz::Vector<size_t>::Std nexts(count);
+  ozz::Vector<int>::Std stamps(count, 0);
+  ozz::Vector<LodCandidate>::Std heap;
+  for (size_t begin = 0, end = 0; begin < count; begin = end) {
+    for (end = begin + 1;
+         end < count && (*_keys)[end].track == (*_keys)[begin].track; ++end) {
+    }
+    for (size_t i = begin; i < end; ++i) {
+      (*_keys)[i].lod = Animation::kKeepKeyLod;
+      prevs[i] = i - 1;
+      nexts[i] = i + 1;
+    }
+    const uint16_t track = (*_keys)[begin].track;
+    if (end - begin < 3 || (track < num_tracks && _input.tracks[track].step)) {
+      continue;
+    }
+
+    heap.clear();
+    for (size_t i = begin + 1; i < end - 1; ++i) {
+      const LodCandidate candidate = {
+          RemovalError<_SortingKey>(*_keys, i - 1, i + 1), i, 0};
+      heap.push_back(candidate);
+    }
+    std::make_heap(heap.begin(), heap.end(), &LodCandidateGreater);
+
+    float error = 0.f;
+    while (!heap.empty()) {
+      std::pop_heap(heap.begin(), heap.end(), &LodCandidateGreater);
+      const LodCandidate candidate = heap.back();
+      heap.pop_back();
+      const size_t index = candidate.index;
+      if (candidate.stamp != stamps[index]) {
+        continue;  // Outdated candidate.
+      }
+      ++stamps[index];
+      error = math::Max(error, candidate.error);
+      (*_keys)[index].lod = ErrorToKeyLod(error, _lods);
+
+      // Unlinks the removed key, and updates its neighbors removal error.
+      const size_t prev = prevs[index];
+      const size_t next = nexts[index];
+      nexts[prev] = next;
+      prevs[next] = prev;
+      if (prev != begin) {
+        const LodCandidate updated = {
+            RemovalError<_SortingKey>(*_keys, prevs[prev], next), prev,
+            ++stamps[prev]};
+        heap.push_back(updated);
+        std::push_heap(heap.begin(), heap.end(), &LodCandidateGreater);
+      }
+      if (next != end - 1) {
+        const LodCandidate updated = {
+            RemovalError<_SortingKey>(*_keys, prev, nexts[next]), next,
+            ++stamps[next]};
+        heap.push_back(updated);
+        std::push_heap(heap.begin(), heap.end(), &LodCandidateGreater);
+      }
+    }
+  }
+}
+
+// Stores time sorted _keys precision lods to the animation, along with the
+// index of the next key of the same track with a higher lod. Keys are scanned
+// backward, remembering for every track the next key of each lod (never
+// skipped keys using the last slot).
+template <typename _SortingKey>
+void StoreKeyLods(const typename ozz::Vector<_SortingKey>::Std& _keys,
+                  const KeyLodsBuild& _lods) {
+  const int slots = _lods.lods + 2;
+  ozz::Vector<int>::Std nexts(_lods.num_tracks * slots, -1);
+  for (size_t i = _keys.size(); i-- > 0;) {
+    const uint8_t lod = _keys[i].lod;
+    const int slot = lod == Animation::kKeepKeyLod ? slots - 1 : lod;
+    int* track_nexts = &nexts[_keys[i].track * slots];
+    _lods.key_lods->begin[i] = lod;
+    _lods.lod_next->begin[i] = slot + 1 < slots ? track_nexts[slot + 1] : -1;
+    for (int j = 0; j <= slot; ++j) {
+      track_nexts[j] = static_cast<int>(i);
+    }
+  }
+}
+
+// Converts tangent component _value to a half float. Values are clamped to
+// half float range.
+uint16_t TangentToHalf(float _value) {
+  return math::FloatToHalf(math::Clamp(-65504.f, _value, 65504.f));
+}
+
+// Selects the number of bits of values spanning _extent, so that their
+// quantization error (half a quantization step) doesn't exceed _tolerance.
+int QuantizationBits(float _extent, float _tolerance) {
+  if (!(_extent > 0.f)) {
+    return 0;
+  }
+  int bits = 1;
+  while (bits < kMaxValueBits &&
+         _extent > 2.f * _tolerance * static_cast<float>((1 << bits) - 1)) {
+    ++bits;
+  }
+  return bits;
+}
+
+// Computes per-track ranges of _src key values and selects their number of
+// bits against _tolerance. _num_tracks is aligned to soa size. Returns the
+// number of bits of all _src key values. Every track is expected to have at
+// least a key.
+template <typename _SortingKey>
+size_t ComputeRanges(const typename ozz::Vector<_SortingKey>::Std& _src,
+                     uint16_t _num_tracks, float _tolerance,
+                     ozz::Vector<KeyRange>::Std* _ranges) {
+  const size_t num_tracks = _num_tracks;
+  ozz::Vector<math::Float3>::Std mins(
+      num_tracks, math::Float3(std::numeric_limits<float>::max()));
+  ozz::Vector<math::Float3>::Std maxs(
+      num_tracks, math::Float3(-std::numeric_limits<float>::max()));
+  ozz::Vector<size_t>::Std counts(num_tracks, 0);
+  for (size_t i = 0; i < _src.size(); ++i) {
+    const _SortingKey& key = _src[i];
+    assert(key.track < num_tracks);
+    mins[key.track] = Min(mins[key.track], key.key.value);
+    maxs[key.track] = Max(maxs[key.track], key.key.value);
+    ++counts[key.track];
+  }
+  _ranges->resize(num_tracks / 4);
+  size_t num_bits = 0;
+  for (size_t i = 0; i < num_tracks; ++i) {
+    assert(mins[i].x <= maxs[i].x);
+    const float min[3] = {mins[i].x, mins[i].y, mins[i].z};
+    const float max[3] = {maxs[i].x, maxs[i].y, maxs[i].z};
+    KeyRange& range = (*_ranges)[i / 4];
+    for (int c = 0; c < 3; ++c) {
+      const int bits = QuantizationBits(max[c] - min[c], _tolerance);
+      range.min[c][i & 3] = min[c];
+      range.step[c][i & 3] =
+          bits > 0 ? (max[c] - min[c]) / ((1 << bits) - 1) : 0.f;
+      range.bits[c][i & 3] = static_cast<uint8_t>(bits);
+      num_bits += bits * counts[i];
+    }
+  }
+  return num_bits;
+}
+
+// Sorts, quantizes and bit packs translation or scale keys values, in
+// _ranges computed by ComputeRanges. Tangents are computed and stored to
+// _tangents unless it's empty (linear animation). Key times are stored to
+// _key_times unless it's empty (frame indices).
+template <typename _SortingKey, typename _Key>
+void CopyToAnimation(const RawAnimation& _input,
+                     typename ozz::Vector<_SortingKey>::Std* _src,
+                     typename ozz::Vector<_SortingKey>::Std* _buffer,
+                     int _num_threads, ozz::Range<_Key>* _dest,
+                     const ozz::Range<KeyRange>& _ranges,
+                     ozz::Range<uint8_t>* _values,
+                     ozz::Range<uint32_t>* _value_offsets,
+                     ozz::Range<Float3Tangent>* _tangents,
+                     ozz::Range<float>* _key_times, const KeyLodsBuild& _lods,
+                     const internal::AnimationKeyTimes& _times) {
   const size_t src_count = _src->size();
   if (!src_count) {
     return;
   }
 
+  // Computes tangents while keys are still sorted per track.
+  if (_tangents->begin) {
+    ComputeTangents<_SortingKey>(_input, _src, _times);
+  }
+
+  // Computes precision lods too.
+  if (_lods.lods) {
+    ComputeKeyLods<_SortingKey>(_input, _src, _lods);
+  }
+
   // Sort animation keys to favor cache coherency.
-  std::sort(&_src->front(), (&_src->back()) + 1,
-            &SortingKeyLess<SortingScaleKey>);
+  SortKeys<_SortingKey>(_src, _buffer, _num_threads);
+  if (_lods.lods) {
+    StoreKeyLods<_SortingKey>(*_src, _lods);
+  }
 
-  // Fills output.
-  const SortingScaleKey* src = &_src->front();
+  // Fills output. Values are packed one after the other, in sorted keys
+  // order.
+  std::memset(_values->begin, 0, _values->size());
+  uint32_t offset = 0;
+  const _SortingKey* src = &_src->front();
   for (size_t i = 0; i < src_count; ++i) {
-    ScaleKey& key = _dest->begin[i];
-    key.ratio = src[i].key.time * _inv_duration;
+    _Key& key = _dest->begin[i];
+    const float frame = _times.Frame(src[i].key.time);
+    key.ratio = _key_times->begin ? 0 : static_cast<uint16_t>(frame);
+    if (_key_times->begin) {
+      _key_times->begin[i] = frame;
+    }
     key.track = src[i].track;
-    key.value[0] = ozz::math::FloatToHalf(src[i].key.value.x);
-    key.value[1] = ozz::math::FloatToHalf(src[i].key.value.y);
-    key.value[2] = ozz::math::FloatToHalf(src[i].key.value.z);
+    if (i % kValueBlockSize == 0) {
+      _value_offsets->begin[i / kValueBlockSize] = offset;
+    }
+    const KeyRange& range = _ranges.begin[key.track / 4];
+    const int lane = key.track & 3;
+    const float value[3] = {src[i].key.value.x, src[i].key.value.y,
+                            src[i].key.value.z};
+    for (int c = 0; c < 3; ++c) {
+      const int bits = range.bits[c][lane];
+      PackValue(QuantizeRanged(value[c], range.min[c][lane],
+                               range.step[c][lane], bits),
+                bits, offset, _values->begin);
+      offset += bits;
+    }
+    if (_tangents->begin) {
+      Float3Tangent& tangent = _tangents->begin[i];
+      tangent.value[0] = TangentToHalf(src[i].tangent.x);
+      tangent.value[1] = TangentToHalf(src[i].tangent.y);
+      tangent.value[2] = TangentToHalf(src[i].tangent.z);
+    }
   }
 }
 
@@ -179,6 +751,9 @@ bool LessAbs(float _left, float _right) {
   return std::abs(_left) < std::abs(_right);
 }
 
+// RotationKey::track bitfield must be able to index all tracks.
+OZZ_STATIC_ASSERT(Skeleton::kMaxJoints <= 1 << 13);
+
 // Compresses quaternion to ozz::animation::RotationKey format.
 // The 3 smallest components of the quaternion are quantized to 16 bits
 // integers, while the largest is recomputed thanks to quaternion normalization
@@ -211,8 +786,13 @@ void CompressQuat(const ozz::math::Quaternion& _src,
 // Specialize for rotations in order to normalize quaternions.
 // Consecutive opposite quaternions are also fixed up in order to avoid checking
 // for the smallest path during the NLerp runtime algorithm.
-void CopyToAnimation(ozz::Vector<SortingRotationKey>::Std* _src,
-                     ozz::Range<RotationKey>* _dest, float _inv_duration) {
+void CopyToAnimation(const RawAnimation& _input,
+                     ozz::Vector<SortingRotationKey>::Std* _src,
+                     ozz::Vector<SortingRotationKey>::Std* _buffer,
+                     int _num_threads, ozz::Range<RotationKey>* _dest,
+                     ozz::Range<QuaternionTangent>* _tangents,
+                     ozz::Range<float>* _key_times, const KeyLodsBuild& _lods,
+                     const internal::AnimationKeyTimes& _times) {
   const size_t src_count = _src->size();
   if (!src_count) {
     return;
@@ -246,41 +826,681 @@ void CopyToAnimation(ozz::Vector<SortingRotationKey>::Std* _src,
     track = src[i].track;
   }
 
+  // Computes tangents once quaternions are fixed-up, as they must be computed
+  // in the same hemisphere.
+  if (_tangents->begin) {
+    ComputeTangents<SortingRotationKey>(_input, _src, _times);
+  }
+
+  // Precision lods errors are also computed in the same hemisphere.
+  if (_lods.lods) {
+    ComputeKeyLods<SortingRotationKey>(_input, _src, _lods);
+  }
+
   // Sort.
-  std::sort(array_begin(*_src), array_end(*_src),
-            &SortingKeyLess<SortingRotationKey>);
+  SortKeys<SortingRotationKey>(_src, _buffer, _num_threads);
+  if (_lods.lods) {
+    StoreKeyLods<SortingRotationKey>(*_src, _lods);
+  }
 
   // Fills rotation keys output.
   for (size_t i = 0; i < src_count; ++i) {
     const SortingRotationKey& skey = src[i];
     RotationKey& dkey = _dest->begin[i];
-    dkey.ratio = skey.key.time * _inv_duration;
+    const float frame = _times.Frame(skey.key.time);
+    dkey.ratio = _key_times->begin ? 0 : static_cast<uint16_t>(frame);
+    if (_key_times->begin) {
+      _key_times->begin[i] = frame;
+    }
     dkey.track = skey.track;
 
     // Compress quaternion to destination container.
     CompressQuat(skey.key.value, &dkey);
+
+    if (_tangents->begin) {
+      QuaternionTangent& tangent = _tangents->begin[i];
+      tangent.value[0] = TangentToHalf(skey.tangent.x);
+      tangent.value[1] = TangentToHalf(skey.tangent.y);
+      tangent.value[2] = TangentToHalf(skey.tangent.z);
+      tangent.value[3] = TangentToHalf(skey.tangent.w);
+    }
+  }
+}
+
+// Keyframes building state, shared by translation, rotation and scale
+// channels, which can be built concurrently.
+struct KeyframesBuild {
+  const RawAnimation* input;
+  uint16_t num_soa_tracks;
+  internal::AnimationKeyTimes times;
+
+  // Number of threads used by each channel to sort its keys.
+  int sort_threads;
+
+  internal::AnimationBuilderBuffers* buffers;
+
+  // Quantization tolerances of translation and scale channels.
+  float quantization_tolerances[2];
+
+  // Number of constant tracks of every channel, and number of bits of
+  // translation and scale values, output by PrepareChannel.
+  int num_constants[3];
+  size_t value_bits[2];
+
+  // Animation buffers, set once the animation is allocated.
+  Range<TranslationKey>* translations;
+  Range<KeyRange>* translation_ranges;
+  Range<uint8_t>* translation_values;
+  Range<uint32_t>* translation_value_offsets;
+  Range<Float3Tangent>* translation_tangents;
+  Range<RotationKey>* rotations;
+  Range<QuaternionTangent>* rotation_tangents;
+  Range<ScaleKey>* scales;
+  Range<KeyRange>* scale_ranges;
+  Range<uint8_t>* scale_values;
+  Range<uint32_t>* scale_value_offsets;
+  Range<Float3Tangent>* scale_tangents;
+  Range<float>* translation_times;
+  Range<float>* rotation_times;
+  Range<float>* scale_times;
+
+  // Precision lods settings of every channel, see KeyLodsBuild.
+  KeyLodsBuild lods[3];
+};
+
+// Copies _channel raw keys to sorting buffers, see PrepareKeys, and computes
+// translation and scale quantization ranges, see ComputeRanges.
+void PrepareChannel(KeyframesBuild* _build, int _channel) {
+  const RawAnimation& input = *_build->input;
+  internal::AnimationBuilderBuffers& buffers = *_build->buffers;
+  switch (_channel) {
+    case 0:
+      _build->num_constants[0] =
+          PrepareKeys(input, &RawAnimation::JointTrack::translations,
+                      _build->num_soa_tracks, _build->times,
+                      &buffers.translations);
+      _build->value_bits[0] = ComputeRanges<SortingTranslationKey>(
+          buffers.translations, _build->num_soa_tracks,
+          _build->quantization_tolerances[0], &buffers.translation_ranges);
+      break;
+    case 1:
+      _build->num_constants[1] =
+          PrepareKeys(input, &RawAnimation::JointTrack::rotations,
+                      _build->num_soa_tracks, _build->times,
+                      &buffers.rotations);
+      break;
+    default:
+      _build->num_constants[2] =
+          PrepareKeys(input, &RawAnimation::JointTrack::scales,
+                      _build->num_soa_tracks, _build->times,
+                      &buffers.scales);
+      _build->value_bits[1] = ComputeRanges<SortingScaleKey>(
+          buffers.scales, _build->num_soa_tracks,
+          _build->quantization_tolerances[1], &buffers.scale_ranges);
+      break;
+  }
+}
+
+// Sorts and copies _channel keys to the animation, see CopyToAnimation.
+void CopyChannel(KeyframesBuild* _build, int _channel) {
+  internal::AnimationBuilderBuffers& buffers = *_build->buffers;
+  switch (_channel) {
+    case 0:
+      CopyToAnimation<SortingTranslationKey>(
+          *_build->input, &buffers.translations, &buffers.translations_merge,
+          _build->sort_threads, _build->translations,
+          *_build->translation_ranges, _build->translation_values,
+          _build->translation_value_offsets, _build->translation_tangents,
+          _build->translation_times, _build->lods[0], _build->times);
+      break;
+    case 1:
+      CopyToAnimation(*_build->input, &buffers.rotations,
+                      &buffers.rotations_merge, _build->sort_threads,
+                      _build->rotations, _build->rotation_tangents,
+                      _build->rotation_times, _build->lods[1], _build->times);
+      break;
+    default:
+      CopyToAnimation<SortingScaleKey>(
+          *_build->input, &buffers.scales, &buffers.scales_merge,
+          _build->sort_threads, _build->scales, *_build->scale_ranges,
+          _build->scale_values, _build->scale_value_offsets,
+          _build->scale_tangents, _build->scale_times, _build->lods[2],
+          _build->times);
+      break;
+  }
+}
+
+typedef void (*ChannelFunction)(KeyframesBuild* _build, int _channel);
+
+#ifdef OZZ_OFFLINE_THREADS
+// Runs _function on channels until there's none left.
+void RunChannelsWorker(ChannelFunction _function, KeyframesBuild* _build,
+                       std::atomic<int>* _next) {
+  memory::ScopedAllocationTag tag(memory::kTagBuilder);
+  for (int channel = (*_next)++; channel < 3; channel = (*_next)++) {
+    _function(_build, channel);
+  }
+}
+#endif  // OZZ_OFFLINE_THREADS
+
+// Runs _function on translation, rotation and scale channels, concurrently
+// if _num_workers is greater than 1. Calling thread is used as a worker too.
+void RunChannels(ChannelFunction _function, KeyframesBuild* _build,
+                 int _num_workers) {
+#ifdef OZZ_OFFLINE_THREADS
+  if (_num_workers > 1) {
+    std::atomic<int> next(0);
+    ozz::Vector<std::thread>::Std threads;
+    threads.reserve(_num_workers - 1);
+    for (int i = 1; i < _num_workers; ++i) {
+      threads.emplace_back(RunChannelsWorker, _function, _build, &next);
+    }
+    RunChannelsWorker(_function, _build, &next);
+    for (size_t i = 0; i < threads.size(); ++i) {
+      threads[i].join();
+    }
+    return;
+  }
+#else   // OZZ_OFFLINE_THREADS
+  (void)_num_workers;
+#endif  // OZZ_OFFLINE_THREADS
+  for (int channel = 0; channel < 3; ++channel) {
+    _function(_build, channel);
+  }
+}
+
+// Advances _keys _cursor and _cache (left and right key indices of every
+// track) up to _ratio. _times are _keys float times, or NULL. This reproduces
+// SamplingJob keyframes iteration algorithm, so that a SamplingCache can later
+// be seeded from this state.
+template <typename _Key>
+void AdvanceSeekKeys(float _ratio, int _num_frames, int _num_tracks,
+                     int _num_constants,
+                     const ozz::Range<_Key>& _keys, const float* _times,
+                     int* _cursor, int* _cache) {
+  if (!*_cursor) {
+    // Constant tracks single keys come first, followed by the first 2 sets of
+    // keys, which are the first 2 keys of every animated track.
+    for (int i = 0; i < _num_constants; ++i) {
+      _cache[_keys.begin[i].track * 2 + 0] = i;
+      _cache[_keys.begin[i].track * 2 + 1] = i;
+    }
+    const int num_animated = _num_tracks - _num_constants;
+    for (int i = _num_constants; i < _num_constants + num_animated; ++i) {
+      _cache[_keys.begin[i].track * 2 + 0] = i;
+      _cache[_keys.begin[i].track * 2 + 1] = i + num_animated;
+    }
+    *_cursor = _num_constants + num_animated * 2;
+  }
+  const int num_keys = static_cast<int>(_keys.count());
+  const float frame = _ratio * _num_frames;
+  while (*_cursor < num_keys &&
+         KeyFrame(_keys.begin, _times,
+                  _cache[_keys.begin[*_cursor].track * 2 + 1]) <= frame) {
+    const int base = _keys.begin[*_cursor].track * 2;
+    _cache[base] = _cache[base + 1];
+    _cache[base + 1] = *_cursor;
+    ++*_cursor;
+  }
+}
+
+// Computes the number of seek points of an animation of duration _duration.
+// Ratio 0 doesn't need any seek point.
+size_t CountSeekPoints(float _duration, float _interval) {
+  if (!(_interval > 0.f)) {
+    return 0;
+  }
+  size_t count = 0;
+  while ((count + 1) * _interval < _duration) {
+    ++count;
+  }
+  return count;
+}
+
+// Fills _animation seek points, once keyframes are sorted.
+void BuildSeekPoints(float _interval, float _inv_duration,
+                     const Animation& _animation, Range<float> _seek_ratios,
+                     Range<int> _seek_keys) {
+  const int num_tracks = _animation.num_soa_tracks() * 4;
+  const int num_frames = _animation.num_frames();
+  const int stride = _animation.seek_point_stride();
+  assert(_seek_keys.count() == _seek_ratios.count() * stride);
+
+  // Seek points are built incrementally, the state of the previous one being
+  // the starting point of the next.
+  ozz::Vector<int>::Std state(stride, 0);
+  int* cursors = &state[0];
+  int* translations = cursors + 3;
+  int* rotations = translations + num_tracks * 2;
+  int* scales = rotations + num_tracks * 2;
+  for (size_t i = 0; i < _seek_ratios.count(); ++i) {
+    const float ratio = (i + 1) * _interval * _inv_duration;
+    AdvanceSeekKeys(ratio, num_frames, num_tracks,
+                    _animation.num_constant_translations(),
+                    _animation.translations(),
+                    _animation.translation_times().begin, &cursors[0],
+                    translations);
+    AdvanceSeekKeys(ratio, num_frames, num_tracks,
+                    _animation.num_constant_rotations(),
+                    _animation.rotations(), _animation.rotation_times().begin,
+                    &cursors[1], rotations);
+    AdvanceSeekKeys(ratio, num_frames, num_tracks,
+                    _animation.num_constant_scales(), _animation.scales(),
+                    _animation.scale_times().begin, &cursors[2], scales);
+
+    _seek_ratios.begin[i] = ratio;
+    std::copy(state.begin(), state.end(), _seek_keys.begin + i * stride);
+  }
+}
+
+// Computes the number of bounds required to cover _duration with bounds of
+// _interval.
+size_t CountBounds(float _duration, float _interval) {
+  if (!(_interval > 0.f)) {
+    return 0;
+  }
+  size_t count = 1;
+  while (count * _interval < _duration) {
+    ++count;
+  }
+  return count;
+}
+
+// Appends _keys ratios to _ratios.
+template <typename _Key>
+void PushKeyRatios(const typename ozz::Vector<_Key>::Std& _keys,
+                   float _inv_duration, ozz::Vector<float>::Std* _ratios) {
+  for (size_t i = 0; i < _keys.size(); ++i) {
+    _ratios->push_back(_keys[i].time * _inv_duration);
+  }
+}
+
+// Fills _animation precomputed bounds, once _animation is built. Every bounds
+// interval is sampled at all _input keyframes ratios it contains, and at least
+// at kBoundsFrequency in between.
+void BuildBounds(const RawAnimation& _input, const Skeleton& _skeleton,
+                 const Animation& _animation, Range<math::Box> _bounds) {
+  const float kBoundsFrequency = 60.f;
+  const float duration = _input.duration;
+  const float inv_duration = 1.f / duration;
+
+  // Collects all key ratios, sorted.
+  ozz::Vector<float>::Std key_ratios;
+  for (size_t i = 0; i < _input.tracks.size(); ++i) {
+    const RawAnimation::JointTrack& track = _input.tracks[i];
+    PushKeyRatios<RawAnimation::TranslationKey>(track.translations,
+                                                inv_duration, &key_ratios);
+    PushKeyRatios<RawAnimation::RotationKey>(track.rotations, inv_duration,
+                                             &key_ratios);
+    PushKeyRatios<RawAnimation::ScaleKey>(track.scales, inv_duration,
+                                          &key_ratios);
+  }
+  std::sort(key_ratios.begin(), key_ratios.end());
+
+  // Sampling and local-to-model buffers.
+  SamplingCache cache(_animation.num_tracks(), _animation.spline()
+                                                   ? SamplingCache::kSpline
+                                                   : SamplingCache::kFull);
+  ozz::Vector<math::SoaTransform>::Std locals(_skeleton.num_soa_joints());
+  ozz::Vector<math::Float4x4>::Std models(_skeleton.num_joints());
+
+  SamplingJob sampling_job;
+  sampling_job.animation = &_animation;
+  sampling_job.cache = &cache;
+  sampling_job.output = make_range(locals);
+
+  LocalToModelJob ltm_job;
+  ltm_job.skeleton = &_skeleton;
+  ltm_job.input = make_range(locals);
+  ltm_job.output = make_range(models);
+
+  const size_t num_bounds = _bounds.count();
+  const float interval = 1.f / num_bounds;
+  const int steps = math::Max(
+      static_cast<int>(std::ceil(duration * interval * kBoundsFrequency)), 1);
+  ozz::Vector<float>::Std ratios;
+  ozz::Vector<float>::Std::const_iterator key = key_ratios.begin();
+  for (size_t i = 0; i < num_bounds; ++i) {
+    const float begin = i * interval;
+    const float end = (i + 1) * interval;
+
+    // Uniform samples, merged with key ratios that are inside the interval.
+    ratios.clear();
+    for (int s = 0; s <= steps; ++s) {
+      ratios.push_back(begin + (end - begin) * s / steps);
+    }
+    for (; key != key_ratios.end() && *key <= end; ++key) {
+      if (*key >= begin) {
+        ratios.push_back(*key);
+      }
+    }
+    std::sort(ratios.begin(), ratios.end());
+
+    math::Box& box = _bounds[i];
+    for (size_t r = 0; r < ratios.size(); ++r) {
+      sampling_job.ratio = ratios[r];
+      bool success = sampling_job.Run();
+      success &= ltm_job.Run();
+      (void)success;
+      assert(success);
+      for (size_t j = 0; j < models.size(); ++j) {
+        math::Float3 position;
+        math::Store3PtrU(models[j].cols[3], &position.x);
+        box = Merge(box, math::Box(position));
+      }
+    }
+  }
+}
+
+// Maximum distance (in frames) of a key time to the frame it's stored at, for
+// the frame count to be selected by FindNumFrames().
+const float kFrameTolerance = 1e-2f;
+
+// Number of multiples of the frame count deduced from the smallest interval
+// between keys that are tested by FindNumFrames().
+const int kMaxFrameMultiple = 16;
+
+// Maximum frame count selected by FindNumFrames(). Frames above kMaxFrames are
+// stored as float key times, which represent frame indices exactly up to 2^24.
+const float kMaxFloatFrames = 16777216.f;
+
+// Smallest interval between two consecutive keys, and the error of its
+// measurement from float key times.
+struct KeyInterval {
+  float interval;
+  float error;
+};
+
+// Updates _min with the interval between key times _begin and _end. Float key
+// times precision decreases as time grows, so an interval that matches _min
+// within their errors only replaces it if it's measured more precisely.
+void UpdateMinKeyInterval(float _begin, float _end, KeyInterval* _min) {
+  const float interval = _end - _begin;
+  if (!(interval > 0.f)) {
+    return;
+  }
+  const float error = _end * std::numeric_limits<float>::epsilon();
+  if (interval + error < _min->interval - _min->error ||
+      (interval - error < _min->interval + _min->error &&
+       error < _min->error)) {
+    _min->interval = interval;
+    _min->error = error;
+  }
+}
+
+// Updates _min with the smallest interval between two consecutive keys of
+// _keys, animation begin and end being implicit keys.
+template <typename _Track>
+void MinKeyInterval(const _Track& _keys, float _duration, KeyInterval* _min) {
+  float prev = 0.f;
+  for (size_t i = 0; i < _keys.size(); ++i) {
+    UpdateMinKeyInterval(prev, _keys[i].time, _min);
+    prev = _keys[i].time;
+  }
+  UpdateMinKeyInterval(prev, _duration, _min);
+}
+
+// Tests if all _keys times are close to a frame, _frame_rate being the number
+// of frames per second. Frames are computed in double precision, as float
+// frames can't measure kFrameTolerance above 2^17 frames.
+template <typename _Track>
+bool MatchFrames(const _Track& _keys, double _frame_rate) {
+  for (size_t i = 0; i < _keys.size(); ++i) {
+    const double frame = _keys[i].time * _frame_rate;
+    if (std::abs(frame - std::floor(frame + .5)) > kFrameTolerance) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Tests that no two consecutive keys of _keys are stored at the same frame,
+// see AnimationKeyTimes::Frame().
+template <typename _Track>
+bool DistinctFrames(const _Track& _keys,
+                    const internal::AnimationKeyTimes& _times) {
+  for (size_t i = 1; i < _keys.size(); ++i) {
+    if (_times.Frame(_keys[i].time) == _times.Frame(_keys[i - 1].time)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Tests that no two keys of any track of _input are stored at the same frame,
+// as one of them would be lost.
+bool DistinctFrames(const RawAnimation& _input,
+                    const internal::AnimationKeyTimes& _times) {
+  for (int i = 0; i < _input.num_tracks(); ++i) {
+    const RawAnimation::JointTrack& track = _input.tracks[i];
+    if (!DistinctFrames(track.translations, _times) ||
+        !DistinctFrames(track.rotations, _times) ||
+        !DistinctFrames(track.scales, _times)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Finds the number of frames key times are stored in, see
+// Animation::num_frames(). Clips sampled at a fixed rate have all their keys on
+// a grid whose step is a divisor of the smallest interval between keys, so the
+// frame counts matching this interval and its first divisors are tested, and
+// the smallest that matches all key times is selected. It can exceed
+// kMaxFrames for long clips. 0 is returned if none matches.
+int FindNumFrames(const RawAnimation& _input) {
+  const float duration = _input.duration;
+  KeyInterval interval = {duration,
+                          duration * std::numeric_limits<float>::epsilon()};
+  for (size_t i = 0; i < _input.tracks.size(); ++i) {
+    const RawAnimation::JointTrack& track = _input.tracks[i];
+    MinKeyInterval(track.translations, duration, &interval);
+    MinKeyInterval(track.rotations, duration, &interval);
+    MinKeyInterval(track.scales, duration, &interval);
+  }
+  const float base = duration / interval.interval;
+  for (int m = 1; m <= kMaxFrameMultiple; ++m) {
+    const float num_frames = std::floor(base * m + .5f);
+    if (num_frames > kMaxFloatFrames) {
+      break;
+    }
+    const double frame_rate = static_cast<double>(num_frames) / duration;
+    bool match = true;
+    for (size_t i = 0; match && i < _input.tracks.size(); ++i) {
+      const RawAnimation::JointTrack& track = _input.tracks[i];
+      match = MatchFrames(track.translations, frame_rate) &&
+              MatchFrames(track.rotations, frame_rate) &&
+              MatchFrames(track.scales, frame_rate);
+    }
+    if (match) {
+      return static_cast<int>(num_frames);
+    }
+  }
+  return 0;
+}
+
+// Fills _keyed with the soa joints (groups of 4 tracks) of _input that have at
+// least a key, padded with empty tracks, and _soa_joints with their indices.
+// See AnimationBuilder::sparse.
+void ExtractKeyedSoaJoints(const RawAnimation& _input, RawAnimation* _keyed,
+                           ozz::Vector<int>::Std* _soa_joints) {
+  _keyed->duration = _input.duration;
+  _keyed->name = _input.name;
+  _keyed->sync_markers = _input.sync_markers;
+  const int num_tracks = _input.num_tracks();
+  for (int soa = 0; soa < (num_tracks + 3) / 4; ++soa) {
+    const int begin = soa * 4;
+    const int end = math::Min(begin + 4, num_tracks);
+    bool keyed = false;
+    for (int i = begin; i < end && !keyed; ++i) {
+      const RawAnimation::JointTrack& track = _input.tracks[i];
+      keyed = !track.translations.empty() || !track.rotations.empty() ||
+              !track.scales.empty();
+    }
+    if (keyed) {
+      _soa_joints->push_back(soa);
+      _keyed->tracks.insert(_keyed->tracks.end(), _input.tracks.begin() + begin,
+                            _input.tracks.begin() + end);
+      _keyed->tracks.resize(_soa_joints->size() * 4);
+    }
   }
 }
 }  // namespace
 
+AnimationBuilderContext::AnimationBuilderContext() {
+  memory::ScopedAllocationTag tag(memory::kTagBuilder);
+  buffers_ =
+      memory::default_allocator()->New<internal::AnimationBuilderBuffers>();
+}
+
+AnimationBuilderContext::~AnimationBuilderContext() {
+  memory::default_allocator()->Delete(buffers_);
+}
+
+AnimationBuilder::AnimationBuilder()
+    : seek_interval(0.f),
+      spline(false),
+      sparse(false),
+      precision_lods(0),
+      precision_translation_tolerance(1e-3f),
+      precision_rotation_tolerance(1e-3f),
+      precision_scale_tolerance(1e-3f),
+      quantization_translation_tolerance(0.f),
+      quantization_scale_tolerance(0.f),
+      bounds_interval(0.f),
+      bounds_skeleton(NULL),
+      num_threads(0),
+      context(NULL) {}
+
 // Ensures _input's validity and allocates _animation.
 // An animation needs to have at least two key frames per joint, the first at
 // t = 0 and the last at t = duration. If at least one of those keys are not
-// in the RawAnimation then the builder creates it.
+// in the RawAnimation then the builder creates it. Tracks whose keys all have
+// the same value are finally collapsed to a single constant key.
 Animation* AnimationBuilder::operator()(const RawAnimation& _input) const {
-  // Tests _raw_animation validity.
-  if (!_input.Validate()) {
+  return (*this)(_input, memory::default_allocator());
+}
+
+Animation* AnimationBuilder::operator()(const RawAnimation& _input,
+                                        memory::Allocator* _allocator) const {
+  assert(_allocator && "Invalid allocator");
+  memory::ScopedAllocationTag tag(memory::kTagBuilder);
+
+  internal::AnimationKeyTimes times;
+  if (!Validate(_input, &times)) {
     return NULL;
   }
 
   // Everything is fine, allocates and fills the animation.
   // Nothing can fail now.
-  Animation* animation = memory::default_allocator()->New<Animation>();
+  Animation* animation = _allocator->New<Animation>(_allocator);
+  if (!animation) {
+    return NULL;
+  }
+  Build(_input, times, animation);
+  return animation;  // Success.
+}
+
+bool AnimationBuilder::operator()(const RawAnimation& _input,
+                                  Animation* _animation) const {
+  memory::ScopedAllocationTag tag(memory::kTagBuilder);
+
+  internal::AnimationKeyTimes times;
+  if (!_animation || !Validate(_input, &times)) {
+    return false;
+  }
+
+  // Replaces _animation content, reusing its buffer if it fits.
+  Build(_input, times, _animation);
+  return true;
+}
+
+bool AnimationBuilder::Validate(const RawAnimation& _input,
+                                internal::AnimationKeyTimes* _times) const {
+  // Tests _raw_animation validity.
+  if (!_input.Validate()) {
+    return false;
+  }
+
+  // Tests precision lods settings. Spline animations have no precision lod.
+  if (precision_lods < 0 || precision_lods >= Animation::kKeepKeyLod ||
+      (precision_lods > 0 && spline) ||
+      !(precision_translation_tolerance >= 0.f) ||
+      !(precision_rotation_tolerance >= 0.f) ||
+      !(precision_scale_tolerance >= 0.f)) {
+    return false;
+  }
+
+  // Tests quantization tolerances.
+  if (!(quantization_translation_tolerance >= 0.f) ||
+      !(quantization_scale_tolerance >= 0.f)) {
+    return false;
+  }
+
+  // Tests bounds skeleton validity. A skeleton is required to build bounds,
+  // and must match the animation if specified. Sparse animations have no
+  // bounds.
+  const size_t bounds_count = CountBounds(_input.duration, bounds_interval);
+  if (sparse && bounds_count > 0) {
+    return false;
+  }
+  if (bounds_skeleton ? bounds_skeleton->num_joints() != _input.num_tracks()
+                      : bounds_count != 0) {
+    return false;
+  }
+
+  // Selects key times storage. Key times are stored as frame indices if they
+  // match a frame rate whose frame count fits 16 bits, or if no two keys of a
+  // track share one of kMaxFrames frames. Long clips frame indices are stored
+  // as float key times, and key times that don't fit any frame count are
+  // stored as floats too. Building only fails if two keys of a track are too
+  // close to be distinguished by float times.
+  const int num_frames = FindNumFrames(_input);
+  internal::AnimationKeyTimes times = {_input.duration, num_frames,
+                                       num_frames > kMaxFrames, true};
+  if (num_frames == 0 || !DistinctFrames(_input, times)) {
+    times.num_frames = kMaxFrames;
+    times.floats = false;
+    if (!DistinctFrames(_input, times)) {
+      times.floats = true;
+      times.rounded = false;
+      if (!DistinctFrames(_input, times)) {
+        return false;
+      }
+    }
+  }
+  *_times = times;
+  return true;
+}
+
+void AnimationBuilder::Build(const RawAnimation& _input,
+                             const internal::AnimationKeyTimes& _times,
+                             Animation* _animation) const {
+  if (!sparse) {
+    BuildTracks(_input, NULL, _times, _animation);
+    return;
+  }
+
+  // Sparse animations are built from keyed soa joints only.
+  RawAnimation keyed;
+  ozz::Vector<int>::Std soa_joints;
+  ExtractKeyedSoaJoints(_input, &keyed, &soa_joints);
+  BuildTracks(keyed, make_range(soa_joints).begin, _times, _animation);
+}
+
+void AnimationBuilder::BuildTracks(const RawAnimation& _input,
+                                   const int* _soa_joints,
+                                   const internal::AnimationKeyTimes& _times,
+                                   Animation* _animation) const {
+  const size_t bounds_count = CountBounds(_input.duration, bounds_interval);
 
   // Sets duration.
   const float duration = _input.duration;
   const float inv_duration = 1.f / _input.duration;
-  animation->duration_ = duration;
+  _animation->duration_ = duration;
+  _animation->num_frames_ = _times.num_frames;
+  _animation->skeleton_fingerprint_ =
+      bounds_skeleton ? bounds_skeleton->fingerprint() : 0;
   // A _duration == 0 would create some division by 0 during sampling.
   // Also we need at least to keys with different times, which cannot be done
   // if duration is 0.
@@ -289,62 +1509,131 @@ Animation* AnimationBuilder::operator()(const RawAnimation& _input) const {
   // Sets tracks count. Can be safely casted to uint16_t as number of tracks as
   // already been validated.
   const uint16_t num_tracks = static_cast<uint16_t>(_input.num_tracks());
-  animation->num_tracks_ = num_tracks;
+  _animation->num_tracks_ = num_tracks;
   const uint16_t num_soa_tracks = math::Align(num_tracks, 4);
 
-  // Declares and preallocates tracks to sort.
-  size_t translations = 0, rotations = 0, scales = 0;
+  // Selects the number of worker threads. Small animations are built on the
+  // calling thread.
+  int num_workers = 1;
+  int sort_threads = 1;
+#ifdef OZZ_OFFLINE_THREADS
+  size_t num_keys = 0;
   for (int i = 0; i < num_tracks; ++i) {
     const RawAnimation::JointTrack& raw_track = _input.tracks[i];
-    translations += raw_track.translations.size() + 2;  // +2 because worst case
-    rotations += raw_track.rotations.size() + 2;        // needs to add the
-    scales += raw_track.scales.size() + 2;              // first and last keys.
+    num_keys += raw_track.translations.size() + raw_track.rotations.size() +
+                raw_track.scales.size();
   }
-  ozz::Vector<SortingTranslationKey>::Std sorting_translations;
-  sorting_translations.reserve(translations);
-  ozz::Vector<SortingRotationKey>::Std sorting_rotations;
-  sorting_rotations.reserve(rotations);
-  ozz::Vector<SortingScaleKey>::Std sorting_scales;
-  sorting_scales.reserve(scales);
-
-  // Filters RawAnimation keys and copies them to the output sorting structure.
-  uint16_t i = 0;
-  for (; i < num_tracks; ++i) {
-    const RawAnimation::JointTrack& raw_track = _input.tracks[i];
-    CopyRaw(raw_track.translations, i, duration, &sorting_translations);
-    CopyRaw(raw_track.rotations, i, duration, &sorting_rotations);
-    CopyRaw(raw_track.scales, i, duration, &sorting_scales);
+  if (num_keys >= kMinParallelBuildKeys) {
+    const int max_workers =
+        num_threads > 0
+            ? num_threads
+            : static_cast<int>(std::thread::hardware_concurrency());
+    num_workers = math::Min(max_workers, 3);
+    sort_threads = math::Max(max_workers / 3, 1);
   }
+#endif  // OZZ_OFFLINE_THREADS
 
-  // Add enough identity keys to match soa requirements.
-  for (; i < num_soa_tracks; ++i) {
-    typedef RawAnimation::TranslationKey SrcTKey;
-    PushBackIdentityKey<SrcTKey>(i, 0.f, &sorting_translations);
-    PushBackIdentityKey<SrcTKey>(i, duration, &sorting_translations);
+  // Sorting buffers are reused from the context if any.
+  internal::AnimationBuilderBuffers local_buffers;
+  KeyframesBuild build;
+  build.input = &_input;
+  build.num_soa_tracks = num_soa_tracks;
+  build.times = _times;
+  build.quantization_tolerances[0] = quantization_translation_tolerance;
+  build.quantization_tolerances[1] = quantization_scale_tolerance;
+  build.sort_threads = sort_threads;
+  build.buffers = context ? context->buffers_ : &local_buffers;
 
-    typedef RawAnimation::RotationKey SrcRKey;
-    PushBackIdentityKey<SrcRKey>(i, 0.f, &sorting_rotations);
-    PushBackIdentityKey<SrcRKey>(i, duration, &sorting_rotations);
+  // Filters RawAnimation keys and copies them to the sorting buffers.
+  RunChannels(PrepareChannel, &build, num_workers);
+  const internal::AnimationBuilderBuffers& buffers = *build.buffers;
 
-    typedef RawAnimation::ScaleKey SrcSKey;
-    PushBackIdentityKey<SrcSKey>(i, 0.f, &sorting_scales);
-    PushBackIdentityKey<SrcSKey>(i, duration, &sorting_scales);
+  // Allocate animation members.
+  const size_t seek_point_count = CountSeekPoints(duration, seek_interval);
+  bool steps = false;
+  for (int i = 0; i < num_tracks; ++i) {
+    steps |= _input.tracks[i].step;
   }
+  _animation->Allocate(
+      _input.name.length() + 1, buffers.translations.size(),
+      buffers.rotations.size(), buffers.scales.size(),
+      ValueBufferSize(buffers.translations.size(), build.value_bits[0]),
+      ValueBufferSize(buffers.scales.size(), build.value_bits[1]),
+      seek_point_count, _input.sync_markers.size(), bounds_count, spline,
+      steps, _soa_joints != NULL, precision_lods > 0, _times.floats);
+  _animation->num_constant_translations_ = build.num_constants[0];
+  _animation->num_constant_rotations_ = build.num_constants[1];
+  _animation->num_constant_scales_ = build.num_constants[2];
 
-  // Allocate animation members.
-  animation->Allocate(_input.name.length() + 1, sorting_translations.size(),
-                      sorting_rotations.size(), sorting_scales.size());
+  // Copy quantization ranges and sorted keys to final animation.
+  std::copy(buffers.translation_ranges.begin(),
+            buffers.translation_ranges.end(),
+            _animation->translation_ranges_.begin);
+  std::copy(buffers.scale_ranges.begin(), buffers.scale_ranges.end(),
+            _animation->scale_ranges_.begin);
+  build.translations = &_animation->translations_;
+  build.translation_ranges = &_animation->translation_ranges_;
+  build.translation_values = &_animation->translation_values_;
+  build.translation_value_offsets = &_animation->translation_value_offsets_;
+  build.translation_tangents = &_animation->translation_tangents_;
+  build.rotations = &_animation->rotations_;
+  build.rotation_tangents = &_animation->rotation_tangents_;
+  build.scales = &_animation->scales_;
+  build.scale_ranges = &_animation->scale_ranges_;
+  build.scale_values = &_animation->scale_values_;
+  build.scale_value_offsets = &_animation->scale_value_offsets_;
+  build.scale_tangents = &_animation->scale_tangents_;
+  build.translation_times = &_animation->translation_times_;
+  build.rotation_times = &_animation->rotation_times_;
+  build.scale_times = &_animation->scale_times_;
+  const float tolerances[3] = {precision_translation_tolerance,
+                               precision_rotation_tolerance,
+                               precision_scale_tolerance};
+  Range<uint8_t>* key_lods[3] = {&_animation->translation_key_lods_,
+                                 &_animation->rotation_key_lods_,
+                                 &_animation->scale_key_lods_};
+  Range<int>* lod_next[3] = {&_animation->translation_lod_next_,
+                             &_animation->rotation_lod_next_,
+                             &_animation->scale_lod_next_};
+  for (int i = 0; i < 3; ++i) {
+    const KeyLodsBuild lods = {precision_lods, tolerances[i],
+                               num_soa_tracks, key_lods[i], lod_next[i]};
+    build.lods[i] = lods;
+  }
+  RunChannels(CopyChannel, &build, num_workers);
 
-  // Copy sorted keys to final animation.
-  CopyToAnimation(&sorting_translations, &animation->translations_,
-                  inv_duration);
-  CopyToAnimation(&sorting_rotations, &animation->rotations_, inv_duration);
-  CopyToAnimation(&sorting_scales, &animation->scales_, inv_duration);
+  // Builds seek points from sorted keys.
+  BuildSeekPoints(seek_interval, inv_duration, *_animation,
+                  _animation->seek_ratios_, _animation->seek_keys_);
 
   // Copy animation's name.
-  strcpy(animation->name_, _input.name.c_str());
+  strcpy(_animation->name_, _input.name.c_str());
 
-  return animation;  // Success.
+  // Copy step tracks flags.
+  if (steps) {
+    std::memset(_animation->steps_.begin, 0, _animation->steps_.size());
+    for (int i = 0; i < num_tracks; ++i) {
+      if (_input.tracks[i].step) {
+        _animation->steps_.begin[i / 8] |= 1 << (i & 7);
+      }
+    }
+  }
+
+  // Copy sparse animation soa joints.
+  if (_soa_joints) {
+    std::copy(_soa_joints, _soa_joints + _animation->num_soa_tracks(),
+              _animation->soa_joints_.begin);
+  }
+
+  // Copy synchronization markers, as ratios.
+  for (size_t m = 0; m < _input.sync_markers.size(); ++m) {
+    _animation->sync_ratios_.begin[m] = _input.sync_markers[m] * inv_duration;
+  }
+
+  // Builds bounds, sampling the complete animation.
+  if (bounds_count > 0) {
+    BuildBounds(_input, *bounds_skeleton, *_animation, _animation->bounds_);
+  }
 }
 }  // namespace offline
 }  // namespace animation
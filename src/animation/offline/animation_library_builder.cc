@@ -0,0 +1,264 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#include "ozz/animation/offline/animation_library_builder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/raw_animation_utils.h"
+#include "ozz/animation/runtime/animation_library.h"
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/maths/math_constant.h"
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/memory/allocator.h"
+
+namespace ozz {
+namespace animation {
+namespace offline {
+
+AnimationLibraryBuilder::AnimationLibraryBuilder()
+    : translation_tolerance(1e-3f),                 // 1 mm.
+      rotation_tolerance(.1f * math::kPi / 180.f),  // 0.1 degree.
+      scale_tolerance(1e-3f) {}                     // 0.1%.
+
+namespace {
+// Compares key time to a time, to search keys.
+template <typename _Key>
+bool RawKeyTimeLess(float _time, const _Key& _key) {
+  return _time < _key.time;
+}
+
+// Samples sorted _keys at _time, clamping to the first and last keys.
+template <typename _Key, typename _Lerp>
+typename _Key::Value SampleChannelKeys(
+    const typename ozz::Vector<_Key>::Std& _keys, float _time, _Lerp _lerp) {
+  if (_keys.empty()) {
+    return _Key::identity();
+  }
+  const size_t right = std::upper_bound(_keys.begin(), _keys.end(), _time,
+                                        RawKeyTimeLess<_Key>) -
+                       _keys.begin();
+  if (right == 0) {
+    return _keys.front().value;
+  } else if (right == _keys.size()) {
+    return _keys.back().value;
+  }
+  const _Key& left = _keys[right - 1];
+  const float alpha = (_time - left.time) / (_keys[right].time - left.time);
+  return _lerp(left.value, _keys[right].value, alpha);
+}
+
+float Float3Error(const math::Float3& _a, const math::Float3& _b) {
+  return Length(_a - _b);
+}
+
+float RotationError(const math::Quaternion& _a, const math::Quaternion& _b) {
+  const float dot = _a.x * _b.x + _a.y * _b.y + _a.z * _b.z + _a.w * _b.w;
+  return 2.f * std::acos(math::Min(std::abs(dot), 1.f));
+}
+
+// Tells if _channel values never differ from _shared ones by more than
+// _tolerance, in the range [0,_duration] sampled by _channel clip.
+template <typename _Key, typename _Lerp, typename _Error>
+bool Matches(const typename ozz::Vector<_Key>::Std& _channel,
+             const typename ozz::Vector<_Key>::Std& _shared, float _duration,
+             _Lerp _lerp, _Error _error, float _tolerance) {
+  // Both channels are piecewise linear, so their biggest difference is at one
+  // of their keys, or at range boundaries.
+  ozz::Vector<float>::Std times;
+  times.push_back(0.f);
+  times.push_back(_duration);
+  for (size_t i = 0; i < _channel.size(); ++i) {
+    times.push_back(_channel[i].time);
+  }
+  for (size_t i = 0; i < _shared.size() && _shared[i].time < _duration; ++i) {
+    times.push_back(_shared[i].time);
+  }
+  for (size_t i = 0; i < times.size(); ++i) {
+    if (_error(SampleChannelKeys<_Key>(_channel, times[i], _lerp),
+               SampleChannelKeys<_Key>(_shared, times[i], _lerp)) >
+        _tolerance) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Finds the channel of _pool that matches _channel, or adds _channel to the
+// pool. Returns the index of the channel in the pool.
+template <typename _Key, typename _Lerp, typename _Error>
+uint32_t FindOrAdd(
+    const typename ozz::Vector<_Key>::Std& _channel, float _duration,
+    _Lerp _lerp, _Error _error, float _tolerance,
+    typename ozz::Vector<const typename ozz::Vector<_Key>::Std*>::Std* _pool) {
+  for (size_t i = 0; i < _pool->size(); ++i) {
+    if (Matches<_Key>(_channel, *(*_pool)[i], _duration, _lerp, _error,
+                      _tolerance)) {
+      return static_cast<uint32_t>(i);
+    }
+  }
+  _pool->push_back(&_channel);
+  return static_cast<uint32_t>(_pool->size() - 1);
+}
+
+// Copies _pool channels keys to _channels and _keys.
+template <typename _Key, typename _LibraryKey>
+void CopyChannels(
+    const typename ozz::Vector<const typename ozz::Vector<_Key>::Std*>::Std&
+        _pool,
+    const Range<LibraryChannel>& _channels, const Range<_LibraryKey>& _keys) {
+  uint32_t first_key = 0;
+  for (size_t i = 0; i < _pool.size(); ++i) {
+    const typename ozz::Vector<_Key>::Std& raw_keys = *_pool[i];
+    LibraryChannel& channel = _channels[i];
+    channel.first_key = first_key;
+    channel.num_keys = static_cast<uint32_t>(raw_keys.size());
+    for (size_t k = 0; k < raw_keys.size(); ++k) {
+      _LibraryKey& key = _keys[first_key + k];
+      key.time = raw_keys[k].time;
+      std::memcpy(key.value, &raw_keys[k].value, sizeof(key.value));
+    }
+    first_key += channel.num_keys;
+  }
+}
+
+// Counts the number of keys of _pool channels.
+template <typename _Key>
+size_t CountKeys(
+    const typename ozz::Vector<const typename ozz::Vector<_Key>::Std*>::Std&
+        _pool) {
+  size_t count = 0;
+  for (size_t i = 0; i < _pool.size(); ++i) {
+    count += _pool[i]->size();
+  }
+  return count;
+}
+}  // namespace
+
+AnimationLibrary* AnimationLibraryBuilder::operator()(
+    const Range<const RawAnimation>& _clips) const {
+  // Tests parameters and raw animations validity.
+  if (!(translation_tolerance >= 0.f) || !(rotation_tolerance >= 0.f) ||
+      !(scale_tolerance >= 0.f)) {
+    return NULL;
+  }
+  size_t num_tracks = 0;
+  size_t names_size = 0;
+  for (const RawAnimation* clip = _clips.begin; clip < _clips.end; ++clip) {
+    if (!clip->Validate()) {
+      return NULL;
+    }
+    num_tracks += clip->tracks.size();
+    names_size += clip->name.size() + 1;
+  }
+
+  // Deduplicates all tracks channels.
+  typedef RawAnimation::JointTrack JointTrack;
+  ozz::Vector<const JointTrack::Translations*>::Std translations;
+  ozz::Vector<const JointTrack::Rotations*>::Std rotations;
+  ozz::Vector<const JointTrack::Scales*>::Std scales;
+  ozz::Vector<uint32_t>::Std channels;
+  channels.reserve(num_tracks * 3);
+  for (const RawAnimation* clip = _clips.begin; clip < _clips.end; ++clip) {
+    for (size_t i = 0; i < clip->tracks.size(); ++i) {
+      const JointTrack& track = clip->tracks[i];
+      channels.push_back(FindOrAdd<RawAnimation::TranslationKey>(
+          track.translations, clip->duration, LerpTranslation, Float3Error,
+          translation_tolerance, &translations));
+      channels.push_back(FindOrAdd<RawAnimation::RotationKey>(
+          track.rotations, clip->duration, LerpRotation, RotationError,
+          rotation_tolerance, &rotations));
+      channels.push_back(FindOrAdd<RawAnimation::ScaleKey>(
+          track.scales, clip->duration, LerpScale, Float3Error,
+          scale_tolerance, &scales));
+    }
+  }
+
+  AnimationLibrary* library =
+      memory::default_allocator()->New<AnimationLibrary>();
+  if (_clips.count() == 0) {
+    return library;
+  }
+  library->Allocate(
+      _clips.count(), channels.size(), translations.size(), rotations.size(),
+      scales.size(), CountKeys<RawAnimation::TranslationKey>(translations),
+      CountKeys<RawAnimation::RotationKey>(rotations),
+      CountKeys<RawAnimation::ScaleKey>(scales), names_size);
+
+  // Fills clips and names.
+  uint32_t first_track = 0;
+  uint32_t name = 0;
+  for (size_t i = 0; i < _clips.count(); ++i) {
+    const RawAnimation& clip = _clips[i];
+    LibraryClip& desc = library->clips_[i];
+    desc.duration = clip.duration;
+    desc.num_tracks = clip.num_tracks();
+    desc.first_track = first_track;
+    desc.name = name;
+    std::strcpy(library->names_.begin + name, clip.name.c_str());
+    first_track += desc.num_tracks;
+    name += static_cast<uint32_t>(clip.name.size() + 1);
+  }
+  if (!channels.empty()) {
+    std::memcpy(library->channels_.begin, &channels[0],
+                library->channels_.size());
+  }
+
+  // Fills channels and keys.
+  CopyChannels<RawAnimation::TranslationKey>(
+      translations, library->translations_, library->translation_keys_);
+  CopyChannels<RawAnimation::RotationKey>(rotations, library->rotations_,
+                                          library->rotation_keys_);
+  CopyChannels<RawAnimation::ScaleKey>(scales, library->scales_,
+                                       library->scale_keys_);
+
+  // Keeps consecutive rotation keys in the same hemisphere, so that the
+  // runtime nlerp takes the shortest path.
+  for (LibraryChannel* channel = library->rotations_.begin;
+       channel < library->rotations_.end; ++channel) {
+    LibraryQuaternionKey* keys =
+        library->rotation_keys_.begin + channel->first_key;
+    for (uint32_t k = 1; k < channel->num_keys; ++k) {
+      const float* a = keys[k - 1].value;
+      float* b = keys[k].value;
+      if (a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3] < 0.f) {
+        for (int c = 0; c < 4; ++c) {
+          b[c] = -b[c];
+        }
+      }
+    }
+  }
+
+  return library;  // Success.
+}
+}  // namespace offline
+}  // namespace animation
+}  // namespace ozz
@@ -27,11 +27,22 @@
 
 #include "ozz/animation/offline/animation_optimizer.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cstddef>
+#include <new>
+
+#ifdef OZZ_OFFLINE_THREADS
+#include <atomic>
+#include <functional>
+#include <thread>
+#endif  // OZZ_OFFLINE_THREADS
 
 #include "ozz/base/maths/math_constant.h"
 #include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/transform.h"
+#include "ozz/base/memory/allocator.h"
 
 #include "ozz/animation/offline/raw_animation.h"
 #include "ozz/animation/offline/raw_animation_utils.h"
@@ -48,7 +59,22 @@ AnimationOptimizer::AnimationOptimizer()
     : translation_tolerance(1e-3f),                 // 1 mm.
       rotation_tolerance(.1f * math::kPi / 180.f),  // 0.1 degree.
       scale_tolerance(1e-3f),                       // 0.1%.
-      hierarchical_tolerance(1e-3f) {               // 1 mm.
+      hierarchical_tolerance(1e-3f),                // 1 mm.
+      spline(false),
+      window_size(0),
+      num_threads(0),
+      model_space(false),
+      model_space_tolerance(1e-3f),  // 1 mm.
+      skinning_distance(1e-1f) {     // 10 cm.
+}
+
+AnimationOptimizer::JointSetting::JointSetting() {
+  const AnimationOptimizer defaults;
+  translation_tolerance = defaults.translation_tolerance;
+  rotation_tolerance = defaults.rotation_tolerance;
+  scale_tolerance = defaults.scale_tolerance;
+  hierarchical_tolerance = defaults.hierarchical_tolerance;
+  model_space_tolerance = defaults.model_space_tolerance;
 }
 
 namespace {
@@ -132,11 +158,13 @@ struct HierarchyBuilder {
   const RawAnimation* animation;
 };
 
-// Copy _src keys to _dest but except the ones that can be interpolated.
+// Copy _src keys to _dest but except the ones that can be interpolated. At
+// most _window consecutive keys are interpolated, see
+// AnimationOptimizer::window_size.
 template <typename _RawTrack, typename _Comparator, typename _Lerp>
 void Filter(const _RawTrack& _src, const _Comparator& _comparator,
             const _Lerp& _lerp, float _tolerance, float _hierarchical_tolerance,
-            float _hierarchy_length, _RawTrack* _dest) {
+            float _hierarchy_length, size_t _window, _RawTrack* _dest) {
   _dest->reserve(_src.size());
 
   // Only copies the key that cannot be interpolated from the others.
@@ -155,6 +183,11 @@ void Filter(const _RawTrack& _src, const _Comparator& _comparator,
         _dest->push_back(right);
         last_src_pushed = i;
       }
+    } else if (i - last_src_pushed > _window) {
+      // Window is full, so i key is pushed without testing. Keys in range
+      // ]last_src_pushed,i[ were already validated against it.
+      _dest->push_back(_src[i]);
+      last_src_pushed = i;
     } else {
       // Only inserts i key if keys in range ]last_src_pushed,i] cannot be
       // interpolated from keys last_src_pushed and i + 1.
@@ -177,6 +210,115 @@ void Filter(const _RawTrack& _src, const _Comparator& _comparator,
   assert(_dest->size() <= _src.size());
 }
 
+// Interpolates step track keys: _a value is held until _b key time.
+template <typename _Value>
+_Value HoldKey(const _Value& _a, const _Value& _b, float _alpha) {
+  return _alpha < 1.f ? _a : _b;
+}
+
+// Brings _value to the same hemisphere as _reference. Only quaternions need
+// it.
+math::Float3 Align(const math::Float3& _value, const math::Float3&) {
+  return _value;
+}
+
+math::Quaternion Align(const math::Quaternion& _value,
+                       const math::Quaternion& _reference) {
+  const float dot = _value.x * _reference.x + _value.y * _reference.y +
+                    _value.z * _reference.z + _value.w * _reference.w;
+  return dot < 0.f ? -_value : _value;
+}
+
+// Computes the tangent of a _curr value from its _prev and _next neighbors,
+// the way AnimationBuilder does. Neighbor slopes are weighted by the opposite
+// time interval, and a null interval means there's no neighbor on this side.
+template <typename _Value>
+_Value SplineTangent(const _Value& _prev, float _prev_time,
+                     const _Value& _curr, float _curr_time,
+                     const _Value& _next, float _next_time) {
+  const float prev_span = _curr_time - _prev_time;
+  const float next_span = _next_time - _curr_time;
+  if (prev_span <= 0.f) {
+    return (_next + _curr * -1.f) * (1.f / next_span);
+  } else if (next_span <= 0.f) {
+    return (_curr + _prev * -1.f) * (1.f / prev_span);
+  }
+  const _Value prev_slope = (_curr + _prev * -1.f) * (1.f / prev_span);
+  const _Value next_slope = (_next + _curr * -1.f) * (1.f / next_span);
+  return (prev_slope * next_span + next_slope * prev_span) *
+         (1.f / (prev_span + next_span));
+}
+
+// Spline version of Filter(), see AnimationOptimizer::spline. Keys tangents
+// are estimated from the candidate neighbors: the last pushed key, and the
+// keys following the tested interval.
+template <typename _RawTrack, typename _Comparator, typename _Hermite>
+void FilterSpline(const _RawTrack& _src, const _Comparator& _comparator,
+                  const _Hermite& _hermite, float _tolerance,
+                  float _hierarchical_tolerance, float _hierarchy_length,
+                  size_t _window, _RawTrack* _dest) {
+  typedef typename _RawTrack::value_type Key;
+  typedef typename Key::Value Value;
+  _dest->reserve(_src.size());
+
+  // Only copies the key that cannot be interpolated from the others.
+  size_t last_src_pushed = 0;  // Index (in src) of the last pushed key.
+  for (size_t i = 0; i < _src.size(); ++i) {
+    // First and last keys are always pushed.
+    if (i == 0) {
+      _dest->push_back(_src[i]);
+      last_src_pushed = i;
+    } else if (i == _src.size() - 1) {
+      // Don't push the last value if it's the same as last_src_pushed.
+      const Key& left = _src[last_src_pushed];
+      const Key& right = _src[i];
+      if (!_comparator(left.value, right.value, _tolerance,
+                       _hierarchical_tolerance, _hierarchy_length)) {
+        _dest->push_back(right);
+        last_src_pushed = i;
+      }
+    } else if (i - last_src_pushed > _window) {
+      // Window is full, so i key is pushed without testing. Keys in range
+      // ]last_src_pushed,i[ were already validated against it.
+      _dest->push_back(_src[i]);
+      last_src_pushed = i;
+    } else {
+      // Only inserts i key if keys in range ]last_src_pushed,i] cannot be
+      // interpolated from keys last_src_pushed and i + 1.
+      const Key& left = _src[last_src_pushed];
+      const Key& right = _src[i + 1];
+      const Key& prev = _dest->size() > 1 ? (*_dest)[_dest->size() - 2] : left;
+      const Key& next = i + 2 < _src.size() ? _src[i + 2] : right;
+      const float span = right.time - left.time;
+      const Value prev_value = Align(prev.value, left.value);
+      const Value right_value = Align(right.value, left.value);
+      const Value next_value = Align(next.value, right_value);
+      const Value left_tangent =
+          SplineTangent(prev_value, prev.time, left.value, left.time,
+                        right_value, right.time) *
+          span;
+      const Value right_tangent =
+          SplineTangent(left.value, left.time, right_value, right.time,
+                        next_value, next.time) *
+          span;
+      for (size_t j = last_src_pushed + 1; j <= i; ++j) {
+        const Key& test = _src[j];
+        const float alpha = (test.time - left.time) / span;
+        assert(alpha >= 0.f && alpha <= 1.f);
+        if (!_comparator(_hermite(left.value, left_tangent, right_value,
+                                  right_tangent, alpha),
+                         test.value, _tolerance, _hierarchical_tolerance,
+                         _hierarchy_length)) {
+          _dest->push_back(_src[i]);
+          last_src_pushed = i;
+          break;
+        }
+      }
+    }
+  }
+  assert(_dest->size() <= _src.size());
+}
+
 // Translation filtering comparator.
 bool CompareTranslation(const math::Float3& _a, const math::Float3& _b,
                         float _tolerance, float _hierarchical_tolerance,
@@ -218,11 +360,405 @@ bool CompareScale(const math::Float3& _a, const math::Float3& _b,
   const math::Float3 l(_hierarchy_length);
   return Compare(_a * l, _b * l, _hierarchical_tolerance);
 }
-}  // namespace
 
-bool AnimationOptimizer::operator()(const RawAnimation& _input,
-                                    const Skeleton& _skeleton,
-                                    RawAnimation* _output) const {
+// Computes tolerances of every joint of _skeleton, from _optimizer global
+// tolerances and joints_setting_override. Hierarchical tolerance of a joint is
+// lowered to the lowest of its hierarchy.
+// Returns false if an override references an invalid joint.
+bool BuildJointSettings(
+    const AnimationOptimizer& _optimizer, const Skeleton& _skeleton,
+    ozz::Vector<AnimationOptimizer::JointSetting>::Std* _settings) {
+  AnimationOptimizer::JointSetting global;
+  global.translation_tolerance = _optimizer.translation_tolerance;
+  global.rotation_tolerance = _optimizer.rotation_tolerance;
+  global.scale_tolerance = _optimizer.scale_tolerance;
+  global.hierarchical_tolerance = _optimizer.hierarchical_tolerance;
+  global.model_space_tolerance = _optimizer.model_space_tolerance;
+
+  const int num_joints = _skeleton.num_joints();
+  _settings->assign(num_joints, global);
+  for (AnimationOptimizer::JointsSetting::const_iterator it =
+           _optimizer.joints_setting_override.begin();
+       it != _optimizer.joints_setting_override.end(); ++it) {
+    if (it->first < 0 || it->first >= num_joints) {
+      return false;
+    }
+    (*_settings)[it->first] = it->second;
+  }
+
+  // Joints are stored in depth-first order, so children come after their
+  // parent.
+  const Range<const int16_t>& parents = _skeleton.joint_parents();
+  for (int i = num_joints - 1; i >= 0; --i) {
+    const int parent = parents[i];
+    if (parent != Skeleton::kNoParent) {
+      float& tolerance = (*_settings)[parent].hierarchical_tolerance;
+      tolerance =
+          math::Min(tolerance, (*_settings)[i].hierarchical_tolerance);
+    }
+  }
+  return true;
+}
+
+// Converts AnimationOptimizer::window_size to a number of keys, 0 meaning
+// unlimited.
+size_t WindowSize(int _window_size) {
+  return _window_size > 0 ? static_cast<size_t>(_window_size)
+                          : ~static_cast<size_t>(0);
+}
+
+// Shared state of the optimization of every channel of an animation.
+struct OptimizationContext {
+  const AnimationOptimizer* optimizer;
+  const RawAnimation* input;
+  const Skeleton* skeleton;
+  const HierarchyBuilder* specs;
+  const AnimationOptimizer::JointSetting* settings;
+  RawAnimation* output;
+};
+
+// Optimizes channel _channel % 3 (translation, rotation, scale) of track
+// _channel / 3. Channels only write to their own output track, so they can be
+// optimized concurrently.
+void OptimizeChannel(const OptimizationContext& _context, size_t _channel) {
+  const AnimationOptimizer& optimizer = *_context.optimizer;
+  const size_t track = _channel / 3;
+  const RawAnimation::JointTrack& input_track = _context.input->tracks[track];
+  RawAnimation::JointTrack& output_track = _context.output->tracks[track];
+
+  const float hierarchical_length = _context.specs->lengths[track];
+  const int parent = _context.skeleton->joint_parents()[track];
+  const float hierarchical_scale =
+      (parent != Skeleton::kNoParent) ? _context.specs->scales[parent] : 1.f;
+  const size_t window = WindowSize(optimizer.window_size);
+  const AnimationOptimizer::JointSetting& setting = _context.settings[track];
+
+  switch (_channel % 3) {
+    case 0:
+      if (input_track.step) {
+        // Step keys are held, so they're never interpolated with splines.
+        Filter(input_track.translations, CompareTranslation,
+               HoldKey<math::Float3>, setting.translation_tolerance,
+               setting.hierarchical_tolerance, hierarchical_scale, window,
+               &output_track.translations);
+      } else if (optimizer.spline) {
+        FilterSpline(input_track.translations, CompareTranslation,
+                     HermiteTranslation, setting.translation_tolerance,
+                     setting.hierarchical_tolerance, hierarchical_scale,
+                     window, &output_track.translations);
+      } else {
+        Filter(input_track.translations, CompareTranslation, LerpTranslation,
+               setting.translation_tolerance,
+               setting.hierarchical_tolerance, hierarchical_scale, window,
+               &output_track.translations);
+      }
+      break;
+    case 1:
+      if (input_track.step) {
+        Filter(input_track.rotations, CompareRotation,
+               HoldKey<math::Quaternion>, setting.rotation_tolerance,
+               setting.hierarchical_tolerance, hierarchical_length, window,
+               &output_track.rotations);
+      } else if (optimizer.spline) {
+        FilterSpline(input_track.rotations, CompareRotation, HermiteRotation,
+                     setting.rotation_tolerance,
+                     setting.hierarchical_tolerance, hierarchical_length,
+                     window, &output_track.rotations);
+      } else {
+        Filter(input_track.rotations, CompareRotation, LerpRotation,
+               setting.rotation_tolerance, setting.hierarchical_tolerance,
+               hierarchical_length, window, &output_track.rotations);
+      }
+      break;
+    default:
+      if (input_track.step) {
+        Filter(input_track.scales, CompareScale, HoldKey<math::Float3>,
+               setting.scale_tolerance, setting.hierarchical_tolerance,
+               hierarchical_length, window, &output_track.scales);
+      } else if (optimizer.spline) {
+        FilterSpline(input_track.scales, CompareScale, HermiteScale,
+                     setting.scale_tolerance,
+                     setting.hierarchical_tolerance, hierarchical_length,
+                     window, &output_track.scales);
+      } else {
+        Filter(input_track.scales, CompareScale, LerpScale,
+               setting.scale_tolerance, setting.hierarchical_tolerance,
+               hierarchical_length, window, &output_track.scales);
+      }
+      break;
+  }
+}
+
+// Greedy key reduction driven by model-space error, see
+// AnimationOptimizer::model_space. Animation is sampled at every input key
+// time. Current local and model-space transforms of every sample are
+// maintained as keys are removed, so that each key removal is only evaluated
+// on the samples and joints it affects.
+class ModelSpaceReducer {
+ public:
+  ModelSpaceReducer(const RawAnimation& _input, const Skeleton& _skeleton,
+                    const AnimationOptimizer::JointSetting* _settings,
+                    float _distance, size_t _window, RawAnimation* _output)
+      : skeleton_(_skeleton),
+        num_joints_(_skeleton.num_joints()),
+        num_points_(_distance > 0.f ? 4 : 1),
+        window_(_window),
+        output_(_output) {
+    // Per joint squared tolerances.
+    tolerances_sq_.resize(num_joints_);
+    for (int i = 0; i < num_joints_; ++i) {
+      const float tolerance = _settings[i].model_space_tolerance;
+      tolerances_sq_[i] = tolerance * tolerance;
+    }
+
+    // Virtual skinning points, in joint local-space.
+    points_[0] = math::simd_float4::zero();
+    points_[1] = math::simd_float4::Load(_distance, 0.f, 0.f, 0.f);
+    points_[2] = math::simd_float4::Load(0.f, _distance, 0.f, 0.f);
+    points_[3] = math::simd_float4::Load(0.f, 0.f, _distance, 0.f);
+
+    // Collects all key times, sorted and unique.
+    for (int i = 0; i < num_joints_; ++i) {
+      const RawAnimation::JointTrack& track = _input.tracks[i];
+      PushTimes(track.translations);
+      PushTimes(track.rotations);
+      PushTimes(track.scales);
+    }
+    std::sort(times_.begin(), times_.end());
+    times_.erase(std::unique(times_.begin(), times_.end()), times_.end());
+
+    // Samples input animation local-space transforms.
+    const size_t num_samples = times_.size();
+    locals_.resize(num_samples * num_joints_);
+    if (!locals_.empty()) {
+      const bool sampled =
+          SampleRawAnimation(_input, make_range(times_), make_range(locals_));
+      (void)sampled;
+      assert(sampled);
+    }
+
+    // Computes reference model-space transforms and points.
+    local_models_.resize(num_samples * num_joints_);
+    models_.resize(num_samples * num_joints_);
+    reference_.resize(num_samples * num_joints_ * num_points_);
+    scratch_.resize(num_joints_);
+    for (size_t s = 0; s < num_samples; ++s) {
+      for (int i = 0; i < num_joints_; ++i) {
+        const int parent = skeleton_.joint_parents()[i];
+        const math::Float4x4& local = local_models_[s * num_joints_ + i] =
+            ToMatrix(locals_[s * num_joints_ + i]);
+        math::Float4x4& model = models_[s * num_joints_ + i];
+        model = parent == Skeleton::kNoParent
+                    ? local
+                    : models_[s * num_joints_ + parent] * local;
+        for (int p = 0; p < num_points_; ++p) {
+          math::Store3PtrU(
+              TransformPoint(model, points_[p]),
+              &reference_[(s * num_joints_ + i) * num_points_ + p].x);
+        }
+      }
+    }
+  }
+
+  // Reduces all tracks, from the root to the leaves.
+  void Run() {
+    for (int i = 0; i < num_joints_ * 3; ++i) {
+      ReduceChannel(i);
+    }
+  }
+
+  // Reduces channel _channel % 3 (translation, rotation, scale) of joint
+  // _channel / 3. Channels must be reduced in order, as each key removal
+  // accounts for the error introduced by previous channels.
+  void ReduceChannel(int _channel) {
+    const int joint = _channel / 3;
+    RawAnimation::JointTrack& track = output_->tracks[joint];
+    switch (_channel % 3) {
+      case 0:
+        Reduce(joint, &track.translations,
+               track.step ? HoldKey<math::Float3> : LerpTranslation,
+               &math::Transform::translation);
+        break;
+      case 1:
+        Reduce(joint, &track.rotations,
+               track.step ? HoldKey<math::Quaternion> : LerpRotation,
+               &math::Transform::rotation);
+        break;
+      default:
+        Reduce(joint, &track.scales,
+               track.step ? HoldKey<math::Float3> : LerpScale,
+               &math::Transform::scale);
+        break;
+    }
+  }
+
+ private:
+  template <typename _Track>
+  void PushTimes(const _Track& _keys) {
+    for (size_t k = 0; k < _keys.size(); ++k) {
+      times_.push_back(_keys[k].time);
+    }
+  }
+
+  // Greedily removes _joint keys, as long as the resulting model-space error
+  // remains within tolerance. At least one key is kept, and at most window_
+  // consecutive keys are removed.
+  template <typename _Track, typename _Value>
+  void Reduce(int _joint, _Track* _keys,
+              _Value (*_lerp)(const _Value&, const _Value&, float),
+              _Value math::Transform::*_member) {
+    size_t removed = 0;  // Number of consecutive removed keys.
+    for (size_t k = 0; _keys->size() > 1 && k < _keys->size();) {
+      if (removed >= window_) {
+        removed = 0;
+        ++k;
+        continue;
+      }
+
+      // Removing key k only affects samples strictly in between its
+      // neighbors.
+      const bool has_prev = k > 0;
+      const bool has_next = k + 1 < _keys->size();
+      const float prev_time = has_prev ? (*_keys)[k - 1].time : 0.f;
+      const float next_time = has_next ? (*_keys)[k + 1].time : 0.f;
+      const size_t begin =
+          has_prev
+              ? std::upper_bound(times_.begin(), times_.end(), prev_time) -
+                    times_.begin()
+              : 0;
+      const size_t end =
+          has_next ? std::lower_bound(times_.begin(), times_.end(), next_time) -
+                         times_.begin()
+                   : times_.size();
+
+      // Tests all samples first, then commits if they're all within
+      // tolerance.
+      bool removable = true;
+      for (int pass = 0; pass < 2 && removable; ++pass) {
+        for (size_t s = begin; s < end && removable; ++s) {
+          _Value value;
+          if (!has_prev) {
+            value = (*_keys)[k + 1].value;
+          } else if (!has_next) {
+            value = (*_keys)[k - 1].value;
+          } else {
+            const float alpha =
+                (times_[s] - prev_time) / (next_time - prev_time);
+            value =
+                _lerp((*_keys)[k - 1].value, (*_keys)[k + 1].value, alpha);
+          }
+          math::Transform local = locals_[s * num_joints_ + _joint];
+          local.*_member = value;
+          removable = Evaluate(_joint, s, local, pass == 1);
+        }
+      }
+      if (removable) {
+        _keys->erase(_keys->begin() + k);
+        ++removed;
+      } else {
+        removed = 0;
+        ++k;
+      }
+    }
+  }
+
+  // Computes model-space transforms of _joint hierarchy at _sample, using
+  // _local as _joint local-space transform. Returns false if a point of the
+  // hierarchy exceeds tolerance. Current transforms are updated if _commit is
+  // true.
+  bool Evaluate(int _joint, size_t _sample, const math::Transform& _local,
+                bool _commit) {
+    const int end = skeleton_.joint_subtree_ends()[_joint];
+    const math::Float4x4* local_models = &local_models_[_sample * num_joints_];
+    math::Float4x4* models = &models_[_sample * num_joints_];
+    const math::Float4x4 joint_local = ToMatrix(_local);
+    for (int i = _joint; i < end; ++i) {
+      const math::Float4x4& local = i == _joint ? joint_local : local_models[i];
+      const int parent = skeleton_.joint_parents()[i];
+      math::Float4x4& model = scratch_[i - _joint];
+      if (parent == Skeleton::kNoParent) {
+        model = local;
+      } else if (parent < _joint) {
+        model = models[parent] * local;
+      } else {
+        model = scratch_[parent - _joint] * local;
+      }
+      const math::Float3* reference =
+          &reference_[(_sample * num_joints_ + i) * num_points_];
+      for (int p = 0; p < num_points_; ++p) {
+        const math::SimdFloat4 diff =
+            TransformPoint(model, points_[p]) -
+            math::simd_float4::Load3PtrU(&reference[p].x);
+        if (math::GetX(math::Length3Sqr(diff)) > tolerances_sq_[i]) {
+          return false;
+        }
+      }
+    }
+    if (_commit) {
+      locals_[_sample * num_joints_ + _joint] = _local;
+      local_models_[_sample * num_joints_ + _joint] = joint_local;
+      std::copy(scratch_.begin(), scratch_.begin() + (end - _joint),
+                models + _joint);
+    }
+    return true;
+  }
+
+  static math::Float4x4 ToMatrix(const math::Transform& _transform) {
+    return math::Float4x4::FromAffine(
+        math::simd_float4::Load3PtrU(&_transform.translation.x),
+        math::simd_float4::LoadPtrU(&_transform.rotation.x),
+        math::simd_float4::Load3PtrU(&_transform.scale.x));
+  }
+
+  const Skeleton& skeleton_;
+  const int num_joints_;
+  const int num_points_;
+  const size_t window_;
+  RawAnimation* output_;
+  math::SimdFloat4 points_[4];
+
+  // Squared model-space tolerance per joint.
+  ozz::Vector<float>::Std tolerances_sq_;
+
+  // Sorted sample times.
+  ozz::Vector<float>::Std times_;
+
+  // Current local-space transforms, as well as their matrices, and
+  // model-space matrices, per sample and joint.
+  ozz::Vector<math::Transform>::Std locals_;
+  ozz::Vector<math::Float4x4>::Std local_models_;
+  ozz::Vector<math::Float4x4>::Std models_;
+
+  // Input model-space points, per sample, joint and point.
+  ozz::Vector<math::Float3>::Std reference_;
+
+  // Model-space transforms of the evaluated hierarchy.
+  ozz::Vector<math::Float4x4>::Std scratch_;
+
+  // Disables copy and assignment.
+  ModelSpaceReducer(const ModelSpaceReducer&);
+  void operator=(const ModelSpaceReducer&);
+};
+
+#ifdef OZZ_OFFLINE_THREADS
+// Optimizes channels until there's none left. Channels are distributed
+// dynamically, as their cost depends on their number of keys.
+void OptimizeChannels(const OptimizationContext& _context,
+                      std::atomic<size_t>* _next, size_t _num_channels) {
+  memory::ScopedAllocationTag tag(memory::kTagBuilder);
+  for (size_t channel = (*_next)++; channel < _num_channels;
+       channel = (*_next)++) {
+    OptimizeChannel(_context, channel);
+  }
+}
+#endif  // OZZ_OFFLINE_THREADS
+
+// Validates optimization inputs, and computes per joint tolerances. _output is
+// reset to an empty animation.
+bool PrepareOptimization(
+    const AnimationOptimizer& _optimizer, const RawAnimation& _input,
+    const Skeleton& _skeleton, RawAnimation* _output,
+    ozz::Vector<AnimationOptimizer::JointSetting>::Std* _settings) {
   if (!_output) {
     return false;
   }
@@ -239,36 +775,210 @@ bool AnimationOptimizer::operator()(const RawAnimation& _input,
     return false;
   }
 
-  // First computes bone lengths, that will be used when filtering.
-  HierarchyBuilder specs(&_input, &_skeleton);
+  // Computes per joint tolerances.
+  return BuildJointSettings(_optimizer, _skeleton, _settings);
+}
 
-  // Rebuilds output animation.
+// Prepares _output tracks to receive optimized channels.
+void PrepareOutput(const RawAnimation& _input, RawAnimation* _output) {
   _output->name = _input.name;
   _output->duration = _input.duration;
   _output->tracks.resize(_input.tracks.size());
-
   for (size_t i = 0; i < _input.tracks.size(); ++i) {
-    const RawAnimation::JointTrack& input_track = _input.tracks[i];
-    RawAnimation::JointTrack& output_track = _output->tracks[i];
+    _output->tracks[i].step = _input.tracks[i].step;
+  }
+}
+}  // namespace
 
-    const float hierarchical_length = specs.lengths[i];
-    const int parent = _skeleton.joint_parents()[i];
-    const float hierarchical_scale =
-        (parent != Skeleton::kNoParent) ? specs.scales[parent] : 1.f;
+bool AnimationOptimizer::operator()(const RawAnimation& _input,
+                                    const Skeleton& _skeleton,
+                                    RawAnimation* _output) const {
+  memory::ScopedAllocationTag tag(memory::kTagBuilder);
+
+  ozz::Vector<JointSetting>::Std settings;
+  if (!PrepareOptimization(*this, _input, _skeleton, _output, &settings)) {
+    return false;
+  }
 
-    Filter(input_track.translations, CompareTranslation, LerpTranslation,
-           translation_tolerance, hierarchical_tolerance, hierarchical_scale,
-           &output_track.translations);
-    Filter(input_track.rotations, CompareRotation, LerpRotation,
-           rotation_tolerance, hierarchical_tolerance, hierarchical_length,
-           &output_track.rotations);
-    Filter(input_track.scales, CompareScale, LerpScale, scale_tolerance,
-           hierarchical_tolerance, hierarchical_length, &output_track.scales);
+  // Model-space optimization starts from the input keys.
+  if (model_space) {
+    *_output = _input;
+    ModelSpaceReducer reducer(_input, _skeleton, make_range(settings).begin,
+                              skinning_distance, WindowSize(window_size),
+                              _output);
+    reducer.Run();
+    return _output->Validate();
+  }
+
+  // First computes bone lengths, that will be used when filtering.
+  HierarchyBuilder specs(&_input, &_skeleton);
+
+  // Rebuilds output animation.
+  PrepareOutput(_input, _output);
+
+  const OptimizationContext context = {
+      this, &_input, &_skeleton, &specs, make_range(settings).begin, _output};
+  const size_t num_channels = _input.tracks.size() * 3;
+
+#ifdef OZZ_OFFLINE_THREADS
+  // Calling thread is used as a worker too.
+  const unsigned int max_workers = num_threads > 0
+                                       ? static_cast<unsigned int>(num_threads)
+                                       : std::thread::hardware_concurrency();
+  const size_t num_workers =
+      math::Min(static_cast<size_t>(max_workers), num_channels);
+  if (num_workers > 1) {
+    std::atomic<size_t> next(0);
+    ozz::Vector<std::thread>::Std threads;
+    threads.reserve(num_workers - 1);
+    for (size_t i = 1; i < num_workers; ++i) {
+      threads.emplace_back(OptimizeChannels, std::cref(context), &next,
+                           num_channels);
+    }
+    OptimizeChannels(context, &next, num_channels);
+    for (size_t i = 0; i < threads.size(); ++i) {
+      threads[i].join();
+    }
+
+    // Output animation is always valid though.
+    return _output->Validate();
+  }
+#endif  // OZZ_OFFLINE_THREADS
+
+  for (size_t i = 0; i < num_channels; ++i) {
+    OptimizeChannel(context, i);
   }
 
   // Output animation is always valid though.
   return _output->Validate();
 }
+
+struct ResumableAnimationOptimizer::Impl {
+  Impl(const AnimationOptimizer& _optimizer, const RawAnimation& _input,
+       const Skeleton& _skeleton, RawAnimation* _output)
+      : optimizer(_optimizer),
+        specs(NULL),
+        reducer(NULL),
+        next(0),
+        num_channels(static_cast<int>(_input.tracks.size()) * 3) {
+    context.optimizer = &optimizer;
+    context.input = &_input;
+    context.skeleton = &_skeleton;
+    context.specs = NULL;
+    context.settings = NULL;
+    context.output = _output;
+  }
+
+  ~Impl() {
+    memory::Allocator* allocator = memory::default_allocator();
+    allocator->Delete(specs);
+    allocator->Delete(reducer);
+  }
+
+  // Copy of optimizer parameters.
+  const AnimationOptimizer optimizer;
+
+  // Per joint tolerances.
+  ozz::Vector<AnimationOptimizer::JointSetting>::Std settings;
+
+  // Hierarchy specs, unless in model-space mode.
+  HierarchyBuilder* specs;
+
+  // Model-space reducer, only in model-space mode.
+  ModelSpaceReducer* reducer;
+
+  OptimizationContext context;
+
+  // Next channel to optimize.
+  int next;
+  int num_channels;
+
+ private:
+  // Disables copy and assignment.
+  Impl(const Impl&);
+  void operator=(const Impl&);
+};
+
+ResumableAnimationOptimizer::ResumableAnimationOptimizer() : impl_(NULL) {}
+
+ResumableAnimationOptimizer::~ResumableAnimationOptimizer() {
+  memory::default_allocator()->Delete(impl_);
+}
+
+bool ResumableAnimationOptimizer::Start(const AnimationOptimizer& _optimizer,
+                                        const RawAnimation& _input,
+                                        const Skeleton& _skeleton,
+                                        RawAnimation* _output) {
+  memory::ScopedAllocationTag tag(memory::kTagBuilder);
+  memory::Allocator* allocator = memory::default_allocator();
+
+  // Abandons any previous optimization.
+  allocator->Delete(impl_);
+  impl_ = NULL;
+
+  ozz::Vector<AnimationOptimizer::JointSetting>::Std settings;
+  if (!PrepareOptimization(_optimizer, _input, _skeleton, _output,
+                           &settings)) {
+    return false;
+  }
+
+  impl_ = allocator->New<Impl>(_optimizer, _input, _skeleton, _output);
+  impl_->settings.swap(settings);
+  impl_->context.settings = make_range(impl_->settings).begin;
+
+  if (_optimizer.model_space) {
+    // Model-space optimization starts from the input keys.
+    *_output = _input;
+    // Allocator::New doesn't support as many constructor arguments.
+    void* reducer = allocator->Allocate(sizeof(ModelSpaceReducer),
+                                        OZZ_ALIGN_OF(ModelSpaceReducer));
+    impl_->reducer = new (reducer) ModelSpaceReducer(
+        _input, _skeleton, impl_->context.settings,
+        _optimizer.skinning_distance, WindowSize(_optimizer.window_size),
+        _output);
+  } else {
+    impl_->specs = allocator->New<HierarchyBuilder>(&_input, &_skeleton);
+    impl_->context.specs = impl_->specs;
+    PrepareOutput(_input, _output);
+  }
+  return true;
+}
+
+bool ResumableAnimationOptimizer::Resume(int _max_channels) {
+  memory::ScopedAllocationTag tag(memory::kTagBuilder);
+
+  if (done() || _max_channels <= 0) {
+    return false;
+  }
+
+  const int end = impl_->num_channels - impl_->next > _max_channels
+                      ? impl_->next + _max_channels
+                      : impl_->num_channels;
+  for (; impl_->next < end; ++impl_->next) {
+    if (impl_->reducer) {
+      impl_->reducer->ReduceChannel(impl_->next);
+    } else {
+      OptimizeChannel(impl_->context, impl_->next);
+    }
+  }
+
+  // Releases optimization state once complete.
+  if (impl_->next == impl_->num_channels) {
+    RawAnimation* output = impl_->context.output;
+    memory::default_allocator()->Delete(impl_);
+    impl_ = NULL;
+
+    // Output animation is always valid though.
+    return output->Validate();
+  }
+  return true;
+}
+
+bool ResumableAnimationOptimizer::done() const { return impl_ == NULL; }
+
+int ResumableAnimationOptimizer::num_remaining_channels() const {
+  return impl_ ? impl_->num_channels - impl_->next : 0;
+}
 }  // namespace offline
 }  // namespace animation
 }  // namespace ozz
@@ -0,0 +1,217 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#include "ozz/animation/offline/animation_recorder.h"
+
+#include <cmath>
+
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/raw_animation_utils.h"
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/base/maths/math_constant.h"
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/soa_transform.h"
+
+namespace ozz {
+namespace animation {
+namespace offline {
+
+namespace {
+
+// Compares recorded translations and scales.
+bool CompareRecordedFloat3(const math::Float3& _a, const math::Float3& _b,
+                           float _tolerance) {
+  return math::Compare(_a, _b, _tolerance);
+}
+
+// Compares recorded rotations, with the shortest unsigned angle between them.
+bool CompareRecordedRotation(const math::Quaternion& _a,
+                             const math::Quaternion& _b, float _tolerance) {
+  const float dot = _a.x * _b.x + _a.y * _b.y + _a.z * _b.z + _a.w * _b.w;
+  return 2.f * std::acos(math::Min(std::abs(dot), 1.f)) <= _tolerance;
+}
+
+// Records _frame to a channel whose retained keys are _keys, and whose frames
+// since the last retained key are _frames. The last frame is retained as a key
+// if interpolating the last retained key and _frame doesn't reproduce all
+// frames within _tolerance, or if there are already _max_frames frames.
+template <typename _Key, typename _Value>
+void RecordChannel(const _Key& _frame, float _tolerance, int _max_frames,
+                   _Value (*_lerp)(const _Value&, const _Value&, float),
+                   bool (*_compare)(const _Value&, const _Value&, float),
+                   typename ozz::Vector<_Key>::Std* _keys,
+                   typename ozz::Vector<_Key>::Std* _frames) {
+  if (_keys->empty()) {
+    _keys->push_back(_frame);
+    return;
+  }
+  const _Key& last = _keys->back();
+  bool interpolable = static_cast<int>(_frames->size()) < _max_frames;
+  for (size_t i = 0; interpolable && i < _frames->size(); ++i) {
+    const _Key& frame = (*_frames)[i];
+    const float alpha = (frame.time - last.time) / (_frame.time - last.time);
+    interpolable =
+        _compare(_lerp(last.value, _frame.value, alpha), frame.value,
+                 _tolerance);
+  }
+  if (!interpolable) {
+    _keys->push_back(_frames->back());
+    _frames->clear();
+  }
+  _frames->push_back(_frame);
+}
+}  // namespace
+
+AnimationRecorder::AnimationRecorder()
+    : translation_tolerance(1e-3f),                 // 1 mm.
+      rotation_tolerance(.1f * math::kPi / 180.f),  // 0.1 degree.
+      scale_tolerance(1e-3f),                       // 0.1%.
+      max_key_interval(16),
+      begin_time_(0.f),
+      last_time_(0.f),
+      num_frames_(0) {}
+
+bool AnimationRecorder::Begin(int _num_tracks) {
+  if (_num_tracks <= 0 || _num_tracks > Skeleton::kMaxJoints) {
+    return false;
+  }
+
+  // Buffers are cleared, but keep their capacity.
+  raw_.tracks.resize(_num_tracks);
+  frames_.resize(_num_tracks);
+  for (int i = 0; i < _num_tracks; ++i) {
+    raw_.tracks[i].translations.clear();
+    raw_.tracks[i].rotations.clear();
+    raw_.tracks[i].scales.clear();
+    frames_[i].translations.clear();
+    frames_[i].rotations.clear();
+    frames_[i].scales.clear();
+  }
+  begin_time_ = 0.f;
+  last_time_ = 0.f;
+  num_frames_ = 0;
+  return true;
+}
+
+bool AnimationRecorder::Record(const Range<const math::SoaTransform>& _pose,
+                               float _time) {
+  const int num_tracks = this->num_tracks();
+  if (num_tracks == 0 ||
+      _pose.count() < static_cast<size_t>((num_tracks + 3) / 4) ||
+      (num_frames_ != 0 && !(_time > last_time_))) {
+    return false;
+  }
+  if (num_frames_ == 0) {
+    begin_time_ = _time;
+  }
+  last_time_ = _time;
+  ++num_frames_;
+
+  const float time = _time - begin_time_;
+  const int max_frames = math::Max(max_key_interval, 1);
+  for (int i = 0; i < num_tracks; i += 4) {
+    // Converts soa transforms to aos.
+    const math::SoaTransform& soa = _pose[i / 4];
+    math::SimdFloat4 translations[4];
+    math::SimdFloat4 rotations[4];
+    math::SimdFloat4 scales[4];
+    math::Transpose3x4(&soa.translation.x, translations);
+    math::Transpose4x4(&soa.rotation.x, rotations);
+    math::Transpose3x4(&soa.scale.x, scales);
+
+    for (int j = 0; j < 4 && i + j < num_tracks; ++j) {
+      RawAnimation::JointTrack& track = raw_.tracks[i + j];
+      TrackFrames& frames = frames_[i + j];
+
+      RawAnimation::TranslationKey tkey;
+      tkey.time = time;
+      math::Store3PtrU(translations[j], &tkey.value.x);
+      RecordChannel(tkey, translation_tolerance, max_frames, &LerpTranslation,
+                    &CompareRecordedFloat3, &track.translations,
+                    &frames.translations);
+
+      RawAnimation::RotationKey rkey;
+      rkey.time = time;
+      math::StorePtrU(rotations[j], &rkey.value.x);
+      RecordChannel(rkey, rotation_tolerance, max_frames, &LerpRotation,
+                    &CompareRecordedRotation, &track.rotations,
+                    &frames.rotations);
+
+      RawAnimation::ScaleKey skey;
+      skey.time = time;
+      math::Store3PtrU(scales[j], &skey.value.x);
+      RecordChannel(skey, scale_tolerance, max_frames, &LerpScale,
+                    &CompareRecordedFloat3, &track.scales, &frames.scales);
+    }
+  }
+  return true;
+}
+
+int AnimationRecorder::num_keys() const {
+  size_t num_keys = 0;
+  for (size_t i = 0; i < raw_.tracks.size(); ++i) {
+    const RawAnimation::JointTrack& track = raw_.tracks[i];
+    num_keys += track.translations.size() + track.rotations.size() +
+                track.scales.size();
+  }
+  return static_cast<int>(num_keys);
+}
+
+Animation* AnimationRecorder::Finalize(const char* _name) const {
+  if (num_frames_ == 0) {
+    return NULL;
+  }
+
+  // Retained keys are completed with the last frame of every channel, which
+  // all frames since the last retained key were validated against.
+  RawAnimation raw_animation = raw_;
+  raw_animation.name = _name ? _name : "";
+  const float duration = last_time_ - begin_time_;
+  raw_animation.duration = duration > 0.f ? duration : 1.f;
+  for (size_t i = 0; i < raw_animation.tracks.size(); ++i) {
+    RawAnimation::JointTrack& track = raw_animation.tracks[i];
+    const TrackFrames& frames = frames_[i];
+    if (!frames.translations.empty()) {
+      track.translations.push_back(frames.translations.back());
+    }
+    if (!frames.rotations.empty()) {
+      track.rotations.push_back(frames.rotations.back());
+    }
+    if (!frames.scales.empty()) {
+      track.scales.push_back(frames.scales.back());
+    }
+  }
+
+  const AnimationBuilder builder;
+  return builder(raw_animation);
+}
+}  // namespace offline
+}  // namespace animation
+}  // namespace ozz
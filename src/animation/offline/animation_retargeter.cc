@@ -0,0 +1,187 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/offline/animation_retargeter.h"
+
+#include <cstddef>
+
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/animation/runtime/skeleton_utils.h"
+#include "ozz/base/maths/transform.h"
+
+namespace ozz {
+namespace animation {
+namespace offline {
+
+namespace {
+
+// Bind translations shorter than this don't define a proportion.
+const float kMinBindLength = 1e-5f;
+
+// Per target joint retargeting of source key values, see
+// AnimationRetargeter.
+struct JointRetarget {
+  math::Float3 source_translation;
+  math::Float3 target_translation;
+  float translation_ratio;
+  math::Quaternion rotation;
+  math::Float3 source_scale;
+  math::Float3 target_scale;
+
+  math::Float3 Translation(const math::Float3& _value) const {
+    return target_translation +
+           (_value - source_translation) * translation_ratio;
+  }
+  math::Quaternion Rotation(const math::Quaternion& _value) const {
+    return rotation * _value;
+  }
+  math::Float3 Scale(const math::Float3& _value) const {
+    return target_scale * _value / source_scale;
+  }
+};
+
+template <typename _Track>
+void RetargetKeys(const _Track& _src, const JointRetarget& _retarget,
+                  typename _Track::value_type::Value (JointRetarget::*_fct)(
+                      const typename _Track::value_type::Value&) const,
+                  _Track* _dest) {
+  typedef typename _Track::value_type Key;
+
+  // A track without key is sampled as identity, which needs to be retargeted
+  // too.
+  if (_src.empty()) {
+    const Key key = {0.f, (_retarget.*_fct)(Key::identity())};
+    _dest->push_back(key);
+    return;
+  }
+
+  _dest->resize(_src.size());
+  for (size_t i = 0; i < _src.size(); ++i) {
+    (*_dest)[i].time = _src[i].time;
+    (*_dest)[i].value = (_retarget.*_fct)(_src[i].value);
+  }
+}
+}  // namespace
+
+AnimationRetargeter::AnimationRetargeter() : scale_translations(true) {}
+
+bool AnimationRetargeter::operator()(const RawAnimation& _input,
+                                     const Skeleton& _source,
+                                     const Skeleton& _target,
+                                     const Range<const int>& _joint_map,
+                                     RawAnimation* _output) const {
+  if (!_output) {
+    return false;
+  }
+  // Reset output animation to default.
+  *_output = RawAnimation();
+
+  // Validates animation and joint map.
+  if (!_input.Validate() || _input.num_tracks() != _source.num_joints()) {
+    return false;
+  }
+  const int num_joints = _target.num_joints();
+  if (_joint_map.count() < static_cast<size_t>(num_joints)) {
+    return false;
+  }
+  for (int i = 0; i < num_joints; ++i) {
+    if (_joint_map[i] < -1 || _joint_map[i] >= _source.num_joints()) {
+      return false;
+    }
+  }
+
+  // Computes the ratio used by joints whose source bind translation doesn't
+  // define a proportion.
+  float source_length = 0.f;
+  float target_length = 0.f;
+  for (int i = 0; i < num_joints; ++i) {
+    if (_joint_map[i] != -1) {
+      source_length += Length(
+          GetJointLocalBindPose(_source, _joint_map[i]).translation);
+      target_length += Length(GetJointLocalBindPose(_target, i).translation);
+    }
+  }
+  const float default_ratio = source_length > kMinBindLength
+                                  ? target_length / source_length
+                                  : 1.f;
+
+  // Rebuilds output animation.
+  _output->duration = _input.duration;
+  _output->name = _input.name;
+  _output->sync_markers = _input.sync_markers;
+  _output->tracks.resize(num_joints);
+
+  for (int i = 0; i < num_joints; ++i) {
+    const math::Transform target_bind = GetJointLocalBindPose(_target, i);
+    RawAnimation::JointTrack& track_out = _output->tracks[i];
+
+    // Unmapped joints are set to their bind pose.
+    if (_joint_map[i] == -1) {
+      const RawAnimation::TranslationKey tkey = {0.f, target_bind.translation};
+      track_out.translations.push_back(tkey);
+      const RawAnimation::RotationKey rkey = {0.f, target_bind.rotation};
+      track_out.rotations.push_back(rkey);
+      const RawAnimation::ScaleKey skey = {0.f, target_bind.scale};
+      track_out.scales.push_back(skey);
+      continue;
+    }
+
+    const math::Transform source_bind =
+        GetJointLocalBindPose(_source, _joint_map[i]);
+    const float source_bind_length = Length(source_bind.translation);
+
+    JointRetarget retarget;
+    retarget.source_translation = source_bind.translation;
+    retarget.target_translation = target_bind.translation;
+    retarget.translation_ratio = 1.f;
+    if (scale_translations) {
+      retarget.translation_ratio =
+          source_bind_length > kMinBindLength
+              ? Length(target_bind.translation) / source_bind_length
+              : default_ratio;
+    }
+    retarget.rotation = target_bind.rotation * Conjugate(source_bind.rotation);
+    retarget.source_scale = source_bind.scale;
+    retarget.target_scale = target_bind.scale;
+
+    const RawAnimation::JointTrack& track_in = _input.tracks[_joint_map[i]];
+    track_out.step = track_in.step;
+    RetargetKeys(track_in.translations, retarget, &JointRetarget::Translation,
+                 &track_out.translations);
+    RetargetKeys(track_in.rotations, retarget, &JointRetarget::Rotation,
+                 &track_out.rotations);
+    RetargetKeys(track_in.scales, retarget, &JointRetarget::Scale,
+                 &track_out.scales);
+  }
+
+  // Output animation is always valid though.
+  return _output->Validate();
+}
+}  // namespace offline
+}  // namespace animation
+}  // namespace ozz
@@ -63,6 +63,10 @@ class Fbx2OzzImporter : public ozz::animation::offline::OzzImporter {
                       float _sampling_rate,
                       ozz::animation::offline::RawAnimation* _animation);
 
+  virtual bool ImportKeyframes(
+      const char* _animation_name, const ozz::animation::Skeleton& _skeleton,
+      float _sampling_rate, ozz::animation::offline::RawAnimation* _animation);
+
   // Track management
   virtual NodeProperties GetNodeProperties(const char* _node_name);
 
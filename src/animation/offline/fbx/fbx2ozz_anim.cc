@@ -40,21 +40,40 @@ Fbx2OzzImporter::AnimationNames Fbx2OzzImporter::GetAnimationNames() {
   return ozz::animation::offline::fbx::GetAnimationNames(*scene_loader_);
 }
 
-bool Fbx2OzzImporter::Import(
+namespace {
+bool ImportAnimationImpl(
+    ozz::animation::offline::fbx::FbxSceneLoader* _scene_loader,
     const char* _animation_name, const ozz::animation::Skeleton& _skeleton,
-    float _sampling_rate, ozz::animation::offline::RawAnimation* _animation) {
+    float _sampling_rate, bool _keyframes,
+    ozz::animation::offline::RawAnimation* _animation) {
   if (!_animation) {
     return false;
   }
 
   *_animation = ozz::animation::offline::RawAnimation();
 
-  if (!scene_loader_) {
+  if (!_scene_loader) {
     return false;
   }
 
   return ozz::animation::offline::fbx::ExtractAnimation(
-      _animation_name, *scene_loader_, _skeleton, _sampling_rate, _animation);
+      _animation_name, *_scene_loader, _skeleton, _sampling_rate, _keyframes,
+      _animation);
+}
+}  // namespace
+
+bool Fbx2OzzImporter::Import(
+    const char* _animation_name, const ozz::animation::Skeleton& _skeleton,
+    float _sampling_rate, ozz::animation::offline::RawAnimation* _animation) {
+  return ImportAnimationImpl(scene_loader_, _animation_name, _skeleton,
+                             _sampling_rate, false, _animation);
+}
+
+bool Fbx2OzzImporter::ImportKeyframes(
+    const char* _animation_name, const ozz::animation::Skeleton& _skeleton,
+    float _sampling_rate, ozz::animation::offline::RawAnimation* _animation) {
+  return ImportAnimationImpl(scene_loader_, _animation_name, _skeleton,
+                             _sampling_rate, true, _animation);
 }
 
 Fbx2OzzImporter::NodeProperties Fbx2OzzImporter::GetNodeProperties(
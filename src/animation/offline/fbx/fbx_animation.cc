@@ -27,6 +27,9 @@
 
 #include "ozz/animation/offline/fbx/fbx_animation.h"
 
+#include <algorithm>
+#include <cmath>
+
 #include "ozz/animation/offline/fbx/fbx.h"
 
 #include "ozz/animation/offline/raw_animation.h"
@@ -76,12 +79,12 @@ SamplingInfo ExtractSamplingInfo(FbxScene* _scene, FbxAnimStack* _anim_stack,
   float sampling_rate;
   if (_sampling_rate > 0.f) {
     sampling_rate = _sampling_rate;
-    log::LogV() << "Using sampling rate of " << sampling_rate << "hz."
-                << std::endl;
+    OZZ_LOGV << "Using sampling rate of " << sampling_rate << "hz."
+             << std::endl;
   } else {
     sampling_rate = scene_frame_rate;
-    log::LogV() << "Using scene sampling rate of " << sampling_rate << "hz."
-                << std::endl;
+    OZZ_LOGV << "Using scene sampling rate of " << sampling_rate << "hz."
+             << std::endl;
   }
   info.period = 1.f / sampling_rate;
 
@@ -100,70 +103,150 @@ SamplingInfo ExtractSamplingInfo(FbxScene* _scene, FbxAnimStack* _anim_stack,
   return info;
 }
 
+// Defines how a joint local transform is extracted from the fbx scene.
+enum JointSource {
+  kBindPose,    // Joint has no node in the scene, skeleton bind pose is used.
+  kNodeLocal,   // Node local transform is the joint local transform.
+  kNodeGlobal,  // Joint local transform is computed from node global transform.
+};
+
+typedef ozz::Vector<float>::Std Times;
+
+// Tolerance used to decide whether a cubic curve segment is linear, when its
+// tangents match the segment slope.
+const float kLinearTolerance = 1e-5f;
+
+// Maximum euler angle variation (in degree) between two keys of rotation
+// curves. Linearly interpolated euler angles aren't linearly interpolated
+// once converted to quaternions, so wider segments are subdivided.
+const float kMaxEulerStep = 10.f;
+
+// Appends to _times the times needed to represent _curve with linearly
+// interpolated keys: curve key times, a key one sampling period before each
+// constant (stepped) change, and subdivisions of segments that aren't linear.
+// Subdivisions are never finer than sampling period.
+void ExtractCurveTimes(FbxAnimCurve* _curve, bool _euler,
+                       const SamplingInfo& _info, Times* _times) {
+  const int num_keys = _curve->KeyGetCount();
+  for (int k = 0; k < num_keys; ++k) {
+    const float t0 =
+        static_cast<float>(_curve->KeyGetTime(k).GetSecondDouble());
+    _times->push_back(t0);
+    if (k + 1 == num_keys) {
+      break;
+    }
+    const float t1 =
+        static_cast<float>(_curve->KeyGetTime(k + 1).GetSecondDouble());
+    const float dt = t1 - t0;
+    if (dt <= 0.f) {
+      continue;
+    }
+    const float delta = _curve->KeyGetValue(k + 1) - _curve->KeyGetValue(k);
+    const FbxAnimCurveDef::EInterpolationType interpolation =
+        _curve->KeyGetInterpolation(k);
+    if (interpolation == FbxAnimCurveDef::eInterpolationConstant) {
+      if (delta != 0.f) {
+        _times->push_back(t1 - math::Min(_info.period, dt * .5f));
+      }
+      continue;
+    }
+
+    // Finds the number of linear segments needed between the two keys.
+    const int max_divisions = static_cast<int>(std::ceil(dt / _info.period));
+    int divisions = 1;
+    if (interpolation == FbxAnimCurveDef::eInterpolationCubic &&
+        (std::abs(_curve->KeyGetRightDerivative(k) * dt - delta) >
+             kLinearTolerance ||
+         std::abs(_curve->KeyGetLeftDerivative(k + 1) * dt - delta) >
+             kLinearTolerance)) {
+      divisions = max_divisions;
+    } else if (_euler) {
+      divisions = static_cast<int>(std::ceil(std::abs(delta) / kMaxEulerStep));
+    }
+    divisions = math::Min(divisions, max_divisions);
+    for (int i = 1; i < divisions; ++i) {
+      _times->push_back(t0 + dt * i / divisions);
+    }
+  }
+}
+
+// Appends to _times the keyframe times of _node local transform curves, for
+// all _anim_stack layers.
+void ExtractNodeTimes(FbxNode* _node, FbxAnimStack* _anim_stack,
+                      const SamplingInfo& _info, Times* _times) {
+  FbxPropertyT<FbxDouble3>* properties[] = {
+      &_node->LclTranslation, &_node->LclRotation, &_node->LclScaling};
+  const char* components[] = {FBXSDK_CURVENODE_COMPONENT_X,
+                              FBXSDK_CURVENODE_COMPONENT_Y,
+                              FBXSDK_CURVENODE_COMPONENT_Z};
+  const int num_layers = _anim_stack->GetMemberCount<FbxAnimLayer>();
+  for (int l = 0; l < num_layers; ++l) {
+    FbxAnimLayer* layer = _anim_stack->GetMember<FbxAnimLayer>(l);
+    for (int p = 0; p < 3; ++p) {
+      for (int c = 0; c < 3; ++c) {
+        FbxAnimCurve* curve = properties[p]->GetCurve(layer, components[c]);
+        if (curve) {
+          ExtractCurveTimes(curve, properties[p] == &_node->LclRotation,
+                            _info, _times);
+        }
+      }
+    }
+  }
+}
+
+// Sorts _times, removing duplicates and times outside of _info timeline,
+// which start and end are always included.
+void SanitizeTimes(const SamplingInfo& _info, Times* _times) {
+  _times->push_back(_info.start);
+  _times->push_back(_info.end);
+  std::sort(_times->begin(), _times->end());
+  Times::iterator begin =
+      std::lower_bound(_times->begin(), _times->end(), _info.start);
+  Times::iterator end = std::upper_bound(begin, _times->end(), _info.end);
+  _times->erase(end, _times->end());
+  _times->erase(_times->begin(), begin);
+  _times->erase(std::unique(_times->begin(), _times->end()), _times->end());
+}
+
+// Extracts joints animation. If _anim_stack isn't NULL, joints are sampled at
+// their nodes curves keyframes times only. Otherwise the whole timeline is
+// sampled at _info sampling period.
 bool ExtractAnimation(FbxSceneLoader& _scene_loader, const SamplingInfo& _info,
-                      const Skeleton& _skeleton, RawAnimation* _animation) {
+                      FbxAnimStack* _anim_stack, const Skeleton& _skeleton,
+                      RawAnimation* _animation) {
   FbxScene* scene = _scene_loader.scene();
   assert(scene);
+  const FbxSystemConverter* converter = _scene_loader.converter();
 
   // Set animation data.
   _animation->duration = _info.duration;
 
-  // Locates all skeleton nodes in the fbx scene. Some might be NULL.
-  ozz::Vector<FbxNode*>::Std nodes;
-  for (int i = 0; i < _skeleton.num_joints(); i++) {
+  const int num_joints = _skeleton.num_joints();
+  const Range<const int16_t> parents = _skeleton.joint_parents();
+
+  // Joints local and model-space matrices at the current time.
+  ozz::Vector<math::Float4x4>::Std locals(num_joints);
+  ozz::Vector<math::Float4x4>::Std models(num_joints);
+
+  // Locates all skeleton nodes in the fbx scene, some might be NULL, and
+  // selects how their local transform is extracted. Node local transform
+  // can be used directly if node parent is the joint parent, and node
+  // inherits its parent transform the same way as ozz (matrix
+  // multiplication). Otherwise, local transform is computed from node global
+  // transform, relatively to joint parent model-space transform.
+  ozz::Vector<FbxNode*>::Std nodes(num_joints);
+  ozz::Vector<JointSource>::Std sources(num_joints);
+  for (int i = 0; i < num_joints; i++) {
     const char* joint_name = _skeleton.joint_names()[i];
-    nodes.push_back(scene->FindNodeByName(joint_name));
-  }
+    FbxNode* node = scene->FindNodeByName(joint_name);
+    nodes[i] = node;
 
-  // Preallocates and initializes world matrices.
-  const size_t max_keys =
-      static_cast<size_t>(3.f + (_info.end - _info.start) / _info.period);
-  ozz::Vector<float>::Std times;
-  times.reserve(max_keys);
-  ozz::Vector<ozz::Vector<ozz::math::Float4x4>::Std>::Std world_matrices;
-  world_matrices.resize(_skeleton.num_joints());
-  for (int i = 0; i < _skeleton.num_joints(); i++) {
-    world_matrices[i].reserve(max_keys);
-  }
-
-  // Goes through the whole timeline to compute animated word matrices.
-  // Fbx sdk seems to compute nodes transformation for the whole scene, so it's
-  // much faster to query all nodes at once for the same time t.
-  FbxAnimEvaluator* evaluator = scene->GetAnimationEvaluator();
-  bool loop_again = true;
-  size_t num_keys = 0;
-  for (float t = _info.start; loop_again; t += _info.period) {
-    if (t >= _info.end) {
-      t = _info.end;
-      loop_again = false;
-    }
-    times.push_back(t - _info.start);
-    ++num_keys;
-
-    // Goes through all nodes.
-    for (int i = 0; i < _skeleton.num_joints(); i++) {
-      FbxNode* node = nodes[i];
-      if (node) {
-        const FbxAMatrix fbx_matrix =
-            evaluator->GetNodeGlobalTransform(node, FbxTimeSeconds(t));
-        const math::Float4x4 matrix =
-            _scene_loader.converter()->ConvertMatrix(fbx_matrix);
-        world_matrices[i].push_back(matrix);
-      }
-    }
-  }
-  assert(num_keys <= max_keys);
-
-  // Builds world matrices for non-animated joints.
-  // Skeleton is order with parents first, so it can be traversed in order.
-  for (int i = 0; i < _skeleton.num_joints(); i++) {
-    // Initializes non-animated joints.
-    FbxNode* node = nodes[i];
     if (node == NULL) {
-      ozz::log::LogV() << "No animation track found for joint \""
-                       << _skeleton.joint_names()[i]
-                       << "\". Using skeleton bind pose instead." << std::endl;
+      OZZ_LOGV << "No animation track found for joint \"" << joint_name
+               << "\". Using skeleton bind pose instead." << std::endl;
 
+      // Non-animated joints local matrix is constant.
+      sources[i] = kBindPose;
       const math::Transform& bind_pose =
           ozz::animation::GetJointLocalBindPose(_skeleton, i);
       const math::SimdFloat4 t =
@@ -172,79 +255,140 @@ bool ExtractAnimation(FbxSceneLoader& _scene_loader, const SamplingInfo& _info,
           math::simd_float4::LoadPtrU(&bind_pose.rotation.x);
       const math::SimdFloat4 s =
           math::simd_float4::Load3PtrU(&bind_pose.scale.x);
-      const math::Float4x4 local_matrix = math::Float4x4::FromAffine(t, q, s);
+      locals[i] = math::Float4x4::FromAffine(t, q, s);
+      continue;
+    }
 
-      ozz::Vector<math::Float4x4>::Std& node_matrices = world_matrices[i];
-      const int16_t parent = _skeleton.joint_parents()[i];
-      if (parent != Skeleton::kNoParent) {
-        ozz::Vector<math::Float4x4>::Std& parent_matrices =
-            world_matrices[parent];
-        assert(num_keys == parent_matrices.size());
-        for (size_t p = 0; p < num_keys; ++p) {
-          node_matrices.push_back(parent_matrices[p] * local_matrix);
+    const int16_t parent = parents[i];
+    FbxTransform::EInheritType inherit_type;
+    node->GetTransformationInheritType(inherit_type);
+    if (parent != Skeleton::kNoParent && nodes[parent] != NULL &&
+        node->GetParent() == nodes[parent] &&
+        inherit_type == FbxTransform::eInheritRSrs) {
+      sources[i] = kNodeLocal;
+    } else {
+      sources[i] = kNodeGlobal;
+    }
+  }
+
+  // Builds the timeline to evaluate. When keyframes are extracted, each joint
+  // is only sampled at the keyframes of the curves its local transform
+  // depends on, and the timeline is the union of all joints times.
+  Times times;
+  ozz::Vector<Times>::Std joint_times;
+  if (_anim_stack) {
+    joint_times.resize(num_joints);
+    for (int i = 0; i < num_joints; i++) {
+      const int16_t parent = parents[i];
+      Times& jtimes = joint_times[i];
+      if (sources[i] == kNodeLocal) {
+        ExtractNodeTimes(nodes[i], _anim_stack, _info, &jtimes);
+      } else if (sources[i] == kNodeGlobal) {
+        for (FbxNode* node = nodes[i]; node; node = node->GetParent()) {
+          ExtractNodeTimes(node, _anim_stack, _info, &jtimes);
         }
-      } else {
-        for (size_t p = 0; p < num_keys; ++p) {
-          node_matrices.push_back(local_matrix);
+        if (parent != Skeleton::kNoParent) {
+          jtimes.insert(jtimes.end(), joint_times[parent].begin(),
+                        joint_times[parent].end());
         }
       }
+      SanitizeTimes(_info, &jtimes);
+      times.insert(times.end(), jtimes.begin(), jtimes.end());
     }
-  }
-
-  // Builds world inverse matrices.
-  ozz::Vector<ozz::Vector<ozz::math::Float4x4>::Std>::Std world_inv_matrices;
-  world_inv_matrices.resize(_skeleton.num_joints());
-  for (int i = 0; i < _skeleton.num_joints(); i++) {
-    ozz::Vector<math::Float4x4>::Std& node_world_matrices = world_matrices[i];
-    ozz::Vector<math::Float4x4>::Std& node_world_inv_matrices =
-        world_inv_matrices[i];
-    node_world_inv_matrices.reserve(num_keys);
-    for (size_t p = 0; p < num_keys; ++p) {
-      node_world_inv_matrices.push_back(Invert(node_world_matrices[p]));
+    SanitizeTimes(_info, &times);
+  } else {
+    // Sample times are computed from their index, as accumulated periods
+    // drift. A sample closer than half a period to the end is replaced by the
+    // end sample, as they might be too close to be stored at distinct frames
+    // (see Animation::num_frames()).
+    for (int i = 0; true; ++i) {
+      const float t = _info.start + i * _info.period;
+      if (t >= _info.end - _info.period * .5f) {
+        times.push_back(_info.end);
+        break;
+      }
+      times.push_back(t);
     }
   }
 
-  // Builds local space animation tracks.
   // Allocates all tracks with the same number of joints as the skeleton.
-  // Tracks that would not be found will be set to skeleton bind-pose
-  // transformation.
-  _animation->tracks.resize(_skeleton.num_joints());
-  for (int i = 0; i < _skeleton.num_joints(); i++) {
+  _animation->tracks.resize(num_joints);
+  for (int i = 0; i < num_joints; i++) {
+    const size_t max_keys = _anim_stack ? joint_times[i].size() : times.size();
     RawAnimation::JointTrack& track = _animation->tracks[i];
-    track.rotations.reserve(num_keys);
-    track.translations.reserve(num_keys);
-    track.scales.reserve(num_keys);
-
-    const int16_t parent = _skeleton.joint_parents()[i];
-    ozz::Vector<math::Float4x4>::Std& node_world_matrices = world_matrices[i];
-    ozz::Vector<math::Float4x4>::Std& node_world_inv_matrices =
-        world_inv_matrices[parent != Skeleton::kNoParent ? parent : 0];
-
-    for (size_t n = 0; n < num_keys; ++n) {
-      // Builds local matrix;
-      math::Float4x4 local_matrix;
+    track.rotations.reserve(max_keys);
+    track.translations.reserve(max_keys);
+    track.scales.reserve(max_keys);
+  }
+  ozz::Vector<size_t>::Std cursors(num_joints, 0);
+
+  // Goes through the whole timeline, evaluating the whole hierarchy for each
+  // time t. Fbx sdk computes nodes transformation for the whole scene, so
+  // it's much faster to query all nodes at once for the same time t. Joints
+  // local transforms are composed from parents to children (skeleton is
+  // ordered with parents first), so model-space matrices don't need to be
+  // stored for the whole timeline.
+  FbxAnimEvaluator* evaluator = scene->GetAnimationEvaluator();
+  for (size_t k = 0; k < times.size(); ++k) {
+    const float t = times[k];
+    const FbxTime fbx_time = FbxTimeSeconds(t);
+    const float time = t - _info.start;
+
+    for (int i = 0; i < num_joints; i++) {
+      const int16_t parent = parents[i];
+      switch (sources[i]) {
+        case kNodeLocal: {
+          locals[i] = converter->ConvertMatrix(
+              evaluator->GetNodeLocalTransform(nodes[i], fbx_time));
+          break;
+        }
+        case kNodeGlobal: {
+          const math::Float4x4 model = converter->ConvertMatrix(
+              evaluator->GetNodeGlobalTransform(nodes[i], fbx_time));
+          if (parent != Skeleton::kNoParent) {
+            locals[i] = Invert(models[parent]) * model;
+          } else {
+            locals[i] = model;
+          }
+          break;
+        }
+        case kBindPose: {
+          break;  // Constant, already initialized.
+        }
+      }
+
+      // Composes model-space matrix, used by children.
       if (parent != Skeleton::kNoParent) {
-        local_matrix = node_world_inv_matrices[n] * node_world_matrices[n];
+        models[i] = models[parent] * locals[i];
       } else {
-        local_matrix = node_world_matrices[n];
+        models[i] = locals[i];
+      }
+
+      // Skips joints that don't have a keyframe at this time.
+      if (_anim_stack) {
+        const Times& jtimes = joint_times[i];
+        if (cursors[i] == jtimes.size() || jtimes[cursors[i]] != t) {
+          continue;
+        }
+        ++cursors[i];
       }
 
       // Convert to transform structure.
-      math::SimdFloat4 t, q, s;
-      if (!ToAffine(local_matrix, &t, &q, &s)) {
+      math::SimdFloat4 translation, rotation, scale;
+      if (!ToAffine(locals[i], &translation, &rotation, &scale)) {
         ozz::log::Err() << "Failed to extract animation transform for joint\""
-                        << _skeleton.joint_names()[i]
-                        << "\" at t = " << times[n] << "s." << std::endl;
+                        << _skeleton.joint_names()[i] << "\" at t = " << time
+                        << "s." << std::endl;
         return false;
       }
 
       ozz::math::Transform transform;
-      math::Store3PtrU(t, &transform.translation.x);
-      math::StorePtrU(math::Normalize4(q), &transform.rotation.x);
-      math::Store3PtrU(s, &transform.scale.x);
+      math::Store3PtrU(translation, &transform.translation.x);
+      math::StorePtrU(math::Normalize4(rotation), &transform.rotation.x);
+      math::Store3PtrU(scale, &transform.scale.x);
 
       // Fills corresponding track.
-      const float time = times[n];
+      RawAnimation::JointTrack& track = _animation->tracks[i];
       const RawAnimation::TranslationKey tkey = {time, transform.translation};
       track.translations.push_back(tkey);
       const RawAnimation::RotationKey rkey = {time, transform.rotation};
@@ -661,7 +805,7 @@ OzzImporter::AnimationNames GetAnimationNames(FbxSceneLoader& _scene_loader) {
 
 bool ExtractAnimation(const char* _animation_name,
                       FbxSceneLoader& _scene_loader, const Skeleton& _skeleton,
-                      float _sampling_rate,
+                      float _sampling_rate, bool _keyframes,
                       ozz::animation::offline::RawAnimation* _animation) {
   FbxScene* scene = _scene_loader.scene();
   assert(scene);
@@ -681,7 +825,9 @@ bool ExtractAnimation(const char* _animation_name,
     // Setup Fbx animation evaluator.
     scene->SetCurrentAnimationStack(anim_stack);
 
-    success = ExtractAnimation(_scene_loader, info, _skeleton, _animation);
+    success = ExtractAnimation(_scene_loader, info,
+                               _keyframes ? anim_stack : NULL, _skeleton,
+                               _animation);
   }
 
   // Clears output if something failed during import, avoids partial data.
@@ -698,8 +844,7 @@ OzzImporter::NodeProperties GetNodeProperties(FbxSceneLoader& _scene_loader,
   FbxScene* scene = _scene_loader.scene();
   const FbxNode* node = scene->FindNodeByName(_node_name);
   if (!node) {
-    ozz::log::LogV() << "Invalid node name \"" << _node_name << "\""
-                     << std::endl;
+    OZZ_LOGV << "Invalid node name \"" << _node_name << "\"" << std::endl;
     return properties;
   }
 
@@ -745,9 +890,9 @@ OzzImporter::NodeProperties GetNodeProperties(FbxSceneLoader& _scene_loader,
         break;
       }
       default: {
-        log::LogV() << "Node property \"" << ppt_name
-                    << "\" doesn't have a importable type\""
-                    << FbxTypeToString(type) << "\"" << std::endl;
+        OZZ_LOGV << "Node property \"" << ppt_name
+                 << "\" doesn't have a importable type\""
+                 << FbxTypeToString(type) << "\"" << std::endl;
         break;
       }
     }
@@ -0,0 +1,96 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#include "ozz/animation/offline/fixed_topology_generator.h"
+
+#include <cstdio>
+
+#include "ozz/animation/runtime/skeleton.h"
+
+namespace ozz {
+namespace animation {
+namespace offline {
+
+namespace {
+// Tests whether _name is a valid C++ identifier.
+bool IsIdentifier(const char* _name) {
+  if (!_name || *_name == 0 || (*_name >= '0' && *_name <= '9')) {
+    return false;
+  }
+  for (const char* c = _name; *c != 0; ++c) {
+    if (!((*c >= 'a' && *c <= 'z') || (*c >= 'A' && *c <= 'Z') ||
+          (*c >= '0' && *c <= '9') || *c == '_')) {
+      return false;
+    }
+  }
+  return true;
+}
+}  // namespace
+
+bool GenerateFixedTopology(const Skeleton& _skeleton, const char* _name,
+                           ozz::String::Std* _source) {
+  const int num_joints = _skeleton.num_joints();
+  if (num_joints == 0 || !IsIdentifier(_name) || !_source) {
+    return false;
+  }
+
+  char line[256];
+  ozz::String::Std source;
+  std::sprintf(line,
+               "// Fixed topology of a %d joints skeleton, generated by "
+               "ozz-animation.\n"
+               "// See ozz/animation/runtime/fixed_topology.h.\n\n",
+               num_joints);
+  source += line;
+  source += "#include \"ozz/animation/runtime/fixed_topology.h\"\n\n";
+  source += "struct ";
+  source += _name;
+  source += " {\n";
+  std::sprintf(line, "  enum { kNumJoints = %d };\n", num_joints);
+  source += line;
+  std::sprintf(line,
+               "  static uint32_t fingerprint() { return 0x%08xu; }\n",
+               static_cast<unsigned int>(_skeleton.fingerprint()));
+  source += line;
+  source += "  template <int _Joint>\n  struct Parent;\n};\n\n";
+
+  // Specializes every joint parent.
+  const Range<const int16_t>& parents = _skeleton.joint_parents();
+  for (int i = 0; i < num_joints; ++i) {
+    std::sprintf(line, "template <>\nstruct %.128s::Parent<%d> {\n", _name, i);
+    source += line;
+    std::sprintf(line, "  enum { kValue = %d };\n};\n", parents[i]);
+    source += line;
+  }
+
+  *_source += source;
+  return true;
+}
+}  // namespace offline
+}  // namespace animation
+}  // namespace ozz
@@ -0,0 +1,448 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#include "animation/offline/gltf/gltf2ozz.h"
+
+#include <cstring>
+#include <sstream>
+
+#include "ozz/base/endianness.h"
+#include "ozz/base/io/stream.h"
+#include "ozz/base/log.h"
+#include "ozz/base/maths/simd_math.h"
+
+int main(int _argc, const char** _argv) {
+  Gltf2OzzImporter converter;
+  return converter(_argc, _argv);
+}
+
+namespace {
+
+// Glb container constants.
+const uint32_t kGlbHeaderSize = 12;
+const uint32_t kGlbChunkJson = 0x4E4F534A;
+const uint32_t kGlbChunkBin = 0x004E4942;
+
+// Accessors component types.
+enum ComponentType {
+  kByte = 5120,
+  kUnsignedByte = 5121,
+  kShort = 5122,
+  kUnsignedShort = 5123,
+  kUnsignedInt = 5125,
+  kFloat = 5126,
+};
+
+// Reads a little endian value, as all glTF binary data are little endian.
+template <typename _Ty>
+_Ty ReadLittleEndian(const char* _data) {
+  _Ty value;
+  std::memcpy(&value, _data, sizeof(value));
+  if (ozz::GetNativeEndianness() != ozz::kLittleEndian) {
+    value = ozz::EndianSwapper<_Ty>::Swap(value);
+  }
+  return value;
+}
+
+// Gets the size of a component type, or 0 if type isn't valid.
+size_t ComponentSize(int _type) {
+  switch (_type) {
+    case kByte:
+    case kUnsignedByte:
+      return 1;
+    case kShort:
+    case kUnsignedShort:
+      return 2;
+    case kUnsignedInt:
+    case kFloat:
+      return 4;
+    default:
+      return 0;
+  }
+}
+
+// Gets the number of components of an accessor type, or 0 if type isn't
+// supported.
+int NumComponents(const ozz::String::Std& _type) {
+  if (_type == "SCALAR") {
+    return 1;
+  } else if (_type == "VEC2") {
+    return 2;
+  } else if (_type == "VEC3") {
+    return 3;
+  } else if (_type == "VEC4") {
+    return 4;
+  }
+  return 0;
+}
+
+// Decodes base64 _begin to _end characters, and appends them to _out.
+// Returns false if encoding is invalid.
+bool DecodeBase64(const char* _begin, const char* _end,
+                  ozz::Vector<char>::Std* _out) {
+  uint32_t bits = 0;
+  int num_bits = 0;
+  for (const char* c = _begin; c < _end && *c != '='; ++c) {
+    uint32_t value;
+    if (*c >= 'A' && *c <= 'Z') {
+      value = static_cast<uint32_t>(*c - 'A');
+    } else if (*c >= 'a' && *c <= 'z') {
+      value = static_cast<uint32_t>(*c - 'a' + 26);
+    } else if (*c >= '0' && *c <= '9') {
+      value = static_cast<uint32_t>(*c - '0' + 52);
+    } else if (*c == '+') {
+      value = 62;
+    } else if (*c == '/') {
+      value = 63;
+    } else {
+      return false;
+    }
+    bits = (bits << 6) | value;
+    num_bits += 6;
+    if (num_bits >= 8) {
+      num_bits -= 8;
+      _out->push_back(static_cast<char>((bits >> num_bits) & 0xff));
+    }
+  }
+  return true;
+}
+
+// Reads the whole content of file _filename to _content.
+bool ReadFile(const char* _filename, ozz::Vector<char>::Std* _content) {
+  ozz::io::File file(_filename, "rb");
+  if (!file.opened()) {
+    return false;
+  }
+  const size_t size = static_cast<size_t>(file.Size());
+  _content->resize(size);
+  return size == 0 || file.Read(&(*_content)[0], size) == size;
+}
+}  // namespace
+
+Gltf2OzzImporter::Gltf2OzzImporter() {}
+
+Gltf2OzzImporter::~Gltf2OzzImporter() {}
+
+bool Gltf2OzzImporter::Load(const char* _filename) {
+  document_ = Json::Value();
+  file_.clear();
+  buffers_content_.clear();
+  buffers_.clear();
+  parents_.clear();
+
+  if (!ReadFile(_filename, &file_) || file_.empty()) {
+    ozz::log::Err() << "Failed to read file " << _filename << "." << std::endl;
+    return false;
+  }
+  const char* begin = &file_[0];
+  const char* end = begin + file_.size();
+
+  // Locates json and binary chunks if file is a glb container, or uses the
+  // whole file as json otherwise.
+  ozz::Range<const char> json(begin, end);
+  ozz::Range<const char> bin;
+  if (file_.size() >= kGlbHeaderSize && std::memcmp(begin, "glTF", 4) == 0) {
+    const uint32_t version = ReadLittleEndian<uint32_t>(begin + 4);
+    if (version != 2) {
+      ozz::log::Err() << "Unsupported glb version " << version << "."
+                      << std::endl;
+      return false;
+    }
+    json = ozz::Range<const char>();
+    for (const char* chunk = begin + kGlbHeaderSize; end - chunk >= 8;) {
+      const uint32_t length = ReadLittleEndian<uint32_t>(chunk);
+      const uint32_t type = ReadLittleEndian<uint32_t>(chunk + 4);
+      const char* data = chunk + 8;
+      if (length > static_cast<size_t>(end - data)) {
+        ozz::log::Err() << "Invalid glb chunk length." << std::endl;
+        return false;
+      }
+      if (type == kGlbChunkJson && json.begin == NULL) {
+        json = ozz::Range<const char>(data, data + length);
+      } else if (type == kGlbChunkBin && bin.begin == NULL) {
+        bin = ozz::Range<const char>(data, data + length);
+      }
+      chunk = data + length;
+    }
+    if (json.begin == NULL) {
+      ozz::log::Err() << "Glb file has no json chunk." << std::endl;
+      return false;
+    }
+  }
+
+  // Parses json document in place.
+  Json::Reader reader;
+  if (!reader.parse(json.begin, json.end, document_, false) ||
+      !document_.isObject()) {
+    ozz::log::Err() << "Failed to parse glTF document: "
+                    << reader.getFormattedErrorMessages() << std::endl;
+    return false;
+  }
+  const Json::Value& version = document_["asset"]["version"];
+  if (!version.isString() || version.asString().compare(0, 2, "2.") != 0) {
+    ozz::log::Err() << "Unsupported glTF version, only glTF 2.0 is supported."
+                    << std::endl;
+    return false;
+  }
+
+  // Loads buffers, relatively to the document directory.
+  ozz::String::Std directory(_filename);
+  const size_t slash = directory.find_last_of("/\\");
+  directory.resize(slash == ozz::String::Std::npos ? 0 : slash + 1);
+  const Json::Value& buffers = document_["buffers"];
+  buffers_content_.resize(buffers.size());
+  buffers_.resize(buffers.size());
+  for (Json::ArrayIndex i = 0; i < buffers.size(); ++i) {
+    if (!LoadBuffer(i, directory, bin)) {
+      return false;
+    }
+  }
+
+  // Builds nodes hierarchy.
+  const Json::Value& nodes = document_["nodes"];
+  parents_.assign(nodes.size(), -1);
+  for (Json::ArrayIndex i = 0; i < nodes.size(); ++i) {
+    const Json::Value& children = nodes[i]["children"];
+    for (Json::ArrayIndex c = 0; c < children.size(); ++c) {
+      const int child = children[c].asInt();
+      if (child < 0 || child >= static_cast<int>(nodes.size()) ||
+          parents_[child] != -1) {
+        ozz::log::Err() << "Invalid glTF nodes hierarchy." << std::endl;
+        return false;
+      }
+      parents_[child] = static_cast<int>(i);
+    }
+  }
+  return true;
+}
+
+bool Gltf2OzzImporter::LoadBuffer(Json::ArrayIndex _index,
+                                  const ozz::String::Std& _directory,
+                                  ozz::Range<const char> _glb_chunk) {
+  const Json::Value& buffer = document_["buffers"][_index];
+  const size_t length = buffer["byteLength"].asUInt();
+
+  if (!buffer.isMember("uri")) {
+    // Glb binary chunk, which is used in place.
+    if (_index != 0 || _glb_chunk.begin == NULL) {
+      ozz::log::Err() << "glTF buffer " << _index << " has no data."
+                      << std::endl;
+      return false;
+    }
+    buffers_[_index] = _glb_chunk;
+  } else {
+    const ozz::String::Std uri = buffer["uri"].asCString();
+    ozz::Vector<char>::Std& content = buffers_content_[_index];
+    if (uri.compare(0, 5, "data:") == 0) {
+      const size_t base64 = uri.find(";base64,");
+      if (base64 == ozz::String::Std::npos ||
+          !DecodeBase64(uri.c_str() + base64 + 8, uri.c_str() + uri.size(),
+                        &content)) {
+        ozz::log::Err() << "Invalid glTF buffer " << _index << " data uri."
+                        << std::endl;
+        return false;
+      }
+    } else {
+      const ozz::String::Std path = _directory + uri;
+      if (!ReadFile(path.c_str(), &content)) {
+        ozz::log::Err() << "Failed to read glTF buffer file \"" << path
+                        << "\"." << std::endl;
+        return false;
+      }
+    }
+    buffers_[_index] =
+        content.empty() ? ozz::Range<const char>()
+                        : ozz::Range<const char>(&content[0],
+                                                 &content[0] + content.size());
+  }
+
+  if (buffers_[_index].count() < length) {
+    ozz::log::Err() << "glTF buffer " << _index << " is too small."
+                    << std::endl;
+    return false;
+  }
+  return true;
+}
+
+bool Gltf2OzzImporter::GetAccessor(int _index, Accessor* _accessor) const {
+  const Json::Value& accessors = document_["accessors"];
+  if (_index < 0 || _index >= static_cast<int>(accessors.size())) {
+    ozz::log::Err() << "Invalid glTF accessor " << _index << "." << std::endl;
+    return false;
+  }
+  const Json::Value& accessor = accessors[_index];
+  if (accessor.isMember("sparse") || !accessor.isMember("bufferView")) {
+    ozz::log::Err() << "glTF accessor " << _index
+                    << " isn't supported, sparse accessors and accessors "
+                       "without buffer view aren't supported."
+                    << std::endl;
+    return false;
+  }
+
+  _accessor->count = accessor["count"].asUInt();
+  _accessor->component_type = accessor["componentType"].asInt();
+  _accessor->num_components = NumComponents(accessor["type"].asCString());
+  _accessor->normalized = accessor["normalized"].asBool();
+  const size_t component_size = ComponentSize(_accessor->component_type);
+  if (component_size == 0 || _accessor->num_components == 0) {
+    ozz::log::Err() << "glTF accessor " << _index << " type isn't supported."
+                    << std::endl;
+    return false;
+  }
+  const size_t element_size = component_size * _accessor->num_components;
+
+  const Json::Value& views = document_["bufferViews"];
+  const int view_index = accessor["bufferView"].asInt();
+  if (view_index < 0 || view_index >= static_cast<int>(views.size())) {
+    ozz::log::Err() << "Invalid glTF buffer view " << view_index << "."
+                    << std::endl;
+    return false;
+  }
+  const Json::Value& view = views[view_index];
+  const int buffer_index = view["buffer"].asInt();
+  if (buffer_index < 0 || buffer_index >= static_cast<int>(buffers_.size())) {
+    ozz::log::Err() << "Invalid glTF buffer " << buffer_index << "."
+                    << std::endl;
+    return false;
+  }
+  const ozz::Range<const char>& buffer = buffers_[buffer_index];
+  const size_t offset =
+      view["byteOffset"].asUInt() + accessor["byteOffset"].asUInt();
+  const size_t stride = view["byteStride"].asUInt();
+  _accessor->stride = stride != 0 ? stride : element_size;
+
+  // Ensures all elements are within the buffer.
+  if (_accessor->count != 0 &&
+      offset + _accessor->stride * (_accessor->count - 1) + element_size >
+          buffer.count()) {
+    ozz::log::Err() << "glTF accessor " << _index << " is out of buffer range."
+                    << std::endl;
+    return false;
+  }
+  _accessor->data = buffer.begin + offset;
+  return true;
+}
+
+float Gltf2OzzImporter::ReadComponent(const Accessor& _accessor,
+                                      size_t _element, int _component) {
+  assert(_element < _accessor.count &&
+         _component < _accessor.num_components);
+  const char* data = _accessor.data + _element * _accessor.stride;
+  switch (_accessor.component_type) {
+    case kFloat: {
+      return ReadLittleEndian<float>(data + _component * 4);
+    }
+    case kByte: {
+      const float value = static_cast<int8_t>(data[_component]);
+      return _accessor.normalized ? ozz::math::Max(value / 127.f, -1.f)
+                                  : value;
+    }
+    case kUnsignedByte: {
+      const float value = static_cast<uint8_t>(data[_component]);
+      return _accessor.normalized ? value / 255.f : value;
+    }
+    case kShort: {
+      const float value = ReadLittleEndian<int16_t>(data + _component * 2);
+      return _accessor.normalized ? ozz::math::Max(value / 32767.f, -1.f)
+                                  : value;
+    }
+    case kUnsignedShort: {
+      const float value = ReadLittleEndian<uint16_t>(data + _component * 2);
+      return _accessor.normalized ? value / 65535.f : value;
+    }
+    default: {
+      assert(_accessor.component_type == kUnsignedInt);
+      return static_cast<float>(
+          ReadLittleEndian<uint32_t>(data + _component * 4));
+    }
+  }
+}
+
+ozz::String::Std Gltf2OzzImporter::GetNodeName(int _index) const {
+  const Json::Value& name = document_["nodes"][_index]["name"];
+  if (name.isString() && *name.asCString() != 0) {
+    return name.asCString();
+  }
+  std::ostringstream generated;
+  generated << "node" << _index;
+  return generated.str().c_str();
+}
+
+int Gltf2OzzImporter::FindNode(const char* _name) const {
+  for (int i = 0; i < static_cast<int>(parents_.size()); ++i) {
+    if (GetNodeName(i) == _name) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+bool Gltf2OzzImporter::GetNodeTransform(
+    int _index, ozz::math::Transform* _transform) const {
+  const Json::Value& node = document_["nodes"][_index];
+  *_transform = ozz::math::Transform::identity();
+
+  const Json::Value& matrix = node["matrix"];
+  if (matrix.size() == 16) {
+    // Column major matrix.
+    ozz::math::Float4x4 m;
+    for (int c = 0; c < 4; ++c) {
+      m.cols[c] = ozz::math::simd_float4::Load(
+          matrix[c * 4 + 0].asFloat(), matrix[c * 4 + 1].asFloat(),
+          matrix[c * 4 + 2].asFloat(), matrix[c * 4 + 3].asFloat());
+    }
+    ozz::math::SimdFloat4 t, r, s;
+    if (!ToAffine(m, &t, &r, &s)) {
+      return false;
+    }
+    ozz::math::Store3PtrU(t, &_transform->translation.x);
+    ozz::math::StorePtrU(ozz::math::Normalize4(r), &_transform->rotation.x);
+    ozz::math::Store3PtrU(s, &_transform->scale.x);
+    return true;
+  }
+
+  const Json::Value& translation = node["translation"];
+  if (translation.size() == 3) {
+    _transform->translation = ozz::math::Float3(translation[0].asFloat(),
+                                                translation[1].asFloat(),
+                                                translation[2].asFloat());
+  }
+  const Json::Value& rotation = node["rotation"];
+  if (rotation.size() == 4) {
+    _transform->rotation = ozz::math::NormalizeSafe(
+        ozz::math::Quaternion(rotation[0].asFloat(), rotation[1].asFloat(),
+                              rotation[2].asFloat(), rotation[3].asFloat()),
+        ozz::math::Quaternion::identity());
+  }
+  const Json::Value& scale = node["scale"];
+  if (scale.size() == 3) {
+    _transform->scale = ozz::math::Float3(
+        scale[0].asFloat(), scale[1].asFloat(), scale[2].asFloat());
+  }
+  return true;
+}
@@ -0,0 +1,162 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#ifndef OZZ_ANIMATION_OFFLINE_GLTF_GLTF2OZZ_H_
+#define OZZ_ANIMATION_OFFLINE_GLTF_GLTF2OZZ_H_
+
+#include "ozz/animation/offline/tools/import2ozz.h"
+
+#include "ozz/base/containers/string.h"
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/maths/transform.h"
+#include "ozz/base/platform.h"
+
+#include <json/json.h>
+
+// gltf2ozz is a command line tool that converts skeletons and animations
+// imported from a glTF 2.0 document (.gltf or .glb) to ozz runtime format.
+//
+// Binary buffers (glb binary chunk, external .bin files or base64 data uris)
+// are loaded once, and accessors data is read in place. Animation channels
+// with linear interpolation are converted to ozz keyframes without
+// resampling. Step and cubic spline channels are resampled, as ozz only
+// supports linear interpolation. When keyframes are preserved, they are only
+// subdivided between keys that can't be linearly interpolated.
+//
+// Use gltf2ozz integrated help command (gltf2ozz --help) for more details
+// about available arguments.
+
+class Gltf2OzzImporter : public ozz::animation::offline::OzzImporter {
+ public:
+  Gltf2OzzImporter();
+  ~Gltf2OzzImporter();
+
+  // Describes where and how accessor elements are stored. data points to the
+  // first element, directly in buffers memory.
+  struct Accessor {
+    const char* data;
+    size_t count;
+    size_t stride;  // Number of bytes between two consecutive elements.
+    int component_type;
+    int num_components;
+    bool normalized;
+  };
+
+  // Reads component _component of accessor element _element, converted to
+  // float (normalized integers are mapped to [0:1] or [-1:1]).
+  static float ReadComponent(const Accessor& _accessor, size_t _element,
+                             int _component);
+
+ private:
+  virtual bool Load(const char* _filename);
+
+  // Skeleton management
+  virtual bool Import(ozz::animation::offline::RawSkeleton* _skeleton,
+                      const NodeType& _types);
+
+  // Animation management
+  virtual AnimationNames GetAnimationNames();
+
+  virtual bool Import(const char* _animation_name,
+                      const ozz::animation::Skeleton& _skeleton,
+                      float _sampling_rate,
+                      ozz::animation::offline::RawAnimation* _animation);
+
+  virtual bool ImportKeyframes(
+      const char* _animation_name, const ozz::animation::Skeleton& _skeleton,
+      float _sampling_rate, ozz::animation::offline::RawAnimation* _animation);
+
+  // Track management
+  virtual NodeProperties GetNodeProperties(const char* _node_name);
+
+  virtual bool Import(const char* _animation_name, const char* _node_name,
+                      const char* _track_name,
+                      NodeProperty::Type _expected_type, float _sampling_rate,
+                      ozz::animation::offline::RawFloatTrack* _track);
+
+  virtual bool Import(const char* _animation_name, const char* _node_name,
+                      const char* _track_name,
+                      NodeProperty::Type _expected_type, float _sampling_rate,
+                      ozz::animation::offline::RawFloat2Track* _track);
+
+  virtual bool Import(const char* _animation_name, const char* _node_name,
+                      const char* _track_name,
+                      NodeProperty::Type _expected_type, float _sampling_rate,
+                      ozz::animation::offline::RawFloat3Track* _track);
+
+  virtual bool Import(const char* _animation_name, const char* _node_name,
+                      const char* _track_name,
+                      NodeProperty::Type _expected_type, float _sampling_rate,
+                      ozz::animation::offline::RawFloat4Track* _track);
+
+  // Loads buffer _index content, from glb binary chunk, a data uri or a file
+  // relative to _directory.
+  bool LoadBuffer(Json::ArrayIndex _index, const ozz::String::Std& _directory,
+                  ozz::Range<const char> _glb_chunk);
+
+  // Gets accessor _index description. Returns false if accessor is invalid or
+  // isn't supported.
+  bool GetAccessor(int _index, Accessor* _accessor) const;
+
+  // Gets node _index name. Unnamed nodes are given a name built from their
+  // index.
+  ozz::String::Std GetNodeName(int _index) const;
+
+  // Finds a node from its name. Returns -1 if not found.
+  int FindNode(const char* _name) const;
+
+  // Gets node _index rest local transform. Returns false if it can't be
+  // decomposed.
+  bool GetNodeTransform(int _index, ozz::math::Transform* _transform) const;
+
+  // Finds animation index from its name. Returns -1 if not found.
+  int FindAnimation(const char* _name) const;
+
+  // Implements animation import, extracting channels keyframes if _keyframes
+  // is true, or resampling channels uniformly otherwise.
+  bool ImportAnimation(const char* _animation_name,
+                       const ozz::animation::Skeleton& _skeleton,
+                       float _sampling_rate, bool _keyframes,
+                       ozz::animation::offline::RawAnimation* _animation);
+
+  // Parsed json document.
+  Json::Value document_;
+
+  // Whole file content. Glb json and binary chunks are used in place.
+  ozz::Vector<char>::Std file_;
+
+  // Content of buffers loaded from data uris or external files.
+  ozz::Vector<ozz::Vector<char>::Std>::Std buffers_content_;
+
+  // Buffers data, pointing to file_ or buffers_content_.
+  ozz::Vector<ozz::Range<const char> >::Std buffers_;
+
+  // Parent of each node, -1 for roots.
+  ozz::Vector<int>::Std parents_;
+};
+#endif  // OZZ_ANIMATION_OFFLINE_GLTF_GLTF2OZZ_H_
@@ -0,0 +1,588 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#include "animation/offline/gltf/gltf2ozz.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <sstream>
+
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/animation/runtime/skeleton_utils.h"
+
+#include "ozz/base/log.h"
+#include "ozz/base/maths/simd_math.h"
+
+namespace {
+
+// Sampling rate used to resample step and cubic spline channels, when none is
+// specified, as glTF documents have no frame rate.
+const float kDefaultSamplingRate = 30.f;
+
+// Tolerance used to decide whether a cubic spline segment is linear, when its
+// tangents match the segment slope.
+const float kLinearTolerance = 1e-5f;
+
+// Animated node properties.
+enum Path { kTranslation, kRotation, kScale, kNumPaths };
+
+enum Interpolation { kLinear, kStep, kCubicSpline };
+
+// An animation channel, with its sampler accessors.
+struct Channel {
+  Gltf2OzzImporter::Accessor input;
+  Gltf2OzzImporter::Accessor output;
+  Interpolation interpolation;
+};
+
+// Gets animation _index name. Unnamed animations are given a name built from
+// their index.
+ozz::String::Std GetAnimationName(const Json::Value& _animations, int _index) {
+  const Json::Value& name = _animations[_index]["name"];
+  if (name.isString() && *name.asCString() != 0) {
+    return name.asCString();
+  }
+  std::ostringstream generated;
+  generated << "animation" << _index;
+  return generated.str().c_str();
+}
+
+float KeyTime(const Channel& _channel, size_t _key) {
+  return Gltf2OzzImporter::ReadComponent(_channel.input, _key, 0);
+}
+
+// Reads output element _element to _value.
+void ReadValue(const Channel& _channel, size_t _element, float* _value) {
+  for (int c = 0; c < _channel.output.num_components; ++c) {
+    _value[c] = Gltf2OzzImporter::ReadComponent(_channel.output, _element, c);
+  }
+}
+
+// Gets the index of the output element of key _key value. Cubic spline
+// outputs store in-tangent, value and out-tangent for each key.
+size_t ValueElement(const Channel& _channel, size_t _key) {
+  return _channel.interpolation == kCubicSpline ? _key * 3 + 1 : _key;
+}
+
+// Evaluates _channel at _time, to _value. Rotations are interpolated with a
+// normalized lerp, the same way as ozz runtime.
+void Evaluate(const Channel& _channel, float _time, float* _value) {
+  const int num_components = _channel.output.num_components;
+  const size_t num_keys = _channel.input.count;
+
+  // Finds the first key after _time.
+  size_t next = 0;
+  for (size_t count = num_keys; count > 0;) {
+    const size_t step = count / 2;
+    if (KeyTime(_channel, next + step) <= _time) {
+      next += step + 1;
+      count -= step + 1;
+    } else {
+      count = step;
+    }
+  }
+
+  if (next == 0 || next == num_keys || _channel.interpolation == kStep) {
+    ReadValue(_channel, ValueElement(_channel, next == 0 ? 0 : next - 1),
+              _value);
+    return;
+  }
+
+  const size_t prev = next - 1;
+  const float t0 = KeyTime(_channel, prev);
+  const float dt = KeyTime(_channel, next) - t0;
+  const float alpha = (_time - t0) / dt;
+  float v0[4], v1[4];
+  ReadValue(_channel, ValueElement(_channel, prev), v0);
+  ReadValue(_channel, ValueElement(_channel, next), v1);
+
+  if (_channel.interpolation == kLinear) {
+    // Interpolates rotations along the shortest path.
+    float sign = 1.f;
+    if (num_components == 4 &&
+        v0[0] * v1[0] + v0[1] * v1[1] + v0[2] * v1[2] + v0[3] * v1[3] < 0.f) {
+      sign = -1.f;
+    }
+    for (int c = 0; c < num_components; ++c) {
+      _value[c] = v0[c] + (v1[c] * sign - v0[c]) * alpha;
+    }
+  } else {
+    // Cubic Hermite spline, from key out-tangent and next key in-tangent.
+    float out_tangent[4], in_tangent[4];
+    ReadValue(_channel, prev * 3 + 2, out_tangent);
+    ReadValue(_channel, next * 3, in_tangent);
+    const float s2 = alpha * alpha;
+    const float s3 = s2 * alpha;
+    const float h00 = 2.f * s3 - 3.f * s2 + 1.f;
+    const float h10 = s3 - 2.f * s2 + alpha;
+    const float h01 = -2.f * s3 + 3.f * s2;
+    const float h11 = s3 - s2;
+    for (int c = 0; c < num_components; ++c) {
+      _value[c] = h00 * v0[c] + h10 * dt * out_tangent[c] + h01 * v1[c] +
+                  h11 * dt * in_tangent[c];
+    }
+  }
+}
+
+// Tests whether cubic spline segment starting at key _key has tangents that
+// match the segment slope, in which case it's a straight line.
+bool IsLinearSegment(const Channel& _channel, size_t _key, float _dt) {
+  float v0[4], v1[4], out_tangent[4], in_tangent[4];
+  ReadValue(_channel, ValueElement(_channel, _key), v0);
+  ReadValue(_channel, ValueElement(_channel, _key + 1), v1);
+  ReadValue(_channel, _key * 3 + 2, out_tangent);
+  ReadValue(_channel, _key * 3 + 3, in_tangent);
+  for (int c = 0; c < _channel.output.num_components; ++c) {
+    const float delta = v1[c] - v0[c];
+    if (std::abs(out_tangent[c] * _dt - delta) > kLinearTolerance ||
+        std::abs(in_tangent[c] * _dt - delta) > kLinearTolerance) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Appends to _times the times needed to represent _channel with linearly
+// interpolated keys: channel key times, a key one _period before each step
+// change, and _period subdivisions of cubic spline segments that aren't
+// straight lines.
+void ExtractKeyframeTimes(const Channel& _channel, float _period,
+                          ozz::Vector<float>::Std* _times) {
+  const size_t num_keys = _channel.input.count;
+  for (size_t k = 0; k < num_keys; ++k) {
+    const float t0 = KeyTime(_channel, k);
+    _times->push_back(t0);
+    if (k + 1 == num_keys || _channel.interpolation == kLinear) {
+      continue;
+    }
+    const float t1 = KeyTime(_channel, k + 1);
+    const float dt = t1 - t0;
+    if (dt <= 0.f) {
+      continue;
+    }
+    if (_channel.interpolation == kStep) {
+      float v0[4], v1[4];
+      ReadValue(_channel, k, v0);
+      ReadValue(_channel, k + 1, v1);
+      for (int c = 0; c < _channel.output.num_components; ++c) {
+        if (v0[c] != v1[c]) {
+          _times->push_back(t1 - ozz::math::Min(_period, dt * .5f));
+          break;
+        }
+      }
+    } else if (!IsLinearSegment(_channel, k, dt)) {
+      const int divisions = static_cast<int>(std::ceil(dt / _period));
+      for (int i = 1; i < divisions; ++i) {
+        _times->push_back(t0 + dt * i / divisions);
+      }
+    }
+  }
+}
+
+void ToValue(const float* _value, ozz::math::Float3* _out) {
+  *_out = ozz::math::Float3(_value[0], _value[1], _value[2]);
+}
+
+void ToValue(const float* _value, ozz::math::Quaternion* _out) {
+  *_out = ozz::math::NormalizeSafe(
+      ozz::math::Quaternion(_value[0], _value[1], _value[2], _value[3]),
+      ozz::math::Quaternion::identity());
+}
+
+// Pushes a key to _keys, unless its time isn't strictly greater than the
+// last key one, which can happen when key times are offset.
+template <typename _Keys>
+void PushKey(float _time, const typename _Keys::value_type::Value& _value,
+             _Keys* _keys) {
+  if (_keys->empty() || _time > _keys->back().time) {
+    const typename _Keys::value_type key = {_time, _value};
+    _keys->push_back(key);
+  }
+}
+
+// Fills _keys from _channel. Linear channels keyframes are copied without
+// resampling, others are sampled at _times. A single _rest key is used if
+// there's no channel.
+template <typename _Keys>
+void ExtractKeys(const Channel* _channel, const ozz::Vector<float>::Std& _times,
+                 float _start,
+                 const typename _Keys::value_type::Value& _rest,
+                 _Keys* _keys) {
+  typename _Keys::value_type::Value value;
+  float buffer[4];
+  if (!_channel) {
+    PushKey(0.f, _rest, _keys);
+  } else if (_channel->interpolation == kLinear) {
+    _keys->reserve(_channel->input.count);
+    for (size_t k = 0; k < _channel->input.count; ++k) {
+      ReadValue(*_channel, k, buffer);
+      ToValue(buffer, &value);
+      PushKey(KeyTime(*_channel, k) - _start, value, _keys);
+    }
+  } else {
+    _keys->reserve(_times.size());
+    for (size_t i = 0; i < _times.size(); ++i) {
+      Evaluate(*_channel, _times[i], buffer);
+      ToValue(buffer, &value);
+      PushKey(_times[i] - _start, value, _keys);
+    }
+  }
+}
+
+ozz::math::Float4x4 ToMatrix(const ozz::math::Transform& _transform) {
+  return ozz::math::Float4x4::FromAffine(
+      ozz::math::simd_float4::Load3PtrU(&_transform.translation.x),
+      ozz::math::simd_float4::LoadPtrU(&_transform.rotation.x),
+      ozz::math::simd_float4::Load3PtrU(&_transform.scale.x));
+}
+
+bool IsIdentity(const ozz::math::Transform& _transform) {
+  const ozz::math::Transform& identity = ozz::math::Transform::identity();
+  return _transform.translation == identity.translation &&
+         _transform.rotation == identity.rotation &&
+         _transform.scale == identity.scale;
+}
+
+// Resamples all joint channels at _times, and transforms them with _offset,
+// which is the rest transform of the nodes between the joint and its parent.
+bool ResampleJoint(const Channel* const* _channels,
+                   const ozz::math::Transform& _rest,
+                   const ozz::math::Float4x4& _offset,
+                   const ozz::Vector<float>::Std& _times, float _start,
+                   ozz::animation::offline::RawAnimation::JointTrack* _track) {
+  for (size_t i = 0; i < _times.size(); ++i) {
+    ozz::math::Transform local = _rest;
+    float buffer[4];
+    if (_channels[kTranslation]) {
+      Evaluate(*_channels[kTranslation], _times[i], buffer);
+      ToValue(buffer, &local.translation);
+    }
+    if (_channels[kRotation]) {
+      Evaluate(*_channels[kRotation], _times[i], buffer);
+      ToValue(buffer, &local.rotation);
+    }
+    if (_channels[kScale]) {
+      Evaluate(*_channels[kScale], _times[i], buffer);
+      ToValue(buffer, &local.scale);
+    }
+
+    ozz::math::SimdFloat4 t, r, s;
+    if (!ToAffine(_offset * ToMatrix(local), &t, &r, &s)) {
+      return false;
+    }
+    ozz::math::Transform transform;
+    ozz::math::Store3PtrU(t, &transform.translation.x);
+    ozz::math::StorePtrU(ozz::math::Normalize4(r), &transform.rotation.x);
+    ozz::math::Store3PtrU(s, &transform.scale.x);
+
+    const float time = _times[i] - _start;
+    PushKey(time, transform.translation, &_track->translations);
+    PushKey(time, transform.rotation, &_track->rotations);
+    PushKey(time, transform.scale, &_track->scales);
+  }
+  return true;
+}
+}  // namespace
+
+int Gltf2OzzImporter::FindAnimation(const char* _name) const {
+  const Json::Value& animations = document_["animations"];
+  for (int i = 0; i < static_cast<int>(animations.size()); ++i) {
+    if (GetAnimationName(animations, i) == _name) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+Gltf2OzzImporter::AnimationNames Gltf2OzzImporter::GetAnimationNames() {
+  AnimationNames names;
+  const Json::Value& animations = document_["animations"];
+  for (int i = 0; i < static_cast<int>(animations.size()); ++i) {
+    names.push_back(GetAnimationName(animations, i));
+  }
+  return names;
+}
+
+bool Gltf2OzzImporter::Import(
+    const char* _animation_name, const ozz::animation::Skeleton& _skeleton,
+    float _sampling_rate, ozz::animation::offline::RawAnimation* _animation) {
+  return ImportAnimation(_animation_name, _skeleton, _sampling_rate, false,
+                         _animation);
+}
+
+bool Gltf2OzzImporter::ImportKeyframes(
+    const char* _animation_name, const ozz::animation::Skeleton& _skeleton,
+    float _sampling_rate, ozz::animation::offline::RawAnimation* _animation) {
+  return ImportAnimation(_animation_name, _skeleton, _sampling_rate, true,
+                         _animation);
+}
+
+bool Gltf2OzzImporter::ImportAnimation(
+    const char* _animation_name, const ozz::animation::Skeleton& _skeleton,
+    float _sampling_rate, bool _keyframes,
+    ozz::animation::offline::RawAnimation* _animation) {
+  const int animation_index = FindAnimation(_animation_name);
+  if (animation_index < 0) {
+    ozz::log::Err() << "No animation named \"" << _animation_name << "\"."
+                    << std::endl;
+    return false;
+  }
+  const Json::Value& animation = document_["animations"][animation_index];
+  const Json::Value& samplers = animation["samplers"];
+  const Json::Value& channels = animation["channels"];
+
+  // Collects channels, indexed by node and path.
+  const int num_nodes = static_cast<int>(parents_.size());
+  ozz::Vector<Channel>::Std node_channels(num_nodes * kNumPaths);
+  ozz::Vector<bool>::Std animated(num_nodes * kNumPaths, false);
+  float start = std::numeric_limits<float>::max();
+  float end = -std::numeric_limits<float>::max();
+  for (Json::ArrayIndex i = 0; i < channels.size(); ++i) {
+    const Json::Value& target = channels[i]["target"];
+    const ozz::String::Std path = target["path"].asCString();
+    int path_index;
+    if (path == "translation") {
+      path_index = kTranslation;
+    } else if (path == "rotation") {
+      path_index = kRotation;
+    } else if (path == "scale") {
+      path_index = kScale;
+    } else {
+      OZZ_LOGV << "Skips unsupported \"" << path << "\" channel." << std::endl;
+      continue;
+    }
+    const int node = target["node"].asInt();
+    const int sampler_index = channels[i]["sampler"].asInt();
+    if (node < 0 || node >= num_nodes || sampler_index < 0 ||
+        sampler_index >= static_cast<int>(samplers.size())) {
+      ozz::log::Err() << "Invalid glTF animation channel." << std::endl;
+      return false;
+    }
+
+    const Json::Value& sampler = samplers[sampler_index];
+    Channel channel;
+    if (!GetAccessor(sampler["input"].asInt(), &channel.input) ||
+        !GetAccessor(sampler["output"].asInt(), &channel.output)) {
+      return false;
+    }
+    const Json::Value& interpolation = sampler["interpolation"];
+    if (interpolation.isNull() || interpolation.asString() == "LINEAR") {
+      channel.interpolation = kLinear;
+    } else if (interpolation.asString() == "STEP") {
+      channel.interpolation = kStep;
+    } else if (interpolation.asString() == "CUBICSPLINE") {
+      channel.interpolation = kCubicSpline;
+    } else {
+      ozz::log::Err() << "Unsupported glTF interpolation \""
+                      << interpolation.asString() << "\"." << std::endl;
+      return false;
+    }
+
+    // Validates accessors layout.
+    const size_t num_keys = channel.input.count;
+    const size_t elements_per_key =
+        channel.interpolation == kCubicSpline ? 3 : 1;
+    if (num_keys == 0 || channel.input.num_components != 1 ||
+        channel.output.count != num_keys * elements_per_key ||
+        channel.output.num_components != (path_index == kRotation ? 4 : 3)) {
+      ozz::log::Err() << "Invalid glTF animation sampler " << sampler_index
+                      << "." << std::endl;
+      return false;
+    }
+
+    start = ozz::math::Min(start, KeyTime(channel, 0));
+    end = ozz::math::Max(end, KeyTime(channel, num_keys - 1));
+    node_channels[node * kNumPaths + path_index] = channel;
+    animated[node * kNumPaths + path_index] = true;
+  }
+
+  // Animation timeline. Duration could be 0 if it's just a pose, in this case
+  // a default 1s duration is used.
+  if (start > end) {
+    start = end = 0.f;
+  }
+  _animation->duration = end > start ? end - start : 1.f;
+
+  // Times to resample channels that can't be copied, unless keyframes are
+  // extracted per channel.
+  float sampling_rate = kDefaultSamplingRate;
+  if (_sampling_rate > 0.f) {
+    sampling_rate = _sampling_rate;
+  }
+  // Sample times are computed from their index, as accumulated periods drift.
+  // A sample closer than half a period to the end is replaced by the end
+  // sample, as they might be too close to be stored at distinct frames (see
+  // ozz::animation::Animation::num_frames()).
+  ozz::Vector<float>::Std times;
+  const float period = 1.f / sampling_rate;
+  for (int i = 0; !_keyframes; ++i) {
+    const float t = start + i * period;
+    if (t >= end - period * .5f) {
+      times.push_back(end);
+      break;
+    }
+    times.push_back(t);
+  }
+
+  // Builds all skeleton joint tracks.
+  const int num_joints = _skeleton.num_joints();
+  _animation->tracks.resize(num_joints);
+  for (int i = 0; i < num_joints; ++i) {
+    ozz::animation::offline::RawAnimation::JointTrack& track =
+        _animation->tracks[i];
+    const char* joint_name = _skeleton.joint_names()[i];
+    const int node = FindNode(joint_name);
+    if (node < 0) {
+      OZZ_LOGV << "No animation track found for joint \"" << joint_name
+               << "\". Using skeleton bind pose instead." << std::endl;
+      const ozz::math::Transform& bind_pose =
+          ozz::animation::GetJointLocalBindPose(_skeleton, i);
+      PushKey(0.f, bind_pose.translation, &track.translations);
+      PushKey(0.f, bind_pose.rotation, &track.rotations);
+      PushKey(0.f, bind_pose.scale, &track.scales);
+      continue;
+    }
+
+    ozz::math::Transform rest;
+    if (!GetNodeTransform(node, &rest)) {
+      ozz::log::Err() << "Failed to extract node \"" << joint_name
+                      << "\" transform." << std::endl;
+      return false;
+    }
+
+    const Channel* node_channel[kNumPaths];
+    ozz::Vector<float>::Std channel_times[kNumPaths];
+    for (int p = 0; p < kNumPaths; ++p) {
+      node_channel[p] =
+          animated[node * kNumPaths + p] ? &node_channels[node * kNumPaths + p]
+                                         : NULL;
+      if (_keyframes && node_channel[p]) {
+        ExtractKeyframeTimes(*node_channel[p], period, &channel_times[p]);
+      }
+    }
+
+    // Accumulates rest transforms of the nodes between the joint and its
+    // parent joint, which aren't part of the skeleton. Their animation isn't
+    // taken into account.
+    const int16_t parent = _skeleton.joint_parents()[i];
+    const int parent_node =
+        parent == ozz::animation::Skeleton::kNoParent
+            ? -1
+            : FindNode(_skeleton.joint_names()[parent]);
+    ozz::math::Float4x4 offset = ozz::math::Float4x4::identity();
+    bool has_offset = false;
+    for (int n = parents_[node]; n != -1 && n != parent_node; n = parents_[n]) {
+      ozz::math::Transform transform;
+      if (!GetNodeTransform(n, &transform)) {
+        ozz::log::Err() << "Failed to extract node \"" << GetNodeName(n)
+                        << "\" transform." << std::endl;
+        return false;
+      }
+      if (!IsIdentity(transform)) {
+        offset = ToMatrix(transform) * offset;
+        has_offset = true;
+      }
+    }
+
+    if (has_offset) {
+      // All channels are sampled at the same times, as they're combined.
+      ozz::Vector<float>::Std joint_times = times;
+      if (_keyframes) {
+        for (int p = 0; p < kNumPaths; ++p) {
+          joint_times.insert(joint_times.end(), channel_times[p].begin(),
+                             channel_times[p].end());
+        }
+        std::sort(joint_times.begin(), joint_times.end());
+        joint_times.erase(std::unique(joint_times.begin(), joint_times.end()),
+                          joint_times.end());
+        if (joint_times.empty()) {
+          joint_times.push_back(start);
+        }
+      }
+      if (!ResampleJoint(node_channel, rest, offset, joint_times, start,
+                         &track)) {
+        ozz::log::Err() << "Failed to extract animation transform for joint \""
+                        << joint_name << "\"." << std::endl;
+        return false;
+      }
+    } else {
+      const ozz::Vector<float>::Std* sampling_times[kNumPaths];
+      for (int p = 0; p < kNumPaths; ++p) {
+        sampling_times[p] = _keyframes ? &channel_times[p] : &times;
+      }
+      ExtractKeys(node_channel[kTranslation], *sampling_times[kTranslation],
+                  start, rest.translation, &track.translations);
+      ExtractKeys(node_channel[kRotation], *sampling_times[kRotation], start,
+                  rest.rotation, &track.rotations);
+      ExtractKeys(node_channel[kScale], *sampling_times[kScale], start,
+                  rest.scale, &track.scales);
+    }
+  }
+
+  return _animation->Validate();
+}
+
+Gltf2OzzImporter::NodeProperties Gltf2OzzImporter::GetNodeProperties(
+    const char*) {
+  // glTF nodes have no user properties that could be imported as tracks.
+  return NodeProperties();
+}
+
+namespace {
+bool TracksNotSupported() {
+  ozz::log::Err() << "glTF importer doesn't support tracks import."
+                  << std::endl;
+  return false;
+}
+}  // namespace
+
+bool Gltf2OzzImporter::Import(const char*, const char*, const char*,
+                              NodeProperty::Type, float,
+                              ozz::animation::offline::RawFloatTrack*) {
+  return TracksNotSupported();
+}
+
+bool Gltf2OzzImporter::Import(const char*, const char*, const char*,
+                              NodeProperty::Type, float,
+                              ozz::animation::offline::RawFloat2Track*) {
+  return TracksNotSupported();
+}
+
+bool Gltf2OzzImporter::Import(const char*, const char*, const char*,
+                              NodeProperty::Type, float,
+                              ozz::animation::offline::RawFloat3Track*) {
+  return TracksNotSupported();
+}
+
+bool Gltf2OzzImporter::Import(const char*, const char*, const char*,
+                              NodeProperty::Type, float,
+                              ozz::animation::offline::RawFloat4Track*) {
+  return TracksNotSupported();
+}
@@ -0,0 +1,182 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#include "animation/offline/gltf/gltf2ozz.h"
+
+#include "ozz/animation/offline/raw_skeleton.h"
+
+#include "ozz/base/log.h"
+#include "ozz/base/maths/simd_math.h"
+
+namespace {
+
+// Converts a transform to an affine matrix.
+ozz::math::Float4x4 ToMatrix(const ozz::math::Transform& _transform) {
+  return ozz::math::Float4x4::FromAffine(
+      ozz::math::simd_float4::Load3PtrU(&_transform.translation.x),
+      ozz::math::simd_float4::LoadPtrU(&_transform.rotation.x),
+      ozz::math::simd_float4::Load3PtrU(&_transform.scale.x));
+}
+
+// Describes all nodes of the document, indexed by node index.
+struct Nodes {
+  const Json::Value* json;
+  ozz::Vector<ozz::String::Std>::Std names;
+  ozz::Vector<ozz::math::Transform>::Std transforms;
+  ozz::Vector<bool>::Std selected;
+};
+
+// Recursively extracts selected nodes as joints. Nodes that aren't selected
+// are skipped, their transform being accumulated to _offset, which is the
+// transform from the closest selected ancestor space (NULL if identity).
+bool ExtractJoints(const Nodes& _nodes, int _node,
+                   const ozz::math::Float4x4* _offset,
+                   ozz::animation::offline::RawSkeleton::Joint::Children*
+                       _joints) {
+  const ozz::math::Transform& transform = _nodes.transforms[_node];
+  const Json::Value& children = (*_nodes.json)[_node]["children"];
+
+  if (_nodes.selected[_node]) {
+    _joints->resize(_joints->size() + 1);
+    ozz::animation::offline::RawSkeleton::Joint& joint = _joints->back();
+    joint.name = _nodes.names[_node];
+    if (_offset) {
+      ozz::math::SimdFloat4 t, r, s;
+      if (!ToAffine(*_offset * ToMatrix(transform), &t, &r, &s)) {
+        ozz::log::Err() << "Failed to extract skeleton transform for joint \""
+                        << joint.name << "\"." << std::endl;
+        return false;
+      }
+      ozz::math::Store3PtrU(t, &joint.transform.translation.x);
+      ozz::math::StorePtrU(ozz::math::Normalize4(r),
+                           &joint.transform.rotation.x);
+      ozz::math::Store3PtrU(s, &joint.transform.scale.x);
+    } else {
+      joint.transform = transform;
+    }
+
+    // This joint is the new parent for further recursions.
+    for (Json::ArrayIndex c = 0; c < children.size(); ++c) {
+      if (!ExtractJoints(_nodes, children[c].asInt(), NULL, &joint.children)) {
+        return false;
+      }
+    }
+  } else {
+    const ozz::math::Float4x4 offset =
+        _offset ? *_offset * ToMatrix(transform) : ToMatrix(transform);
+    for (Json::ArrayIndex c = 0; c < children.size(); ++c) {
+      if (!ExtractJoints(_nodes, children[c].asInt(), &offset, _joints)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+}  // namespace
+
+bool Gltf2OzzImporter::Import(ozz::animation::offline::RawSkeleton* _skeleton,
+                              const NodeType& _types) {
+  if (!_skeleton) {
+    return false;
+  }
+
+  // Reset skeleton.
+  *_skeleton = ozz::animation::offline::RawSkeleton();
+
+  const Json::Value& nodes_json = document_["nodes"];
+  const int num_nodes = static_cast<int>(nodes_json.size());
+
+  // Flags skins joints, which are glTF skeleton nodes.
+  ozz::Vector<bool>::Std skin_joints(num_nodes, false);
+  const Json::Value& skins = document_["skins"];
+  for (Json::ArrayIndex i = 0; i < skins.size(); ++i) {
+    const Json::Value& joints = skins[i]["joints"];
+    for (Json::ArrayIndex j = 0; j < joints.size(); ++j) {
+      const int joint = joints[j].asInt();
+      if (joint >= 0 && joint < num_nodes) {
+        skin_joints[joint] = true;
+      }
+    }
+  }
+
+  // Selects nodes according to _types. Nodes with no mesh, camera, light and
+  // that aren't skin joints are considered as markers.
+  Nodes nodes;
+  nodes.json = &nodes_json;
+  nodes.names.resize(num_nodes);
+  nodes.transforms.resize(num_nodes);
+  nodes.selected.resize(num_nodes);
+  for (int i = 0; i < num_nodes; ++i) {
+    const Json::Value& node = nodes_json[i];
+    nodes.names[i] = GetNodeName(i);
+    if (!GetNodeTransform(i, &nodes.transforms[i])) {
+      ozz::log::Err() << "Failed to extract node \"" << nodes.names[i]
+                      << "\" transform." << std::endl;
+      return false;
+    }
+    const bool geometry = node.isMember("mesh");
+    const bool camera = node.isMember("camera");
+    const bool light = node["extensions"].isMember("KHR_lights_punctual");
+    const bool marker = !geometry && !camera && !light && !skin_joints[i];
+    nodes.selected[i] = _types.any || (_types.skeleton && skin_joints[i]) ||
+                        (_types.geometry && geometry) ||
+                        (_types.camera && camera) ||
+                        (_types.light && light) || (_types.marker && marker);
+  }
+
+  // Traverses default scene hierarchy, or all root nodes if there's none.
+  ozz::Vector<int>::Std roots;
+  const Json::Value& scenes = document_["scenes"];
+  const Json::ArrayIndex scene = document_["scene"].asUInt();
+  if (scene < scenes.size()) {
+    const Json::Value& scene_nodes = scenes[scene]["nodes"];
+    for (Json::ArrayIndex i = 0; i < scene_nodes.size(); ++i) {
+      const int root = scene_nodes[i].asInt();
+      if (root >= 0 && root < num_nodes) {
+        roots.push_back(root);
+      }
+    }
+  } else {
+    for (int i = 0; i < num_nodes; ++i) {
+      if (parents_[i] == -1) {
+        roots.push_back(i);
+      }
+    }
+  }
+  for (size_t i = 0; i < roots.size(); ++i) {
+    if (!ExtractJoints(nodes, roots[i], NULL, &_skeleton->roots)) {
+      return false;
+    }
+  }
+
+  if (_skeleton->roots.empty()) {
+    ozz::log::Err() << "No skeleton found in glTF document." << std::endl;
+    return false;
+  }
+  return true;
+}
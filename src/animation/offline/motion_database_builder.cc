@@ -0,0 +1,296 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#include "ozz/animation/offline/motion_database_builder.h"
+
+#include <cassert>
+#include <cmath>
+
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/local_to_model_job.h"
+#include "ozz/animation/runtime/motion_database.h"
+#include "ozz/animation/runtime/sampling_job.h"
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/allocator.h"
+
+namespace ozz {
+namespace animation {
+namespace offline {
+
+namespace {
+// Character space of a frame: root joint position and forward direction,
+// projected on the ground plane.
+struct CharacterSpace {
+  math::Float3 origin;
+  float forward_x;
+  float forward_z;
+
+  // Expresses model-space vector _v in *this character space, which is
+  // rotated around y axis.
+  math::Float3 ToLocal(const math::Float3& _v) const {
+    return math::Float3(_v.x * forward_z - _v.z * forward_x, _v.y,
+                        _v.x * forward_x + _v.z * forward_z);
+  }
+};
+
+// Samples _animation at _frequency, and outputs character space and model-space
+// positions of _joints for every frame.
+void SampleClip(const Animation& _animation, const Skeleton& _skeleton,
+                const MotionDatabaseBuilder& _builder,
+                ozz::Vector<CharacterSpace>::Std* _spaces,
+                ozz::Vector<math::Float3>::Std* _positions) {
+  const float duration = _animation.duration();
+  const int num_frames =
+      static_cast<int>(std::floor(duration * _builder.frequency)) + 1;
+
+  SamplingCache cache(_animation.num_tracks());
+  ozz::Vector<math::SoaTransform>::Std locals(_skeleton.num_soa_joints());
+  ozz::Vector<math::Float4x4>::Std models(_skeleton.num_joints());
+
+  SamplingJob sampling_job;
+  sampling_job.animation = &_animation;
+  sampling_job.cache = &cache;
+  sampling_job.output = make_range(locals);
+
+  LocalToModelJob ltm_job;
+  ltm_job.skeleton = &_skeleton;
+  ltm_job.input = make_range(locals);
+  ltm_job.output = make_range(models);
+
+  const math::SimdFloat4 forward =
+      math::simd_float4::Load3PtrU(&_builder.root_forward.x);
+
+  _spaces->resize(num_frames);
+  _positions->resize(num_frames * _builder.joints.size());
+  for (int i = 0; i < num_frames; ++i) {
+    sampling_job.ratio = math::Min(i / (_builder.frequency * duration), 1.f);
+    bool success = sampling_job.Run();
+    success &= ltm_job.Run();
+    (void)success;
+    assert(success);
+
+    // Root is projected on the ground plane.
+    const math::Float4x4& root = models[_builder.root_joint];
+    CharacterSpace& space = (*_spaces)[i];
+    math::Store3PtrU(root.cols[3], &space.origin.x);
+    space.origin.y = 0.f;
+    math::Float3 facing;
+    math::Store3PtrU(math::TransformVector(root, forward), &facing.x);
+    const float len = std::sqrt(facing.x * facing.x + facing.z * facing.z);
+    if (len > 1e-6f) {
+      space.forward_x = facing.x / len;
+      space.forward_z = facing.z / len;
+    } else {
+      space.forward_x = 0.f;
+      space.forward_z = 1.f;
+    }
+
+    for (size_t j = 0; j < _builder.joints.size(); ++j) {
+      math::Store3PtrU(models[_builder.joints[j]].cols[3],
+                       &(*_positions)[i * _builder.joints.size() + j].x);
+    }
+  }
+}
+
+// Computes features of every frame of a clip, from its character spaces and
+// joint positions, and appends them to _features.
+void ComputeClipFeatures(const MotionDatabaseBuilder& _builder,
+                         const ozz::Vector<CharacterSpace>::Std& _spaces,
+                         const ozz::Vector<math::Float3>::Std& _positions,
+                         ozz::Vector<float>::Std* _features) {
+  const int num_frames = static_cast<int>(_spaces.size());
+  const size_t num_joints = _builder.joints.size();
+  for (int i = 0; i < num_frames; ++i) {
+    const CharacterSpace& space = _spaces[i];
+
+    // Joint positions.
+    for (size_t j = 0; j < num_joints; ++j) {
+      const math::Float3 position =
+          space.ToLocal(_positions[i * num_joints + j] - space.origin);
+      _features->push_back(position.x);
+      _features->push_back(position.y);
+      _features->push_back(position.z);
+    }
+
+    // Joint velocities, backward difference for the last frame.
+    const int next = math::Min(i + 1, num_frames - 1);
+    const int prev = math::Max(next - 1, 0);
+    for (size_t j = 0; j < num_joints; ++j) {
+      const math::Float3 velocity =
+          next == prev ? math::Float3::zero()
+                       : space.ToLocal((_positions[next * num_joints + j] -
+                                        _positions[prev * num_joints + j]) *
+                                       _builder.frequency);
+      _features->push_back(velocity.x);
+      _features->push_back(velocity.y);
+      _features->push_back(velocity.z);
+    }
+
+    // Future trajectory positions, then directions.
+    for (int d = 0; d < 2; ++d) {
+      for (size_t t = 0; t < _builder.trajectory_times.size(); ++t) {
+        const float frames = _builder.trajectory_times[t] * _builder.frequency;
+        const int offset = static_cast<int>(std::floor(frames + .5f));
+        const CharacterSpace& future =
+            _spaces[math::Min(i + offset, num_frames - 1)];
+        const math::Float3 value =
+            d == 0 ? space.ToLocal(future.origin - space.origin)
+                   : space.ToLocal(math::Float3(future.forward_x, 0.f,
+                                                future.forward_z));
+        _features->push_back(value.x);
+        _features->push_back(value.z);
+      }
+    }
+  }
+}
+}  // namespace
+
+MotionDatabaseBuilder::MotionDatabaseBuilder()
+    : frequency(30.f),
+      root_joint(0),
+      root_forward(math::Float3::z_axis()),
+      position_weight(1.f),
+      velocity_weight(1.f),
+      trajectory_position_weight(1.f),
+      trajectory_direction_weight(1.f) {
+  trajectory_times.push_back(1.f / 3.f);
+  trajectory_times.push_back(2.f / 3.f);
+  trajectory_times.push_back(1.f);
+}
+
+int MotionDatabaseBuilder::num_features() const {
+  return static_cast<int>(joints.size() * 6 + trajectory_times.size() * 4);
+}
+
+MotionDatabase* MotionDatabaseBuilder::operator()(
+    const Range<const Animation* const>& _animations,
+    const Skeleton& _skeleton) const {
+  // Tests *this validity.
+  const int num_joints = _skeleton.num_joints();
+  bool valid = frequency > 0.f && num_features() > 0 && root_joint >= 0 &&
+               root_joint < num_joints;
+  for (size_t i = 0; valid && i < joints.size(); ++i) {
+    valid = joints[i] >= 0 && joints[i] < num_joints;
+  }
+  for (size_t i = 0; valid && i < trajectory_times.size(); ++i) {
+    valid = trajectory_times[i] >= 0.f;
+  }
+  for (size_t i = 0; valid && i < _animations.count(); ++i) {
+    valid = _animations[i] && _animations[i]->num_tracks() == num_joints;
+  }
+  if (!valid) {
+    return NULL;
+  }
+
+  memory::ScopedAllocationTag tag(memory::kTagBuilder);
+
+  // Samples all clips and computes raw features.
+  const int num_clips = static_cast<int>(_animations.count());
+  ozz::Vector<int>::Std clip_begins(1, 0);
+  ozz::Vector<float>::Std features;
+  ozz::Vector<CharacterSpace>::Std spaces;
+  ozz::Vector<math::Float3>::Std positions;
+  for (int c = 0; c < num_clips; ++c) {
+    SampleClip(*_animations[c], _skeleton, *this, &spaces, &positions);
+    ComputeClipFeatures(*this, spaces, positions, &features);
+    clip_begins.push_back(clip_begins.back() + static_cast<int>(spaces.size()));
+  }
+
+  // Computes normalization offsets (means) and scales. Scales are computed
+  // per group, from the average variance of the group features, so that the
+  // relative magnitude of the features of a group is preserved.
+  const int count = num_features();
+  const int num_frames = clip_begins.back();
+  ozz::Vector<double>::Std means(count, 0.);
+  ozz::Vector<double>::Std variances(count, 0.);
+  for (int f = 0; f < num_frames; ++f) {
+    for (int i = 0; i < count; ++i) {
+      means[i] += features[f * count + i];
+    }
+  }
+  for (int i = 0; i < count; ++i) {
+    means[i] /= math::Max(num_frames, 1);
+  }
+  for (int f = 0; f < num_frames; ++f) {
+    for (int i = 0; i < count; ++i) {
+      const double diff = features[f * count + i] - means[i];
+      variances[i] += diff * diff;
+    }
+  }
+
+  const int num_joint_features = static_cast<int>(joints.size()) * 3;
+  const int num_trajectory_features =
+      static_cast<int>(trajectory_times.size()) * 2;
+  const int group_ends[4] = {
+      num_joint_features, num_joint_features * 2,
+      num_joint_features * 2 + num_trajectory_features, count};
+  const float weights[4] = {position_weight, velocity_weight,
+                            trajectory_position_weight,
+                            trajectory_direction_weight};
+
+  MotionDatabase* database = memory::default_allocator()->New<MotionDatabase>();
+  database->Allocate(num_frames, count, num_clips);
+  database->frequency_ = frequency;
+  for (int c = 0; c <= num_clips; ++c) {
+    database->clip_begins_[c] = clip_begins[c];
+  }
+  for (int g = 0; g < 4; ++g) {
+    const int begin = g == 0 ? 0 : group_ends[g - 1];
+    double variance = 0.;
+    for (int i = begin; i < group_ends[g]; ++i) {
+      variance += variances[i];
+    }
+    const int group_count = (group_ends[g] - begin) * math::Max(num_frames, 1);
+    const float deviation =
+        static_cast<float>(std::sqrt(variance / math::Max(group_count, 1)));
+    const float scale = deviation > 1e-6f ? weights[g] / deviation : weights[g];
+    for (int i = begin; i < group_ends[g]; ++i) {
+      database->offsets_[i] = static_cast<float>(means[i]);
+      database->scales_[i] = scale;
+    }
+  }
+
+  // Fills normalized features matrix.
+  const int stride = database->stride();
+  for (int f = 0; f < num_frames; ++f) {
+    for (int i = 0; i < count; ++i) {
+      database->features_[f * stride + i] =
+          (features[f * count + i] - database->offsets_[i]) *
+          database->scales_[i];
+    }
+  }
+  database->ComputeBounds();
+
+  return database;
+}
+}  // namespace offline
+}  // namespace animation
+}  // namespace ozz
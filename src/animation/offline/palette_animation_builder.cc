@@ -0,0 +1,133 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/offline/palette_animation_builder.h"
+
+#include <cmath>
+#include <cstring>
+
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/local_to_model_job.h"
+#include "ozz/animation/runtime/palette_animation.h"
+#include "ozz/animation/runtime/sampling_job.h"
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/allocator.h"
+
+namespace ozz {
+namespace animation {
+namespace offline {
+
+PaletteAnimationBuilder::PaletteAnimationBuilder() : frequency(30.f) {}
+
+PaletteAnimation* PaletteAnimationBuilder::operator()(
+    const Animation& _animation, const Skeleton& _skeleton) const {
+  // Tests inputs validity.
+  const int num_joints = _skeleton.num_joints();
+  if (_animation.num_tracks() != num_joints || !(frequency > 0.f)) {
+    return NULL;
+  }
+  const bool remapped = inverse_bind_poses.count() != 0;
+  const int palette_size =
+      remapped ? static_cast<int>(inverse_bind_poses.count()) : num_joints;
+  if (joint_remaps.count() != 0 &&
+      joint_remaps.count() != inverse_bind_poses.count()) {
+    return NULL;
+  }
+  for (int i = 0; i < palette_size; ++i) {
+    const int joint = joint_remaps.count() != 0 ? joint_remaps[i] : i;
+    if (joint >= num_joints) {
+      return NULL;
+    }
+  }
+
+  // Computes the number of frames, rounding up the number of intervals, with a
+  // tolerance for floating point approximations.
+  const float intervals = _animation.duration() * frequency;
+  const int num_frames =
+      math::Max(static_cast<int>(std::ceil(intervals - 1e-3f)), 1) + 1;
+
+  PaletteAnimation* animation =
+      memory::default_allocator()->New<PaletteAnimation>();
+  animation->duration_ = _animation.duration();
+  animation->Allocate(std::strlen(_animation.name()), palette_size,
+                      num_frames);
+
+  // Allocates sampling runtime buffers.
+  ozz::Vector<math::SoaTransform>::Std locals(_skeleton.num_soa_joints());
+  ozz::Vector<math::Float4x4>::Std models(num_joints);
+  SamplingCache cache(num_joints, _animation.spline() ? SamplingCache::kSpline
+                                                      : SamplingCache::kFull);
+
+  bool success = true;
+  for (int f = 0; success && f < num_frames; ++f) {
+    SamplingJob sampling_job;
+    sampling_job.animation = &_animation;
+    sampling_job.cache = &cache;
+    sampling_job.ratio = static_cast<float>(f) / (num_frames - 1);
+    sampling_job.output = make_range(locals);
+    success &= sampling_job.Run();
+
+    LocalToModelJob ltm_job;
+    ltm_job.skeleton = &_skeleton;
+    ltm_job.input = make_range(locals);
+    ltm_job.output = make_range(models);
+    success &= ltm_job.Run();
+
+    // Stores palette matrices rows, 3 texels per joint.
+    float* texels = animation->texels_.begin + f * animation->width() * 4;
+    for (int i = 0; i < palette_size; ++i) {
+      const int joint = joint_remaps.count() != 0 ? joint_remaps[i] : i;
+      const math::Float4x4 matrix =
+          remapped ? models[joint] * inverse_bind_poses[i] : models[joint];
+      math::SimdFloat4 rows[4];
+      math::Transpose4x4(matrix.cols, rows);
+      math::StorePtrU(rows[0], texels + 0);
+      math::StorePtrU(rows[1], texels + 4);
+      math::StorePtrU(rows[2], texels + 8);
+      texels += PaletteAnimation::kTexelsPerJoint * 4;
+    }
+  }
+
+  if (!success) {
+    memory::default_allocator()->Delete(animation);
+    return NULL;
+  }
+
+  // Copy animation's name.
+  if (animation->name_) {
+    strcpy(animation->name_, _animation.name());
+  }
+
+  return animation;  // Success.
+}
+}  // namespace offline
+}  // namespace animation
+}  // namespace ozz
@@ -78,6 +78,16 @@ bool RawAnimation::Validate() const {
     }
   }
 
+  // Ensures that synchronization markers are valid, like key frames.
+  float previous_time = -1.f;
+  for (size_t m = 0; m < sync_markers.size(); ++m) {
+    const float time = sync_markers[m];
+    if (time < 0.f || time > duration || time <= previous_time) {
+      return false;
+    }
+    previous_time = time;
+  }
+
   return true;  // *this is valid.
 }
 }  // namespace offline
@@ -27,6 +27,9 @@
 
 #include "ozz/animation/offline/raw_animation.h"
 
+#include <cassert>
+#include <cstring>
+
 #include "ozz/base/io/archive.h"
 #include "ozz/base/maths/math_archive.h"
 
@@ -36,15 +39,104 @@
 
 namespace ozz {
 namespace io {
+namespace {
+// Number of floats of _Keys values, which are float3 or quaternions, whose
+// components are contiguous starting with x.
+template <typename _Keys>
+size_t KeyValueFloats(const _Keys& _keys) {
+  return sizeof(_keys[0].value) / sizeof(float);
+}
+
+// Number of floats of all _Keys times and values.
+template <typename _Keys>
+size_t KeysFloats(const _Keys& _keys) {
+  return _keys.size() * (1 + KeyValueFloats(_keys));
+}
 
+// Copies _keys times, followed by their values, to _floats. Returns the end
+// of the written floats.
+template <typename _Keys>
+float* GatherKeys(const _Keys& _keys, float* _floats) {
+  const size_t num_keys = _keys.size();
+  const size_t value_floats = KeyValueFloats(_keys);
+  float* values = _floats + num_keys;
+  for (size_t i = 0; i < num_keys; ++i) {
+    _floats[i] = _keys[i].time;
+    std::memcpy(values + i * value_floats, &_keys[i].value.x,
+                value_floats * sizeof(float));
+  }
+  return values + num_keys * value_floats;
+}
+
+// Copies times followed by values from _floats to _keys, which are already
+// sized. Returns the end of the read floats.
+template <typename _Keys>
+const float* ScatterKeys(const float* _floats, _Keys* _keys) {
+  const size_t num_keys = _keys->size();
+  const size_t value_floats = KeyValueFloats(*_keys);
+  const float* values = _floats + num_keys;
+  for (size_t i = 0; i < num_keys; ++i) {
+    (*_keys)[i].time = _floats[i];
+    std::memcpy(&(*_keys)[i].value.x, values + i * value_floats,
+                value_floats * sizeof(float));
+  }
+  return values + num_keys * value_floats;
+}
+}  // namespace
+
+// Since version 5, keyframes are stored in a columnar layout: the number of
+// keys of all tracks, followed by all keys times and values. Each track
+// channel stores its keys times contiguously, followed by its values. This
+// allows to load a whole animation with a few large reads. Since version 6,
+// step flags of all tracks follow keys counts.
 void Extern<animation::offline::RawAnimation>::Save(
     OArchive& _archive, const animation::offline::RawAnimation* _animations,
     size_t _count) {
+  ozz::Vector<uint32_t>::Std counts;
+  ozz::Vector<uint8_t>::Std steps;
+  ozz::Vector<float>::Std floats;
   for (size_t i = 0; i < _count; ++i) {
     const animation::offline::RawAnimation& animation = _animations[i];
     _archive << animation.duration;
-    _archive << animation.tracks;
+
+    // Number of keys of every track channel.
+    const size_t num_tracks = animation.tracks.size();
+    counts.resize(num_tracks * 3);
+    steps.resize(num_tracks);
+    size_t num_floats = 0;
+    for (size_t j = 0; j < num_tracks; ++j) {
+      const animation::offline::RawAnimation::JointTrack& track =
+          animation.tracks[j];
+      counts[j * 3 + 0] = static_cast<uint32_t>(track.translations.size());
+      counts[j * 3 + 1] = static_cast<uint32_t>(track.rotations.size());
+      counts[j * 3 + 2] = static_cast<uint32_t>(track.scales.size());
+      steps[j] = track.step ? 1 : 0;
+      num_floats += KeysFloats(track.translations) +
+                    KeysFloats(track.rotations) + KeysFloats(track.scales);
+    }
+    _archive << static_cast<uint32_t>(num_tracks);
+    if (num_tracks > 0) {
+      _archive << ozz::io::MakeArray(&counts[0], counts.size());
+      _archive << ozz::io::MakeArray(&steps[0], steps.size());
+    }
+
+    // Keys times and values.
+    if (num_floats > 0) {
+      floats.resize(num_floats);
+      float* cursor = &floats[0];
+      for (size_t j = 0; j < num_tracks; ++j) {
+        const animation::offline::RawAnimation::JointTrack& track =
+            animation.tracks[j];
+        cursor = GatherKeys(track.translations, cursor);
+        cursor = GatherKeys(track.rotations, cursor);
+        cursor = GatherKeys(track.scales, cursor);
+      }
+      assert(cursor == &floats[0] + num_floats);
+      _archive << ozz::io::MakeArray(&floats[0], num_floats);
+    }
+
     _archive << animation.name;
+    _archive << animation.sync_markers;
   }
 }
 
@@ -56,31 +148,67 @@ void Extern<animation::offline::RawAnimation>::Load(
                << std::endl;
     return;
   }
+  ozz::Vector<uint32_t>::Std counts;
+  ozz::Vector<uint8_t>::Std steps;
+  ozz::Vector<float>::Std floats;
   for (size_t i = 0; i < _count; ++i) {
     animation::offline::RawAnimation& animation = _animations[i];
     _archive >> animation.duration;
-    _archive >> animation.tracks;
+    if (_version >= 5) {
+      uint32_t num_tracks;
+      _archive >> num_tracks;
+      animation.tracks.resize(num_tracks);
+      if (num_tracks > 0) {
+        counts.resize(num_tracks * 3);
+        _archive >> ozz::io::MakeArray(&counts[0], counts.size());
+        steps.assign(num_tracks, 0);
+        if (_version >= 6) {
+          _archive >> ozz::io::MakeArray(&steps[0], steps.size());
+        }
+      }
+      size_t num_floats = 0;
+      for (size_t j = 0; j < num_tracks; ++j) {
+        animation::offline::RawAnimation::JointTrack& track =
+            animation.tracks[j];
+        track.translations.resize(counts[j * 3 + 0]);
+        track.rotations.resize(counts[j * 3 + 1]);
+        track.scales.resize(counts[j * 3 + 2]);
+        track.step = steps[j] != 0;
+        num_floats += KeysFloats(track.translations) +
+                      KeysFloats(track.rotations) + KeysFloats(track.scales);
+      }
+      if (num_floats > 0) {
+        floats.resize(num_floats);
+        _archive >> ozz::io::MakeArray(&floats[0], num_floats);
+        const float* cursor = &floats[0];
+        for (size_t j = 0; j < num_tracks; ++j) {
+          animation::offline::RawAnimation::JointTrack& track =
+              animation.tracks[j];
+          cursor = ScatterKeys(cursor, &track.translations);
+          cursor = ScatterKeys(cursor, &track.rotations);
+          cursor = ScatterKeys(cursor, &track.scales);
+        }
+        assert(cursor == &floats[0] + num_floats);
+      }
+    } else {
+      // Versions prior to 5 store keys one by one.
+      _archive >> animation.tracks;
+    }
     _archive >> animation.name;
+    animation.sync_markers.clear();
+    if (_version >= 4) {
+      _archive >> animation.sync_markers;
+    }
   }
 }
 
-// RawAnimation::*Keys' version can be declared locally as it will be saved from
-// this cpp file only.
+// RawAnimation::*Keys' version can be declared locally as it will be loaded
+// from this cpp file only. They are only used to load versions prior to 5.
 
 OZZ_IO_TYPE_VERSION(1, animation::offline::RawAnimation::JointTrack)
 
 template <>
 struct Extern<animation::offline::RawAnimation::JointTrack> {
-  static void Save(OArchive& _archive,
-                   const animation::offline::RawAnimation::JointTrack* _tracks,
-                   size_t _count) {
-    for (size_t i = 0; i < _count; ++i) {
-      const animation::offline::RawAnimation::JointTrack& track = _tracks[i];
-      _archive << track.translations;
-      _archive << track.rotations;
-      _archive << track.scales;
-    }
-  }
   static void Load(IArchive& _archive,
                    animation::offline::RawAnimation::JointTrack* _tracks,
                    size_t _count, uint32_t _version) {
@@ -90,6 +218,7 @@ struct Extern<animation::offline::RawAnimation::JointTrack> {
       _archive >> track.translations;
       _archive >> track.rotations;
       _archive >> track.scales;
+      track.step = false;
     }
   }
 };
@@ -98,16 +227,6 @@ OZZ_IO_TYPE_VERSION(1, animation::offline::RawAnimation::TranslationKey)
 
 template <>
 struct Extern<animation::offline::RawAnimation::TranslationKey> {
-  static void Save(
-      OArchive& _archive,
-      const animation::offline::RawAnimation::TranslationKey* _keys,
-      size_t _count) {
-    for (size_t i = 0; i < _count; ++i) {
-      const animation::offline::RawAnimation::TranslationKey& key = _keys[i];
-      _archive << key.time;
-      _archive << key.value;
-    }
-  }
   static void Load(IArchive& _archive,
                    animation::offline::RawAnimation::TranslationKey* _keys,
                    size_t _count, uint32_t _version) {
@@ -124,15 +243,6 @@ OZZ_IO_TYPE_VERSION(1, animation::offline::RawAnimation::RotationKey)
 
 template <>
 struct Extern<animation::offline::RawAnimation::RotationKey> {
-  static void Save(OArchive& _archive,
-                   const animation::offline::RawAnimation::RotationKey* _keys,
-                   size_t _count) {
-    for (size_t i = 0; i < _count; ++i) {
-      const animation::offline::RawAnimation::RotationKey& key = _keys[i];
-      _archive << key.time;
-      _archive << key.value;
-    }
-  }
   static void Load(IArchive& _archive,
                    animation::offline::RawAnimation::RotationKey* _keys,
                    size_t _count, uint32_t _version) {
@@ -149,15 +259,6 @@ OZZ_IO_TYPE_VERSION(1, animation::offline::RawAnimation::ScaleKey)
 
 template <>
 struct Extern<animation::offline::RawAnimation::ScaleKey> {
-  static void Save(OArchive& _archive,
-                   const animation::offline::RawAnimation::ScaleKey* _keys,
-                   size_t _count) {
-    for (size_t i = 0; i < _count; ++i) {
-      const animation::offline::RawAnimation::ScaleKey& key = _keys[i];
-      _archive << key.time;
-      _archive << key.value;
-    }
-  }
   static void Load(IArchive& _archive,
                    animation::offline::RawAnimation::ScaleKey* _keys,
                    size_t _count, uint32_t _version) {
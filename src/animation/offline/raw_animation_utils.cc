@@ -27,6 +27,8 @@
 
 #include "ozz/animation/offline/raw_animation_utils.h"
 
+#include <cassert>
+
 namespace ozz {
 namespace animation {
 namespace offline {
@@ -58,6 +60,290 @@ math::Float3 LerpScale(const math::Float3& _a, const math::Float3& _b,
                        float _alpha) {
   return math::Lerp(_a, _b, _alpha);
 }
+
+namespace {
+// Computes cubic Hermite basis functions at _alpha.
+void HermiteBasis(float _alpha, float* _p0, float* _m0, float* _p1,
+                  float* _m1) {
+  const float alpha2 = _alpha * _alpha;
+  const float alpha3 = alpha2 * _alpha;
+  *_p1 = 3.f * alpha2 - 2.f * alpha3;
+  *_p0 = 1.f - *_p1;
+  *_m0 = alpha3 - 2.f * alpha2 + _alpha;
+  *_m1 = alpha3 - alpha2;
+}
+}  // namespace
+
+// Translation Hermite interpolation method.
+// This must be the same interpolation as the one used by the sampling job.
+math::Float3 HermiteTranslation(const math::Float3& _a, const math::Float3& _ta,
+                                const math::Float3& _b, const math::Float3& _tb,
+                                float _alpha) {
+  float p0, m0, p1, m1;
+  HermiteBasis(_alpha, &p0, &m0, &p1, &m1);
+  return _a * p0 + _ta * m0 + _b * p1 + _tb * m1;
+}
+
+// Rotation Hermite interpolation method.
+// This must be the same interpolation as the one used by the sampling job.
+// Components are interpolated independently, and then normalized. Quaternions
+// (and tangents) are expected to be in the same hemisphere, which is ensured
+// by the AnimationBuilder for runtime animations.
+math::Quaternion HermiteRotation(const math::Quaternion& _a,
+                                 const math::Quaternion& _ta,
+                                 const math::Quaternion& _b,
+                                 const math::Quaternion& _tb, float _alpha) {
+  float p0, m0, p1, m1;
+  HermiteBasis(_alpha, &p0, &m0, &p1, &m1);
+  return NormalizeSafe(_a * p0 + _ta * m0 + _b * p1 + _tb * m1, _a);
+}
+
+// Scale Hermite interpolation method.
+// This must be the same interpolation as the one used by the sampling job.
+math::Float3 HermiteScale(const math::Float3& _a, const math::Float3& _ta,
+                          const math::Float3& _b, const math::Float3& _tb,
+                          float _alpha) {
+  float p0, m0, p1, m1;
+  HermiteBasis(_alpha, &p0, &m0, &p1, &m1);
+  return _a * p0 + _ta * m0 + _b * p1 + _tb * m1;
+}
+
+namespace {
+
+// Step interpolation method, which holds _a value until right key _b is
+// reached, see RawAnimation::JointTrack::step.
+template <typename _Value>
+_Value StepValue(const _Value& _a, const _Value& _b, float _alpha) {
+  return _alpha < 1.f ? _a : _b;
+}
+
+// Samples _keys at _time, using _lerp interpolation function.
+template <typename _Key>
+typename _Key::Value SampleKeys(
+    const typename ozz::Vector<_Key>::Std& _keys, float _time,
+    typename _Key::Value (*_lerp)(const typename _Key::Value&,
+                                  const typename _Key::Value&, float)) {
+  if (_keys.empty()) {
+    return _Key::identity();
+  }
+  if (_time <= _keys.front().time) {
+    return _keys.front().value;
+  }
+  if (_time >= _keys.back().time) {
+    return _keys.back().value;
+  }
+  size_t i = 1;
+  while (_keys[i].time < _time) {
+    ++i;
+  }
+  const _Key& left = _keys[i - 1];
+  const _Key& right = _keys[i];
+  const float alpha = (_time - left.time) / (right.time - left.time);
+  return _lerp(left.value, right.value, alpha);
+}
+
+// Samples _keys at every time of sorted _times, using _lerp interpolation
+// function, and outputs values to _member of every _stride transform of
+// _output. The same as SampleKeys, but the right key is found with a forward
+// cursor.
+template <typename _Key>
+void SampleSortedKeys(
+    const typename ozz::Vector<_Key>::Std& _keys,
+    const Range<const float>& _times,
+    typename _Key::Value (*_lerp)(const typename _Key::Value&,
+                                  const typename _Key::Value&, float),
+    typename _Key::Value math::Transform::*_member, size_t _stride,
+    math::Transform* _output) {
+  const size_t num_times = _times.count();
+  if (_keys.empty()) {
+    for (size_t t = 0; t < num_times; ++t) {
+      _output[t * _stride].*_member = _Key::identity();
+    }
+    return;
+  }
+  const _Key& front = _keys.front();
+  const _Key& back = _keys.back();
+  size_t right = 1;
+  for (size_t t = 0; t < num_times; ++t) {
+    const float time = _times[t];
+    typename _Key::Value& value = _output[t * _stride].*_member;
+    if (time <= front.time) {
+      value = front.value;
+    } else if (time >= back.time) {
+      value = back.value;
+    } else {
+      while (_keys[right].time < time) {
+        ++right;
+      }
+      const _Key& left = _keys[right - 1];
+      const float alpha =
+          (time - left.time) / (_keys[right].time - left.time);
+      value = _lerp(left.value, _keys[right].value, alpha);
+    }
+  }
+}
+
+// Copies _input keys in [_begin,_end] interval to _output, shifting their time
+// by -_begin, and adds interpolated keys at interval bounds if needed. A
+// single key track remains a single key track.
+template <typename _Key>
+void ExtractKeys(const typename ozz::Vector<_Key>::Std& _input, float _begin,
+                 float _end,
+                 typename _Key::Value (*_lerp)(const typename _Key::Value&,
+                                               const typename _Key::Value&,
+                                               float),
+                 typename ozz::Vector<_Key>::Std* _output) {
+  _output->clear();
+  if (_input.empty()) {
+    return;  // Identity tracks remain identity.
+  }
+
+  const _Key first = {0.f, SampleKeys<_Key>(_input, _begin, _lerp)};
+  _output->push_back(first);
+  for (size_t i = 0; i < _input.size(); ++i) {
+    const _Key& key = _input[i];
+    if (key.time > _begin && key.time < _end) {
+      const _Key shifted = {key.time - _begin, key.value};
+      _output->push_back(shifted);
+    }
+  }
+  const _Key last = {_end - _begin, SampleKeys<_Key>(_input, _end, _lerp)};
+  if (_input.size() > 1 && last.time > _output->back().time) {
+    _output->push_back(last);
+  }
+}
+}  // namespace
+
+bool SampleAnimation(const RawAnimation& _animation, float _time,
+                     const Range<math::Transform>& _transforms) {
+  return SampleRawAnimation(_animation, Range<const float>(&_time, 1),
+                            _transforms);
+}
+
+bool SampleRawAnimation(const RawAnimation& _animation,
+                        const Range<const float>& _times,
+                        const Range<math::Transform>& _transforms) {
+  if (!_animation.Validate()) {
+    return false;
+  }
+  const size_t num_tracks = _animation.tracks.size();
+  const size_t num_times = _times.count();
+  if (_transforms.count() < num_times * num_tracks) {
+    return false;
+  }
+  for (size_t t = 1; t < num_times; ++t) {
+    if (!(_times[t] >= _times[t - 1])) {
+      return false;
+    }
+  }
+  for (size_t i = 0; i < num_tracks; ++i) {
+    const RawAnimation::JointTrack& track = _animation.tracks[i];
+    math::Transform* output = _transforms.begin + i;
+    SampleSortedKeys<RawAnimation::TranslationKey>(
+        track.translations, _times,
+        track.step ? StepValue<math::Float3> : LerpTranslation,
+        &math::Transform::translation, num_tracks, output);
+    SampleSortedKeys<RawAnimation::RotationKey>(
+        track.rotations, _times,
+        track.step ? StepValue<math::Quaternion> : LerpRotation,
+        &math::Transform::rotation, num_tracks, output);
+    SampleSortedKeys<RawAnimation::ScaleKey>(
+        track.scales, _times, track.step ? StepValue<math::Float3> : LerpScale,
+        &math::Transform::scale, num_tracks, output);
+  }
+  return true;
+}
+
+bool ExtractSegment(const RawAnimation& _input, float _begin, float _end,
+                    RawAnimation* _output) {
+  if (!_output) {
+    return false;
+  }
+  _output->tracks.clear();
+  if (!_input.Validate() || !(_begin >= 0.f) || !(_end > _begin) ||
+      _end > _input.duration) {
+    return false;
+  }
+
+  _output->duration = _end - _begin;
+  _output->name = _input.name;
+  _output->tracks.resize(_input.tracks.size());
+  for (size_t i = 0; i < _input.tracks.size(); ++i) {
+    const RawAnimation::JointTrack& in = _input.tracks[i];
+    RawAnimation::JointTrack& out = _output->tracks[i];
+    out.step = in.step;
+    ExtractKeys<RawAnimation::TranslationKey>(
+        in.translations, _begin, _end,
+        in.step ? StepValue<math::Float3> : LerpTranslation,
+        &out.translations);
+    ExtractKeys<RawAnimation::RotationKey>(
+        in.rotations, _begin, _end,
+        in.step ? StepValue<math::Quaternion> : LerpRotation, &out.rotations);
+    ExtractKeys<RawAnimation::ScaleKey>(
+        in.scales, _begin, _end, in.step ? StepValue<math::Float3> : LerpScale,
+        &out.scales);
+  }
+  assert(_output->Validate());
+  return true;
+}
+
+bool SplitAnimation(const RawAnimation& _input, float _segment_duration,
+                    ozz::Vector<RawAnimation>::Std* _segments) {
+  if (!_segments) {
+    return false;
+  }
+  _segments->clear();
+  if (!_input.Validate() || !(_segment_duration > 0.f)) {
+    return false;
+  }
+
+  // Uses the same segment count computation as SegmentedSamplingJob.
+  size_t count = 1;
+  while (count * _segment_duration < _input.duration) {
+    ++count;
+  }
+  _segments->resize(count);
+  for (size_t i = 0; i < count; ++i) {
+    const float begin = i * _segment_duration;
+    const float end =
+        i == count - 1 ? _input.duration : begin + _segment_duration;
+    if (!ExtractSegment(_input, begin, end, &_segments->at(i))) {
+      _segments->clear();
+      return false;
+    }
+  }
+  return true;
+}
+
+bool ExtractSyncMarkers(const RawFloatTrack& _track, float _threshold,
+                        RawAnimation* _animation) {
+  if (!_track.Validate()) {
+    return false;
+  }
+  _animation->sync_markers.clear();
+  const RawFloatTrack::Keyframes& keys = _track.keyframes;
+  for (size_t i = 1; i < keys.size(); ++i) {
+    const RawFloatTrack::Keyframe& left = keys[i - 1];
+    const RawFloatTrack::Keyframe& right = keys[i];
+    if (!(left.value < _threshold && right.value >= _threshold)) {
+      continue;
+    }
+    // Step keys hold their value up to the next key, linear ones cross the
+    // threshold in between.
+    float ratio = right.ratio;
+    if (left.interpolation == RawTrackInterpolation::kLinear) {
+      const float alpha =
+          (_threshold - left.value) / (right.value - left.value);
+      ratio = left.ratio + (right.ratio - left.ratio) * alpha;
+    }
+    const float time = ratio * _animation->duration;
+    if (_animation->sync_markers.empty() ||
+        time > _animation->sync_markers.back()) {
+      _animation->sync_markers.push_back(time);
+    }
+  }
+  return true;
+}
 }  // namespace offline
 }  // namespace animation
 }  // namespace ozz
@@ -123,6 +123,15 @@ template struct RawTrack<math::Float3>;
 template struct RawTrack<math::Float4>;
 template struct RawTrack<math::Quaternion>;
 }  // namespace internal
+
+bool RawTrackSet::Validate() const {
+  for (size_t i = 0; i < channels.size(); ++i) {
+    if (!channels[i].Validate()) {
+      return false;
+    }
+  }
+  return true;  // Validated.
+}
 }  // namespace offline
 }  // namespace animation
 }  // namespace ozz
@@ -0,0 +1,149 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/offline/root_motion_extractor.h"
+
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/raw_animation_utils.h"
+#include "ozz/animation/offline/raw_track.h"
+
+namespace ozz {
+namespace animation {
+namespace offline {
+
+namespace {
+// Samples extracted yaw _track at _ratio.
+math::Quaternion SampleYaw(const RawQuaternionTrack& _track, float _ratio) {
+  const RawQuaternionTrack::Keyframes& keys = _track.keyframes;
+  if (keys.empty()) {
+    return math::Quaternion::identity();
+  }
+  size_t i = 0;
+  while (i < keys.size() && keys[i].ratio <= _ratio) {
+    ++i;
+  }
+  if (i == 0) {
+    return keys.front().value;
+  } else if (i == keys.size()) {
+    return keys.back().value;
+  }
+  const RawQuaternionTrack::Keyframe& left = keys[i - 1];
+  const RawQuaternionTrack::Keyframe& right = keys[i];
+  const float alpha = (_ratio - left.ratio) / (right.ratio - left.ratio);
+  return LerpRotation(left.value, right.value, alpha);
+}
+}  // namespace
+
+RootMotionExtractor::RootMotionExtractor()
+    : root_joint(0),
+      translation_x(true),
+      translation_y(false),
+      translation_z(true),
+      yaw(true),
+      bake(true) {}
+
+bool RootMotionExtractor::operator()(const RawAnimation& _input,
+                                     RawFloat3Track* _translation,
+                                     RawQuaternionTrack* _rotation,
+                                     RawAnimation* _output) const {
+  if (!_translation || !_rotation) {
+    return false;
+  }
+
+  // Reset outputs to default.
+  *_translation = RawFloat3Track();
+  *_rotation = RawQuaternionTrack();
+  if (_output) {
+    *_output = RawAnimation();
+  }
+
+  // Validate animation.
+  if (!_input.Validate() || root_joint < 0 ||
+      root_joint >= _input.num_tracks()) {
+    return false;
+  }
+
+  const RawAnimation::JointTrack& root = _input.tracks[root_joint];
+  const float inv_duration = 1.f / _input.duration;
+
+  // Extracts translation on selected axes.
+  const math::Float3 mask(translation_x ? 1.f : 0.f, translation_y ? 1.f : 0.f,
+                          translation_z ? 1.f : 0.f);
+  for (size_t i = 0; i < root.translations.size(); ++i) {
+    const RawAnimation::TranslationKey& key = root.translations[i];
+    const RawFloat3Track::Keyframe keyframe = {
+        RawTrackInterpolation::kLinear, key.time * inv_duration,
+        key.value * mask};
+    _translation->keyframes.push_back(keyframe);
+  }
+
+  // Extracts yaw, which is the twist of root rotation around y axis. Keys are
+  // kept in the same hemisphere so they interpolate along the shortest path.
+  math::Quaternion previous = math::Quaternion::identity();
+  for (size_t i = 0; i < root.rotations.size(); ++i) {
+    const RawAnimation::RotationKey& key = root.rotations[i];
+    math::Quaternion twist = math::Quaternion::identity();
+    if (yaw) {
+      const math::Quaternion projected(0.f, key.value.y, 0.f, key.value.w);
+      twist = NormalizeSafe(projected, math::Quaternion::identity());
+      const float dot = twist.y * previous.y + twist.w * previous.w;
+      twist = dot < 0.f ? -twist : twist;
+    }
+    previous = twist;
+    const RawQuaternionTrack::Keyframe keyframe = {
+        RawTrackInterpolation::kLinear, key.time * inv_duration, twist};
+    _rotation->keyframes.push_back(keyframe);
+  }
+
+  if (!_output) {
+    return true;
+  }
+
+  *_output = _input;
+  if (!bake) {
+    return true;
+  }
+
+  // Removes extracted motion from root joint, so that root motion applied as
+  // the parent of the root joint restores original animation:
+  // root = extracted * baked.
+  RawAnimation::JointTrack& baked = _output->tracks[root_joint];
+  for (size_t i = 0; i < baked.translations.size(); ++i) {
+    RawAnimation::TranslationKey& key = baked.translations[i];
+    const math::Quaternion inv_yaw =
+        Conjugate(SampleYaw(*_rotation, key.time * inv_duration));
+    key.value = TransformVector(inv_yaw, key.value - key.value * mask);
+  }
+  for (size_t i = 0; i < baked.rotations.size(); ++i) {
+    RawAnimation::RotationKey& key = baked.rotations[i];
+    key.value = Conjugate(_rotation->keyframes[i].value) * key.value;
+  }
+  return true;
+}
+}  // namespace offline
+}  // namespace animation
+}  // namespace ozz
@@ -27,6 +27,7 @@
 
 #include "ozz/animation/offline/skeleton_builder.h"
 
+#include <algorithm>
 #include <cstring>
 
 #include "ozz/animation/offline/raw_skeleton.h"
@@ -34,6 +35,7 @@
 #include "ozz/base/containers/vector.h"
 #include "ozz/base/maths/soa_transform.h"
 #include "ozz/base/memory/allocator.h"
+#include "ozz/base/platform.h"
 
 namespace ozz {
 namespace animation {
@@ -68,28 +70,237 @@ struct JointLister {
   // Array of joints in the traversed DAG order.
   ozz::Vector<Joint>::Std linear_joints;
 };
+
+// Computes the number of joints of _joint hierarchy, including itself.
+int HierarchySize(const RawSkeleton::Joint& _joint) {
+  int size = 1;
+  for (size_t i = 0; i < _joint.children.size(); ++i) {
+    size += HierarchySize(_joint.children[i]);
+  }
+  return size;
+}
+
+// Computes the coarsest LOD of every joint of _raw_skeleton, indexed in raw
+// depth-first order, by applying _lods rules one after the other.
+void ComputeLODs(const RawSkeleton& _raw_skeleton,
+                 const ozz::Vector<SkeletonLOD>::Std& _lods,
+                 ozz::Vector<int>::Std* _levels) {
+  const int num_joints = _raw_skeleton.num_joints();
+  _levels->assign(num_joints, 0);
+  if (_lods.empty()) {
+    return;
+  }
+
+  JointLister lister(num_joints);
+  IterateJointsDF<JointLister&>(_raw_skeleton, lister);
+  const ozz::Vector<JointLister::Joint>::Std& joints = lister.linear_joints;
+
+  ozz::Vector<int>::Std depths(num_joints);
+  for (int i = 0; i < num_joints; ++i) {
+    const int parent = joints[i].parent;
+    depths[i] = parent == Skeleton::kNoParent ? 0 : depths[parent] + 1;
+  }
+
+  ozz::Vector<bool>::Std kept(num_joints);
+  ozz::Vector<int>::Std children(num_joints);
+  for (size_t l = 0; l < _lods.size(); ++l) {
+    const SkeletonLOD& lod = _lods[l];
+    const int level = static_cast<int>(l);
+
+    // Parents are listed before their children, so removing a joint also
+    // removes its hierarchy.
+    for (int i = 0; i < num_joints; ++i) {
+      const int parent = joints[i].parent;
+      bool keep = (*_levels)[i] == level &&
+                  (parent == Skeleton::kNoParent || kept[parent]) &&
+                  (lod.max_depth < 0 || depths[i] <= lod.max_depth);
+      for (size_t e = 0; keep && e < lod.excluded_joints.size(); ++e) {
+        keep = !strmatch(joints[i].joint->name.c_str(),
+                         lod.excluded_joints[e].c_str());
+      }
+      kept[i] = keep;
+    }
+
+    // Every pass removes all the leaves of the current hierarchy at once.
+    for (int pass = 0; pass < lod.prune_leaves; ++pass) {
+      std::fill(children.begin(), children.end(), 0);
+      for (int i = 0; i < num_joints; ++i) {
+        if (kept[i] && joints[i].parent != Skeleton::kNoParent) {
+          ++children[joints[i].parent];
+        }
+      }
+      for (int i = 0; i < num_joints; ++i) {
+        kept[i] = kept[i] && children[i] != 0;
+      }
+    }
+
+    for (int i = 0; i < num_joints; ++i) {
+      (*_levels)[i] += kept[i];
+    }
+  }
+}
+
+// Sibling joint, sorted by decreasing level of detail first, so that joints of
+// coarse LODs are listed as early as possible. Siblings of the same LOD are
+// then sorted by hierarchy size, if requested. Original order is used to sort
+// siblings last, so that the order is deterministic.
+struct Sibling {
+  int lod;
+  int size;
+  int index;
+  int raw_index;  // Depth-first index in the raw skeleton.
+};
+
+struct SiblingLess {
+  explicit SiblingLess(bool _by_size) : by_size(_by_size) {}
+  bool operator()(const Sibling& _a, const Sibling& _b) const {
+    if (_a.lod != _b.lod) {
+      return _a.lod > _b.lod;
+    }
+    if (by_size && _a.size != _b.size) {
+      return _a.size < _b.size;
+    }
+    return _a.index < _b.index;
+  }
+  bool by_size;
+};
+
+// Lists _children hierarchies in depth-first order, visiting siblings in
+// SiblingLess order (see SkeletonBuilder::optimize_joints_order and
+// SkeletonBuilder::lods). _raw_index is the raw skeleton depth-first index of
+// the first child.
+void ListOptimized(const RawSkeleton::Joint::Children& _children,
+                   int16_t _parent, int _raw_index, bool _optimize,
+                   const ozz::Vector<int>::Std& _levels, JointLister* _lister,
+                   ozz::Vector<int>::Std* _order) {
+  ozz::Vector<Sibling>::Std siblings(_children.size());
+  for (size_t i = 0; i < _children.size(); ++i) {
+    const Sibling sibling = {_levels[_raw_index], HierarchySize(_children[i]),
+                             static_cast<int>(i), _raw_index};
+    siblings[i] = sibling;
+    _raw_index += sibling.size;
+  }
+  std::sort(siblings.begin(), siblings.end(), SiblingLess(_optimize));
+
+  for (size_t i = 0; i < siblings.size(); ++i) {
+    const RawSkeleton::Joint& joint = _children[siblings[i].index];
+    const int16_t index = static_cast<int16_t>(_lister->linear_joints.size());
+    const JointLister::Joint listed = {&joint, _parent};
+    _lister->linear_joints.push_back(listed);
+    _order->push_back(siblings[i].raw_index);
+    ListOptimized(joint.children, index, siblings[i].raw_index + 1, _optimize,
+                  _levels, _lister, _order);
+  }
+}
+
+// Lists _raw_skeleton joints in built skeleton order, and outputs the raw
+// depth-first index of every listed joint to _order. _levels are the raw
+// joints LODs, see ComputeLODs().
+void ListJoints(const RawSkeleton& _raw_skeleton, bool _optimize,
+                const ozz::Vector<int>::Std& _levels, JointLister* _lister,
+                ozz::Vector<int>::Std* _order) {
+  _order->reserve(_raw_skeleton.num_joints());
+  bool has_lods = false;
+  for (size_t i = 0; i < _levels.size() && !has_lods; ++i) {
+    has_lods = _levels[i] != 0;
+  }
+  if (_optimize || has_lods) {
+    ListOptimized(_raw_skeleton.roots, Skeleton::kNoParent, 0, _optimize,
+                  _levels, _lister, _order);
+  } else {
+    IterateJointsDF<JointLister&>(_raw_skeleton, *_lister);
+    for (size_t i = 0; i < _lister->linear_joints.size(); ++i) {
+      _order->push_back(static_cast<int>(i));
+    }
+  }
+}
 }  // namespace
 
-// Validates the RawSkeleton and fills a Skeleton.
-// Uses RawSkeleton::IterateJointsDF to traverse in DAG depth-first order.
-// Building skeleton hierarchy in depth first order make it easier to iterate a
-// skeleton sub-hierarchy.
+SkeletonLOD::SkeletonLOD() : max_depth(-1), prune_leaves(0) {}
+
+SkeletonBuilder::SkeletonBuilder() : optimize_joints_order(false) {}
+
+bool SkeletonBuilder::Validate(const RawSkeleton& _raw_skeleton) const {
+  if (!_raw_skeleton.Validate()) {
+    return false;
+  }
+  // LOD 0 isn't part of the rules.
+  return lods.size() < Skeleton::kMaxLODs;
+}
+
+bool SkeletonBuilder::BuildJointsOrder(const RawSkeleton& _raw_skeleton,
+                                       const Range<int>& _order) const {
+  if (!Validate(_raw_skeleton)) {
+    return false;
+  }
+  const int num_joints = _raw_skeleton.num_joints();
+  if (_order.count() < static_cast<size_t>(num_joints)) {
+    return false;
+  }
+
+  ozz::Vector<int>::Std levels;
+  ComputeLODs(_raw_skeleton, lods, &levels);
+  JointLister lister(num_joints);
+  ozz::Vector<int>::Std order;
+  ListJoints(_raw_skeleton, optimize_joints_order, levels, &lister, &order);
+  std::copy(order.begin(), order.end(), _order.begin);
+  return true;
+}
+
 Skeleton* SkeletonBuilder::operator()(const RawSkeleton& _raw_skeleton) const {
+  return (*this)(_raw_skeleton, memory::default_allocator());
+}
+
+Skeleton* SkeletonBuilder::operator()(const RawSkeleton& _raw_skeleton,
+                                      memory::Allocator* _allocator) const {
+  assert(_allocator && "Invalid allocator");
+  memory::ScopedAllocationTag tag(memory::kTagBuilder);
+
   // Tests _raw_skeleton validity.
-  if (!_raw_skeleton.Validate()) {
+  if (!Validate(_raw_skeleton)) {
     return NULL;
   }
 
   // Everything is fine, allocates and fills the skeleton.
   // Will not fail.
-  Skeleton* skeleton = memory::default_allocator()->New<Skeleton>();
+  Skeleton* skeleton = _allocator->New<Skeleton>(_allocator);
+  if (!skeleton) {
+    return NULL;
+  }
+  Build(_raw_skeleton, skeleton);
+  return skeleton;  // Success.
+}
+
+bool SkeletonBuilder::operator()(const RawSkeleton& _raw_skeleton,
+                                 Skeleton* _skeleton) const {
+  memory::ScopedAllocationTag tag(memory::kTagBuilder);
+
+  // Tests _raw_skeleton validity.
+  if (!_skeleton || !Validate(_raw_skeleton)) {
+    return false;
+  }
+
+  // Replaces _skeleton content, reusing its buffer if it fits.
+  Build(_raw_skeleton, _skeleton);
+  return true;
+}
+
+// Fills a Skeleton from a validated RawSkeleton.
+// Uses RawSkeleton::IterateJointsDF to traverse in DAG depth-first order.
+// Building skeleton hierarchy in depth first order make it easier to iterate a
+// skeleton sub-hierarchy.
+void SkeletonBuilder::Build(const RawSkeleton& _raw_skeleton,
+                            Skeleton* _skeleton) const {
   const int num_joints = _raw_skeleton.num_joints();
 
   // Iterates through all the joint of the raw skeleton and fills a sorted joint
   // list.
   // Iteration order defines runtime skeleton joint ordering.
+  ozz::Vector<int>::Std levels;
+  ComputeLODs(_raw_skeleton, lods, &levels);
   JointLister lister(num_joints);
-  IterateJointsDF<JointLister&>(_raw_skeleton, lister);
+  ozz::Vector<int>::Std order;
+  ListJoints(_raw_skeleton, optimize_joints_order, levels, &lister, &order);
   assert(static_cast<int>(lister.linear_joints.size()) == num_joints);
 
   // Computes name's buffer size.
@@ -100,28 +311,38 @@ Skeleton* SkeletonBuilder::operator()(const RawSkeleton& _raw_skeleton) const {
   }
 
   // Allocates all skeleton members.
-  char* cursor = skeleton->Allocate(chars_size, num_joints);
+  char* cursor = _skeleton->Allocate(chars_size, num_joints);
 
   // Copy names. All names are allocated in a single buffer. Only the first name
   // is set, all other names array entries must be initialized.
+  const char* chars = cursor;
   for (int i = 0; i < num_joints; ++i) {
     const RawSkeleton::Joint& current = *lister.linear_joints[i].joint;
-    skeleton->joint_names_[i] = cursor;
+    _skeleton->joint_names_[i] = cursor;
     strcpy(cursor, current.name.c_str());
     cursor += (current.name.size() + 1) * sizeof(char);
   }
 
   // Transfers sorted joints hierarchy to the new skeleton.
   for (int i = 0; i < num_joints; ++i) {
-    skeleton->joint_parents_[i] = lister.linear_joints[i].parent;
+    _skeleton->joint_parents_[i] = lister.linear_joints[i].parent;
   }
+  _skeleton->ComputeSubtreeEnds();
+  _skeleton->ComputeLevels();
+  _skeleton->ComputeNameHashes(chars);
+
+  // Transfers levels of detail.
+  for (int i = 0; i < num_joints; ++i) {
+    _skeleton->joint_lods_[i] = static_cast<uint8_t>(levels[order[i]]);
+  }
+  _skeleton->ComputeLODEnds();
 
   // Transfers t-poses.
   const math::SimdFloat4 w_axis = math::simd_float4::w_axis();
   const math::SimdFloat4 zero = math::simd_float4::zero();
   const math::SimdFloat4 one = math::simd_float4::one();
 
-  for (int i = 0; i < skeleton->num_soa_joints(); ++i) {
+  for (int i = 0; i < _skeleton->num_soa_joints(); ++i) {
     math::SimdFloat4 translations[4];
     math::SimdFloat4 scales[4];
     math::SimdFloat4 rotations[4];
@@ -143,12 +364,10 @@ Skeleton* SkeletonBuilder::operator()(const RawSkeleton& _raw_skeleton) const {
     }
     // Fills the SoaTransform structure.
     math::Transpose4x3(translations,
-                       &skeleton->joint_bind_poses_[i].translation.x);
-    math::Transpose4x4(rotations, &skeleton->joint_bind_poses_[i].rotation.x);
-    math::Transpose4x3(scales, &skeleton->joint_bind_poses_[i].scale.x);
+                       &_skeleton->joint_bind_poses_[i].translation.x);
+    math::Transpose4x4(rotations, &_skeleton->joint_bind_poses_[i].rotation.x);
+    math::Transpose4x3(scales, &_skeleton->joint_bind_poses_[i].scale.x);
   }
-
-  return skeleton;  // Success.
 }
 }  // namespace offline
 }  // namespace animation
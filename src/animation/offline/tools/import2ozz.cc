@@ -31,6 +31,7 @@
 #include <cstring>
 
 #include "animation/offline/tools/import2ozz_anim.h"
+#include "animation/offline/tools/import2ozz_cache.h"
 #include "animation/offline/tools/import2ozz_config.h"
 #include "animation/offline/tools/import2ozz_skel.h"
 
@@ -73,8 +74,8 @@ ozz::Endianness InitializeEndianness() {
   } else if (std::strcmp(OPTIONS_endian, "big") == 0) {
     endianness = ozz::kBigEndian;
   }
-  ozz::log::LogV() << (endianness == ozz::kLittleEndian ? "Little" : "Big")
-                   << " endian output binary format selected." << std::endl;
+  OZZ_LOGV << (endianness == ozz::kLittleEndian ? "Little" : "Big")
+           << " endian output binary format selected." << std::endl;
   return endianness;
 }
 
@@ -97,6 +98,32 @@ OZZ_OPTIONS_DECLARE_STRING_FN(
     "Selects log level. Can be \"silent\", \"standard\" or \"verbose\".",
     "standard", false, &ValidateLogLevel)
 
+static bool ValidateJobs(const ozz::options::Option& _option, int /*_argc*/) {
+  const ozz::options::IntOption& option =
+      static_cast<const ozz::options::IntOption&>(_option);
+  bool valid = option.value() >= 0;
+  if (!valid) {
+    ozz::log::Err() << "Invalid jobs option \"" << option << "\"" << std::endl;
+  }
+  return valid;
+}
+
+OZZ_OPTIONS_DECLARE_INT_FN(
+    jobs,
+    "Number of animations processed concurrently. 0 selects hardware "
+    "concurrency. Reading from the imported file is serialized, while "
+    "additive, optimization, build and output stages run concurrently.",
+    1, false, &ValidateJobs)
+
+OZZ_OPTIONS_DECLARE_STRING(
+    cache,
+    "Specifies an existing directory where import results are cached across "
+    "runs. Skeleton and animations whose imported file, skeleton and "
+    "configuration didn't change aren't imported again, and imported raw "
+    "animations are reused when only processing settings changed. Empty "
+    "disables the cache.",
+    "", false)
+
 void InitializeLogLevel() {
   ozz::log::Level log_level = ozz::log::GetLevel();
   if (std::strcmp(OPTIONS_log_level, "silent") == 0) {
@@ -107,7 +134,7 @@ void InitializeLogLevel() {
     log_level = ozz::log::kVerbose;
   }
   ozz::log::SetLevel(log_level);
-  ozz::log::LogV() << "Verbose log level activated." << std::endl;
+  OZZ_LOGV << "Verbose log level activated." << std::endl;
 }
 
 namespace ozz {
@@ -151,18 +178,31 @@ int OzzImporter::operator()(int _argc, const char** _argv) {
   }
 
   // Handles skeleton import processing
-  if (!ImportSkeleton(config, this, endianness)) {
+  // Hashes imported file, used to key all cached import steps.
+  const ImportCache cache(OPTIONS_cache, OPTIONS_file);
+
+  if (!ImportSkeleton(config, this, endianness, cache)) {
     return EXIT_FAILURE;
   }
 
   // Handles animations import processing
-  if (!ImportAnimations(config, this, endianness)) {
+  if (!ImportAnimations(config, this, endianness, OPTIONS_jobs, cache)) {
     return EXIT_FAILURE;
   }
 
   return EXIT_SUCCESS;
 }
 
+bool OzzImporter::ImportKeyframes(const char* _animation_name,
+                                  const ozz::animation::Skeleton& _skeleton,
+                                  float _sampling_rate,
+                                  RawAnimation* _animation) {
+  ozz::log::Log() << "Importer doesn't support keyframes extraction, "
+                     "animation will be sampled uniformly."
+                  << std::endl;
+  return Import(_animation_name, _skeleton, _sampling_rate, _animation);
+}
+
 ozz::String::Std OzzImporter::BuildFilename(const char* _filename,
                                             const char* _data_name) const {
   ozz::String::Std output(_filename);
@@ -30,7 +30,14 @@
 #include <cstdlib>
 #include <cstring>
 
+#ifdef OZZ_OFFLINE_THREADS
+#include <atomic>
+#include <mutex>
+#include <thread>
+#endif  // OZZ_OFFLINE_THREADS
+
 #include "animation/offline/tools/import2ozz_anim.h"
+#include "animation/offline/tools/import2ozz_cache.h"
 #include "animation/offline/tools/import2ozz_config.h"
 #include "animation/offline/tools/import2ozz_track.h"
 
@@ -45,10 +52,13 @@
 #include "ozz/animation/runtime/skeleton.h"
 
 #include "ozz/base/io/archive.h"
+#include "ozz/base/io/compressed_stream.h"
 #include "ozz/base/io/stream.h"
 
 #include "ozz/base/maths/soa_transform.h"
 
+#include "ozz/base/containers/vector.h"
+
 #include "ozz/base/log.h"
 
 #include "ozz/options/options.h"
@@ -87,12 +97,10 @@ void DisplaysOptimizationstatistics(const RawAnimation& _non_optimized,
   float scale_ratio =
       non_opt_scales != 0 ? 100.f * opt_scales / non_opt_scales : 0;
 
-  ozz::log::LogV() << "Optimization stage results (% of remaining keys):"
-                   << std::endl;
-  ozz::log::LogV() << " - Translations: " << translation_ratio << "%"
-                   << std::endl;
-  ozz::log::LogV() << " - Rotations: " << rotation_ratio << "%" << std::endl;
-  ozz::log::LogV() << " - Scales: " << scale_ratio << "%" << std::endl;
+  OZZ_LOGV << "Optimization stage results (% of remaining keys):" << std::endl;
+  OZZ_LOGV << " - Translations: " << translation_ratio << "%" << std::endl;
+  OZZ_LOGV << " - Rotations: " << rotation_ratio << "%" << std::endl;
+  OZZ_LOGV << " - Scales: " << scale_ratio << "%" << std::endl;
 }
 
 Skeleton* LoadSkeleton(const char* _path) {
@@ -104,8 +112,7 @@ Skeleton* LoadSkeleton(const char* _path) {
                       << std::endl;
       return NULL;
     }
-    ozz::log::LogV() << "Opens input skeleton ozz binary file: " << _path
-                     << std::endl;
+    OZZ_LOGV << "Opens input skeleton ozz binary file: " << _path << std::endl;
     ozz::io::File file(_path, "rb");
     if (!file.opened()) {
       ozz::log::Err() << "Failed to open input skeleton ozz binary file: \""
@@ -116,14 +123,14 @@ Skeleton* LoadSkeleton(const char* _path) {
 
     // File could contain a RawSkeleton or a Skeleton.
     if (archive.TestTag<RawSkeleton>()) {
-      ozz::log::LogV() << "Reading RawSkeleton from file." << std::endl;
+      OZZ_LOGV << "Reading RawSkeleton from file." << std::endl;
 
       // Reading the skeleton cannot file.
       RawSkeleton raw_skeleton;
       archive >> raw_skeleton;
 
       // Builds runtime skeleton.
-      ozz::log::LogV() << "Builds runtime skeleton." << std::endl;
+      OZZ_LOGV << "Builds runtime skeleton." << std::endl;
       SkeletonBuilder builder;
       skeleton = builder(raw_skeleton);
       if (!skeleton) {
@@ -168,7 +175,7 @@ Vector<math::Transform>::Std SkeletonBindPoseSoAToAoS(
 
 bool Export(OzzImporter& _importer, const RawAnimation& _raw_animation,
             const Skeleton& _skeleton, const Json::Value& _config,
-            const ozz::Endianness _endianness) {
+            const ozz::Endianness _endianness, int _num_threads) {
   // Raw animation to build and output.
   RawAnimation raw_animation;
 
@@ -216,6 +223,40 @@ bool Export(OzzImporter& _importer, const RawAnimation& _raw_animation,
     optimizer.rotation_tolerance = tolerances["rotation"].asFloat();
     optimizer.scale_tolerance = tolerances["scale"].asFloat();
     optimizer.hierarchical_tolerance = tolerances["hierarchical"].asFloat();
+    optimizer.model_space = tolerances["model_space"].asBool();
+    optimizer.model_space_tolerance =
+        tolerances["model_space_tolerance"].asFloat();
+    optimizer.skinning_distance = tolerances["skinning_distance"].asFloat();
+    optimizer.num_threads = _num_threads;
+
+    // Per joint tolerances, matching joints by name. Later overrides have
+    // precedence.
+    const Json::Value& overrides = tolerances["override"];
+    for (Json::ArrayIndex i = 0; i < overrides.size(); ++i) {
+      const Json::Value& joint_override = overrides[i];
+      AnimationOptimizer::JointSetting setting;
+      setting.translation_tolerance = joint_override["translation"].asFloat();
+      setting.rotation_tolerance = joint_override["rotation"].asFloat();
+      setting.scale_tolerance = joint_override["scale"].asFloat();
+      setting.hierarchical_tolerance = joint_override["hierarchical"].asFloat();
+      setting.model_space_tolerance =
+          joint_override["model_space_tolerance"].asFloat();
+
+      const char* pattern = joint_override["name"].asCString();
+      const ozz::Range<const char* const> names = _skeleton.joint_names();
+      bool matched = false;
+      for (size_t j = 0; j < names.count(); ++j) {
+        if (strmatch(names[j], pattern)) {
+          optimizer.joints_setting_override[static_cast<int>(j)] = setting;
+          matched = true;
+        }
+      }
+      if (!matched) {
+        ozz::log::Log() << "No joint found for optimization tolerances "
+                           "override \""
+                        << pattern << "\"." << std::endl;
+      }
+    }
 
     RawAnimation raw_optimized_animation;
     if (!optimizer(raw_animation, _skeleton, &raw_optimized_animation)) {
@@ -235,6 +276,10 @@ bool Export(OzzImporter& _importer, const RawAnimation& _raw_animation,
   if (!_config["raw"].asBool()) {
     ozz::log::Log() << "Builds runtime animation." << std::endl;
     AnimationBuilder builder;
+    builder.seek_interval = _config["seek_interval"].asFloat();
+    builder.bounds_interval = _config["bounds_interval"].asFloat();
+    builder.bounds_skeleton = &_skeleton;
+    builder.num_threads = _num_threads;
     animation = builder(raw_animation);
     if (!animation) {
       ozz::log::Err() << "Failed to build runtime animation." << std::endl;
@@ -251,7 +296,7 @@ bool Export(OzzImporter& _importer, const RawAnimation& _raw_animation,
     ozz::String::Std filename = _importer.BuildFilename(
         _config["filename"].asCString(), _raw_animation.name.c_str());
 
-    ozz::log::LogV() << "Opens output file: " << filename << std::endl;
+    OZZ_LOGV << "Opens output file: " << filename << std::endl;
     ozz::io::File file(filename.c_str(), "wb");
     if (!file.opened()) {
       ozz::log::Err() << "Failed to open output file: \"" << filename << "\""
@@ -260,21 +305,35 @@ bool Export(OzzImporter& _importer, const RawAnimation& _raw_animation,
       return false;
     }
 
+    // Optionally compresses output stream.
+    ozz::io::CompressedStream* compressed = NULL;
+    if (_config["compress"].asBool()) {
+      OZZ_LOGV << "Compresses output archive." << std::endl;
+      compressed =
+          ozz::memory::default_allocator()->New<ozz::io::CompressedStream>(
+              &file, ozz::io::CompressedStream::kCompress);
+    }
+    ozz::io::Stream* stream = compressed;
+    if (!stream) {
+      stream = &file;
+    }
+
     // Initializes output archive.
-    ozz::io::OArchive archive(&file, _endianness);
+    ozz::io::OArchive archive(stream, _endianness);
 
     // Fills output archive with the animation.
     if (_config["raw"].asBool()) {
       ozz::log::Log() << "Outputs RawAnimation to binary archive." << std::endl;
       archive << raw_animation;
     } else {
-      ozz::log::LogV() << "Outputs Animation to binary archive." << std::endl;
+      OZZ_LOGV << "Outputs Animation to binary archive." << std::endl;
       archive << *animation;
     }
+    // Flushes compressed stream before file is closed.
+    ozz::memory::default_allocator()->Delete(compressed);
   }
 
-  ozz::log::LogV() << "Animation binary archive successfully outputted."
-                   << std::endl;
+  OZZ_LOGV << "Animation binary archive successfully outputted." << std::endl;
 
   // Delete local objects.
   ozz::memory::default_allocator()->Delete(animation);
@@ -282,21 +341,167 @@ bool Export(OzzImporter& _importer, const RawAnimation& _raw_animation,
   return true;
 }  // namespace
 
-bool ProcessAnimation(OzzImporter& _importer, const char* _animation_name,
-                      const Skeleton& _skeleton, const Json::Value& _config,
-                      const ozz::Endianness _endianness) {
+#ifdef OZZ_OFFLINE_THREADS
+// Serializes importer calls, as importers (and the sdk they rely on) aren't
+// expected to be thread safe. A NULL mutex doesn't lock anything.
+class ImporterLock {
+ public:
+  explicit ImporterLock(std::mutex* _mutex) : mutex_(_mutex) {
+    if (mutex_) {
+      mutex_->lock();
+    }
+  }
+  ~ImporterLock() {
+    if (mutex_) {
+      mutex_->unlock();
+    }
+  }
+
+ private:
+  ImporterLock(const ImporterLock&);
+  void operator=(const ImporterLock&);
+  std::mutex* mutex_;
+};
+#endif  // OZZ_OFFLINE_THREADS
+
+// An animation to import, with the configuration it matched.
+struct AnimationJob {
+  const char* name;
+  const Json::Value* config;
+  // Cache keys of the imported raw animation, and of the job outputs.
+  uint64_t raw_key;
+  uint64_t key;
+  // Animation output filename.
+  ozz::String::Std filename;
+};
+
+// Shared state of all animations import jobs.
+struct ImportContext {
+  OzzImporter* importer;
+  const Skeleton* skeleton;
+  ozz::Endianness endianness;
+  const ozz::Vector<AnimationJob>::Std* jobs;
+  const ImportCache* cache;
+  // Number of threads used by each job to optimize and build its animation.
+  int num_threads;
+#ifdef OZZ_OFFLINE_THREADS
+  // Locks importer, NULL if jobs aren't processed concurrently.
+  std::mutex* importer_mutex;
+#endif  // OZZ_OFFLINE_THREADS
+};
+
+bool ProcessAnimation(const ImportContext& _context, const AnimationJob& _job) {
+  const Json::Value& config = *_job.config;
   RawAnimation animation;
-  if (!_importer.Import(_animation_name, _skeleton,
-                        _config["sampling_rate"].asFloat(), &animation)) {
-    ozz::log::Err() << "Failed to import animation \"" << _animation_name
-                    << "\"" << std::endl;
+  bool imported;
+  {
+#ifdef OZZ_OFFLINE_THREADS
+    ImporterLock lock(_context.importer_mutex);
+#endif  // OZZ_OFFLINE_THREADS
+    imported = _context.cache->LoadRawAnimation(_job.raw_key, &animation);
+    if (imported) {
+      OZZ_LOGV << "Reuses cached raw animation \"" << _job.name
+               << "\"." << std::endl;
+    } else {
+      const float sampling_rate = config["sampling_rate"].asFloat();
+      if (config["preserve_keyframes"].asBool()) {
+        imported = _context.importer->ImportKeyframes(
+            _job.name, *_context.skeleton, sampling_rate, &animation);
+      } else {
+        imported = _context.importer->Import(_job.name, *_context.skeleton,
+                                             sampling_rate, &animation);
+      }
+      if (imported) {
+        _context.cache->SaveRawAnimation(_job.raw_key, animation);
+      }
+    }
+  }
+  if (!imported) {
+    ozz::log::Err() << "Failed to import animation \"" << _job.name << "\""
+                    << std::endl;
     return false;
-  } else {
-    // Give animation a name
-    animation.name = _animation_name;
+  }
+
+  // Give animation a name
+  animation.name = _job.name;
 
-    return Export(_importer, animation, _skeleton, _config, _endianness);
+  if (!Export(*_context.importer, animation, *_context.skeleton, config,
+              _context.endianness, _context.num_threads)) {
+    return false;
   }
+
+  // Tracks import interleaves importer calls with their processing, so they
+  // are processed while holding the importer.
+#ifdef OZZ_OFFLINE_THREADS
+  ImporterLock lock(_context.importer_mutex);
+#endif  // OZZ_OFFLINE_THREADS
+  const Json::Value& tracks_config = config["tracks"];
+  for (Json::ArrayIndex t = 0; t < tracks_config.size(); ++t) {
+    if (!ProcessTracks(*_context.importer, _job.name, *_context.skeleton,
+                       tracks_config[t], _context.endianness)) {
+      return false;
+    }
+  }
+
+  // All outputs are closed, they can be cached.
+  _context.cache->SetUpToDate(_job.key, _job.filename.c_str());
+  return true;
+}
+
+#ifdef OZZ_OFFLINE_THREADS
+// Processes jobs until there's none left, or one failed.
+void ProcessAnimationsWorker(const ImportContext* _context,
+                             std::atomic<size_t>* _next,
+                             std::atomic<bool>* _success) {
+  memory::ScopedAllocationTag tag(memory::kTagBuilder);
+  const size_t num_jobs = _context->jobs->size();
+  for (size_t i = (*_next)++; *_success && i < num_jobs; i = (*_next)++) {
+    if (!ProcessAnimation(*_context, (*_context->jobs)[i])) {
+      *_success = false;
+    }
+  }
+}
+#endif  // OZZ_OFFLINE_THREADS
+
+// Processes all jobs, up to _num_workers concurrently. Calling thread is used
+// as a worker too.
+bool ProcessAnimations(ImportContext* _context, int _num_workers) {
+#ifdef OZZ_OFFLINE_THREADS
+  const size_t max_workers =
+      _num_workers > 0
+          ? static_cast<size_t>(_num_workers)
+          : static_cast<size_t>(std::thread::hardware_concurrency());
+  const size_t num_workers = math::Min(max_workers, _context->jobs->size());
+  if (num_workers > 1) {
+    std::mutex importer_mutex;
+    _context->importer_mutex = &importer_mutex;
+    // Jobs are already concurrent, nested threads would oversubscribe.
+    _context->num_threads = 1;
+
+    std::atomic<size_t> next(0);
+    std::atomic<bool> success(true);
+    ozz::Vector<std::thread>::Std threads;
+    threads.reserve(num_workers - 1);
+    for (size_t i = 1; i < num_workers; ++i) {
+      threads.emplace_back(ProcessAnimationsWorker, _context, &next, &success);
+    }
+    ProcessAnimationsWorker(_context, &next, &success);
+    for (size_t i = 0; i < threads.size(); ++i) {
+      threads[i].join();
+    }
+    _context->importer_mutex = NULL;
+    return success;
+  }
+#else   // OZZ_OFFLINE_THREADS
+  (void)_num_workers;
+#endif  // OZZ_OFFLINE_THREADS
+  const ozz::Vector<AnimationJob>::Std& jobs = *_context->jobs;
+  for (size_t i = 0; i < jobs.size(); ++i) {
+    if (!ProcessAnimation(*_context, jobs[i])) {
+      return false;
+    }
+  }
+  return true;
 }
 }  // namespace
 
@@ -307,7 +512,8 @@ AdditiveReference::EnumNames AdditiveReference::GetNames() {
 }
 
 bool ImportAnimations(const Json::Value& _config, OzzImporter* _importer,
-                      const ozz::Endianness _endianness) {
+                      const ozz::Endianness _endianness, int _jobs,
+                      const ImportCache& _cache) {
   const Json::Value& skeleton_config = _config["skeleton"];
   const Json::Value& animations_config = _config["animations"];
 
@@ -328,16 +534,23 @@ bool ImportAnimations(const Json::Value& _config, OzzImporter* _importer,
     return true;
   }
 
-  // Iterates all imported animations, build and output them.
-  bool success = true;
-
   // Import skeleton instance.
   Skeleton* skeleton = LoadSkeleton(skeleton_config["filename"].asCString());
-  success &= skeleton != NULL;
+  if (!skeleton) {
+    return false;
+  }
 
-  // Loop though all existing animations, and export those who match
+  // Cache keys depend on the skeleton animations are imported for.
+  const uint64_t skeleton_hash =
+      _cache.enabled()
+          ? HashFile(skeleton_config["filename"].asCString(),
+                     _cache.source_hash())
+          : 0;
+
+  // Loop though all existing animations, and collect those who match
   // configuration.
-  for (Json::ArrayIndex i = 0; success && i < animations_config.size(); ++i) {
+  ozz::Vector<AnimationJob>::Std jobs;
+  for (Json::ArrayIndex i = 0; i < animations_config.size(); ++i) {
     const Json::Value& animation_config = animations_config[i];
     const char* clip_match = animation_config["clip"].asCString();
 
@@ -349,21 +562,33 @@ bool ImportAnimations(const Json::Value& _config, OzzImporter* _importer,
     }
 
     bool matched = false;
-    for (size_t j = 0; success && j < import_animation_names.size(); ++j) {
+    for (size_t j = 0; j < import_animation_names.size(); ++j) {
       const char* animation_name = import_animation_names[j].c_str();
       if (!strmatch(animation_name, clip_match)) {
         continue;
       }
-
       matched = true;
-      success = ProcessAnimation(*_importer, animation_name, *skeleton,
-                                 animation_config, _endianness);
-
-      const Json::Value& tracks_config = animation_config["tracks"];
-      for (Json::ArrayIndex t = 0; success && t < tracks_config.size(); ++t) {
-        success = ProcessTracks(*_importer, animation_name, *skeleton,
-                                tracks_config[t], _endianness);
+      AnimationJob job;
+      job.name = animation_name;
+      job.config = &animation_config;
+      job.raw_key = HashConfig(
+          animation_config["preserve_keyframes"],
+          HashConfig(animation_config["sampling_rate"],
+                     HashString(animation_name, skeleton_hash)));
+      job.key = HashConfig(
+          animation_config,
+          HashBytes(&_endianness, sizeof(_endianness), job.raw_key));
+      job.filename = _importer->BuildFilename(
+          animation_config["filename"].asCString(), animation_name);
+
+      // Skips animations whose inputs didn't change.
+      if (_cache.IsUpToDate(job.key, job.filename.c_str())) {
+        ozz::log::Log() << "Animation \"" << animation_name
+                        << "\" is up to date, import will be skipped."
+                        << std::endl;
+        continue;
       }
+      jobs.push_back(job);
     }
     // Don't display any message if no animation is supposed to be imported.
     if (!matched && *clip_match != 0) {
@@ -372,6 +597,19 @@ bool ImportAnimations(const Json::Value& _config, OzzImporter* _importer,
     }
   }
 
+  // Builds and outputs all matching animations.
+  ImportContext context;
+  context.importer = _importer;
+  context.skeleton = skeleton;
+  context.endianness = _endianness;
+  context.jobs = &jobs;
+  context.cache = &_cache;
+  context.num_threads = 0;
+#ifdef OZZ_OFFLINE_THREADS
+  context.importer_mutex = NULL;
+#endif  // OZZ_OFFLINE_THREADS
+  const bool success = ProcessAnimations(&context, _jobs);
+
   ozz::memory::default_allocator()->Delete(skeleton);
 
   return success;
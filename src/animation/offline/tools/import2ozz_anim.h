@@ -43,8 +43,15 @@ namespace animation {
 namespace offline {
 
 class OzzImporter;
+class ImportCache;
+
+// Imports, processes and outputs all animations matching _config. Up to _jobs
+// animations are processed concurrently, 0 selecting hardware concurrency.
+// _importer calls are serialized. Animations that _cache reports as up to date
+// are skipped, and cached raw animations are reused instead of being imported.
 bool ImportAnimations(const Json::Value& _config, OzzImporter* _importer,
-                      const ozz::Endianness _endianness);
+                      const ozz::Endianness _endianness, int _jobs,
+                      const ImportCache& _cache);
 
 // Additive reference enum to config string conversions.
 struct AdditiveReferenceEnum {
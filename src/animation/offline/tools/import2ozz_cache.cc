@@ -0,0 +1,174 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#include "animation/offline/tools/import2ozz_cache.h"
+
+#include <cstring>
+#include <sstream>
+
+#include "ozz/animation/offline/raw_animation.h"
+
+#include "ozz/base/io/archive.h"
+#include "ozz/base/io/stream.h"
+
+#include "ozz/base/log.h"
+
+#include <json/json.h>
+
+namespace ozz {
+namespace animation {
+namespace offline {
+namespace {
+// Cache format version, to be incremented whenever keys or cached data change.
+const uint64_t kCacheVersion = 1;
+
+// FNV-1a 64 bits parameters.
+const uint64_t kFnvOffsetBasis = 14695981039346656037ULL;
+const uint64_t kFnvPrime = 1099511628211ULL;
+}  // namespace
+
+uint64_t HashBytes(const void* _data, size_t _size, uint64_t _seed) {
+  const unsigned char* bytes = static_cast<const unsigned char*>(_data);
+  uint64_t hash = _seed;
+  for (size_t i = 0; i < _size; ++i) {
+    hash = (hash ^ bytes[i]) * kFnvPrime;
+  }
+  return hash;
+}
+
+uint64_t HashString(const char* _string, uint64_t _seed) {
+  // Includes the nul terminator, so that consecutive strings can't collide.
+  return HashBytes(_string, std::strlen(_string) + 1, _seed);
+}
+
+uint64_t HashFile(const char* _filename, uint64_t _seed) {
+  uint64_t hash = _seed;
+  ozz::io::File file(_filename, "rb");
+  if (file.opened()) {
+    char buffer[16 << 10];
+    for (size_t read = file.Read(buffer, sizeof(buffer)); read != 0;
+         read = file.Read(buffer, sizeof(buffer))) {
+      hash = HashBytes(buffer, read, hash);
+    }
+  }
+  return hash;
+}
+
+uint64_t HashConfig(const Json::Value& _config, uint64_t _seed) {
+  Json::StreamWriterBuilder builder;
+  builder["indentation"] = "";
+  const std::string& document = Json::writeString(builder, _config);
+  return HashBytes(document.c_str(), document.size(), _seed);
+}
+
+ImportCache::ImportCache(const char* _directory, const char* _source)
+    : source_hash_(0) {
+  if (_directory && *_directory != 0) {
+    directory_ = _directory;
+    if (directory_[directory_.size() - 1] != '/') {
+      directory_ += '/';
+    }
+    const uint64_t seed = HashBytes(&kCacheVersion, sizeof(kCacheVersion),
+                                    kFnvOffsetBasis);
+    source_hash_ = HashFile(_source, seed);
+  }
+}
+
+ozz::String::Std ImportCache::BuildPath(uint64_t _key,
+                                        const char* _extension) const {
+  std::ostringstream name;
+  name << std::hex << _key << _extension;
+  return directory_ + name.str().c_str();
+}
+
+bool ImportCache::IsUpToDate(uint64_t _key, const char* _output) const {
+  if (!enabled() || !ozz::io::File::Exist(_output)) {
+    return false;
+  }
+  // Stamp file content is the output filename, which must match.
+  ozz::io::File file(BuildPath(_key, ".stamp").c_str(), "rb");
+  if (!file.opened()) {
+    return false;
+  }
+  const size_t size = std::strlen(_output);
+  if (file.Size() != size) {
+    return false;
+  }
+  ozz::String::Std stamp(size, 0);
+  return file.Read(&stamp[0], size) == size && stamp == _output;
+}
+
+void ImportCache::SetUpToDate(uint64_t _key, const char* _output) const {
+  if (!enabled()) {
+    return;
+  }
+  const ozz::String::Std& path = BuildPath(_key, ".stamp");
+  ozz::io::File file(path.c_str(), "wb");
+  if (!file.opened()) {
+    ozz::log::Err() << "Failed to open cache file \"" << path << "\"."
+                    << std::endl;
+    return;
+  }
+  file.Write(_output, std::strlen(_output));
+}
+
+bool ImportCache::LoadRawAnimation(uint64_t _key,
+                                   RawAnimation* _animation) const {
+  if (!enabled()) {
+    return false;
+  }
+  ozz::io::File file(BuildPath(_key, ".raw").c_str(), "rb");
+  if (!file.opened()) {
+    return false;
+  }
+  ozz::io::IArchive archive(&file);
+  if (!archive.TestTag<RawAnimation>()) {
+    return false;
+  }
+  archive >> *_animation;
+  return _animation->Validate();
+}
+
+void ImportCache::SaveRawAnimation(uint64_t _key,
+                                   const RawAnimation& _animation) const {
+  if (!enabled()) {
+    return;
+  }
+  const ozz::String::Std& path = BuildPath(_key, ".raw");
+  ozz::io::File file(path.c_str(), "wb");
+  if (!file.opened()) {
+    ozz::log::Err() << "Failed to open cache file \"" << path << "\"."
+                    << std::endl;
+    return;
+  }
+  ozz::io::OArchive archive(&file);
+  archive << _animation;
+}
+}  // namespace offline
+}  // namespace animation
+}  // namespace ozz
@@ -0,0 +1,100 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#ifndef OZZ_ANIMATION_OFFLINE_TOOLS_IMPORT2OZZ_CACHE_H_
+#define OZZ_ANIMATION_OFFLINE_TOOLS_IMPORT2OZZ_CACHE_H_
+
+#include "ozz/base/containers/string.h"
+#include "ozz/base/platform.h"
+
+namespace Json {
+class Value;
+}
+
+namespace ozz {
+namespace animation {
+namespace offline {
+
+struct RawAnimation;
+
+// Hashes _size bytes of _data, chained from _seed (FNV-1a).
+uint64_t HashBytes(const void* _data, size_t _size, uint64_t _seed);
+
+// Hashes a nul terminated string, chained from _seed.
+uint64_t HashString(const char* _string, uint64_t _seed);
+
+// Hashes the content of the file at path _filename, chained from _seed. A
+// missing file hashes like an empty file.
+uint64_t HashFile(const char* _filename, uint64_t _seed);
+
+// Hashes a configuration subtree, chained from _seed.
+uint64_t HashConfig(const Json::Value& _config, uint64_t _seed);
+
+// Caches import results across importer runs, in a directory. Import steps are
+// keyed on hashes of their inputs (imported file, skeleton, configuration
+// subtree...), so outputs whose inputs didn't change aren't rebuilt, and
+// imported raw animations are reused when only processing settings changed.
+// Note that keys don't cover importer implementation changes.
+// Cache is disabled if no directory is provided. Once constructed, a cache can
+// be used concurrently, as long as keys are different.
+class ImportCache {
+ public:
+  // Initializes a cache stored in the existing _directory, for the imported
+  // file _source. _directory can be NULL or empty to disable the cache.
+  ImportCache(const char* _directory, const char* _source);
+
+  // Tests if cache is enabled. All other functions fail or do nothing
+  // otherwise.
+  bool enabled() const { return !directory_.empty(); }
+
+  // Hash of the imported file content, to be used as a seed for keys.
+  uint64_t source_hash() const { return source_hash_; }
+
+  // Tests if _output file was produced by the step _key, and still exists.
+  bool IsUpToDate(uint64_t _key, const char* _output) const;
+
+  // Records that _output file was produced by the step _key.
+  void SetUpToDate(uint64_t _key, const char* _output) const;
+
+  // Loads the raw animation cached for _key. Returns false if there's none.
+  bool LoadRawAnimation(uint64_t _key, RawAnimation* _animation) const;
+
+  // Stores _animation for _key.
+  void SaveRawAnimation(uint64_t _key, const RawAnimation& _animation) const;
+
+ private:
+  // Builds the path of the cache file for _key.
+  ozz::String::Std BuildPath(uint64_t _key, const char* _extension) const;
+
+  ozz::String::Std directory_;
+  uint64_t source_hash_;
+};
+}  // namespace offline
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_ANIMATION_OFFLINE_TOOLS_IMPORT2OZZ_CACHE_H_
@@ -35,7 +35,9 @@
 #include "animation/offline/tools/import2ozz_track.h"
 #include "ozz/animation/offline/tools/import2ozz.h"
 
+#include "ozz/animation/offline/animation_builder.h"
 #include "ozz/animation/offline/animation_optimizer.h"
+#include "ozz/animation/offline/skeleton_builder.h"
 #include "ozz/animation/offline/track_optimizer.h"
 
 #include "ozz/base/containers/string.h"
@@ -226,16 +228,41 @@ bool SanitizeSkeletonJointTypes(Json::Value& _root, bool _all_options) {
   return true;
 }
 
+bool SanitizeSkeletonLOD(Json::Value& _root) {
+  MakeDefault(_root, "exclude", "",
+              "Comma separated names of the joints removed from this level of "
+              "detail, along with their hierarchy. Wildcard characters '*' "
+              "and '?' are supported.");
+  MakeDefault(_root, "max_depth", SkeletonLOD().max_depth,
+              "Maximum depth of the joints kept by this level of detail, roots "
+              "having a depth of 0. Set a value < 0 for an unlimited depth.");
+  MakeDefault(_root, "prune_leaves", SkeletonLOD().prune_leaves,
+              "Number of times leaf joints are removed from this level of "
+              "detail.");
+  return true;
+}
+
 bool SanitizeSkeletonImport(Json::Value& _root, bool _all_options) {
-  (void)_all_options;
   MakeDefault(
       _root, "enable", true,
       "Imports (from source data file) and writes skeleton output file.");
   MakeDefault(_root, "raw", false, "Outputs raw skeleton.");
+  MakeDefault(_root, "compress", false,
+              "Compresses output archive (see ozz::io::CompressedStream).");
   MakeDefaultObject(
       _root, "types",
       "Define nodes types that should be considered as skeleton joints.");
   SanitizeSkeletonJointTypes(_root["types"], _all_options);
+  MakeDefaultArray(_root, "lods",
+                   "Levels of detail, each one removing joints from the "
+                   "previous one, the first one being the whole skeleton. "
+                   "Joints are ordered so that the joints of a level of detail "
+                   "are gathered at the beginning of the skeleton.",
+                   !_all_options);
+  Json::Value& lods = _root["lods"];
+  for (Json::ArrayIndex i = 0; i < lods.size(); ++i) {
+    SanitizeSkeletonLOD(lods[i]);
+  }
   return true;
 }
 
@@ -250,7 +277,27 @@ bool SanitizeSkeleton(Json::Value& _root, bool _all_options) {
   return true;
 }
 
-bool SanitizeOptimizationTolerances(Json::Value& _root) {
+bool SanitizeJointOptimizationTolerances(Json::Value& _root,
+                                         const Json::Value& _parent) {
+  MakeDefault(_root, "name", "*",
+              "Name of the joint(s) whose tolerances are overridden. Wildcard "
+              "characters '*' and '?' are supported.");
+  MakeDefault(_root, "translation", _parent["translation"].asFloat(),
+              "Translation optimization tolerance.");
+  MakeDefault(_root, "rotation", _parent["rotation"].asFloat(),
+              "Rotation optimization tolerance.");
+  MakeDefault(_root, "scale", _parent["scale"].asFloat(),
+              "Scale optimization tolerance.");
+  MakeDefault(_root, "hierarchical", _parent["hierarchical"].asFloat(),
+              "Hierarchical translation optimization tolerance. The lowest "
+              "one of a joint hierarchy is used for the joint.");
+  MakeDefault(_root, "model_space_tolerance",
+              _parent["model_space_tolerance"].asFloat(),
+              "Model-space optimization tolerance.");
+  return true;
+}
+
+bool SanitizeOptimizationTolerances(Json::Value& _root, bool _all_options) {
   MakeDefault(
       _root, "translation", AnimationOptimizer().translation_tolerance,
       "Translation optimization tolerance, defined as the distance between two "
@@ -270,6 +317,34 @@ bool SanitizeOptimizationTolerances(Json::Value& _root) {
       "(distance) that an optimization on a joint is allowed to generate on "
       "its whole child hierarchy.");
 
+  MakeDefault(_root, "model_space", AnimationOptimizer().model_space,
+              "Measures the actual model-space error on joints and virtual "
+              "skinning points, instead of local-space and hierarchical "
+              "tolerances.");
+
+  MakeDefault(_root, "model_space_tolerance",
+              AnimationOptimizer().model_space_tolerance,
+              "Model-space optimization tolerance, ie: the maximum distance "
+              "in meters between original and optimized joints and skinning "
+              "points.");
+
+  MakeDefault(_root, "skinning_distance",
+              AnimationOptimizer().skinning_distance,
+              "Distance in meters of virtual skinning points from their "
+              "joint, used by model-space optimization. 0 only measures "
+              "joints positions.");
+
+  MakeDefaultArray(_root, "override",
+                   "Per joint optimization tolerances, overriding the ones "
+                   "above for joints whose name matches. Unspecified "
+                   "tolerances default to the ones above. When multiple "
+                   "entries match a joint, the last one is used.",
+                   !_all_options);
+  Json::Value& overrides = _root["override"];
+  for (Json::ArrayIndex i = 0; i < overrides.size(); ++i) {
+    SanitizeJointOptimizationTolerances(overrides[i], _root);
+  }
+
   return true;
 }
 
@@ -298,6 +373,8 @@ bool SanitizeTrackImport(Json::Value& _root) {
   }
 
   MakeDefault(_root, "raw", false, "Outputs raw track.");
+  MakeDefault(_root, "compress", false,
+              "Compresses output archive (see ozz::io::CompressedStream).");
   MakeDefault(_root, "optimize", true, "Activates keyframes optimization.");
   MakeDefault(_root, "optimization_tolerance", TrackOptimizer().tolerance,
               "Optimization tolerance");
@@ -350,6 +427,8 @@ bool SanitizeAnimation(Json::Value& _root, bool _all_options) {
               "clip name.");
 
   MakeDefault(_root, "raw", false, "Outputs raw animation.");
+  MakeDefault(_root, "compress", false,
+              "Compresses output archive (see ozz::io::CompressedStream).");
 
   MakeDefault(
       _root, "additive", false,
@@ -374,12 +453,28 @@ bool SanitizeAnimation(Json::Value& _root, bool _all_options) {
               "Selects animation sampling rate in hertz. Set a value <= 0 to "
               "use imported scene default frame rate.");
 
+  MakeDefault(_root, "preserve_keyframes", false,
+              "Extracts source keyframes instead of uniformly resampling the "
+              "animation at sampling_rate. Curves that can't be linearly "
+              "interpolated are subdivided, at most at sampling_rate.");
+
   MakeDefault(_root, "optimize", true,
               "Activates keyframes reduction optimization.");
 
   MakeDefaultObject(_root, "optimization_tolerances",
                     "Optimization tolerances.");
-  SanitizeOptimizationTolerances(_root["optimization_tolerances"]);
+  SanitizeOptimizationTolerances(_root["optimization_tolerances"],
+                                 _all_options);
+
+  MakeDefault(_root, "seek_interval", AnimationBuilder().seek_interval,
+              "Interval of time (in seconds) between two consecutive animation "
+              "seek points, used to speed-up backward and scrubbed sampling. "
+              "Set a value <= 0 to disable seek points.");
+
+  MakeDefault(_root, "bounds_interval", AnimationBuilder().bounds_interval,
+              "Interval of time (in seconds) covered by each precomputed "
+              "model-space bounds, used to cull animated objects without "
+              "sampling. Set a value <= 0 to disable bounds.");
 
   MakeDefaultArray(_root, "tracks", "Tracks to build.", !_all_options);
   Json::Value& tracks = _root["tracks"];
@@ -458,7 +553,7 @@ std::string ToString(const Json::Value& _value) {
 
 bool DumpConfig(const char* _path, const Json::Value& _config) {
   if (_path[0] != 0) {
-    ozz::log::LogV() << "Opens config file to dump: " << _path << std::endl;
+    OZZ_LOGV << "Opens config file to dump: " << _path << std::endl;
     std::ofstream file(_path);
     if (!file.is_open()) {
       ozz::log::Err() << "Failed to open config file to dump: \"" << _path
@@ -487,8 +582,8 @@ bool ProcessConfiguration(Json::Value* _config) {
   if (OPTIONS_config.value()[0] != 0) {
     config_string = OPTIONS_config.value();
   } else if (OPTIONS_config_file.value()[0] != 0) {
-    ozz::log::LogV() << "Opens config file: \"" << OPTIONS_config_file << "\"."
-                     << std::endl;
+    OZZ_LOGV << "Opens config file: \"" << OPTIONS_config_file << "\"."
+             << std::endl;
 
     std::ifstream file(OPTIONS_config_file.value());
     if (!file.is_open()) {
@@ -528,10 +623,10 @@ bool ProcessConfiguration(Json::Value* _config) {
   }
 
   // Dumps the config to LogV now it's sanitized.
-  if (ozz::log::GetLevel() >= ozz::log::kVerbose) {
+  if (ozz::log::IsEnabled(ozz::log::kVerbose)) {
     const std::string& document = ToString(*_config);
-    ozz::log::LogV() << "Sanitized configuration:" << std::endl
-                     << document << std::endl;
+    OZZ_LOGV << "Sanitized configuration:" << std::endl
+             << document << std::endl;
   }
 
   // Dumps reference config to file.
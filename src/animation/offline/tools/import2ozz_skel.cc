@@ -31,6 +31,7 @@
 #include <cstring>
 #include <iomanip>
 
+#include "animation/offline/tools/import2ozz_cache.h"
 #include "animation/offline/tools/import2ozz_config.h"
 
 #include "ozz/animation/offline/tools/import2ozz.h"
@@ -44,6 +45,7 @@
 #include "ozz/base/containers/set.h"
 
 #include "ozz/base/io/archive.h"
+#include "ozz/base/io/compressed_stream.h"
 #include "ozz/base/io/stream.h"
 
 #include "ozz/base/log.h"
@@ -55,6 +57,42 @@ namespace animation {
 namespace offline {
 namespace {
 
+// Fills skeleton levels of detail rules from _config.
+bool BuildLODs(const Json::Value& _config,
+               ozz::Vector<SkeletonLOD>::Std* _lods) {
+  if (_config.size() >= Skeleton::kMaxLODs) {
+    ozz::log::Err() << "Too many skeleton levels of detail, maximum is "
+                    << Skeleton::kMaxLODs - 1 << "." << std::endl;
+    return false;
+  }
+  _lods->resize(_config.size());
+  for (Json::ArrayIndex i = 0; i < _config.size(); ++i) {
+    const Json::Value& config = _config[i];
+    SkeletonLOD& lod = (*_lods)[i];
+    lod.max_depth = config["max_depth"].asInt();
+    lod.prune_leaves = config["prune_leaves"].asInt();
+
+    // Splits comma separated names.
+    const ozz::String::Std exclude = config["exclude"].asString().c_str();
+    for (size_t begin = 0; begin < exclude.size();) {
+      size_t end = exclude.find(',', begin);
+      if (end == ozz::String::Std::npos) {
+        end = exclude.size();
+      }
+      if (end != begin) {
+        lod.excluded_joints.push_back(exclude.substr(begin, end - begin));
+      }
+      begin = end + 1;
+    }
+    OZZ_LOGV << "Skeleton level of detail " << i + 1 << " excludes "
+             << lod.excluded_joints.size()
+             << " joint name(s), with maximum depth " << lod.max_depth
+             << " and " << lod.prune_leaves
+             << " leaves pruning pass(es)." << std::endl;
+  }
+  return true;
+}
+
 // Uses a set to detect names uniqueness.
 typedef ozz::Set<const char*, ozz::str_less>::Std Names;
 
@@ -83,31 +121,30 @@ bool ValidateJointNamesUniqueness(const RawSkeleton& _skeleton) {
 
 void LogHierarchy(const RawSkeleton::Joint::Children& _children,
                   int _depth = 0) {
-  const std::streamsize pres = ozz::log::LogV().stream().precision();
   for (size_t i = 0; i < _children.size(); ++i) {
     const RawSkeleton::Joint& joint = _children[i];
-    ozz::log::LogV() << std::setw(_depth) << std::setfill('.') << "";
-    ozz::log::LogV() << joint.name.c_str() << std::setprecision(4)
-                     << " t: " << joint.transform.translation.x << ", "
-                     << joint.transform.translation.y << ", "
-                     << joint.transform.translation.z
-                     << " r: " << joint.transform.rotation.x << ", "
-                     << joint.transform.rotation.y << ", "
-                     << joint.transform.rotation.z << ", "
-                     << joint.transform.rotation.w
-                     << " s: " << joint.transform.scale.x << ", "
-                     << joint.transform.scale.y << ", "
-                     << joint.transform.scale.z << std::endl;
+    OZZ_LOGV << std::setw(_depth) << std::setfill('.') << ""
+             << joint.name.c_str() << std::setprecision(4)
+             << " t: " << joint.transform.translation.x << ", "
+             << joint.transform.translation.y << ", "
+             << joint.transform.translation.z
+             << " r: " << joint.transform.rotation.x << ", "
+             << joint.transform.rotation.y << ", "
+             << joint.transform.rotation.z << ", "
+             << joint.transform.rotation.w
+             << " s: " << joint.transform.scale.x << ", "
+             << joint.transform.scale.y << ", "
+             << joint.transform.scale.z << std::endl;
 
     // Recurse
     LogHierarchy(joint.children, _depth + 1);
   }
-  ozz::log::LogV() << std::setprecision(pres);
 }
 }  // namespace
 
 bool ImportSkeleton(const Json::Value& _config, OzzImporter* _importer,
-                    const ozz::Endianness _endianness) {
+                    const ozz::Endianness _endianness,
+                    const ImportCache& _cache) {
   const Json::Value& skeleton_config = _config["skeleton"];
   const Json::Value& import_config = skeleton_config["import"];
 
@@ -118,6 +155,19 @@ bool ImportSkeleton(const Json::Value& _config, OzzImporter* _importer,
     return true;
   }
 
+  // Skips import if neither the imported file nor the configuration changed.
+  const char* filename = skeleton_config["filename"].asCString();
+  const uint64_t key =
+      HashConfig(skeleton_config,
+                 HashBytes(&_endianness, sizeof(_endianness),
+                           _cache.source_hash()));
+  if (_cache.IsUpToDate(key, filename)) {
+    ozz::log::Log() << "Skeleton \"" << filename
+                    << "\" is up to date, import will be skipped."
+                    << std::endl;
+    return true;
+  }
+
   // Setup node types import properties.
   const Json::Value& types_config = import_config["types"];
   OzzImporter::NodeType types = {0};
@@ -135,7 +185,7 @@ bool ImportSkeleton(const Json::Value& _config, OzzImporter* _importer,
   }
 
   // Log skeleton hierarchy
-  if (ozz::log::GetLevel() == ozz::log::kVerbose) {
+  if (ozz::log::IsEnabled(ozz::log::kVerbose)) {
     LogHierarchy(raw_skeleton.roots);
   }
 
@@ -152,6 +202,9 @@ bool ImportSkeleton(const Json::Value& _config, OzzImporter* _importer,
     // Builds runtime skeleton.
     ozz::log::Log() << "Builds runtime skeleton." << std::endl;
     SkeletonBuilder builder;
+    if (!BuildLODs(import_config["lods"], &builder.lods)) {
+      return false;
+    }
     skeleton = builder(raw_skeleton);
     if (!skeleton) {
       ozz::log::Err() << "Failed to build runtime skeleton." << std::endl;
@@ -164,7 +217,6 @@ bool ImportSkeleton(const Json::Value& _config, OzzImporter* _importer,
   // Once the file is opened, nothing should fail as it would leave an invalid
   // file on the disk.
   {
-    const char* filename = skeleton_config["filename"].asCString();
     ozz::log::Log() << "Opens output file: " << filename << std::endl;
     ozz::io::File file(filename, "wb");
     if (!file.opened()) {
@@ -174,8 +226,21 @@ bool ImportSkeleton(const Json::Value& _config, OzzImporter* _importer,
       return false;
     }
 
+    // Optionally compresses output stream.
+    ozz::io::CompressedStream* compressed = NULL;
+    if (import_config["compress"].asBool()) {
+      OZZ_LOGV << "Compresses output archive." << std::endl;
+      compressed =
+          ozz::memory::default_allocator()->New<ozz::io::CompressedStream>(
+              &file, ozz::io::CompressedStream::kCompress);
+    }
+    ozz::io::Stream* stream = compressed;
+    if (!stream) {
+      stream = &file;
+    }
+
     // Initializes output archive.
-    ozz::io::OArchive archive(&file, _endianness);
+    ozz::io::OArchive archive(stream, _endianness);
 
     // Fills output archive with the skeleton.
     if (import_config["raw"].asBool()) {
@@ -185,10 +250,17 @@ bool ImportSkeleton(const Json::Value& _config, OzzImporter* _importer,
       ozz::log::Log() << "Outputs Skeleton to binary archive." << std::endl;
       archive << *skeleton;
     }
+
+    // Flushes compressed stream before file is closed.
+    ozz::memory::default_allocator()->Delete(compressed);
+
     ozz::log::Log() << "Skeleton binary archive successfully outputted."
                     << std::endl;
   }
 
+  // Output file is closed, it can be cached.
+  _cache.SetUpToDate(key, filename);
+
   // Delete local objects.
   ozz::memory::default_allocator()->Delete(skeleton);
 
@@ -40,9 +40,13 @@ namespace animation {
 namespace offline {
 
 class OzzImporter;
+class ImportCache;
 
+// Imports, builds and outputs the skeleton, unless _cache reports it's up to
+// date.
 bool ImportSkeleton(const Json::Value& _config, OzzImporter* _importer,
-                    const ozz::Endianness _endianness);
+                    const ozz::Endianness _endianness,
+                    const ImportCache& _cache);
 
 }  // namespace offline
 }  // namespace animation
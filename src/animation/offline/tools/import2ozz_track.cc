@@ -41,6 +41,7 @@
 #include "ozz/animation/runtime/track.h"
 
 #include "ozz/base/io/archive.h"
+#include "ozz/base/io/compressed_stream.h"
 #include "ozz/base/io/stream.h"
 
 #include "ozz/base/log.h"
@@ -99,7 +100,7 @@ bool Export(OzzImporter& _importer, const _RawTrack& _raw_track,
 
   // Optimizes track if option is enabled.
   if (_config["optimize"].asBool()) {
-    ozz::log::LogV() << "Optimizing track." << std::endl;
+    OZZ_LOGV << "Optimizing track." << std::endl;
     TrackOptimizer optimizer;
     optimizer.tolerance = _config["optimization_tolerance"].asFloat();
     _RawTrack raw_optimized_track;
@@ -118,7 +119,7 @@ bool Export(OzzImporter& _importer, const _RawTrack& _raw_track,
   // Builds runtime track.
   typename RawTrackToTrack<_RawTrack>::Track* track = NULL;
   if (!_config["raw"].asBool()) {
-    ozz::log::LogV() << "Builds runtime track." << std::endl;
+    OZZ_LOGV << "Builds runtime track." << std::endl;
     TrackBuilder builder;
     track = builder(raw_track);
     if (!track) {
@@ -135,7 +136,7 @@ bool Export(OzzImporter& _importer, const _RawTrack& _raw_track,
     const ozz::String::Std filename = _importer.BuildFilename(
         _config["filename"].asCString(), _raw_track.name.c_str());
 
-    ozz::log::LogV() << "Opens output file: " << filename << std::endl;
+    OZZ_LOGV << "Opens output file: " << filename << std::endl;
     ozz::io::File file(filename.c_str(), "wb");
     if (!file.opened()) {
       ozz::log::Err() << "Failed to open output file: " << filename
@@ -144,21 +145,35 @@ bool Export(OzzImporter& _importer, const _RawTrack& _raw_track,
       return false;
     }
 
+    // Optionally compresses output stream.
+    ozz::io::CompressedStream* compressed = NULL;
+    if (_config["compress"].asBool()) {
+      OZZ_LOGV << "Compresses output archive." << std::endl;
+      compressed =
+          ozz::memory::default_allocator()->New<ozz::io::CompressedStream>(
+              &file, ozz::io::CompressedStream::kCompress);
+    }
+    ozz::io::Stream* stream = compressed;
+    if (!stream) {
+      stream = &file;
+    }
+
     // Initializes output archive.
-    ozz::io::OArchive archive(&file, _endianness);
+    ozz::io::OArchive archive(stream, _endianness);
 
     // Fills output archive with the track.
     if (_config["raw"].asBool()) {
-      ozz::log::LogV() << "Outputs RawTrack to binary archive." << std::endl;
+      OZZ_LOGV << "Outputs RawTrack to binary archive." << std::endl;
       archive << raw_track;
     } else {
-      ozz::log::LogV() << "Outputs Track to binary archive." << std::endl;
+      OZZ_LOGV << "Outputs Track to binary archive." << std::endl;
       archive << *track;
     }
+    // Flushes compressed stream before file is closed.
+    ozz::memory::default_allocator()->Delete(compressed);
   }
 
-  ozz::log::LogV() << "Track binary archive successfully outputted."
-                   << std::endl;
+  OZZ_LOGV << "Track binary archive successfully outputted." << std::endl;
 
   // Delete local objects.
   ozz::memory::default_allocator()->Delete(track);
@@ -220,8 +235,8 @@ bool ProcessImportTrack(OzzImporter& _importer, const char* _animation_name,
       const OzzImporter::NodeProperty& property = properties[p];
       // Checks property name matches
       const char* property_name = property.name.c_str();
-      ozz::log::LogV() << "Inspecting property " << joint_name << ":"
-                       << property_name << "\"." << std::endl;
+      OZZ_LOGV << "Inspecting property " << joint_name << ":"
+               << property_name << "\"." << std::endl;
       if (!strmatch(property_name, ppt_name_match)) {
         continue;
       }
@@ -246,10 +261,10 @@ bool ProcessImportTrack(OzzImporter& _importer, const char* _animation_name,
         continue;
       }
 
-      ozz::log::LogV() << "Found matching property \"" << joint_name << ":"
-                       << property_name << "\" of type \""
-                       << PropertyTypeConfig::GetEnumName(property.type)
-                       << "\"." << std::endl;
+      OZZ_LOGV << "Found matching property \"" << joint_name << ":"
+               << property_name << "\" of type \""
+               << PropertyTypeConfig::GetEnumName(property.type)
+               << "\"." << std::endl;
 
       // A property has been found.
       ppt_found = true;
@@ -0,0 +1,259 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#include <cstdlib>
+#include <cstring>
+
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/raw_skeleton.h"
+#include "ozz/animation/offline/raw_track.h"
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/palette_animation.h"
+#include "ozz/animation/runtime/quantized_track.h"
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/animation/runtime/track.h"
+#include "ozz/animation/runtime/track_set.h"
+#include "ozz/animation/runtime/uniform_animation.h"
+#include "ozz/base/io/archive.h"
+#include "ozz/base/io/compressed_stream.h"
+#include "ozz/base/io/stream.h"
+#include "ozz/base/log.h"
+#include "ozz/base/memory/allocator.h"
+
+#include "ozz/options/options.h"
+
+// Upgrades ozz files (skeletons, animations, tracks...) to the current version
+// of their format, without having to re-import them from source files. Every
+// object of the input file is loaded, converted by the library on load if its
+// version is older, and saved at the current version. Input file can be
+// overwritten, as it's entirely read before output is written.
+
+// Declares command line options.
+OZZ_OPTIONS_DECLARE_STRING(file, "Specifies input file", "", true)
+OZZ_OPTIONS_DECLARE_STRING(output, "Specifies output file", "", true)
+
+static bool ValidateEndianness(const ozz::options::Option& _option,
+                               int /*_argc*/) {
+  const ozz::options::StringOption& option =
+      static_cast<const ozz::options::StringOption&>(_option);
+  bool valid = std::strcmp(option.value(), "native") == 0 ||
+               std::strcmp(option.value(), "little") == 0 ||
+               std::strcmp(option.value(), "big") == 0;
+  if (!valid) {
+    ozz::log::Err() << "Invalid endianness option \"" << option << "\""
+                    << std::endl;
+  }
+  return valid;
+}
+
+OZZ_OPTIONS_DECLARE_STRING_FN(
+    endian,
+    "Selects output endianness mode. Can be \"native\" (same as current "
+    "platform), \"little\" or \"big\".",
+    "native", false, &ValidateEndianness)
+
+OZZ_OPTIONS_DECLARE_BOOL(compress,
+                         "Compresses output file (see "
+                         "ozz::io::CompressedStream).",
+                         false, false)
+
+namespace {
+
+// Result of an upgrade attempt of a single object.
+enum UpgradeResult {
+  kNotMatching,  // Input doesn't contain an object of the tested type.
+  kUpgraded,     // Object was loaded and saved at current version.
+  kUnsupported,  // Object version is more recent than the current one.
+};
+
+// Loads a _Ty object from _input and saves it to _output, if _input contains
+// a _Ty object at its current position.
+template <typename _Ty>
+UpgradeResult Upgrade(ozz::io::IArchive& _input, ozz::io::OArchive& _output,
+                      const char* _name) {
+  if (!_input.TestTag<_Ty>()) {
+    return kNotMatching;
+  }
+  const uint32_t version = _input.PeekVersion<_Ty>();
+  const uint32_t current = ozz::io::internal::Version<const _Ty>::kValue;
+  if (version > current) {
+    ozz::log::Err() << _name << " version " << version
+                    << " is more recent than supported version " << current
+                    << "." << std::endl;
+    return kUnsupported;
+  }
+  if (version != current) {
+    ozz::log::Log() << "Upgrades " << _name << " from version " << version
+                    << " to version " << current << "." << std::endl;
+  } else {
+    OZZ_LOGV << _name << " is already at version " << current << "."
+             << std::endl;
+  }
+
+  // Objects can be big, so they're allocated.
+  _Ty* object = ozz::memory::default_allocator()->New<_Ty>();
+  _input >> *object;
+  _output << *object;
+  ozz::memory::default_allocator()->Delete(object);
+  return kUpgraded;
+}
+
+// Upgrades the object at _input current position, whatever its type.
+UpgradeResult UpgradeAny(ozz::io::IArchive& _input,
+                         ozz::io::OArchive& _output) {
+  typedef UpgradeResult (*Upgrader)(ozz::io::IArchive&, ozz::io::OArchive&,
+                                    const char*);
+  struct Entry {
+    Upgrader upgrade;
+    const char* name;
+  };
+  namespace a = ozz::animation;
+  namespace o = ozz::animation::offline;
+  const Entry entries[] = {
+      {&Upgrade<a::Skeleton>, "Skeleton"},
+      {&Upgrade<a::Animation>, "Animation"},
+      {&Upgrade<a::UniformAnimation>, "UniformAnimation"},
+      {&Upgrade<a::PaletteAnimation>, "PaletteAnimation"},
+      {&Upgrade<a::FloatTrack>, "FloatTrack"},
+      {&Upgrade<a::Float2Track>, "Float2Track"},
+      {&Upgrade<a::Float3Track>, "Float3Track"},
+      {&Upgrade<a::Float4Track>, "Float4Track"},
+      {&Upgrade<a::QuaternionTrack>, "QuaternionTrack"},
+      {&Upgrade<a::QuantizedFloatTrack>, "QuantizedFloatTrack"},
+      {&Upgrade<a::QuantizedFloat2Track>, "QuantizedFloat2Track"},
+      {&Upgrade<a::QuantizedFloat3Track>, "QuantizedFloat3Track"},
+      {&Upgrade<a::QuantizedFloat4Track>, "QuantizedFloat4Track"},
+      {&Upgrade<a::TrackSet>, "TrackSet"},
+      {&Upgrade<o::RawSkeleton>, "RawSkeleton"},
+      {&Upgrade<o::RawAnimation>, "RawAnimation"},
+      {&Upgrade<o::RawFloatTrack>, "RawFloatTrack"},
+      {&Upgrade<o::RawFloat2Track>, "RawFloat2Track"},
+      {&Upgrade<o::RawFloat3Track>, "RawFloat3Track"},
+      {&Upgrade<o::RawFloat4Track>, "RawFloat4Track"},
+      {&Upgrade<o::RawQuaternionTrack>, "RawQuaternionTrack"}};
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(entries); ++i) {
+    const UpgradeResult result =
+        entries[i].upgrade(_input, _output, entries[i].name);
+    if (result != kNotMatching) {
+      return result;
+    }
+  }
+  return kNotMatching;
+}
+}  // namespace
+
+int main(int _argc, const char** _argv) {
+  // Parses arguments.
+  ozz::options::ParseResult parse_result = ozz::options::ParseCommandLine(
+      _argc, _argv, "1.0",
+      "Upgrades ozz files to the current version of their format.");
+  if (parse_result != ozz::options::kSuccess) {
+    return parse_result == ozz::options::kExitSuccess ? EXIT_SUCCESS
+                                                      : EXIT_FAILURE;
+  }
+
+  // Reads the whole input file to memory, so it can be overwritten.
+  ozz::io::MemoryStream input;
+  {
+    ozz::io::File file(OPTIONS_file, "rb");
+    if (!file.opened()) {
+      ozz::log::Err() << "Failed to open input file \"" << OPTIONS_file
+                      << "\"." << std::endl;
+      return EXIT_FAILURE;
+    }
+    char buffer[4096];
+    for (size_t read; (read = file.Read(buffer, sizeof(buffer))) != 0;) {
+      input.Write(buffer, read);
+    }
+    input.Seek(0, ozz::io::Stream::kSet);
+  }
+
+  // Input archive is decompressed transparently.
+  ozz::io::CompressedStream* decompressed = NULL;
+  ozz::io::Stream* input_stream = &input;
+  if (ozz::io::CompressedStream::IsCompressed(&input)) {
+    decompressed =
+        ozz::memory::default_allocator()->New<ozz::io::CompressedStream>(
+            &input, ozz::io::CompressedStream::kDecompress);
+    input_stream = decompressed;
+  }
+
+  ozz::Endianness endianness = ozz::GetNativeEndianness();
+  if (std::strcmp(OPTIONS_endian, "little") == 0) {
+    endianness = ozz::kLittleEndian;
+  } else if (std::strcmp(OPTIONS_endian, "big") == 0) {
+    endianness = ozz::kBigEndian;
+  }
+
+  int num_objects = 0;
+  bool success = input_stream->opened();
+  if (success) {
+    ozz::io::File file(OPTIONS_output, "wb");
+    if (!file.opened()) {
+      ozz::log::Err() << "Failed to open output file \"" << OPTIONS_output
+                      << "\"." << std::endl;
+      success = false;
+    } else {
+      ozz::io::CompressedStream* compressed = NULL;
+      ozz::io::Stream* output_stream = &file;
+      if (OPTIONS_compress) {
+        compressed =
+            ozz::memory::default_allocator()->New<ozz::io::CompressedStream>(
+                &file, ozz::io::CompressedStream::kCompress);
+        output_stream = compressed;
+      }
+
+      // Upgrades all objects of the input file. An object that fails to load
+      // leaves the input stream before its end, and is detected as unknown.
+      ozz::io::IArchive iarchive(input_stream);
+      ozz::io::OArchive oarchive(output_stream, endianness);
+      while (success && input_stream->Tell() <
+                            static_cast<int64_t>(input_stream->Size())) {
+        const UpgradeResult result = UpgradeAny(iarchive, oarchive);
+        if (result == kNotMatching) {
+          ozz::log::Err() << "Unknown or invalid object found in \""
+                          << OPTIONS_file << "\"." << std::endl;
+        }
+        success = result == kUpgraded;
+        num_objects += success;
+      }
+      ozz::memory::default_allocator()->Delete(compressed);
+    }
+  } else {
+    ozz::log::Err() << "Failed to decompress input file \"" << OPTIONS_file
+                    << "\"." << std::endl;
+  }
+  ozz::memory::default_allocator()->Delete(decompressed);
+
+  if (!success) {
+    return EXIT_FAILURE;
+  }
+  ozz::log::Log() << "Upgraded " << num_objects << " object(s) to \""
+                  << OPTIONS_output << "\"." << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,149 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#include <cstdlib>
+
+#include "ozz/animation/offline/palette_animation_builder.h"
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/palette_animation.h"
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/base/io/archive.h"
+#include "ozz/base/io/stream.h"
+#include "ozz/base/log.h"
+#include "ozz/base/memory/allocator.h"
+
+#include "ozz/options/options.h"
+
+// Bakes animations to palette animations (see
+// ozz::animation::PaletteAnimation), which store a skinning matrices palette
+// per frame in a GPU texture friendly layout. Crowd shaders can then sample
+// animations and skin meshes with no CPU cost per instance. Every animation
+// of the input file is baked, and the texture layout of each is reported.
+
+// Declares command line options.
+OZZ_OPTIONS_DECLARE_STRING(skeleton, "Specifies skeleton input file", "",
+                           true)
+OZZ_OPTIONS_DECLARE_STRING(animation,
+                           "Specifies animations input file, every animation "
+                           "of the file is baked",
+                           "", true)
+OZZ_OPTIONS_DECLARE_STRING(output, "Specifies palette animations output file",
+                           "", true)
+
+static bool ValidateFrequency(const ozz::options::Option& _option,
+                              int /*_argc*/) {
+  const ozz::options::FloatOption& option =
+      static_cast<const ozz::options::FloatOption&>(_option);
+  bool valid = option.value() > 0.f;
+  if (!valid) {
+    ozz::log::Err() << "Invalid frequency option \"" << option << "\""
+                    << std::endl;
+  }
+  return valid;
+}
+
+OZZ_OPTIONS_DECLARE_FLOAT_FN(frequency,
+                             "Baking frequency, in frames per second", 30.f,
+                             false, &ValidateFrequency)
+
+int main(int _argc, const char** _argv) {
+  // Parses arguments.
+  ozz::options::ParseResult parse_result = ozz::options::ParseCommandLine(
+      _argc, _argv, "1.0", "Bakes animations to GPU palette animations.");
+  if (parse_result != ozz::options::kSuccess) {
+    return parse_result == ozz::options::kExitSuccess ? EXIT_SUCCESS
+                                                      : EXIT_FAILURE;
+  }
+
+  // Loads skeleton.
+  ozz::animation::Skeleton skeleton;
+  {
+    ozz::io::File file(OPTIONS_skeleton, "rb");
+    if (!file.opened()) {
+      ozz::log::Err() << "Failed to open skeleton file \"" << OPTIONS_skeleton
+                      << "\"." << std::endl;
+      return EXIT_FAILURE;
+    }
+    ozz::io::IArchive archive(&file);
+    if (!archive.TestTag<ozz::animation::Skeleton>()) {
+      ozz::log::Err() << "Failed to load skeleton from file \""
+                      << OPTIONS_skeleton << "\"." << std::endl;
+      return EXIT_FAILURE;
+    }
+    archive >> skeleton;
+  }
+
+  ozz::io::File input(OPTIONS_animation, "rb");
+  if (!input.opened()) {
+    ozz::log::Err() << "Failed to open animation file \"" << OPTIONS_animation
+                    << "\"." << std::endl;
+    return EXIT_FAILURE;
+  }
+  ozz::io::File output(OPTIONS_output, "wb");
+  if (!output.opened()) {
+    ozz::log::Err() << "Failed to open output file \"" << OPTIONS_output
+                    << "\"." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // Bakes every animation of the input file.
+  ozz::animation::offline::PaletteAnimationBuilder builder;
+  builder.frequency = OPTIONS_frequency;
+
+  int num_animations = 0;
+  ozz::io::IArchive iarchive(&input);
+  ozz::io::OArchive oarchive(&output);
+  while (iarchive.TestTag<ozz::animation::Animation>()) {
+    ozz::animation::Animation animation;
+    iarchive >> animation;
+
+    ozz::animation::PaletteAnimation* baked = builder(animation, skeleton);
+    if (!baked) {
+      ozz::log::Err() << "Failed to bake animation \"" << animation.name()
+                      << "\", which doesn't match skeleton." << std::endl;
+      return EXIT_FAILURE;
+    }
+    oarchive << *baked;
+    ++num_animations;
+
+    ozz::log::Log() << "Baked animation \"" << baked->name() << "\": "
+                    << baked->num_frames() << " frames of "
+                    << baked->num_joints() << " joints, "
+                    << baked->width() << "x" << baked->height()
+                    << " RGBA32F texels (" << baked->texels().size()
+                    << " bytes)." << std::endl;
+    ozz::memory::default_allocator()->Delete(baked);
+  }
+
+  if (num_animations == 0) {
+    ozz::log::Err() << "No animation found in file \"" << OPTIONS_animation
+                    << "\"." << std::endl;
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
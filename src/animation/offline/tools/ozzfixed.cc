@@ -0,0 +1,100 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#include <cstdlib>
+
+#include "ozz/animation/offline/fixed_topology_generator.h"
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/base/containers/string.h"
+#include "ozz/base/io/archive.h"
+#include "ozz/base/io/stream.h"
+#include "ozz/base/log.h"
+
+#include "ozz/options/options.h"
+
+// Generates a C++ header describing a skeleton topology at compile time (see
+// ozz/animation/runtime/fixed_topology.h), so that hierarchy and blending jobs
+// can be specialized and unrolled for this skeleton.
+
+// Declares command line options.
+OZZ_OPTIONS_DECLARE_STRING(skeleton, "Specifies skeleton input file", "",
+                           true)
+OZZ_OPTIONS_DECLARE_STRING(name, "Specifies generated topology type name", "",
+                           true)
+OZZ_OPTIONS_DECLARE_STRING(output, "Specifies C++ header output file", "",
+                           true)
+
+int main(int _argc, const char** _argv) {
+  // Parses arguments.
+  ozz::options::ParseResult parse_result = ozz::options::ParseCommandLine(
+      _argc, _argv, "1.0",
+      "Generates a fixed topology C++ header from a skeleton.");
+  if (parse_result != ozz::options::kSuccess) {
+    return parse_result == ozz::options::kExitSuccess ? EXIT_SUCCESS
+                                                      : EXIT_FAILURE;
+  }
+
+  // Loads skeleton.
+  ozz::animation::Skeleton skeleton;
+  {
+    ozz::io::File file(OPTIONS_skeleton, "rb");
+    if (!file.opened()) {
+      ozz::log::Err() << "Failed to open skeleton file \"" << OPTIONS_skeleton
+                      << "\"." << std::endl;
+      return EXIT_FAILURE;
+    }
+    ozz::io::IArchive archive(&file);
+    if (!archive.TestTag<ozz::animation::Skeleton>()) {
+      ozz::log::Err() << "Failed to load skeleton from file \""
+                      << OPTIONS_skeleton << "\"." << std::endl;
+      return EXIT_FAILURE;
+    }
+    archive >> skeleton;
+  }
+
+  ozz::String::Std source;
+  if (!ozz::animation::offline::GenerateFixedTopology(skeleton, OPTIONS_name,
+                                                      &source)) {
+    ozz::log::Err() << "Failed to generate topology \"" << OPTIONS_name
+                    << "\", which must be a valid C++ identifier."
+                    << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  ozz::io::File output(OPTIONS_output, "wb");
+  if (!output.opened() ||
+      output.Write(source.c_str(), source.size()) != source.size()) {
+    ozz::log::Err() << "Failed to write output file \"" << OPTIONS_output
+                    << "\"." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  ozz::log::Log() << "Generated topology \"" << OPTIONS_name << "\" of "
+                  << skeleton.num_joints() << " joints." << std::endl;
+  return EXIT_SUCCESS;
+}
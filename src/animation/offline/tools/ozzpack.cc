@@ -0,0 +1,114 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include <cstdlib>
+#include <cstring>
+
+#include "ozz/base/containers/string.h"
+#include "ozz/base/io/mapped_file.h"
+#include "ozz/base/io/pack.h"
+#include "ozz/base/io/stream.h"
+#include "ozz/base/log.h"
+
+#include "ozz/options/options.h"
+
+// Packs a list of ozz files (skeletons, animations, tracks...) into a single
+// pack file, loadable with ozz::io::PackReader. Entries are named after input
+// files names, without their directory and extension.
+
+// Declares command line options.
+OZZ_OPTIONS_DECLARE_STRING(files,
+                           "Specifies the comma separated list of files to "
+                           "pack",
+                           "", true)
+OZZ_OPTIONS_DECLARE_STRING(output, "Specifies output pack file", "", true)
+
+// Extracts entry name from _path, removing directory and extension.
+static ozz::String::Std EntryName(const ozz::String::Std& _path) {
+  const size_t slash = _path.find_last_of("/\\");
+  const size_t begin = slash == ozz::String::Std::npos ? 0 : slash + 1;
+  const size_t dot = _path.find_last_of('.');
+  const size_t end =
+      dot == ozz::String::Std::npos || dot < begin ? _path.size() : dot;
+  return _path.substr(begin, end - begin);
+}
+
+int main(int _argc, const char** _argv) {
+  // Parses arguments.
+  ozz::options::ParseResult parse_result = ozz::options::ParseCommandLine(
+      _argc, _argv, "1.0",
+      "Packs ozz files into a single pack file, with a table of contents for "
+      "random access loading.");
+  if (parse_result != ozz::options::kSuccess) {
+    return parse_result == ozz::options::kExitSuccess ? EXIT_SUCCESS
+                                                      : EXIT_FAILURE;
+  }
+
+  ozz::io::File output(OPTIONS_output, "wb");
+  if (!output.opened()) {
+    ozz::log::Err() << "Failed to open output file \"" << OPTIONS_output
+                    << "\"." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  ozz::io::PackWriter writer(&output);
+  const ozz::String::Std files(OPTIONS_files.value());
+  for (size_t begin = 0; begin <= files.size();) {
+    size_t end = files.find(',', begin);
+    if (end == ozz::String::Std::npos) {
+      end = files.size();
+    }
+    const ozz::String::Std path = files.substr(begin, end - begin);
+    begin = end + 1;
+    if (path.empty()) {
+      continue;
+    }
+
+    ozz::io::MappedFile file(path.c_str());
+    if (!file.opened()) {
+      ozz::log::Err() << "Failed to open input file \"" << path << "\"."
+                      << std::endl;
+      return EXIT_FAILURE;
+    }
+    const ozz::String::Std name = EntryName(path);
+    if (!writer.AddBinary(name.c_str(), file.data(), file.size())) {
+      ozz::log::Err() << "Failed to pack \"" << path << "\" as entry \""
+                      << name << "\"." << std::endl;
+      return EXIT_FAILURE;
+    }
+    OZZ_LOGV << "Packed \"" << path << "\" as entry \"" << name
+             << "\"." << std::endl;
+  }
+
+  if (!writer.Finalize()) {
+    ozz::log::Err() << "Failed to write pack table of contents." << std::endl;
+    return EXIT_FAILURE;
+  }
+  ozz::log::Log() << "Packed " << writer.num_entries() << " file(s) to \""
+                  << OPTIONS_output << "\"." << std::endl;
+  return EXIT_SUCCESS;
+}
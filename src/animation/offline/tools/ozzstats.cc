@@ -0,0 +1,610 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/quantized_track.h"
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/animation/runtime/track.h"
+#include "ozz/animation/runtime/track_set.h"
+#include "ozz/animation/runtime/uniform_animation.h"
+#include "ozz/base/containers/string.h"
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/io/archive.h"
+#include "ozz/base/io/compressed_stream.h"
+#include "ozz/base/io/stream.h"
+#include "ozz/base/log.h"
+#include "ozz/base/maths/box.h"
+#include "ozz/base/memory/allocator.h"
+
+#include "ozz/options/options.h"
+
+#define OZZ_INCLUDE_PRIVATE_HEADER  // Allows to include private headers.
+#include "animation/runtime/animation_keyframe.h"
+
+#include <json/json.h>
+
+// Reports statistics about a library of ozz files (skeletons, animations,
+// tracks...), to find the clips and tracks that dominate memory and sampling
+// cost. Every object of every input file is loaded, and reported as a json
+// document. Animations report is broken down per channel and per joint: key
+// counts, keys per second, memory used by each buffer, constant and padding
+// tracks, and the estimated number of keys scanned per frame when the
+// animation is played at a given frame rate.
+
+// Declares command line options.
+OZZ_OPTIONS_DECLARE_STRING(files,
+                           "Specifies the comma separated list of files to "
+                           "analyze",
+                           "", true)
+
+OZZ_OPTIONS_DECLARE_STRING(skeleton,
+                           "Specifies an optional skeleton file, used to name "
+                           "animations joints",
+                           "", false)
+
+OZZ_OPTIONS_DECLARE_STRING(output,
+                           "Specifies json report output file. Report is "
+                           "written to standard output if empty",
+                           "", false)
+
+static bool ValidateFrameRate(const ozz::options::Option& _option,
+                              int /*_argc*/) {
+  const ozz::options::FloatOption& option =
+      static_cast<const ozz::options::FloatOption&>(_option);
+  const bool valid = option.value() > 0.f;
+  if (!valid) {
+    ozz::log::Err() << "Invalid frame rate option \"" << option
+                    << "\", must be greater than 0." << std::endl;
+  }
+  return valid;
+}
+
+OZZ_OPTIONS_DECLARE_FLOAT_FN(
+    frame_rate,
+    "Frame rate (in hertz) used to estimate the number of keys scanned per "
+    "frame by animations sampling.",
+    30.f, false, &ValidateFrameRate)
+
+namespace {
+
+Json::Value ToJson(size_t _value) {
+  return Json::Value(static_cast<Json::UInt64>(_value));
+}
+
+// Compares quantized rotation key values.
+struct SameRotationValue {
+  const ozz::animation::RotationKey* keys;
+  bool operator()(int _a, int _b) const {
+    const ozz::animation::RotationKey& a = keys[_a];
+    const ozz::animation::RotationKey& b = keys[_b];
+    return a.largest == b.largest && a.sign == b.sign &&
+           std::memcmp(a.value, b.value, sizeof(a.value)) == 0;
+  }
+};
+
+// Compares quantized translation or scale key values, which are bit packed.
+template <typename _Key>
+struct SamePackedValue {
+  const _Key* keys;
+  const ozz::animation::KeyRange* ranges;
+  const uint32_t* offsets;
+  const uint8_t* values;
+  bool operator()(int _a, int _b) const {
+    int a[3], b[3];
+    ozz::animation::UnpackKeyValues(keys, ranges, offsets, values, _a, a);
+    ozz::animation::UnpackKeyValues(keys, ranges, offsets, values, _b, b);
+    return std::memcmp(a, b, sizeof(a)) == 0;
+  }
+};
+
+// Per track keys statistics of a key buffer.
+struct TrackKeys {
+  // Number of keys per track.
+  ozz::Vector<int>::Std counts;
+  // Number of keys of soa padding tracks, beyond animation number of tracks.
+  size_t padding;
+  // Number of tracks that have more than one key, all with the same value.
+  int redundant_tracks;
+  // Number of keys of those tracks that could be removed.
+  size_t redundant_keys;
+};
+
+// _same_value compares the values of 2 keys of _keys, from their indices.
+template <typename _Key, typename _SameValue>
+void CountTrackKeys(ozz::Range<const _Key> _keys, int _num_tracks,
+                    const _SameValue& _same_value, TrackKeys* _track_keys) {
+  _track_keys->counts.assign(_num_tracks, 0);
+  _track_keys->padding = 0;
+  ozz::Vector<int>::Std first(_num_tracks, -1);
+  ozz::Vector<bool>::Std constant(_num_tracks, true);
+  for (int i = 0; i < static_cast<int>(_keys.count()); ++i) {
+    const int track = _keys.begin[i].track;
+    if (track >= _num_tracks) {
+      ++_track_keys->padding;
+      continue;
+    }
+    ++_track_keys->counts[track];
+    if (first[track] < 0) {
+      first[track] = i;
+    } else if (constant[track]) {
+      constant[track] = _same_value(first[track], i);
+    }
+  }
+  _track_keys->redundant_tracks = 0;
+  _track_keys->redundant_keys = 0;
+  for (int i = 0; i < _num_tracks; ++i) {
+    const int count = _track_keys->counts[i];
+    if (count > 1 && constant[i]) {
+      ++_track_keys->redundant_tracks;
+      _track_keys->redundant_keys += count - 1;
+    }
+  }
+}
+
+// Accumulates to _histogram the number of keys whose time falls in each
+// frame. Constant keys, at the beginning of the buffer, aren't scanned during
+// sampling. Key times are stored in _key_frames animation frames, as floats
+// (_times) or frame indices (_times is empty).
+template <typename _Key>
+void ScanKeys(ozz::Range<const _Key> _keys, ozz::Range<const float> _times,
+              int _num_constants, int _key_frames,
+              ozz::Vector<int>::Std* _histogram) {
+  const int num_frames = static_cast<int>(_histogram->size());
+  const int num_keys = static_cast<int>(_keys.count());
+  for (int i = _num_constants; i < num_keys; ++i) {
+    const float ratio =
+        ozz::animation::KeyFrame(_keys.begin, _times.begin, i) / _key_frames;
+    const int frame = static_cast<int>(ratio * num_frames);
+    ++(*_histogram)[frame < num_frames ? frame : num_frames - 1];
+  }
+}
+
+// Reports a key buffer statistics. _values_size is the size of translation
+// and scale bit packed values and value offsets.
+template <typename _Key>
+Json::Value ReportChannel(ozz::Range<const _Key> _keys, int _num_constants,
+                          size_t _padding, size_t _tangent_size,
+                          size_t _values_size, float _duration) {
+  const size_t num_keys = _keys.count();
+  const size_t animated_keys = num_keys - _num_constants - _padding;
+  Json::Value report;
+  report["keys"] = ToJson(num_keys);
+  report["constant_tracks"] = _num_constants;
+  report["padding_keys"] = ToJson(_padding);
+  report["keys_per_second"] = animated_keys / _duration;
+  report["size"] =
+      ToJson(num_keys * (sizeof(_Key) + _tangent_size) + _values_size);
+  return report;
+}
+
+Json::Value ReportAnimation(const ozz::animation::Animation& _animation,
+                            const ozz::animation::Skeleton* _skeleton,
+                            float _frame_rate) {
+  using ozz::animation::Float3Tangent;
+  using ozz::animation::KeyRange;
+  using ozz::animation::QuaternionTangent;
+  using ozz::animation::RotationKey;
+  using ozz::animation::ScaleKey;
+  using ozz::animation::TranslationKey;
+
+  const int num_tracks = _animation.num_tracks();
+  const float duration = _animation.duration();
+  const bool spline = _animation.spline();
+
+  Json::Value report;
+  report["name"] = _animation.name();
+  report["size"] = ToJson(_animation.size());
+  report["duration"] = duration;
+  report["num_frames"] = _animation.num_frames();
+  report["key_times"] = _animation.has_key_times();
+  report["num_tracks"] = num_tracks;
+  report["spline"] = spline;
+
+  // Per channel statistics.
+  TrackKeys translations, rotations, scales;
+  const SamePackedValue<TranslationKey> same_translation = {
+      _animation.translations().begin, _animation.translation_ranges().begin,
+      _animation.translation_value_offsets().begin,
+      _animation.translation_values().begin};
+  CountTrackKeys(_animation.translations(), num_tracks, same_translation,
+                 &translations);
+  const SameRotationValue same_rotation = {_animation.rotations().begin};
+  CountTrackKeys(_animation.rotations(), num_tracks, same_rotation,
+                 &rotations);
+  const SamePackedValue<ScaleKey> same_scale = {
+      _animation.scales().begin, _animation.scale_ranges().begin,
+      _animation.scale_value_offsets().begin,
+      _animation.scale_values().begin};
+  CountTrackKeys(_animation.scales(), num_tracks, same_scale, &scales);
+  const size_t translation_padding = translations.padding;
+  const size_t rotation_padding = rotations.padding;
+  const size_t scale_padding = scales.padding;
+
+  Json::Value& channels = report["channels"];
+  channels["translations"] = ReportChannel(
+      _animation.translations(), _animation.num_constant_translations(),
+      translation_padding, spline ? sizeof(Float3Tangent) : 0,
+      _animation.translation_values().size() +
+          _animation.translation_value_offsets().size(),
+      duration);
+  channels["rotations"] = ReportChannel(
+      _animation.rotations(), _animation.num_constant_rotations(),
+      rotation_padding, spline ? sizeof(QuaternionTangent) : 0, 0, duration);
+  channels["scales"] = ReportChannel(
+      _animation.scales(), _animation.num_constant_scales(), scale_padding,
+      spline ? sizeof(Float3Tangent) : 0,
+      _animation.scale_values().size() +
+          _animation.scale_value_offsets().size(),
+      duration);
+
+  const size_t num_keys = _animation.translations().count() +
+                          _animation.rotations().count() +
+                          _animation.scales().count();
+  const int num_constants = _animation.num_constant_translations() +
+                            _animation.num_constant_rotations() +
+                            _animation.num_constant_scales();
+  const size_t num_padding =
+      translation_padding + rotation_padding + scale_padding;
+  const size_t animated_keys = num_keys - num_constants - num_padding;
+  report["keys"] = ToJson(num_keys);
+  report["keys_per_second"] = animated_keys / duration;
+
+  // Memory used by other buffers.
+  Json::Value& buffers = report["buffers"];
+  buffers["ranges"] = ToJson(_animation.translation_ranges().size() +
+                             _animation.scale_ranges().size());
+  buffers["seek_points"] = ToJson(_animation.seek_ratios().size() +
+                                  _animation.seek_keys().size());
+  buffers["sync_markers"] = ToJson(_animation.sync_ratios().size());
+  buffers["key_times"] = ToJson(_animation.translation_times().size() +
+                                _animation.rotation_times().size() +
+                                _animation.scale_times().size());
+  buffers["bounds"] = ToJson(_animation.bounds().size());
+
+  // Keys that don't animate anything: constant tracks keys still need to be
+  // decompressed when sampling cache is (re)seeded, tracks whose keys all have
+  // the same value could be stored as constant tracks, and soa padding tracks
+  // keys are never used.
+  Json::Value& waste = report["waste"];
+  waste["constant_tracks"] = num_constants;
+  waste["redundant_tracks"] = translations.redundant_tracks +
+                              rotations.redundant_tracks +
+                              scales.redundant_tracks;
+  waste["redundant_keys"] = ToJson(translations.redundant_keys +
+                                   rotations.redundant_keys +
+                                   scales.redundant_keys);
+  waste["redundant_size"] =
+      ToJson(translations.redundant_keys * sizeof(TranslationKey) +
+             rotations.redundant_keys * sizeof(RotationKey) +
+             scales.redundant_keys * sizeof(ScaleKey));
+  waste["padding_keys"] = ToJson(num_padding);
+  waste["padding_size"] =
+      ToJson(translation_padding * sizeof(TranslationKey) +
+             rotation_padding * sizeof(RotationKey) +
+             scale_padding * sizeof(ScaleKey));
+
+  // Estimates the number of keys sampling scans per frame, when the animation
+  // is played forward at _frame_rate.
+  const int num_frames = ozz::math::Max(
+      1, static_cast<int>(std::ceil(duration * _frame_rate)));
+  ozz::Vector<int>::Std histogram(num_frames, 0);
+  const int key_frames = _animation.num_frames();
+  ScanKeys(_animation.translations(), _animation.translation_times(),
+           _animation.num_constant_translations(), key_frames, &histogram);
+  ScanKeys(_animation.rotations(), _animation.rotation_times(),
+           _animation.num_constant_rotations(), key_frames, &histogram);
+  ScanKeys(_animation.scales(), _animation.scale_times(),
+           _animation.num_constant_scales(), key_frames, &histogram);
+  int max_keys_per_frame = 0;
+  for (int i = 0; i < num_frames; ++i) {
+    max_keys_per_frame = ozz::math::Max(max_keys_per_frame, histogram[i]);
+  }
+  Json::Value& scan = report["key_scan"];
+  scan["frame_rate"] = _frame_rate;
+  scan["frames"] = num_frames;
+  scan["average_keys_per_frame"] =
+      static_cast<float>(num_keys - num_constants) / num_frames;
+  scan["max_keys_per_frame"] = max_keys_per_frame;
+
+  // Per joint statistics. Joints are named if skeleton matches.
+  const bool named = _skeleton && _skeleton->num_joints() == num_tracks;
+  Json::Value& joints = report["joints"];
+  joints = Json::Value(Json::arrayValue);
+  for (int i = 0; i < num_tracks; ++i) {
+    Json::Value joint;
+    if (named) {
+      joint["name"] = _skeleton->joint_names()[i];
+    }
+    const int translation_keys = translations.counts[i];
+    const int rotation_keys = rotations.counts[i];
+    const int scale_keys = scales.counts[i];
+    joint["translations"] = translation_keys;
+    joint["rotations"] = rotation_keys;
+    joint["scales"] = scale_keys;
+    joint["keys_per_second"] =
+        (translation_keys + rotation_keys + scale_keys) / duration;
+    joints.append(joint);
+  }
+  return report;
+}
+
+Json::Value ReportSkeleton(const ozz::animation::Skeleton& _skeleton) {
+  Json::Value report;
+  report["size"] = ToJson(_skeleton.flat_size());
+  report["num_joints"] = _skeleton.num_joints();
+  return report;
+}
+
+template <typename _Track>
+Json::Value ReportTrack(const _Track& _track) {
+  Json::Value report;
+  report["name"] = _track.name();
+  report["size"] = ToJson(_track.size());
+  report["keys"] = ToJson(_track.ratios().count());
+  return report;
+}
+
+template <typename _Ty>
+Json::Value ReportSize(const _Ty& _object) {
+  Json::Value report;
+  report["name"] = _object.name();
+  report["size"] = ToJson(_object.size());
+  return report;
+}
+
+// Reports objects of all supported types.
+struct Reporter {
+  const ozz::animation::Skeleton* skeleton;
+  float frame_rate;
+
+  Json::Value operator()(const ozz::animation::Animation& _animation) const {
+    return ReportAnimation(_animation, skeleton, frame_rate);
+  }
+  Json::Value operator()(const ozz::animation::Skeleton& _skeleton) const {
+    return ReportSkeleton(_skeleton);
+  }
+  Json::Value operator()(const ozz::animation::FloatTrack& _track) const {
+    return ReportTrack(_track);
+  }
+  Json::Value operator()(const ozz::animation::Float2Track& _track) const {
+    return ReportTrack(_track);
+  }
+  Json::Value operator()(const ozz::animation::Float3Track& _track) const {
+    return ReportTrack(_track);
+  }
+  Json::Value operator()(const ozz::animation::Float4Track& _track) const {
+    return ReportTrack(_track);
+  }
+  Json::Value operator()(const ozz::animation::QuaternionTrack& _track) const {
+    return ReportTrack(_track);
+  }
+  template <typename _Ty>
+  Json::Value operator()(const _Ty& _object) const {
+    return ReportSize(_object);
+  }
+};
+
+// Result of a report attempt of a single object.
+enum ReportResult {
+  kNotMatching,  // Input doesn't contain an object of the tested type.
+  kReported,     // Object was loaded and reported.
+  kUnsupported,  // Object version is more recent than the current one.
+};
+
+// Loads a _Ty object from _input and outputs its report to _report, if
+// _input contains a _Ty object at its current position.
+template <typename _Ty>
+ReportResult Report(ozz::io::IArchive& _input, const Reporter& _reporter,
+                    const char* _type, Json::Value* _report) {
+  if (!_input.TestTag<_Ty>()) {
+    return kNotMatching;
+  }
+  const uint32_t version = _input.PeekVersion<_Ty>();
+  const uint32_t current = ozz::io::internal::Version<const _Ty>::kValue;
+  if (version > current) {
+    ozz::log::Err() << _type << " version " << version
+                    << " is more recent than supported version " << current
+                    << "." << std::endl;
+    return kUnsupported;
+  }
+
+  // Objects can be big, so they're allocated.
+  _Ty* object = ozz::memory::default_allocator()->New<_Ty>();
+  _input >> *object;
+  *_report = _reporter(*object);
+  (*_report)["type"] = _type;
+  ozz::memory::default_allocator()->Delete(object);
+  return kReported;
+}
+
+// Reports the object at _input current position, whatever its type.
+ReportResult ReportAny(ozz::io::IArchive& _input, const Reporter& _reporter,
+                       Json::Value* _report) {
+  typedef ReportResult (*ReportFn)(ozz::io::IArchive&, const Reporter&,
+                                   const char*, Json::Value*);
+  struct Entry {
+    ReportFn report;
+    const char* type;
+  };
+  namespace a = ozz::animation;
+  const Entry entries[] = {
+      {&Report<a::Skeleton>, "Skeleton"},
+      {&Report<a::Animation>, "Animation"},
+      {&Report<a::UniformAnimation>, "UniformAnimation"},
+      {&Report<a::FloatTrack>, "FloatTrack"},
+      {&Report<a::Float2Track>, "Float2Track"},
+      {&Report<a::Float3Track>, "Float3Track"},
+      {&Report<a::Float4Track>, "Float4Track"},
+      {&Report<a::QuaternionTrack>, "QuaternionTrack"},
+      {&Report<a::QuantizedFloatTrack>, "QuantizedFloatTrack"},
+      {&Report<a::QuantizedFloat2Track>, "QuantizedFloat2Track"},
+      {&Report<a::QuantizedFloat3Track>, "QuantizedFloat3Track"},
+      {&Report<a::QuantizedFloat4Track>, "QuantizedFloat4Track"},
+      {&Report<a::TrackSet>, "TrackSet"}};
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(entries); ++i) {
+    const ReportResult result =
+        entries[i].report(_input, _reporter, entries[i].type, _report);
+    if (result != kNotMatching) {
+      return result;
+    }
+  }
+  return kNotMatching;
+}
+
+// Reports all objects of file _path to _reports.
+bool ReportFile(const char* _path, const Reporter& _reporter,
+                Json::Value* _reports) {
+  ozz::io::File file(_path, "rb");
+  if (!file.opened()) {
+    ozz::log::Err() << "Failed to open input file \"" << _path << "\"."
+                    << std::endl;
+    return false;
+  }
+
+  // Input archive is decompressed transparently.
+  ozz::io::CompressedStream* decompressed = NULL;
+  ozz::io::Stream* stream = &file;
+  if (ozz::io::CompressedStream::IsCompressed(&file)) {
+    decompressed =
+        ozz::memory::default_allocator()->New<ozz::io::CompressedStream>(
+            &file, ozz::io::CompressedStream::kDecompress);
+    stream = decompressed;
+  }
+
+  bool success = stream->opened();
+  if (success) {
+    ozz::io::IArchive archive(stream);
+    while (success &&
+           stream->Tell() < static_cast<int64_t>(stream->Size())) {
+      Json::Value report;
+      const ReportResult result = ReportAny(archive, _reporter, &report);
+      if (result == kNotMatching) {
+        ozz::log::Err() << "Unknown or invalid object found in \"" << _path
+                        << "\"." << std::endl;
+      }
+      success = result == kReported;
+      if (success) {
+        report["file"] = _path;
+        _reports->append(report);
+      }
+    }
+  } else {
+    ozz::log::Err() << "Failed to decompress input file \"" << _path << "\"."
+                    << std::endl;
+  }
+  ozz::memory::default_allocator()->Delete(decompressed);
+  return success;
+}
+}  // namespace
+
+int main(int _argc, const char** _argv) {
+  // Parses arguments.
+  ozz::options::ParseResult parse_result = ozz::options::ParseCommandLine(
+      _argc, _argv, "1.0",
+      "Reports size, keys and sampling cost statistics of ozz files as a json "
+      "document.");
+  if (parse_result != ozz::options::kSuccess) {
+    return parse_result == ozz::options::kExitSuccess ? EXIT_SUCCESS
+                                                      : EXIT_FAILURE;
+  }
+
+  // Loads the optional skeleton used to name joints.
+  ozz::animation::Skeleton skeleton;
+  Reporter reporter = {NULL, OPTIONS_frame_rate};
+  if (OPTIONS_skeleton.value()[0] != 0) {
+    ozz::io::File file(OPTIONS_skeleton, "rb");
+    ozz::io::IArchive archive(&file);
+    if (!file.opened() || !archive.TestTag<ozz::animation::Skeleton>()) {
+      ozz::log::Err() << "Failed to load skeleton from \""
+                      << OPTIONS_skeleton << "\"." << std::endl;
+      return EXIT_FAILURE;
+    }
+    archive >> skeleton;
+    reporter.skeleton = &skeleton;
+  }
+
+  // Reports all objects of all files.
+  Json::Value root;
+  Json::Value& objects = root["objects"];
+  objects = Json::Value(Json::arrayValue);
+  const ozz::String::Std files(OPTIONS_files.value());
+  for (size_t begin = 0; begin <= files.size();) {
+    size_t end = files.find(',', begin);
+    if (end == ozz::String::Std::npos) {
+      end = files.size();
+    }
+    const ozz::String::Std path = files.substr(begin, end - begin);
+    begin = end + 1;
+    if (path.empty()) {
+      continue;
+    }
+    if (!ReportFile(path.c_str(), reporter, &objects)) {
+      return EXIT_FAILURE;
+    }
+  }
+
+  // Summarizes the whole library.
+  Json::Value& summary = root["summary"];
+  Json::UInt64 size = 0, keys = 0;
+  int num_animations = 0;
+  for (Json::ArrayIndex i = 0; i < objects.size(); ++i) {
+    size += objects[i]["size"].asUInt64();
+    if (objects[i]["type"] == "Animation") {
+      keys += objects[i]["keys"].asUInt64();
+      ++num_animations;
+    }
+  }
+  summary["objects"] = objects.size();
+  summary["animations"] = num_animations;
+  summary["size"] = size;
+  summary["animation_keys"] = keys;
+
+  Json::StreamWriterBuilder builder;
+  builder["indentation"] = "  ";
+  builder["precision"] = 6;
+  const std::string document = Json::writeString(builder, root);
+  if (OPTIONS_output.value()[0] == 0) {
+    ozz::log::Out() << document << std::endl;
+  } else {
+    std::ofstream file(OPTIONS_output);
+    if (!file.is_open()) {
+      ozz::log::Err() << "Failed to open output file \"" << OPTIONS_output
+                      << "\"." << std::endl;
+      return EXIT_FAILURE;
+    }
+    file << document << std::endl;
+    ozz::log::Log() << "Reported " << objects.size() << " object(s) to \""
+                    << OPTIONS_output << "\"." << std::endl;
+  }
+  return EXIT_SUCCESS;
+}
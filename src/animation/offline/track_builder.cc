@@ -27,16 +27,20 @@
 
 #include "ozz/animation/offline/track_builder.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cmath>
 #include <cstring>
 #include <limits>
 
+#include "ozz/base/maths/math_ex.h"
 #include "ozz/base/memory/allocator.h"
 
 #include "ozz/animation/offline/raw_track.h"
 
+#include "ozz/animation/runtime/quantized_track.h"
 #include "ozz/animation/runtime/track.h"
+#include "ozz/animation/runtime/track_set.h"
 
 namespace ozz {
 namespace animation {
@@ -94,12 +98,16 @@ void Fixup(_Keyframes* _keyframes) {
 }
 }  // namespace
 
+TrackBuilder::TrackBuilder() : tolerance(1e-3f) {}
+
 // Ensures _input's validity and allocates _animation.
 // An animation needs to have at least two key frames per joint, the first at
 // t = 0 and the last at t = 1. If at least one of those keys are not
 // in the RawAnimation then the builder creates it.
 template <typename _RawTrack, typename _Track>
 _Track* TrackBuilder::Build(const _RawTrack& _input) const {
+  memory::ScopedAllocationTag tag(memory::kTagBuilder);
+
   // Tests _raw_animation validity.
   if (!_input.Validate()) {
     return NULL;
@@ -108,7 +116,26 @@ _Track* TrackBuilder::Build(const _RawTrack& _input) const {
   // Everything is fine, allocates and fills the animation.
   // Nothing can fail now.
   _Track* track = memory::default_allocator()->New<_Track>();
+  Fill<_RawTrack, _Track>(_input, track);
+  return track;  // Success.
+}
+
+template <typename _RawTrack, typename _Track>
+bool TrackBuilder::Build(const _RawTrack& _input, _Track* _track) const {
+  memory::ScopedAllocationTag tag(memory::kTagBuilder);
 
+  // Tests _raw_animation validity.
+  if (!_track || !_input.Validate()) {
+    return false;
+  }
+
+  // Replaces _track content, reusing its buffer if it fits.
+  Fill<_RawTrack, _Track>(_input, _track);
+  return true;
+}
+
+template <typename _RawTrack, typename _Track>
+void TrackBuilder::Fill(const _RawTrack& _input, _Track* _track) const {
   // Copy data to temporary prepared data structure
   typename _RawTrack::Keyframes keyframes;
   // Guessing a worst size to avoid realloc.
@@ -127,41 +154,55 @@ _Track* TrackBuilder::Build(const _RawTrack& _input) const {
 
   // Allocates output track.
   const size_t name_len = _input.name.size();
-  track->Allocate(keyframes.size(), _input.name.size());
+  _track->Allocate(keyframes.size(), _input.name.size());
 
   // Copy all keys to output.
-  assert(keyframes.size() == track->ratios_.count() &&
-         keyframes.size() == track->values_.count() &&
-         keyframes.size() <= track->steps_.count() * 8);
-  memset(track->steps_.begin, 0, track->steps_.size());
+  assert(keyframes.size() == _track->ratios_.count() &&
+         keyframes.size() == _track->values_.count() &&
+         keyframes.size() <= _track->steps_.count() * 8);
+  memset(_track->steps_.begin, 0, _track->steps_.size());
   for (size_t i = 0; i < keyframes.size(); ++i) {
     const typename _RawTrack::Keyframe& src_key = keyframes[i];
-    track->ratios_[i] = src_key.ratio;
-    track->values_[i] = src_key.value;
-    track->steps_[i / 8] |=
+    _track->ratios_[i] = src_key.ratio;
+    _track->values_[i] = src_key.value;
+    _track->steps_[i / 8] |=
         (src_key.interpolation == RawTrackInterpolation::kStep) << (i & 7);
   }
 
   // Copy track's name.
   if (name_len) {
-    strcpy(track->name_, _input.name.c_str());
+    strcpy(_track->name_, _input.name.c_str());
   }
-
-  return track;  // Success.
 }
 
 FloatTrack* TrackBuilder::operator()(const RawFloatTrack& _input) const {
   return Build<RawFloatTrack, FloatTrack>(_input);
 }
+bool TrackBuilder::operator()(const RawFloatTrack& _input,
+                              FloatTrack* _track) const {
+  return Build<RawFloatTrack, FloatTrack>(_input, _track);
+}
 Float2Track* TrackBuilder::operator()(const RawFloat2Track& _input) const {
   return Build<RawFloat2Track, Float2Track>(_input);
 }
+bool TrackBuilder::operator()(const RawFloat2Track& _input,
+                              Float2Track* _track) const {
+  return Build<RawFloat2Track, Float2Track>(_input, _track);
+}
 Float3Track* TrackBuilder::operator()(const RawFloat3Track& _input) const {
   return Build<RawFloat3Track, Float3Track>(_input);
 }
+bool TrackBuilder::operator()(const RawFloat3Track& _input,
+                              Float3Track* _track) const {
+  return Build<RawFloat3Track, Float3Track>(_input, _track);
+}
 Float4Track* TrackBuilder::operator()(const RawFloat4Track& _input) const {
   return Build<RawFloat4Track, Float4Track>(_input);
 }
+bool TrackBuilder::operator()(const RawFloat4Track& _input,
+                              Float4Track* _track) const {
+  return Build<RawFloat4Track, Float4Track>(_input, _track);
+}
 
 namespace {
 // Fixes-up successive opposite quaternions that would fail to take the shortest
@@ -199,6 +240,189 @@ QuaternionTrack* TrackBuilder::operator()(
     const RawQuaternionTrack& _input) const {
   return Build<RawQuaternionTrack, QuaternionTrack>(_input);
 }
+bool TrackBuilder::operator()(const RawQuaternionTrack& _input,
+                              QuaternionTrack* _track) const {
+  return Build<RawQuaternionTrack, QuaternionTrack>(_input, _track);
+}
+
+template <typename _RawTrack, typename _Track>
+_Track* TrackBuilder::BuildQuantized(const _RawTrack& _input) const {
+  memory::ScopedAllocationTag tag(memory::kTagBuilder);
+
+  // Tests _input validity.
+  if (!_input.Validate()) {
+    return NULL;
+  }
+
+  // Ensure there's a key frame at the start and end of the track.
+  typename _RawTrack::Keyframes keyframes;
+  keyframes.reserve(_input.keyframes.size() + 2);
+  PatchBeginEndKeys(_input, &keyframes);
+
+  // Quantizes ratios, which must remain strictly increasing.
+  const int kMaxRatio = _Track::kMaxRatio;
+  ozz::Vector<uint16_t>::Std ratios(keyframes.size());
+  for (size_t i = 0; i < keyframes.size(); ++i) {
+    ratios[i] = static_cast<uint16_t>(keyframes[i].ratio * kMaxRatio + .5f);
+    if (i > 0 && ratios[i] == ratios[i - 1]) {
+      return NULL;
+    }
+  }
+
+  // Finds components range.
+  const int kComponents = _Track::kComponents;
+  float mins[kComponents];
+  float maxs[kComponents];
+  for (int c = 0; c < kComponents; ++c) {
+    mins[c] = std::numeric_limits<float>::max();
+    maxs[c] = -std::numeric_limits<float>::max();
+  }
+  for (size_t i = 0; i < keyframes.size(); ++i) {
+    const float* components =
+        reinterpret_cast<const float*>(&keyframes[i].value);
+    for (int c = 0; c < kComponents; ++c) {
+      mins[c] = math::Min(mins[c], components[c]);
+      maxs[c] = math::Max(maxs[c], components[c]);
+    }
+  }
+
+  // Selects 8 bits quantization if its maximum rounding error, half a
+  // quantization step, is within tolerance for all components.
+  int value_size = 1;
+  for (int c = 0; c < kComponents; ++c) {
+    if ((maxs[c] - mins[c]) / (2.f * 255.f) > tolerance) {
+      value_size = 2;
+    }
+  }
+  const float max_quantized = value_size == 1 ? 255.f : 65535.f;
+
+  // Everything is fine, allocates and fills the track.
+  _Track* track = memory::default_allocator()->New<_Track>();
+  const size_t name_len = _input.name.size();
+  track->Allocate(keyframes.size(), value_size, name_len);
+  for (int c = 0; c < kComponents; ++c) {
+    track->offsets_[c] = mins[c];
+    track->scales_[c] = (maxs[c] - mins[c]) / max_quantized;
+  }
+
+  memset(track->steps_.begin, 0, track->steps_.size());
+  uint16_t* values16 = reinterpret_cast<uint16_t*>(track->values_.begin);
+  for (size_t i = 0; i < keyframes.size(); ++i) {
+    const typename _RawTrack::Keyframe& src_key = keyframes[i];
+    track->ratios_[i] = ratios[i];
+    const float* components = reinterpret_cast<const float*>(&src_key.value);
+    for (int c = 0; c < kComponents; ++c) {
+      const float range = maxs[c] - mins[c];
+      const float normalized =
+          range > 0.f ? (components[c] - mins[c]) / range : 0.f;
+      const int quantized = static_cast<int>(normalized * max_quantized + .5f);
+      const size_t v = i * kComponents + c;
+      if (value_size == 1) {
+        track->values_[v] = static_cast<uint8_t>(quantized);
+      } else {
+        values16[v] = static_cast<uint16_t>(quantized);
+      }
+    }
+    track->steps_[i / 8] |=
+        (src_key.interpolation == RawTrackInterpolation::kStep) << (i & 7);
+  }
+
+  // Copy track's name.
+  if (name_len) {
+    strcpy(track->name_, _input.name.c_str());
+  }
+
+  return track;  // Success.
+}
+
+QuantizedFloatTrack* TrackBuilder::Quantize(const RawFloatTrack& _input) const {
+  return BuildQuantized<RawFloatTrack, QuantizedFloatTrack>(_input);
+}
+QuantizedFloat2Track* TrackBuilder::Quantize(
+    const RawFloat2Track& _input) const {
+  return BuildQuantized<RawFloat2Track, QuantizedFloat2Track>(_input);
+}
+QuantizedFloat3Track* TrackBuilder::Quantize(
+    const RawFloat3Track& _input) const {
+  return BuildQuantized<RawFloat3Track, QuantizedFloat3Track>(_input);
+}
+QuantizedFloat4Track* TrackBuilder::Quantize(
+    const RawFloat4Track& _input) const {
+  return BuildQuantized<RawFloat4Track, QuantizedFloat4Track>(_input);
+}
+
+TrackSet* TrackBuilder::operator()(const RawTrackSet& _input) const {
+  memory::ScopedAllocationTag tag(memory::kTagBuilder);
+
+  // Tests _input validity.
+  if (!_input.Validate()) {
+    return NULL;
+  }
+
+  // Ensure there's a key frame at the start and end of every channel, and
+  // gathers all channels ratios.
+  const size_t num_channels = _input.channels.size();
+  ozz::Vector<RawFloatTrack::Keyframes>::Std channels(num_channels);
+  ozz::Vector<float>::Std ratios;
+  for (size_t c = 0; c < num_channels; ++c) {
+    const RawFloatTrack& channel = _input.channels[c];
+    channels[c].reserve(channel.keyframes.size() + 2);
+    PatchBeginEndKeys(channel, &channels[c]);
+    for (size_t i = 0; i < channels[c].size(); ++i) {
+      ratios.push_back(channels[c][i].ratio);
+    }
+  }
+
+  // Merges ratios into a sorted and deduplicated time axis.
+  std::sort(ratios.begin(), ratios.end());
+  ratios.erase(std::unique(ratios.begin(), ratios.end()), ratios.end());
+
+  // Everything is fine, allocates and fills the track set.
+  TrackSet* track_set = memory::default_allocator()->New<TrackSet>();
+  const size_t name_len = _input.name.size();
+  track_set->Allocate(ratios.size(), static_cast<int>(num_channels), name_len);
+  assert(ratios.size() == track_set->ratios_.count() &&
+         ratios.size() * num_channels == track_set->values_.count() &&
+         track_set->values_.count() <= track_set->steps_.count() * 8);
+  memset(track_set->steps_.begin, 0, track_set->steps_.size());
+  for (size_t i = 0; i < ratios.size(); ++i) {
+    track_set->ratios_[i] = ratios[i];
+  }
+
+  // Fills all channels values, resampling channels at the ratios they don't
+  // have a keyframe for. Inserting a key inside a segment doesn't change the
+  // curve, as long as it inherits segment interpolation mode.
+  for (size_t c = 0; c < num_channels; ++c) {
+    const RawFloatTrack::Keyframes& keyframes = channels[c];
+    size_t k = 0;  // Last channel keyframe with a ratio <= ratios[i].
+    for (size_t i = 0; i < ratios.size(); ++i) {
+      const float ratio = ratios[i];
+      while (k + 1 < keyframes.size() && keyframes[k + 1].ratio <= ratio) {
+        ++k;
+      }
+      const RawFloatTrack::Keyframe& key = keyframes[k];
+      const bool step = key.interpolation == RawTrackInterpolation::kStep;
+      float value = key.value;
+      if (key.ratio != ratio && !step) {
+        // Last channel key is at ratio 1, so there's always a next key.
+        assert(k + 1 < keyframes.size());
+        const RawFloatTrack::Keyframe& next = keyframes[k + 1];
+        const float alpha = (ratio - key.ratio) / (next.ratio - key.ratio);
+        value = math::Lerp(key.value, next.value, alpha);
+      }
+      const size_t v = i * num_channels + c;
+      track_set->values_[v] = value;
+      track_set->steps_[v / 8] |= step << (v & 7);
+    }
+  }
+
+  // Copy track set's name.
+  if (name_len) {
+    strcpy(track_set->name_, _input.name.c_str());
+  }
+
+  return track_set;  // Success.
+}
 }  // namespace offline
 }  // namespace animation
 }  // namespace ozz
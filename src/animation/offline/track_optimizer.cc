@@ -42,7 +42,9 @@ namespace animation {
 namespace offline {
 
 // Setup default values (favoring quality).
-TrackOptimizer::TrackOptimizer() : tolerance(1e-3f) {  // 1 mm.
+TrackOptimizer::TrackOptimizer()
+    : tolerance(1e-3f),  // 1 mm.
+      window_size(0) {
 }
 
 namespace {
@@ -51,9 +53,12 @@ bool Compare(float _left, float _right, float _tolerance) {
   return fabs(_left - _right) <= _tolerance;
 }
 
-// Copy _src keys to _dest but except the ones that can be interpolated.
+// Copy _src keys to _dest but except the ones that can be interpolated. At
+// most _window consecutive keys are interpolated, see
+// TrackOptimizer::window_size.
 template <typename _Keyframes>
-void Filter(const _Keyframes& _src, float _tolerance, _Keyframes* _dest) {
+void Filter(const _Keyframes& _src, float _tolerance, size_t _window,
+            _Keyframes* _dest) {
   typedef typename _Keyframes::value_type Keyframe;
   typedef typename Keyframe::ValueType ValueType;
 
@@ -77,6 +82,11 @@ void Filter(const _Keyframes& _src, float _tolerance, _Keyframes* _dest) {
         _dest->push_back(current);
         last_src_pushed = i;
       }
+    } else if (i - last_src_pushed > _window) {
+      // Window is full, so i key is pushed without testing. Keys in range
+      // ]last_src_pushed,i[ were already validated against it.
+      _dest->push_back(current);
+      last_src_pushed = i;
     } else {
       // Only inserts i key if keys in range ]last_src_pushed,i] cannot be
       // interpolated from keys last_src_pushed and i + 1.
@@ -119,7 +129,10 @@ bool Optimize(const TrackOptimizer& _optimizer, const _Track& _input,
   _output->name = _input.name;
 
   // Optimizes.
-  Filter(_input.keyframes, _optimizer.tolerance, &_output->keyframes);
+  const size_t window = _optimizer.window_size > 0
+                            ? static_cast<size_t>(_optimizer.window_size)
+                            : ~static_cast<size_t>(0);
+  Filter(_input.keyframes, _optimizer.tolerance, window, &_output->keyframes);
 
   // Output animation is always valid though.
   return _output->Validate();
@@ -0,0 +1,149 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/offline/uniform_animation_builder.h"
+
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/raw_animation_utils.h"
+#include "ozz/animation/runtime/uniform_animation.h"
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/allocator.h"
+
+namespace ozz {
+namespace animation {
+namespace offline {
+
+UniformAnimationBuilder::UniformAnimationBuilder() : frequency(30.f) {}
+
+namespace {
+// Packs up to 4 transforms of _transforms, starting at _first, to _soa.
+// Missing transforms are set to identity.
+void Pack(const ozz::Vector<math::Transform>::Std& _transforms, size_t _first,
+          math::SoaTransform* _soa) {
+  math::Transform aos[4];
+  for (size_t i = 0; i < 4; ++i) {
+    const size_t track = _first + i;
+    aos[i] = track < _transforms.size() ? _transforms[track]
+                                        : math::Transform::identity();
+  }
+  _soa->translation = math::SoaFloat3::Load(
+      math::simd_float4::Load(aos[0].translation.x, aos[1].translation.x,
+                              aos[2].translation.x, aos[3].translation.x),
+      math::simd_float4::Load(aos[0].translation.y, aos[1].translation.y,
+                              aos[2].translation.y, aos[3].translation.y),
+      math::simd_float4::Load(aos[0].translation.z, aos[1].translation.z,
+                              aos[2].translation.z, aos[3].translation.z));
+  _soa->rotation = math::SoaQuaternion::Load(
+      math::simd_float4::Load(aos[0].rotation.x, aos[1].rotation.x,
+                              aos[2].rotation.x, aos[3].rotation.x),
+      math::simd_float4::Load(aos[0].rotation.y, aos[1].rotation.y,
+                              aos[2].rotation.y, aos[3].rotation.y),
+      math::simd_float4::Load(aos[0].rotation.z, aos[1].rotation.z,
+                              aos[2].rotation.z, aos[3].rotation.z),
+      math::simd_float4::Load(aos[0].rotation.w, aos[1].rotation.w,
+                              aos[2].rotation.w, aos[3].rotation.w));
+  _soa->scale = math::SoaFloat3::Load(
+      math::simd_float4::Load(aos[0].scale.x, aos[1].scale.x, aos[2].scale.x,
+                              aos[3].scale.x),
+      math::simd_float4::Load(aos[0].scale.y, aos[1].scale.y, aos[2].scale.y,
+                              aos[3].scale.y),
+      math::simd_float4::Load(aos[0].scale.z, aos[1].scale.z, aos[2].scale.z,
+                              aos[3].scale.z));
+}
+}  // namespace
+
+UniformAnimation* UniformAnimationBuilder::operator()(
+    const RawAnimation& _input) const {
+  // Tests _raw_animation validity.
+  if (!_input.Validate() || !(frequency > 0.f)) {
+    return NULL;
+  }
+
+  // Computes the number of frames, rounding up the number of intervals, with a
+  // tolerance for floating point approximations.
+  const float intervals = _input.duration * frequency;
+  const int num_frames =
+      math::Max(static_cast<int>(std::ceil(intervals - 1e-3f)), 1) + 1;
+
+  UniformAnimation* animation =
+      memory::default_allocator()->New<UniformAnimation>();
+  animation->duration_ = _input.duration;
+  animation->Allocate(_input.name.size(), _input.num_tracks(), num_frames);
+
+  // Samples all frames at once.
+  const size_t num_tracks = _input.tracks.size();
+  const int num_soa_tracks = animation->num_soa_tracks();
+  ozz::Vector<float>::Std times(num_frames);
+  for (int f = 0; f < num_frames; ++f) {
+    times[f] = _input.duration * f / (num_frames - 1);
+  }
+  ozz::Vector<math::Transform>::Std samples(num_frames * num_tracks);
+  const Range<math::Transform> range =
+      num_tracks > 0 ? make_range(samples) : Range<math::Transform>();
+  const bool sampled = SampleRawAnimation(_input, make_range(times), range);
+  (void)sampled;
+  assert(sampled);
+
+  ozz::Vector<math::Transform>::Std transforms(num_tracks);
+  for (int f = 0; f < num_frames; ++f) {
+    const math::Transform* frame_samples =
+        num_tracks > 0 ? &samples[f * num_tracks] : NULL;
+    for (size_t t = 0; t < num_tracks; ++t) {
+      // Keeps consecutive frames rotations in the same hemisphere, so that the
+      // runtime nlerp takes the shortest path.
+      const math::Quaternion& a = transforms[t].rotation;
+      const math::Quaternion& b = frame_samples[t].rotation;
+      const bool flip =
+          f > 0 && a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w < 0.f;
+      transforms[t] = frame_samples[t];
+      if (flip) {
+        transforms[t].rotation = -transforms[t].rotation;
+      }
+    }
+
+    math::SoaTransform* frame = animation->frames_.begin + f * num_soa_tracks;
+    for (int i = 0; i < num_soa_tracks; ++i) {
+      Pack(transforms, i * 4, frame + i);
+    }
+  }
+
+  // Copy animation's name.
+  if (animation->name_) {
+    strcpy(animation->name_, _input.name.c_str());
+  }
+
+  return animation;  // Success.
+}
+}  // namespace offline
+}  // namespace animation
+}  // namespace ozz
@@ -0,0 +1,155 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#include "ozz/animation/runtime/accumulated_blending_job.h"
+
+#include <cassert>
+
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/profile.h"
+
+namespace ozz {
+namespace animation {
+
+void ResetBlendAccumulators(const Range<SoaBlendAccumulator>& _accumulators) {
+  const math::SimdFloat4 zero = math::simd_float4::zero();
+  const SoaBlendAccumulator reset = {{zero, zero, zero},
+                                     {zero, zero, zero, zero},
+                                     {zero, zero, zero},
+                                     zero};
+  for (SoaBlendAccumulator* acc = _accumulators.begin;
+       acc < _accumulators.end; ++acc) {
+    *acc = reset;
+  }
+}
+
+AccumulatedBlendingJob::AccumulatedBlendingJob()
+    : threshold(.1f), quality(BlendingJob::kStandard) {}
+
+bool AccumulatedBlendingJob::Validate() const {
+  // Don't need any early out, as jobs are valid in most of the performance
+  // critical cases.
+  // Tests are written in multiple lines in order to avoid branches.
+  bool valid = true;
+
+  // Test for valid threshold.
+  valid &= threshold > 0.f;
+
+  // Test for NULL begin pointers.
+  valid &= bind_pose.begin != NULL;
+  valid &= accumulator.begin != NULL;
+  valid &= output.begin != NULL;
+
+  // Test ranges are valid (implicitly test for NULL end pointers).
+  valid &= bind_pose.end >= bind_pose.begin;
+
+  // The bind pose size defines the ranges of transforms to normalize, so all
+  // other buffers should be bigger.
+  const ptrdiff_t min_range = bind_pose.end - bind_pose.begin;
+  valid &= accumulator.end - accumulator.begin >= min_range;
+  valid &= output.end - output.begin >= min_range;
+
+  return valid;
+}
+
+namespace {
+// Blends the bind pose to the joints whose accumulated weight is less than the
+// threshold, normalizes accumulated transforms to the output, and resets the
+// accumulators. _Policy defines quaternion normalization precision, see
+// BlendingJob::Quality.
+template <typename _Policy>
+void NormalizeAccumulated(const AccumulatedBlendingJob& _job) {
+  const math::SimdFloat4 zero = math::simd_float4::zero();
+  const math::SimdFloat4 one = math::simd_float4::one();
+  const math::SimdFloat4 simd_threshold =
+      math::simd_float4::Load1(_job.threshold);
+
+  const ptrdiff_t num_soa_joints = _job.bind_pose.end - _job.bind_pose.begin;
+  for (ptrdiff_t i = 0; i < num_soa_joints; ++i) {
+    SoaBlendAccumulator& acc = _job.accumulator.begin[i];
+    const math::SoaTransform& bp = _job.bind_pose.begin[i];
+
+    // Blends bind pose if accumulated weight is less than the threshold, the
+    // same way BlendingJob does with partial blending.
+    const math::SimdFloat4 bp_weight = math::Max0(simd_threshold - acc.weight);
+    const math::SimdFloat4 weight = math::Max(simd_threshold, acc.weight);
+    const math::SimdFloat4 dot = acc.rotation.x * bp.rotation.x +
+                                 acc.rotation.y * bp.rotation.y +
+                                 acc.rotation.z * bp.rotation.z +
+                                 acc.rotation.w * bp.rotation.w;
+    const math::SimdInt4 sign = math::Sign(dot);
+    const math::SoaQuaternion bp_rotation = {
+        math::Xor(bp.rotation.x, sign), math::Xor(bp.rotation.y, sign),
+        math::Xor(bp.rotation.z, sign), math::Xor(bp.rotation.w, sign)};
+
+    // Normalizes output. Quaternion length cannot be zero as opposed
+    // quaternions have been fixed up during accumulation.
+    const math::SimdFloat4 ratio = one / weight;
+    math::SoaTransform& out = _job.output.begin[i];
+    out.translation = (acc.translation + bp.translation * bp_weight) * ratio;
+    out.rotation =
+        _Policy::Normalize(acc.rotation + bp_rotation * bp_weight);
+    out.scale = (acc.scale + bp.scale * bp_weight) * ratio;
+
+    // Resets accumulator for the next blend.
+    const math::SoaFloat3 zero3 = {zero, zero, zero};
+    const math::SoaQuaternion zero_quat = {zero, zero, zero, zero};
+    acc.translation = zero3;
+    acc.rotation = zero_quat;
+    acc.scale = zero3;
+    acc.weight = zero;
+  }
+}
+}  // namespace
+
+bool AccumulatedBlendingJob::Run() const {
+  if (!Validate()) {
+    return false;
+  }
+  OZZ_PROFILE_ZONE("ozz::AccumulatedBlendingJob::Run");
+
+  // Dispatches to the kernel specialized for the requested quality.
+  switch (quality) {
+    case BlendingJob::kFast: {
+      NormalizeAccumulated<math::EstimatedNormalization<0> >(*this);
+      break;
+    }
+    case BlendingJob::kAccurate: {
+      NormalizeAccumulated<math::ExactNormalization>(*this);
+      break;
+    }
+    default: {
+      NormalizeAccumulated<math::EstimatedNormalization<1> >(*this);
+      break;
+    }
+  }
+  return true;
+}
+}  // namespace animation
+}  // namespace ozz
@@ -27,14 +27,24 @@
 
 #include "ozz/animation/runtime/animation.h"
 
+#include "ozz/base/containers/vector.h"
 #include "ozz/base/io/archive.h"
 #include "ozz/base/log.h"
+#include "ozz/base/maths/box.h"
 #include "ozz/base/maths/math_archive.h"
 #include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/simd_math.h"
 #include "ozz/base/memory/allocator.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cstring>
+#include <limits>
+#include <new>
+#include <utility>
+#if __cplusplus >= 201103L
+#include <atomic>
+#endif  // __cplusplus
 
 // Internal include file
 #define OZZ_INCLUDE_PRIVATE_HEADER  // Allows to include private headers.
@@ -43,30 +53,556 @@
 namespace ozz {
 namespace animation {
 
-Animation::Animation() : duration_(0.f), num_tracks_(0), name_(NULL) {}
+namespace {
+// Last generated animation unique identifier.
+#if __cplusplus >= 201103L
+std::atomic<uint32_t> g_last_uid(0);
+#else   // __cplusplus
+uint32_t g_last_uid = 0;
+#endif  // __cplusplus
+
+// Generates a new animation unique identifier, skipping 0 on wrap around.
+uint32_t GenerateUid() {
+  uint32_t uid = ++g_last_uid;
+  while (uid == 0) {
+    uid = ++g_last_uid;
+  }
+  return uid;
+}
+
+// Number of bits of the values of a key of archive versions prior to 21,
+// which stored 16 bits per component.
+const int kLegacyKeyBits = 3 * kMaxValueBits;
+
+// Converts half float keys values (archive versions prior to 8) to values
+// quantized in per-track ranges. _values are the 3 values of every key.
+template <typename _Key>
+void HalfToRanged(const Range<_Key>& _keys, uint16_t* _values,
+                  const Range<KeyRange>& _ranges) {
+  // Computes ranges.
+  const size_t num_tracks = _ranges.count() * 4;
+  const float kMax = std::numeric_limits<float>::max();
+  ozz::Vector<float>::Std mins(num_tracks * 3, kMax);
+  ozz::Vector<float>::Std maxs(num_tracks * 3, -kMax);
+  for (size_t i = 0; i < _keys.count(); ++i) {
+    const int track = _keys.begin[i].track;
+    for (int c = 0; c < 3; ++c) {
+      const float value = math::HalfToFloat(_values[i * 3 + c]);
+      float& min = mins[track * 3 + c];
+      float& max = maxs[track * 3 + c];
+      min = math::Min(min, value);
+      max = math::Max(max, value);
+    }
+  }
+  for (size_t i = 0; i < num_tracks; ++i) {
+    KeyRange& range = _ranges.begin[i / 4];
+    for (int c = 0; c < 3; ++c) {
+      const float min = mins[i * 3 + c];
+      const float max = maxs[i * 3 + c];
+      const bool valid = min <= max;  // Track might have no key.
+      range.min[c][i & 3] = valid ? min : 0.f;
+      range.step[c][i & 3] = valid ? (max - min) / 65535.f : 0.f;
+      range.bits[c][i & 3] = kMaxValueBits;
+    }
+  }
+
+  // Quantizes values.
+  for (size_t i = 0; i < _keys.count(); ++i) {
+    const int track = _keys.begin[i].track;
+    const KeyRange& range = _ranges.begin[track / 4];
+    for (int c = 0; c < 3; ++c) {
+      const float value = math::HalfToFloat(_values[i * 3 + c]);
+      _values[i * 3 + c] = static_cast<uint16_t>(
+          QuantizeRanged(value, range.min[c][track & 3],
+                         range.step[c][track & 3], kMaxValueBits));
+    }
+  }
+}
+
+// Packs the 16 bits _values (3 per key) of the _num_keys keys of archive
+// versions prior to 21 to _packed, along with their _offsets.
+void PackLegacyValues(const uint16_t* _values, size_t _num_keys,
+                      const Range<uint32_t>& _offsets,
+                      const Range<uint8_t>& _packed) {
+  std::memset(_packed.begin, 0, _packed.size());
+  for (size_t i = 0; i < _offsets.count(); ++i) {
+    _offsets.begin[i] =
+        static_cast<uint32_t>(i * kValueBlockSize * kLegacyKeyBits);
+  }
+  for (size_t i = 0; i < _num_keys * 3; ++i) {
+    PackValue(_values[i], kMaxValueBits,
+              static_cast<uint32_t>(i * kMaxValueBits), _packed.begin);
+  }
+}
+
+// Loads a key ratio. Float ratios of archive versions prior to 9 are loaded
+// as float key times, in _num_frames frames.
+void LoadRatio(ozz::io::IArchive& _archive, uint32_t _version,
+               int _num_frames, uint16_t* _ratio, float* _time) {
+  if (_version >= 9) {
+    _archive >> *_ratio;
+  } else {
+    float ratio;
+    _archive >> ratio;
+    *_ratio = 0;
+    *_time = ratio * _num_frames;
+  }
+}
+
+// Tells if RotationKey bitfields in-memory layout matches the archive layout
+// (track in the 13 lower bits of the second word, then largest and sign), so
+// that rotation keys can be serialized as raw 16 bits words.
+bool NativeRotationKeyLayout() {
+  OZZ_STATIC_ASSERT(sizeof(RotationKey) == 5 * sizeof(uint16_t));
+  RotationKey key;
+  std::memset(&key, 0, sizeof(key));
+  key.track = 1;
+  key.largest = 2;
+  key.sign = 1;
+  uint16_t words[sizeof(RotationKey) / sizeof(uint16_t)];
+  std::memcpy(words, &key, sizeof(key));
+  return words[1] == (1 | 2 << 13 | 1 << 15);
+}
+
+// Serializes a buffer of keys or tangents, exclusively made of 16 bits
+// words, with a single bulk array operation. Archive only needs to swap
+// words in place when endianness differs.
+template <typename _Ty>
+void SaveWords(ozz::io::OArchive& _archive, const Range<_Ty>& _buffer) {
+  OZZ_STATIC_ASSERT(sizeof(_Ty) % sizeof(uint16_t) == 0);
+  _archive << ozz::io::MakeArray(
+      reinterpret_cast<const uint16_t*>(_buffer.begin),
+      _buffer.size() / sizeof(uint16_t));
+}
+
+template <typename _Ty>
+void LoadWords(ozz::io::IArchive& _archive, const Range<_Ty>& _buffer) {
+  OZZ_STATIC_ASSERT(sizeof(_Ty) % sizeof(uint16_t) == 0);
+  _archive >> ozz::io::MakeArray(reinterpret_cast<uint16_t*>(_buffer.begin),
+                                 _buffer.size() / sizeof(uint16_t));
+}
+
+// Serializes quantization ranges, made of floats followed by bits.
+void SaveRanges(ozz::io::OArchive& _archive, const Range<KeyRange>& _ranges) {
+  for (const KeyRange* range = _ranges.begin; range < _ranges.end; ++range) {
+    _archive << ozz::io::MakeArray(&range->min[0][0], 24);
+    _archive << ozz::io::MakeArray(&range->bits[0][0], 12);
+  }
+}
+
+void LoadRanges(ozz::io::IArchive& _archive, const Range<KeyRange>& _ranges) {
+  for (KeyRange* range = _ranges.begin; range < _ranges.end; ++range) {
+    _archive >> ozz::io::MakeArray(&range->min[0][0], 24);
+    _archive >> ozz::io::MakeArray(&range->bits[0][0], 12);
+  }
+}
+
+// Loads quantization ranges of archive versions 8 to 20, which had no bits.
+void LoadLegacyRanges(ozz::io::IArchive& _archive,
+                      const Range<KeyRange>& _ranges) {
+  for (KeyRange* range = _ranges.begin; range < _ranges.end; ++range) {
+    _archive >> ozz::io::MakeArray(&range->min[0][0], 24);
+    std::memset(range->bits, kMaxValueBits, sizeof(range->bits));
+  }
+}
+
+// Loads translation or scale keys of archive versions prior to 21, which
+// stored 16 bits values in keys, to _keys and _values (3 per key).
+template <typename _Key>
+void LoadLegacyKeys(ozz::io::IArchive& _archive, uint32_t _version,
+                    int _num_frames, const Range<_Key>& _keys, float* _times,
+                    ozz::Vector<uint16_t>::Std* _values) {
+  const size_t count = _keys.count();
+  _values->resize(count * 3);
+  if (_version >= 14) {
+    // Keys were bulk arrays of 16 bits words.
+    ozz::Vector<uint16_t>::Std words(count * 5);
+    if (count > 0) {
+      _archive >> ozz::io::MakeArray(&words[0], words.size());
+    }
+    for (size_t i = 0; i < count; ++i) {
+      _keys.begin[i].ratio = words[i * 5 + 0];
+      _keys.begin[i].track = words[i * 5 + 1];
+      for (int c = 0; c < 3; ++c) {
+        (*_values)[i * 3 + c] = words[i * 5 + 2 + c];
+      }
+    }
+  } else {
+    for (size_t i = 0; i < count; ++i) {
+      _Key& key = _keys.begin[i];
+      LoadRatio(_archive, _version, _num_frames, &key.ratio, _times + i);
+      _archive >> key.track;
+      _archive >> ozz::io::MakeArray(&(*_values)[i * 3], 3);
+    }
+  }
+}
+
+// Loads rotation keys, whose layout didn't change since version 14.
+void LoadRotations(ozz::io::IArchive& _archive, uint32_t _version,
+                   int _num_frames, const Range<RotationKey>& _keys,
+                   float* _times) {
+  if (_version >= 14) {
+    LoadWords(_archive, _keys);
+    if (!NativeRotationKeyLayout()) {
+      for (RotationKey* key = _keys.begin; key < _keys.end; ++key) {
+        uint16_t words[sizeof(RotationKey) / sizeof(uint16_t)];
+        std::memcpy(words, key, sizeof(*key));
+        key->track = words[1] & 0x1fff;
+        key->largest = (words[1] >> 13) & 3;
+        key->sign = words[1] >> 15;
+      }
+    }
+  } else {
+    for (size_t i = 0; i < _keys.count(); ++i) {
+      RotationKey& key = _keys.begin[i];
+      LoadRatio(_archive, _version, _num_frames, &key.ratio, _times + i);
+      uint16_t track;
+      _archive >> track;
+      key.track = track;
+      uint8_t largest;
+      _archive >> largest;
+      key.largest = largest & 3;
+      bool sign;
+      _archive >> sign;
+      key.sign = sign & 1;
+      _archive >> ozz::io::MakeArray(key.value);
+    }
+  }
+}
+}  // namespace
+
+Animation::Animation()
+    : allocator_(memory::default_allocator()),
+      duration_(0.f),
+      num_frames_(0),
+      num_tracks_(0),
+      name_(NULL),
+      uid_(0),
+      skeleton_fingerprint_(0),
+      num_constant_translations_(0),
+      num_constant_rotations_(0),
+      num_constant_scales_(0),
+      capacity_(0),
+      mapped_(false) {}
+
+Animation::Animation(memory::Allocator* _allocator)
+    : allocator_(_allocator),
+      duration_(0.f),
+      num_frames_(0),
+      num_tracks_(0),
+      name_(NULL),
+      uid_(0),
+      skeleton_fingerprint_(0),
+      num_constant_translations_(0),
+      num_constant_rotations_(0),
+      num_constant_scales_(0),
+      capacity_(0),
+      mapped_(false) {
+  assert(_allocator && "Invalid allocator");
+}
 
 Animation::~Animation() { Deallocate(); }
 
+#if __cplusplus >= 201103L
+Animation::Animation(Animation&& _other) : Animation(_other.allocator_) {
+  Swap(_other);
+}
+
+Animation& Animation::operator=(Animation&& _other) {
+  // Previous content is released by temporary destruction.
+  Animation tmp(std::move(_other));
+  Swap(tmp);
+  return *this;
+}
+#endif  // __cplusplus
+
+void Animation::Swap(Animation& _other) {
+  std::swap(allocator_, _other.allocator_);
+  std::swap(duration_, _other.duration_);
+  std::swap(num_frames_, _other.num_frames_);
+  std::swap(num_tracks_, _other.num_tracks_);
+  std::swap(name_, _other.name_);
+  std::swap(uid_, _other.uid_);
+  std::swap(skeleton_fingerprint_, _other.skeleton_fingerprint_);
+  std::swap(translations_, _other.translations_);
+  std::swap(rotations_, _other.rotations_);
+  std::swap(scales_, _other.scales_);
+  std::swap(translation_tangents_, _other.translation_tangents_);
+  std::swap(rotation_tangents_, _other.rotation_tangents_);
+  std::swap(scale_tangents_, _other.scale_tangents_);
+  std::swap(num_constant_translations_, _other.num_constant_translations_);
+  std::swap(num_constant_rotations_, _other.num_constant_rotations_);
+  std::swap(num_constant_scales_, _other.num_constant_scales_);
+  std::swap(translation_ranges_, _other.translation_ranges_);
+  std::swap(scale_ranges_, _other.scale_ranges_);
+  std::swap(translation_values_, _other.translation_values_);
+  std::swap(scale_values_, _other.scale_values_);
+  std::swap(translation_value_offsets_, _other.translation_value_offsets_);
+  std::swap(scale_value_offsets_, _other.scale_value_offsets_);
+  std::swap(seek_ratios_, _other.seek_ratios_);
+  std::swap(seek_keys_, _other.seek_keys_);
+  std::swap(sync_ratios_, _other.sync_ratios_);
+  std::swap(translation_times_, _other.translation_times_);
+  std::swap(rotation_times_, _other.rotation_times_);
+  std::swap(scale_times_, _other.scale_times_);
+  std::swap(bounds_, _other.bounds_);
+  std::swap(steps_, _other.steps_);
+  std::swap(soa_joints_, _other.soa_joints_);
+  std::swap(translation_key_lods_, _other.translation_key_lods_);
+  std::swap(rotation_key_lods_, _other.rotation_key_lods_);
+  std::swap(scale_key_lods_, _other.scale_key_lods_);
+  std::swap(translation_lod_next_, _other.translation_lod_next_);
+  std::swap(rotation_lod_next_, _other.rotation_lod_next_);
+  std::swap(scale_lod_next_, _other.scale_lod_next_);
+  std::swap(capacity_, _other.capacity_);
+  std::swap(mapped_, _other.mapped_);
+}
+
+void Animation::CopyFrom(const Animation& _other) {
+  if (&_other == this) {
+    return;
+  }
+
+  // Buffer size and layout depend on the number of tracks, which must be set
+  // first.
+  num_tracks_ = _other.num_tracks_;
+  const size_t name_len = _other.name_ ? std::strlen(_other.name_) : 0;
+  const size_t size =
+      BufferSize(name_len, _other.translations_.count(),
+                 _other.rotations_.count(), _other.scales_.count(),
+                 _other.translation_values_.count(),
+                 _other.scale_values_.count(), _other.seek_ratios_.count(),
+                 _other.sync_ratios_.count(), _other.bounds_.count(),
+                 _other.spline(), _other.has_steps(), _other.sparse(),
+                 _other.has_precision_lods(), _other.has_key_times());
+  if (size == 0) {
+    Deallocate();
+  } else {
+    // Same layout as _other buffer, which starts with translation ranges.
+    Allocate(name_len, _other.translations_.count(), _other.rotations_.count(),
+             _other.scales_.count(), _other.translation_values_.count(),
+             _other.scale_values_.count(), _other.seek_ratios_.count(),
+             _other.sync_ratios_.count(), _other.bounds_.count(),
+             _other.spline(), _other.has_steps(), _other.sparse(),
+             _other.has_precision_lods(), _other.has_key_times());
+    std::memcpy(translation_ranges_.begin, _other.translation_ranges_.begin,
+                size);
+  }
+
+  duration_ = _other.duration_;
+  num_frames_ = _other.num_frames_;
+  skeleton_fingerprint_ = _other.skeleton_fingerprint_;
+  num_constant_translations_ = _other.num_constant_translations_;
+  num_constant_rotations_ = _other.num_constant_rotations_;
+  num_constant_scales_ = _other.num_constant_scales_;
+}
+
+size_t Animation::BufferSize(size_t _name_len, size_t _translation_count,
+                             size_t _rotation_count, size_t _scale_count,
+                             size_t _translation_value_size,
+                             size_t _scale_value_size,
+                             size_t _seek_point_count, size_t _sync_count,
+                             size_t _bounds_count, bool _spline, bool _steps,
+                             bool _sparse, bool _lods, bool _times) const {
+  // Ranges, seek points, steps and soa joints size depends on the number of
+  // tracks.
+  const size_t range_count = num_soa_tracks();
+  const size_t seek_keys_count = _seek_point_count * seek_point_stride();
+  const size_t steps_count = _steps ? (num_tracks_ + 7) / 8 : 0;
+  const size_t soa_joints_count = _sparse ? range_count : 0;
+  const size_t lods_count =
+      _lods ? _translation_count + _rotation_count + _scale_count : 0;
+  const size_t times_count =
+      _times ? _translation_count + _rotation_count + _scale_count : 0;
+  const size_t value_offsets_count =
+      ValueOffsetCount(_translation_count) + ValueOffsetCount(_scale_count);
+
+  // Compute overall size of the single buffer for all the data.
+  const size_t buffer_size = (_name_len > 0 ? _name_len + 1 : 0) +
+                             _translation_count * sizeof(TranslationKey) +
+                             _rotation_count * sizeof(RotationKey) +
+                             _scale_count * sizeof(ScaleKey) +
+                             range_count * 2 * sizeof(KeyRange) +
+                             _translation_value_size + _scale_value_size +
+                             value_offsets_count * sizeof(uint32_t) +
+                             _seek_point_count * sizeof(float) +
+                             _sync_count * sizeof(float) +
+                             times_count * sizeof(float) +
+                             _bounds_count * sizeof(math::Box) +
+                             seek_keys_count * sizeof(int) +
+                             soa_joints_count * sizeof(int) +
+                             steps_count * sizeof(uint8_t) +
+                             lods_count * (sizeof(int) + sizeof(uint8_t));
+  const size_t tangents_size =
+      _spline ? _translation_count * sizeof(Float3Tangent) +
+                    _rotation_count * sizeof(QuaternionTangent) +
+                    _scale_count * sizeof(Float3Tangent)
+              : 0;
+  return buffer_size + tangents_size;
+}
+
 void Animation::Allocate(size_t _name_len, size_t _translation_count,
-                         size_t _rotation_count, size_t _scale_count) {
+                         size_t _rotation_count, size_t _scale_count,
+                         size_t _translation_value_size,
+                         size_t _scale_value_size, size_t _seek_point_count,
+                         size_t _sync_count, size_t _bounds_count,
+                         bool _spline, bool _steps, bool _sparse, bool _lods,
+                         bool _times) {
+  memory::ScopedAllocationTag tag(memory::kTagAnimation);
+
   // Distributes buffer memory while ensuring proper alignment (serves larger
   // alignment values first).
-  OZZ_STATIC_ASSERT(OZZ_ALIGN_OF(TranslationKey) >= OZZ_ALIGN_OF(RotationKey) &&
+  OZZ_STATIC_ASSERT(OZZ_ALIGN_OF(KeyRange) >= OZZ_ALIGN_OF(float) &&
+                    OZZ_ALIGN_OF(float) >= OZZ_ALIGN_OF(math::Box) &&
+                    OZZ_ALIGN_OF(math::Box) >= OZZ_ALIGN_OF(int) &&
+                    OZZ_ALIGN_OF(int) >= OZZ_ALIGN_OF(TranslationKey) &&
+                    OZZ_ALIGN_OF(TranslationKey) >= OZZ_ALIGN_OF(RotationKey) &&
                     OZZ_ALIGN_OF(RotationKey) >= OZZ_ALIGN_OF(ScaleKey) &&
-                    OZZ_ALIGN_OF(ScaleKey) >= OZZ_ALIGN_OF(char));
+                    OZZ_ALIGN_OF(ScaleKey) >= OZZ_ALIGN_OF(Float3Tangent) &&
+                    OZZ_ALIGN_OF(Float3Tangent) >=
+                        OZZ_ALIGN_OF(QuaternionTangent) &&
+                    OZZ_ALIGN_OF(QuaternionTangent) >=
+                        OZZ_ALIGN_OF(uint8_t) &&
+                    OZZ_ALIGN_OF(uint8_t) >= OZZ_ALIGN_OF(char));
 
-  assert(name_ == NULL && translations_.size() == 0 && rotations_.size() == 0 &&
-         scales_.size() == 0);
+  // Reuses the owned buffer if it's big enough, otherwise previous content is
+  // released.
+  const size_t size =
+      BufferSize(_name_len, _translation_count, _rotation_count, _scale_count,
+                 _translation_value_size, _scale_value_size,
+                 _seek_point_count, _sync_count, _bounds_count, _spline,
+                 _steps, _sparse, _lods, _times);
+  char* buffer;
+  if (capacity_ > 0 && capacity_ >= size) {
+    assert(!mapped_);
+    buffer = reinterpret_cast<char*>(translation_ranges_.begin);
+    translation_tangents_ = ozz::Range<Float3Tangent>();
+    rotation_tangents_ = ozz::Range<QuaternionTangent>();
+    scale_tangents_ = ozz::Range<Float3Tangent>();
+  } else {
+    Deallocate();
+    buffer = reinterpret_cast<char*>(
+        allocator_->Allocate(size, OZZ_ALIGN_OF(KeyRange)));
+    capacity_ = size;
+  }
 
-  // Compute overall size and allocate a single buffer for all the data.
-  const size_t buffer_size = (_name_len > 0 ? _name_len + 1 : 0) +
-                             _translation_count * sizeof(TranslationKey) +
-                             _rotation_count * sizeof(RotationKey) +
-                             _scale_count * sizeof(ScaleKey);
-  char* buffer = reinterpret_cast<char*>(memory::default_allocator()->Allocate(
-      buffer_size, OZZ_ALIGN_OF(TranslationKey)));
+  // New content, new identifier.
+  uid_ = GenerateUid();
+
+  FixUp(buffer, _name_len, _translation_count, _rotation_count, _scale_count,
+        _translation_value_size, _scale_value_size, _seek_point_count,
+        _sync_count, _bounds_count, _spline, _steps, _sparse, _lods, _times);
+
+  // Bounds are the only non trivially constructible objects of the buffer.
+  for (math::Box* box = bounds_.begin; box < bounds_.end; ++box) {
+    new (box) math::Box;
+  }
+}
+
+void Animation::FixUp(char* _buffer, size_t _name_len,
+                      size_t _translation_count, size_t _rotation_count,
+                      size_t _scale_count, size_t _translation_value_size,
+                      size_t _scale_value_size, size_t _seek_point_count,
+                      size_t _sync_count, size_t _bounds_count, bool _spline,
+                      bool _steps, bool _sparse, bool _lods, bool _times) {
+  // Ranges, seek points, steps and soa joints size depends on the number of
+  // tracks.
+  const size_t range_count = num_soa_tracks();
+  const size_t seek_keys_count = _seek_point_count * seek_point_stride();
+  const size_t steps_count = _steps ? (num_tracks_ + 7) / 8 : 0;
+  char* buffer = _buffer;
 
   // Fix up pointers. Serves larger alignment values first.
+  translation_ranges_.begin = reinterpret_cast<KeyRange*>(buffer);
+  assert(math::IsAligned(translation_ranges_.begin, OZZ_ALIGN_OF(KeyRange)));
+  buffer += range_count * sizeof(KeyRange);
+  translation_ranges_.end = reinterpret_cast<KeyRange*>(buffer);
+
+  scale_ranges_.begin = reinterpret_cast<KeyRange*>(buffer);
+  assert(math::IsAligned(scale_ranges_.begin, OZZ_ALIGN_OF(KeyRange)));
+  buffer += range_count * sizeof(KeyRange);
+  scale_ranges_.end = reinterpret_cast<KeyRange*>(buffer);
+
+  seek_ratios_.begin = reinterpret_cast<float*>(buffer);
+  assert(math::IsAligned(seek_ratios_.begin, OZZ_ALIGN_OF(float)));
+  buffer += _seek_point_count * sizeof(float);
+  seek_ratios_.end = reinterpret_cast<float*>(buffer);
+
+  sync_ratios_.begin = reinterpret_cast<float*>(buffer);
+  assert(math::IsAligned(sync_ratios_.begin, OZZ_ALIGN_OF(float)));
+  buffer += _sync_count * sizeof(float);
+  sync_ratios_.end = reinterpret_cast<float*>(buffer);
+
+  // Key times are only allocated for animations whose key times don't fit
+  // frame indices.
+  if (_times) {
+    translation_times_.begin = reinterpret_cast<float*>(buffer);
+    buffer += _translation_count * sizeof(float);
+    translation_times_.end = reinterpret_cast<float*>(buffer);
+
+    rotation_times_.begin = reinterpret_cast<float*>(buffer);
+    buffer += _rotation_count * sizeof(float);
+    rotation_times_.end = reinterpret_cast<float*>(buffer);
+
+    scale_times_.begin = reinterpret_cast<float*>(buffer);
+    buffer += _scale_count * sizeof(float);
+    scale_times_.end = reinterpret_cast<float*>(buffer);
+  } else {
+    translation_times_ = ozz::Range<float>();
+    rotation_times_ = ozz::Range<float>();
+    scale_times_ = ozz::Range<float>();
+  }
+
+  bounds_.begin = reinterpret_cast<math::Box*>(buffer);
+  assert(math::IsAligned(bounds_.begin, OZZ_ALIGN_OF(math::Box)));
+  buffer += _bounds_count * sizeof(math::Box);
+  bounds_.end = reinterpret_cast<math::Box*>(buffer);
+
+  seek_keys_.begin = reinterpret_cast<int*>(buffer);
+  assert(math::IsAligned(seek_keys_.begin, OZZ_ALIGN_OF(int)));
+  buffer += seek_keys_count * sizeof(int);
+  seek_keys_.end = reinterpret_cast<int*>(buffer);
+
+  // Soa joints are only allocated for sparse animations.
+  if (_sparse) {
+    soa_joints_.begin = reinterpret_cast<int*>(buffer);
+    assert(math::IsAligned(soa_joints_.begin, OZZ_ALIGN_OF(int)));
+    buffer += range_count * sizeof(int);
+    soa_joints_.end = reinterpret_cast<int*>(buffer);
+  } else {
+    soa_joints_ = ozz::Range<int>();
+  }
+
+  // Keys precision lods are only allocated for animations with precision lods.
+  if (_lods) {
+    translation_lod_next_.begin = reinterpret_cast<int*>(buffer);
+    assert(math::IsAligned(translation_lod_next_.begin, OZZ_ALIGN_OF(int)));
+    buffer += _translation_count * sizeof(int);
+    translation_lod_next_.end = reinterpret_cast<int*>(buffer);
+
+    rotation_lod_next_.begin = reinterpret_cast<int*>(buffer);
+    buffer += _rotation_count * sizeof(int);
+    rotation_lod_next_.end = reinterpret_cast<int*>(buffer);
+
+    scale_lod_next_.begin = reinterpret_cast<int*>(buffer);
+    buffer += _scale_count * sizeof(int);
+    scale_lod_next_.end = reinterpret_cast<int*>(buffer);
+  } else {
+    translation_lod_next_ = ozz::Range<int>();
+    rotation_lod_next_ = ozz::Range<int>();
+    scale_lod_next_ = ozz::Range<int>();
+  }
+
+  translation_value_offsets_.begin = reinterpret_cast<uint32_t*>(buffer);
+  assert(math::IsAligned(translation_value_offsets_.begin,
+                         OZZ_ALIGN_OF(uint32_t)));
+  buffer += ValueOffsetCount(_translation_count) * sizeof(uint32_t);
+  translation_value_offsets_.end = reinterpret_cast<uint32_t*>(buffer);
+
+  scale_value_offsets_.begin = reinterpret_cast<uint32_t*>(buffer);
+  buffer += ValueOffsetCount(_scale_count) * sizeof(uint32_t);
+  scale_value_offsets_.end = reinterpret_cast<uint32_t*>(buffer);
+
   translations_.begin = reinterpret_cast<TranslationKey*>(buffer);
   assert(math::IsAligned(translations_.begin, OZZ_ALIGN_OF(TranslationKey)));
   buffer += _translation_count * sizeof(TranslationKey);
@@ -82,6 +618,61 @@ void Animation::Allocate(size_t _name_len, size_t _translation_count,
   buffer += _scale_count * sizeof(ScaleKey);
   scales_.end = reinterpret_cast<ScaleKey*>(buffer);
 
+  // Tangents are only allocated for spline animations.
+  if (_spline) {
+    translation_tangents_.begin = reinterpret_cast<Float3Tangent*>(buffer);
+    assert(math::IsAligned(translation_tangents_.begin,
+                           OZZ_ALIGN_OF(Float3Tangent)));
+    buffer += _translation_count * sizeof(Float3Tangent);
+    translation_tangents_.end = reinterpret_cast<Float3Tangent*>(buffer);
+
+    rotation_tangents_.begin = reinterpret_cast<QuaternionTangent*>(buffer);
+    assert(math::IsAligned(rotation_tangents_.begin,
+                           OZZ_ALIGN_OF(QuaternionTangent)));
+    buffer += _rotation_count * sizeof(QuaternionTangent);
+    rotation_tangents_.end = reinterpret_cast<QuaternionTangent*>(buffer);
+
+    scale_tangents_.begin = reinterpret_cast<Float3Tangent*>(buffer);
+    assert(math::IsAligned(scale_tangents_.begin, OZZ_ALIGN_OF(Float3Tangent)));
+    buffer += _scale_count * sizeof(Float3Tangent);
+    scale_tangents_.end = reinterpret_cast<Float3Tangent*>(buffer);
+  }
+
+  // Steps are only allocated for animations with step tracks.
+  if (_steps) {
+    steps_.begin = reinterpret_cast<uint8_t*>(buffer);
+    buffer += steps_count * sizeof(uint8_t);
+    steps_.end = reinterpret_cast<uint8_t*>(buffer);
+  } else {
+    steps_ = ozz::Range<uint8_t>();
+  }
+
+  if (_lods) {
+    translation_key_lods_.begin = reinterpret_cast<uint8_t*>(buffer);
+    buffer += _translation_count * sizeof(uint8_t);
+    translation_key_lods_.end = reinterpret_cast<uint8_t*>(buffer);
+
+    rotation_key_lods_.begin = reinterpret_cast<uint8_t*>(buffer);
+    buffer += _rotation_count * sizeof(uint8_t);
+    rotation_key_lods_.end = reinterpret_cast<uint8_t*>(buffer);
+
+    scale_key_lods_.begin = reinterpret_cast<uint8_t*>(buffer);
+    buffer += _scale_count * sizeof(uint8_t);
+    scale_key_lods_.end = reinterpret_cast<uint8_t*>(buffer);
+  } else {
+    translation_key_lods_ = ozz::Range<uint8_t>();
+    rotation_key_lods_ = ozz::Range<uint8_t>();
+    scale_key_lods_ = ozz::Range<uint8_t>();
+  }
+
+  translation_values_.begin = reinterpret_cast<uint8_t*>(buffer);
+  buffer += _translation_value_size * sizeof(uint8_t);
+  translation_values_.end = reinterpret_cast<uint8_t*>(buffer);
+
+  scale_values_.begin = reinterpret_cast<uint8_t*>(buffer);
+  buffer += _scale_value_size * sizeof(uint8_t);
+  scale_values_.end = reinterpret_cast<uint8_t*>(buffer);
+
   // Let name be NULL if animation has no name. Allows to avoid allocating this
   // buffer in the constructor of empty animations.
   name_ = reinterpret_cast<char*>(_name_len > 0 ? buffer : NULL);
@@ -89,22 +680,245 @@ void Animation::Allocate(size_t _name_len, size_t _translation_count,
 }
 
 void Animation::Deallocate() {
-  memory::default_allocator()->Deallocate(translations_.begin);
+  // Ranges are the first member of the single allocated buffer. A mapped flat
+  // buffer isn't owned.
+  if (!mapped_) {
+    allocator_->Deallocate(translation_ranges_.begin);
+  }
+  mapped_ = false;
+  capacity_ = 0;
 
   name_ = NULL;
+  uid_ = 0;
   translations_ = ozz::Range<TranslationKey>();
   rotations_ = ozz::Range<RotationKey>();
   scales_ = ozz::Range<ScaleKey>();
+  translation_ranges_ = ozz::Range<KeyRange>();
+  scale_ranges_ = ozz::Range<KeyRange>();
+  translation_values_ = ozz::Range<uint8_t>();
+  scale_values_ = ozz::Range<uint8_t>();
+  translation_value_offsets_ = ozz::Range<uint32_t>();
+  scale_value_offsets_ = ozz::Range<uint32_t>();
+  seek_ratios_ = ozz::Range<float>();
+  seek_keys_ = ozz::Range<int>();
+  sync_ratios_ = ozz::Range<float>();
+  translation_times_ = ozz::Range<float>();
+  rotation_times_ = ozz::Range<float>();
+  scale_times_ = ozz::Range<float>();
+  bounds_ = ozz::Range<math::Box>();
+  steps_ = ozz::Range<uint8_t>();
+  soa_joints_ = ozz::Range<int>();
+  translation_key_lods_ = ozz::Range<uint8_t>();
+  rotation_key_lods_ = ozz::Range<uint8_t>();
+  scale_key_lods_ = ozz::Range<uint8_t>();
+  translation_lod_next_ = ozz::Range<int>();
+  rotation_lod_next_ = ozz::Range<int>();
+  scale_lod_next_ = ozz::Range<int>();
+  translation_tangents_ = ozz::Range<Float3Tangent>();
+  rotation_tangents_ = ozz::Range<QuaternionTangent>();
+  scale_tangents_ = ozz::Range<Float3Tangent>();
+  num_constant_translations_ = 0;
+  num_constant_rotations_ = 0;
+  num_constant_scales_ = 0;
+}
+
+namespace {
+// Header of an animation flat representation, see Animation::WriteFlat().
+// It's followed by the animation buffer, at kFlatAnimationDataOffset.
+struct FlatAnimationHeader {
+  uint32_t tag;
+  uint32_t version;
+  float duration;
+  int32_t num_frames;
+  int32_t num_tracks;
+  uint32_t skeleton_fingerprint;
+  int32_t num_constant_translations;
+  int32_t num_constant_rotations;
+  int32_t num_constant_scales;
+  uint32_t name_len;
+  uint32_t translation_count;
+  uint32_t rotation_count;
+  uint32_t scale_count;
+  uint32_t translation_value_size;
+  uint32_t scale_value_size;
+  uint32_t seek_point_count;
+  uint32_t sync_count;
+  uint32_t bounds_count;
+  uint32_t spline;
+  uint32_t steps;
+  uint32_t sparse;
+  uint32_t lods;
+  uint32_t times;
+  uint32_t data_size;
+};
+
+// Flat representation tag ("ozfa"), also used to detect endianness mismatch.
+const uint32_t kFlatAnimationTag = 0x61667a6f;
+const size_t kFlatAnimationDataOffset =
+    (sizeof(FlatAnimationHeader) + Animation::kFlatAlignment - 1) &
+    ~static_cast<size_t>(Animation::kFlatAlignment - 1);
+}  // namespace
+
+size_t Animation::flat_size() const {
+  const size_t name_len = name_ ? std::strlen(name_) : 0;
+  return kFlatAnimationDataOffset +
+         BufferSize(name_len, translations_.count(), rotations_.count(),
+                    scales_.count(), translation_values_.count(),
+                    scale_values_.count(), seek_ratios_.count(),
+                    sync_ratios_.count(), bounds_.count(), spline(),
+                    has_steps(), sparse(), has_precision_lods(),
+                    has_key_times());
+}
+
+bool Animation::WriteFlat(void* _buffer, size_t _size) const {
+  const size_t flat_size = this->flat_size();
+  if (!_buffer || _size < flat_size ||
+      !math::IsAligned(_buffer, kFlatAlignment)) {
+    log::Err() << "Invalid buffer for animation flat representation."
+               << std::endl;
+    return false;
+  }
+  FlatAnimationHeader header;
+  header.tag = kFlatAnimationTag;
+  header.version = io::internal::Version<const Animation>::kValue;
+  header.duration = duration_;
+  header.num_frames = num_frames_;
+  header.num_tracks = num_tracks_;
+  header.skeleton_fingerprint = skeleton_fingerprint_;
+  header.num_constant_translations = num_constant_translations_;
+  header.num_constant_rotations = num_constant_rotations_;
+  header.num_constant_scales = num_constant_scales_;
+  header.name_len = static_cast<uint32_t>(name_ ? std::strlen(name_) : 0);
+  header.translation_count = static_cast<uint32_t>(translations_.count());
+  header.rotation_count = static_cast<uint32_t>(rotations_.count());
+  header.scale_count = static_cast<uint32_t>(scales_.count());
+  header.translation_value_size =
+      static_cast<uint32_t>(translation_values_.count());
+  header.scale_value_size = static_cast<uint32_t>(scale_values_.count());
+  header.seek_point_count = static_cast<uint32_t>(seek_ratios_.count());
+  header.sync_count = static_cast<uint32_t>(sync_ratios_.count());
+  header.bounds_count = static_cast<uint32_t>(bounds_.count());
+  header.spline = spline() ? 1 : 0;
+  header.steps = has_steps() ? 1 : 0;
+  header.sparse = sparse() ? 1 : 0;
+  header.lods = has_precision_lods() ? 1 : 0;
+  header.times = has_key_times() ? 1 : 0;
+  header.data_size =
+      static_cast<uint32_t>(flat_size - kFlatAnimationDataOffset);
+
+  // Header and data are copied as is, data buffer is a single contiguous
+  // allocation starting with translation ranges.
+  char* dest = static_cast<char*>(_buffer);
+  std::memset(dest, 0, kFlatAnimationDataOffset);
+  std::memcpy(dest, &header, sizeof(header));
+  if (header.data_size > 0) {
+    std::memcpy(dest + kFlatAnimationDataOffset, translation_ranges_.begin,
+                header.data_size);
+  }
+  return true;
+}
+
+bool Animation::MapFlat(const void* _buffer, size_t _size) {
+  // Releases current content, *this is left empty on failure.
+  Deallocate();
+  duration_ = 0.f;
+  num_frames_ = 0;
+  num_tracks_ = 0;
+  skeleton_fingerprint_ = 0;
+
+  if (!_buffer || _size < kFlatAnimationDataOffset ||
+      !math::IsAligned(_buffer, kFlatAlignment)) {
+    log::Err() << "Invalid buffer for animation flat representation."
+               << std::endl;
+    return false;
+  }
+  FlatAnimationHeader header;
+  std::memcpy(&header, _buffer, sizeof(header));
+  if (header.tag != kFlatAnimationTag ||
+      header.version != io::internal::Version<const Animation>::kValue) {
+    log::Err() << "Unsupported animation flat representation." << std::endl;
+    return false;
+  }
+
+  // Ranges and seek keys buffers size depend on the number of tracks.
+  num_tracks_ = header.num_tracks;
+  const size_t data_size =
+      BufferSize(header.name_len, header.translation_count,
+                 header.rotation_count, header.scale_count,
+                 header.translation_value_size, header.scale_value_size,
+                 header.seek_point_count, header.sync_count,
+                 header.bounds_count, header.spline != 0, header.steps != 0,
+                 header.sparse != 0, header.lods != 0, header.times != 0);
+  if (header.num_tracks < 0 || data_size != header.data_size ||
+      _size < kFlatAnimationDataOffset + data_size) {
+    log::Err() << "Corrupted animation flat representation." << std::endl;
+    num_tracks_ = 0;
+    return false;
+  }
+
+  duration_ = header.duration;
+  num_frames_ = header.num_frames;
+  skeleton_fingerprint_ = header.skeleton_fingerprint;
+  num_constant_translations_ = header.num_constant_translations;
+  num_constant_rotations_ = header.num_constant_rotations;
+  num_constant_scales_ = header.num_constant_scales;
+
+  // Buffer content isn't modified, even though ranges aren't const.
+  if (data_size > 0) {
+    char* data = const_cast<char*>(static_cast<const char*>(_buffer)) +
+                 kFlatAnimationDataOffset;
+    FixUp(data, header.name_len, header.translation_count,
+          header.rotation_count, header.scale_count,
+          header.translation_value_size, header.scale_value_size,
+          header.seek_point_count,
+          header.sync_count, header.bounds_count, header.spline != 0,
+          header.steps != 0, header.sparse != 0, header.lods != 0,
+          header.times != 0);
+  }
+  mapped_ = true;
+
+  // New content, new identifier.
+  uid_ = GenerateUid();
+  return true;
+}
+
+int Animation::num_bounds() const {
+  return static_cast<int>(bounds_.count());
+}
+
+const math::Box* Animation::GetBounds(float _ratio) const {
+  const int num_bounds = this->num_bounds();
+  if (num_bounds == 0) {
+    return NULL;
+  }
+  const float ratio = math::Clamp(0.f, _ratio, 1.f);
+  const int index =
+      math::Min(static_cast<int>(ratio * num_bounds), num_bounds - 1);
+  return bounds_.begin + index;
 }
 
 size_t Animation::size() const {
-  const size_t size =
-      sizeof(*this) + translations_.size() + rotations_.size() + scales_.size();
+  const size_t size = sizeof(*this) + translations_.size() +
+                      rotations_.size() + scales_.size() +
+                      translation_ranges_.size() + scale_ranges_.size() +
+                      translation_values_.size() + scale_values_.size() +
+                      translation_value_offsets_.size() +
+                      scale_value_offsets_.size() +
+                      seek_ratios_.size() + seek_keys_.size() +
+                      sync_ratios_.size() + translation_times_.size() +
+                      rotation_times_.size() + scale_times_.size() +
+                      bounds_.size() + steps_.size() +
+                      soa_joints_.size() + translation_tangents_.size() +
+                      rotation_tangents_.size() + scale_tangents_.size() +
+                      translation_key_lods_.size() + rotation_key_lods_.size() +
+                      scale_key_lods_.size() + translation_lod_next_.size() +
+                      rotation_lod_next_.size() + scale_lod_next_.size();
   return size;
 }
 
 void Animation::Save(ozz::io::OArchive& _archive) const {
   _archive << duration_;
+  _archive << static_cast<int32_t>(num_frames_);
   _archive << static_cast<int32_t>(num_tracks_);
 
   const size_t name_len = name_ ? std::strlen(name_) : 0;
@@ -116,44 +930,101 @@ void Animation::Save(ozz::io::OArchive& _archive) const {
   _archive << static_cast<int32_t>(rotation_count);
   const ptrdiff_t scale_count = scales_.count();
   _archive << static_cast<int32_t>(scale_count);
+  _archive << static_cast<int32_t>(translation_values_.count());
+  _archive << static_cast<int32_t>(scale_values_.count());
+  const ptrdiff_t seek_point_count = seek_ratios_.count();
+  _archive << static_cast<int32_t>(seek_point_count);
+  const ptrdiff_t sync_count = sync_ratios_.count();
+  _archive << static_cast<int32_t>(sync_count);
+  const ptrdiff_t bounds_count = bounds_.count();
+  _archive << static_cast<int32_t>(bounds_count);
+  _archive << static_cast<int32_t>(num_constant_translations_);
+  _archive << static_cast<int32_t>(num_constant_rotations_);
+  _archive << static_cast<int32_t>(num_constant_scales_);
+  const bool spline = this->spline();
+  _archive << spline;
+  _archive << skeleton_fingerprint_;
+  const bool steps = has_steps();
+  _archive << steps;
+  const bool sparse = this->sparse();
+  _archive << sparse;
+  const bool lods = has_precision_lods();
+  _archive << lods;
+  const bool times = has_key_times();
+  _archive << times;
 
   _archive << ozz::io::MakeArray(name_, name_len);
 
-  for (ptrdiff_t i = 0; i < translation_count; ++i) {
-    const TranslationKey& key = translations_.begin[i];
-    _archive << key.ratio;
-    _archive << key.track;
-    _archive << ozz::io::MakeArray(key.value);
+  // Keys are stored with their in-memory layout, one bulk array per buffer.
+  // Rotation keys bitfields are repacked on platforms whose layout differs.
+  SaveWords(_archive, translations_);
+  if (NativeRotationKeyLayout()) {
+    SaveWords(_archive, rotations_);
+  } else {
+    for (ptrdiff_t i = 0; i < rotation_count; ++i) {
+      const RotationKey& key = rotations_.begin[i];
+      _archive << key.ratio;
+      const uint16_t bits = static_cast<uint16_t>(
+          key.track | key.largest << 13 | key.sign << 15);
+      _archive << bits;
+      _archive << ozz::io::MakeArray(key.value);
+    }
   }
+  SaveWords(_archive, scales_);
+  SaveRanges(_archive, translation_ranges_);
+  SaveRanges(_archive, scale_ranges_);
+  _archive << ozz::io::MakeArray(translation_values_);
+  _archive << ozz::io::MakeArray(scale_values_);
+  _archive << ozz::io::MakeArray(translation_value_offsets_);
+  _archive << ozz::io::MakeArray(scale_value_offsets_);
 
-  for (ptrdiff_t i = 0; i < rotation_count; ++i) {
-    const RotationKey& key = rotations_.begin[i];
-    _archive << key.ratio;
-    uint16_t track = key.track;
-    _archive << track;
-    uint8_t largest = key.largest;
-    _archive << largest;
-    bool sign = key.sign;
-    _archive << sign;
-    _archive << ozz::io::MakeArray(key.value);
-  }
+  _archive << ozz::io::MakeArray(seek_ratios_);
+  _archive << ozz::io::MakeArray(seek_keys_);
+  _archive << ozz::io::MakeArray(sync_ratios_);
+  _archive << ozz::io::MakeArray(bounds_);
 
-  for (ptrdiff_t i = 0; i < scale_count; ++i) {
-    const ScaleKey& key = scales_.begin[i];
-    _archive << key.ratio;
-    _archive << key.track;
-    _archive << ozz::io::MakeArray(key.value);
-  }
+  SaveWords(_archive, translation_tangents_);
+  SaveWords(_archive, rotation_tangents_);
+  SaveWords(_archive, scale_tangents_);
+
+  _archive << ozz::io::MakeArray(steps_);
+  _archive << ozz::io::MakeArray(soa_joints_);
+
+  _archive << ozz::io::MakeArray(translation_key_lods_);
+  _archive << ozz::io::MakeArray(rotation_key_lods_);
+  _archive << ozz::io::MakeArray(scale_key_lods_);
+  _archive << ozz::io::MakeArray(translation_lod_next_);
+  _archive << ozz::io::MakeArray(rotation_lod_next_);
+  _archive << ozz::io::MakeArray(scale_lod_next_);
+
+  _archive << ozz::io::MakeArray(translation_times_);
+  _archive << ozz::io::MakeArray(rotation_times_);
+  _archive << ozz::io::MakeArray(scale_times_);
 }
 
 void Animation::Load(ozz::io::IArchive& _archive, uint32_t _version) {
   // Destroy animation in case it was already used before.
   Deallocate();
   duration_ = 0.f;
+  num_frames_ = 0;
   num_tracks_ = 0;
+  skeleton_fingerprint_ = 0;
 
-  // No retro-compatibility with anterior versions.
-  if (_version != 6) {
+  // No retro-compatibility with versions anterior to 6. Version 6 has no seek
+  // point. Versions 6 and 7 store translation and scale values as half
+  // floats, which are converted to ranged values. Versions prior to 9 store
+  // key ratios as floats, which are loaded as float key times. Versions prior
+  // to 10 have no constant track. Versions prior to 11 have no spline
+  // animation. Versions prior to 12 have no precomputed bounds. Versions prior
+  // to 13 have no synchronization marker. Versions prior to 14 store keys
+  // field by field, instead of bulk arrays with in-memory layout. Versions
+  // prior to 15 have no skeleton fingerprint. Versions prior to 16 have no
+  // step track. Versions prior to 17 have no sparse animation. Versions prior
+  // to 18 have no precision lod. Versions 9 to 18 store key times in 65535
+  // frames, which their builder kept distinct per track. Versions prior to 20
+  // have no float key time. Versions prior to 21 store 16 bits translation
+  // and scale values in keys, which are packed to 16 bits values.
+  if (_version < 6 || _version > 21) {
     log::Err() << "Unsupported Animation version " << _version << "."
                << std::endl;
     return;
@@ -161,6 +1032,12 @@ void Animation::Load(ozz::io::IArchive& _archive, uint32_t _version) {
 
   _archive >> duration_;
 
+  int32_t num_frames = kMaxFrames;
+  if (_version >= 19) {
+    _archive >> num_frames;
+  }
+  num_frames_ = num_frames;
+
   int32_t num_tracks;
   _archive >> num_tracks;
   num_tracks_ = num_tracks;
@@ -173,41 +1050,129 @@ void Animation::Load(ozz::io::IArchive& _archive, uint32_t _version) {
   _archive >> rotation_count;
   int32_t scale_count;
   _archive >> scale_count;
+  int32_t translation_value_size =
+      static_cast<int32_t>(ValueBufferSize(translation_count,
+                                           translation_count * kLegacyKeyBits));
+  int32_t scale_value_size = static_cast<int32_t>(
+      ValueBufferSize(scale_count, scale_count * kLegacyKeyBits));
+  if (_version >= 21) {
+    _archive >> translation_value_size;
+    _archive >> scale_value_size;
+  }
+  int32_t seek_point_count = 0;
+  if (_version >= 7) {
+    _archive >> seek_point_count;
+  }
+  int32_t sync_count = 0;
+  if (_version >= 13) {
+    _archive >> sync_count;
+  }
+  int32_t bounds_count = 0;
+  if (_version >= 12) {
+    _archive >> bounds_count;
+  }
+  int32_t num_constant_translations = 0;
+  int32_t num_constant_rotations = 0;
+  int32_t num_constant_scales = 0;
+  if (_version >= 10) {
+    _archive >> num_constant_translations;
+    _archive >> num_constant_rotations;
+    _archive >> num_constant_scales;
+  }
+  bool spline = false;
+  if (_version >= 11) {
+    _archive >> spline;
+  }
+  if (_version >= 15) {
+    _archive >> skeleton_fingerprint_;
+  }
+  bool steps = false;
+  if (_version >= 16) {
+    _archive >> steps;
+  }
+  bool sparse = false;
+  if (_version >= 17) {
+    _archive >> sparse;
+  }
+  bool lods = false;
+  if (_version >= 18) {
+    _archive >> lods;
+  }
+  bool times = _version < 9;
+  if (_version >= 20) {
+    _archive >> times;
+  }
 
-  Allocate(name_len, translation_count, rotation_count, scale_count);
+  Allocate(name_len, translation_count, rotation_count, scale_count,
+           translation_value_size, scale_value_size, seek_point_count,
+           sync_count, bounds_count, spline, steps, sparse, lods, times);
+  num_constant_translations_ = num_constant_translations;
+  num_constant_rotations_ = num_constant_rotations;
+  num_constant_scales_ = num_constant_scales;
 
   if (name_) {  // NULL name_ is supported.
     _archive >> ozz::io::MakeArray(name_, name_len);
     name_[name_len] = 0;
   }
 
-  for (int i = 0; i < translation_count; ++i) {
-    TranslationKey& key = translations_.begin[i];
-    _archive >> key.ratio;
-    _archive >> key.track;
-    _archive >> ozz::io::MakeArray(key.value);
-  }
-
-  for (int i = 0; i < rotation_count; ++i) {
-    RotationKey& key = rotations_.begin[i];
-    _archive >> key.ratio;
-    uint16_t track;
-    _archive >> track;
-    key.track = track;
-    uint8_t largest;
-    _archive >> largest;
-    key.largest = largest & 3;
-    bool sign;
-    _archive >> sign;
-    key.sign = sign & 1;
-    _archive >> ozz::io::MakeArray(key.value);
-  }
-
-  for (int i = 0; i < scale_count; ++i) {
-    ScaleKey& key = scales_.begin[i];
-    _archive >> key.ratio;
-    _archive >> key.track;
-    _archive >> ozz::io::MakeArray(key.value);
+  if (_version >= 21) {
+    LoadWords(_archive, translations_);
+    LoadRotations(_archive, _version, num_frames, rotations_,
+                  rotation_times_.begin);
+    LoadWords(_archive, scales_);
+    LoadRanges(_archive, translation_ranges_);
+    LoadRanges(_archive, scale_ranges_);
+    _archive >> ozz::io::MakeArray(translation_values_);
+    _archive >> ozz::io::MakeArray(scale_values_);
+    _archive >> ozz::io::MakeArray(translation_value_offsets_);
+    _archive >> ozz::io::MakeArray(scale_value_offsets_);
+  } else {
+    ozz::Vector<uint16_t>::Std translation_values;
+    LoadLegacyKeys(_archive, _version, num_frames, translations_,
+                   translation_times_.begin, &translation_values);
+    LoadRotations(_archive, _version, num_frames, rotations_,
+                  rotation_times_.begin);
+    ozz::Vector<uint16_t>::Std scale_values;
+    LoadLegacyKeys(_archive, _version, num_frames, scales_,
+                   scale_times_.begin, &scale_values);
+    if (_version >= 8) {
+      LoadLegacyRanges(_archive, translation_ranges_);
+      LoadLegacyRanges(_archive, scale_ranges_);
+    } else {
+      HalfToRanged(translations_, array_begin(translation_values),
+                   translation_ranges_);
+      HalfToRanged(scales_, array_begin(scale_values), scale_ranges_);
+    }
+    PackLegacyValues(array_begin(translation_values), translation_count,
+                     translation_value_offsets_, translation_values_);
+    PackLegacyValues(array_begin(scale_values), scale_count,
+                     scale_value_offsets_, scale_values_);
+  }
+
+  _archive >> ozz::io::MakeArray(seek_ratios_);
+  _archive >> ozz::io::MakeArray(seek_keys_);
+  _archive >> ozz::io::MakeArray(sync_ratios_);
+  _archive >> ozz::io::MakeArray(bounds_);
+
+  // Tangents were always stored as contiguous half floats.
+  LoadWords(_archive, translation_tangents_);
+  LoadWords(_archive, rotation_tangents_);
+  LoadWords(_archive, scale_tangents_);
+
+  _archive >> ozz::io::MakeArray(steps_);
+  _archive >> ozz::io::MakeArray(soa_joints_);
+
+  _archive >> ozz::io::MakeArray(translation_key_lods_);
+  _archive >> ozz::io::MakeArray(rotation_key_lods_);
+  _archive >> ozz::io::MakeArray(scale_key_lods_);
+  _archive >> ozz::io::MakeArray(translation_lod_next_);
+  _archive >> ozz::io::MakeArray(rotation_lod_next_);
+  _archive >> ozz::io::MakeArray(scale_lod_next_);
+
+  if (_version >= 20) {
+    _archive >> ozz::io::MakeArray(translation_times_);
+    _archive >> ozz::io::MakeArray(rotation_times_);
+    _archive >> ozz::io::MakeArray(scale_times_);
   }
 }
 }  // namespace animation
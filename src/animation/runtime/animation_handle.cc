@@ -0,0 +1,193 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#include "ozz/animation/runtime/animation_handle.h"
+
+#if __cplusplus >= 201103L
+#include <atomic>
+#endif  // __cplusplus
+#include <cassert>
+#include <new>
+
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/memory/allocator.h"
+
+namespace ozz {
+namespace animation {
+
+namespace {
+#if __cplusplus >= 201103L
+typedef std::atomic<uint32_t> EpochCounter;
+typedef std::atomic<Animation*> AnimationPointer;
+#else   // __cplusplus
+// Mimics the subset of std::atomic interface used below, without any
+// synchronization.
+template <typename _Type>
+struct Unsynchronized {
+  _Type load() const { return value; }
+  void store(_Type _value) { value = _value; }
+  _Type exchange(_Type _value) {
+    const _Type previous = value;
+    value = _value;
+    return previous;
+  }
+  _Type value;
+};
+typedef Unsynchronized<uint32_t> EpochCounter;
+typedef Unsynchronized<Animation*> AnimationPointer;
+#endif  // __cplusplus
+
+// Epoch value of a reader that isn't using any animation.
+const uint32_t kIdleEpoch = 0;
+
+// Deletes _animation with the allocator it was allocated from.
+void DeleteAnimation(Animation* _animation) {
+  if (_animation) {
+    _animation->allocator()->Delete(_animation);
+  }
+}
+}  // namespace
+
+struct AnimationHandle::State {
+  // Currently published animation.
+  AnimationPointer current;
+
+  // Global epoch, incremented every time an animation is retired. It's never
+  // kIdleEpoch.
+  EpochCounter epoch;
+
+  // Number of published animations.
+  EpochCounter generation;
+
+  // Epoch of every reader when it acquired the animation, or kIdleEpoch.
+  EpochCounter* readers;
+
+  // Writer only data: retired animations, along with the epoch they were
+  // retired at. Readers that acquired an animation from this epoch can only
+  // see the animations published after it.
+  struct Retired {
+    Animation* animation;
+    uint32_t epoch;
+  };
+  ozz::Vector<Retired>::Std retired;
+};
+
+AnimationHandle::AnimationHandle(int _num_readers)
+    : state_(NULL), num_readers_(_num_readers > 0 ? _num_readers : 0) {
+  memory::Allocator* allocator = memory::default_allocator();
+  state_ = allocator->New<State>();
+  state_->current.store(NULL);
+  state_->epoch.store(kIdleEpoch + 1);
+  state_->generation.store(0);
+  state_->readers = reinterpret_cast<EpochCounter*>(allocator->Allocate(
+      sizeof(EpochCounter) * num_readers_, OZZ_ALIGN_OF(EpochCounter)));
+  for (int i = 0; i < num_readers_; ++i) {
+    new (&state_->readers[i]) EpochCounter();
+    state_->readers[i].store(kIdleEpoch);
+  }
+}
+
+AnimationHandle::~AnimationHandle() {
+  for (int i = 0; i < num_readers_; ++i) {
+    assert(state_->readers[i].load() == kIdleEpoch &&
+           "Animation handle is destroyed while being used by a reader.");
+    state_->readers[i].~EpochCounter();
+  }
+  for (size_t i = 0; i < state_->retired.size(); ++i) {
+    DeleteAnimation(state_->retired[i].animation);
+  }
+  DeleteAnimation(state_->current.load());
+  memory::Allocator* allocator = memory::default_allocator();
+  allocator->Deallocate(state_->readers);
+  allocator->Delete(state_);
+}
+
+const Animation* AnimationHandle::Acquire(int _reader) {
+  assert(_reader >= 0 && _reader < num_readers_ && "Invalid reader index.");
+  EpochCounter& reader = state_->readers[_reader];
+  assert(reader.load() == kIdleEpoch && "Reader has already acquired.");
+
+  // The epoch is published before the animation is loaded, so that the
+  // writer can't miss this reader when it decides to delete an animation
+  // retired from this epoch on.
+  reader.store(state_->epoch.load());
+  return state_->current.load();
+}
+
+void AnimationHandle::Release(int _reader) {
+  assert(_reader >= 0 && _reader < num_readers_ && "Invalid reader index.");
+  assert(state_->readers[_reader].load() != kIdleEpoch &&
+         "Reader hasn't acquired.");
+  state_->readers[_reader].store(kIdleEpoch);
+}
+
+void AnimationHandle::Publish(Animation* _animation) {
+  Animation* previous = state_->current.exchange(_animation);
+  state_->generation.store(state_->generation.load() + 1);
+  if (previous) {
+    // Readers that acquire from the new epoch on load the new animation, as
+    // it was stored before the epoch is incremented.
+    uint32_t epoch = state_->epoch.load() + 1;
+    if (epoch == kIdleEpoch) {
+      epoch = kIdleEpoch + 1;
+    }
+    state_->epoch.store(epoch);
+    const State::Retired retired = {previous, epoch};
+    state_->retired.push_back(retired);
+  }
+  Collect();
+}
+
+int AnimationHandle::Collect() {
+  ozz::Vector<State::Retired>::Std& retired = state_->retired;
+  size_t kept = 0;
+  for (size_t i = 0; i < retired.size(); ++i) {
+    // A retired animation can still be used by readers that acquired before
+    // it was retired. Epochs are compared with wrap around.
+    bool used = false;
+    for (int r = 0; r < num_readers_ && !used; ++r) {
+      const uint32_t reader = state_->readers[r].load();
+      used = reader != kIdleEpoch &&
+             static_cast<int32_t>(reader - retired[i].epoch) < 0;
+    }
+    if (used) {
+      retired[kept++] = retired[i];
+    } else {
+      DeleteAnimation(retired[i].animation);
+    }
+  }
+  retired.resize(kept);
+  return static_cast<int>(kept);
+}
+
+uint32_t AnimationHandle::generation() const {
+  return state_->generation.load();
+}
+}  // namespace animation
+}  // namespace ozz
@@ -0,0 +1,160 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+#include "ozz/animation/runtime/animation_instance.h"
+
+#include <cassert>
+
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/soa_transform.h"
+
+namespace ozz {
+namespace animation {
+
+namespace {
+// Alignment of the instance block, and of each buffer within it.
+const size_t kInstanceAlignment = 16;
+
+// Computes buffers offsets within the instance block.
+struct InstanceLayout {
+  InstanceLayout(int _num_joints, int _max_tracks, SamplingCache::Mode _mode) {
+    const size_t num_soa_joints = (_num_joints + 3) / 4;
+    locals = math::Align(sizeof(AnimationInstance), kInstanceAlignment);
+    models = locals + sizeof(math::SoaTransform) * num_soa_joints;
+    skinning_palette = models + sizeof(math::Float4x4) * _num_joints;
+    cache = skinning_palette + sizeof(math::Float4x4) * _num_joints;
+    size = cache + SamplingCache::AllocationSize(_max_tracks, _mode);
+  }
+  size_t locals;
+  size_t models;
+  size_t skinning_palette;
+  size_t cache;  // Cache is last, up to the end of the block.
+  size_t size;
+};
+}  // namespace
+
+AnimationInstance* AnimationInstance::New(
+    const Skeleton& _skeleton, const Range<const Animation* const>& _animations,
+    memory::Allocator* _allocator) {
+  int max_tracks = 0;
+  bool spline = false;
+  for (const Animation* const* it = _animations.begin; it < _animations.end;
+       ++it) {
+    max_tracks = math::Max(max_tracks, (*it)->num_tracks());
+    spline |= (*it)->spline();
+  }
+  return New(_skeleton.num_joints(), max_tracks,
+             spline ? SamplingCache::kSpline : SamplingCache::kFull,
+             _allocator);
+}
+
+AnimationInstance* AnimationInstance::New(int _num_joints, int _max_tracks,
+                                          SamplingCache::Mode _mode,
+                                          memory::Allocator* _allocator) {
+  assert(_allocator && "Invalid allocator");
+  OZZ_STATIC_ASSERT(OZZ_ALIGN_OF(math::SoaTransform) <= kInstanceAlignment &&
+                    OZZ_ALIGN_OF(math::Float4x4) <= kInstanceAlignment &&
+                    OZZ_ALIGN_OF(AnimationInstance) <= kInstanceAlignment &&
+                    SamplingCache::kAllocationAlignment <= kInstanceAlignment);
+  const InstanceLayout layout(_num_joints, _max_tracks, _mode);
+  char* block = reinterpret_cast<char*>(
+      _allocator->Allocate(layout.size, kInstanceAlignment));
+  if (!block) {
+    return NULL;
+  }
+
+  // Instance object is placed at the beginning of the block, followed by the
+  // buffers.
+  AnimationInstance* instance = new (block) AnimationInstance(
+      _num_joints, _max_tracks, _mode, _allocator, layout.size, layout.cache);
+  instance->locals_ =
+      reinterpret_cast<math::SoaTransform*>(block + layout.locals);
+  instance->models_ = reinterpret_cast<math::Float4x4*>(block + layout.models);
+  instance->skinning_palette_ =
+      reinterpret_cast<math::Float4x4*>(block + layout.skinning_palette);
+  return instance;
+}
+
+void AnimationInstance::Delete(AnimationInstance* _instance) {
+  if (!_instance) {
+    return;
+  }
+  memory::Allocator* allocator = _instance->allocator_;
+  _instance->~AnimationInstance();
+  allocator->Deallocate(_instance);
+}
+
+AnimationInstance::AnimationInstance(int _num_joints, int _max_tracks,
+                                     SamplingCache::Mode _mode,
+                                     memory::Allocator* _allocator,
+                                     size_t _size, size_t _cache_offset)
+    : allocator_(_allocator),
+      size_(_size),
+      num_joints_(_num_joints),
+      locals_(NULL),
+      models_(NULL),
+      skinning_palette_(NULL),
+      cache_allocator_(reinterpret_cast<char*>(this) + _cache_offset,
+                       _size - _cache_offset),
+      cache_(_max_tracks, _mode, &cache_allocator_) {}
+
+Range<math::SoaTransform> AnimationInstance::locals() const {
+  return Range<math::SoaTransform>(locals_, num_soa_joints());
+}
+
+Range<math::Float4x4> AnimationInstance::models() const {
+  return Range<math::Float4x4>(models_, num_joints_);
+}
+
+Range<math::Float4x4> AnimationInstance::skinning_palette() const {
+  return Range<math::Float4x4>(skinning_palette_, num_joints_);
+}
+
+void* AnimationInstance::CacheAllocator::Allocate(size_t _size,
+                                                  size_t _alignment) {
+  // The cache does a single allocation, served from the instance block.
+  (void)_alignment;
+  assert(math::IsAligned(buffer_, _alignment));
+  assert(_size <= size_ && "Instance cache can't grow beyond its initial size");
+  return _size <= size_ ? buffer_ : NULL;
+}
+
+void AnimationInstance::CacheAllocator::Deallocate(void* _block) {
+  // Memory belongs to the instance block.
+  (void)_block;
+  assert((!_block || _block == buffer_) && "Unknown block");
+}
+
+void* AnimationInstance::CacheAllocator::Reallocate(void* _block, size_t _size,
+                                                    size_t _alignment) {
+  Deallocate(_block);
+  return Allocate(_size, _alignment);
+}
+}  // namespace animation
+}  // namespace ozz
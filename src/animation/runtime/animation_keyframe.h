@@ -32,6 +32,9 @@
 #error "This header is private, it cannot be included from public headers."
 #endif  // OZZ_INCLUDE_PRIVATE_HEADER
 
+#include <cassert>
+#include <cmath>
+
 namespace ozz {
 namespace animation {
 
@@ -41,14 +44,41 @@ namespace animation {
 // cache coherency. Key frame values are compressed, according on their type.
 // Decompression is efficient because it's done on SoA data and cached during
 // sampling.
+// Key time is stored as a 16 bits frame index, in range [0, num_frames] of the
+// animation it belongs to (see Animation::num_frames()). Its time ratio in
+// unit interval is restored as "ratio / num_frames". Animations whose key times
+// don't fit 16 bits frame indices store them as floats instead, in a buffer
+// parallel to keys (see Animation::has_key_times()), and keys ratio is unused.
+
+// Maximum number of frames of an animation, which is also the number of frames
+// of animations whose key times don't match a coarser frame rate.
+const int kMaxFrames = 65535;
+
+// Converts a time ratio in unit interval [0,1] to the nearest frame index of an
+// animation made of _num_frames frames.
+inline uint16_t QuantizeRatio(float _ratio, int _num_frames) {
+  const float frames = static_cast<float>(_num_frames);
+  const float quantized = std::floor(_ratio * frames + .5f);
+  return static_cast<uint16_t>(
+      quantized < 0.f ? 0.f : (quantized > frames ? frames : quantized));
+}
+
+// Gets the time, in frames, of key _index of _keys. _times are the float key
+// times of _keys buffer, or NULL if they are stored as frame indices.
+template <typename _Key>
+inline float KeyFrame(const _Key* _keys, const float* _times, int _index) {
+  return _times ? _times[_index] : static_cast<float>(_keys[_index].ratio);
+}
 
 // Defines the translation key frame type.
-// Translation values are stored as half precision floats with 16 bits per
-// component.
+// Translation values are quantized to unsigned integers per component,
+// relatively to the range of values of the track they belong to, with a
+// number of bits chosen per track (see KeyRange). As this number varies, values
+// aren't stored in keys, but bit packed in a separate buffer (see
+// UnpackKeyValues()).
 struct TranslationKey {
-  float ratio;
+  uint16_t ratio;
   uint16_t track;
-  uint16_t value[3];
 };
 
 // Defines the rotation key frame type.
@@ -66,8 +96,12 @@ struct TranslationKey {
 // Quantization could be reduced to 11-11-10 bits as often used for animation
 // key frames, but in this case RotationKey structure would induce 16 bits of
 // padding.
+//
+// The 13 bits track index addresses up to 8192 tracks, which bounds
+// Skeleton::kMaxJoints. Widening it would grow every rotation key by 2 bytes,
+// or require a per block track base lookup while sampling.
 struct RotationKey {
-  float ratio;
+  uint16_t ratio;
   uint16_t track : 13;   // The track this key frame belongs to.
   uint16_t largest : 2;  // The largest component of the quaternion.
   uint16_t sign : 1;     // The sign of the largest component. 1 for negative.
@@ -75,13 +109,118 @@ struct RotationKey {
 };
 
 // Defines the scale key frame type.
-// Scale values are stored as half precision floats with 16 bits per
-// component.
+// Scale values are quantized and bit packed like translation values, see
+// TranslationKey.
 struct ScaleKey {
-  float ratio;
+  uint16_t ratio;
   uint16_t track;
+};
+
+// Defines spline animations key frame tangents (see Animation::spline()).
+// Tangent i of a tangent buffer belongs to key i of the matching key buffer.
+// It's the derivative of the key value relatively to the time ratio. Tangent
+// components are stored as half floats.
+struct Float3Tangent {
   uint16_t value[3];
 };
+
+struct QuaternionTangent {
+  uint16_t value[4];
+};
+
+// Defines the range of translation or scale values for 4 consecutive tracks
+// (aka a soa track). Quantized key values are restored as
+// "min + value * step". Ranges are stored as SoA, so they can be loaded
+// directly during SoA decompression.
+// Every component of every track is quantized with its own number of bits,
+// in range [0, kMaxValueBits], which the AnimationBuilder selects so that
+// quantization error stays below a tolerance (see
+// AnimationBuilder::quantization_translation_tolerance). Components that don't
+// vary use no bit at all. Using per-track ranges (range reduction) allows to
+// spend these bits on the subset of values a track actually uses, whatever the
+// magnitude of these values.
+struct KeyRange {
+  float min[3][4];     // Minimum value, per component and per track.
+  float step[3][4];    // Quantization step, aka (max - min) / (2^bits - 1).
+  uint8_t bits[3][4];  // Number of bits, per component and per track.
+};
+
+// Maximum number of bits of a quantized translation or scale component.
+const int kMaxValueBits = 16;
+
+// Translation and scale values of a key buffer are bit packed, key after key,
+// in a value buffer. The bit offset of the values of every kValueBlockSize-th
+// key is stored in a value offsets buffer, so that the values of any key can be
+// located by accumulating the bits of at most kValueBlockSize - 1 preceding
+// keys, which are 64 contiguous bytes of keys.
+const int kValueBlockSize = 16;
+
+// Gets the number of value offsets of a buffer of _num_keys keys.
+inline size_t ValueOffsetCount(size_t _num_keys) {
+  return (_num_keys + kValueBlockSize - 1) / kValueBlockSize;
+}
+
+// Gets the size, in bytes, of the value buffer of _num_keys keys whose values
+// take _num_bits bits. Buffer is padded so that values can be read as 3 bytes
+// from any bit offset.
+inline size_t ValueBufferSize(size_t _num_keys, size_t _num_bits) {
+  return _num_keys > 0 ? _num_bits / 8 + 3 : 0;
+}
+
+// Gets the number of bits of the values of a key of track _track.
+inline int KeyBits(const KeyRange* _ranges, int _track) {
+  const KeyRange& range = _ranges[_track / 4];
+  const int lane = _track & 3;
+  return range.bits[0][lane] + range.bits[1][lane] + range.bits[2][lane];
+}
+
+// Unpacks the 3 quantized component values of key _index of _keys, from _values
+// and _offsets buffers.
+template <typename _Key>
+inline void UnpackKeyValues(const _Key* _keys, const KeyRange* _ranges,
+                            const uint32_t* _offsets, const uint8_t* _values,
+                            int _index, int _unpacked[3]) {
+  const int block = _index / kValueBlockSize;
+  uint32_t offset = _offsets[block];
+  for (int i = block * kValueBlockSize; i < _index; ++i) {
+    offset += KeyBits(_ranges, _keys[i].track);
+  }
+  const int track = _keys[_index].track;
+  const KeyRange& range = _ranges[track / 4];
+  for (int c = 0; c < 3; ++c) {
+    const int bits = range.bits[c][track & 3];
+    const uint8_t* bytes = _values + (offset >> 3);
+    const uint32_t word = bytes[0] | bytes[1] << 8 | bytes[2] << 16;
+    _unpacked[c] =
+        static_cast<int>((word >> (offset & 7)) & ((1u << bits) - 1));
+    offset += bits;
+  }
+}
+
+// Packs the _bits bits _value at bit _offset of _values, which is expected to
+// be zeroed.
+inline void PackValue(int _value, int _bits, uint32_t _offset,
+                      uint8_t* _values) {
+  assert(_value >= 0 && _value < 1 << _bits);
+  (void)_bits;
+  uint8_t* bytes = _values + (_offset >> 3);
+  const uint32_t word = static_cast<uint32_t>(_value) << (_offset & 7);
+  bytes[0] |= word & 0xff;
+  bytes[1] |= (word >> 8) & 0xff;
+  bytes[2] |= (word >> 16) & 0xff;
+}
+
+// Quantizes _value to _bits bits, in range
+// [_min, _min + (2^_bits - 1) * _step].
+inline int QuantizeRanged(float _value, float _min, float _step, int _bits) {
+  if (!(_step > 0.f)) {
+    return 0;
+  }
+  const float max = static_cast<float>((1 << _bits) - 1);
+  const float quantized = std::floor((_value - _min) / _step + .5f);
+  return static_cast<int>(
+      quantized < 0.f ? 0.f : (quantized > max ? max : quantized));
+}
 }  // namespace animation
 }  // namespace ozz
 #endif  // OZZ_ANIMATION_RUNTIME_ANIMATION_KEYFRAME_H_
@@ -0,0 +1,226 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#include "ozz/animation/runtime/animation_library.h"
+
+#include <cassert>
+#include <cstring>
+
+#include "ozz/base/io/archive.h"
+#include "ozz/base/log.h"
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/memory/allocator.h"
+
+namespace ozz {
+namespace animation {
+
+AnimationLibrary::AnimationLibrary() {}
+
+AnimationLibrary::~AnimationLibrary() { Deallocate(); }
+
+namespace {
+// Fixes up _range to _count elements at *_buffer, and moves *_buffer after it.
+template <typename _Ty>
+void FixUpRange(char** _buffer, size_t _count, Range<_Ty>* _range) {
+  assert(math::IsAligned(*_buffer, OZZ_ALIGN_OF(_Ty)));
+  _range->begin = reinterpret_cast<_Ty*>(*_buffer);
+  *_buffer += _count * sizeof(_Ty);
+  _range->end = reinterpret_cast<_Ty*>(*_buffer);
+}
+}  // namespace
+
+void AnimationLibrary::Allocate(size_t _num_clips, size_t _num_clip_channels,
+                                size_t _num_translations,
+                                size_t _num_rotations, size_t _num_scales,
+                                size_t _num_translation_keys,
+                                size_t _num_rotation_keys,
+                                size_t _num_scale_keys, size_t _names_size) {
+  assert(clips_.begin == NULL);
+
+  // All buffers are 4 bytes aligned, but names that come last.
+  OZZ_STATIC_ASSERT(OZZ_ALIGN_OF(LibraryClip) == 4 &&
+                    OZZ_ALIGN_OF(LibraryChannel) == 4 &&
+                    OZZ_ALIGN_OF(LibraryFloat3Key) == 4 &&
+                    OZZ_ALIGN_OF(LibraryQuaternionKey) == 4);
+
+  // Compute overall size and allocate a single buffer for all the data.
+  const size_t buffer_size =
+      _num_clips * sizeof(LibraryClip) + _num_clip_channels * sizeof(uint32_t) +
+      (_num_translations + _num_rotations + _num_scales) *
+          sizeof(LibraryChannel) +
+      (_num_translation_keys + _num_scale_keys) * sizeof(LibraryFloat3Key) +
+      _num_rotation_keys * sizeof(LibraryQuaternionKey) + _names_size;
+  char* buffer = reinterpret_cast<char*>(
+      memory::default_allocator()->Allocate(buffer_size, 4));
+
+  // Fix up pointers.
+  FixUpRange(&buffer, _num_clips, &clips_);
+  FixUpRange(&buffer, _num_clip_channels, &channels_);
+  FixUpRange(&buffer, _num_translations, &translations_);
+  FixUpRange(&buffer, _num_rotations, &rotations_);
+  FixUpRange(&buffer, _num_scales, &scales_);
+  FixUpRange(&buffer, _num_translation_keys, &translation_keys_);
+  FixUpRange(&buffer, _num_rotation_keys, &rotation_keys_);
+  FixUpRange(&buffer, _num_scale_keys, &scale_keys_);
+  FixUpRange(&buffer, _names_size, &names_);
+}
+
+void AnimationLibrary::Deallocate() {
+  // Deallocate everything at once.
+  memory::default_allocator()->Deallocate(clips_.begin);
+
+  clips_.Clear();
+  channels_.Clear();
+  translations_.Clear();
+  rotations_.Clear();
+  scales_.Clear();
+  translation_keys_.Clear();
+  rotation_keys_.Clear();
+  scale_keys_.Clear();
+  names_.Clear();
+}
+
+const LibraryClip& AnimationLibrary::clip(int _clip) const {
+  assert(_clip >= 0 && _clip < num_clips() && "Clip index out of range.");
+  return clips_[_clip];
+}
+
+const char* AnimationLibrary::clip_name(int _clip) const {
+  return names_.begin + clip(_clip).name;
+}
+
+int AnimationLibrary::FindClip(const char* _name) const {
+  for (int i = 0; i < num_clips(); ++i) {
+    if (std::strcmp(clip_name(i), _name) == 0) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+Range<const uint32_t> AnimationLibrary::clip_channels(int _clip) const {
+  const LibraryClip& desc = clip(_clip);
+  const uint32_t* begin = channels_.begin + desc.first_track * 3;
+  return Range<const uint32_t>(begin, desc.num_tracks * 3);
+}
+
+size_t AnimationLibrary::size() const {
+  const size_t size = sizeof(*this) + clips_.size() + channels_.size() +
+                      translations_.size() + rotations_.size() +
+                      scales_.size() + translation_keys_.size() +
+                      rotation_keys_.size() + scale_keys_.size() +
+                      names_.size();
+  return size;
+}
+
+namespace {
+// Library structures are made of 4 bytes components only, which are
+// serialized as arrays of floats or uint32_t.
+OZZ_STATIC_ASSERT(sizeof(LibraryFloat3Key) == 4 * sizeof(float) &&
+                  sizeof(LibraryQuaternionKey) == 5 * sizeof(float) &&
+                  sizeof(LibraryChannel) == 2 * sizeof(uint32_t));
+
+template <typename _Ty>
+const io::internal::Array<float> MakeFloatArray(const Range<_Ty>& _range) {
+  return io::MakeArray(reinterpret_cast<float*>(_range.begin),
+                       _range.size() / sizeof(float));
+}
+
+const io::internal::Array<uint32_t> MakeChannelArray(
+    const Range<LibraryChannel>& _range) {
+  return io::MakeArray(reinterpret_cast<uint32_t*>(_range.begin),
+                       _range.size() / sizeof(uint32_t));
+}
+}  // namespace
+
+void AnimationLibrary::Save(ozz::io::OArchive& _archive) const {
+  _archive << static_cast<uint32_t>(clips_.count());
+  _archive << static_cast<uint32_t>(channels_.count());
+  _archive << static_cast<uint32_t>(translations_.count());
+  _archive << static_cast<uint32_t>(rotations_.count());
+  _archive << static_cast<uint32_t>(scales_.count());
+  _archive << static_cast<uint32_t>(translation_keys_.count());
+  _archive << static_cast<uint32_t>(rotation_keys_.count());
+  _archive << static_cast<uint32_t>(scale_keys_.count());
+  _archive << static_cast<uint32_t>(names_.count());
+
+  for (const LibraryClip* clip = clips_.begin; clip < clips_.end; ++clip) {
+    _archive << clip->duration;
+    _archive << static_cast<int32_t>(clip->num_tracks);
+    _archive << clip->first_track;
+    _archive << clip->name;
+  }
+  _archive << ozz::io::MakeArray(channels_);
+  _archive << MakeChannelArray(translations_);
+  _archive << MakeChannelArray(rotations_);
+  _archive << MakeChannelArray(scales_);
+  _archive << MakeFloatArray(translation_keys_);
+  _archive << MakeFloatArray(rotation_keys_);
+  _archive << MakeFloatArray(scale_keys_);
+  _archive << ozz::io::MakeArray(names_);
+}
+
+void AnimationLibrary::Load(ozz::io::IArchive& _archive, uint32_t _version) {
+  // Destroy library in case it was already used before.
+  Deallocate();
+
+  if (_version != 1) {
+    log::Err() << "Unsupported AnimationLibrary version " << _version << "."
+               << std::endl;
+    return;
+  }
+
+  uint32_t counts[9];
+  for (int i = 0; i < 9; ++i) {
+    _archive >> counts[i];
+  }
+  if (counts[0] == 0) {  // Leaves the library empty.
+    return;
+  }
+  Allocate(counts[0], counts[1], counts[2], counts[3], counts[4], counts[5],
+           counts[6], counts[7], counts[8]);
+
+  for (LibraryClip* clip = clips_.begin; clip < clips_.end; ++clip) {
+    _archive >> clip->duration;
+    int32_t num_tracks;
+    _archive >> num_tracks;
+    clip->num_tracks = num_tracks;
+    _archive >> clip->first_track;
+    _archive >> clip->name;
+  }
+  _archive >> ozz::io::MakeArray(channels_);
+  _archive >> MakeChannelArray(translations_);
+  _archive >> MakeChannelArray(rotations_);
+  _archive >> MakeChannelArray(scales_);
+  _archive >> MakeFloatArray(translation_keys_);
+  _archive >> MakeFloatArray(rotation_keys_);
+  _archive >> MakeFloatArray(scale_keys_);
+  _archive >> ozz::io::MakeArray(names_);
+}
+}  // namespace animation
+}  // namespace ozz
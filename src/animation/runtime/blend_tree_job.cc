@@ -0,0 +1,285 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#include "ozz/animation/runtime/blend_tree_job.h"
+
+#include <cassert>
+#include <new>
+
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/sampling_job.h"
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/allocator.h"
+
+namespace ozz {
+namespace animation {
+
+BlendTreeCache::BlendTreeCache()
+    : num_buffers_(0), num_soa_joints_(0), buffers_(NULL), layers_(NULL) {}
+
+BlendTreeCache::BlendTreeCache(int _num_joints, int _num_buffers)
+    : num_buffers_(0), num_soa_joints_(0), buffers_(NULL), layers_(NULL) {
+  Resize(_num_joints, _num_buffers);
+}
+
+BlendTreeCache::~BlendTreeCache() { Deallocate(); }
+
+void BlendTreeCache::Deallocate() {
+  memory::Allocator* allocator = memory::default_allocator();
+  allocator->Deallocate(buffers_);
+  buffers_ = NULL;
+  allocator->Deallocate(layers_);
+  layers_ = NULL;
+  num_buffers_ = 0;
+  num_soa_joints_ = 0;
+}
+
+void BlendTreeCache::Resize(int _num_joints, int _num_buffers) {
+  Deallocate();
+
+  num_soa_joints_ = _num_joints > 0 ? (_num_joints + 3) / 4 : 0;
+  num_buffers_ = _num_buffers > 0 ? _num_buffers : 0;
+
+  memory::Allocator* allocator = memory::default_allocator();
+  buffers_ = reinterpret_cast<math::SoaTransform*>(
+      allocator->Allocate(sizeof(math::SoaTransform) * num_soa_joints_ *
+                              num_buffers_,
+                          OZZ_ALIGN_OF(math::SoaTransform)));
+  layers_ = reinterpret_cast<BlendingJob::Layer*>(
+      allocator->Allocate(sizeof(BlendingJob::Layer) * num_buffers_,
+                          OZZ_ALIGN_OF(BlendingJob::Layer)));
+  for (int i = 0; i < num_buffers_; ++i) {
+    new (layers_ + i) BlendingJob::Layer;
+  }
+}
+
+BlendTreeJob::Node::Node()
+    : type(kSample),
+      weight(0.f),
+      animation(NULL),
+      sampling_cache(NULL),
+      ratio(0.f) {}
+
+BlendTreeJob::BlendTreeJob()
+    : skeleton(NULL), cache(NULL), threshold(.1f), weight_epsilon(0.f) {}
+
+namespace {
+bool ValidateChildren(const Range<const int>& _children, int _parent,
+                      int _num_nodes) {
+  bool valid = true;
+  valid &= _children.end >= _children.begin;
+  valid &= _children.begin != NULL || _children.end == NULL;
+  for (const int* child = _children.begin; child < _children.end; ++child) {
+    valid &= *child > _parent && *child < _num_nodes;
+  }
+  return valid;
+}
+
+// Counts the number of buffers required to evaluate node _index and its
+// children.
+int CountBuffers(const BlendTreeJob& _job, int _index) {
+  const BlendTreeJob::Node& node = _job.nodes.begin[_index];
+  if (node.type != BlendTreeJob::Node::kBlend) {
+    return 0;
+  }
+  int children_buffers = 0;
+  for (const int* child = node.children.begin; child < node.children.end;
+       ++child) {
+    const int count = CountBuffers(_job, *child);
+    children_buffers = count > children_buffers ? count : children_buffers;
+  }
+  for (const int* child = node.additive_children.begin;
+       child < node.additive_children.end; ++child) {
+    const int count = CountBuffers(_job, *child);
+    children_buffers = count > children_buffers ? count : children_buffers;
+  }
+  return static_cast<int>(node.children.count() +
+                          node.additive_children.count()) +
+         children_buffers;
+}
+
+// Cache buffers and layers shared by the whole tree evaluation.
+struct EvaluationContext {
+  const BlendTreeJob* job;
+  math::SoaTransform* buffers;
+  BlendingJob::Layer* layers;
+  int num_buffers;
+  int buffer_stride;
+};
+
+// Evaluates node _index to _output, using cache buffers from _stack.
+bool EvaluateNode(const EvaluationContext& _context, int _index, int _stack,
+                  const Range<math::SoaTransform>& _output) {
+  const BlendTreeJob& job = *_context.job;
+  const BlendTreeJob::Node& node = job.nodes.begin[_index];
+
+  if (node.type == BlendTreeJob::Node::kSample) {
+    SamplingJob sampling_job;
+    sampling_job.animation = node.animation;
+    sampling_job.cache = node.sampling_cache;
+    sampling_job.ratio = node.ratio;
+    sampling_job.output = _output;
+    return sampling_job.Run();
+  }
+
+  BlendingJob blending_job;
+  blending_job.threshold = job.threshold;
+  blending_job.weight_epsilon = job.weight_epsilon;
+
+  // Reserves a buffer and a layer for every contributing children, pruning
+  // the others.
+  int num_layers = 0;
+  for (const int* child = node.children.begin; child < node.children.end;
+       ++child) {
+    num_layers +=
+        blending_job.IsLayerContributing(job.nodes.begin[*child].weight);
+  }
+  int num_additive_layers = 0;
+  for (const int* child = node.additive_children.begin;
+       child < node.additive_children.end; ++child) {
+    num_additive_layers += blending_job.IsAdditiveLayerContributing(
+        job.nodes.begin[*child].weight);
+  }
+  const int num_buffers = num_layers + num_additive_layers;
+  const int children_stack = _stack + num_buffers;
+  assert(children_stack <= _context.num_buffers);
+
+  // Evaluates children to their buffer.
+  bool success = true;
+  const int num_soa_joints = job.skeleton->num_soa_joints();
+  BlendingJob::Layer* layers = _context.layers + _stack;
+  BlendingJob::Layer* layer = layers;
+  for (int additive = 0; additive < 2; ++additive) {
+    const Range<const int>& children =
+        additive ? node.additive_children : node.children;
+    for (const int* child = children.begin; child < children.end; ++child) {
+      const BlendTreeJob::Node& child_node = job.nodes.begin[*child];
+      if (additive
+              ? !blending_job.IsAdditiveLayerContributing(child_node.weight)
+              : !blending_job.IsLayerContributing(child_node.weight)) {
+        continue;
+      }
+      const ptrdiff_t buffer = layer - _context.layers;
+      math::SoaTransform* transforms =
+          _context.buffers + buffer * _context.buffer_stride;
+      const Range<math::SoaTransform> child_output(transforms, num_soa_joints);
+      success &= EvaluateNode(_context, *child, children_stack, child_output);
+
+      layer->weight = child_node.weight;
+      layer->transform = child_output;
+      layer->joint_weights = child_node.joint_weights;
+      layer->joint_indices = child_node.joint_indices;
+      ++layer;
+    }
+  }
+
+  blending_job.layers = Range<const BlendingJob::Layer>(layers, num_layers);
+  blending_job.additive_layers = Range<const BlendingJob::Layer>(
+      layers + num_layers, num_additive_layers);
+  blending_job.bind_pose = job.skeleton->joint_bind_poses();
+  blending_job.output = _output;
+  success &= blending_job.Run();
+
+  return success;
+}
+}  // namespace
+
+bool BlendTreeJob::Validate() const {
+  // Don't need any early out, as jobs are valid in most of the performance
+  // critical cases.
+  // Tests are written in multiple lines in order to avoid branches.
+  if (!skeleton || !cache || nodes.begin == NULL) {
+    return false;
+  }
+
+  bool valid = true;
+
+  // Test for valid threshold and epsilon.
+  valid &= threshold > 0.f;
+  valid &= weight_epsilon >= 0.f;
+
+  // Tests output range, implicitly tests output.end != NULL.
+  const int num_soa_joints = skeleton->num_soa_joints();
+  valid &= output.begin != NULL;
+  valid &= output.end - output.begin >= num_soa_joints;
+
+  // Tests nodes.
+  valid &= nodes.end > nodes.begin;
+  if (!valid) {
+    return false;
+  }
+  const int num_nodes = static_cast<int>(nodes.count());
+  for (int i = 0; i < num_nodes; ++i) {
+    const Node& node = nodes.begin[i];
+    switch (node.type) {
+      case Node::kSample: {
+        valid &= node.animation != NULL && node.sampling_cache != NULL;
+        valid &= node.animation == NULL ||
+                 node.animation->num_tracks() == skeleton->num_joints();
+        break;
+      }
+      case Node::kBlend: {
+        valid &= ValidateChildren(node.children, i, num_nodes);
+        valid &= ValidateChildren(node.additive_children, i, num_nodes);
+        break;
+      }
+      default: { valid = false; }
+    }
+  }
+  if (!valid) {
+    return false;
+  }
+
+  // Tests cache size, which requires a valid topology.
+  valid &= cache->num_soa_joints() >= num_soa_joints;
+  valid &= cache->num_buffers() >= RequiredBuffers();
+
+  return valid;
+}
+
+int BlendTreeJob::RequiredBuffers() const {
+  if (nodes.end <= nodes.begin) {
+    return 0;
+  }
+  return CountBuffers(*this, 0);
+}
+
+bool BlendTreeJob::Run() const {
+  if (!Validate()) {
+    return false;
+  }
+
+  // Evaluates the tree from its root, using the whole stack of buffers.
+  const EvaluationContext context = {this, cache->buffers_, cache->layers_,
+                                     cache->num_buffers_,
+                                     cache->num_soa_joints_};
+  return EvaluateNode(context, 0, 0, output);
+}
+}  // namespace animation
+}  // namespace ozz
@@ -27,38 +27,97 @@
 
 #include "ozz/animation/runtime/blending_job.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cstddef>
 
-#include "ozz/animation/runtime/skeleton.h"
-
 #include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/soa_half_transform.h"
 #include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/profile.h"
 
 namespace ozz {
 namespace animation {
 
 BlendingJob::Layer::Layer() : weight(0.f) {}
 
-BlendingJob::BlendingJob() : threshold(.1f) {}
+BlendingJob::BlendingJob()
+    : threshold(.1f), weight_epsilon(0.f), quality(kStandard) {}
 
 namespace {
-bool ValidateLayer(const BlendingJob::Layer& _layer, ptrdiff_t _min_range) {
+bool ValidateIndices(const Range<const int>& _indices) {
+  int previous = -1;
   bool valid = true;
+  for (const int* index = _indices.begin; index < _indices.end; ++index) {
+    valid &= *index > previous;
+    previous = *index;
+  }
+  return valid;
+}
 
-  // Tests transforms validity.
-  valid &= _layer.transform.begin != NULL;
-  valid &= _layer.transform.end >= _layer.transform.begin;
-  valid &= _layer.transform.end - _layer.transform.begin >= _min_range;
+// Returns the number of soa transforms of _layer, whether they're half
+// precision or not.
+ptrdiff_t LayerSize(const BlendingJob::Layer& _layer) {
+  return _layer.half_transform.begin
+             ? _layer.half_transform.end - _layer.half_transform.begin
+             : _layer.transform.end - _layer.transform.begin;
+}
+
+// Tells if _layer is sparse, aka specifies joint or transform indices.
+bool IsSparseLayer(const BlendingJob::Layer& _layer) {
+  return _layer.joint_indices.begin || _layer.transform_indices.begin;
+}
+
+bool ValidateLayer(const BlendingJob::Layer& _layer, ptrdiff_t _min_range,
+                   bool _additive) {
+  bool valid = true;
+
+  // Tests transforms validity. Exactly one of transform and half_transform is
+  // specified.
+  const bool half = _layer.half_transform.begin != NULL;
+  valid &= (_layer.transform.begin != NULL) != half;
+  valid &= half ? _layer.half_transform.end >= _layer.half_transform.begin
+               : _layer.transform.end >= _layer.transform.begin;
+  const ptrdiff_t num_transforms = LayerSize(_layer);
+
+  // Transform indices are optional, and only supported by additive layers.
+  if (_layer.transform_indices.begin != NULL) {
+    const ptrdiff_t count =
+        _layer.transform_indices.end - _layer.transform_indices.begin;
+    valid &= _additive;
+    valid &= count >= 0;
+    valid &= num_transforms >= count;
+    valid &= _layer.joint_indices.begin == NULL;
+    if (_layer.joint_weights.begin != NULL) {
+      valid &= _layer.joint_weights.end - _layer.joint_weights.begin >= count;
+    }
+    valid &= ValidateIndices(_layer.transform_indices);
+  } else {
+    valid &= _layer.transform_indices.end == NULL;
+    valid &= num_transforms >= _min_range;
+  }
 
   // Joint weights are optional.
   if (_layer.joint_weights.begin != NULL) {
     valid &= _layer.joint_weights.end >= _layer.joint_weights.begin;
-    valid &=
-        _layer.joint_weights.end - _layer.joint_weights.begin >= _min_range;
+    if (_layer.joint_indices.begin == NULL &&
+        _layer.transform_indices.begin == NULL) {
+      valid &=
+          _layer.joint_weights.end - _layer.joint_weights.begin >= _min_range;
+    }
   } else {
     valid &= _layer.joint_weights.end == NULL;
   }
+
+  // Joint indices are optional, but require joint weights.
+  if (_layer.joint_indices.begin != NULL) {
+    valid &= _layer.joint_weights.begin != NULL;
+    valid &= _layer.joint_indices.end - _layer.joint_indices.begin ==
+             _layer.joint_weights.end - _layer.joint_weights.begin;
+    valid &= ValidateIndices(_layer.joint_indices);
+  } else {
+    valid &= _layer.joint_indices.end == NULL;
+  }
   return valid;
 }
 }  // namespace
@@ -69,8 +128,9 @@ bool BlendingJob::Validate() const {
   // Tests are written in multiple lines in order to avoid branches.
   bool valid = true;
 
-  // Test for valid threshold).
+  // Test for valid threshold and epsilon.
   valid &= threshold > 0.f;
+  valid &= weight_epsilon >= 0.f;
 
   // Test for NULL begin pointers.
   // Blending layers are mandatory, additive aren't.
@@ -94,9 +154,13 @@ bool BlendingJob::Validate() const {
   }
 
   // Validates layers.
+  int num_sparse_layers = 0;
   for (const Layer* layer = layers.begin; layers.begin && layer < layers.end;
        ++layer) {
-    valid &= ValidateLayer(*layer, min_range);
+    if (IsLayerContributing(layer->weight)) {
+      valid &= ValidateLayer(*layer, min_range, false);
+      num_sparse_layers += IsSparseLayer(*layer);
+    }
   }
 
   // Additive layers are optional.
@@ -111,9 +175,15 @@ bool BlendingJob::Validate() const {
        additive_layers.begin &&
        layer < additive_layers.end;  // Handles NULL pointers.
        ++layer) {
-    valid &= ValidateLayer(*layer, min_range);
+    if (IsAdditiveLayerContributing(layer->weight)) {
+      valid &= ValidateLayer(*layer, min_range, true);
+      num_sparse_layers += IsSparseLayer(*layer);
+    }
   }
 
+  // Sparse layers cursors are stored on the stack.
+  valid &= num_sparse_layers <= kMaxSparseLayers;
+
   return valid;
 }
 
@@ -160,7 +230,7 @@ namespace {
     const math::SoaQuaternion interp_quat = {                                \
         rotation.x * _simd_weight, rotation.y * _simd_weight,                \
         rotation.z * _simd_weight, (rotation.w - one) * _simd_weight + one}; \
-    _out.rotation = NormalizeEst(interp_quat) * _out.rotation;               \
+    _out.rotation = _Policy::Normalize(interp_quat) * _out.rotation;         \
     _out.scale =                                                             \
         _out.scale * (one_minus_weight_f3 + (_in.scale * _simd_weight));     \
   }
@@ -178,7 +248,8 @@ namespace {
     const math::SoaQuaternion interp_quat = {                                  \
         rotation.x * _simd_weight, rotation.y * _simd_weight,                  \
         rotation.z * _simd_weight, (rotation.w - one) * _simd_weight + one};   \
-    _out.rotation = Conjugate(NormalizeEst(interp_quat)) * _out.rotation;      \
+    _out.rotation =                                                            \
+        Conjugate(_Policy::Normalize(interp_quat)) * _out.rotation;            \
     const math::SoaFloat3 rcp_scale = {                                        \
         math::RcpEst(math::MAdd(_in.scale.x, _simd_weight, one_minus_weight)), \
         math::RcpEst(math::MAdd(_in.scale.y, _simd_weight, one_minus_weight)), \
@@ -187,283 +258,435 @@ namespace {
     _out.scale = _out.scale * rcp_scale;                                       \
   }
 
-// Defines parameters that are passed through blending stages.
+// Returns _layer transform at _index. Half precision transforms are converted
+// to _scratch, whose reference is returned.
+inline const math::SoaTransform& GetLayerTransform(
+    const BlendingJob::Layer& _layer, size_t _index,
+    math::SoaTransform* _scratch) {
+  if (_layer.half_transform.begin) {
+    *_scratch = math::UnpackHalf(_layer.half_transform.begin[_index]);
+    return *_scratch;
+  }
+  return _layer.transform.begin[_index];
+}
+
+// Gets the sparse indices of _layer, or an empty range if it's dense.
+inline const Range<const int>& GetSparseIndices(
+    const BlendingJob::Layer& _layer) {
+  return _layer.transform_indices.begin ? _layer.transform_indices
+                                        : _layer.joint_indices;
+}
+
+// Advances _cursor over sorted _indices up to SoA joint _joint. As joints are
+// processed in increasing order, cursors only move forward, so a sparse layer
+// costs the number of its indices, and joints it doesn't list cost nothing.
+// Returns false if _joint isn't listed in _indices.
+inline bool AdvanceCursor(const Range<const int>& _indices, size_t _joint,
+                          const int** _cursor) {
+  const int joint = static_cast<int>(_joint);
+  const int* cursor = *_cursor;
+  while (cursor < _indices.end && *cursor < joint) {
+    ++cursor;
+  }
+  *_cursor = cursor;
+  return cursor < _indices.end && *cursor == joint;
+}
+
+// Computes the weight of _layer for SoA joint _joint, including per-joint
+// weights. _cursor is the layer sparse indices cursor, see AdvanceCursor.
+// Returns false if the layer doesn't affect this joint, which can only happen
+// for sparse joint weights.
+inline bool GetJointWeight(const BlendingJob::Layer& _layer, size_t _joint,
+                           math::SimdFloat4 _layer_weight,
+                           const int** _cursor, math::SimdFloat4* _weight) {
+  if (!_layer.joint_weights.begin) {
+    *_weight = _layer_weight;
+    return true;
+  }
+  size_t index = _joint;
+  if (_layer.joint_indices.begin) {
+    if (!AdvanceCursor(_layer.joint_indices, _joint, _cursor)) {
+      return false;
+    }
+    index = *_cursor - _layer.joint_indices.begin;
+  }
+  *_weight = _layer_weight * math::Max0(_layer.joint_weights.begin[index]);
+  return true;
+}
+
+// Finds the transform of additive _layer for SoA joint _joint, and computes its
+// weight, including per-joint weights. _cursor is the layer sparse indices
+// cursor, see AdvanceCursor. Half precision transforms are converted to
+// _scratch.
+// Returns NULL if the layer doesn't affect this joint, which can only happen
+// for sparse layers.
+inline const math::SoaTransform* GetAdditiveTransform(
+    const BlendingJob::Layer& _layer, size_t _joint,
+    math::SimdFloat4 _layer_weight, const int** _cursor,
+    math::SimdFloat4* _weight, math::SoaTransform* _scratch) {
+  if (!_layer.transform_indices.begin) {
+    if (!GetJointWeight(_layer, _joint, _layer_weight, _cursor, _weight)) {
+      return NULL;
+    }
+    return &GetLayerTransform(_layer, _joint, _scratch);
+  }
+  if (!AdvanceCursor(_layer.transform_indices, _joint, _cursor)) {
+    return NULL;
+  }
+  const ptrdiff_t index = *_cursor - _layer.transform_indices.begin;
+  *_weight = _layer.joint_weights.begin
+                 ? _layer_weight * math::Max0(_layer.joint_weights.begin[index])
+                 : _layer_weight;
+  return &GetLayerTransform(_layer, index, _scratch);
+}
+
+// Stores sparse indices cursors of contributing sparse layers, followed by
+// contributing sparse additive layers ones, initialized to the first index not
+// lower than SoA joint _begin. Their number is limited by
+// BlendingJob::kMaxSparseLayers, so they are stored on the stack.
+class LayerCursors {
+ public:
+  LayerCursors(const BlendingJob& _job, size_t _begin) {
+    const int** cursor = cursors_;
+    for (const BlendingJob::Layer* layer = _job.layers.begin;
+         layer < _job.layers.end; ++layer) {
+      if (_job.IsLayerContributing(layer->weight)) {
+        cursor = Init(*layer, _begin, cursor);
+      }
+    }
+    additive_cursors_ = cursor;
+    for (const BlendingJob::Layer* layer = _job.additive_layers.begin;
+         layer < _job.additive_layers.end; ++layer) {
+      if (_job.IsAdditiveLayerContributing(layer->weight)) {
+        cursor = Init(*layer, _begin, cursor);
+      }
+    }
+  }
+
+  // Gets the cursors of sparse layers, in layers order.
+  const int** cursors() { return cursors_; }
+
+  // Gets the cursors of sparse additive layers, in additive layers order.
+  const int** additive_cursors() { return additive_cursors_; }
+
+ private:
+  // Disables copy and assignment.
+  LayerCursors(const LayerCursors&);
+  void operator=(const LayerCursors&);
+
+  // Initializes _cursor if _layer is sparse, and returns the next cursor.
+  const int** Init(const BlendingJob::Layer& _layer, size_t _begin,
+                   const int** _cursor) {
+    if (!IsSparseLayer(_layer)) {
+      return _cursor;
+    }
+    assert(_cursor < cursors_ + BlendingJob::kMaxSparseLayers);
+    const Range<const int>& indices = GetSparseIndices(_layer);
+    *_cursor =
+        std::lower_bound(indices.begin, indices.end, static_cast<int>(_begin));
+    return _cursor + 1;
+  }
+
+  const int* cursors_[BlendingJob::kMaxSparseLayers];
+  const int** additive_cursors_;
+};
+
+// Defines blending parameters that are shared by all joints. They only depend
+// on layers weights, so they are computed once before processing joints.
 struct ProcessArgs {
-  ProcessArgs(const BlendingJob& _job)
-      : job(_job),
-        num_soa_joints(_job.bind_pose.end - _job.bind_pose.begin),
+  explicit ProcessArgs(const BlendingJob& _job)
+      : num_soa_joints(_job.bind_pose.end - _job.bind_pose.begin),
         num_passes(0),
         num_partial_passes(0),
-        accumulated_weight(0.f) {
+        accumulated_weight(0.f),
+        bind_pose_weight(0.f),
+        copy_bind_pose(false),
+        unit_additive_passes(false) {
     // The range of all buffers has already been validated.
-    assert(job.output.end >= job.output.begin + num_soa_joints);
-    assert(OZZ_ARRAY_SIZE(accumulated_weights) >= num_soa_joints);
-  }
+    assert(_job.output.end >= _job.output.begin + num_soa_joints);
+
+    // Accumulates global weights of all relevant layers.
+    for (const BlendingJob::Layer* layer = _job.layers.begin;
+         layer < _job.layers.end; ++layer) {
+      // Skip irrelevant layers.
+      if (!_job.IsLayerContributing(layer->weight)) {
+        continue;
+      }
 
-  // Allocates enough space to store a accumulated weights per-joint.
-  // It will be initialized by the first pass processed, if any.
-  // This is quite big for a stack allocation (4 byte * maximum number of
-  // joints). This is one of the reasons why the number of joints is limited
-  // by the API.
-  // Note that this array is used with SoA data.
-  // This is the first argument in order to avoid wasting too much space with
-  // alignment padding.
-  math::SimdFloat4 accumulated_weights[Skeleton::kMaxSoAJoints];
+      // Asserts buffer sizes, which must never fail as it has been validated.
+      assert(LayerSize(*layer) >= static_cast<ptrdiff_t>(num_soa_joints));
+      assert(!layer->joint_weights.begin || layer->joint_indices.begin ||
+             (layer->joint_weights.end >=
+              layer->joint_weights.begin + num_soa_joints));
+      accumulated_weight += layer->weight;
+      num_partial_passes += layer->joint_weights.begin != NULL;
+      ++num_passes;
+    }
+
+    // Without partial blending pass, bind pose threshold can be tested
+    // globally.
+    if (num_partial_passes == 0) {
+      const float bp_weight = _job.threshold - accumulated_weight;
+      if (bp_weight > 0.f) {  // The bind-pose is needed if it has a weight.
+        if (num_passes == 0) {
+          // Strictly copying bind-pose.
+          copy_bind_pose = true;
+          accumulated_weight = 1.f;
+        } else {
+          // Updates global accumulated weight, as normalization stage will be
+          // global also.
+          bind_pose_weight = bp_weight;
+          accumulated_weight = _job.threshold;
+        }
+      }
+    }
 
-  // The job to process.
-  const BlendingJob& job;
+    // Detects whether all contributing additive layers are unit weighted and
+    // full body, which allows to use the additive fast path.
+    int num_unit_additive_passes = 0;
+    for (const BlendingJob::Layer* layer = _job.additive_layers.begin;
+         layer < _job.additive_layers.end; ++layer) {
+      if (!_job.IsAdditiveLayerContributing(layer->weight)) {
+        continue;
+      }
+      if (layer->weight != 1.f || layer->joint_weights.begin ||
+          layer->transform_indices.begin) {
+        num_unit_additive_passes = 0;
+        break;
+      }
+      assert(LayerSize(*layer) >= static_cast<ptrdiff_t>(num_soa_joints));
+      ++num_unit_additive_passes;
+    }
+    unit_additive_passes = num_unit_additive_passes != 0;
+  }
 
   // The number of transforms to process as defined by the size of the bind
   // pose.
   size_t num_soa_joints;
 
-  // Number of processed blended passes (excluding passes with a weight <= 0.f),
+  // Number of processed blended passes (excluding non contributing passes),
   // including partial passes.
   int num_passes;
 
   // Number of processed partial blending passes (aka with a weight per-joint).
   int num_partial_passes;
 
-  // The accumulated weight of all layers.
+  // The accumulated weight of all layers, including bind pose contribution.
+  // Only used when there's no partial blending pass.
   float accumulated_weight;
 
- private:
-  // Disables assignment operators.
-  ProcessArgs(const ProcessArgs&);
-  void operator=(const ProcessArgs&);
-};
+  // Weight of the bind pose when it's blended globally, 0.f otherwise.
+  float bind_pose_weight;
 
-// Blends all layers of the job to its output.
-void BlendLayers(ProcessArgs* _args) {
-  assert(_args);
+  // The bind-pose is copied to the output instead of being blended, as no
+  // layer is contributing.
+  bool copy_bind_pose;
 
-  // Iterates through all layers and blend them to the output.
-  for (const BlendingJob::Layer* layer = _args->job.layers.begin;
-       layer < _args->job.layers.end; ++layer) {
-    // Asserts buffer sizes, which must never fail as it has been validated.
-    assert(layer->transform.end >=
-           layer->transform.begin + _args->num_soa_joints);
-    assert(!layer->joint_weights.begin ||
-           (layer->joint_weights.end >=
-            layer->joint_weights.begin + _args->num_soa_joints));
+  // All contributing additive layers have a weight of exactly 1.f, and neither
+  // joint weights nor transform indices, see AddUnitLayers().
+  bool unit_additive_passes;
+};
 
+// Additive fast path, adds all additive layers to SoA joint _joint of
+// _blended when they are unit weighted and full body. No weighting nor
+// normalization is needed, as additive rotations are expected to be normalized
+// (as output by the SamplingJob). Layers are concatenated first, so _blended is
+// updated only once whatever the number of layers.
+inline void AddUnitLayers(const BlendingJob& _job, size_t _joint,
+                          math::SoaTransform* _blended) {
+  math::SoaFloat3 translation = math::SoaFloat3::zero();
+  math::SoaQuaternion rotation = math::SoaQuaternion::identity();
+  math::SoaFloat3 scale = math::SoaFloat3::one();
+  for (const BlendingJob::Layer* layer = _job.additive_layers.begin;
+       layer < _job.additive_layers.end; ++layer) {
     // Skip irrelevant layers.
-    if (layer->weight <= 0.f) {
+    if (!_job.IsAdditiveLayerContributing(layer->weight)) {
       continue;
     }
+    math::SoaTransform scratch;
+    const math::SoaTransform& src = GetLayerTransform(*layer, _joint, &scratch);
+    translation = translation + src.translation;
+    // Quaternion sign is fixed up, the same way as the generic additive pass.
+    const math::SimdInt4 sign = math::Sign(src.rotation.w);
+    const math::SoaQuaternion src_rotation = {
+        math::Xor(src.rotation.x, sign), math::Xor(src.rotation.y, sign),
+        math::Xor(src.rotation.z, sign), math::Xor(src.rotation.w, sign)};
+    rotation = src_rotation * rotation;
+    scale = scale * src.scale;
+  }
+  _blended->translation = _blended->translation + translation;
+  _blended->rotation = rotation * _blended->rotation;
+  _blended->scale = _blended->scale * scale;
+}
 
-    // Accumulates global weights.
-    _args->accumulated_weight += layer->weight;
-    const math::SimdFloat4 layer_weight =
-        math::simd_float4::Load1(layer->weight);
-
-    if (layer->joint_weights.begin) {
-      // This layer has per-joint weights.
-      ++_args->num_partial_passes;
-
-      if (_args->num_passes == 0) {
-        for (size_t i = 0; i < _args->num_soa_joints; ++i) {
-          const math::SoaTransform& src = layer->transform.begin[i];
-          math::SoaTransform* dest = _args->job.output.begin + i;
-          const math::SimdFloat4 weight =
-              layer_weight * math::Max0(layer->joint_weights.begin[i]);
-          _args->accumulated_weights[i] = weight;
-          OZZ_BLEND_1ST_PASS(src, weight, dest);
+// Blending is processed in a single pass over joints: each SoA joint is read
+// once from every layer, blended, normalized and then added with additive
+// layers before being written to the output. This avoids reading back and
+// writing the output buffer once per layer and stage.
+// _Policy defines quaternion normalization precision, see BlendingJob::Quality.
+// Only soa joints in range [_begin, _end[ are processed.
+template <typename _Policy>
+void BlendJoints(const BlendingJob& _job, const ProcessArgs& _args,
+                 size_t _begin, size_t _end) {
+  // Prepares constants.
+  const math::SimdFloat4 one = math::simd_float4::one();
+  const math::SimdFloat4 simd_threshold =
+      math::simd_float4::Load1(_job.threshold);
+  const math::SimdFloat4 simd_bp_weight =
+      math::simd_float4::Load1(_args.bind_pose_weight);
+  const math::SimdFloat4 global_ratio =
+      math::simd_float4::Load1(1.f / _args.accumulated_weight);
+
+  // Sparse layers cursors.
+  LayerCursors layer_cursors(_job, _begin);
+
+  for (size_t i = _begin; i < _end; ++i) {
+    math::SoaTransform blended;
+    math::SoaTransform* dest = &blended;
+
+    if (_args.copy_bind_pose) {
+      blended = _job.bind_pose.begin[i];
+    } else {
+      // Blends all layers.
+      math::SimdFloat4 accumulated_weight = math::simd_float4::zero();
+      bool first_pass = true;
+      const int** cursors = layer_cursors.cursors();
+      for (const BlendingJob::Layer* layer = _job.layers.begin;
+           layer < _job.layers.end; ++layer) {
+        // Skip irrelevant layers.
+        if (!_job.IsLayerContributing(layer->weight)) {
+          continue;
         }
-      } else {
-        for (size_t i = 0; i < _args->num_soa_joints; ++i) {
-          const math::SoaTransform& src = layer->transform.begin[i];
-          math::SoaTransform* dest = _args->job.output.begin + i;
-          const math::SimdFloat4 weight =
-              layer_weight * math::Max0(layer->joint_weights.begin[i]);
-          _args->accumulated_weights[i] =
-              _args->accumulated_weights[i] + weight;
+        // Only sparse layers own a cursor, dense ones never read it.
+        const int** cursor = cursors;
+        cursors += IsSparseLayer(*layer);
+        math::SimdFloat4 weight;
+        if (!GetJointWeight(*layer, i, math::simd_float4::Load1(layer->weight),
+                            cursor, &weight)) {
+          continue;  // This joint isn't part of the sparse layer.
+        }
+        math::SoaTransform scratch;
+        const math::SoaTransform& src = GetLayerTransform(*layer, i, &scratch);
+        if (first_pass) {
+          first_pass = false;
+          accumulated_weight = weight;
+          OZZ_BLEND_1ST_PASS(src, weight, dest);
+        } else {
+          accumulated_weight = accumulated_weight + weight;
           OZZ_BLEND_N_PASS(src, weight, dest);
         }
       }
-    } else {
-      // This is a full layer.
-      if (_args->num_passes == 0) {
-        for (size_t i = 0; i < _args->num_soa_joints; ++i) {
-          const math::SoaTransform& src = layer->transform.begin[i];
-          math::SoaTransform* dest = _args->job.output.begin + i;
-          _args->accumulated_weights[i] = layer_weight;
-          OZZ_BLEND_1ST_PASS(src, layer_weight, dest);
+
+      // Blends bind pose if accumulated weight is less than the threshold.
+      const math::SoaTransform& bp = _job.bind_pose.begin[i];
+      if (_args.num_partial_passes == 0) {
+        if (_args.bind_pose_weight > 0.f) {
+          OZZ_BLEND_N_PASS(bp, simd_bp_weight, dest);
         }
       } else {
-        for (size_t i = 0; i < _args->num_soa_joints; ++i) {
-          const math::SoaTransform& src = layer->transform.begin[i];
-          math::SoaTransform* dest = _args->job.output.begin + i;
-          _args->accumulated_weights[i] =
-              _args->accumulated_weights[i] + layer_weight;
-          OZZ_BLEND_N_PASS(src, layer_weight, dest);
+        // Blending passes contain partial blending, threshold must be tested
+        // for each joint.
+        const math::SimdFloat4 bp_weight =
+            math::Max0(simd_threshold - accumulated_weight);
+        accumulated_weight = math::Max(simd_threshold, accumulated_weight);
+        if (first_pass) {
+          // No sparse layer affects this joint.
+          OZZ_BLEND_1ST_PASS(bp, bp_weight, dest);
+        } else {
+          OZZ_BLEND_N_PASS(bp, bp_weight, dest);
         }
       }
+
+      // Normalizes output. Quaternion length cannot be zero as opposed
+      // quaternions have been fixed up during blending passes.
+      // Translations and scales are normalized by the accumulated weight, which
+      // is computed per-joint only for partial blending.
+      const math::SimdFloat4 ratio = _args.num_partial_passes == 0
+                                         ? global_ratio
+                                         : one / accumulated_weight;
+      blended.translation = blended.translation * ratio;
+      blended.scale = blended.scale * ratio;
     }
-    // One more pass blended.
-    ++_args->num_passes;
-  }
-}
+    blended.rotation = _Policy::Normalize(blended.rotation);
+
+    // Process additive blending passes.
+    if (_args.unit_additive_passes) {
+      AddUnitLayers(_job, i, &blended);
+      _job.output.begin[i] = blended;
+      continue;
+    }
+    const int** additive_cursors = layer_cursors.additive_cursors();
+    for (const BlendingJob::Layer* layer = _job.additive_layers.begin;
+         layer < _job.additive_layers.end; ++layer) {
+      // Skip irrelevant layers.
+      if (!_job.IsAdditiveLayerContributing(layer->weight)) {
+        continue;
+      }
 
-// Blends bind pose to the output if accumulated weight is less than the
-// threshold value.
-void BlendBindPose(ProcessArgs* _args) {
-  assert(_args);
-
-  // Asserts buffer sizes, which must never fail as it has been validated.
-  assert(_args->job.bind_pose.end >=
-         _args->job.bind_pose.begin + _args->num_soa_joints);
-
-  if (_args->num_partial_passes == 0) {
-    // No partial blending pass detected, threshold can be tested globally.
-    const float bp_weight = _args->job.threshold - _args->accumulated_weight;
-
-    if (bp_weight > 0.f) {  // The bind-pose is needed if it has a weight.
-      if (_args->num_passes == 0) {
-        // Strictly copying bind-pose.
-        _args->accumulated_weight = 1.f;
-        for (size_t i = 0; i < _args->num_soa_joints; ++i) {
-          _args->job.output.begin[i] = _args->job.bind_pose.begin[i];
+      // Asserts buffer sizes, which must never fail as it has been validated.
+      assert(layer->transform_indices.begin ||
+             LayerSize(*layer) >=
+                 static_cast<ptrdiff_t>(_args.num_soa_joints));
+      assert(!layer->joint_weights.begin || layer->joint_indices.begin ||
+             layer->transform_indices.begin ||
+             (layer->joint_weights.end >=
+              layer->joint_weights.begin + _args.num_soa_joints));
+
+      math::SimdFloat4 weight;
+      math::SoaTransform scratch;
+      const int** cursor = additive_cursors;
+      additive_cursors += IsSparseLayer(*layer);
+      if (layer->weight > 0.f) {
+        // Weight is positive, need to perform additive blending.
+        const math::SoaTransform* src = GetAdditiveTransform(
+            *layer, i, math::simd_float4::Load1(layer->weight), cursor,
+            &weight, &scratch);
+        if (!src) {
+          continue;  // This joint isn't part of the sparse layer.
         }
+        const math::SimdFloat4 one_minus_weight = one - weight;
+        const math::SoaFloat3 one_minus_weight_f3 = {
+            one_minus_weight, one_minus_weight, one_minus_weight};
+        OZZ_ADD_PASS((*src), weight, blended);
       } else {
-        // Updates global accumulated weight, but not per-joint weight any more
-        // because normalization stage will be global also.
-        _args->accumulated_weight = _args->job.threshold;
-
-        const math::SimdFloat4 simd_bp_weight =
-            math::simd_float4::Load1(bp_weight);
-
-        for (size_t i = 0; i < _args->num_soa_joints; ++i) {
-          const math::SoaTransform& src = _args->job.bind_pose.begin[i];
-          math::SoaTransform* dest = _args->job.output.begin + i;
-          OZZ_BLEND_N_PASS(src, simd_bp_weight, dest);
+        // Weight is negative, need to perform subtractive blending.
+        const math::SoaTransform* src = GetAdditiveTransform(
+            *layer, i, math::simd_float4::Load1(-layer->weight), cursor,
+            &weight, &scratch);
+        if (!src) {
+          continue;  // This joint isn't part of the sparse layer.
         }
+        const math::SimdFloat4 one_minus_weight = one - weight;
+        OZZ_SUB_PASS((*src), weight, blended);
       }
     }
-  } else {
-    // Blending passes contain partial blending, threshold must be tested for
-    // each joint.
-    const math::SimdFloat4 threshold =
-        math::simd_float4::Load1(_args->job.threshold);
-
-    // There's been at least 1 pass as num_partial_passes != 0.
-    assert(_args->num_passes != 0);
-
-    for (size_t i = 0; i < _args->num_soa_joints; ++i) {
-      const math::SoaTransform& src = _args->job.bind_pose.begin[i];
-      math::SoaTransform* dest = _args->job.output.begin + i;
-      const math::SimdFloat4 bp_weight =
-          math::Max0(threshold - _args->accumulated_weights[i]);
-      _args->accumulated_weights[i] =
-          math::Max(threshold, _args->accumulated_weights[i]);
-      OZZ_BLEND_N_PASS(src, bp_weight, dest);
-    }
+
+    // Stores the fully blended joint.
+    _job.output.begin[i] = blended;
   }
 }
+}  // namespace
 
-// Normalizes output rotations. Quaternion length cannot be zero as opposed
-// quaternions have been fixed up during blending passes.
-// Translations and scales are already normalized because weights were
-// pre-multiplied by the normalization ratio.
-void Normalize(ProcessArgs* _args) {
-  assert(_args);
-
-  if (_args->num_partial_passes == 0) {
-    // Normalization of a non-partial blending requires to apply the same
-    // division to all joints.
-    const math::SimdFloat4 ratio =
-        math::simd_float4::Load1(1.f / _args->accumulated_weight);
-    for (size_t i = 0; i < _args->num_soa_joints; ++i) {
-      math::SoaTransform& dest = _args->job.output.begin[i];
-      dest.rotation = NormalizeEst(dest.rotation);
-      dest.translation = dest.translation * ratio;
-      dest.scale = dest.scale * ratio;
+namespace {
+// Blends soa joints in range [_begin, _end[ of a validated job.
+void BlendRange(const BlendingJob& _job, size_t _begin, size_t _end) {
+  // Initializes blending parameters that are shared by all joints.
+  OZZ_PROFILE_ZONE("ozz::BlendingJob::Blend");
+  const ProcessArgs args(_job);
+
+  // Dispatches to the kernel specialized for the requested quality.
+  switch (_job.quality) {
+    case BlendingJob::kFast: {
+      BlendJoints<math::EstimatedNormalization<0> >(_job, args, _begin, _end);
+      break;
     }
-  } else {
-    // Partial blending normalization requires to compute the divider per-joint.
-    const math::SimdFloat4 one = math::simd_float4::one();
-    for (size_t i = 0; i < _args->num_soa_joints; ++i) {
-      const math::SimdFloat4 ratio = one / _args->accumulated_weights[i];
-      math::SoaTransform& dest = _args->job.output.begin[i];
-      dest.rotation = NormalizeEst(dest.rotation);
-      dest.translation = dest.translation * ratio;
-      dest.scale = dest.scale * ratio;
+    case BlendingJob::kAccurate: {
+      BlendJoints<math::ExactNormalization>(_job, args, _begin, _end);
+      break;
     }
-  }
-}
-
-// Process additive blending pass.
-void AddLayers(ProcessArgs* _args) {
-  assert(_args);
-
-  // Iterates through all layers and blend them to the output.
-  for (const BlendingJob::Layer* layer = _args->job.additive_layers.begin;
-       layer < _args->job.additive_layers.end; ++layer) {
-    // Asserts buffer sizes, which must never fail as it has been validated.
-    assert(layer->transform.end >=
-           layer->transform.begin + _args->num_soa_joints);
-    assert(!layer->joint_weights.begin ||
-           (layer->joint_weights.end >=
-            layer->joint_weights.begin + _args->num_soa_joints));
-
-    // Prepares constants.
-    const math::SimdFloat4 one = math::simd_float4::one();
-
-    if (layer->weight > 0.f) {
-      // Weight is positive, need to perform additive blending.
-      const math::SimdFloat4 layer_weight =
-          math::simd_float4::Load1(layer->weight);
-
-      if (layer->joint_weights.begin) {
-        // This layer has per-joint weights.
-        for (size_t i = 0; i < _args->num_soa_joints; ++i) {
-          const math::SoaTransform& src = layer->transform.begin[i];
-          math::SoaTransform& dest = _args->job.output.begin[i];
-          const math::SimdFloat4 weight =
-              layer_weight * math::Max0(layer->joint_weights.begin[i]);
-          const math::SimdFloat4 one_minus_weight = one - weight;
-          const math::SoaFloat3 one_minus_weight_f3 = {
-              one_minus_weight, one_minus_weight, one_minus_weight};
-          OZZ_ADD_PASS(src, weight, dest);
-        }
-      } else {
-        // This is a full layer.
-        const math::SimdFloat4 one_minus_weight = one - layer_weight;
-        const math::SoaFloat3 one_minus_weight_f3 = {
-            one_minus_weight, one_minus_weight, one_minus_weight};
-
-        for (size_t i = 0; i < _args->num_soa_joints; ++i) {
-          const math::SoaTransform& src = layer->transform.begin[i];
-          math::SoaTransform& dest = _args->job.output.begin[i];
-          OZZ_ADD_PASS(src, layer_weight, dest);
-        }
-      }
-    } else if (layer->weight < 0.f) {
-      // Weight is negative, need to perform subtractive blending.
-      const math::SimdFloat4 layer_weight =
-          math::simd_float4::Load1(-layer->weight);
-
-      if (layer->joint_weights.begin) {
-        // This layer has per-joint weights.
-        for (size_t i = 0; i < _args->num_soa_joints; ++i) {
-          const math::SoaTransform& src = layer->transform.begin[i];
-          math::SoaTransform& dest = _args->job.output.begin[i];
-          const math::SimdFloat4 weight =
-              layer_weight * math::Max0(layer->joint_weights.begin[i]);
-          const math::SimdFloat4 one_minus_weight = one - weight;
-          OZZ_SUB_PASS(src, weight, dest);
-        }
-      } else {
-        // This is a full layer.
-        const math::SimdFloat4 one_minus_weight = one - layer_weight;
-        for (size_t i = 0; i < _args->num_soa_joints; ++i) {
-          const math::SoaTransform& src = layer->transform.begin[i];
-          math::SoaTransform& dest = _args->job.output.begin[i];
-          OZZ_SUB_PASS(src, layer_weight, dest);
-        }
-      }
-    } else {
-      // Skip layer as its weight is 0.
+    default: {
+      BlendJoints<math::EstimatedNormalization<1> >(_job, args, _begin, _end);
+      break;
     }
   }
 }
@@ -473,21 +696,33 @@ bool BlendingJob::Run() const {
   if (!Validate()) {
     return false;
   }
+  RunUnchecked();
+  return true;
+}
 
-  // Initializes blended parameters that are exchanged across blend stages.
-  ProcessArgs process_args(*this);
-
-  // Blends all layers to the job output buffers.
-  BlendLayers(&process_args);
+void BlendingJob::RunUnchecked() const {
+  OZZ_PROFILE_ZONE("ozz::BlendingJob::Run");
+  assert(Validate() && "Invalid job, see BlendingJob::Validate().");
 
-  // Applies bind pose.
-  BlendBindPose(&process_args);
+  BlendRange(*this, 0, bind_pose.count());
+}
 
-  // Normalizes output.
-  Normalize(&process_args);
+bool BlendingJob::Resume(int* _cursor, int _max_soa_joints) const {
+  OZZ_PROFILE_ZONE("ozz::BlendingJob::Resume");
+  if (!_cursor || _max_soa_joints <= 0 || !Validate()) {
+    return false;
+  }
+  const int num_soa_joints = static_cast<int>(bind_pose.count());
+  const int begin = *_cursor;
+  if (begin < 0 || begin > num_soa_joints) {
+    return false;
+  }
+  const int end = num_soa_joints - begin > _max_soa_joints
+                      ? begin + _max_soa_joints
+                      : num_soa_joints;
 
-  // Process additive blending.
-  AddLayers(&process_args);
+  BlendRange(*this, begin, end);
+  *_cursor = end;
 
   return true;
 }
@@ -0,0 +1,94 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#include "ozz/animation/runtime/correction_job.h"
+
+#include "ozz/base/maths/simd_quaternion.h"
+#include "ozz/base/maths/soa_transform.h"
+
+namespace ozz {
+namespace animation {
+
+bool CorrectionJob::Validate() const {
+  bool valid = true;
+  valid &= corrections.count() >= joints.count();
+  const size_t num_joints = output.count() * 4;
+  for (size_t i = 0; valid && i < joints.count(); ++i) {
+    valid &= joints[i] >= 0 && static_cast<size_t>(joints[i]) < num_joints;
+  }
+  return valid;
+}
+
+bool CorrectionJob::Run() const {
+  if (!Validate()) {
+    return false;
+  }
+
+  const math::SimdInt4 lane_masks[4] = {
+      math::simd_int4::mask_f000(), math::simd_int4::mask_0f00(),
+      math::simd_int4::mask_00f0(), math::simd_int4::mask_000f()};
+
+  // Corrections are accumulated in a soa quaternion as long as they target
+  // different lanes of the same soa transform.
+  math::SoaQuaternion soa_correction = math::SoaQuaternion::identity();
+  int soa_index = -1;
+  int used_lanes = 0;
+  for (size_t i = 0; i < joints.count(); ++i) {
+    const int joint = joints[i];
+    const int lane = joint & 3;
+    if (joint / 4 != soa_index || (used_lanes & (1 << lane)) != 0) {
+      if (soa_index != -1) {
+        math::SoaQuaternion& rotation = output[soa_index].rotation;
+        rotation = rotation * soa_correction;
+      }
+      soa_correction = math::SoaQuaternion::identity();
+      soa_index = joint / 4;
+      used_lanes = 0;
+    }
+    used_lanes |= 1 << lane;
+
+    // Sets correction lane, others remain unchanged.
+    const math::SimdInt4 mask = lane_masks[lane];
+    const math::SimdFloat4 correction = corrections[i].xyzw;
+    soa_correction.x =
+        math::Select(mask, math::SplatX(correction), soa_correction.x);
+    soa_correction.y =
+        math::Select(mask, math::SplatY(correction), soa_correction.y);
+    soa_correction.z =
+        math::Select(mask, math::SplatZ(correction), soa_correction.z);
+    soa_correction.w =
+        math::Select(mask, math::SplatW(correction), soa_correction.w);
+  }
+  if (soa_index != -1) {
+    math::SoaQuaternion& rotation = output[soa_index].rotation;
+    rotation = rotation * soa_correction;
+  }
+  return true;
+}
+}  // namespace animation
+}  // namespace ozz
@@ -0,0 +1,95 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#include "ozz/animation/runtime/ik_aim_chain_job.h"
+
+#include "ozz/animation/runtime/ik_aim_job.h"
+#include "ozz/base/maths/simd_quaternion.h"
+
+namespace ozz {
+namespace animation {
+IKAimChainJob::IKAimChainJob()
+    : target(math::simd_float4::zero()),
+      forward(math::simd_float4::x_axis()),
+      offset(math::simd_float4::zero()),
+      pole_vector(math::simd_float4::y_axis()),
+      reached(NULL) {}
+
+bool IKAimChainJob::Validate() const {
+  bool valid = true;
+  const size_t count = joints.count();
+  valid &= ups.count() >= count;
+  valid &= weights.count() >= count;
+  valid &= joint_corrections.count() >= count;
+  for (size_t i = 0; valid && i < count; ++i) {
+    valid &= joints[i] != NULL;
+  }
+  valid &= math::AreAllTrue1(math::IsNormalizedEst3(forward));
+  return valid;
+}
+
+bool IKAimChainJob::Run() const {
+  if (!Validate()) {
+    return false;
+  }
+
+  // Pole vector and target position are constant for the whole chain.
+  IKAimJob job;
+  job.target = target;
+  job.pole_vector = pole_vector;
+  job.forward = forward;
+  job.offset = offset;
+  job.reached = reached;
+
+  for (size_t i = 0; i < joints.count(); ++i) {
+    if (i != 0) {
+      // Applies previous joint correction to forward and offset, and brings
+      // them to the current joint local-space. Previous joint model-space
+      // matrix is deliberately not updated with its correction: the offset is
+      // rotated by the correction before being transformed.
+      const math::SimdQuaternion& correction = joint_corrections[i - 1];
+      const math::Float4x4& previous = *joints[i - 1];
+      const math::Float4x4 to_local = Invert(*joints[i]) * previous;
+      job.forward =
+          TransformVector(to_local, TransformVector(correction, job.forward));
+      job.offset =
+          TransformPoint(to_local, TransformVector(correction, job.offset));
+    }
+
+    job.joint = joints[i];
+    job.up = ups[i];
+    job.weight = weights[i];
+    job.joint_correction = &joint_corrections[i];
+    if (!job.Run()) {
+      return false;
+    }
+  }
+  return true;
+}
+}  // namespace animation
+}  // namespace ozz
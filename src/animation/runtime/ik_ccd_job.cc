@@ -0,0 +1,173 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#include "ozz/animation/runtime/ik_ccd_job.h"
+
+#include "ozz/base/maths/simd_quaternion.h"
+
+namespace ozz {
+namespace animation {
+IKCCDJob::IKCCDJob()
+    : target(math::simd_float4::zero()),
+      tolerance(1e-3f),
+      max_iterations(16),
+      weight(1.f),
+      end_joint(NULL),
+      reached(NULL) {}
+
+bool IKCCDJob::Validate() const {
+  bool valid = true;
+  valid &= end_joint != NULL;
+  valid &= joint_corrections.count() >= joints.count();
+  for (size_t i = 0; valid && i < joints.count(); ++i) {
+    valid &= joints[i] != NULL;
+  }
+  return valid;
+}
+
+namespace {
+
+// Computes current model-space position of the end joint, and of chain joint
+// _joint, according to model-space rotations accumulated in
+// _job.joint_corrections. The offset between a joint and its parent is
+// rotated by the parent accumulated rotation, so positions are rebuilt from
+// the root of the chain, which never moves.
+math::SimdFloat4 CCDPositions(const IKCCDJob& _job, size_t _joint,
+                              math::SimdFloat4* _joint_position) {
+  const size_t count = _job.joints.count();
+  math::SimdFloat4 position = _job.joints[count - 1]->cols[3];
+  *_joint_position = position;
+  for (size_t i = count - 1; i > 0; --i) {
+    position = position + TransformVector(_job.joint_corrections[i],
+                                          _job.joints[i - 1]->cols[3] -
+                                              _job.joints[i]->cols[3]);
+    if (i - 1 == _joint) {
+      *_joint_position = position;
+    }
+  }
+  return position + TransformVector(_job.joint_corrections[0],
+                                    _job.end_joint->cols[3] -
+                                        _job.joints[0]->cols[3]);
+}
+
+bool CCDReached(const IKCCDJob& _job, math::_SimdFloat4 _end) {
+  const math::SimdFloat4 distance2 = math::Length3Sqr(_job.target - _end);
+  return math::GetX(distance2) <= _job.tolerance * _job.tolerance;
+}
+
+// Converts accumulated model-space rotations to local-space corrections, in
+// place, and applies weight.
+void CCDOutput(const IKCCDJob& _job) {
+  const math::SimdFloat4 zero = math::simd_float4::zero();
+  const math::SimdInt4 mask_sign = math::simd_int4::mask_sign();
+  const size_t count = _job.joints.count();
+  for (size_t i = 0; i < count; ++i) {
+    // Model-space rotation of the joint, relative to its parent one. Parent
+    // rotation is still in model-space, as joints are processed from child to
+    // parent.
+    const math::SimdQuaternion parent =
+        i + 1 < count ? _job.joint_corrections[i + 1]
+                      : math::SimdQuaternion::identity();
+    const math::SimdQuaternion delta_ms =
+        Conjugate(parent) * _job.joint_corrections[i];
+
+    // Brings rotation axis to joint local-space. Axis is normalized to
+    // support uniformly scaled matrices.
+    const math::SimdFloat4 axis_ms = math::SetW(delta_ms.xyzw, zero);
+    const math::SimdFloat4 axis_ls = math::NormalizeSafe3(
+        TransformVector(Invert(*_job.joints[i]), axis_ms), zero);
+    const math::SimdFloat4 local =
+        math::SetW(axis_ls * math::SplatX(math::Length3(axis_ms)),
+                   math::SplatW(delta_ms.xyzw));
+
+    // Fix up quaternions so w is always positive, which is required for NLerp
+    // (with identity quaternion) to lerp the shortest path.
+    const math::SimdFloat4 local_fu =
+        math::Xor(local, math::And(mask_sign,
+                                   math::CmpLt(math::SplatW(local), zero)));
+    math::SimdQuaternion& correction = _job.joint_corrections[i];
+    if (_job.weight <= 0.f) {
+      correction = math::SimdQuaternion::identity();
+    } else if (_job.weight < 1.f) {
+      const math::SimdFloat4 lerp =
+          math::Lerp(math::simd_float4::w_axis(), local_fu,
+               math::simd_float4::Load1(_job.weight));
+      correction.xyzw = math::Normalize4(lerp);
+    } else {
+      correction.xyzw = math::Normalize4(local_fu);
+    }
+  }
+}
+}  // namespace
+
+bool IKCCDJob::Run() const {
+  if (!Validate()) {
+    return false;
+  }
+
+  // Without any joint to rotate, the end joint can only be tested.
+  if (joints.count() == 0) {
+    if (reached) {
+      *reached = CCDReached(*this, end_joint->cols[3]) && weight >= 1.f;
+    }
+    return true;
+  }
+
+  // Corrections are used to accumulate model-space rotation of each joint
+  // while iterating.
+  for (size_t i = 0; i < joints.count(); ++i) {
+    joint_corrections[i] = math::SimdQuaternion::identity();
+  }
+
+  math::SimdFloat4 joint_position;
+  bool lreached = CCDReached(*this, end_joint->cols[3]);
+  for (int it = 0; it < max_iterations && !lreached; ++it) {
+    for (size_t i = 0; i < joints.count(); ++i) {
+      // Rotates joint so end joint gets aligned with target direction.
+      const math::SimdFloat4 end = CCDPositions(*this, i, &joint_position);
+      const math::SimdQuaternion rotation = math::SimdQuaternion::FromVectors(
+          end - joint_position, target - joint_position);
+
+      // Joint rotation applies to all its children.
+      for (size_t j = 0; j <= i; ++j) {
+        joint_corrections[j] = rotation * joint_corrections[j];
+      }
+    }
+    lreached = CCDReached(*this, CCDPositions(*this, 0, &joint_position));
+  }
+
+  if (reached) {
+    *reached = lreached && weight >= 1.f;
+  }
+
+  CCDOutput(*this);
+
+  return true;
+}
+}  // namespace animation
+}  // namespace ozz
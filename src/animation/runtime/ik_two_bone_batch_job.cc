@@ -0,0 +1,385 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#include "ozz/animation/runtime/ik_two_bone_batch_job.h"
+
+#include <cassert>
+
+#include "ozz/base/maths/simd_quaternion.h"
+#include "ozz/base/maths/soa_float.h"
+#include "ozz/base/maths/soa_quaternion.h"
+
+namespace ozz {
+namespace animation {
+
+IKTwoBoneBatchJob::IKTwoBoneBatchJob()
+    : mid_axis(math::simd_float4::z_axis()), soften(1.f) {}
+
+bool IKTwoBoneBatchJob::Validate() const {
+  bool valid = true;
+  const size_t count = targets.count();
+  valid &= pole_vectors.count() >= count;
+  valid &= twist_angles.begin == NULL || twist_angles.count() >= count;
+  valid &= weights.begin == NULL || weights.count() >= count;
+  valid &= start_joints.count() >= count;
+  valid &= mid_joints.count() >= count;
+  valid &= end_joints.count() >= count;
+  valid &= start_joint_corrections.count() >= count;
+  valid &= mid_joint_corrections.count() >= count;
+  valid &= reached.begin == NULL || reached.count() >= count;
+  for (size_t i = 0; valid && i < count; ++i) {
+    valid &= start_joints[i] && mid_joints[i] && end_joints[i];
+  }
+  valid &= math::AreAllTrue1(math::IsNormalizedEst3(mid_axis));
+  return valid;
+}
+
+namespace {
+
+// Transposes the xyz components of 4 vectors to soa.
+math::SoaFloat3 GatherSoaFloat3(const math::SimdFloat4 _aos[4]) {
+  math::SimdFloat4 soa[3];
+  math::Transpose4x3(_aos, soa);
+  const math::SoaFloat3 v = {soa[0], soa[1], soa[2]};
+  return v;
+}
+
+// Selects _true or _false soa vector lanes, according to _b lanes.
+math::SoaFloat3 SelectSoa(math::_SimdInt4 _b, const math::SoaFloat3& _true,
+                          const math::SoaFloat3& _false) {
+  const math::SoaFloat3 v = {math::Select(_b, _true.x, _false.x),
+                             math::Select(_b, _true.y, _false.y),
+                             math::Select(_b, _true.z, _false.z)};
+  return v;
+}
+math::SoaQuaternion SelectSoa(math::_SimdInt4 _b,
+                              const math::SoaQuaternion& _true,
+                              const math::SoaQuaternion& _false) {
+  const math::SoaQuaternion q = {math::Select(_b, _true.x, _false.x),
+                                 math::Select(_b, _true.y, _false.y),
+                                 math::Select(_b, _true.z, _false.z),
+                                 math::Select(_b, _true.w, _false.w)};
+  return q;
+}
+
+// Rotates soa vector _v by soa quaternion _q, see math::TransformVector.
+math::SoaFloat3 RotateSoa(const math::SoaQuaternion& _q,
+                          const math::SoaFloat3& _v) {
+  const math::SoaFloat3 xyz = {_q.x, _q.y, _q.z};
+  const math::SoaFloat3 cross1 = _v * _q.w + math::Cross(xyz, _v);
+  const math::SoaFloat3 cross2 = math::Cross(xyz, cross1);
+  return _v + cross2 + cross2;
+}
+
+// Soa version of SimdQuaternion::FromAxisAngle.
+math::SoaQuaternion FromAxisAngleSoa(const math::SoaFloat3& _axis,
+                                     math::_SimdFloat4 _angle) {
+  const math::SimdFloat4 half_angle = _angle * math::simd_float4::Load1(.5f);
+  const math::SimdFloat4 half_sin = math::Sin(half_angle);
+  const math::SoaQuaternion q = {_axis.x * half_sin, _axis.y * half_sin,
+                                 _axis.z * half_sin, math::Cos(half_angle)};
+  return q;
+}
+
+// Soa version of SimdQuaternion::FromAxisCosAngle.
+math::SoaQuaternion FromAxisCosAngleSoa(const math::SoaFloat3& _axis,
+                                        math::_SimdFloat4 _cos) {
+  const math::SimdFloat4 one = math::simd_float4::one();
+  const math::SimdFloat4 half_cos2 =
+      (one + _cos) * math::simd_float4::Load1(.5f);
+  const math::SimdFloat4 half_sin = math::Sqrt(one - half_cos2);
+  const math::SoaQuaternion q = {_axis.x * half_sin, _axis.y * half_sin,
+                                 _axis.z * half_sin, math::Sqrt(half_cos2)};
+  return q;
+}
+
+// Soa version of SimdQuaternion::FromVectors.
+math::SoaQuaternion FromVectorsSoa(const math::SoaFloat3& _from,
+                                   const math::SoaFloat3& _to) {
+  const math::SimdFloat4 zero = math::simd_float4::zero();
+  const math::SimdFloat4 epsilon = math::simd_float4::Load1(1.e-6f);
+  const math::SimdFloat4 norm_from_norm_to =
+      math::Sqrt(math::LengthSqr(_from) * math::LengthSqr(_to));
+  const math::SimdFloat4 real_part =
+      norm_from_norm_to + math::Dot(_from, _to);
+
+  // General code path.
+  const math::SoaFloat3 cross = math::Cross(_from, _to);
+  const math::SoaQuaternion general = {cross.x, cross.y, cross.z, real_part};
+
+  // If _from and _to are exactly opposite, rotate 180 degrees around an
+  // arbitrary orthogonal axis.
+  const math::SimdInt4 x_major =
+      math::CmpGt(math::Abs(_from.x), math::Abs(_from.z));
+  const math::SoaQuaternion opposite = {
+      math::Select(x_major, -_from.y, zero),
+      math::Select(x_major, _from.x, -_from.z),
+      math::Select(x_major, zero, _from.y), zero};
+  const math::SimdInt4 is_opposite =
+      math::CmpLt(real_part, epsilon * norm_from_norm_to);
+  const math::SoaQuaternion quat =
+      math::Normalize(SelectSoa(is_opposite, opposite, general));
+
+  // Null vectors lead to identity.
+  return SelectSoa(math::CmpLt(norm_from_norm_to, epsilon),
+                   math::SoaQuaternion::identity(), quat);
+}
+
+// Fixes up quaternions so w is always positive, which is required for NLerp
+// (with identity quaternion) to lerp the shortest path. Then applies weight.
+math::SoaQuaternion WeightSoa(const math::SoaQuaternion& _q,
+                              math::_SimdFloat4 _weight) {
+  const math::SimdFloat4 zero = math::simd_float4::zero();
+  const math::SimdInt4 flip =
+      math::And(math::simd_int4::mask_sign(), math::CmpLt(_q.w, zero));
+  const math::SoaQuaternion fu = {math::Xor(_q.x, flip), math::Xor(_q.y, flip),
+                                  math::Xor(_q.z, flip), math::Xor(_q.w, flip)};
+
+  // NLerp with identity.
+  const math::SimdFloat4 weight = math::Max(zero, _weight);
+  const math::SimdFloat4 one = math::simd_float4::one();
+  const math::SoaQuaternion lerp = {fu.x * weight, fu.y * weight,
+                                    fu.z * weight, one + (fu.w - one) * weight};
+  const math::SimdFloat4 rlen = math::RSqrtEstNR(
+      lerp.x * lerp.x + lerp.y * lerp.y + lerp.z * lerp.z + lerp.w * lerp.w);
+  const math::SoaQuaternion nlerp = {lerp.x * rlen, lerp.y * rlen,
+                                     lerp.z * rlen, lerp.w * rlen};
+
+  const math::SoaQuaternion weighted =
+      SelectSoa(math::CmpLt(_weight, one), nlerp, fu);
+  return SelectSoa(math::CmpLe(_weight, zero), math::SoaQuaternion::identity(),
+                   weighted);
+}
+
+// Solves 4 chains, starting at chain _first. Out of range chains are padded
+// with the last chain and their outputs are discarded.
+void SolveSoa(const IKTwoBoneBatchJob& _job, size_t _first) {
+  const size_t count = _job.targets.count();
+  const math::SimdFloat4 zero = math::simd_float4::zero();
+  const math::SimdFloat4 one = math::simd_float4::one();
+  const math::SimdFloat4 m_one = -one;
+  const math::SimdInt4 mask_sign = math::simd_int4::mask_sign();
+
+  // Computes matrices dependent setup for each chain.
+  // If matrices aren't invertible, they'll be all 0 (ozz::math
+  // implementation), which will result in identity correction quaternions.
+  math::SimdFloat4 start_mid_ms[4], mid_end_ms[4], start_mid_ss[4], end_ss[4],
+      target_ss[4], pole_ss[4], mid_axis_ss[4], mid_to_ss[3][4];
+  float twist[4], weight[4];
+  for (size_t l = 0; l < 4; ++l) {
+    const size_t i = _first + l < count ? _first + l : count - 1;
+    const math::Float4x4& start_joint = *_job.start_joints[i];
+    const math::Float4x4& mid_joint = *_job.mid_joints[i];
+    const math::Float4x4& end_joint = *_job.end_joints[i];
+
+    math::SimdInt4 invertible;
+    const math::Float4x4 inv_start_joint = Invert(start_joint, &invertible);
+    const math::Float4x4 inv_mid_joint = Invert(mid_joint, &invertible);
+
+    start_mid_ms[l] = -TransformPoint(inv_mid_joint, start_joint.cols[3]);
+    mid_end_ms[l] = TransformPoint(inv_mid_joint, end_joint.cols[3]);
+    start_mid_ss[l] = TransformPoint(inv_start_joint, mid_joint.cols[3]);
+    end_ss[l] = TransformPoint(inv_start_joint, end_joint.cols[3]);
+    target_ss[l] = TransformPoint(inv_start_joint, _job.targets[i]);
+    pole_ss[l] = TransformVector(inv_start_joint, _job.pole_vectors[i]);
+
+    // Matrix transforming mid joint space vectors to start joint space.
+    const math::Float4x4 mid_to_ss_matrix = inv_start_joint * mid_joint;
+    for (int c = 0; c < 3; ++c) {
+      mid_to_ss[c][l] = mid_to_ss_matrix.cols[c];
+    }
+    mid_axis_ss[l] = TransformVector(mid_to_ss_matrix, _job.mid_axis);
+
+    twist[l] = _job.twist_angles.begin ? _job.twist_angles[i] : 0.f;
+    weight[l] = _job.weights.begin ? _job.weights[i] : 1.f;
+  }
+
+  // Converts setup to soa.
+  const math::SoaFloat3 s_start_mid_ms = GatherSoaFloat3(start_mid_ms);
+  const math::SoaFloat3 s_mid_end_ms = GatherSoaFloat3(mid_end_ms);
+  const math::SoaFloat3 s_start_mid_ss = GatherSoaFloat3(start_mid_ss);
+  const math::SoaFloat3 s_end_ss = GatherSoaFloat3(end_ss);
+  const math::SoaFloat3 s_target_original_ss = GatherSoaFloat3(target_ss);
+  const math::SoaFloat3 s_pole_ss = GatherSoaFloat3(pole_ss);
+  const math::SoaFloat3 s_mid_axis_ss = GatherSoaFloat3(mid_axis_ss);
+  const math::SoaFloat3 s_mid_to_ss[3] = {GatherSoaFloat3(mid_to_ss[0]),
+                                          GatherSoaFloat3(mid_to_ss[1]),
+                                          GatherSoaFloat3(mid_to_ss[2])};
+  const math::SoaFloat3 s_mid_axis = {math::SplatX(_job.mid_axis),
+                                      math::SplatY(_job.mid_axis),
+                                      math::SplatZ(_job.mid_axis)};
+  const math::SimdFloat4 s_weight = math::simd_float4::LoadPtrU(weight);
+
+  // Bones lengths.
+  const math::SoaFloat3 s_mid_end_ss = s_end_ss - s_start_mid_ss;
+  const math::SimdFloat4 start_mid_ss_len2 = math::LengthSqr(s_start_mid_ss);
+  const math::SimdFloat4 mid_end_ss_len2 = math::LengthSqr(s_mid_end_ss);
+  const math::SimdFloat4 start_end_ss_len2 = math::LengthSqr(s_end_ss);
+
+  // Softens target position, see IKTwoBoneJob SoftenTarget().
+  const math::SimdFloat4 start_target_original_ss_len2 =
+      math::LengthSqr(s_target_original_ss);
+  const math::SimdFloat4 start_mid_ss_len = math::Sqrt(start_mid_ss_len2);
+  const math::SimdFloat4 mid_end_ss_len = math::Sqrt(mid_end_ss_len2);
+  const math::SimdFloat4 start_target_original_ss_len =
+      math::Sqrt(start_target_original_ss_len2);
+  const math::SimdFloat4 bone_len_diff_abs =
+      math::Abs(start_mid_ss_len - mid_end_ss_len);
+  const math::SimdFloat4 bones_chain_len = start_mid_ss_len + mid_end_ss_len;
+  const math::SimdFloat4 da =
+      bones_chain_len *
+      math::Clamp(zero, math::simd_float4::Load1(_job.soften), one);
+  const math::SimdFloat4 ds = bones_chain_len - da;
+
+  const math::SimdInt4 further = math::CmpGt(start_target_original_ss_len, da);
+  const math::SimdInt4 soft =
+      math::And(math::And(further, math::CmpGt(start_target_original_ss_len,
+                                               zero)),
+                math::CmpGt(ds, zero));
+  const math::SimdInt4 reached = math::AndNot(
+      math::CmpGt(start_target_original_ss_len, bone_len_diff_abs), further);
+
+  // Approximates an exponential function with : 1-(3^4)/(alpha+3)^4
+  const math::SimdFloat4 alpha =
+      (start_target_original_ss_len - da) * math::RcpEst(ds);
+  const math::SimdFloat4 op = alpha + math::simd_float4::Load1(3.f);
+  const math::SimdFloat4 op2 = op * op;
+  const math::SimdFloat4 ratio =
+      math::simd_float4::Load1(81.f) * math::RcpEst(op2 * op2);
+  const math::SimdFloat4 start_target_soft_ss_len = da + ds - ds * ratio;
+  const math::SimdFloat4 start_target_ss_len2 =
+      math::Select(soft, start_target_soft_ss_len * start_target_soft_ss_len,
+                   start_target_original_ss_len2);
+  const math::SoaFloat3 s_target_ss =
+      SelectSoa(soft,
+                s_target_original_ss *
+                    (start_target_soft_ss_len *
+                     math::RcpEst(start_target_original_ss_len)),
+                s_target_original_ss);
+
+  // Computes mid joint rotation, see IKTwoBoneJob ComputeMidJoint().
+  const math::SimdFloat4 start_mid_end_sum_ss_len2 =
+      start_mid_ss_len2 + mid_end_ss_len2;
+  const math::SimdFloat4 start_mid_end_ss_half_rlen =
+      math::simd_float4::Load1(.5f) *
+      math::RSqrtEstNR(start_mid_ss_len2 * mid_end_ss_len2);
+  const math::SimdFloat4 mid_corrected_angle = math::ACos(math::Clamp(
+      m_one,
+      (start_mid_end_sum_ss_len2 - start_target_ss_len2) *
+          start_mid_end_ss_half_rlen,
+      one));
+  const math::SimdFloat4 mid_initial_angle_abs = math::ACos(math::Clamp(
+      m_one,
+      (start_mid_end_sum_ss_len2 - start_end_ss_len2) *
+          start_mid_end_ss_half_rlen,
+      one));
+  const math::SoaFloat3 bent_side_ref = math::Cross(s_start_mid_ms, s_mid_axis);
+  const math::SimdInt4 bent_side_flip =
+      math::CmpLt(math::Dot(bent_side_ref, s_mid_end_ms), zero);
+  const math::SimdFloat4 mid_initial_angle =
+      math::Xor(mid_initial_angle_abs, math::And(bent_side_flip, mask_sign));
+  const math::SoaQuaternion mid_rot_ms = FromAxisAngleSoa(
+      s_mid_axis, mid_corrected_angle - mid_initial_angle);
+
+  // Computes start joint rotation, see IKTwoBoneJob ComputeStartJoint().
+  const math::SoaFloat3 mid_end_ms_final = RotateSoa(mid_rot_ms, s_mid_end_ms);
+  const math::SoaFloat3 mid_end_ss_final =
+      s_mid_to_ss[0] * mid_end_ms_final.x +
+      s_mid_to_ss[1] * mid_end_ms_final.y +
+      s_mid_to_ss[2] * mid_end_ms_final.z;
+  const math::SoaFloat3 start_end_ss_final = s_start_mid_ss + mid_end_ss_final;
+  const math::SoaQuaternion end_to_target_rot_ss =
+      FromVectorsSoa(start_end_ss_final, s_target_ss);
+
+  // Aligns joint chain plane to the reference plane (pole vector). This can
+  // only be computed if start target axis is valid (not 0 length).
+  const math::SoaFloat3 ref_plane_normal_ss =
+      math::Cross(s_target_ss, s_pole_ss);
+  const math::SoaFloat3 joint_plane_normal_ss =
+      RotateSoa(end_to_target_rot_ss, s_mid_axis_ss);
+  const math::SimdFloat4 rotate_plane_cos_angle = math::Dot(
+      ref_plane_normal_ss *
+          math::RSqrtEstNR(math::LengthSqr(ref_plane_normal_ss)),
+      joint_plane_normal_ss *
+          math::RSqrtEstNR(math::LengthSqr(joint_plane_normal_ss)));
+  const math::SoaFloat3 rotate_plane_axis_ss =
+      s_target_ss * math::RSqrtEstNR(start_target_ss_len2);
+  const math::SimdFloat4 start_axis_flip =
+      math::And(math::Dot(joint_plane_normal_ss, s_pole_ss), mask_sign);
+  const math::SoaFloat3 rotate_plane_axis_flipped_ss = {
+      math::Xor(rotate_plane_axis_ss.x, start_axis_flip),
+      math::Xor(rotate_plane_axis_ss.y, start_axis_flip),
+      math::Xor(rotate_plane_axis_ss.z, start_axis_flip)};
+  const math::SoaQuaternion rotate_plane_ss = FromAxisCosAngleSoa(
+      rotate_plane_axis_flipped_ss,
+      math::Clamp(m_one, rotate_plane_cos_angle, one));
+  math::SoaQuaternion start_rot_ss = rotate_plane_ss * end_to_target_rot_ss;
+  if (_job.twist_angles.begin) {
+    start_rot_ss = FromAxisAngleSoa(rotate_plane_axis_ss,
+                                    math::simd_float4::LoadPtrU(twist)) *
+                   start_rot_ss;
+  }
+  start_rot_ss = SelectSoa(math::CmpGt(start_target_ss_len2, zero),
+                           start_rot_ss, end_to_target_rot_ss);
+
+  // Applies weight and outputs.
+  const math::SoaQuaternion start_weighted = WeightSoa(start_rot_ss, s_weight);
+  const math::SoaQuaternion mid_weighted = WeightSoa(mid_rot_ms, s_weight);
+  const math::SimdFloat4 start_soa[4] = {start_weighted.x, start_weighted.y,
+                                         start_weighted.z, start_weighted.w};
+  const math::SimdFloat4 mid_soa[4] = {mid_weighted.x, mid_weighted.y,
+                                       mid_weighted.z, mid_weighted.w};
+  math::SimdFloat4 start_aos[4];
+  math::SimdFloat4 mid_aos[4];
+  math::Transpose4x4(start_soa, start_aos);
+  math::Transpose4x4(mid_soa, mid_aos);
+  const int reached_mask = math::MoveMask(
+      math::And(reached, math::CmpGe(s_weight, one)));
+  for (size_t l = 0; l < 4 && _first + l < count; ++l) {
+    _job.start_joint_corrections[_first + l].xyzw = start_aos[l];
+    _job.mid_joint_corrections[_first + l].xyzw = mid_aos[l];
+    if (_job.reached.begin) {
+      _job.reached[_first + l] = (reached_mask & (1 << l)) != 0;
+    }
+  }
+}
+}  // namespace
+
+bool IKTwoBoneBatchJob::Run() const {
+  if (!Validate()) {
+    return false;
+  }
+
+  // Solves chains 4 by 4.
+  for (size_t i = 0; i < targets.count(); i += 4) {
+    SolveSoa(*this, i);
+  }
+  return true;
+}
+}  // namespace animation
+}  // namespace ozz
@@ -0,0 +1,232 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#include "ozz/animation/runtime/inertialization_job.h"
+
+#include "ozz/base/maths/soa_quaternion.h"
+#include "ozz/base/maths/soa_transform.h"
+
+namespace ozz {
+namespace animation {
+
+namespace {
+// Shortest decay duration, which prevents polynomial coefficients from
+// overflowing.
+const float kMinDecayDuration = 1e-3f;
+
+// Splits _v into a unit axis and its _length. Null vectors get a null axis,
+// so that any velocity projected on it is null too.
+OZZ_INLINE math::SoaFloat3 SafeAxis(const math::SoaFloat3& _v,
+                                    math::SimdFloat4* _length) {
+  const math::SimdFloat4 zero = math::simd_float4::zero();
+  const math::SimdFloat4 len = math::Length(_v);
+  const math::SimdInt4 valid = math::CmpGt(len, zero);
+  const math::SimdFloat4 rcp_len =
+      math::Select(valid, math::simd_float4::one() / len, zero);
+  *_length = len;
+  return _v * rcp_len;
+}
+
+// Computes the rotation between _from and _to quaternions, along the shortest
+// path. The returned quaternion w is positive.
+OZZ_INLINE math::SoaQuaternion ShortestRotation(
+    const math::SoaQuaternion& _to, const math::SoaQuaternion& _from) {
+  const math::SoaQuaternion q = _to * math::Conjugate(_from);
+  const math::SimdInt4 sign = math::Sign(q.w);
+  const math::SoaQuaternion r = {math::Xor(q.x, sign), math::Xor(q.y, sign),
+                                 math::Xor(q.z, sign), math::Xor(q.w, sign)};
+  return r;
+}
+
+// Splits rotation _q (with a positive w) into a unit axis and an _angle.
+OZZ_INLINE math::SoaFloat3 RotationAxis(const math::SoaQuaternion& _q,
+                                        math::SimdFloat4* _angle) {
+  const math::SimdFloat4 one = math::simd_float4::one();
+  const math::SimdFloat4 two = math::simd_float4::Load1(2.f);
+  *_angle = two * math::ACos(math::Min(_q.w, one));
+  const math::SoaFloat3 v = {_q.x, _q.y, _q.z};
+  math::SimdFloat4 sin_half_angle;
+  return SafeAxis(v, &sin_half_angle);
+}
+
+// Captures the decay of offset _x0 (positive), moving at _v0 along its axis.
+// A velocity moving the offset away from zero is cancelled, as it would
+// overshoot. Decay is shortened if velocity would otherwise make the offset
+// cross zero before _duration.
+OZZ_INLINE void CaptureDecay(math::SimdFloat4 _x0, math::SimdFloat4 _v0,
+                             math::SimdFloat4 _duration,
+                             math::SimdFloat4* _velocity,
+                             math::SimdFloat4* _decay_duration) {
+  const math::SimdFloat4 zero = math::simd_float4::zero();
+  const math::SimdFloat4 v0 = math::Min(_v0, zero);
+  const math::SimdInt4 approaching = math::CmpLt(v0, zero);
+  const math::SimdFloat4 crossing =
+      math::simd_float4::Load1(-5.f) * _x0 /
+      math::Select(approaching, v0, math::simd_float4::one());
+  const math::SimdFloat4 duration =
+      math::Select(approaching, math::Min(_duration, crossing), _duration);
+  *_velocity = v0;
+  *_decay_duration =
+      math::Max(duration, math::simd_float4::Load1(kMinDecayDuration));
+}
+
+// Evaluates the offset decayed at time _t, from its initial value _x0,
+// velocity _v0 and decay _duration. The quintic polynomial reaches zero with
+// null velocity and acceleration at _duration, and is expressed in normalized
+// time u = _t / _duration.
+OZZ_INLINE math::SimdFloat4 EvaluateDecay(math::SimdFloat4 _x0,
+                                          math::SimdFloat4 _v0,
+                                          math::SimdFloat4 _duration,
+                                          math::SimdFloat4 _t) {
+  const math::SimdFloat4 zero = math::simd_float4::zero();
+  const math::SimdFloat4 half = math::simd_float4::Load1(.5f);
+  const math::SimdFloat4 u =
+      math::Min(_t / _duration, math::simd_float4::one());
+  const math::SimdFloat4 x = _x0;
+  const math::SimdFloat4 v = _v0 * _duration;
+  const math::SimdFloat4 a = math::Max0(math::simd_float4::Load1(-8.f) * v -
+                                        math::simd_float4::Load1(20.f) * x);
+  const math::SimdFloat4 c5 =
+      -half * (a + math::simd_float4::Load1(6.f) * v +
+               math::simd_float4::Load1(12.f) * x);
+  const math::SimdFloat4 c4 =
+      half * (math::simd_float4::Load1(3.f) * a +
+              math::simd_float4::Load1(16.f) * v +
+              math::simd_float4::Load1(30.f) * x);
+  const math::SimdFloat4 c3 =
+      -half * (math::simd_float4::Load1(3.f) * a +
+               math::simd_float4::Load1(12.f) * v +
+               math::simd_float4::Load1(20.f) * x);
+  const math::SimdFloat4 c2 = half * a;
+  const math::SimdFloat4 poly =
+      ((((c5 * u + c4) * u + c3) * u + c2) * u + v) * u + x;
+  return math::Select(math::CmpLt(_t, _duration), poly, zero);
+}
+}  // namespace
+
+InertializationJob::InertializationJob()
+    : dt(0.f), capture(false), duration(.2f), source_dt(0.f) {}
+
+bool InertializationJob::Validate() const {
+  bool valid = true;
+  valid &= dt >= 0.f;
+  valid &= states.count() >= output.count();
+  if (capture) {
+    valid &= duration > 0.f;
+    valid &= source_dt > 0.f;
+    valid &= source.count() >= output.count();
+    valid &= previous_source.count() >= output.count();
+  }
+  return valid;
+}
+
+bool InertializationJob::Run() const {
+  if (!Validate()) {
+    return false;
+  }
+
+  const math::SimdFloat4 half = math::simd_float4::Load1(.5f);
+  const math::SimdFloat4 rcp_source_dt =
+      math::simd_float4::Load1(capture ? 1.f / source_dt : 0.f);
+  const math::SimdFloat4 simd_duration = math::simd_float4::Load1(duration);
+
+  const size_t num_soa_joints = output.count();
+  for (size_t i = 0; i < num_soa_joints; ++i) {
+    math::SoaTransform& transform = output[i];
+    SoaInertializationState& state = states[i];
+
+    // Captures offsets from target pose to source pose, and source velocities
+    // along offsets axes.
+    if (capture) {
+      const math::SoaTransform& from = source[i];
+      const math::SoaTransform& prev = previous_source[i];
+
+      state.translation_axis = SafeAxis(
+          from.translation - transform.translation, &state.offsets[0]);
+      const math::SoaFloat3 linear_velocity =
+          (from.translation - prev.translation) * rcp_source_dt;
+      CaptureDecay(state.offsets[0],
+                   math::Dot(linear_velocity, state.translation_axis),
+                   simd_duration, &state.velocities[0], &state.durations[0]);
+
+      state.rotation_axis =
+          RotationAxis(ShortestRotation(from.rotation, transform.rotation),
+                       &state.offsets[1]);
+      math::SimdFloat4 delta_angle;
+      const math::SoaFloat3 delta_axis = RotationAxis(
+          ShortestRotation(from.rotation, prev.rotation), &delta_angle);
+      const math::SoaFloat3 angular_velocity =
+          delta_axis * (delta_angle * rcp_source_dt);
+      CaptureDecay(state.offsets[1],
+                   math::Dot(angular_velocity, state.rotation_axis),
+                   simd_duration, &state.velocities[1], &state.durations[1]);
+
+      state.scale_axis =
+          SafeAxis(from.scale - transform.scale, &state.offsets[2]);
+      const math::SoaFloat3 scale_velocity =
+          (from.scale - prev.scale) * rcp_source_dt;
+      CaptureDecay(state.offsets[2],
+                   math::Dot(scale_velocity, state.scale_axis), simd_duration,
+                   &state.velocities[2], &state.durations[2]);
+
+      state.elapsed = 0.f;
+    }
+
+    // Skips joints whose transition is over.
+    state.elapsed += dt;
+    const math::SimdFloat4 t = math::simd_float4::Load1(state.elapsed);
+    const math::SimdFloat4 longest = math::Max(
+        state.durations[0], math::Max(state.durations[1], state.durations[2]));
+    if (math::AreAllTrue(math::CmpGe(t, longest))) {
+      continue;
+    }
+
+    // Adds decayed offsets to the target pose.
+    const math::SimdFloat4 translation = EvaluateDecay(
+        state.offsets[0], state.velocities[0], state.durations[0], t);
+    transform.translation =
+        transform.translation + state.translation_axis * translation;
+
+    const math::SimdFloat4 half_angle =
+        half * EvaluateDecay(state.offsets[1], state.velocities[1],
+                             state.durations[1], t);
+    const math::SimdFloat4 sin_half_angle = math::Sin(half_angle);
+    const math::SoaQuaternion rotation = {
+        state.rotation_axis.x * sin_half_angle,
+        state.rotation_axis.y * sin_half_angle,
+        state.rotation_axis.z * sin_half_angle, math::Cos(half_angle)};
+    transform.rotation = rotation * transform.rotation;
+
+    const math::SimdFloat4 scale = EvaluateDecay(
+        state.offsets[2], state.velocities[2], state.durations[2], t);
+    transform.scale = transform.scale + state.scale_axis * scale;
+  }
+  return true;
+}
+}  // namespace animation
+}  // namespace ozz
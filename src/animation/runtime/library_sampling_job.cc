@@ -0,0 +1,168 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#include "ozz/animation/runtime/library_sampling_job.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+#include "ozz/animation/runtime/animation_library.h"
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/soa_transform.h"
+
+namespace ozz {
+namespace animation {
+
+LibrarySamplingJob::LibrarySamplingJob()
+    : ratio(0.f), library(NULL), clip(0) {}
+
+bool LibrarySamplingJob::Validate() const {
+  // Don't stop validation on the first failure, in order to make it easier
+  // to debug.
+  bool success = true;
+
+  // Test for NULL pointers.
+  if (!library) {
+    return false;
+  }
+  if (clip < 0 || clip >= library->num_clips()) {
+    return false;
+  }
+  success &= output.begin != NULL;
+
+  // Tests output range, output data are not tested.
+  const ptrdiff_t num_soa_tracks = (library->clip(clip).num_tracks + 3) / 4;
+  success &= output.end - output.begin >= num_soa_tracks;
+
+  return success;
+}
+
+namespace {
+// Soa transforms are made of 10 SimdFloat4, in this order: translation x, y,
+// z, rotation x, y, z, w and scale x, y, z.
+const int kTranslationComponent = 0;
+const int kRotationComponent = 3;
+const int kScaleComponent = 7;
+OZZ_STATIC_ASSERT(sizeof(math::SoaTransform) == sizeof(float) * 4 * 10);
+
+// Compares key time to a time, to search keys.
+template <typename _Key>
+bool KeyTimeLess(float _time, const _Key& _key) {
+  return _time < _key.time;
+}
+
+// Samples _channel at _time, and writes the result to lane _lane of the _n
+// soa components of _soa. _identity is the value of channels with no key.
+template <typename _Key, int _N>
+void SampleChannel(const LibraryChannel& _channel, const _Key* _keys,
+                   float _time, const float (&_identity)[_N], float* _soa,
+                   int _lane) {
+  float value[_N];
+  if (_channel.num_keys == 0) {
+    for (int c = 0; c < _N; ++c) {
+      value[c] = _identity[c];
+    }
+  } else {
+    // Finds the first key after _time.
+    const _Key* begin = _keys + _channel.first_key;
+    const _Key* end = begin + _channel.num_keys;
+    const _Key* right = std::upper_bound(begin, end, _time, KeyTimeLess<_Key>);
+    if (right == begin || right == end) {  // Clamps to first or last key.
+      const _Key& key = right == begin ? *begin : *(end - 1);
+      for (int c = 0; c < _N; ++c) {
+        value[c] = key.value[c];
+      }
+    } else {
+      const _Key& left = *(right - 1);
+      const float alpha = (_time - left.time) / (right->time - left.time);
+      for (int c = 0; c < _N; ++c) {
+        value[c] = left.value[c] + (right->value[c] - left.value[c]) * alpha;
+      }
+    }
+  }
+  for (int c = 0; c < _N; ++c) {
+    _soa[c * 4 + _lane] = value[c];
+  }
+}
+
+// Rotations are interpolated component wise like other channels, which
+// requires library keys to be in the same hemisphere, then normalized.
+void NormalizeRotation(float* _soa, int _lane) {
+  float* rotation = _soa + kRotationComponent * 4 + _lane;
+  const float len2 = rotation[0] * rotation[0] + rotation[4] * rotation[4] +
+                     rotation[8] * rotation[8] + rotation[12] * rotation[12];
+  const float inv_len = 1.f / std::sqrt(len2);
+  for (int c = 0; c < 4; ++c) {
+    rotation[c * 4] *= inv_len;
+  }
+}
+}  // namespace
+
+bool LibrarySamplingJob::Run() const {
+  if (!Validate()) {
+    return false;
+  }
+
+  const LibraryClip& desc = library->clip(clip);
+  const float time = math::Clamp(0.f, ratio, 1.f) * desc.duration;
+  const Range<const uint32_t> channels = library->clip_channels(clip);
+  const LibraryChannel* translations = library->translations().begin;
+  const LibraryChannel* rotations = library->rotations().begin;
+  const LibraryChannel* scales = library->scales().begin;
+  const LibraryFloat3Key* translation_keys =
+      library->translation_keys().begin;
+  const LibraryQuaternionKey* rotation_keys = library->rotation_keys().begin;
+  const LibraryFloat3Key* scale_keys = library->scale_keys().begin;
+
+  // Sets last soa transform to identity, so lanes with no track are valid.
+  const int num_soa_tracks = (desc.num_tracks + 3) / 4;
+  if (num_soa_tracks > 0) {
+    output.begin[num_soa_tracks - 1] = math::SoaTransform::identity();
+  }
+
+  const float kZero[3] = {0.f, 0.f, 0.f};
+  const float kIdentity[4] = {0.f, 0.f, 0.f, 1.f};
+  const float kOne[3] = {1.f, 1.f, 1.f};
+  for (int i = 0; i < desc.num_tracks; ++i) {
+    float* soa = reinterpret_cast<float*>(output.begin + i / 4);
+    const int lane = i & 3;
+    const uint32_t* track = channels.begin + i * 3;
+    SampleChannel(translations[track[0]], translation_keys, time, kZero,
+                  soa + kTranslationComponent * 4, lane);
+    SampleChannel(rotations[track[1]], rotation_keys, time, kIdentity,
+                  soa + kRotationComponent * 4, lane);
+    NormalizeRotation(soa, lane);
+    SampleChannel(scales[track[2]], scale_keys, time, kOne,
+                  soa + kScaleComponent * 4, lane);
+  }
+
+  return true;
+}
+}  // namespace animation
+}  // namespace ozz
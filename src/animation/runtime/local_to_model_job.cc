@@ -30,9 +30,11 @@
 #include <cassert>
 
 #include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/simd_affine.h"
 #include "ozz/base/maths/simd_math.h"
 #include "ozz/base/maths/soa_float4x4.h"
 #include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/profile.h"
 
 #include "ozz/animation/runtime/skeleton.h"
 
@@ -62,52 +64,335 @@ bool LocalToModelJob::Validate() const {
 
   // Test input and output ranges, implicitly tests for NULL end pointers.
   valid &= input.end - input.begin >= num_soa_joints;
-  valid &= output.end - output.begin >= num_joints;
+  if (soa_output.begin != NULL) {
+    // Soa output mode updates the whole hierarchy.
+    valid &= soa_output.end - soa_output.begin >= num_soa_joints;
+    valid &= from == Skeleton::kNoParent;
+    valid &= to >= Skeleton::kMaxJoints;
+    valid &= !from_excluded;
+  } else if (affine_output.begin != NULL) {
+    valid &= affine_output.end - affine_output.begin >= num_joints;
+  } else {
+    valid &= output.end - output.begin >= num_joints;
+  }
+
+  // Skinning output requires inverse bind poses for every output matrix, and
+  // valid sorted joint remaps if any.
+  if (skinning_output.begin != NULL) {
+    valid &= soa_output.begin == NULL;
+    if (joint_remaps.begin == NULL) {
+      valid &= skinning_output.end - skinning_output.begin >= num_joints;
+      valid &= inverse_bind_poses.end - inverse_bind_poses.begin >= num_joints;
+    } else {
+      const ptrdiff_t num_remaps = joint_remaps.end - joint_remaps.begin;
+      valid &= skinning_output.end - skinning_output.begin >= num_remaps;
+      valid &= inverse_bind_poses.end - inverse_bind_poses.begin >= num_remaps;
+      for (const uint16_t* remap = joint_remaps.begin;
+           valid && remap < joint_remaps.end; ++remap) {
+        valid &= *remap < num_joints;
+        valid &= remap == joint_remaps.begin || remap[-1] <= *remap;
+      }
+    }
+  }
+
+  // Dirty joints mode replaces "from" and "to" parameters, and isn't supported
+  // with soa output. Dirty joints must be valid and sorted.
+  if (dirty_joints.begin != NULL) {
+    valid &= soa_output.begin == NULL;
+    valid &= from == Skeleton::kNoParent;
+    valid &= to >= Skeleton::kMaxJoints;
+    valid &= !from_excluded;
+    valid &= dirty_joints.begin <= dirty_joints.end;
+    for (const int* dirty = dirty_joints.begin;
+         valid && dirty < dirty_joints.end; ++dirty) {
+      valid &= *dirty >= 0 && *dirty < num_joints;
+      valid &= dirty == dirty_joints.begin || dirty[-1] < *dirty;
+    }
+  }
+
+  // Required joints mask must cover all joints.
+  if (required_joints.begin != NULL) {
+    valid &= soa_output.begin == NULL;
+    valid &= required_joints.end - required_joints.begin >= num_joints;
+  }
 
   return valid;
 }
 
-bool LocalToModelJob::Run() const {
-  if (!Validate()) {
-    return false;
+namespace {
+// Converts a splatted aos matrix to soa format.
+math::SoaFloat4x4 SplatToSoa(const math::Float4x4& _m) {
+  math::SoaFloat4x4 soa;
+  for (int i = 0; i < 4; ++i) {
+    const math::SoaFloat4 col = {
+        math::SplatX(_m.cols[i]), math::SplatY(_m.cols[i]),
+        math::SplatZ(_m.cols[i]), math::SplatW(_m.cols[i])};
+    soa.cols[i] = col;
   }
+  return soa;
+}
 
-  const Range<const int16_t>& parents = skeleton->joint_parents();
+// Applies hierarchical transformation to the whole hierarchy, in soa format.
+void RunSoa(const LocalToModelJob& _job, const math::Float4x4& _root) {
+  const Range<const int16_t>& parents = _job.skeleton->joint_parents();
+  const int num_joints = _job.skeleton->num_joints();
 
-  // Initializes an identity matrix that will be used to compute roots model
-  // matrices without requiring a branch.
-  const math::Float4x4 identity = math::Float4x4::identity();
-  const math::Float4x4* root_matrix = (root == NULL) ? &identity : root;
+  // Caches the last soa output element converted to aos, as consecutive joints
+  // usually have parents in the same soa element.
+  int cached = -1;
+  math::Float4x4 cached_aos_matrices[4];
+
+  for (int first = 0; first < num_joints; first += 4) {
+    const int soa_end = math::Min(first + 4, num_joints);
 
-  // Applies hierarchical transformation.
-  // Loop ends after "to".
-  const int end = math::Min(to + 1, skeleton->num_joints());
-  // Begins iteration from "from", or the next joint if "from" is excluded.
-  // Process next joint if end is not reach. parents[begin] >= from is true as
-  // long as "begin" is a child of "from".
-  for (int i = math::Max(from + from_excluded, 0),
-           process = i < end && (!from_excluded || parents[i] >= from);
-       process;) {
     // Builds soa matrices from soa transforms.
-    const math::SoaTransform& transform = input.begin[i / 4];
+    const math::SoaTransform& transform = _job.input.begin[first / 4];
     const math::SoaFloat4x4 local_soa_matrices = math::SoaFloat4x4::FromAffine(
         transform.translation, transform.rotation, transform.scale);
+    math::SoaFloat4x4& model_soa_matrices = _job.soa_output.begin[first / 4];
 
-    // Converts to aos matrices.
+    // Tests whether all joints share the same parent, which must be complete
+    // (not part of the same soa element).
+    const int parent = parents[first];
+    bool shared = true;
+    for (int i = first + 1; i < soa_end; ++i) {
+      shared &= parents[i] == parent;
+    }
+    if (shared) {
+      const math::Float4x4* parent_matrix = &_root;
+      if (parent != Skeleton::kNoParent) {
+        if (parent / 4 != cached) {
+          cached = parent / 4;
+          math::Transpose16x16(&_job.soa_output.begin[cached].cols[0].x,
+                               cached_aos_matrices->cols);
+        }
+        parent_matrix = &cached_aos_matrices[parent & 3];
+      }
+      model_soa_matrices = SplatToSoa(*parent_matrix) * local_soa_matrices;
+      continue;
+    }
+
+    // Otherwise processes joints one by one in aos format.
     math::Float4x4 local_aos_matrices[4];
     math::Transpose16x16(&local_soa_matrices.cols[0].x,
                          local_aos_matrices->cols);
+    math::Float4x4 model_aos_matrices[4];
+    for (int i = first; i < first + 4; ++i) {
+      // Padding joints are considered as roots.
+      const int joint_parent = i < soa_end ? parents[i] : Skeleton::kNoParent;
+      const math::Float4x4* parent_matrix = &_root;
+      if (joint_parent >= first) {
+        parent_matrix = &model_aos_matrices[joint_parent & 3];
+      } else if (joint_parent != Skeleton::kNoParent) {
+        if (joint_parent / 4 != cached) {
+          cached = joint_parent / 4;
+          math::Transpose16x16(&_job.soa_output.begin[cached].cols[0].x,
+                               cached_aos_matrices->cols);
+        }
+        parent_matrix = &cached_aos_matrices[joint_parent & 3];
+      }
+      model_aos_matrices[i & 3] = *parent_matrix * local_aos_matrices[i & 3];
+    }
+    for (int i = 0; i < 4; ++i) {
+      const math::SimdFloat4 cols[4] = {
+          model_aos_matrices[0].cols[i], model_aos_matrices[1].cols[i],
+          model_aos_matrices[2].cols[i], model_aos_matrices[3].cols[i]};
+      math::Transpose4x4(cols, &model_soa_matrices.cols[i].x);
+    }
+  }
+}
+
+// Accesses model-space matrices output as Float4x4.
+struct Float4x4Output {
+  explicit Float4x4Output(const Range<math::Float4x4>& _output)
+      : output(_output) {}
+  const math::Float4x4& Load(int _joint) const { return output[_joint]; }
+  void Store(int _joint, const math::Float4x4& _matrix) {
+    output[_joint] = _matrix;
+  }
+  Range<math::Float4x4> output;
+};
+
+// Accesses model-space matrices output as Float3x4.
+struct Float3x4Output {
+  explicit Float3x4Output(const Range<math::Float3x4>& _output)
+      : output(_output) {}
+  math::Float4x4 Load(int _joint) const {
+    return math::ToFloat4x4(output[_joint]);
+  }
+  void Store(int _joint, const math::Float4x4& _matrix) {
+    output[_joint] = math::ToFloat3x4(_matrix);
+  }
+  Range<math::Float3x4> output;
+};
+
+// Decorates _Output so that skinning matrices are also output, in the same
+// pass as model-space matrices. Joints must be stored in increasing order, so
+// that joint remaps can be iterated linearly.
+template <typename _Output>
+struct SkinningOutput {
+  SkinningOutput(_Output* _output, const LocalToModelJob& _job)
+      : output(_output),
+        skinning_output(_job.skinning_output),
+        inverse_bind_poses(_job.inverse_bind_poses),
+        joint_remaps(_job.joint_remaps),
+        remap(_job.joint_remaps.begin) {}
+  math::Float4x4 Load(int _joint) const { return output->Load(_joint); }
+  void Store(int _joint, const math::Float4x4& _matrix) {
+    output->Store(_joint, _matrix);
+    if (joint_remaps.begin == NULL) {
+      skinning_output[_joint] = _matrix * inverse_bind_poses[_joint];
+      return;
+    }
+    // Skips mesh joints whose skeleton joint wasn't updated. Then outputs all
+    // mesh joints remapped to this skeleton joint.
+    for (; remap < joint_remaps.end && *remap < _joint; ++remap) {
+    }
+    for (; remap < joint_remaps.end && *remap == _joint; ++remap) {
+      const size_t index = remap - joint_remaps.begin;
+      skinning_output[index] = _matrix * inverse_bind_poses[index];
+    }
+  }
+  _Output* output;
+  Range<math::Float4x4> skinning_output;
+  Range<const math::Float4x4> inverse_bind_poses;
+  Range<const uint16_t> joint_remaps;
+  const uint16_t* remap;
+};
+
+// Builds the 4 aos local matrices of soa transform _transform.
+void ToAosMatrices(const math::SoaTransform& _transform,
+                   math::Float4x4 _matrices[4]) {
+  // Builds soa matrices from soa transforms.
+  const math::SoaFloat4x4 local_soa_matrices = math::SoaFloat4x4::FromAffine(
+      _transform.translation, _transform.rotation, _transform.scale);
 
-    // parents[i] >= from is true as long as "i" is a child of "from".
-    for (const int soa_end = (i + 4) & ~3; i < soa_end && process;
-         ++i, process = i < end && parents[i] >= from) {
+  // Converts to aos matrices.
+  math::Transpose16x16(&local_soa_matrices.cols[0].x, _matrices->cols);
+}
+
+// Applies hierarchical transformation to all joints of [_begin,_end[ range, to
+// _output. Parents of the range joints must have already been updated.
+template <typename _Output>
+void RunAosRange(const LocalToModelJob& _job, const math::Float4x4& _root,
+                 _Output* _output, int _begin, int _end) {
+  const Range<const int16_t>& parents = _job.skeleton->joint_parents();
+  const Range<const int16_t>& subtree_ends =
+      _job.skeleton->joint_subtree_ends();
+  const bool* required = _job.required_joints.begin;
+  for (int i = _begin; i < _end;) {
+    // Skips subtrees that aren't required, as none of their joints are.
+    if (required && !required[i]) {
+      i = subtree_ends[i];
+      continue;
+    }
+
+    math::Float4x4 local_aos_matrices[4];
+    ToAosMatrices(_job.input.begin[i / 4], local_aos_matrices);
+
+    for (const int soa_end = math::Min((i + 4) & ~3, _end); i < soa_end; ++i) {
+      if (required && !required[i]) {
+        continue;
+      }
       const int parent = parents[i];
-      const math::Float4x4* parent_matrix =
-          parent == Skeleton::kNoParent ? root_matrix : &output[parent];
-      output[i] = *parent_matrix * local_aos_matrices[i & 3];
+      const math::Float4x4 parent_matrix =
+          parent == Skeleton::kNoParent ? _root : _output->Load(parent);
+      _output->Store(i, parent_matrix * local_aos_matrices[i & 3]);
+    }
+  }
+}
+
+// Applies hierarchical transformation, from "from" to "to" joints, to _output.
+// As joints are stored in depth-first order, "from" subtree is the contiguous
+// range of joints [from, joint_subtree_ends()[from][, so its bounds are known
+// without walking the hierarchy.
+template <typename _Output>
+void RunAos(const LocalToModelJob& _job, const math::Float4x4& _root,
+            _Output* _output) {
+  const int num_joints = _job.skeleton->num_joints();
+  int begin = 0;
+  int end = num_joints;
+  if (_job.from >= 0) {
+    if (_job.from >= num_joints) {
+      return;
     }
+    begin = _job.from + _job.from_excluded;
+    end = _job.skeleton->joint_subtree_ends()[_job.from];
+  }
+  // Loop ends after "to".
+  end = math::Min(end, _job.to + 1);
+  RunAosRange(_job, _root, _output, begin, end);
+}
+
+// Applies hierarchical transformation to all dirty joints and their
+// descendants, to _output. As dirty joints are sorted, their subtrees are
+// either disjoint or nested, which allows to merge them in a single ordered
+// pass over the hierarchy.
+template <typename _Output>
+void RunAosDirty(const LocalToModelJob& _job, const math::Float4x4& _root,
+                 _Output* _output) {
+  const Range<const int16_t>& subtree_ends =
+      _job.skeleton->joint_subtree_ends();
+  int processed_end = 0;
+  for (const int* dirty = _job.dirty_joints.begin;
+       dirty < _job.dirty_joints.end; ++dirty) {
+    const int end = subtree_ends[*dirty];
+    if (end > processed_end) {
+      RunAosRange(_job, _root, _output, math::Max(*dirty, processed_end), end);
+      processed_end = end;
+    }
+  }
+}
+
+// Dispatches to dirty joints or from/to update modes.
+template <typename _Output>
+void RunAosMode(const LocalToModelJob& _job, const math::Float4x4& _root,
+                _Output* _output) {
+  if (_job.dirty_joints.begin != NULL) {
+    RunAosDirty(_job, _root, _output);
+  } else {
+    RunAos(_job, _root, _output);
   }
+}
+
+// Dispatches with or without skinning output.
+template <typename _Output>
+void RunAosOutput(const LocalToModelJob& _job, const math::Float4x4& _root,
+                  _Output _output) {
+  if (_job.skinning_output.begin != NULL) {
+    SkinningOutput<_Output> skinning_output(&_output, _job);
+    RunAosMode(_job, _root, &skinning_output);
+  } else {
+    RunAosMode(_job, _root, &_output);
+  }
+}
+}  // namespace
+
+bool LocalToModelJob::Run() const {
+  if (!Validate()) {
+    return false;
+  }
+  RunUnchecked();
   return true;
 }
+
+void LocalToModelJob::RunUnchecked() const {
+  OZZ_PROFILE_ZONE("ozz::LocalToModelJob::Run");
+  assert(Validate() && "Invalid job, see LocalToModelJob::Validate().");
+
+  // Initializes an identity matrix that will be used to compute roots model
+  // matrices without requiring a branch.
+  const math::Float4x4 identity = math::Float4x4::identity();
+  const math::Float4x4* root_matrix = (root == NULL) ? &identity : root;
+
+  // Dispatches according to output mode.
+  if (soa_output.begin != NULL) {
+    RunSoa(*this, *root_matrix);
+  } else if (affine_output.begin != NULL) {
+    RunAosOutput(*this, *root_matrix, Float3x4Output(affine_output));
+  } else {
+    RunAosOutput(*this, *root_matrix, Float4x4Output(output));
+  }
+}
 }  // namespace animation
 }  // namespace ozz
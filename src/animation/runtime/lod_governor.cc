@@ -0,0 +1,182 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/lod_governor.h"
+
+#include <cassert>
+#include <cmath>
+
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/animation/runtime/skeleton_utils.h"
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/memory/allocator.h"
+
+namespace ozz {
+namespace animation {
+
+LODGovernor::LODGovernor()
+    : budget(1.f / 500.f),
+      smoothing(.1f),
+      num_levels_(0),
+      entries_(NULL),
+      masks_(NULL),
+      mask_size_(0),
+      frame_(0),
+      planned_cost_(0.f) {}
+
+LODGovernor::~LODGovernor() { Deallocate(); }
+
+void LODGovernor::Deallocate() {
+  memory::Allocator* allocator = memory::default_allocator();
+  allocator->Deallocate(entries_);
+  entries_ = NULL;
+  allocator->Deallocate(masks_);
+  masks_ = NULL;
+  num_levels_ = 0;
+  mask_size_ = 0;
+}
+
+bool LODGovernor::Initialize(const Skeleton& _skeleton,
+                             const Range<const Level>& _levels,
+                             float _initial_cost) {
+  Deallocate();
+  frame_ = 0;
+  planned_cost_ = 0.f;
+
+  const int num_levels = static_cast<int>(_levels.count());
+  const int num_joints = _skeleton.num_joints();
+  if (num_levels == 0 || num_joints == 0 || _initial_cost < 0.f) {
+    return false;
+  }
+  for (int i = 0; i < num_levels; ++i) {
+    const Level& level = _levels[i];
+    if (level.lod < 0 || level.lod >= _skeleton.num_lods() ||
+        level.update_interval < 1) {
+      return false;
+    }
+  }
+
+  memory::Allocator* allocator = memory::default_allocator();
+  mask_size_ = (_skeleton.num_soa_joints() + 7) / 8;
+  entries_ = reinterpret_cast<Entry*>(
+      allocator->Allocate(sizeof(Entry) * num_levels, OZZ_ALIGN_OF(Entry)));
+  masks_ = reinterpret_cast<uint8_t*>(
+      allocator->Allocate(mask_size_ * num_levels, OZZ_ALIGN_OF(uint8_t)));
+  num_levels_ = num_levels;
+
+  for (int i = 0; i < num_levels; ++i) {
+    Entry& entry = entries_[i];
+    entry.level = _levels[i];
+    entry.num_joints = _skeleton.lod_num_joints(entry.level.lod);
+    entry.cost = _initial_cost * entry.num_joints / num_joints;
+    GetLODSamplingMask(_skeleton, entry.level.lod,
+                       Range<uint8_t>(masks_ + mask_size_ * i, mask_size_));
+  }
+  return true;
+}
+
+bool LODGovernor::Measure(int _level, int _count, float _seconds) {
+  if (_level < 0 || _level >= num_levels_ || _count <= 0) {
+    return false;
+  }
+  float& cost = entries_[_level].cost;
+  cost = math::Lerp(cost, _seconds / _count, smoothing);
+  return true;
+}
+
+float LODGovernor::cost(int _level) const {
+  assert(_level >= 0 && _level < num_levels_ && "_level index out of range");
+  return entries_[_level].cost;
+}
+
+float LODGovernor::Plan(const Range<const float>& _priorities,
+                        float _threshold, Decision* _decisions) const {
+  const int last = num_levels_ - 1;
+  float frame_cost = 0.f;
+  for (size_t i = 0; i < _priorities.count(); ++i) {
+    const float priority = _priorities[i];
+    const float steps = priority > 0.f ? std::floor(_threshold / priority)
+                                       : static_cast<float>(last);
+    const int level = steps < last ? static_cast<int>(steps) : last;
+    const Entry& entry = entries_[level];
+    frame_cost += entry.cost / entry.level.update_interval;
+
+    if (_decisions) {
+      Decision& decision = _decisions[i];
+      decision.level = level;
+      decision.lod = entry.level.lod;
+      decision.num_joints = entry.num_joints;
+      decision.mask =
+          Range<const uint8_t>(masks_ + mask_size_ * level, mask_size_);
+      decision.skinning = entry.level.skinning;
+      decision.update =
+          (frame_ + static_cast<unsigned int>(i)) %
+              static_cast<unsigned int>(entry.level.update_interval) ==
+          0;
+    }
+  }
+  return frame_cost;
+}
+
+bool LODGovernor::Run(const Range<const float>& _priorities,
+                      const Range<Decision>& _decisions) {
+  if (num_levels_ == 0 || _decisions.count() < _priorities.count()) {
+    return false;
+  }
+  float max_priority = 0.f;
+  for (size_t i = 0; i < _priorities.count(); ++i) {
+    if (_priorities[i] < 0.f) {
+      return false;
+    }
+    max_priority = math::Max(max_priority, _priorities[i]);
+  }
+
+  // Instances levels only increase with the threshold, so the lowest
+  // threshold that fits the budget is found by bisection. Above max_threshold
+  // all instances are at the cheapest level.
+  float threshold = 0.f;
+  if (Plan(_priorities, 0.f, NULL) > budget) {
+    const float max_threshold = max_priority * num_levels_;
+    float low = 0.f;
+    threshold = max_threshold;
+    if (Plan(_priorities, max_threshold, NULL) <= budget) {
+      for (int i = 0; i < 32; ++i) {
+        const float mid = (low + threshold) * .5f;
+        if (Plan(_priorities, mid, NULL) > budget) {
+          low = mid;
+        } else {
+          threshold = mid;
+        }
+      }
+    }
+  }
+  planned_cost_ = Plan(_priorities, threshold, _decisions.begin);
+  ++frame_;
+  return true;
+}
+}  // namespace animation
+}  // namespace ozz
@@ -0,0 +1,174 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/memory_usage.h"
+
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/animation_instance.h"
+#include "ozz/animation/runtime/sampling_job.h"
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/soa_transform.h"
+
+#include <cstring>
+
+namespace ozz {
+namespace animation {
+
+namespace {
+// Gets the size of _name, including its null terminating character, or 0 if
+// there's no name.
+size_t NameSize(const char* _name) {
+  return *_name != 0 ? std::strlen(_name) + 1 : 0;
+}
+
+template <typename _Track>
+MemoryUsage GetTrackMemoryUsage(const _Track& _track) {
+  MemoryUsage usage;
+  usage.data =
+      _track.ratios().size() + _track.values().size() + _track.steps().size();
+  usage.metadata = sizeof(_Track) + NameSize(_track.name());
+  return usage;
+}
+}  // namespace
+
+MemoryUsage GetMemoryUsage(const Animation& _animation) {
+  MemoryUsage usage;
+  usage.data = _animation.translations().size() +
+               _animation.rotations().size() + _animation.scales().size() +
+               _animation.translation_values().size() +
+               _animation.scale_values().size() +
+               _animation.translation_tangents().size() +
+               _animation.rotation_tangents().size() +
+               _animation.scale_tangents().size() +
+               _animation.translation_times().size() +
+               _animation.rotation_times().size() +
+               _animation.scale_times().size();
+  usage.metadata = sizeof(Animation) + NameSize(_animation.name()) +
+                   _animation.translation_ranges().size() +
+                   _animation.scale_ranges().size() +
+                   _animation.translation_value_offsets().size() +
+                   _animation.scale_value_offsets().size() +
+                   _animation.seek_ratios().size() +
+                   _animation.seek_keys().size() +
+                   _animation.sync_ratios().size() +
+                   _animation.bounds().size() + _animation.steps().size() +
+                   _animation.soa_joints().size() +
+                   _animation.translation_key_lods().size() +
+                   _animation.rotation_key_lods().size() +
+                   _animation.scale_key_lods().size() +
+                   _animation.translation_lod_next().size() +
+                   _animation.rotation_lod_next().size() +
+                   _animation.scale_lod_next().size();
+  return usage;
+}
+
+MemoryUsage GetMemoryUsage(const Skeleton& _skeleton) {
+  MemoryUsage usage;
+  usage.data = _skeleton.joint_bind_poses().size();
+  usage.metadata = sizeof(Skeleton) + _skeleton.joint_parents().size() +
+                   _skeleton.joint_subtree_ends().size() +
+                   _skeleton.joint_depths().size() +
+                   _skeleton.joint_child_counts().size() +
+                   // Levels joints and ends, as big as depths.
+                   _skeleton.joint_depths().size() * 2 +
+                   _skeleton.joint_name_hashes().size() +
+                   _skeleton.joint_lods().size() +
+                   _skeleton.joint_names().size();
+  const Range<const char* const> names = _skeleton.joint_names();
+  for (const char* const* it = names.begin; it < names.end; ++it) {
+    usage.metadata += NameSize(*it);
+  }
+  return usage;
+}
+
+MemoryUsage GetMemoryUsage(const SamplingCache& _cache) {
+  MemoryUsage usage;
+  usage.data = _cache.max_tracks() > 0 ? SamplingCache::AllocationSize(
+                                             _cache.max_tracks(), _cache.mode())
+                                       : 0;
+  usage.metadata = sizeof(SamplingCache);
+  return usage;
+}
+
+MemoryUsage GetMemoryUsage(const AnimationInstance& _instance) {
+  MemoryUsage usage;
+  usage.data = _instance.size() - sizeof(AnimationInstance);
+  usage.metadata = sizeof(AnimationInstance);
+  return usage;
+}
+
+MemoryUsage GetMemoryUsage(const FloatTrack& _track) {
+  return GetTrackMemoryUsage(_track);
+}
+
+MemoryUsage GetMemoryUsage(const Float2Track& _track) {
+  return GetTrackMemoryUsage(_track);
+}
+
+MemoryUsage GetMemoryUsage(const Float3Track& _track) {
+  return GetTrackMemoryUsage(_track);
+}
+
+MemoryUsage GetMemoryUsage(const Float4Track& _track) {
+  return GetTrackMemoryUsage(_track);
+}
+
+MemoryUsage GetMemoryUsage(const QuaternionTrack& _track) {
+  return GetTrackMemoryUsage(_track);
+}
+
+MemoryUsage ComputeWorkingSetUsage(const Skeleton& _skeleton,
+                                   const Animation& _animation,
+                                   int _num_layers) {
+  MemoryUsage usage;
+  if (_num_layers < 1) {
+    return usage;
+  }
+  const size_t num_layers = static_cast<size_t>(_num_layers);
+
+  // Per layer sampling cache and output.
+  const SamplingCache::Mode mode =
+      _animation.spline() ? SamplingCache::kSpline : SamplingCache::kFull;
+  const size_t pose_size =
+      sizeof(math::SoaTransform) * _skeleton.num_soa_joints();
+  usage.data = num_layers * (SamplingCache::AllocationSize(
+                                 _animation.num_tracks(), mode) +
+                             pose_size);
+  usage.metadata = num_layers * sizeof(SamplingCache);
+
+  // Blending output.
+  if (num_layers > 1) {
+    usage.data += pose_size;
+  }
+
+  // Model-space matrices.
+  usage.data += sizeof(math::Float4x4) * _skeleton.num_joints();
+  return usage;
+}
+}  // namespace animation
+}  // namespace ozz
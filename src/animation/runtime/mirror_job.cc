@@ -0,0 +1,144 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#include "ozz/animation/runtime/mirror_job.h"
+
+#include "ozz/base/maths/soa_transform.h"
+
+namespace ozz {
+namespace animation {
+
+MirrorJob::MirrorJob() : axis(kX) {}
+
+bool MirrorJob::Validate() const {
+  // Don't stop validation on the first failure, in order to make it easier
+  // to debug.
+  bool success = true;
+
+  // Test for NULL pointers, an empty mirror table is valid though.
+  success &= mirror.begin != NULL || mirror.end == NULL;
+  success &= input.begin != NULL;
+  success &= output.begin != NULL;
+
+  // Mirroring can't be done in place, as joints are swapped.
+  success &= input.begin != output.begin;
+
+  // Tests output range.
+  const ptrdiff_t num_joints = mirror.count();
+  success &= output.count() >= static_cast<size_t>((num_joints + 3) / 4);
+
+  // Tests mirror entries.
+  const ptrdiff_t num_input_joints = input.count() * 4;
+  for (const int* entry = mirror.begin; entry < mirror.end; ++entry) {
+    success &= *entry >= 0 && *entry < num_input_joints;
+  }
+
+  return success;
+}
+
+namespace {
+// Number of floats of a SoaTransform, which is made of 10 SimdFloat4:
+// translation x, y, z, rotation x, y, z, w and scale x, y, z.
+const int kNumSoaComponents = 10;
+OZZ_STATIC_ASSERT(sizeof(math::SoaTransform) ==
+                  sizeof(float) * 4 * kNumSoaComponents);
+
+// Copies lane _from of _input soa transform to lane _to of _output.
+void CopyMirrorLane(const math::SoaTransform& _input, int _from,
+                    math::SoaTransform* _output, int _to) {
+  const float* in = reinterpret_cast<const float*>(&_input);
+  float* out = reinterpret_cast<float*>(_output);
+  for (int c = 0; c < kNumSoaComponents; ++c) {
+    out[c * 4 + _to] = in[c * 4 + _from];
+  }
+}
+
+// Reflects 4 transforms by the plane of normal _Axis, where _Axis is the
+// index of the translation and rotation component along the normal.
+template <int _Axis>
+void Reflect(math::SoaTransform* _transform) {
+  math::SimdFloat4* translation = &_transform->translation.x;
+  math::SimdFloat4* rotation = &_transform->rotation.x;
+  translation[_Axis] = -translation[_Axis];
+  rotation[(_Axis + 1) % 3] = -rotation[(_Axis + 1) % 3];
+  rotation[(_Axis + 2) % 3] = -rotation[(_Axis + 2) % 3];
+}
+
+template <int _Axis>
+void ReflectAll(math::SoaTransform* _begin, math::SoaTransform* _end) {
+  for (math::SoaTransform* transform = _begin; transform < _end; ++transform) {
+    Reflect<_Axis>(transform);
+  }
+}
+}  // namespace
+
+bool MirrorJob::Run() const {
+  if (!Validate()) {
+    return false;
+  }
+
+  // Gathers mirror joints.
+  const int num_joints = static_cast<int>(mirror.count());
+  for (int i = 0; i < num_joints; i += 4) {
+    math::SoaTransform& soa_output = output.begin[i / 4];
+
+    // Copies the whole soa block if its joints are their own mirror.
+    if (i + 4 <= num_joints && mirror.begin[i] == i &&
+        mirror.begin[i + 1] == i + 1 && mirror.begin[i + 2] == i + 2 &&
+        mirror.begin[i + 3] == i + 3) {
+      soa_output = input.begin[i / 4];
+      continue;
+    }
+
+    // Otherwise copies joints one by one.
+    for (int j = i; j < i + 4 && j < num_joints; ++j) {
+      const int from = mirror.begin[j];
+      CopyMirrorLane(input.begin[from / 4], from & 3, &soa_output, j & 3);
+    }
+  }
+
+  // Reflects all soa joints at once.
+  math::SoaTransform* end = output.begin + (num_joints + 3) / 4;
+  switch (axis) {
+    case kY: {
+      ReflectAll<1>(output.begin, end);
+      break;
+    }
+    case kZ: {
+      ReflectAll<2>(output.begin, end);
+      break;
+    }
+    default: {
+      ReflectAll<0>(output.begin, end);
+      break;
+    }
+  }
+  return true;
+}
+}  // namespace animation
+}  // namespace ozz
@@ -0,0 +1,149 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/model_space_sampling_job.h"
+
+#include <cstring>
+
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/sampling_job.h"
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/soa_float4x4.h"
+#include "ozz/base/maths/soa_transform.h"
+
+namespace ozz {
+namespace animation {
+
+ModelSpaceSamplingJob::ModelSpaceSamplingJob()
+    : ratio(0.f), animation(NULL), cache(NULL), skeleton(NULL), root(NULL) {}
+
+namespace {
+// Size of the soa tracks mask buffer able to handle any skeleton.
+const int kMaskSize = (Skeleton::kMaxSoAJoints + 7) / 8;
+
+// Setups _job to sample _model_space job animation, using _mask soa tracks
+// mask (whose content isn't initialized).
+void SetupSampling(const ModelSpaceSamplingJob& _model_space,
+                   const uint8_t* _mask, SamplingJob* _job) {
+  _job->ratio = _model_space.ratio;
+  _job->animation = _model_space.animation;
+  _job->cache = _model_space.cache;
+  _job->output = _model_space.locals;
+  _job->mask.begin = _mask;
+  _job->mask.end = _mask + (_model_space.animation->num_soa_tracks() + 7) / 8;
+}
+}  // namespace
+
+bool ModelSpaceSamplingJob::Validate() const {
+  // Test for NULL pointers.
+  if (!animation || !skeleton) {
+    return false;
+  }
+  bool valid = true;
+
+  const int num_joints = skeleton->num_joints();
+  valid &= animation->num_tracks() == num_joints;
+  valid &= locals.end - locals.begin >= skeleton->num_soa_joints();
+  valid &= output.end - output.begin >= num_joints;
+
+  // Target joints must be part of the skeleton.
+  valid &= joints.begin != NULL || joints.end == NULL;
+  for (const int* joint = joints.begin; valid && joint < joints.end; ++joint) {
+    valid &= *joint >= 0 && *joint < num_joints;
+  }
+
+  // Validates sampling job, mask content doesn't matter.
+  const uint8_t mask[kMaskSize] = {0};
+  SamplingJob job;
+  SetupSampling(*this, mask, &job);
+  valid &= job.Validate();
+
+  return valid;
+}
+
+bool ModelSpaceSamplingJob::Run() const {
+  if (!Validate()) {
+    return false;
+  }
+
+  const Range<const int16_t>& parents = skeleton->joint_parents();
+
+  // Flags target joints and their ancestors, and the soa tracks they belong
+  // to. Parents always have a lower index than their children, so the joints
+  // to update end with the last target.
+  bool required[Skeleton::kMaxJoints];
+  std::memset(required, 0, sizeof(required));
+  uint8_t mask[kMaskSize] = {0};
+  int end = 0;
+  for (const int* joint = joints.begin; joint < joints.end; ++joint) {
+    end = math::Max(end, *joint + 1);
+    for (int i = *joint; i != Skeleton::kNoParent && !required[i];
+         i = parents[i]) {
+      required[i] = true;
+      mask[i / 32] |= 1 << ((i / 4) & 7);
+    }
+  }
+
+  // Samples required soa tracks only.
+  SamplingJob sampling_job;
+  SetupSampling(*this, mask, &sampling_job);
+  if (!sampling_job.Run()) {
+    return false;
+  }
+
+  // Initializes an identity matrix that will be used to compute roots model
+  // matrices without requiring a branch.
+  const math::Float4x4 identity = math::Float4x4::identity();
+  const math::Float4x4* root_matrix = (root == NULL) ? &identity : root;
+
+  // Applies hierarchical transformation to required joints. Local matrices
+  // are converted once per soa joint.
+  math::Float4x4 local_aos_matrices[4];
+  for (int i = 0, soa_converted = -1; i < end; ++i) {
+    if (!required[i]) {
+      continue;
+    }
+    if (i / 4 != soa_converted) {
+      soa_converted = i / 4;
+      const math::SoaTransform& transform = locals.begin[soa_converted];
+      const math::SoaFloat4x4 local_soa_matrices =
+          math::SoaFloat4x4::FromAffine(transform.translation,
+                                        transform.rotation, transform.scale);
+      math::Transpose16x16(&local_soa_matrices.cols[0].x,
+                           local_aos_matrices->cols);
+    }
+    const int parent = parents[i];
+    const math::Float4x4* parent_matrix =
+        parent == Skeleton::kNoParent ? root_matrix : &output.begin[parent];
+    output.begin[i] = *parent_matrix * local_aos_matrices[i & 3];
+  }
+  return true;
+}
+}  // namespace animation
+}  // namespace ozz
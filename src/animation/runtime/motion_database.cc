@@ -0,0 +1,230 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#include "ozz/animation/runtime/motion_database.h"
+
+#include "ozz/base/io/archive.h"
+#include "ozz/base/log.h"
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/memory/allocator.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+namespace ozz {
+namespace animation {
+
+MotionDatabase::MotionDatabase()
+    : num_frames_(0), num_features_(0), frequency_(0.f) {}
+
+MotionDatabase::~MotionDatabase() { Deallocate(); }
+
+void MotionDatabase::Allocate(int _num_frames, int _num_features,
+                              int _num_clips) {
+  memory::ScopedAllocationTag tag(memory::kTagAnimation);
+
+  assert(features_.size() == 0 && clip_begins_.size() == 0);
+  assert(_num_frames >= 0 && _num_features >= 0 && _num_clips >= 0);
+
+  num_frames_ = _num_frames;
+  num_features_ = _num_features;
+
+  // Distributes buffer memory while ensuring proper alignment (serves larger
+  // alignment values first). All float arrays are made of rows of stride()
+  // floats, so they're all simd aligned.
+  OZZ_STATIC_ASSERT(OZZ_ALIGN_OF(math::SimdFloat4) >= OZZ_ALIGN_OF(int));
+
+  const size_t row_size = stride() * sizeof(float);
+  const size_t num_blocks = (_num_frames + kBlockSize - 1) / kBlockSize;
+  const size_t num_large_blocks =
+      (_num_frames + kLargeBlockSize - 1) / kLargeBlockSize;
+  const size_t features_size = _num_frames * row_size;
+  const size_t bounds_size = num_blocks * 2 * row_size;
+  const size_t large_bounds_size = num_large_blocks * 2 * row_size;
+  const size_t clips_size = (_num_clips + 1) * sizeof(int);
+  const size_t buffer_size = features_size + bounds_size + large_bounds_size +
+                             row_size * 2 + clips_size;
+  char* buffer = reinterpret_cast<char*>(memory::default_allocator()->Allocate(
+      buffer_size, OZZ_ALIGN_OF(math::SimdFloat4)));
+
+  // Fix up pointers. Serves larger alignment values first.
+  features_.begin = reinterpret_cast<float*>(buffer);
+  assert(math::IsAligned(features_.begin, OZZ_ALIGN_OF(math::SimdFloat4)));
+  buffer += features_size;
+  features_.end = reinterpret_cast<float*>(buffer);
+
+  bounds_.begin = reinterpret_cast<float*>(buffer);
+  buffer += bounds_size;
+  bounds_.end = reinterpret_cast<float*>(buffer);
+
+  large_bounds_.begin = reinterpret_cast<float*>(buffer);
+  buffer += large_bounds_size;
+  large_bounds_.end = reinterpret_cast<float*>(buffer);
+
+  offsets_.begin = reinterpret_cast<float*>(buffer);
+  buffer += row_size;
+  offsets_.end = reinterpret_cast<float*>(buffer);
+
+  scales_.begin = reinterpret_cast<float*>(buffer);
+  buffer += row_size;
+  scales_.end = reinterpret_cast<float*>(buffer);
+
+  clip_begins_.begin = reinterpret_cast<int*>(buffer);
+  buffer += clips_size;
+  clip_begins_.end = reinterpret_cast<int*>(buffer);
+
+  // Padding features must be 0, so they don't contribute to matching costs.
+  std::memset(features_.begin, 0,
+              features_size + bounds_size + large_bounds_size + row_size * 2);
+}
+
+void MotionDatabase::Deallocate() {
+  // Deallocate everything at once.
+  memory::default_allocator()->Deallocate(features_.begin);
+
+  features_.Clear();
+  bounds_.Clear();
+  large_bounds_.Clear();
+  offsets_.Clear();
+  scales_.Clear();
+  clip_begins_.Clear();
+  num_frames_ = 0;
+  num_features_ = 0;
+  frequency_ = 0.f;
+}
+
+namespace {
+// Computes the bounds of every block of _block_size rows of _features.
+void ComputeBlockBounds(const float* _features, int _num_frames, int _stride,
+                        int _block_size, float* _bounds) {
+  const int num_blocks = (_num_frames + _block_size - 1) / _block_size;
+  for (int b = 0; b < num_blocks; ++b) {
+    const float* frame = _features + b * _block_size * _stride;
+    const float* end =
+        _features + math::Min((b + 1) * _block_size, _num_frames) * _stride;
+    float* min = _bounds + b * 2 * _stride;
+    float* max = min + _stride;
+    std::memcpy(min, frame, _stride * sizeof(float));
+    std::memcpy(max, frame, _stride * sizeof(float));
+    for (frame += _stride; frame < end; frame += _stride) {
+      for (int i = 0; i < _stride; ++i) {
+        min[i] = math::Min(min[i], frame[i]);
+        max[i] = math::Max(max[i], frame[i]);
+      }
+    }
+  }
+}
+}  // namespace
+
+void MotionDatabase::ComputeBounds() {
+  OZZ_STATIC_ASSERT(kLargeBlockSize % kBlockSize == 0);
+  ComputeBlockBounds(features_.begin, num_frames_, stride(), kBlockSize,
+                     bounds_.begin);
+  ComputeBlockBounds(features_.begin, num_frames_, stride(), kLargeBlockSize,
+                     large_bounds_.begin);
+}
+
+int MotionDatabase::FindClip(int _frame, float* _time) const {
+  if (_frame < 0 || _frame >= num_frames_) {
+    return -1;
+  }
+  // Finds the first clip beginning after _frame.
+  const int* begin = clip_begins_.begin;
+  const int* clip = std::upper_bound(begin, clip_begins_.end, _frame) - 1;
+  if (_time) {
+    *_time = (_frame - *clip) / frequency_;
+  }
+  return static_cast<int>(clip - begin);
+}
+
+bool MotionDatabase::Normalize(const Range<const float>& _raw,
+                               const Range<float>& _normalized) const {
+  if (_raw.count() < static_cast<size_t>(num_features_) ||
+      _normalized.count() < static_cast<size_t>(stride())) {
+    return false;
+  }
+  for (int i = 0; i < num_features_; ++i) {
+    _normalized[i] = (_raw[i] - offsets_[i]) * scales_[i];
+  }
+  for (int i = num_features_; i < stride(); ++i) {
+    _normalized[i] = 0.f;
+  }
+  return true;
+}
+
+size_t MotionDatabase::size() const {
+  const size_t size = sizeof(*this) + features_.size() + bounds_.size() +
+                      large_bounds_.size() + offsets_.size() + scales_.size() +
+                      clip_begins_.size();
+  return size;
+}
+
+void MotionDatabase::Save(ozz::io::OArchive& _archive) const {
+  _archive << static_cast<int32_t>(num_frames_);
+  _archive << static_cast<int32_t>(num_features_);
+  _archive << static_cast<int32_t>(num_clips());
+  _archive << frequency_;
+
+  _archive << ozz::io::MakeArray(offsets_);
+  _archive << ozz::io::MakeArray(scales_);
+  _archive << ozz::io::MakeArray(clip_begins_);
+  _archive << ozz::io::MakeArray(features_);
+}
+
+void MotionDatabase::Load(ozz::io::IArchive& _archive, uint32_t _version) {
+  // Destroy database in case it was already used before.
+  Deallocate();
+
+  if (_version != 1) {
+    log::Err() << "Unsupported MotionDatabase version " << _version << "."
+               << std::endl;
+    return;
+  }
+
+  int32_t num_frames;
+  _archive >> num_frames;
+  int32_t num_features;
+  _archive >> num_features;
+  int32_t num_clips;
+  _archive >> num_clips;
+
+  Allocate(num_frames, num_features, num_clips);
+
+  _archive >> frequency_;
+  _archive >> ozz::io::MakeArray(offsets_);
+  _archive >> ozz::io::MakeArray(scales_);
+  _archive >> ozz::io::MakeArray(clip_begins_);
+  _archive >> ozz::io::MakeArray(features_);
+
+  // Bounds aren't serialized, as they're computed from features.
+  ComputeBounds();
+}
+}  // namespace animation
+}  // namespace ozz
@@ -0,0 +1,202 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#include "ozz/animation/runtime/motion_matching_job.h"
+
+#include <limits>
+
+#include "ozz/animation/runtime/motion_database.h"
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/simd_math.h"
+
+namespace ozz {
+namespace animation {
+
+MotionMatchingJob::MotionMatchingJob()
+    : database(NULL),
+      accelerate(true),
+      max_cost(std::numeric_limits<float>::max()),
+      frame(NULL),
+      cost(NULL) {}
+
+bool MotionMatchingJob::Validate() const {
+  bool success = true;
+  success &= database != NULL;
+  success &= frame != NULL;
+  success &= cost != NULL;
+  if (!success) {
+    return false;
+  }
+  const size_t stride = static_cast<size_t>(database->stride());
+  success &= query.count() >= stride;
+  success &= weights.count() == 0 || weights.count() >= stride;
+  return success;
+}
+
+namespace {
+
+// Number of features accumulated before testing a row partial cost.
+const int kRowEarlyOut = 16;
+
+// Squares _diff, and weights it with _weights if _Weighted is true.
+template <bool _Weighted>
+OZZ_INLINE math::SimdFloat4 Square(math::_SimdFloat4 _diff,
+                                   const float* _weights);
+
+template <>
+OZZ_INLINE math::SimdFloat4 Square<false>(math::_SimdFloat4 _diff,
+                                          const float*) {
+  return _diff * _diff;
+}
+
+template <>
+OZZ_INLINE math::SimdFloat4 Square<true>(math::_SimdFloat4 _diff,
+                                         const float* _weights) {
+  return _diff * _diff * math::simd_float4::LoadPtrU(_weights);
+}
+
+// Computes the squared distance between _query and _row. Computation stops as
+// soon as it exceeds _best, in which case the partial distance is returned.
+template <bool _Weighted>
+float RowCost(const float* _query, const float* _row, const float* _weights,
+              int _stride, float _best) {
+  math::SimdFloat4 acc = math::simd_float4::zero();
+  float cost = 0.f;
+  for (int i = 0; i < _stride;) {
+    for (const int end = math::Min(i + kRowEarlyOut, _stride); i < end;
+         i += 4) {
+      const math::SimdFloat4 diff = math::simd_float4::LoadPtrU(_query + i) -
+                                    math::simd_float4::LoadPtr(_row + i);
+      acc = acc + Square<_Weighted>(diff, _weights + i);
+    }
+    cost = math::GetX(math::HAdd4(acc));
+    if (cost >= _best) {
+      break;
+    }
+  }
+  return cost;
+}
+
+// Computes the squared distance between _query and the closest point of the
+// box defined by _min and _max rows, which is a lower bound of the cost of all
+// the frames of the block.
+template <bool _Weighted>
+float BoxCost(const float* _query, const float* _min, const float* _weights,
+              int _stride) {
+  const float* max = _min + _stride;
+  math::SimdFloat4 acc = math::simd_float4::zero();
+  for (int i = 0; i < _stride; i += 4) {
+    const math::SimdFloat4 query = math::simd_float4::LoadPtrU(_query + i);
+    const math::SimdFloat4 diff =
+        query - math::Clamp(math::simd_float4::LoadPtr(_min + i), query,
+                            math::simd_float4::LoadPtr(max + i));
+    acc = acc + Square<_Weighted>(diff, _weights + i);
+  }
+  return math::GetX(math::HAdd4(acc));
+}
+
+// Tests frames [_begin, _end[, and updates _best and _best_frame.
+template <bool _Weighted>
+void SearchFrames(const MotionMatchingJob& _job, int _begin, int _end,
+                  float* _best, int* _best_frame) {
+  const int stride = _job.database->stride();
+  const float* row = _job.database->features().begin + _begin * stride;
+  for (int f = _begin; f < _end; ++f, row += stride) {
+    const float cost = RowCost<_Weighted>(_job.query.begin, row,
+                                          _job.weights.begin, stride, *_best);
+    if (cost < *_best) {
+      *_best = cost;
+      *_best_frame = f;
+    }
+  }
+}
+
+// Searches large blocks, then blocks whose bounds can contain a better frame
+// than the best one so far.
+template <bool _Weighted>
+void SearchHierarchy(const MotionMatchingJob& _job, float* _best,
+                     int* _best_frame) {
+  const MotionDatabase& database = *_job.database;
+  const int stride = database.stride();
+  const int num_frames = database.num_frames();
+  const float* query = _job.query.begin;
+  const float* weights = _job.weights.begin;
+  const float* large_bounds = database.large_bounds().begin;
+  const float* bounds = database.bounds().begin;
+  const int kBlocks =
+      MotionDatabase::kLargeBlockSize / MotionDatabase::kBlockSize;
+
+  for (int l = 0; l * MotionDatabase::kLargeBlockSize < num_frames; ++l) {
+    if (BoxCost<_Weighted>(query, large_bounds + l * 2 * stride, weights,
+                           stride) >= *_best) {
+      continue;
+    }
+    for (int b = l * kBlocks;
+         b < (l + 1) * kBlocks && b * MotionDatabase::kBlockSize < num_frames;
+         ++b) {
+      if (BoxCost<_Weighted>(query, bounds + b * 2 * stride, weights,
+                             stride) >= *_best) {
+        continue;
+      }
+      const int begin = b * MotionDatabase::kBlockSize;
+      const int end = math::Min(begin + MotionDatabase::kBlockSize, num_frames);
+      SearchFrames<_Weighted>(_job, begin, end, _best, _best_frame);
+    }
+  }
+}
+
+template <bool _Weighted>
+void Search(const MotionMatchingJob& _job, float* _best, int* _best_frame) {
+  if (_job.accelerate) {
+    SearchHierarchy<_Weighted>(_job, _best, _best_frame);
+  } else {
+    SearchFrames<_Weighted>(_job, 0, _job.database->num_frames(), _best,
+                            _best_frame);
+  }
+}
+}  // namespace
+
+bool MotionMatchingJob::Run() const {
+  if (!Validate()) {
+    return false;
+  }
+
+  float best_cost = max_cost;
+  int best_frame = -1;
+  if (weights.count() == 0) {
+    Search<false>(*this, &best_cost, &best_frame);
+  } else {
+    Search<true>(*this, &best_cost, &best_frame);
+  }
+
+  *frame = best_frame;
+  *cost = best_cost;
+  return true;
+}
+}  // namespace animation
+}  // namespace ozz
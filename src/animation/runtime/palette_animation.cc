@@ -0,0 +1,147 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/palette_animation.h"
+
+#include <cassert>
+#include <cstring>
+
+#include "ozz/base/io/archive.h"
+#include "ozz/base/log.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/memory/allocator.h"
+
+namespace ozz {
+namespace animation {
+
+PaletteAnimation::PaletteAnimation()
+    : duration_(0.f), num_joints_(0), num_frames_(0), name_(NULL) {}
+
+PaletteAnimation::~PaletteAnimation() { Deallocate(); }
+
+void PaletteAnimation::Allocate(size_t _name_len, int _num_joints,
+                                int _num_frames) {
+  assert(name_ == NULL && texels_.begin == NULL);
+
+  num_joints_ = _num_joints;
+  num_frames_ = _num_frames;
+  const size_t float_count = static_cast<size_t>(width()) *
+                             static_cast<size_t>(_num_frames) * 4;
+
+  // Compute overall size and allocate a single buffer for all the data.
+  // Texels are 16 bytes aligned, so they can be loaded as simd vectors.
+  const size_t buffer_size =
+      float_count * sizeof(float) + (_name_len > 0 ? _name_len + 1 : 0);
+  char* buffer = reinterpret_cast<char*>(
+      memory::default_allocator()->Allocate(buffer_size, 16));
+
+  // Fix up pointers. Serves larger alignment values first.
+  texels_.begin = reinterpret_cast<float*>(buffer);
+  buffer += float_count * sizeof(float);
+  texels_.end = reinterpret_cast<float*>(buffer);
+
+  // Let name be NULL if animation has no name. Allows to avoid allocating this
+  // buffer in the constructor of empty animations.
+  name_ = _name_len > 0 ? buffer : NULL;
+}
+
+void PaletteAnimation::Deallocate() {
+  // Deallocate everything at once.
+  memory::default_allocator()->Deallocate(texels_.begin);
+
+  texels_.Clear();
+  name_ = NULL;
+  num_joints_ = 0;
+  num_frames_ = 0;
+}
+
+const float* PaletteAnimation::frame(int _frame) const {
+  assert(_frame >= 0 && _frame < num_frames_);
+  return texels_.begin + _frame * width() * 4;
+}
+
+void PaletteAnimation::GetMatrix(int _frame, int _joint,
+                                 math::Float4x4* _matrix) const {
+  assert(_joint >= 0 && _joint < num_joints_);
+  const float* texels = frame(_frame) + _joint * kTexelsPerJoint * 4;
+
+  // Texels are matrix rows, transposes them back to columns.
+  const math::SimdFloat4 rows[4] = {
+      math::simd_float4::LoadPtr(texels + 0),
+      math::simd_float4::LoadPtr(texels + 4),
+      math::simd_float4::LoadPtr(texels + 8), math::simd_float4::w_axis()};
+  math::Transpose4x4(rows, _matrix->cols);
+}
+
+size_t PaletteAnimation::size() const {
+  const size_t size = sizeof(*this) + texels_.size();
+  return size;
+}
+
+void PaletteAnimation::Save(ozz::io::OArchive& _archive) const {
+  _archive << duration_;
+  _archive << static_cast<int32_t>(num_joints_);
+  _archive << static_cast<int32_t>(num_frames_);
+
+  const size_t name_len = name_ ? std::strlen(name_) : 0;
+  _archive << static_cast<int32_t>(name_len);
+  _archive << ozz::io::MakeArray(name_, name_len);
+
+  _archive << ozz::io::MakeArray(texels_);
+}
+
+void PaletteAnimation::Load(ozz::io::IArchive& _archive, uint32_t _version) {
+  // Destroy animation in case it was already used before.
+  Deallocate();
+  duration_ = 0.f;
+
+  if (_version != 1) {
+    log::Err() << "Unsupported PaletteAnimation version " << _version << "."
+               << std::endl;
+    return;
+  }
+
+  _archive >> duration_;
+
+  int32_t num_joints;
+  _archive >> num_joints;
+  int32_t num_frames;
+  _archive >> num_frames;
+  int32_t name_len;
+  _archive >> name_len;
+
+  Allocate(name_len, num_joints, num_frames);
+
+  if (name_) {  // NULL name_ is supported.
+    _archive >> ozz::io::MakeArray(name_, name_len);
+    name_[name_len] = 0;
+  }
+
+  _archive >> ozz::io::MakeArray(texels_);
+}
+}  // namespace animation
+}  // namespace ozz
@@ -0,0 +1,196 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#include "ozz/animation/runtime/pipeline_buffers.h"
+
+#if __cplusplus >= 201103L
+#include <atomic>
+#endif  // __cplusplus
+#include <cassert>
+
+#include "ozz/animation/runtime/pipeline_job.h"
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/memory/allocator.h"
+
+namespace ozz {
+namespace animation {
+
+namespace {
+#if __cplusplus >= 201103L
+typedef std::atomic<int> BufferCounter;
+#else   // __cplusplus
+// Mimics the subset of std::atomic<int> interface used below, without any
+// synchronization.
+struct BufferCounter {
+  int load() const { return value; }
+  void store(int _value) { value = _value; }
+  int operator++() { return ++value; }
+  int operator--() { return --value; }
+  int value;
+};
+#endif  // __cplusplus
+}  // namespace
+
+struct PipelineBuffers::State {
+  // Index of the latest published buffer, -1 if none.
+  BufferCounter latest;
+
+  // Number of consumers reading each buffer.
+  BufferCounter readers[kMaxBuffers];
+
+  // Frame number each buffer was published for.
+  BufferCounter frames[kMaxBuffers];
+
+  // Producer only data: buffer being written (-1 if none), and last published
+  // frame number.
+  int writing;
+  uint32_t frame_counter;
+};
+
+PipelineBuffers::PipelineBuffers()
+    : state_(NULL),
+      num_buffers_(0),
+      num_joints_(0),
+      palette_size_(0),
+      matrices_(NULL) {}
+
+PipelineBuffers::PipelineBuffers(int _num_joints, int _palette_size,
+                                 int _num_buffers)
+    : state_(NULL),
+      num_buffers_(0),
+      num_joints_(0),
+      palette_size_(0),
+      matrices_(NULL) {
+  Resize(_num_joints, _palette_size, _num_buffers);
+}
+
+PipelineBuffers::~PipelineBuffers() {
+  memory::Allocator* allocator = memory::default_allocator();
+  allocator->Delete(state_);
+  allocator->Deallocate(matrices_);
+}
+
+void PipelineBuffers::Resize(int _num_joints, int _palette_size,
+                             int _num_buffers) {
+  memory::Allocator* allocator = memory::default_allocator();
+  if (!state_) {
+    state_ = allocator->New<State>();
+  }
+  state_->latest.store(-1);
+  for (int i = 0; i < kMaxBuffers; ++i) {
+    state_->readers[i].store(0);
+    state_->frames[i].store(0);
+  }
+  state_->writing = -1;
+  state_->frame_counter = 0;
+
+  num_buffers_ = math::Clamp(2, _num_buffers, static_cast<int>(kMaxBuffers));
+  num_joints_ = _num_joints;
+  palette_size_ = _palette_size;
+
+  allocator->Deallocate(matrices_);
+  const size_t size = sizeof(math::Float4x4) * num_buffers_ *
+                      (num_joints_ + palette_size_);
+  matrices_ = reinterpret_cast<math::Float4x4*>(
+      allocator->Allocate(size, OZZ_ALIGN_OF(math::Float4x4)));
+}
+
+int PipelineBuffers::BeginWrite() {
+  assert(state_ && state_->writing == -1 && "Buffer already being written.");
+
+  // Doesn't reuse the latest buffer, nor buffers being read. A consumer that
+  // increments readers after they're tested here will see latest has changed,
+  // and back off (see AcquireRead()).
+  const int latest = state_->latest.load();
+  for (int i = 0; i < num_buffers_; ++i) {
+    if (i != latest && state_->readers[i].load() == 0) {
+      state_->writing = i;
+      return i;
+    }
+  }
+  return -1;
+}
+
+void PipelineBuffers::EndWrite(int _index) {
+  assert(state_ && state_->writing == _index && "Buffer isn't being written.");
+  state_->frames[_index].store(static_cast<int>(++state_->frame_counter));
+  state_->latest.store(_index);
+  state_->writing = -1;
+}
+
+void PipelineBuffers::SetupOutputs(int _index, PipelineJob* _job) const {
+  assert(_job);
+  _job->models = models(_index);
+  _job->skinning_palette = palette_size_ != 0 ? skinning_palette(_index)
+                                              : Range<math::Float4x4>();
+}
+
+int PipelineBuffers::AcquireRead() {
+  assert(state_);
+  for (;;) {
+    const int latest = state_->latest.load();
+    if (latest < 0) {
+      return -1;
+    }
+    ++state_->readers[latest];
+
+    // Buffer can be safely read if it's still the latest once reader count
+    // was incremented, as the producer never writes to the latest buffer.
+    if (state_->latest.load() == latest) {
+      return latest;
+    }
+    --state_->readers[latest];
+  }
+}
+
+void PipelineBuffers::ReleaseRead(int _index) {
+  assert(state_ && _index >= 0 && _index < num_buffers_ &&
+         state_->readers[_index].load() > 0 && "Buffer isn't being read.");
+  --state_->readers[_index];
+}
+
+Range<math::Float4x4> PipelineBuffers::models(int _index) const {
+  assert(_index >= 0 && _index < num_buffers_);
+  return Range<math::Float4x4>(
+      matrices_ + _index * (num_joints_ + palette_size_), num_joints_);
+}
+
+Range<math::Float4x4> PipelineBuffers::skinning_palette(int _index) const {
+  assert(_index >= 0 && _index < num_buffers_);
+  return Range<math::Float4x4>(
+      matrices_ + _index * (num_joints_ + palette_size_) + num_joints_,
+      palette_size_);
+}
+
+uint32_t PipelineBuffers::frame(int _index) const {
+  assert(state_ && _index >= 0 && _index < num_buffers_);
+  return static_cast<uint32_t>(state_->frames[_index].load());
+}
+}  // namespace animation
+}  // namespace ozz
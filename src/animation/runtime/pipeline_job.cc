@@ -0,0 +1,273 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#include "ozz/animation/runtime/pipeline_job.h"
+
+#include <cassert>
+
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/blending_job.h"
+#include "ozz/animation/runtime/ik_two_bone_job.h"
+#include "ozz/animation/runtime/local_to_model_job.h"
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/simd_quaternion.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/allocator.h"
+
+namespace ozz {
+namespace animation {
+
+namespace {
+// Multiplies _joint local-space rotation of _locals by _correction.
+void ApplyPipelineCorrection(int _joint,
+                             const math::SimdQuaternion& _correction,
+                             const Range<math::SoaTransform>& _locals) {
+  math::SoaTransform& soa_transform = _locals[_joint / 4];
+  math::SimdQuaternion aos_quats[4];
+  math::Transpose4x4(&soa_transform.rotation.x, &aos_quats->xyzw);
+  aos_quats[_joint & 3] = aos_quats[_joint & 3] * _correction;
+  math::Transpose4x4(&aos_quats->xyzw, &soa_transform.rotation.x);
+}
+}  // namespace
+
+PipelineContext::PipelineContext()
+    : max_soa_joints_(0), max_layers_(0), poses_(NULL) {}
+
+PipelineContext::PipelineContext(int _max_joints, int _max_layers)
+    : max_soa_joints_(0), max_layers_(0), poses_(NULL) {
+  Resize(_max_joints, _max_layers);
+}
+
+PipelineContext::~PipelineContext() {
+  memory::default_allocator()->Deallocate(poses_);
+}
+
+void PipelineContext::Resize(int _max_joints, int _max_layers) {
+  memory::default_allocator()->Deallocate(poses_);
+  max_soa_joints_ = (_max_joints + 3) / 4;
+  max_layers_ = _max_layers;
+  const size_t size =
+      sizeof(math::SoaTransform) * max_soa_joints_ * _max_layers;
+  poses_ = reinterpret_cast<math::SoaTransform*>(
+      memory::default_allocator()->Allocate(size,
+                                            OZZ_ALIGN_OF(math::SoaTransform)));
+}
+
+Range<math::SoaTransform> PipelineContext::pose(int _layer) const {
+  assert(_layer >= 0 && _layer < max_layers_);
+  return Range<math::SoaTransform>(poses_ + _layer * max_soa_joints_,
+                                   max_soa_joints_);
+}
+
+PipelineJob::Layer::Layer()
+    : animation(NULL), cache(NULL), ratio(0.f), weight(1.f) {}
+
+PipelineJob::TwoBoneIK::TwoBoneIK()
+    : start_joint(-1),
+      mid_joint(-1),
+      end_joint(-1),
+      target(math::simd_float4::zero()),
+      mid_axis(math::simd_float4::z_axis()),
+      pole_vector(math::simd_float4::y_axis()),
+      twist_angle(0.f),
+      soften(1.f),
+      weight(1.f) {}
+
+PipelineJob::PipelineJob()
+    : skeleton(NULL),
+      threshold(.1f),
+      quality(SamplingJob::kStandard),
+      skinning_stage(NULL),
+      skinning_user_data(NULL),
+      context(NULL) {}
+
+bool PipelineJob::NeedsBlending() const {
+  if (layers.count() != 1) {
+    return layers.count() != 0;
+  }
+  const Layer& layer = layers[0];
+  return layer.joint_weights.begin != NULL || layer.weight < threshold;
+}
+
+bool PipelineJob::Validate() const {
+  if (!skeleton) {
+    return false;
+  }
+  bool valid = threshold > 0.f;
+
+  const int num_joints = skeleton->num_joints();
+  const int num_soa_joints = skeleton->num_soa_joints();
+  valid &= locals.end - locals.begin >= num_soa_joints;
+  valid &= models.end - models.begin >= num_joints;
+
+  // Layers can be sampled and blended.
+  const int num_layers = static_cast<int>(layers.count());
+  valid &= num_layers <= kMaxLayers;
+  for (int i = 0; valid && i < num_layers; ++i) {
+    const Layer& layer = layers[i];
+    if (!layer.animation) {
+      return false;
+    }
+    valid &= layer.animation->num_tracks() == num_joints;
+    SamplingJob sampling_job;
+    sampling_job.animation = layer.animation;
+    sampling_job.cache = layer.cache;
+    sampling_job.output = locals;
+    valid &= sampling_job.Validate();
+    if (layer.joint_weights.begin != NULL) {
+      valid &= layer.joint_weights.end - layer.joint_weights.begin >=
+               num_soa_joints;
+    }
+  }
+  if (num_layers != 0 && NeedsBlending()) {
+    valid &= context != NULL && context->max_soa_joints() >= num_soa_joints &&
+             context->max_layers() >= num_layers;
+  }
+
+  // IK chains.
+  for (const TwoBoneIK* ik = two_bone_iks.begin; ik < two_bone_iks.end;
+       ++ik) {
+    valid &= ik->start_joint >= 0;
+    valid &= ik->start_joint < ik->mid_joint;
+    valid &= ik->mid_joint < ik->end_joint;
+    valid &= ik->end_joint < num_joints;
+    valid &= math::AreAllTrue1(math::IsNormalizedEst3(ik->mid_axis));
+  }
+
+  // Skinning palette, see LocalToModelJob.
+  if (skinning_palette.begin != NULL) {
+    LocalToModelJob ltm_job;
+    ltm_job.skeleton = skeleton;
+    ltm_job.input = locals;
+    ltm_job.output = models;
+    ltm_job.skinning_output = skinning_palette;
+    ltm_job.inverse_bind_poses = inverse_bind_poses;
+    ltm_job.joint_remaps = joint_remaps;
+    valid &= ltm_job.Validate();
+  } else {
+    valid &= skinning_stage == NULL;
+  }
+
+  return valid;
+}
+
+bool PipelineJob::Run() const {
+  if (!Validate()) {
+    return false;
+  }
+
+  // Samples and blends layers.
+  const int num_layers = static_cast<int>(layers.count());
+  if (num_layers == 0) {
+    const Range<const math::SoaTransform> bind_poses =
+        skeleton->joint_bind_poses();
+    for (size_t i = 0; i < bind_poses.count(); ++i) {
+      locals[i] = bind_poses[i];
+    }
+  } else if (!NeedsBlending()) {
+    // A single layer is sampled directly to the output.
+    const Layer& layer = layers[0];
+    layer.cache->Sample(*layer.animation,
+                        math::Clamp(0.f, layer.ratio, 1.f), NULL, NULL,
+                        locals.begin, quality);
+  } else {
+    BlendingJob::Layer blend_layers[kMaxLayers];
+    for (int i = 0; i < num_layers; ++i) {
+      const Layer& layer = layers[i];
+      const Range<math::SoaTransform> pose = context->pose(i);
+      layer.cache->Sample(*layer.animation,
+                          math::Clamp(0.f, layer.ratio, 1.f), NULL, NULL,
+                          pose.begin, quality);
+      blend_layers[i].weight = layer.weight;
+      blend_layers[i].transform = pose;
+      blend_layers[i].joint_weights = layer.joint_weights;
+    }
+
+    BlendingJob blending_job;
+    blending_job.threshold = threshold;
+    // Sampling and blending quality enums share the same values.
+    blending_job.quality = static_cast<BlendingJob::Quality>(quality);
+    blending_job.layers =
+        Range<const BlendingJob::Layer>(blend_layers, num_layers);
+    blending_job.bind_pose = skeleton->joint_bind_poses();
+    blending_job.output = locals;
+    if (!blending_job.Run()) {
+      return false;
+    }
+  }
+
+  // Converts to model-space, computing skinning palette in the same pass.
+  LocalToModelJob ltm_job;
+  ltm_job.skeleton = skeleton;
+  ltm_job.input = locals;
+  ltm_job.output = models;
+  ltm_job.skinning_output = skinning_palette;
+  ltm_job.inverse_bind_poses = inverse_bind_poses;
+  ltm_job.joint_remaps = joint_remaps;
+  if (!ltm_job.Run()) {
+    return false;
+  }
+
+  // Solves IK chains, and updates their sub-hierarchy.
+  for (const TwoBoneIK* ik = two_bone_iks.begin; ik < two_bone_iks.end;
+       ++ik) {
+    math::SimdQuaternion start_correction;
+    math::SimdQuaternion mid_correction;
+    IKTwoBoneJob ik_job;
+    ik_job.target = ik->target;
+    ik_job.mid_axis = ik->mid_axis;
+    ik_job.pole_vector = ik->pole_vector;
+    ik_job.twist_angle = ik->twist_angle;
+    ik_job.soften = ik->soften;
+    ik_job.weight = ik->weight;
+    ik_job.start_joint = &models[ik->start_joint];
+    ik_job.mid_joint = &models[ik->mid_joint];
+    ik_job.end_joint = &models[ik->end_joint];
+    ik_job.start_joint_correction = &start_correction;
+    ik_job.mid_joint_correction = &mid_correction;
+    if (!ik_job.Run()) {
+      return false;
+    }
+    ApplyPipelineCorrection(ik->start_joint, start_correction, locals);
+    ApplyPipelineCorrection(ik->mid_joint, mid_correction, locals);
+
+    ltm_job.from = ik->start_joint;
+    if (!ltm_job.Run()) {
+      return false;
+    }
+  }
+
+  // Skinning stage, while the palette is still in cache.
+  if (skinning_stage) {
+    return skinning_stage(skinning_user_data, skinning_palette);
+  }
+  return true;
+}
+}  // namespace animation
+}  // namespace ozz
@@ -0,0 +1,336 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/pose_encoding_job.h"
+
+#include <cmath>
+
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/soa_transform.h"
+
+namespace ozz {
+namespace animation {
+
+namespace {
+// Number of float components of a transform: translation, rotation, scale.
+const int kPoseComponents = 10;
+
+// Number of bits used to store a group bit width.
+const int kPoseWidthBits = 5;
+
+// Quantized values are clamped so that deltas and their zigzag encoding fit in
+// 31 bits.
+const float kPoseMaxQuantized = 536870911.f;  // 2^29 - 1
+
+// Components of a soa transform, unpacked per lane.
+struct PoseComponents {
+  float values[kPoseComponents][4];
+};
+
+void ExtractPoseComponents(const math::SoaTransform& _transform,
+                           PoseComponents* _components) {
+  float(*values)[4] = _components->values;
+  math::StorePtrU(_transform.translation.x, values[0]);
+  math::StorePtrU(_transform.translation.y, values[1]);
+  math::StorePtrU(_transform.translation.z, values[2]);
+  math::StorePtrU(_transform.rotation.x, values[3]);
+  math::StorePtrU(_transform.rotation.y, values[4]);
+  math::StorePtrU(_transform.rotation.z, values[5]);
+  math::StorePtrU(_transform.rotation.w, values[6]);
+  math::StorePtrU(_transform.scale.x, values[7]);
+  math::StorePtrU(_transform.scale.y, values[8]);
+  math::StorePtrU(_transform.scale.z, values[9]);
+}
+
+void ExtractReferenceComponents(const Range<const math::SoaTransform>& _ref,
+                                size_t _index, PoseComponents* _components) {
+  if (_ref.count() == 0) {
+    ExtractPoseComponents(math::SoaTransform::identity(), _components);
+  } else {
+    ExtractPoseComponents(_ref[_index], _components);
+  }
+}
+
+// Computes inverse quantization steps of every component.
+void ComputePoseSteps(float _translation, float _rotation, float _scale,
+                      float _steps[kPoseComponents]) {
+  for (int i = 0; i < 3; ++i) {
+    _steps[i] = _translation;
+    _steps[3 + i] = _rotation;
+    _steps[7 + i] = _scale;
+  }
+  _steps[6] = _rotation;
+}
+
+int32_t QuantizePoseValue(float _value, float _step) {
+  float quantized = std::floor(_value / _step + .5f);
+  // Also handles NaN.
+  if (!(quantized > -kPoseMaxQuantized)) {
+    quantized = -kPoseMaxQuantized;
+  } else if (quantized > kPoseMaxQuantized) {
+    quantized = kPoseMaxQuantized;
+  }
+  return static_cast<int32_t>(quantized);
+}
+
+// Writes bits to a byte buffer, least significant bits first.
+class PoseBitWriter {
+ public:
+  PoseBitWriter(char* _begin, const char* _end)
+      : cursor_(_begin), end_(_end), bits_(0), count_(0), overflow_(false) {}
+
+  void Write(uint32_t _value, int _bits) {
+    bits_ |= static_cast<uint64_t>(_value) << count_;
+    count_ += _bits;
+    while (count_ >= 8) {
+      Flush();
+    }
+  }
+
+  // Flushes remaining bits, and returns number of bytes written, or 0 if
+  // buffer overflowed.
+  size_t Finish(const char* _begin) {
+    if (count_ > 0) {
+      Flush();
+    }
+    return overflow_ ? 0 : static_cast<size_t>(cursor_ - _begin);
+  }
+
+ private:
+  void Flush() {
+    if (cursor_ < end_) {
+      *cursor_++ = static_cast<char>(bits_ & 0xff);
+    } else {
+      overflow_ = true;
+    }
+    bits_ >>= 8;
+    count_ = count_ > 8 ? count_ - 8 : 0;
+  }
+
+  char* cursor_;
+  const char* end_;
+  uint64_t bits_;
+  int count_;
+  bool overflow_;
+};
+
+// Reads bits written by PoseBitWriter.
+class PoseBitReader {
+ public:
+  PoseBitReader(const char* _begin, const char* _end)
+      : cursor_(_begin), end_(_end), bits_(0), count_(0), overflow_(false) {}
+
+  uint32_t Read(int _bits) {
+    while (count_ < _bits) {
+      uint64_t byte = 0;
+      if (cursor_ < end_) {
+        byte = static_cast<unsigned char>(*cursor_++);
+      } else {
+        overflow_ = true;
+      }
+      bits_ |= byte << count_;
+      count_ += 8;
+    }
+    const uint32_t value =
+        static_cast<uint32_t>(bits_ & ((uint64_t(1) << _bits) - 1));
+    bits_ >>= _bits;
+    count_ -= _bits;
+    return value;
+  }
+
+  bool overflow() const { return overflow_; }
+
+ private:
+  const char* cursor_;
+  const char* end_;
+  uint64_t bits_;
+  int count_;
+  bool overflow_;
+};
+
+bool ValidatePosePrecisions(float _translation, float _rotation,
+                            float _scale) {
+  return _translation > 0.f && _rotation > 0.f && _scale > 0.f;
+}
+}  // namespace
+
+PoseEncodingJob::PoseEncodingJob()
+    : translation_precision(1e-4f),
+      rotation_precision(1.f / 16383.f),
+      scale_precision(1e-4f),
+      size(NULL) {}
+
+bool PoseEncodingJob::Validate() const {
+  bool valid = size != NULL;
+  valid &= reference.count() == 0 || reference.count() >= pose.count();
+  valid &= ValidatePosePrecisions(translation_precision, rotation_precision,
+                                  scale_precision);
+  return valid;
+}
+
+size_t PoseEncodingJob::MaxSize(size_t _num_soa_transforms) {
+  const size_t group_bits = kPoseWidthBits + 4 * 31;
+  return (_num_soa_transforms * kPoseComponents * group_bits + 7) / 8;
+}
+
+bool PoseEncodingJob::Run() const {
+  if (!Validate()) {
+    return false;
+  }
+
+  float steps[kPoseComponents];
+  ComputePoseSteps(translation_precision, rotation_precision, scale_precision,
+                   steps);
+
+  PoseBitWriter writer(buffer.begin, buffer.end);
+  for (size_t i = 0; i < pose.count(); ++i) {
+    PoseComponents current;
+    ExtractPoseComponents(pose[i], &current);
+    PoseComponents ref;
+    ExtractReferenceComponents(reference, i, &ref);
+
+    // Chooses the quaternion closest to the reference one, so deltas are
+    // small.
+    for (int l = 0; l < 4; ++l) {
+      const float dot = current.values[3][l] * ref.values[3][l] +
+                        current.values[4][l] * ref.values[4][l] +
+                        current.values[5][l] * ref.values[5][l] +
+                        current.values[6][l] * ref.values[6][l];
+      if (dot < 0.f) {
+        for (int c = 3; c < 7; ++c) {
+          current.values[c][l] = -current.values[c][l];
+        }
+      }
+    }
+
+    for (int c = 0; c < kPoseComponents; ++c) {
+      // Zigzag encodes deltas, so that small negative values use few bits.
+      uint32_t zigzags[4];
+      uint32_t all = 0;
+      for (int l = 0; l < 4; ++l) {
+        const int32_t delta =
+            QuantizePoseValue(current.values[c][l], steps[c]) -
+            QuantizePoseValue(ref.values[c][l], steps[c]);
+        zigzags[l] = (static_cast<uint32_t>(delta) << 1) ^
+                     static_cast<uint32_t>(delta >> 31);
+        all |= zigzags[l];
+      }
+      int width = 0;
+      for (; all != 0; all >>= 1) {
+        ++width;
+      }
+      writer.Write(static_cast<uint32_t>(width), kPoseWidthBits);
+      if (width != 0) {
+        for (int l = 0; l < 4; ++l) {
+          writer.Write(zigzags[l], width);
+        }
+      }
+    }
+  }
+
+  const size_t written = writer.Finish(buffer.begin);
+  *size = written;
+  return written != 0 || pose.count() == 0;
+}
+
+PoseDecodingJob::PoseDecodingJob()
+    : translation_precision(1e-4f),
+      rotation_precision(1.f / 16383.f),
+      scale_precision(1e-4f) {}
+
+bool PoseDecodingJob::Validate() const {
+  bool valid = reference.count() == 0 || reference.count() >= output.count();
+  valid &= ValidatePosePrecisions(translation_precision, rotation_precision,
+                                  scale_precision);
+  return valid;
+}
+
+bool PoseDecodingJob::Run() const {
+  if (!Validate()) {
+    return false;
+  }
+
+  float steps[kPoseComponents];
+  ComputePoseSteps(translation_precision, rotation_precision, scale_precision,
+                   steps);
+
+  PoseBitReader reader(buffer.begin, buffer.end);
+  for (size_t i = 0; i < output.count(); ++i) {
+    PoseComponents ref;
+    ExtractReferenceComponents(reference, i, &ref);
+
+    PoseComponents decoded;
+    for (int c = 0; c < kPoseComponents; ++c) {
+      const int width = static_cast<int>(reader.Read(kPoseWidthBits));
+      for (int l = 0; l < 4; ++l) {
+        const uint32_t zigzag = width != 0 ? reader.Read(width) : 0;
+        const int32_t delta = static_cast<int32_t>(zigzag >> 1) ^
+                              -static_cast<int32_t>(zigzag & 1);
+        const int32_t quantized =
+            QuantizePoseValue(ref.values[c][l], steps[c]) + delta;
+        decoded.values[c][l] = static_cast<float>(quantized) * steps[c];
+      }
+    }
+    if (reader.overflow()) {
+      return false;
+    }
+
+    // Renormalizes quaternions, as quantization altered their length.
+    for (int l = 0; l < 4; ++l) {
+      float(*values)[4] = decoded.values;
+      const float len2 = values[3][l] * values[3][l] +
+                         values[4][l] * values[4][l] +
+                         values[5][l] * values[5][l] +
+                         values[6][l] * values[6][l];
+      if (len2 > 0.f) {
+        const float inv_len = 1.f / std::sqrt(len2);
+        for (int c = 3; c < 7; ++c) {
+          values[c][l] *= inv_len;
+        }
+      } else {
+        values[3][l] = values[4][l] = values[5][l] = 0.f;
+        values[6][l] = 1.f;
+      }
+    }
+
+    const float(*values)[4] = decoded.values;
+    math::SoaTransform& transform = output[i];
+    transform.translation.x = math::simd_float4::LoadPtrU(values[0]);
+    transform.translation.y = math::simd_float4::LoadPtrU(values[1]);
+    transform.translation.z = math::simd_float4::LoadPtrU(values[2]);
+    transform.rotation.x = math::simd_float4::LoadPtrU(values[3]);
+    transform.rotation.y = math::simd_float4::LoadPtrU(values[4]);
+    transform.rotation.z = math::simd_float4::LoadPtrU(values[5]);
+    transform.rotation.w = math::simd_float4::LoadPtrU(values[6]);
+    transform.scale.x = math::simd_float4::LoadPtrU(values[7]);
+    transform.scale.y = math::simd_float4::LoadPtrU(values[8]);
+    transform.scale.z = math::simd_float4::LoadPtrU(values[9]);
+  }
+  return true;
+}
+}  // namespace animation
+}  // namespace ozz
@@ -0,0 +1,132 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/pose_interpolation_job.h"
+
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/profile.h"
+
+namespace ozz {
+namespace animation {
+
+PoseInterpolationJob::PoseInterpolationJob()
+    : ratio(0.f), quality(BlendingJob::kStandard) {}
+
+bool PoseInterpolationJob::Validate() const {
+  bool valid = true;
+
+  // Ranges must be valid.
+  valid &= from.begin <= from.end && to.begin <= to.end &&
+           output.begin <= output.end;
+  valid &= model_from.begin <= model_from.end &&
+           model_to.begin <= model_to.end &&
+           model_output.begin <= model_output.end;
+
+  // At least an output is required.
+  valid &= output.count() != 0 || model_output.count() != 0;
+
+  // Inputs must be big enough.
+  valid &= from.count() >= output.count() && to.count() >= output.count();
+  valid &= model_from.count() >= model_output.count() &&
+           model_to.count() >= model_output.count();
+
+  return valid;
+}
+
+namespace {
+// Interpolates local-space poses of a validated job, normalizing rotations
+// with _Policy.
+template <typename _Policy>
+void InterpolateLocals(const PoseInterpolationJob& _job,
+                       math::_SimdFloat4 _ratio) {
+  for (size_t i = 0; i < _job.output.count(); ++i) {
+    const math::SoaTransform& from = _job.from[i];
+    const math::SoaTransform& to = _job.to[i];
+
+    // Negates to rotation if it isn't in from rotation hemisphere, in order to
+    // interpolate along the shortest path.
+    const math::SimdInt4 sign = math::Sign(
+        from.rotation.x * to.rotation.x + from.rotation.y * to.rotation.y +
+        from.rotation.z * to.rotation.z + from.rotation.w * to.rotation.w);
+    const math::SoaQuaternion to_rotation = {
+        math::Xor(to.rotation.x, sign), math::Xor(to.rotation.y, sign),
+        math::Xor(to.rotation.z, sign), math::Xor(to.rotation.w, sign)};
+
+    math::SoaTransform& output = _job.output[i];
+    output.translation = Lerp(from.translation, to.translation, _ratio);
+    output.rotation =
+        math::NLerp<_Policy>(from.rotation, to_rotation, _ratio);
+    output.scale = Lerp(from.scale, to.scale, _ratio);
+  }
+}
+
+// Interpolates model-space matrices of a validated job.
+void InterpolateModels(const PoseInterpolationJob& _job,
+                       math::_SimdFloat4 _ratio) {
+  for (size_t i = 0; i < _job.model_output.count(); ++i) {
+    const math::Float4x4& from = _job.model_from[i];
+    const math::Float4x4& to = _job.model_to[i];
+    math::Float4x4& output = _job.model_output[i];
+    for (int c = 0; c < 4; ++c) {
+      output.cols[c] = math::Lerp(from.cols[c], to.cols[c], _ratio);
+    }
+  }
+}
+}  // namespace
+
+bool PoseInterpolationJob::Run() const {
+  OZZ_PROFILE_ZONE("ozz::PoseInterpolationJob::Run");
+  if (!Validate()) {
+    return false;
+  }
+
+  const math::SimdFloat4 simd_ratio =
+      math::simd_float4::Load1(math::Clamp(0.f, ratio, 1.f));
+
+  // Dispatches to the kernel specialized for the requested quality.
+  switch (quality) {
+    case BlendingJob::kFast: {
+      InterpolateLocals<math::EstimatedNormalization<0> >(*this, simd_ratio);
+      break;
+    }
+    case BlendingJob::kAccurate: {
+      InterpolateLocals<math::ExactNormalization>(*this, simd_ratio);
+      break;
+    }
+    default: {
+      InterpolateLocals<math::EstimatedNormalization<1> >(*this, simd_ratio);
+      break;
+    }
+  }
+  InterpolateModels(*this, simd_ratio);
+
+  return true;
+}
+}  // namespace animation
+}  // namespace ozz
@@ -0,0 +1,460 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#include "ozz/animation/runtime/pose_stream.h"
+
+#include <cassert>
+#include <cstring>
+
+#include "ozz/animation/runtime/blending_job.h"
+#include "ozz/animation/runtime/pose_encoding_job.h"
+#include "ozz/animation/runtime/sampling_job.h"
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/base/io/archive.h"
+#include "ozz/base/log.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/maths/vec_float.h"
+#include "ozz/base/memory/allocator.h"
+
+namespace ozz {
+namespace animation {
+
+namespace {
+// Frame header: number of layers and number of IK targets, one byte each.
+const size_t kFrameHeaderSize = 2;
+
+// Layer: 16 bits clip index, ratio and weight floats.
+const size_t kLayerSize = 2 + 4 + 4;
+
+// IK target: 3 floats.
+const size_t kIKTargetSize = 3 * 4;
+
+// Floats are stored with their exact bit pattern, in little endian order
+// whatever the platform, so decoding is deterministic.
+char* WriteU32(char* _cursor, uint32_t _value) {
+  for (int i = 0; i < 4; ++i) {
+    _cursor[i] = static_cast<char>((_value >> (i * 8)) & 0xff);
+  }
+  return _cursor + 4;
+}
+
+char* WriteFloat(char* _cursor, float _value) {
+  uint32_t bits;
+  std::memcpy(&bits, &_value, sizeof(bits));
+  return WriteU32(_cursor, bits);
+}
+
+const char* ReadU32(const char* _cursor, uint32_t* _value) {
+  uint32_t value = 0;
+  for (int i = 0; i < 4; ++i) {
+    value |= static_cast<uint32_t>(static_cast<unsigned char>(_cursor[i]))
+             << (i * 8);
+  }
+  *_value = value;
+  return _cursor + 4;
+}
+
+const char* ReadFloat(const char* _cursor, float* _value) {
+  uint32_t bits;
+  _cursor = ReadU32(_cursor, &bits);
+  std::memcpy(_value, &bits, sizeof(bits));
+  return _cursor;
+}
+
+// Grows _range so it can contain at least _count elements, doubling its
+// capacity to amortize reallocations.
+template <typename _Ty>
+void Reserve(Range<_Ty>* _range, size_t _count) {
+  const size_t capacity = _range->count();
+  if (_count <= capacity) {
+    return;
+  }
+  size_t new_capacity = capacity < 16 ? 16 : capacity * 2;
+  if (new_capacity < _count) {
+    new_capacity = _count;
+  }
+  _Ty* buffer = reinterpret_cast<_Ty*>(memory::default_allocator()->Reallocate(
+      _range->begin, new_capacity * sizeof(_Ty), OZZ_ALIGN_OF(_Ty)));
+  *_range = Range<_Ty>(buffer, new_capacity);
+}
+}  // namespace
+
+PoseStream::Settings::Settings()
+    : snapshot_interval(60),
+      translation_precision(PoseEncodingJob().translation_precision),
+      rotation_precision(PoseEncodingJob().rotation_precision),
+      scale_precision(PoseEncodingJob().scale_precision) {}
+
+PoseStream::PoseStream()
+    : num_frames_(0), num_snapshots_(0), num_soa_transforms_(0) {}
+
+PoseStream::~PoseStream() { Deallocate(); }
+
+void PoseStream::Deallocate() {
+  memory::Allocator* allocator = memory::default_allocator();
+  allocator->Deallocate(frames_.begin);
+  frames_.Clear();
+  allocator->Deallocate(frame_offsets_.begin);
+  frame_offsets_.Clear();
+  allocator->Deallocate(snapshots_.begin);
+  snapshots_.Clear();
+  allocator->Deallocate(snapshot_offsets_.begin);
+  snapshot_offsets_.Clear();
+
+  num_frames_ = 0;
+  num_snapshots_ = 0;
+  num_soa_transforms_ = 0;
+}
+
+bool PoseStream::Reset(const Settings& _settings) {
+  Deallocate();
+  if (_settings.snapshot_interval < 0 ||
+      !(_settings.translation_precision > 0.f) ||
+      !(_settings.rotation_precision > 0.f) ||
+      !(_settings.scale_precision > 0.f)) {
+    return false;
+  }
+  settings_ = _settings;
+  return true;
+}
+
+bool PoseStream::Record(const Range<const PoseStreamLayer>& _layers,
+                        const Range<const math::Float3>& _ik_targets,
+                        const Range<const math::SoaTransform>& _pose) {
+  const size_t num_layers = _layers.count();
+  const size_t num_ik_targets = _ik_targets.count();
+  if (num_layers > kMaxLayers || num_ik_targets > kMaxIKTargets) {
+    return false;
+  }
+  for (size_t i = 0; i < num_layers; ++i) {
+    if (_layers[i].clip < 0 || _layers[i].clip > 0xffff) {
+      return false;
+    }
+  }
+
+  // Encodes snapshot first, so the stream is left unchanged if it fails.
+  const bool snapshot = IsSnapshotFrame(num_frames_);
+  if (snapshot) {
+    const size_t num_soa = _pose.count();
+    if (num_soa == 0 ||
+        (num_snapshots_ != 0 &&
+         num_soa != static_cast<size_t>(num_soa_transforms_))) {
+      return false;
+    }
+
+    Reserve(&snapshot_offsets_, num_snapshots_ + 2);
+    if (num_snapshots_ == 0) {
+      snapshot_offsets_[0] = 0;
+    }
+    const uint32_t offset = snapshot_offsets_[num_snapshots_];
+    Reserve(&snapshots_, offset + PoseEncodingJob::MaxSize(num_soa));
+
+    size_t size = 0;
+    PoseEncodingJob job;
+    job.translation_precision = settings_.translation_precision;
+    job.rotation_precision = settings_.rotation_precision;
+    job.scale_precision = settings_.scale_precision;
+    job.pose = _pose;
+    job.buffer = Range<char>(snapshots_.begin + offset, snapshots_.end);
+    job.size = &size;
+    if (!job.Run()) {
+      return false;
+    }
+    snapshot_offsets_[num_snapshots_ + 1] =
+        offset + static_cast<uint32_t>(size);
+    num_soa_transforms_ = static_cast<int>(num_soa);
+    ++num_snapshots_;
+  }
+
+  // Appends frame.
+  Reserve(&frame_offsets_, num_frames_ + 2);
+  if (num_frames_ == 0) {
+    frame_offsets_[0] = 0;
+  }
+  const uint32_t offset = frame_offsets_[num_frames_];
+  const size_t size = kFrameHeaderSize + num_layers * kLayerSize +
+                      num_ik_targets * kIKTargetSize;
+  Reserve(&frames_, offset + size);
+
+  char* cursor = frames_.begin + offset;
+  *cursor++ = static_cast<char>(num_layers);
+  *cursor++ = static_cast<char>(num_ik_targets);
+  for (size_t i = 0; i < num_layers; ++i) {
+    const PoseStreamLayer& layer = _layers[i];
+    *cursor++ = static_cast<char>(layer.clip & 0xff);
+    *cursor++ = static_cast<char>((layer.clip >> 8) & 0xff);
+    cursor = WriteFloat(cursor, layer.ratio);
+    cursor = WriteFloat(cursor, layer.weight);
+  }
+  for (size_t i = 0; i < num_ik_targets; ++i) {
+    const math::Float3& target = _ik_targets[i];
+    cursor = WriteFloat(cursor, target.x);
+    cursor = WriteFloat(cursor, target.y);
+    cursor = WriteFloat(cursor, target.z);
+  }
+  assert(cursor == frames_.begin + offset + size);
+
+  frame_offsets_[num_frames_ + 1] = offset + static_cast<uint32_t>(size);
+  ++num_frames_;
+  return true;
+}
+
+bool PoseStream::ReadFrame(int _frame, const Range<PoseStreamLayer>& _layers,
+                           int* _num_layers,
+                           const Range<math::Float3>& _ik_targets,
+                           int* _num_ik_targets) const {
+  if (_frame < 0 || _frame >= num_frames_ || !_num_layers) {
+    return false;
+  }
+
+  const char* cursor = frames_.begin + frame_offsets_[_frame];
+  const int num_layers = static_cast<unsigned char>(*cursor++);
+  const int num_ik_targets = static_cast<unsigned char>(*cursor++);
+  if (_layers.count() < static_cast<size_t>(num_layers) ||
+      (_num_ik_targets &&
+       _ik_targets.count() < static_cast<size_t>(num_ik_targets))) {
+    return false;
+  }
+
+  for (int i = 0; i < num_layers; ++i) {
+    PoseStreamLayer& layer = _layers[i];
+    layer.clip = static_cast<unsigned char>(cursor[0]) |
+                 (static_cast<unsigned char>(cursor[1]) << 8);
+    cursor = ReadFloat(cursor + 2, &layer.ratio);
+    cursor = ReadFloat(cursor, &layer.weight);
+  }
+  *_num_layers = num_layers;
+
+  if (_num_ik_targets) {
+    for (int i = 0; i < num_ik_targets; ++i) {
+      math::Float3& target = _ik_targets[i];
+      cursor = ReadFloat(cursor, &target.x);
+      cursor = ReadFloat(cursor, &target.y);
+      cursor = ReadFloat(cursor, &target.z);
+    }
+    *_num_ik_targets = num_ik_targets;
+  }
+  return true;
+}
+
+int PoseStream::FindSnapshot(int _frame) const {
+  if (_frame < 0 || num_snapshots_ == 0) {
+    return -1;
+  }
+  const int snapshot = _frame / settings_.snapshot_interval;
+  return snapshot < num_snapshots_ ? snapshot : num_snapshots_ - 1;
+}
+
+bool PoseStream::ReadSnapshot(int _snapshot,
+                              const Range<math::SoaTransform>& _pose) const {
+  if (_snapshot < 0 || _snapshot >= num_snapshots_ ||
+      _pose.count() < static_cast<size_t>(num_soa_transforms_)) {
+    return false;
+  }
+  PoseDecodingJob job;
+  job.translation_precision = settings_.translation_precision;
+  job.rotation_precision = settings_.rotation_precision;
+  job.scale_precision = settings_.scale_precision;
+  job.buffer =
+      Range<const char>(snapshots_.begin + snapshot_offsets_[_snapshot],
+                        snapshots_.begin + snapshot_offsets_[_snapshot + 1]);
+  job.output = Range<math::SoaTransform>(_pose.begin, num_soa_transforms_);
+  return job.Run();
+}
+
+size_t PoseStream::size() const {
+  size_t size = sizeof(*this);
+  if (num_frames_ > 0) {
+    size += frame_offsets_[num_frames_] +
+            (num_frames_ + 1) * sizeof(*frame_offsets_.begin);
+  }
+  if (num_snapshots_ > 0) {
+    size += snapshot_offsets_[num_snapshots_] +
+            (num_snapshots_ + 1) * sizeof(*snapshot_offsets_.begin);
+  }
+  return size;
+}
+
+void PoseStream::Save(ozz::io::OArchive& _archive) const {
+  _archive << static_cast<int32_t>(settings_.snapshot_interval);
+  _archive << settings_.translation_precision;
+  _archive << settings_.rotation_precision;
+  _archive << settings_.scale_precision;
+
+  _archive << static_cast<int32_t>(num_frames_);
+  _archive << static_cast<int32_t>(num_snapshots_);
+  _archive << static_cast<int32_t>(num_soa_transforms_);
+
+  if (num_frames_ > 0) {
+    _archive << ozz::io::MakeArray(frame_offsets_.begin, num_frames_ + 1);
+    _archive << ozz::io::MakeArray(frames_.begin,
+                                   frame_offsets_[num_frames_]);
+  }
+  if (num_snapshots_ > 0) {
+    _archive << ozz::io::MakeArray(snapshot_offsets_.begin,
+                                   num_snapshots_ + 1);
+    _archive << ozz::io::MakeArray(snapshots_.begin,
+                                   snapshot_offsets_[num_snapshots_]);
+  }
+}
+
+void PoseStream::Load(ozz::io::IArchive& _archive, uint32_t _version) {
+  // Destroy stream in case it was already used before.
+  Deallocate();
+  settings_ = Settings();
+
+  if (_version != 1) {
+    log::Err() << "Unsupported PoseStream version " << _version << "."
+               << std::endl;
+    return;
+  }
+
+  int32_t snapshot_interval;
+  _archive >> snapshot_interval;
+  settings_.snapshot_interval = snapshot_interval;
+  _archive >> settings_.translation_precision;
+  _archive >> settings_.rotation_precision;
+  _archive >> settings_.scale_precision;
+
+  int32_t num_frames;
+  _archive >> num_frames;
+  int32_t num_snapshots;
+  _archive >> num_snapshots;
+  int32_t num_soa_transforms;
+  _archive >> num_soa_transforms;
+
+  if (num_frames > 0) {
+    Reserve(&frame_offsets_, num_frames + 1);
+    _archive >> ozz::io::MakeArray(frame_offsets_.begin, num_frames + 1);
+    Reserve(&frames_, frame_offsets_[num_frames]);
+    _archive >> ozz::io::MakeArray(frames_.begin, frame_offsets_[num_frames]);
+  }
+  if (num_snapshots > 0) {
+    Reserve(&snapshot_offsets_, num_snapshots + 1);
+    _archive >> ozz::io::MakeArray(snapshot_offsets_.begin, num_snapshots + 1);
+    Reserve(&snapshots_, snapshot_offsets_[num_snapshots]);
+    _archive >> ozz::io::MakeArray(snapshots_.begin,
+                                   snapshot_offsets_[num_snapshots]);
+  }
+  num_frames_ = num_frames;
+  num_snapshots_ = num_snapshots;
+  num_soa_transforms_ = num_soa_transforms;
+}
+
+PoseStreamDecodingJob::PoseStreamDecodingJob()
+    : stream(NULL),
+      frame(0),
+      use_snapshots(true),
+      skeleton(NULL),
+      cache(NULL),
+      num_ik_targets(NULL) {}
+
+bool PoseStreamDecodingJob::Validate() const {
+  bool valid = true;
+  valid &= stream != NULL;
+  valid &= skeleton != NULL;
+  valid &= cache != NULL;
+  if (!valid) {
+    return false;
+  }
+  valid &= frame >= 0 && frame < stream->num_frames();
+  valid &= output.count() >= static_cast<size_t>(skeleton->num_soa_joints());
+  return valid;
+}
+
+bool PoseStreamDecodingJob::Run() const {
+  if (!Validate()) {
+    return false;
+  }
+
+  PoseStreamLayer layers[PoseStream::kMaxLayers];
+  int num_layers = 0;
+  math::Float3 targets[PoseStream::kMaxIKTargets];
+  int num_targets = 0;
+  if (!stream->ReadFrame(frame, layers, &num_layers, targets, &num_targets)) {
+    return false;
+  }
+
+  // IK targets are output whatever the pose source.
+  if (num_ik_targets) {
+    const int count = ik_targets.count() < static_cast<size_t>(num_targets)
+                          ? static_cast<int>(ik_targets.count())
+                          : num_targets;
+    for (int i = 0; i < count; ++i) {
+      ik_targets[i] = targets[i];
+    }
+    *num_ik_targets = count;
+  }
+
+  // Snapshot frames output their recorded pose.
+  const int num_soa_joints = skeleton->num_soa_joints();
+  if (use_snapshots && stream->IsSnapshotFrame(frame) &&
+      stream->num_soa_transforms() == num_soa_joints) {
+    const int snapshot = stream->FindSnapshot(frame);
+    if (snapshot >= 0 && stream->snapshot_frame(snapshot) == frame) {
+      return stream->ReadSnapshot(snapshot, output);
+    }
+  }
+
+  // Samples every layer.
+  if (scratch.count() <
+      static_cast<size_t>(num_layers) * static_cast<size_t>(num_soa_joints)) {
+    return false;
+  }
+  BlendingJob::Layer blend_layers[PoseStream::kMaxLayers];
+  for (int i = 0; i < num_layers; ++i) {
+    const PoseStreamLayer& layer = layers[i];
+    if (static_cast<size_t>(layer.clip) >= animations.count() ||
+        animations[layer.clip] == NULL) {
+      return false;
+    }
+    const Range<math::SoaTransform> locals(
+        scratch.begin + i * num_soa_joints, num_soa_joints);
+
+    SamplingJob sampling_job;
+    sampling_job.animation = animations[layer.clip];
+    sampling_job.cache = cache;
+    sampling_job.ratio = layer.ratio;
+    sampling_job.output = locals;
+    if (!sampling_job.Run()) {
+      return false;
+    }
+    blend_layers[i].weight = layer.weight;
+    blend_layers[i].transform = locals;
+  }
+
+  // Blends layers, or falls back to the bind pose if there's none.
+  BlendingJob blending_job;
+  blending_job.layers =
+      Range<const BlendingJob::Layer>(blend_layers, num_layers);
+  blending_job.bind_pose = skeleton->joint_bind_poses();
+  blending_job.output = output;
+  return blending_job.Run();
+}
+}  // namespace animation
+}  // namespace ozz
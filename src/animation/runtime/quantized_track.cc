@@ -0,0 +1,193 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#include "ozz/animation/runtime/quantized_track.h"
+
+#include "ozz/base/io/archive.h"
+#include "ozz/base/log.h"
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/memory/allocator.h"
+
+#include <cassert>
+#include <cstring>
+
+namespace ozz {
+namespace animation {
+namespace internal {
+
+template <typename _ValueType>
+QuantizedTrack<_ValueType>::QuantizedTrack() : value_size_(1), name_(NULL) {
+  OZZ_STATIC_ASSERT(kComponents * sizeof(float) == sizeof(_ValueType));
+  for (int c = 0; c < kComponents; ++c) {
+    offsets_[c] = 0.f;
+    scales_[c] = 0.f;
+  }
+}
+
+template <typename _ValueType>
+QuantizedTrack<_ValueType>::~QuantizedTrack() {
+  Deallocate();
+}
+
+template <typename _ValueType>
+void QuantizedTrack<_ValueType>::Allocate(size_t _keys_count, int _value_size,
+                                          size_t _name_len) {
+  memory::ScopedAllocationTag tag(memory::kTagTrack);
+
+  assert(ratios_.size() == 0 && values_.size() == 0);
+  assert(_value_size == 1 || _value_size == 2);
+
+  // Distributes buffer memory while ensuring proper alignment (serves larger
+  // alignment values first). Ratios size is a multiple of 2 bytes, so 16 bits
+  // values remain aligned.
+  OZZ_STATIC_ASSERT(OZZ_ALIGN_OF(uint16_t) >= OZZ_ALIGN_OF(uint8_t));
+
+  // Compute overall size and allocate a single buffer for all the data.
+  const size_t values_size = _keys_count * kComponents * _value_size;
+  const size_t buffer_size = _keys_count * sizeof(uint16_t) +  // ratios
+                             values_size +                     // values
+                             (_keys_count + 7) * sizeof(uint8_t) / 8 +  // steps
+                             (_name_len > 0 ? _name_len + 1 : 0);
+  char* buffer = reinterpret_cast<char*>(memory::default_allocator()->Allocate(
+      buffer_size, OZZ_ALIGN_OF(uint16_t)));
+
+  // Fix up pointers. Serves larger alignment values first.
+  ratios_.begin = reinterpret_cast<uint16_t*>(buffer);
+  assert(math::IsAligned(ratios_.begin, OZZ_ALIGN_OF(uint16_t)));
+  buffer += _keys_count * sizeof(uint16_t);
+  ratios_.end = reinterpret_cast<uint16_t*>(buffer);
+
+  values_.begin = reinterpret_cast<uint8_t*>(buffer);
+  buffer += values_size;
+  values_.end = reinterpret_cast<uint8_t*>(buffer);
+
+  steps_.begin = reinterpret_cast<uint8_t*>(buffer);
+  buffer += (_keys_count + 7) * sizeof(uint8_t) / 8;
+  steps_.end = reinterpret_cast<uint8_t*>(buffer);
+
+  value_size_ = _value_size;
+
+  // Let name be NULL if track has no name.
+  name_ = reinterpret_cast<char*>(_name_len > 0 ? buffer : NULL);
+}
+
+template <typename _ValueType>
+void QuantizedTrack<_ValueType>::Deallocate() {
+  // Deallocate everything at once.
+  memory::default_allocator()->Deallocate(ratios_.begin);
+
+  ratios_.Clear();
+  values_.Clear();
+  steps_.Clear();
+  value_size_ = 1;
+  name_ = NULL;
+}
+
+template <typename _ValueType>
+size_t QuantizedTrack<_ValueType>::size() const {
+  const size_t size =
+      sizeof(*this) + ratios_.size() + values_.size() + steps_.size();
+  return size;
+}
+
+template <typename _ValueType>
+void QuantizedTrack<_ValueType>::Save(ozz::io::OArchive& _archive) const {
+  uint32_t num_keys = static_cast<uint32_t>(ratios_.count());
+  _archive << num_keys;
+
+  _archive << static_cast<uint8_t>(value_size_);
+
+  const size_t name_len = name_ ? std::strlen(name_) : 0;
+  _archive << static_cast<int32_t>(name_len);
+
+  _archive << ozz::io::MakeArray(offsets_);
+  _archive << ozz::io::MakeArray(scales_);
+
+  _archive << ozz::io::MakeArray(ratios_);
+  if (value_size_ == 1) {
+    _archive << ozz::io::MakeArray(values_);
+  } else {
+    // Serializes 16 bits values as such, to support endianness swapping.
+    _archive << ozz::io::MakeArray(
+        reinterpret_cast<const uint16_t*>(values_.begin), values_.size() / 2);
+  }
+  _archive << ozz::io::MakeArray(steps_);
+
+  _archive << ozz::io::MakeArray(name_, name_len);
+}
+
+template <typename _ValueType>
+void QuantizedTrack<_ValueType>::Load(ozz::io::IArchive& _archive,
+                                      uint32_t _version) {
+  // Destroy track in case it was already used before.
+  Deallocate();
+
+  if (_version > 1) {
+    log::Err() << "Unsupported QuantizedTrack version " << _version << "."
+               << std::endl;
+    return;
+  }
+
+  uint32_t num_keys;
+  _archive >> num_keys;
+
+  uint8_t value_size;
+  _archive >> value_size;
+
+  int32_t name_len;
+  _archive >> name_len;
+
+  Allocate(num_keys, value_size, name_len);
+
+  _archive >> ozz::io::MakeArray(offsets_);
+  _archive >> ozz::io::MakeArray(scales_);
+
+  _archive >> ozz::io::MakeArray(ratios_);
+  if (value_size_ == 1) {
+    _archive >> ozz::io::MakeArray(values_);
+  } else {
+    _archive >> ozz::io::MakeArray(reinterpret_cast<uint16_t*>(values_.begin),
+                                   values_.size() / 2);
+  }
+  _archive >> ozz::io::MakeArray(steps_);
+
+  if (name_) {  // NULL name_ is supported.
+    _archive >> ozz::io::MakeArray(name_, name_len);
+    name_[name_len] = 0;
+  }
+}
+
+// Explicitly instantiate supported tracks.
+template class QuantizedTrack<float>;
+template class QuantizedTrack<math::Float2>;
+template class QuantizedTrack<math::Float3>;
+template class QuantizedTrack<math::Float4>;
+
+}  // namespace internal
+}  // namespace animation
+}  // namespace ozz
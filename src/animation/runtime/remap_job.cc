@@ -0,0 +1,112 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/remap_job.h"
+
+#include <cassert>
+
+#include "ozz/base/maths/soa_transform.h"
+
+namespace ozz {
+namespace animation {
+
+RemapJob::RemapJob() {}
+
+bool RemapJob::Validate() const {
+  // Don't stop validation on the first failure, in order to make it easier
+  // to debug.
+  bool success = true;
+
+  // Test for NULL pointers, an empty remap table is valid though.
+  success &= remap.begin != NULL || remap.end == NULL;
+  success &= input.begin != NULL;
+  success &= output.begin != NULL;
+
+  // Remapping can't be done in place.
+  success &= input.begin != output.begin;
+
+  // Tests output range.
+  const ptrdiff_t num_joints = remap.count();
+  success &= output.count() >= static_cast<size_t>((num_joints + 3) / 4);
+
+  // Tests remap entries.
+  const ptrdiff_t num_input_joints = input.count() * 4;
+  for (const int* entry = remap.begin; entry < remap.end; ++entry) {
+    success &= *entry < num_input_joints;
+  }
+
+  return success;
+}
+
+namespace {
+// Number of floats of a SoaTransform, which is made of 10 SimdFloat4:
+// translation x, y, z, rotation x, y, z, w and scale x, y, z.
+const int kSoaTransformComponents = 10;
+OZZ_STATIC_ASSERT(sizeof(math::SoaTransform) ==
+                  sizeof(float) * 4 * kSoaTransformComponents);
+
+// Copies lane _from of _input soa transform to lane _to of _output.
+void CopyLane(const math::SoaTransform& _input, int _from,
+              math::SoaTransform* _output, int _to) {
+  const float* in = reinterpret_cast<const float*>(&_input);
+  float* out = reinterpret_cast<float*>(_output);
+  for (int c = 0; c < kSoaTransformComponents; ++c) {
+    out[c * 4 + _to] = in[c * 4 + _from];
+  }
+}
+}  // namespace
+
+bool RemapJob::Run() const {
+  if (!Validate()) {
+    return false;
+  }
+
+  const int num_joints = static_cast<int>(remap.count());
+  for (int i = 0; i < num_joints; i += 4) {
+    math::SoaTransform& soa_output = output.begin[i / 4];
+
+    // Copies the whole soa block if it matches a source block.
+    const int first = remap.begin[i];
+    if (first >= 0 && (first & 3) == 0 && i + 4 <= num_joints &&
+        remap.begin[i + 1] == first + 1 && remap.begin[i + 2] == first + 2 &&
+        remap.begin[i + 3] == first + 3) {
+      soa_output = input.begin[first / 4];
+      continue;
+    }
+
+    // Otherwise copies joints one by one.
+    for (int j = i; j < i + 4 && j < num_joints; ++j) {
+      const int from = remap.begin[j];
+      if (from >= 0) {
+        CopyLane(input.begin[from / 4], from & 3, &soa_output, j & 3);
+      }
+    }
+  }
+  return true;
+}
+}  // namespace animation
+}  // namespace ozz
@@ -0,0 +1,135 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/root_motion_job.h"
+
+#include <cmath>
+
+#include "ozz/animation/runtime/track.h"
+#include "ozz/animation/runtime/track_sampling_job.h"
+#include "ozz/base/maths/quaternion.h"
+#include "ozz/base/maths/vec_float.h"
+
+namespace ozz {
+namespace animation {
+
+RootMotionJob::RootMotionJob()
+    : from(0.f),
+      to(0.f),
+      translation(NULL),
+      rotation(NULL),
+      delta_translation(NULL),
+      delta_rotation(NULL) {}
+
+bool RootMotionJob::Validate() const {
+  bool success = true;
+  success &= translation != NULL;
+  success &= rotation != NULL;
+  success &= delta_translation != NULL;
+  success &= delta_rotation != NULL;
+  return success;
+}
+
+namespace {
+// Rigid motion, rotation being applied before translation.
+struct Motion {
+  math::Float3 translation;
+  math::Quaternion rotation;
+};
+
+// Samples root motion tracks at _ratio, in range [0,1].
+Motion Sample(const RootMotionJob& _job, float _ratio) {
+  Motion motion;
+  Float3TrackSamplingJob translation_job;
+  translation_job.ratio = _ratio;
+  translation_job.track = _job.translation;
+  translation_job.result = &motion.translation;
+  translation_job.Run();
+  QuaternionTrackSamplingJob rotation_job;
+  rotation_job.ratio = _ratio;
+  rotation_job.track = _job.rotation;
+  rotation_job.result = &motion.rotation;
+  rotation_job.Run();
+  return motion;
+}
+
+// Applies _b motion, expressed in _a space, after _a.
+Motion Compose(const Motion& _a, const Motion& _b) {
+  const Motion motion = {
+      _a.translation + TransformVector(_a.rotation, _b.translation),
+      _a.rotation * _b.rotation};
+  return motion;
+}
+
+Motion Invert(const Motion& _motion) {
+  const math::Quaternion inv_rotation = Conjugate(_motion.rotation);
+  const Motion motion = {-TransformVector(inv_rotation, _motion.translation),
+                         inv_rotation};
+  return motion;
+}
+
+// Computes motion from _from to _to, expressed in _from space.
+Motion Relative(const Motion& _from, const Motion& _to) {
+  return Compose(Invert(_from), _to);
+}
+
+// Computes motion from ratio _from to ratio _to, where _from <= _to. Integer
+// part of ratios are loops.
+Motion Forward(const RootMotionJob& _job, float _from, float _to) {
+  const float from_loop = std::floor(_from);
+  const float to_loop = std::floor(_to);
+  const Motion from = Sample(_job, _from - from_loop);
+  if (from_loop == to_loop) {
+    return Relative(from, Sample(_job, _to - to_loop));
+  }
+
+  // Accumulates end of the first loop, whole loops and beginning of the last
+  // one.
+  const Motion begin = Sample(_job, 0.f);
+  const Motion end = Sample(_job, 1.f);
+  const Motion cycle = Relative(begin, end);
+  Motion motion = Relative(from, end);
+  for (float loop = from_loop + 1.f; loop < to_loop; loop += 1.f) {
+    motion = Compose(motion, cycle);
+  }
+  return Compose(motion, Relative(begin, Sample(_job, _to - to_loop)));
+}
+}  // namespace
+
+bool RootMotionJob::Run() const {
+  if (!Validate()) {
+    return false;
+  }
+
+  const Motion motion =
+      from <= to ? Forward(*this, from, to) : Invert(Forward(*this, to, from));
+  *delta_translation = motion.translation;
+  *delta_rotation = motion.rotation;
+  return true;
+}
+}  // namespace animation
+}  // namespace ozz
@@ -0,0 +1,131 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/sampling_cache_pool.h"
+
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/base/memory/allocator.h"
+
+namespace ozz {
+namespace animation {
+
+SamplingCachePool::SamplingCachePool()
+    : num_caches_(0), max_soa_tracks_(0), use_counter_(0), entries_(NULL) {}
+
+SamplingCachePool::SamplingCachePool(int _max_tracks, int _num_caches,
+                                     SamplingCache::Mode _mode)
+    : num_caches_(0), max_soa_tracks_(0), use_counter_(0), entries_(NULL) {
+  Resize(_max_tracks, _num_caches, _mode);
+}
+
+SamplingCachePool::~SamplingCachePool() { Deallocate(); }
+
+void SamplingCachePool::Deallocate() {
+  memory::Allocator* allocator = memory::default_allocator();
+  for (int i = 0; i < num_caches_; ++i) {
+    allocator->Delete(entries_[i].cache);
+  }
+  allocator->Deallocate(entries_);
+  entries_ = NULL;
+  num_caches_ = 0;
+}
+
+void SamplingCachePool::Resize(int _max_tracks, int _num_caches,
+                               SamplingCache::Mode _mode) {
+  Deallocate();
+
+  max_soa_tracks_ = (_max_tracks + 3) / 4;
+  num_caches_ = _num_caches > 0 ? _num_caches : 0;
+
+  memory::Allocator* allocator = memory::default_allocator();
+  entries_ = reinterpret_cast<Entry*>(
+      allocator->Allocate(sizeof(Entry) * num_caches_, OZZ_ALIGN_OF(Entry)));
+  for (int i = 0; i < num_caches_; ++i) {
+    entries_[i].cache =
+        allocator->New<SamplingCache>(max_soa_tracks_ * 4, _mode);
+  }
+
+  Invalidate();
+}
+
+void SamplingCachePool::Invalidate() {
+  use_counter_ = 0;
+  for (int i = 0; i < num_caches_; ++i) {
+    Entry& entry = entries_[i];
+    entry.cache->Invalidate();
+    entry.animation = NULL;
+    entry.uid = 0;
+    entry.last_use = 0;
+  }
+}
+
+SamplingCache* SamplingCachePool::Get(const Animation& _animation) {
+  if (_animation.num_soa_tracks() > max_soa_tracks_) {
+    return NULL;
+  }
+
+  // Searches for the cache of _animation, and for the best one to recycle
+  // otherwise: an unused one, or the least recently used one.
+  Entry* found = NULL;
+  Entry* recycle = NULL;
+  for (int i = 0; i < num_caches_; ++i) {
+    Entry& entry = entries_[i];
+    if (entry.animation == &_animation && entry.uid == _animation.uid()) {
+      found = &entry;
+      break;
+    }
+    if (!recycle || !entry.animation ||
+        (recycle->animation && entry.last_use < recycle->last_use)) {
+      recycle = &entry;
+    }
+  }
+
+  if (!found) {
+    if (!recycle) {
+      return NULL;  // Empty pool.
+    }
+    recycle->cache->Invalidate();
+    recycle->animation = &_animation;
+    recycle->uid = _animation.uid();
+    found = recycle;
+  }
+
+  found->last_use = ++use_counter_;
+  return found->cache;
+}
+
+bool SamplingCachePool::Contains(const Animation& _animation) const {
+  for (int i = 0; i < num_caches_; ++i) {
+    const Entry& entry = entries_[i];
+    if (entry.animation == &_animation && entry.uid == _animation.uid()) {
+      return true;
+    }
+  }
+  return false;
+}
+}  // namespace animation
+}  // namespace ozz
@@ -27,13 +27,19 @@
 
 #include "ozz/animation/runtime/sampling_job.h"
 
+#include <algorithm>
 #include <cassert>
+#include <cstring>
 
+#include "ozz/animation/runtime/accumulated_blending_job.h"
 #include "ozz/animation/runtime/animation.h"
 #include "ozz/base/maths/math_constant.h"
 #include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/soa_half_transform.h"
 #include "ozz/base/maths/soa_transform.h"
 #include "ozz/base/memory/allocator.h"
+#include "ozz/base/profile.h"
+#include "ozz/base/task_scheduler.h"
 
 // Internal include file
 #define OZZ_INCLUDE_PRIVATE_HEADER  // Allows to include private headers.
@@ -55,8 +61,48 @@ struct InterpSoaScale {
   math::SimdFloat4 ratio[2];
   math::SoaFloat3 value[2];
 };
+
+// Compact mode hot data. Ratios and translation/scale values are copied from
+// their quantized keys, while rotations are stored as 16 bits quaternion
+// components.
+struct PackedSoaFloat3 {
+  uint16_t ratio[2][4];
+  uint16_t value[2][3][4];
+};
+struct PackedSoaRotation {
+  uint16_t ratio[2][4];
+  int16_t value[2][4][4];
+};
+
+// Spline mode hot data, left and right key tangents.
+struct InterpSoaFloat3Tangent {
+  math::SoaFloat3 value[2];
+};
+struct InterpSoaQuaternionTangent {
+  math::SoaQuaternion value[2];
+};
 }  // namespace internal
 
+namespace {
+// Tests if _cache can sample _animation.
+bool CanSample(const SamplingCache& _cache, const Animation& _animation) {
+  bool valid = _cache.max_soa_tracks() >= _animation.num_soa_tracks();
+
+  // Key indices and key times are stored on 16 bits in compact mode.
+  if (_cache.compact()) {
+    const ptrdiff_t kMaxKeys = 65536;
+    valid &= _animation.translations().count() <= kMaxKeys;
+    valid &= _animation.rotations().count() <= kMaxKeys;
+    valid &= _animation.scales().count() <= kMaxKeys;
+    valid &= !_animation.has_key_times();
+  }
+
+  // Tangents are only cached in spline mode.
+  valid &= !_animation.spline() || _cache.mode() == SamplingCache::kSpline;
+  return valid;
+}
+}  // namespace
+
 bool SamplingJob::Validate() const {
   // Don't need any early out, as jobs are valid in most of the performance
   // critical cases.
@@ -67,75 +113,176 @@ bool SamplingJob::Validate() const {
   if (!animation || !cache) {
     return false;
   }
-  valid &= output.begin != NULL;
+  // Exactly one of output, half_output and accumulator is specified.
+  const bool half = half_output.begin != NULL;
+  const bool accumulate = accumulator.begin != NULL;
+  valid &= (output.begin != NULL) + half + accumulate == 1;
 
-  // Tests output range, implicitly tests output.end != NULL.
+  // Tests output range, implicitly tests output.end != NULL. Scattered sparse
+  // animations output up to their last soa joint.
   const ptrdiff_t num_soa_tracks = animation->num_soa_tracks();
-  valid &= output.end - output.begin >= num_soa_tracks;
+  const bool scattered = scatter && animation->sparse();
+  const ptrdiff_t num_outputs =
+      scattered ? animation->soa_joints().end[-1] + 1 : num_soa_tracks;
+  valid &= (half ? half_output.end - half_output.begin
+                 : accumulate ? accumulator.end - accumulator.begin
+                              : output.end - output.begin) >= num_outputs;
 
-  // Tests cache size.
-  valid &= cache->max_soa_tracks() >= num_soa_tracks;
+  // Accumulation can't be incremental, and needs positive weights.
+  if (accumulate) {
+    valid &= changed.begin == NULL;
+    valid &= weight >= 0.f;
+    if (joint_weights.begin) {
+      valid &= joint_weights.end - joint_weights.begin >= num_outputs;
+    }
+  }
+
+  // Velocities aren't scattered.
+  valid &=
+      !scattered || (!linear_velocities.begin && !angular_velocities.begin);
+
+  // Precision lod can't be negative.
+  valid &= precision_lod >= 0;
+
+  // Tests cache size and mode.
+  valid &= CanSample(*cache, *animation);
+
+  // Tests optional mask and changed sizes.
+  if (mask.begin) {
+    valid &= mask.end - mask.begin >= (num_soa_tracks + 7) / 8;
+  }
+  if (changed.begin) {
+    valid &= changed.end - changed.begin >= (num_soa_tracks + 7) / 8;
+  }
+
+  // Tests optional velocities output ranges.
+  if (linear_velocities.begin) {
+    valid &= linear_velocities.end - linear_velocities.begin >= num_soa_tracks;
+  }
+  if (angular_velocities.begin) {
+    valid &=
+        angular_velocities.end - angular_velocities.begin >= num_soa_tracks;
+  }
 
   return valid;
 }
 
 namespace {
-// Loops through the sorted key frames and update cache structure.
-template <typename _Key>
-void UpdateKeys(float _ratio, int _num_soa_tracks, ozz::Range<const _Key> _keys,
-                int* _cursor, int* _cache, unsigned char* _outdated) {
+// Flags all soa entries as outdated. It cares to only flag valid soa entries as
+// this is the exit condition of other algorithms.
+void OutdateAll(int _num_soa_tracks, uint8_t* _outdated) {
+  const int num_outdated_flags = (_num_soa_tracks + 7) / 8;
+  for (int i = 0; i < num_outdated_flags - 1; ++i) {
+    _outdated[i] = 0xff;
+  }
+  _outdated[num_outdated_flags - 1] =
+      0xff >> (num_outdated_flags * 8 - _num_soa_tracks);
+}
+
+// Counts outdated soa entries, amongst the ones set in optional _mask.
+int CountOutdated(int _num_soa_tracks, const uint8_t* _mask,
+                  const uint8_t* _outdated) {
+  int count = 0;
+  const int num_outdated_flags = (_num_soa_tracks + 7) / 8;
+  for (int i = 0; i < num_outdated_flags; ++i) {
+    for (int flags = _mask ? _outdated[i] & _mask[i] : _outdated[i]; flags;
+         flags &= flags - 1) {
+      ++count;
+    }
+  }
+  return count;
+}
+
+// Loops through the sorted key frames and update cache structure up to _frame,
+// the sampling time in frames (see Animation::num_frames()). _times are _keys
+// float times, or NULL (see Animation::has_key_times()).
+// _num_constants is the number of constant tracks, whose single key frame is
+// stored at the beginning of _keys. _Index is the type of _cache key indices.
+// Keys whose precision lod (_key_lods, NULL if the animation has none) is
+// lower than _lod are skipped, see SamplingJob::precision_lod.
+template <typename _Key, typename _Index>
+void UpdateKeys(float _frame, int _num_soa_tracks, int _num_constants,
+                ozz::Range<const _Key> _keys, const float* _times,
+                int* _cursor, _Index* _cache, unsigned char* _outdated,
+                const uint8_t* _key_lods, const int* _lod_next, int _lod) {
   assert(_num_soa_tracks >= 1);
   const int num_tracks = _num_soa_tracks * 4;
-  assert(_keys.begin + num_tracks * 2 <= _keys.end);
+  assert(_num_constants >= 0 && _num_constants <= num_tracks);
+  const int num_animated = num_tracks - _num_constants;
+  const int num_seed_keys = _num_constants + num_animated * 2;
+  assert(_keys.begin + num_seed_keys <= _keys.end);
 
   const _Key* cursor = &_keys.begin[*_cursor];
   if (!*_cursor) {
-    // Initializes interpolated entries with the first 2 sets of key frames.
-    // The sorting algorithm ensures that the first 2 key frames of a track
-    // are consecutive.
-    for (int i = 0; i < _num_soa_tracks; ++i) {
-      const int in_index0 = i * 4;                   // * soa size
-      const int in_index1 = in_index0 + num_tracks;  // 2nd row.
-      const int out_index = i * 4 * 2;
-      _cache[out_index + 0] = in_index0 + 0;
-      _cache[out_index + 1] = in_index1 + 0;
-      _cache[out_index + 2] = in_index0 + 1;
-      _cache[out_index + 3] = in_index1 + 1;
-      _cache[out_index + 4] = in_index0 + 2;
-      _cache[out_index + 5] = in_index1 + 2;
-      _cache[out_index + 6] = in_index0 + 3;
-      _cache[out_index + 7] = in_index1 + 3;
-    }
-    cursor = _keys.begin + num_tracks * 2;  // New cursor position.
-
-    // All entries are outdated. It cares to only flag valid soa entries as
-    // this is the exit condition of other algorithms.
-    const int num_outdated_flags = (_num_soa_tracks + 7) / 8;
-    for (int i = 0; i < num_outdated_flags - 1; ++i) {
-      _outdated[i] = 0xff;
-    }
-    _outdated[num_outdated_flags - 1] =
-        0xff >> (num_outdated_flags * 8 - _num_soa_tracks);
+    // Constant tracks use their single key frame as both left and right keys.
+    // They are never updated by the key frames scan below.
+    for (int i = 0; i < _num_constants; ++i) {
+      const int base = _keys.begin[i].track * 2;
+      _cache[base + 0] = static_cast<_Index>(i);
+      _cache[base + 1] = static_cast<_Index>(i);
+    }
+
+    // Initializes animated tracks entries with the first 2 sets of key frames.
+    // The sorting algorithm ensures that the first 2 sets store the same
+    // tracks in the same order.
+    for (int i = _num_constants; i < _num_constants + num_animated; ++i) {
+      const int base = _keys.begin[i].track * 2;
+      _cache[base + 0] = static_cast<_Index>(i);
+      _cache[base + 1] = static_cast<_Index>(i + num_animated);
+    }
+    cursor = _keys.begin + num_seed_keys;  // New cursor position.
+
+    // All entries are outdated.
+    OutdateAll(_num_soa_tracks, _outdated);
   } else {
-    assert(cursor >= _keys.begin + num_tracks * 2 && cursor <= _keys.end);
+    assert(cursor >= _keys.begin + num_seed_keys && cursor <= _keys.end);
   }
 
   // Search for the keys that matches _ratio.
   // Iterates while the cache is not updated with left and right keys required
-  // for interpolation at time ratio _ratio, for all tracks. Thanks to the
-  // keyframe sorting, the loop can end as soon as it finds a key greater that
-  // _ratio. It will mean that all the keys lower than _ratio have been
-  // processed, meaning all cache entries are up to date.
-  while (cursor < _keys.end &&
-         _keys.begin[_cache[cursor->track * 2 + 1]].ratio <= _ratio) {
-    // Flag this soa entry as outdated.
-    _outdated[cursor->track / 32] |= (1 << ((cursor->track & 0x1f) / 4));
-    // Updates cache.
-    const int base = cursor->track * 2;
-    _cache[base] = _cache[base + 1];
-    _cache[base + 1] = static_cast<int>(cursor - _keys.begin);
-    // Process next key.
-    ++cursor;
+  // for interpolation at time _frame, for all tracks. Thanks to the keyframe
+  // sorting, the loop can end as soon as it finds a key greater that _frame.
+  // It will mean that all the keys lower than _frame have been processed,
+  // meaning all cache entries are up to date.
+  if (_key_lods) {
+    // Precision lod variant. When a track needs its next key, the right key
+    // jumps to the first following key whose lod is high enough, following
+    // _lod_next indices. Skipped keys are still scanned, as they are
+    // interleaved with other tracks keys, but they are recognized as being
+    // before the cache right key, so they neither update the cache nor
+    // outdate soa entries. This variant is also used for _lod 0, as the cache
+    // might have jumped keys with a previous lod.
+    while (cursor < _keys.end) {
+      const int index = static_cast<int>(cursor - _keys.begin);
+      const int base = cursor->track * 2;
+      const int right = _cache[base + 1];
+      if (index > right) {
+        if (KeyFrame(_keys.begin, _times, right) > _frame) {
+          break;
+        }
+        int key = index;
+        while (_key_lods[key] < _lod) {
+          key = _lod_next[key];
+        }
+        _outdated[cursor->track / 32] |= (1 << ((cursor->track & 0x1f) / 4));
+        _cache[base] = _cache[base + 1];
+        _cache[base + 1] = static_cast<_Index>(key);
+      }
+      ++cursor;
+    }
+  } else {
+    while (cursor < _keys.end &&
+           KeyFrame(_keys.begin, _times, _cache[cursor->track * 2 + 1]) <=
+               _frame) {
+      // Flag this soa entry as outdated.
+      _outdated[cursor->track / 32] |= (1 << ((cursor->track & 0x1f) / 4));
+      // Updates cache.
+      const int base = cursor->track * 2;
+      _cache[base] = _cache[base + 1];
+      _cache[base + 1] = static_cast<_Index>(cursor - _keys.begin);
+      // Process next key.
+      ++cursor;
+    }
   }
   assert(cursor <= _keys.end);
 
@@ -143,14 +290,160 @@ void UpdateKeys(float _ratio, int _num_soa_tracks, ozz::Range<const _Key> _keys,
   *_cursor = static_cast<int>(cursor - _keys.begin);
 }
 
-void UpdateSoaTranslations(int _num_soa_tracks,
+// Re-seeds _cache with the first 2 sets of key frames, the same way as
+// UpdateKeys does for a null cursor, and moves *_cursor after them. As opposed
+// to UpdateKeys, entries are only outdated if their keys changed, as the cache
+// already refers to the same animation. Constant tracks keys never change.
+template <typename _Key, typename _Index>
+void RewindKeys(int _num_soa_tracks, int _num_constants,
+                ozz::Range<const _Key> _keys, int* _cursor, _Index* _cache,
+                unsigned char* _outdated) {
+  if (!*_cursor) {
+    return;  // Not seeded yet, UpdateKeys seeds everything.
+  }
+  const int num_animated = _num_soa_tracks * 4 - _num_constants;
+  for (int i = _num_constants; i < _num_constants + num_animated; ++i) {
+    const int track = _keys.begin[i].track;
+    const int base = track * 2;
+    const _Index left = static_cast<_Index>(i);
+    const _Index right = static_cast<_Index>(i + num_animated);
+    if (_cache[base] != left || _cache[base + 1] != right) {
+      _cache[base] = left;
+      _cache[base + 1] = right;
+      _outdated[track / 32] |= (1 << ((track & 0x1f) / 4));
+    }
+  }
+  *_cursor = _num_constants + num_animated * 2;
+}
+
+// Restores unit interval time ratios of the 4 keys of a soa track side, from
+// their time in frames and the inverse of the animation number of frames.
+// _interp points to the first key index of the side, track indices being
+// interleaved with the other side ones. _times are _keys float times, or NULL.
+template <typename _Key, typename _Index>
+OZZ_INLINE math::SimdFloat4 LoadRatios(const _Key* _keys, const float* _times,
+                                       const _Index* _interp,
+                                       math::SimdFloat4 _inv_frames) {
+  if (_times) {
+    return math::simd_float4::Load(_times[_interp[0]], _times[_interp[2]],
+                                   _times[_interp[4]], _times[_interp[6]]) *
+           _inv_frames;
+  }
+  const math::SimdFloat4 frames = math::simd_float4::FromInt(
+      math::simd_int4::Load(_keys[_interp[0]].ratio, _keys[_interp[2]].ratio,
+                            _keys[_interp[4]].ratio, _keys[_interp[6]].ratio));
+  return frames * _inv_frames;
+}
+
+// Restores unit interval time ratios of 4 right side keys. Constant tracks use
+// the same key on both sides, in which case the right ratio is set to 1 so that
+// the interpolation coefficient remains finite.
+template <typename _Key, typename _Index>
+OZZ_INLINE math::SimdFloat4 LoadRightRatios(const _Key* _keys,
+                                            const float* _times,
+                                            const _Index* _interp,
+                                            math::SimdFloat4 _left,
+                                            math::SimdFloat4 _inv_frames) {
+  const math::SimdFloat4 right =
+      LoadRatios(_keys, _times, _interp, _inv_frames);
+  return math::Select(math::CmpEq(right, _left), math::simd_float4::one(),
+                      right);
+}
+
+// Restores 4 ranged values (see KeyRange) of component _c.
+OZZ_INLINE math::SimdFloat4 Dequantize(const KeyRange& _range, int _c, int _v0,
+                                       int _v1, int _v2, int _v3) {
+  const math::SimdFloat4 min = math::simd_float4::LoadPtrU(_range.min[_c]);
+  const math::SimdFloat4 step = math::simd_float4::LoadPtrU(_range.step[_c]);
+  const math::SimdFloat4 value =
+      math::simd_float4::FromInt(math::simd_int4::Load(_v0, _v1, _v2, _v3));
+  return math::MAdd(value, step, min);
+}
+
+// Restores left or right (_side) ranged values of translation or scale soa
+// track _i, which are bit packed in _values (see KeyRange).
+template <typename _Key>
+OZZ_INLINE math::SoaFloat3 DecompressSoaFloat3(
+    const _Key* _keys, const KeyRange* _ranges, const uint8_t* _values,
+    const uint32_t* _value_offsets, const int* _interp, int _i, int _side) {
+  const int base = _i * 4 * 2;  // * soa size * 2 keys
+  int v[4][3];
+  for (int k = 0; k < 4; ++k) {
+    UnpackKeyValues(_keys, _ranges, _value_offsets, _values,
+                    _interp[base + k * 2 + _side], v[k]);
+  }
+  const KeyRange& range = _ranges[_i];
+  const math::SoaFloat3 value = {
+      Dequantize(range, 0, v[0][0], v[1][0], v[2][0], v[3][0]),
+      Dequantize(range, 1, v[0][1], v[1][1], v[2][1], v[3][1]),
+      Dequantize(range, 2, v[0][2], v[1][2], v[2][2], v[3][2])};
+  return value;
+}
+
+// Restores 4 half float tangent components _c.
+template <typename _Tangent>
+OZZ_INLINE math::SimdFloat4 LoadTangents(const _Tangent& _t0,
+                                         const _Tangent& _t1,
+                                         const _Tangent& _t2,
+                                         const _Tangent& _t3, int _c) {
+  return math::HalfToFloat(math::simd_int4::Load(
+      _t0.value[_c], _t1.value[_c], _t2.value[_c], _t3.value[_c]));
+}
+
+// Restores left and right tangents of translation or scale soa track _i.
+OZZ_INLINE void UpdateSoaFloat3Tangents(
+    const Float3Tangent* _tangents, const int* _interp, int _i,
+    internal::InterpSoaFloat3Tangent* _soa_tangents) {
+  const int base = _i * 4 * 2;  // * soa size * 2 keys
+  for (int side = 0; side < 2; ++side) {
+    const Float3Tangent& t0 = _tangents[_interp[base + 0 + side]];
+    const Float3Tangent& t1 = _tangents[_interp[base + 2 + side]];
+    const Float3Tangent& t2 = _tangents[_interp[base + 4 + side]];
+    const Float3Tangent& t3 = _tangents[_interp[base + 6 + side]];
+    math::SoaFloat3& value = _soa_tangents[_i].value[side];
+    value.x = LoadTangents(t0, t1, t2, t3, 0);
+    value.y = LoadTangents(t0, t1, t2, t3, 1);
+    value.z = LoadTangents(t0, t1, t2, t3, 2);
+  }
+}
+
+// Restores left and right tangents of rotation soa track _i.
+template <typename _Index>
+OZZ_INLINE void UpdateSoaQuaternionTangents(
+    const QuaternionTangent* _tangents, const _Index* _interp, int _i,
+    internal::InterpSoaQuaternionTangent* _soa_tangents) {
+  const int base = _i * 4 * 2;  // * soa size * 2 keys
+  for (int side = 0; side < 2; ++side) {
+    const QuaternionTangent& t0 = _tangents[_interp[base + 0 + side]];
+    const QuaternionTangent& t1 = _tangents[_interp[base + 2 + side]];
+    const QuaternionTangent& t2 = _tangents[_interp[base + 4 + side]];
+    const QuaternionTangent& t3 = _tangents[_interp[base + 6 + side]];
+    math::SoaQuaternion& value = _soa_tangents[_i].value[side];
+    value.x = LoadTangents(t0, t1, t2, t3, 0);
+    value.y = LoadTangents(t0, t1, t2, t3, 1);
+    value.z = LoadTangents(t0, t1, t2, t3, 2);
+    value.w = LoadTangents(t0, t1, t2, t3, 3);
+  }
+}
+
+// _tangents and _soa_tangents are only specified for spline animations.
+void UpdateSoaTranslations(int _num_soa_tracks, float _inv_frames,
                            ozz::Range<const TranslationKey> _keys,
-                           const int* _interp, uint8_t* _outdated,
-                           internal::InterpSoaTranslation* soa_translations_) {
+                           const float* _times,
+                           ozz::Range<const KeyRange> _ranges,
+                           const uint8_t* _values,
+                           const uint32_t* _value_offsets,
+                           const int* _interp, const uint8_t* _mask,
+                           uint8_t* _outdated,
+                           internal::InterpSoaTranslation* soa_translations_,
+                           const Float3Tangent* _tangents,
+                           internal::InterpSoaFloat3Tangent* _soa_tangents) {
+  const math::SimdFloat4 inv_frames = math::simd_float4::Load1(_inv_frames);
   const int num_outdated_flags = (_num_soa_tracks + 7) / 8;
   for (int j = 0; j < num_outdated_flags; ++j) {
-    uint8_t outdated = _outdated[j];
-    _outdated[j] = 0;  // Reset outdated entries as all will be processed.
+    // Masked out entries remain outdated, so they are updated once unmasked.
+    uint8_t outdated = _outdated[j] & (_mask ? _mask[j] : 0xff);
+    _outdated[j] ^= outdated;  // Reset outdated entries that will be processed.
     for (int i = j * 8; outdated; ++i, outdated >>= 1) {
       if (!(outdated & 1)) {
         continue;
@@ -158,32 +451,23 @@ void UpdateSoaTranslations(int _num_soa_tracks,
       const int base = i * 4 * 2;  // * soa size * 2 keys
 
       // Decompress left side keyframes and store them in soa structures.
-      const TranslationKey& k00 = _keys.begin[_interp[base + 0]];
-      const TranslationKey& k10 = _keys.begin[_interp[base + 2]];
-      const TranslationKey& k20 = _keys.begin[_interp[base + 4]];
-      const TranslationKey& k30 = _keys.begin[_interp[base + 6]];
       soa_translations_[i].ratio[0] =
-          math::simd_float4::Load(k00.ratio, k10.ratio, k20.ratio, k30.ratio);
-      soa_translations_[i].value[0].x = math::HalfToFloat(math::simd_int4::Load(
-          k00.value[0], k10.value[0], k20.value[0], k30.value[0]));
-      soa_translations_[i].value[0].y = math::HalfToFloat(math::simd_int4::Load(
-          k00.value[1], k10.value[1], k20.value[1], k30.value[1]));
-      soa_translations_[i].value[0].z = math::HalfToFloat(math::simd_int4::Load(
-          k00.value[2], k10.value[2], k20.value[2], k30.value[2]));
+          LoadRatios(_keys.begin, _times, _interp + base, inv_frames);
+      soa_translations_[i].value[0] =
+          DecompressSoaFloat3(_keys.begin, _ranges.begin, _values,
+                              _value_offsets, _interp, i, 0);
 
       // Decompress right side keyframes and store them in soa structures.
-      const TranslationKey& k01 = _keys.begin[_interp[base + 1]];
-      const TranslationKey& k11 = _keys.begin[_interp[base + 3]];
-      const TranslationKey& k21 = _keys.begin[_interp[base + 5]];
-      const TranslationKey& k31 = _keys.begin[_interp[base + 7]];
       soa_translations_[i].ratio[1] =
-          math::simd_float4::Load(k01.ratio, k11.ratio, k21.ratio, k31.ratio);
-      soa_translations_[i].value[1].x = math::HalfToFloat(math::simd_int4::Load(
-          k01.value[0], k11.value[0], k21.value[0], k31.value[0]));
-      soa_translations_[i].value[1].y = math::HalfToFloat(math::simd_int4::Load(
-          k01.value[1], k11.value[1], k21.value[1], k31.value[1]));
-      soa_translations_[i].value[1].z = math::HalfToFloat(math::simd_int4::Load(
-          k01.value[2], k11.value[2], k21.value[2], k31.value[2]));
+          LoadRightRatios(_keys.begin, _times, _interp + base + 1,
+                          soa_translations_[i].ratio[0], inv_frames);
+      soa_translations_[i].value[1] =
+          DecompressSoaFloat3(_keys.begin, _ranges.begin, _values,
+                              _value_offsets, _interp, i, 1);
+
+      if (_soa_tangents) {
+        UpdateSoaFloat3Tangents(_tangents, _interp, i, _soa_tangents);
+      }
     }
   }
 }
@@ -257,10 +541,153 @@ void UpdateSoaTranslations(int _num_soa_tracks,
     _quat.w = cpnt[3];                                                         \
   } while (void(0), 0)
 
-void UpdateSoaRotations(int _num_soa_tracks,
-                        ozz::Range<const RotationKey> _keys, const int* _interp,
-                        uint8_t* _outdated,
-                        internal::InterpSoaRotation* _soa_rotations) {
+#if defined(OZZ_SIMD_AVX2)
+// AVX2 version of DECOMPRESS_SOA_QUAT, which decompresses the 8 keys (left and
+// right) of a soa track at once. Keys are gathered from their _interp indices,
+// and largest component is restored with 8 wide branchless operations.
+// RotationKey bit fields are expected to be allocated from the least
+// significant bit, which is the case of all x86 compilers.
+void DecompressSoaQuats(const RotationKey* _keys, const int _interp[8],
+                        math::SoaQuaternion* _left,
+                        math::SoaQuaternion* _right) {
+  OZZ_STATIC_ASSERT(sizeof(RotationKey) == 10);
+
+  // Left keys go to the 4 lower lanes, right keys to the 4 upper ones.
+  const __m256i offsets = _mm256_mullo_epi32(
+      _mm256_setr_epi32(_interp[0], _interp[2], _interp[4], _interp[6],
+                        _interp[1], _interp[3], _interp[5], _interp[7]),
+      _mm256_set1_epi32(sizeof(RotationKey)));
+
+  // Gathers bit fields and value[0] from bytes 2 to 5, value[1] and value[2]
+  // from bytes 6 to 9.
+  const char* base = reinterpret_cast<const char*>(_keys);
+  const __m256i lo = _mm256_i32gather_epi32(
+      reinterpret_cast<const int*>(base + 2), offsets, 1);
+  const __m256i hi = _mm256_i32gather_epi32(
+      reinterpret_cast<const int*>(base + 6), offsets, 1);
+
+  // Sign extends the 3 smallest components.
+  const __m256i v0 = _mm256_srai_epi32(lo, 16);
+  const __m256i v1 = _mm256_srai_epi32(_mm256_slli_epi32(hi, 16), 16);
+  const __m256i v2 = _mm256_srai_epi32(hi, 16);
+
+  // Extracts largest component index and sign.
+  const __m256i largest =
+      _mm256_and_si256(_mm256_srli_epi32(lo, 13), _mm256_set1_epi32(3));
+  const __m256i sign = _mm256_slli_epi32(_mm256_srli_epi32(lo, 15), 31);
+
+  // Components before the largest one are stored in order, the ones after are
+  // shifted by one. The largest is reset to 0.
+  const __m256i l0 = _mm256_cmpeq_epi32(largest, _mm256_set1_epi32(0));
+  const __m256i l1 = _mm256_cmpeq_epi32(largest, _mm256_set1_epi32(1));
+  const __m256i l2 = _mm256_cmpeq_epi32(largest, _mm256_set1_epi32(2));
+  const __m256i l3 = _mm256_cmpeq_epi32(largest, _mm256_set1_epi32(3));
+  const __m256i lt1 = l0;
+  const __m256i lt2 = _mm256_or_si256(l0, l1);
+  const __m256i lt3 = _mm256_or_si256(lt2, l2);
+  const __m256i icpnt[4] = {
+      _mm256_andnot_si256(l0, v0),
+      _mm256_andnot_si256(l1, _mm256_blendv_epi8(v1, v0, lt1)),
+      _mm256_andnot_si256(l2, _mm256_blendv_epi8(v2, v1, lt2)),
+      _mm256_and_si256(lt3, v2)};
+
+  // Rebuilds quaternion from quantized values.
+  const __m256 kInt2Float = _mm256_set1_ps(1.f / (32767.f * math::kSqrt2));
+  __m256 cpnt[4];
+  for (int c = 0; c < 4; ++c) {
+    cpnt[c] = _mm256_mul_ps(kInt2Float, _mm256_cvtepi32_ps(icpnt[c]));
+  }
+
+  // Get back length of 4th component, the same way DECOMPRESS_SOA_QUAT does.
+  const __m256 dot = _mm256_add_ps(
+      _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(cpnt[0], cpnt[0]),
+                                  _mm256_mul_ps(cpnt[1], cpnt[1])),
+                    _mm256_mul_ps(cpnt[2], cpnt[2])),
+      _mm256_mul_ps(cpnt[3], cpnt[3]));
+  const __m256 ww0 = _mm256_max_ps(_mm256_set1_ps(1e-16f),
+                                   _mm256_sub_ps(_mm256_set1_ps(1.f), dot));
+  const __m256 w0 = _mm256_mul_ps(ww0, _mm256_rsqrt_ps(ww0));
+  const __m256 restored = _mm256_or_ps(w0, _mm256_castsi256_ps(sign));
+
+  // Re-injects the largest component.
+  const __m256i lmasks[4] = {l0, l1, l2, l3};
+  for (int c = 0; c < 4; ++c) {
+    cpnt[c] = _mm256_or_ps(
+        cpnt[c], _mm256_and_ps(restored, _mm256_castsi256_ps(lmasks[c])));
+  }
+
+  // Stores results.
+  math::SimdFloat4* left[4] = {&_left->x, &_left->y, &_left->z, &_left->w};
+  math::SimdFloat4* right[4] = {&_right->x, &_right->y, &_right->z,
+                                &_right->w};
+  for (int c = 0; c < 4; ++c) {
+    *left[c] = _mm256_castps256_ps128(cpnt[c]);
+    *right[c] = _mm256_extractf128_ps(cpnt[c], 1);
+  }
+}
+#endif  // OZZ_SIMD_AVX2
+
+// Stores left (_side = 0) or right (_side = 1) decompressed rotations of a soa
+// track to full precision hot data. _interp points to the first key index of
+// the side, see LoadRatios().
+template <typename _Index>
+OZZ_INLINE void StoreSoaRotation(int _side, const RotationKey* _keys,
+                                 const float* _times, const _Index* _interp,
+                                 const math::SoaQuaternion& _quat,
+                                 math::SimdFloat4 _inv_frames,
+                                 internal::InterpSoaRotation* _soa_rotation) {
+  _soa_rotation->ratio[_side] =
+      _side == 0 ? LoadRatios(_keys, _times, _interp, _inv_frames)
+                 : LoadRightRatios(_keys, _times, _interp,
+                                   _soa_rotation->ratio[0], _inv_frames);
+  _soa_rotation->value[_side] = _quat;
+}
+
+// Stores left (_side = 0) or right (_side = 1) decompressed rotations of a soa
+// track to compact mode hot data. Compact mode keeps key times in frames, it
+// doesn't sample animations with float key times.
+template <typename _Index>
+OZZ_INLINE void StoreSoaRotation(int _side, const RotationKey* _keys,
+                                 const float* _times, const _Index* _interp,
+                                 const math::SoaQuaternion& _quat,
+                                 math::SimdFloat4 /*_inv_frames*/,
+                                 internal::PackedSoaRotation* _soa_rotation) {
+  assert(!_times);
+  (void)_times;
+  for (int k = 0; k < 4; ++k) {
+    const uint16_t ratio = _keys[_interp[k * 2]].ratio;
+    // Constant tracks use the same key on both sides, see LoadRightRatios().
+    _soa_rotation->ratio[_side][k] =
+        (_side == 1 && ratio == _soa_rotation->ratio[0][k]) ? kMaxFrames
+                                                              : ratio;
+  }
+  // Components are clamped, as the restored one can slightly exceed 1.
+  const math::SimdFloat4 kFloat2Int = math::simd_float4::Load1(32767.f);
+  const math::SimdFloat4 kMin = -math::simd_float4::one();
+  const math::SimdFloat4 kMax = math::simd_float4::one();
+  const math::SimdFloat4 cpnts[4] = {_quat.x, _quat.y, _quat.z, _quat.w};
+  for (int c = 0; c < 4; ++c) {
+    OZZ_ALIGN(16) int values[4];
+    const math::SimdFloat4 clamped = math::Clamp(kMin, cpnts[c], kMax);
+    math::StorePtr(math::simd_int4::FromFloatRound(clamped * kFloat2Int),
+                   values);
+    for (int k = 0; k < 4; ++k) {
+      _soa_rotation->value[_side][c][k] = static_cast<int16_t>(values[k]);
+    }
+  }
+}
+
+// _tangents and _soa_tangents are only specified for spline animations.
+template <typename _Index, typename _SoaRotation>
+void UpdateSoaRotations(int _num_soa_tracks, float _inv_frames,
+                        ozz::Range<const RotationKey> _keys,
+                        const float* _times, const _Index* _interp,
+                        const uint8_t* _mask, uint8_t* _outdated,
+                        _SoaRotation* _soa_rotations,
+                        const QuaternionTangent* _tangents,
+                        internal::InterpSoaQuaternionTangent* _soa_tangents) {
+  const math::SimdFloat4 inv_frames = math::simd_float4::Load1(_inv_frames);
+#if !defined(OZZ_SIMD_AVX2)
   // Prepares constants.
   const math::SimdFloat4 one = math::simd_float4::one();
   const math::SimdFloat4 eps = math::simd_float4::Load1(1e-16f);
@@ -275,11 +702,13 @@ void UpdateSoaRotations(int _num_soa_tracks,
   // quaternion.
   const int kCpntMapping[4][4] = {
       {0, 0, 1, 2}, {0, 0, 1, 2}, {0, 1, 0, 2}, {0, 1, 2, 0}};
+#endif  // OZZ_SIMD_AVX2
 
   const int num_outdated_flags = (_num_soa_tracks + 7) / 8;
   for (int j = 0; j < num_outdated_flags; ++j) {
-    uint8_t outdated = _outdated[j];
-    _outdated[j] = 0;  // Reset outdated entries as all will be processed.
+    // Masked out entries remain outdated, so they are updated once unmasked.
+    uint8_t outdated = _outdated[j] & (_mask ? _mask[j] : 0xff);
+    _outdated[j] ^= outdated;  // Reset outdated entries that will be processed.
     for (int i = j * 8; outdated; ++i, outdated >>= 1) {
       if (!(outdated & 1)) {
         continue;
@@ -287,6 +716,21 @@ void UpdateSoaRotations(int _num_soa_tracks,
 
       const int base = i * 4 * 2;  // * soa size * 2 keys per track
 
+#if defined(OZZ_SIMD_AVX2)
+      // Decompress left and right side keyframes at once.
+      {
+        const int interp[8] = {_interp[base + 0], _interp[base + 1],
+                               _interp[base + 2], _interp[base + 3],
+                               _interp[base + 4], _interp[base + 5],
+                               _interp[base + 6], _interp[base + 7]};
+        math::SoaQuaternion left, right;
+        DecompressSoaQuats(_keys.begin, interp, &left, &right);
+        StoreSoaRotation(0, _keys.begin, _times, interp, left, inv_frames,
+                         &_soa_rotations[i]);
+        StoreSoaRotation(1, _keys.begin, _times, interp + 1, right, inv_frames,
+                         &_soa_rotations[i]);
+      }
+#else   // OZZ_SIMD_AVX2
       // Decompress left side keyframes and store them in soa structures.
       {
         const RotationKey& k0 = _keys.begin[_interp[base + 0]];
@@ -294,10 +738,10 @@ void UpdateSoaRotations(int _num_soa_tracks,
         const RotationKey& k2 = _keys.begin[_interp[base + 4]];
         const RotationKey& k3 = _keys.begin[_interp[base + 6]];
 
-        _soa_rotations[i].ratio[0] =
-            math::simd_float4::Load(k0.ratio, k1.ratio, k2.ratio, k3.ratio);
-        math::SoaQuaternion& quat = _soa_rotations[i].value[0];
+        math::SoaQuaternion quat;
         DECOMPRESS_SOA_QUAT(k0, k1, k2, k3, quat);
+        StoreSoaRotation(0, _keys.begin, _times, _interp + base, quat,
+                         inv_frames, &_soa_rotations[i]);
       }
 
       // Decompress right side keyframes and store them in soa structures.
@@ -307,10 +751,15 @@ void UpdateSoaRotations(int _num_soa_tracks,
         const RotationKey& k2 = _keys.begin[_interp[base + 5]];
         const RotationKey& k3 = _keys.begin[_interp[base + 7]];
 
-        _soa_rotations[i].ratio[1] =
-            math::simd_float4::Load(k0.ratio, k1.ratio, k2.ratio, k3.ratio);
-        math::SoaQuaternion& quat = _soa_rotations[i].value[1];
+        math::SoaQuaternion quat;
         DECOMPRESS_SOA_QUAT(k0, k1, k2, k3, quat);
+        StoreSoaRotation(1, _keys.begin, _times, _interp + base + 1, quat,
+                         inv_frames, &_soa_rotations[i]);
+      }
+#endif  // OZZ_SIMD_AVX2
+
+      if (_soa_tangents) {
+        UpdateSoaQuaternionTangents(_tangents, _interp, i, _soa_tangents);
       }
     }
   }
@@ -318,13 +767,21 @@ void UpdateSoaRotations(int _num_soa_tracks,
 
 #undef DECOMPRESS_SOA_QUAT
 
-void UpdateSoaScales(int _num_soa_tracks, ozz::Range<const ScaleKey> _keys,
-                     const int* _interp, uint8_t* _outdated,
-                     internal::InterpSoaScale* soa_scales_) {
+// _tangents and _soa_tangents are only specified for spline animations.
+void UpdateSoaScales(int _num_soa_tracks, float _inv_frames,
+                     ozz::Range<const ScaleKey> _keys, const float* _times,
+                     ozz::Range<const KeyRange> _ranges,
+                     const uint8_t* _values, const uint32_t* _value_offsets,
+                     const int* _interp, const uint8_t* _mask,
+                     uint8_t* _outdated, internal::InterpSoaScale* soa_scales_,
+                     const Float3Tangent* _tangents,
+                     internal::InterpSoaFloat3Tangent* _soa_tangents) {
+  const math::SimdFloat4 inv_frames = math::simd_float4::Load1(_inv_frames);
   const int num_outdated_flags = (_num_soa_tracks + 7) / 8;
   for (int j = 0; j < num_outdated_flags; ++j) {
-    uint8_t outdated = _outdated[j];
-    _outdated[j] = 0;  // Reset outdated entries as all will be processed.
+    // Masked out entries remain outdated, so they are updated once unmasked.
+    uint8_t outdated = _outdated[j] & (_mask ? _mask[j] : 0xff);
+    _outdated[j] ^= outdated;  // Reset outdated entries that will be processed.
     for (int i = j * 8; outdated; ++i, outdated >>= 1) {
       if (!(outdated & 1)) {
         continue;
@@ -332,43 +789,501 @@ void UpdateSoaScales(int _num_soa_tracks, ozz::Range<const ScaleKey> _keys,
       const int base = i * 4 * 2;  // * soa size * 2 keys
 
       // Decompress left side keyframes and store them in soa structures.
-      const ScaleKey& k00 = _keys.begin[_interp[base + 0]];
-      const ScaleKey& k10 = _keys.begin[_interp[base + 2]];
-      const ScaleKey& k20 = _keys.begin[_interp[base + 4]];
-      const ScaleKey& k30 = _keys.begin[_interp[base + 6]];
       soa_scales_[i].ratio[0] =
-          math::simd_float4::Load(k00.ratio, k10.ratio, k20.ratio, k30.ratio);
-      soa_scales_[i].value[0].x = math::HalfToFloat(math::simd_int4::Load(
-          k00.value[0], k10.value[0], k20.value[0], k30.value[0]));
-      soa_scales_[i].value[0].y = math::HalfToFloat(math::simd_int4::Load(
-          k00.value[1], k10.value[1], k20.value[1], k30.value[1]));
-      soa_scales_[i].value[0].z = math::HalfToFloat(math::simd_int4::Load(
-          k00.value[2], k10.value[2], k20.value[2], k30.value[2]));
+          LoadRatios(_keys.begin, _times, _interp + base, inv_frames);
+      soa_scales_[i].value[0] =
+          DecompressSoaFloat3(_keys.begin, _ranges.begin, _values,
+                              _value_offsets, _interp, i, 0);
 
       // Decompress right side keyframes and store them in soa structures.
-      const ScaleKey& k01 = _keys.begin[_interp[base + 1]];
-      const ScaleKey& k11 = _keys.begin[_interp[base + 3]];
-      const ScaleKey& k21 = _keys.begin[_interp[base + 5]];
-      const ScaleKey& k31 = _keys.begin[_interp[base + 7]];
       soa_scales_[i].ratio[1] =
-          math::simd_float4::Load(k01.ratio, k11.ratio, k21.ratio, k31.ratio);
-      soa_scales_[i].value[1].x = math::HalfToFloat(math::simd_int4::Load(
-          k01.value[0], k11.value[0], k21.value[0], k31.value[0]));
-      soa_scales_[i].value[1].y = math::HalfToFloat(math::simd_int4::Load(
-          k01.value[1], k11.value[1], k21.value[1], k31.value[1]));
-      soa_scales_[i].value[1].z = math::HalfToFloat(math::simd_int4::Load(
-          k01.value[2], k11.value[2], k21.value[2], k31.value[2]));
+          LoadRightRatios(_keys.begin, _times, _interp + base + 1,
+                          soa_scales_[i].ratio[0], inv_frames);
+      soa_scales_[i].value[1] =
+          DecompressSoaFloat3(_keys.begin, _ranges.begin, _values,
+                              _value_offsets, _interp, i, 1);
+
+      if (_soa_tangents) {
+        UpdateSoaFloat3Tangents(_tangents, _interp, i, _soa_tangents);
+      }
+    }
+  }
+}
+
+// Copies translation or scale quantized keys to compact mode hot data.
+template <typename _Key>
+void UpdatePackedSoaFloat3(int _num_soa_tracks, ozz::Range<const _Key> _keys,
+                           ozz::Range<const KeyRange> _ranges,
+                           const uint8_t* _values,
+                           const uint32_t* _value_offsets,
+                           const uint16_t* _interp, const uint8_t* _mask,
+                           uint8_t* _outdated,
+                           internal::PackedSoaFloat3* _packed) {
+  const int num_outdated_flags = (_num_soa_tracks + 7) / 8;
+  for (int j = 0; j < num_outdated_flags; ++j) {
+    // Masked out entries remain outdated, so they are updated once unmasked.
+    uint8_t outdated = _outdated[j] & (_mask ? _mask[j] : 0xff);
+    _outdated[j] ^= outdated;  // Reset outdated entries that will be processed.
+    for (int i = j * 8; outdated; ++i, outdated >>= 1) {
+      if (!(outdated & 1)) {
+        continue;
+      }
+      const int base = i * 4 * 2;  // * soa size * 2 keys
+      internal::PackedSoaFloat3& packed = _packed[i];
+      for (int k = 0; k < 4; ++k) {
+        const int left_index = _interp[base + k * 2 + 0];
+        const int right_index = _interp[base + k * 2 + 1];
+        const _Key& left = _keys.begin[left_index];
+        const _Key& right = _keys.begin[right_index];
+        packed.ratio[0][k] = left.ratio;
+        // Constant tracks use the same key on both sides, see
+        // LoadRightRatios().
+        packed.ratio[1][k] =
+            right.ratio == left.ratio ? kMaxFrames : right.ratio;
+        int values[2][3];
+        UnpackKeyValues(_keys.begin, _ranges.begin, _value_offsets, _values,
+                        left_index, values[0]);
+        UnpackKeyValues(_keys.begin, _ranges.begin, _value_offsets, _values,
+                        right_index, values[1]);
+        for (int c = 0; c < 3; ++c) {
+          packed.value[0][c][k] = static_cast<uint16_t>(values[0][c]);
+          packed.value[1][c][k] = static_cast<uint16_t>(values[1][c]);
+        }
+      }
+    }
+  }
+}
+
+// Gets the lanes (one bit per soa lane) of an interpolation entry whose right
+// key is reached at _ratio. Step tracks output their right key value from
+// then on, which matters for keys at the end of the animation as the cache
+// never moves past them.
+template <typename _Entry>
+OZZ_INLINE int ReachedLanes(float _ratio, const _Entry& _entry) {
+  return math::MoveMask(
+      math::CmpGe(math::simd_float4::Load1(_ratio), _entry.ratio[1]));
+}
+
+// Compact mode entries store key times in frames, so _ratio is expected in
+// frames too.
+OZZ_INLINE int ReachedLanes(float _ratio, const uint16_t (&_right)[4]) {
+  return (_ratio >= _right[0]) | ((_ratio >= _right[1]) << 1) |
+         ((_ratio >= _right[2]) << 2) | ((_ratio >= _right[3]) << 3);
+}
+
+OZZ_INLINE int ReachedLanes(float _ratio,
+                            const internal::PackedSoaFloat3& _entry) {
+  return ReachedLanes(_ratio, _entry.ratio[1]);
+}
+
+OZZ_INLINE int ReachedLanes(float _ratio,
+                            const internal::PackedSoaRotation& _entry) {
+  return ReachedLanes(_ratio, _entry.ratio[1]);
+}
+
+// Holds left key values of step _lanes (one bit per soa lane) on the right
+// side of the interpolation, see Animation::steps().
+OZZ_INLINE void HoldLeft(int _lanes, math::SoaFloat3* _values) {
+  const math::SimdInt4 lanes = math::simd_int4::Load(
+      -(_lanes & 1), -((_lanes >> 1) & 1), -((_lanes >> 2) & 1),
+      -((_lanes >> 3) & 1));
+  _values[1].x = math::Select(lanes, _values[0].x, _values[1].x);
+  _values[1].y = math::Select(lanes, _values[0].y, _values[1].y);
+  _values[1].z = math::Select(lanes, _values[0].z, _values[1].z);
+}
+
+OZZ_INLINE void HoldLeft(int _lanes, math::SoaQuaternion* _values) {
+  const math::SimdInt4 lanes = math::simd_int4::Load(
+      -(_lanes & 1), -((_lanes >> 1) & 1), -((_lanes >> 2) & 1),
+      -((_lanes >> 3) & 1));
+  _values[1].x = math::Select(lanes, _values[0].x, _values[1].x);
+  _values[1].y = math::Select(lanes, _values[0].y, _values[1].y);
+  _values[1].z = math::Select(lanes, _values[0].z, _values[1].z);
+  _values[1].w = math::Select(lanes, _values[0].w, _values[1].w);
+}
+
+// Compact mode version, for quantized values of _Count components.
+template <typename _Ty, int _Count>
+void HoldLeft(int _lanes, _Ty (*_values)[_Count][4]) {
+  for (int k = 0; k < 4; ++k) {
+    if (_lanes & (1 << k)) {
+      for (int c = 0; c < _Count; ++c) {
+        _values[1][c][k] = _values[0][c][k];
+      }
+    }
+  }
+}
+
+// Outdates soa tracks whose step lanes (see Animation::steps()) reached their
+// right key at _ratio, as their right values might have been overwritten by
+// HoldSteps. Decompressing them again restores right values. Must be called
+// once keys are updated, as already outdated entries aren't initialized yet.
+template <typename _Translation, typename _Rotation, typename _Scale>
+void OutdateSteps(float _ratio, int _num_soa_tracks, const uint8_t* _steps,
+                  const _Translation* _translations,
+                  const _Rotation* _rotations, const _Scale* _scales,
+                  uint8_t* _outdated_translations,
+                  uint8_t* _outdated_rotations, uint8_t* _outdated_scales) {
+  for (int i = 0; i < _num_soa_tracks; ++i) {
+    const int lanes = (_steps[i / 2] >> ((i & 1) * 4)) & 0xf;
+    if (!lanes) {
+      continue;
+    }
+    const uint8_t bit = static_cast<uint8_t>(1 << (i & 7));
+    if (!(_outdated_translations[i / 8] & bit) &&
+        (ReachedLanes(_ratio, _translations[i]) & lanes)) {
+      _outdated_translations[i / 8] |= bit;
+    }
+    if (!(_outdated_rotations[i / 8] & bit) &&
+        (ReachedLanes(_ratio, _rotations[i]) & lanes)) {
+      _outdated_rotations[i / 8] |= bit;
+    }
+    if (!(_outdated_scales[i / 8] & bit) &&
+        (ReachedLanes(_ratio, _scales[i]) & lanes)) {
+      _outdated_scales[i / 8] |= bit;
+    }
+  }
+}
+
+// Makes step tracks (see Animation::steps()) hold their left key values, by
+// copying them to the right side of their decompressed keys, until their right
+// key is reached. Interpolation kernels thus output step tracks as constants
+// between two keys, without any branch nor specific kernel. Holding values is
+// idempotent, so it's applied to all soa tracks with step lanes, whether they
+// were just decompressed or not. Step tracks tangents are null, so spline
+// interpolation holds values as well.
+template <typename _Translation, typename _Rotation, typename _Scale>
+void HoldSteps(float _ratio, int _num_soa_tracks, const uint8_t* _steps,
+               _Translation* _translations, _Rotation* _rotations,
+               _Scale* _scales) {
+  for (int i = 0; i < _num_soa_tracks; ++i) {
+    const int lanes = (_steps[i / 2] >> ((i & 1) * 4)) & 0xf;
+    if (lanes) {
+      HoldLeft(lanes & ~ReachedLanes(_ratio, _translations[i]),
+               _translations[i].value);
+      HoldLeft(lanes & ~ReachedLanes(_ratio, _rotations[i]),
+               _rotations[i].value);
+      HoldLeft(lanes & ~ReachedLanes(_ratio, _scales[i]), _scales[i].value);
+    }
+  }
+}
+
+// Loads 4 16 bits integers to a SimdFloat4.
+template <typename _Ty>
+OZZ_INLINE math::SimdFloat4 LoadPacked(const _Ty (&_values)[4]) {
+  return math::simd_float4::FromInt(
+      math::simd_int4::Load(_values[0], _values[1], _values[2], _values[3]));
+}
+
+// Restores compact mode SoaFloat3 value _side of soa track _i.
+OZZ_INLINE math::SoaFloat3 UnpackSoaFloat3(
+    const internal::PackedSoaFloat3& _packed, int _side,
+    const KeyRange& _range) {
+  const uint16_t(&v)[3][4] = _packed.value[_side];
+  const math::SoaFloat3 value = {
+      Dequantize(_range, 0, v[0][0], v[0][1], v[0][2], v[0][3]),
+      Dequantize(_range, 1, v[1][0], v[1][1], v[1][2], v[1][3]),
+      Dequantize(_range, 2, v[2][0], v[2][1], v[2][2], v[2][3])};
+  return value;
+}
+
+// Restores compact mode SoaQuaternion value _side of soa track _i.
+OZZ_INLINE math::SoaQuaternion UnpackSoaQuaternion(
+    const internal::PackedSoaRotation& _packed, int _side) {
+  const math::SimdFloat4 kInt2Float = math::simd_float4::Load1(1.f / 32767.f);
+  const int16_t(&v)[4][4] = _packed.value[_side];
+  const math::SoaQuaternion value = {
+      LoadPacked(v[0]) * kInt2Float, LoadPacked(v[1]) * kInt2Float,
+      LoadPacked(v[2]) * kInt2Float, LoadPacked(v[3]) * kInt2Float};
+  return value;
+}
+
+// Computes interpolation coefficient from compact mode quantized ratios.
+template <typename _Packed>
+OZZ_INLINE math::SimdFloat4 PackedInterpRatio(math::SimdFloat4 _anim_ratio,
+                                              const _Packed& _packed) {
+  const math::SimdFloat4 ratio0 = LoadPacked(_packed.ratio[0]);
+  const math::SimdFloat4 ratio1 = LoadPacked(_packed.ratio[1]);
+  return (_anim_ratio - ratio0) * math::RcpEst(ratio1 - ratio0);
+}
+
+// Stores interpolated _transform to soa track _i of _output.
+OZZ_INLINE void StorePose(const math::SoaTransform& _transform,
+                          math::SoaTransform* _output, int _i) {
+  _output[_i] = _transform;
+}
+
+// Stores interpolated _transform to soa track _i of half precision _output, so
+// conversion is fused with interpolation, see SamplingJob::half_output.
+OZZ_INLINE void StorePose(const math::SoaTransform& _transform,
+                          math::SoaHalfTransform* _output, int _i) {
+  _output[_i] = math::PackHalf(_transform);
+}
+
+// Weighted accumulation output, see SamplingJob::accumulator.
+struct AccumulatorOutput {
+  SoaBlendAccumulator* accumulators;
+  math::SimdFloat4 weight;
+  const math::SimdFloat4* joint_weights;
+};
+
+// Accumulates interpolated _transform to soa track _i of _output accumulators,
+// like a BlendingJob layer pass, so no intermediate pose is stored.
+OZZ_INLINE void StorePose(const math::SoaTransform& _transform,
+                          const AccumulatorOutput* _output, int _i) {
+  const math::SimdFloat4 weight =
+      _output->joint_weights ? _output->weight * _output->joint_weights[_i]
+                             : _output->weight;
+  SoaBlendAccumulator& acc = _output->accumulators[_i];
+  acc.translation = acc.translation + _transform.translation * weight;
+  // Negates opposed quaternions to be sure to choose the shortest path.
+  const math::SimdFloat4 dot = acc.rotation.x * _transform.rotation.x +
+                               acc.rotation.y * _transform.rotation.y +
+                               acc.rotation.z * _transform.rotation.z +
+                               acc.rotation.w * _transform.rotation.w;
+  const math::SimdInt4 sign = math::Sign(dot);
+  const math::SoaQuaternion rotation = {math::Xor(_transform.rotation.x, sign),
+                                        math::Xor(_transform.rotation.y, sign),
+                                        math::Xor(_transform.rotation.z, sign),
+                                        math::Xor(_transform.rotation.w, sign)};
+  acc.rotation = acc.rotation + rotation * weight;
+  acc.scale = acc.scale + _transform.scale * weight;
+  acc.weight = acc.weight + weight;
+}
+
+// Scattered output, see SamplingJob::scatter.
+template <typename _Output>
+struct ScatterOutput {
+  _Output* output;
+  const int* indices;
+};
+
+// Stores interpolated _transform to soa track _indices[_i] of scattered
+// _output.
+template <typename _Output>
+OZZ_INLINE void StorePose(const math::SoaTransform& _transform,
+                          const ScatterOutput<_Output>* _output, int _i) {
+  StorePose(_transform, _output->output, _output->indices[_i]);
+}
+
+// Compact mode version of Interpolates(). Interpolation coefficients are
+// computed in frames, hence _anim_frame sampling time.
+template <typename _Policy, typename _Output>
+void InterpolatesPacked(float _anim_frame, int _num_soa_tracks,
+                        const internal::PackedSoaFloat3* _translations,
+                        ozz::Range<const KeyRange> _translation_ranges,
+                        const internal::PackedSoaRotation* _rotations,
+                        const internal::PackedSoaFloat3* _scales,
+                        ozz::Range<const KeyRange> _scale_ranges,
+                        const uint8_t* _mask, _Output* _output) {
+  const math::SimdFloat4 anim_ratio = math::simd_float4::Load1(_anim_frame);
+  for (int i = 0; i < _num_soa_tracks; ++i) {
+    if (_mask && !(_mask[i / 8] & (1 << (i & 7)))) {
+      continue;  // Masked out entries output is left unchanged.
     }
+
+    const math::SimdFloat4 interp_t_ratio =
+        PackedInterpRatio(anim_ratio, _translations[i]);
+    const math::SimdFloat4 interp_r_ratio =
+        PackedInterpRatio(anim_ratio, _rotations[i]);
+    const math::SimdFloat4 interp_s_ratio =
+        PackedInterpRatio(anim_ratio, _scales[i]);
+
+    math::SoaTransform transform;
+    const KeyRange& t_range = _translation_ranges.begin[i];
+    transform.translation =
+        Lerp(UnpackSoaFloat3(_translations[i], 0, t_range),
+             UnpackSoaFloat3(_translations[i], 1, t_range), interp_t_ratio);
+    transform.rotation =
+        math::NLerp<_Policy>(UnpackSoaQuaternion(_rotations[i], 0),
+                             UnpackSoaQuaternion(_rotations[i], 1),
+                             interp_r_ratio);
+    const KeyRange& s_range = _scale_ranges.begin[i];
+    transform.scale =
+        Lerp(UnpackSoaFloat3(_scales[i], 0, s_range),
+             UnpackSoaFloat3(_scales[i], 1, s_range), interp_s_ratio);
+    StorePose(transform, _output, i);
+  }
+}
+
+// Copies _count seek point key indices to cache _keys.
+template <typename _Index>
+void CopySeekKeys(const int* _seek_keys, int _count, _Index* _keys) {
+  for (int i = 0; i < _count; ++i) {
+    _keys[i] = static_cast<_Index>(_seek_keys[i]);
+  }
+}
+
+#if defined(OZZ_SIMD_AVX) || defined(OZZ_SIMD_AVX2_DISPATCH)
+// 8 wide helpers, used to interpolate two adjacent soa tracks at once. Track
+// _i is packed in the 4 lower lanes and track _i + 1 in the 4 upper ones, so
+// that soa tracks memory layout remains 4 wide.
+OZZ_INLINE OZZ_SIMD_AVX2_TARGET __m256 Load8(const math::SimdFloat4& _lo,
+                                             const math::SimdFloat4& _hi) {
+  return _mm256_insertf128_ps(_mm256_castps128_ps256(_lo), _hi, 1);
+}
+
+OZZ_INLINE OZZ_SIMD_AVX2_TARGET void Store8(__m256 _v, math::SimdFloat4* _lo,
+                                            math::SimdFloat4* _hi) {
+  *_lo = _mm256_castps256_ps128(_v);
+  *_hi = _mm256_extractf128_ps(_v, 1);
+}
+
+OZZ_INLINE OZZ_SIMD_AVX2_TARGET __m256 Lerp8(__m256 _a, __m256 _b,
+                                             __m256 _f) {
+#if defined(OZZ_SIMD_FMA) || defined(OZZ_SIMD_AVX2_DISPATCH)
+  return _mm256_fmadd_ps(_mm256_sub_ps(_b, _a), _f, _a);
+#else   // OZZ_SIMD_FMA
+  return _mm256_add_ps(_mm256_mul_ps(_mm256_sub_ps(_b, _a), _f), _a);
+#endif  // OZZ_SIMD_FMA
+}
+
+OZZ_INLINE OZZ_SIMD_AVX2_TARGET __m256
+InterpRatio8(__m256 _anim_ratio, const math::SimdFloat4 (&_lo)[2],
+             const math::SimdFloat4 (&_hi)[2]) {
+  const __m256 r0 = Load8(_lo[0], _hi[0]);
+  const __m256 r1 = Load8(_lo[1], _hi[1]);
+  return _mm256_mul_ps(_mm256_sub_ps(_anim_ratio, r0),
+                       _mm256_rcp_ps(_mm256_sub_ps(r1, r0)));
+}
+
+OZZ_INLINE OZZ_SIMD_AVX2_TARGET void Lerp8(const math::SoaFloat3 (&_lo)[2],
+                                           const math::SoaFloat3 (&_hi)[2],
+                                           __m256 _f, math::SoaFloat3* _out_lo,
+                                           math::SoaFloat3* _out_hi) {
+  Store8(Lerp8(Load8(_lo[0].x, _hi[0].x), Load8(_lo[1].x, _hi[1].x), _f),
+         &_out_lo->x, &_out_hi->x);
+  Store8(Lerp8(Load8(_lo[0].y, _hi[0].y), Load8(_lo[1].y, _hi[1].y), _f),
+         &_out_lo->y, &_out_hi->y);
+  Store8(Lerp8(Load8(_lo[0].z, _hi[0].z), Load8(_lo[1].z, _hi[1].z), _f),
+         &_out_lo->z, &_out_hi->z);
+}
+
+// 8 wide reciprocal square root of _len2, with the same precision as
+// math::ExactNormalization.
+OZZ_INLINE OZZ_SIMD_AVX2_TARGET __m256 RSqrt8(
+    __m256 _len2, const math::ExactNormalization&) {
+  return _mm256_div_ps(_mm256_set1_ps(1.f), _mm256_sqrt_ps(_len2));
+}
+
+// 8 wide reciprocal square root of _len2, with the same precision as
+// math::EstimatedNormalization.
+template <int _NRSteps>
+OZZ_INLINE OZZ_SIMD_AVX2_TARGET __m256
+RSqrt8(__m256 _len2, const math::EstimatedNormalization<_NRSteps>&) {
+  __m256 inv_len = _mm256_rsqrt_ps(_len2);
+  for (int i = 0; i < _NRSteps; ++i) {
+    inv_len = _mm256_mul_ps(
+        _mm256_mul_ps(_mm256_set1_ps(.5f), inv_len),
+        _mm256_sub_ps(_mm256_set1_ps(3.f),
+                      _mm256_mul_ps(_mm256_mul_ps(_len2, inv_len), inv_len)));
   }
+  return inv_len;
+}
+
+// 8 wide version of math::NLerp<_Policy>.
+template <typename _Policy>
+OZZ_INLINE OZZ_SIMD_AVX2_TARGET void NLerp8(
+    const math::SoaQuaternion (&_lo)[2], const math::SoaQuaternion (&_hi)[2],
+    __m256 _f, math::SoaQuaternion* _out_lo, math::SoaQuaternion* _out_hi) {
+  const __m256 x =
+      Lerp8(Load8(_lo[0].x, _hi[0].x), Load8(_lo[1].x, _hi[1].x), _f);
+  const __m256 y =
+      Lerp8(Load8(_lo[0].y, _hi[0].y), Load8(_lo[1].y, _hi[1].y), _f);
+  const __m256 z =
+      Lerp8(Load8(_lo[0].z, _hi[0].z), Load8(_lo[1].z, _hi[1].z), _f);
+  const __m256 w =
+      Lerp8(Load8(_lo[0].w, _hi[0].w), Load8(_lo[1].w, _hi[1].w), _f);
+  const __m256 len2 = _mm256_add_ps(
+      _mm256_add_ps(_mm256_mul_ps(x, x), _mm256_mul_ps(y, y)),
+      _mm256_add_ps(_mm256_mul_ps(z, z), _mm256_mul_ps(w, w)));
+  const __m256 inv_len = RSqrt8(len2, _Policy());
+  Store8(_mm256_mul_ps(x, inv_len), &_out_lo->x, &_out_hi->x);
+  Store8(_mm256_mul_ps(y, inv_len), &_out_lo->y, &_out_hi->y);
+  Store8(_mm256_mul_ps(z, inv_len), &_out_lo->z, &_out_hi->z);
+  Store8(_mm256_mul_ps(w, inv_len), &_out_lo->w, &_out_hi->w);
 }
 
+// Interpolates soa tracks _i and _i + 1 at once, to _output[0] and _output[1].
+template <typename _Policy>
+OZZ_SIMD_AVX2_TARGET void Interpolates8(
+    float _anim_ratio, int _i,
+    const internal::InterpSoaTranslation* _translations,
+    const internal::InterpSoaRotation* _rotations,
+    const internal::InterpSoaScale* _scales, math::SoaTransform* _output) {
+  const int j = _i + 1;
+  const __m256 anim_ratio8 = _mm256_set1_ps(_anim_ratio);
+  Lerp8(_translations[_i].value, _translations[j].value,
+        InterpRatio8(anim_ratio8, _translations[_i].ratio,
+                     _translations[j].ratio),
+        &_output[0].translation, &_output[1].translation);
+  NLerp8<_Policy>(
+      _rotations[_i].value, _rotations[j].value,
+      InterpRatio8(anim_ratio8, _rotations[_i].ratio, _rotations[j].ratio),
+      &_output[0].rotation, &_output[1].rotation);
+  Lerp8(_scales[_i].value, _scales[j].value,
+        InterpRatio8(anim_ratio8, _scales[_i].ratio, _scales[j].ratio),
+        &_output[0].scale, &_output[1].scale);
+}
+
+// Interpolates soa tracks _i and _i + 1 at once, directly to _output.
+template <typename _Policy>
+OZZ_INLINE void Interpolates8To(
+    float _anim_ratio, int _i,
+    const internal::InterpSoaTranslation* _translations,
+    const internal::InterpSoaRotation* _rotations,
+    const internal::InterpSoaScale* _scales, math::SoaTransform* _output) {
+  Interpolates8<_Policy>(_anim_ratio, _i, _translations, _rotations, _scales,
+                         _output + _i);
+}
+
+// Interpolates soa tracks _i and _i + 1 at once, and stores them to _output
+// that isn't a SoaTransform buffer (half precision or accumulation).
+template <typename _Policy, typename _Output>
+OZZ_INLINE void Interpolates8To(
+    float _anim_ratio, int _i,
+    const internal::InterpSoaTranslation* _translations,
+    const internal::InterpSoaRotation* _rotations,
+    const internal::InterpSoaScale* _scales, _Output* _output) {
+  math::SoaTransform transforms[2];
+  Interpolates8<_Policy>(_anim_ratio, _i, _translations, _rotations, _scales,
+                         transforms);
+  StorePose(transforms[0], _output, _i);
+  StorePose(transforms[1], _output, _i + 1);
+}
+#endif  // OZZ_SIMD_AVX || OZZ_SIMD_AVX2_DISPATCH
+
+// _Policy defines quaternion normalization precision, see SamplingJob::Quality.
+template <typename _Policy, typename _Output>
 void Interpolates(float _anim_ratio, int _num_soa_tracks,
                   const internal::InterpSoaTranslation* _translations,
                   const internal::InterpSoaRotation* _rotations,
                   const internal::InterpSoaScale* _scales,
-                  math::SoaTransform* _output) {
+                  const uint8_t* _mask, _Output* _output) {
   const math::SimdFloat4 anim_ratio = math::simd_float4::Load1(_anim_ratio);
+#if defined(OZZ_SIMD_AVX)
+  const bool wide = true;
+#elif defined(OZZ_SIMD_AVX2_DISPATCH)
+  // 8 wide interpolation is selected at runtime.
+  const bool wide = math::CpuSupportsAvx2Fma();
+#endif
   for (int i = 0; i < _num_soa_tracks; ++i) {
+    if (_mask && !(_mask[i / 8] & (1 << (i & 7)))) {
+      continue;  // Masked out entries output is left unchanged.
+    }
+
+#if defined(OZZ_SIMD_AVX) || defined(OZZ_SIMD_AVX2_DISPATCH)
+    // Interpolates track i and i + 1 at once when both are enabled.
+    const int j = i + 1;
+    if (wide && j < _num_soa_tracks &&
+        (!_mask || (_mask[j / 8] & (1 << (j & 7))))) {
+      Interpolates8To<_Policy>(_anim_ratio, i, _translations, _rotations,
+                               _scales, _output);
+      i = j;
+      continue;
+    }
+#endif  // OZZ_SIMD_AVX || OZZ_SIMD_AVX2_DISPATCH
+
     // Prepares interpolation coefficients.
     const math::SimdFloat4 interp_t_ratio =
         (anim_ratio - _translations[i].ratio[0]) *
@@ -383,140 +1298,1253 @@ void Interpolates(float _anim_ratio, int _num_soa_tracks,
     // Processes interpolations.
     // The lerp of the rotation uses the shortest path, because opposed
     // quaternions were negated during animation build stage (AnimationBuilder).
-    _output[i].translation = Lerp(_translations[i].value[0],
-                                  _translations[i].value[1], interp_t_ratio);
-    _output[i].rotation = NLerpEst(_rotations[i].value[0],
-                                   _rotations[i].value[1], interp_r_ratio);
-    _output[i].scale =
+    math::SoaTransform transform;
+    transform.translation = Lerp(_translations[i].value[0],
+                                 _translations[i].value[1], interp_t_ratio);
+    transform.rotation = math::NLerp<_Policy>(
+        _rotations[i].value[0], _rotations[i].value[1], interp_r_ratio);
+    transform.scale =
         Lerp(_scales[i].value[0], _scales[i].value[1], interp_s_ratio);
+    StorePose(transform, _output, i);
   }
 }
-}  // namespace
-
-SamplingJob::SamplingJob() : ratio(0.f), animation(NULL), cache(NULL) {}
 
-bool SamplingJob::Run() const {
-  if (!Validate()) {
-    return false;
+// Computes cubic Hermite basis functions at _alpha, for a key interval of
+// _span ratio. Tangent coefficients are pre-multiplied by _span, as tangents
+// are derivatives relatively to the time ratio.
+struct HermiteBasis {
+  HermiteBasis(math::SimdFloat4 _alpha, math::SimdFloat4 _span) {
+    const math::SimdFloat4 one = math::simd_float4::one();
+    const math::SimdFloat4 two = math::simd_float4::Load1(2.f);
+    const math::SimdFloat4 three = math::simd_float4::Load1(3.f);
+    const math::SimdFloat4 alpha2 = _alpha * _alpha;
+    const math::SimdFloat4 alpha3 = alpha2 * _alpha;
+    p1 = three * alpha2 - two * alpha3;
+    p0 = one - p1;
+    m0 = (alpha3 - two * alpha2 + _alpha) * _span;
+    m1 = (alpha3 - alpha2) * _span;
   }
+  math::SimdFloat4 p0, p1, m0, m1;
+};
 
-  const int num_soa_tracks = animation->num_soa_tracks();
-  if (num_soa_tracks == 0) {  // Early out if animation contains no joint.
-    return true;
-  }
+OZZ_INLINE math::SoaFloat3 Hermite(
+    const math::SoaFloat3 (&_values)[2],
+    const internal::InterpSoaFloat3Tangent& _tangents,
+    const HermiteBasis& _basis) {
+  return _values[0] * _basis.p0 + _values[1] * _basis.p1 +
+         _tangents.value[0] * _basis.m0 + _tangents.value[1] * _basis.m1;
+}
 
-  // Clamps ratio in range [0,duration].
-  const float anim_ratio = math::Clamp(0.f, ratio, 1.f);
+// Quaternion components are interpolated independently, and then normalized
+// according to _Policy.
+template <typename _Policy>
+OZZ_INLINE math::SoaQuaternion Hermite(
+    const math::SoaQuaternion (&_values)[2],
+    const internal::InterpSoaQuaternionTangent& _tangents,
+    const HermiteBasis& _basis) {
+  return _Policy::Normalize(_values[0] * _basis.p0 + _values[1] * _basis.p1 +
+                            _tangents.value[0] * _basis.m0 +
+                            _tangents.value[1] * _basis.m1);
+}
 
-  // Step the cache to this potentially new animation and ratio.
-  assert(cache->max_soa_tracks() >= num_soa_tracks);
-  cache->Step(*animation, anim_ratio);
-
-  // Fetch key frames from the animation to the cache a r = anim_ratio.
-  // Then updates outdated soa hot values.
-  UpdateKeys(anim_ratio, num_soa_tracks, animation->translations(),
-             &cache->translation_cursor_, cache->translation_keys_,
-             cache->outdated_translations_);
-  UpdateSoaTranslations(num_soa_tracks, animation->translations(),
-                        cache->translation_keys_, cache->outdated_translations_,
-                        cache->soa_translations_);
-
-  UpdateKeys(anim_ratio, num_soa_tracks, animation->rotations(),
-             &cache->rotation_cursor_, cache->rotation_keys_,
-             cache->outdated_rotations_);
-  UpdateSoaRotations(num_soa_tracks, animation->rotations(),
-                     cache->rotation_keys_, cache->outdated_rotations_,
-                     cache->soa_rotations_);
-
-  UpdateKeys(anim_ratio, num_soa_tracks, animation->scales(),
-             &cache->scale_cursor_, cache->scale_keys_,
-             cache->outdated_scales_);
-  UpdateSoaScales(num_soa_tracks, animation->scales(), cache->scale_keys_,
-                  cache->outdated_scales_, cache->soa_scales_);
-
-  // Interpolates soa hot data.
-  Interpolates(anim_ratio, num_soa_tracks, cache->soa_translations_,
-               cache->soa_rotations_, cache->soa_scales_, output.begin);
+// Spline animations version of Interpolates().
+template <typename _Policy, typename _Output>
+void InterpolatesSpline(
+    float _anim_ratio, int _num_soa_tracks,
+    const internal::InterpSoaTranslation* _translations,
+    const internal::InterpSoaFloat3Tangent* _translation_tangents,
+    const internal::InterpSoaRotation* _rotations,
+    const internal::InterpSoaQuaternionTangent* _rotation_tangents,
+    const internal::InterpSoaScale* _scales,
+    const internal::InterpSoaFloat3Tangent* _scale_tangents,
+    const uint8_t* _mask, _Output* _output) {
+  const math::SimdFloat4 anim_ratio = math::simd_float4::Load1(_anim_ratio);
+  for (int i = 0; i < _num_soa_tracks; ++i) {
+    if (_mask && !(_mask[i / 8] & (1 << (i & 7)))) {
+      continue;  // Masked out entries output is left unchanged.
+    }
 
-  return true;
-}
+    const math::SimdFloat4 t_span =
+        _translations[i].ratio[1] - _translations[i].ratio[0];
+    const HermiteBasis t_basis(
+        (anim_ratio - _translations[i].ratio[0]) * math::RcpEst(t_span),
+        t_span);
+    const math::SimdFloat4 r_span =
+        _rotations[i].ratio[1] - _rotations[i].ratio[0];
+    const HermiteBasis r_basis(
+        (anim_ratio - _rotations[i].ratio[0]) * math::RcpEst(r_span), r_span);
+    const math::SimdFloat4 s_span = _scales[i].ratio[1] - _scales[i].ratio[0];
+    const HermiteBasis s_basis(
+        (anim_ratio - _scales[i].ratio[0]) * math::RcpEst(s_span), s_span);
 
-SamplingCache::SamplingCache()
-    : max_soa_tracks_(0),
-      soa_translations_(NULL) {  // soa_translations_ is the allocation pointer.
-  Invalidate();
+    math::SoaTransform transform;
+    transform.translation =
+        Hermite(_translations[i].value, _translation_tangents[i], t_basis);
+    transform.rotation =
+        Hermite<_Policy>(_rotations[i].value, _rotation_tangents[i], r_basis);
+    transform.scale = Hermite(_scales[i].value, _scale_tangents[i], s_basis);
+    StorePose(transform, _output, i);
+  }
 }
 
-SamplingCache::SamplingCache(int _max_tracks)
-    : max_soa_tracks_(0),
-      soa_translations_(NULL) {  // soa_translations_ is the allocation pointer.
-  Resize(_max_tracks);
+// Computes the derivative, per second, of an interpolation coefficient over a
+// key interval of _span, for an animation whose inverse duration is
+// _inv_duration. Null spans (same key on both sides) have a null derivative.
+OZZ_INLINE math::SimdFloat4 InterpRate(math::SimdFloat4 _span,
+                                       math::SimdFloat4 _inv_duration) {
+  const math::SimdFloat4 zero = math::simd_float4::zero();
+  return math::Select(math::CmpNe(_span, zero), _inv_duration / _span, zero);
 }
 
-SamplingCache::~SamplingCache() {
-  // Deallocates everything at once.
-  memory::default_allocator()->Deallocate(soa_translations_);
+// Computes the interpolation coefficient of _anim_ratio in [_ratio0,_ratio1].
+OZZ_INLINE math::SimdFloat4 InterpAlpha(math::SimdFloat4 _anim_ratio,
+                                        math::SimdFloat4 _ratio0,
+                                        math::SimdFloat4 _ratio1) {
+  const math::SimdFloat4 zero = math::simd_float4::zero();
+  const math::SimdFloat4 span = _ratio1 - _ratio0;
+  return math::Select(math::CmpNe(span, zero), (_anim_ratio - _ratio0) / span,
+                      zero);
 }
 
-void SamplingCache::Resize(int _max_tracks) {
-  using internal::InterpSoaRotation;
-  using internal::InterpSoaScale;
-  using internal::InterpSoaTranslation;
+// Computes the angular velocity of a rotation interpolated as the normalized
+// quaternion _lerp, whose derivative is _dlerp. Angular velocity is
+// w = 2 * q' * conj(q), which simplifies to 2 * l' * conj(l) / |l|^2 for the
+// normalized q = l / |l|. Its vector part is
+// (l.w * l'.v - l'.w * l.v - l'.v x l.v), its real part is null.
+OZZ_INLINE math::SoaFloat3 AngularVelocity(const math::SoaQuaternion& _lerp,
+                                           const math::SoaQuaternion& _dlerp) {
+  const math::SoaFloat3 v = {_lerp.x, _lerp.y, _lerp.z};
+  const math::SoaFloat3 dv = {_dlerp.x, _dlerp.y, _dlerp.z};
+  const math::SimdFloat4 len2 = _lerp.x * _lerp.x + _lerp.y * _lerp.y +
+                                _lerp.z * _lerp.z + _lerp.w * _lerp.w;
+  return (dv * _lerp.w - v * _dlerp.w - Cross(dv, v)) *
+         (math::simd_float4::Load1(2.f) / len2);
+}
 
-  // Reset existing data.
-  Invalidate();
-  memory::default_allocator()->Deallocate(soa_translations_);
+// Computes velocities of linear interpolations of soa hot data.
+void Differentiates(float _anim_ratio, float _inv_duration,
+                    int _num_soa_tracks,
+                    const internal::InterpSoaTranslation* _translations,
+                    const internal::InterpSoaRotation* _rotations,
+                    const uint8_t* _mask, math::SoaFloat3* _linear,
+                    math::SoaFloat3* _angular) {
+  const math::SimdFloat4 anim_ratio = math::simd_float4::Load1(_anim_ratio);
+  const math::SimdFloat4 inv_duration =
+      math::simd_float4::Load1(_inv_duration);
+  for (int i = 0; i < _num_soa_tracks; ++i) {
+    if (_mask && !(_mask[i / 8] & (1 << (i & 7)))) {
+      continue;  // Masked out entries output is left unchanged.
+    }
+    if (_linear) {
+      const internal::InterpSoaTranslation& t = _translations[i];
+      _linear[i] = (t.value[1] - t.value[0]) *
+                   InterpRate(t.ratio[1] - t.ratio[0], inv_duration);
+    }
+    if (_angular) {
+      const internal::InterpSoaRotation& r = _rotations[i];
+      const math::SimdFloat4 alpha =
+          InterpAlpha(anim_ratio, r.ratio[0], r.ratio[1]);
+      const math::SoaQuaternion lerp = Lerp(r.value[0], r.value[1], alpha);
+      const math::SoaQuaternion dlerp =
+          (r.value[1] + -r.value[0]) *
+          InterpRate(r.ratio[1] - r.ratio[0], inv_duration);
+      _angular[i] = AngularVelocity(lerp, dlerp);
+    }
+  }
+}
 
-  // Updates maximum supported soa tracks.
-  max_soa_tracks_ = (_max_tracks + 3) / 4;
+// Compact mode version of Differentiates(), in frames: _anim_frame is the
+// sampling time in frames, and _frame_rate the number of frames per second.
+void DifferentiatesPacked(float _anim_frame, float _frame_rate,
+                          int _num_soa_tracks,
+                          const internal::PackedSoaFloat3* _translations,
+                          ozz::Range<const KeyRange> _translation_ranges,
+                          const internal::PackedSoaRotation* _rotations,
+                          const uint8_t* _mask, math::SoaFloat3* _linear,
+                          math::SoaFloat3* _angular) {
+  const math::SimdFloat4 anim_ratio = math::simd_float4::Load1(_anim_frame);
+  const math::SimdFloat4 inv_duration = math::simd_float4::Load1(_frame_rate);
+  for (int i = 0; i < _num_soa_tracks; ++i) {
+    if (_mask && !(_mask[i / 8] & (1 << (i & 7)))) {
+      continue;  // Masked out entries output is left unchanged.
+    }
+    if (_linear) {
+      const internal::PackedSoaFloat3& t = _translations[i];
+      const KeyRange& range = _translation_ranges.begin[i];
+      _linear[i] =
+          (UnpackSoaFloat3(t, 1, range) - UnpackSoaFloat3(t, 0, range)) *
+          InterpRate(LoadPacked(t.ratio[1]) - LoadPacked(t.ratio[0]),
+                     inv_duration);
+    }
+    if (_angular) {
+      const internal::PackedSoaRotation& r = _rotations[i];
+      const math::SimdFloat4 ratio0 = LoadPacked(r.ratio[0]);
+      const math::SimdFloat4 ratio1 = LoadPacked(r.ratio[1]);
+      const math::SoaQuaternion value0 = UnpackSoaQuaternion(r, 0);
+      const math::SoaQuaternion value1 = UnpackSoaQuaternion(r, 1);
+      const math::SoaQuaternion lerp =
+          Lerp(value0, value1, InterpAlpha(anim_ratio, ratio0, ratio1));
+      const math::SoaQuaternion dlerp =
+          (value1 + -value0) * InterpRate(ratio1 - ratio0, inv_duration);
+      _angular[i] = AngularVelocity(lerp, dlerp);
+    }
+  }
+}
 
-  // Allocate all cache data at once in a single allocation.
-  // Alignment is guaranteed because memory is dispatch from the highest
-  // alignment requirement (Soa data: SimdFloat4) to the lowest (outdated
-  // flag: unsigned char).
+// Computes the derivatives of cubic Hermite basis functions (see
+// HermiteBasis), per second.
+struct HermiteDerivativeBasis {
+  HermiteDerivativeBasis(math::SimdFloat4 _alpha, math::SimdFloat4 _span,
+                         math::SimdFloat4 _inv_duration) {
+    const math::SimdFloat4 two = math::simd_float4::Load1(2.f);
+    const math::SimdFloat4 three = math::simd_float4::Load1(3.f);
+    const math::SimdFloat4 four = math::simd_float4::Load1(4.f);
+    const math::SimdFloat4 six = math::simd_float4::Load1(6.f);
+    const math::SimdFloat4 alpha2 = _alpha * _alpha;
+    // Values basis derivatives are divided by the span, as alpha is relative
+    // to the key interval. Tangents basis are already pre-multiplied by it.
+    dp1 = (six * _alpha - six * alpha2) * InterpRate(_span, _inv_duration);
+    dp0 = -dp1;
+    dm0 = (three * alpha2 - four * _alpha + math::simd_float4::one()) *
+          _inv_duration;
+    dm1 = (three * alpha2 - two * _alpha) * _inv_duration;
+  }
+  math::SimdFloat4 dp0, dp1, dm0, dm1;
+};
 
-  // Computes allocation size.
-  const size_t max_tracks = max_soa_tracks_ * 4;
-  const size_t num_outdated = (max_soa_tracks_ + 7) / 8;
-  const size_t size =
-      sizeof(InterpSoaTranslation) * max_soa_tracks_ +
-      sizeof(InterpSoaRotation) * max_soa_tracks_ +
-      sizeof(InterpSoaScale) * max_soa_tracks_ +
-      sizeof(int) * max_tracks * 2 * 3 +  // 2 keys * (trans + rot + scale).
-      sizeof(uint8_t) * 3 * num_outdated;
+// Spline animations version of Differentiates().
+void DifferentiatesSpline(
+    float _anim_ratio, float _inv_duration, int _num_soa_tracks,
+    const internal::InterpSoaTranslation* _translations,
+    const internal::InterpSoaFloat3Tangent* _translation_tangents,
+    const internal::InterpSoaRotation* _rotations,
+    const internal::InterpSoaQuaternionTangent* _rotation_tangents,
+    const uint8_t* _mask, math::SoaFloat3* _linear,
+    math::SoaFloat3* _angular) {
+  const math::SimdFloat4 anim_ratio = math::simd_float4::Load1(_anim_ratio);
+  const math::SimdFloat4 inv_duration =
+      math::simd_float4::Load1(_inv_duration);
+  for (int i = 0; i < _num_soa_tracks; ++i) {
+    if (_mask && !(_mask[i / 8] & (1 << (i & 7)))) {
+      continue;  // Masked out entries output is left unchanged.
+    }
+    if (_linear) {
+      const internal::InterpSoaTranslation& t = _translations[i];
+      const internal::InterpSoaFloat3Tangent& tangents =
+          _translation_tangents[i];
+      const HermiteDerivativeBasis basis(
+          InterpAlpha(anim_ratio, t.ratio[0], t.ratio[1]),
+          t.ratio[1] - t.ratio[0], inv_duration);
+      _linear[i] = t.value[0] * basis.dp0 + t.value[1] * basis.dp1 +
+                   tangents.value[0] * basis.dm0 +
+                   tangents.value[1] * basis.dm1;
+    }
+    if (_angular) {
+      const internal::InterpSoaRotation& r = _rotations[i];
+      const internal::InterpSoaQuaternionTangent& tangents =
+          _rotation_tangents[i];
+      const math::SimdFloat4 span = r.ratio[1] - r.ratio[0];
+      const math::SimdFloat4 alpha =
+          InterpAlpha(anim_ratio, r.ratio[0], r.ratio[1]);
+      const HermiteBasis basis(alpha, span);
+      const math::SoaQuaternion lerp =
+          r.value[0] * basis.p0 + r.value[1] * basis.p1 +
+          tangents.value[0] * basis.m0 + tangents.value[1] * basis.m1;
+      const HermiteDerivativeBasis dbasis(alpha, span, inv_duration);
+      const math::SoaQuaternion dlerp =
+          r.value[0] * dbasis.dp0 + r.value[1] * dbasis.dp1 +
+          tangents.value[0] * dbasis.dm0 + tangents.value[1] * dbasis.dm1;
+      _angular[i] = AngularVelocity(lerp, dlerp);
+    }
+  }
+}
+
+// Interpolation kernels, specialized for a quaternion normalization policy and
+// an _Output pose type.
+template <typename _Output>
+struct InterpolationKernels {
+  template <typename _Policy>
+  static InterpolationKernels Get() {
+    const InterpolationKernels kernels = {
+        &Interpolates<_Policy, _Output>, &InterpolatesPacked<_Policy, _Output>,
+        &InterpolatesSpline<_Policy, _Output>};
+    return kernels;
+  }
+
+  void (*linear)(float, int, const internal::InterpSoaTranslation*,
+                 const internal::InterpSoaRotation*,
+                 const internal::InterpSoaScale*, const uint8_t*, _Output*);
+  void (*packed)(float, int, const internal::PackedSoaFloat3*,
+                 ozz::Range<const KeyRange>,
+                 const internal::PackedSoaRotation*,
+                 const internal::PackedSoaFloat3*, ozz::Range<const KeyRange>,
+                 const uint8_t*, _Output*);
+  void (*spline)(float, int, const internal::InterpSoaTranslation*,
+                 const internal::InterpSoaFloat3Tangent*,
+                 const internal::InterpSoaRotation*,
+                 const internal::InterpSoaQuaternionTangent*,
+                 const internal::InterpSoaScale*,
+                 const internal::InterpSoaFloat3Tangent*, const uint8_t*,
+                 _Output*);
+};
+
+// Selects interpolation kernels matching _quality, for _Output poses.
+template <typename _Output>
+InterpolationKernels<_Output> SelectKernels(SamplingJob::Quality _quality) {
+  typedef InterpolationKernels<_Output> Kernels;
+  switch (_quality) {
+    case SamplingJob::kFast:
+      return Kernels::template Get<math::EstimatedNormalization<0> >();
+    case SamplingJob::kAccurate:
+      return Kernels::template Get<math::ExactNormalization>();
+    default:
+      return Kernels::template Get<math::EstimatedNormalization<1> >();
+  }
+}
+
+// Selects soa tracks to interpolate during an incremental sampling, and
+// outputs them to _changed. These are the unmasked tracks that were refreshed
+// (outdated keys), or that weren't steady.
+void SelectChanged(int _num_soa_tracks, const uint8_t* _mask,
+                   const uint8_t* _outdated_translations,
+                   const uint8_t* _outdated_rotations,
+                   const uint8_t* _outdated_scales, const uint8_t* _steady,
+                   uint8_t* _changed) {
+  const int num_flags = (_num_soa_tracks + 7) / 8;
+  for (int i = 0; i < num_flags; ++i) {
+    const uint8_t refreshed = _outdated_translations[i] |
+                              _outdated_rotations[i] | _outdated_scales[i];
+    const uint8_t valid =
+        i < num_flags - 1 ? 0xff : 0xff >> (num_flags * 8 - _num_soa_tracks);
+    _changed[i] =
+        (_mask ? _mask[i] : 0xff) & valid & ~(_steady[i] & ~refreshed);
+  }
+}
+
+OZZ_INLINE math::SimdInt4 CmpEq(const math::SoaFloat3& _a,
+                                const math::SoaFloat3& _b) {
+  return math::And(math::And(math::CmpEq(_a.x, _b.x), math::CmpEq(_a.y, _b.y)),
+                   math::CmpEq(_a.z, _b.z));
+}
+
+OZZ_INLINE math::SimdInt4 CmpEq(const math::SoaQuaternion& _a,
+                                const math::SoaQuaternion& _b) {
+  return math::And(math::And(math::CmpEq(_a.x, _b.x), math::CmpEq(_a.y, _b.y)),
+                   math::And(math::CmpEq(_a.z, _b.z), math::CmpEq(_a.w, _b.w)));
+}
+
+// Tests if left and right keys of the 4 lanes of _interp are equal, meaning
+// interpolation doesn't depend on the ratio.
+template <typename _Interp>
+OZZ_INLINE bool IsSteady(const _Interp& _interp) {
+  return math::AreAllTrue(CmpEq(_interp.value[0], _interp.value[1]));
+}
+
+// Spline interpolation also requires null tangents.
+template <typename _Tangent>
+OZZ_INLINE bool IsSteadyTangent(const _Tangent& _tangent) {
+  const math::SimdFloat4 zero = math::simd_float4::zero();
+  const math::SimdInt4 zero0 = math::And(
+      math::And(math::CmpEq(_tangent.value[0].x, zero),
+                math::CmpEq(_tangent.value[0].y, zero)),
+      math::CmpEq(_tangent.value[0].z, zero));
+  const math::SimdInt4 zero1 = math::And(
+      math::And(math::CmpEq(_tangent.value[1].x, zero),
+                math::CmpEq(_tangent.value[1].y, zero)),
+      math::CmpEq(_tangent.value[1].z, zero));
+  return math::AreAllTrue(math::And(zero0, zero1));
+}
+
+OZZ_INLINE bool IsSteadyTangent(
+    const internal::InterpSoaQuaternionTangent& _tangent) {
+  const math::SimdFloat4 zero = math::simd_float4::zero();
+  const math::SoaQuaternion zeros = {zero, zero, zero, zero};
+  return math::AreAllTrue(math::And(CmpEq(_tangent.value[0], zeros),
+                                    CmpEq(_tangent.value[1], zeros)));
+}
+
+// Compact mode hot data are compared in their quantized form.
+OZZ_INLINE bool IsSteady(const internal::PackedSoaFloat3& _interp) {
+  return std::memcmp(_interp.value[0], _interp.value[1],
+                     sizeof(_interp.value[0])) == 0;
+}
+
+OZZ_INLINE bool IsSteady(const internal::PackedSoaRotation& _interp) {
+  return std::memcmp(_interp.value[0], _interp.value[1],
+                     sizeof(_interp.value[0])) == 0;
+}
+
+// Updates _steady flags of _changed soa tracks, from their hot data.
+// _translation_tangents, _rotation_tangents and _scale_tangents are only
+// specified for spline animations.
+template <typename _Translation, typename _Rotation, typename _Scale>
+void UpdateSteady(
+    int _num_soa_tracks, const uint8_t* _changed,
+    const _Translation* _translations, const _Rotation* _rotations,
+    const _Scale* _scales,
+    const internal::InterpSoaFloat3Tangent* _translation_tangents,
+    const internal::InterpSoaQuaternionTangent* _rotation_tangents,
+    const internal::InterpSoaFloat3Tangent* _scale_tangents,
+    uint8_t* _steady) {
+  const int num_flags = (_num_soa_tracks + 7) / 8;
+  for (int j = 0; j < num_flags; ++j) {
+    uint8_t changed = _changed[j];
+    for (int i = j * 8; changed; ++i, changed >>= 1) {
+      if (!(changed & 1)) {
+        continue;
+      }
+      bool steady = IsSteady(_translations[i]) && IsSteady(_rotations[i]) &&
+                    IsSteady(_scales[i]);
+      if (steady && _translation_tangents) {
+        steady = IsSteadyTangent(_translation_tangents[i]) &&
+                 IsSteadyTangent(_rotation_tangents[i]) &&
+                 IsSteadyTangent(_scale_tangents[i]);
+      }
+      const uint8_t bit = static_cast<uint8_t>(1 << (i & 7));
+      _steady[j] = steady ? (_steady[j] | bit) : (_steady[j] & ~bit);
+    }
+  }
+}
+}  // namespace
+
+SamplingCounters::SamplingCounters() { Reset(); }
+
+void SamplingCounters::Reset() {
+  samples = 0;
+  keys_scanned = 0;
+  decompressed = 0;
+  invalidations = 0;
+  seeks = 0;
+  wraps = 0;
+}
+
+SamplingCounters& SamplingCounters::operator+=(
+    const SamplingCounters& _other) {
+  samples += _other.samples;
+  keys_scanned += _other.keys_scanned;
+  decompressed += _other.decompressed;
+  invalidations += _other.invalidations;
+  seeks += _other.seeks;
+  wraps += _other.wraps;
+  return *this;
+}
+
+SamplingCounters Aggregate(const Range<const SamplingCounters>& _counters) {
+  SamplingCounters aggregated;
+  for (const SamplingCounters* counters = _counters.begin;
+       counters < _counters.end; ++counters) {
+    aggregated += *counters;
+  }
+  return aggregated;
+}
+
+SamplingJob::SamplingJob()
+    : ratio(0.f),
+      quality(kStandard),
+      loop(false),
+      animation(NULL),
+      cache(NULL),
+      weight(1.f),
+      scatter(false),
+      precision_lod(0),
+      counters(NULL) {}
+
+bool SamplingJob::Run() const {
+  if (!Validate()) {
+    return false;
+  }
+  RunUnchecked();
+  return true;
+}
+
+void SamplingJob::RunUnchecked() const {
+  OZZ_PROFILE_ZONE("ozz::SamplingJob::Run");
+  assert(Validate() && "Invalid job, see SamplingJob::Validate().");
+
+  // Clamps ratio in range [0,duration].
+  const float anim_ratio = math::Clamp(0.f, ratio, 1.f);
+
+  // Sparse animations soa tracks are stored to their skeleton soa joints.
+  const int* indices = scatter ? animation->soa_joints().begin : NULL;
+
+  if (half_output.begin) {
+    cache->Sample(*animation, anim_ratio, mask.begin, changed.begin,
+                  half_output.begin, quality, counters, loop, indices,
+                  precision_lod);
+  } else if (accumulator.begin) {
+    if (animation->num_soa_tracks() != 0) {
+      const AccumulatorOutput acc = {accumulator.begin,
+                                     math::simd_float4::Load1(weight),
+                                     joint_weights.begin};
+      cache->Update(*animation, anim_ratio, mask.begin, NULL, counters, loop,
+                    precision_lod);
+      if (indices) {
+        const ScatterOutput<const AccumulatorOutput> scattered = {&acc,
+                                                                  indices};
+        cache->Interpolate(*animation, anim_ratio, mask.begin, NULL,
+                           &scattered, quality);
+      } else {
+        cache->Interpolate(*animation, anim_ratio, mask.begin, NULL, &acc,
+                           quality);
+      }
+    }
+  } else {
+    cache->Sample(*animation, anim_ratio, mask.begin, changed.begin,
+                  output.begin, quality, counters, loop, indices,
+                  precision_lod);
+  }
+
+  // Velocities are computed for the tracks that were written to output.
+  cache->Differentiate(*animation, anim_ratio,
+                       changed.begin ? changed.begin : mask.begin,
+                       linear_velocities.begin, angular_velocities.begin);
+}
+
+BatchSamplingJob::BatchSamplingJob()
+    : animation(NULL),
+      quality(SamplingJob::kStandard),
+      scheduler(NULL),
+      grain_size(16),
+      prefetch_distance(0) {}
+
+bool BatchSamplingJob::Validate() const {
+  if (!animation || grain_size <= 0 || prefetch_distance < 0) {
+    return false;
+  }
+
+  // All instances ranges must match.
+  const size_t num_instances = ratios.count();
+  bool valid = caches.count() == num_instances;
+  valid &= outputs.count() == num_instances;
+  valid &= counters.count() == 0 || counters.count() == num_instances;
+  if (!valid) {
+    return false;
+  }
+
+  // Validates each instance.
+  const ptrdiff_t num_soa_tracks = animation->num_soa_tracks();
+  for (size_t i = 0; i < num_instances; ++i) {
+    const SamplingCache* cache = caches.begin[i];
+    if (!cache) {
+      return false;
+    }
+    valid &= CanSample(*cache, *animation);
+    const Range<math::SoaTransform>& output = outputs.begin[i];
+    valid &= output.begin != NULL;
+    valid &= output.end - output.begin >= num_soa_tracks;
+  }
+
+  return valid;
+}
+
+bool BatchSamplingJob::Run() const {
+  OZZ_PROFILE_ZONE("ozz::BatchSamplingJob::Run");
+  if (!Validate()) {
+    return false;
+  }
+
+  const int num_soa_tracks = animation->num_soa_tracks();
+  if (num_soa_tracks == 0) {  // Early out if animation contains no joint.
+    return true;
+  }
+
+  const int num_instances = static_cast<int>(ratios.count());
+  if (scheduler) {
+    ParallelFor(scheduler, &SampleTask, const_cast<BatchSamplingJob*>(this),
+                (num_instances + grain_size - 1) / grain_size);
+  } else {
+    Sample(0, num_instances);
+  }
+
+  return true;
+}
+
+void BatchSamplingJob::SampleTask(void* _context, int _index) {
+  const BatchSamplingJob& job = *static_cast<BatchSamplingJob*>(_context);
+  const int num_instances = static_cast<int>(job.ratios.count());
+  const int begin = _index * job.grain_size;
+  const int end = begin + job.grain_size < num_instances
+                      ? begin + job.grain_size
+                      : num_instances;
+  job.Sample(begin, end);
+}
+
+void BatchSamplingJob::Sample(int _begin, int _end) const {
+  const int num_soa_tracks = animation->num_soa_tracks();
+  const math::SoaTransform* previous = NULL;
+  float previous_ratio = 0.f;
+  for (int i = _begin; i < _end; ++i) {
+    // Prefetches instances ahead, cache objects first as cache data addresses
+    // are read from them.
+    if (prefetch_distance > 0) {
+      const int ahead = i + prefetch_distance;
+      if (ahead < _end) {
+        caches.begin[ahead]->Prefetch(*animation, outputs.begin[ahead].begin);
+      }
+      if (ahead + prefetch_distance < _end) {
+        OZZ_PREFETCH(caches.begin[ahead + prefetch_distance]);
+      }
+    }
+
+    // Clamps ratio in range [0,duration].
+    const float anim_ratio = math::Clamp(0.f, ratios.begin[i], 1.f);
+    math::SoaTransform* output = outputs.begin[i].begin;
+
+    // Shares previous instance sampling result if ratio is the same.
+    // Instance cache is left untouched, which doesn't affect its validity.
+    if (previous && anim_ratio == previous_ratio) {
+      std::memcpy(output, previous,
+                  sizeof(math::SoaTransform) * num_soa_tracks);
+      continue;
+    }
+
+    caches.begin[i]->Sample(*animation, anim_ratio, NULL, NULL, output,
+                            quality, counters.begin ? &counters[i] : NULL);
+
+    previous = output;
+    previous_ratio = anim_ratio;
+  }
+}
+
+GroupedSamplingJob::GroupedSamplingJob()
+    : quality(SamplingJob::kStandard),
+      scheduler(NULL),
+      grain_size(16),
+      prefetch_distance(0) {}
+
+bool GroupedSamplingJob::Validate() const {
+  const size_t num_instances = animations.count();
+  bool valid = grain_size > 0 && prefetch_distance >= 0;
+  valid &= ratios.count() == num_instances;
+  valid &= caches.count() == num_instances;
+  valid &= outputs.count() == num_instances;
+  valid &= counters.count() == 0 || counters.count() == num_instances;
+  valid &= order.count() >= num_instances;
+  if (!valid) {
+    return false;
+  }
+
+  // Validates each instance.
+  for (size_t i = 0; i < num_instances; ++i) {
+    const Animation* animation = animations.begin[i];
+    const SamplingCache* cache = caches.begin[i];
+    if (!animation || !cache) {
+      return false;
+    }
+    valid &= CanSample(*cache, *animation);
+    const Range<math::SoaTransform>& output = outputs.begin[i];
+    valid &= output.begin != NULL;
+    valid &= output.end - output.begin >= animation->num_soa_tracks();
+  }
+
+  return valid;
+}
+
+namespace {
+// Orders instances by animation, then by ratio.
+struct GroupedInstanceLess {
+  GroupedInstanceLess(const Animation* const* _animations,
+                      const float* _ratios)
+      : animations(_animations), ratios(_ratios) {}
+  bool operator()(int _a, int _b) const {
+    if (animations[_a] != animations[_b]) {
+      return animations[_a] < animations[_b];
+    }
+    return ratios[_a] < ratios[_b];
+  }
+  const Animation* const* animations;
+  const float* ratios;
+};
+}  // namespace
+
+bool GroupedSamplingJob::Run() const {
+  OZZ_PROFILE_ZONE("ozz::GroupedSamplingJob::Run");
+  if (!Validate()) {
+    return false;
+  }
+
+  // Sorts instances, so that instances of the same animation are contiguous.
+  const int num_instances = static_cast<int>(animations.count());
+  for (int i = 0; i < num_instances; ++i) {
+    order[i] = i;
+  }
+  std::sort(order.begin, order.begin + num_instances,
+            GroupedInstanceLess(animations.begin, ratios.begin));
+
+  if (scheduler) {
+    ParallelFor(scheduler, &SampleTask, const_cast<GroupedSamplingJob*>(this),
+                (num_instances + grain_size - 1) / grain_size);
+  } else {
+    Sample(0, num_instances);
+  }
+
+  return true;
+}
+
+void GroupedSamplingJob::SampleTask(void* _context, int _index) {
+  const GroupedSamplingJob& job = *static_cast<GroupedSamplingJob*>(_context);
+  const int num_instances = static_cast<int>(job.animations.count());
+  const int begin = _index * job.grain_size;
+  const int end = begin + job.grain_size < num_instances
+                      ? begin + job.grain_size
+                      : num_instances;
+  job.Sample(begin, end);
+}
+
+void GroupedSamplingJob::Sample(int _begin, int _end) const {
+  const Animation* previous_animation = NULL;
+  const math::SoaTransform* previous = NULL;
+  float previous_ratio = 0.f;
+  for (int i = _begin; i < _end; ++i) {
+    // Prefetches sorted instances ahead, see BatchSamplingJob::Sample().
+    if (prefetch_distance > 0) {
+      const int ahead = i + prefetch_distance;
+      if (ahead < _end) {
+        const int prefetched = order[ahead];
+        caches.begin[prefetched]->Prefetch(*animations.begin[prefetched],
+                                           outputs.begin[prefetched].begin);
+      }
+      if (ahead + prefetch_distance < _end) {
+        const int prefetched = order[ahead + prefetch_distance];
+        OZZ_PREFETCH(caches.begin[prefetched]);
+        OZZ_PREFETCH(animations.begin[prefetched]);
+      }
+    }
+
+    const int instance = order[i];
+    const Animation& animation = *animations.begin[instance];
+    const int num_soa_tracks = animation.num_soa_tracks();
+    if (num_soa_tracks == 0) {  // Skips animations that contain no joint.
+      continue;
+    }
+
+    // Clamps ratio in range [0,duration].
+    const float anim_ratio = math::Clamp(0.f, ratios.begin[instance], 1.f);
+    math::SoaTransform* output = outputs.begin[instance].begin;
+
+    // Shares previous instance sampling result if animation and ratio are the
+    // same. Instance cache is left untouched, which doesn't affect its
+    // validity.
+    if (previous && &animation == previous_animation &&
+        anim_ratio == previous_ratio) {
+      std::memcpy(output, previous,
+                  sizeof(math::SoaTransform) * num_soa_tracks);
+      continue;
+    }
+
+    caches.begin[instance]->Sample(
+        animation, anim_ratio, NULL, NULL, output, quality,
+        counters.begin ? &counters[instance] : NULL);
+
+    previous_animation = &animation;
+    previous = output;
+    previous_ratio = anim_ratio;
+  }
+}
+
+CacheWarmUpJob::CacheWarmUpJob()
+    : ratio(0.f), animation(NULL), source(NULL), cache(NULL), counters(NULL) {}
+
+bool CacheWarmUpJob::Validate() const {
+  if (!animation || !cache) {
+    return false;
+  }
+  return source != cache && CanSample(*cache, *animation);
+}
+
+bool CacheWarmUpJob::Run() const {
+  OZZ_PROFILE_ZONE("ozz::CacheWarmUpJob::Run");
+  if (!Validate()) {
+    return false;
+  }
+
+  const int num_soa_tracks = animation->num_soa_tracks();
+  if (num_soa_tracks == 0) {  // Early out if animation contains no joint.
+    return true;
+  }
+
+  // Clamps ratio in range [0,duration].
+  const float anim_ratio = math::Clamp(0.f, ratio, 1.f);
+
+  // Clones source state if it's warm for this animation, and not ahead of
+  // ratio (which would invalidate the cache anyway). A failing copy leaves
+  // cache unchanged, which is still valid.
+  if (source && source->animation_ == animation &&
+      source->animation_uid_ == animation->uid() &&
+      source->ratio_ <= anim_ratio) {
+    cache->CopyFrom(*source);
+  }
+
+  cache->Update(*animation, anim_ratio, NULL, NULL, counters);
+
+  return true;
+}
+
+void SamplingCache::Update(const Animation& _animation, float _ratio,
+                           const uint8_t* _mask, uint8_t* _changed,
+                           SamplingCounters* _counters, bool _loop,
+                           int _lod) {
+  const int num_soa_tracks = _animation.num_soa_tracks();
+  const bool compact = mode_ == kCompact;
+  // Keys are searched in frames, see Animation::num_frames().
+  const float frames = static_cast<float>(_animation.num_frames());
+  const float frame = _ratio * frames;
+  {
+    OZZ_PROFILE_ZONE("ozz::SamplingJob::UpdateKeys");
+
+    // Step the cache to this potentially new animation and ratio.
+    assert(max_soa_tracks() >= num_soa_tracks);
+    Step(_animation, _ratio, _counters, _loop);
+    const int cursors = translation_cursor_ + rotation_cursor_ + scale_cursor_;
+
+    // Fetch key frames from the animation to the cache a r = _ratio. Lods
+    // higher than kKeepKeyLod skip the same keys.
+    const int lod = math::Min(_lod, static_cast<int>(Animation::kKeepKeyLod));
+    const Range<const uint8_t> t_lods = _animation.translation_key_lods();
+    const Range<const uint8_t> r_lods = _animation.rotation_key_lods();
+    const Range<const uint8_t> s_lods = _animation.scale_key_lods();
+    const Range<const int> t_next = _animation.translation_lod_next();
+    const Range<const int> r_next = _animation.rotation_lod_next();
+    const Range<const int> s_next = _animation.scale_lod_next();
+    const float* t_times = _animation.translation_times().begin;
+    const float* r_times = _animation.rotation_times().begin;
+    const float* s_times = _animation.scale_times().begin;
+    if (compact) {
+      UpdateKeys(frame, num_soa_tracks,
+                 _animation.num_constant_translations(),
+                 _animation.translations(), t_times, &translation_cursor_,
+                 packed_translation_keys_, outdated_translations_,
+                 t_lods.begin, t_next.begin, lod);
+      UpdateKeys(frame, num_soa_tracks, _animation.num_constant_rotations(),
+                 _animation.rotations(), r_times, &rotation_cursor_,
+                 packed_rotation_keys_, outdated_rotations_, r_lods.begin,
+                 r_next.begin, lod);
+      UpdateKeys(frame, num_soa_tracks, _animation.num_constant_scales(),
+                 _animation.scales(), s_times, &scale_cursor_,
+                 packed_scale_keys_,
+                 outdated_scales_, s_lods.begin, s_next.begin, lod);
+    } else {
+      UpdateKeys(frame, num_soa_tracks,
+                 _animation.num_constant_translations(),
+                 _animation.translations(), t_times, &translation_cursor_,
+                 translation_keys_, outdated_translations_, t_lods.begin,
+                 t_next.begin, lod);
+      UpdateKeys(frame, num_soa_tracks, _animation.num_constant_rotations(),
+                 _animation.rotations(), r_times, &rotation_cursor_,
+                 rotation_keys_,
+                 outdated_rotations_, r_lods.begin, r_next.begin, lod);
+      UpdateKeys(frame, num_soa_tracks, _animation.num_constant_scales(),
+                 _animation.scales(), s_times, &scale_cursor_, scale_keys_,
+                 outdated_scales_, s_lods.begin, s_next.begin, lod);
+    }
+
+    // Step tracks right values must be restored once reached.
+    if (_animation.has_steps()) {
+      if (compact) {
+        OutdateSteps(frame, num_soa_tracks, _animation.steps().begin,
+                     packed_translations_, packed_rotations_, packed_scales_,
+                     outdated_translations_, outdated_rotations_,
+                     outdated_scales_);
+      } else {
+        OutdateSteps(_ratio, num_soa_tracks, _animation.steps().begin,
+                     soa_translations_, soa_rotations_, soa_scales_,
+                     outdated_translations_, outdated_rotations_,
+                     outdated_scales_);
+      }
+    }
+
+    // Incremental sampling only interpolates tracks that could have changed,
+    // which must be selected before outdated flags are reset. Otherwise
+    // steady flags don't apply to the output, which could be any buffer.
+    if (_changed) {
+      SelectChanged(num_soa_tracks, _mask, outdated_translations_,
+                    outdated_rotations_, outdated_scales_, steady_, _changed);
+    } else {
+      std::memset(steady_, 0, (num_soa_tracks + 7) / 8);
+    }
+
+    if (_counters) {
+      ++_counters->samples;
+      _counters->keys_scanned +=
+          translation_cursor_ + rotation_cursor_ + scale_cursor_ - cursors;
+      _counters->decompressed +=
+          CountOutdated(num_soa_tracks, _mask, outdated_translations_) +
+          CountOutdated(num_soa_tracks, _mask, outdated_rotations_) +
+          CountOutdated(num_soa_tracks, _mask, outdated_scales_);
+    }
+  }
+
+  // Updates outdated soa hot values.
+  OZZ_PROFILE_ZONE("ozz::SamplingJob::Decompress");
+  if (compact) {
+    UpdatePackedSoaFloat3(num_soa_tracks, _animation.translations(),
+                          _animation.translation_ranges(),
+                          _animation.translation_values().begin,
+                          _animation.translation_value_offsets().begin,
+                          packed_translation_keys_, _mask,
+                          outdated_translations_, packed_translations_);
+    UpdateSoaRotations(num_soa_tracks, 1.f / frames, _animation.rotations(),
+                       NULL, packed_rotation_keys_, _mask, outdated_rotations_,
+                       packed_rotations_, NULL, NULL);
+    UpdatePackedSoaFloat3(num_soa_tracks, _animation.scales(),
+                          _animation.scale_ranges(),
+                          _animation.scale_values().begin,
+                          _animation.scale_value_offsets().begin,
+                          packed_scale_keys_, _mask, outdated_scales_,
+                          packed_scales_);
+    if (_animation.has_steps()) {
+      HoldSteps(frame, num_soa_tracks, _animation.steps().begin,
+                packed_translations_, packed_rotations_, packed_scales_);
+    }
+    return;
+  }
+
+  // Tangents are only decompressed for spline animations.
+  const bool spline = _animation.spline();
+  assert(!spline || mode_ == kSpline);
+
+  const float inv_frames = 1.f / frames;
+  UpdateSoaTranslations(num_soa_tracks, inv_frames, _animation.translations(),
+                        _animation.translation_times().begin,
+                        _animation.translation_ranges(),
+                        _animation.translation_values().begin,
+                        _animation.translation_value_offsets().begin,
+                        translation_keys_, _mask, outdated_translations_,
+                        soa_translations_,
+                        _animation.translation_tangents().begin,
+                        spline ? soa_translation_tangents_ : NULL);
+  UpdateSoaRotations(num_soa_tracks, inv_frames, _animation.rotations(),
+                     _animation.rotation_times().begin, rotation_keys_, _mask,
+                     outdated_rotations_, soa_rotations_,
+                     _animation.rotation_tangents().begin,
+                     spline ? soa_rotation_tangents_ : NULL);
+  UpdateSoaScales(num_soa_tracks, inv_frames, _animation.scales(),
+                  _animation.scale_times().begin, _animation.scale_ranges(),
+                  _animation.scale_values().begin,
+                  _animation.scale_value_offsets().begin, scale_keys_, _mask,
+                  outdated_scales_, soa_scales_,
+                  _animation.scale_tangents().begin,
+                  spline ? soa_scale_tangents_ : NULL);
+  if (_animation.has_steps()) {
+    HoldSteps(_ratio, num_soa_tracks, _animation.steps().begin,
+              soa_translations_, soa_rotations_, soa_scales_);
+  }
+}
+
+template <typename _Output>
+void SamplingCache::Interpolate(const Animation& _animation, float _ratio,
+                                const uint8_t* _mask, uint8_t* _changed,
+                                _Output* _output,
+                                SamplingJob::Quality _quality) {
+  const int num_soa_tracks = _animation.num_soa_tracks();
+
+  // Incremental sampling only interpolates changed tracks.
+  OZZ_PROFILE_ZONE("ozz::SamplingJob::Interpolate");
+  const uint8_t* interp_mask = _changed ? _changed : _mask;
+
+  if (mode_ == kCompact) {
+    // Interpolates compact soa hot data.
+    const InterpolationKernels<_Output> kernels =
+        SelectKernels<_Output>(_quality);
+    const float frame = _ratio * _animation.num_frames();
+    kernels.packed(frame, num_soa_tracks, packed_translations_,
+                   _animation.translation_ranges(), packed_rotations_,
+                   packed_scales_, _animation.scale_ranges(), interp_mask,
+                   _output);
+    if (_changed) {
+      UpdateSteady(num_soa_tracks, _changed, packed_translations_,
+                   packed_rotations_, packed_scales_, NULL, NULL, NULL,
+                   steady_);
+    }
+    return;
+  }
+
+  // Interpolates soa hot data, including tangents for spline animations.
+  const bool spline = _animation.spline();
+  const InterpolationKernels<_Output> kernels =
+      SelectKernels<_Output>(_quality);
+  if (spline) {
+    kernels.spline(_ratio, num_soa_tracks, soa_translations_,
+                   soa_translation_tangents_, soa_rotations_,
+                   soa_rotation_tangents_, soa_scales_, soa_scale_tangents_,
+                   interp_mask, _output);
+  } else {
+    kernels.linear(_ratio, num_soa_tracks, soa_translations_, soa_rotations_,
+                   soa_scales_, interp_mask, _output);
+  }
+  if (_changed) {
+    UpdateSteady(num_soa_tracks, _changed, soa_translations_, soa_rotations_,
+                 soa_scales_, spline ? soa_translation_tangents_ : NULL,
+                 spline ? soa_rotation_tangents_ : NULL,
+                 spline ? soa_scale_tangents_ : NULL, steady_);
+  }
+}
+
+void SamplingCache::Sample(const Animation& _animation, float _ratio,
+                           const uint8_t* _mask, uint8_t* _changed,
+                           math::SoaTransform* _output,
+                           SamplingJob::Quality _quality,
+                           SamplingCounters* _counters, bool _loop,
+                           const int* _scatter, int _lod) {
+  if (_animation.num_soa_tracks() == 0) {  // Early out if no joint.
+    return;
+  }
+
+  // Fetches and decompresses key frames.
+  Update(_animation, _ratio, _mask, _changed, _counters, _loop, _lod);
+
+  if (_scatter) {
+    const ScatterOutput<math::SoaTransform> scattered = {_output, _scatter};
+    Interpolate(_animation, _ratio, _mask, _changed, &scattered, _quality);
+  } else {
+    Interpolate(_animation, _ratio, _mask, _changed, _output, _quality);
+  }
+}
+
+void SamplingCache::Sample(const Animation& _animation, float _ratio,
+                           const uint8_t* _mask, uint8_t* _changed,
+                           math::SoaHalfTransform* _output,
+                           SamplingJob::Quality _quality,
+                           SamplingCounters* _counters, bool _loop,
+                           const int* _scatter, int _lod) {
+  if (_animation.num_soa_tracks() == 0) {  // Early out if no joint.
+    return;
+  }
+
+  // Fetches and decompresses key frames.
+  Update(_animation, _ratio, _mask, _changed, _counters, _loop, _lod);
+
+  if (_scatter) {
+    const ScatterOutput<math::SoaHalfTransform> scattered = {_output,
+                                                             _scatter};
+    Interpolate(_animation, _ratio, _mask, _changed, &scattered, _quality);
+  } else {
+    Interpolate(_animation, _ratio, _mask, _changed, _output, _quality);
+  }
+}
+
+void SamplingCache::Differentiate(const Animation& _animation, float _ratio,
+                                  const uint8_t* _mask,
+                                  math::SoaFloat3* _linear,
+                                  math::SoaFloat3* _angular) const {
+  const int num_soa_tracks = _animation.num_soa_tracks();
+  if (num_soa_tracks == 0 || (!_linear && !_angular)) {
+    return;
+  }
+
+  OZZ_PROFILE_ZONE("ozz::SamplingJob::Differentiate");
+  const float duration = _animation.duration();
+  const float inv_duration = duration > 0.f ? 1.f / duration : 0.f;
+  if (mode_ == kCompact) {
+    const float frames = static_cast<float>(_animation.num_frames());
+    DifferentiatesPacked(_ratio * frames, inv_duration * frames,
+                         num_soa_tracks, packed_translations_,
+                         _animation.translation_ranges(), packed_rotations_,
+                         _mask, _linear, _angular);
+  } else if (_animation.spline()) {
+    DifferentiatesSpline(_ratio, inv_duration, num_soa_tracks,
+                         soa_translations_, soa_translation_tangents_,
+                         soa_rotations_, soa_rotation_tangents_, _mask,
+                         _linear, _angular);
+  } else {
+    Differentiates(_ratio, inv_duration, num_soa_tracks, soa_translations_,
+                   soa_rotations_, _mask, _linear, _angular);
+  }
+}
+
+SamplingCache::SamplingCache()
+    : max_soa_tracks_(0),
+      mode_(kFull),
+      allocator_(memory::default_allocator()),
+      allocation_(NULL) {
+  Resize(0);
+}
+
+SamplingCache::SamplingCache(int _max_tracks, Mode _mode)
+    : max_soa_tracks_(0),
+      mode_(kFull),
+      allocator_(memory::default_allocator()),
+      allocation_(NULL) {
+  Resize(_max_tracks, _mode);
+}
+
+SamplingCache::SamplingCache(int _max_tracks, Mode _mode,
+                             memory::Allocator* _allocator)
+    : max_soa_tracks_(0),
+      mode_(kFull),
+      allocator_(_allocator),
+      allocation_(NULL) {
+  assert(_allocator && "Invalid allocator");
+  Resize(_max_tracks, _mode);
+}
+
+SamplingCache::~SamplingCache() {
+  // Deallocates everything at once.
+  allocator_->Deallocate(allocation_);
+}
+
+size_t SamplingCache::AllocationSize(int _max_tracks, Mode _mode) {
+  using internal::InterpSoaFloat3Tangent;
+  using internal::InterpSoaQuaternionTangent;
+  using internal::InterpSoaRotation;
+  using internal::InterpSoaScale;
+  using internal::InterpSoaTranslation;
+  using internal::PackedSoaFloat3;
+  using internal::PackedSoaRotation;
+
+  const size_t max_soa_tracks = (_max_tracks + 3) / 4;
+  const bool compact = _mode == kCompact;
+  const bool spline = _mode == kSpline;
+  const size_t max_tracks = max_soa_tracks * 4;
+  const size_t num_outdated = (max_soa_tracks + 7) / 8;
+  const size_t full_size =
+      sizeof(InterpSoaTranslation) * max_soa_tracks +
+      sizeof(InterpSoaRotation) * max_soa_tracks +
+      sizeof(InterpSoaScale) * max_soa_tracks +
+      sizeof(int) * max_tracks * 2 * 3;  // 2 keys * (trans + rot + scale).
+  const size_t spline_size = sizeof(InterpSoaFloat3Tangent) * max_soa_tracks +
+                             sizeof(InterpSoaQuaternionTangent) *
+                                 max_soa_tracks +
+                             sizeof(InterpSoaFloat3Tangent) * max_soa_tracks;
+  const size_t compact_size =
+      sizeof(PackedSoaFloat3) * max_soa_tracks +
+      sizeof(PackedSoaRotation) * max_soa_tracks +
+      sizeof(PackedSoaFloat3) * max_soa_tracks +
+      sizeof(uint16_t) * max_tracks * 2 * 3;  // 2 keys * (trans + rot + scale).
+  return (compact ? compact_size : full_size) + (spline ? spline_size : 0) +
+         sizeof(uint8_t) * 4 * num_outdated;
+}
+
+void SamplingCache::Resize(int _max_tracks, Mode _mode) {
+  memory::ScopedAllocationTag tag(memory::kTagSamplingCache);
+
+  using internal::InterpSoaFloat3Tangent;
+  using internal::InterpSoaQuaternionTangent;
+  using internal::InterpSoaRotation;
+  using internal::InterpSoaScale;
+  using internal::InterpSoaTranslation;
+  using internal::PackedSoaFloat3;
+  using internal::PackedSoaRotation;
+
+  // Reset existing data.
+  Invalidate();
+  allocator_->Deallocate(allocation_);
+
+  // Updates maximum supported soa tracks and mode.
+  max_soa_tracks_ = (_max_tracks + 3) / 4;
+  mode_ = _mode;
+  const bool compact = mode_ == kCompact;
+  const bool spline = mode_ == kSpline;
+  const size_t max_tracks = max_soa_tracks_ * 4;
+  const size_t num_outdated = (max_soa_tracks_ + 7) / 8;
+
+  // Allocate all cache data at once in a single allocation.
+  // Alignment is guaranteed because memory is dispatch from the highest
+  // alignment requirement (Soa data: SimdFloat4) to the lowest (outdated
+  // flag: unsigned char).
+
+  // Computes allocation size. Only the hot data and key indices of the
+  // selected mode are allocated.
+  const size_t size = AllocationSize(_max_tracks, _mode);
 
   // Allocates all at once.
-  memory::Allocator* allocator = memory::default_allocator();
   char* alloc_begin = reinterpret_cast<char*>(
-      allocator->Allocate(size, OZZ_ALIGN_OF(InterpSoaTranslation)));
+      allocator_->Allocate(size, kAllocationAlignment));
   char* alloc_cursor = alloc_begin;
+  allocation_ = alloc_begin;
 
   // Distributes buffer memory while ensuring proper alignment (serves larger
   // alignment values first).
+  OZZ_STATIC_ASSERT(
+      OZZ_ALIGN_OF(InterpSoaTranslation) <= kAllocationAlignment &&
+      OZZ_ALIGN_OF(PackedSoaFloat3) <= kAllocationAlignment);
   OZZ_STATIC_ASSERT(
       OZZ_ALIGN_OF(InterpSoaTranslation) >= OZZ_ALIGN_OF(InterpSoaRotation) &&
       OZZ_ALIGN_OF(InterpSoaRotation) >= OZZ_ALIGN_OF(InterpSoaScale) &&
-      OZZ_ALIGN_OF(InterpSoaScale) >= OZZ_ALIGN_OF(int) &&
+      OZZ_ALIGN_OF(InterpSoaScale) >= OZZ_ALIGN_OF(InterpSoaFloat3Tangent) &&
+      OZZ_ALIGN_OF(InterpSoaFloat3Tangent) >=
+          OZZ_ALIGN_OF(InterpSoaQuaternionTangent) &&
+      OZZ_ALIGN_OF(InterpSoaQuaternionTangent) >= OZZ_ALIGN_OF(int) &&
       OZZ_ALIGN_OF(int) >= OZZ_ALIGN_OF(uint8_t));
+  OZZ_STATIC_ASSERT(
+      OZZ_ALIGN_OF(PackedSoaFloat3) >= OZZ_ALIGN_OF(PackedSoaRotation) &&
+      OZZ_ALIGN_OF(PackedSoaRotation) >= OZZ_ALIGN_OF(uint16_t) &&
+      OZZ_ALIGN_OF(uint16_t) >= OZZ_ALIGN_OF(uint8_t));
+
+  soa_translations_ = NULL;
+  soa_rotations_ = NULL;
+  soa_scales_ = NULL;
+  soa_translation_tangents_ = NULL;
+  soa_rotation_tangents_ = NULL;
+  soa_scale_tangents_ = NULL;
+  translation_keys_ = NULL;
+  rotation_keys_ = NULL;
+  scale_keys_ = NULL;
+  packed_translations_ = NULL;
+  packed_rotations_ = NULL;
+  packed_scales_ = NULL;
+  packed_translation_keys_ = NULL;
+  packed_rotation_keys_ = NULL;
+  packed_scale_keys_ = NULL;
+
+  if (compact) {
+    packed_translations_ = reinterpret_cast<PackedSoaFloat3*>(alloc_cursor);
+    assert(
+        math::IsAligned(packed_translations_, OZZ_ALIGN_OF(PackedSoaFloat3)));
+    alloc_cursor += sizeof(PackedSoaFloat3) * max_soa_tracks_;
+    packed_rotations_ = reinterpret_cast<PackedSoaRotation*>(alloc_cursor);
+    assert(
+        math::IsAligned(packed_rotations_, OZZ_ALIGN_OF(PackedSoaRotation)));
+    alloc_cursor += sizeof(PackedSoaRotation) * max_soa_tracks_;
+    packed_scales_ = reinterpret_cast<PackedSoaFloat3*>(alloc_cursor);
+    assert(math::IsAligned(packed_scales_, OZZ_ALIGN_OF(PackedSoaFloat3)));
+    alloc_cursor += sizeof(PackedSoaFloat3) * max_soa_tracks_;
+
+    packed_translation_keys_ = reinterpret_cast<uint16_t*>(alloc_cursor);
+    assert(math::IsAligned(packed_translation_keys_, OZZ_ALIGN_OF(uint16_t)));
+    alloc_cursor += sizeof(uint16_t) * max_tracks * 2;
+    packed_rotation_keys_ = reinterpret_cast<uint16_t*>(alloc_cursor);
+    alloc_cursor += sizeof(uint16_t) * max_tracks * 2;
+    packed_scale_keys_ = reinterpret_cast<uint16_t*>(alloc_cursor);
+    alloc_cursor += sizeof(uint16_t) * max_tracks * 2;
+  } else {
+    soa_translations_ = reinterpret_cast<InterpSoaTranslation*>(alloc_cursor);
+    assert(math::IsAligned(soa_translations_,
+                           OZZ_ALIGN_OF(InterpSoaTranslation)));
+    alloc_cursor += sizeof(InterpSoaTranslation) * max_soa_tracks_;
+    soa_rotations_ = reinterpret_cast<InterpSoaRotation*>(alloc_cursor);
+    assert(math::IsAligned(soa_rotations_, OZZ_ALIGN_OF(InterpSoaRotation)));
+    alloc_cursor += sizeof(InterpSoaRotation) * max_soa_tracks_;
+    soa_scales_ = reinterpret_cast<InterpSoaScale*>(alloc_cursor);
+    assert(math::IsAligned(soa_scales_, OZZ_ALIGN_OF(InterpSoaScale)));
+    alloc_cursor += sizeof(InterpSoaScale) * max_soa_tracks_;
+
+    if (spline) {
+      soa_translation_tangents_ =
+          reinterpret_cast<InterpSoaFloat3Tangent*>(alloc_cursor);
+      assert(math::IsAligned(soa_translation_tangents_,
+                             OZZ_ALIGN_OF(InterpSoaFloat3Tangent)));
+      alloc_cursor += sizeof(InterpSoaFloat3Tangent) * max_soa_tracks_;
+      soa_rotation_tangents_ =
+          reinterpret_cast<InterpSoaQuaternionTangent*>(alloc_cursor);
+      assert(math::IsAligned(soa_rotation_tangents_,
+                             OZZ_ALIGN_OF(InterpSoaQuaternionTangent)));
+      alloc_cursor += sizeof(InterpSoaQuaternionTangent) * max_soa_tracks_;
+      soa_scale_tangents_ =
+          reinterpret_cast<InterpSoaFloat3Tangent*>(alloc_cursor);
+      assert(math::IsAligned(soa_scale_tangents_,
+                             OZZ_ALIGN_OF(InterpSoaFloat3Tangent)));
+      alloc_cursor += sizeof(InterpSoaFloat3Tangent) * max_soa_tracks_;
+    }
 
-  soa_translations_ = reinterpret_cast<InterpSoaTranslation*>(alloc_cursor);
-  assert(
-      math::IsAligned(soa_translations_, OZZ_ALIGN_OF(InterpSoaTranslation)));
-  alloc_cursor += sizeof(InterpSoaTranslation) * max_soa_tracks_;
-  soa_rotations_ = reinterpret_cast<InterpSoaRotation*>(alloc_cursor);
-  assert(math::IsAligned(soa_rotations_, OZZ_ALIGN_OF(InterpSoaRotation)));
-  alloc_cursor += sizeof(InterpSoaRotation) * max_soa_tracks_;
-  soa_scales_ = reinterpret_cast<InterpSoaScale*>(alloc_cursor);
-  assert(math::IsAligned(soa_scales_, OZZ_ALIGN_OF(InterpSoaScale)));
-  alloc_cursor += sizeof(InterpSoaScale) * max_soa_tracks_;
-
-  translation_keys_ = reinterpret_cast<int*>(alloc_cursor);
-  assert(math::IsAligned(translation_keys_, OZZ_ALIGN_OF(int)));
-  alloc_cursor += sizeof(int) * max_tracks * 2;
-  rotation_keys_ = reinterpret_cast<int*>(alloc_cursor);
-  alloc_cursor += sizeof(int) * max_tracks * 2;
-  scale_keys_ = reinterpret_cast<int*>(alloc_cursor);
-  alloc_cursor += sizeof(int) * max_tracks * 2;
+    translation_keys_ = reinterpret_cast<int*>(alloc_cursor);
+    assert(math::IsAligned(translation_keys_, OZZ_ALIGN_OF(int)));
+    alloc_cursor += sizeof(int) * max_tracks * 2;
+    rotation_keys_ = reinterpret_cast<int*>(alloc_cursor);
+    alloc_cursor += sizeof(int) * max_tracks * 2;
+    scale_keys_ = reinterpret_cast<int*>(alloc_cursor);
+    alloc_cursor += sizeof(int) * max_tracks * 2;
+  }
 
   outdated_translations_ = reinterpret_cast<uint8_t*>(alloc_cursor);
   assert(math::IsAligned(outdated_translations_, OZZ_ALIGN_OF(uint8_t)));
@@ -525,23 +2553,253 @@ void SamplingCache::Resize(int _max_tracks) {
   alloc_cursor += sizeof(uint8_t) * num_outdated;
   outdated_scales_ = reinterpret_cast<uint8_t*>(alloc_cursor);
   alloc_cursor += sizeof(uint8_t) * num_outdated;
+  steady_ = reinterpret_cast<uint8_t*>(alloc_cursor);
+  alloc_cursor += sizeof(uint8_t) * num_outdated;
+  std::memset(steady_, 0, num_outdated);
 
   assert(alloc_cursor == alloc_begin + size);
 }
 
-void SamplingCache::Step(const Animation& _animation, float _ratio) {
-  // The cache is invalidated if animation has changed or if it is being rewind.
-  if (animation_ != &_animation || _ratio < ratio_) {
+namespace {
+// Assumed cache line size, used as prefetching stride.
+const size_t kPrefetchLineSize = 64;
+
+// Prefetches all cache lines of _size bytes buffer _begin.
+void PrefetchBuffer(const void* _begin, size_t _size) {
+  const char* begin = static_cast<const char*>(_begin);
+  for (size_t offset = 0; offset < _size; offset += kPrefetchLineSize) {
+    OZZ_PREFETCH(begin + offset);
+  }
+}
+
+// Prefetches the first cache lines of _keys following _cursor, which are the
+// next ones updating the cache will read.
+template <typename _Key>
+void PrefetchKeys(const Range<const _Key>& _keys, int _cursor) {
+  const size_t kLines = 2;
+  if (_keys.begin + _cursor < _keys.end) {
+    PrefetchBuffer(_keys.begin + _cursor, kLines * kPrefetchLineSize);
+  }
+}
+}  // namespace
+
+void SamplingCache::Prefetch(const Animation& _animation,
+                             const math::SoaTransform* _output) const {
+  const int num_soa_tracks = _animation.num_soa_tracks();
+  assert(max_soa_tracks() >= num_soa_tracks);
+  const size_t n = static_cast<size_t>(num_soa_tracks);
+
+  // Output is only written.
+  const char* output = reinterpret_cast<const char*>(_output);
+  for (size_t offset = 0; offset < sizeof(*_output) * n;
+       offset += kPrefetchLineSize) {
+    OZZ_PREFETCH_WRITE(output + offset);
+  }
+
+  // Outdated and steady flags are contiguous, and small enough to be fetched
+  // at once.
+  PrefetchBuffer(outdated_translations_,
+                 static_cast<size_t>(steady_ - outdated_translations_) +
+                     (n + 7) / 8);
+
+  if (mode_ == kCompact) {
+    PrefetchBuffer(packed_translation_keys_, sizeof(uint16_t) * n * 4 * 2);
+    PrefetchBuffer(packed_rotation_keys_, sizeof(uint16_t) * n * 4 * 2);
+    PrefetchBuffer(packed_scale_keys_, sizeof(uint16_t) * n * 4 * 2);
+    PrefetchBuffer(packed_translations_, sizeof(*packed_translations_) * n);
+    PrefetchBuffer(packed_rotations_, sizeof(*packed_rotations_) * n);
+    PrefetchBuffer(packed_scales_, sizeof(*packed_scales_) * n);
+  } else {
+    PrefetchBuffer(translation_keys_, sizeof(int) * n * 4 * 2);
+    PrefetchBuffer(rotation_keys_, sizeof(int) * n * 4 * 2);
+    PrefetchBuffer(scale_keys_, sizeof(int) * n * 4 * 2);
+    PrefetchBuffer(soa_translations_, sizeof(*soa_translations_) * n);
+    PrefetchBuffer(soa_rotations_, sizeof(*soa_rotations_) * n);
+    PrefetchBuffer(soa_scales_, sizeof(*soa_scales_) * n);
+    if (_animation.spline()) {
+      PrefetchBuffer(soa_translation_tangents_,
+                     sizeof(*soa_translation_tangents_) * n);
+      PrefetchBuffer(soa_rotation_tangents_,
+                     sizeof(*soa_rotation_tangents_) * n);
+      PrefetchBuffer(soa_scale_tangents_, sizeof(*soa_scale_tangents_) * n);
+    }
+  }
+
+  // Animation keys are read from cache cursors, or from the beginning of the
+  // animation if the cache is going to be invalidated.
+  const bool same =
+      animation_ == &_animation && animation_uid_ == _animation.uid();
+  PrefetchKeys(_animation.translations(), same ? translation_cursor_ : 0);
+  PrefetchKeys(_animation.rotations(), same ? rotation_cursor_ : 0);
+  PrefetchKeys(_animation.scales(), same ? scale_cursor_ : 0);
+}
+
+void SamplingCache::Step(const Animation& _animation, float _ratio,
+                         SamplingCounters* _counters, bool _loop) {
+  // The cache is invalidated if animation has changed or if it is being rewind,
+  // unless it loops.
+  // Animation uid detects a different animation allocated at the same address.
+  const bool same = animation_ == &_animation &&
+                    animation_uid_ == _animation.uid();
+  const bool invalidate = !same || (_ratio < ratio_ && !_loop);
+  if (!invalidate && _ratio < ratio_) {
+    // Wraps back to the beginning of the animation. Keys are re-seeded, but
+    // entries whose keys didn't change remain valid.
+    if (_counters) {
+      ++_counters->wraps;
+    }
+    const int num_soa_tracks = _animation.num_soa_tracks();
+    if (mode_ == kCompact) {
+      RewindKeys(num_soa_tracks, _animation.num_constant_translations(),
+                 _animation.translations(), &translation_cursor_,
+                 packed_translation_keys_, outdated_translations_);
+      RewindKeys(num_soa_tracks, _animation.num_constant_rotations(),
+                 _animation.rotations(), &rotation_cursor_,
+                 packed_rotation_keys_, outdated_rotations_);
+      RewindKeys(num_soa_tracks, _animation.num_constant_scales(),
+                 _animation.scales(), &scale_cursor_, packed_scale_keys_,
+                 outdated_scales_);
+    } else {
+      RewindKeys(num_soa_tracks, _animation.num_constant_translations(),
+                 _animation.translations(), &translation_cursor_,
+                 translation_keys_, outdated_translations_);
+      RewindKeys(num_soa_tracks, _animation.num_constant_rotations(),
+                 _animation.rotations(), &rotation_cursor_, rotation_keys_,
+                 outdated_rotations_);
+      RewindKeys(num_soa_tracks, _animation.num_constant_scales(),
+                 _animation.scales(), &scale_cursor_, scale_keys_,
+                 outdated_scales_);
+    }
+    // Cache is now at the beginning of the animation, so seek points are
+    // only used below for long forward jumps.
+    ratio_ = 0.f;
+  }
+  if (invalidate) {
+    if (_counters) {
+      ++_counters->invalidations;
+    }
     animation_ = &_animation;
+    animation_uid_ = _animation.uid();
     translation_cursor_ = 0;
     rotation_cursor_ = 0;
     scale_cursor_ = 0;
   }
+
+  // Looks for the last seek point before _ratio, if animation has any.
+  const Range<const float> seek_ratios = _animation.seek_ratios();
+  const float* seek =
+      std::upper_bound(seek_ratios.begin, seek_ratios.end, _ratio);
+  if (seek != seek_ratios.begin) {
+    --seek;
+    // Cache is re-seeded if it was invalidated, or if it is at least a seek
+    // point behind the one found. The later allows to skip long forward
+    // jumps, while small steps still benefits from incremental updates.
+    if (invalidate || (seek > seek_ratios.begin && seek[-1] >= ratio_)) {
+      if (_counters) {
+        ++_counters->seeks;
+      }
+      const int num_soa_tracks = _animation.num_soa_tracks();
+      const int num_keys = num_soa_tracks * 4 * 2;
+      const int stride = _animation.seek_point_stride();
+      const int* keys = _animation.seek_keys().begin +
+                        (seek - seek_ratios.begin) * stride;
+      translation_cursor_ = keys[0];
+      rotation_cursor_ = keys[1];
+      scale_cursor_ = keys[2];
+      keys += 3;
+      if (mode_ == kCompact) {
+        CopySeekKeys(keys, num_keys, packed_translation_keys_);
+        CopySeekKeys(keys + num_keys, num_keys, packed_rotation_keys_);
+        CopySeekKeys(keys + num_keys * 2, num_keys, packed_scale_keys_);
+      } else {
+        CopySeekKeys(keys, num_keys, translation_keys_);
+        CopySeekKeys(keys + num_keys, num_keys, rotation_keys_);
+        CopySeekKeys(keys + num_keys * 2, num_keys, scale_keys_);
+      }
+
+      // All entries must be decompressed again.
+      OutdateAll(num_soa_tracks, outdated_translations_);
+      OutdateAll(num_soa_tracks, outdated_rotations_);
+      OutdateAll(num_soa_tracks, outdated_scales_);
+    }
+  }
+
   ratio_ = _ratio;
 }
 
+bool SamplingCache::CopyFrom(const SamplingCache& _other) {
+  if (&_other == this) {
+    return true;
+  }
+  if (!_other.animation_) {
+    Invalidate();
+    return true;
+  }
+  const int num_soa_tracks = _other.animation_->num_soa_tracks();
+  if (_other.mode_ != mode_ || num_soa_tracks > max_soa_tracks_) {
+    return false;
+  }
+
+  animation_ = _other.animation_;
+  animation_uid_ = _other.animation_uid_;
+  ratio_ = _other.ratio_;
+  translation_cursor_ = _other.translation_cursor_;
+  rotation_cursor_ = _other.rotation_cursor_;
+  scale_cursor_ = _other.scale_cursor_;
+
+  // Only copies entries used by the animation, as caches can have different
+  // sizes.
+  const size_t num_keys = num_soa_tracks * 4 * 2;
+  if (mode_ == kCompact) {
+    std::memcpy(packed_translations_, _other.packed_translations_,
+                sizeof(*packed_translations_) * num_soa_tracks);
+    std::memcpy(packed_rotations_, _other.packed_rotations_,
+                sizeof(*packed_rotations_) * num_soa_tracks);
+    std::memcpy(packed_scales_, _other.packed_scales_,
+                sizeof(*packed_scales_) * num_soa_tracks);
+    std::memcpy(packed_translation_keys_, _other.packed_translation_keys_,
+                sizeof(uint16_t) * num_keys);
+    std::memcpy(packed_rotation_keys_, _other.packed_rotation_keys_,
+                sizeof(uint16_t) * num_keys);
+    std::memcpy(packed_scale_keys_, _other.packed_scale_keys_,
+                sizeof(uint16_t) * num_keys);
+  } else {
+    std::memcpy(soa_translations_, _other.soa_translations_,
+                sizeof(*soa_translations_) * num_soa_tracks);
+    std::memcpy(soa_rotations_, _other.soa_rotations_,
+                sizeof(*soa_rotations_) * num_soa_tracks);
+    std::memcpy(soa_scales_, _other.soa_scales_,
+                sizeof(*soa_scales_) * num_soa_tracks);
+    if (mode_ == kSpline) {
+      std::memcpy(soa_translation_tangents_, _other.soa_translation_tangents_,
+                  sizeof(*soa_translation_tangents_) * num_soa_tracks);
+      std::memcpy(soa_rotation_tangents_, _other.soa_rotation_tangents_,
+                  sizeof(*soa_rotation_tangents_) * num_soa_tracks);
+      std::memcpy(soa_scale_tangents_, _other.soa_scale_tangents_,
+                  sizeof(*soa_scale_tangents_) * num_soa_tracks);
+    }
+    std::memcpy(translation_keys_, _other.translation_keys_,
+                sizeof(int) * num_keys);
+    std::memcpy(rotation_keys_, _other.rotation_keys_, sizeof(int) * num_keys);
+    std::memcpy(scale_keys_, _other.scale_keys_, sizeof(int) * num_keys);
+  }
+
+  const size_t num_flags = (num_soa_tracks + 7) / 8;
+  std::memcpy(outdated_translations_, _other.outdated_translations_,
+              num_flags);
+  std::memcpy(outdated_rotations_, _other.outdated_rotations_, num_flags);
+  std::memcpy(outdated_scales_, _other.outdated_scales_, num_flags);
+
+  // Steady flags refer to the previous output of _other cache, they can't be
+  // used for *this cache output.
+  std::memset(steady_, 0, num_flags);
+
+  return true;
+}
+
 void SamplingCache::Invalidate() {
   animation_ = NULL;
+  animation_uid_ = 0;
   ratio_ = 0.f;
   translation_cursor_ = 0;
   rotation_cursor_ = 0;
@@ -0,0 +1,85 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#include "ozz/animation/runtime/segmented_sampling_job.h"
+
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/sampling_job.h"
+#include "ozz/base/maths/math_ex.h"
+
+namespace ozz {
+namespace animation {
+
+SegmentedSamplingJob::SegmentedSamplingJob()
+    : ratio(0.f), duration(0.f), segment_duration(0.f), cache(NULL) {}
+
+int SegmentedSamplingJob::segment() const {
+  const ptrdiff_t num_segments = segments.end - segments.begin;
+  if (!(duration > 0.f) || !(segment_duration > 0.f) || num_segments <= 0) {
+    return -1;
+  }
+  const float time = math::Clamp(0.f, ratio, 1.f) * duration;
+  const int index = static_cast<int>(time / segment_duration);
+  return math::Min(index, static_cast<int>(num_segments) - 1);
+}
+
+namespace {
+// Setups _job to sample the segment required by _segmented job. Returns false
+// if segment index is invalid or the segment isn't resident.
+bool SetupSegment(const SegmentedSamplingJob& _segmented, SamplingJob* _job) {
+  const int index = _segmented.segment();
+  if (index < 0 || !_segmented.segments.begin[index]) {
+    return false;
+  }
+  const Animation* animation = _segmented.segments.begin[index];
+  const float time = math::Clamp(0.f, _segmented.ratio, 1.f) *
+                         _segmented.duration -
+                     index * _segmented.segment_duration;
+  _job->ratio = time / animation->duration();
+  _job->animation = animation;
+  _job->cache = _segmented.cache;
+  _job->output = _segmented.output;
+  return true;
+}
+}  // namespace
+
+bool SegmentedSamplingJob::Validate() const {
+  SamplingJob job;
+  return SetupSegment(*this, &job) && job.Validate();
+}
+
+bool SegmentedSamplingJob::Run() const {
+  SamplingJob job;
+  if (!SetupSegment(*this, &job)) {
+    return false;
+  }
+  // SamplingJob validates (and clamps ratio) on its side.
+  return job.Run();
+}
+}  // namespace animation
+}  // namespace ozz
@@ -0,0 +1,186 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/shared_pose_cache.h"
+
+#include <cassert>
+#include <cmath>
+
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/allocator.h"
+
+namespace ozz {
+namespace animation {
+
+SharedPoseCache::SharedPoseCache()
+    : ratio_steps_(0),
+      max_poses_(0),
+      max_soa_tracks_(0),
+      use_counter_(0),
+      poses_(NULL),
+      entries_(NULL) {}
+
+SharedPoseCache::SharedPoseCache(int _max_tracks, int _max_poses)
+    : ratio_steps_(0),
+      max_poses_(0),
+      max_soa_tracks_(0),
+      use_counter_(0),
+      poses_(NULL),
+      entries_(NULL) {
+  Resize(_max_tracks, _max_poses);
+}
+
+SharedPoseCache::~SharedPoseCache() {
+  // Deallocates everything at once.
+  memory::default_allocator()->Deallocate(poses_);
+}
+
+void SharedPoseCache::Resize(int _max_tracks, int _max_poses) {
+  memory::Allocator* allocator = memory::default_allocator();
+  allocator->Deallocate(poses_);
+
+  max_soa_tracks_ = (_max_tracks + 3) / 4;
+  max_poses_ = _max_poses > 0 ? _max_poses : 0;
+  // Spline mode allows to sample any animation.
+  sampling_cache_.Resize(max_soa_tracks_ * 4, SamplingCache::kSpline);
+
+  // Allocates poses and entries at once. Poses alignment is the highest.
+  OZZ_STATIC_ASSERT(OZZ_ALIGN_OF(math::SoaTransform) >= OZZ_ALIGN_OF(Entry));
+  const size_t poses_size =
+      sizeof(math::SoaTransform) * max_soa_tracks_ * max_poses_;
+  const size_t size = poses_size + sizeof(Entry) * max_poses_;
+  char* alloc_begin = reinterpret_cast<char*>(
+      allocator->Allocate(size, OZZ_ALIGN_OF(math::SoaTransform)));
+  poses_ = reinterpret_cast<math::SoaTransform*>(alloc_begin);
+  entries_ = reinterpret_cast<Entry*>(alloc_begin + poses_size);
+  assert(math::IsAligned(entries_, OZZ_ALIGN_OF(Entry)));
+
+  Invalidate();
+}
+
+void SharedPoseCache::Invalidate() {
+  sampling_cache_.Invalidate();
+  use_counter_ = 0;
+  for (int i = 0; i < max_poses_; ++i) {
+    Entry& entry = entries_[i];
+    entry.animation = NULL;
+    entry.uid = 0;
+    entry.ratio = 0.f;
+    entry.references = 0;
+    entry.last_use = 0;
+  }
+}
+
+void SharedPoseCache::set_ratio_steps(int _ratio_steps) {
+  ratio_steps_ = _ratio_steps > 0 ? _ratio_steps : 0;
+  Invalidate();
+}
+
+Range<const math::SoaTransform> SharedPoseCache::Acquire(
+    const Animation& _animation, float _ratio) {
+  const int num_soa_tracks = _animation.num_soa_tracks();
+  if (num_soa_tracks > max_soa_tracks_) {
+    return Range<const math::SoaTransform>();
+  }
+
+  // Computes the key ratio.
+  float ratio = math::Clamp(0.f, _ratio, 1.f);
+  if (ratio_steps_ > 0) {
+    const float steps = static_cast<float>(ratio_steps_);
+    ratio = std::floor(ratio * steps + .5f) / steps;
+  }
+
+  // Searches for an existing pose, and for the best slot to recycle
+  // otherwise: an empty one, or the least recently used one.
+  Entry* found = NULL;
+  Entry* recycle = NULL;
+  for (int i = 0; i < max_poses_; ++i) {
+    Entry& entry = entries_[i];
+    if (entry.animation == &_animation && entry.uid == _animation.uid() &&
+        entry.ratio == ratio) {
+      found = &entry;
+      break;
+    }
+    if (entry.references == 0 &&
+        (!recycle || !entry.animation ||
+         (recycle->animation && entry.last_use < recycle->last_use))) {
+      recycle = &entry;
+    }
+  }
+
+  math::SoaTransform* pose = NULL;
+  if (found) {
+    pose = poses_ + (found - entries_) * max_soa_tracks_;
+  } else if (recycle) {
+    // Samples the new pose.
+    pose = poses_ + (recycle - entries_) * max_soa_tracks_;
+    SamplingJob job;
+    job.animation = &_animation;
+    job.cache = &sampling_cache_;
+    job.ratio = ratio;
+    job.output.begin = pose;
+    job.output.end = pose + num_soa_tracks;
+    if (!job.Run()) {
+      return Range<const math::SoaTransform>();
+    }
+    recycle->animation = &_animation;
+    recycle->uid = _animation.uid();
+    recycle->ratio = ratio;
+    found = recycle;
+  } else {
+    return Range<const math::SoaTransform>();  // All poses are referenced.
+  }
+
+  ++found->references;
+  found->last_use = ++use_counter_;
+  return Range<const math::SoaTransform>(pose,
+                                         static_cast<size_t>(num_soa_tracks));
+}
+
+void SharedPoseCache::Release(const Range<const math::SoaTransform>& _pose) {
+  if (!_pose.begin || !max_soa_tracks_) {
+    return;
+  }
+  const ptrdiff_t index = (_pose.begin - poses_) / max_soa_tracks_;
+  assert(index >= 0 && index < max_poses_ &&
+         poses_ + index * max_soa_tracks_ == _pose.begin && "Invalid pose.");
+  Entry& entry = entries_[index];
+  assert(entry.references > 0 && "Pose isn't acquired.");
+  --entry.references;
+}
+
+int SharedPoseCache::num_acquired_poses() const {
+  int count = 0;
+  for (int i = 0; i < max_poses_; ++i) {
+    count += entries_[i].references > 0;
+  }
+  return count;
+}
+}  // namespace animation
+}  // namespace ozz
@@ -27,7 +27,9 @@
 
 #include "ozz/animation/runtime/skeleton.h"
 
+#include <algorithm>
 #include <cstring>
+#include <utility>
 
 #include "ozz/base/io/archive.h"
 #include "ozz/base/log.h"
@@ -39,36 +41,119 @@
 namespace ozz {
 namespace animation {
 
-Skeleton::Skeleton() {}
+Skeleton::Skeleton()
+    : allocator_(memory::default_allocator()),
+      num_levels_(0),
+      load_names_(true),
+      capacity_(0),
+      mapped_(false) {
+  ComputeLODEnds();
+}
+
+Skeleton::Skeleton(memory::Allocator* _allocator)
+    : allocator_(_allocator),
+      num_levels_(0),
+      load_names_(true),
+      capacity_(0),
+      mapped_(false) {
+  assert(_allocator && "Invalid allocator");
+  ComputeLODEnds();
+}
 
 Skeleton::~Skeleton() { Deallocate(); }
 
+#if __cplusplus >= 201103L
+Skeleton::Skeleton(Skeleton&& _other) : Skeleton(_other.allocator_) {
+  Swap(_other);
+}
+
+Skeleton& Skeleton::operator=(Skeleton&& _other) {
+  // Previous content is released by temporary destruction.
+  Skeleton tmp(std::move(_other));
+  Swap(tmp);
+  return *this;
+}
+#endif  // __cplusplus
+
+void Skeleton::Swap(Skeleton& _other) {
+  std::swap(allocator_, _other.allocator_);
+  std::swap(joint_bind_poses_, _other.joint_bind_poses_);
+  std::swap(joint_parents_, _other.joint_parents_);
+  std::swap(joint_subtree_ends_, _other.joint_subtree_ends_);
+  std::swap(joint_depths_, _other.joint_depths_);
+  std::swap(joint_child_counts_, _other.joint_child_counts_);
+  std::swap(level_joints_, _other.level_joints_);
+  std::swap(level_ends_, _other.level_ends_);
+  std::swap(num_levels_, _other.num_levels_);
+  std::swap(joint_names_, _other.joint_names_);
+  std::swap(joint_name_hashes_, _other.joint_name_hashes_);
+  std::swap(joint_name_table_, _other.joint_name_table_);
+  std::swap(joint_lods_, _other.joint_lods_);
+  std::swap(num_lods_, _other.num_lods_);
+  std::swap_ranges(lod_ends_, lod_ends_ + kMaxLODs, _other.lod_ends_);
+  std::swap(load_names_, _other.load_names_);
+  std::swap(capacity_, _other.capacity_);
+  std::swap(mapped_, _other.mapped_);
+}
+
+namespace {
+// Computes the size of the joint name hash table, a power of 2 at least twice
+// as big as the number of joints, to keep probing sequences short.
+size_t JointNameTableSize(size_t _num_joints) {
+  size_t size = 1;
+  while (size < _num_joints * 2) {
+    size <<= 1;
+  }
+  return size;
+}
+}  // namespace
+
 char* Skeleton::Allocate(size_t _chars_size, size_t _num_joints) {
+  memory::ScopedAllocationTag tag(memory::kTagSkeleton);
+
   // Distributes buffer memory while ensuring proper alignment (serves larger
   // alignment values first).
   OZZ_STATIC_ASSERT(OZZ_ALIGN_OF(math::SoaTransform) >= OZZ_ALIGN_OF(char*) &&
-                    OZZ_ALIGN_OF(char*) >= OZZ_ALIGN_OF(int16_t) &&
+                    OZZ_ALIGN_OF(char*) >= OZZ_ALIGN_OF(uint32_t) &&
+                    OZZ_ALIGN_OF(uint32_t) >= OZZ_ALIGN_OF(int16_t) &&
                     OZZ_ALIGN_OF(int16_t) >= OZZ_ALIGN_OF(char));
 
-  assert(joint_bind_poses_.size() == 0 && joint_names_.size() == 0 &&
-         joint_parents_.size() == 0);
-
   // Early out if no joint.
   if (_num_joints == 0) {
+    Deallocate();
     return NULL;
   }
 
   // Bind poses have SoA format
   const size_t joint_bind_poses_size =
       (_num_joints + 3) / 4 * sizeof(math::SoaTransform);
-  const size_t names_size = _num_joints * sizeof(char*);
+  const size_t names_size = _chars_size ? _num_joints * sizeof(char*) : 0;
+  const size_t joint_name_hashes_size = _num_joints * sizeof(uint32_t);
   const size_t joint_parents_size = _num_joints * sizeof(int16_t);
-  const size_t buffer_size =
-      names_size + _chars_size + joint_parents_size + joint_bind_poses_size;
+  const size_t joint_subtree_ends_size = _num_joints * sizeof(int16_t);
+  const size_t levels_size = _num_joints * sizeof(int16_t) * 4;
+  const size_t joint_name_table_size =
+      JointNameTableSize(_num_joints) * sizeof(int16_t);
+  const size_t joint_lods_size = _num_joints * sizeof(uint8_t);
+  const size_t buffer_size = names_size + _chars_size +
+                             joint_name_hashes_size + joint_parents_size +
+                             joint_subtree_ends_size + levels_size +
+                             joint_name_table_size + joint_lods_size +
+                             joint_bind_poses_size;
 
-  // Allocates whole buffer.
-  char* buffer = reinterpret_cast<char*>(memory::default_allocator()->Allocate(
-      buffer_size, OZZ_ALIGN_OF(math::SoaTransform)));
+  // Reuses the owned buffer if it's big enough, otherwise previous content is
+  // released and the whole buffer is allocated.
+  char* buffer;
+  if (capacity_ > 0 && capacity_ >= buffer_size) {
+    assert(!mapped_);
+    buffer = reinterpret_cast<char*>(joint_bind_poses_.begin);
+    joint_names_.Clear();
+  } else {
+    Deallocate();
+    buffer = reinterpret_cast<char*>(allocator_->Allocate(
+        buffer_size, OZZ_ALIGN_OF(math::SoaTransform)));
+    capacity_ = buffer_size;
+  }
 
   // Serves larger alignment values first.
   // Bind pose first, biggest alignment.
@@ -78,27 +163,402 @@ char* Skeleton::Allocate(size_t _chars_size, size_t _num_joints) {
   buffer += joint_bind_poses_size;
   joint_bind_poses_.end = reinterpret_cast<math::SoaTransform*>(buffer);
 
-  // Then names array, second biggest alignment.
-  joint_names_.begin = reinterpret_cast<char**>(buffer);
-  assert(math::IsAligned(joint_names_.begin, OZZ_ALIGN_OF(char**)));
-  buffer += names_size;
-  joint_names_.end = reinterpret_cast<char**>(buffer);
+  // Then names array, second biggest alignment. It's left empty if there's no
+  // name.
+  if (names_size) {
+    joint_names_.begin = reinterpret_cast<char**>(buffer);
+    assert(math::IsAligned(joint_names_.begin, OZZ_ALIGN_OF(char**)));
+    buffer += names_size;
+    joint_names_.end = reinterpret_cast<char**>(buffer);
+  }
+
+  // Name hashes, third biggest alignment.
+  joint_name_hashes_.begin = reinterpret_cast<uint32_t*>(buffer);
+  assert(math::IsAligned(joint_name_hashes_.begin, OZZ_ALIGN_OF(uint32_t)));
+  buffer += joint_name_hashes_size;
+  joint_name_hashes_.end = reinterpret_cast<uint32_t*>(buffer);
 
-  // Parents, third biggest alignment.
+  // Parents, fourth biggest alignment.
   joint_parents_.begin = reinterpret_cast<int16_t*>(buffer);
   assert(math::IsAligned(joint_parents_.begin, OZZ_ALIGN_OF(int16_t)));
   buffer += joint_parents_size;
   joint_parents_.end = reinterpret_cast<int16_t*>(buffer);
 
+  // Subtree ends, same alignment as parents.
+  joint_subtree_ends_.begin = reinterpret_cast<int16_t*>(buffer);
+  buffer += joint_subtree_ends_size;
+  joint_subtree_ends_.end = reinterpret_cast<int16_t*>(buffer);
+
+  // Depths, child counts and levels, same alignment as parents.
+  buffer = AllocateLevels(buffer, _num_joints);
+
+  // Name hash table, same alignment as parents.
+  joint_name_table_.begin = reinterpret_cast<int16_t*>(buffer);
+  buffer += joint_name_table_size;
+  joint_name_table_.end = reinterpret_cast<int16_t*>(buffer);
+
+  // Levels of detail, smallest alignment.
+  joint_lods_.begin = reinterpret_cast<uint8_t*>(buffer);
+  buffer += joint_lods_size;
+  joint_lods_.end = reinterpret_cast<uint8_t*>(buffer);
+
   // Remaning buffer will be used to store joint names.
   return buffer;
 }
 
+char* Skeleton::AllocateLevels(char* _buffer, size_t _num_joints) {
+  Range<int16_t>* ranges[] = {&joint_depths_, &joint_child_counts_,
+                              &level_joints_, &level_ends_};
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(ranges); ++i) {
+    ranges[i]->begin = reinterpret_cast<int16_t*>(_buffer);
+    _buffer += _num_joints * sizeof(int16_t);
+    ranges[i]->end = reinterpret_cast<int16_t*>(_buffer);
+  }
+  return _buffer;
+}
+
 void Skeleton::Deallocate() {
-  memory::default_allocator()->Deallocate(joint_bind_poses_.begin);
+  // Only the array of names is owned when mapped to a flat buffer.
+  allocator_->Deallocate(mapped_ ? static_cast<void*>(joint_names_.begin)
+                                 : static_cast<void*>(joint_bind_poses_.begin));
+  mapped_ = false;
+  capacity_ = 0;
   joint_bind_poses_.Clear();
   joint_names_.Clear();
+  joint_name_hashes_.Clear();
+  joint_name_table_.Clear();
   joint_parents_.Clear();
+  joint_subtree_ends_.Clear();
+  joint_depths_.Clear();
+  joint_child_counts_.Clear();
+  level_joints_.Clear();
+  level_ends_.Clear();
+  num_levels_ = 0;
+  joint_lods_.Clear();
+  ComputeLODEnds();
+}
+
+void Skeleton::ComputeSubtreeEnds() {
+  // Children are stored after their parent, so iterating in reverse order
+  // ensures a joint subtree end is final before it's propagated to its
+  // parent.
+  const int num_joints = this->num_joints();
+  for (int i = 0; i < num_joints; ++i) {
+    joint_subtree_ends_[i] = static_cast<int16_t>(i + 1);
+  }
+  for (int i = num_joints - 1; i >= 0; --i) {
+    const int parent = joint_parents_[i];
+    if (parent != kNoParent) {
+      joint_subtree_ends_[parent] =
+          math::Max(joint_subtree_ends_[parent], joint_subtree_ends_[i]);
+    }
+  }
+}
+
+void Skeleton::ComputeLevels() {
+  // Parents are stored before their children, so a parent depth is final
+  // before it's used.
+  const int num_joints = this->num_joints();
+  num_levels_ = 0;
+  for (int i = 0; i < num_joints; ++i) {
+    joint_child_counts_[i] = 0;
+    level_ends_[i] = 0;
+  }
+  for (int i = 0; i < num_joints; ++i) {
+    const int parent = joint_parents_[i];
+    const int depth = parent == kNoParent ? 0 : joint_depths_[parent] + 1;
+    joint_depths_[i] = static_cast<int16_t>(depth);
+    num_levels_ = math::Max(num_levels_, depth + 1);
+    if (parent != kNoParent) {
+      ++joint_child_counts_[parent];
+    }
+    ++level_ends_[depth];
+  }
+
+  // Counting sort of joints by depth, which preserves joints order within a
+  // level.
+  for (int level = 1; level < num_levels_; ++level) {
+    level_ends_[level] += level_ends_[level - 1];
+  }
+  for (int i = num_joints - 1; i >= 0; --i) {
+    const int slot = --level_ends_[joint_depths_[i]];
+    level_joints_[slot] = static_cast<int16_t>(i);
+  }
+  // Level ends were moved to level begins by the sort.
+  for (int level = 0; level < num_levels_; ++level) {
+    level_ends_[level] = static_cast<int16_t>(
+        level + 1 < num_levels_ ? level_ends_[level + 1] : num_joints);
+  }
+}
+
+void Skeleton::ComputeLODEnds() {
+  num_lods_ = 1;
+  for (size_t i = 0; i < joint_lods_.count(); ++i) {
+    num_lods_ = math::Max(num_lods_, joint_lods_[i] + 1);
+  }
+  assert(num_lods_ <= kMaxLODs);
+  for (int lod = 0; lod < kMaxLODs; ++lod) {
+    lod_ends_[lod] = 0;
+  }
+  for (size_t i = 0; i < joint_lods_.count(); ++i) {
+    for (int lod = 0; lod <= joint_lods_[i]; ++lod) {
+      lod_ends_[lod] = static_cast<int16_t>(i + 1);
+    }
+  }
+}
+
+void Skeleton::ComputeNameHashes(const char* _chars) {
+  const int num_joints = this->num_joints();
+  for (int i = 0; i < num_joints; ++i) {
+    joint_name_hashes_[i] = HashJointName(_chars);
+    _chars += std::strlen(_chars) + 1;
+  }
+
+  // Inserts joints in the table using linear probing. The first joint with a
+  // given name is found first, as joints are inserted in order.
+  std::fill(joint_name_table_.begin,
+            joint_name_table_.begin + joint_name_table_.count(),
+            static_cast<int16_t>(kNoParent));
+  const size_t mask = joint_name_table_.count() - 1;
+  for (int i = 0; i < num_joints; ++i) {
+    size_t slot = joint_name_hashes_[i] & mask;
+    while (joint_name_table_[slot] != kNoParent) {
+      slot = (slot + 1) & mask;
+    }
+    joint_name_table_[slot] = static_cast<int16_t>(i);
+  }
+}
+
+uint32_t Skeleton::HashJointName(const char* _name) {
+  uint32_t hash = 2166136261u;
+  for (; *_name; ++_name) {
+    hash ^= static_cast<uint8_t>(*_name);
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+namespace {
+// Accumulates the 4 bytes of _value to FNV-1a _hash.
+uint32_t HashFingerprint(uint32_t _hash, uint32_t _value) {
+  for (int i = 0; i < 4; ++i, _value >>= 8) {
+    _hash ^= _value & 0xff;
+    _hash *= 16777619u;
+  }
+  return _hash;
+}
+}  // namespace
+
+uint32_t Skeleton::fingerprint() const {
+  const int num_joints = this->num_joints();
+  uint32_t hash =
+      HashFingerprint(2166136261u, static_cast<uint32_t>(num_joints));
+  for (int i = 0; i < num_joints; ++i) {
+    hash = HashFingerprint(hash, static_cast<uint32_t>(joint_parents_[i]));
+    hash = HashFingerprint(hash, joint_name_hashes_[i]);
+  }
+  // 0 stands for an unknown skeleton.
+  return hash ? hash : 1;
+}
+
+int Skeleton::FindJointByHash(uint32_t _hash) const {
+  if (joint_name_table_.count() == 0) {
+    return -1;
+  }
+  const size_t mask = joint_name_table_.count() - 1;
+  for (size_t slot = _hash & mask; joint_name_table_[slot] != kNoParent;
+       slot = (slot + 1) & mask) {
+    const int joint = joint_name_table_[slot];
+    if (joint_name_hashes_[joint] == _hash) {
+      return joint;
+    }
+  }
+  return -1;
+}
+
+int Skeleton::FindJoint(const char* _name) const {
+  if (joint_name_table_.count() == 0) {
+    return -1;
+  }
+  // Names are compared when available, to resolve hash collisions.
+  const uint32_t hash = HashJointName(_name);
+  const bool has_names = joint_names_.count() != 0;
+  const size_t mask = joint_name_table_.count() - 1;
+  for (size_t slot = hash & mask; joint_name_table_[slot] != kNoParent;
+       slot = (slot + 1) & mask) {
+    const int joint = joint_name_table_[slot];
+    if (joint_name_hashes_[joint] == hash &&
+        (!has_names || std::strcmp(joint_names_[joint], _name) == 0)) {
+      return joint;
+    }
+  }
+  return -1;
+}
+
+namespace {
+// Header of a skeleton flat representation, see Skeleton::WriteFlat(). It's
+// followed by bind poses, parents, subtree ends, levels of detail and names
+// characters buffers, starting at kFlatSkeletonDataOffset.
+struct FlatSkeletonHeader {
+  uint32_t tag;
+  uint32_t version;
+  uint32_t num_joints;
+  uint32_t chars_size;
+};
+
+// Flat representation tag ("ozfs"), also used to detect endianness mismatch.
+const uint32_t kFlatSkeletonTag = 0x73667a6f;
+const size_t kFlatSkeletonDataOffset =
+    (sizeof(FlatSkeletonHeader) + Skeleton::kFlatAlignment - 1) &
+    ~static_cast<size_t>(Skeleton::kFlatAlignment - 1);
+
+// Computes flat representation size from its header.
+size_t FlatSkeletonSize(const FlatSkeletonHeader& _header) {
+  return kFlatSkeletonDataOffset +
+         (_header.num_joints + 3) / 4 * sizeof(math::SoaTransform) +
+         _header.num_joints * (sizeof(int16_t) * 2 + sizeof(uint8_t)) +
+         _header.chars_size;
+}
+}  // namespace
+
+size_t Skeleton::flat_size() const {
+  FlatSkeletonHeader header = {};
+  header.num_joints = static_cast<uint32_t>(num_joints());
+  for (int i = 0; i < static_cast<int>(joint_names_.count()); ++i) {
+    header.chars_size +=
+        static_cast<uint32_t>(std::strlen(joint_names_[i]) + 1);
+  }
+  return FlatSkeletonSize(header);
+}
+
+bool Skeleton::WriteFlat(void* _buffer, size_t _size) const {
+  if (num_joints() != 0 && joint_names_.count() == 0) {
+    log::Err() << "Skeleton flat representation requires joint names."
+               << std::endl;
+    return false;
+  }
+  if (!_buffer || _size < flat_size() ||
+      !math::IsAligned(_buffer, kFlatAlignment)) {
+    log::Err() << "Invalid buffer for skeleton flat representation."
+               << std::endl;
+    return false;
+  }
+  char* cursor = static_cast<char*>(_buffer);
+  std::memset(cursor, 0, kFlatSkeletonDataOffset);
+  cursor += kFlatSkeletonDataOffset;
+
+  // Buffers are written by decreasing alignment order.
+  std::memcpy(cursor, joint_bind_poses_.begin, joint_bind_poses_.size());
+  cursor += joint_bind_poses_.size();
+  std::memcpy(cursor, joint_parents_.begin, joint_parents_.size());
+  cursor += joint_parents_.size();
+  std::memcpy(cursor, joint_subtree_ends_.begin, joint_subtree_ends_.size());
+  cursor += joint_subtree_ends_.size();
+  std::memcpy(cursor, joint_lods_.begin, joint_lods_.size());
+  cursor += joint_lods_.size();
+
+  // Names are stored as contiguous c-strings, in joint order.
+  const char* chars = cursor;
+  for (int i = 0; i < num_joints(); ++i) {
+    const size_t len = std::strlen(joint_names_[i]) + 1;
+    std::memcpy(cursor, joint_names_[i], len);
+    cursor += len;
+  }
+
+  FlatSkeletonHeader header;
+  header.tag = kFlatSkeletonTag;
+  header.version = io::internal::Version<const Skeleton>::kValue;
+  header.num_joints = static_cast<uint32_t>(num_joints());
+  header.chars_size = static_cast<uint32_t>(cursor - chars);
+  std::memcpy(_buffer, &header, sizeof(header));
+  return true;
+}
+
+bool Skeleton::MapFlat(const void* _buffer, size_t _size) {
+  // Releases current content, *this is left empty on failure.
+  Deallocate();
+
+  if (!_buffer || _size < kFlatSkeletonDataOffset ||
+      !math::IsAligned(_buffer, kFlatAlignment)) {
+    log::Err() << "Invalid buffer for skeleton flat representation."
+               << std::endl;
+    return false;
+  }
+  FlatSkeletonHeader header;
+  std::memcpy(&header, _buffer, sizeof(header));
+  if (header.tag != kFlatSkeletonTag ||
+      header.version != io::internal::Version<const Skeleton>::kValue) {
+    log::Err() << "Unsupported skeleton flat representation." << std::endl;
+    return false;
+  }
+  if (header.num_joints > kMaxJoints || _size < FlatSkeletonSize(header) ||
+      (header.num_joints != 0 && header.chars_size == 0)) {
+    log::Err() << "Corrupted skeleton flat representation." << std::endl;
+    return false;
+  }
+  if (header.num_joints == 0) {
+    return true;
+  }
+
+  // Buffer content isn't modified, even though ranges aren't const.
+  char* cursor = const_cast<char*>(static_cast<const char*>(_buffer)) +
+                 kFlatSkeletonDataOffset;
+  joint_bind_poses_.begin = reinterpret_cast<math::SoaTransform*>(cursor);
+  cursor += (header.num_joints + 3) / 4 * sizeof(math::SoaTransform);
+  joint_bind_poses_.end = reinterpret_cast<math::SoaTransform*>(cursor);
+  joint_parents_.begin = reinterpret_cast<int16_t*>(cursor);
+  cursor += header.num_joints * sizeof(int16_t);
+  joint_parents_.end = reinterpret_cast<int16_t*>(cursor);
+  joint_subtree_ends_.begin = reinterpret_cast<int16_t*>(cursor);
+  cursor += header.num_joints * sizeof(int16_t);
+  joint_subtree_ends_.end = reinterpret_cast<int16_t*>(cursor);
+  joint_lods_.begin = reinterpret_cast<uint8_t*>(cursor);
+  cursor += header.num_joints * sizeof(uint8_t);
+  joint_lods_.end = reinterpret_cast<uint8_t*>(cursor);
+  for (uint32_t i = 0; i < header.num_joints; ++i) {
+    if (joint_lods_[i] >= kMaxLODs) {
+      log::Err() << "Corrupted skeleton flat representation." << std::endl;
+      joint_lods_.Clear();
+      return false;
+    }
+  }
+
+  // Names array can't be shared as it contains pointers, so it's allocated
+  // when mapping a skeleton, along with name hashes and hash table. Names must
+  // be null terminated within the chars buffer.
+  memory::ScopedAllocationTag tag(memory::kTagSkeleton);
+  const size_t table_size = JointNameTableSize(header.num_joints);
+  char* owned = reinterpret_cast<char*>(allocator_->Allocate(
+      header.num_joints * (sizeof(char*) + sizeof(uint32_t)) +
+          (table_size + header.num_joints * 4) * sizeof(int16_t),
+      OZZ_ALIGN_OF(char*)));
+  joint_names_.begin = reinterpret_cast<char**>(owned);
+  owned += header.num_joints * sizeof(char*);
+  joint_names_.end = reinterpret_cast<char**>(owned);
+  joint_name_hashes_.begin = reinterpret_cast<uint32_t*>(owned);
+  owned += header.num_joints * sizeof(uint32_t);
+  joint_name_hashes_.end = reinterpret_cast<uint32_t*>(owned);
+  joint_name_table_.begin = reinterpret_cast<int16_t*>(owned);
+  owned += table_size * sizeof(int16_t);
+  joint_name_table_.end = reinterpret_cast<int16_t*>(owned);
+  AllocateLevels(owned, header.num_joints);
+  mapped_ = true;
+  const char* chars = cursor;
+  const char* chars_end = cursor + header.chars_size;
+  for (uint32_t i = 0; i < header.num_joints; ++i) {
+    const void* terminator = std::memchr(cursor, 0, chars_end - cursor);
+    if (!terminator) {
+      log::Err() << "Corrupted skeleton flat representation." << std::endl;
+      Deallocate();
+      return false;
+    }
+    joint_names_[i] = cursor;
+    cursor = static_cast<char*>(const_cast<void*>(terminator)) + 1;
+  }
+  ComputeNameHashes(chars);
+  ComputeLevels();
+  ComputeLODEnds();
+  return true;
 }
 
 void Skeleton::Save(ozz::io::OArchive& _archive) const {
@@ -111,22 +571,31 @@ void Skeleton::Save(ozz::io::OArchive& _archive) const {
   }
 
   // Stores names. They are all concatenated in the same buffer, starting at
-  // joint_names_[0].
-  size_t chars_count = 0;
-  for (int i = 0; i < num_joints; ++i) {
-    chars_count += (std::strlen(joint_names_[i]) + 1) * sizeof(char);
+  // joint_names_[0]. Empty names are stored if names weren't loaded.
+  if (joint_names_.count() != 0) {
+    size_t chars_count = 0;
+    for (int i = 0; i < num_joints; ++i) {
+      chars_count += (std::strlen(joint_names_[i]) + 1) * sizeof(char);
+    }
+    _archive << static_cast<int32_t>(chars_count);
+    _archive << ozz::io::MakeArray(joint_names_[0], chars_count);
+  } else {
+    const char empty = 0;
+    _archive << static_cast<int32_t>(num_joints);
+    for (int i = 0; i < num_joints; ++i) {
+      _archive << empty;
+    }
   }
-  _archive << static_cast<int32_t>(chars_count);
-  _archive << ozz::io::MakeArray(joint_names_[0], chars_count);
   _archive << ozz::io::MakeArray(joint_parents_);
   _archive << ozz::io::MakeArray(joint_bind_poses_);
+  _archive << ozz::io::MakeArray(joint_lods_);
 }
 
 void Skeleton::Load(ozz::io::IArchive& _archive, uint32_t _version) {
   // Deallocate skeleton in case it was already used before.
   Deallocate();
 
-  if (_version != 2) {
+  if (_version < 2 || _version > 3) {
     log::Err() << "Unsupported Skeleton version " << _version << "."
                << std::endl;
     return;
@@ -144,23 +613,56 @@ void Skeleton::Load(ozz::io::IArchive& _archive, uint32_t _version) {
   int32_t chars_count;
   _archive >> chars_count;
 
-  // Allocates all skeleton data members.
-  char* cursor = Allocate(chars_count, num_joints);
+  // Allocates all skeleton data members. Names are only allocated if they
+  // are loaded.
+  char* cursor = Allocate(load_names_ ? chars_count : 0, num_joints);
 
-  // Reads name's buffer, they are all contiguous in the same buffer.
-  _archive >> ozz::io::MakeArray(cursor, chars_count);
+  if (load_names_) {
+    // Reads name's buffer, they are all contiguous in the same buffer.
+    _archive >> ozz::io::MakeArray(cursor, chars_count);
+    ComputeNameHashes(cursor);
 
-  // Fixes up array of pointers. Stops at num_joints - 1, so that it doesn't
-  // read memory past the end of the buffer.
-  for (int i = 0; i < num_joints - 1; ++i) {
-    joint_names_[i] = cursor;
-    cursor += std::strlen(joint_names_[i]) + 1;
+    // Fixes up array of pointers. Stops at num_joints - 1, so that it doesn't
+    // read memory past the end of the buffer.
+    for (int i = 0; i < num_joints - 1; ++i) {
+      joint_names_[i] = cursor;
+      cursor += std::strlen(joint_names_[i]) + 1;
+    }
+    // num_joints is > 0, as this was tested at the beginning of the function.
+    joint_names_[num_joints - 1] = cursor;
+  } else {
+    // Names are read to a temporary buffer, only to compute their hashes.
+    memory::ScopedAllocationTag tag(memory::kTagSkeleton);
+    char* chars = reinterpret_cast<char*>(
+        allocator_->Allocate(chars_count, OZZ_ALIGN_OF(char)));
+    _archive >> ozz::io::MakeArray(chars, chars_count);
+    ComputeNameHashes(chars);
+    allocator_->Deallocate(chars);
   }
-  // num_joints is > 0, as this was tested at the beginning of the function.
-  joint_names_[num_joints - 1] = cursor;
 
   _archive >> ozz::io::MakeArray(joint_parents_);
   _archive >> ozz::io::MakeArray(joint_bind_poses_);
+
+  // Levels of detail were introduced with version 3, all joints belong to LOD
+  // 0 before.
+  if (_version >= 3) {
+    _archive >> ozz::io::MakeArray(joint_lods_);
+    for (int i = 0; i < num_joints; ++i) {
+      if (joint_lods_[i] >= kMaxLODs) {
+        log::Err() << "Invalid skeleton level of detail." << std::endl;
+        Deallocate();
+        return;
+      }
+    }
+  } else {
+    std::memset(joint_lods_.begin, 0, joint_lods_.size());
+  }
+
+  // Subtree ends and levels aren't serialized, as they're computed from
+  // parents.
+  ComputeSubtreeEnds();
+  ComputeLevels();
+  ComputeLODEnds();
 }
 }  // namespace animation
 }  // namespace ozz
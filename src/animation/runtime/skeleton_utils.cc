@@ -27,9 +27,12 @@
 
 #include "ozz/animation/runtime/skeleton_utils.h"
 
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/base/maths/math_ex.h"
 #include "ozz/base/maths/soa_transform.h"
 
 #include <assert.h>
+#include <cstring>
 
 namespace ozz {
 namespace animation {
@@ -60,5 +63,165 @@ ozz::math::Transform GetJointLocalBindPose(const Skeleton& _skeleton,
 
   return bind_pose;
 }
+
+bool IsCompatible(const Skeleton& _skeleton, const Animation& _animation) {
+  if (_animation.sparse()) {
+    if (_animation.soa_joints().end[-1] >= _skeleton.num_soa_joints()) {
+      return false;
+    }
+  } else if (_animation.num_tracks() != _skeleton.num_joints()) {
+    return false;
+  }
+  const uint32_t fingerprint = _animation.skeleton_fingerprint();
+  return fingerprint == 0 || fingerprint == _skeleton.fingerprint();
+}
+
+int BuildJointRemap(const Skeleton& _from, const Skeleton& _to,
+                    const Range<int>& _remap) {
+  const int num_joints = _to.num_joints();
+  if (_remap.count() < static_cast<size_t>(num_joints)) {
+    return -1;
+  }
+
+  // Joints are found by name when both skeletons have names, otherwise by
+  // name hash.
+  const Range<const char* const> to_names = _to.joint_names();
+  const Range<const uint32_t> to_hashes = _to.joint_name_hashes();
+  const bool by_name =
+      to_names.count() != 0 && _from.joint_names().count() != 0;
+  int matched = 0;
+  for (int i = 0; i < num_joints; ++i) {
+    _remap[i] = by_name ? _from.FindJoint(to_names[i])
+                        : _from.FindJointByHash(to_hashes[i]);
+    matched += _remap[i] != -1;
+  }
+  return matched;
+}
+
+namespace {
+// Finds the joint named like _name, where the first occurrence of _from is
+// replaced by _to. Returns -1 if _from isn't found in _name, or if there's no
+// such joint.
+int FindJointSubstituted(const Skeleton& _skeleton, const char* _name,
+                         const char* _from, const char* _to) {
+  const char* found = std::strstr(_name, _from);
+  if (!found) {
+    return -1;
+  }
+  const size_t prefix = found - _name;
+  const size_t from_len = std::strlen(_from);
+  const size_t to_len = std::strlen(_to);
+  const size_t name_len = std::strlen(_name);
+  const size_t len = name_len - from_len + to_len;
+  char buffer[256];
+  if (len >= sizeof(buffer)) {
+    return -1;
+  }
+  std::memcpy(buffer, _name, prefix);
+  std::memcpy(buffer + prefix, _to, to_len);
+  std::memcpy(buffer + prefix + to_len, found + from_len,
+              name_len - prefix - from_len + 1);
+  return _skeleton.FindJoint(buffer);
+}
+}  // namespace
+
+int BuildJointMirror(const Skeleton& _skeleton, const char* _left,
+                     const char* _right, const Range<int>& _mirror) {
+  assert(_left && *_left && _right && *_right && "Invalid mirror tokens.");
+  const int num_joints = _skeleton.num_joints();
+  const Range<const char* const> names = _skeleton.joint_names();
+  if (_mirror.count() < static_cast<size_t>(num_joints) ||
+      (num_joints != 0 && names.count() == 0)) {
+    return -1;
+  }
+  int paired = 0;
+  for (int i = 0; i < num_joints; ++i) {
+    int mirror = FindJointSubstituted(_skeleton, names[i], _left, _right);
+    if (mirror == -1) {
+      mirror = FindJointSubstituted(_skeleton, names[i], _right, _left);
+    }
+    _mirror[i] = mirror == -1 ? i : mirror;
+    paired += _mirror[i] != i;
+  }
+  return paired;
+}
+
+int GetIndependentSubtrees(const Skeleton& _skeleton, int _split,
+                           const Range<int>& _roots) {
+  const Range<const int16_t>& ends = _skeleton.joint_subtree_ends();
+  const int num_joints = _skeleton.num_joints();
+  const int max_roots = static_cast<int>(_roots.count());
+  int num_subtrees = 0;
+  for (int i = math::Max(_split, 0); i < num_joints; i = ends[i]) {
+    if (num_subtrees < max_roots) {
+      _roots[num_subtrees] = i;
+    }
+    ++num_subtrees;
+  }
+  return num_subtrees;
+}
+
+int GetRequiredJoints(const Skeleton& _skeleton,
+                      const Range<const uint16_t>& _joints,
+                      const Range<bool>& _required) {
+  const int num_joints = _skeleton.num_joints();
+  if (_required.count() < static_cast<size_t>(num_joints)) {
+    return -1;
+  }
+  const Range<const int16_t>& parents = _skeleton.joint_parents();
+  int marked = 0;
+  for (const uint16_t* joint = _joints.begin; joint < _joints.end; ++joint) {
+    if (*joint >= num_joints) {
+      return -1;
+    }
+    // Ancestors are already marked if the joint is.
+    for (int i = *joint; i != Skeleton::kNoParent && !_required[i];
+         i = parents[i]) {
+      _required[i] = true;
+      ++marked;
+    }
+  }
+  return marked;
+}
+
+int GetLODJoints(const Skeleton& _skeleton, int _lod,
+                 const Range<bool>& _required) {
+  const int num_joints = _skeleton.num_joints();
+  if (_lod < 0 || _lod >= _skeleton.num_lods() ||
+      _required.count() < static_cast<size_t>(num_joints)) {
+    return -1;
+  }
+  const Range<const uint8_t>& lods = _skeleton.joint_lods();
+  int count = 0;
+  for (int i = 0; i < num_joints; ++i) {
+    _required[i] = lods[i] >= _lod;
+    count += _required[i];
+  }
+  return count;
+}
+
+int GetLODSamplingMask(const Skeleton& _skeleton, int _lod,
+                       const Range<uint8_t>& _mask) {
+  const int num_soa_joints = _skeleton.num_soa_joints();
+  const size_t mask_size = (num_soa_joints + 7) / 8;
+  if (_lod < 0 || _lod >= _skeleton.num_lods() || _mask.count() < mask_size) {
+    return -1;
+  }
+  std::memset(_mask.begin, 0, mask_size);
+  const Range<const uint8_t>& lods = _skeleton.joint_lods();
+  const int num_joints = _skeleton.num_joints();
+  int count = 0;
+  for (int i = 0; i < num_soa_joints; ++i) {
+    bool in_lod = false;
+    for (int j = i * 4; j < i * 4 + 4 && j < num_joints && !in_lod; ++j) {
+      in_lod = lods[j] >= _lod;
+    }
+    if (in_lod) {
+      _mask[i / 8] |= static_cast<uint8_t>(1 << (i & 7));
+      ++count;
+    }
+  }
+  return count;
+}
 }  // namespace animation
 }  // namespace ozz
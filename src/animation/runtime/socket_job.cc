@@ -0,0 +1,74 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#include "ozz/animation/runtime/socket_job.h"
+
+#include "ozz/base/maths/simd_math.h"
+
+namespace ozz {
+namespace animation {
+
+bool SocketJob::Validate() const {
+  bool valid = true;
+  valid &= offsets.count() >= sockets.count();
+  valid &= output.count() >= sockets.count();
+  valid &= transforms.count() == 0 || transforms.count() >= models.count();
+  const size_t num_characters = models.count();
+  for (size_t i = 0; valid && i < sockets.count(); ++i) {
+    const Socket& socket = sockets[i];
+    valid &= socket.character >= 0 &&
+             static_cast<size_t>(socket.character) < num_characters;
+    valid &= valid && socket.joint >= 0 &&
+             static_cast<size_t>(socket.joint) <
+                 models[socket.character].count();
+  }
+  return valid;
+}
+
+bool SocketJob::Run() const {
+  if (!Validate()) {
+    return false;
+  }
+
+  const size_t num_sockets = sockets.count();
+  if (transforms.count() == 0) {
+    for (size_t i = 0; i < num_sockets; ++i) {
+      const Socket& socket = sockets[i];
+      output[i] = models[socket.character][socket.joint] * offsets[i];
+    }
+  } else {
+    for (size_t i = 0; i < num_sockets; ++i) {
+      const Socket& socket = sockets[i];
+      output[i] = transforms[socket.character] *
+                  (models[socket.character][socket.joint] * offsets[i]);
+    }
+  }
+  return true;
+}
+}  // namespace animation
+}  // namespace ozz
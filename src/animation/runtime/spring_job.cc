@@ -0,0 +1,148 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#include "ozz/animation/runtime/spring_job.h"
+
+#include "ozz/base/maths/soa_transform.h"
+
+namespace ozz {
+namespace animation {
+
+namespace {
+// Integrates a damped spring component with implicit Euler, pulling *_x
+// toward _target, and updates its velocity *_v. _k is stiffness times dt, and
+// _rcp_den is 1 / (1 + dt * damping + dt^2 * stiffness).
+OZZ_INLINE void IntegrateSpring(math::SimdFloat4 _target, math::SimdFloat4 _k,
+                                math::SimdFloat4 _rcp_den,
+                                math::SimdFloat4 _dt, math::SimdFloat4* _x,
+                                math::SimdFloat4* _v) {
+  *_v = (*_v + _k * (_target - *_x)) * _rcp_den;
+  *_x = *_x + *_v * _dt;
+}
+}  // namespace
+
+SpringJob::SpringJob() : dt(0.f), reset(false) {}
+
+bool SpringJob::Validate() const {
+  bool valid = true;
+  valid &= dt >= 0.f;
+  valid &= stiffness.count() >= output.count();
+  valid &= damping.count() >= output.count();
+  valid &= states.count() >= output.count();
+  return valid;
+}
+
+bool SpringJob::Run() const {
+  if (!Validate()) {
+    return false;
+  }
+
+  const math::SimdFloat4 zero = math::simd_float4::zero();
+  const math::SimdFloat4 one = math::simd_float4::one();
+  const math::SimdFloat4 simd_dt = math::simd_float4::Load1(dt);
+  const math::SoaQuaternion zero_q = {zero, zero, zero, zero};
+  const math::SoaFloat3 zero_f3 = math::SoaFloat3::zero();
+
+  const size_t num_soa_joints = output.count();
+  for (size_t i = 0; i < num_soa_joints; ++i) {
+    math::SoaTransform& transform = output[i];
+    SoaSpringState& state = states[i];
+
+    // Resets to the animated transform, or skips if no joint is simulated.
+    const math::SimdFloat4 k = stiffness[i];
+    const math::SimdInt4 simulated = math::CmpGt(k, zero);
+    if (reset || math::AreAllFalse(simulated)) {
+      state.rotation = transform.rotation;
+      state.translation = transform.translation;
+      state.angular_velocity = zero_q;
+      state.velocity = zero_f3;
+      continue;
+    }
+
+    // Fixes up target quaternion sign, so the spring takes the shortest path.
+    const math::SoaQuaternion& q = transform.rotation;
+    const math::SimdFloat4 dot =
+        state.rotation.x * q.x + state.rotation.y * q.y +
+        state.rotation.z * q.z + state.rotation.w * q.w;
+    const math::SimdInt4 sign = math::Sign(dot);
+    const math::SoaQuaternion target = {
+        math::Xor(q.x, sign), math::Xor(q.y, sign), math::Xor(q.z, sign),
+        math::Xor(q.w, sign)};
+
+    // Implicit Euler coefficients. Non simulated lanes have a null stiffness,
+    // which is fixed up after integration.
+    const math::SimdFloat4 kdt = math::Max0(k) * simd_dt;
+    const math::SimdFloat4 rcp_den =
+        one / (one + simd_dt * (math::Max0(damping[i]) + kdt));
+
+    math::SoaQuaternion rotation = state.rotation;
+    math::SoaQuaternion angular_velocity = state.angular_velocity;
+    IntegrateSpring(target.x, kdt, rcp_den, simd_dt, &rotation.x,
+                    &angular_velocity.x);
+    IntegrateSpring(target.y, kdt, rcp_den, simd_dt, &rotation.y,
+                    &angular_velocity.y);
+    IntegrateSpring(target.z, kdt, rcp_den, simd_dt, &rotation.z,
+                    &angular_velocity.z);
+    IntegrateSpring(target.w, kdt, rcp_den, simd_dt, &rotation.w,
+                    &angular_velocity.w);
+    rotation = math::Normalize(rotation);
+
+    math::SoaFloat3 translation = state.translation;
+    math::SoaFloat3 velocity = state.velocity;
+    const math::SoaFloat3& t = transform.translation;
+    IntegrateSpring(t.x, kdt, rcp_den, simd_dt, &translation.x, &velocity.x);
+    IntegrateSpring(t.y, kdt, rcp_den, simd_dt, &translation.y, &velocity.y);
+    IntegrateSpring(t.z, kdt, rcp_den, simd_dt, &translation.z, &velocity.z);
+
+    // Non simulated lanes follow animation.
+    state.rotation.x = math::Select(simulated, rotation.x, q.x);
+    state.rotation.y = math::Select(simulated, rotation.y, q.y);
+    state.rotation.z = math::Select(simulated, rotation.z, q.z);
+    state.rotation.w = math::Select(simulated, rotation.w, q.w);
+    state.angular_velocity.x =
+        math::Select(simulated, angular_velocity.x, zero);
+    state.angular_velocity.y =
+        math::Select(simulated, angular_velocity.y, zero);
+    state.angular_velocity.z =
+        math::Select(simulated, angular_velocity.z, zero);
+    state.angular_velocity.w =
+        math::Select(simulated, angular_velocity.w, zero);
+    state.translation.x = math::Select(simulated, translation.x, t.x);
+    state.translation.y = math::Select(simulated, translation.y, t.y);
+    state.translation.z = math::Select(simulated, translation.z, t.z);
+    state.velocity.x = math::Select(simulated, velocity.x, zero);
+    state.velocity.y = math::Select(simulated, velocity.y, zero);
+    state.velocity.z = math::Select(simulated, velocity.z, zero);
+
+    transform.rotation = state.rotation;
+    transform.translation = state.translation;
+  }
+  return true;
+}
+}  // namespace animation
+}  // namespace ozz
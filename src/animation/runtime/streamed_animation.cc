@@ -0,0 +1,266 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#include "ozz/animation/runtime/streamed_animation.h"
+
+#include <cassert>
+#include <cstring>
+
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/segmented_sampling_job.h"
+#include "ozz/base/io/archive.h"
+#include "ozz/base/io/stream.h"
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/memory/allocator.h"
+
+namespace ozz {
+namespace animation {
+
+namespace {
+// Header tag and version of streamed animations.
+const char kTag[] = "ozz-streamed_animation";
+const uint32_t kVersion = 1;
+}  // namespace
+
+StreamedAnimation::StreamedAnimation()
+    : stream_(NULL),
+      origin_(0),
+      duration_(0.f),
+      segment_duration_(0.f),
+      num_segments_(0),
+      window_size_(0),
+      window_first_(-1),
+      offsets_(NULL),
+      animations_(NULL) {}
+
+StreamedAnimation::~StreamedAnimation() { Close(); }
+
+bool StreamedAnimation::Save(io::OArchive& _archive, float _duration,
+                             float _segment_duration,
+                             const Range<const Animation* const>& _segments) {
+  const ptrdiff_t num_segments = _segments.end - _segments.begin;
+  if (!(_duration > 0.f) || !(_segment_duration > 0.f) || num_segments <= 0) {
+    return false;
+  }
+  for (const Animation* const* it = _segments.begin; it < _segments.end;
+       ++it) {
+    if (!*it) {
+      return false;
+    }
+  }
+
+  io::Stream* stream = _archive.stream();
+  const int64_t origin = stream->Tell();
+  _archive.SaveBinary(kTag, sizeof(kTag));
+  _archive << kVersion;
+  _archive << _duration;
+  _archive << _segment_duration;
+  _archive << static_cast<int32_t>(num_segments);
+
+  // Reserves offsets table, to be filled once segments are written.
+  const int64_t table = stream->Tell();
+  for (ptrdiff_t i = 0; i < num_segments; ++i) {
+    _archive << static_cast<int32_t>(0);
+  }
+
+  // Writes segments, each in its own archive so they can be read from their
+  // offset.
+  const Endianness native = GetNativeEndianness();
+  const Endianness endianness =
+      _archive.endian_swap()
+          ? (native == kBigEndian ? kLittleEndian : kBigEndian)
+          : native;
+  memory::Allocator* allocator = memory::default_allocator();
+  int32_t* offsets = reinterpret_cast<int32_t*>(allocator->Allocate(
+      sizeof(int32_t) * num_segments, OZZ_ALIGN_OF(int32_t)));
+  for (ptrdiff_t i = 0; i < num_segments; ++i) {
+    offsets[i] = static_cast<int32_t>(stream->Tell() - origin);
+    io::OArchive segment_archive(stream, endianness);
+    segment_archive << *_segments.begin[i];
+  }
+
+  // Fills offsets table and restores stream position.
+  const int64_t end = stream->Tell();
+  bool success = stream->Seek(table, io::Stream::kSet) == 0;
+  for (ptrdiff_t i = 0; success && i < num_segments; ++i) {
+    _archive << offsets[i];
+  }
+  success &= stream->Seek(end, io::Stream::kSet) == 0;
+  allocator->Deallocate(offsets);
+  return success;
+}
+
+bool StreamedAnimation::Open(io::Stream* _stream, int _window_size) {
+  Close();
+  if (!_stream || !_stream->opened() || _window_size < 1) {
+    return false;
+  }
+
+  io::IArchive archive(_stream);
+  const int64_t origin = _stream->Tell();
+
+  char tag[sizeof(kTag)];
+  if (archive.LoadBinary(tag, sizeof(tag)) != sizeof(tag) ||
+      std::memcmp(tag, kTag, sizeof(tag)) != 0) {
+    return false;
+  }
+  uint32_t version;
+  archive >> version;
+  if (version != kVersion) {
+    return false;
+  }
+  float duration, segment_duration;
+  int32_t num_segments;
+  archive >> duration;
+  archive >> segment_duration;
+  archive >> num_segments;
+  if (!(duration > 0.f) || !(segment_duration > 0.f) || num_segments <= 0) {
+    return false;
+  }
+
+  // Allocates offsets and animations at once.
+  const size_t size = (sizeof(int) + sizeof(Animation*)) * num_segments;
+  char* alloc = reinterpret_cast<char*>(
+      memory::default_allocator()->Allocate(size, OZZ_ALIGN_OF(Animation*)));
+  animations_ = reinterpret_cast<Animation**>(alloc);
+  offsets_ = reinterpret_cast<int*>(alloc + sizeof(Animation*) * num_segments);
+  for (int i = 0; i < num_segments; ++i) {
+    int32_t offset;
+    archive >> offset;
+    offsets_[i] = offset;
+    animations_[i] = NULL;
+  }
+
+  stream_ = _stream;
+  origin_ = origin;
+  duration_ = duration;
+  segment_duration_ = segment_duration;
+  num_segments_ = num_segments;
+  window_size_ = math::Min(_window_size, num_segments_);
+  window_first_ = -1;
+  return true;
+}
+
+void StreamedAnimation::Close() {
+  memory::Allocator* allocator = memory::default_allocator();
+  for (int i = 0; i < num_segments_; ++i) {
+    allocator->Delete(animations_[i]);
+  }
+  // Deallocates everything at once.
+  allocator->Deallocate(animations_);
+  animations_ = NULL;
+  offsets_ = NULL;
+  stream_ = NULL;
+  origin_ = 0;
+  duration_ = 0.f;
+  segment_duration_ = 0.f;
+  num_segments_ = 0;
+  window_size_ = 0;
+  window_first_ = -1;
+}
+
+bool StreamedAnimation::InWindow(int _first, int _index) const {
+  // Window wraps to the beginning of the animation.
+  const int distance = (_index - _first + num_segments_) % num_segments_;
+  return distance < window_size_;
+}
+
+bool StreamedAnimation::LoadSegment(int _index) {
+  assert(_index >= 0 && _index < num_segments_);
+  if (animations_[_index]) {
+    return true;
+  }
+  if (stream_->Seek(origin_ + offsets_[_index], io::Stream::kSet) != 0) {
+    return false;
+  }
+  io::IArchive archive(stream_);
+  if (!archive.TestTag<Animation>()) {
+    return false;
+  }
+  Animation* animation = memory::default_allocator()->New<Animation>();
+  archive >> *animation;
+  animations_[_index] = animation;
+  return true;
+}
+
+bool StreamedAnimation::Update(float _ratio) {
+  if (!stream_) {
+    return false;
+  }
+
+  // Uses the same segment selection as the sampling job.
+  SegmentedSamplingJob job;
+  job.ratio = _ratio;
+  job.duration = duration_;
+  job.segment_duration = segment_duration_;
+  job.segments = segments();
+  const int first = job.segment();
+  assert(first >= 0);
+
+  if (first != window_first_) {
+    // Unloads segments that left the window.
+    for (int i = 0; i < num_segments_; ++i) {
+      if (animations_[i] && !InWindow(first, i)) {
+        memory::default_allocator()->Delete(animations_[i]);
+        animations_[i] = NULL;
+      }
+    }
+    window_first_ = first;
+  }
+
+  // The required segment is loaded synchronously, next ones are left to
+  // Prefetch().
+  return LoadSegment(first);
+}
+
+bool StreamedAnimation::Prefetch() {
+  if (!stream_ || window_first_ < 0) {
+    return false;
+  }
+  for (int i = 0; i < window_size_; ++i) {
+    const int index = (window_first_ + i) % num_segments_;
+    if (!animations_[index]) {
+      return LoadSegment(index);
+    }
+  }
+  return false;
+}
+
+Range<const Animation* const> StreamedAnimation::segments() const {
+  return Range<const Animation* const>(animations_, num_segments_);
+}
+
+int StreamedAnimation::num_resident_segments() const {
+  int count = 0;
+  for (int i = 0; i < num_segments_; ++i) {
+    count += animations_[i] != NULL;
+  }
+  return count;
+}
+}  // namespace animation
+}  // namespace ozz
@@ -0,0 +1,154 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/sync_sampling_job.h"
+
+#include <cassert>
+#include <cmath>
+
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/sampling_job.h"
+#include "ozz/base/maths/math_ex.h"
+
+namespace ozz {
+namespace animation {
+
+namespace {
+// Returns the fractional part of _x, in range [0,1[.
+float Fract(float _x) {
+  const float fract = _x - std::floor(_x);
+  return fract < 1.f ? fract : 0.f;
+}
+}  // namespace
+
+float PhaseToRatio(const Animation& _animation, float _phase) {
+  const Range<const float> markers = _animation.sync_ratios();
+  const int num_markers = _animation.num_sync_markers();
+  if (num_markers == 0) {
+    return Fract(_phase);
+  }
+
+  // Finds the interval of markers that contains phase, the last one wrapping
+  // to the first marker of the next loop.
+  const float scaled = Fract(_phase) * num_markers;
+  const int k = math::Min(static_cast<int>(scaled), num_markers - 1);
+  const float from = markers[k];
+  const float to = k + 1 < num_markers ? markers[k + 1] : markers[0] + 1.f;
+  return Fract(from + (to - from) * (scaled - k));
+}
+
+float RatioToPhase(const Animation& _animation, float _ratio) {
+  const Range<const float> markers = _animation.sync_ratios();
+  const int num_markers = _animation.num_sync_markers();
+  if (num_markers == 0) {
+    return Fract(_ratio);
+  }
+
+  // Ratios before the first marker belong to the last interval of the
+  // previous loop.
+  float ratio = Fract(_ratio);
+  if (ratio < markers[0]) {
+    ratio += 1.f;
+  }
+  int k = num_markers - 1;
+  while (k > 0 && markers[k] > ratio) {
+    --k;
+  }
+  const float from = markers[k];
+  const float to = k + 1 < num_markers ? markers[k + 1] : markers[0] + 1.f;
+  const float span = to - from;
+  const float alpha = span > 0.f ? (ratio - from) / span : 0.f;
+  return Fract((k + alpha) / num_markers);
+}
+
+SyncSamplingJob::Layer::Layer()
+    : animation(NULL), cache(NULL), weight(0.f) {}
+
+SyncSamplingJob::SyncSamplingJob() : phase(0.f) {}
+
+bool SyncSamplingJob::Validate() const {
+  // Don't stop validation on the first failure, in order to make it easier
+  // to debug.
+  bool success = true;
+
+  success &= layers.begin != NULL || layers.end == NULL;
+
+  int num_markers = -1;
+  for (const Layer* layer = layers.begin; layer < layers.end; ++layer) {
+    if (!layer->animation) {
+      success = false;
+      continue;
+    }
+    const int layer_markers = layer->animation->num_sync_markers();
+    success &= num_markers < 0 || layer_markers == num_markers;
+    num_markers = layer_markers;
+    success &= layer->weight >= 0.f;
+
+    SamplingJob job;
+    job.animation = layer->animation;
+    job.cache = layer->cache;
+    job.output = layer->output;
+    success &= job.Validate();
+  }
+
+  return success;
+}
+
+bool SyncSamplingJob::Run() const {
+  if (!Validate()) {
+    return false;
+  }
+
+  for (const Layer* layer = layers.begin; layer < layers.end; ++layer) {
+    if (layer->weight <= 0.f) {
+      continue;  // Not needed for blending.
+    }
+    SamplingJob job;
+    job.animation = layer->animation;
+    job.cache = layer->cache;
+    job.ratio = PhaseToRatio(*layer->animation, phase);
+    job.output = layer->output;
+    if (!job.Run()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+float SyncSamplingJob::CycleDuration() const {
+  float weights = 0.f;
+  float duration = 0.f;
+  for (const Layer* layer = layers.begin; layer < layers.end; ++layer) {
+    if (layer->animation && layer->weight > 0.f) {
+      weights += layer->weight;
+      duration += layer->weight * layer->animation->duration();
+    }
+  }
+  return weights > 0.f ? duration / weights : 0.f;
+}
+}  // namespace animation
+}  // namespace ozz
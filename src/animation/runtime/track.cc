@@ -33,7 +33,10 @@
 #include "ozz/base/maths/math_ex.h"
 #include "ozz/base/memory/allocator.h"
 
+#include <algorithm>
 #include <cassert>
+#include <cstring>
+#include <utility>
 
 namespace ozz {
 namespace animation {
@@ -41,29 +44,77 @@ namespace animation {
 namespace internal {
 
 template <typename _ValueType>
-Track<_ValueType>::Track() : name_(NULL) {}
+Track<_ValueType>::Track() : name_(NULL), capacity_(0), mapped_(false) {}
 
 template <typename _ValueType>
 Track<_ValueType>::~Track() {
   Deallocate();
 }
 
+#if __cplusplus >= 201103L
+template <typename _ValueType>
+Track<_ValueType>::Track(Track&& _other)
+    : name_(NULL), capacity_(0), mapped_(false) {
+  Swap(_other);
+}
+
+template <typename _ValueType>
+Track<_ValueType>& Track<_ValueType>::operator=(Track&& _other) {
+  // Previous content is released by temporary destruction.
+  Track tmp(std::move(_other));
+  Swap(tmp);
+  return *this;
+}
+#endif  // __cplusplus
+
+template <typename _ValueType>
+void Track<_ValueType>::Swap(Track& _other) {
+  std::swap(ratios_, _other.ratios_);
+  std::swap(values_, _other.values_);
+  std::swap(steps_, _other.steps_);
+  std::swap(name_, _other.name_);
+  std::swap(capacity_, _other.capacity_);
+  std::swap(mapped_, _other.mapped_);
+}
+
 template <typename _ValueType>
 void Track<_ValueType>::Allocate(size_t _keys_count, size_t _name_len) {
-  assert(ratios_.size() == 0 && values_.size() == 0);
+  memory::ScopedAllocationTag tag(memory::kTagTrack);
 
   // Distributes buffer memory while ensuring proper alignment (serves larger
   // alignment values first).
   OZZ_STATIC_ASSERT(OZZ_ALIGN_OF(_ValueType) >= OZZ_ALIGN_OF(float));
   OZZ_STATIC_ASSERT(OZZ_ALIGN_OF(float) >= OZZ_ALIGN_OF(uint8_t));
 
-  // Compute overall size and allocate a single buffer for all the data.
-  const size_t buffer_size = _keys_count * sizeof(_ValueType) +  // values
-                             _keys_count * sizeof(float) +       // ratios
-                             (_keys_count + 7) * sizeof(uint8_t) / 8 +  // steps
-                             (_name_len > 0 ? _name_len + 1 : 0);
-  char* buffer = reinterpret_cast<char*>(memory::default_allocator()->Allocate(
-      buffer_size, OZZ_ALIGN_OF(_ValueType)));
+  // Reuses the owned buffer if it's big enough, otherwise previous content is
+  // released.
+  const size_t size = BufferSize(_keys_count, _name_len);
+  char* buffer;
+  if (capacity_ > 0 && capacity_ >= size) {
+    assert(!mapped_);
+    buffer = reinterpret_cast<char*>(values_.begin);
+  } else {
+    Deallocate();
+    buffer = reinterpret_cast<char*>(
+        memory::default_allocator()->Allocate(size, OZZ_ALIGN_OF(_ValueType)));
+    capacity_ = size;
+  }
+  FixUp(buffer, _keys_count, _name_len);
+}
+
+template <typename _ValueType>
+size_t Track<_ValueType>::BufferSize(size_t _keys_count, size_t _name_len) {
+  // Compute overall size of the single buffer for all the data.
+  return _keys_count * sizeof(_ValueType) +         // values
+         _keys_count * sizeof(float) +              // ratios
+         (_keys_count + 7) * sizeof(uint8_t) / 8 +  // steps
+         (_name_len > 0 ? _name_len + 1 : 0);
+}
+
+template <typename _ValueType>
+void Track<_ValueType>::FixUp(char* _buffer, size_t _keys_count,
+                              size_t _name_len) {
+  char* buffer = _buffer;
 
   // Fix up pointers. Serves larger alignment values first.
   values_.begin = reinterpret_cast<_ValueType*>(buffer);
@@ -89,8 +140,12 @@ void Track<_ValueType>::Allocate(size_t _keys_count, size_t _name_len) {
 
 template <typename _ValueType>
 void Track<_ValueType>::Deallocate() {
-  // Deallocate everything at once.
-  memory::default_allocator()->Deallocate(values_.begin);
+  // Deallocate everything at once. A mapped flat buffer isn't owned.
+  if (!mapped_) {
+    memory::default_allocator()->Deallocate(values_.begin);
+  }
+  mapped_ = false;
+  capacity_ = 0;
 
   values_.Clear();
   ratios_.Clear();
@@ -105,6 +160,83 @@ size_t Track<_ValueType>::size() const {
   return size;
 }
 
+namespace {
+// Header of a track flat representation, see Track::WriteFlat(). It's followed
+// by the track buffer, at kFlatTrackDataOffset.
+struct FlatTrackHeader {
+  uint32_t tag;
+  uint32_t value_size;
+  uint32_t num_keys;
+  uint32_t name_len;
+};
+
+// Flat representation tag ("ozft"), also used to detect endianness mismatch.
+const uint32_t kFlatTrackTag = 0x74667a6f;
+const size_t kFlatTrackDataOffset = 16;
+OZZ_STATIC_ASSERT(sizeof(FlatTrackHeader) <= kFlatTrackDataOffset);
+}  // namespace
+
+template <typename _ValueType>
+size_t Track<_ValueType>::flat_size() const {
+  const size_t name_len = name_ ? std::strlen(name_) : 0;
+  return kFlatTrackDataOffset + BufferSize(ratios_.count(), name_len);
+}
+
+template <typename _ValueType>
+bool Track<_ValueType>::WriteFlat(void* _buffer, size_t _size) const {
+  const size_t flat_size = this->flat_size();
+  if (!_buffer || _size < flat_size ||
+      !math::IsAligned(_buffer, kFlatAlignment)) {
+    log::Err() << "Invalid buffer for track flat representation." << std::endl;
+    return false;
+  }
+  FlatTrackHeader header;
+  header.tag = kFlatTrackTag;
+  header.value_size = sizeof(_ValueType);
+  header.num_keys = static_cast<uint32_t>(ratios_.count());
+  header.name_len = static_cast<uint32_t>(name_ ? std::strlen(name_) : 0);
+
+  // Data buffer is a single contiguous allocation starting with values.
+  char* dest = static_cast<char*>(_buffer);
+  std::memset(dest, 0, kFlatTrackDataOffset);
+  std::memcpy(dest, &header, sizeof(header));
+  if (flat_size > kFlatTrackDataOffset) {
+    std::memcpy(dest + kFlatTrackDataOffset, values_.begin,
+                flat_size - kFlatTrackDataOffset);
+  }
+  return true;
+}
+
+template <typename _ValueType>
+bool Track<_ValueType>::MapFlat(const void* _buffer, size_t _size) {
+  // Releases current content, *this is left empty on failure.
+  Deallocate();
+
+  if (!_buffer || _size < kFlatTrackDataOffset ||
+      !math::IsAligned(_buffer, kFlatAlignment)) {
+    log::Err() << "Invalid buffer for track flat representation." << std::endl;
+    return false;
+  }
+  FlatTrackHeader header;
+  std::memcpy(&header, _buffer, sizeof(header));
+  if (header.tag != kFlatTrackTag || header.value_size != sizeof(_ValueType)) {
+    log::Err() << "Unsupported track flat representation." << std::endl;
+    return false;
+  }
+  if (_size < kFlatTrackDataOffset +
+                  BufferSize(header.num_keys, header.name_len)) {
+    log::Err() << "Corrupted track flat representation." << std::endl;
+    return false;
+  }
+
+  // Buffer content isn't modified, even though ranges aren't const.
+  char* data = const_cast<char*>(static_cast<const char*>(_buffer)) +
+               kFlatTrackDataOffset;
+  FixUp(data, header.num_keys, header.name_len);
+  mapped_ = true;
+  return true;
+}
+
 template <typename _ValueType>
 void Track<_ValueType>::Save(ozz::io::OArchive& _archive) const {
   uint32_t num_keys = static_cast<uint32_t>(ratios_.count());
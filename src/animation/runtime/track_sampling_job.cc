@@ -26,7 +26,9 @@
 //----------------------------------------------------------------------------//
 
 #include "ozz/animation/runtime/track_sampling_job.h"
+#include "ozz/animation/runtime/quantized_track.h"
 #include "ozz/animation/runtime/track.h"
+#include "ozz/animation/runtime/track_set.h"
 #include "ozz/base/maths/math_ex.h"
 
 #include <algorithm>
@@ -36,6 +38,201 @@ namespace ozz {
 namespace animation {
 namespace internal {
 
+namespace {
+// Maximum number of keyframes a cursor is moved by, before falling back to a
+// binary search.
+const int kMaxCursorSteps = 4;
+
+// Finds the index of the first keyframe with a ratio greater than _ratio,
+// starting from _cursor if any. First keyframe ratio is always 0, so the
+// index is in range [1, count]. _Ratio is float, or uint16_t for quantized
+// tracks, in which case _ratio must be in quantized range.
+template <typename _Ratio>
+int FindKey(const Range<const _Ratio>& _ratios, float _ratio, int* _cursor) {
+  const int count = static_cast<int>(_ratios.count());
+  if (_cursor != NULL) {
+    int id1 = math::Min(math::Max(*_cursor, 1), count);
+    for (int steps = 0; steps < kMaxCursorSteps; ++steps) {
+      if (_ratios[id1 - 1] > _ratio) {
+        --id1;  // Moves backward, id1 can't reach 0 as first ratio is 0.
+      } else if (id1 < count && _ratios[id1] <= _ratio) {
+        ++id1;  // Moves forward.
+      } else {
+        *_cursor = id1;
+        return id1;
+      }
+    }
+  }
+
+  // Search for the first key frame with a ratio value greater than input
+  // ratio. Our ratio is between this one and the previous one.
+  const int id1 = static_cast<int>(
+      std::upper_bound(_ratios.begin, _ratios.end, _ratio) - _ratios.begin);
+  if (_cursor != NULL) {
+    *_cursor = id1;
+  }
+  return id1;
+}
+
+// Samples _track at _ratio, using optional _cursor to find keyframes.
+template <typename _Track>
+typename _Track::ValueType Sample(const _Track& _track, float _ratio,
+                                  int* _cursor) {
+  typedef typename _Track::ValueType ValueType;
+
+  // Clamps ratio in range [0,1].
+  const float clamped_ratio = math::Clamp(0.f, _ratio, 1.f);
+
+  // Search keyframes to interpolate.
+  const Range<const float> ratios = _track.ratios();
+  const Range<const ValueType> values = _track.values();
+  assert(ratios.count() == values.count() &&
+         _track.steps().count() * 8 >= values.count());
+
+  // Default track returns identity.
+  if (ratios.count() == 0) {
+    return internal::TrackPolicy<ValueType>::identity();
+  }
+
+  // Deduce keys indices.
+  const size_t id1 = FindKey(ratios, clamped_ratio, _cursor);
+  const size_t id0 = id1 - 1;
+
+  const bool id0step = (_track.steps()[id0 / 8] & (1 << (id0 & 7))) != 0;
+  if (id0step || id1 == ratios.count()) {
+    return values[id0];
+  }
+
+  // Lerp relevant keys.
+  const float tk0 = ratios[id0];
+  const float tk1 = ratios[id1];
+  assert(clamped_ratio >= tk0 && clamped_ratio < tk1 && tk0 != tk1);
+  const float alpha = (clamped_ratio - tk0) / (tk1 - tk0);
+  const ValueType& vk0 = values[id0];
+  const ValueType& vk1 = values[id1];
+  return internal::TrackPolicy<ValueType>::Lerp(vk0, vk1, alpha);
+}
+
+// Samples quantized _track at _ratio, using optional _cursor to find
+// keyframes.
+template <typename _ValueType>
+_ValueType Sample(const QuantizedTrack<_ValueType>& _track, float _ratio,
+                  int* _cursor) {
+  // Default track returns identity.
+  const Range<const uint16_t> ratios = _track.ratios();
+  if (ratios.count() == 0) {
+    return internal::TrackPolicy<_ValueType>::identity();
+  }
+
+  // Clamps ratio in range [0,1], and converts it to quantized ratios range.
+  const float quantized_ratio = math::Clamp(0.f, _ratio, 1.f) *
+                                QuantizedTrack<_ValueType>::kMaxRatio;
+
+  // Deduce keys indices.
+  const size_t id1 = FindKey(ratios, quantized_ratio, _cursor);
+  const size_t id0 = id1 - 1;
+
+  const bool id0step = (_track.steps()[id0 / 8] & (1 << (id0 & 7))) != 0;
+  if (id0step || id1 == ratios.count()) {
+    return _track.value(id0);
+  }
+
+  // Lerp relevant keys.
+  const float tk0 = ratios[id0];
+  const float tk1 = ratios[id1];
+  assert(quantized_ratio >= tk0 && quantized_ratio < tk1);
+  const float alpha = (quantized_ratio - tk0) / (tk1 - tk0);
+  return internal::TrackPolicy<_ValueType>::Lerp(_track.value(id0),
+                                                 _track.value(id1), alpha);
+}
+
+// Dispatches sampling to Track or QuantizedTrack implementation. Tracks are
+// converted to their base class, so that template argument deduction selects
+// the right implementation.
+template <typename _ValueType>
+_ValueType SampleTrack(const Track<_ValueType>& _track, float _ratio,
+                       int* _cursor) {
+  return Sample(_track, _ratio, _cursor);
+}
+template <typename _ValueType>
+_ValueType SampleTrack(const QuantizedTrack<_ValueType>& _track, float _ratio,
+                       int* _cursor) {
+  return Sample(_track, _ratio, _cursor);
+}
+
+// Finds keyframes to interpolate to sample _track at _ratio, and outputs their
+// values and the interpolation coefficient. Coefficient is 0 if the first
+// keyframe is a step, or the last one of the track. NULL and default tracks
+// output _identity.
+template <typename _Track>
+void FindKeyframes(const _Track* _track, float _ratio, int* _cursor,
+                   const typename _Track::ValueType* _identity,
+                   const typename _Track::ValueType** _k0,
+                   const typename _Track::ValueType** _k1, float* _alpha) {
+  typedef typename _Track::ValueType ValueType;
+  *_alpha = 0.f;
+
+  if (_track == NULL || _track->ratios().count() == 0) {
+    *_k0 = *_k1 = _identity;
+    return;
+  }
+
+  // Deduce keys indices.
+  const Range<const float> ratios = _track->ratios();
+  const Range<const ValueType> values = _track->values();
+  const size_t id1 = FindKey(ratios, _ratio, _cursor);
+  const size_t id0 = id1 - 1;
+  *_k0 = *_k1 = &values[id0];
+
+  const bool id0step = (_track->steps()[id0 / 8] & (1 << (id0 & 7))) != 0;
+  if (id0step || id1 == ratios.count()) {
+    return;
+  }
+  const float tk0 = ratios[id0];
+  const float tk1 = ratios[id1];
+  *_k1 = &values[id1];
+  *_alpha = (_ratio - tk0) / (tk1 - tk0);
+}
+
+// Definition of soa operations policies per track value type.
+template <typename _ValueType>
+struct SoaTrackPolicy;
+
+template <>
+struct SoaTrackPolicy<math::Float3> {
+  static math::SoaFloat3 Load(const math::Float3* const* _v) {
+    const math::SoaFloat3 value = {
+        math::simd_float4::Load(_v[0]->x, _v[1]->x, _v[2]->x, _v[3]->x),
+        math::simd_float4::Load(_v[0]->y, _v[1]->y, _v[2]->y, _v[3]->y),
+        math::simd_float4::Load(_v[0]->z, _v[1]->z, _v[2]->z, _v[3]->z)};
+    return value;
+  }
+  static math::SoaFloat3 Lerp(const math::SoaFloat3& _a,
+                              const math::SoaFloat3& _b,
+                              math::SimdFloat4 _alpha) {
+    return math::Lerp(_a, _b, _alpha);
+  }
+};
+
+template <>
+struct SoaTrackPolicy<math::Quaternion> {
+  static math::SoaQuaternion Load(const math::Quaternion* const* _v) {
+    const math::SoaQuaternion value = {
+        math::simd_float4::Load(_v[0]->x, _v[1]->x, _v[2]->x, _v[3]->x),
+        math::simd_float4::Load(_v[0]->y, _v[1]->y, _v[2]->y, _v[3]->y),
+        math::simd_float4::Load(_v[0]->z, _v[1]->z, _v[2]->z, _v[3]->z),
+        math::simd_float4::Load(_v[0]->w, _v[1]->w, _v[2]->w, _v[3]->w)};
+    return value;
+  }
+  // Uses NLerp, as the AoS TrackPolicy does.
+  static math::SoaQuaternion Lerp(const math::SoaQuaternion& _a,
+                                  const math::SoaQuaternion& _b,
+                                  math::SimdFloat4 _alpha) {
+    return math::NLerp(_a, _b, _alpha);
+  }
+};
+}  // namespace
+
 template <typename _Track>
 TrackSamplingJob<_Track>::TrackSamplingJob()
     : ratio(0.f), track(NULL), result(NULL) {}
@@ -54,42 +251,79 @@ bool TrackSamplingJob<_Track>::Run() const {
     return false;
   }
 
-  // Clamps ratio in range [0,1].
-  const float clamped_ratio = math::Clamp(0.f, ratio, 1.f);
+  *result = SampleTrack(*track, ratio, NULL);
+  return true;
+}
 
-  // Search keyframes to interpolate.
-  const Range<const float> ratios = track->ratios();
-  const Range<const ValueType> values = track->values();
-  assert(ratios.count() == values.count() &&
-         track->steps().count() * 8 >= values.count());
+template <typename _Track>
+TrackBatchSamplingJob<_Track>::TrackBatchSamplingJob() : ratio(0.f) {}
 
-  // Default track returns identity.
-  if (ratios.count() == 0) {
-    *result = internal::TrackPolicy<ValueType>::identity();
-    return true;
+template <typename _Track>
+bool TrackBatchSamplingJob<_Track>::Validate() const {
+  bool success = true;
+  success &= tracks.end >= tracks.begin;
+  success &= results.count() >= tracks.count();
+  if (cursors.begin != NULL) {
+    success &= cursors.count() >= tracks.count();
+  }
+  for (const _Track* const* track = tracks.begin; track < tracks.end;
+       ++track) {
+    success &= *track != NULL;
+  }
+  return success;
+}
+
+template <typename _Track>
+bool TrackBatchSamplingJob<_Track>::Run() const {
+  if (!Validate()) {
+    return false;
+  }
+  for (size_t i = 0; i < tracks.count(); ++i) {
+    results[i] =
+        SampleTrack(*tracks[i], ratio, cursors.begin ? &cursors[i] : NULL);
   }
+  return true;
+}
 
-  // Search for the first key frame with a ratio value greater than input ratio.
-  // Our ratio is between this one and the previous one.
-  const float* ptk1 = std::upper_bound(ratios.begin, ratios.end, clamped_ratio);
+template <typename _Track, typename _SoaValueType>
+TrackSoaSamplingJob<_Track, _SoaValueType>::TrackSoaSamplingJob()
+    : ratio(0.f), result(NULL) {
+  tracks[0] = tracks[1] = tracks[2] = tracks[3] = NULL;
+}
 
-  // Deduce keys indices.
-  const size_t id1 = ptk1 - ratios.begin;
-  const size_t id0 = id1 - 1;
+template <typename _Track, typename _SoaValueType>
+bool TrackSoaSamplingJob<_Track, _SoaValueType>::Validate() const {
+  bool success = true;
+  success &= result != NULL;
+  if (cursors.begin != NULL) {
+    success &= cursors.count() >= 4;
+  }
+  return success;
+}
 
-  const bool id0step = (track->steps()[id0 / 8] & (1 << (id0 & 7))) != 0;
-  if (id0step || ptk1 == ratios.end) {
-    *result = values[id0];
-  } else {
-    // Lerp relevant keys.
-    const float tk0 = ratios[id0];
-    const float tk1 = ratios[id1];
-    assert(clamped_ratio >= tk0 && clamped_ratio < tk1 && tk0 != tk1);
-    const float alpha = (clamped_ratio - tk0) / (tk1 - tk0);
-    const ValueType& vk0 = values[id0];
-    const ValueType& vk1 = values[id1];
-    *result = internal::TrackPolicy<ValueType>::Lerp(vk0, vk1, alpha);
+template <typename _Track, typename _SoaValueType>
+bool TrackSoaSamplingJob<_Track, _SoaValueType>::Run() const {
+  if (!Validate()) {
+    return false;
   }
+
+  // Clamps ratio in range [0,1].
+  const float clamped_ratio = math::Clamp(0.f, ratio, 1.f);
+
+  // Finds keyframes of each track.
+  const ValueType identity = internal::TrackPolicy<ValueType>::identity();
+  const ValueType* k0[4];
+  const ValueType* k1[4];
+  float alpha[4];
+  for (int i = 0; i < 4; ++i) {
+    FindKeyframes(tracks[i], clamped_ratio, cursors.begin ? &cursors[i] : NULL,
+                  &identity, &k0[i], &k1[i], &alpha[i]);
+  }
+
+  // Interpolates the 4 tracks at once.
+  typedef SoaTrackPolicy<ValueType> Policy;
+  *result = Policy::Lerp(Policy::Load(k0), Policy::Load(k1),
+                         math::simd_float4::LoadPtrU(alpha));
   return true;
 }
 
@@ -99,6 +333,75 @@ template struct TrackSamplingJob<Float2Track>;
 template struct TrackSamplingJob<Float3Track>;
 template struct TrackSamplingJob<Float4Track>;
 template struct TrackSamplingJob<QuaternionTrack>;
+template struct TrackBatchSamplingJob<FloatTrack>;
+template struct TrackBatchSamplingJob<Float2Track>;
+template struct TrackBatchSamplingJob<Float3Track>;
+template struct TrackBatchSamplingJob<Float4Track>;
+template struct TrackBatchSamplingJob<QuaternionTrack>;
+template struct TrackSamplingJob<QuantizedFloatTrack>;
+template struct TrackSamplingJob<QuantizedFloat2Track>;
+template struct TrackSamplingJob<QuantizedFloat3Track>;
+template struct TrackSamplingJob<QuantizedFloat4Track>;
+template struct TrackBatchSamplingJob<QuantizedFloatTrack>;
+template struct TrackBatchSamplingJob<QuantizedFloat2Track>;
+template struct TrackBatchSamplingJob<QuantizedFloat3Track>;
+template struct TrackBatchSamplingJob<QuantizedFloat4Track>;
+template struct TrackSoaSamplingJob<Float3Track, math::SoaFloat3>;
+template struct TrackSoaSamplingJob<QuaternionTrack, math::SoaQuaternion>;
 }  // namespace internal
+
+TrackSetSamplingJob::TrackSetSamplingJob()
+    : ratio(0.f), track_set(NULL), cursor(NULL) {}
+
+bool TrackSetSamplingJob::Validate() const {
+  bool success = true;
+  success &= track_set != NULL;
+  if (success) {
+    success &=
+        results.count() >= static_cast<size_t>(track_set->num_channels());
+  }
+  return success;
+}
+
+bool TrackSetSamplingJob::Run() const {
+  if (!Validate()) {
+    return false;
+  }
+
+  const int num_channels = track_set->num_channels();
+  const Range<const float> ratios = track_set->ratios();
+  if (ratios.count() == 0) {
+    return true;  // Nothing to sample.
+  }
+
+  // Clamps ratio in range [0,1].
+  const float clamped_ratio = math::Clamp(0.f, ratio, 1.f);
+
+  // A single lookup serves all channels.
+  const int id1 = internal::FindKey(ratios, clamped_ratio, cursor);
+  const int id0 = id1 - 1;
+
+  const Range<const float> values = track_set->values();
+  const Range<const uint8_t> steps = track_set->steps();
+  const float* vk0 = values.begin + id0 * num_channels;
+  if (id1 == static_cast<int>(ratios.count())) {
+    for (int c = 0; c < num_channels; ++c) {
+      results[c] = vk0[c];
+    }
+    return true;
+  }
+
+  // Lerp relevant keys, unless channel key is a step.
+  const float tk0 = ratios[id0];
+  const float tk1 = ratios[id1];
+  assert(clamped_ratio >= tk0 && clamped_ratio < tk1 && tk0 != tk1);
+  const float alpha = (clamped_ratio - tk0) / (tk1 - tk0);
+  const float* vk1 = vk0 + num_channels;
+  for (int c = 0, s = id0 * num_channels; c < num_channels; ++c, ++s) {
+    const bool step = (steps[s / 8] & (1 << (s & 7))) != 0;
+    results[c] = step ? vk0[c] : math::Lerp(vk0[c], vk1[c], alpha);
+  }
+  return true;
+}
 }  // namespace animation
 }  // namespace ozz
@@ -0,0 +1,152 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#include "ozz/animation/runtime/track_set.h"
+
+#include "ozz/base/io/archive.h"
+#include "ozz/base/log.h"
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/memory/allocator.h"
+
+#include <cassert>
+#include <cstring>
+
+namespace ozz {
+namespace animation {
+
+TrackSet::TrackSet() : num_channels_(0), name_(NULL) {}
+
+TrackSet::~TrackSet() { Deallocate(); }
+
+void TrackSet::Allocate(size_t _keys_count, int _num_channels,
+                        size_t _name_len) {
+  memory::ScopedAllocationTag tag(memory::kTagTrack);
+
+  assert(ratios_.size() == 0 && values_.size() == 0);
+  assert(_num_channels >= 0);
+
+  // Distributes buffer memory while ensuring proper alignment (serves larger
+  // alignment values first).
+  OZZ_STATIC_ASSERT(OZZ_ALIGN_OF(float) >= OZZ_ALIGN_OF(uint8_t));
+
+  // Compute overall size and allocate a single buffer for all the data.
+  const size_t values_count = _keys_count * _num_channels;
+  const size_t buffer_size =
+      values_count * sizeof(float) +              // values
+      _keys_count * sizeof(float) +               // ratios
+      (values_count + 7) * sizeof(uint8_t) / 8 +  // steps
+      (_name_len > 0 ? _name_len + 1 : 0);
+  char* buffer = reinterpret_cast<char*>(
+      memory::default_allocator()->Allocate(buffer_size, OZZ_ALIGN_OF(float)));
+
+  // Fix up pointers. Serves larger alignment values first.
+  values_.begin = reinterpret_cast<float*>(buffer);
+  assert(math::IsAligned(values_.begin, OZZ_ALIGN_OF(float)));
+  buffer += values_count * sizeof(float);
+  values_.end = reinterpret_cast<float*>(buffer);
+
+  ratios_.begin = reinterpret_cast<float*>(buffer);
+  assert(math::IsAligned(ratios_.begin, OZZ_ALIGN_OF(float)));
+  buffer += _keys_count * sizeof(float);
+  ratios_.end = reinterpret_cast<float*>(buffer);
+
+  steps_.begin = reinterpret_cast<uint8_t*>(buffer);
+  buffer += (values_count + 7) * sizeof(uint8_t) / 8;
+  steps_.end = reinterpret_cast<uint8_t*>(buffer);
+
+  num_channels_ = _num_channels;
+
+  // Let name be NULL if track set has no name.
+  name_ = reinterpret_cast<char*>(_name_len > 0 ? buffer : NULL);
+}
+
+void TrackSet::Deallocate() {
+  // Deallocate everything at once.
+  memory::default_allocator()->Deallocate(values_.begin);
+
+  values_.Clear();
+  ratios_.Clear();
+  steps_.Clear();
+  num_channels_ = 0;
+  name_ = NULL;
+}
+
+size_t TrackSet::size() const {
+  const size_t size =
+      sizeof(*this) + values_.size() + ratios_.size() + steps_.size();
+  return size;
+}
+
+void TrackSet::Save(ozz::io::OArchive& _archive) const {
+  uint32_t num_keys = static_cast<uint32_t>(ratios_.count());
+  _archive << num_keys;
+
+  _archive << static_cast<int32_t>(num_channels_);
+
+  const size_t name_len = name_ ? std::strlen(name_) : 0;
+  _archive << static_cast<int32_t>(name_len);
+
+  _archive << ozz::io::MakeArray(ratios_);
+  _archive << ozz::io::MakeArray(values_);
+  _archive << ozz::io::MakeArray(steps_);
+
+  _archive << ozz::io::MakeArray(name_, name_len);
+}
+
+void TrackSet::Load(ozz::io::IArchive& _archive, uint32_t _version) {
+  // Destroy track set in case it was already used before.
+  Deallocate();
+
+  if (_version > 1) {
+    log::Err() << "Unsupported TrackSet version " << _version << "."
+               << std::endl;
+    return;
+  }
+
+  uint32_t num_keys;
+  _archive >> num_keys;
+
+  int32_t num_channels;
+  _archive >> num_channels;
+
+  int32_t name_len;
+  _archive >> name_len;
+
+  Allocate(num_keys, num_channels, name_len);
+
+  _archive >> ozz::io::MakeArray(ratios_);
+  _archive >> ozz::io::MakeArray(values_);
+  _archive >> ozz::io::MakeArray(steps_);
+
+  if (name_) {  // NULL name_ is supported.
+    _archive >> ozz::io::MakeArray(name_, name_len);
+    name_[name_len] = 0;
+  }
+}
+}  // namespace animation
+}  // namespace ozz
@@ -62,27 +62,27 @@ bool TrackTriggeringJob::Run() const {
 
 namespace {
 inline bool DetectEdge(ptrdiff_t _i0, ptrdiff_t _i1, bool _forward,
-                       const TrackTriggeringJob& _job,
+                       const FloatTrack& _track, float _threshold,
                        TrackTriggeringJob::Edge* _edge) {
-  const Range<const float>& values = _job.track->values();
+  const Range<const float>& values = _track.values();
 
   const float vk0 = values[_i0];
   const float vk1 = values[_i1];
 
   bool detected = false;
-  if (vk0 <= _job.threshold && vk1 > _job.threshold) {
+  if (vk0 <= _threshold && vk1 > _threshold) {
     // Rising edge
     _edge->rising = _forward;
     detected = true;
-  } else if (vk0 > _job.threshold && vk1 <= _job.threshold) {
+  } else if (vk0 > _threshold && vk1 <= _threshold) {
     // Falling edge
     _edge->rising = !_forward;
     detected = true;
   }
 
   if (detected) {
-    const Range<const float>& ratios = _job.track->ratios();
-    const Range<const uint8_t>& steps = _job.track->steps();
+    const Range<const float>& ratios = _track.ratios();
+    const Range<const uint8_t>& steps = _track.steps();
 
     const bool step = (steps[_i0 / 8] & (1 << (_i0 & 7))) != 0;
     if (step) {
@@ -96,7 +96,7 @@ inline bool DetectEdge(ptrdiff_t _i0, ptrdiff_t _i1, bool _forward,
         // Finds where the curve crosses threshold value.
         // This is the lerp equation, where we know the result and look for
         // alpha, aka un-lerp.
-        const float alpha = (_job.threshold - vk0) / (vk1 - vk0);
+        const float alpha = (_threshold - vk0) / (vk1 - vk0);
 
         // Remaps to keyframes actual times.
         const float tk0 = ratios[_i0];
@@ -107,13 +107,58 @@ inline bool DetectEdge(ptrdiff_t _i0, ptrdiff_t _i1, bool _forward,
   }
   return detected;
 }
+
+// Compares edge ratio, in _outer loop, to a global _ratio. Ratios are compared
+// in global space, as the iterator does, to get the same floating point
+// results.
+struct EdgeBefore {
+  explicit EdgeBefore(float _outer) : outer(_outer) {}
+  bool operator()(const TrackTriggeringJob::Edge& _edge, float _ratio) const {
+    return _edge.ratio + outer < _ratio;
+  }
+  float outer;
+};
 }  // namespace
 
+int ComputeTrackEdges(const FloatTrack& _track, float _threshold,
+                      const Range<TrackTriggeringJob::Edge>& _edges) {
+  const ptrdiff_t num_keys = _track.ratios().count();
+  if (_edges.count() < static_cast<size_t>(num_keys)) {
+    return -1;
+  }
+
+  // Detects edges in the same order as a forward iterator does.
+  int count = 0;
+  for (ptrdiff_t i1 = 0; i1 < num_keys; ++i1) {
+    const ptrdiff_t i0 = i1 == 0 ? num_keys - 1 : i1 - 1;
+    if (DetectEdge(i0, i1, true, _track, _threshold, &_edges[count])) {
+      ++count;
+    }
+  }
+  return count;
+}
+
 TrackTriggeringJob::Iterator::Iterator(const TrackTriggeringJob* _job)
     : job_(_job) {
   // Outer loop initialization.
   outer_ = floorf(job_->from);
 
+  // With an edge index, binary searches the first edge of the first loop.
+  const Range<const Edge>& edges = job_->edges;
+  if (edges.begin != NULL) {
+    const ptrdiff_t first =
+        std::lower_bound(edges.begin, edges.end, job_->from,
+                         EdgeBefore(outer_)) -
+        edges.begin;
+    if (job_->from < job_->to) {
+      inner_ = first;
+    } else {
+      inner_ = job_->from >= 1.f + outer_ ? edges.count() - 1 : first - 1;
+    }
+    ++*this;
+    return;
+  }
+
   // Search could start more closely to the "from" ratio, but it's not possible
   // to ensure that floating point precision will not lead to missing a key
   // (when from/to range is far from 0). This is less good in algorithmic
@@ -129,6 +174,10 @@ TrackTriggeringJob::Iterator::Iterator(const TrackTriggeringJob* _job)
 const TrackTriggeringJob::Iterator& TrackTriggeringJob::Iterator::operator++() {
   assert(*this != job_->end() && "Can't increment end iterator.");
 
+  if (job_->edges.begin != NULL) {
+    return IncrementIndexed();
+  }
+
   const Range<const float>& ratios = job_->track->ratios();
   const ptrdiff_t num_keys = ratios.count();
 
@@ -136,7 +185,8 @@ const TrackTriggeringJob::Iterator& TrackTriggeringJob::Iterator::operator++() {
     for (; outer_ < job_->to; outer_ += 1.f) {
       for (; inner_ < num_keys; ++inner_) {
         const ptrdiff_t i0 = inner_ == 0 ? num_keys - 1 : inner_ - 1;
-        if (DetectEdge(i0, inner_, true, *job_, &edge_)) {
+        if (DetectEdge(i0, inner_, true, *job_->track, job_->threshold,
+                       &edge_)) {
           edge_.ratio += outer_;  // Convert to global ratio space.
           if (edge_.ratio >= job_->from &&
               (edge_.ratio < job_->to || job_->to >= 1.f + outer_)) {
@@ -155,7 +205,8 @@ const TrackTriggeringJob::Iterator& TrackTriggeringJob::Iterator::operator++() {
     for (; outer_ + 1.f > job_->to; outer_ -= 1.f) {
       for (; inner_ >= 0; --inner_) {
         const ptrdiff_t i0 = inner_ == 0 ? num_keys - 1 : inner_ - 1;
-        if (DetectEdge(i0, inner_, false, *job_, &edge_)) {
+        if (DetectEdge(i0, inner_, false, *job_->track, job_->threshold,
+                       &edge_)) {
           edge_.ratio += outer_;  // Convert to global ratio space.
           if (edge_.ratio >= job_->to &&
               (edge_.ratio < job_->from || job_->from >= 1.f + outer_)) {
@@ -177,5 +228,102 @@ const TrackTriggeringJob::Iterator& TrackTriggeringJob::Iterator::operator++() {
 
   return *this;
 }
+
+const TrackTriggeringJob::Iterator&
+TrackTriggeringJob::Iterator::IncrementIndexed() {
+  // Edges are sorted by ratio, so the first edge that's out of range ends the
+  // iteration. Loops in between are all entirely in range, and only need to
+  // offset edges ratio.
+  const Range<const Edge>& edges = job_->edges;
+  const ptrdiff_t num_edges = edges.count();
+  if (num_edges != 0) {
+    if (job_->to > job_->from) {
+      for (; outer_ < job_->to; outer_ += 1.f, inner_ = 0) {
+        if (inner_ < num_edges) {
+          const Edge& edge = edges[inner_];
+          const float ratio = edge.ratio + outer_;
+          if (ratio < job_->to || job_->to >= 1.f + outer_) {
+            edge_.ratio = ratio;
+            edge_.rising = edge.rising;
+            ++inner_;
+            return *this;  // Yield found edge.
+          }
+          break;  // Won't find any further edge.
+        }
+      }
+    } else {
+      for (; outer_ + 1.f > job_->to; outer_ -= 1.f, inner_ = num_edges - 1) {
+        if (inner_ >= 0) {
+          const Edge& edge = edges[inner_];
+          const float ratio = edge.ratio + outer_;
+          if (ratio >= job_->to) {
+            edge_.ratio = ratio;
+            edge_.rising = !edge.rising;
+            --inner_;
+            return *this;  // Yield found edge.
+          }
+          break;  // Won't find any further edge.
+        }
+      }
+    }
+  }
+
+  // Set iterator to end position.
+  *this = job_->end();
+
+  return *this;
+}
+
+TrackBatchTriggeringJob::TrackBatchTriggeringJob() : num_events(NULL) {}
+
+bool TrackBatchTriggeringJob::Validate() const {
+  bool valid = true;
+  valid &= num_events != NULL;
+  valid &= queries.end >= queries.begin;
+  for (const Query* query = queries.begin; query < queries.end; ++query) {
+    valid &= query->track != NULL;
+  }
+  return valid;
+}
+
+bool TrackBatchTriggeringJob::Run() const {
+  if (!Validate()) {
+    return false;
+  }
+
+  size_t count = 0;
+  const size_t capacity = events.count();
+  bool fit = true;
+  for (size_t q = 0; q < queries.count() && fit; ++q) {
+    const Query& query = queries[q];
+
+    TrackTriggeringJob job;
+    job.track = query.track;
+    job.from = query.from;
+    job.to = query.to;
+    job.threshold = query.threshold;
+    job.edges = query.edges;
+    TrackTriggeringJob::Iterator iterator;
+    job.iterator = &iterator;
+    if (!job.Run()) {
+      return false;
+    }
+
+    for (const TrackTriggeringJob::Iterator end = job.end(); iterator != end;
+         ++iterator) {
+      if (count == capacity) {
+        fit = false;
+        break;
+      }
+      Event& event = events[count++];
+      event.query = static_cast<int>(q);
+      event.ratio = iterator->ratio;
+      event.rising = iterator->rising;
+    }
+  }
+  *num_events = count;
+
+  return fit;
+}
 }  // namespace animation
 }  // namespace ozz
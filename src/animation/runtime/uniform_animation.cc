@@ -0,0 +1,140 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/uniform_animation.h"
+
+#include <cassert>
+#include <cstring>
+
+#include "ozz/base/io/archive.h"
+#include "ozz/base/log.h"
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/soa_math_archive.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/allocator.h"
+
+namespace ozz {
+namespace animation {
+
+UniformAnimation::UniformAnimation()
+    : duration_(0.f), num_tracks_(0), num_frames_(0), name_(NULL) {}
+
+UniformAnimation::~UniformAnimation() { Deallocate(); }
+
+void UniformAnimation::Allocate(size_t _name_len, int _num_tracks,
+                                int _num_frames) {
+  assert(name_ == NULL && frames_.begin == NULL);
+
+  // Distributes buffer memory while ensuring proper alignment (serves larger
+  // alignment values first).
+  OZZ_STATIC_ASSERT(OZZ_ALIGN_OF(math::SoaTransform) >= OZZ_ALIGN_OF(char));
+
+  num_tracks_ = _num_tracks;
+  num_frames_ = _num_frames;
+  const size_t frame_count =
+      static_cast<size_t>(num_soa_tracks()) * static_cast<size_t>(_num_frames);
+
+  // Compute overall size and allocate a single buffer for all the data.
+  const size_t buffer_size = frame_count * sizeof(math::SoaTransform) +
+                             (_name_len > 0 ? _name_len + 1 : 0);
+  char* buffer = reinterpret_cast<char*>(memory::default_allocator()->Allocate(
+      buffer_size, OZZ_ALIGN_OF(math::SoaTransform)));
+
+  // Fix up pointers. Serves larger alignment values first.
+  frames_.begin = reinterpret_cast<math::SoaTransform*>(buffer);
+  assert(math::IsAligned(frames_.begin, OZZ_ALIGN_OF(math::SoaTransform)));
+  buffer += frame_count * sizeof(math::SoaTransform);
+  frames_.end = reinterpret_cast<math::SoaTransform*>(buffer);
+
+  // Let name be NULL if animation has no name. Allows to avoid allocating this
+  // buffer in the constructor of empty animations.
+  name_ = _name_len > 0 ? buffer : NULL;
+}
+
+void UniformAnimation::Deallocate() {
+  // Deallocate everything at once.
+  memory::default_allocator()->Deallocate(frames_.begin);
+
+  frames_.Clear();
+  name_ = NULL;
+  num_tracks_ = 0;
+  num_frames_ = 0;
+}
+
+const math::SoaTransform* UniformAnimation::frame(int _frame) const {
+  assert(_frame >= 0 && _frame < num_frames_);
+  return frames_.begin + _frame * num_soa_tracks();
+}
+
+size_t UniformAnimation::size() const {
+  const size_t size = sizeof(*this) + frames_.size();
+  return size;
+}
+
+void UniformAnimation::Save(ozz::io::OArchive& _archive) const {
+  _archive << duration_;
+  _archive << static_cast<int32_t>(num_tracks_);
+  _archive << static_cast<int32_t>(num_frames_);
+
+  const size_t name_len = name_ ? std::strlen(name_) : 0;
+  _archive << static_cast<int32_t>(name_len);
+  _archive << ozz::io::MakeArray(name_, name_len);
+
+  _archive << ozz::io::MakeArray(frames_);
+}
+
+void UniformAnimation::Load(ozz::io::IArchive& _archive, uint32_t _version) {
+  // Destroy animation in case it was already used before.
+  Deallocate();
+  duration_ = 0.f;
+
+  if (_version != 1) {
+    log::Err() << "Unsupported UniformAnimation version " << _version << "."
+               << std::endl;
+    return;
+  }
+
+  _archive >> duration_;
+
+  int32_t num_tracks;
+  _archive >> num_tracks;
+  int32_t num_frames;
+  _archive >> num_frames;
+  int32_t name_len;
+  _archive >> name_len;
+
+  Allocate(name_len, num_tracks, num_frames);
+
+  if (name_) {  // NULL name_ is supported.
+    _archive >> ozz::io::MakeArray(name_, name_len);
+    name_[name_len] = 0;
+  }
+
+  _archive >> ozz::io::MakeArray(frames_);
+}
+}  // namespace animation
+}  // namespace ozz
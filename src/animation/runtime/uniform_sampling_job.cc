@@ -0,0 +1,93 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/uniform_sampling_job.h"
+
+#include <cassert>
+
+#include "ozz/animation/runtime/uniform_animation.h"
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/soa_transform.h"
+
+namespace ozz {
+namespace animation {
+
+UniformSamplingJob::UniformSamplingJob() : ratio(0.f), animation(NULL) {}
+
+bool UniformSamplingJob::Validate() const {
+  // Don't stop validation on the first failure, in order to make it easier
+  // to debug.
+  bool success = true;
+
+  // Test for NULL pointers.
+  if (!animation) {
+    return false;
+  }
+  success &= output.begin != NULL;
+
+  // Tests output range, output data are not tested.
+  const ptrdiff_t num_soa_tracks = animation->num_soa_tracks();
+  success &= output.end - output.begin >= num_soa_tracks;
+
+  return success;
+}
+
+bool UniformSamplingJob::Run() const {
+  if (!Validate()) {
+    return false;
+  }
+
+  const int num_soa_tracks = animation->num_soa_tracks();
+  const int num_frames = animation->num_frames();
+  if (num_soa_tracks == 0 || num_frames == 0) {  // Early out if no track.
+    return true;
+  }
+
+  // Finds the 2 frames surrounding ratio, and the interpolation factor between
+  // them.
+  const float anim_ratio = math::Clamp(0.f, ratio, 1.f);
+  const float frame_ratio = anim_ratio * (num_frames - 1);
+  const int left = math::Min(static_cast<int>(frame_ratio),
+                             math::Max(num_frames - 2, 0));
+  const int right = math::Min(left + 1, num_frames - 1);
+  const math::SimdFloat4 alpha =
+      math::simd_float4::Load1(frame_ratio - static_cast<float>(left));
+
+  const math::SoaTransform* lefts = animation->frame(left);
+  const math::SoaTransform* rights = animation->frame(right);
+  for (int i = 0; i < num_soa_tracks; ++i) {
+    math::SoaTransform& transform = output.begin[i];
+    transform.translation =
+        Lerp(lefts[i].translation, rights[i].translation, alpha);
+    transform.rotation = NLerpEst(lefts[i].rotation, rights[i].rotation, alpha);
+    transform.scale = Lerp(lefts[i].scale, rights[i].scale, alpha);
+  }
+
+  return true;
+}
+}  // namespace animation
+}  // namespace ozz
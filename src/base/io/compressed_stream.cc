@@ -0,0 +1,526 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/base/io/compressed_stream.h"
+
+#include <cassert>
+#include <cstring>
+
+#include "ozz/base/memory/allocator.h"
+
+namespace ozz {
+namespace io {
+
+namespace {
+// Frame magic number.
+const char kLZMagic[4] = {'O', 'Z', 'L', 'Z'};
+
+// Size of frame and block headers.
+const size_t kLZHeaderSize = 8;
+
+// Flags a block stored uncompressed.
+const uint32_t kStoredRaw = 0x80000000u;
+
+// Compression format constants, compatible with LZ4 block format.
+const size_t kLZMinMatch = 4;
+const size_t kLZLastLiterals = 5;  // Last bytes are always literals.
+const size_t kLZMatchLimit = 12;   // Last match starts before that limit.
+const size_t kLZMaxOffset = 65535;
+const int kLZHashLog = 12;
+
+void StoreLE32(uint32_t _value, unsigned char* _dest) {
+  _dest[0] = static_cast<unsigned char>(_value);
+  _dest[1] = static_cast<unsigned char>(_value >> 8);
+  _dest[2] = static_cast<unsigned char>(_value >> 16);
+  _dest[3] = static_cast<unsigned char>(_value >> 24);
+}
+
+uint32_t LoadLE32(const unsigned char* _src) {
+  return static_cast<uint32_t>(_src[0]) |
+         (static_cast<uint32_t>(_src[1]) << 8) |
+         (static_cast<uint32_t>(_src[2]) << 16) |
+         (static_cast<uint32_t>(_src[3]) << 24);
+}
+
+uint32_t LZRead32(const unsigned char* _src) {
+  uint32_t value;
+  std::memcpy(&value, _src, sizeof(value));
+  return value;
+}
+
+uint32_t LZHash(uint32_t _sequence) {
+  return (_sequence * 2654435761u) >> (32 - kLZHashLog);
+}
+
+// Writes the extension bytes of a length that doesn't fit in the token.
+bool LZWriteLength(size_t _length, unsigned char** _op,
+                   const unsigned char* _oend) {
+  for (; _length >= 255; _length -= 255) {
+    if (*_op >= _oend) {
+      return false;
+    }
+    *(*_op)++ = 255;
+  }
+  if (*_op >= _oend) {
+    return false;
+  }
+  *(*_op)++ = static_cast<unsigned char>(_length);
+  return true;
+}
+
+// Reads the extension bytes of a length.
+bool LZReadLength(size_t* _length, const unsigned char** _ip,
+                  const unsigned char* _iend) {
+  unsigned char byte;
+  do {
+    if (*_ip >= _iend) {
+      return false;
+    }
+    byte = *(*_ip)++;
+    *_length += byte;
+  } while (byte == 255);
+  return true;
+}
+
+// Writes a sequence of _literals, followed by a match of _match_length bytes at
+// _offset, unless _match_length is 0 (last sequence).
+bool LZWriteSequence(const unsigned char* _literals, size_t _literals_length,
+                     size_t _offset, size_t _match_length, unsigned char** _op,
+                     const unsigned char* _oend) {
+  if (*_op >= _oend) {
+    return false;
+  }
+  unsigned char* token = (*_op)++;
+  *token = static_cast<unsigned char>(
+      (_literals_length >= 15 ? 15 : _literals_length) << 4);
+  if (_literals_length >= 15 &&
+      !LZWriteLength(_literals_length - 15, _op, _oend)) {
+    return false;
+  }
+  if (static_cast<size_t>(_oend - *_op) < _literals_length) {
+    return false;
+  }
+  std::memcpy(*_op, _literals, _literals_length);
+  *_op += _literals_length;
+
+  if (_match_length == 0) {
+    return true;
+  }
+  if (_oend - *_op < 2) {
+    return false;
+  }
+  *(*_op)++ = static_cast<unsigned char>(_offset);
+  *(*_op)++ = static_cast<unsigned char>(_offset >> 8);
+  const size_t length = _match_length - kLZMinMatch;
+  *token |= static_cast<unsigned char>(length >= 15 ? 15 : length);
+  return length < 15 || LZWriteLength(length - 15, _op, _oend);
+}
+}  // namespace
+
+size_t CompressedStream::CompressBound(size_t _size) {
+  return _size + _size / 255 + 16;
+}
+
+size_t CompressedStream::CompressBlock(const void* _src, size_t _src_size,
+                                       void* _dest, size_t _dest_size) {
+  const unsigned char* in = static_cast<const unsigned char*>(_src);
+  unsigned char* out = static_cast<unsigned char*>(_dest);
+  unsigned char* op = out;
+  const unsigned char* oend = out + _dest_size;
+
+  // Positions (+1, so 0 means empty) of the last occurrence of each hashed
+  // 4 bytes sequence.
+  size_t table[1 << kLZHashLog];
+  std::memset(table, 0, sizeof(table));
+
+  size_t anchor = 0;
+  if (_src_size > kLZMatchLimit) {
+    const size_t match_end = _src_size - kLZLastLiterals;
+    for (size_t ip = 0; ip + kLZMatchLimit <= _src_size;) {
+      const uint32_t sequence = LZRead32(in + ip);
+      const uint32_t hash = LZHash(sequence);
+      const size_t candidate = table[hash];
+      table[hash] = ip + 1;
+      if (candidate == 0 || ip - (candidate - 1) > kLZMaxOffset ||
+          LZRead32(in + candidate - 1) != sequence) {
+        // Accelerates over incompressible data.
+        ip += 1 + ((ip - anchor) >> 6);
+        continue;
+      }
+      const size_t match = candidate - 1;
+      size_t length = kLZMinMatch;
+      while (ip + length < match_end && in[match + length] == in[ip + length]) {
+        ++length;
+      }
+      if (!LZWriteSequence(in + anchor, ip - anchor, ip - match, length, &op,
+                           oend)) {
+        return 0;
+      }
+      ip += length;
+      anchor = ip;
+    }
+  }
+  if (!LZWriteSequence(in + anchor, _src_size - anchor, 0, 0, &op, oend)) {
+    return 0;
+  }
+  return static_cast<size_t>(op - out);
+}
+
+bool CompressedStream::DecompressBlock(const void* _src, size_t _src_size,
+                                       void* _dest, size_t _dest_size) {
+  const unsigned char* ip = static_cast<const unsigned char*>(_src);
+  const unsigned char* iend = ip + _src_size;
+  unsigned char* out = static_cast<unsigned char*>(_dest);
+  unsigned char* op = out;
+  const unsigned char* oend = out + _dest_size;
+  for (;;) {
+    if (ip >= iend) {
+      return false;
+    }
+    const unsigned int token = *ip++;
+
+    // Literals.
+    size_t literals = token >> 4;
+    if (literals == 15 && !LZReadLength(&literals, &ip, iend)) {
+      return false;
+    }
+    if (literals > static_cast<size_t>(iend - ip) ||
+        literals > static_cast<size_t>(oend - op)) {
+      return false;
+    }
+    std::memcpy(op, ip, literals);
+    op += literals;
+    ip += literals;
+
+    // Last sequence has no match.
+    if (ip == iend) {
+      break;
+    }
+
+    // Match.
+    if (iend - ip < 2) {
+      return false;
+    }
+    const size_t offset = static_cast<size_t>(ip[0]) |
+                          (static_cast<size_t>(ip[1]) << 8);
+    ip += 2;
+    if (offset == 0 || offset > static_cast<size_t>(op - out)) {
+      return false;
+    }
+    size_t length = token & 15;
+    if (length == 15 && !LZReadLength(&length, &ip, iend)) {
+      return false;
+    }
+    length += kLZMinMatch;
+    if (length > static_cast<size_t>(oend - op)) {
+      return false;
+    }
+    const unsigned char* match = op - offset;
+    if (offset >= length) {
+      std::memcpy(op, match, length);
+    } else {
+      // Overlapping match repeats the last offset bytes.
+      for (size_t i = 0; i < length; ++i) {
+        op[i] = match[i];
+      }
+    }
+    op += length;
+  }
+  return op == oend;
+}
+
+bool CompressedStream::IsCompressed(Stream* _stream) {
+  if (!_stream || !_stream->opened()) {
+    return false;
+  }
+  const int64_t tell = _stream->Tell();
+  char magic[sizeof(kLZMagic)];
+  const bool read = _stream->Read(magic, sizeof(magic)) == sizeof(magic);
+  _stream->Seek(tell, Stream::kSet);
+  return read && std::memcmp(magic, kLZMagic, sizeof(magic)) == 0;
+}
+
+CompressedStream::CompressedStream(Stream* _stream, Mode _mode,
+                                   int _block_size)
+    : stream_(_stream),
+      mode_(_mode),
+      block_size_(0),
+      valid_(false),
+      raw_(NULL),
+      packed_(NULL),
+      pending_(0),
+      current_(-1),
+      tell_(0),
+      size_(0) {
+  if (!stream_ || !stream_->opened()) {
+    return;
+  }
+  if (mode_ == kCompress) {
+    block_size_ = static_cast<size_t>(
+        _block_size < 1 ? 1
+                        : _block_size > kMaxBlockSize ? kMaxBlockSize
+                                                      : _block_size);
+    unsigned char header[kLZHeaderSize];
+    std::memcpy(header, kLZMagic, sizeof(kLZMagic));
+    StoreLE32(static_cast<uint32_t>(block_size_), header + 4);
+    if (stream_->Write(header, sizeof(header)) != sizeof(header)) {
+      return;
+    }
+  } else if (!OpenFrame()) {
+    return;
+  }
+
+  memory::Allocator* allocator = memory::default_allocator();
+  raw_ = static_cast<char*>(allocator->Allocate(block_size_, 16));
+  packed_ = static_cast<char*>(
+      allocator->Allocate(CompressBound(block_size_), 16));
+  valid_ = raw_ && packed_;
+}
+
+CompressedStream::~CompressedStream() {
+  Close();
+  memory::Allocator* allocator = memory::default_allocator();
+  allocator->Deallocate(raw_);
+  allocator->Deallocate(packed_);
+}
+
+bool CompressedStream::OpenFrame() {
+  unsigned char header[kLZHeaderSize];
+  if (stream_->Read(header, sizeof(header)) != sizeof(header) ||
+      std::memcmp(header, kLZMagic, sizeof(kLZMagic)) != 0) {
+    return false;
+  }
+  const uint32_t block_size = LoadLE32(header + 4);
+  if (block_size < 1 || block_size > kMaxBlockSize) {
+    return false;
+  }
+  block_size_ = block_size;
+
+  // Reads blocks headers, skipping their data.
+  uint64_t position = 0;
+  for (;;) {
+    if (stream_->Read(header, sizeof(header)) != sizeof(header)) {
+      return false;
+    }
+    Block block;
+    block.size = LoadLE32(header);
+    block.stored = LoadLE32(header + 4);
+    if (block.size == 0) {
+      // End of frame.
+      if (block.stored != 0) {
+        return false;
+      }
+      break;
+    }
+    const uint32_t stored = block.stored & ~kStoredRaw;
+    const bool valid =
+        block.size <= block_size_ &&
+        ((block.stored & kStoredRaw) ? stored == block.size
+                                     : stored != 0 &&
+                                           stored <= CompressBound(block.size));
+    if (!valid) {
+      return false;
+    }
+    block.offset = stream_->Tell();
+    block.position = position;
+    if (stream_->Seek(stored, Stream::kCurrent) != 0) {
+      return false;
+    }
+    blocks_.push_back(block);
+    position += block.size;
+  }
+  size_ = position;
+  return true;
+}
+
+bool CompressedStream::Close() {
+  bool success = valid_;
+  if (valid_ && mode_ == kCompress) {
+    const unsigned char end[kLZHeaderSize] = {0};
+    success = FlushBlock() && stream_->Write(end, sizeof(end)) == sizeof(end);
+  }
+  valid_ = false;
+  return success;
+}
+
+bool CompressedStream::opened() const { return valid_; }
+
+bool CompressedStream::FlushBlock() {
+  if (pending_ == 0) {
+    return true;
+  }
+  const size_t packed =
+      CompressBlock(raw_, pending_, packed_, CompressBound(pending_));
+
+  // Stores raw data if compression doesn't save anything.
+  const bool raw = packed == 0 || packed >= pending_;
+  const char* data = raw ? raw_ : packed_;
+  const size_t size = raw ? pending_ : packed;
+
+  unsigned char header[kLZHeaderSize];
+  StoreLE32(static_cast<uint32_t>(pending_), header);
+  StoreLE32(static_cast<uint32_t>(size) | (raw ? kStoredRaw : 0), header + 4);
+  pending_ = 0;
+  if (stream_->Write(header, sizeof(header)) != sizeof(header) ||
+      stream_->Write(data, size) != size) {
+    valid_ = false;
+    return false;
+  }
+  return true;
+}
+
+int CompressedStream::FindBlock(uint64_t _position) const {
+  // Sequential reading usually hits current or next block.
+  const int num_blocks = static_cast<int>(blocks_.size());
+  for (int i = current_; i >= 0 && i < num_blocks && i <= current_ + 1; ++i) {
+    const Block& block = blocks_[i];
+    if (_position >= block.position &&
+        _position < block.position + block.size) {
+      return i;
+    }
+  }
+  // Binary searches the last block starting before _position.
+  int first = 0;
+  int last = num_blocks;
+  while (last - first > 1) {
+    const int mid = first + (last - first) / 2;
+    if (blocks_[mid].position <= _position) {
+      first = mid;
+    } else {
+      last = mid;
+    }
+  }
+  return first;
+}
+
+bool CompressedStream::LoadBlock(int _index) {
+  if (_index == current_) {
+    return true;
+  }
+  current_ = -1;
+  const Block& block = blocks_[_index];
+  if (stream_->Seek(block.offset, Stream::kSet) != 0) {
+    return false;
+  }
+  if (block.stored & kStoredRaw) {
+    if (stream_->Read(raw_, block.size) != block.size) {
+      return false;
+    }
+  } else {
+    const size_t stored = block.stored;
+    if (stream_->Read(packed_, stored) != stored ||
+        !DecompressBlock(packed_, stored, raw_, block.size)) {
+      return false;
+    }
+  }
+  current_ = _index;
+  return true;
+}
+
+size_t CompressedStream::Read(void* _buffer, size_t _size) {
+  if (!valid_ || mode_ != kDecompress) {
+    return 0;
+  }
+  char* buffer = static_cast<char*>(_buffer);
+  size_t read = 0;
+  while (read < _size && tell_ < size_) {
+    const int index = FindBlock(tell_);
+    if (!LoadBlock(index)) {
+      break;
+    }
+    const Block& block = blocks_[index];
+    const size_t in_block = static_cast<size_t>(tell_ - block.position);
+    size_t count = block.size - in_block;
+    if (count > _size - read) {
+      count = _size - read;
+    }
+    std::memcpy(buffer + read, raw_ + in_block, count);
+    read += count;
+    tell_ += count;
+  }
+  return read;
+}
+
+size_t CompressedStream::Write(const void* _buffer, size_t _size) {
+  if (!valid_ || mode_ != kCompress) {
+    return 0;
+  }
+  const char* buffer = static_cast<const char*>(_buffer);
+  size_t written = 0;
+  while (written < _size) {
+    size_t count = block_size_ - pending_;
+    if (count > _size - written) {
+      count = _size - written;
+    }
+    std::memcpy(raw_ + pending_, buffer + written, count);
+    pending_ += count;
+    if (pending_ == block_size_ && !FlushBlock()) {
+      break;
+    }
+    written += count;
+  }
+  tell_ += written;
+  size_ = tell_;
+  return written;
+}
+
+int CompressedStream::Seek(int64_t _offset, Origin _origin) {
+  if (!valid_) {
+    return -1;
+  }
+  int64_t origin;
+  switch (_origin) {
+    case kCurrent:
+      origin = static_cast<int64_t>(tell_);
+      break;
+    case kEnd:
+      origin = static_cast<int64_t>(size_);
+      break;
+    case kSet:
+      origin = 0;
+      break;
+    default:
+      return -1;
+  }
+  const int64_t target = origin + _offset;
+  if (target < 0 || static_cast<uint64_t>(target) > size_) {
+    return -1;
+  }
+  if (mode_ == kCompress && static_cast<uint64_t>(target) != tell_) {
+    return -1;
+  }
+  tell_ = static_cast<uint64_t>(target);
+  return 0;
+}
+
+int64_t CompressedStream::Tell() const {
+  return valid_ ? static_cast<int64_t>(tell_) : -1;
+}
+
+uint64_t CompressedStream::Size() const { return size_; }
+}  // namespace io
+}  // namespace ozz
@@ -0,0 +1,181 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/base/io/mapped_file.h"
+
+#include <cassert>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif  // NOMINMAX
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif  // WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#define OZZ_MAPPED_FILE_WIN32
+#elif (defined(__unix__) || defined(__APPLE__)) && !defined(__EMSCRIPTEN__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define OZZ_MAPPED_FILE_MMAP
+#endif
+
+#include "ozz/base/memory/allocator.h"
+
+namespace ozz {
+namespace io {
+
+namespace {
+// Maps _filename content, returns NULL on failure or if file is empty.
+const void* MapFileContent(const char* _filename, size_t* _size) {
+  *_size = 0;
+#if defined(OZZ_MAPPED_FILE_WIN32)
+  HANDLE file = CreateFileA(_filename, GENERIC_READ, FILE_SHARE_READ, NULL,
+                            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (file == INVALID_HANDLE_VALUE) {
+    return NULL;
+  }
+  const void* data = NULL;
+  LARGE_INTEGER size;
+  if (GetFileSizeEx(file, &size) && size.QuadPart > 0) {
+    // The mapping object is kept alive by the view, so handles can be closed.
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mapping) {
+      data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+      CloseHandle(mapping);
+    }
+    if (data) {
+      *_size = static_cast<size_t>(size.QuadPart);
+    }
+  }
+  CloseHandle(file);
+  return data;
+#elif defined(OZZ_MAPPED_FILE_MMAP)
+  const int fd = open(_filename, O_RDONLY);
+  if (fd < 0) {
+    return NULL;
+  }
+  const void* data = NULL;
+  struct stat st;
+  if (fstat(fd, &st) == 0 && st.st_size > 0) {
+    // The mapping stays valid once the descriptor is closed.
+    void* pages = mmap(NULL, static_cast<size_t>(st.st_size), PROT_READ,
+                       MAP_SHARED, fd, 0);
+    if (pages != MAP_FAILED) {
+      data = pages;
+      *_size = static_cast<size_t>(st.st_size);
+    }
+  }
+  close(fd);
+  return data;
+#else   // No file mapping support.
+  (void)_filename;
+  return NULL;
+#endif
+}
+
+void UnmapFileContent(const void* _data, size_t _size) {
+#if defined(OZZ_MAPPED_FILE_WIN32)
+  (void)_size;
+  UnmapViewOfFile(_data);
+#elif defined(OZZ_MAPPED_FILE_MMAP)
+  munmap(const_cast<void*>(_data), _size);
+#else   // No file mapping support.
+  (void)_data;
+  (void)_size;
+  assert(false && "File mapping isn't supported.");
+#endif
+}
+
+// Reads _filename content to a buffer allocated from the default allocator,
+// aligned for flat representations.
+const void* ReadFileContent(const char* _filename, size_t* _size) {
+  *_size = 0;
+  File file(_filename, "rb");
+  if (!file.opened() || file.Size() == 0 ||
+      file.Size() > static_cast<size_t>(-1)) {
+    return NULL;
+  }
+  const size_t size = static_cast<size_t>(file.Size());
+  void* data = memory::default_allocator()->Allocate(size, 16);
+  if (file.Read(data, size) != size) {
+    memory::default_allocator()->Deallocate(data);
+    return NULL;
+  }
+  *_size = size;
+  return data;
+}
+}  // namespace
+
+MappedFile::MappedFile(const char* _filename)
+    : data_(NULL), size_(0), mapped_(false) {
+  data_ = MapFileContent(_filename, &size_);
+  mapped_ = data_ != NULL;
+  if (!mapped_) {
+    data_ = ReadFileContent(_filename, &size_);
+  }
+}
+
+MappedFile::~MappedFile() { Close(); }
+
+void MappedFile::Close() {
+  if (mapped_) {
+    UnmapFileContent(data_, size_);
+  } else {
+    memory::default_allocator()->Deallocate(const_cast<void*>(data_));
+  }
+  data_ = NULL;
+  size_ = 0;
+  mapped_ = false;
+}
+
+MappedFileStream::MappedFileStream(const char* _filename)
+    : file_(_filename), stream_(file_.data(), file_.size()) {}
+
+MappedFileStream::~MappedFileStream() {}
+
+bool MappedFileStream::opened() const { return stream_.opened(); }
+
+size_t MappedFileStream::Read(void* _buffer, size_t _size) {
+  return stream_.Read(_buffer, _size);
+}
+
+size_t MappedFileStream::Write(const void* _buffer, size_t _size) {
+  return stream_.Write(_buffer, _size);
+}
+
+int MappedFileStream::Seek(int64_t _offset, Origin _origin) {
+  return stream_.Seek(_offset, _origin);
+}
+
+int64_t MappedFileStream::Tell() const { return stream_.Tell(); }
+
+uint64_t MappedFileStream::Size() const { return stream_.Size(); }
+}  // namespace io
+}  // namespace ozz
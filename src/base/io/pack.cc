@@ -0,0 +1,301 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/base/io/pack.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+#include "ozz/base/io/stream.h"
+#include "ozz/base/maths/math_ex.h"
+
+namespace ozz {
+namespace io {
+
+namespace {
+// Pack header tag and version.
+const char kPackTag[] = "ozz-pack";
+const uint32_t kPackVersion = 1;
+
+// Size of the header archive: endianness, tag, version, number of entries and
+// table of contents offset.
+const uint64_t kPackHeaderSize = 1 + sizeof(kPackTag) + 4 + 4 + 8;
+
+// Orders entries indices by entry name.
+struct PackNameLess {
+  explicit PackNameLess(const ozz::Vector<internal::PackEntry>::Std& _entries)
+      : entries(&_entries) {}
+  bool operator()(int _a, int _b) const {
+    return (*entries)[_a].name < (*entries)[_b].name;
+  }
+  const ozz::Vector<internal::PackEntry>::Std* entries;
+};
+
+// Orders slots by the index of the entry they refer to, which is also stream
+// order.
+struct PackSlotLess {
+  explicit PackSlotLess(const Range<const int>& _indices) : indices(_indices) {}
+  bool operator()(int _a, int _b) const {
+    return indices[_a] < indices[_b];
+  }
+  Range<const int> indices;
+};
+}  // namespace
+
+PackWriter::PackWriter(Stream* _stream, Endianness _endianness)
+    : stream_(_stream),
+      endianness_(_endianness),
+      origin_(_stream->Tell()),
+      failed_(false),
+      finalized_(false) {
+  assert(stream_ && stream_->opened() &&
+         "_stream argument must point a valid opened stream.");
+
+  // Reserves header space, rewritten by Finalize().
+  failed_ = !WriteHeader(0);
+}
+
+bool PackWriter::WriteHeader(uint64_t _toc_offset) {
+  OArchive archive(stream_, endianness_);
+  if (archive.SaveBinary(kPackTag, sizeof(kPackTag)) != sizeof(kPackTag)) {
+    return false;
+  }
+  archive << kPackVersion;
+  archive << static_cast<uint32_t>(entries_.size());
+  archive << _toc_offset;
+  return true;
+}
+
+bool PackWriter::BeginEntry(const char* _name) {
+  if (failed_ || finalized_ || !_name || !*_name) {
+    return false;
+  }
+  for (size_t i = 0; i < entries_.size(); ++i) {
+    if (entries_[i].name == _name) {
+      return false;
+    }
+  }
+
+  // Pads with 0 up to payload alignment.
+  const uint64_t position = static_cast<uint64_t>(stream_->Tell() - origin_);
+  const uint64_t aligned = math::Align(position, kAlignment);
+  const char padding[kAlignment] = {0};
+  const size_t padding_size = static_cast<size_t>(aligned - position);
+  if (stream_->Write(padding, padding_size) != padding_size) {
+    failed_ = true;
+    return false;
+  }
+
+  internal::PackEntry entry;
+  entry.name = _name;
+  entry.offset = aligned;
+  entry.size = 0;
+  entries_.push_back(entry);
+  return true;
+}
+
+bool PackWriter::EndEntry() {
+  internal::PackEntry& entry = entries_.back();
+  const int64_t end = stream_->Tell() - origin_;
+  if (end < static_cast<int64_t>(entry.offset)) {
+    failed_ = true;
+    return false;
+  }
+  entry.size = static_cast<uint64_t>(end) - entry.offset;
+  return true;
+}
+
+bool PackWriter::AddBinary(const char* _name, const void* _data,
+                           size_t _size) {
+  if (!BeginEntry(_name)) {
+    return false;
+  }
+  if (stream_->Write(_data, _size) != _size) {
+    failed_ = true;
+    return false;
+  }
+  return EndEntry();
+}
+
+bool PackWriter::Finalize() {
+  if (failed_ || finalized_) {
+    return false;
+  }
+  finalized_ = true;
+
+  // Writes table of contents.
+  const int64_t toc = stream_->Tell();
+  {
+    OArchive archive(stream_, endianness_);
+    for (size_t i = 0; i < entries_.size(); ++i) {
+      const internal::PackEntry& entry = entries_[i];
+      archive << static_cast<uint32_t>(entry.name.size());
+      archive << MakeArray(entry.name.c_str(), entry.name.size());
+      archive << entry.offset;
+      archive << entry.size;
+    }
+  }
+  const int64_t end = stream_->Tell();
+
+  // Rewrites header, now that toc offset is known.
+  bool success = stream_->Seek(origin_, Stream::kSet) == 0 &&
+                 WriteHeader(static_cast<uint64_t>(toc - origin_));
+  success &= stream_->Seek(end, Stream::kSet) == 0;
+  return success;
+}
+
+PackReader::PackReader() : stream_(NULL), origin_(0) {}
+
+void PackReader::Close() {
+  stream_ = NULL;
+  origin_ = 0;
+  entries_.clear();
+  sorted_.clear();
+}
+
+bool PackReader::Open(Stream* _stream) {
+  Close();
+  if (!_stream || !_stream->opened()) {
+    return false;
+  }
+  const int64_t origin = _stream->Tell();
+  const uint64_t size = _stream->Size();
+  if (size < static_cast<uint64_t>(origin) + kPackHeaderSize) {
+    return false;
+  }
+  const uint64_t available = size - static_cast<uint64_t>(origin);
+
+  // Reads and validates header.
+  IArchive archive(_stream);
+  char tag[sizeof(kPackTag)];
+  if (archive.LoadBinary(tag, sizeof(tag)) != sizeof(tag) ||
+      std::memcmp(tag, kPackTag, sizeof(tag)) != 0) {
+    return false;
+  }
+  uint32_t version;
+  archive >> version;
+  if (version != kPackVersion) {
+    return false;
+  }
+  uint32_t num_entries;
+  archive >> num_entries;
+  uint64_t toc_offset;
+  archive >> toc_offset;
+  if (toc_offset < kPackHeaderSize || toc_offset > available ||
+      _stream->Seek(origin + static_cast<int64_t>(toc_offset),
+                    Stream::kSet) != 0) {
+    return false;
+  }
+
+  // Reads table of contents.
+  IArchive toc(_stream);
+  entries_.resize(num_entries);
+  for (uint32_t i = 0; i < num_entries; ++i) {
+    internal::PackEntry& entry = entries_[i];
+    uint32_t name_len;
+    toc >> name_len;
+    if (name_len == 0 || name_len > available - toc_offset) {
+      Close();
+      return false;
+    }
+    entry.name.resize(name_len);
+    toc >> MakeArray(&entry.name[0], name_len);
+    toc >> entry.offset;
+    toc >> entry.size;
+    // Payloads are all located before the table of contents.
+    if (entry.offset > toc_offset || entry.size > toc_offset - entry.offset) {
+      Close();
+      return false;
+    }
+  }
+
+  sorted_.resize(num_entries);
+  for (uint32_t i = 0; i < num_entries; ++i) {
+    sorted_[i] = static_cast<int>(i);
+  }
+  std::sort(sorted_.begin(), sorted_.end(), PackNameLess(entries_));
+
+  stream_ = _stream;
+  origin_ = origin;
+  return true;
+}
+
+const char* PackReader::name(int _index) const {
+  assert(_index >= 0 && _index < num_entries());
+  return entries_[_index].name.c_str();
+}
+
+uint64_t PackReader::offset(int _index) const {
+  assert(_index >= 0 && _index < num_entries());
+  return entries_[_index].offset;
+}
+
+uint64_t PackReader::size(int _index) const {
+  assert(_index >= 0 && _index < num_entries());
+  return entries_[_index].size;
+}
+
+int PackReader::Find(const char* _name) const {
+  if (!_name) {
+    return -1;
+  }
+  size_t first = 0;
+  size_t last = sorted_.size();
+  while (first < last) {
+    const size_t mid = first + (last - first) / 2;
+    const int cmp = std::strcmp(entries_[sorted_[mid]].name.c_str(), _name);
+    if (cmp == 0) {
+      return sorted_[mid];
+    } else if (cmp < 0) {
+      first = mid + 1;
+    } else {
+      last = mid;
+    }
+  }
+  return -1;
+}
+
+bool PackReader::SeekEntry(int _index) {
+  if (!stream_ || _index < 0 || _index >= num_entries()) {
+    return false;
+  }
+  const int64_t offset = static_cast<int64_t>(entries_[_index].offset);
+  return stream_->Seek(origin_ + offset, Stream::kSet) == 0;
+}
+
+void PackReader::SortByOffset(const Range<const int>& _indices,
+                              const Range<int>& _order) const {
+  assert(_order.count() == _indices.count());
+  for (size_t i = 0; i < _order.count(); ++i) {
+    _order[i] = static_cast<int>(i);
+  }
+  std::sort(_order.begin, _order.begin + _order.count(),
+            PackSlotLess(_indices));
+}
+}  // namespace io
+}  // namespace ozz
@@ -35,6 +35,23 @@
 #include "ozz/base/maths/math_ex.h"
 #include "ozz/base/memory/allocator.h"
 
+// Selects CRT 64 bits file offsets functions.
+#if defined(_WIN32)
+#define OZZ_FSEEK _fseeki64
+#define OZZ_FTELL _ftelli64
+#elif defined(__GLIBC__) && defined(_LARGEFILE64_SOURCE)
+// Explicit 64 bits variants, as _FILE_OFFSET_BITS can't be relied on when
+// system headers were included before this file (like in fused sources).
+#define OZZ_FSEEK fseeko64
+#define OZZ_FTELL ftello64
+#elif defined(__unix__) || defined(__APPLE__)
+#define OZZ_FSEEK fseeko
+#define OZZ_FTELL ftello
+#else  // Falls back to long offsets.
+#define OZZ_FSEEK std::fseek
+#define OZZ_FTELL std::ftell
+#endif
+
 namespace ozz {
 namespace io {
 
@@ -76,39 +93,69 @@ size_t File::Write(const void* _buffer, size_t _size) {
   return std::fwrite(_buffer, 1, _size, file);
 }
 
-int File::Seek(int _offset, Origin _origin) {
+int File::Seek(int64_t _offset, Origin _origin) {
   int origins[] = {SEEK_CUR, SEEK_END, SEEK_SET};
   if (_origin >= static_cast<int>(OZZ_ARRAY_SIZE(origins))) {
     return -1;
   }
   std::FILE* file = reinterpret_cast<std::FILE*>(file_);
-  return std::fseek(file, _offset, origins[_origin]);
+  return OZZ_FSEEK(file, _offset, origins[_origin]);
 }
 
-int File::Tell() const {
+int64_t File::Tell() const {
   std::FILE* file = reinterpret_cast<std::FILE*>(file_);
-  return std::ftell(file);
+  return OZZ_FTELL(file);
 }
 
-size_t File::Size() const {
+uint64_t File::Size() const {
   std::FILE* file = reinterpret_cast<std::FILE*>(file_);
 
-  const int current = std::ftell(file);
+  const int64_t current = OZZ_FTELL(file);
   assert(current >= 0);
-  int seek = std::fseek(file, 0, SEEK_END);
+  int seek = OZZ_FSEEK(file, 0, SEEK_END);
   assert(seek == 0);
   (void)seek;
-  const int end = std::ftell(file);
+  const int64_t end = OZZ_FTELL(file);
   assert(end >= 0);
-  seek = std::fseek(file, current, SEEK_SET);
+  seek = OZZ_FSEEK(file, current, SEEK_SET);
   assert(seek == 0);
 
-  return static_cast<size_t>(end);
+  return static_cast<uint64_t>(end);
 }
 
 // Starts MemoryStream implementation.
 const size_t MemoryStream::kBufferSizeIncrement = 16 << 10;
-const size_t MemoryStream::kMaxSize = std::numeric_limits<int>::max();
+const size_t MemoryStream::kMaxSize = std::numeric_limits<ptrdiff_t>::max();
+
+namespace {
+// Computes the new position of a memory stream cursor, returns false if it's
+// before the beginning or beyond _max_size.
+bool SeekMemory(int64_t _offset, Stream::Origin _origin, size_t _tell,
+                size_t _end, size_t _max_size, size_t* _position) {
+  uint64_t origin;
+  switch (_origin) {
+    case Stream::kCurrent:
+      origin = _tell;
+      break;
+    case Stream::kEnd:
+      origin = _end;
+      break;
+    case Stream::kSet:
+      origin = 0;
+      break;
+    default:
+      return false;
+  }
+
+  // Exit if seeking before file begin or beyond max file size.
+  if (_offset < 0 ? origin < 0 - static_cast<uint64_t>(_offset)
+                  : static_cast<uint64_t>(_offset) > _max_size - origin) {
+    return false;
+  }
+  *_position = static_cast<size_t>(origin + _offset);
+  return true;
+}
+}  // namespace
 
 MemoryStream::MemoryStream()
     : buffer_(NULL), alloc_size_(0), end_(0), tell_(0) {}
@@ -122,19 +169,18 @@ bool MemoryStream::opened() const { return true; }
 
 size_t MemoryStream::Read(void* _buffer, size_t _size) {
   // A read cannot set file position beyond the end of the file.
-  // A read cannot exceed the maximum Stream size.
-  if (tell_ > end_ || _size > kMaxSize) {
+  if (tell_ > end_) {
     return 0;
   }
 
-  const int read_size = math::Min(end_ - tell_, static_cast<int>(_size));
+  const size_t read_size = math::Min(end_ - tell_, _size);
   std::memcpy(_buffer, buffer_ + tell_, read_size);
   tell_ += read_size;
   return read_size;
 }
 
 size_t MemoryStream::Write(const void* _buffer, size_t _size) {
-  if (_size > kMaxSize || tell_ > static_cast<int>(kMaxSize - _size)) {
+  if (_size > kMaxSize || tell_ > kMaxSize - _size) {
     // A write cannot exceed the maximum Stream size.
     return 0;
   }
@@ -152,48 +198,25 @@ size_t MemoryStream::Write(const void* _buffer, size_t _size) {
     end_ = tell_;
   }
 
-  const int size = static_cast<int>(_size);
-  const int tell_end = tell_ + size;
+  const size_t tell_end = tell_ + _size;
   if (Resize(tell_end)) {
     end_ = math::Max(tell_end, end_);
     std::memcpy(buffer_ + tell_, _buffer, _size);
-    tell_ += size;
+    tell_ += _size;
     return _size;
   }
   return 0;
 }
 
-int MemoryStream::Seek(int _offset, Origin _origin) {
-  int origin;
-  switch (_origin) {
-    case kCurrent:
-      origin = tell_;
-      break;
-    case kEnd:
-      origin = end_;
-      break;
-    case kSet:
-      origin = 0;
-      break;
-    default:
-      return -1;
-  }
-
-  // Exit if seeking before file begin or beyond max file size.
-  if (origin < -_offset ||
-      (_offset > 0 && origin > static_cast<int>(kMaxSize - _offset))) {
-    return -1;
-  }
-
+int MemoryStream::Seek(int64_t _offset, Origin _origin) {
   // So tell_ is moved but end_ pointer is not moved until something is later
   // written.
-  tell_ = origin + _offset;
-  return 0;
+  return SeekMemory(_offset, _origin, tell_, end_, kMaxSize, &tell_) ? 0 : -1;
 }
 
-int MemoryStream::Tell() const { return tell_; }
+int64_t MemoryStream::Tell() const { return static_cast<int64_t>(tell_); }
 
-size_t MemoryStream::Size() const { return static_cast<size_t>(end_); }
+uint64_t MemoryStream::Size() const { return end_; }
 
 bool MemoryStream::Resize(size_t _size) {
   if (_size > alloc_size_) {
@@ -208,5 +231,48 @@ bool MemoryStream::Resize(size_t _size) {
   }
   return _size == 0 || buffer_ != NULL;
 }
+
+// Starts ExternalMemoryStream implementation.
+
+const size_t ExternalMemoryStream::kMaxSize =
+    std::numeric_limits<ptrdiff_t>::max();
+
+ExternalMemoryStream::ExternalMemoryStream(const void* _buffer, size_t _size)
+    : buffer_(NULL), end_(0), tell_(0) {
+  if (_buffer && _size <= kMaxSize) {
+    buffer_ = static_cast<const char*>(_buffer);
+    end_ = _size;
+  }
+}
+
+ExternalMemoryStream::~ExternalMemoryStream() {}
+
+bool ExternalMemoryStream::opened() const { return buffer_ != NULL; }
+
+size_t ExternalMemoryStream::Read(void* _buffer, size_t _size) {
+  // A read cannot set file position beyond the end of the file.
+  if (tell_ > end_) {
+    return 0;
+  }
+
+  const size_t read_size = math::Min(end_ - tell_, _size);
+  std::memcpy(_buffer, buffer_ + tell_, read_size);
+  tell_ += read_size;
+  return read_size;
+}
+
+size_t ExternalMemoryStream::Write(const void* /*_buffer*/, size_t /*_size*/) {
+  return 0;
+}
+
+int ExternalMemoryStream::Seek(int64_t _offset, Origin _origin) {
+  return SeekMemory(_offset, _origin, tell_, end_, kMaxSize, &tell_) ? 0 : -1;
+}
+
+int64_t ExternalMemoryStream::Tell() const {
+  return static_cast<int64_t>(tell_);
+}
+
+uint64_t ExternalMemoryStream::Size() const { return end_; }
 }  // namespace io
 }  // namespace ozz
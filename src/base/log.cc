@@ -27,10 +27,6 @@
 
 #include "ozz/base/log.h"
 
-#include <sstream>
-
-#include "ozz/base/memory/allocator.h"
-
 namespace ozz {
 namespace log {
 
@@ -57,17 +53,49 @@ Err::Err() : internal::Logger(std::cerr, kStandard) {}
 
 namespace internal {
 
-Logger::Logger(std::ostream& _stream, Level _level)
-    : stream_(
-          _level <= GetLevel()
-              ? _stream
-              : *ozz::memory::default_allocator()->New<std::ostringstream>()),
-      local_stream_(&stream_ != &_stream) {}
-Logger::~Logger() {
-  if (local_stream_) {
-    ozz::memory::default_allocator()->Delete(&stream_);
+LogBuffer::LogBuffer(std::streambuf* _target) : target_(_target) {
+  if (target_) {
+    setp(buffer_, buffer_ + sizeof(buffer_));
   }
 }
+
+LogBuffer::~LogBuffer() { Flush(); }
+
+LogBuffer::int_type LogBuffer::overflow(int_type _c) {
+  if (!target_ || !Flush()) {
+    return traits_type::eof();
+  }
+  if (!traits_type::eq_int_type(_c, traits_type::eof())) {
+    *pptr() = traits_type::to_char_type(_c);
+    pbump(1);
+  }
+  return traits_type::not_eof(_c);
+}
+
+int LogBuffer::sync() {
+  if (!target_ || !Flush()) {
+    return -1;
+  }
+  return target_->pubsync();
+}
+
+bool LogBuffer::Flush() {
+  const std::streamsize size = pptr() - pbase();
+  if (size == 0) {
+    return true;
+  }
+  setp(buffer_, buffer_ + sizeof(buffer_));
+  return target_->sputn(buffer_, size) == size;
+}
+
+Logger::Logger(std::ostream& _stream, Level _level)
+    : buffer_(IsEnabled(_level) ? _stream.rdbuf() : NULL),
+      // A NULL stream buffer sets the stream in a failed state, so that it
+      // doesn't format.
+      stream_(IsEnabled(_level) ? &buffer_ : NULL) {}
+
+// buffer_ destructor writes remaining logs.
+Logger::~Logger() {}
 }  // namespace internal
 }  // namespace log
 }  // namespace ozz
@@ -0,0 +1,154 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/base/maths/box_utils.h"
+
+#include <cassert>
+
+namespace ozz {
+namespace math {
+
+namespace {
+// Reduces translations of non-empty [_begin, _end[ matrices range to _min and
+// _max bounds. 4 independent accumulators are used to break min/max
+// dependency chains.
+void ReduceBounds(const Float4x4* _begin, const Float4x4* _end,
+                  SimdFloat4* _min, SimdFloat4* _max) {
+  assert(_begin < _end);
+  SimdFloat4 min0 = _begin->cols[3];
+  SimdFloat4 min1 = min0, min2 = min0, min3 = min0;
+  SimdFloat4 max0 = min0, max1 = min0, max2 = min0, max3 = min0;
+  const Float4x4* current = _begin + 1;
+  for (; _end - current >= 4; current += 4) {
+    min0 = Min(min0, current[0].cols[3]);
+    max0 = Max(max0, current[0].cols[3]);
+    min1 = Min(min1, current[1].cols[3]);
+    max1 = Max(max1, current[1].cols[3]);
+    min2 = Min(min2, current[2].cols[3]);
+    max2 = Max(max2, current[2].cols[3]);
+    min3 = Min(min3, current[3].cols[3]);
+    max3 = Max(max3, current[3].cols[3]);
+  }
+  for (; current < _end; ++current) {
+    min0 = Min(min0, current->cols[3]);
+    max0 = Max(max0, current->cols[3]);
+  }
+  *_min = Min(Min(min0, min1), Min(min2, min3));
+  *_max = Max(Max(max0, max1), Max(max2, max3));
+}
+}  // namespace
+
+Box ComputeBounds(const Range<const Float4x4>& _matrices) {
+  Box box;
+  if (_matrices.begin >= _matrices.end) {
+    return box;
+  }
+  SimdFloat4 min, max;
+  ReduceBounds(_matrices.begin, _matrices.end, &min, &max);
+  Store3PtrU(min, &box.min.x);
+  Store3PtrU(max, &box.max.x);
+  return box;
+}
+
+bool ComputeBounds(const Range<const Float4x4>& _matrices, size_t _pose_size,
+                   const Range<Box>& _boxes) {
+  const size_t count = _boxes.count();
+  if (_matrices.count() < _pose_size * count) {
+    return false;
+  }
+  for (size_t i = 0; i < count; ++i) {
+    const Float4x4* begin = _matrices.begin + i * _pose_size;
+    _boxes[i] = ComputeBounds(Range<const Float4x4>(begin, _pose_size));
+  }
+  return true;
+}
+
+Frustum Frustum::FromMatrix(const Float4x4& _view_proj) {
+  // Gribb-Hartmann extraction, planes are combinations of matrix rows.
+  SimdFloat4 rows[4];
+  Transpose4x4(_view_proj.cols, rows);
+  const Frustum frustum = {{rows[3] + rows[0], rows[3] - rows[0],
+                            rows[3] + rows[1], rows[3] - rows[1],
+                            rows[3] + rows[2], rows[3] - rows[2]}};
+  return frustum;
+}
+
+bool TestFrustum(const Frustum& _frustum, const Range<const Box>& _boxes,
+                 const Range<bool>& _visible) {
+  const size_t count = _boxes.count();
+  if (_visible.count() < count) {
+    return false;
+  }
+
+  const SimdFloat4 zero = simd_float4::zero();
+  const SimdFloat4 half = simd_float4::Load1(.5f);
+
+  for (size_t i = 0; i < count; i += 4) {
+    // Loads 4 boxes and converts them to soa centers and extents. Lanes past
+    // the end of the range replicate the last box.
+    SimdFloat4 mins[4];
+    SimdFloat4 maxs[4];
+    for (size_t j = 0; j < 4; ++j) {
+      const Box& box = _boxes[i + j < count ? i + j : count - 1];
+      mins[j] = simd_float4::Load3PtrU(&box.min.x);
+      maxs[j] = simd_float4::Load3PtrU(&box.max.x);
+    }
+    SimdFloat4 soa_min[3];
+    SimdFloat4 soa_max[3];
+    Transpose4x3(mins, soa_min);
+    Transpose4x3(maxs, soa_max);
+    const SimdFloat4 cx = (soa_max[0] + soa_min[0]) * half;
+    const SimdFloat4 cy = (soa_max[1] + soa_min[1]) * half;
+    const SimdFloat4 cz = (soa_max[2] + soa_min[2]) * half;
+    const SimdFloat4 ex = (soa_max[0] - soa_min[0]) * half;
+    const SimdFloat4 ey = (soa_max[1] - soa_min[1]) * half;
+    const SimdFloat4 ez = (soa_max[2] - soa_min[2]) * half;
+
+    // A box is outside if it's fully behind any plane, aka if the distance
+    // from its center to the plane is lower than minus its projected radius.
+    SimdInt4 outside = simd_int4::zero();
+    for (int p = 0; p < Frustum::kNumPlanes; ++p) {
+      const SimdFloat4 plane = _frustum.planes[p];
+      const SimdFloat4 abs_plane = Abs(plane);
+      const SimdFloat4 distance =
+          MAdd(SplatX(plane), cx,
+               MAdd(SplatY(plane), cy, MAdd(SplatZ(plane), cz, SplatW(plane))));
+      const SimdFloat4 radius =
+          MAdd(SplatX(abs_plane), ex,
+               MAdd(SplatY(abs_plane), ey, SplatZ(abs_plane) * ez));
+      outside = Or(outside, CmpLt(distance + radius, zero));
+    }
+
+    const int mask = MoveMask(outside);
+    for (size_t j = 0; j < 4 && i + j < count; ++j) {
+      _visible[i + j] = (mask & (1 << j)) == 0;
+    }
+  }
+  return true;
+}
+}  // namespace math
+}  // namespace ozz
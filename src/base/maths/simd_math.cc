@@ -31,7 +31,13 @@ namespace ozz {
 namespace math {
 
 // Select compile time name of the simd implementation
-#if defined(OZZ_SIMD_AVX2) && defined(OZZ_SIMD_FMA)
+#if defined(OZZ_SIMD_NEON_A64)
+#define _OZZ_SIMD_IMPLEMENTATION "NEON-A64"
+#elif defined(OZZ_SIMD_NEON)
+#define _OZZ_SIMD_IMPLEMENTATION "NEON"
+#elif defined(OZZ_SIMD_WASM)
+#define _OZZ_SIMD_IMPLEMENTATION "WASM-SIMD128"
+#elif defined(OZZ_SIMD_AVX2) && defined(OZZ_SIMD_FMA)
 #define _OZZ_SIMD_IMPLEMENTATION "AVX2-FMA"
 #elif defined(OZZ_SIMD_AVX2)
 #define _OZZ_SIMD_IMPLEMENTATION "AVX2"
@@ -57,5 +63,63 @@ namespace math {
                 " SIMD math implementation")
 
 const char* SimdImplementationName() { return _OZZ_SIMD_IMPLEMENTATION; }
+
+#if defined(OZZ_SIMD_AVX2_DISPATCH)
+namespace {
+bool DetectAvx2Fma() {
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+}
+}  // namespace
+
+bool CpuSupportsAvx2Fma() {
+  static const bool supported = DetectAvx2Fma();
+  return supported;
+}
+#elif defined(OZZ_SIMD_AVX2) && defined(OZZ_SIMD_FMA)
+bool CpuSupportsAvx2Fma() { return true; }
+#else
+bool CpuSupportsAvx2Fma() { return false; }
+#endif
+
+void FloatToHalf(const float* _src, size_t _count, uint16_t* _dest) {
+  size_t i = 0;
+#if defined(OZZ_SIMD_F16C)
+  for (; i + 8 <= _count; i += 8) {
+    _mm_storeu_si128(
+        reinterpret_cast<__m128i*>(_dest + i),
+        _mm256_cvtps_ph(_mm256_loadu_ps(_src + i), _MM_FROUND_TO_NEAREST_INT));
+  }
+#endif  // OZZ_SIMD_F16C
+  for (; i + 4 <= _count; i += 4) {
+    int ints[4];
+    StorePtrU(FloatToHalf(simd_float4::LoadPtrU(_src + i)), ints);
+    for (int j = 0; j < 4; ++j) {
+      _dest[i + j] = static_cast<uint16_t>(ints[j]);
+    }
+  }
+  for (; i < _count; ++i) {
+    _dest[i] = FloatToHalf(_src[i]);
+  }
+}
+
+void HalfToFloat(const uint16_t* _src, size_t _count, float* _dest) {
+  size_t i = 0;
+#if defined(OZZ_SIMD_F16C)
+  for (; i + 8 <= _count; i += 8) {
+    _mm256_storeu_ps(_dest + i,
+                     _mm256_cvtph_ps(_mm_loadu_si128(
+                         reinterpret_cast<const __m128i*>(_src + i))));
+  }
+#endif  // OZZ_SIMD_F16C
+  for (; i + 4 <= _count; i += 4) {
+    StorePtrU(HalfToFloat(simd_int4::Load(_src[i + 0], _src[i + 1],
+                                          _src[i + 2], _src[i + 3])),
+              _dest + i);
+  }
+  for (; i < _count; ++i) {
+    _dest[i] = HalfToFloat(_src[i]);
+  }
+}
 }  // namespace math
 }  // namespace ozz
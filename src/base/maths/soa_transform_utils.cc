@@ -0,0 +1,101 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/base/maths/soa_transform_utils.h"
+
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/maths/transform.h"
+
+namespace ozz {
+namespace math {
+
+bool PackSoaTransforms(const Range<const Transform>& _transforms,
+                       const Range<SoaTransform>& _soa_transforms) {
+  const size_t count = _transforms.count();
+  const size_t soa_count = (count + 3) / 4;
+  if (_soa_transforms.count() < soa_count) {
+    return false;
+  }
+
+  const SimdFloat4 zero = simd_float4::zero();
+  const SimdFloat4 one = simd_float4::one();
+  const SimdFloat4 w_axis = simd_float4::w_axis();
+
+  for (size_t i = 0; i < soa_count; ++i) {
+    SimdFloat4 translations[4];
+    SimdFloat4 rotations[4];
+    SimdFloat4 scales[4];
+    for (size_t j = 0; j < 4; ++j) {
+      if (i * 4 + j < count) {
+        const Transform& src = _transforms[i * 4 + j];
+        translations[j] = simd_float4::Load3PtrU(&src.translation.x);
+        rotations[j] = simd_float4::LoadPtrU(&src.rotation.x);
+        scales[j] = simd_float4::Load3PtrU(&src.scale.x);
+      } else {
+        translations[j] = zero;
+        rotations[j] = w_axis;
+        scales[j] = one;
+      }
+    }
+    SoaTransform& dest = _soa_transforms[i];
+    Transpose4x3(translations, &dest.translation.x);
+    Transpose4x4(rotations, &dest.rotation.x);
+    Transpose4x3(scales, &dest.scale.x);
+  }
+  return true;
+}
+
+bool UnpackSoaTransforms(const Range<const SoaTransform>& _soa_transforms,
+                         const Range<Transform>& _transforms) {
+  const size_t count = _transforms.count();
+  const size_t soa_count = (count + 3) / 4;
+  if (_soa_transforms.count() < soa_count) {
+    return false;
+  }
+
+  Transform* dest = _transforms.begin;
+  for (size_t i = 0; i < soa_count; ++i) {
+    const SoaTransform& src = _soa_transforms[i];
+    SimdFloat4 translations[4];
+    SimdFloat4 rotations[4];
+    SimdFloat4 scales[4];
+    Transpose3x4(&src.translation.x, translations);
+    Transpose4x4(&src.rotation.x, rotations);
+    Transpose3x4(&src.scale.x, scales);
+
+    const size_t lanes = count - i * 4 < 4 ? count - i * 4 : 4;
+    for (size_t j = 0; j < lanes; ++j, ++dest) {
+      Store3PtrU(translations[j], &dest->translation.x);
+      StorePtrU(rotations[j], &dest->rotation.x);
+      Store3PtrU(scales[j], &dest->scale.x);
+    }
+  }
+  return true;
+}
+}  // namespace math
+}  // namespace ozz
@@ -126,10 +126,23 @@ HeapAllocator g_heap_allocator;
 
 // Instantiates the default heap allocator pointer.
 Allocator* g_default_allocator = &g_heap_allocator;
+
+// Instantiates calling thread scratch allocator pointer, NULL meaning default.
+OZZ_THREAD_LOCAL Allocator* g_thread_scratch_allocator = NULL;
+
+// Instantiates calling thread allocation tag.
+OZZ_THREAD_LOCAL int g_allocation_tag = kTagUntagged;
+
+// Instantiates calling thread ScopedNoAllocation nesting depth.
+OZZ_THREAD_LOCAL int g_no_allocation_depth = 0;
 }  // namespace
 
 // Implements default allocator accessor.
-Allocator* default_allocator() { return g_default_allocator; }
+Allocator* default_allocator() {
+  assert(g_no_allocation_depth == 0 &&
+         "Default allocator used within a ScopedNoAllocation scope");
+  return g_default_allocator;
+}
 
 // Implements default allocator setter.
 Allocator* SetDefaulAllocator(Allocator* _allocator) {
@@ -137,5 +150,39 @@ Allocator* SetDefaulAllocator(Allocator* _allocator) {
   g_default_allocator = _allocator;
   return previous;
 }
+
+// Implements thread scratch allocator accessor.
+Allocator* thread_scratch_allocator() {
+  return g_thread_scratch_allocator ? g_thread_scratch_allocator
+                                    : default_allocator();
+}
+
+// Implements thread scratch allocator setter.
+Allocator* SetThreadScratchAllocator(Allocator* _allocator) {
+  Allocator* previous = g_thread_scratch_allocator;
+  g_thread_scratch_allocator = _allocator;
+  return previous;
+}
+
+bool allocations_allowed() { return g_no_allocation_depth == 0; }
+
+ScopedNoAllocation::ScopedNoAllocation() { ++g_no_allocation_depth; }
+
+ScopedNoAllocation::~ScopedNoAllocation() {
+  assert(g_no_allocation_depth > 0);
+  --g_no_allocation_depth;
+}
+
+AllocationTag allocation_tag() {
+  return static_cast<AllocationTag>(g_allocation_tag);
+}
+
+ScopedAllocationTag::ScopedAllocationTag(AllocationTag _tag)
+    : previous_(static_cast<AllocationTag>(g_allocation_tag)) {
+  assert(_tag >= 0 && _tag < kNumAllocationTags && "Invalid tag");
+  g_allocation_tag = _tag;
+}
+
+ScopedAllocationTag::~ScopedAllocationTag() { g_allocation_tag = previous_; }
 }  // namespace memory
 }  // namespace ozz
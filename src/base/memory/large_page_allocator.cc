@@ -0,0 +1,266 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+#include "ozz/base/memory/large_page_allocator.h"
+
+#include <cassert>
+#include <cstring>
+#include <new>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif  // NOMINMAX
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif  // WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#define OZZ_LARGE_PAGE_VIRTUAL_ALLOC
+#elif (defined(__unix__) || defined(__APPLE__)) && !defined(__EMSCRIPTEN__)
+#include <sys/mman.h>
+#define OZZ_LARGE_PAGE_MMAP
+#endif
+
+#include "ozz/base/maths/math_ex.h"
+
+namespace ozz {
+namespace memory {
+
+namespace {
+// Granularity of regions when large pages aren't supported.
+const size_t kSmallPageSize = 4096;
+
+// Maps _size bytes of read/write memory, using large pages if possible.
+// _size must be a multiple of LargePageAllocator::large_page_size() for large
+// pages to be used. Sets _large to true if large pages are used.
+void* MapPages(size_t _size, bool* _large) {
+  *_large = false;
+#if defined(OZZ_LARGE_PAGE_VIRTUAL_ALLOC)
+  const size_t large_page_size = GetLargePageMinimum();
+  if (large_page_size && _size % large_page_size == 0) {
+    void* pages =
+        VirtualAlloc(NULL, _size, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES,
+                     PAGE_READWRITE);
+    if (pages) {
+      *_large = true;
+      return pages;
+    }
+  }
+  return VirtualAlloc(NULL, _size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+#elif defined(OZZ_LARGE_PAGE_MMAP)
+#ifdef MAP_HUGETLB
+  // Explicit huge pages are only available if the system reserved some.
+  void* huge =
+      mmap(NULL, _size, PROT_READ | PROT_WRITE,
+           MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+  if (huge != MAP_FAILED) {
+    *_large = true;
+    return huge;
+  }
+#endif  // MAP_HUGETLB
+  void* pages = mmap(NULL, _size, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (pages == MAP_FAILED) {
+    return NULL;
+  }
+#ifdef MADV_HUGEPAGE
+  // Falls back to transparent huge pages.
+  madvise(pages, _size, MADV_HUGEPAGE);
+#endif  // MADV_HUGEPAGE
+  return pages;
+#else
+  return default_allocator()->Allocate(_size, kSmallPageSize);
+#endif
+}
+
+// Unmaps pages mapped with MapPages.
+void UnmapPages(void* _pages, size_t _size) {
+#if defined(OZZ_LARGE_PAGE_VIRTUAL_ALLOC)
+  (void)_size;
+  VirtualFree(_pages, 0, MEM_RELEASE);
+#elif defined(OZZ_LARGE_PAGE_MMAP)
+  munmap(_pages, _size);
+#else
+  (void)_size;
+  default_allocator()->Deallocate(_pages);
+#endif
+}
+
+// Stored right before each block.
+struct LargePageHeader {
+  // Region the block belongs to.
+  void* region;
+  // Requested block size.
+  size_t size;
+};
+
+LargePageHeader* GetLargePageHeader(void* _block) {
+  return reinterpret_cast<LargePageHeader*>(reinterpret_cast<char*>(_block) -
+                                            sizeof(LargePageHeader));
+}
+}  // namespace
+
+struct LargePageAllocator::Region {
+  // Region size, including this header.
+  size_t size;
+  // Offset of the region free space.
+  size_t used;
+  // Number of blocks allocated from this region and not deallocated yet.
+  size_t live_count;
+  // Is the region backed by large pages.
+  bool large_pages;
+};
+
+LargePageAllocator::LargePageAllocator(size_t _region_size)
+    : region_size_(_region_size),
+      current_(NULL),
+      mapped_bytes_(0),
+      large_page_bytes_(0) {}
+
+LargePageAllocator::~LargePageAllocator() {
+  assert(mapped_bytes_ == (current_ ? current_->size : 0) &&
+         (!current_ || current_->live_count == 0) && "Memory leak detected");
+  if (current_) {
+    UnmapRegion(current_);
+  }
+}
+
+size_t LargePageAllocator::large_page_size() {
+#if defined(OZZ_LARGE_PAGE_VIRTUAL_ALLOC)
+  return GetLargePageMinimum();
+#elif defined(OZZ_LARGE_PAGE_MMAP) && defined(MAP_HUGETLB)
+  return 2 << 20;
+#else
+  return 0;
+#endif
+}
+
+LargePageAllocator::Region* LargePageAllocator::MapRegion(size_t _size) {
+  const size_t large_page_size = LargePageAllocator::large_page_size();
+  const size_t granularity =
+      large_page_size ? large_page_size : kSmallPageSize;
+  const size_t size = math::Align(_size, granularity);
+  bool large_pages;
+  void* pages = MapPages(size, &large_pages);
+  if (!pages) {
+    return NULL;
+  }
+  Region* region = new (pages) Region;
+  region->size = size;
+  region->used = sizeof(Region);
+  region->live_count = 0;
+  region->large_pages = large_pages;
+  mapped_bytes_ += size;
+  large_page_bytes_ += large_pages ? size : 0;
+  return region;
+}
+
+void LargePageAllocator::UnmapRegion(Region* _region) {
+  assert(_region->live_count == 0);
+  mapped_bytes_ -= _region->size;
+  large_page_bytes_ -= _region->large_pages ? _region->size : 0;
+  UnmapPages(_region, _region->size);
+}
+
+void* LargePageAllocator::Allocate(size_t _size, size_t _alignment) {
+  // Computes the block offset in a region with _offset free space offset,
+  // with enough space for the header and required alignment.
+  const size_t header_alignment = OZZ_ALIGN_OF(LargePageHeader);
+  const size_t alignment =
+      _alignment > header_alignment ? _alignment : header_alignment;
+
+  // Finds space in the current region.
+  Region* region = current_;
+  size_t offset = 0;
+  if (region) {
+    offset = math::Align(region->used + sizeof(LargePageHeader), alignment);
+    if (offset + _size > region->size) {
+      region = NULL;
+    }
+  }
+
+  // Maps a new region otherwise. Blocks that don't fit in a default region
+  // get their own dedicated region.
+  if (!region) {
+    const size_t required =
+        math::Align(sizeof(Region) + sizeof(LargePageHeader), alignment) +
+        _size;
+    const bool dedicated = required > region_size_;
+    region = MapRegion(dedicated ? required : region_size_);
+    if (!region) {
+      return NULL;
+    }
+    offset = math::Align(region->used + sizeof(LargePageHeader), alignment);
+    assert(offset + _size <= region->size);
+    if (!dedicated) {
+      // Previous region is released once empty.
+      if (current_ && current_->live_count == 0) {
+        UnmapRegion(current_);
+      }
+      current_ = region;
+    }
+  }
+
+  char* block = reinterpret_cast<char*>(region) + offset;
+  LargePageHeader* header = GetLargePageHeader(block);
+  header->region = region;
+  header->size = _size;
+  region->used = offset + _size;
+  ++region->live_count;
+  return block;
+}
+
+void LargePageAllocator::Deallocate(void* _block) {
+  if (!_block) {
+    return;
+  }
+  Region* region =
+      reinterpret_cast<Region*>(GetLargePageHeader(_block)->region);
+  assert(region->live_count > 0 && "Invalid block");
+  if (--region->live_count != 0) {
+    return;
+  }
+  if (region == current_) {
+    // Recycles current region memory.
+    region->used = sizeof(Region);
+  } else {
+    UnmapRegion(region);
+  }
+}
+
+void* LargePageAllocator::Reallocate(void* _block, size_t _size,
+                                     size_t _alignment) {
+  void* block = Allocate(_size, _alignment);
+  if (block && _block) {
+    // Copies and deallocate the old memory block.
+    const size_t size = GetLargePageHeader(_block)->size;
+    std::memcpy(block, _block, size < _size ? size : _size);
+    Deallocate(_block);
+  }
+  return block;
+}
+}  // namespace memory
+}  // namespace ozz
@@ -0,0 +1,136 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/base/memory/linear_allocator.h"
+
+#include <cassert>
+#include <cstring>
+
+#include "ozz/base/maths/math_ex.h"
+
+namespace ozz {
+namespace memory {
+
+namespace {
+// Stored right before each block.
+struct LinearHeader {
+  // Block size, required to copy block content on reallocation.
+  size_t size;
+  // Free space beginning before the block was allocated, used to rewind when
+  // the last block is deallocated.
+  char* previous;
+};
+
+LinearHeader* GetLinearHeader(void* _block) {
+  return reinterpret_cast<LinearHeader*>(reinterpret_cast<char*>(_block) -
+                                         sizeof(LinearHeader));
+}
+}  // namespace
+
+LinearAllocator::LinearAllocator(void* _buffer, size_t _size)
+    : begin_(reinterpret_cast<char*>(_buffer)),
+      end_(begin_ + _size),
+      current_(begin_),
+      owned_(false) {
+  assert((_buffer || !_size) && "Invalid buffer");
+}
+
+LinearAllocator::LinearAllocator(size_t _size)
+    : begin_(reinterpret_cast<char*>(
+          default_allocator()->Allocate(_size, OZZ_ALIGN_OF(LinearHeader)))),
+      end_(begin_ ? begin_ + _size : NULL),
+      current_(begin_),
+      owned_(true) {}
+
+LinearAllocator::~LinearAllocator() {
+  if (owned_) {
+    default_allocator()->Deallocate(begin_);
+  }
+}
+
+void LinearAllocator::Reset() { current_ = begin_; }
+
+void* LinearAllocator::Allocate(size_t _size, size_t _alignment) {
+  if (!begin_) {
+    return NULL;
+  }
+  // LinearHeader is stored right before the aligned block.
+  const size_t header_alignment = OZZ_ALIGN_OF(LinearHeader);
+  const size_t alignment =
+      _alignment > header_alignment ? _alignment : header_alignment;
+  char* block = math::Align(current_ + sizeof(LinearHeader), alignment);
+  if (block > end_ || _size > static_cast<size_t>(end_ - block)) {
+    return NULL;
+  }
+  LinearHeader* header = GetLinearHeader(block);
+  header->size = _size;
+  header->previous = current_;
+  current_ = block + _size;
+  return block;
+}
+
+void LinearAllocator::Deallocate(void* _block) {
+  if (!_block) {
+    return;
+  }
+  assert(_block > begin_ && _block <= end_ && "Unknown block");
+  const LinearHeader* header = GetLinearHeader(_block);
+  // Only the last block can be released.
+  if (reinterpret_cast<char*>(_block) + header->size == current_) {
+    current_ = header->previous;
+  }
+}
+
+void* LinearAllocator::Reallocate(void* _block, size_t _size,
+                                  size_t _alignment) {
+  if (!_block) {
+    return Allocate(_size, _alignment);
+  }
+  assert(_block > begin_ && _block <= end_ && "Unknown block");
+  char* block = reinterpret_cast<char*>(_block);
+  LinearHeader* header = GetLinearHeader(_block);
+
+  // Resizes in place if it's the last block.
+  if (block + header->size == current_ && math::IsAligned(block, _alignment)) {
+    if (_size > static_cast<size_t>(end_ - block)) {
+      return NULL;
+    }
+    header->size = _size;
+    current_ = block + _size;
+    return block;
+  }
+
+  // Otherwise allocates a new block, the old one being simply abandoned.
+  void* new_block = Allocate(_size, _alignment);
+  if (new_block) {
+    std::memcpy(new_block, _block,
+                header->size < _size ? header->size : _size);
+  }
+  return new_block;
+}
+}  // namespace memory
+}  // namespace ozz
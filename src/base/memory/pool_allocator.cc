@@ -0,0 +1,104 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/base/memory/pool_allocator.h"
+
+#include <cassert>
+
+#include "ozz/base/maths/math_ex.h"
+
+namespace ozz {
+namespace memory {
+
+PoolAllocator::PoolAllocator(size_t _block_size, size_t _block_count,
+                             size_t _alignment)
+    : buffer_(NULL),
+      free_list_(NULL),
+      block_size_(_block_size),
+      block_count_(0),
+      alignment_(_alignment > OZZ_ALIGN_OF(void*) ? _alignment
+                                                  : OZZ_ALIGN_OF(void*)),
+      allocated_count_(0) {
+  assert((_alignment & (_alignment - 1)) == 0 &&
+         "Alignment must be a power of two");
+
+  // Blocks must be big enough to store free list pointers, and consecutive
+  // blocks must remain aligned.
+  const size_t stride = math::Align(
+      _block_size > sizeof(void*) ? _block_size : sizeof(void*), alignment_);
+  buffer_ = reinterpret_cast<char*>(
+      default_allocator()->Allocate(stride * _block_count, alignment_));
+  if (!buffer_) {
+    return;
+  }
+  block_count_ = _block_count;
+
+  // Chains all blocks, first block being the head of the free list.
+  for (size_t i = _block_count; i > 0; --i) {
+    void* block = buffer_ + (i - 1) * stride;
+    *reinterpret_cast<void**>(block) = free_list_;
+    free_list_ = block;
+  }
+}
+
+PoolAllocator::~PoolAllocator() {
+  assert(allocated_count_ == 0 && "Memory leak detected");
+  default_allocator()->Deallocate(buffer_);
+}
+
+void* PoolAllocator::Allocate(size_t _size, size_t _alignment) {
+  if (!free_list_ || _size > block_size_ || _alignment > alignment_) {
+    return NULL;
+  }
+  void* block = free_list_;
+  free_list_ = *reinterpret_cast<void**>(block);
+  ++allocated_count_;
+  return block;
+}
+
+void PoolAllocator::Deallocate(void* _block) {
+  if (!_block) {
+    return;
+  }
+  assert(allocated_count_ > 0 && "Unknown block");
+  *reinterpret_cast<void**>(_block) = free_list_;
+  free_list_ = _block;
+  --allocated_count_;
+}
+
+void* PoolAllocator::Reallocate(void* _block, size_t _size,
+                                size_t _alignment) {
+  if (!_block) {
+    return Allocate(_size, _alignment);
+  }
+  if (_size > block_size_ || _alignment > alignment_) {
+    return NULL;
+  }
+  return _block;
+}
+}  // namespace memory
+}  // namespace ozz
@@ -0,0 +1,267 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+#include "ozz/base/memory/thread_caching_allocator.h"
+
+#if __cplusplus >= 201103L
+#include <atomic>
+#endif  // __cplusplus
+#include <cassert>
+#include <cstring>
+#include <new>
+
+#include "ozz/base/maths/math_ex.h"
+
+namespace ozz {
+namespace memory {
+
+namespace {
+// Stored right before each block.
+struct CachingHeader {
+  // Address returned by the decorated allocator.
+  void* unaligned;
+  // Requested block size.
+  size_t size;
+  // Size class of the block, or -1 if it isn't cached.
+  int size_class;
+};
+
+CachingHeader* GetCachingHeader(void* _block) {
+  return reinterpret_cast<CachingHeader*>(reinterpret_cast<char*>(_block) -
+                                          sizeof(CachingHeader));
+}
+
+// Number of power of two size classes, from kMinAlignment to kMaxCachedSize.
+const int kNumSizeClasses = 9;
+OZZ_STATIC_ASSERT(ThreadCachingAllocator::kMinAlignment
+                      << (kNumSizeClasses - 1) ==
+                  ThreadCachingAllocator::kMaxCachedSize);
+
+// Gets the size of the blocks of _size_class.
+size_t SizeClassSize(int _size_class) {
+  return static_cast<size_t>(ThreadCachingAllocator::kMinAlignment)
+         << _size_class;
+}
+
+#if __cplusplus >= 201103L
+// Gets the size class of a _size bytes block, or -1 if it's too big.
+int SizeClass(size_t _size) {
+  for (int i = 0; i < kNumSizeClasses; ++i) {
+    if (_size <= SizeClassSize(i)) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+// Distributes threads on shards, in order of their first allocation.
+std::atomic<int> g_next_caching_shard(0);
+OZZ_THREAD_LOCAL int g_caching_shard = -1;
+
+int ShardIndex() {
+  if (g_caching_shard < 0) {
+    g_caching_shard =
+        g_next_caching_shard++ % ThreadCachingAllocator::kNumShards;
+  }
+  return g_caching_shard;
+}
+
+// Spins until _lock is acquired, releases it on destruction.
+class ShardLock {
+ public:
+  explicit ShardLock(std::atomic_flag* _lock) : lock_(_lock) {
+    while (lock_->test_and_set(std::memory_order_acquire)) {
+    }
+  }
+  ~ShardLock() { lock_->clear(std::memory_order_release); }
+
+ private:
+  ShardLock(const ShardLock&);
+  void operator=(const ShardLock&);
+  std::atomic_flag* lock_;
+};
+#else   // __cplusplus
+int SizeClass(size_t) { return -1; }
+int ShardIndex() { return 0; }
+#endif  // __cplusplus
+}  // namespace
+
+// Free lists of cached blocks, per size class. The next block of a list is
+// stored in the block itself.
+struct ThreadCachingAllocator::Shard {
+#if __cplusplus >= 201103L
+  std::atomic_flag lock;
+#endif  // __cplusplus
+  void* free_lists[kNumSizeClasses];
+  int counts[kNumSizeClasses];
+  // Avoids false sharing between shards.
+  char padding[64];
+};
+
+ThreadCachingAllocator::ThreadCachingAllocator(Allocator* _allocator)
+    : allocator_(_allocator), shards_(NULL) {
+  assert(_allocator && "Invalid allocator");
+#if __cplusplus >= 201103L
+  shards_ = reinterpret_cast<Shard*>(
+      allocator_->Allocate(sizeof(Shard) * kNumShards, 64));
+  for (int i = 0; shards_ && i < kNumShards; ++i) {
+    Shard* shard = new (shards_ + i) Shard;
+    shard->lock.clear();
+    for (int j = 0; j < kNumSizeClasses; ++j) {
+      shard->free_lists[j] = NULL;
+      shard->counts[j] = 0;
+    }
+  }
+#endif  // __cplusplus
+}
+
+ThreadCachingAllocator::~ThreadCachingAllocator() {
+  Trim();
+  allocator_->Deallocate(shards_);
+}
+
+void ThreadCachingAllocator::Trim() {
+  for (int i = 0; shards_ && i < kNumShards; ++i) {
+    // Detaches free lists while locked, releases them after.
+    void* free_lists[kNumSizeClasses];
+    {
+#if __cplusplus >= 201103L
+      ShardLock lock(&shards_[i].lock);
+#endif  // __cplusplus
+      for (int j = 0; j < kNumSizeClasses; ++j) {
+        free_lists[j] = shards_[i].free_lists[j];
+        shards_[i].free_lists[j] = NULL;
+        shards_[i].counts[j] = 0;
+      }
+    }
+    for (int j = 0; j < kNumSizeClasses; ++j) {
+      while (free_lists[j]) {
+        void* next = *reinterpret_cast<void**>(free_lists[j]);
+        Release(free_lists[j]);
+        free_lists[j] = next;
+      }
+    }
+  }
+}
+
+size_t ThreadCachingAllocator::cached_count() const {
+  size_t count = 0;
+  for (int i = 0; shards_ && i < kNumShards; ++i) {
+#if __cplusplus >= 201103L
+    ShardLock lock(&shards_[i].lock);
+#endif  // __cplusplus
+    for (int j = 0; j < kNumSizeClasses; ++j) {
+      count += shards_[i].counts[j];
+    }
+  }
+  return count;
+}
+
+void* ThreadCachingAllocator::Allocate(size_t _size, size_t _alignment) {
+  const size_t min_alignment = kMinAlignment;
+  const size_t alignment =
+      _alignment > min_alignment ? _alignment : min_alignment;
+  const int size_class =
+      shards_ && alignment == min_alignment ? SizeClass(_size) : -1;
+
+  // Pops a cached block from the calling thread shard.
+  if (size_class >= 0) {
+    Shard& shard = shards_[ShardIndex()];
+    void* block = NULL;
+    {
+#if __cplusplus >= 201103L
+      ShardLock lock(&shard.lock);
+#endif  // __cplusplus
+      block = shard.free_lists[size_class];
+      if (block) {
+        shard.free_lists[size_class] = *reinterpret_cast<void**>(block);
+        --shard.counts[size_class];
+      }
+    }
+    if (block) {
+      GetCachingHeader(block)->size = _size;
+      return block;
+    }
+  }
+
+  // Allocates a new block from the decorated allocator, with enough memory to
+  // store the header and required alignment space. Cached blocks are
+  // allocated with their size class size, so they can be reused.
+  const size_t capacity =
+      size_class >= 0 ? SizeClassSize(size_class) : _size;
+  const size_t offset = math::Align(sizeof(CachingHeader), alignment);
+  char* unaligned = reinterpret_cast<char*>(
+      allocator_->Allocate(offset + capacity, alignment));
+  if (!unaligned) {
+    return NULL;
+  }
+  char* block = unaligned + offset;
+  CachingHeader* header = GetCachingHeader(block);
+  header->unaligned = unaligned;
+  header->size = _size;
+  header->size_class = size_class;
+  return block;
+}
+
+void ThreadCachingAllocator::Deallocate(void* _block) {
+  if (!_block) {
+    return;
+  }
+  const int size_class = GetCachingHeader(_block)->size_class;
+  if (size_class >= 0) {
+    // Pushes the block to the calling thread shard, which might not be the
+    // one it was allocated from.
+    Shard& shard = shards_[ShardIndex()];
+#if __cplusplus >= 201103L
+    ShardLock lock(&shard.lock);
+#endif  // __cplusplus
+    if (shard.counts[size_class] < kMaxCachedBlocks) {
+      *reinterpret_cast<void**>(_block) = shard.free_lists[size_class];
+      shard.free_lists[size_class] = _block;
+      ++shard.counts[size_class];
+      return;
+    }
+  }
+  Release(_block);
+}
+
+void* ThreadCachingAllocator::Reallocate(void* _block, size_t _size,
+                                         size_t _alignment) {
+  void* block = Allocate(_size, _alignment);
+  if (block && _block) {
+    // Copies and deallocate the old memory block.
+    const size_t size = GetCachingHeader(_block)->size;
+    std::memcpy(block, _block, size < _size ? size : _size);
+    Deallocate(_block);
+  }
+  return block;
+}
+
+void ThreadCachingAllocator::Release(void* _block) {
+  allocator_->Deallocate(GetCachingHeader(_block)->unaligned);
+}
+}  // namespace memory
+}  // namespace ozz
@@ -0,0 +1,169 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/base/memory/tracking_allocator.h"
+
+#include <cassert>
+#include <cstring>
+
+#include "ozz/base/maths/math_ex.h"
+
+namespace ozz {
+namespace memory {
+
+namespace {
+// Stored right before each block.
+struct TrackingHeader {
+  // Address returned by the decorated allocator.
+  void* unaligned;
+  // Requested block size.
+  size_t size;
+  // Tag at allocation time.
+  AllocationTag tag;
+};
+
+TrackingHeader* GetTrackingHeader(void* _block) {
+  return reinterpret_cast<TrackingHeader*>(reinterpret_cast<char*>(_block) -
+                                           sizeof(TrackingHeader));
+}
+
+#if __cplusplus >= 201103L
+void Store(std::atomic<size_t>* _counter, size_t _value) {
+  _counter->store(_value);
+}
+size_t Load(const std::atomic<size_t>& _counter) { return _counter.load(); }
+void UpdatePeak(std::atomic<size_t>* _peak, size_t _value) {
+  size_t peak = _peak->load();
+  while (_value > peak && !_peak->compare_exchange_weak(peak, _value)) {
+  }
+}
+#else   // __cplusplus
+void Store(size_t* _counter, size_t _value) { *_counter = _value; }
+size_t Load(size_t _counter) { return _counter; }
+void UpdatePeak(size_t* _peak, size_t _value) {
+  if (_value > *_peak) {
+    *_peak = _value;
+  }
+}
+#endif  // __cplusplus
+}  // namespace
+
+TrackingAllocator::TrackingAllocator(Allocator* _allocator)
+    : allocator_(_allocator) {
+  assert(_allocator && "Invalid allocator");
+  Counters* counters[kNumAllocationTags + 1] = {&global_};
+  for (int i = 0; i < kNumAllocationTags; ++i) {
+    counters[i + 1] = &tags_[i];
+  }
+  for (int i = 0; i < kNumAllocationTags + 1; ++i) {
+    Store(&counters[i]->live_bytes, 0);
+    Store(&counters[i]->peak_bytes, 0);
+    Store(&counters[i]->live_count, 0);
+    Store(&counters[i]->allocation_count, 0);
+  }
+}
+
+TrackingAllocator::~TrackingAllocator() {
+  assert(Load(global_.live_count) == 0 && "Memory leak detected");
+}
+
+AllocationStats TrackingAllocator::ToStats(const Counters& _counters) {
+  const AllocationStats stats = {
+      Load(_counters.live_bytes), Load(_counters.peak_bytes),
+      Load(_counters.live_count), Load(_counters.allocation_count)};
+  return stats;
+}
+
+AllocationStats TrackingAllocator::stats() const { return ToStats(global_); }
+
+AllocationStats TrackingAllocator::stats(AllocationTag _tag) const {
+  assert(_tag >= 0 && _tag < kNumAllocationTags && "Invalid tag");
+  return ToStats(tags_[_tag]);
+}
+
+void TrackingAllocator::ResetCounters() {
+  Store(&global_.peak_bytes, Load(global_.live_bytes));
+  Store(&global_.allocation_count, 0);
+  for (int i = 0; i < kNumAllocationTags; ++i) {
+    Store(&tags_[i].peak_bytes, Load(tags_[i].live_bytes));
+    Store(&tags_[i].allocation_count, 0);
+  }
+}
+
+void* TrackingAllocator::Allocate(size_t _size, size_t _alignment) {
+  // Allocates enough memory to store the header + required alignment space.
+  const size_t alignment = _alignment > OZZ_ALIGN_OF(TrackingHeader)
+                               ? _alignment
+                               : OZZ_ALIGN_OF(TrackingHeader);
+  const size_t offset = math::Align(sizeof(TrackingHeader), alignment);
+  char* unaligned =
+      reinterpret_cast<char*>(allocator_->Allocate(offset + _size, alignment));
+  if (!unaligned) {
+    return NULL;
+  }
+  char* block = unaligned + offset;
+  TrackingHeader* header = GetTrackingHeader(block);
+  header->unaligned = unaligned;
+  header->size = _size;
+  header->tag = allocation_tag();
+
+  // Updates statistics.
+  Counters* counters[2] = {&global_, &tags_[header->tag]};
+  for (int i = 0; i < 2; ++i) {
+    const size_t live = (counters[i]->live_bytes += _size);
+    UpdatePeak(&counters[i]->peak_bytes, live);
+    ++counters[i]->live_count;
+    ++counters[i]->allocation_count;
+  }
+  return block;
+}
+
+void TrackingAllocator::Deallocate(void* _block) {
+  if (!_block) {
+    return;
+  }
+  const TrackingHeader* header = GetTrackingHeader(_block);
+  Counters* counters[2] = {&global_, &tags_[header->tag]};
+  for (int i = 0; i < 2; ++i) {
+    counters[i]->live_bytes -= header->size;
+    --counters[i]->live_count;
+  }
+  allocator_->Deallocate(header->unaligned);
+}
+
+void* TrackingAllocator::Reallocate(void* _block, size_t _size,
+                                    size_t _alignment) {
+  void* new_block = Allocate(_size, _alignment);
+  if (new_block && _block) {
+    const size_t old_size = GetTrackingHeader(_block)->size;
+    std::memcpy(new_block, _block, old_size < _size ? old_size : _size);
+    Deallocate(_block);
+  }
+  return new_block;
+}
+}  // namespace memory
+}  // namespace ozz
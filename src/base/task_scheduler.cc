@@ -0,0 +1,68 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#include "ozz/base/task_scheduler.h"
+
+namespace ozz {
+
+void ParallelFor(TaskScheduler* _scheduler, TaskScheduler::Task _task,
+                 void* _context, int _count) {
+  if (_count <= 0) {
+    return;
+  }
+  if (_scheduler) {
+    _scheduler->ParallelFor(_task, _context, _count);
+  } else {
+    for (int i = 0; i < _count; ++i) {
+      _task(_context, i);
+    }
+  }
+}
+
+TaskGroup::TaskGroup(TaskScheduler* _scheduler) : scheduler_(_scheduler) {}
+
+TaskGroup::~TaskGroup() { Wait(); }
+
+void TaskGroup::Add(TaskScheduler::Task _task, void* _context) {
+  const Entry entry = {_task, _context};
+  tasks_.push_back(entry);
+}
+
+void TaskGroup::Wait() {
+  if (tasks_.empty()) {
+    return;
+  }
+  ParallelFor(scheduler_, &RunTask, this, size());
+  tasks_.clear();
+}
+
+void TaskGroup::RunTask(void* _context, int _index) {
+  const Entry& entry = static_cast<TaskGroup*>(_context)->tasks_[_index];
+  entry.task(entry.context, 0);
+}
+}  // namespace ozz
@@ -0,0 +1,301 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#include "ozz/base/thread_pool.h"
+
+#ifdef OZZ_BASE_THREADS
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif  // OZZ_BASE_THREADS
+
+#include "ozz/base/memory/allocator.h"
+
+namespace ozz {
+
+#ifdef OZZ_BASE_THREADS
+namespace {
+// Spins until _lock is acquired, releases it on destruction. Queues are only
+// locked for a few instructions.
+class QueueLock {
+ public:
+  explicit QueueLock(std::atomic_flag* _lock) : lock_(_lock) {
+    while (lock_->test_and_set(std::memory_order_acquire)) {
+    }
+  }
+  ~QueueLock() { lock_->clear(std::memory_order_release); }
+
+ private:
+  QueueLock(const QueueLock&);
+  void operator=(const QueueLock&);
+  std::atomic_flag* lock_;
+};
+}  // namespace
+
+struct ThreadPool::Impl {
+  // Per-thread queue of tasks, as a range of indices [begin, end[. Task and
+  // context are stored along with the range, so that a stolen range is always
+  // run with the function it was pushed with. Generation is the ParallelFor
+  // call the range belongs to. It prevents a worker that's late from a
+  // previous call from stealing tasks while queues are being filled.
+  struct Queue {
+    std::atomic_flag lock;
+    uint32_t generation;
+    Task task;
+    void* context;
+    int begin;
+    int end;
+    // Avoids false sharing between queues.
+    char padding[64];
+  };
+
+  // Pops a task of _generation from the front of _self queue, or steals the
+  // upper half of another queue if _self queue is empty. Returns false if all
+  // queues are empty.
+  bool Pop(int _self, uint32_t _generation, Task* _task, void** _context,
+           int* _index) {
+    Queue& self = queues[_self];
+    {
+      QueueLock lock(&self.lock);
+      if (self.generation == _generation && self.begin < self.end) {
+        *_task = self.task;
+        *_context = self.context;
+        *_index = self.begin++;
+        return true;
+      }
+    }
+
+    // Steals from other queues, starting with the next one.
+    for (int i = 1; i < num_threads; ++i) {
+      Queue& victim = queues[(_self + i) % num_threads];
+      int begin, end;
+      {
+        QueueLock lock(&victim.lock);
+        const int remaining = victim.end - victim.begin;
+        if (victim.generation != _generation || remaining <= 0) {
+          continue;
+        }
+        *_task = victim.task;
+        *_context = victim.context;
+        begin = victim.end - (remaining + 1) / 2;
+        end = victim.end;
+        victim.end = begin;
+      }
+      ++steals;
+
+      // First stolen task is run right away, others are pushed to _self
+      // queue, where they can be stolen again.
+      *_index = begin++;
+      QueueLock lock(&self.lock);
+      self.generation = _generation;
+      self.task = *_task;
+      self.context = *_context;
+      self.begin = begin;
+      self.end = end;
+      return true;
+    }
+    return false;
+  }
+
+  // Runs tasks of _generation until all queues are empty.
+  void Run(int _self, uint32_t _generation) {
+    Task task;
+    void* context;
+    int index;
+    int ran = 0;
+    for (; Pop(_self, _generation, &task, &context, &index); ++ran) {
+      task(context, index);
+    }
+    if (ran != 0 && pending.fetch_sub(ran) == ran) {
+      std::lock_guard<std::mutex> lock(mutex);
+      completed.notify_all();
+    }
+  }
+
+  // Worker threads loop, _self is the index of the worker queue.
+  void Work(int _self) {
+    if (thread_init) {
+      thread_init(user_data, _self);
+    }
+    uint32_t last = 0;
+    for (;;) {
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!quit && generation == last) {
+          wake.wait(lock);
+        }
+        if (quit) {
+          return;
+        }
+        last = generation;
+      }
+      Run(_self, last);
+    }
+  }
+
+  int num_threads;
+  Queue queues[kMaxThreads];
+
+  // Called by each worker thread when it starts.
+  ThreadInit thread_init;
+  void* user_data;
+
+  // Number of tasks of the current ParallelFor that aren't completed yet.
+  std::atomic<int> pending;
+  std::atomic<int> steals;
+
+  // Wakes up workers when generation changes, or on quit.
+  std::mutex mutex;
+  std::condition_variable wake;
+  std::condition_variable completed;
+  uint32_t generation;
+  bool quit;
+
+  std::thread threads[kMaxThreads];
+};
+#endif  // OZZ_BASE_THREADS
+
+ThreadPool::ThreadPool(int _num_threads, ThreadInit _thread_init,
+                       void* _user_data)
+    : impl_(NULL) {
+#ifdef OZZ_BASE_THREADS
+  int num_threads = _num_threads;
+  if (num_threads <= 0) {
+    num_threads = static_cast<int>(std::thread::hardware_concurrency());
+  }
+  num_threads = num_threads < kMaxThreads ? num_threads : kMaxThreads;
+  if (num_threads <= 1) {
+    return;
+  }
+
+  impl_ = memory::default_allocator()->New<Impl>();
+  impl_->num_threads = num_threads;
+  impl_->thread_init = _thread_init;
+  impl_->user_data = _user_data;
+  for (int i = 0; i < num_threads; ++i) {
+    Impl::Queue& queue = impl_->queues[i];
+    queue.lock.clear();
+    queue.generation = 0;
+    queue.task = NULL;
+    queue.context = NULL;
+    queue.begin = 0;
+    queue.end = 0;
+  }
+  impl_->pending.store(0);
+  impl_->steals.store(0);
+  impl_->generation = 0;
+  impl_->quit = false;
+
+  // Queue 0 belongs to the calling thread.
+  for (int i = 1; i < num_threads; ++i) {
+    impl_->threads[i] = std::thread(&Impl::Work, impl_, i);
+  }
+#else   // OZZ_BASE_THREADS
+  (void)_num_threads;
+  (void)_thread_init;
+  (void)_user_data;
+#endif  // OZZ_BASE_THREADS
+}
+
+ThreadPool::~ThreadPool() {
+#ifdef OZZ_BASE_THREADS
+  if (!impl_) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    impl_->quit = true;
+  }
+  impl_->wake.notify_all();
+  for (int i = 1; i < impl_->num_threads; ++i) {
+    impl_->threads[i].join();
+  }
+  memory::default_allocator()->Delete(impl_);
+#endif  // OZZ_BASE_THREADS
+}
+
+void ThreadPool::ParallelFor(Task _task, void* _context, int _count) {
+#ifdef OZZ_BASE_THREADS
+  if (impl_ && _count > 1) {
+    // Pending count must be set before any task can be popped.
+    impl_->pending.store(_count);
+
+    // Distributes tasks in contiguous blocks. Only this thread writes
+    // generation, so it can be read without locking.
+    const uint32_t generation = impl_->generation + 1;
+    const int num_threads = impl_->num_threads;
+    for (int i = 0; i < num_threads; ++i) {
+      Impl::Queue& queue = impl_->queues[i];
+      QueueLock lock(&queue.lock);
+      queue.generation = generation;
+      queue.task = _task;
+      queue.context = _context;
+      queue.begin = static_cast<int>(static_cast<int64_t>(_count) * i /
+                                     num_threads);
+      queue.end = static_cast<int>(static_cast<int64_t>(_count) * (i + 1) /
+                                   num_threads);
+    }
+
+    // Wakes up workers, and participates.
+    {
+      std::lock_guard<std::mutex> lock(impl_->mutex);
+      impl_->generation = generation;
+    }
+    impl_->wake.notify_all();
+    impl_->Run(0, generation);
+
+    // Waits for tasks run by workers.
+    std::unique_lock<std::mutex> lock(impl_->mutex);
+    while (impl_->pending.load() != 0) {
+      impl_->completed.wait(lock);
+    }
+    return;
+  }
+#endif  // OZZ_BASE_THREADS
+  for (int i = 0; i < _count; ++i) {
+    _task(_context, i);
+  }
+}
+
+int ThreadPool::num_threads() const {
+#ifdef OZZ_BASE_THREADS
+  return impl_ ? impl_->num_threads : 1;
+#else   // OZZ_BASE_THREADS
+  return 1;
+#endif  // OZZ_BASE_THREADS
+}
+
+int ThreadPool::num_steals() const {
+#ifdef OZZ_BASE_THREADS
+  return impl_ ? impl_->steals.load() : 0;
+#else   // OZZ_BASE_THREADS
+  return 0;
+#endif  // OZZ_BASE_THREADS
+}
+}  // namespace ozz
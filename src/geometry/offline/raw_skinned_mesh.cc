@@ -0,0 +1,88 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/geometry/offline/raw_skinned_mesh.h"
+
+namespace ozz {
+namespace geometry {
+namespace offline {
+
+RawSkinnedMesh::RawSkinnedMesh() : influences_count(1) {}
+
+RawSkinnedMesh::~RawSkinnedMesh() {}
+
+bool RawSkinnedMesh::Validate() const {
+  if (influences_count < 1) {
+    return false;
+  }
+
+  // Tests attributes sizes.
+  const size_t count = positions.size();
+  if ((!normals.empty() && normals.size() != count) ||
+      (!tangents.empty() && tangents.size() != count) ||
+      (!uvs.empty() && uvs.size() != count) ||
+      (!colors.empty() && colors.size() != count * 4)) {
+    return false;
+  }
+  if (!tangents.empty() && normals.empty()) {
+    return false;
+  }
+
+  // Tests skinning data.
+  const size_t influences = static_cast<size_t>(influences_count);
+  if (joint_indices.size() != count * influences ||
+      joint_weights.size() != count * influences) {
+    return false;
+  }
+  for (size_t i = 0; i < count; ++i) {
+    float sum = 0.f;
+    for (size_t j = 0; j < influences; ++j) {
+      const float weight = joint_weights[i * influences + j];
+      if (!(weight >= 0.f)) {  // Also rejects NaN.
+        return false;
+      }
+      sum += weight;
+    }
+    if (sum <= 0.f) {
+      return false;
+    }
+  }
+
+  // Tests triangles.
+  if (triangle_indices.size() % 3 != 0) {
+    return false;
+  }
+  for (size_t i = 0; i < triangle_indices.size(); ++i) {
+    if (triangle_indices[i] >= count) {
+      return false;
+    }
+  }
+  return true;
+}
+}  // namespace offline
+}  // namespace geometry
+}  // namespace ozz
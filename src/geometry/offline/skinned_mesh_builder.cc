@@ -0,0 +1,580 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/geometry/offline/skinned_mesh_builder.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/simd_math.h"
+
+#include "ozz/geometry/offline/raw_skinned_mesh.h"
+
+namespace ozz {
+namespace geometry {
+namespace offline {
+
+SkinnedMesh::SkinnedMesh()
+    : vertex_count(0),
+      influences_count(1),
+      positions_format(SkinningJob::kFloat3),
+      normals_format(SkinningJob::kFloat3),
+      tangents_format(SkinningJob::kFloat3),
+      joint_indices_stride(0),
+      joint_weights_stride(0) {}
+
+SkinnedMesh::~SkinnedMesh() {}
+
+SkinnedMeshBuilder::SkinnedMeshBuilder()
+    : max_influences(0),
+      min_bucket_size(0),
+      optimize_vertex_cache(true),
+      vertex_cache_size(32),
+      sort_by_joint(true),
+      min_rigid_range_size(16),
+      positions_format(SkinningJob::kFloat3),
+      normals_format(SkinningJob::kFloat3),
+      tangents_format(SkinningJob::kFloat3),
+      joint_indices_format(kIndicesUint16),
+      joint_weights_format(kWeightsFloat) {}
+
+namespace {
+
+// Vertex influence, as a joint index and its weight.
+struct Influence {
+  uint16_t joint;
+  float weight;
+};
+
+// Sorts influences by decreasing weight, then by joint index so that output is
+// deterministic.
+bool SortInfluences(const Influence& _left, const Influence& _right) {
+  return _left.weight > _right.weight ||
+         (_left.weight == _right.weight && _left.joint < _right.joint);
+}
+
+// Vertex cache optimization, following Tom Forsyth's "Linear-Speed Vertex
+// Cache Optimisation"
+// (https://tomforsyth1000.github.io/papers/fast_vert_cache_opt.html).
+// Triangles are greedily emitted by score, which is the sum of their vertices
+// score. A vertex scores higher when it's recently used (in the simulated LRU
+// cache) and when it has few remaining triangles to emit, so that isolated
+// triangles aren't left behind.
+const float kCacheDecayPower = 1.5f;
+const float kLastTriangleScore = .75f;
+const float kValenceBoostScale = 2.f;
+const float kValenceBoostPower = .5f;
+
+float VertexScore(int _cache_position, int _valence, int _cache_size) {
+  if (_valence == 0) {
+    return -1.f;  // No more triangle to emit using this vertex.
+  }
+  float score = 0.f;
+  if (_cache_position >= 0) {
+    if (_cache_position < 3) {
+      // Vertices of the last emitted triangle get a fixed score, to avoid
+      // favoring triangles sharing a single edge only.
+      score = kLastTriangleScore;
+    } else {
+      const float scale = 1.f / (_cache_size - 3);
+      score = std::pow(1.f - (_cache_position - 3) * scale, kCacheDecayPower);
+    }
+  }
+  const float valence = static_cast<float>(_valence);
+  return score + kValenceBoostScale * std::pow(valence, -kValenceBoostPower);
+}
+
+void OptimizeVertexCache(const ozz::Vector<uint32_t>::Std& _indices,
+                         int _vertex_count, int _cache_size,
+                         ozz::Vector<uint32_t>::Std* _output) {
+  const int triangle_count = static_cast<int>(_indices.size() / 3);
+  _output->clear();
+  _output->reserve(_indices.size());
+  if (triangle_count == 0) {
+    return;
+  }
+
+  // Builds vertex to triangles adjacency. Triangles of a vertex that are still
+  // to be emitted are kept at the beginning of its range, valence long.
+  ozz::Vector<int>::Std valences(_vertex_count, 0);
+  for (size_t i = 0; i < _indices.size(); ++i) {
+    ++valences[_indices[i]];
+  }
+  ozz::Vector<int>::Std offsets(_vertex_count + 1, 0);
+  for (int i = 0; i < _vertex_count; ++i) {
+    offsets[i + 1] = offsets[i] + valences[i];
+  }
+  ozz::Vector<int>::Std adjacency(_indices.size());
+  {
+    ozz::Vector<int>::Std fill(offsets.begin(), offsets.end() - 1);
+    for (size_t i = 0; i < _indices.size(); ++i) {
+      adjacency[fill[_indices[i]]++] = static_cast<int>(i / 3);
+    }
+  }
+
+  // Initializes scores.
+  ozz::Vector<int>::Std cache_positions(_vertex_count, -1);
+  ozz::Vector<float>::Std vertex_scores(_vertex_count);
+  for (int i = 0; i < _vertex_count; ++i) {
+    vertex_scores[i] = VertexScore(-1, valences[i], _cache_size);
+  }
+  ozz::Vector<bool>::Std emitted(triangle_count, false);
+  int best = 0;
+  float best_score = -1.f;
+  for (int t = 0; t < triangle_count; ++t) {
+    const float score = vertex_scores[_indices[t * 3 + 0]] +
+                        vertex_scores[_indices[t * 3 + 1]] +
+                        vertex_scores[_indices[t * 3 + 2]];
+    if (score > best_score) {
+      best_score = score;
+      best = t;
+    }
+  }
+
+  // Simulated LRU cache, which is allowed to temporarily grow by the 3
+  // vertices of the emitted triangle.
+  ozz::Vector<int>::Std cache;
+  ozz::Vector<int>::Std next_cache;
+  cache.reserve(_cache_size + 3);
+  next_cache.reserve(_cache_size + 3);
+
+  int cursor = 0;  // Fallback search position.
+  for (int emitted_count = 0; emitted_count < triangle_count;
+       ++emitted_count) {
+    if (best < 0) {
+      // No scored triangle adjacent to the cache, takes the next one that
+      // isn't emitted.
+      while (emitted[cursor]) {
+        ++cursor;
+      }
+      best = cursor;
+    }
+
+    // Emits best triangle and removes it from its vertices adjacency.
+    emitted[best] = true;
+    next_cache.clear();
+    for (int c = 0; c < 3; ++c) {
+      const int v = _indices[best * 3 + c];
+      _output->push_back(v);
+      int* begin = &adjacency[offsets[v]];
+      int* end = begin + valences[v];
+      *std::find(begin, end, best) = *(end - 1);
+      --valences[v];
+      if (std::find(next_cache.begin(), next_cache.end(), v) ==
+          next_cache.end()) {
+        next_cache.push_back(v);
+      }
+    }
+
+    // Updates cache, most recently used vertices first.
+    const int emitted_vertices = static_cast<int>(next_cache.size());
+    for (size_t i = 0; i < cache.size(); ++i) {
+      const int v = cache[i];
+      const int* begin = &next_cache[0];
+      if (std::find(begin, begin + emitted_vertices, v) ==
+          begin + emitted_vertices) {
+        next_cache.push_back(v);
+      }
+    }
+    cache.swap(next_cache);
+    for (size_t i = 0; i < cache.size(); ++i) {
+      const int v = cache[i];
+      cache_positions[v] = i < static_cast<size_t>(_cache_size)
+                               ? static_cast<int>(i)
+                               : -1;
+      vertex_scores[v] =
+          VertexScore(cache_positions[v], valences[v], _cache_size);
+    }
+    if (cache.size() > static_cast<size_t>(_cache_size)) {
+      cache.resize(_cache_size);
+    }
+
+    // Updates remaining triangles of cached vertices, and selects the best
+    // one.
+    best = -1;
+    best_score = -1.f;
+    for (size_t i = 0; i < cache.size(); ++i) {
+      const int v = cache[i];
+      for (int a = offsets[v]; a < offsets[v] + valences[v]; ++a) {
+        const int t = adjacency[a];
+        const float score = vertex_scores[_indices[t * 3 + 0]] +
+                            vertex_scores[_indices[t * 3 + 1]] +
+                            vertex_scores[_indices[t * 3 + 2]];
+        if (score > best_score) {
+          best_score = score;
+          best = t;
+        }
+      }
+    }
+  }
+}
+
+// Sorts vertices by group (bucket, rigid vertices first), then dominant
+// joint, then first use.
+struct VertexLess {
+  bool operator()(uint32_t _left, uint32_t _right) const {
+    if (groups[_left] != groups[_right]) {
+      return groups[_left] < groups[_right];
+    }
+    if (joints && joints[_left] != joints[_right]) {
+      return joints[_left] < joints[_right];
+    }
+    return first_uses[_left] < first_uses[_right];
+  }
+  const int* groups;
+  const uint16_t* joints;
+  const uint32_t* first_uses;
+};
+
+size_t FormatSize(SkinningJob::Format _format) {
+  switch (_format) {
+    case SkinningJob::kHalf3:
+      return 3 * sizeof(uint16_t);
+    case SkinningJob::kSnorm16x3:
+      return 3 * sizeof(int16_t);
+    case SkinningJob::kSnorm10x3_2:
+      return sizeof(uint32_t);
+    default:
+      return 3 * sizeof(float);
+  }
+}
+
+// Encodes a 3 components vector to _format, at _dest. _w is only used by
+// kSnorm10x3_2 format.
+void Encode(const math::Float3& _value, float _w, SkinningJob::Format _format,
+            uint8_t* _dest) {
+  const float values[3] = {_value.x, _value.y, _value.z};
+  switch (_format) {
+    case SkinningJob::kFloat3: {
+      std::memcpy(_dest, values, sizeof(values));
+      break;
+    }
+    case SkinningJob::kHalf3: {
+      uint16_t halves[3];
+      for (int i = 0; i < 3; ++i) {
+        halves[i] = math::FloatToHalf(values[i]);
+      }
+      std::memcpy(_dest, halves, sizeof(halves));
+      break;
+    }
+    case SkinningJob::kSnorm16x3: {
+      int16_t snorms[3];
+      for (int i = 0; i < 3; ++i) {
+        snorms[i] = static_cast<int16_t>(
+            std::floor(math::Clamp(-1.f, values[i], 1.f) * 32767.f + .5f));
+      }
+      std::memcpy(_dest, snorms, sizeof(snorms));
+      break;
+    }
+    case SkinningJob::kSnorm10x3_2: {
+      uint32_t packed = _w < 0.f ? 3u << 30 : 1u << 30;
+      for (int i = 0; i < 3; ++i) {
+        const int snorm = static_cast<int>(
+            std::floor(math::Clamp(-1.f, values[i], 1.f) * 511.f + .5f));
+        packed |= (static_cast<uint32_t>(snorm) & 0x3ff) << (i * 10);
+      }
+      std::memcpy(_dest, &packed, sizeof(packed));
+      break;
+    }
+  }
+}
+}  // namespace
+
+bool SkinnedMeshBuilder::operator()(const RawSkinnedMesh& _input,
+                                    SkinnedMesh* _output) const {
+  if (!_output || !_input.Validate()) {
+    return false;
+  }
+  if (max_influences < 0 || min_bucket_size < 0 || min_rigid_range_size < 0 ||
+      (optimize_vertex_cache && vertex_cache_size < 4) ||
+      (positions_format != SkinningJob::kFloat3 &&
+       positions_format != SkinningJob::kHalf3)) {
+    return false;
+  }
+
+  const int vertex_count = _input.vertex_count();
+  const int in_influences = _input.influences_count;
+
+  // Sorts and limits influences of every vertex, and finds the number of
+  // significant influences.
+  int influences_count = 1;
+  ozz::Vector<Influence>::Std influences(vertex_count * in_influences);
+  ozz::Vector<int>::Std counts(vertex_count);
+  for (int i = 0; i < vertex_count; ++i) {
+    Influence* begin = &influences[i * in_influences];
+    for (int j = 0; j < in_influences; ++j) {
+      begin[j].joint = _input.joint_indices[i * in_influences + j];
+      begin[j].weight = _input.joint_weights[i * in_influences + j];
+    }
+    std::sort(begin, begin + in_influences, &SortInfluences);
+    int count = 0;
+    while (count < in_influences && begin[count].weight > 0.f) {
+      ++count;
+    }
+    if (max_influences > 0 && count > max_influences) {
+      count = max_influences;
+    }
+    float sum = 0.f;
+    for (int j = 0; j < count; ++j) {
+      sum += begin[j].weight;
+    }
+    for (int j = 0; j < count; ++j) {
+      begin[j].weight /= sum;
+    }
+    counts[i] = count;
+    influences_count = std::max(influences_count, count);
+  }
+
+  // Validates compact formats.
+  const bool indices_u8 = joint_indices_format == kIndicesUint8;
+  if ((indices_u8 || joint_weights_format != kWeightsFloat) &&
+      influences_count > SkinningJob::kMaxCompactInfluences) {
+    return false;
+  }
+  if (indices_u8) {
+    for (int i = 0; i < vertex_count; ++i) {
+      for (int j = 0; j < counts[i]; ++j) {
+        if (influences[i * in_influences + j].joint > 255) {
+          return false;
+        }
+      }
+    }
+  }
+
+  // Buckets vertices by number of influences. Small buckets are merged into
+  // the next one.
+  ozz::Vector<int>::Std buckets(influences_count, 0);
+  for (int i = 0; i < vertex_count; ++i) {
+    ++buckets[counts[i] - 1];
+  }
+  ozz::Vector<int>::Std bucket_remap(influences_count);
+  for (int i = 0; i < influences_count; ++i) {
+    bucket_remap[i] = i;
+  }
+  for (int i = 0; i < influences_count - 1; ++i) {
+    if (buckets[i] > 0 && buckets[i] < min_bucket_size) {
+      buckets[i + 1] += buckets[i];
+      buckets[i] = 0;
+      for (int j = 0; j <= i; ++j) {
+        if (bucket_remap[j] == i) {
+          bucket_remap[j] = i + 1;
+        }
+      }
+    }
+  }
+  ozz::Vector<int>::Std vertex_buckets(vertex_count);
+  ozz::Vector<uint16_t>::Std dominant_joints(vertex_count);
+  for (int i = 0; i < vertex_count; ++i) {
+    vertex_buckets[i] = bucket_remap[counts[i] - 1];
+    dominant_joints[i] = influences[i * in_influences].joint;
+  }
+
+  // Finds rigid vertices, that is vertices of the single influence bucket
+  // whose joint binds at least min_rigid_range_size of them. Sorting groups
+  // place them before any other vertex.
+  const bool rigid = sort_by_joint && min_rigid_range_size > 0;
+  ozz::Vector<int>::Std rigid_counts;
+  for (int i = 0; rigid && i < vertex_count; ++i) {
+    if (vertex_buckets[i] == 0) {
+      const size_t joint = dominant_joints[i];
+      if (joint >= rigid_counts.size()) {
+        rigid_counts.resize(joint + 1, 0);
+      }
+      ++rigid_counts[joint];
+    }
+  }
+  ozz::Vector<int>::Std vertex_groups(vertex_count);
+  ozz::Vector<bool>::Std rigid_vertices(vertex_count, false);
+  for (int i = 0; i < vertex_count; ++i) {
+    rigid_vertices[i] = rigid && vertex_buckets[i] == 0 &&
+                        rigid_counts[dominant_joints[i]] >=
+                            min_rigid_range_size;
+    vertex_groups[i] = rigid_vertices[i] ? 0 : vertex_buckets[i] + 1;
+  }
+
+  // Reorders triangles.
+  ozz::Vector<uint32_t>::Std triangle_indices;
+  if (optimize_vertex_cache) {
+    OptimizeVertexCache(_input.triangle_indices, vertex_count,
+                        vertex_cache_size, &triangle_indices);
+  } else {
+    triangle_indices = _input.triangle_indices;
+  }
+
+  // Sorts vertices. First use order keeps vertices fetched by consecutive
+  // triangles close in memory. Unused vertices are pushed back.
+  const uint32_t kUnused = ~0u;
+  ozz::Vector<uint32_t>::Std first_uses(vertex_count, kUnused);
+  uint32_t uses = 0;
+  for (size_t i = 0; i < triangle_indices.size(); ++i) {
+    uint32_t& first_use = first_uses[triangle_indices[i]];
+    if (first_use == kUnused) {
+      first_use = uses++;
+    }
+  }
+  for (int i = 0; i < vertex_count; ++i) {
+    if (first_uses[i] == kUnused) {
+      first_uses[i] = uses++;
+    }
+  }
+  ozz::Vector<uint32_t>::Std vertex_remap(vertex_count);
+  for (int i = 0; i < vertex_count; ++i) {
+    vertex_remap[i] = i;
+  }
+  if (vertex_count) {
+    const VertexLess less = {&vertex_groups[0],
+                             sort_by_joint ? &dominant_joints[0] : NULL,
+                             &first_uses[0]};
+    std::sort(vertex_remap.begin(), vertex_remap.end(), less);
+  }
+
+  // Remaps triangle indices.
+  ozz::Vector<uint32_t>::Std original_to_new(vertex_count);
+  for (int i = 0; i < vertex_count; ++i) {
+    original_to_new[vertex_remap[i]] = i;
+  }
+  for (size_t i = 0; i < triangle_indices.size(); ++i) {
+    triangle_indices[i] = original_to_new[triangle_indices[i]];
+  }
+
+  // Builds rigid ranges from sorted rigid vertices.
+  ozz::Vector<SkinningJob::RigidRange>::Std rigid_ranges;
+  for (int i = 0; i < vertex_count && rigid_vertices[vertex_remap[i]]; ++i) {
+    const int joint = dominant_joints[vertex_remap[i]];
+    if (rigid_ranges.empty() || rigid_ranges.back().joint != joint) {
+      const SkinningJob::RigidRange range = {joint, 0};
+      rigid_ranges.push_back(range);
+    }
+    ++rigid_ranges.back().vertex_count;
+  }
+
+  // Fills output, which can't fail anymore.
+  SkinnedMesh& output = *_output;
+  output.vertex_count = vertex_count;
+  output.influences_count = influences_count;
+  output.influences_buckets.swap(buckets);
+  output.rigid_ranges.swap(rigid_ranges);
+  output.vertex_remap.swap(vertex_remap);
+  output.triangle_indices.swap(triangle_indices);
+
+  // Vertex attributes.
+  output.positions_format = positions_format;
+  output.normals_format = normals_format;
+  output.tangents_format = tangents_format;
+  output.positions.resize(vertex_count * FormatSize(positions_format));
+  output.normals.resize(_input.normals.empty()
+                            ? 0
+                            : vertex_count * FormatSize(normals_format));
+  output.tangents.resize(_input.tangents.empty()
+                             ? 0
+                             : vertex_count * FormatSize(tangents_format));
+  output.uvs.resize(_input.uvs.size());
+  output.colors.resize(_input.colors.size());
+  for (int i = 0; i < vertex_count; ++i) {
+    const uint32_t src = output.vertex_remap[i];
+    Encode(_input.positions[src], 0.f, positions_format,
+           &output.positions[i * FormatSize(positions_format)]);
+    if (!output.normals.empty()) {
+      Encode(_input.normals[src], 0.f, normals_format,
+             &output.normals[i * FormatSize(normals_format)]);
+    }
+    if (!output.tangents.empty()) {
+      const math::Float4& tangent = _input.tangents[src];
+      Encode(math::Float3(tangent.x, tangent.y, tangent.z), tangent.w,
+             tangents_format,
+             &output.tangents[i * FormatSize(tangents_format)]);
+    }
+    if (!output.uvs.empty()) {
+      output.uvs[i] = _input.uvs[src];
+    }
+    if (!output.colors.empty()) {
+      std::memcpy(&output.colors[i * 4], &_input.colors[src * 4], 4);
+    }
+  }
+
+  // Joint indices, padded with the dominant joint which has a 0 weight.
+  const size_t index_size = indices_u8 ? sizeof(uint8_t) : sizeof(uint16_t);
+  output.joint_indices_stride = influences_count * index_size;
+  output.joint_indices.resize(vertex_count * output.joint_indices_stride);
+  for (int i = 0; i < vertex_count; ++i) {
+    const uint32_t src = output.vertex_remap[i];
+    const Influence* in = &influences[src * in_influences];
+    uint8_t* dest = &output.joint_indices[i * output.joint_indices_stride];
+    for (int j = 0; j < influences_count; ++j) {
+      const uint16_t joint = j < counts[src] ? in[j].joint : in[0].joint;
+      if (indices_u8) {
+        dest[j] = static_cast<uint8_t>(joint);
+      } else {
+        std::memcpy(dest + j * sizeof(uint16_t), &joint, sizeof(joint));
+      }
+    }
+  }
+
+  // Joint weights, the last one being implicit. Quantized weights are computed
+  // from quantized cumulative sums, so that rounding errors don't accumulate
+  // and the restored last weight is never negative.
+  const size_t weight_size = joint_weights_format == kWeightsUnorm8
+                                 ? sizeof(uint8_t)
+                                 : joint_weights_format == kWeightsUnorm16
+                                       ? sizeof(uint16_t)
+                                       : sizeof(float);
+  const int weights_count = influences_count - 1;
+  output.joint_weights_stride = weights_count * weight_size;
+  output.joint_weights.resize(vertex_count * output.joint_weights_stride);
+  const float scale = joint_weights_format == kWeightsUnorm8 ? 255.f : 65535.f;
+  for (int i = 0; i < vertex_count; ++i) {
+    const uint32_t src = output.vertex_remap[i];
+    const Influence* in = &influences[src * in_influences];
+    uint8_t* dest = &output.joint_weights[i * output.joint_weights_stride];
+    float sum = 0.f;
+    int quantized_sum = 0;
+    for (int j = 0; j < weights_count; ++j) {
+      const float weight = j < counts[src] ? in[j].weight : 0.f;
+      if (joint_weights_format == kWeightsFloat) {
+        std::memcpy(dest + j * sizeof(float), &weight, sizeof(float));
+        continue;
+      }
+      sum = math::Min(sum + weight, 1.f);
+      const int cumulative = static_cast<int>(sum * scale + .5f);
+      const int quantized = cumulative - quantized_sum;
+      quantized_sum = cumulative;
+      if (joint_weights_format == kWeightsUnorm8) {
+        dest[j] = static_cast<uint8_t>(quantized);
+      } else {
+        const uint16_t value = static_cast<uint16_t>(quantized);
+        std::memcpy(dest + j * sizeof(uint16_t), &value, sizeof(value));
+      }
+    }
+  }
+  return true;
+}
+}  // namespace offline
+}  // namespace geometry
+}  // namespace ozz
@@ -0,0 +1,490 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#include "ozz/geometry/runtime/mesh_bvh.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "ozz/base/maths/simd_math.h"
+
+namespace ozz {
+namespace geometry {
+namespace internal {
+struct BvhTriangle {
+  math::Float3 centroid;
+  math::Box bounds;
+  int index;
+};
+}  // namespace internal
+
+namespace {
+// Maximum depth of queries traversal stack. Median splits keep the hierarchy
+// balanced, so this is way more than enough.
+const int kBvhStackSize = 64;
+
+// Tests if _size bytes are enough to store _count elements of _element_size
+// bytes, with _stride bytes between each element.
+bool BvhBufferFits(size_t _size, size_t _stride, size_t _element_size,
+                   int _count) {
+  if (_stride < _element_size) {
+    return false;
+  }
+  return _count == 0 || _size >= _stride * (_count - 1) + _element_size;
+}
+
+// Reads the position of vertex _index.
+OZZ_INLINE math::Float3 LoadPosition(const float* _positions, size_t _stride,
+                                     int _index) {
+  const float* p = reinterpret_cast<const float*>(
+      reinterpret_cast<const char*>(_positions) + _stride * _index);
+  return math::Float3(p[0], p[1], p[2]);
+}
+
+// Orders triangles along an axis, by centroid.
+struct CentroidLess {
+  explicit CentroidLess(int _axis) : axis(_axis) {}
+  bool operator()(const internal::BvhTriangle& _a,
+                  const internal::BvhTriangle& _b) const {
+    return (&_a.centroid.x)[axis] < (&_b.centroid.x)[axis];
+  }
+  int axis;
+};
+
+// Transforms _box by _matrix, conservatively: the returned box contains the
+// whole transformed box, whatever _matrix rotation.
+math::Box TransformBoxConservative(const math::Float4x4& _matrix,
+                                   const math::Box& _box) {
+  const math::SimdFloat4 half = math::simd_float4::Load1(.5f);
+  const math::SimdFloat4 min = math::simd_float4::Load3PtrU(&_box.min.x);
+  const math::SimdFloat4 max = math::simd_float4::Load3PtrU(&_box.max.x);
+  const math::SimdFloat4 center =
+      math::TransformPoint(_matrix, (min + max) * half);
+  const math::SimdFloat4 extent = (max - min) * half;
+  const math::SimdFloat4 radius =
+      math::Abs(_matrix.cols[0]) * math::SplatX(extent) +
+      math::Abs(_matrix.cols[1]) * math::SplatY(extent) +
+      math::Abs(_matrix.cols[2]) * math::SplatZ(extent);
+
+  // Pads radius to compensate for rounding errors, which would otherwise
+  // leave vertices lying on bounds just outside.
+  const math::SimdFloat4 padded =
+      radius + (math::Abs(center) + radius) * math::simd_float4::Load1(1e-5f);
+  math::Box box;
+  math::Store3PtrU(center - padded, &box.min.x);
+  math::Store3PtrU(center + padded, &box.max.x);
+  return box;
+}
+
+// Computes ray entry distance in the box [_min, _max]. Returns false if the
+// ray misses the box, or enters it further than _max_distance.
+OZZ_INLINE bool RayIntersectsBox(const math::Float3& _origin,
+                                 const math::Float3& _inv_direction,
+                                 const math::Float3& _min,
+                                 const math::Float3& _max,
+                                 float _max_distance, float* _distance) {
+  const math::Float3 t0 = (_min - _origin) * _inv_direction;
+  const math::Float3 t1 = (_max - _origin) * _inv_direction;
+  const math::Float3 tmin = math::Min(t0, t1);
+  const math::Float3 tmax = math::Max(t0, t1);
+  const float enter = std::max(std::max(tmin.x, tmin.y), std::max(tmin.z, 0.f));
+  const float exit =
+      std::min(std::min(tmax.x, tmax.y), std::min(tmax.z, _max_distance));
+  *_distance = enter;
+  return enter <= exit;
+}
+
+// Intersects the ray with triangle (_p0, _p1, _p2), from both sides
+// (Moller-Trumbore algorithm). Returns false if the triangle is missed, or if
+// it's further than _max_distance.
+OZZ_INLINE bool RayIntersectsTriangle(const math::Float3& _origin,
+                                      const math::Float3& _direction,
+                                      const math::Float3& _p0,
+                                      const math::Float3& _p1,
+                                      const math::Float3& _p2,
+                                      float _max_distance, float* _distance) {
+  const math::Float3 e1 = _p1 - _p0;
+  const math::Float3 e2 = _p2 - _p0;
+  const math::Float3 p = Cross(_direction, e2);
+  const float det = Dot(e1, p);
+  if (det == 0.f) {  // Ray is parallel to the triangle.
+    return false;
+  }
+  const float inv_det = 1.f / det;
+  const math::Float3 s = _origin - _p0;
+  const float u = Dot(s, p) * inv_det;
+  if (u < 0.f || u > 1.f) {
+    return false;
+  }
+  const math::Float3 q = Cross(s, e1);
+  const float v = Dot(_direction, q) * inv_det;
+  if (v < 0.f || u + v > 1.f) {
+    return false;
+  }
+  const float t = Dot(e2, q) * inv_det;
+  if (t < 0.f || t > _max_distance) {
+    return false;
+  }
+  *_distance = t;
+  return true;
+}
+}  // namespace
+
+MeshBvh::MeshBvh() : vertex_count_(0), joint_count_(0) {}
+
+bool MeshBvh::Build(const Range<const uint16_t>& _indices,
+                    const Range<const float>& _positions,
+                    size_t _positions_stride) {
+  nodes_.clear();
+  indices_.clear();
+  triangles_.clear();
+  bind_bounds_.clear();
+  node_joints_.clear();
+  joints_.clear();
+  vertex_count_ = 0;
+  joint_count_ = 0;
+
+  const size_t index_count = _indices.count();
+  if (index_count % 3 != 0) {
+    return false;
+  }
+  int vertex_count = 0;
+  for (size_t i = 0; i < index_count; ++i) {
+    vertex_count = std::max(vertex_count, _indices[i] + 1);
+  }
+  if (!BvhBufferFits(_positions.size(), _positions_stride, sizeof(float) * 3,
+                     vertex_count)) {
+    return false;
+  }
+  const int triangle_count = static_cast<int>(index_count / 3);
+  if (triangle_count == 0) {
+    return true;
+  }
+
+  // Computes triangles centroid and bounds.
+  ozz::Vector<internal::BvhTriangle>::Std triangles(triangle_count);
+  for (int i = 0; i < triangle_count; ++i) {
+    const math::Float3 p0 =
+        LoadPosition(_positions.begin, _positions_stride, _indices[i * 3 + 0]);
+    const math::Float3 p1 =
+        LoadPosition(_positions.begin, _positions_stride, _indices[i * 3 + 1]);
+    const math::Float3 p2 =
+        LoadPosition(_positions.begin, _positions_stride, _indices[i * 3 + 2]);
+    internal::BvhTriangle& triangle = triangles[i];
+    triangle.bounds.min = Min(p0, Min(p1, p2));
+    triangle.bounds.max = Max(p0, Max(p1, p2));
+    triangle.centroid = (p0 + p1 + p2) / 3.f;
+    triangle.index = i;
+  }
+
+  // Builds nodes, which reorders triangles.
+  nodes_.reserve(2 * (triangle_count / kMaxLeafTriangles) + 1);
+  BuildNode(&triangles[0], 0, triangle_count);
+
+  // Copies triangles in leaves order.
+  triangles_.resize(triangle_count);
+  indices_.resize(index_count);
+  for (int i = 0; i < triangle_count; ++i) {
+    const int index = triangles[i].index;
+    triangles_[i] = index;
+    indices_[i * 3 + 0] = _indices[index * 3 + 0];
+    indices_[i * 3 + 1] = _indices[index * 3 + 1];
+    indices_[i * 3 + 2] = _indices[index * 3 + 2];
+  }
+  vertex_count_ = vertex_count;
+
+  // Keeps build bounds for joint refit.
+  bind_bounds_.resize(nodes_.size());
+  for (size_t i = 0; i < nodes_.size(); ++i) {
+    bind_bounds_[i] = math::Box(nodes_[i].min, nodes_[i].max);
+  }
+  return true;
+}
+
+void MeshBvh::BuildNode(internal::BvhTriangle* _triangles, int _begin,
+                        int _end) {
+  // Computes node bounds, and the bounds of triangles centroids, which
+  // selects the split axis.
+  math::Box bounds = _triangles[_begin].bounds;
+  math::Box centroids(_triangles[_begin].centroid);
+  for (int i = _begin + 1; i < _end; ++i) {
+    bounds = Merge(bounds, _triangles[i].bounds);
+    centroids = Merge(centroids, math::Box(_triangles[i].centroid));
+  }
+
+  const int index = static_cast<int>(nodes_.size());
+  const Node node = {bounds.min, _begin, bounds.max, 0};
+  nodes_.push_back(node);
+
+  const int count = _end - _begin;
+  if (count <= kMaxLeafTriangles) {
+    nodes_[index].count = count;
+    return;
+  }
+
+  // Splits triangles in two halves, around the median centroid along the
+  // longest axis.
+  const math::Float3 extent = centroids.max - centroids.min;
+  const int axis = extent.x >= extent.y && extent.x >= extent.z
+                       ? 0
+                       : (extent.y >= extent.z ? 1 : 2);
+  const int middle = _begin + count / 2;
+  std::nth_element(_triangles + _begin, _triangles + middle,
+                   _triangles + _end, CentroidLess(axis));
+
+  BuildNode(_triangles, _begin, middle);
+  nodes_[index].first = static_cast<int>(nodes_.size());
+  BuildNode(_triangles, middle, _end);
+}
+
+bool MeshBvh::SetupJointRefit(const Range<const uint16_t>& _joint_indices,
+                              size_t _joint_indices_stride,
+                              int _influences_count) {
+  node_joints_.clear();
+  joints_.clear();
+  joint_count_ = 0;
+  if (nodes_.empty() || _influences_count <= 0 ||
+      !BvhBufferFits(_joint_indices.size(), _joint_indices_stride,
+                     sizeof(uint16_t) * _influences_count, vertex_count_)) {
+    return false;
+  }
+
+  // Gathers the unique joints influencing each leaf.
+  ozz::Vector<uint16_t>::Std leaf_joints;
+  node_joints_.resize(nodes_.size() + 1);
+  for (size_t i = 0; i < nodes_.size(); ++i) {
+    node_joints_[i] = static_cast<int>(joints_.size());
+    const Node& node = nodes_[i];
+    leaf_joints.clear();
+    for (int t = node.first; t < node.first + node.count; ++t) {
+      for (int v = 0; v < 3; ++v) {
+        const uint16_t* indices = reinterpret_cast<const uint16_t*>(
+            reinterpret_cast<const char*>(_joint_indices.begin) +
+            _joint_indices_stride * indices_[t * 3 + v]);
+        leaf_joints.insert(leaf_joints.end(), indices,
+                           indices + _influences_count);
+      }
+    }
+    std::sort(leaf_joints.begin(), leaf_joints.end());
+    leaf_joints.erase(std::unique(leaf_joints.begin(), leaf_joints.end()),
+                      leaf_joints.end());
+    joints_.insert(joints_.end(), leaf_joints.begin(), leaf_joints.end());
+    if (!leaf_joints.empty()) {
+      joint_count_ = std::max(joint_count_, leaf_joints.back() + 1);
+    }
+  }
+  node_joints_.back() = static_cast<int>(joints_.size());
+  return true;
+}
+
+bool MeshBvh::Refit(const Range<const float>& _positions,
+                    size_t _positions_stride) {
+  if (!BvhBufferFits(_positions.size(), _positions_stride, sizeof(float) * 3,
+                     vertex_count_)) {
+    return false;
+  }
+
+  // Children come after their parent, so iterating backward refits them
+  // first.
+  for (int i = static_cast<int>(nodes_.size()) - 1; i >= 0; --i) {
+    Node& node = nodes_[i];
+    if (node.count == 0) {
+      const Node& left = nodes_[i + 1];
+      const Node& right = nodes_[node.first];
+      node.min = Min(left.min, right.min);
+      node.max = Max(left.max, right.max);
+      continue;
+    }
+    const uint16_t* indices = &indices_[node.first * 3];
+    math::Float3 min = LoadPosition(_positions.begin, _positions_stride,
+                                    indices[0]);
+    math::Float3 max = min;
+    for (int v = 1; v < node.count * 3; ++v) {
+      const math::Float3 p =
+          LoadPosition(_positions.begin, _positions_stride, indices[v]);
+      min = Min(min, p);
+      max = Max(max, p);
+    }
+    node.min = min;
+    node.max = max;
+  }
+  return true;
+}
+
+bool MeshBvh::Refit(const Range<const math::Float4x4>& _joint_matrices) {
+  if (!joint_refit() ||
+      _joint_matrices.count() < static_cast<size_t>(joint_count_)) {
+    return false;
+  }
+
+  for (int i = static_cast<int>(nodes_.size()) - 1; i >= 0; --i) {
+    Node& node = nodes_[i];
+    if (node.count == 0) {
+      const Node& left = nodes_[i + 1];
+      const Node& right = nodes_[node.first];
+      node.min = Min(left.min, right.min);
+      node.max = Max(left.max, right.max);
+      continue;
+    }
+
+    // Merges leaf bind bounds transformed by every joint influencing it.
+    math::Box bounds;
+    for (int j = node_joints_[i]; j < node_joints_[i + 1]; ++j) {
+      bounds = Merge(bounds, TransformBoxConservative(
+                                 _joint_matrices[joints_[j]], bind_bounds_[i]));
+    }
+    node.min = bounds.min;
+    node.max = bounds.max;
+  }
+  return true;
+}
+
+bool MeshBvh::Raycast(const math::Float3& _origin,
+                      const math::Float3& _direction,
+                      const Range<const float>& _positions,
+                      size_t _positions_stride, float _max_distance,
+                      MeshBvhHit* _hit) const {
+  if (nodes_.empty() || !_hit ||
+      !BvhBufferFits(_positions.size(), _positions_stride, sizeof(float) * 3,
+                     vertex_count_)) {
+    return false;
+  }
+
+  const math::Float3 inv_direction(1.f / _direction.x, 1.f / _direction.y,
+                                   1.f / _direction.z);
+  float closest = _max_distance;
+  int hit = -1;
+
+  int stack[kBvhStackSize];
+  int stack_size = 0;
+  stack[stack_size++] = 0;
+  while (stack_size) {
+    const Node& node = nodes_[stack[--stack_size]];
+    float distance;
+    if (!RayIntersectsBox(_origin, inv_direction, node.min, node.max, closest,
+                          &distance)) {
+      continue;
+    }
+
+    if (node.count) {
+      for (int t = node.first; t < node.first + node.count; ++t) {
+        const uint16_t* indices = &indices_[t * 3];
+        if (RayIntersectsTriangle(
+                _origin, _direction,
+                LoadPosition(_positions.begin, _positions_stride, indices[0]),
+                LoadPosition(_positions.begin, _positions_stride, indices[1]),
+                LoadPosition(_positions.begin, _positions_stride, indices[2]),
+                closest, &distance)) {
+          closest = distance;
+          hit = t;
+        }
+      }
+      continue;
+    }
+
+    // Pushes the nearest child last, so it's visited first and shrinks the
+    // closest distance before the other one is tested.
+    const int left = static_cast<int>(&node - &nodes_[0]) + 1;
+    const int right = node.first;
+    float left_distance, right_distance;
+    const bool left_hit =
+        RayIntersectsBox(_origin, inv_direction, nodes_[left].min,
+                         nodes_[left].max, closest, &left_distance);
+    const bool right_hit =
+        RayIntersectsBox(_origin, inv_direction, nodes_[right].min,
+                         nodes_[right].max, closest, &right_distance);
+    assert(stack_size + 2 <= kBvhStackSize);
+    if (left_hit && right_hit) {
+      const bool left_first = left_distance <= right_distance;
+      stack[stack_size++] = left_first ? right : left;
+      stack[stack_size++] = left_first ? left : right;
+    } else if (left_hit) {
+      stack[stack_size++] = left;
+    } else if (right_hit) {
+      stack[stack_size++] = right;
+    }
+  }
+
+  if (hit < 0) {
+    return false;
+  }
+
+  const uint16_t* indices = &indices_[hit * 3];
+  const math::Float3 p0 =
+      LoadPosition(_positions.begin, _positions_stride, indices[0]);
+  const math::Float3 p1 =
+      LoadPosition(_positions.begin, _positions_stride, indices[1]);
+  const math::Float3 p2 =
+      LoadPosition(_positions.begin, _positions_stride, indices[2]);
+  _hit->distance = closest;
+  _hit->triangle = triangles_[hit];
+  _hit->point = _origin + _direction * closest;
+  _hit->normal = Normalize(Cross(p1 - p0, p2 - p0));
+  return true;
+}
+
+int MeshBvh::Overlap(const math::Box& _box,
+                     const Range<int>& _triangles) const {
+  if (nodes_.empty() || !_box.is_valid()) {
+    return 0;
+  }
+
+  const int capacity = static_cast<int>(_triangles.count());
+  int found = 0;
+  int stack[kBvhStackSize];
+  int stack_size = 0;
+  stack[stack_size++] = 0;
+  while (stack_size) {
+    const int index = stack[--stack_size];
+    const Node& node = nodes_[index];
+    if (!(node.min <= _box.max && node.max >= _box.min)) {
+      continue;
+    }
+    if (node.count) {
+      for (int t = node.first; t < node.first + node.count; ++t, ++found) {
+        if (found < capacity) {
+          _triangles[found] = triangles_[t];
+        }
+      }
+      continue;
+    }
+    assert(stack_size + 2 <= kBvhStackSize);
+    stack[stack_size++] = node.first;
+    stack[stack_size++] = index + 1;
+  }
+  return found;
+}
+
+math::Box MeshBvh::bounds() const {
+  if (nodes_.empty()) {
+    return math::Box();
+  }
+  return math::Box(nodes_[0].min, nodes_[0].max);
+}
+}  // namespace geometry
+}  // namespace ozz
@@ -0,0 +1,168 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#include "ozz/geometry/runtime/morph_job.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+namespace ozz {
+namespace geometry {
+
+namespace {
+// Gets the size in bytes required by _count vertices of _stride bytes.
+size_t VerticesSize(size_t _stride, int _count) {
+  return _count > 0 ? _stride * (_count - 1) + sizeof(float) * 3 : 0;
+}
+
+// Offsets _ptr by _offset bytes.
+template <typename _Type>
+_Type* Offset(_Type* _ptr, size_t _offset) {
+  return reinterpret_cast<_Type*>(reinterpret_cast<uintptr_t>(_ptr) + _offset);
+}
+
+// Copies _count vertices from _src to _dest, unless they're the same buffer.
+void CopyVertices(const float* _src, size_t _src_stride, float* _dest,
+                  size_t _dest_stride, int _count) {
+  if (_src == _dest && _src_stride == _dest_stride) {
+    return;
+  }
+  for (int i = 0; i < _count; ++i) {
+    std::memcpy(Offset(_dest, _dest_stride * i), Offset(_src, _src_stride * i),
+                sizeof(float) * 3);
+  }
+}
+
+// Compares block last vertex with _vertex, to search blocks with
+// std::lower_bound.
+bool BlockEndsBefore(const MorphDeltaBlock& _block, int _vertex) {
+  return _block.vertices[3] < _vertex;
+}
+
+// Adds the 4 soa _deltas scaled by _weight to the 3 floats vertices of
+// _vertices indices that are in range [_first, _first + _count[.
+void AddDeltas(const math::SimdFloat4 _deltas[3], math::SimdFloat4 _weight,
+               const int _vertices[4], int _first, int _count, float* _out,
+               size_t _stride) {
+  math::SimdFloat4 deltas[4];
+  math::Transpose3x4(_deltas, deltas);
+  for (int i = 0; i < 4; ++i) {
+    const int vertex = _vertices[i] - _first;
+    if (vertex >= 0 && vertex < _count) {
+      float* out = Offset(_out, _stride * vertex);
+      math::Store3PtrU(
+          math::MAdd(deltas[i], _weight, math::simd_float4::Load3PtrU(out)),
+          out);
+    }
+  }
+}
+}  // namespace
+
+MorphJob::MorphJob()
+    : first_vertex(0),
+      vertex_count(0),
+      in_positions_stride(0),
+      in_normals_stride(0),
+      out_positions_stride(0),
+      out_normals_stride(0) {}
+
+bool MorphJob::Validate() const {
+  bool valid = true;
+
+  valid &= first_vertex >= 0;
+  valid &= vertex_count >= 0;
+
+  // Checks targets and their weights.
+  valid &= targets.end >= targets.begin;
+  valid &= weights.end >= weights.begin;
+  valid &= weights.count() >= targets.count();
+
+  // Checks positions, mandatory.
+  valid &= in_positions.begin != NULL;
+  valid &= in_positions.size() >=
+           VerticesSize(in_positions_stride, vertex_count);
+  valid &= out_positions.begin != NULL;
+  valid &= out_positions.size() >=
+           VerticesSize(out_positions_stride, vertex_count);
+
+  // Checks normals, optional.
+  if (in_normals.begin) {
+    valid &= in_normals.size() >= VerticesSize(in_normals_stride,
+                                               vertex_count);
+    valid &= out_normals.begin != NULL;
+    valid &= out_normals.size() >= VerticesSize(out_normals_stride,
+                                                vertex_count);
+  }
+
+  return valid;
+}
+
+bool MorphJob::Run() const {
+  if (!Validate()) {
+    return false;
+  }
+
+  // Copies base vertices.
+  const bool normals = in_normals.begin != NULL;
+  CopyVertices(in_positions.begin, in_positions_stride, out_positions.begin,
+               out_positions_stride, vertex_count);
+  if (normals) {
+    CopyVertices(in_normals.begin, in_normals_stride, out_normals.begin,
+                 out_normals_stride, vertex_count);
+  }
+
+  // Adds weighted deltas of blocks overlapping the processed range.
+  const int end_vertex = first_vertex + vertex_count;
+  for (size_t t = 0; t < targets.count(); ++t) {
+    const float weight = weights.begin[t];
+    if (weight == 0.f) {
+      continue;
+    }
+    const math::SimdFloat4 w = math::simd_float4::Load1(weight);
+    const Range<const MorphDeltaBlock>& blocks = targets.begin[t].blocks;
+    for (const MorphDeltaBlock* block = std::lower_bound(
+             blocks.begin, blocks.end, first_vertex, BlockEndsBefore);
+         block < blocks.end && block->vertices[0] < end_vertex; ++block) {
+      assert(block->vertices[0] <= block->vertices[1] &&
+             block->vertices[1] <= block->vertices[2] &&
+             block->vertices[2] <= block->vertices[3] &&
+             "Morph target block vertices must be sorted.");
+      AddDeltas(block->positions, w, block->vertices, first_vertex,
+                vertex_count, out_positions.begin, out_positions_stride);
+      if (normals) {
+        AddDeltas(block->normals, w, block->vertices, first_vertex,
+                  vertex_count, out_normals.begin, out_normals_stride);
+      }
+    }
+  }
+
+  return true;
+}
+}  // namespace geometry
+}  // namespace ozz
@@ -0,0 +1,219 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#include "ozz/geometry/runtime/parallel_skinning_job.h"
+
+#include <cassert>
+
+#include "ozz/base/profile.h"
+
+namespace ozz {
+namespace geometry {
+
+namespace {
+
+// Size of a cache line, used to prevent false sharing between chunks.
+const int kCacheLineSize = 64;
+
+// Computes the number of vertices of stride _stride that covers a whole
+// number of cache lines.
+int CacheLineVertices(size_t _stride) {
+  int g = kCacheLineSize;
+  for (int stride = static_cast<int>(_stride % kCacheLineSize); stride != 0;) {
+    const int r = g % stride;
+    g = stride;
+    stride = r;
+  }
+  return kCacheLineSize / g;
+}
+
+// Moves _range begin forward by _count elements of _stride bytes.
+template <typename _Type>
+void AdvanceRange(Range<_Type>* _range, size_t _stride, int _count) {
+  if (_range->begin != NULL) {
+    _range->begin = reinterpret_cast<_Type*>(
+        reinterpret_cast<uintptr_t>(_range->begin) + _stride * _count);
+  }
+}
+
+// Describes how vertices are split in chunks. Chunk 0 covers vertices
+// [0, first + size[, next chunks i covers [first + i * size,
+// first + (i + 1) * size[.
+struct ChunksLayout {
+  int first;
+  int size;
+  int count;
+};
+
+ChunksLayout ComputeChunksLayout(const ParallelSkinningJob& _job) {
+  const SkinningJob& job = _job.job;
+
+  // Number of vertices such that all outputs cover whole cache lines. All
+  // values are powers of 2, so the maximum is also the least common multiple.
+  int granularity = CacheLineVertices(job.out_positions_stride);
+  if (job.in_normals.begin != NULL) {
+    const int normals = CacheLineVertices(job.out_normals_stride);
+    granularity = normals > granularity ? normals : granularity;
+    if (job.in_tangents.begin != NULL) {
+      const int tangents = CacheLineVertices(job.out_tangents_stride);
+      granularity = tangents > granularity ? tangents : granularity;
+    }
+  }
+
+  // Finds the first vertex whose positions output starts a cache line. There
+  // might be none if out_positions isn't aligned on a multiple of its stride.
+  const uintptr_t address =
+      reinterpret_cast<uintptr_t>(job.out_positions.begin);
+  int first = 0;
+  for (int i = 0; i < granularity; ++i) {
+    if ((address + job.out_positions_stride * i) % kCacheLineSize == 0) {
+      first = i;
+      break;
+    }
+  }
+
+  ChunksLayout layout;
+  layout.first = first;
+  layout.size =
+      (_job.chunk_size + granularity - 1) / granularity * granularity;
+  if (job.vertex_count == 0) {
+    layout.count = 0;
+  } else if (job.vertex_count <= first + layout.size) {
+    layout.count = 1;
+  } else {
+    layout.count = (job.vertex_count - first + layout.size - 1) / layout.size;
+  }
+  return layout;
+}
+
+// Runs chunk _index of ParallelSkinningJob _context.
+void RunChunk(void* _context, int _index) {
+  const ParallelSkinningJob* job =
+      static_cast<const ParallelSkinningJob*>(_context);
+  SkinningJob chunk;
+  const bool valid = job->GetChunk(_index, &chunk);
+  (void)valid;
+  assert(valid);
+  const bool success = chunk.Run();
+  (void)success;
+  assert(success);
+}
+
+// Context of a resumed slice of chunks, starting from chunk first.
+struct SliceContext {
+  const ParallelSkinningJob* job;
+  int first;
+};
+
+// Runs chunk _index of SliceContext _context slice.
+void RunSliceChunk(void* _context, int _index) {
+  const SliceContext* slice = static_cast<const SliceContext*>(_context);
+  RunChunk(const_cast<ParallelSkinningJob*>(slice->job),
+           slice->first + _index);
+}
+}  // namespace
+
+ParallelSkinningJob::ParallelSkinningJob() : chunk_size(512), scheduler(NULL) {}
+
+bool ParallelSkinningJob::Validate() const {
+  bool valid = true;
+  valid &= job.Validate();
+  valid &= chunk_size > 0;
+  valid &= job.influences_buckets.begin == NULL;
+  valid &= job.rigid_ranges.begin == NULL;
+  return valid;
+}
+
+int ParallelSkinningJob::NumChunks() const {
+  if (!Validate()) {
+    return 0;
+  }
+  return ComputeChunksLayout(*this).count;
+}
+
+bool ParallelSkinningJob::GetChunk(int _index, SkinningJob* _chunk) const {
+  if (!_chunk || !Validate()) {
+    return false;
+  }
+  const ChunksLayout layout = ComputeChunksLayout(*this);
+  if (_index < 0 || _index >= layout.count) {
+    return false;
+  }
+
+  const int begin = _index == 0 ? 0 : layout.first + _index * layout.size;
+  const int end = layout.first + (_index + 1) * layout.size;
+
+  *_chunk = job;
+  _chunk->vertex_count =
+      (end < job.vertex_count ? end : job.vertex_count) - begin;
+  AdvanceRange(&_chunk->joint_indices, job.joint_indices_stride, begin);
+  AdvanceRange(&_chunk->joint_indices_u8, job.joint_indices_stride, begin);
+  AdvanceRange(&_chunk->joint_weights, job.joint_weights_stride, begin);
+  AdvanceRange(&_chunk->joint_weights_u8, job.joint_weights_stride, begin);
+  AdvanceRange(&_chunk->joint_weights_u16, job.joint_weights_stride, begin);
+  AdvanceRange(&_chunk->in_positions, job.in_positions_stride, begin);
+  AdvanceRange(&_chunk->in_normals, job.in_normals_stride, begin);
+  AdvanceRange(&_chunk->in_tangents, job.in_tangents_stride, begin);
+  AdvanceRange(&_chunk->out_positions, job.out_positions_stride, begin);
+  AdvanceRange(&_chunk->out_normals, job.out_normals_stride, begin);
+  AdvanceRange(&_chunk->out_tangents, job.out_tangents_stride, begin);
+  _chunk->morph_first_vertex += begin;
+  return true;
+}
+
+bool ParallelSkinningJob::Run() const {
+  OZZ_PROFILE_ZONE("ozz::ParallelSkinningJob::Run");
+  if (!Validate()) {
+    return false;
+  }
+
+  const int count = ComputeChunksLayout(*this).count;
+  ParallelFor(scheduler, &RunChunk, const_cast<ParallelSkinningJob*>(this),
+              count);
+  return true;
+}
+
+bool ParallelSkinningJob::Resume(int* _cursor, int _max_chunks) const {
+  OZZ_PROFILE_ZONE("ozz::ParallelSkinningJob::Resume");
+  if (!_cursor || _max_chunks <= 0 || !Validate()) {
+    return false;
+  }
+  const int count = ComputeChunksLayout(*this).count;
+  const int begin = *_cursor;
+  if (begin < 0 || begin > count) {
+    return false;
+  }
+  const int end = count - begin > _max_chunks ? begin + _max_chunks : count;
+
+  SliceContext slice = {this, begin};
+  ParallelFor(scheduler, &RunSliceChunk, &slice, end - begin);
+  *_cursor = end;
+  return true;
+}
+}  // namespace geometry
+}  // namespace ozz
@@ -28,23 +28,62 @@
 #include "ozz/geometry/runtime/skinning_job.h"
 
 #include <cassert>
+#include <cstring>
 
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/simd_affine.h"
 #include "ozz/base/maths/simd_math.h"
+#include "ozz/base/profile.h"
+#include "ozz/geometry/runtime/morph_job.h"
 
 namespace ozz {
 namespace geometry {
 
+namespace {
+// Gets the size in bytes of a vertex component stored with format _format.
+size_t FormatSize(SkinningJob::Format _format) {
+  switch (_format) {
+    case SkinningJob::kFloat3:
+      return sizeof(float) * 3;
+    case SkinningJob::kHalf3:
+    case SkinningJob::kSnorm16x3:
+      return sizeof(uint16_t) * 3;
+    case SkinningJob::kSnorm10x3_2:
+      return sizeof(uint32_t);
+  }
+  return 0;
+}
+
+// Computes the minimum size in bytes of a buffer storing _vertex_count
+// vertices with format _format, every _stride bytes.
+size_t RequiredSize(size_t _stride, SkinningJob::Format _format,
+                    int _vertex_count) {
+  if (_vertex_count == 0) {
+    return 0;
+  }
+  return _stride * (_vertex_count - 1) + FormatSize(_format);
+}
+}  // namespace
+
 SkinningJob::SkinningJob()
     : vertex_count(0),
       influences_count(0),
       joint_indices_stride(0),
       joint_weights_stride(0),
       in_positions_stride(0),
+      in_positions_format(kFloat3),
       in_normals_stride(0),
+      in_normals_format(kFloat3),
       in_tangents_stride(0),
+      in_tangents_format(kFloat3),
+      morph_first_vertex(0),
       out_positions_stride(0),
+      out_positions_format(kFloat3),
       out_normals_stride(0),
-      out_tangents_stride(0) {}
+      out_normals_format(kFloat3),
+      out_tangents_stride(0),
+      out_tangents_format(kFloat3),
+      streaming_output(false) {}
 
 bool SkinningJob::Validate() const {
   // Start validation of all parameters.
@@ -53,9 +92,37 @@ bool SkinningJob::Validate() const {
   // Checks influences bounds.
   valid &= influences_count > 0;
 
-  // Checks joints matrices, required.
-  valid &= joint_matrices.begin != NULL;
-  valid &= joint_matrices.end >= joint_matrices.begin;
+  // Checks influence buckets, which must partition all vertices.
+  if (influences_buckets.begin) {
+    valid &= influences_buckets.end >= influences_buckets.begin;
+    valid &= influences_buckets.count() <=
+             static_cast<size_t>(math::Max(influences_count, 0));
+    int bucketed = 0;
+    for (const int* bucket = influences_buckets.begin;
+         bucket < influences_buckets.end; ++bucket) {
+      valid &= *bucket >= 0;
+      bucketed += *bucket;
+    }
+    valid &= bucketed == vertex_count;
+  }
+
+  // Checks optional morph targets.
+  if (morph_targets.begin) {
+    valid &= morph_targets.end >= morph_targets.begin;
+    valid &= morph_weights.end >= morph_weights.begin;
+    valid &= morph_weights.count() >= morph_targets.count();
+  }
+  valid &= morph_first_vertex >= 0;
+
+  // Checks joints matrices or dual quaternions, one of them is required.
+  if (joint_dual_quaternions.begin) {
+    valid &= joint_dual_quaternions.end >= joint_dual_quaternions.begin;
+    valid &= joint_matrices.begin == NULL;
+    valid &= joint_inverse_transpose_matrices.begin == NULL;
+  } else {
+    valid &= joint_matrices.begin != NULL;
+    valid &= joint_matrices.end >= joint_matrices.begin;
+  }
 
   // Checks optional inverse transpose matrices.
   if (joint_inverse_transpose_matrices.begin) {
@@ -64,54 +131,102 @@ bool SkinningJob::Validate() const {
              joint_inverse_transpose_matrices.begin;
   }
 
+  // Checks rigid ranges, which can only cover the leading single influence
+  // vertices, and whose joints must exist.
+  if (rigid_ranges.begin) {
+    valid &= rigid_ranges.end >= rigid_ranges.begin;
+    int single_influence = influences_count == 1 ? vertex_count : 0;
+    if (influences_buckets.begin) {
+      single_influence = influences_buckets.end > influences_buckets.begin
+                             ? influences_buckets.begin[0]
+                             : 0;
+    }
+    const size_t num_joints = joint_dual_quaternions.begin
+                                  ? joint_dual_quaternions.count()
+                                  : joint_matrices.count();
+    int rigid = 0;
+    for (const RigidRange* range = rigid_ranges.begin;
+         range < rigid_ranges.end; ++range) {
+      valid &= range->vertex_count >= 0;
+      valid &= range->joint >= 0;
+      valid &= static_cast<size_t>(range->joint) < num_joints;
+      if (joint_inverse_transpose_matrices.begin) {
+        valid &= static_cast<size_t>(range->joint) <
+                 joint_inverse_transpose_matrices.count();
+      }
+      rigid += range->vertex_count;
+    }
+    valid &= rigid <= single_influence;
+  }
+
   // Prepares local variables used to compute buffer size.
   const int vertex_count_minus_1 = vertex_count > 0 ? vertex_count - 1 : 0;
   const int vertex_count_at_least_1 = vertex_count > 0;
 
-  // Checks indices, required.
-  valid &= joint_indices.begin != NULL;
-  valid &= joint_indices.size() >=
+  // Checks indices, required, in a single format.
+  const bool indices_u8 = joint_indices_u8.begin != NULL;
+  valid &= (joint_indices.begin != NULL) != indices_u8;
+  const size_t indices_size =
+      indices_u8 ? joint_indices_u8.size() : joint_indices.size();
+  const size_t index_size = indices_u8 ? sizeof(uint8_t) : sizeof(uint16_t);
+  valid &= indices_size >=
            joint_indices_stride * vertex_count_minus_1 +
-               sizeof(uint16_t) * influences_count * vertex_count_at_least_1;
+               index_size * influences_count * vertex_count_at_least_1;
 
-  // Checks weights, required if influences_count > 1.
+  // Checks weights, required if influences_count > 1, in a single format.
+  const bool weights_u8 = joint_weights_u8.begin != NULL;
+  const bool weights_u16 = joint_weights_u16.begin != NULL;
   if (influences_count != 1) {
-    valid &= joint_weights.begin != NULL;
+    valid &= (joint_weights.begin != NULL) + weights_u8 + weights_u16 == 1;
+    const size_t weights_size =
+        weights_u8 ? joint_weights_u8.size()
+                   : weights_u16 ? joint_weights_u16.size()
+                                 : joint_weights.size();
+    const size_t weight_size = weights_u8    ? sizeof(uint8_t)
+                               : weights_u16 ? sizeof(uint16_t)
+                                             : sizeof(float);
     valid &=
-        joint_weights.size() >=
+        weights_size >=
         joint_weights_stride * vertex_count_minus_1 +
-            sizeof(float) * (influences_count - 1) * vertex_count_at_least_1;
+            weight_size * (influences_count - 1) * vertex_count_at_least_1;
+  }
+
+  // Compact formats are decoded to fixed size buffers.
+  if (indices_u8 || weights_u8 || weights_u16) {
+    valid &= influences_count <= kMaxCompactInfluences;
   }
 
   // Checks positions, mandatory.
   valid &= in_positions.begin != NULL;
-  valid &=
-      in_positions.size() >= in_positions_stride * vertex_count_minus_1 +
-                                 sizeof(float) * 3 * vertex_count_at_least_1;
+  valid &= in_positions.size() >=
+           RequiredSize(in_positions_stride, in_positions_format, vertex_count);
   valid &= out_positions.begin != NULL;
-  valid &=
-      out_positions.size() >= out_positions_stride * vertex_count_minus_1 +
-                                  sizeof(float) * 3 * vertex_count_at_least_1;
+  valid &= out_positions.size() >= RequiredSize(out_positions_stride,
+                                                out_positions_format,
+                                                vertex_count);
+
+  // Positions are not normalized.
+  valid &= in_positions_format == kFloat3 || in_positions_format == kHalf3;
+  valid &= out_positions_format == kFloat3 || out_positions_format == kHalf3;
 
   // Checks normals, optional.
   if (in_normals.begin) {
-    valid &=
-        in_normals.size() >= in_normals_stride * vertex_count_minus_1 +
-                                 sizeof(float) * 3 * vertex_count_at_least_1;
+    valid &= in_normals.size() >=
+             RequiredSize(in_normals_stride, in_normals_format, vertex_count);
     valid &= out_normals.begin != NULL;
-    valid &=
-        out_normals.size() >= out_normals_stride * vertex_count_minus_1 +
-                                  sizeof(float) * 3 * vertex_count_at_least_1;
+    valid &= out_normals.size() >= RequiredSize(out_normals_stride,
+                                                out_normals_format,
+                                                vertex_count);
 
     // Checks tangents, optional but requires normals.
     if (in_tangents.begin) {
-      valid &=
-          in_tangents.size() >= in_tangents_stride * vertex_count_minus_1 +
-                                    sizeof(float) * 3 * vertex_count_at_least_1;
+      valid &= in_tangents.size() >= RequiredSize(in_tangents_stride,
+                                                  in_tangents_format,
+                                                  vertex_count);
       valid &= out_tangents.begin != NULL;
-      valid &= out_tangents.size() >=
-               out_tangents_stride * vertex_count_minus_1 +
-                   sizeof(float) * 3 * vertex_count_at_least_1;
+      valid &= out_tangents.size() >= RequiredSize(out_tangents_stride,
+                                                   out_tangents_format,
+                                                   vertex_count);
     }
   } else {
     // Tangents are not supported if normals are not there.
@@ -132,7 +247,7 @@ bool SkinningJob::Validate() const {
 // Defines the skeleton code for the per vertex skinning loop.
 #define SKINNING_FN(_type, _it, _inf)                                        \
   void SKINNING_FN_NAME(_type, _it, _inf)(const SkinningJob& _job) {         \
-    ASSERT_##_type() ASSERT_##_it() INIT_##_type() INIT_W##_inf()            \
+    ASSERT_##_type() ASSERT_##_it() INIT_##_type() INIT_W##_inf(_it)         \
         const int loops = _job.vertex_count - 1;                             \
     for (int i = 0; i < loops; ++i) {                                        \
       PREPARE_##_inf##_INNER(_it) TRANSFORM_##_type##_INNER() NEXT_##_type() \
@@ -181,17 +296,31 @@ bool SkinningJob::Validate() const {
 // Implements loop initializations for weights.
 // Note that if the number of influences per vertex is 1, then there's no weight
 // as it's implicitly 1.
-#define INIT_W1()
+#define INIT_W1(_it)
 
-#define INIT_W2()                                        \
+#define INIT_W2(_it)                                     \
   const math::SimdFloat4 one = math::simd_float4::one(); \
   const float* joint_weights = _job.joint_weights.begin;
 
-#define INIT_W3() INIT_W2()
+#define INIT_W3(_it) INIT_W2(_it)
+
+#define INIT_W4(_it) INIT_W2(_it)
 
-#define INIT_W4() INIT_W2()
+#define INIT_WN(_it) INIT_W2(_it)
 
-#define INIT_WN() INIT_W2()
+// Rigid ranges (R) have no weight either, their joint matrices are loaded
+// once for the whole range, to local variables that can be kept in registers
+// as they can't alias outputs.
+#define INIT_WR(_it)                                                       \
+  const int rigid_joint = _job.rigid_ranges.begin->joint;                  \
+  const math::Float4x4 rigid_transform = _job.joint_matrices[rigid_joint]; \
+  INIT_##_it##_R()
+
+#define INIT_NOIT_R()
+
+#define INIT_IT_R()                         \
+  const math::Float4x4 rigid_it_transform = \
+      _job.joint_inverse_transpose_matrices[rigid_joint];
 
 // Implements pointer striding.
 #define NEXT(_type, _current, _stride) \
@@ -208,6 +337,8 @@ bool SkinningJob::Validate() const {
 
 #define NEXT_WN() NEXT_W2()
 
+#define NEXT_WR()
+
 #define NEXT_P()                                                             \
   joint_indices =                                                            \
       NEXT(const uint16_t*, joint_indices, _job.joint_indices_stride);       \
@@ -255,7 +386,7 @@ bool SkinningJob::Validate() const {
   const math::Float4x4& m1 = _job.joint_matrices[i1];                          \
   const math::SimdFloat4 w1 = one - w0;                                        \
   const math::Float4x4 transform =                                             \
-      math::ColumnMultiply(m0, w0) + math::ColumnMultiply(m1, w1);             \
+      math::ColumnMultiplyAdd(m1, w1, math::ColumnMultiply(m0, w0));           \
   PREPARE_##_it##_2()
 
 #define PREPARE_NOIT_2() PREPARE_NOIT()
@@ -264,21 +395,20 @@ bool SkinningJob::Validate() const {
   const math::Float4x4& mit0 = _job.joint_inverse_transpose_matrices[i0]; \
   const math::Float4x4& mit1 = _job.joint_inverse_transpose_matrices[i1]; \
   const math::Float4x4 it_transform =                                     \
-      math::ColumnMultiply(mit0, w0) + math::ColumnMultiply(mit1, w1);
+      math::ColumnMultiplyAdd(mit1, w1, math::ColumnMultiply(mit0, w0));
 
 #define PREPARE_2_OUTER(_it) PREPARE_2_INNER(_it)
 
-#define PREPARE_3_CONCAT(_it)                                     \
-  const uint16_t i0 = joint_indices[0];                           \
-  const uint16_t i1 = joint_indices[1];                           \
-  const uint16_t i2 = joint_indices[2];                           \
-  const math::Float4x4& m0 = _job.joint_matrices[i0];             \
-  const math::Float4x4& m1 = _job.joint_matrices[i1];             \
-  const math::Float4x4& m2 = _job.joint_matrices[i2];             \
-  const math::SimdFloat4 w2 = one - (w0 + w1);                    \
-  const math::Float4x4 transform = math::ColumnMultiply(m0, w0) + \
-                                   math::ColumnMultiply(m1, w1) + \
-                                   math::ColumnMultiply(m2, w2);  \
+#define PREPARE_3_CONCAT(_it)                                                 \
+  const uint16_t i0 = joint_indices[0];                                       \
+  const uint16_t i1 = joint_indices[1];                                       \
+  const uint16_t i2 = joint_indices[2];                                       \
+  const math::Float4x4& m0 = _job.joint_matrices[i0];                         \
+  const math::Float4x4& m1 = _job.joint_matrices[i1];                         \
+  const math::Float4x4& m2 = _job.joint_matrices[i2];                         \
+  const math::SimdFloat4 w2 = one - (w0 + w1);                                \
+  const math::Float4x4 transform = math::ColumnMultiplyAdd(                   \
+      m2, w2, math::ColumnMultiplyAdd(m1, w1, math::ColumnMultiply(m0, w0))); \
   PREPARE_##_it##_3()
 
 #define PREPARE_NOIT_3() PREPARE_NOIT()
@@ -287,9 +417,9 @@ bool SkinningJob::Validate() const {
   const math::Float4x4& mit0 = _job.joint_inverse_transpose_matrices[i0]; \
   const math::Float4x4& mit1 = _job.joint_inverse_transpose_matrices[i1]; \
   const math::Float4x4& mit2 = _job.joint_inverse_transpose_matrices[i2]; \
-  const math::Float4x4 it_transform = math::ColumnMultiply(mit0, w0) +    \
-                                      math::ColumnMultiply(mit1, w1) +    \
-                                      math::ColumnMultiply(mit2, w2);
+  const math::Float4x4 it_transform = math::ColumnMultiplyAdd(            \
+      mit2, w2,                                                           \
+      math::ColumnMultiplyAdd(mit1, w1, math::ColumnMultiply(mit0, w0)));
 
 #define PREPARE_3_INNER(_it)                                             \
   const math::SimdFloat4 w = math::simd_float4::LoadPtrU(joint_weights); \
@@ -302,31 +432,35 @@ bool SkinningJob::Validate() const {
   const math::SimdFloat4 w1 = math::simd_float4::Load1PtrU(joint_weights + 1); \
   PREPARE_3_CONCAT(_it)
 
-#define PREPARE_4_CONCAT(_it)                                       \
-  const uint16_t i0 = joint_indices[0];                             \
-  const uint16_t i1 = joint_indices[1];                             \
-  const uint16_t i2 = joint_indices[2];                             \
-  const uint16_t i3 = joint_indices[3];                             \
-  const math::Float4x4& m0 = _job.joint_matrices[i0];               \
-  const math::Float4x4& m1 = _job.joint_matrices[i1];               \
-  const math::Float4x4& m2 = _job.joint_matrices[i2];               \
-  const math::Float4x4& m3 = _job.joint_matrices[i3];               \
-  const math::SimdFloat4 w3 = one - (w0 + w1 + w2);                 \
-  const math::Float4x4 transform =                                  \
-      math::ColumnMultiply(m0, w0) + math::ColumnMultiply(m1, w1) + \
-      math::ColumnMultiply(m2, w2) + math::ColumnMultiply(m3, w3);  \
+#define PREPARE_4_CONCAT(_it)                                              \
+  const uint16_t i0 = joint_indices[0];                                    \
+  const uint16_t i1 = joint_indices[1];                                    \
+  const uint16_t i2 = joint_indices[2];                                    \
+  const uint16_t i3 = joint_indices[3];                                    \
+  const math::Float4x4& m0 = _job.joint_matrices[i0];                      \
+  const math::Float4x4& m1 = _job.joint_matrices[i1];                      \
+  const math::Float4x4& m2 = _job.joint_matrices[i2];                      \
+  const math::Float4x4& m3 = _job.joint_matrices[i3];                      \
+  const math::SimdFloat4 w3 = one - (w0 + w1 + w2);                        \
+  const math::Float4x4 transform = math::ColumnMultiplyAdd(                \
+      m3, w3,                                                              \
+      math::ColumnMultiplyAdd(                                             \
+          m2, w2,                                                          \
+          math::ColumnMultiplyAdd(m1, w1, math::ColumnMultiply(m0, w0)))); \
   PREPARE_##_it##_4()
 
 #define PREPARE_NOIT_4() PREPARE_NOIT()
 
-#define PREPARE_IT_4()                                                    \
-  const math::Float4x4& mit0 = _job.joint_inverse_transpose_matrices[i0]; \
-  const math::Float4x4& mit1 = _job.joint_inverse_transpose_matrices[i1]; \
-  const math::Float4x4& mit2 = _job.joint_inverse_transpose_matrices[i2]; \
-  const math::Float4x4& mit3 = _job.joint_inverse_transpose_matrices[i3]; \
-  const math::Float4x4 it_transform =                                     \
-      math::ColumnMultiply(mit0, w0) + math::ColumnMultiply(mit1, w1) +   \
-      math::ColumnMultiply(mit2, w2) + math::ColumnMultiply(mit3, w3);
+#define PREPARE_IT_4()                                                         \
+  const math::Float4x4& mit0 = _job.joint_inverse_transpose_matrices[i0];      \
+  const math::Float4x4& mit1 = _job.joint_inverse_transpose_matrices[i1];      \
+  const math::Float4x4& mit2 = _job.joint_inverse_transpose_matrices[i2];      \
+  const math::Float4x4& mit3 = _job.joint_inverse_transpose_matrices[i3];      \
+  const math::Float4x4 it_transform = math::ColumnMultiplyAdd(                 \
+      mit3, w3,                                                                \
+      math::ColumnMultiplyAdd(                                                 \
+          mit2, w2,                                                            \
+          math::ColumnMultiplyAdd(mit1, w1, math::ColumnMultiply(mit0, w0))));
 
 #define PREPARE_4_INNER(_it)                                             \
   const math::SimdFloat4 w = math::simd_float4::LoadPtrU(joint_weights); \
@@ -341,53 +475,61 @@ bool SkinningJob::Validate() const {
   const math::SimdFloat4 w2 = math::simd_float4::Load1PtrU(joint_weights + 2); \
   PREPARE_4_CONCAT(_it)
 
-#define PREPARE_NOIT_N()                                                     \
+#define PREPARE_NOIT_N()                                                   \
+  math::SimdFloat4 wsum = math::simd_float4::Load1PtrU(joint_weights + 0); \
+  math::Float4x4 transform =                                               \
+      math::ColumnMultiply(_job.joint_matrices[joint_indices[0]], wsum);   \
+  const int last = _job.influences_count - 1;                              \
+  for (int j = 1; j < last; ++j) {                                         \
+    const math::SimdFloat4 w =                                             \
+        math::simd_float4::Load1PtrU(joint_weights + j);                   \
+    wsum = wsum + w;                                                       \
+    transform = math::ColumnMultiplyAdd(                                   \
+        _job.joint_matrices[joint_indices[j]], w, transform);              \
+  }                                                                        \
+  transform = math::ColumnMultiplyAdd(                                     \
+      _job.joint_matrices[joint_indices[last]], one - wsum, transform);    \
+  PREPARE_NOIT()
+
+#define PREPARE_IT_N()                                                       \
   math::SimdFloat4 wsum = math::simd_float4::Load1PtrU(joint_weights + 0);   \
+  const uint16_t i0 = joint_indices[0];                                      \
   math::Float4x4 transform =                                                 \
-      math::ColumnMultiply(_job.joint_matrices[joint_indices[0]], wsum);     \
+      math::ColumnMultiply(_job.joint_matrices[i0], wsum);                   \
+  math::Float4x4 it_transform =                                              \
+      math::ColumnMultiply(_job.joint_inverse_transpose_matrices[i0], wsum); \
   const int last = _job.influences_count - 1;                                \
   for (int j = 1; j < last; ++j) {                                           \
+    const uint16_t ij = joint_indices[j];                                    \
     const math::SimdFloat4 w =                                               \
         math::simd_float4::Load1PtrU(joint_weights + j);                     \
     wsum = wsum + w;                                                         \
-    transform = transform + math::ColumnMultiply(                            \
-                                _job.joint_matrices[joint_indices[j]], w);   \
+    transform =                                                              \
+        math::ColumnMultiplyAdd(_job.joint_matrices[ij], w, transform);      \
+    it_transform = math::ColumnMultiplyAdd(                                  \
+        _job.joint_inverse_transpose_matrices[ij], w, it_transform);         \
   }                                                                          \
+  const math::SimdFloat4 wlast = one - wsum;                                 \
+  const int ilast = joint_indices[last];                                     \
   transform =                                                                \
-      transform + math::ColumnMultiply(                                      \
-                      _job.joint_matrices[joint_indices[last]], one - wsum); \
-  PREPARE_NOIT()
-
-#define PREPARE_IT_N()                                                        \
-  math::SimdFloat4 wsum = math::simd_float4::Load1PtrU(joint_weights + 0);    \
-  const uint16_t i0 = joint_indices[0];                                       \
-  math::Float4x4 transform =                                                  \
-      math::ColumnMultiply(_job.joint_matrices[i0], wsum);                    \
-  math::Float4x4 it_transform =                                               \
-      math::ColumnMultiply(_job.joint_inverse_transpose_matrices[i0], wsum);  \
-  const int last = _job.influences_count - 1;                                 \
-  for (int j = 1; j < last; ++j) {                                            \
-    const uint16_t ij = joint_indices[j];                                     \
-    const math::SimdFloat4 w =                                                \
-        math::simd_float4::Load1PtrU(joint_weights + j);                      \
-    wsum = wsum + w;                                                          \
-    transform = transform + math::ColumnMultiply(_job.joint_matrices[ij], w); \
-    it_transform =                                                            \
-        it_transform +                                                        \
-        math::ColumnMultiply(_job.joint_inverse_transpose_matrices[ij], w);   \
-  }                                                                           \
-  const math::SimdFloat4 wlast = one - wsum;                                  \
-  const int ilast = joint_indices[last];                                      \
-  transform =                                                                 \
-      transform + math::ColumnMultiply(_job.joint_matrices[ilast], wlast);    \
-  it_transform =                                                              \
-      it_transform + math::ColumnMultiply(                                    \
-                         _job.joint_inverse_transpose_matrices[ilast], wlast);
+      math::ColumnMultiplyAdd(_job.joint_matrices[ilast], wlast, transform); \
+  it_transform = math::ColumnMultiplyAdd(                                    \
+      _job.joint_inverse_transpose_matrices[ilast], wlast, it_transform);
 
 #define PREPARE_N_INNER(_it) PREPARE_##_it##_N()
 
 #define PREPARE_N_OUTER(_it) PREPARE_##_it##_N()
 
+#define PREPARE_R_INNER(_it)                         \
+  const math::Float4x4& transform = rigid_transform; \
+  PREPARE_##_it##_R()
+
+#define PREPARE_R_OUTER(_it) PREPARE_R_INNER(_it)
+
+#define PREPARE_NOIT_R() PREPARE_NOIT()
+
+#define PREPARE_IT_R() const math::Float4x4& it_transform = rigid_it_transform;
+
 // Implement point and vector transformation. _INNER and _OUTER have the same
 // meaning as defined for the PREPARE functions.
 #define TRANSFORM_P_INNER()                                                \
@@ -450,6 +592,11 @@ SKINNING_FN(PN, NOIT, N)
 SKINNING_FN(PNT, NOIT, N)
 SKINNING_FN(PN, IT, N)
 SKINNING_FN(PNT, IT, N)
+SKINNING_FN(P, NOIT, R)
+SKINNING_FN(PN, NOIT, R)
+SKINNING_FN(PNT, NOIT, R)
+SKINNING_FN(PN, IT, R)
+SKINNING_FN(PNT, IT, R)
 
 // Defines a matrix of skinning function pointers. This matrix will then be
 // indexed according to skinning jobs parameters.
@@ -480,34 +627,937 @@ static const SkiningFct kSkinningFct[2][5][3] = {
          &SKINNING_FN_NAME(PNT, IT, N)},
     }};
 
-// Implements job Run function.
-bool SkinningJob::Run() const {
-  // Exit with an error if job is invalid.
-  if (!Validate()) {
-    return false;
+// Defines a matrix of rigid range skinning function pointers, indexed like
+// kSkinningFct without the number of influences.
+static const SkiningFct kRigidSkinningFct[2][3] = {
+    {&SKINNING_FN_NAME(P, NOIT, R), &SKINNING_FN_NAME(PN, NOIT, R),
+     &SKINNING_FN_NAME(PNT, NOIT, R)},
+    {&SKINNING_FN_NAME(P, NOIT, R), &SKINNING_FN_NAME(PN, IT, R),
+     &SKINNING_FN_NAME(PNT, IT, R)}};
+
+#if defined(OZZ_SIMD_AVX2) || defined(OZZ_SIMD_AVX2_DISPATCH)
+namespace {
+
+// Number of vertices processed at once by the AVX2 skinning kernel.
+const int kAvx2Width = 8;
+
+// Multiplies _a and _b, and adds the result to _c.
+OZZ_INLINE OZZ_SIMD_AVX2_TARGET __m256 MAdd8(__m256 _a, __m256 _b,
+                                             __m256 _c) {
+#if defined(OZZ_SIMD_FMA) || defined(OZZ_SIMD_AVX2_DISPATCH)
+  return _mm256_fmadd_ps(_a, _b, _c);
+#else
+  return _mm256_add_ps(_mm256_mul_ps(_a, _b), _c);
+#endif
+}
+
+// Computes byte offsets of the vertices of a batch, from the first one.
+OZZ_INLINE OZZ_SIMD_AVX2_TARGET __m256i BatchOffsets(size_t _stride) {
+  return _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7),
+                            _mm256_set1_epi32(static_cast<int>(_stride)));
+}
+
+// Gathers 8 floats located at _offsets bytes from _base.
+OZZ_INLINE OZZ_SIMD_AVX2_TARGET __m256 Gather8(const float* _base,
+                                               __m256i _offsets) {
+  return _mm256_i32gather_ps(_base, _offsets, 1);
+}
+
+// Transforms 8 soa points or vectors (depending on _cols, 4 or 3), located at
+// _offsets bytes from _in, by soa matrices _m. Results are written to _out
+// buffer of 8 vertices, with a _stride bytes stride.
+OZZ_SIMD_AVX2_TARGET void Transform8(const __m256 _m[4][3], int _cols,
+                                     const float* _in, __m256i _offsets,
+                                     float* _out, size_t _stride) {
+  const __m256 x = Gather8(_in + 0, _offsets);
+  const __m256 y = Gather8(_in + 1, _offsets);
+  const __m256 z = Gather8(_in + 2, _offsets);
+  float out[3][kAvx2Width];
+  for (int r = 0; r < 3; ++r) {
+    const __m256 t = _cols == 4 ? _m[3][r] : _mm256_setzero_ps();
+    _mm256_storeu_ps(
+        out[r], MAdd8(_m[0][r], x, MAdd8(_m[1][r], y, MAdd8(_m[2][r], z, t))));
   }
+  for (int k = 0; k < kAvx2Width; ++k) {
+    float* out_k = NEXT(float*, _out, _stride * k);
+    out_k[0] = out[0][k];
+    out_k[1] = out[1][k];
+    out_k[2] = out[2][k];
+  }
+}
 
-  // Early out if no vertex. This isn't an error.
-  // Skinning function algorithm doesn't support the case.
-  if (vertex_count == 0) {
-    return true;
+// Skins the first _count vertices of _job, kAvx2Width at a time. _count must
+// be a multiple of kAvx2Width.
+// Weighted matrices of the 8 vertices are built in soa format, gathering
+// matrices components from joint indices. This supports any number of
+// influences and all skinning variants.
+OZZ_SIMD_AVX2_TARGET void SkinningAvx2(const SkinningJob& _job, int _count) {
+  assert(_count % kAvx2Width == 0);
+  const float* matrices =
+      reinterpret_cast<const float*>(_job.joint_matrices.begin);
+  const bool it = _job.in_normals.begin != NULL &&
+                  _job.joint_inverse_transpose_matrices.begin != NULL;
+  const float* it_matrices =
+      it ? reinterpret_cast<const float*>(
+               _job.joint_inverse_transpose_matrices.begin)
+         : matrices;
+  const int last = _job.influences_count - 1;
+  const bool normals = _job.in_normals.begin != NULL;
+  const bool tangents = normals && _job.in_tangents.begin != NULL;
+
+  // Byte offsets of each vertex from the first one of a batch.
+  const __m256i weights_offsets = BatchOffsets(_job.joint_weights_stride);
+  const __m256i positions_offsets = BatchOffsets(_job.in_positions_stride);
+  const __m256i normals_offsets = BatchOffsets(_job.in_normals_stride);
+  const __m256i tangents_offsets = BatchOffsets(_job.in_tangents_stride);
+  const __m256 one = _mm256_set1_ps(1.f);
+
+  const uint16_t* joint_indices = _job.joint_indices.begin;
+  const float* joint_weights = _job.joint_weights.begin;
+  const float* in_positions = _job.in_positions.begin;
+  const float* in_normals = _job.in_normals.begin;
+  const float* in_tangents = _job.in_tangents.begin;
+  float* out_positions = _job.out_positions.begin;
+  float* out_normals = _job.out_normals.begin;
+  float* out_tangents = _job.out_tangents.begin;
+
+  for (int v = 0; v < _count; v += kAvx2Width) {
+    // Builds weighted matrices. Only the 3 first rows are needed, as points
+    // and vectors are output as 3 components.
+    __m256 transform[4][3];
+    __m256 it_transform[4][3];
+    for (int c = 0; c < 4; ++c) {
+      for (int r = 0; r < 3; ++r) {
+        transform[c][r] = _mm256_setzero_ps();
+        it_transform[c][r] = _mm256_setzero_ps();
+      }
+    }
+    __m256 wsum = _mm256_setzero_ps();
+    for (int j = 0; j <= last; ++j) {
+      // Indices are loaded one by one, as 16 bits gathers don't exist.
+      int indices[kAvx2Width];
+      for (int k = 0; k < kAvx2Width; ++k) {
+        indices[k] = NEXT(const uint16_t*, joint_indices,
+                          _job.joint_indices_stride * k)[j];
+      }
+      const __m256i offsets = _mm256_mullo_epi32(
+          _mm256_loadu_si256(reinterpret_cast<const __m256i*>(indices)),
+          _mm256_set1_epi32(sizeof(math::Float4x4)));
+
+      // Last weight is deduced from the others.
+      __m256 w;
+      if (j != last) {
+        w = Gather8(joint_weights + j, weights_offsets);
+        wsum = _mm256_add_ps(wsum, w);
+      } else {
+        w = _mm256_sub_ps(one, wsum);
+      }
+
+      for (int c = 0; c < 4; ++c) {
+        for (int r = 0; r < 3; ++r) {
+          transform[c][r] = MAdd8(Gather8(matrices + c * 4 + r, offsets), w,
+                                  transform[c][r]);
+        }
+      }
+      if (it) {
+        for (int c = 0; c < 3; ++c) {
+          for (int r = 0; r < 3; ++r) {
+            it_transform[c][r] =
+                MAdd8(Gather8(it_matrices + c * 4 + r, offsets), w,
+                      it_transform[c][r]);
+          }
+        }
+      }
+    }
+
+    // Transforms and outputs vertices.
+    Transform8(transform, 4, in_positions, positions_offsets, out_positions,
+               _job.out_positions_stride);
+    if (normals) {
+      const __m256(*vectors_transform)[3] = it ? it_transform : transform;
+      Transform8(vectors_transform, 3, in_normals, normals_offsets,
+                 out_normals, _job.out_normals_stride);
+      if (tangents) {
+        Transform8(vectors_transform, 3, in_tangents, tangents_offsets,
+                   out_tangents, _job.out_tangents_stride);
+      }
+    }
+
+    // Moves to the next batch of vertices.
+    const size_t batch = kAvx2Width;
+    joint_indices = NEXT(const uint16_t*, joint_indices,
+                         _job.joint_indices_stride * batch);
+    joint_weights =
+        NEXT(const float*, joint_weights, _job.joint_weights_stride * batch);
+    in_positions =
+        NEXT(const float*, in_positions, _job.in_positions_stride * batch);
+    out_positions =
+        NEXT(float*, out_positions, _job.out_positions_stride * batch);
+    in_normals = NEXT(const float*, in_normals, _job.in_normals_stride * batch);
+    out_normals = NEXT(float*, out_normals, _job.out_normals_stride * batch);
+    in_tangents =
+        NEXT(const float*, in_tangents, _job.in_tangents_stride * batch);
+    out_tangents =
+        NEXT(float*, out_tangents, _job.out_tangents_stride * batch);
+  }
+}
+}  // namespace
+#endif  // OZZ_SIMD_AVX2 || OZZ_SIMD_AVX2_DISPATCH
+
+namespace {
+// Moves _range begin forward by _count elements of _stride bytes.
+template <typename _Type>
+void Advance(Range<_Type>* _range, size_t _stride, int _count) {
+  if (_range->begin != NULL) {
+    _range->begin = NEXT(_Type*, _range->begin, _stride * _count);
   }
+}
+
+// Implements dual quaternion skinning.
+// Like matrices skinning functions, variants are instantiated for 1 to 4
+// influences (_Influences = 0 means any number of influences), and for
+// positions, normals and tangents (_Type = 0, 1 and 2).
+// Dual quaternions are blended per vertex, in the hemisphere of the first
+// influence one, and normalized. Normals and tangents are rotated by the
+// blended quaternion, positions are also translated.
+template <int _Influences, int _Type>
+void SkinningDualQuaternion(const SkinningJob& _job) {
+  const int last = (_Influences ? _Influences : _job.influences_count) - 1;
+  const math::DualQuaternion* dqs = _job.joint_dual_quaternions.begin;
+  const math::SimdFloat4 zero = math::simd_float4::zero();
+  const math::SimdFloat4 one = math::simd_float4::one();
+  const math::SimdFloat4 two = math::simd_float4::Load1(2.f);
+
+  const uint16_t* joint_indices = _job.joint_indices.begin;
+  const float* joint_weights = _job.joint_weights.begin;
+  const float* in_positions = _job.in_positions.begin;
+  const float* in_normals = _job.in_normals.begin;
+  const float* in_tangents = _job.in_tangents.begin;
+  float* out_positions = _job.out_positions.begin;
+  float* out_normals = _job.out_normals.begin;
+  float* out_tangents = _job.out_tangents.begin;
+  for (int i = 0; i < _job.vertex_count; ++i) {
+    // Blends dual quaternions.
+    const math::DualQuaternion& dq0 = dqs[joint_indices[0]];
+    math::SimdFloat4 wsum =
+        last ? math::simd_float4::Load1PtrU(joint_weights) : one;
+    math::SimdFloat4 real = dq0.real.xyzw * wsum;
+    math::SimdFloat4 dual = dq0.dual.xyzw * wsum;
+    for (int j = 1; j <= last; ++j) {
+      const math::DualQuaternion& dq = dqs[joint_indices[j]];
+      math::SimdFloat4 w = one - wsum;
+      if (j != last) {
+        w = math::simd_float4::Load1PtrU(joint_weights + j);
+        wsum = wsum + w;
+      }
+
+      // Flips weight if quaternion isn't in the same hemisphere.
+      w = math::Select(
+          math::CmpLt(math::SplatX(math::Dot4(dq0.real.xyzw, dq.real.xyzw)),
+                      zero),
+          -w, w);
+      real = real + dq.real.xyzw * w;
+      dual = dual + dq.dual.xyzw * w;
+    }
+    const math::SimdFloat4 inv_len =
+        one / math::SplatX(math::Length4(real));
+    real = real * inv_len;
+    dual = dual * inv_len;
+    const math::SimdFloat4 real_w = math::SplatW(real);
+
+    // Transforms position, rotation then translation from dual part.
+    const math::SimdFloat4 in_p = math::simd_float4::Load3PtrU(in_positions);
+    const math::SimdFloat4 translation =
+        two * (real_w * dual - math::SplatW(dual) * real +
+               math::Cross3(real, dual));
+    const math::SimdFloat4 out_p =
+        in_p +
+        two * math::Cross3(real, math::Cross3(real, in_p) + real_w * in_p) +
+        translation;
+    math::Store3PtrU(out_p, out_positions);
+
+    if (_Type > 0) {
+      const math::SimdFloat4 in_n = math::simd_float4::Load3PtrU(in_normals);
+      const math::SimdFloat4 out_n =
+          in_n +
+          two * math::Cross3(real, math::Cross3(real, in_n) + real_w * in_n);
+      math::Store3PtrU(out_n, out_normals);
+      in_normals = NEXT(const float*, in_normals, _job.in_normals_stride);
+      out_normals = NEXT(float*, out_normals, _job.out_normals_stride);
+    }
+    if (_Type > 1) {
+      const math::SimdFloat4 in_t = math::simd_float4::Load3PtrU(in_tangents);
+      const math::SimdFloat4 out_t =
+          in_t +
+          two * math::Cross3(real, math::Cross3(real, in_t) + real_w * in_t);
+      math::Store3PtrU(out_t, out_tangents);
+      in_tangents = NEXT(const float*, in_tangents, _job.in_tangents_stride);
+      out_tangents = NEXT(float*, out_tangents, _job.out_tangents_stride);
+    }
+
+    joint_indices =
+        NEXT(const uint16_t*, joint_indices, _job.joint_indices_stride);
+    joint_weights =
+        NEXT(const float*, joint_weights, _job.joint_weights_stride);
+    in_positions = NEXT(const float*, in_positions, _job.in_positions_stride);
+    out_positions = NEXT(float*, out_positions, _job.out_positions_stride);
+  }
+}
 
+// Defines a matrix of dual quaternion skinning function pointers, indexed
+// like kSkinningFct.
+const SkiningFct kDualQuaternionSkinningFct[5][3] = {
+    {&SkinningDualQuaternion<1, 0>, &SkinningDualQuaternion<1, 1>,
+     &SkinningDualQuaternion<1, 2>},
+    {&SkinningDualQuaternion<2, 0>, &SkinningDualQuaternion<2, 1>,
+     &SkinningDualQuaternion<2, 2>},
+    {&SkinningDualQuaternion<3, 0>, &SkinningDualQuaternion<3, 1>,
+     &SkinningDualQuaternion<3, 2>},
+    {&SkinningDualQuaternion<4, 0>, &SkinningDualQuaternion<4, 1>,
+     &SkinningDualQuaternion<4, 2>},
+    {&SkinningDualQuaternion<0, 0>, &SkinningDualQuaternion<0, 1>,
+     &SkinningDualQuaternion<0, 2>}};
+
+// Runs skinning function matching _job parameters. _job must be valid, use
+// uint16_t indices and float weights, and have at least a vertex. _job
+// vertices are all rigidly bound to the first rigid range joint if it has
+// rigid ranges, see RunRigidRanges().
+void RunSkinningFct(const SkinningJob& _job) {
   // Find skinning function index.
-  const size_t it = joint_inverse_transpose_matrices.begin != NULL;
+  const size_t it = _job.joint_inverse_transpose_matrices.begin != NULL;
   assert(it < OZZ_ARRAY_SIZE(kSkinningFct));
-  const size_t inf =
-      static_cast<size_t>(influences_count) > OZZ_ARRAY_SIZE(kSkinningFct[0])
-          ? OZZ_ARRAY_SIZE(kSkinningFct[0]) - 1
-          : influences_count - 1;
+  const size_t inf = static_cast<size_t>(_job.influences_count) >
+                             OZZ_ARRAY_SIZE(kSkinningFct[0])
+                         ? OZZ_ARRAY_SIZE(kSkinningFct[0]) - 1
+                         : _job.influences_count - 1;
   assert(inf < OZZ_ARRAY_SIZE(kSkinningFct[0]));
-  const size_t fct = (in_normals.begin != NULL) + (in_tangents.begin != NULL);
+  const size_t fct =
+      (_job.in_normals.begin != NULL) + (_job.in_tangents.begin != NULL);
   assert(fct < OZZ_ARRAY_SIZE(kSkinningFct[0][0]));
 
+  if (_job.joint_dual_quaternions.begin != NULL) {
+    kDualQuaternionSkinningFct[inf][fct](_job);
+    return;
+  }
+
+  // Rigid vertices are transformed by a single matrix.
+  if (_job.rigid_ranges.begin != NULL) {
+    assert(_job.influences_count == 1);
+    kRigidSkinningFct[it][fct](_job);
+    return;
+  }
+
+#if defined(OZZ_SIMD_AVX2) || defined(OZZ_SIMD_AVX2_DISPATCH)
+  // Skins vertices 8 at a time, remaining ones are processed by the 4 wide
+  // skinning functions below. AVX2 kernel is selected at runtime if it isn't
+  // natively supported by the build.
+#if defined(OZZ_SIMD_AVX2_DISPATCH)
+  const bool avx2 = math::CpuSupportsAvx2Fma();
+#else   // OZZ_SIMD_AVX2_DISPATCH
+  const bool avx2 = true;
+#endif  // OZZ_SIMD_AVX2_DISPATCH
+  const int vertex_count = _job.vertex_count;
+  const int avx2_count = vertex_count - vertex_count % kAvx2Width;
+  if (avx2 && avx2_count != 0) {
+    SkinningAvx2(_job, avx2_count);
+    if (avx2_count == vertex_count) {
+      return;
+    }
+    SkinningJob remaining = _job;
+    remaining.vertex_count = vertex_count - avx2_count;
+    Advance(&remaining.joint_indices, _job.joint_indices_stride, avx2_count);
+    Advance(&remaining.joint_weights, _job.joint_weights_stride, avx2_count);
+    Advance(&remaining.in_positions, _job.in_positions_stride, avx2_count);
+    Advance(&remaining.in_normals, _job.in_normals_stride, avx2_count);
+    Advance(&remaining.in_tangents, _job.in_tangents_stride, avx2_count);
+    Advance(&remaining.out_positions, _job.out_positions_stride, avx2_count);
+    Advance(&remaining.out_normals, _job.out_normals_stride, avx2_count);
+    Advance(&remaining.out_tangents, _job.out_tangents_stride, avx2_count);
+    kSkinningFct[it][inf][fct](remaining);
+    return;
+  }
+#endif  // OZZ_SIMD_AVX2 || OZZ_SIMD_AVX2_DISPATCH
+
   // Calls skinning function. Cannot fail because job is valid.
-  kSkinningFct[it][inf][fct](*this);
+  kSkinningFct[it][inf][fct](_job);
+}
 
+// Decodes _count values of type _Src, located every _stride bytes from _src,
+// to _dest. Each value is multiplied by _scale.
+template <typename _Src, typename _Dest>
+void Decode(const _Src* _src, size_t _stride, int _count, int _per_vertex,
+            float _scale, _Dest* _dest) {
+  for (int v = 0; v < _count; ++v, _src = NEXT(const _Src*, _src, _stride)) {
+    for (int j = 0; j < _per_vertex; ++j) {
+      *(_dest++) = static_cast<_Dest>(_src[j] * _scale);
+    }
+  }
+}
+
+// Decodes _count vertices of format _format, located every _stride bytes from
+// _src, to 3 floats per vertex in _dest.
+void DecodeVertices(const float* _src, size_t _stride,
+                    SkinningJob::Format _format, int _count, float* _dest) {
+  // Tightly packed halves are converted in bulk.
+  if (_format == SkinningJob::kHalf3 && _stride == 3 * sizeof(uint16_t)) {
+    math::HalfToFloat(reinterpret_cast<const uint16_t*>(_src), _count * 3u,
+                      _dest);
+    return;
+  }
+  const math::SimdFloat4 minus_one = -math::simd_float4::one();
+  for (int v = 0; v < _count;
+       ++v, _src = NEXT(const float*, _src, _stride), _dest += 3) {
+    math::SimdFloat4 value;
+    switch (_format) {
+      case SkinningJob::kFloat3: {
+        value = math::simd_float4::Load3PtrU(_src);
+        break;
+      }
+      case SkinningJob::kHalf3: {
+        const uint16_t* src = reinterpret_cast<const uint16_t*>(_src);
+        value = math::HalfToFloat(
+            math::simd_int4::Load(src[0], src[1], src[2], 0));
+        break;
+      }
+      case SkinningJob::kSnorm16x3: {
+        const int16_t* src = reinterpret_cast<const int16_t*>(_src);
+        value = math::Max(
+            math::simd_float4::FromInt(
+                math::simd_int4::Load(src[0], src[1], src[2], 0)) *
+                math::simd_float4::Load1(1.f / 32767.f),
+            minus_one);
+        break;
+      }
+      case SkinningJob::kSnorm10x3_2: {
+        // Sign extends 10 bits components.
+        const uint32_t src = *reinterpret_cast<const uint32_t*>(_src);
+        value = math::Max(
+            math::simd_float4::FromInt(math::simd_int4::Load(
+                static_cast<int>(src << 22) >> 22,
+                static_cast<int>(src << 12) >> 22,
+                static_cast<int>(src << 2) >> 22, 0)) *
+                math::simd_float4::Load1(1.f / 511.f),
+            minus_one);
+        break;
+      }
+      default: {
+        assert(false && "Invalid vertex format.");
+        value = math::simd_float4::zero();
+        break;
+      }
+    }
+    math::Store3PtrU(value, _dest);
+  }
+}
+
+// Encodes _count vertices of 3 floats from _src, to format _format in _dest
+// every _stride bytes. _w_src is an optional kSnorm10x3_2 buffer (with
+// _w_stride stride) from which w component is copied, or NULL.
+void EncodeVertices(const float* _src, int _count, SkinningJob::Format _format,
+                    float* _dest, size_t _stride, const float* _w_src,
+                    size_t _w_stride) {
+  // Tightly packed halves are converted in bulk.
+  if (_format == SkinningJob::kHalf3 && _stride == 3 * sizeof(uint16_t)) {
+    math::FloatToHalf(_src, _count * 3u, reinterpret_cast<uint16_t*>(_dest));
+    return;
+  }
+  const math::SimdFloat4 one = math::simd_float4::one();
+  for (int v = 0; v < _count;
+       ++v, _src += 3, _dest = NEXT(float*, _dest, _stride)) {
+    const math::SimdFloat4 value = math::simd_float4::Load3PtrU(_src);
+    int ints[4];
+    switch (_format) {
+      case SkinningJob::kFloat3: {
+        math::Store3PtrU(value, _dest);
+        break;
+      }
+      case SkinningJob::kHalf3: {
+        math::StorePtrU(math::FloatToHalf(value), ints);
+        uint16_t* dest = reinterpret_cast<uint16_t*>(_dest);
+        for (int i = 0; i < 3; ++i) {
+          dest[i] = static_cast<uint16_t>(ints[i]);
+        }
+        break;
+      }
+      case SkinningJob::kSnorm16x3: {
+        math::StorePtrU(
+            math::simd_int4::FromFloatRound(
+                math::Clamp(-one, value, one) *
+                math::simd_float4::Load1(32767.f)),
+            ints);
+        int16_t* dest = reinterpret_cast<int16_t*>(_dest);
+        for (int i = 0; i < 3; ++i) {
+          dest[i] = static_cast<int16_t>(ints[i]);
+        }
+        break;
+      }
+      case SkinningJob::kSnorm10x3_2: {
+        math::StorePtrU(math::simd_int4::FromFloatRound(
+                            math::Clamp(-one, value, one) *
+                            math::simd_float4::Load1(511.f)),
+                        ints);
+        uint32_t packed = (ints[0] & 0x3ff) | (ints[1] & 0x3ff) << 10 |
+                          (ints[2] & 0x3ff) << 20;
+        if (_w_src) {
+          packed |= *reinterpret_cast<const uint32_t*>(_w_src) & 0xc0000000;
+          _w_src = NEXT(const float*, _w_src, _w_stride);
+        }
+        *reinterpret_cast<uint32_t*>(_dest) = packed;
+        break;
+      }
+    }
+  }
+}
+
+// Number of vertices converted at once when vertex formats aren't kFloat3.
+const int kVertexBatch = 128;
+
+// Sets up _range to read _count input vertices from _src. Vertices are
+// decoded to float _buffer if their format isn't kFloat3 or if they're
+// _buffered.
+void PrepareInput(const float* _src, size_t _stride,
+                  SkinningJob::Format _format, int _count, bool _buffered,
+                  float* _buffer, Range<const float>* _range) {
+  if (_format == SkinningJob::kFloat3 && !_buffered) {
+    _range->begin = _src;
+  } else {
+    DecodeVertices(_src, _stride, _format, _count, _buffer);
+    *_range = Range<const float>(_buffer, _count * 3);
+  }
+}
+
+// Sets up _range to write _count output vertices to _dest, or to float _buffer
+// if their format isn't kFloat3 or if output is _streamed. Buffer is then
+// encoded by FinishOutput().
+void PrepareOutput(float* _dest, SkinningJob::Format _format, int _count,
+                   bool _streamed, float* _buffer, Range<float>* _range) {
+  if (_format == SkinningJob::kFloat3 && !_streamed) {
+    _range->begin = _dest;
+  } else {
+    *_range = Range<float>(_buffer, _count * 3);
+  }
+}
+
+// Encodes _buffer to _dest if format isn't kFloat3. See PrepareOutput().
+void FinishOutput(const float* _buffer, int _count,
+                  SkinningJob::Format _format, float* _dest, size_t _stride,
+                  const float* _src, SkinningJob::Format _src_format,
+                  size_t _src_stride) {
+  if (_format != SkinningJob::kFloat3) {
+    const bool copy_w = _format == SkinningJob::kSnorm10x3_2 &&
+                        _src_format == SkinningJob::kSnorm10x3_2;
+    EncodeVertices(_buffer, _count, _format, _dest, _stride,
+                   copy_w ? _src : NULL, _src_stride);
+  }
+}
+
+// Copies _size bytes from _src to _dest, using non-temporal stores for every 4
+// bytes aligned word when available.
+void StreamCopy(void* _dest, const void* _src, size_t _size) {
+#if defined(OZZ_SIMD_SSE2)
+  char* dest = static_cast<char*>(_dest);
+  const char* src = static_cast<const char*>(_src);
+  if ((reinterpret_cast<uintptr_t>(dest) & 3) == 0) {
+    for (; _size >= 4; _size -= 4, dest += 4, src += 4) {
+      int word;
+      std::memcpy(&word, src, 4);
+      _mm_stream_si32(reinterpret_cast<int*>(dest), word);
+    }
+  }
+  std::memcpy(dest, src, _size);
+#else   // OZZ_SIMD_SSE2
+  std::memcpy(_dest, _src, _size);
+#endif  // OZZ_SIMD_SSE2
+}
+
+// Output stream, that is a buffer of encoded vertices to write to an output.
+struct Stream {
+  const char* src;
+  char* dest;
+  size_t size;
+  size_t dest_stride;
+};
+
+// Encodes _buffer in place (packed, _format sized vertices) and sets up
+// _stream to write it to _dest. Encoding in place is safe as encoded vertices
+// are never bigger than float ones, and each vertex is loaded before it's
+// written.
+void PrepareStream(float* _buffer, int _count, SkinningJob::Format _format,
+                   float* _dest, size_t _stride, const float* _src,
+                   SkinningJob::Format _src_format, size_t _src_stride,
+                   Stream* _stream) {
+  const size_t size = FormatSize(_format);
+  FinishOutput(_buffer, _count, _format, _buffer, size, _src, _src_format,
+               _src_stride);
+  _stream->src = reinterpret_cast<const char*>(_buffer);
+  _stream->dest = reinterpret_cast<char*>(_dest);
+  _stream->size = size;
+  _stream->dest_stride = _stride;
+}
+
+// Writes _count vertices of all _streams, vertex after vertex.
+void WriteStreams(Stream* _streams, int _num_streams, int _count) {
+  for (int v = 0; v < _count; ++v) {
+    for (int s = 0; s < _num_streams; ++s) {
+      Stream& stream = _streams[s];
+      StreamCopy(stream.dest, stream.src, stream.size);
+      stream.src += stream.size;
+      stream.dest += stream.dest_stride;
+    }
+  }
+}
+
+// Skins _job vertices by batches, decoding compact indices and weights, and
+// converting vertex formats other than kFloat3, to cache resident buffers.
+// These buffers are then used as the input and output of skinning functions.
+// They're also used to morph inputs and to write streamed outputs, see
+// SkinningJob::morph_targets and SkinningJob::streaming_output.
+void RunBatches(const SkinningJob& _job) {
+  const int kBufferSize = SkinningJob::kMaxCompactInfluences * 32;
+  uint16_t indices[kBufferSize];
+  float weights[kBufferSize];
+  float in_positions[kVertexBatch * 3];
+  float in_normals[kVertexBatch * 3];
+  float in_tangents[kVertexBatch * 3];
+  float out_positions[kVertexBatch * 3];
+  float out_normals[kVertexBatch * 3];
+  float out_tangents[kVertexBatch * 3];
+
+  const int influences = _job.influences_count;
+  const bool compact = _job.joint_indices_u8.begin != NULL ||
+                       _job.joint_weights_u8.begin != NULL ||
+                       _job.joint_weights_u16.begin != NULL;
+  const int batch =
+      compact ? math::Min(kVertexBatch, kBufferSize / influences)
+              : kVertexBatch;
+  assert(batch > 0);
+
+  SkinningJob decoded = _job;
+  if (compact) {
+    decoded.joint_indices_u8 = Range<const uint8_t>();
+    decoded.joint_weights_u8 = Range<const uint8_t>();
+    decoded.joint_weights_u16 = Range<const uint16_t>();
+    decoded.joint_indices_stride = sizeof(uint16_t) * influences;
+    decoded.joint_weights_stride = sizeof(float) * (influences - 1);
+  }
+
+  // Converted vertices are stored contiguously.
+  const SkinningJob::Format kFloat3 = SkinningJob::kFloat3;
+  const size_t kFloat3Stride = sizeof(float) * 3;
+  decoded.in_positions_format = kFloat3;
+  decoded.in_normals_format = kFloat3;
+  decoded.in_tangents_format = kFloat3;
+  decoded.out_positions_format = kFloat3;
+  decoded.out_normals_format = kFloat3;
+  decoded.out_tangents_format = kFloat3;
+  if (_job.in_positions_format != kFloat3) {
+    decoded.in_positions_stride = kFloat3Stride;
+  }
+  if (_job.in_normals_format != kFloat3) {
+    decoded.in_normals_stride = kFloat3Stride;
+  }
+  if (_job.in_tangents_format != kFloat3) {
+    decoded.in_tangents_stride = kFloat3Stride;
+  }
+  if (_job.out_positions_format != kFloat3) {
+    decoded.out_positions_stride = kFloat3Stride;
+  }
+  if (_job.out_normals_format != kFloat3) {
+    decoded.out_normals_stride = kFloat3Stride;
+  }
+  if (_job.out_tangents_format != kFloat3) {
+    decoded.out_tangents_stride = kFloat3Stride;
+  }
+  const bool morphed = _job.morph_targets.begin != NULL;
+  if (morphed) {
+    decoded.morph_targets = Range<const MorphTarget>();
+    decoded.morph_weights = Range<const float>();
+    decoded.in_positions_stride = kFloat3Stride;
+    decoded.in_normals_stride = kFloat3Stride;
+  }
+  const bool streamed = _job.streaming_output;
+  if (streamed) {
+    decoded.out_positions_stride = kFloat3Stride;
+    decoded.out_normals_stride = kFloat3Stride;
+    decoded.out_tangents_stride = kFloat3Stride;
+  }
+
+  const uint16_t* joint_indices = _job.joint_indices.begin;
+  const uint8_t* joint_indices_u8 = _job.joint_indices_u8.begin;
+  const float* joint_weights = _job.joint_weights.begin;
+  const uint8_t* joint_weights_u8 = _job.joint_weights_u8.begin;
+  const uint16_t* joint_weights_u16 = _job.joint_weights_u16.begin;
+  const bool normals = _job.in_normals.begin != NULL;
+  const bool tangents = _job.in_tangents.begin != NULL;
+  for (int begin = 0; begin < _job.vertex_count; begin += batch) {
+    const int count = math::Min(batch, _job.vertex_count - begin);
+
+    if (compact) {
+      // Decodes indices.
+      if (joint_indices_u8) {
+        Decode(joint_indices_u8, _job.joint_indices_stride, count, influences,
+               1.f, indices);
+        joint_indices_u8 = NEXT(const uint8_t*, joint_indices_u8,
+                                _job.joint_indices_stride * count);
+      } else {
+        Decode(joint_indices, _job.joint_indices_stride, count, influences,
+               1.f, indices);
+        joint_indices = NEXT(const uint16_t*, joint_indices,
+                             _job.joint_indices_stride * count);
+      }
+      decoded.joint_indices =
+          Range<const uint16_t>(indices, count * influences);
+
+      // Decodes weights.
+      if (influences > 1) {
+        if (joint_weights_u8) {
+          Decode(joint_weights_u8, _job.joint_weights_stride, count,
+                 influences - 1, 1.f / 255.f, weights);
+          joint_weights_u8 = NEXT(const uint8_t*, joint_weights_u8,
+                                  _job.joint_weights_stride * count);
+        } else if (joint_weights_u16) {
+          Decode(joint_weights_u16, _job.joint_weights_stride, count,
+                 influences - 1, 1.f / 65535.f, weights);
+          joint_weights_u16 = NEXT(const uint16_t*, joint_weights_u16,
+                                   _job.joint_weights_stride * count);
+        } else {
+          Decode(joint_weights, _job.joint_weights_stride, count,
+                 influences - 1, 1.f, weights);
+          joint_weights = NEXT(const float*, joint_weights,
+                               _job.joint_weights_stride * count);
+        }
+        decoded.joint_weights =
+            Range<const float>(weights, count * (influences - 1));
+      }
+    } else {
+      decoded.joint_indices.begin =
+          NEXT(const uint16_t*, _job.joint_indices.begin,
+               _job.joint_indices_stride * begin);
+      if (influences > 1) {
+        decoded.joint_weights.begin =
+            NEXT(const float*, _job.joint_weights.begin,
+                 _job.joint_weights_stride * begin);
+      }
+    }
+
+    // Prepares vertices streams.
+    const float* in_positions_src =
+        NEXT(const float*, _job.in_positions.begin,
+             _job.in_positions_stride * begin);
+    const float* in_normals_src = NEXT(const float*, _job.in_normals.begin,
+                                       _job.in_normals_stride * begin);
+    const float* in_tangents_src = NEXT(const float*, _job.in_tangents.begin,
+                                        _job.in_tangents_stride * begin);
+    float* out_positions_dest = NEXT(float*, _job.out_positions.begin,
+                                     _job.out_positions_stride * begin);
+    float* out_normals_dest = NEXT(float*, _job.out_normals.begin,
+                                   _job.out_normals_stride * begin);
+    float* out_tangents_dest = NEXT(float*, _job.out_tangents.begin,
+                                    _job.out_tangents_stride * begin);
+    PrepareInput(in_positions_src, _job.in_positions_stride,
+                 _job.in_positions_format, count, morphed, in_positions,
+                 &decoded.in_positions);
+    PrepareOutput(out_positions_dest, _job.out_positions_format, count,
+                  streamed, out_positions, &decoded.out_positions);
+    if (normals) {
+      PrepareInput(in_normals_src, _job.in_normals_stride,
+                   _job.in_normals_format, count, morphed, in_normals,
+                   &decoded.in_normals);
+      PrepareOutput(out_normals_dest, _job.out_normals_format, count, streamed,
+                    out_normals, &decoded.out_normals);
+    }
+    if (tangents) {
+      PrepareInput(in_tangents_src, _job.in_tangents_stride,
+                   _job.in_tangents_format, count, false, in_tangents,
+                   &decoded.in_tangents);
+      PrepareOutput(out_tangents_dest, _job.out_tangents_format, count,
+                    streamed, out_tangents, &decoded.out_tangents);
+    }
+
+    // Morphs buffered positions and normals in place.
+    if (morphed) {
+      MorphJob morph;
+      morph.first_vertex = _job.morph_first_vertex + begin;
+      morph.vertex_count = count;
+      morph.targets = _job.morph_targets;
+      morph.weights = _job.morph_weights;
+      morph.in_positions = Range<const float>(in_positions, count * 3);
+      morph.in_positions_stride = kFloat3Stride;
+      morph.out_positions = Range<float>(in_positions, count * 3);
+      morph.out_positions_stride = kFloat3Stride;
+      if (normals) {
+        morph.in_normals = Range<const float>(in_normals, count * 3);
+        morph.in_normals_stride = kFloat3Stride;
+        morph.out_normals = Range<float>(in_normals, count * 3);
+        morph.out_normals_stride = kFloat3Stride;
+      }
+      const bool success = morph.Run();
+      (void)success;
+      assert(success);
+    }
+
+    // Skins the batch.
+    decoded.vertex_count = count;
+    RunSkinningFct(decoded);
+
+    // Encodes outputs.
+    if (streamed) {
+      Stream streams[3];
+      int num_streams = 0;
+      PrepareStream(out_positions, count, _job.out_positions_format,
+                    out_positions_dest, _job.out_positions_stride, NULL,
+                    kFloat3, 0, &streams[num_streams++]);
+      if (normals) {
+        PrepareStream(out_normals, count, _job.out_normals_format,
+                      out_normals_dest, _job.out_normals_stride,
+                      in_normals_src, _job.in_normals_format,
+                      _job.in_normals_stride, &streams[num_streams++]);
+      }
+      if (tangents) {
+        PrepareStream(out_tangents, count, _job.out_tangents_format,
+                      out_tangents_dest, _job.out_tangents_stride,
+                      in_tangents_src, _job.in_tangents_format,
+                      _job.in_tangents_stride, &streams[num_streams++]);
+      }
+      WriteStreams(streams, num_streams, count);
+    } else {
+      FinishOutput(out_positions, count, _job.out_positions_format,
+                   out_positions_dest, _job.out_positions_stride, NULL,
+                   kFloat3, 0);
+      if (normals) {
+        FinishOutput(out_normals, count, _job.out_normals_format,
+                     out_normals_dest, _job.out_normals_stride,
+                     in_normals_src, _job.in_normals_format,
+                     _job.in_normals_stride);
+      }
+      if (tangents) {
+        FinishOutput(out_tangents, count, _job.out_tangents_format,
+                     out_tangents_dest, _job.out_tangents_stride,
+                     in_tangents_src, _job.in_tangents_format,
+                     _job.in_tangents_stride);
+      }
+    }
+  }
+
+#if defined(OZZ_SIMD_SSE2)
+  // Makes non-temporal stores globally visible.
+  if (streamed) {
+    _mm_sfence();
+  }
+#endif  // OZZ_SIMD_SSE2
+}
+
+// Skins all _job vertices, converting them if needed.
+void RunVertices(const SkinningJob& _job) {
+  // Compact inputs, vertex formats other than kFloat3, morphing and streaming
+  // output require intermediate buffers.
+  const SkinningJob::Format kFloat3 = SkinningJob::kFloat3;
+  if (_job.streaming_output || _job.morph_targets.begin != NULL ||
+      _job.joint_indices_u8.begin != NULL ||
+      _job.joint_weights_u8.begin != NULL ||
+      _job.joint_weights_u16.begin != NULL ||
+      _job.in_positions_format != kFloat3 ||
+      _job.in_normals_format != kFloat3 ||
+      _job.in_tangents_format != kFloat3 ||
+      _job.out_positions_format != kFloat3 ||
+      _job.out_normals_format != kFloat3 ||
+      _job.out_tangents_format != kFloat3) {
+    RunBatches(_job);
+  } else {
+    RunSkinningFct(_job);
+  }
+}
+
+// Moves all _sub job per-vertex inputs and outputs forward by _count
+// vertices, using _job strides.
+void AdvanceVertices(SkinningJob* _sub, const SkinningJob& _job, int _count) {
+  Advance(&_sub->joint_indices, _job.joint_indices_stride, _count);
+  Advance(&_sub->joint_indices_u8, _job.joint_indices_stride, _count);
+  Advance(&_sub->joint_weights, _job.joint_weights_stride, _count);
+  Advance(&_sub->joint_weights_u8, _job.joint_weights_stride, _count);
+  Advance(&_sub->joint_weights_u16, _job.joint_weights_stride, _count);
+  Advance(&_sub->in_positions, _job.in_positions_stride, _count);
+  Advance(&_sub->in_normals, _job.in_normals_stride, _count);
+  Advance(&_sub->in_tangents, _job.in_tangents_stride, _count);
+  Advance(&_sub->out_positions, _job.out_positions_stride, _count);
+  Advance(&_sub->out_normals, _job.out_normals_stride, _count);
+  Advance(&_sub->out_tangents, _job.out_tangents_stride, _count);
+  _sub->morph_first_vertex += _count;
+}
+
+// Skins each _job rigid range as a sub job, whose rigid_ranges is restricted
+// to the range, then skins remaining vertices without rigid ranges.
+void RunRigidRanges(const SkinningJob& _job) {
+  SkinningJob sub = _job;
+  int remaining = _job.vertex_count;
+  for (const SkinningJob::RigidRange* range = _job.rigid_ranges.begin;
+       range < _job.rigid_ranges.end; ++range) {
+    const int count = range->vertex_count;
+    if (count != 0) {
+      sub.vertex_count = count;
+      sub.rigid_ranges = Range<const SkinningJob::RigidRange>(range, 1);
+      RunVertices(sub);
+    }
+    AdvanceVertices(&sub, _job, count);
+    remaining -= count;
+  }
+  if (remaining != 0) {
+    sub.vertex_count = remaining;
+    sub.rigid_ranges = Range<const SkinningJob::RigidRange>();
+    RunVertices(sub);
+  }
+}
+
+// Skins each _job influence bucket as a sub job, which number of influences
+// is the one of the bucket. Rigid ranges belong to the first bucket.
+void RunBuckets(const SkinningJob& _job) {
+  SkinningJob bucket = _job;
+  bucket.influences_buckets = Range<const int>();
+  for (int i = 0; i < static_cast<int>(_job.influences_buckets.count());
+       ++i) {
+    const int count = _job.influences_buckets.begin[i];
+    if (count != 0) {
+      bucket.vertex_count = count;
+      bucket.influences_count = i + 1;
+      if (i == 0 && bucket.rigid_ranges.begin != NULL) {
+        RunRigidRanges(bucket);
+      } else {
+        bucket.rigid_ranges = Range<const SkinningJob::RigidRange>();
+        RunVertices(bucket);
+      }
+    }
+    AdvanceVertices(&bucket, _job, count);
+  }
+}
+}  // namespace
+
+// Implements job Run function.
+bool SkinningJob::Run() const {
+  // Exit with an error if job is invalid.
+  if (!Validate()) {
+    return false;
+  }
+  RunUnchecked();
   return true;
 }
+
+void SkinningJob::RunUnchecked() const {
+  OZZ_PROFILE_ZONE("ozz::SkinningJob::Run");
+  assert(Validate() && "Invalid job, see SkinningJob::Validate().");
+
+  // Early out if no vertex. This isn't an error.
+  // Skinning function algorithm doesn't support the case.
+  if (vertex_count == 0) {
+    return;
+  }
+
+  if (influences_buckets.begin != NULL) {
+    RunBuckets(*this);
+  } else if (rigid_ranges.begin != NULL) {
+    RunRigidRanges(*this);
+  } else {
+    RunVertices(*this);
+  }
+}
 }  // namespace geometry
 }  // namespace ozz
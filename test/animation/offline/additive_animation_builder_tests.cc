@@ -315,3 +315,72 @@ TEST(BuildRefPose, AdditiveAnimationBuilder) {
     }
   }
 }
+
+TEST(BuildSparse, AdditiveAnimationBuilder) {
+  AdditiveAnimationBuilder builder;
+  ozz::Vector<int>::Std soa_joints;
+
+  {  // Invalid inputs.
+    RawAnimation input;
+    RawAnimation output;
+    EXPECT_FALSE(builder.BuildSparse(input, NULL, &soa_joints));
+    EXPECT_FALSE(builder.BuildSparse(input, &output, NULL));
+
+    input.duration = -1.f;
+    soa_joints.push_back(0);
+    output.tracks.resize(1);
+    EXPECT_FALSE(builder.BuildSparse(input, &output, &soa_joints));
+    EXPECT_EQ(output.num_tracks(), 0);
+    EXPECT_TRUE(soa_joints.empty());
+  }
+
+  // 9 tracks, aka 3 SoA joints, which are all identity but the 6th and 9th.
+  RawAnimation input;
+  input.duration = 2.f;
+  input.tracks.resize(9);
+  for (int i = 0; i < input.num_tracks(); ++i) {
+    const RawAnimation::TranslationKey tkey = {.5f, ozz::math::Float3::zero()};
+    input.tracks[i].translations.push_back(tkey);
+    const RawAnimation::RotationKey rkey = {
+        .5f, ozz::math::Quaternion::identity()};
+    input.tracks[i].rotations.push_back(rkey);
+  }
+  const RawAnimation::TranslationKey tkey = {1.f,
+                                             ozz::math::Float3(0.f, 1.f, 0.f)};
+  input.tracks[5].translations.push_back(tkey);
+  const RawAnimation::ScaleKey skey = {1.f, ozz::math::Float3(2.f)};
+  input.tracks[8].scales.push_back(skey);
+  ASSERT_TRUE(input.Validate());
+
+  RawAnimation output;
+  ASSERT_TRUE(builder.BuildSparse(input, &output, &soa_joints));
+  EXPECT_FLOAT_EQ(output.duration, 2.f);
+  ASSERT_EQ(soa_joints.size(), 2u);
+  EXPECT_EQ(soa_joints[0], 1);
+  EXPECT_EQ(soa_joints[1], 2);
+
+  // Kept SoA joints are copied, and the last one is padded.
+  ASSERT_EQ(output.num_tracks(), 8);
+  ASSERT_EQ(output.tracks[1].translations.size(), 2u);
+  EXPECT_FLOAT3_EQ(output.tracks[1].translations[1].value, 0.f, 1.f, 0.f);
+  ASSERT_EQ(output.tracks[4].scales.size(), 1u);
+  EXPECT_FLOAT3_EQ(output.tracks[4].scales[0].value, 2.f, 2.f, 2.f);
+  for (int i = 5; i < 8; ++i) {
+    EXPECT_TRUE(output.tracks[i].translations.empty());
+    EXPECT_TRUE(output.tracks[i].rotations.empty());
+    EXPECT_TRUE(output.tracks[i].scales.empty());
+  }
+
+  // Deltas within tolerance are identity.
+  input.tracks[5].translations[1].value = ozz::math::Float3(0.f, 1e-6f, 0.f);
+  input.tracks[8].scales[0].value = ozz::math::Float3(1.f);
+  ASSERT_TRUE(builder.BuildSparse(input, &output, &soa_joints));
+  EXPECT_TRUE(soa_joints.empty());
+  EXPECT_EQ(output.num_tracks(), 0);
+
+  builder.identity_tolerance = 0.f;
+  ASSERT_TRUE(builder.BuildSparse(input, &output, &soa_joints));
+  ASSERT_EQ(soa_joints.size(), 1u);
+  EXPECT_EQ(soa_joints[0], 1);
+  EXPECT_EQ(output.num_tracks(), 4);
+}
@@ -27,13 +27,27 @@
 
 #include "ozz/animation/offline/animation_builder.h"
 
+#include <cmath>
+#include <cstring>
+#include <utility>
+
 #include "gtest/gtest.h"
 #include "ozz/base/maths/gtest_math_helper.h"
 
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/io/archive.h"
+#include "ozz/base/io/mapped_file.h"
+#include "ozz/base/io/stream.h"
+#include "ozz/base/maths/box.h"
 #include "ozz/base/maths/soa_transform.h"
 #include "ozz/base/memory/allocator.h"
+#include "ozz/base/memory/large_page_allocator.h"
+#include "ozz/base/memory/linear_allocator.h"
+#include "ozz/base/memory/tracking_allocator.h"
 
 #include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/raw_skeleton.h"
+#include "ozz/animation/offline/skeleton_builder.h"
 
 #include "ozz/animation/runtime/animation.h"
 #include "ozz/animation/runtime/sampling_job.h"
@@ -41,7 +55,10 @@
 
 using ozz::animation::Animation;
 using ozz::animation::offline::AnimationBuilder;
+using ozz::animation::offline::AnimationBuilderContext;
 using ozz::animation::offline::RawAnimation;
+using ozz::animation::offline::RawSkeleton;
+using ozz::animation::offline::SkeletonBuilder;
 
 TEST(Error, AnimationBuilder) {
   // Instantiates a builder objects with default parameters.
@@ -101,6 +118,40 @@ TEST(Error, AnimationBuilder) {
   }
 }
 
+TEST(MaxTracks, AnimationBuilder) {
+  // Rotation keys of the last track must keep their track index.
+  const int kNumTracks = ozz::animation::Skeleton::kMaxJoints;
+  RawAnimation raw_animation;
+  raw_animation.tracks.resize(kNumTracks);
+  const RawAnimation::RotationKey key = {
+      .5f, ozz::math::Quaternion(0.f, .70710677f, 0.f, .70710677f)};
+  raw_animation.tracks[kNumTracks - 1].rotations.push_back(key);
+
+  AnimationBuilder builder;
+  Animation* animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+  EXPECT_EQ(animation->num_tracks(), kNumTracks);
+
+  ozz::animation::SamplingJob job;
+  ozz::animation::SamplingCache cache(kNumTracks);
+  ozz::Vector<ozz::math::SoaTransform>::Std output(
+      animation->num_soa_tracks());
+  job.animation = animation;
+  job.cache = &cache;
+  job.output = make_range(output);
+  job.ratio = 0.f;
+  ASSERT_TRUE(job.Run());
+
+  EXPECT_SOAQUATERNION_EQ_EST(output[0].rotation, 0.f, 0.f, 0.f, 0.f, 0.f,
+                              0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 1.f, 1.f,
+                              1.f, 1.f);
+  EXPECT_SOAQUATERNION_EQ_EST(output.back().rotation, 0.f, 0.f, 0.f, 0.f, 0.f,
+                              0.f, 0.f, .70710677f, 0.f, 0.f, 0.f, 0.f, 1.f,
+                              1.f, 1.f, .70710677f);
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
 TEST(Build, AnimationBuilder) {
   // Instantiates a builder objects with default parameters.
   AnimationBuilder builder;
@@ -354,3 +405,1151 @@ TEST(Sort, AnimationBuilder) {
     ozz::memory::default_allocator()->Delete(animation);
   }
 }
+
+TEST(ConstantTracks, AnimationBuilder) {
+  // Instantiates a builder objects with default parameters.
+  AnimationBuilder builder;
+
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(6);
+
+  // Track 0 translation is animated, track 1 translation is constant but
+  // defined with multiple keys, track 2 has a single translation key. Other
+  // tracks, including soa padding tracks, are identity.
+  const RawAnimation::TranslationKey t0a = {0.f,
+                                            ozz::math::Float3(1.f, 0.f, 0.f)};
+  raw_animation.tracks[0].translations.push_back(t0a);
+  const RawAnimation::TranslationKey t0b = {1.f,
+                                            ozz::math::Float3(3.f, 0.f, 0.f)};
+  raw_animation.tracks[0].translations.push_back(t0b);
+  const RawAnimation::TranslationKey t1 = {.2f,
+                                           ozz::math::Float3(0.f, 2.f, 0.f)};
+  raw_animation.tracks[1].translations.push_back(t1);
+  raw_animation.tracks[1].translations.push_back(t1);
+  raw_animation.tracks[1].translations.back().time = .7f;
+  const RawAnimation::TranslationKey t2 = {.5f,
+                                           ozz::math::Float3(0.f, 0.f, 4.f)};
+  raw_animation.tracks[2].translations.push_back(t2);
+
+  // Track 5 scale is animated.
+  const RawAnimation::ScaleKey s5a = {0.f, ozz::math::Float3(1.f, 1.f, 1.f)};
+  raw_animation.tracks[5].scales.push_back(s5a);
+  const RawAnimation::ScaleKey s5b = {.5f, ozz::math::Float3(2.f, 1.f, 1.f)};
+  raw_animation.tracks[5].scales.push_back(s5b);
+
+  Animation* animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+
+  // 8 soa aligned tracks.
+  EXPECT_EQ(animation->num_constant_translations(), 7);
+  EXPECT_EQ(animation->num_constant_rotations(), 8);
+  EXPECT_EQ(animation->num_constant_scales(), 7);
+
+  ozz::animation::SamplingJob job;
+  ozz::animation::SamplingCache cache(6);
+  ozz::math::SoaTransform output[2];
+  job.animation = animation;
+  job.cache = &cache;
+  job.output.begin = output;
+  job.output.end = output + 2;
+
+  const float ratios[] = {0.f, .25f, .5f, 1.f, .75f};
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(ratios); ++i) {
+    job.ratio = ratios[i];
+    ASSERT_TRUE(job.Run());
+    const float t = 1.f + 2.f * ratios[i];
+    EXPECT_SOAFLOAT3_EQ_EST(output[0].translation, t, 0.f, 0.f, 0.f, 0.f, 2.f,
+                            0.f, 0.f, 0.f, 0.f, 4.f, 0.f);
+    EXPECT_SOAQUATERNION_EQ_EST(output[0].rotation, 0.f, 0.f, 0.f, 0.f, 0.f,
+                                0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 1.f, 1.f,
+                                1.f, 1.f);
+    const float s = 1.f + ozz::math::Min(ratios[i] * 2.f, 1.f);
+    EXPECT_SOAFLOAT3_EQ_EST(output[1].scale, 1.f, s, 1.f, 1.f, 1.f, 1.f, 1.f,
+                            1.f, 1.f, 1.f, 1.f, 1.f);
+  }
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+TEST(Bounds, AnimationBuilder) {
+  // A root joint with a child.
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  raw_skeleton.roots[0].children.resize(1);
+  SkeletonBuilder skeleton_builder;
+  ozz::animation::Skeleton* skeleton = skeleton_builder(raw_skeleton);
+  ASSERT_TRUE(skeleton != NULL);
+
+  // Root moves along x, child is 1 unit above the root.
+  RawAnimation raw_animation;
+  raw_animation.duration = 2.f;
+  raw_animation.tracks.resize(2);
+  const RawAnimation::TranslationKey t0 = {0.f,
+                                           ozz::math::Float3(0.f, 0.f, 0.f)};
+  raw_animation.tracks[0].translations.push_back(t0);
+  const RawAnimation::TranslationKey t1 = {2.f,
+                                           ozz::math::Float3(4.f, 0.f, 0.f)};
+  raw_animation.tracks[0].translations.push_back(t1);
+  const RawAnimation::TranslationKey t2 = {0.f,
+                                           ozz::math::Float3(0.f, 1.f, 0.f)};
+  raw_animation.tracks[1].translations.push_back(t2);
+
+  AnimationBuilder builder;
+
+  {  // No bounds by default.
+    Animation* animation = builder(raw_animation);
+    ASSERT_TRUE(animation != NULL);
+    EXPECT_EQ(animation->num_bounds(), 0);
+    EXPECT_TRUE(animation->GetBounds(.5f) == NULL);
+    ozz::memory::default_allocator()->Delete(animation);
+  }
+
+  builder.bounds_interval = 1.f;
+
+  {  // Bounds require a skeleton.
+    EXPECT_TRUE(!builder(raw_animation));
+  }
+
+  {  // Bounds require a matching skeleton.
+    RawAnimation mismatching = raw_animation;
+    mismatching.tracks.resize(3);
+    builder.bounds_skeleton = skeleton;
+    EXPECT_TRUE(!builder(mismatching));
+  }
+
+  {  // Builds bounds.
+    builder.bounds_skeleton = skeleton;
+    Animation* animation = builder(raw_animation);
+    ASSERT_TRUE(animation != NULL);
+    ASSERT_EQ(animation->num_bounds(), 2);
+
+    // Translations are quantized.
+    const float kTolerance = 2e-3f;
+    const ozz::math::Box& b0 = animation->bounds()[0];
+    EXPECT_NEAR(b0.min.x, 0.f, kTolerance);
+    EXPECT_NEAR(b0.min.y, 0.f, kTolerance);
+    EXPECT_NEAR(b0.max.x, 2.f, kTolerance);
+    EXPECT_NEAR(b0.max.y, 1.f, kTolerance);
+    const ozz::math::Box& b1 = animation->bounds()[1];
+    EXPECT_NEAR(b1.min.x, 2.f, kTolerance);
+    EXPECT_NEAR(b1.min.y, 0.f, kTolerance);
+    EXPECT_NEAR(b1.max.x, 4.f, kTolerance);
+    EXPECT_NEAR(b1.max.y, 1.f, kTolerance);
+
+    EXPECT_EQ(animation->GetBounds(-1.f), &animation->bounds()[0]);
+    EXPECT_EQ(animation->GetBounds(.25f), &animation->bounds()[0]);
+    EXPECT_EQ(animation->GetBounds(.5f), &animation->bounds()[1]);
+    EXPECT_EQ(animation->GetBounds(1.f), &animation->bounds()[1]);
+    EXPECT_EQ(animation->GetBounds(2.f), &animation->bounds()[1]);
+
+    ozz::memory::default_allocator()->Delete(animation);
+  }
+
+  {  // Odd interval.
+    builder.bounds_interval = .75f;
+    Animation* animation = builder(raw_animation);
+    ASSERT_TRUE(animation != NULL);
+    ASSERT_EQ(animation->num_bounds(), 3);
+    ozz::memory::default_allocator()->Delete(animation);
+  }
+
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+TEST(Allocator, AnimationBuilder) {
+  AnimationBuilder builder;
+
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(5);
+  const RawAnimation::TranslationKey key = {.5f,
+                                            ozz::math::Float3(1.f, 2.f, 3.f)};
+  raw_animation.tracks[3].translations.push_back(key);
+
+  // Default allocator.
+  {
+    Animation* animation = builder(raw_animation);
+    ASSERT_TRUE(animation != NULL);
+    EXPECT_EQ(animation->allocator(), ozz::memory::default_allocator());
+    ozz::memory::default_allocator()->Delete(animation);
+  }
+
+  // Explicit allocator, for both animation object and data.
+  ozz::memory::LinearAllocator allocator(4096);
+  Animation* animation = builder(raw_animation, &allocator);
+  ASSERT_TRUE(animation != NULL);
+  EXPECT_EQ(animation->allocator(), &allocator);
+  EXPECT_TRUE(allocator.used() > sizeof(Animation));
+
+  // Cache data can also be allocated from a dedicated allocator.
+  const size_t animation_used = allocator.used();
+  ozz::animation::SamplingCache cache(
+      5, ozz::animation::SamplingCache::kFull, &allocator);
+  EXPECT_EQ(cache.allocator(), &allocator);
+  EXPECT_TRUE(allocator.used() > animation_used);
+
+  ozz::math::SoaTransform output[2];
+  ozz::animation::SamplingJob job;
+  job.animation = animation;
+  job.cache = &cache;
+  job.ratio = 0.f;
+  job.output = output;
+  ASSERT_TRUE(job.Run());
+  EXPECT_SOAFLOAT3_EQ(output[0].translation, 0.f, 0.f, 0.f, 1.f, 0.f, 0.f, 0.f,
+                      2.f, 0.f, 0.f, 0.f, 3.f);
+
+  allocator.Delete(animation);
+
+  // Fails if the animation can't be allocated.
+  ozz::memory::LinearAllocator small_allocator(8);
+  EXPECT_TRUE(builder(raw_animation, &small_allocator) == NULL);
+  EXPECT_EQ(small_allocator.used(), 0u);
+}
+
+TEST(Frames, AnimationBuilder) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 2.f;
+  raw_animation.tracks.resize(2);
+
+  AnimationBuilder builder;
+  {  // No key, only the first and last frames are needed.
+    Animation* animation = builder(raw_animation);
+    ASSERT_TRUE(animation != NULL);
+    EXPECT_EQ(animation->num_frames(), 1);
+    ozz::memory::default_allocator()->Delete(animation);
+  }
+
+  // Keys sampled at 30Hz, whose smallest interval is 3 frames.
+  const int frames[] = {0, 3, 7, 12, 60};
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(frames); ++i) {
+    const RawAnimation::TranslationKey key = {
+        frames[i] * (1.f / 30.f), ozz::math::Float3(frames[i] * 1.f, 0.f, 0.f)};
+    raw_animation.tracks[0].translations.push_back(key);
+  }
+  const RawAnimation::RotationKey rkey = {
+      41.f / 30.f, ozz::math::Quaternion::identity()};
+  raw_animation.tracks[1].rotations.push_back(rkey);
+  {
+    Animation* animation = builder(raw_animation);
+    ASSERT_TRUE(animation != NULL);
+    EXPECT_EQ(animation->num_frames(), 60);
+
+    // Keys are sampled at their frame, values are only affected by their 16
+    // bits quantization.
+    ozz::animation::SamplingCache cache(2);
+    ozz::math::SoaTransform output[1];
+    ozz::animation::SamplingJob job;
+    job.animation = animation;
+    job.cache = &cache;
+    job.output = output;
+    for (size_t i = 0; i < OZZ_ARRAY_SIZE(frames); ++i) {
+      job.ratio = frames[i] / 60.f;
+      ASSERT_TRUE(job.Run());
+      EXPECT_NEAR(ozz::math::GetX(output[0].translation.x), frames[i] * 1.f,
+                  1e-3f);
+    }
+    ozz::memory::default_allocator()->Delete(animation);
+  }
+
+  // A key out of the 30Hz grid selects the finest frame count.
+  const RawAnimation::ScaleKey skey = {.1234f, ozz::math::Float3::one()};
+  raw_animation.tracks[1].scales.push_back(skey);
+  {
+    Animation* animation = builder(raw_animation);
+    ASSERT_TRUE(animation != NULL);
+    EXPECT_EQ(animation->num_frames(), 65535);
+    ozz::memory::default_allocator()->Delete(animation);
+  }
+
+  // Keys of a track that would be stored at the same frame index are stored as
+  // float key times.
+  const RawAnimation::ScaleKey close = {.1234f + 1e-6f,
+                                        ozz::math::Float3::one()};
+  raw_animation.tracks[1].scales.push_back(close);
+  {
+    Animation* animation = builder(raw_animation);
+    ASSERT_TRUE(animation != NULL);
+    EXPECT_EQ(animation->num_frames(), 65535);
+    ASSERT_TRUE(animation->has_key_times());
+    EXPECT_NE(animation->translation_times().count(), 0u);
+    EXPECT_NE(animation->rotation_times().count(), 0u);
+    EXPECT_NE(animation->scale_times().count(), 0u);
+    ozz::memory::default_allocator()->Delete(animation);
+  }
+}
+
+TEST(LongClip, AnimationBuilder) {
+  // A 40 minutes clip sampled at 30Hz has more frames than 16 bits frame
+  // indices can address.
+  RawAnimation raw_animation;
+  raw_animation.duration = 2400.f;
+  raw_animation.tracks.resize(1);
+  const int frames[] = {0, 1, 2, 36000, 71998, 71999, 72000};
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(frames); ++i) {
+    const RawAnimation::TranslationKey key = {
+        frames[i] / 30.f, ozz::math::Float3(frames[i] * .001f, 0.f, 0.f)};
+    raw_animation.tracks[0].translations.push_back(key);
+  }
+
+  AnimationBuilder builder;
+  Animation* animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+
+  // Frame indices are stored exactly as float key times.
+  EXPECT_EQ(animation->num_frames(), 72000);
+  ASSERT_TRUE(animation->has_key_times());
+  const ozz::Range<const float> times = animation->translation_times();
+  ASSERT_GE(times.count(), OZZ_ARRAY_SIZE(frames));
+  for (size_t i = 0; i < times.count(); ++i) {
+    EXPECT_EQ(times[i], std::floor(times[i]));
+  }
+
+  // All keys are sampled at their frame, none was merged.
+  ozz::animation::SamplingCache cache(1);
+  ozz::math::SoaTransform output[1];
+  ozz::animation::SamplingJob job;
+  job.animation = animation;
+  job.cache = &cache;
+  job.output = output;
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(frames); ++i) {
+    job.ratio = frames[i] / 72000.f;
+    ASSERT_TRUE(job.Run());
+    EXPECT_NEAR(ozz::math::GetX(output[0].translation.x), frames[i] * .001f,
+                2e-3f);
+  }
+
+  // Compact mode stores key times as 16 bits frame indices.
+  ozz::animation::SamplingCache compact_cache(
+      1, ozz::animation::SamplingCache::kCompact);
+  job.cache = &compact_cache;
+  EXPECT_FALSE(job.Validate());
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+TEST(CloseKeys, AnimationBuilder) {
+  // Keys 10us apart in a 100s clip share a frame when the duration is divided
+  // in 65535 frames.
+  RawAnimation raw_animation;
+  raw_animation.duration = 100.f;
+  raw_animation.tracks.resize(1);
+  const RawAnimation::TranslationKey key0 = {.3f,
+                                             ozz::math::Float3(0.f, 0.f, 0.f)};
+  raw_animation.tracks[0].translations.push_back(key0);
+  const RawAnimation::TranslationKey key1 = {.30001f,
+                                             ozz::math::Float3(1.f, 0.f, 0.f)};
+  raw_animation.tracks[0].translations.push_back(key1);
+
+  AnimationBuilder builder;
+  Animation* animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+  EXPECT_EQ(animation->num_frames(), 65535);
+  ASSERT_TRUE(animation->has_key_times());
+
+  // Both keys are kept.
+  ozz::animation::SamplingCache cache(1);
+  ozz::math::SoaTransform output[1];
+  ozz::animation::SamplingJob job;
+  job.animation = animation;
+  job.cache = &cache;
+  job.output = output;
+  job.ratio = .3f / 100.f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_NEAR(ozz::math::GetX(output[0].translation.x), 0.f, 1e-2f);
+  job.ratio = .30001f / 100.f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_NEAR(ozz::math::GetX(output[0].translation.x), 1.f, 1e-2f);
+  job.ratio = 1.f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_NEAR(ozz::math::GetX(output[0].translation.x), 1.f, 1e-3f);
+
+  // Animations with frame indices are built again without float key times.
+  raw_animation.tracks[0].translations.pop_back();
+  EXPECT_TRUE(builder(raw_animation, animation));
+  EXPECT_FALSE(animation->has_key_times());
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+TEST(Steps, AnimationBuilder) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(9);
+
+  AnimationBuilder builder;
+  {  // No step track.
+    Animation* animation = builder(raw_animation);
+    ASSERT_TRUE(animation != NULL);
+    EXPECT_FALSE(animation->has_steps());
+    EXPECT_EQ(animation->steps().count(), 0u);
+    ozz::memory::default_allocator()->Delete(animation);
+  }
+
+  raw_animation.tracks[0].step = true;
+  raw_animation.tracks[3].step = true;
+  raw_animation.tracks[8].step = true;
+  {  // One bit per track.
+    Animation* animation = builder(raw_animation);
+    ASSERT_TRUE(animation != NULL);
+    ASSERT_TRUE(animation->has_steps());
+    ASSERT_EQ(animation->steps().count(), 2u);
+    EXPECT_EQ(animation->steps()[0], 0x9);
+    EXPECT_EQ(animation->steps()[1], 0x1);
+
+    // Steps are part of the flat representation.
+    ozz::memory::Allocator* allocator = ozz::memory::default_allocator();
+    const size_t size = animation->flat_size();
+    void* buffer = allocator->Allocate(size, Animation::kFlatAlignment);
+    ASSERT_TRUE(animation->WriteFlat(buffer, size));
+    {
+      Animation mapped;
+      ASSERT_TRUE(mapped.MapFlat(buffer, size));
+      ASSERT_EQ(mapped.steps().count(), 2u);
+      EXPECT_EQ(mapped.steps()[0], 0x9);
+      EXPECT_EQ(mapped.steps()[1], 0x1);
+    }
+    allocator->Deallocate(buffer);
+    allocator->Delete(animation);
+  }
+}
+
+TEST(PrecisionLods, AnimationBuilder) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(4);
+
+  // Track 0 translations are linear, but for a 3cm bump at t = .5. Track 1 is
+  // a step track, whose keys are never skipped. Tracks 2 and 3 are constant.
+  for (int k = 0; k <= 10; ++k) {
+    const float time = k / 10.f;
+    const RawAnimation::TranslationKey key = {
+        time, ozz::math::Float3(time + (k == 5 ? .03f : 0.f), 0.f, 0.f)};
+    raw_animation.tracks[0].translations.push_back(key);
+  }
+  raw_animation.tracks[1].step = true;
+  for (int k = 0; k <= 4; ++k) {
+    const RawAnimation::TranslationKey key = {
+        k / 4.f, ozz::math::Float3(k * 1.f, 0.f, 0.f)};
+    raw_animation.tracks[1].translations.push_back(key);
+  }
+
+  AnimationBuilder builder;
+  {  // No precision lod by default.
+    Animation* animation = builder(raw_animation);
+    ASSERT_TRUE(animation != NULL);
+    EXPECT_FALSE(animation->has_precision_lods());
+    EXPECT_EQ(animation->translation_key_lods().count(), 0u);
+    EXPECT_EQ(animation->translation_lod_next().count(), 0u);
+    ozz::memory::default_allocator()->Delete(animation);
+  }
+
+  {  // Invalid settings.
+    AnimationBuilder invalid;
+    invalid.precision_lods = -1;
+    EXPECT_TRUE(!invalid(raw_animation));
+    invalid.precision_lods = Animation::kKeepKeyLod;
+    EXPECT_TRUE(!invalid(raw_animation));
+    invalid.precision_lods = 2;
+    invalid.precision_rotation_tolerance = -1.f;
+    EXPECT_TRUE(!invalid(raw_animation));
+    invalid.precision_rotation_tolerance = 1e-3f;
+    invalid.spline = true;
+    EXPECT_TRUE(!invalid(raw_animation));
+  }
+
+  // Lods 1 to 6 tolerances are 1, 2, 4, 8, 16 and 32mm.
+  builder.precision_lods = 6;
+  Animation* animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+  ASSERT_TRUE(animation->has_precision_lods());
+  ASSERT_EQ(animation->translation_key_lods().count(), 18u);
+  ASSERT_EQ(animation->translation_lod_next().count(), 18u);
+  ASSERT_EQ(animation->rotation_key_lods().count(), 4u);
+  ASSERT_EQ(animation->scale_lod_next().count(), 4u);
+
+  // Linear keys are skipped by lod 1, the bump and its neighbors (whose removal
+  // errors are 3 and 2.4cm) by lod 6. First and last keys, constant and step
+  // tracks keys are kept.
+  const ozz::Range<const uint8_t> lods = animation->translation_key_lods();
+  const ozz::Range<const int> next = animation->translation_lod_next();
+  int counts[3] = {0, 0, 0};
+  for (size_t i = 0; i < lods.count(); ++i) {
+    if (lods[i] == Animation::kKeepKeyLod) {
+      ++counts[2];
+      EXPECT_EQ(next[i], -1);
+      continue;
+    }
+    ASSERT_TRUE(lods[i] == 0 || lods[i] == 5);
+    ++counts[lods[i] / 5];
+
+    // Next key has a higher lod.
+    ASSERT_GT(next[i], static_cast<int>(i));
+    ASSERT_LT(next[i], static_cast<int>(lods.count()));
+    EXPECT_GT(lods[next[i]], lods[i]);
+  }
+  EXPECT_EQ(counts[0], 6);
+  EXPECT_EQ(counts[1], 3);
+  EXPECT_EQ(counts[2], 9);
+
+  // Rotations and scales are all constant.
+  for (size_t i = 0; i < animation->rotation_key_lods().count(); ++i) {
+    EXPECT_EQ(animation->rotation_key_lods()[i], Animation::kKeepKeyLod);
+  }
+
+  // Precision lods are part of the flat representation.
+  ozz::memory::Allocator* allocator = ozz::memory::default_allocator();
+  const size_t size = animation->flat_size();
+  void* buffer = allocator->Allocate(size, Animation::kFlatAlignment);
+  ASSERT_TRUE(animation->WriteFlat(buffer, size));
+  {
+    Animation mapped;
+    ASSERT_TRUE(mapped.MapFlat(buffer, size));
+    ASSERT_TRUE(mapped.has_precision_lods());
+    ASSERT_EQ(mapped.translation_key_lods().count(), lods.count());
+    for (size_t i = 0; i < lods.count(); ++i) {
+      EXPECT_EQ(mapped.translation_key_lods()[i], lods[i]);
+      EXPECT_EQ(mapped.translation_lod_next()[i], next[i]);
+    }
+  }
+  allocator->Deallocate(buffer);
+  allocator->Delete(animation);
+}
+
+TEST(Sparse, AnimationBuilder) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(12);
+
+  AnimationBuilder builder;
+  {  // Dense by default.
+    Animation* animation = builder(raw_animation);
+    ASSERT_TRUE(animation != NULL);
+    EXPECT_FALSE(animation->sparse());
+    EXPECT_EQ(animation->soa_joints().count(), 0u);
+    EXPECT_EQ(animation->num_tracks(), 12);
+    ozz::memory::default_allocator()->Delete(animation);
+  }
+
+  const RawAnimation::TranslationKey key = {0.f,
+                                            ozz::math::Float3(1.f, 2.f, 3.f)};
+  raw_animation.tracks[8].translations.push_back(key);
+  raw_animation.tracks[9].translations.push_back(key);
+  raw_animation.tracks[9].step = true;
+
+  builder.sparse = true;
+  {  // Only the third soa joint is keyed.
+    Animation* animation = builder(raw_animation);
+    ASSERT_TRUE(animation != NULL);
+    ASSERT_TRUE(animation->sparse());
+    EXPECT_EQ(animation->num_tracks(), 4);
+    ASSERT_EQ(animation->soa_joints().count(), 1u);
+    EXPECT_EQ(animation->soa_joints()[0], 2);
+    ASSERT_TRUE(animation->has_steps());
+    EXPECT_EQ(animation->steps()[0], 0x2);
+
+    // Soa joints are part of the flat representation.
+    ozz::memory::Allocator* allocator = ozz::memory::default_allocator();
+    const size_t size = animation->flat_size();
+    void* buffer = allocator->Allocate(size, Animation::kFlatAlignment);
+    ASSERT_TRUE(animation->WriteFlat(buffer, size));
+    {
+      Animation mapped;
+      ASSERT_TRUE(mapped.MapFlat(buffer, size));
+      ASSERT_TRUE(mapped.sparse());
+      ASSERT_EQ(mapped.soa_joints().count(), 1u);
+      EXPECT_EQ(mapped.soa_joints()[0], 2);
+    }
+    allocator->Deallocate(buffer);
+    allocator->Delete(animation);
+  }
+
+  raw_animation.tracks[0].translations.push_back(key);
+  {  // Soa joints are sorted.
+    Animation* animation = builder(raw_animation);
+    ASSERT_TRUE(animation != NULL);
+    EXPECT_EQ(animation->num_tracks(), 8);
+    ASSERT_EQ(animation->soa_joints().count(), 2u);
+    EXPECT_EQ(animation->soa_joints()[0], 0);
+    EXPECT_EQ(animation->soa_joints()[1], 2);
+    ozz::memory::default_allocator()->Delete(animation);
+  }
+
+  {  // Sparse animations can't have bounds, even with a matching skeleton.
+    RawSkeleton raw_skeleton;
+    raw_skeleton.roots.resize(12);
+    SkeletonBuilder skeleton_builder;
+    ozz::animation::Skeleton* skeleton = skeleton_builder(raw_skeleton);
+    ASSERT_TRUE(skeleton != NULL);
+    builder.bounds_skeleton = skeleton;
+
+    Animation* animation = builder(raw_animation);
+    ASSERT_TRUE(animation != NULL);
+    EXPECT_EQ(animation->skeleton_fingerprint(), skeleton->fingerprint());
+    ozz::memory::default_allocator()->Delete(animation);
+
+    builder.bounds_interval = .1f;
+    EXPECT_TRUE(builder(raw_animation) == NULL);
+    ozz::memory::default_allocator()->Delete(skeleton);
+  }
+}
+
+TEST(Flat, AnimationBuilder) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.name = "flat";
+  raw_animation.tracks.resize(5);
+  const RawAnimation::TranslationKey first = {0.f,
+                                              ozz::math::Float3(0.f, 0.f, 0.f)};
+  const RawAnimation::TranslationKey last = {1.f,
+                                             ozz::math::Float3(2.f, 4.f, 6.f)};
+  raw_animation.tracks[3].translations.push_back(first);
+  raw_animation.tracks[3].translations.push_back(last);
+
+  AnimationBuilder builder;
+  builder.seek_interval = .25f;
+  Animation* built = builder(raw_animation);
+  ASSERT_TRUE(built != NULL);
+
+  // Writes flat representation.
+  ozz::memory::Allocator* allocator = ozz::memory::default_allocator();
+  const size_t size = built->flat_size();
+  void* written = allocator->Allocate(size, Animation::kFlatAlignment);
+  EXPECT_FALSE(built->WriteFlat(NULL, size));
+  EXPECT_FALSE(built->WriteFlat(written, size - 1));
+  EXPECT_FALSE(built->WriteFlat(static_cast<char*>(written) + 4, size - 4));
+  ASSERT_TRUE(built->WriteFlat(written, size));
+
+  // Flat representation is relocatable, and independent of the built
+  // animation.
+  void* buffer = allocator->Allocate(size, Animation::kFlatAlignment);
+  std::memcpy(buffer, written, size);
+  allocator->Deallocate(written);
+  const uint32_t uid = built->uid();
+  const int num_seek_points = built->num_seek_points();
+  EXPECT_GT(num_seek_points, 0);
+  allocator->Delete(built);
+
+  {
+    Animation animation;
+    EXPECT_FALSE(animation.MapFlat(buffer, size - 1));
+    EXPECT_FALSE(animation.mapped());
+    EXPECT_EQ(animation.num_tracks(), 0);
+
+    ASSERT_TRUE(animation.MapFlat(buffer, size));
+    EXPECT_TRUE(animation.mapped());
+    EXPECT_NE(animation.uid(), uid);
+    EXPECT_EQ(animation.duration(), 1.f);
+    EXPECT_EQ(animation.num_frames(), 1);
+    EXPECT_EQ(animation.num_tracks(), 5);
+    EXPECT_STREQ(animation.name(), "flat");
+    EXPECT_EQ(animation.num_seek_points(), num_seek_points);
+    EXPECT_EQ(animation.flat_size(), size);
+    EXPECT_TRUE(static_cast<const void*>(animation.translation_ranges().begin) >
+                buffer);
+    EXPECT_TRUE(static_cast<const void*>(animation.translation_ranges().begin) <
+                static_cast<char*>(buffer) + size);
+
+    ozz::animation::SamplingCache cache(5);
+    ozz::math::SoaTransform output[2];
+    ozz::animation::SamplingJob job;
+    job.animation = &animation;
+    job.cache = &cache;
+    job.ratio = .5f;
+    job.output = output;
+    ASSERT_TRUE(job.Run());
+    EXPECT_SOAFLOAT3_EQ_EST(output[0].translation, 0.f, 0.f, 0.f, 1.f, 0.f,
+                            0.f, 0.f, 2.f, 0.f, 0.f, 0.f, 3.f);
+  }
+
+  // The same buffer can be mapped by many animations.
+  {
+    Animation a, b;
+    ASSERT_TRUE(a.MapFlat(buffer, size));
+    ASSERT_TRUE(b.MapFlat(buffer, size));
+    EXPECT_EQ(a.translations().begin, b.translations().begin);
+    EXPECT_NE(a.uid(), b.uid());
+  }
+
+  // Corrupted buffers are rejected.
+  static_cast<char*>(buffer)[0] ^= 0xff;
+  {
+    Animation animation;
+    EXPECT_FALSE(animation.MapFlat(buffer, size));
+    EXPECT_FALSE(animation.mapped());
+  }
+  allocator->Deallocate(buffer);
+}
+
+TEST(CopyFrom, AnimationBuilder) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 2.f;
+  raw_animation.name = "copy";
+  raw_animation.tracks.resize(5);
+  const RawAnimation::TranslationKey first = {0.f,
+                                              ozz::math::Float3(0.f, 0.f, 0.f)};
+  const RawAnimation::TranslationKey last = {2.f,
+                                             ozz::math::Float3(2.f, 4.f, 6.f)};
+  raw_animation.tracks[3].translations.push_back(first);
+  raw_animation.tracks[3].translations.push_back(last);
+
+  AnimationBuilder builder;
+  builder.seek_interval = .5f;
+  builder.spline = true;
+  Animation* built = builder(raw_animation);
+  ASSERT_TRUE(built != NULL);
+
+  // Copies to an animation allocated from another allocator, like node local
+  // memory.
+  ozz::memory::LinearAllocator allocator(4096);
+  Animation* copy = allocator.New<Animation>(&allocator);
+  ASSERT_TRUE(copy != NULL);
+  const size_t used = allocator.used();
+  copy->CopyFrom(*built);
+  EXPECT_GT(allocator.used(), used);
+  EXPECT_EQ(copy->allocator(), &allocator);
+  EXPECT_NE(copy->uid(), built->uid());
+  EXPECT_EQ(copy->duration(), 2.f);
+  EXPECT_EQ(copy->num_frames(), built->num_frames());
+  EXPECT_EQ(copy->num_tracks(), 5);
+  EXPECT_STREQ(copy->name(), "copy");
+  EXPECT_TRUE(copy->spline());
+  EXPECT_EQ(copy->num_seek_points(), built->num_seek_points());
+  EXPECT_EQ(copy->size(), built->size());
+  EXPECT_NE(copy->translations().begin, built->translations().begin);
+
+  // Deleting the source doesn't affect the copy.
+  const float ratio = .5f;
+  ozz::math::SoaTransform expected[2];
+  {
+    ozz::animation::SamplingCache cache(
+        5, ozz::animation::SamplingCache::kSpline);
+    ozz::animation::SamplingJob job;
+    job.animation = built;
+    job.cache = &cache;
+    job.ratio = ratio;
+    job.output = expected;
+    ASSERT_TRUE(job.Run());
+  }
+  ozz::memory::default_allocator()->Delete(built);
+
+  {
+    ozz::animation::SamplingCache cache(
+        5, ozz::animation::SamplingCache::kSpline);
+    ozz::math::SoaTransform output[2];
+    ozz::animation::SamplingJob job;
+    job.animation = copy;
+    job.cache = &cache;
+    job.ratio = ratio;
+    job.output = output;
+    ASSERT_TRUE(job.Run());
+    EXPECT_EQ(std::memcmp(output, expected, sizeof(output)), 0);
+  }
+
+  // Copying an empty animation empties the copy.
+  Animation empty;
+  copy->CopyFrom(empty);
+  EXPECT_EQ(copy->num_tracks(), 0);
+  EXPECT_EQ(copy->duration(), 0.f);
+  EXPECT_STREQ(copy->name(), "");
+  EXPECT_TRUE(copy->translations().begin == NULL);
+
+  allocator.Delete(copy);
+}
+
+TEST(FlatFile, AnimationBuilder) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(2);
+  const RawAnimation::TranslationKey first = {0.f,
+                                              ozz::math::Float3(0.f, 0.f, 0.f)};
+  const RawAnimation::TranslationKey last = {1.f,
+                                             ozz::math::Float3(2.f, 4.f, 6.f)};
+  raw_animation.tracks[1].translations.push_back(first);
+  raw_animation.tracks[1].translations.push_back(last);
+
+  AnimationBuilder builder;
+  Animation* built = builder(raw_animation);
+  ASSERT_TRUE(built != NULL);
+
+  // Writes flat representation to a file.
+  {
+    ozz::memory::Allocator* allocator = ozz::memory::default_allocator();
+    const size_t size = built->flat_size();
+    void* buffer = allocator->Allocate(size, Animation::kFlatAlignment);
+    ASSERT_TRUE(built->WriteFlat(buffer, size));
+    ozz::io::File file("animation.flat", "wb");
+    ASSERT_TRUE(file.opened());
+    EXPECT_EQ(file.Write(buffer, size), size);
+    allocator->Deallocate(buffer);
+  }
+  ozz::memory::default_allocator()->Delete(built);
+
+  // Maps animation directly from the file, without loading it.
+  ozz::io::MappedFile file("animation.flat");
+  ASSERT_TRUE(file.opened());
+  Animation animation;
+  ASSERT_TRUE(animation.MapFlat(file.data(), file.size()));
+  EXPECT_EQ(animation.num_tracks(), 2);
+
+  ozz::animation::SamplingCache cache(2);
+  ozz::math::SoaTransform output[1];
+  ozz::animation::SamplingJob job;
+  job.animation = &animation;
+  job.cache = &cache;
+  job.ratio = .5f;
+  job.output = output;
+  ASSERT_TRUE(job.Run());
+  EXPECT_SOAFLOAT3_EQ_EST(output[0].translation, 0.f, 1.f, 0.f, 0.f, 0.f, 2.f,
+                          0.f, 0.f, 0.f, 3.f, 0.f, 0.f);
+}
+
+TEST(LargePageAllocator, AnimationBuilder) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(46);
+
+  ozz::memory::LargePageAllocator allocator;
+  AnimationBuilder builder;
+  Animation* animation = builder(raw_animation, &allocator);
+  ASSERT_TRUE(animation != NULL);
+  EXPECT_EQ(animation->allocator(), &allocator);
+  EXPECT_EQ(animation->num_tracks(), 46);
+  EXPECT_GT(allocator.mapped_bytes(), 0u);
+  allocator.Delete(animation);
+}
+
+namespace {
+// Builds a large spline animation, whose tracks are animated with different
+// noisy motions and number of keys.
+void BuildLargeAnimation(RawAnimation* _raw_animation) {
+  _raw_animation->duration = 10.f;
+  _raw_animation->tracks.resize(13);
+  for (size_t i = 0; i < _raw_animation->tracks.size(); ++i) {
+    RawAnimation::JointTrack& track = _raw_animation->tracks[i];
+    const float f = static_cast<float>(i + 1);
+    const int num_keys = 1000 + static_cast<int>(i) * 37;
+    for (int k = 0; k <= num_keys; ++k) {
+      const float t = _raw_animation->duration * k / num_keys;
+      const RawAnimation::TranslationKey tkey = {
+          t, ozz::math::Float3(std::sin(t * f), std::cos(t * 7.f), k * 1e-3f)};
+      track.translations.push_back(tkey);
+      const RawAnimation::RotationKey rkey = {
+          t, ozz::math::Quaternion::FromAxisAngle(ozz::math::Float3::y_axis(),
+                                                  std::cos(t * f) * 3.f)};
+      track.rotations.push_back(rkey);
+      if (i % 3) {  // Leaves some constant scale tracks.
+        const RawAnimation::ScaleKey skey = {
+            t, ozz::math::Float3(1.f + std::sin(t * f) * .1f)};
+        track.scales.push_back(skey);
+      }
+    }
+  }
+}
+
+// Serializes _animation to _stream.
+void SaveAnimation(const Animation& _animation,
+                   ozz::io::MemoryStream* _stream) {
+  ozz::io::OArchive archive(_stream);
+  archive << _animation;
+}
+
+// Expects _a and _b memory streams content to be the same.
+void ExpectSameContent(ozz::io::MemoryStream* _a, ozz::io::MemoryStream* _b) {
+  const size_t size = static_cast<size_t>(_a->Size());
+  ASSERT_EQ(_b->Size(), _a->Size());
+  ASSERT_GT(size, 0u);
+  ozz::Vector<char>::Std a(size), b(size);
+  _a->Seek(0, ozz::io::Stream::kSet);
+  _b->Seek(0, ozz::io::Stream::kSet);
+  ASSERT_EQ(_a->Read(&a[0], size), size);
+  ASSERT_EQ(_b->Read(&b[0], size), size);
+  EXPECT_EQ(std::memcmp(&a[0], &b[0], size), 0);
+}
+}  // namespace
+
+TEST(QuantizationTolerance, AnimationBuilder) {
+  // Translations move 10cm on x and 2m on y, but not on z. Scales barely
+  // change on x only.
+  RawAnimation raw_animation;
+  raw_animation.duration = 2.f;
+  raw_animation.tracks.resize(6);
+  for (int t = 0; t < 6; ++t) {
+    for (int i = 0; i <= 60; ++i) {
+      const RawAnimation::TranslationKey tkey = {
+          i / 30.f, ozz::math::Float3(.05f * std::sin(i * .1f + t),
+                                      2.f * i / 60.f, 1.f + t)};
+      raw_animation.tracks[t].translations.push_back(tkey);
+      const RawAnimation::ScaleKey skey = {
+          i / 30.f, ozz::math::Float3(1.f + .01f * std::cos(i * .2f + t), 1.f,
+                                      1.f)};
+      raw_animation.tracks[t].scales.push_back(skey);
+    }
+  }
+
+  AnimationBuilder builder;
+
+  // Negative tolerances are invalid.
+  builder.quantization_translation_tolerance = -1e-3f;
+  EXPECT_TRUE(!builder(raw_animation));
+  builder.quantization_translation_tolerance = 0.f;
+  builder.quantization_scale_tolerance = -1e-3f;
+  EXPECT_TRUE(!builder(raw_animation));
+  builder.quantization_scale_tolerance = 0.f;
+
+  // Default tolerance quantizes varying components to 16 bits, and constant
+  // ones to none.
+  Animation* reference = builder(raw_animation);
+  ASSERT_TRUE(reference != NULL);
+  EXPECT_LT(reference->scale_values().size(),
+            reference->translation_values().size());
+
+  const float kTolerance = 1e-3f;
+  builder.quantization_translation_tolerance = kTolerance;
+  builder.quantization_scale_tolerance = kTolerance;
+  Animation* animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+
+  // x and y translations take 6 and 10 bits instead of 16, x scales 4 bits.
+  EXPECT_LT(animation->translation_values().size(),
+            reference->translation_values().size() * 6 / 10);
+  EXPECT_LT(animation->scale_values().size(),
+            reference->scale_values().size() * 3 / 10);
+  EXPECT_LT(animation->size(), reference->size());
+
+  // Values are sampled within tolerance, also after serialization.
+  ozz::io::MemoryStream stream;
+  SaveAnimation(*animation, &stream);
+  stream.Seek(0, ozz::io::Stream::kSet);
+  Animation loaded;
+  {
+    ozz::io::IArchive archive(&stream);
+    archive >> loaded;
+  }
+  const Animation* animations[] = {animation, &loaded};
+  for (size_t a = 0; a < OZZ_ARRAY_SIZE(animations); ++a) {
+    ozz::animation::SamplingCache cache(6);
+    ozz::math::SoaTransform output[2];
+    ozz::animation::SamplingJob job;
+    job.animation = animations[a];
+    job.cache = &cache;
+    job.output = output;
+    for (int i = 0; i <= 60; ++i) {
+      job.ratio = i / 60.f;
+      ASSERT_TRUE(job.Run());
+      for (int t = 0; t < 6; ++t) {
+        const RawAnimation::TranslationKey& tkey =
+            raw_animation.tracks[t].translations[i];
+        const RawAnimation::ScaleKey& skey = raw_animation.tracks[t].scales[i];
+        float values[6][4];
+        ozz::math::StorePtrU(output[t / 4].translation.x, values[0]);
+        ozz::math::StorePtrU(output[t / 4].translation.y, values[1]);
+        ozz::math::StorePtrU(output[t / 4].translation.z, values[2]);
+        ozz::math::StorePtrU(output[t / 4].scale.x, values[3]);
+        ozz::math::StorePtrU(output[t / 4].scale.y, values[4]);
+        ozz::math::StorePtrU(output[t / 4].scale.z, values[5]);
+        const float expected[6] = {tkey.value.x, tkey.value.y, tkey.value.z,
+                                   skey.value.x, skey.value.y, skey.value.z};
+        for (int c = 0; c < 6; ++c) {
+          EXPECT_NEAR(values[c][t & 3], expected[c], kTolerance * 1.01f);
+        }
+      }
+    }
+  }
+
+  ozz::memory::default_allocator()->Delete(animation);
+  ozz::memory::default_allocator()->Delete(reference);
+}
+
+TEST(Threads, AnimationBuilder) {
+  RawAnimation raw_animation;
+  BuildLargeAnimation(&raw_animation);
+  ASSERT_TRUE(raw_animation.Validate());
+
+  AnimationBuilder builder;
+  builder.spline = true;
+  builder.seek_interval = .5f;
+  builder.num_threads = 1;
+  Animation* reference = builder(raw_animation);
+  ASSERT_TRUE(reference != NULL);
+  ozz::io::MemoryStream reference_stream;
+  SaveAnimation(*reference, &reference_stream);
+
+  // Output is the same whatever the number of threads.
+  const int num_threads[] = {0, 2, 4, 7, 64};
+  for (size_t n = 0; n < OZZ_ARRAY_SIZE(num_threads); ++n) {
+    builder.num_threads = num_threads[n];
+    Animation* animation = builder(raw_animation);
+    ASSERT_TRUE(animation != NULL);
+    EXPECT_EQ(animation->num_constant_scales(),
+              reference->num_constant_scales());
+    ozz::io::MemoryStream stream;
+    SaveAnimation(*animation, &stream);
+    ExpectSameContent(&stream, &reference_stream);
+    ozz::memory::default_allocator()->Delete(animation);
+  }
+  ozz::memory::default_allocator()->Delete(reference);
+}
+
+TEST(Context, AnimationBuilder) {
+  RawAnimation large;
+  BuildLargeAnimation(&large);
+
+  RawAnimation small;
+  small.duration = 1.f;
+  small.tracks.resize(3);
+  const RawAnimation::TranslationKey first = {0.f,
+                                              ozz::math::Float3(0.f, 0.f, 0.f)};
+  const RawAnimation::TranslationKey last = {1.f,
+                                             ozz::math::Float3(2.f, 4.f, 6.f)};
+  small.tracks[1].translations.push_back(first);
+  small.tracks[1].translations.push_back(last);
+
+  AnimationBuilder builder;
+  builder.num_threads = 4;
+  const RawAnimation* raw_animations[] = {&large, &small, &large, &small};
+  ozz::io::MemoryStream references[OZZ_ARRAY_SIZE(raw_animations)];
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(raw_animations); ++i) {
+    Animation* animation = builder(*raw_animations[i]);
+    ASSERT_TRUE(animation != NULL);
+    SaveAnimation(*animation, &references[i]);
+    ozz::memory::default_allocator()->Delete(animation);
+  }
+
+  // Successive builds sharing a context output the same animations, whatever
+  // the size of the previous one.
+  AnimationBuilderContext context;
+  builder.context = &context;
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(raw_animations); ++i) {
+    Animation* animation = builder(*raw_animations[i]);
+    ASSERT_TRUE(animation != NULL);
+    ozz::io::MemoryStream stream;
+    SaveAnimation(*animation, &stream);
+    ExpectSameContent(&stream, &references[i]);
+    ozz::memory::default_allocator()->Delete(animation);
+  }
+
+  // Invalid animations still fail.
+  RawAnimation invalid;
+  invalid.duration = -1.f;
+  EXPECT_TRUE(builder(invalid) == NULL);
+}
+
+TEST(Rebuild, AnimationBuilder) {
+  RawAnimation large;
+  BuildLargeAnimation(&large);
+
+  RawAnimation small;
+  small.duration = 1.f;
+  small.name = "small";
+  small.tracks.resize(2);
+  const RawAnimation::TranslationKey key = {.5f,
+                                            ozz::math::Float3(1.f, 2.f, 3.f)};
+  small.tracks[1].translations.push_back(key);
+
+  // References are built into new animations.
+  AnimationBuilder builder;
+  const RawAnimation* raw_animations[] = {&large, &small};
+  ozz::io::MemoryStream references[OZZ_ARRAY_SIZE(raw_animations)];
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(raw_animations); ++i) {
+    Animation* animation = builder(*raw_animations[i]);
+    ASSERT_TRUE(animation != NULL);
+    SaveAnimation(*animation, &references[i]);
+    ozz::memory::default_allocator()->Delete(animation);
+  }
+
+  ozz::memory::TrackingAllocator tracking(ozz::memory::default_allocator());
+  AnimationBuilderContext context;
+  builder.context = &context;
+  Animation animation(&tracking);
+  EXPECT_FALSE(builder(large, static_cast<Animation*>(NULL)));
+
+  ASSERT_TRUE(builder(large, &animation));
+  EXPECT_EQ(animation.allocator(), &tracking);
+  EXPECT_EQ(tracking.stats(ozz::memory::kTagAnimation).allocation_count, 1u);
+  const uint32_t uid = animation.uid();
+  {
+    ozz::io::MemoryStream stream;
+    SaveAnimation(animation, &stream);
+    ExpectSameContent(&stream, &references[0]);
+  }
+
+  // A smaller animation reuses animation buffer.
+  ASSERT_TRUE(builder(small, &animation));
+  EXPECT_EQ(tracking.stats(ozz::memory::kTagAnimation).allocation_count, 1u);
+  EXPECT_NE(animation.uid(), uid);
+  EXPECT_STREQ(animation.name(), "small");
+  {
+    ozz::io::MemoryStream stream;
+    SaveAnimation(animation, &stream);
+    ExpectSameContent(&stream, &references[1]);
+  }
+
+  // Failing leaves the animation unchanged.
+  RawAnimation invalid;
+  invalid.duration = -1.f;
+  EXPECT_FALSE(builder(invalid, &animation));
+  EXPECT_EQ(animation.num_tracks(), 2);
+  EXPECT_STREQ(animation.name(), "small");
+
+  // A bigger animation reallocates it.
+  builder.spline = true;
+  ASSERT_TRUE(builder(large, &animation));
+  EXPECT_TRUE(animation.spline());
+  EXPECT_EQ(tracking.stats(ozz::memory::kTagAnimation).allocation_count, 2u);
+  EXPECT_EQ(tracking.stats(ozz::memory::kTagAnimation).live_count, 1u);
+}
+
+#if __cplusplus >= 201103L
+TEST(Move, AnimationBuilder) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 2.f;
+  raw_animation.name = "move";
+  raw_animation.tracks.resize(3);
+
+  AnimationBuilder builder;
+  Animation* built = builder(raw_animation);
+  ASSERT_TRUE(built != NULL);
+  const uint32_t uid = built->uid();
+  const void* translations = built->translations().begin;
+
+  // Move construction transfers the buffer.
+  Animation animation(std::move(*built));
+  EXPECT_EQ(animation.duration(), 2.f);
+  EXPECT_EQ(animation.num_tracks(), 3);
+  EXPECT_STREQ(animation.name(), "move");
+  EXPECT_EQ(animation.uid(), uid);
+  EXPECT_EQ(animation.translations().begin, translations);
+  EXPECT_EQ(animation.allocator(), built->allocator());
+
+  // Moved-from animation is empty.
+  EXPECT_EQ(built->num_tracks(), 0);
+  EXPECT_EQ(built->duration(), 0.f);
+  EXPECT_EQ(built->uid(), 0u);
+  EXPECT_TRUE(built->translations().begin == NULL);
+  ozz::memory::default_allocator()->Delete(built);
+
+  // Move assignment releases previous content, in place.
+  raw_animation.duration = 3.f;
+  Animation* reloaded = builder(raw_animation);
+  ASSERT_TRUE(reloaded != NULL);
+  animation = std::move(*reloaded);
+  EXPECT_EQ(animation.duration(), 3.f);
+  EXPECT_NE(animation.uid(), uid);
+  EXPECT_EQ(reloaded->num_tracks(), 0);
+  ozz::memory::default_allocator()->Delete(reloaded);
+
+  // Animations can live in a contiguous array.
+  ozz::Vector<Animation>::Std animations;
+  for (int i = 0; i < 5; ++i) {
+    Animation* tmp = builder(raw_animation);
+    ASSERT_TRUE(tmp != NULL);
+    animations.push_back(std::move(*tmp));
+    ozz::memory::default_allocator()->Delete(tmp);
+  }
+  for (size_t i = 0; i < animations.size(); ++i) {
+    EXPECT_EQ(animations[i].num_tracks(), 3);
+    EXPECT_EQ(animations[i].duration(), 3.f);
+  }
+}
+#endif  // __cplusplus
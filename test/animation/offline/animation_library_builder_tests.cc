@@ -0,0 +1,169 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#include "ozz/animation/offline/animation_library_builder.h"
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/io/archive.h"
+#include "ozz/base/io/stream.h"
+#include "ozz/base/memory/allocator.h"
+
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/runtime/animation_library.h"
+
+using ozz::animation::AnimationLibrary;
+using ozz::animation::offline::AnimationLibraryBuilder;
+using ozz::animation::offline::RawAnimation;
+
+namespace {
+// Builds a 2 tracks raw animation, whose first track translation moves along x
+// by _offset, and whose second track rotates around y of _angle.
+void BuildClip(const char* _name, float _duration, float _offset,
+               float _angle, RawAnimation* _clip) {
+  _clip->name = _name;
+  _clip->duration = _duration;
+  _clip->tracks.resize(2);
+  const RawAnimation::TranslationKey t0 = {0.f,
+                                           ozz::math::Float3(0.f, 1.f, 0.f)};
+  const RawAnimation::TranslationKey t1 = {
+      _duration, ozz::math::Float3(_offset, 1.f, 0.f)};
+  _clip->tracks[0].translations.push_back(t0);
+  _clip->tracks[0].translations.push_back(t1);
+  const RawAnimation::RotationKey r0 = {
+      _duration * .5f, ozz::math::Quaternion::FromAxisAngle(
+                           ozz::math::Float3::y_axis(), _angle)};
+  _clip->tracks[1].rotations.push_back(r0);
+}
+}  // namespace
+
+TEST(Error, AnimationLibraryBuilder) {
+  AnimationLibraryBuilder builder;
+
+  {  // Building an invalid RawAnimation fails.
+    RawAnimation raw_animation;
+    raw_animation.duration = -1.f;
+    EXPECT_TRUE(builder(ozz::Range<const RawAnimation>(&raw_animation, 1)) ==
+                NULL);
+  }
+
+  {  // Invalid tolerance fails.
+    RawAnimation raw_animation;
+    AnimationLibraryBuilder invalid;
+    invalid.rotation_tolerance = -1.f;
+    EXPECT_TRUE(invalid(ozz::Range<const RawAnimation>(&raw_animation, 1)) ==
+                NULL);
+  }
+
+  {  // Building an empty library succeeds.
+    AnimationLibrary* library = builder(ozz::Range<const RawAnimation>());
+    ASSERT_TRUE(library != NULL);
+    EXPECT_EQ(library->num_clips(), 0);
+    EXPECT_EQ(library->FindClip("any"), -1);
+    ozz::memory::default_allocator()->Delete(library);
+  }
+}
+
+TEST(Deduplicate, AnimationLibraryBuilder) {
+  RawAnimation clips[4];
+  BuildClip("walk", 1.f, 1.f, .5f, &clips[0]);
+  BuildClip("walk_variant", 1.f, 1.0001f, .5f, &clips[1]);  // Near-identical.
+  BuildClip("run", 1.f, 2.f, .5f, &clips[2]);
+  BuildClip("idle", 2.f, 1.f, -.5f, &clips[3]);  // Longer clip.
+
+  AnimationLibraryBuilder builder;
+  AnimationLibrary* library = builder(clips);
+  ASSERT_TRUE(library != NULL);
+  ASSERT_EQ(library->num_clips(), 4);
+  EXPECT_STREQ(library->clip_name(1), "walk_variant");
+  EXPECT_EQ(library->FindClip("run"), 2);
+  EXPECT_EQ(library->FindClip("jump"), -1);
+  EXPECT_FLOAT_EQ(library->clip(3).duration, 2.f);
+  EXPECT_EQ(library->clip(3).num_tracks, 2);
+
+  // Translations: the rest channel (track 1) is shared by all clips, walk
+  // moves are shared by walk variants only. Idle moves at half speed.
+  EXPECT_EQ(library->translations().count(), 4u);
+  EXPECT_EQ(library->translation_keys().count(), 6u);
+  // Rotations: identity (track 0), +.5 and -.5 rotations.
+  EXPECT_EQ(library->rotations().count(), 3u);
+  EXPECT_EQ(library->rotation_keys().count(), 2u);
+  // Scales: all identity.
+  EXPECT_EQ(library->scales().count(), 1u);
+  EXPECT_EQ(library->scale_keys().count(), 0u);
+
+  const ozz::Range<const uint32_t> walk = library->clip_channels(0);
+  const ozz::Range<const uint32_t> variant = library->clip_channels(1);
+  ASSERT_EQ(walk.count(), 6u);
+  for (int i = 0; i < 6; ++i) {
+    EXPECT_EQ(walk[i], variant[i]);
+  }
+  const ozz::Range<const uint32_t> run = library->clip_channels(2);
+  EXPECT_NE(run[0], walk[0]);
+  EXPECT_EQ(run[4], walk[4]);
+
+  // Exact sharing doesn't merge the variant.
+  AnimationLibraryBuilder exact;
+  exact.translation_tolerance = 0.f;
+  AnimationLibrary* exact_library = exact(clips);
+  ASSERT_TRUE(exact_library != NULL);
+  EXPECT_EQ(exact_library->translations().count(), 5u);
+  EXPECT_GT(exact_library->size(), library->size());
+
+  // Archives and reloads the library.
+  ozz::io::MemoryStream stream;
+  {
+    ozz::io::OArchive o(&stream);
+    o << *library;
+  }
+  stream.Seek(0, ozz::io::Stream::kSet);
+  AnimationLibrary loaded;
+  {
+    ozz::io::IArchive i(&stream);
+    ASSERT_TRUE(i.TestTag<AnimationLibrary>());
+    i >> loaded;
+  }
+  ASSERT_EQ(loaded.num_clips(), 4);
+  EXPECT_EQ(loaded.size(), library->size());
+  EXPECT_STREQ(loaded.clip_name(3), "idle");
+  EXPECT_FLOAT_EQ(loaded.clip(3).duration, 2.f);
+  for (size_t i = 0; i < library->translation_keys().count(); ++i) {
+    EXPECT_FLOAT_EQ(loaded.translation_keys()[i].time,
+                    library->translation_keys()[i].time);
+    EXPECT_FLOAT_EQ(loaded.translation_keys()[i].value[0],
+                    library->translation_keys()[i].value[0]);
+  }
+  for (int c = 0; c < 4; ++c) {
+    for (int i = 0; i < 6; ++i) {
+      EXPECT_EQ(loaded.clip_channels(c)[i], library->clip_channels(c)[i]);
+    }
+  }
+
+  ozz::memory::default_allocator()->Delete(exact_library);
+  ozz::memory::default_allocator()->Delete(library);
+}
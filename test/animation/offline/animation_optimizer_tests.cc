@@ -27,12 +27,18 @@
 
 #include "ozz/animation/offline/animation_optimizer.h"
 
+#include <cmath>
+
 #include "gtest/gtest.h"
 
 #include "ozz/base/maths/math_constant.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/transform.h"
+#include "ozz/base/memory/allocator.h"
 
 #include "ozz/animation/offline/animation_builder.h"
 #include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/raw_animation_utils.h"
 
 #include "ozz/animation/offline/raw_skeleton.h"
 #include "ozz/animation/offline/skeleton_builder.h"
@@ -42,6 +48,7 @@ using ozz::animation::Skeleton;
 using ozz::animation::offline::AnimationOptimizer;
 using ozz::animation::offline::RawAnimation;
 using ozz::animation::offline::RawSkeleton;
+using ozz::animation::offline::ResumableAnimationOptimizer;
 using ozz::animation::offline::SkeletonBuilder;
 
 TEST(Error, AnimationOptimizer) {
@@ -546,3 +553,506 @@ TEST(OptimizeHierarchical, AnimationOptimizer) {
 
   ozz::memory::default_allocator()->Delete(skeleton);
 }
+
+TEST(OptimizeSpline, AnimationOptimizer) {
+  // Prepares a skeleton.
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  SkeletonBuilder skeleton_builder;
+  Skeleton* skeleton = skeleton_builder(raw_skeleton);
+  ASSERT_TRUE(skeleton != NULL);
+
+  // A smooth motion, sampled at 30Hz.
+  RawAnimation input;
+  input.duration = 2.f;
+  input.tracks.resize(1);
+  for (int i = 0; i <= 60; ++i) {
+    const float t = i / 30.f;
+    const RawAnimation::TranslationKey tkey = {
+        t, ozz::math::Float3(std::sin(t * 3.f), 0.f, 0.f)};
+    input.tracks[0].translations.push_back(tkey);
+    const RawAnimation::RotationKey rkey = {
+        t, ozz::math::Quaternion::FromAxisAngle(ozz::math::Float3::y_axis(),
+                                                std::cos(t * 2.f))};
+    input.tracks[0].rotations.push_back(rkey);
+  }
+
+  AnimationOptimizer optimizer;
+  RawAnimation linear;
+  ASSERT_TRUE(optimizer(input, *skeleton, &linear));
+
+  optimizer.spline = true;
+  RawAnimation spline;
+  ASSERT_TRUE(optimizer(input, *skeleton, &spline));
+  EXPECT_TRUE(spline.Validate());
+
+  // Splines need less keys to represent the same motion.
+  EXPECT_LT(spline.tracks[0].translations.size(),
+            linear.tracks[0].translations.size() / 2);
+  EXPECT_LT(spline.tracks[0].rotations.size(),
+            linear.tracks[0].rotations.size() / 2);
+
+  // First and last keys are always kept.
+  EXPECT_FLOAT_EQ(spline.tracks[0].translations.front().time, 0.f);
+  EXPECT_FLOAT_EQ(spline.tracks[0].translations.back().time, 2.f);
+
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+TEST(OptimizeStep, AnimationOptimizer) {
+  // Prepares a skeleton.
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  SkeletonBuilder skeleton_builder;
+  Skeleton* skeleton = skeleton_builder(raw_skeleton);
+  ASSERT_TRUE(skeleton != NULL);
+
+  // Linear keys, that can't be interpolated from their neighbors once held.
+  RawAnimation input;
+  input.duration = 1.f;
+  input.tracks.resize(1);
+  input.tracks[0].step = true;
+  const float values[] = {0.f, 1.f, 2.f, 2.f, 2.f};
+  for (int i = 0; i < 5; ++i) {
+    const RawAnimation::TranslationKey key = {
+        i * .25f, ozz::math::Float3(values[i], 0.f, 0.f)};
+    input.tracks[0].translations.push_back(key);
+  }
+
+  AnimationOptimizer optimizer;
+  for (int mode = 0; mode < 3; ++mode) {
+    optimizer.spline = mode == 1;
+    optimizer.model_space = mode == 2;
+    RawAnimation output;
+    ASSERT_TRUE(optimizer(input, *skeleton, &output));
+    EXPECT_TRUE(output.tracks[0].step);
+
+    // Only keys that repeat the held value are removed.
+    const RawAnimation::JointTrack::Translations& translations =
+        output.tracks[0].translations;
+    ASSERT_EQ(translations.size(), 3u) << "mode " << mode;
+    EXPECT_FLOAT_EQ(translations[0].time, 0.f);
+    EXPECT_FLOAT_EQ(translations[1].time, .25f);
+    EXPECT_FLOAT_EQ(translations[2].time, .5f);
+  }
+
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+TEST(OptimizeWindow, AnimationOptimizer) {
+  // Prepares a skeleton.
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  SkeletonBuilder skeleton_builder;
+  Skeleton* skeleton = skeleton_builder(raw_skeleton);
+  ASSERT_TRUE(skeleton != NULL);
+
+  // A long linear translation.
+  RawAnimation input;
+  input.duration = 1.f;
+  input.tracks.resize(1);
+  for (int i = 0; i <= 1000; ++i) {
+    const RawAnimation::TranslationKey key = {
+        i / 1000.f, ozz::math::Float3(i * .1f, 0.f, 0.f)};
+    input.tracks[0].translations.push_back(key);
+  }
+
+  // Without window, linear keys are all interpolated.
+  AnimationOptimizer optimizer;
+  RawAnimation output;
+  ASSERT_TRUE(optimizer(input, *skeleton, &output));
+  EXPECT_EQ(output.tracks[0].translations.size(), 2u);
+
+  // With a window, at most window_size keys are interpolated in a row.
+  optimizer.window_size = 9;
+  ASSERT_TRUE(optimizer(input, *skeleton, &output));
+  ASSERT_EQ(output.tracks[0].translations.size(), 101u);
+  for (size_t i = 0; i < output.tracks[0].translations.size(); ++i) {
+    EXPECT_FLOAT_EQ(output.tracks[0].translations[i].value.x, i * 1.f);
+  }
+
+  // Same for splines and model-space optimization.
+  optimizer.spline = true;
+  ASSERT_TRUE(optimizer(input, *skeleton, &output));
+  EXPECT_EQ(output.tracks[0].translations.size(), 101u);
+  optimizer.spline = false;
+  optimizer.model_space = true;
+  ASSERT_TRUE(optimizer(input, *skeleton, &output));
+  EXPECT_EQ(output.tracks[0].translations.size(), 101u);
+
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+TEST(OptimizeThreads, AnimationOptimizer) {
+  // Prepares a skeleton with a few chains of joints.
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(3);
+  for (size_t i = 0; i < raw_skeleton.roots.size(); ++i) {
+    RawSkeleton::Joint* joint = &raw_skeleton.roots[i];
+    for (int j = 0; j < 4; ++j) {
+      joint->children.resize(1);
+      joint = &joint->children[0];
+    }
+  }
+  SkeletonBuilder skeleton_builder;
+  Skeleton* skeleton = skeleton_builder(raw_skeleton);
+  ASSERT_TRUE(skeleton != NULL);
+  ASSERT_EQ(skeleton->num_joints(), 15);
+
+  // Every track channel is animated with a different noisy motion.
+  RawAnimation input;
+  input.duration = 1.f;
+  input.tracks.resize(skeleton->num_joints());
+  for (size_t i = 0; i < input.tracks.size(); ++i) {
+    const float f = static_cast<float>(i + 1);
+    for (int k = 0; k <= 30; ++k) {
+      const float t = k / 30.f;
+      const RawAnimation::TranslationKey tkey = {
+          t, ozz::math::Float3(std::sin(t * f), std::cos(t * 7.f) * .01f,
+                               (k % 3) * 1e-3f * f)};
+      input.tracks[i].translations.push_back(tkey);
+      const RawAnimation::RotationKey rkey = {
+          t, ozz::math::Quaternion::FromAxisAngle(ozz::math::Float3::x_axis(),
+                                                  std::cos(t * f) * .5f)};
+      input.tracks[i].rotations.push_back(rkey);
+      const RawAnimation::ScaleKey skey = {
+          t, ozz::math::Float3(1.f + (k % 4) * 1e-3f * f)};
+      input.tracks[i].scales.push_back(skey);
+    }
+  }
+
+  // Output is the same whatever the number of threads.
+  AnimationOptimizer optimizer;
+  optimizer.num_threads = 1;
+  RawAnimation reference;
+  ASSERT_TRUE(optimizer(input, *skeleton, &reference));
+
+  const int num_threads[] = {0, 2, 3, 64};
+  for (size_t n = 0; n < OZZ_ARRAY_SIZE(num_threads); ++n) {
+    optimizer.num_threads = num_threads[n];
+    RawAnimation output;
+    ASSERT_TRUE(optimizer(input, *skeleton, &output));
+    ASSERT_EQ(output.num_tracks(), reference.num_tracks());
+    for (int i = 0; i < output.num_tracks(); ++i) {
+      const RawAnimation::JointTrack& track = output.tracks[i];
+      const RawAnimation::JointTrack& expected = reference.tracks[i];
+      ASSERT_EQ(track.translations.size(), expected.translations.size());
+      for (size_t k = 0; k < track.translations.size(); ++k) {
+        EXPECT_EQ(track.translations[k].time, expected.translations[k].time);
+      }
+      ASSERT_EQ(track.rotations.size(), expected.rotations.size());
+      for (size_t k = 0; k < track.rotations.size(); ++k) {
+        EXPECT_EQ(track.rotations[k].time, expected.rotations[k].time);
+      }
+      ASSERT_EQ(track.scales.size(), expected.scales.size());
+      for (size_t k = 0; k < track.scales.size(); ++k) {
+        EXPECT_EQ(track.scales[k].time, expected.scales[k].time);
+      }
+    }
+  }
+
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+namespace {
+// Computes model-space position of _point (in joint local-space) for every
+// joint of _skeleton, from _animation sampled at _time.
+void ComputeModelPoints(const RawAnimation& _animation,
+                        const Skeleton& _skeleton, float _time,
+                        const ozz::math::Float3& _point,
+                        ozz::math::Float3* _points) {
+  ozz::math::Transform locals[8];
+  ASSERT_TRUE(ozz::animation::offline::SampleAnimation(
+      _animation, _time, ozz::Range<ozz::math::Transform>(locals)));
+  ozz::math::Float4x4 models[8];
+  for (int i = 0; i < _skeleton.num_joints(); ++i) {
+    const ozz::math::Float4x4 local = ozz::math::Float4x4::FromAffine(
+        ozz::math::simd_float4::Load3PtrU(&locals[i].translation.x),
+        ozz::math::simd_float4::LoadPtrU(&locals[i].rotation.x),
+        ozz::math::simd_float4::Load3PtrU(&locals[i].scale.x));
+    const int parent = _skeleton.joint_parents()[i];
+    models[i] = parent == Skeleton::kNoParent ? local : models[parent] * local;
+    ozz::math::Store3PtrU(
+        TransformPoint(models[i], ozz::math::simd_float4::Load3PtrU(&_point.x)),
+        &_points[i].x);
+  }
+}
+}  // namespace
+
+TEST(OptimizeModelSpace, AnimationOptimizer) {
+  // Prepares a chain of 4 joints, 1m apart.
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  RawSkeleton::Joint* joint = &raw_skeleton.roots[0];
+  for (int i = 0; i < 3; ++i) {
+    joint->children.resize(1);
+    joint = &joint->children[0];
+  }
+  SkeletonBuilder skeleton_builder;
+  Skeleton* skeleton = skeleton_builder(raw_skeleton);
+  ASSERT_TRUE(skeleton != NULL);
+  ASSERT_EQ(skeleton->num_joints(), 4);
+
+  // Root rotates slowly with some noise, other joints have a linear
+  // translation with noise under tolerance, and the leaf rotates.
+  RawAnimation input;
+  input.duration = 1.f;
+  input.tracks.resize(4);
+  for (int k = 0; k <= 30; ++k) {
+    const float t = k / 30.f;
+    const float noise = (k % 2) * 2e-4f;
+    const RawAnimation::RotationKey root_rotation = {
+        t, ozz::math::Quaternion::FromAxisAngle(ozz::math::Float3::z_axis(),
+                                                std::sin(t * 3.f) * .3f)};
+    input.tracks[0].rotations.push_back(root_rotation);
+    for (int i = 1; i < 4; ++i) {
+      const RawAnimation::TranslationKey translation = {
+          t, ozz::math::Float3(1.f + t * .1f + noise, 0.f, 0.f)};
+      input.tracks[i].translations.push_back(translation);
+    }
+    const RawAnimation::RotationKey leaf_rotation = {
+        t, ozz::math::Quaternion::FromAxisAngle(ozz::math::Float3::x_axis(),
+                                                t * 2.f)};
+    input.tracks[3].rotations.push_back(leaf_rotation);
+  }
+  ASSERT_TRUE(input.Validate());
+
+  AnimationOptimizer optimizer;
+  optimizer.model_space = true;
+  RawAnimation output;
+  ASSERT_TRUE(optimizer(input, *skeleton, &output));
+  EXPECT_TRUE(output.Validate());
+  EXPECT_EQ(output.num_tracks(), 4);
+
+  // Noisy linear translations are reduced to their bounds.
+  for (int i = 1; i < 4; ++i) {
+    EXPECT_LE(output.tracks[i].translations.size(), 4u);
+  }
+
+  // Root rotation is amplified along the chain, so it keeps more keys.
+  EXPECT_GT(output.tracks[0].rotations.size(), 2u);
+  EXPECT_LT(output.tracks[0].rotations.size(), 31u);
+
+  // Leaf rotation is only detected by skinning points.
+  EXPECT_GT(output.tracks[3].rotations.size(), 2u);
+
+  // Model-space error stays within tolerance for all joints and points.
+  const ozz::math::Float3 points[] = {
+      ozz::math::Float3::zero(),
+      ozz::math::Float3(optimizer.skinning_distance, 0.f, 0.f),
+      ozz::math::Float3(0.f, optimizer.skinning_distance, 0.f),
+      ozz::math::Float3(0.f, 0.f, optimizer.skinning_distance)};
+  for (int k = 0; k <= 30; ++k) {
+    const float t = k / 30.f;
+    for (size_t p = 0; p < OZZ_ARRAY_SIZE(points); ++p) {
+      ozz::math::Float3 expected[4];
+      ComputeModelPoints(input, *skeleton, t, points[p], expected);
+      ozz::math::Float3 actual[4];
+      ComputeModelPoints(output, *skeleton, t, points[p], actual);
+      for (int i = 0; i < 4; ++i) {
+        EXPECT_LE(Length(actual[i] - expected[i]),
+                  optimizer.model_space_tolerance * 1.01f);
+      }
+    }
+  }
+
+  // Without skinning points, leaf rotation isn't measured.
+  optimizer.skinning_distance = 0.f;
+  RawAnimation joints_only;
+  ASSERT_TRUE(optimizer(input, *skeleton, &joints_only));
+  EXPECT_EQ(joints_only.tracks[3].rotations.size(), 1u);
+
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+namespace {
+// Expects _a and _b keys to be the same.
+void ExpectSameKeys(const RawAnimation& _a, const RawAnimation& _b) {
+  ASSERT_EQ(_a.num_tracks(), _b.num_tracks());
+  EXPECT_EQ(_a.duration, _b.duration);
+  for (int i = 0; i < _a.num_tracks(); ++i) {
+    const RawAnimation::JointTrack& a = _a.tracks[i];
+    const RawAnimation::JointTrack& b = _b.tracks[i];
+    ASSERT_EQ(a.translations.size(), b.translations.size());
+    for (size_t k = 0; k < a.translations.size(); ++k) {
+      EXPECT_EQ(a.translations[k].time, b.translations[k].time);
+    }
+    ASSERT_EQ(a.rotations.size(), b.rotations.size());
+    for (size_t k = 0; k < a.rotations.size(); ++k) {
+      EXPECT_EQ(a.rotations[k].time, b.rotations[k].time);
+    }
+    ASSERT_EQ(a.scales.size(), b.scales.size());
+    for (size_t k = 0; k < a.scales.size(); ++k) {
+      EXPECT_EQ(a.scales[k].time, b.scales[k].time);
+    }
+  }
+}
+}  // namespace
+
+TEST(Resumable, AnimationOptimizer) {
+  // Prepares a chain of 4 joints.
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  RawSkeleton::Joint* joint = &raw_skeleton.roots[0];
+  for (int i = 0; i < 3; ++i) {
+    joint->children.resize(1);
+    joint = &joint->children[0];
+  }
+  SkeletonBuilder skeleton_builder;
+  Skeleton* skeleton = skeleton_builder(raw_skeleton);
+  ASSERT_TRUE(skeleton != NULL);
+
+  RawAnimation input;
+  input.duration = 1.f;
+  input.tracks.resize(4);
+  for (int i = 0; i < 4; ++i) {
+    const float f = static_cast<float>(i + 1);
+    for (int k = 0; k <= 30; ++k) {
+      const float t = k / 30.f;
+      const RawAnimation::TranslationKey tkey = {
+          t, ozz::math::Float3(1.f + (k % 2) * 1e-4f, std::sin(t * f), 0.f)};
+      input.tracks[i].translations.push_back(tkey);
+      const RawAnimation::RotationKey rkey = {
+          t, ozz::math::Quaternion::FromAxisAngle(ozz::math::Float3::z_axis(),
+                                                  std::cos(t * f) * .3f)};
+      input.tracks[i].rotations.push_back(rkey);
+    }
+  }
+
+  ResumableAnimationOptimizer resumable;
+  EXPECT_TRUE(resumable.done());
+  EXPECT_EQ(resumable.num_remaining_channels(), 0);
+  EXPECT_FALSE(resumable.Resume(1));
+
+  AnimationOptimizer optimizer;
+  RawAnimation output;
+
+  {  // Invalid inputs.
+    EXPECT_FALSE(resumable.Start(optimizer, input, *skeleton, NULL));
+    RawAnimation invalid;
+    invalid.duration = -1.f;
+    EXPECT_FALSE(resumable.Start(optimizer, invalid, *skeleton, &output));
+    EXPECT_TRUE(resumable.done());
+  }
+
+  // Output is the same as a single optimization, in both modes.
+  for (int m = 0; m < 2; ++m) {
+    optimizer.model_space = m == 1;
+    RawAnimation expected;
+    ASSERT_TRUE(optimizer(input, *skeleton, &expected));
+
+    ASSERT_TRUE(resumable.Start(optimizer, input, *skeleton, &output));
+    EXPECT_FALSE(resumable.done());
+    EXPECT_EQ(resumable.num_remaining_channels(), 12);
+    EXPECT_FALSE(resumable.Resume(0));
+
+    int slices = 0;
+    while (!resumable.done()) {
+      ASSERT_TRUE(resumable.Resume(5));
+      ++slices;
+    }
+    EXPECT_EQ(slices, 3);
+    EXPECT_EQ(resumable.num_remaining_channels(), 0);
+    EXPECT_FALSE(resumable.Resume(1));
+    ExpectSameKeys(output, expected);
+  }
+
+  // Restarting abandons the optimization in progress.
+  optimizer.model_space = false;
+  ASSERT_TRUE(resumable.Start(optimizer, input, *skeleton, &output));
+  ASSERT_TRUE(resumable.Resume(1));
+  ASSERT_TRUE(resumable.Start(optimizer, input, *skeleton, &output));
+  EXPECT_EQ(resumable.num_remaining_channels(), 12);
+
+  // Destroying an optimization in progress is fine too.
+
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+TEST(JointsSettingOverride, AnimationOptimizer) {
+  // Prepares a skeleton with a root and a child.
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  raw_skeleton.roots[0].children.resize(1);
+  SkeletonBuilder skeleton_builder;
+  Skeleton* skeleton = skeleton_builder(raw_skeleton);
+  ASSERT_TRUE(skeleton != NULL);
+
+  // Root rotation and child translation middle keys are within default
+  // tolerances.
+  RawAnimation input;
+  input.duration = 1.f;
+  input.tracks.resize(2);
+  const float angle = .05f * ozz::math::kPi / 180.f;
+  const RawAnimation::RotationKey rotations[] = {
+      {0.f, ozz::math::Quaternion::identity()},
+      {.5f, ozz::math::Quaternion::FromEuler(angle, 0.f, 0.f)},
+      {1.f, ozz::math::Quaternion::identity()}};
+  input.tracks[0].rotations.assign(rotations, rotations + 3);
+  const RawAnimation::TranslationKey translations[] = {
+      {0.f, ozz::math::Float3(1.f, 0.f, 0.f)},
+      {.5f, ozz::math::Float3(1.0005f, 0.f, 0.f)},
+      {1.f, ozz::math::Float3(1.f, 0.f, 0.f)}};
+  input.tracks[1].translations.assign(translations, translations + 3);
+  ASSERT_TRUE(input.Validate());
+
+  AnimationOptimizer optimizer;
+  RawAnimation output;
+
+  {  // Global tolerances.
+    ASSERT_TRUE(optimizer(input, *skeleton, &output));
+    EXPECT_LT(output.tracks[0].rotations.size(), 3u);
+    EXPECT_LT(output.tracks[1].translations.size(), 3u);
+  }
+
+  {  // Child tight translation tolerance only affects the child.
+    AnimationOptimizer::JointSetting setting;
+    setting.translation_tolerance = 1e-4f;
+    optimizer.joints_setting_override[1] = setting;
+    ASSERT_TRUE(optimizer(input, *skeleton, &output));
+    EXPECT_LT(output.tracks[0].rotations.size(), 3u);
+    EXPECT_EQ(output.tracks[1].translations.size(), 3u);
+  }
+
+  {  // Child tight hierarchical tolerance applies to its parent.
+    optimizer.joints_setting_override[1].hierarchical_tolerance = 1e-4f;
+    ASSERT_TRUE(optimizer(input, *skeleton, &output));
+    EXPECT_EQ(output.tracks[0].rotations.size(), 3u);
+    EXPECT_EQ(output.tracks[1].translations.size(), 3u);
+  }
+
+  {  // Root loose tolerances doesn't loosen child hierarchy.
+    AnimationOptimizer::JointSetting setting;
+    setting.rotation_tolerance = 1.f;
+    setting.hierarchical_tolerance = 1.f;
+    optimizer.joints_setting_override[0] = setting;
+    ASSERT_TRUE(optimizer(input, *skeleton, &output));
+    EXPECT_EQ(output.tracks[0].rotations.size(), 3u);
+  }
+
+  {  // Model-space tolerance of a child applies to its parent keys.
+    optimizer.joints_setting_override.clear();
+    optimizer.model_space = true;
+    optimizer.skinning_distance = 0.f;
+    ASSERT_TRUE(optimizer(input, *skeleton, &output));
+    EXPECT_LT(output.tracks[0].rotations.size(), 3u);
+
+    AnimationOptimizer::JointSetting setting;
+    setting.model_space_tolerance = 1e-4f;
+    optimizer.joints_setting_override[1] = setting;
+    ASSERT_TRUE(optimizer(input, *skeleton, &output));
+    EXPECT_EQ(output.tracks[0].rotations.size(), 3u);
+    EXPECT_EQ(output.tracks[1].translations.size(), 3u);
+  }
+
+  {  // Invalid joint index.
+    optimizer.joints_setting_override[2] = AnimationOptimizer::JointSetting();
+    EXPECT_FALSE(optimizer(input, *skeleton, &output));
+    EXPECT_EQ(output.num_tracks(), 0);
+    optimizer.joints_setting_override.clear();
+    optimizer.joints_setting_override[-1] = AnimationOptimizer::JointSetting();
+    EXPECT_FALSE(optimizer(input, *skeleton, &output));
+  }
+
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
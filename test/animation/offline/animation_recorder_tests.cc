@@ -0,0 +1,159 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#include "ozz/animation/offline/animation_recorder.h"
+
+#include <cmath>
+
+#include "gtest/gtest.h"
+
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/sampling_job.h"
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/allocator.h"
+
+using ozz::animation::Animation;
+using ozz::animation::SamplingCache;
+using ozz::animation::SamplingJob;
+using ozz::animation::offline::AnimationRecorder;
+
+namespace {
+// Builds a 5 tracks pose at time _t. Track 0 moves linearly, track 1 along a
+// sine, track 2 rotates around y at constant speed, and others don't move.
+void BuildPose(float _t, ozz::math::SoaTransform _pose[2]) {
+  const float half_angle = _t * .5f;
+  for (int i = 0; i < 2; ++i) {
+    _pose[i] = ozz::math::SoaTransform::identity();
+  }
+  _pose[0].translation.x =
+      ozz::math::simd_float4::Load(_t, std::sin(_t * 6.f), 0.f, 0.f);
+  _pose[0].rotation.y = ozz::math::simd_float4::Load(
+      0.f, 0.f, std::sin(half_angle), 0.f);
+  _pose[0].rotation.w = ozz::math::simd_float4::Load(
+      1.f, 1.f, std::cos(half_angle), 1.f);
+}
+}  // namespace
+
+TEST(Error, AnimationRecorder) {
+  AnimationRecorder recorder;
+  ozz::math::SoaTransform pose[2];
+  BuildPose(0.f, pose);
+
+  // Not begun.
+  EXPECT_FALSE(recorder.Record(pose, 0.f));
+  EXPECT_TRUE(recorder.Finalize() == NULL);
+
+  // Invalid number of tracks.
+  EXPECT_FALSE(recorder.Begin(0));
+  EXPECT_FALSE(recorder.Begin(ozz::animation::Skeleton::kMaxJoints + 1));
+
+  ASSERT_TRUE(recorder.Begin(5));
+  EXPECT_EQ(recorder.num_tracks(), 5);
+  EXPECT_TRUE(recorder.Finalize() == NULL);
+
+  // Pose too small.
+  EXPECT_FALSE(
+      recorder.Record(ozz::Range<const ozz::math::SoaTransform>(pose, 1), 0.f));
+
+  // Times must increase.
+  EXPECT_TRUE(recorder.Record(pose, 1.f));
+  EXPECT_FALSE(recorder.Record(pose, 1.f));
+  EXPECT_FALSE(recorder.Record(pose, .5f));
+  EXPECT_EQ(recorder.num_frames(), 1);
+
+  // A single frame animation.
+  Animation* animation = recorder.Finalize("single");
+  ASSERT_TRUE(animation != NULL);
+  EXPECT_STREQ(animation->name(), "single");
+  EXPECT_EQ(animation->num_tracks(), 5);
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+TEST(Record, AnimationRecorder) {
+  AnimationRecorder recorder;
+  ASSERT_TRUE(recorder.Begin(5));
+
+  // Records 2 seconds at 60fps, starting at an arbitrary time.
+  const int kNumFrames = 121;
+  const float kBegin = 10.f;
+  ozz::math::SoaTransform pose[2];
+  for (int f = 0; f < kNumFrames; ++f) {
+    const float t = f / 60.f;
+    BuildPose(t, pose);
+    ASSERT_TRUE(recorder.Record(pose, kBegin + t));
+  }
+  EXPECT_EQ(recorder.num_frames(), kNumFrames);
+
+  // Keys are reduced: far less than a key per frame and channel, but more than
+  // a key per channel as track 1 follows a sine and max_key_interval is
+  // reached by static tracks.
+  const int num_keys = recorder.num_keys();
+  EXPECT_LT(num_keys, 5 * 3 * kNumFrames / 4);
+  EXPECT_GT(num_keys, 5 * 3);
+
+  Animation* animation = recorder.Finalize();
+  ASSERT_TRUE(animation != NULL);
+  EXPECT_FLOAT_EQ(animation->duration(), (kNumFrames - 1) / 60.f);
+
+  // Sampling the animation at recorded frames gives back recorded poses,
+  // within tolerances.
+  SamplingCache cache(5);
+  ozz::math::SoaTransform output[2];
+  SamplingJob job;
+  job.animation = animation;
+  job.cache = &cache;
+  job.output = output;
+  for (int f = 0; f < kNumFrames; ++f) {
+    const float t = f / 60.f;
+    BuildPose(t, pose);
+    job.ratio = t / animation->duration();
+    ASSERT_TRUE(job.Run());
+    for (int i = 0; i < 2; ++i) {
+      ozz::math::SimdFloat4 diff[3] = {
+          output[i].translation.x - pose[i].translation.x,
+          output[i].translation.y - pose[i].translation.y,
+          output[i].rotation.y - pose[i].rotation.y};
+      for (int c = 0; c < 3; ++c) {
+        float values[4];
+        ozz::math::StorePtrU(diff[c], values);
+        for (int k = 0; k < 4; ++k) {
+          EXPECT_NEAR(values[k], 0.f, 2e-3f) << "frame " << f;
+        }
+      }
+    }
+  }
+  ozz::memory::default_allocator()->Delete(animation);
+
+  // Recording can be restarted.
+  ASSERT_TRUE(recorder.Begin(1));
+  EXPECT_EQ(recorder.num_frames(), 0);
+  EXPECT_EQ(recorder.num_keys(), 0);
+}
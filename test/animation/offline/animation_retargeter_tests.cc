@@ -0,0 +1,237 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/offline/animation_retargeter.h"
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/math_constant.h"
+#include "ozz/base/maths/transform.h"
+#include "ozz/base/memory/allocator.h"
+
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/raw_skeleton.h"
+#include "ozz/animation/offline/skeleton_builder.h"
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/animation/runtime/skeleton_utils.h"
+
+using ozz::animation::Skeleton;
+using ozz::animation::offline::AnimationRetargeter;
+using ozz::animation::offline::RawAnimation;
+using ozz::animation::offline::RawSkeleton;
+using ozz::animation::offline::SkeletonBuilder;
+
+namespace {
+// Builds a root / hip / knee chain skeleton, whose hip and knee translations
+// are scaled by _scale and knee bind rotation is _knee_rotation. An extra
+// joint is appended to the knee if _extra is true.
+Skeleton* BuildLegSkeleton(float _scale,
+                           const ozz::math::Quaternion& _knee_rotation,
+                           bool _extra) {
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  RawSkeleton::Joint& root = raw_skeleton.roots[0];
+  root.name = "root";
+  root.transform = ozz::math::Transform::identity();
+  root.children.resize(1);
+  RawSkeleton::Joint& hip = root.children[0];
+  hip.name = "hip";
+  hip.transform = ozz::math::Transform::identity();
+  hip.transform.translation = ozz::math::Float3(0.f, _scale, 0.f);
+  hip.children.resize(1);
+  RawSkeleton::Joint& knee = hip.children[0];
+  knee.name = "knee";
+  knee.transform = ozz::math::Transform::identity();
+  knee.transform.translation = ozz::math::Float3(0.f, -.5f * _scale, 0.f);
+  knee.transform.rotation = _knee_rotation;
+  if (_extra) {
+    knee.children.resize(1);
+    knee.children[0].name = "extra";
+    knee.children[0].transform = ozz::math::Transform::identity();
+    knee.children[0].transform.translation = ozz::math::Float3(0.f, 0.f, 1.f);
+  }
+  return SkeletonBuilder()(raw_skeleton);
+}
+}  // namespace
+
+TEST(Error, AnimationRetargeter) {
+  Skeleton* skeleton =
+      BuildLegSkeleton(1.f, ozz::math::Quaternion::identity(), false);
+  ASSERT_TRUE(skeleton != NULL);
+  const int map[] = {0, 1, 2};
+
+  AnimationRetargeter retargeter;
+  RawAnimation input;
+  input.tracks.resize(3);
+  ASSERT_TRUE(input.Validate());
+
+  {  // NULL output.
+    EXPECT_FALSE(retargeter(input, *skeleton, *skeleton, map, NULL));
+  }
+
+  {  // Invalid input animation.
+    RawAnimation invalid = input;
+    invalid.duration = -1.f;
+    RawAnimation output;
+    output.tracks.resize(1);
+    EXPECT_FALSE(retargeter(invalid, *skeleton, *skeleton, map, &output));
+    EXPECT_EQ(output.num_tracks(), 0);
+  }
+
+  {  // Input doesn't match source skeleton.
+    RawAnimation mismatch = input;
+    mismatch.tracks.resize(2);
+    RawAnimation output;
+    output.tracks.resize(1);
+    EXPECT_FALSE(retargeter(mismatch, *skeleton, *skeleton, map, &output));
+    EXPECT_EQ(output.num_tracks(), 0);
+  }
+
+  {  // Joint map is too small.
+    RawAnimation output;
+    EXPECT_FALSE(retargeter(input, *skeleton, *skeleton,
+                            ozz::Range<const int>(map, 2), &output));
+    EXPECT_EQ(output.num_tracks(), 0);
+  }
+
+  {  // Joint map has invalid indices.
+    const int invalid_map[] = {0, 3, -1};
+    RawAnimation output;
+    EXPECT_FALSE(retargeter(input, *skeleton, *skeleton, invalid_map, &output));
+    const int negative_map[] = {0, -2, 1};
+    EXPECT_FALSE(
+        retargeter(input, *skeleton, *skeleton, negative_map, &output));
+  }
+
+  {  // Valid.
+    const int partial_map[] = {0, -1, 1};
+    RawAnimation output;
+    EXPECT_TRUE(retargeter(input, *skeleton, *skeleton, partial_map, &output));
+    EXPECT_EQ(output.num_tracks(), 3);
+  }
+
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+TEST(Retarget, AnimationRetargeter) {
+  const ozz::math::Quaternion source_knee =
+      ozz::math::Quaternion::FromAxisAngle(ozz::math::Float3::x_axis(),
+                                           ozz::math::kPi_4);
+  const ozz::math::Quaternion target_knee =
+      ozz::math::Quaternion::FromAxisAngle(ozz::math::Float3::z_axis(),
+                                           ozz::math::kPi_2);
+  Skeleton* source = BuildLegSkeleton(1.f, source_knee, false);
+  ASSERT_TRUE(source != NULL);
+  Skeleton* target = BuildLegSkeleton(2.f, target_knee, true);
+  ASSERT_TRUE(target != NULL);
+
+  int map[4];
+  EXPECT_EQ(ozz::animation::BuildJointRemap(*source, *target, map), 3);
+
+  // Root moves forward, hip goes up and knee bends.
+  const ozz::math::Quaternion bend = ozz::math::Quaternion::FromAxisAngle(
+      ozz::math::Float3::x_axis(), ozz::math::kPi_2);
+  RawAnimation input;
+  input.duration = 2.f;
+  input.name = "walk";
+  input.sync_markers.push_back(.5f);
+  input.tracks.resize(3);
+  const RawAnimation::TranslationKey root_keys[] = {
+      {0.f, ozz::math::Float3::zero()}, {2.f, ozz::math::Float3(1.f, 0, 0)}};
+  input.tracks[0].translations.assign(root_keys, root_keys + 2);
+  const RawAnimation::TranslationKey hip_keys[] = {
+      {0.f, ozz::math::Float3(0.f, 1.f, 0.f)},
+      {1.f, ozz::math::Float3(0.f, 1.5f, 0.f)}};
+  input.tracks[1].translations.assign(hip_keys, hip_keys + 2);
+  const RawAnimation::RotationKey knee_keys[] = {{0.f, source_knee},
+                                                 {1.f, source_knee * bend}};
+  input.tracks[2].rotations.assign(knee_keys, knee_keys + 2);
+  const RawAnimation::ScaleKey knee_scales[] = {
+      {.5f, ozz::math::Float3(2.f, 1.f, 1.f)}};
+  input.tracks[2].scales.assign(knee_scales, knee_scales + 1);
+  ASSERT_TRUE(input.Validate());
+
+  AnimationRetargeter retargeter;
+  RawAnimation output;
+  ASSERT_TRUE(retargeter(input, *source, *target, map, &output));
+  EXPECT_FLOAT_EQ(output.duration, 2.f);
+  EXPECT_STREQ(output.name.c_str(), "walk");
+  ASSERT_EQ(output.sync_markers.size(), 1u);
+  ASSERT_EQ(output.num_tracks(), 4);
+
+  // Root bind translation is 0, so the whole skeleton ratio is used.
+  const RawAnimation::JointTrack& root = output.tracks[0];
+  ASSERT_EQ(root.translations.size(), 2u);
+  EXPECT_FLOAT3_EQ(root.translations[0].value, 0.f, 0.f, 0.f);
+  EXPECT_FLOAT_EQ(root.translations[1].time, 2.f);
+  EXPECT_FLOAT3_EQ(root.translations[1].value, 2.f, 0.f, 0.f);
+
+  // Hip motion is scaled from its bind pose.
+  const RawAnimation::JointTrack& hip = output.tracks[1];
+  ASSERT_EQ(hip.translations.size(), 2u);
+  EXPECT_FLOAT3_EQ(hip.translations[0].value, 0.f, 2.f, 0.f);
+  EXPECT_FLOAT3_EQ(hip.translations[1].value, 0.f, 3.f, 0.f);
+
+  // Tracks without key are retargeted from identity, which is what they're
+  // sampled as.
+  ASSERT_EQ(hip.rotations.size(), 1u);
+  EXPECT_QUATERNION_EQ(hip.rotations[0].value, 0.f, 0.f, 0.f, 1.f);
+  const RawAnimation::JointTrack& knee = output.tracks[2];
+  ASSERT_EQ(knee.translations.size(), 1u);
+  EXPECT_FLOAT3_EQ(knee.translations[0].value, 0.f, 0.f, 0.f);
+
+  // Knee rotation is applied relatively to target bind pose.
+  ASSERT_EQ(knee.rotations.size(), 2u);
+  const ozz::math::Quaternion knee0 = target_knee;
+  EXPECT_QUATERNION_EQ(knee.rotations[0].value, knee0.x, knee0.y, knee0.z,
+                       knee0.w);
+  const ozz::math::Quaternion knee1 = target_knee * bend;
+  EXPECT_QUATERNION_EQ(knee.rotations[1].value, knee1.x, knee1.y, knee1.z,
+                       knee1.w);
+  ASSERT_EQ(knee.scales.size(), 1u);
+  EXPECT_FLOAT_EQ(knee.scales[0].time, .5f);
+  EXPECT_FLOAT3_EQ(knee.scales[0].value, 2.f, 1.f, 1.f);
+
+  // Unmapped joint is set to its bind pose.
+  const RawAnimation::JointTrack& extra = output.tracks[3];
+  ASSERT_EQ(extra.translations.size(), 1u);
+  EXPECT_FLOAT3_EQ(extra.translations[0].value, 0.f, 0.f, 1.f);
+  ASSERT_EQ(extra.rotations.size(), 1u);
+  EXPECT_QUATERNION_EQ(extra.rotations[0].value, 0.f, 0.f, 0.f, 1.f);
+  ASSERT_EQ(extra.scales.size(), 1u);
+  EXPECT_FLOAT3_EQ(extra.scales[0].value, 1.f, 1.f, 1.f);
+
+  // Without translation scaling, motion is copied.
+  retargeter.scale_translations = false;
+  ASSERT_TRUE(retargeter(input, *source, *target, map, &output));
+  EXPECT_FLOAT3_EQ(output.tracks[0].translations[1].value, 1.f, 0.f, 0.f);
+  EXPECT_FLOAT3_EQ(output.tracks[1].translations[1].value, 0.f, 2.5f, 0.f);
+
+  ozz::memory::default_allocator()->Delete(source);
+  ozz::memory::default_allocator()->Delete(target);
+}
@@ -0,0 +1,252 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#include "ozz/animation/offline/async_pipeline.h"
+
+#include <cmath>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/io/archive.h"
+#include "ozz/base/io/stream.h"
+#include "ozz/base/memory/allocator.h"
+
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/raw_skeleton.h"
+#include "ozz/animation/offline/skeleton_builder.h"
+
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/skeleton.h"
+
+using ozz::animation::Animation;
+using ozz::animation::Skeleton;
+using ozz::animation::offline::AnimationBuilder;
+using ozz::animation::offline::AnimationOptimizer;
+using ozz::animation::offline::AsyncBuild;
+using ozz::animation::offline::AsyncExecutor;
+using ozz::animation::offline::AsyncLoad;
+using ozz::animation::offline::AsyncOptimize;
+using ozz::animation::offline::AsyncTask;
+using ozz::animation::offline::RawAnimation;
+using ozz::animation::offline::RawSkeleton;
+using ozz::animation::offline::SkeletonBuilder;
+using ozz::animation::offline::SyncWait;
+using ozz::animation::offline::WhenAll;
+
+namespace {
+// Resumes coroutines from its own threads.
+class ThreadExecutor : public AsyncExecutor {
+ public:
+  explicit ThreadExecutor(int _num_threads) : exit_(false), num_posts_(0) {
+    for (int i = 0; i < _num_threads; ++i) {
+      threads_.emplace_back([this] { Work(); });
+    }
+  }
+  virtual ~ThreadExecutor() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      exit_ = true;
+    }
+    condition_.notify_all();
+    for (std::thread& thread : threads_) {
+      thread.join();
+    }
+  }
+  virtual void Post(std::coroutine_handle<> _coroutine) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      queue_.push_back(_coroutine);
+      ++num_posts_;
+    }
+    condition_.notify_one();
+  }
+  int num_posts() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return num_posts_;
+  }
+
+ private:
+  void Work() {
+    for (;;) {
+      std::coroutine_handle<> coroutine;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        condition_.wait(lock, [this] { return exit_ || !queue_.empty(); });
+        if (queue_.empty()) {
+          return;
+        }
+        coroutine = queue_.front();
+        queue_.pop_front();
+      }
+      coroutine.resume();
+    }
+  }
+
+  std::mutex mutex_;
+  std::condition_variable condition_;
+  std::deque<std::coroutine_handle<> > queue_;
+  std::vector<std::thread> threads_;
+  bool exit_;
+  int num_posts_;
+};
+
+// Builds a 2 joints skeleton, and saves an animation for it to _filename.
+Skeleton* Prepare(const char* _filename) {
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  raw_skeleton.roots[0].children.resize(1);
+  SkeletonBuilder skeleton_builder;
+  Skeleton* skeleton = skeleton_builder(raw_skeleton);
+
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(2);
+  for (int k = 0; k <= 20; ++k) {
+    const float t = k / 20.f;
+    const RawAnimation::TranslationKey key = {
+        t, ozz::math::Float3(t, std::sin(t * 3.f), 0.f)};
+    raw_animation.tracks[1].translations.push_back(key);
+  }
+  ozz::io::File file(_filename, "wb");
+  ozz::io::OArchive archive(&file);
+  archive << raw_animation;
+  return skeleton;
+}
+
+// Loads, optimizes and builds _filename animation, with I/O and CPU stages
+// run on their own executor.
+AsyncTask<Animation*> Process(AsyncExecutor* _io, AsyncExecutor* _cpu,
+                              const char* _filename,
+                              const Skeleton* _skeleton) {
+  RawAnimation raw_animation;
+  if (!co_await AsyncLoad(_io, _filename, &raw_animation)) {
+    co_return NULL;
+  }
+  RawAnimation optimized;
+  const AnimationOptimizer optimizer;
+  if (!co_await AsyncOptimize(_cpu, optimizer, raw_animation, *_skeleton,
+                              &optimized)) {
+    co_return NULL;
+  }
+  const AnimationBuilder builder;
+  co_return co_await AsyncBuild(_cpu, builder, optimized);
+}
+}  // namespace
+
+TEST(Inline, AsyncPipeline) {
+  Skeleton* skeleton = Prepare("async_inline.ozz");
+  ASSERT_TRUE(skeleton != NULL);
+
+  AsyncTask<Animation*> task =
+      Process(NULL, NULL, "async_inline.ozz", skeleton);
+  EXPECT_TRUE(task.valid());
+  EXPECT_FALSE(task.done());  // Tasks are lazy.
+
+  Animation* animation = SyncWait(task);
+  EXPECT_TRUE(task.done());
+  ASSERT_TRUE(animation != NULL);
+  EXPECT_EQ(animation->num_tracks(), 2);
+  EXPECT_FLOAT_EQ(animation->duration(), 1.f);
+
+  ozz::memory::default_allocator()->Delete(animation);
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+TEST(LoadFailure, AsyncPipeline) {
+  Skeleton* skeleton = Prepare("async_failure.ozz");
+  ASSERT_TRUE(skeleton != NULL);
+
+  {  // Missing file.
+    AsyncTask<Animation*> task =
+        Process(NULL, NULL, "async_missing.ozz", skeleton);
+    EXPECT_TRUE(SyncWait(task) == NULL);
+  }
+
+  {  // Wrong type.
+    RawSkeleton raw_skeleton;
+    AsyncTask<bool> task = AsyncLoad(NULL, "async_failure.ozz", &raw_skeleton);
+    EXPECT_FALSE(SyncWait(task));
+  }
+
+  {  // Right type.
+    RawAnimation raw_animation;
+    AsyncTask<bool> task =
+        AsyncLoad(NULL, "async_failure.ozz", &raw_animation);
+    EXPECT_TRUE(SyncWait(task));
+    EXPECT_EQ(raw_animation.num_tracks(), 2);
+  }
+
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+TEST(WhenAll, AsyncPipeline) {
+  Skeleton* skeleton = Prepare("async_all.ozz");
+  ASSERT_TRUE(skeleton != NULL);
+
+  {  // Empty batch.
+    AsyncTask<bool>* none = NULL;
+    AsyncTask<> all = WhenAll(ozz::Range<AsyncTask<bool> >(none, none));
+    SyncWait(all);
+    EXPECT_TRUE(all.done());
+  }
+
+  ThreadExecutor io(2);
+  ThreadExecutor cpu(4);
+  const int kNumAssets = 64;
+  AsyncTask<Animation*> tasks[kNumAssets];
+  for (int i = 0; i < kNumAssets; ++i) {
+    tasks[i] = Process(&io, &cpu, i % 8 ? "async_all.ozz" : "async_missing.ozz",
+                       skeleton);
+  }
+  AsyncTask<> all = WhenAll(ozz::Range<AsyncTask<Animation*> >(tasks));
+  SyncWait(all);
+
+  for (int i = 0; i < kNumAssets; ++i) {
+    ASSERT_TRUE(tasks[i].done());
+    Animation* animation = tasks[i].result();
+    if (i % 8) {
+      ASSERT_TRUE(animation != NULL);
+      EXPECT_EQ(animation->num_tracks(), 2);
+      ozz::memory::default_allocator()->Delete(animation);
+    } else {
+      EXPECT_TRUE(animation == NULL);
+    }
+  }
+
+  // Every asset was loaded on io executor, and successfully loaded ones were
+  // optimized and built on cpu executor.
+  EXPECT_EQ(io.num_posts(), kNumAssets);
+  EXPECT_EQ(cpu.num_posts(), kNumAssets / 8 * 7 * 2);
+
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
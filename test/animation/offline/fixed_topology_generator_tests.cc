@@ -0,0 +1,115 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#include "ozz/animation/offline/fixed_topology_generator.h"
+
+#include <cstdio>
+
+#include "gtest/gtest.h"
+
+#include "ozz/animation/offline/raw_skeleton.h"
+#include "ozz/animation/offline/skeleton_builder.h"
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/base/memory/allocator.h"
+
+using ozz::animation::Skeleton;
+using ozz::animation::offline::GenerateFixedTopology;
+using ozz::animation::offline::RawSkeleton;
+using ozz::animation::offline::SkeletonBuilder;
+
+TEST(Error, FixedTopologyGenerator) {
+  ozz::String::Std source = "unchanged";
+
+  // Empty skeleton.
+  EXPECT_FALSE(GenerateFixedTopology(Skeleton(), "Topology", &source));
+
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  raw_skeleton.roots[0].name = "root";
+  SkeletonBuilder builder;
+  Skeleton* skeleton = builder(raw_skeleton);
+  ASSERT_TRUE(skeleton != NULL);
+
+  // Invalid names.
+  EXPECT_FALSE(GenerateFixedTopology(*skeleton, NULL, &source));
+  EXPECT_FALSE(GenerateFixedTopology(*skeleton, "", &source));
+  EXPECT_FALSE(GenerateFixedTopology(*skeleton, "0Topology", &source));
+  EXPECT_FALSE(GenerateFixedTopology(*skeleton, "My Topology", &source));
+  EXPECT_FALSE(GenerateFixedTopology(*skeleton, "Topology", NULL));
+  EXPECT_STREQ(source.c_str(), "unchanged");
+
+  EXPECT_TRUE(GenerateFixedTopology(*skeleton, "_Topology0", &source));
+  EXPECT_EQ(source.find("unchanged"), 0u);
+
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+TEST(Generate, FixedTopologyGenerator) {
+  // j0 (j1 (j2), j3)
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  RawSkeleton::Joint& j0 = raw_skeleton.roots[0];
+  j0.name = "j0";
+  j0.children.resize(2);
+  j0.children[0].name = "j1";
+  j0.children[0].children.resize(1);
+  j0.children[0].children[0].name = "j2";
+  j0.children[1].name = "j3";
+  SkeletonBuilder builder;
+  Skeleton* skeleton = builder(raw_skeleton);
+  ASSERT_TRUE(skeleton != NULL);
+
+  ozz::String::Std source;
+  ASSERT_TRUE(GenerateFixedTopology(*skeleton, "Topology", &source));
+
+  EXPECT_NE(source.find("#include \"ozz/animation/runtime/fixed_topology.h\""),
+            ozz::String::Std::npos);
+  EXPECT_NE(source.find("struct Topology {"), ozz::String::Std::npos);
+  EXPECT_NE(source.find("enum { kNumJoints = 4 };"), ozz::String::Std::npos);
+
+  char fingerprint[64];
+  std::sprintf(fingerprint, "return 0x%08xu;",
+               static_cast<unsigned int>(skeleton->fingerprint()));
+  EXPECT_NE(source.find(fingerprint), ozz::String::Std::npos);
+
+  EXPECT_NE(source.find("struct Topology::Parent<0> {\n"
+                        "  enum { kValue = -1 };"),
+            ozz::String::Std::npos);
+  EXPECT_NE(source.find("struct Topology::Parent<1> {\n"
+                        "  enum { kValue = 0 };"),
+            ozz::String::Std::npos);
+  EXPECT_NE(source.find("struct Topology::Parent<2> {\n"
+                        "  enum { kValue = 1 };"),
+            ozz::String::Std::npos);
+  EXPECT_NE(source.find("struct Topology::Parent<3> {\n"
+                        "  enum { kValue = 0 };"),
+            ozz::String::Std::npos);
+  EXPECT_EQ(source.find("Parent<4>"), ozz::String::Std::npos);
+
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
@@ -0,0 +1,293 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#include "ozz/animation/offline/motion_database_builder.h"
+
+#include <algorithm>
+
+#include "gtest/gtest.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/raw_skeleton.h"
+#include "ozz/animation/offline/skeleton_builder.h"
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/motion_database.h"
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/base/memory/allocator.h"
+
+using ozz::animation::Animation;
+using ozz::animation::MotionDatabase;
+using ozz::animation::Skeleton;
+using ozz::animation::offline::AnimationBuilder;
+using ozz::animation::offline::MotionDatabaseBuilder;
+using ozz::animation::offline::RawAnimation;
+using ozz::animation::offline::RawSkeleton;
+using ozz::animation::offline::SkeletonBuilder;
+
+namespace {
+// Builds a 2 joints skeleton: a root and a hand.
+Skeleton* BuildSkeleton() {
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  raw_skeleton.roots[0].name = "root";
+  raw_skeleton.roots[0].children.resize(1);
+  raw_skeleton.roots[0].children[0].name = "hand";
+  return SkeletonBuilder()(raw_skeleton);
+}
+
+// Builds an animation whose root moves along z at _speed, and whose hand is at
+// (1, 1, 0) from the root.
+Animation* BuildAnimation(float _duration, float _speed) {
+  RawAnimation raw;
+  raw.duration = _duration;
+  raw.tracks.resize(2);
+  const RawAnimation::TranslationKey root_keys[] = {
+      {0.f, ozz::math::Float3::zero()},
+      {_duration, ozz::math::Float3(0.f, 0.f, _speed * _duration)}};
+  raw.tracks[0].translations.assign(root_keys, root_keys + 2);
+  const RawAnimation::TranslationKey hand_key = {
+      0.f, ozz::math::Float3(1.f, 1.f, 0.f)};
+  raw.tracks[1].translations.push_back(hand_key);
+  return AnimationBuilder()(raw);
+}
+
+// Animation translations are stored as half floats.
+const float kTolerance = 1e-3f;
+
+// Denormalizes feature _i of _frame.
+float Raw(const MotionDatabase& _database, int _frame, int _i) {
+  return _database.features()[_frame * _database.stride() + _i] /
+             _database.scales()[_i] +
+         _database.offsets()[_i];
+}
+}  // namespace
+
+TEST(Error, MotionDatabaseBuilder) {
+  Skeleton* skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton != NULL);
+  Animation* animation = BuildAnimation(1.f, 1.f);
+  ASSERT_TRUE(animation != NULL);
+  const Animation* animations[] = {animation};
+
+  MotionDatabaseBuilder builder;
+  EXPECT_EQ(builder.num_features(), 12);
+
+  {  // Default builder has only trajectory features.
+    MotionDatabase* database = builder(animations, *skeleton);
+    ASSERT_TRUE(database != NULL);
+    EXPECT_EQ(database->num_features(), 12);
+    ozz::memory::default_allocator()->Delete(database);
+  }
+
+  {  // No feature.
+    MotionDatabaseBuilder invalid;
+    invalid.trajectory_times.clear();
+    EXPECT_TRUE(invalid(animations, *skeleton) == NULL);
+  }
+
+  {  // Invalid joints.
+    MotionDatabaseBuilder invalid;
+    invalid.joints.push_back(2);
+    EXPECT_TRUE(invalid(animations, *skeleton) == NULL);
+    invalid.joints[0] = -1;
+    EXPECT_TRUE(invalid(animations, *skeleton) == NULL);
+  }
+
+  {  // Invalid root joint.
+    MotionDatabaseBuilder invalid;
+    invalid.root_joint = 2;
+    EXPECT_TRUE(invalid(animations, *skeleton) == NULL);
+  }
+
+  {  // Invalid frequency.
+    MotionDatabaseBuilder invalid;
+    invalid.frequency = 0.f;
+    EXPECT_TRUE(invalid(animations, *skeleton) == NULL);
+  }
+
+  {  // Invalid trajectory time.
+    MotionDatabaseBuilder invalid;
+    invalid.trajectory_times.push_back(-1.f);
+    EXPECT_TRUE(invalid(animations, *skeleton) == NULL);
+  }
+
+  {  // Invalid animation.
+    const Animation* null_animations[] = {animation, NULL};
+    EXPECT_TRUE(builder(null_animations, *skeleton) == NULL);
+  }
+
+  ozz::memory::default_allocator()->Delete(animation);
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+TEST(Build, MotionDatabaseBuilder) {
+  Skeleton* skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton != NULL);
+  Animation* walk = BuildAnimation(1.f, 1.f);
+  ASSERT_TRUE(walk != NULL);
+  Animation* idle = BuildAnimation(.5f, 0.f);
+  ASSERT_TRUE(idle != NULL);
+  const Animation* animations[] = {walk, idle};
+
+  MotionDatabaseBuilder builder;
+  builder.frequency = 10.f;
+  builder.joints.push_back(1);
+  builder.trajectory_times.clear();
+  builder.trajectory_times.push_back(.5f);
+  builder.velocity_weight = 2.f;
+  EXPECT_EQ(builder.num_features(), 10);
+
+  MotionDatabase* database = builder(animations, *skeleton);
+  ASSERT_TRUE(database != NULL);
+
+  EXPECT_EQ(database->num_features(), 10);
+  EXPECT_EQ(database->stride(), 12);
+  EXPECT_FLOAT_EQ(database->frequency(), 10.f);
+  EXPECT_EQ(database->num_clips(), 2);
+  ASSERT_EQ(database->num_frames(), 17);
+  EXPECT_EQ(database->clip_begins()[0], 0);
+  EXPECT_EQ(database->clip_begins()[1], 11);
+  EXPECT_EQ(database->clip_begins()[2], 17);
+  EXPECT_EQ(database->features().count(), 17u * 12u);
+  EXPECT_EQ(database->bounds().count(), 2u * 2u * 12u);
+  EXPECT_EQ(database->large_bounds().count(), 1u * 2u * 12u);
+
+  float time = -1.f;
+  EXPECT_EQ(database->FindClip(-1, &time), -1);
+  EXPECT_EQ(database->FindClip(17, &time), -1);
+  EXPECT_FLOAT_EQ(time, -1.f);
+  EXPECT_EQ(database->FindClip(0, &time), 0);
+  EXPECT_FLOAT_EQ(time, 0.f);
+  EXPECT_EQ(database->FindClip(10, NULL), 0);
+  EXPECT_EQ(database->FindClip(13, &time), 1);
+  EXPECT_FLOAT_EQ(time, .2f);
+
+  // Velocities have twice the weight of positions, scales are positive and
+  // padding is 0.
+  EXPECT_GT(database->scales()[3], 0.f);
+  EXPECT_GT(database->scales()[6], 0.f);
+  EXPECT_FLOAT_EQ(database->scales()[10], 0.f);
+  EXPECT_FLOAT_EQ(database->scales()[11], 0.f);
+  for (int f = 0; f < database->num_frames(); ++f) {
+    EXPECT_FLOAT_EQ(database->features()[f * 12 + 10], 0.f);
+    EXPECT_FLOAT_EQ(database->features()[f * 12 + 11], 0.f);
+  }
+
+  for (int f = 0; f < database->num_frames(); ++f) {
+    const bool walking = f < 11;
+
+    // Hand position relative to root.
+    EXPECT_NEAR(Raw(*database, f, 0), 1.f, kTolerance);
+    EXPECT_NEAR(Raw(*database, f, 1), 1.f, kTolerance);
+    EXPECT_NEAR(Raw(*database, f, 2), 0.f, kTolerance);
+
+    // Hand velocity.
+    EXPECT_NEAR(Raw(*database, f, 3), 0.f, kTolerance);
+    EXPECT_NEAR(Raw(*database, f, 4), 0.f, kTolerance);
+    EXPECT_NEAR(Raw(*database, f, 5), walking ? 1.f : 0.f, kTolerance);
+
+    // Trajectory is clamped at the end of the clip.
+    const float trajectory = walking ? std::min(10 - f, 5) * .1f : 0.f;
+    EXPECT_NEAR(Raw(*database, f, 6), 0.f, kTolerance);
+    EXPECT_NEAR(Raw(*database, f, 7), trajectory, kTolerance);
+
+    // Direction remains forward.
+    EXPECT_NEAR(Raw(*database, f, 8), 0.f, kTolerance);
+    EXPECT_NEAR(Raw(*database, f, 9), 1.f, kTolerance);
+  }
+
+  // Bounds contain their block frames.
+  for (int f = 0; f < database->num_frames(); ++f) {
+    const float* min = database->bounds().begin +
+                       (f / MotionDatabase::kBlockSize) * 2 * 12;
+    const float* max = min + 12;
+    const float* large_min = database->large_bounds().begin +
+                             (f / MotionDatabase::kLargeBlockSize) * 2 * 12;
+    const float* large_max = large_min + 12;
+    for (int i = 0; i < 12; ++i) {
+      EXPECT_LE(min[i], database->features()[f * 12 + i]);
+      EXPECT_GE(max[i], database->features()[f * 12 + i]);
+      EXPECT_LE(large_min[i], min[i]);
+      EXPECT_GE(large_max[i], max[i]);
+    }
+  }
+
+  ozz::memory::default_allocator()->Delete(database);
+  ozz::memory::default_allocator()->Delete(idle);
+  ozz::memory::default_allocator()->Delete(walk);
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+TEST(Rotation, MotionDatabaseBuilder) {
+  Skeleton* skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton != NULL);
+
+  // Root faces x axis, and moves along it.
+  RawAnimation raw;
+  raw.duration = 1.f;
+  raw.tracks.resize(2);
+  const RawAnimation::TranslationKey root_keys[] = {
+      {0.f, ozz::math::Float3::zero()},
+      {1.f, ozz::math::Float3(2.f, 0.f, 0.f)}};
+  raw.tracks[0].translations.assign(root_keys, root_keys + 2);
+  const RawAnimation::RotationKey root_key = {
+      0.f, ozz::math::Quaternion::FromAxisAngle(ozz::math::Float3::y_axis(),
+                                                ozz::math::kPi_2)};
+  raw.tracks[0].rotations.push_back(root_key);
+  const RawAnimation::TranslationKey hand_key = {
+      0.f, ozz::math::Float3(1.f, 1.f, 0.f)};
+  raw.tracks[1].translations.push_back(hand_key);
+  Animation* animation = AnimationBuilder()(raw);
+  ASSERT_TRUE(animation != NULL);
+  const Animation* animations[] = {animation};
+
+  MotionDatabaseBuilder builder;
+  builder.frequency = 10.f;
+  builder.joints.push_back(1);
+  builder.trajectory_times.clear();
+  builder.trajectory_times.push_back(.5f);
+  MotionDatabase* database = builder(animations, *skeleton);
+  ASSERT_TRUE(database != NULL);
+
+  // Features are expressed in character space, where the root faces z.
+  EXPECT_NEAR(Raw(*database, 0, 0), 1.f, kTolerance);
+  EXPECT_NEAR(Raw(*database, 0, 1), 1.f, kTolerance);
+  EXPECT_NEAR(Raw(*database, 0, 2), 0.f, kTolerance);
+  EXPECT_NEAR(Raw(*database, 0, 3), 0.f, kTolerance);
+  EXPECT_NEAR(Raw(*database, 0, 5), 2.f, kTolerance);
+  EXPECT_NEAR(Raw(*database, 0, 6), 0.f, kTolerance);
+  EXPECT_NEAR(Raw(*database, 0, 7), 1.f, kTolerance);
+  EXPECT_NEAR(Raw(*database, 0, 8), 0.f, kTolerance);
+  EXPECT_NEAR(Raw(*database, 0, 9), 1.f, kTolerance);
+
+  ozz::memory::default_allocator()->Delete(database);
+  ozz::memory::default_allocator()->Delete(animation);
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
@@ -0,0 +1,249 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/offline/palette_animation_builder.h"
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/io/archive.h"
+#include "ozz/base/io/stream.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/memory/allocator.h"
+
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/raw_skeleton.h"
+#include "ozz/animation/offline/skeleton_builder.h"
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/palette_animation.h"
+#include "ozz/animation/runtime/skeleton.h"
+
+using ozz::animation::Animation;
+using ozz::animation::PaletteAnimation;
+using ozz::animation::Skeleton;
+using ozz::animation::offline::AnimationBuilder;
+using ozz::animation::offline::PaletteAnimationBuilder;
+using ozz::animation::offline::RawAnimation;
+using ozz::animation::offline::RawSkeleton;
+using ozz::animation::offline::SkeletonBuilder;
+
+namespace {
+// Builds a 2 joints skeleton, the child being 1 unit above its parent.
+Skeleton* BuildSkeleton() {
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  RawSkeleton::Joint& root = raw_skeleton.roots[0];
+  root.name = "root";
+  root.transform = ozz::math::Transform::identity();
+  root.children.resize(1);
+  RawSkeleton::Joint& child = root.children[0];
+  child.name = "child";
+  child.transform = ozz::math::Transform::identity();
+  child.transform.translation = ozz::math::Float3(0.f, 1.f, 0.f);
+  return SkeletonBuilder()(raw_skeleton);
+}
+
+// Builds a 2 tracks animation, the root moving from 0 to 4 along x, and the
+// child staying 1 unit above the root.
+Animation* BuildAnimation() {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.name = "palette";
+  raw_animation.tracks.resize(2);
+  const RawAnimation::TranslationKey t0 = {0.f,
+                                           ozz::math::Float3(0.f, 0.f, 0.f)};
+  raw_animation.tracks[0].translations.push_back(t0);
+  const RawAnimation::TranslationKey t1 = {1.f,
+                                           ozz::math::Float3(4.f, 0.f, 0.f)};
+  raw_animation.tracks[0].translations.push_back(t1);
+  const RawAnimation::TranslationKey c0 = {0.f,
+                                           ozz::math::Float3(0.f, 1.f, 0.f)};
+  raw_animation.tracks[1].translations.push_back(c0);
+  return AnimationBuilder()(raw_animation);
+}
+}  // namespace
+
+TEST(Error, PaletteAnimationBuilder) {
+  Skeleton* skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton != NULL);
+  Animation* animation = BuildAnimation();
+  ASSERT_TRUE(animation != NULL);
+
+  {  // Mismatching animation and skeleton fail.
+    Skeleton empty;
+    PaletteAnimationBuilder builder;
+    EXPECT_TRUE(builder(*animation, empty) == NULL);
+  }
+
+  {  // Invalid frequency fails.
+    PaletteAnimationBuilder builder;
+    builder.frequency = 0.f;
+    EXPECT_TRUE(builder(*animation, *skeleton) == NULL);
+  }
+
+  const ozz::math::Float4x4 inverse_bind_poses[2] = {
+      ozz::math::Float4x4::identity(), ozz::math::Float4x4::identity()};
+  {  // Joint remaps without inverse bind poses fail.
+    const uint16_t remaps[1] = {1};
+    PaletteAnimationBuilder builder;
+    builder.joint_remaps = remaps;
+    EXPECT_TRUE(builder(*animation, *skeleton) == NULL);
+  }
+
+  {  // Out of range joint remaps fail.
+    const uint16_t remaps[2] = {0, 2};
+    PaletteAnimationBuilder builder;
+    builder.joint_remaps = remaps;
+    builder.inverse_bind_poses = inverse_bind_poses;
+    EXPECT_TRUE(builder(*animation, *skeleton) == NULL);
+  }
+
+  {  // Too many inverse bind poses fail.
+    const ozz::math::Float4x4 too_many[3] = {ozz::math::Float4x4::identity(),
+                                             ozz::math::Float4x4::identity(),
+                                             ozz::math::Float4x4::identity()};
+    PaletteAnimationBuilder builder;
+    builder.inverse_bind_poses = too_many;
+    EXPECT_TRUE(builder(*animation, *skeleton) == NULL);
+  }
+
+  ozz::memory::default_allocator()->Delete(animation);
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+TEST(Layout, PaletteAnimationBuilder) {
+  Skeleton* skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton != NULL);
+  Animation* animation = BuildAnimation();
+  ASSERT_TRUE(animation != NULL);
+
+  PaletteAnimationBuilder builder;
+  builder.frequency = 4.f;
+  PaletteAnimation* palette = builder(*animation, *skeleton);
+  ASSERT_TRUE(palette != NULL);
+
+  EXPECT_STREQ(palette->name(), "palette");
+  EXPECT_FLOAT_EQ(palette->duration(), 1.f);
+  EXPECT_EQ(palette->num_joints(), 2);
+  EXPECT_EQ(palette->num_frames(), 5);
+  EXPECT_EQ(palette->width(), 6);
+  EXPECT_EQ(palette->height(), 5);
+  EXPECT_EQ(palette->texels().count(), 6u * 5u * 4u);
+
+  // Texels are matrix rows, translation being the last column. Translations
+  // are approximated as animation stores them as half floats.
+  const float* frame2 = palette->frame(2);
+  EXPECT_FLOAT_EQ(frame2[0], 1.f);
+  EXPECT_NEAR(frame2[3], 2.f, 1e-2f);
+  EXPECT_FLOAT_EQ(frame2[5], 1.f);
+  EXPECT_FLOAT_EQ(frame2[7], 0.f);
+  EXPECT_FLOAT_EQ(frame2[10], 1.f);
+  EXPECT_FLOAT_EQ(frame2[11], 0.f);
+
+  // Child joint of the last frame.
+  ozz::math::Float4x4 matrix;
+  palette->GetMatrix(4, 1, &matrix);
+  EXPECT_SIMDFLOAT_EQ(matrix.cols[0], 1.f, 0.f, 0.f, 0.f);
+  EXPECT_SIMDFLOAT_EQ(matrix.cols[1], 0.f, 1.f, 0.f, 0.f);
+  EXPECT_SIMDFLOAT_EQ(matrix.cols[2], 0.f, 0.f, 1.f, 0.f);
+  EXPECT_NEAR(ozz::math::GetX(matrix.cols[3]), 4.f, 1e-2f);
+  EXPECT_NEAR(ozz::math::GetY(matrix.cols[3]), 1.f, 1e-2f);
+  EXPECT_FLOAT_EQ(ozz::math::GetW(matrix.cols[3]), 1.f);
+
+  ozz::memory::default_allocator()->Delete(palette);
+  ozz::memory::default_allocator()->Delete(animation);
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+TEST(Remap, PaletteAnimationBuilder) {
+  Skeleton* skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton != NULL);
+  Animation* animation = BuildAnimation();
+  ASSERT_TRUE(animation != NULL);
+
+  // A mesh skinned by the child joint only, whose bind pose is 1 unit up.
+  const uint16_t remaps[1] = {1};
+  const ozz::math::Float4x4 inverse_bind_poses[1] = {
+      ozz::math::Float4x4::Translation(
+          ozz::math::simd_float4::Load(0.f, -1.f, 0.f, 0.f))};
+
+  PaletteAnimationBuilder builder;
+  builder.frequency = 4.f;
+  builder.joint_remaps = remaps;
+  builder.inverse_bind_poses = inverse_bind_poses;
+  PaletteAnimation* palette = builder(*animation, *skeleton);
+  ASSERT_TRUE(palette != NULL);
+  EXPECT_EQ(palette->num_joints(), 1);
+  EXPECT_EQ(palette->width(), 3);
+
+  // Skinning matrices only contain root motion.
+  ozz::math::Float4x4 matrix;
+  palette->GetMatrix(0, 0, &matrix);
+  EXPECT_FLOAT4x4_EQ(matrix, 1.f, 0.f, 0.f, 0.f, 0.f, 1.f, 0.f, 0.f, 0.f, 0.f,
+                     1.f, 0.f, 0.f, 0.f, 0.f, 1.f);
+  palette->GetMatrix(3, 0, &matrix);
+  EXPECT_NEAR(ozz::math::GetX(matrix.cols[3]), 3.f, 1e-2f);
+  EXPECT_NEAR(ozz::math::GetY(matrix.cols[3]), 0.f, 1e-2f);
+
+  ozz::memory::default_allocator()->Delete(palette);
+  ozz::memory::default_allocator()->Delete(animation);
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+TEST(Serialize, PaletteAnimationBuilder) {
+  Skeleton* skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton != NULL);
+  Animation* animation = BuildAnimation();
+  ASSERT_TRUE(animation != NULL);
+
+  PaletteAnimationBuilder builder;
+  PaletteAnimation* o_palette = builder(*animation, *skeleton);
+  ASSERT_TRUE(o_palette != NULL);
+
+  ozz::io::MemoryStream stream;
+  ozz::io::OArchive o(&stream, ozz::GetNativeEndianness());
+  o << *o_palette;
+
+  stream.Seek(0, ozz::io::Stream::kSet);
+  ozz::io::IArchive i(&stream);
+  PaletteAnimation i_palette;
+  i >> i_palette;
+
+  EXPECT_STREQ(i_palette.name(), o_palette->name());
+  EXPECT_FLOAT_EQ(i_palette.duration(), o_palette->duration());
+  EXPECT_EQ(i_palette.num_joints(), o_palette->num_joints());
+  EXPECT_EQ(i_palette.num_frames(), o_palette->num_frames());
+  ASSERT_EQ(i_palette.texels().count(), o_palette->texels().count());
+  for (size_t t = 0; t < i_palette.texels().count(); ++t) {
+    EXPECT_EQ(i_palette.texels()[t], o_palette->texels()[t]);
+  }
+
+  ozz::memory::default_allocator()->Delete(o_palette);
+  ozz::memory::default_allocator()->Delete(animation);
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
@@ -31,6 +31,7 @@
 
 #include "ozz/base/io/archive.h"
 #include "ozz/base/io/stream.h"
+#include "ozz/base/maths/gtest_math_helper.h"
 
 using ozz::animation::offline::RawAnimation;
 
@@ -67,6 +68,9 @@ TEST(Filled, RawAnimationSerialize) {
   const RawAnimation::ScaleKey s_key = {1.f,
                                         ozz::math::Float3(93.f, 46.f, 99.f)};
   o_animation.tracks[2].scales.push_back(s_key);
+  o_animation.tracks[2].step = true;
+  o_animation.sync_markers.push_back(3.f);
+  o_animation.sync_markers.push_back(23.f);
 
   EXPECT_TRUE(o_animation.Validate());
   EXPECT_EQ(o_animation.num_tracks(), 3);
@@ -89,10 +93,15 @@ TEST(Filled, RawAnimationSerialize) {
     EXPECT_TRUE(i_animation.Validate());
     EXPECT_FLOAT_EQ(o_animation.duration, i_animation.duration);
     ASSERT_EQ(o_animation.num_tracks(), i_animation.num_tracks());
+    ASSERT_EQ(o_animation.sync_markers.size(), i_animation.sync_markers.size());
+    for (size_t i = 0; i < o_animation.sync_markers.size(); ++i) {
+      EXPECT_FLOAT_EQ(o_animation.sync_markers[i], i_animation.sync_markers[i]);
+    }
 
     for (size_t i = 0; i < o_animation.tracks.size(); ++i) {
       const RawAnimation::JointTrack& o_track = o_animation.tracks[i];
       const RawAnimation::JointTrack& i_track = i_animation.tracks[i];
+      EXPECT_EQ(o_track.step, i_track.step);
       for (size_t j = 0; j < o_track.translations.size(); ++j) {
         const RawAnimation::TranslationKey& o_key = o_track.translations[j];
         const RawAnimation::TranslationKey& i_key = i_track.translations[j];
@@ -115,6 +124,77 @@ TEST(Filled, RawAnimationSerialize) {
   }
 }
 
+TEST(MultipleKeys, RawAnimationSerialize) {
+  // Tracks have different numbers of keys per channel, including none, to
+  // test keys columnar layout.
+  RawAnimation o_animation;
+  o_animation.duration = 2.f;
+  o_animation.tracks.resize(4);
+  for (int i = 0; i < 4; ++i) {
+    RawAnimation::JointTrack& track = o_animation.tracks[i];
+    for (int j = 0; j < i; ++j) {
+      const float f = static_cast<float>(i * 10 + j);
+      const RawAnimation::TranslationKey t_key = {
+          j * .5f, ozz::math::Float3(f, f + 1.f, f + 2.f)};
+      track.translations.push_back(t_key);
+    }
+    for (int j = 0; j < 3 - i; ++j) {
+      const RawAnimation::RotationKey r_key = {
+          j * .5f, ozz::math::Quaternion(0.f, .70710677f, 0.f, .70710677f)};
+      track.rotations.push_back(r_key);
+    }
+    for (int j = 0; j < i * 2; ++j) {
+      const float f = static_cast<float>(i * 10 + j);
+      const RawAnimation::ScaleKey s_key = {
+          j * .25f, ozz::math::Float3(f + 2.f, f + 1.f, f)};
+      track.scales.push_back(s_key);
+    }
+  }
+  EXPECT_TRUE(o_animation.Validate());
+
+  for (int e = 0; e < 2; ++e) {
+    ozz::Endianness endianess = e == 0 ? ozz::kBigEndian : ozz::kLittleEndian;
+    ozz::io::MemoryStream stream;
+
+    // Streams out.
+    ozz::io::OArchive o(&stream, endianess);
+    o << o_animation;
+
+    // Streams in.
+    stream.Seek(0, ozz::io::Stream::kSet);
+    ozz::io::IArchive ia(&stream);
+
+    RawAnimation i_animation;
+    ia >> i_animation;
+
+    EXPECT_TRUE(i_animation.Validate());
+    ASSERT_EQ(o_animation.num_tracks(), i_animation.num_tracks());
+    for (size_t i = 0; i < o_animation.tracks.size(); ++i) {
+      const RawAnimation::JointTrack& o_track = o_animation.tracks[i];
+      const RawAnimation::JointTrack& i_track = i_animation.tracks[i];
+      ASSERT_EQ(o_track.translations.size(), i_track.translations.size());
+      for (size_t j = 0; j < o_track.translations.size(); ++j) {
+        EXPECT_FLOAT_EQ(o_track.translations[j].time,
+                        i_track.translations[j].time);
+        EXPECT_TRUE(Compare(o_track.translations[j].value,
+                            i_track.translations[j].value, 0.f));
+      }
+      ASSERT_EQ(o_track.rotations.size(), i_track.rotations.size());
+      for (size_t j = 0; j < o_track.rotations.size(); ++j) {
+        EXPECT_FLOAT_EQ(o_track.rotations[j].time, i_track.rotations[j].time);
+        EXPECT_QUATERNION_EQ(i_track.rotations[j].value, 0.f, .70710677f, 0.f,
+                             .70710677f);
+      }
+      ASSERT_EQ(o_track.scales.size(), i_track.scales.size());
+      for (size_t j = 0; j < o_track.scales.size(); ++j) {
+        EXPECT_FLOAT_EQ(o_track.scales[j].time, i_track.scales[j].time);
+        EXPECT_TRUE(Compare(o_track.scales[j].value, i_track.scales[j].value,
+                            0.f));
+      }
+    }
+  }
+}
+
 TEST(AlreadyInitialized, RawAnimationSerialize) {
   RawAnimation o_animation;
   o_animation.duration = 46.f;
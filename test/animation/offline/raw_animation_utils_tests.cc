@@ -0,0 +1,182 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/offline/raw_animation_utils.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+
+#include "ozz/animation/offline/raw_animation.h"
+
+using ozz::animation::offline::RawAnimation;
+using ozz::animation::offline::SampleAnimation;
+using ozz::animation::offline::SampleRawAnimation;
+
+TEST(SampleRawAnimationError, RawAnimationUtils) {
+  RawAnimation animation;
+  animation.duration = 1.f;
+  animation.tracks.resize(2);
+
+  const float times[] = {0.f, .5f, 1.f};
+  ozz::math::Transform transforms[6];
+  EXPECT_TRUE(SampleRawAnimation(animation, times, transforms));
+
+  // Output is too small.
+  EXPECT_FALSE(SampleRawAnimation(
+      animation, times, ozz::Range<ozz::math::Transform>(transforms, 5)));
+
+  // Times aren't sorted.
+  const float unsorted[] = {0.f, .5f, .2f};
+  EXPECT_FALSE(SampleRawAnimation(animation, unsorted, transforms));
+
+  // Animation is invalid.
+  animation.duration = -1.f;
+  EXPECT_FALSE(SampleRawAnimation(animation, times, transforms));
+
+  // No time to sample.
+  animation.duration = 1.f;
+  EXPECT_TRUE(SampleRawAnimation(animation, ozz::Range<const float>(),
+                                 ozz::Range<ozz::math::Transform>()));
+}
+
+TEST(SampleRawAnimation, RawAnimationUtils) {
+  // Tracks have different numbers of keys, including none and a single one.
+  RawAnimation animation;
+  animation.duration = 2.f;
+  animation.tracks.resize(4);
+  for (size_t i = 1; i < animation.tracks.size(); ++i) {
+    RawAnimation::JointTrack& track = animation.tracks[i];
+    const int num_keys = 1 + static_cast<int>(i * i) * 3;
+    for (int k = 0; k < num_keys; ++k) {
+      const float t = .1f + 1.8f * k / num_keys;
+      const float v = std::sin(t * i);
+      const RawAnimation::TranslationKey tkey = {
+          t, ozz::math::Float3(v, -v, static_cast<float>(k))};
+      track.translations.push_back(tkey);
+      const RawAnimation::RotationKey rkey = {
+          t, ozz::math::Quaternion::FromAxisAngle(ozz::math::Float3::z_axis(),
+                                                  v * 3.f)};
+      track.rotations.push_back(rkey);
+      if (k % 2) {
+        const RawAnimation::ScaleKey skey = {t, ozz::math::Float3(1.f + v)};
+        track.scales.push_back(skey);
+      }
+    }
+  }
+  ASSERT_TRUE(animation.Validate());
+
+  // Sorted times, before, after and exactly at key times, with duplicates.
+  ozz::Vector<float>::Std times;
+  for (int i = 0; i <= 100; ++i) {
+    times.push_back(animation.duration * i / 100.f);
+  }
+  times.push_back(animation.duration);
+  const RawAnimation::TranslationKey& key = animation.tracks[3].translations[5];
+  times.insert(std::lower_bound(times.begin(), times.end(), key.time), 2,
+               key.time);
+
+  const size_t num_tracks = animation.tracks.size();
+  ozz::Vector<ozz::math::Transform>::Std batch(times.size() * num_tracks);
+  ASSERT_TRUE(SampleRawAnimation(animation, make_range(times),
+                                 make_range(batch)));
+
+  // Batch is the same as sampling every time independently.
+  ozz::Vector<ozz::math::Transform>::Std single(num_tracks);
+  for (size_t t = 0; t < times.size(); ++t) {
+    ASSERT_TRUE(SampleAnimation(animation, times[t], make_range(single)));
+    for (size_t i = 0; i < num_tracks; ++i) {
+      const ozz::math::Transform& a = batch[t * num_tracks + i];
+      const ozz::math::Transform& b = single[i];
+      EXPECT_FLOAT3_EQ(a.translation, b.translation.x, b.translation.y,
+                       b.translation.z);
+      EXPECT_QUATERNION_EQ(a.rotation, b.rotation.x, b.rotation.y,
+                           b.rotation.z, b.rotation.w);
+      EXPECT_FLOAT3_EQ(a.scale, b.scale.x, b.scale.y, b.scale.z);
+    }
+  }
+
+  // Tracks without key are identity.
+  EXPECT_FLOAT3_EQ(batch[num_tracks * 50].translation, 0.f, 0.f, 0.f);
+  EXPECT_QUATERNION_EQ(batch[num_tracks * 50].rotation, 0.f, 0.f, 0.f, 1.f);
+
+  // Key values are output exactly at key times.
+  const size_t at_key =
+      std::lower_bound(times.begin(), times.end(), key.time) - times.begin();
+  EXPECT_FLOAT3_EQ(batch[at_key * num_tracks + 3].translation,
+                   key.value.x, key.value.y, key.value.z);
+  EXPECT_FLOAT3_EQ(batch[(at_key + 1) * num_tracks + 3].translation,
+                   key.value.x, key.value.y, key.value.z);
+
+  // Times are clamped to first and last keys.
+  const RawAnimation::JointTrack& track = animation.tracks[2];
+  EXPECT_FLOAT3_EQ(batch[2].translation, track.translations.front().value.x,
+                   track.translations.front().value.y,
+                   track.translations.front().value.z);
+  EXPECT_FLOAT3_EQ(batch[(times.size() - 1) * num_tracks + 2].translation,
+                   track.translations.back().value.x,
+                   track.translations.back().value.y,
+                   track.translations.back().value.z);
+}
+
+TEST(SampleStep, RawAnimationUtils) {
+  RawAnimation animation;
+  animation.duration = 1.f;
+  animation.tracks.resize(1);
+  RawAnimation::JointTrack& track = animation.tracks[0];
+  track.step = true;
+  const RawAnimation::TranslationKey tkey0 = {.2f, ozz::math::Float3(1.f)};
+  track.translations.push_back(tkey0);
+  const RawAnimation::TranslationKey tkey1 = {.6f, ozz::math::Float3(2.f)};
+  track.translations.push_back(tkey1);
+  ASSERT_TRUE(animation.Validate());
+
+  // Key values are held until the next key.
+  ozz::math::Transform output;
+  ozz::Range<ozz::math::Transform> outputs(&output, 1);
+  ASSERT_TRUE(SampleAnimation(animation, 0.f, outputs));
+  EXPECT_FLOAT3_EQ(output.translation, 1.f, 1.f, 1.f);
+  ASSERT_TRUE(SampleAnimation(animation, .2f, outputs));
+  EXPECT_FLOAT3_EQ(output.translation, 1.f, 1.f, 1.f);
+  ASSERT_TRUE(SampleAnimation(animation, .59f, outputs));
+  EXPECT_FLOAT3_EQ(output.translation, 1.f, 1.f, 1.f);
+  ASSERT_TRUE(SampleAnimation(animation, .6f, outputs));
+  EXPECT_FLOAT3_EQ(output.translation, 2.f, 2.f, 2.f);
+  ASSERT_TRUE(SampleAnimation(animation, 1.f, outputs));
+  EXPECT_FLOAT3_EQ(output.translation, 2.f, 2.f, 2.f);
+
+  // Extracted segments remain step tracks.
+  RawAnimation segment;
+  ASSERT_TRUE(ExtractSegment(animation, .4f, .8f, &segment));
+  EXPECT_TRUE(segment.tracks[0].step);
+  ASSERT_TRUE(SampleAnimation(segment, .1f, outputs));
+  EXPECT_FLOAT3_EQ(output.translation, 1.f, 1.f, 1.f);
+}
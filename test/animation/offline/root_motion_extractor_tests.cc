@@ -0,0 +1,143 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/offline/root_motion_extractor.h"
+
+#include "gtest/gtest.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/raw_track.h"
+
+using ozz::animation::offline::RawAnimation;
+using ozz::animation::offline::RawFloat3Track;
+using ozz::animation::offline::RawQuaternionTrack;
+using ozz::animation::offline::RootMotionExtractor;
+
+namespace {
+const ozz::math::Quaternion kYaw = ozz::math::Quaternion::FromAxisAngle(
+    ozz::math::Float3::y_axis(), ozz::math::kPi_2);
+const ozz::math::Quaternion kPitch = ozz::math::Quaternion::FromAxisAngle(
+    ozz::math::Float3::x_axis(), .3f);
+
+void BuildRawAnimation(RawAnimation* _raw) {
+  _raw->duration = 2.f;
+  _raw->tracks.resize(2);
+  const RawAnimation::TranslationKey tkeys[] = {
+      {0.f, ozz::math::Float3(0.f, 1.f, 0.f)},
+      {2.f, ozz::math::Float3(4.f, 1.f, 2.f)}};
+  _raw->tracks[0].translations.assign(tkeys, tkeys + 2);
+  const RawAnimation::RotationKey rkeys[] = {
+      {0.f, ozz::math::Quaternion::identity()}, {2.f, kYaw * kPitch}};
+  _raw->tracks[0].rotations.assign(rkeys, rkeys + 2);
+  const RawAnimation::TranslationKey child_key = {
+      1.f, ozz::math::Float3(0.f, 0.f, 1.f)};
+  _raw->tracks[1].translations.push_back(child_key);
+}
+}  // namespace
+
+TEST(Error, RootMotionExtractor) {
+  RawAnimation raw;
+  BuildRawAnimation(&raw);
+  RootMotionExtractor extractor;
+  RawFloat3Track translation;
+  RawQuaternionTrack rotation;
+  RawAnimation output;
+
+  EXPECT_TRUE(extractor(raw, &translation, &rotation, &output));
+  EXPECT_TRUE(extractor(raw, &translation, &rotation, NULL));
+  EXPECT_FALSE(extractor(raw, NULL, &rotation, &output));
+  EXPECT_FALSE(extractor(raw, &translation, NULL, &output));
+
+  {  // Invalid root joint.
+    RootMotionExtractor invalid;
+    invalid.root_joint = 2;
+    EXPECT_FALSE(invalid(raw, &translation, &rotation, &output));
+    EXPECT_EQ(output.num_tracks(), 0);
+    invalid.root_joint = -1;
+    EXPECT_FALSE(invalid(raw, &translation, &rotation, &output));
+  }
+
+  {  // Invalid animation.
+    RawAnimation invalid = raw;
+    invalid.duration = -1.f;
+    EXPECT_FALSE(extractor(invalid, &translation, &rotation, &output));
+    EXPECT_EQ(translation.keyframes.size(), 0u);
+    EXPECT_EQ(rotation.keyframes.size(), 0u);
+  }
+}
+
+TEST(Extract, RootMotionExtractor) {
+  RawAnimation raw;
+  BuildRawAnimation(&raw);
+  RootMotionExtractor extractor;
+  RawFloat3Track translation;
+  RawQuaternionTrack rotation;
+  RawAnimation output;
+
+  ASSERT_TRUE(extractor(raw, &translation, &rotation, &output));
+  EXPECT_TRUE(translation.Validate());
+  EXPECT_TRUE(rotation.Validate());
+
+  // Ground plane translation and yaw are extracted.
+  ASSERT_EQ(translation.keyframes.size(), 2u);
+  EXPECT_FLOAT_EQ(translation.keyframes[0].ratio, 0.f);
+  EXPECT_FLOAT3_EQ(translation.keyframes[0].value, 0.f, 0.f, 0.f);
+  EXPECT_FLOAT_EQ(translation.keyframes[1].ratio, 1.f);
+  EXPECT_FLOAT3_EQ(translation.keyframes[1].value, 4.f, 0.f, 2.f);
+  ASSERT_EQ(rotation.keyframes.size(), 2u);
+  EXPECT_QUATERNION_EQ(rotation.keyframes[0].value, 0.f, 0.f, 0.f, 1.f);
+  EXPECT_QUATERNION_EQ(rotation.keyframes[1].value, kYaw.x, kYaw.y, kYaw.z,
+                       kYaw.w);
+
+  // Extracted motion is baked out of the root, other tracks are unchanged.
+  ASSERT_TRUE(output.Validate());
+  ASSERT_EQ(output.num_tracks(), 2);
+  const RawAnimation::JointTrack& root = output.tracks[0];
+  ASSERT_EQ(root.translations.size(), 2u);
+  EXPECT_FLOAT3_EQ(root.translations[0].value, 0.f, 1.f, 0.f);
+  EXPECT_FLOAT3_EQ(root.translations[1].value, 0.f, 1.f, 0.f);
+  ASSERT_EQ(root.rotations.size(), 2u);
+  EXPECT_QUATERNION_EQ(root.rotations[0].value, 0.f, 0.f, 0.f, 1.f);
+  EXPECT_QUATERNION_EQ(root.rotations[1].value, kPitch.x, kPitch.y, kPitch.z,
+                       kPitch.w);
+  ASSERT_EQ(output.tracks[1].translations.size(), 1u);
+  EXPECT_FLOAT3_EQ(output.tracks[1].translations[0].value, 0.f, 0.f, 1.f);
+
+  {  // Only vertical translation, no yaw, no baking.
+    RootMotionExtractor vertical;
+    vertical.translation_x = false;
+    vertical.translation_y = true;
+    vertical.translation_z = false;
+    vertical.yaw = false;
+    vertical.bake = false;
+    ASSERT_TRUE(vertical(raw, &translation, &rotation, &output));
+    EXPECT_FLOAT3_EQ(translation.keyframes[1].value, 0.f, 1.f, 0.f);
+    EXPECT_QUATERNION_EQ(rotation.keyframes[1].value, 0.f, 0.f, 0.f, 1.f);
+    EXPECT_FLOAT3_EQ(output.tracks[0].translations[1].value, 4.f, 1.f, 2.f);
+  }
+}
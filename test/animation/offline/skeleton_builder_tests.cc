@@ -29,13 +29,17 @@
 #include "ozz/animation/offline/skeleton_builder.h"
 
 #include <cstring>
+#include <utility>
 
 #include "gtest/gtest.h"
 
 #include "ozz/animation/runtime/skeleton.h"
+#include "ozz/animation/runtime/skeleton_utils.h"
 #include "ozz/base/maths/simd_math.h"
 #include "ozz/base/maths/soa_transform.h"
 #include "ozz/base/memory/allocator.h"
+#include "ozz/base/memory/linear_allocator.h"
+#include "ozz/base/memory/tracking_allocator.h"
 
 #include "ozz/base/maths/gtest_math_helper.h"
 
@@ -730,3 +734,401 @@ TEST(MaxJoints, SkeletonBuilder) {
     EXPECT_TRUE(!builder(raw_skeleton));
   }
 }
+
+TEST(Allocator, SkeletonBuilder) {
+  SkeletonBuilder builder;
+
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  raw_skeleton.roots[0].name = "root";
+  raw_skeleton.roots[0].children.resize(1);
+  raw_skeleton.roots[0].children[0].name = "child";
+
+  // Default allocator.
+  {
+    Skeleton* skeleton = builder(raw_skeleton);
+    ASSERT_TRUE(skeleton != NULL);
+    EXPECT_EQ(skeleton->allocator(), ozz::memory::default_allocator());
+    ozz::memory::default_allocator()->Delete(skeleton);
+  }
+
+  // Explicit allocator, for both skeleton object and data.
+  ozz::memory::LinearAllocator allocator(4096);
+  Skeleton* skeleton = builder(raw_skeleton, &allocator);
+  ASSERT_TRUE(skeleton != NULL);
+  EXPECT_EQ(skeleton->allocator(), &allocator);
+  EXPECT_TRUE(allocator.used() > sizeof(Skeleton));
+  EXPECT_EQ(skeleton->num_joints(), 2);
+  EXPECT_STREQ(skeleton->joint_names()[1], "child");
+
+  // Last allocated blocks are released by the linear allocator.
+  allocator.Delete(skeleton);
+  EXPECT_EQ(allocator.used(), 0u);
+
+  // Fails if the skeleton can't be allocated.
+  ozz::memory::LinearAllocator small_allocator(8);
+  EXPECT_TRUE(builder(raw_skeleton, &small_allocator) == NULL);
+}
+
+TEST(Tracking, SkeletonBuilder) {
+  SkeletonBuilder builder;
+
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  raw_skeleton.roots[0].name = "root";
+
+  ozz::memory::TrackingAllocator tracking(ozz::memory::default_allocator());
+  Skeleton* skeleton = builder(raw_skeleton, &tracking);
+  ASSERT_TRUE(skeleton != NULL);
+
+  // Skeleton data are tagged, the skeleton object is allocated by the builder.
+  EXPECT_TRUE(tracking.stats(ozz::memory::kTagSkeleton).live_bytes > 0u);
+  EXPECT_EQ(tracking.stats(ozz::memory::kTagBuilder).live_bytes,
+            sizeof(Skeleton));
+  EXPECT_EQ(tracking.stats().live_count, 2u);
+
+  tracking.Delete(skeleton);
+  EXPECT_EQ(tracking.stats().live_bytes, 0u);
+  EXPECT_EQ(tracking.stats(ozz::memory::kTagSkeleton).allocation_count, 1u);
+}
+
+TEST(Rebuild, SkeletonBuilder) {
+  SkeletonBuilder builder;
+
+  RawSkeleton large;
+  large.roots.resize(1);
+  large.roots[0].name = "root";
+  large.roots[0].children.resize(9);
+  for (size_t i = 0; i < large.roots[0].children.size(); ++i) {
+    large.roots[0].children[i].name = "child";
+    large.roots[0].children[i].name += static_cast<char>('0' + i);
+  }
+
+  RawSkeleton small;
+  small.roots.resize(1);
+  small.roots[0].name = "small";
+
+  ozz::memory::TrackingAllocator tracking(ozz::memory::default_allocator());
+  Skeleton skeleton(&tracking);
+  EXPECT_FALSE(builder(large, static_cast<Skeleton*>(NULL)));
+
+  ASSERT_TRUE(builder(large, &skeleton));
+  EXPECT_EQ(skeleton.num_joints(), 10);
+  EXPECT_EQ(skeleton.FindJoint("child8"), 9);
+  EXPECT_EQ(tracking.stats(ozz::memory::kTagSkeleton).allocation_count, 1u);
+
+  // Smaller and same size skeletons reuse skeleton buffer.
+  ASSERT_TRUE(builder(small, &skeleton));
+  EXPECT_EQ(skeleton.num_joints(), 1);
+  EXPECT_STREQ(skeleton.joint_names()[0], "small");
+  EXPECT_EQ(skeleton.joint_parents()[0], Skeleton::kNoParent);
+  EXPECT_EQ(skeleton.FindJoint("small"), 0);
+  EXPECT_EQ(skeleton.FindJoint("child8"), -1);
+
+  ASSERT_TRUE(builder(large, &skeleton));
+  EXPECT_EQ(skeleton.num_joints(), 10);
+  EXPECT_STREQ(skeleton.joint_names()[9], "child8");
+  EXPECT_EQ(skeleton.joint_parents()[9], 0);
+  EXPECT_EQ(tracking.stats(ozz::memory::kTagSkeleton).allocation_count, 1u);
+
+  // A bigger skeleton reallocates it.
+  large.roots[0].children[0].children.resize(10);
+  ASSERT_TRUE(builder(large, &skeleton));
+  EXPECT_EQ(skeleton.num_joints(), 20);
+  EXPECT_EQ(tracking.stats(ozz::memory::kTagSkeleton).allocation_count, 2u);
+  EXPECT_EQ(tracking.stats(ozz::memory::kTagSkeleton).live_count, 1u);
+
+  // An empty skeleton releases it.
+  ASSERT_TRUE(builder(RawSkeleton(), &skeleton));
+  EXPECT_EQ(skeleton.num_joints(), 0);
+  EXPECT_EQ(tracking.stats().live_bytes, 0u);
+}
+
+TEST(Flat, SkeletonBuilder) {
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  raw_skeleton.roots[0].name = "root";
+  raw_skeleton.roots[0].transform.translation =
+      ozz::math::Float3(1.f, 2.f, 3.f);
+  raw_skeleton.roots[0].children.resize(2);
+  raw_skeleton.roots[0].children[0].name = "j0";
+  raw_skeleton.roots[0].children[1].name = "j1";
+
+  SkeletonBuilder builder;
+  Skeleton* built = builder(raw_skeleton);
+  ASSERT_TRUE(built != NULL);
+
+  // Writes flat representation, then relocates it.
+  ozz::memory::Allocator* allocator = ozz::memory::default_allocator();
+  const size_t size = built->flat_size();
+  void* written = allocator->Allocate(size, Skeleton::kFlatAlignment);
+  EXPECT_FALSE(built->WriteFlat(written, size - 1));
+  ASSERT_TRUE(built->WriteFlat(written, size));
+  void* buffer = allocator->Allocate(size, Skeleton::kFlatAlignment);
+  std::memcpy(buffer, written, size);
+  allocator->Deallocate(written);
+  allocator->Delete(built);
+
+  // Only joint names array is allocated when mapping.
+  ozz::memory::TrackingAllocator tracking(allocator);
+  {
+    Skeleton skeleton(&tracking);
+    EXPECT_FALSE(skeleton.MapFlat(buffer, size - 1));
+    EXPECT_FALSE(skeleton.mapped());
+    ASSERT_TRUE(skeleton.MapFlat(buffer, size));
+    EXPECT_TRUE(skeleton.mapped());
+    EXPECT_EQ(tracking.stats().live_count, 1u);
+    EXPECT_EQ(skeleton.num_joints(), 3);
+    EXPECT_EQ(skeleton.flat_size(), size);
+    EXPECT_STREQ(skeleton.joint_names()[0], "root");
+    EXPECT_STREQ(skeleton.joint_names()[1], "j0");
+    EXPECT_STREQ(skeleton.joint_names()[2], "j1");
+    EXPECT_EQ(skeleton.joint_parents()[0], Skeleton::kNoParent);
+    EXPECT_EQ(skeleton.joint_parents()[1], 0);
+    EXPECT_EQ(skeleton.joint_parents()[2], 0);
+    EXPECT_EQ(skeleton.joint_subtree_ends()[0], 3);
+    EXPECT_EQ(skeleton.joint_subtree_ends()[1], 2);
+    EXPECT_EQ(skeleton.joint_depths()[2], 1);
+    EXPECT_EQ(skeleton.joint_child_counts()[0], 2);
+    ASSERT_EQ(skeleton.num_levels(), 2);
+    EXPECT_EQ(skeleton.level_joints(1).count(), 2u);
+    EXPECT_SOAFLOAT3_EQ(skeleton.joint_bind_poses()[0].translation, 1.f, 0.f,
+                        0.f, 0.f, 2.f, 0.f, 0.f, 0.f, 3.f, 0.f, 0.f, 0.f);
+  }
+  EXPECT_EQ(tracking.stats().live_count, 0u);
+
+  // Corrupted buffers are rejected.
+  static_cast<char*>(buffer)[0] ^= 0xff;
+  {
+    Skeleton skeleton;
+    EXPECT_FALSE(skeleton.MapFlat(buffer, size));
+    EXPECT_EQ(skeleton.num_joints(), 0);
+  }
+  allocator->Deallocate(buffer);
+}
+
+#if __cplusplus >= 201103L
+TEST(Move, SkeletonBuilder) {
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  raw_skeleton.roots[0].name = "root";
+  raw_skeleton.roots[0].children.resize(2);
+  raw_skeleton.roots[0].children[0].name = "j0";
+  raw_skeleton.roots[0].children[1].name = "j1";
+
+  SkeletonBuilder builder;
+  Skeleton* built = builder(raw_skeleton);
+  ASSERT_TRUE(built != NULL);
+  const void* bind_poses = built->joint_bind_poses().begin;
+
+  // Move construction transfers the buffer.
+  Skeleton skeleton(std::move(*built));
+  EXPECT_EQ(skeleton.num_joints(), 3);
+  EXPECT_STREQ(skeleton.joint_names()[2], "j1");
+  EXPECT_EQ(skeleton.joint_bind_poses().begin, bind_poses);
+  EXPECT_EQ(built->num_joints(), 0);
+  ozz::memory::default_allocator()->Delete(built);
+
+  // Move assignment releases previous content.
+  ozz::memory::TrackingAllocator tracking(ozz::memory::default_allocator());
+  Skeleton* tracked = builder(raw_skeleton, &tracking);
+  ASSERT_TRUE(tracked != NULL);
+  skeleton = std::move(*tracked);
+  EXPECT_EQ(skeleton.allocator(), &tracking);
+  EXPECT_EQ(skeleton.num_joints(), 3);
+  EXPECT_EQ(tracked->num_joints(), 0);
+  tracking.Delete(tracked);
+  EXPECT_EQ(tracking.stats().live_count, 1u);
+
+  skeleton = Skeleton();
+  EXPECT_EQ(skeleton.num_joints(), 0);
+  EXPECT_EQ(tracking.stats().live_count, 0u);
+}
+#endif  // __cplusplus
+
+TEST(OptimizeJointsOrder, SkeletonBuilder) {
+  // Root has 3 children, with hierarchies of 4, 1 and 3 joints. Joint
+  // translation x is set to its raw depth-first index.
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  RawSkeleton::Joint& root = raw_skeleton.roots[0];
+  root.name = "root";
+  root.children.resize(3);
+  root.children[0].name = "a";
+  root.children[0].children.resize(1);
+  root.children[0].children[0].name = "a1";
+  root.children[0].children[0].children.resize(1);
+  root.children[0].children[0].children[0].name = "a2";
+  root.children[0].children[0].children[0].children.resize(1);
+  root.children[0].children[0].children[0].children[0].name = "a3";
+  root.children[1].name = "b";
+  root.children[2].name = "c";
+  root.children[2].children.resize(2);
+  root.children[2].children[0].name = "c1";
+  root.children[2].children[1].name = "c2";
+
+  struct Indexer {
+    Indexer() : index(0) {}
+    void operator()(const RawSkeleton::Joint& _current,
+                    const RawSkeleton::Joint*) {
+      RawSkeleton::Joint& joint = const_cast<RawSkeleton::Joint&>(_current);
+      joint.transform = ozz::math::Transform::identity();
+      joint.transform.translation.x = static_cast<float>(index++);
+    }
+    int index;
+  };
+  IterateJointsDF(raw_skeleton, Indexer());
+  ASSERT_TRUE(raw_skeleton.Validate());
+  const int num_joints = raw_skeleton.num_joints();
+  ASSERT_EQ(num_joints, 9);
+
+  SkeletonBuilder builder;
+  EXPECT_FALSE(builder.optimize_joints_order);
+
+  int order[9];
+  EXPECT_FALSE(
+      builder.BuildJointsOrder(raw_skeleton, ozz::Range<int>(order, 8)));
+
+  {  // Default order is raw skeleton depth-first order.
+    ASSERT_TRUE(builder.BuildJointsOrder(raw_skeleton, order));
+    for (int i = 0; i < num_joints; ++i) {
+      EXPECT_EQ(order[i], i);
+    }
+  }
+
+  builder.optimize_joints_order = true;
+  ASSERT_TRUE(builder.BuildJointsOrder(raw_skeleton, order));
+  const int expected_order[9] = {0, 5, 6, 7, 8, 1, 2, 3, 4};
+  for (int i = 0; i < num_joints; ++i) {
+    EXPECT_EQ(order[i], expected_order[i]);
+  }
+
+  Skeleton* skeleton = builder(raw_skeleton);
+  ASSERT_TRUE(skeleton != NULL);
+  ASSERT_EQ(skeleton->num_joints(), num_joints);
+
+  // Joints are still in depth-first order, smallest hierarchies first.
+  const char* expected_names[9] = {"root", "b",  "c",  "c1", "c2",
+                                   "a",    "a1", "a2", "a3"};
+  const int16_t expected_parents[9] = {Skeleton::kNoParent, 0, 0, 2, 2, 0,
+                                       5,                   6, 7};
+  int distance = 0;
+  for (int i = 0; i < num_joints; ++i) {
+    EXPECT_STREQ(skeleton->joint_names()[i], expected_names[i]);
+    EXPECT_EQ(skeleton->joint_parents()[i], expected_parents[i]);
+    if (expected_parents[i] != Skeleton::kNoParent) {
+      distance += i - expected_parents[i];
+    }
+    // Bind poses follow their joint.
+    EXPECT_FLOAT_EQ(
+        ozz::animation::GetJointLocalBindPose(*skeleton, i).translation.x,
+        static_cast<float>(order[i]));
+  }
+  EXPECT_EQ(skeleton->joint_subtree_ends()[2], 5);
+  EXPECT_EQ(skeleton->joint_subtree_ends()[5], 9);
+
+  // Total distance to parents is 18 in default order.
+  EXPECT_EQ(distance, 14);
+
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+TEST(LODs, SkeletonBuilder) {
+  // Same hierarchy as OptimizeJointsOrder test:
+  // root
+  //  |- a - a1 - a2 - a3
+  //  |- b
+  //  |- c - c1
+  //      |- c2
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  RawSkeleton::Joint& root = raw_skeleton.roots[0];
+  root.name = "root";
+  root.children.resize(3);
+  root.children[0].name = "a";
+  root.children[0].children.resize(1);
+  root.children[0].children[0].name = "a1";
+  root.children[0].children[0].children.resize(1);
+  root.children[0].children[0].children[0].name = "a2";
+  root.children[0].children[0].children[0].children.resize(1);
+  root.children[0].children[0].children[0].children[0].name = "a3";
+  root.children[1].name = "b";
+  root.children[2].name = "c";
+  root.children[2].children.resize(2);
+  root.children[2].children[0].name = "c1";
+  root.children[2].children[1].name = "c2";
+  ASSERT_TRUE(raw_skeleton.Validate());
+  const int num_joints = raw_skeleton.num_joints();
+
+  SkeletonBuilder builder;
+  EXPECT_TRUE(builder.lods.empty());
+
+  {  // Default skeleton has a single LOD.
+    Skeleton* skeleton = builder(raw_skeleton);
+    ASSERT_TRUE(skeleton != NULL);
+    EXPECT_EQ(skeleton->num_lods(), 1);
+    EXPECT_EQ(skeleton->lod_num_joints(0), num_joints);
+    for (int i = 0; i < num_joints; ++i) {
+      EXPECT_EQ(skeleton->joint_lods()[i], 0);
+    }
+    ozz::memory::default_allocator()->Delete(skeleton);
+  }
+
+  {  // Too many LODs.
+    builder.lods.resize(Skeleton::kMaxLODs);
+    EXPECT_TRUE(builder(raw_skeleton) == NULL);
+    int order[9];
+    EXPECT_FALSE(builder.BuildJointsOrder(raw_skeleton, order));
+    builder.lods.resize(Skeleton::kMaxLODs - 1);
+    Skeleton* skeleton = builder(raw_skeleton);
+    ASSERT_TRUE(skeleton != NULL);
+    // Default rules remove no joint.
+    EXPECT_EQ(skeleton->num_lods(), Skeleton::kMaxLODs);
+    EXPECT_EQ(skeleton->lod_num_joints(Skeleton::kMaxLODs - 1), num_joints);
+    ozz::memory::default_allocator()->Delete(skeleton);
+  }
+
+  // LOD 1 removes b, and leaves.
+  // LOD 2 removes joints deeper than root children.
+  builder.lods.resize(2);
+  builder.lods[0] = ozz::animation::offline::SkeletonLOD();
+  builder.lods[0].excluded_joints.push_back("b*");
+  builder.lods[0].excluded_joints.push_back("x*");
+  builder.lods[0].prune_leaves = 1;
+  builder.lods[1] = ozz::animation::offline::SkeletonLOD();
+  builder.lods[1].max_depth = 1;
+
+  int order[9];
+  ASSERT_TRUE(builder.BuildJointsOrder(raw_skeleton, order));
+  const int expected_order[9] = {0, 1, 2, 3, 4, 6, 7, 8, 5};
+  for (int i = 0; i < num_joints; ++i) {
+    EXPECT_EQ(order[i], expected_order[i]);
+  }
+
+  Skeleton* skeleton = builder(raw_skeleton);
+  ASSERT_TRUE(skeleton != NULL);
+  ASSERT_EQ(skeleton->num_joints(), num_joints);
+
+  // Siblings of the coarsest LODs come first.
+  const char* expected_names[9] = {"root", "a",  "a1", "a2", "a3",
+                                   "c",    "c1", "c2", "b"};
+  const uint8_t expected_lods[9] = {2, 2, 1, 1, 0, 2, 0, 0, 0};
+  for (int i = 0; i < num_joints; ++i) {
+    EXPECT_STREQ(skeleton->joint_names()[i], expected_names[i]);
+    EXPECT_EQ(skeleton->joint_lods()[i], expected_lods[i]);
+  }
+  EXPECT_EQ(skeleton->num_lods(), 3);
+  EXPECT_EQ(skeleton->lod_num_joints(0), 9);
+  EXPECT_EQ(skeleton->lod_num_joints(1), 6);
+  EXPECT_EQ(skeleton->lod_num_joints(2), 6);
+  ozz::memory::default_allocator()->Delete(skeleton);
+
+  {  // LODs ordering has priority over hierarchy size.
+    builder.optimize_joints_order = true;
+    ASSERT_TRUE(builder.BuildJointsOrder(raw_skeleton, order));
+    const int expected_optimized_order[9] = {0, 6, 7, 8, 1, 2, 3, 4, 5};
+    for (int i = 0; i < num_joints; ++i) {
+      EXPECT_EQ(order[i], expected_optimized_order[i]);
+    }
+  }
+}
@@ -31,14 +31,19 @@
 #include "ozz/base/maths/gtest_math_helper.h"
 
 #include "ozz/animation/offline/raw_track.h"
+#include "ozz/animation/runtime/quantized_track.h"
 #include "ozz/animation/runtime/track.h"
 #include "ozz/animation/runtime/track_sampling_job.h"
+#include "ozz/animation/runtime/track_set.h"
 
+#include <cstring>
 #include <limits>
+#include <utility>
 
 using ozz::animation::FloatTrack;
 using ozz::animation::FloatTrackSamplingJob;
 using ozz::animation::offline::RawFloatTrack;
+using ozz::animation::offline::RawTrackSet;
 using ozz::animation::offline::RawTrackInterpolation;
 using ozz::animation::offline::TrackBuilder;
 
@@ -1101,3 +1106,348 @@ TEST(Quaternion, TrackBuilder) {
     ozz::memory::default_allocator()->Delete(track);
   }
 }
+
+TEST(TrackSet, TrackBuilder) {
+  TrackBuilder builder;
+
+  {  // Empty set.
+    RawTrackSet raw_set;
+    EXPECT_TRUE(raw_set.Validate());
+    ozz::animation::TrackSet* set = builder(raw_set);
+    ASSERT_TRUE(set != NULL);
+    EXPECT_EQ(set->num_channels(), 0);
+    EXPECT_EQ(set->num_keys(), 0);
+    EXPECT_STREQ(set->name(), "");
+    ozz::memory::default_allocator()->Delete(set);
+  }
+
+  {  // Invalid channel.
+    RawTrackSet raw_set;
+    raw_set.channels.resize(2);
+    const RawFloatTrack::Keyframe key0 = {RawTrackInterpolation::kLinear, .5f,
+                                          0.f};
+    raw_set.channels[1].keyframes.push_back(key0);
+    const RawFloatTrack::Keyframe key1 = {RawTrackInterpolation::kLinear, .2f,
+                                          1.f};
+    raw_set.channels[1].keyframes.push_back(key1);
+    EXPECT_FALSE(raw_set.Validate());
+    EXPECT_TRUE(!builder(raw_set));
+  }
+
+  {  // Channels sharing the same time axis don't get any additional key.
+    RawTrackSet raw_set;
+    raw_set.name = "shared";
+    raw_set.channels.resize(3);
+    for (int c = 0; c < 3; ++c) {
+      for (int k = 0; k < 5; ++k) {
+        const RawFloatTrack::Keyframe key = {RawTrackInterpolation::kLinear,
+                                             k * .25f,
+                                             static_cast<float>(c * k)};
+        raw_set.channels[c].keyframes.push_back(key);
+      }
+    }
+    ozz::animation::TrackSet* set = builder(raw_set);
+    ASSERT_TRUE(set != NULL);
+    EXPECT_STREQ(set->name(), "shared");
+    EXPECT_EQ(set->num_channels(), 3);
+    ASSERT_EQ(set->num_keys(), 5);
+    for (int k = 0; k < 5; ++k) {
+      EXPECT_FLOAT_EQ(set->ratios()[k], k * .25f);
+      for (int c = 0; c < 3; ++c) {
+        EXPECT_FLOAT_EQ(set->values()[k * 3 + c], static_cast<float>(c * k));
+      }
+    }
+    ozz::memory::default_allocator()->Delete(set);
+  }
+
+  {  // Channels ratios are merged and deduplicated.
+    RawTrackSet raw_set;
+    raw_set.channels.resize(3);
+
+    // Channel 0 is linear, keys at .2 and .6.
+    const RawFloatTrack::Keyframe key00 = {RawTrackInterpolation::kLinear, .2f,
+                                           0.f};
+    raw_set.channels[0].keyframes.push_back(key00);
+    const RawFloatTrack::Keyframe key01 = {RawTrackInterpolation::kLinear, .6f,
+                                           4.f};
+    raw_set.channels[0].keyframes.push_back(key01);
+
+    // Channel 1 is step, keys at .2 and .4.
+    const RawFloatTrack::Keyframe key10 = {RawTrackInterpolation::kStep, .2f,
+                                           1.f};
+    raw_set.channels[1].keyframes.push_back(key10);
+    const RawFloatTrack::Keyframe key11 = {RawTrackInterpolation::kStep, .4f,
+                                           2.f};
+    raw_set.channels[1].keyframes.push_back(key11);
+
+    // Channel 2 has no key.
+
+    ozz::animation::TrackSet* set = builder(raw_set);
+    ASSERT_TRUE(set != NULL);
+    EXPECT_EQ(set->num_channels(), 3);
+
+    // 0, .2, .4, .6 and 1.
+    ASSERT_EQ(set->num_keys(), 5);
+    EXPECT_FLOAT_EQ(set->ratios()[0], 0.f);
+    EXPECT_FLOAT_EQ(set->ratios()[1], .2f);
+    EXPECT_FLOAT_EQ(set->ratios()[2], .4f);
+    EXPECT_FLOAT_EQ(set->ratios()[3], .6f);
+    EXPECT_FLOAT_EQ(set->ratios()[4], 1.f);
+
+    const float expected[5][3] = {{0.f, 1.f, 0.f},
+                                  {0.f, 1.f, 0.f},
+                                  {2.f, 2.f, 0.f},
+                                  {4.f, 2.f, 0.f},
+                                  {4.f, 2.f, 0.f}};
+    const bool expected_steps[5][3] = {{false, false, false},
+                                       {false, true, false},
+                                       {false, true, false},
+                                       {false, true, false},
+                                       {false, false, false}};
+    for (int k = 0; k < 5; ++k) {
+      for (int c = 0; c < 3; ++c) {
+        const int v = k * 3 + c;
+        EXPECT_FLOAT_EQ(set->values()[v], expected[k][c]);
+        EXPECT_EQ((set->steps()[v / 8] & (1 << (v & 7))) != 0,
+                  expected_steps[k][c]);
+      }
+    }
+    ozz::memory::default_allocator()->Delete(set);
+  }
+}
+
+TEST(Quantize, TrackBuilder) {
+  TrackBuilder builder;
+  EXPECT_FLOAT_EQ(builder.tolerance, 1e-3f);
+
+  {  // Invalid track.
+    RawFloatTrack raw_track;
+    const RawFloatTrack::Keyframe key0 = {RawTrackInterpolation::kLinear, .8f,
+                                          0.f};
+    raw_track.keyframes.push_back(key0);
+    const RawFloatTrack::Keyframe key1 = {RawTrackInterpolation::kLinear, .2f,
+                                          1.f};
+    raw_track.keyframes.push_back(key1);
+    EXPECT_TRUE(!builder.Quantize(raw_track));
+  }
+
+  {  // Keyframes too close to be quantized.
+    RawFloatTrack raw_track;
+    const RawFloatTrack::Keyframe key0 = {RawTrackInterpolation::kLinear, .5f,
+                                          0.f};
+    raw_track.keyframes.push_back(key0);
+    const RawFloatTrack::Keyframe key1 = {RawTrackInterpolation::kLinear,
+                                          .500001f, 1.f};
+    raw_track.keyframes.push_back(key1);
+    EXPECT_TRUE(raw_track.Validate());
+    EXPECT_TRUE(!builder.Quantize(raw_track));
+  }
+
+  {  // Default track.
+    RawFloatTrack raw_track;
+    raw_track.name = "quantized";
+    ozz::animation::QuantizedFloatTrack* track = builder.Quantize(raw_track);
+    ASSERT_TRUE(track != NULL);
+    EXPECT_STREQ(track->name(), "quantized");
+    EXPECT_EQ(track->ratios().count(), 2u);
+
+    ozz::animation::QuantizedFloatTrackSamplingJob sampling;
+    float result;
+    sampling.track = track;
+    sampling.result = &result;
+    sampling.ratio = .5f;
+    ASSERT_TRUE(sampling.Run());
+    EXPECT_FLOAT_EQ(result, 0.f);
+    ozz::memory::default_allocator()->Delete(track);
+  }
+
+  // Builds a track with varying keyframes. Values range is 1 for x, and 100
+  // for y.
+  ozz::animation::offline::RawFloat2Track raw_track;
+  for (int k = 0; k < 20; ++k) {
+    const ozz::animation::offline::RawFloat2Track::Keyframe key = {
+        k % 4 == 0 ? RawTrackInterpolation::kStep
+                   : RawTrackInterpolation::kLinear,
+        .05f * k + .01f,
+        ozz::math::Float2((k * 7 % 11) / 10.f, (k * 3 % 11) * 10.f)};
+    raw_track.keyframes.push_back(key);
+  }
+  TrackBuilder float_builder;
+  ozz::animation::Float2Track* float_track = float_builder(raw_track);
+  ASSERT_TRUE(float_track != NULL);
+
+  const float tolerances[] = {1e-3f, .2f};
+  const int value_sizes[] = {2, 1};
+  for (int t = 0; t < 2; ++t) {
+    builder.tolerance = tolerances[t];
+    ozz::animation::QuantizedFloat2Track* track = builder.Quantize(raw_track);
+    ASSERT_TRUE(track != NULL);
+    EXPECT_EQ(track->value_size(), value_sizes[t]);
+    EXPECT_EQ(track->ratios().count(), float_track->ratios().count());
+    EXPECT_LT(track->size(), float_track->size());
+
+    // Keyframes values are within tolerance.
+    for (size_t k = 0; k < track->ratios().count(); ++k) {
+      const ozz::math::Float2 value = track->value(k);
+      EXPECT_NEAR(value.x, float_track->values()[k].x, tolerances[t]);
+      EXPECT_NEAR(value.y, float_track->values()[k].y, tolerances[t]);
+    }
+
+    // Sampling outside of keyframes is close to float track. Ratio
+    // quantization moves keyframes slightly, which matters on steep slopes.
+    ozz::animation::QuantizedFloat2TrackSamplingJob sampling;
+    ozz::math::Float2 result;
+    sampling.track = track;
+    sampling.result = &result;
+    ozz::animation::Float2TrackSamplingJob float_sampling;
+    ozz::math::Float2 expected;
+    float_sampling.track = float_track;
+    float_sampling.result = &expected;
+    for (float ratio = -.1f; ratio < 1.1f; ratio += .013f) {
+      sampling.ratio = float_sampling.ratio = ratio;
+      ASSERT_TRUE(sampling.Run());
+      ASSERT_TRUE(float_sampling.Run());
+      EXPECT_NEAR(result.x, expected.x, tolerances[t] + 2e-3f);
+      EXPECT_NEAR(result.y, expected.y, tolerances[t] + .2f);
+    }
+    ozz::memory::default_allocator()->Delete(track);
+  }
+  ozz::memory::default_allocator()->Delete(float_track);
+}
+
+TEST(Flat, TrackBuilder) {
+  RawFloatTrack raw_float_track;
+  raw_float_track.name = "flat";
+  const RawFloatTrack::Keyframe first = {RawTrackInterpolation::kLinear, 0.f,
+                                         0.f};
+  const RawFloatTrack::Keyframe last = {RawTrackInterpolation::kLinear, 1.f,
+                                        46.f};
+  raw_float_track.keyframes.push_back(first);
+  raw_float_track.keyframes.push_back(last);
+
+  TrackBuilder builder;
+  FloatTrack* built = builder(raw_float_track);
+  ASSERT_TRUE(built != NULL);
+
+  // Writes flat representation, then relocates it.
+  ozz::memory::Allocator* allocator = ozz::memory::default_allocator();
+  const size_t size = built->flat_size();
+  void* written = allocator->Allocate(size, FloatTrack::kFlatAlignment);
+  EXPECT_FALSE(built->WriteFlat(written, size - 1));
+  ASSERT_TRUE(built->WriteFlat(written, size));
+  void* buffer = allocator->Allocate(size, FloatTrack::kFlatAlignment);
+  std::memcpy(buffer, written, size);
+  allocator->Deallocate(written);
+  allocator->Delete(built);
+
+  {
+    FloatTrack track;
+    EXPECT_FALSE(track.MapFlat(buffer, size - 1));
+    ASSERT_TRUE(track.MapFlat(buffer, size));
+    EXPECT_TRUE(track.mapped());
+    EXPECT_STREQ(track.name(), "flat");
+    EXPECT_EQ(track.flat_size(), size);
+
+    FloatTrackSamplingJob job;
+    float result;
+    job.track = &track;
+    job.ratio = .5f;
+    job.result = &result;
+    ASSERT_TRUE(job.Run());
+    EXPECT_FLOAT_EQ(result, 23.f);
+  }
+
+  // Flat representation can't be mapped by another track type.
+  {
+    ozz::animation::Float3Track track;
+    EXPECT_FALSE(track.MapFlat(buffer, size));
+    EXPECT_FALSE(track.mapped());
+    EXPECT_EQ(track.values().count(), 0u);
+  }
+  allocator->Deallocate(buffer);
+}
+
+TEST(Rebuild, TrackBuilder) {
+  TrackBuilder builder;
+  RawFloatTrack raw_float_track;
+  raw_float_track.name = "rebuild";
+  for (int i = 0; i <= 10; ++i) {
+    const RawFloatTrack::Keyframe key = {RawTrackInterpolation::kStep,
+                                         i / 10.f, static_cast<float>(i)};
+    raw_float_track.keyframes.push_back(key);
+  }
+
+  FloatTrack track;
+  EXPECT_FALSE(builder(raw_float_track, static_cast<FloatTrack*>(NULL)));
+  ASSERT_TRUE(builder(raw_float_track, &track));
+  EXPECT_EQ(track.ratios().count(), 11u);
+  EXPECT_STREQ(track.name(), "rebuild");
+  const float* values = track.values().begin;
+
+  // A smaller track reuses track buffer.
+  raw_float_track.name.clear();
+  raw_float_track.keyframes.resize(2);
+  raw_float_track.keyframes[0].interpolation = RawTrackInterpolation::kLinear;
+  raw_float_track.keyframes[1].interpolation = RawTrackInterpolation::kLinear;
+  raw_float_track.keyframes[1].ratio = 1.f;
+  ASSERT_TRUE(builder(raw_float_track, &track));
+  EXPECT_EQ(track.values().begin, values);
+  EXPECT_EQ(track.ratios().count(), 2u);
+  EXPECT_STREQ(track.name(), "");
+
+  FloatTrackSamplingJob job;
+  float result;
+  job.track = &track;
+  job.ratio = .5f;
+  job.result = &result;
+  ASSERT_TRUE(job.Run());
+  EXPECT_FLOAT_EQ(result, .5f);
+
+  // Invalid tracks fail, leaving the track unchanged.
+  raw_float_track.keyframes[1].ratio = 2.f;
+  EXPECT_FALSE(builder(raw_float_track, &track));
+  EXPECT_EQ(track.ratios().count(), 2u);
+
+  // Other track types can be rebuilt too.
+  ozz::animation::offline::RawQuaternionTrack raw_quaternion_track;
+  ozz::animation::QuaternionTrack quaternion_track;
+  EXPECT_TRUE(builder(raw_quaternion_track, &quaternion_track));
+  EXPECT_EQ(quaternion_track.values().count(), 2u);
+}
+
+#if __cplusplus >= 201103L
+TEST(Move, TrackBuilder) {
+  RawFloatTrack raw_float_track;
+  raw_float_track.name = "move";
+  const RawFloatTrack::Keyframe key = {RawTrackInterpolation::kLinear, .5f,
+                                       46.f};
+  raw_float_track.keyframes.push_back(key);
+
+  TrackBuilder builder;
+  FloatTrack* built = builder(raw_float_track);
+  ASSERT_TRUE(built != NULL);
+  const float* values = built->values().begin;
+
+  // Move construction transfers the buffer.
+  FloatTrack track(std::move(*built));
+  EXPECT_EQ(track.values().begin, values);
+  EXPECT_STREQ(track.name(), "move");
+  EXPECT_EQ(built->values().count(), 0u);
+  EXPECT_STREQ(built->name(), "");
+  ozz::memory::default_allocator()->Delete(built);
+
+  // Move assignment.
+  FloatTrack other;
+  other = std::move(track);
+  EXPECT_EQ(other.values().begin, values);
+  EXPECT_EQ(track.values().count(), 0u);
+
+  FloatTrackSamplingJob job;
+  float result;
+  job.track = &other;
+  job.ratio = 0.f;
+  job.result = &result;
+  ASSERT_TRUE(job.Run());
+  EXPECT_FLOAT_EQ(result, 46.f);
+}
+#endif  // __cplusplus
@@ -180,6 +180,30 @@ TEST(OptimizeInterpolate, TrackOptimizer) {
   }
 }
 
+TEST(OptimizeWindow, TrackOptimizer) {
+  // A long linear track.
+  RawFloatTrack raw_float_track;
+  for (int i = 0; i <= 1000; ++i) {
+    const RawFloatTrack::Keyframe key = {RawTrackInterpolation::kLinear,
+                                         i / 1000.f, i * .1f};
+    raw_float_track.keyframes.push_back(key);
+  }
+
+  // Without window, linear keys are all interpolated.
+  TrackOptimizer optimizer;
+  RawFloatTrack output;
+  ASSERT_TRUE(optimizer(raw_float_track, &output));
+  EXPECT_EQ(output.keyframes.size(), 2u);
+
+  // With a window, at most window_size keys are interpolated in a row.
+  optimizer.window_size = 9;
+  ASSERT_TRUE(optimizer(raw_float_track, &output));
+  ASSERT_EQ(output.keyframes.size(), 101u);
+  for (size_t i = 0; i < output.keyframes.size(); ++i) {
+    EXPECT_FLOAT_EQ(output.keyframes[i].value, i * 1.f);
+  }
+}
+
 TEST(float, TrackOptimizer) {
   TrackOptimizer optimizer;
 
@@ -0,0 +1,153 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/offline/uniform_animation_builder.h"
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/allocator.h"
+
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/runtime/uniform_animation.h"
+
+using ozz::animation::UniformAnimation;
+using ozz::animation::offline::RawAnimation;
+using ozz::animation::offline::UniformAnimationBuilder;
+
+TEST(Error, UniformAnimationBuilder) {
+  UniformAnimationBuilder builder;
+
+  {  // Building an invalid RawAnimation fails.
+    RawAnimation raw_animation;
+    raw_animation.duration = -1.f;
+    EXPECT_TRUE(builder(raw_animation) == NULL);
+  }
+
+  {  // Invalid frequency fails.
+    RawAnimation raw_animation;
+    raw_animation.duration = 1.f;
+    UniformAnimationBuilder invalid;
+    invalid.frequency = 0.f;
+    EXPECT_TRUE(invalid(raw_animation) == NULL);
+  }
+
+  {  // Building an empty animation succeeds.
+    RawAnimation raw_animation;
+    raw_animation.duration = 1.f;
+    UniformAnimation* animation = builder(raw_animation);
+    ASSERT_TRUE(animation != NULL);
+    EXPECT_EQ(animation->num_tracks(), 0);
+    EXPECT_EQ(animation->num_frames(), 31);
+    EXPECT_EQ(animation->frames().count(), 0u);
+    ozz::memory::default_allocator()->Delete(animation);
+  }
+}
+
+TEST(Frames, UniformAnimationBuilder) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.name = "uniform";
+  raw_animation.tracks.resize(5);
+
+  const RawAnimation::TranslationKey t0 = {0.f,
+                                           ozz::math::Float3(0.f, 0.f, 0.f)};
+  raw_animation.tracks[0].translations.push_back(t0);
+  const RawAnimation::TranslationKey t1 = {1.f,
+                                           ozz::math::Float3(4.f, 0.f, 0.f)};
+  raw_animation.tracks[0].translations.push_back(t1);
+
+  const RawAnimation::ScaleKey s0 = {0.f, ozz::math::Float3(2.f, 2.f, 2.f)};
+  raw_animation.tracks[4].scales.push_back(s0);
+
+  // Rotations keys aren't in the same hemisphere.
+  const RawAnimation::RotationKey r0 = {
+      0.f, ozz::math::Quaternion(0.f, 0.f, 0.f, 1.f)};
+  raw_animation.tracks[1].rotations.push_back(r0);
+  const RawAnimation::RotationKey r1 = {
+      1.f, ozz::math::Quaternion(0.f, .70710677f, 0.f, -.70710677f)};
+  raw_animation.tracks[1].rotations.push_back(r1);
+
+  UniformAnimationBuilder builder;
+  builder.frequency = 4.f;
+  UniformAnimation* animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+
+  EXPECT_STREQ(animation->name(), "uniform");
+  EXPECT_FLOAT_EQ(animation->duration(), 1.f);
+  EXPECT_EQ(animation->num_tracks(), 5);
+  EXPECT_EQ(animation->num_soa_tracks(), 2);
+  EXPECT_EQ(animation->num_frames(), 5);
+  EXPECT_EQ(animation->frames().count(), 10u);
+
+  // First, middle and last frames.
+  const ozz::math::SoaTransform* frame0 = animation->frame(0);
+  EXPECT_SOAFLOAT3_EQ_EST(frame0[0].translation, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f,
+                          0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+  EXPECT_SOAQUATERNION_EQ_EST(frame0[0].rotation, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f,
+                              0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 1.f, 1.f, 1.f, 1.f);
+  EXPECT_SOAFLOAT3_EQ_EST(frame0[1].scale, 2.f, 1.f, 1.f, 1.f, 2.f, 1.f, 1.f,
+                          1.f, 2.f, 1.f, 1.f, 1.f);
+
+  const ozz::math::SoaTransform* frame2 = animation->frame(2);
+  EXPECT_SOAFLOAT3_EQ_EST(frame2[0].translation, 2.f, 0.f, 0.f, 0.f, 0.f, 0.f,
+                          0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+
+  const ozz::math::SoaTransform* frame4 = animation->frame(4);
+  EXPECT_SOAFLOAT3_EQ_EST(frame4[0].translation, 4.f, 0.f, 0.f, 0.f, 0.f, 0.f,
+                          0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+
+  // Last rotation was flipped to the hemisphere of the previous frames.
+  EXPECT_SOAQUATERNION_EQ_EST(frame4[0].rotation, 0.f, 0.f, 0.f, 0.f, 0.f,
+                              -.70710677f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 1.f,
+                              .70710677f, 1.f, 1.f);
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+TEST(Frequency, UniformAnimationBuilder) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 2.f;
+  raw_animation.tracks.resize(1);
+
+  UniformAnimationBuilder builder;
+
+  // Rounds the number of intervals up.
+  builder.frequency = 2.2f;
+  UniformAnimation* animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+  EXPECT_EQ(animation->num_frames(), 6);
+  ozz::memory::default_allocator()->Delete(animation);
+
+  // At least 2 frames.
+  builder.frequency = .1f;
+  animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+  EXPECT_EQ(animation->num_frames(), 2);
+  ozz::memory::default_allocator()->Delete(animation);
+}
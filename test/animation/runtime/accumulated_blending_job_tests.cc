@@ -0,0 +1,366 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#include "ozz/animation/runtime/accumulated_blending_job.h"
+
+#include "gtest/gtest.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/allocator.h"
+
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/sampling_job.h"
+
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/raw_animation.h"
+
+using ozz::animation::AccumulatedBlendingJob;
+using ozz::animation::Animation;
+using ozz::animation::BlendingJob;
+using ozz::animation::SamplingCache;
+using ozz::animation::SamplingJob;
+using ozz::animation::SoaBlendAccumulator;
+using ozz::animation::offline::AnimationBuilder;
+using ozz::animation::offline::RawAnimation;
+
+TEST(JobValidity, AccumulatedBlendingJob) {
+  const ozz::math::SoaTransform identity = ozz::math::SoaTransform::identity();
+  const ozz::math::SoaTransform bind_pose[2] = {identity, identity};
+  SoaBlendAccumulator accumulator[2];
+  ozz::math::SoaTransform output[2];
+
+  {  // Empty/default job.
+    AccumulatedBlendingJob job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  {  // Valid job.
+    AccumulatedBlendingJob job;
+    job.bind_pose = bind_pose;
+    job.accumulator = accumulator;
+    job.output = output;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+  {  // Invalid threshold.
+    AccumulatedBlendingJob job;
+    job.threshold = 0.f;
+    job.bind_pose = bind_pose;
+    job.accumulator = accumulator;
+    job.output = output;
+    EXPECT_FALSE(job.Validate());
+  }
+  {  // Missing accumulator.
+    AccumulatedBlendingJob job;
+    job.bind_pose = bind_pose;
+    job.output = output;
+    EXPECT_FALSE(job.Validate());
+  }
+  {  // Accumulator too small.
+    AccumulatedBlendingJob job;
+    job.bind_pose = bind_pose;
+    job.accumulator.begin = accumulator;
+    job.accumulator.end = accumulator + 1;
+    job.output = output;
+    EXPECT_FALSE(job.Validate());
+  }
+  {  // Output too small.
+    AccumulatedBlendingJob job;
+    job.bind_pose = bind_pose;
+    job.accumulator = accumulator;
+    job.output.begin = output;
+    job.output.end = output + 1;
+    EXPECT_FALSE(job.Validate());
+  }
+}
+
+TEST(SamplingValidity, AccumulatedBlendingJob) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(5);
+  AnimationBuilder builder;
+  Animation* animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+
+  SamplingCache cache(5);
+  ozz::math::SoaTransform output[2];
+  SoaBlendAccumulator accumulator[2];
+  ozz::math::SimdFloat4 joint_weights[2];
+
+  SamplingJob job;
+  job.animation = animation;
+  job.cache = &cache;
+  job.accumulator = accumulator;
+  EXPECT_TRUE(job.Validate());
+
+  // Only one output.
+  job.output = output;
+  EXPECT_FALSE(job.Validate());
+  job.output = ozz::Range<ozz::math::SoaTransform>();
+
+  // Accumulator too small.
+  job.accumulator.end = accumulator + 1;
+  EXPECT_FALSE(job.Validate());
+  job.accumulator = accumulator;
+
+  // Negative weight.
+  job.weight = -1.f;
+  EXPECT_FALSE(job.Validate());
+  job.weight = 0.f;
+  EXPECT_TRUE(job.Validate());
+
+  // Joint weights.
+  job.joint_weights.begin = joint_weights;
+  job.joint_weights.end = joint_weights + 1;
+  EXPECT_FALSE(job.Validate());
+  job.joint_weights.end = joint_weights + 2;
+  EXPECT_TRUE(job.Validate());
+
+  // Can't be incremental.
+  uint8_t changed[1];
+  job.changed = changed;
+  EXPECT_FALSE(job.Validate());
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+namespace {
+// Expects all components of _a and _b to be nearly equal.
+void ExpectSoaNear(const ozz::math::SoaTransform& _a,
+                   const ozz::math::SoaTransform& _b) {
+  const ozz::math::SimdFloat4* a =
+      reinterpret_cast<const ozz::math::SimdFloat4*>(&_a);
+  const ozz::math::SimdFloat4* b =
+      reinterpret_cast<const ozz::math::SimdFloat4*>(&_b);
+  for (size_t i = 0; i < sizeof(_a) / sizeof(*a); ++i) {
+    float fa[4];
+    float fb[4];
+    ozz::math::StorePtrU(a[i], fa);
+    ozz::math::StorePtrU(b[i], fb);
+    for (int j = 0; j < 4; ++j) {
+      EXPECT_NEAR(fa[j], fb[j], 2e-5f);
+    }
+  }
+}
+
+// Builds an animation of _num_tracks, whose track i rotates around y and
+// translates along x, according to _seed.
+Animation* BuildAnimation(int _num_tracks, float _seed) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(_num_tracks);
+  for (int i = 0; i < _num_tracks; ++i) {
+    RawAnimation::JointTrack& track = raw_animation.tracks[i];
+    const float v = _seed + i;
+    const RawAnimation::TranslationKey t0 = {0.f,
+                                             ozz::math::Float3(v, 1.f, 0.f)};
+    const RawAnimation::TranslationKey t1 = {
+        1.f, ozz::math::Float3(-v, 2.f, v)};
+    track.translations.push_back(t0);
+    track.translations.push_back(t1);
+    const RawAnimation::RotationKey r0 = {
+        0.f, ozz::math::Quaternion::FromEuler(v * .3f, 0.f, 0.f)};
+    const RawAnimation::RotationKey r1 = {
+        1.f, ozz::math::Quaternion::FromEuler(-v * .2f, v * .1f, 0.f)};
+    track.rotations.push_back(r0);
+    track.rotations.push_back(r1);
+    const RawAnimation::ScaleKey s0 = {0.f,
+                                       ozz::math::Float3(1.f, 2.f, 1.f + v)};
+    track.scales.push_back(s0);
+  }
+  AnimationBuilder builder;
+  return builder(raw_animation);
+}
+}  // namespace
+
+TEST(Blend, AccumulatedBlendingJob) {
+  // 7 joints, so last soa joint is partially used.
+  Animation* animations[2] = {BuildAnimation(7, 1.f), BuildAnimation(7, 3.f)};
+  ASSERT_TRUE(animations[0] && animations[1]);
+
+  const ozz::math::SoaTransform identity = ozz::math::SoaTransform::identity();
+  ozz::math::SoaTransform bind_pose[2] = {identity, identity};
+  bind_pose[1].translation.x = ozz::math::simd_float4::Load1(5.f);
+  const ozz::math::SimdFloat4 joint_weights[2] = {
+      ozz::math::simd_float4::Load(1.f, .5f, 0.f, .2f),
+      ozz::math::simd_float4::Load(0.f, 1.f, .1f, 0.f)};
+  const float weights[2] = {.3f, .6f};
+  const float ratios[2] = {.3f, .8f};
+
+  // Various weights, to test bind pose blending threshold.
+  const float scales[3] = {1.f, .1f, 0.f};
+  for (int s = 0; s < 3; ++s) {
+    SamplingCache caches[2] = {SamplingCache(7), SamplingCache(7)};
+
+    // Reference output, using intermediate poses and a BlendingJob.
+    ozz::math::SoaTransform poses[2][2];
+    BlendingJob::Layer layers[2];
+    for (int i = 0; i < 2; ++i) {
+      SamplingJob sampling_job;
+      sampling_job.animation = animations[i];
+      sampling_job.cache = &caches[i];
+      sampling_job.ratio = ratios[i];
+      sampling_job.output = poses[i];
+      ASSERT_TRUE(sampling_job.Run());
+      layers[i].transform = poses[i];
+      layers[i].weight = weights[i] * scales[s];
+    }
+    layers[1].joint_weights = joint_weights;
+
+    ozz::math::SoaTransform expected[2];
+    BlendingJob blending_job;
+    blending_job.layers = layers;
+    blending_job.bind_pose = bind_pose;
+    blending_job.output = expected;
+    ASSERT_TRUE(blending_job.Run());
+
+    // Accumulated output.
+    SoaBlendAccumulator accumulator[2];
+    ozz::animation::ResetBlendAccumulators(
+        ozz::Range<SoaBlendAccumulator>(accumulator));
+    for (int i = 0; i < 2; ++i) {
+      SamplingJob sampling_job;
+      sampling_job.animation = animations[i];
+      sampling_job.cache = &caches[i];
+      sampling_job.ratio = ratios[i];
+      sampling_job.accumulator = accumulator;
+      sampling_job.weight = weights[i] * scales[s];
+      if (i == 1) {
+        sampling_job.joint_weights = joint_weights;
+      }
+      ASSERT_TRUE(sampling_job.Run());
+    }
+
+    ozz::math::SoaTransform output[2];
+    AccumulatedBlendingJob job;
+    job.bind_pose = bind_pose;
+    job.accumulator = accumulator;
+    job.output = output;
+    ASSERT_TRUE(job.Run());
+
+    ExpectSoaNear(expected[0], output[0]);
+    ExpectSoaNear(expected[1], output[1]);
+
+    // Accumulators are reset.
+    for (int i = 0; i < 2; ++i) {
+      EXPECT_SOAFLOAT1_EQ(accumulator[i].weight, 0.f, 0.f, 0.f, 0.f);
+      EXPECT_SOAFLOAT1_EQ(accumulator[i].rotation.w, 0.f, 0.f, 0.f, 0.f);
+    }
+  }
+
+  ozz::memory::default_allocator()->Delete(animations[0]);
+  ozz::memory::default_allocator()->Delete(animations[1]);
+}
+
+TEST(Mask, AccumulatedBlendingJob) {
+  Animation* animation = BuildAnimation(8, 1.f);
+  ASSERT_TRUE(animation);
+  SamplingCache cache(8);
+
+  const ozz::math::SoaTransform identity = ozz::math::SoaTransform::identity();
+  const ozz::math::SoaTransform bind_pose[2] = {identity, identity};
+
+  // Samples second soa track only.
+  ozz::math::SoaTransform expected[2];
+  SamplingJob sampling_job;
+  sampling_job.animation = animation;
+  sampling_job.cache = &cache;
+  sampling_job.ratio = .5f;
+  sampling_job.output = expected;
+  ASSERT_TRUE(sampling_job.Run());
+
+  SoaBlendAccumulator accumulator[2];
+  ozz::animation::ResetBlendAccumulators(
+      ozz::Range<SoaBlendAccumulator>(accumulator));
+  const uint8_t mask[1] = {2};
+  sampling_job.output = ozz::Range<ozz::math::SoaTransform>();
+  sampling_job.accumulator = accumulator;
+  sampling_job.mask = mask;
+  ASSERT_TRUE(sampling_job.Run());
+  EXPECT_SOAFLOAT1_EQ(accumulator[0].weight, 0.f, 0.f, 0.f, 0.f);
+  EXPECT_SOAFLOAT1_EQ(accumulator[1].weight, 1.f, 1.f, 1.f, 1.f);
+
+  // Masked out soa track falls back to the bind pose.
+  ozz::math::SoaTransform output[2];
+  AccumulatedBlendingJob job;
+  job.bind_pose = bind_pose;
+  job.accumulator = accumulator;
+  job.output = output;
+  ASSERT_TRUE(job.Run());
+  ExpectSoaNear(identity, output[0]);
+  ExpectSoaNear(expected[1], output[1]);
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+TEST(Scatter, AccumulatedBlendingJob) {
+  // Sparse animation that only animates the second soa joint of an 8 joints
+  // skeleton.
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(8);
+  const RawAnimation::TranslationKey key = {0.f,
+                                            ozz::math::Float3(1.f, 2.f, 3.f)};
+  raw_animation.tracks[5].translations.push_back(key);
+
+  AnimationBuilder builder;
+  builder.sparse = true;
+  Animation* animation = builder(raw_animation);
+  ASSERT_TRUE(animation);
+  ASSERT_EQ(animation->num_soa_tracks(), 1);
+  SamplingCache cache(4);
+
+  const ozz::math::SoaTransform identity = ozz::math::SoaTransform::identity();
+  const ozz::math::SoaTransform bind_pose[2] = {identity, identity};
+
+  SoaBlendAccumulator accumulator[2];
+  ozz::animation::ResetBlendAccumulators(
+      ozz::Range<SoaBlendAccumulator>(accumulator));
+  SamplingJob sampling_job;
+  sampling_job.animation = animation;
+  sampling_job.cache = &cache;
+  sampling_job.accumulator = accumulator;
+  sampling_job.scatter = true;
+  ASSERT_TRUE(sampling_job.Run());
+
+  // Only the animated soa joint gains weight.
+  EXPECT_SOAFLOAT1_EQ(accumulator[0].weight, 0.f, 0.f, 0.f, 0.f);
+  EXPECT_SOAFLOAT1_EQ(accumulator[1].weight, 1.f, 1.f, 1.f, 1.f);
+
+  ozz::math::SoaTransform output[2];
+  AccumulatedBlendingJob job;
+  job.bind_pose = bind_pose;
+  job.accumulator = accumulator;
+  job.output = output;
+  ASSERT_TRUE(job.Run());
+  ExpectSoaNear(identity, output[0]);
+  EXPECT_SOAFLOAT3_EQ_EST(output[1].translation, 0.f, 1.f, 0.f, 0.f, 0.f, 2.f,
+                          0.f, 0.f, 0.f, 3.f, 0.f, 0.f);
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
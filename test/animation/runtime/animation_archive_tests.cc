@@ -34,12 +34,16 @@
 #include "ozz/base/io/stream.h"
 #include "ozz/base/memory/allocator.h"
 
+#include "ozz/base/maths/box.h"
 #include "ozz/base/maths/soa_transform.h"
 
 #include "ozz/animation/runtime/sampling_job.h"
 
 #include "ozz/animation/offline/animation_builder.h"
 #include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/raw_skeleton.h"
+#include "ozz/animation/offline/skeleton_builder.h"
+#include "ozz/animation/runtime/skeleton.h"
 
 using ozz::animation::Animation;
 using ozz::animation::TranslationKey;
@@ -47,6 +51,8 @@ using ozz::animation::RotationKey;
 using ozz::animation::ScaleKey;
 using ozz::animation::offline::RawAnimation;
 using ozz::animation::offline::AnimationBuilder;
+using ozz::animation::offline::RawSkeleton;
+using ozz::animation::offline::SkeletonBuilder;
 
 TEST(Empty, AnimationSerialize) {
   ozz::io::MemoryStream stream;
@@ -67,6 +73,26 @@ TEST(Empty, AnimationSerialize) {
   EXPECT_EQ(o_animation.num_tracks(), i_animation.num_tracks());
 }
 
+TEST(PeekVersion, AnimationSerialize) {
+  ozz::io::MemoryStream stream;
+  ozz::io::OArchive o(&stream, ozz::GetNativeEndianness());
+  Animation o_animation;
+  o << o_animation;
+
+  // Version is peeked without consuming the object.
+  stream.Seek(0, ozz::io::Stream::kSet);
+  ozz::io::IArchive i(&stream);
+  const int64_t tell = stream.Tell();
+  EXPECT_EQ(i.PeekVersion<ozz::animation::Skeleton>(), 0u);
+  EXPECT_EQ(i.PeekVersion<Animation>(),
+            static_cast<uint32_t>(
+                ozz::io::internal::Version<const Animation>::kValue));
+  EXPECT_EQ(stream.Tell(), tell);
+  Animation i_animation;
+  i >> i_animation;
+  EXPECT_EQ(i_animation.num_tracks(), 0);
+}
+
 TEST(Filled, AnimationSerialize) {
   // Builds a valid animation.
   Animation* o_animation = NULL;
@@ -110,6 +136,7 @@ TEST(Filled, AnimationSerialize) {
     i >> i_animation;
 
     ASSERT_FLOAT_EQ(o_animation->duration(), i_animation.duration());
+    ASSERT_EQ(o_animation->num_frames(), i_animation.num_frames());
     ASSERT_EQ(o_animation->num_tracks(), i_animation.num_tracks());
     EXPECT_EQ(o_animation->size(), i_animation.size());
 
@@ -190,3 +217,376 @@ TEST(AlreadyInitialized, AnimationSerialize) {
     ASSERT_EQ(i_animation.num_tracks(), 2);
   }
 }
+
+TEST(SeekPoints, AnimationSerialize) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(3);
+  for (int i = 0; i < 10; ++i) {
+    const float t = i * .1f;
+    RawAnimation::TranslationKey t_key = {t, ozz::math::Float3(t, 0.f, -t)};
+    raw_animation.tracks[1].translations.push_back(t_key);
+  }
+
+  AnimationBuilder builder;
+  builder.seek_interval = .25f;
+  Animation* o_animation = builder(raw_animation);
+  ASSERT_TRUE(o_animation != NULL);
+  ASSERT_EQ(o_animation->num_seek_points(), 3);
+
+  for (int e = 0; e < 2; ++e) {
+    ozz::Endianness endianess = e == 0 ? ozz::kBigEndian : ozz::kLittleEndian;
+    ozz::io::MemoryStream stream;
+
+    // Streams out.
+    ozz::io::OArchive o(&stream, endianess);
+    o << *o_animation;
+
+    // Streams in.
+    stream.Seek(0, ozz::io::Stream::kSet);
+    ozz::io::IArchive i(&stream);
+
+    Animation i_animation;
+    i >> i_animation;
+
+    EXPECT_EQ(o_animation->size(), i_animation.size());
+    ASSERT_EQ(o_animation->num_seek_points(), i_animation.num_seek_points());
+    EXPECT_EQ(memcmp(o_animation->seek_ratios().begin,
+                     i_animation.seek_ratios().begin,
+                     o_animation->seek_ratios().size()),
+              0);
+    ASSERT_EQ(o_animation->seek_keys().count(),
+              i_animation.seek_keys().count());
+    EXPECT_EQ(memcmp(o_animation->seek_keys().begin,
+                     i_animation.seek_keys().begin,
+                     o_animation->seek_keys().size()),
+              0);
+  }
+  ozz::memory::default_allocator()->Delete(o_animation);
+}
+
+TEST(Spline, AnimationSerialize) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(2);
+  for (int i = 0; i < 10; ++i) {
+    const float t = i * .1f;
+    RawAnimation::TranslationKey t_key = {t, ozz::math::Float3(t, 0.f, -t)};
+    raw_animation.tracks[1].translations.push_back(t_key);
+  }
+
+  AnimationBuilder builder;
+  builder.spline = true;
+  Animation* o_animation = builder(raw_animation);
+  ASSERT_TRUE(o_animation != NULL);
+  ASSERT_TRUE(o_animation->spline());
+
+  ozz::io::MemoryStream stream;
+  ozz::io::OArchive o(&stream);
+  o << *o_animation;
+
+  stream.Seek(0, ozz::io::Stream::kSet);
+  ozz::io::IArchive i(&stream);
+  Animation i_animation;
+  i >> i_animation;
+
+  EXPECT_EQ(o_animation->size(), i_animation.size());
+  ASSERT_TRUE(i_animation.spline());
+  ASSERT_EQ(o_animation->translation_tangents().size(),
+            i_animation.translation_tangents().size());
+  EXPECT_EQ(memcmp(o_animation->translation_tangents().begin,
+                   i_animation.translation_tangents().begin,
+                   o_animation->translation_tangents().size()),
+            0);
+  ASSERT_EQ(o_animation->rotation_tangents().size(),
+            i_animation.rotation_tangents().size());
+  EXPECT_EQ(memcmp(o_animation->rotation_tangents().begin,
+                   i_animation.rotation_tangents().begin,
+                   o_animation->rotation_tangents().size()),
+            0);
+  ASSERT_EQ(o_animation->scale_tangents().size(),
+            i_animation.scale_tangents().size());
+  EXPECT_EQ(memcmp(o_animation->scale_tangents().begin,
+                   i_animation.scale_tangents().begin,
+                   o_animation->scale_tangents().size()),
+            0);
+
+  ozz::memory::default_allocator()->Delete(o_animation);
+}
+
+TEST(Steps, AnimationSerialize) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(10);
+  raw_animation.tracks[2].step = true;
+  raw_animation.tracks[9].step = true;
+
+  AnimationBuilder builder;
+  Animation* o_animation = builder(raw_animation);
+  ASSERT_TRUE(o_animation != NULL);
+  ASSERT_TRUE(o_animation->has_steps());
+
+  ozz::io::MemoryStream stream;
+  ozz::io::OArchive o(&stream);
+  o << *o_animation;
+
+  stream.Seek(0, ozz::io::Stream::kSet);
+  ozz::io::IArchive i(&stream);
+  Animation i_animation;
+  i >> i_animation;
+
+  EXPECT_EQ(o_animation->size(), i_animation.size());
+  ASSERT_TRUE(i_animation.has_steps());
+  ASSERT_EQ(i_animation.steps().count(), 2u);
+  EXPECT_EQ(i_animation.steps()[0], 1 << 2);
+  EXPECT_EQ(i_animation.steps()[1], 1 << 1);
+
+  ozz::memory::default_allocator()->Delete(o_animation);
+}
+
+TEST(Sparse, AnimationSerialize) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(10);
+  const RawAnimation::TranslationKey key = {0.f,
+                                            ozz::math::Float3(1.f, 2.f, 3.f)};
+  raw_animation.tracks[9].translations.push_back(key);
+
+  AnimationBuilder builder;
+  builder.sparse = true;
+  Animation* o_animation = builder(raw_animation);
+  ASSERT_TRUE(o_animation != NULL);
+  ASSERT_TRUE(o_animation->sparse());
+
+  ozz::io::MemoryStream stream;
+  ozz::io::OArchive o(&stream);
+  o << *o_animation;
+
+  stream.Seek(0, ozz::io::Stream::kSet);
+  ozz::io::IArchive i(&stream);
+  Animation i_animation;
+  i >> i_animation;
+
+  EXPECT_EQ(o_animation->size(), i_animation.size());
+  EXPECT_EQ(i_animation.num_tracks(), 4);
+  ASSERT_TRUE(i_animation.sparse());
+  ASSERT_EQ(i_animation.soa_joints().count(), 1u);
+  EXPECT_EQ(i_animation.soa_joints()[0], 2);
+
+  ozz::memory::default_allocator()->Delete(o_animation);
+}
+
+TEST(PrecisionLods, AnimationSerialize) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(1);
+  for (int k = 0; k <= 4; ++k) {
+    const RawAnimation::TranslationKey key = {
+        k / 4.f, ozz::math::Float3(k * .01f, (k & 1) * .01f, 0.f)};
+    raw_animation.tracks[0].translations.push_back(key);
+  }
+
+  AnimationBuilder builder;
+  builder.precision_lods = 2;
+  Animation* o_animation = builder(raw_animation);
+  ASSERT_TRUE(o_animation != NULL);
+  ASSERT_TRUE(o_animation->has_precision_lods());
+
+  ozz::io::MemoryStream stream;
+  ozz::io::OArchive o(&stream);
+  o << *o_animation;
+
+  stream.Seek(0, ozz::io::Stream::kSet);
+  ozz::io::IArchive i(&stream);
+  Animation i_animation;
+  i >> i_animation;
+
+  EXPECT_EQ(o_animation->size(), i_animation.size());
+  ASSERT_TRUE(i_animation.has_precision_lods());
+  const ozz::Range<const uint8_t> o_lods = o_animation->translation_key_lods();
+  const ozz::Range<const uint8_t> i_lods = i_animation.translation_key_lods();
+  ASSERT_EQ(o_lods.count(), i_lods.count());
+  for (size_t k = 0; k < o_lods.count(); ++k) {
+    EXPECT_EQ(o_lods[k], i_lods[k]);
+    EXPECT_EQ(o_animation->translation_lod_next()[k],
+              i_animation.translation_lod_next()[k]);
+  }
+  EXPECT_EQ(i_animation.rotation_key_lods().count(),
+            o_animation->rotation_key_lods().count());
+  EXPECT_EQ(i_animation.scale_lod_next().count(),
+            o_animation->scale_lod_next().count());
+
+  ozz::memory::default_allocator()->Delete(o_animation);
+}
+
+TEST(KeyTimes, AnimationSerialize) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 100.f;
+  raw_animation.tracks.resize(1);
+  const RawAnimation::RotationKey key0 = {
+      .3f, ozz::math::Quaternion::identity()};
+  raw_animation.tracks[0].rotations.push_back(key0);
+  const RawAnimation::RotationKey key1 = {
+      .30001f, ozz::math::Quaternion(0.f, 1.f, 0.f, 0.f)};
+  raw_animation.tracks[0].rotations.push_back(key1);
+
+  AnimationBuilder builder;
+  Animation* o_animation = builder(raw_animation);
+  ASSERT_TRUE(o_animation != NULL);
+  ASSERT_TRUE(o_animation->has_key_times());
+
+  ozz::io::MemoryStream stream;
+  ozz::io::OArchive o(&stream);
+  o << *o_animation;
+
+  stream.Seek(0, ozz::io::Stream::kSet);
+  ozz::io::IArchive i(&stream);
+  Animation i_animation;
+  i >> i_animation;
+
+  EXPECT_EQ(o_animation->size(), i_animation.size());
+  EXPECT_EQ(i_animation.num_frames(), o_animation->num_frames());
+  ASSERT_TRUE(i_animation.has_key_times());
+  const ozz::Range<const float> o_times = o_animation->rotation_times();
+  const ozz::Range<const float> i_times = i_animation.rotation_times();
+  ASSERT_EQ(o_times.count(), i_times.count());
+  for (size_t k = 0; k < o_times.count(); ++k) {
+    EXPECT_EQ(o_times[k], i_times[k]);
+  }
+  EXPECT_EQ(i_animation.translation_times().count(),
+            o_animation->translation_times().count());
+  EXPECT_EQ(i_animation.scale_times().count(),
+            o_animation->scale_times().count());
+
+  ozz::memory::default_allocator()->Delete(o_animation);
+}
+
+TEST(BoundsAndSyncMarkers, AnimationSerialize) {
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(2);
+  SkeletonBuilder skeleton_builder;
+  ozz::animation::Skeleton* skeleton = skeleton_builder(raw_skeleton);
+  ASSERT_TRUE(skeleton != NULL);
+
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(2);
+  for (int i = 0; i < 10; ++i) {
+    const float t = i * .1f;
+    RawAnimation::TranslationKey t_key = {t, ozz::math::Float3(t, 0.f, -t)};
+    raw_animation.tracks[1].translations.push_back(t_key);
+  }
+
+  raw_animation.sync_markers.push_back(.1f);
+  raw_animation.sync_markers.push_back(.6f);
+
+  AnimationBuilder builder;
+  builder.bounds_interval = .25f;
+  builder.bounds_skeleton = skeleton;
+  Animation* o_animation = builder(raw_animation);
+  ASSERT_TRUE(o_animation != NULL);
+  ASSERT_EQ(o_animation->num_bounds(), 4);
+
+  ozz::io::MemoryStream stream;
+  ozz::io::OArchive o(&stream);
+  o << *o_animation;
+
+  stream.Seek(0, ozz::io::Stream::kSet);
+  ozz::io::IArchive i(&stream);
+  Animation i_animation;
+  i >> i_animation;
+
+  EXPECT_EQ(o_animation->size(), i_animation.size());
+  EXPECT_EQ(o_animation->skeleton_fingerprint(), skeleton->fingerprint());
+  EXPECT_EQ(i_animation.skeleton_fingerprint(), skeleton->fingerprint());
+  ASSERT_EQ(i_animation.num_sync_markers(), 2);
+  EXPECT_FLOAT_EQ(i_animation.sync_ratios()[0], .1f);
+  EXPECT_FLOAT_EQ(i_animation.sync_ratios()[1], .6f);
+  ASSERT_EQ(o_animation->num_bounds(), i_animation.num_bounds());
+  for (int b = 0; b < o_animation->num_bounds(); ++b) {
+    const ozz::math::Box& o_box = o_animation->bounds()[b];
+    const ozz::math::Box& i_box = i_animation.bounds()[b];
+    EXPECT_FLOAT3_EQ(i_box.min, o_box.min.x, o_box.min.y, o_box.min.z);
+    EXPECT_FLOAT3_EQ(i_box.max, o_box.max.x, o_box.max.y, o_box.max.z);
+  }
+
+  ozz::memory::default_allocator()->Delete(o_animation);
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+TEST(KeysLayout, AnimationSerialize) {
+  // Rotation keys of various tracks, largest component and sign, to test
+  // bitfields serialization.
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(6);
+  for (int t = 0; t < 6; ++t) {
+    RawAnimation::JointTrack& track = raw_animation.tracks[t];
+    for (int i = 0; i < 4; ++i) {
+      const float ratio = i / 3.f;
+      const RawAnimation::TranslationKey t_key = {
+          ratio, ozz::math::Float3(ratio * t, 1.f, -ratio)};
+      track.translations.push_back(t_key);
+      const float sign = (i + t) & 1 ? -1.f : 1.f;
+      const ozz::math::Float4 values[4] = {
+          ozz::math::Float4(.9f, .1f, .3f, .2f),
+          ozz::math::Float4(.1f, .9f, .3f, .2f),
+          ozz::math::Float4(.1f, .3f, .9f, .2f),
+          ozz::math::Float4(.1f, .3f, .2f, .9f)};
+      const ozz::math::Float4& v = values[(i + t) & 3];
+      const RawAnimation::RotationKey r_key = {
+          ratio, Normalize(ozz::math::Quaternion(v.x * sign, v.y, v.z,
+                                                  v.w * sign))};
+      track.rotations.push_back(r_key);
+      const RawAnimation::ScaleKey s_key = {
+          ratio, ozz::math::Float3(1.f + ratio, 2.f, 1.f + t)};
+      track.scales.push_back(s_key);
+    }
+  }
+
+  AnimationBuilder builder;
+  builder.spline = true;
+  Animation* o_animation = builder(raw_animation);
+  ASSERT_TRUE(o_animation != NULL);
+
+  for (int e = 0; e < 2; ++e) {
+    const ozz::Endianness endianess =
+        e == 0 ? ozz::kBigEndian : ozz::kLittleEndian;
+    ozz::io::MemoryStream stream;
+    ozz::io::OArchive o(&stream, endianess);
+    o << *o_animation;
+
+    stream.Seek(0, ozz::io::Stream::kSet);
+    ozz::io::IArchive i(&stream);
+    Animation i_animation;
+    i >> i_animation;
+
+    // Loaded buffers must match built ones, byte for byte.
+    ASSERT_EQ(o_animation->size(), i_animation.size());
+    EXPECT_EQ(memcmp(o_animation->translations().begin,
+                     i_animation.translations().begin,
+                     o_animation->translations().size()),
+              0);
+    EXPECT_EQ(memcmp(o_animation->rotations().begin,
+                     i_animation.rotations().begin,
+                     o_animation->rotations().size()),
+              0);
+    EXPECT_EQ(memcmp(o_animation->scales().begin, i_animation.scales().begin,
+                     o_animation->scales().size()),
+              0);
+    EXPECT_EQ(memcmp(o_animation->translation_ranges().begin,
+                     i_animation.translation_ranges().begin,
+                     o_animation->translation_ranges().size()),
+              0);
+    EXPECT_EQ(memcmp(o_animation->scale_ranges().begin,
+                     i_animation.scale_ranges().begin,
+                     o_animation->scale_ranges().size()),
+              0);
+    EXPECT_EQ(memcmp(o_animation->rotation_tangents().begin,
+                     i_animation.rotation_tangents().begin,
+                     o_animation->rotation_tangents().size()),
+              0);
+  }
+
+  ozz::memory::default_allocator()->Delete(o_animation);
+}
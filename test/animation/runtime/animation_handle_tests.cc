@@ -0,0 +1,183 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#include "ozz/animation/runtime/animation_handle.h"
+
+#include <thread>
+
+#include "gtest/gtest.h"
+
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/sampling_job.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/tracking_allocator.h"
+
+using ozz::animation::Animation;
+using ozz::animation::AnimationHandle;
+using ozz::animation::SamplingCache;
+using ozz::animation::SamplingJob;
+using ozz::animation::offline::AnimationBuilder;
+using ozz::animation::offline::RawAnimation;
+
+namespace {
+// Builds a single track animation, whose constant translation x is _x.
+Animation* BuildAnimation(float _x,
+                          ozz::memory::Allocator* _allocator =
+                              ozz::memory::default_allocator()) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(1);
+  const RawAnimation::TranslationKey key = {0.f,
+                                            ozz::math::Float3(_x, 0.f, 0.f)};
+  raw_animation.tracks[0].translations.push_back(key);
+  AnimationBuilder builder;
+  return builder(raw_animation, _allocator);
+}
+}  // namespace
+
+TEST(Empty, AnimationHandle) {
+  AnimationHandle handle(2);
+  EXPECT_EQ(handle.num_readers(), 2);
+  EXPECT_EQ(handle.generation(), 0u);
+  EXPECT_TRUE(handle.Acquire(0) == NULL);
+  handle.Release(0);
+  EXPECT_EQ(handle.Collect(), 0);
+}
+
+TEST(Reclamation, AnimationHandle) {
+  ozz::memory::TrackingAllocator tracking(ozz::memory::default_allocator());
+  {
+    AnimationHandle handle(2);
+    Animation* first = BuildAnimation(1.f, &tracking);
+    ASSERT_TRUE(first != NULL);
+    handle.Publish(first);
+    EXPECT_EQ(handle.generation(), 1u);
+
+    // Reader 0 keeps the first animation while a second one is published.
+    EXPECT_EQ(handle.Acquire(0), first);
+    Animation* second = BuildAnimation(2.f, &tracking);
+    ASSERT_TRUE(second != NULL);
+    handle.Publish(second);
+    EXPECT_EQ(handle.generation(), 2u);
+    EXPECT_EQ(handle.Collect(), 1);
+    const size_t live_count = tracking.stats().live_count;
+
+    // Reader 1 gets the second animation, which doesn't prevent the first
+    // one from being deleted once reader 0 releases it.
+    {
+      AnimationHandle::ScopedAcquire acquire(&handle, 1);
+      EXPECT_EQ(acquire.animation(), second);
+      EXPECT_EQ(handle.Collect(), 1);
+      handle.Release(0);
+      EXPECT_EQ(handle.Collect(), 0);
+      EXPECT_LT(tracking.stats().live_count, live_count);
+    }
+
+    // Publishing NULL retires the second animation, which is deleted
+    // immediately as no reader uses it.
+    handle.Publish(NULL);
+    EXPECT_EQ(handle.Collect(), 0);
+    EXPECT_TRUE(handle.Acquire(0) == NULL);
+    handle.Release(0);
+
+    // The handle deletes its current animation.
+    handle.Publish(BuildAnimation(3.f, &tracking));
+  }
+  EXPECT_EQ(tracking.stats().live_count, 0u);
+}
+
+TEST(Sampling, AnimationHandle) {
+  AnimationHandle handle(1);
+  handle.Publish(BuildAnimation(1.f));
+
+  SamplingCache cache(1);
+  ozz::math::SoaTransform output[1];
+  SamplingJob job;
+  job.cache = &cache;
+  job.output = output;
+  {
+    AnimationHandle::ScopedAcquire acquire(&handle, 0);
+    job.animation = acquire.animation();
+    ASSERT_TRUE(job.Run());
+    EXPECT_SOAFLOAT3_EQ_EST(output[0].translation, 1.f, 0.f, 0.f, 0.f, 0.f,
+                            0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+  }
+
+  // The new animation can be allocated at the address of the deleted one,
+  // the cache is still invalidated thanks to the animation uid.
+  handle.Publish(BuildAnimation(2.f));
+  {
+    AnimationHandle::ScopedAcquire acquire(&handle, 0);
+    job.animation = acquire.animation();
+    ASSERT_TRUE(job.Run());
+    EXPECT_SOAFLOAT3_EQ_EST(output[0].translation, 2.f, 0.f, 0.f, 0.f, 0.f,
+                            0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+  }
+}
+
+TEST(Concurrency, AnimationHandle) {
+  const int kNumReaders = 3;
+  const int kNumPublications = 200;
+  AnimationHandle handle(kNumReaders);
+  handle.Publish(BuildAnimation(0.f));
+
+  // Readers sample the current animation until the last one is published,
+  // and check they always see a complete animation.
+  std::thread* readers[kNumReaders];
+  for (int r = 0; r < kNumReaders; ++r) {
+    readers[r] = new std::thread([&handle, r] {
+      SamplingCache cache(1);
+      ozz::math::SoaTransform output[1];
+      SamplingJob job;
+      job.cache = &cache;
+      job.output = output;
+      float last = 0.f;
+      while (last < kNumPublications) {
+        AnimationHandle::ScopedAcquire acquire(&handle, r);
+        job.animation = acquire.animation();
+        ASSERT_TRUE(job.Run());
+        const float x = ozz::math::GetX(output[0].translation.x);
+        EXPECT_GE(x, last);
+        last = x;
+      }
+    });
+  }
+
+  // The writer publishes animations, whose translation increases.
+  for (int i = 1; i <= kNumPublications; ++i) {
+    handle.Publish(BuildAnimation(static_cast<float>(i)));
+  }
+  for (int r = 0; r < kNumReaders; ++r) {
+    readers[r]->join();
+    delete readers[r];
+  }
+  EXPECT_EQ(handle.Collect(), 0);
+}
@@ -0,0 +1,179 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+#include "ozz/animation/runtime/animation_instance.h"
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/allocator.h"
+#include "ozz/base/memory/tracking_allocator.h"
+
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/raw_skeleton.h"
+#include "ozz/animation/offline/skeleton_builder.h"
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/local_to_model_job.h"
+#include "ozz/animation/runtime/sampling_job.h"
+#include "ozz/animation/runtime/skeleton.h"
+
+using ozz::animation::Animation;
+using ozz::animation::AnimationInstance;
+using ozz::animation::LocalToModelJob;
+using ozz::animation::SamplingCache;
+using ozz::animation::SamplingJob;
+using ozz::animation::Skeleton;
+using ozz::animation::offline::AnimationBuilder;
+using ozz::animation::offline::RawAnimation;
+using ozz::animation::offline::RawSkeleton;
+using ozz::animation::offline::SkeletonBuilder;
+
+TEST(Layout, AnimationInstance) {
+  ozz::memory::TrackingAllocator tracking(ozz::memory::default_allocator());
+
+  AnimationInstance* instance =
+      AnimationInstance::New(7, 9, SamplingCache::kFull, &tracking);
+  ASSERT_TRUE(instance != NULL);
+
+  // Everything is a single allocation.
+  EXPECT_EQ(tracking.stats().live_count, 1u);
+  EXPECT_EQ(tracking.stats().live_bytes, instance->size());
+
+  EXPECT_EQ(instance->num_joints(), 7);
+  EXPECT_EQ(instance->num_soa_joints(), 2);
+  EXPECT_EQ(instance->locals().count(), 2u);
+  EXPECT_EQ(instance->models().count(), 7u);
+  EXPECT_EQ(instance->skinning_palette().count(), 7u);
+  EXPECT_EQ(instance->cache()->max_tracks(), 12);
+  EXPECT_EQ(instance->cache()->mode(), SamplingCache::kFull);
+
+  // Buffers are aligned, contiguous and within the instance block.
+  const char* block = reinterpret_cast<const char*>(instance);
+  EXPECT_TRUE(ozz::math::IsAligned(block, 16));
+  EXPECT_TRUE(ozz::math::IsAligned(instance->locals().begin, 16));
+  EXPECT_TRUE(reinterpret_cast<const char*>(instance->locals().begin) >=
+              block + sizeof(AnimationInstance));
+  EXPECT_EQ(static_cast<const void*>(instance->locals().end),
+            static_cast<const void*>(instance->models().begin));
+  EXPECT_EQ(instance->models().end, instance->skinning_palette().begin);
+  EXPECT_EQ(reinterpret_cast<const char*>(instance->skinning_palette().end) +
+                SamplingCache::AllocationSize(9, SamplingCache::kFull),
+            block + instance->size());
+
+  AnimationInstance::Delete(instance);
+  EXPECT_EQ(tracking.stats().live_count, 0u);
+
+  // Deleting NULL is supported.
+  AnimationInstance::Delete(NULL);
+}
+
+TEST(Modes, AnimationInstance) {
+  for (int i = 0; i < 3; ++i) {
+    const SamplingCache::Mode mode = static_cast<SamplingCache::Mode>(i);
+    AnimationInstance* instance = AnimationInstance::New(
+        5, 46, mode, ozz::memory::default_allocator());
+    ASSERT_TRUE(instance != NULL);
+    EXPECT_EQ(instance->cache()->mode(), mode);
+    EXPECT_EQ(instance->cache()->max_tracks(), 48);
+
+    // Cache can be resized within its initial size.
+    instance->cache()->Resize(4, mode);
+    EXPECT_EQ(instance->cache()->max_tracks(), 4);
+
+    AnimationInstance::Delete(instance);
+  }
+}
+
+TEST(Update, AnimationInstance) {
+  // Builds a 5 joints skeleton.
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  raw_skeleton.roots[0].name = "root";
+  raw_skeleton.roots[0].children.resize(4);
+  for (size_t i = 0; i < 4; ++i) {
+    raw_skeleton.roots[0].children[i].name = "child";
+  }
+  SkeletonBuilder skeleton_builder;
+  Skeleton* skeleton = skeleton_builder(raw_skeleton);
+  ASSERT_TRUE(skeleton != NULL);
+
+  // Builds a linear and a spline animation.
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(5);
+  const RawAnimation::TranslationKey key = {
+      0.f, ozz::math::Float3(1.f, 2.f, 3.f)};
+  raw_animation.tracks[0].translations.push_back(key);
+  AnimationBuilder animation_builder;
+  Animation* linear = animation_builder(raw_animation);
+  ASSERT_TRUE(linear != NULL);
+  animation_builder.spline = true;
+  Animation* spline = animation_builder(raw_animation);
+  ASSERT_TRUE(spline != NULL);
+
+  {
+    const Animation* animations[] = {linear};
+    AnimationInstance* instance = AnimationInstance::New(*skeleton, animations);
+    ASSERT_TRUE(instance != NULL);
+    EXPECT_EQ(instance->cache()->mode(), SamplingCache::kFull);
+    EXPECT_EQ(instance->num_joints(), 5);
+    AnimationInstance::Delete(instance);
+  }
+
+  const Animation* animations[] = {linear, spline};
+  AnimationInstance* instance = AnimationInstance::New(*skeleton, animations);
+  ASSERT_TRUE(instance != NULL);
+  EXPECT_EQ(instance->cache()->mode(), SamplingCache::kSpline);
+
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(animations); ++i) {
+    SamplingJob sampling_job;
+    sampling_job.animation = animations[i];
+    sampling_job.cache = instance->cache();
+    sampling_job.ratio = .5f;
+    sampling_job.output = instance->locals();
+    ASSERT_TRUE(sampling_job.Run());
+
+    LocalToModelJob ltm_job;
+    ltm_job.skeleton = skeleton;
+    ltm_job.input = instance->locals();
+    ltm_job.output = instance->models();
+    ASSERT_TRUE(ltm_job.Run());
+
+    EXPECT_SIMDFLOAT_EQ(instance->models().begin[0].cols[3], 1.f, 2.f, 3.f,
+                        1.f);
+    EXPECT_SIMDFLOAT_EQ(instance->models().begin[4].cols[3], 1.f, 2.f, 3.f,
+                        1.f);
+  }
+
+  AnimationInstance::Delete(instance);
+  ozz::memory::default_allocator()->Delete(linear);
+  ozz::memory::default_allocator()->Delete(spline);
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
@@ -0,0 +1,274 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#include "ozz/animation/runtime/blend_tree_job.h"
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/allocator.h"
+
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/raw_skeleton.h"
+#include "ozz/animation/offline/skeleton_builder.h"
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/sampling_job.h"
+#include "ozz/animation/runtime/skeleton.h"
+
+using ozz::animation::Animation;
+using ozz::animation::BlendTreeCache;
+using ozz::animation::BlendTreeJob;
+using ozz::animation::SamplingCache;
+using ozz::animation::Skeleton;
+using ozz::animation::offline::AnimationBuilder;
+using ozz::animation::offline::RawAnimation;
+using ozz::animation::offline::RawSkeleton;
+using ozz::animation::offline::SkeletonBuilder;
+
+namespace {
+// Builds a 1 joint skeleton.
+Skeleton* BuildSkeleton() {
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  raw_skeleton.roots[0].name = "root";
+  SkeletonBuilder builder;
+  return builder(raw_skeleton);
+}
+
+// Builds a 1 track animation whose translation x is constant and set to _x.
+Animation* BuildAnimation(float _x) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(1);
+  const RawAnimation::TranslationKey key = {0.f,
+                                            ozz::math::Float3(_x, 0.f, 0.f)};
+  raw_animation.tracks[0].translations.push_back(key);
+  AnimationBuilder builder;
+  return builder(raw_animation);
+}
+}  // namespace
+
+TEST(JobValidity, BlendTreeJob) {
+  Skeleton* skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton != NULL);
+  Animation* animation = BuildAnimation(1.f);
+  ASSERT_TRUE(animation != NULL);
+  SamplingCache sampling_cache(1);
+  BlendTreeCache cache(1, 2);
+  ozz::math::SoaTransform output[1];
+
+  BlendTreeJob::Node nodes[3];
+  const int children[] = {1, 2};
+  nodes[0].type = BlendTreeJob::Node::kBlend;
+  nodes[0].children = ozz::Range<const int>(children, 2);
+  for (int i = 1; i < 3; ++i) {
+    nodes[i].weight = 1.f;
+    nodes[i].animation = animation;
+    nodes[i].sampling_cache = &sampling_cache;
+  }
+
+  {  // Empty/default job.
+    BlendTreeJob job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Valid job.
+    BlendTreeJob job;
+    job.nodes = nodes;
+    job.skeleton = skeleton;
+    job.cache = &cache;
+    job.output = output;
+    EXPECT_EQ(job.RequiredBuffers(), 2);
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+
+    // No node.
+    job.nodes.end = job.nodes.begin;
+    EXPECT_FALSE(job.Validate());
+  }
+
+  {  // Invalid output.
+    BlendTreeJob job;
+    job.nodes = nodes;
+    job.skeleton = skeleton;
+    job.cache = &cache;
+    job.output.begin = output;
+    job.output.end = output;
+    EXPECT_FALSE(job.Validate());
+  }
+
+  {  // Invalid threshold.
+    BlendTreeJob job;
+    job.nodes = nodes;
+    job.skeleton = skeleton;
+    job.cache = &cache;
+    job.output = output;
+    job.threshold = 0.f;
+    EXPECT_FALSE(job.Validate());
+  }
+
+  {  // Not enough buffers.
+    BlendTreeCache small_cache(1, 1);
+    BlendTreeJob job;
+    job.nodes = nodes;
+    job.skeleton = skeleton;
+    job.cache = &small_cache;
+    job.output = output;
+    EXPECT_FALSE(job.Validate());
+  }
+
+  {  // Invalid sampling node.
+    nodes[2].animation = NULL;
+    BlendTreeJob job;
+    job.nodes = nodes;
+    job.skeleton = skeleton;
+    job.cache = &cache;
+    job.output = output;
+    EXPECT_FALSE(job.Validate());
+    nodes[2].animation = animation;
+  }
+
+  {  // Invalid children indices, which would create a cycle.
+    const int cyclic_children[] = {1, 0};
+    nodes[0].children = ozz::Range<const int>(cyclic_children, 2);
+    BlendTreeJob job;
+    job.nodes = nodes;
+    job.skeleton = skeleton;
+    job.cache = &cache;
+    job.output = output;
+    EXPECT_FALSE(job.Validate());
+    nodes[0].children = ozz::Range<const int>(children, 2);
+  }
+
+  {  // Out of range children indices.
+    const int out_children[] = {1, 3};
+    nodes[0].children = ozz::Range<const int>(out_children, 2);
+    BlendTreeJob job;
+    job.nodes = nodes;
+    job.skeleton = skeleton;
+    job.cache = &cache;
+    job.output = output;
+    EXPECT_FALSE(job.Validate());
+    nodes[0].children = ozz::Range<const int>(children, 2);
+  }
+
+  ozz::memory::default_allocator()->Delete(animation);
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+TEST(Evaluate, BlendTreeJob) {
+  Skeleton* skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton != NULL);
+  Animation* animations[4] = {BuildAnimation(2.f), BuildAnimation(4.f),
+                              BuildAnimation(8.f), BuildAnimation(1.f)};
+  SamplingCache sampling_caches[4];
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_TRUE(animations[i] != NULL);
+    sampling_caches[i].Resize(1);
+  }
+
+  // 0: blend {1, 2} + additive {3}
+  // 1: sample 2
+  // 2: blend {4, 5}
+  // 3: sample additive 1
+  // 4: sample 4
+  // 5: sample 8
+  BlendTreeJob::Node nodes[6];
+  const int root_children[] = {1, 2};
+  const int root_additive_children[] = {3};
+  const int blend_children[] = {4, 5};
+  nodes[0].type = BlendTreeJob::Node::kBlend;
+  nodes[0].children = ozz::Range<const int>(root_children, 2);
+  nodes[0].additive_children =
+      ozz::Range<const int>(root_additive_children, 1);
+  nodes[2].type = BlendTreeJob::Node::kBlend;
+  nodes[2].children = ozz::Range<const int>(blend_children, 2);
+  nodes[2].weight = 1.f;
+  const int samples[] = {1, 4, 5, 3};
+  for (int i = 0; i < 4; ++i) {
+    BlendTreeJob::Node& node = nodes[samples[i]];
+    node.weight = 1.f;
+    node.animation = animations[i];
+    node.sampling_cache = &sampling_caches[i];
+  }
+  nodes[4].weight = .5f;
+
+  // Root needs 3 buffers, plus 2 for the nested blend node.
+  BlendTreeCache cache(skeleton->num_joints(), 5);
+  ozz::math::SoaTransform output[1];
+
+  BlendTreeJob job;
+  job.nodes = nodes;
+  job.skeleton = skeleton;
+  job.cache = &cache;
+  job.output = output;
+  EXPECT_EQ(job.RequiredBuffers(), 5);
+
+  {  // All nodes.
+    ASSERT_TRUE(job.Run());
+    EXPECT_SOAFLOAT3_EQ_EST(output[0].translation, 5.333333f, 0.f, 0.f, 0.f,
+                            0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+  }
+
+  {  // Pruned branch isn't sampled, even with an invalid sampling cache.
+    SamplingCache empty_cache;
+    nodes[5].weight = 0.f;
+    nodes[5].sampling_cache = &empty_cache;
+    ASSERT_TRUE(job.Run());
+    EXPECT_SOAFLOAT3_EQ_EST(output[0].translation, 4.f, 0.f, 0.f, 0.f, 0.f,
+                            0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+
+    // Fails as soon as the branch is evaluated.
+    nodes[5].weight = 1.f;
+    EXPECT_FALSE(job.Run());
+    nodes[5].sampling_cache = &sampling_caches[2];
+  }
+
+  {  // Pruned additive node.
+    nodes[3].weight = 0.f;
+    ASSERT_TRUE(job.Run());
+    EXPECT_SOAFLOAT3_EQ_EST(output[0].translation, 4.333333f, 0.f, 0.f, 0.f,
+                            0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+  }
+
+  {  // All children pruned, falls back to bind pose.
+    nodes[1].weight = 0.f;
+    nodes[2].weight = 0.f;
+    ASSERT_TRUE(job.Run());
+    EXPECT_SOAFLOAT3_EQ_EST(output[0].translation, 0.f, 0.f, 0.f, 0.f, 0.f,
+                            0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+  }
+
+  for (int i = 0; i < 4; ++i) {
+    ozz::memory::default_allocator()->Delete(animations[i]);
+  }
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
@@ -30,6 +30,7 @@
 #include "gtest/gtest.h"
 #include "ozz/base/maths/gtest_math_helper.h"
 
+#include "ozz/base/maths/soa_half_transform.h"
 #include "ozz/base/maths/soa_transform.h"
 
 using ozz::animation::BlendingJob;
@@ -44,6 +45,9 @@ TEST(JobValidity, BlendingJob) {
   ozz::math::SoaTransform output_transforms[3] = {identity, identity, identity};
   ozz::math::SimdFloat4 joint_weights[3] = {zero, zero, zero};
 
+  // Only contributing layers are validated.
+  layers[0].weight = 1.f;
+  layers[1].weight = 1.f;
   layers[0].transform.begin = input_transforms;
   layers[0].transform.end = input_transforms + 3;
   layers[1].transform.begin = input_transforms;
@@ -110,6 +114,8 @@ TEST(JobValidity, BlendingJob) {
   }
   {  // Invalid layer input range, too small.
     BlendingJob::Layer invalid_layers[2];
+    invalid_layers[0].weight = 1.f;
+    invalid_layers[1].weight = 1.f;
     invalid_layers[0].transform.begin = input_transforms;
     invalid_layers[0].transform.end = input_transforms + 1;
     invalid_layers[1].transform.begin = input_transforms;
@@ -127,6 +133,7 @@ TEST(JobValidity, BlendingJob) {
   }
   {  // Invalid layer input range, NULL.
     BlendingJob::Layer invalid_layers[1];
+    invalid_layers[0].weight = 1.f;
     invalid_layers[0].transform.begin = NULL;
     invalid_layers[0].transform.end = input_transforms + 2;
 
@@ -142,6 +149,7 @@ TEST(JobValidity, BlendingJob) {
   }
   {  // Invalid layer input range, NULL.
     BlendingJob::Layer invalid_layers[1];
+    invalid_layers[0].weight = 1.f;
     invalid_layers[0].transform.begin = input_transforms;
     invalid_layers[0].transform.end = NULL;
 
@@ -292,6 +300,81 @@ TEST(JobValidity, BlendingJob) {
     EXPECT_TRUE(job.Run());
   }
 
+  {  // Invalid joint indices without joint weights.
+    const int joint_indices[1] = {1};
+    layers[0].joint_weights.begin = NULL;
+    layers[0].joint_weights.end = NULL;
+    layers[0].joint_indices.begin = joint_indices;
+    layers[0].joint_indices.end = joint_indices + 1;
+
+    BlendingJob job;
+    job.layers.begin = layers;
+    job.layers.end = layers + 2;
+    job.bind_pose.begin = bind_poses;
+    job.bind_pose.end = bind_poses + 2;
+    job.output.begin = output_transforms;
+    job.output.end = output_transforms + 2;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Invalid joint indices size.
+    const int joint_indices[2] = {0, 1};
+    layers[0].joint_weights.begin = joint_weights;
+    layers[0].joint_weights.end = joint_weights + 1;
+    layers[0].joint_indices.begin = joint_indices;
+    layers[0].joint_indices.end = joint_indices + 2;
+
+    BlendingJob job;
+    job.layers.begin = layers;
+    job.layers.end = layers + 2;
+    job.bind_pose.begin = bind_poses;
+    job.bind_pose.end = bind_poses + 2;
+    job.output.begin = output_transforms;
+    job.output.end = output_transforms + 2;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Invalid unsorted joint indices.
+    const int joint_indices[2] = {1, 0};
+    layers[0].joint_weights.begin = joint_weights;
+    layers[0].joint_weights.end = joint_weights + 2;
+    layers[0].joint_indices.begin = joint_indices;
+    layers[0].joint_indices.end = joint_indices + 2;
+
+    BlendingJob job;
+    job.layers.begin = layers;
+    job.layers.end = layers + 2;
+    job.bind_pose.begin = bind_poses;
+    job.bind_pose.end = bind_poses + 2;
+    job.output.begin = output_transforms;
+    job.output.end = output_transforms + 2;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Valid sparse joint weights, smaller than the bind pose.
+    const int joint_indices[1] = {1};
+    layers[0].joint_weights.begin = joint_weights;
+    layers[0].joint_weights.end = joint_weights + 1;
+    layers[0].joint_indices.begin = joint_indices;
+    layers[0].joint_indices.end = joint_indices + 1;
+
+    BlendingJob job;
+    job.layers.begin = layers;
+    job.layers.end = layers + 2;
+    job.bind_pose.begin = bind_poses;
+    job.bind_pose.end = bind_poses + 2;
+    job.output.begin = output_transforms;
+    job.output.end = output_transforms + 2;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+
+    layers[0].joint_indices.begin = NULL;
+    layers[0].joint_indices.end = NULL;
+  }
+
   {  // Valid no layers.
     BlendingJob job;
     job.bind_pose.begin = bind_poses;
@@ -320,6 +403,11 @@ TEST(JobValidityAdditive, BlendingJob) {
   layers[1].transform.begin = input_transforms;
   layers[1].transform.end = input_transforms + 3;
 
+  // Only contributing layers are validated.
+  layers[0].weight = 1.f;
+  layers[1].weight = 1.f;
+  additive_layers[0].weight = 1.f;
+  additive_layers[1].weight = 1.f;
   additive_layers[0].transform.begin = input_transforms;
   additive_layers[0].transform.end = input_transforms + 3;
   additive_layers[1].transform.begin = input_transforms;
@@ -384,6 +472,8 @@ TEST(JobValidityAdditive, BlendingJob) {
 
   {  // Invalid layer input range, too small.
     BlendingJob::Layer invalid_layers[2];
+    invalid_layers[0].weight = 1.f;
+    invalid_layers[1].weight = 1.f;
     invalid_layers[0].transform.begin = input_transforms;
     invalid_layers[0].transform.end = input_transforms + 1;
     invalid_layers[1].transform.begin = input_transforms;
@@ -656,6 +746,116 @@ TEST(JointWeights, BlendingJob) {
   }
 }
 
+TEST(SparseJointWeights, BlendingJob) {
+  const ozz::math::SoaTransform identity = ozz::math::SoaTransform::identity();
+
+  // Initialize inputs.
+  ozz::math::SoaTransform input_transforms[2][3] = {
+      {identity, identity, identity}, {identity, identity, identity}};
+  ozz::math::SoaTransform additive_transforms[3] = {identity, identity,
+                                                    identity};
+  ozz::math::SoaTransform bind_poses[3] = {identity, identity, identity};
+  for (int i = 0; i < 3; ++i) {
+    input_transforms[0][i].translation = ozz::math::SoaFloat3::Load(
+        ozz::math::simd_float4::Load1(2.f), ozz::math::simd_float4::Load1(2.f),
+        ozz::math::simd_float4::Load1(2.f));
+    input_transforms[1][i].translation = ozz::math::SoaFloat3::Load(
+        ozz::math::simd_float4::Load1(4.f), ozz::math::simd_float4::Load1(4.f),
+        ozz::math::simd_float4::Load1(4.f));
+    additive_transforms[i].translation = ozz::math::SoaFloat3::Load(
+        ozz::math::simd_float4::Load1(1.f), ozz::math::simd_float4::Load1(1.f),
+        ozz::math::simd_float4::Load1(1.f));
+    bind_poses[i].translation = ozz::math::SoaFloat3::Load(
+        ozz::math::simd_float4::Load1(1.f), ozz::math::simd_float4::Load1(1.f),
+        ozz::math::simd_float4::Load1(1.f));
+  }
+
+  // Second layer only affects SoA joint 1.
+  const int joint_indices[1] = {1};
+  const ozz::math::SimdFloat4 joint_weights[1] = {
+      ozz::math::simd_float4::Load(1.f, 0.f, .5f, 1.f)};
+  BlendingJob::Layer layers[2];
+  layers[0].transform = input_transforms[0];
+  layers[1].transform = input_transforms[1];
+  layers[1].joint_weights = joint_weights;
+  layers[1].joint_indices = joint_indices;
+
+  // Additive layer only affects SoA joint 2.
+  const int additive_joint_indices[1] = {2};
+  const ozz::math::SimdFloat4 additive_joint_weights[1] = {
+      ozz::math::simd_float4::one()};
+  BlendingJob::Layer additive_layers[1];
+  additive_layers[0].transform = additive_transforms;
+  additive_layers[0].joint_weights = additive_joint_weights;
+  additive_layers[0].joint_indices = additive_joint_indices;
+
+  {  // Both layers, untouched joints only receive the full layer.
+    ozz::math::SoaTransform output_transforms[3];
+
+    BlendingJob job;
+    job.layers = layers;
+    job.bind_pose = bind_poses;
+    job.output = output_transforms;
+
+    layers[0].weight = 1.f;
+    layers[1].weight = 1.f;
+
+    EXPECT_TRUE(job.Run());
+
+    EXPECT_SOAFLOAT3_EQ(output_transforms[0].translation, 2.f, 2.f, 2.f, 2.f,
+                        2.f, 2.f, 2.f, 2.f, 2.f, 2.f, 2.f, 2.f);
+    EXPECT_SOAFLOAT3_EQ_EST(output_transforms[1].translation, 3.f, 2.f,
+                            2.666667f, 3.f, 3.f, 2.f, 2.666667f, 3.f, 3.f, 2.f,
+                            2.666667f, 3.f);
+    EXPECT_SOAFLOAT3_EQ(output_transforms[2].translation, 2.f, 2.f, 2.f, 2.f,
+                        2.f, 2.f, 2.f, 2.f, 2.f, 2.f, 2.f, 2.f);
+  }
+
+  {  // Sparse layer only, untouched joints fall back to the bind pose.
+    ozz::math::SoaTransform output_transforms[3];
+
+    BlendingJob job;
+    job.layers = layers;
+    job.bind_pose = bind_poses;
+    job.output = output_transforms;
+
+    layers[0].weight = 0.f;
+    layers[1].weight = 1.f;
+
+    EXPECT_TRUE(job.Run());
+
+    EXPECT_SOAFLOAT3_EQ_EST(output_transforms[0].translation, 1.f, 1.f, 1.f,
+                            1.f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f);
+    EXPECT_SOAFLOAT3_EQ_EST(output_transforms[1].translation, 4.f, 1.f, 4.f,
+                            4.f, 4.f, 1.f, 4.f, 4.f, 4.f, 1.f, 4.f, 4.f);
+    EXPECT_SOAFLOAT3_EQ_EST(output_transforms[2].translation, 1.f, 1.f, 1.f,
+                            1.f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f);
+  }
+
+  {  // Sparse additive layer.
+    ozz::math::SoaTransform output_transforms[3];
+
+    BlendingJob job;
+    job.layers = layers;
+    job.additive_layers = additive_layers;
+    job.bind_pose = bind_poses;
+    job.output = output_transforms;
+
+    layers[0].weight = 1.f;
+    layers[1].weight = 0.f;
+    additive_layers[0].weight = 1.f;
+
+    EXPECT_TRUE(job.Run());
+
+    EXPECT_SOAFLOAT3_EQ(output_transforms[0].translation, 2.f, 2.f, 2.f, 2.f,
+                        2.f, 2.f, 2.f, 2.f, 2.f, 2.f, 2.f, 2.f);
+    EXPECT_SOAFLOAT3_EQ(output_transforms[1].translation, 2.f, 2.f, 2.f, 2.f,
+                        2.f, 2.f, 2.f, 2.f, 2.f, 2.f, 2.f, 2.f);
+    EXPECT_SOAFLOAT3_EQ(output_transforms[2].translation, 3.f, 3.f, 3.f, 3.f,
+                        3.f, 3.f, 3.f, 3.f, 3.f, 3.f, 3.f, 3.f);
+  }
+}
+
 TEST(Normalize, BlendingJob) {
   const ozz::math::SoaTransform identity = ozz::math::SoaTransform::identity();
 
@@ -864,6 +1064,198 @@ TEST(Threshold, BlendingJob) {
   }
 }
 
+TEST(WeightEpsilon, BlendingJob) {
+  const ozz::math::SoaTransform identity = ozz::math::SoaTransform::identity();
+
+  // Initialize inputs.
+  ozz::math::SoaTransform input_transforms[1] = {identity};
+  input_transforms[0].translation = ozz::math::SoaFloat3::Load(
+      ozz::math::simd_float4::Load(0.f, 1.f, 2.f, 3.f),
+      ozz::math::simd_float4::Load(4.f, 5.f, 6.f, 7.f),
+      ozz::math::simd_float4::Load(8.f, 9.f, 10.f, 11.f));
+  const ozz::math::SoaTransform bind_poses[1] = {identity};
+
+  // Decayed layers don't provide any transform.
+  BlendingJob::Layer layers[2];
+  layers[0].weight = 1.f;
+  layers[0].transform = input_transforms;
+  layers[1].weight = .005f;
+  BlendingJob::Layer additive_layers[1];
+  additive_layers[0].weight = -.005f;
+
+  ozz::math::SoaTransform output_transforms[1];
+
+  BlendingJob job;
+  job.layers = layers;
+  job.additive_layers = additive_layers;
+  job.bind_pose = bind_poses;
+  job.output = output_transforms;
+
+  // Decayed layers contribute by default.
+  EXPECT_TRUE(job.IsLayerContributing(layers[1].weight));
+  EXPECT_TRUE(job.IsAdditiveLayerContributing(additive_layers[0].weight));
+  EXPECT_FALSE(job.IsLayerContributing(0.f));
+  EXPECT_FALSE(job.IsAdditiveLayerContributing(0.f));
+  EXPECT_FALSE(job.Validate());
+
+  // Negative epsilon is invalid.
+  job.weight_epsilon = -.01f;
+  EXPECT_FALSE(job.Validate());
+
+  // Decayed layers are culled, so they don't need valid transforms.
+  job.weight_epsilon = .01f;
+  EXPECT_TRUE(job.IsLayerContributing(layers[0].weight));
+  EXPECT_FALSE(job.IsLayerContributing(layers[1].weight));
+  EXPECT_FALSE(job.IsAdditiveLayerContributing(additive_layers[0].weight));
+  EXPECT_TRUE(job.IsAdditiveLayerContributing(-.02f));
+  ASSERT_TRUE(job.Validate());
+  ASSERT_TRUE(job.Run());
+
+  EXPECT_SOAFLOAT3_EQ(output_transforms[0].translation, 0.f, 1.f, 2.f, 3.f, 4.f,
+                      5.f, 6.f, 7.f, 8.f, 9.f, 10.f, 11.f);
+  EXPECT_SOAQUATERNION_EQ_EST(output_transforms[0].rotation, 0.f, 0.f, 0.f,
+                              0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 1.f,
+                              1.f, 1.f, 1.f);
+  EXPECT_SOAFLOAT3_EQ(output_transforms[0].scale, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f,
+                      1.f, 1.f, 1.f, 1.f, 1.f, 1.f);
+}
+
+TEST(Quality, BlendingJob) {
+  const ozz::math::SoaTransform identity = ozz::math::SoaTransform::identity();
+
+  // Initialize inputs, second layer is rotated by 90 degrees around x.
+  ozz::math::SoaTransform input_transforms[2][1] = {{identity}, {identity}};
+  input_transforms[1][0].rotation = ozz::math::SoaQuaternion::Load(
+      ozz::math::simd_float4::Load1(.70710677f),
+      ozz::math::simd_float4::zero(), ozz::math::simd_float4::zero(),
+      ozz::math::simd_float4::Load1(.70710677f));
+  const ozz::math::SoaTransform bind_poses[1] = {identity};
+
+  BlendingJob::Layer layers[2];
+  layers[0].weight = .5f;
+  layers[0].transform = input_transforms[0];
+  layers[1].weight = .5f;
+  layers[1].transform = input_transforms[1];
+
+  ozz::math::SoaTransform output_transforms[1];
+
+  BlendingJob job;
+  job.layers = layers;
+  job.bind_pose = bind_poses;
+  job.output = output_transforms;
+  EXPECT_EQ(job.quality, BlendingJob::kStandard);
+
+  {  // Standard quality.
+    ASSERT_TRUE(job.Run());
+    EXPECT_SOAQUATERNION_EQ_EST(
+        output_transforms[0].rotation, .3826834f, .3826834f, .3826834f,
+        .3826834f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, .9238795f,
+        .9238795f, .9238795f, .9238795f);
+  }
+
+  {  // Fast quality.
+    job.quality = BlendingJob::kFast;
+    ASSERT_TRUE(job.Run());
+    EXPECT_SOAQUATERNION_EQ_EST(
+        output_transforms[0].rotation, .3826834f, .3826834f, .3826834f,
+        .3826834f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, .9238795f,
+        .9238795f, .9238795f, .9238795f);
+  }
+
+  {  // Accurate quality.
+    job.quality = BlendingJob::kAccurate;
+    ASSERT_TRUE(job.Run());
+    EXPECT_SOAQUATERNION_EQ(output_transforms[0].rotation, .3826834f,
+                            .3826834f, .3826834f, .3826834f, 0.f, 0.f, 0.f,
+                            0.f, 0.f, 0.f, 0.f, 0.f, .9238795f, .9238795f,
+                            .9238795f, .9238795f);
+  }
+}
+
+TEST(Resume, BlendingJob) {
+  const ozz::math::SoaTransform identity = ozz::math::SoaTransform::identity();
+
+  // Initializes 5 soa joints, with partial joint weights and an additive layer.
+  const int kNumSoaJoints = 5;
+  ozz::math::SoaTransform input_transforms[2][kNumSoaJoints];
+  ozz::math::SoaTransform additive_transforms[kNumSoaJoints];
+  ozz::math::SimdFloat4 joint_weights[kNumSoaJoints];
+  ozz::math::SoaTransform bind_poses[kNumSoaJoints];
+  for (int i = 0; i < kNumSoaJoints; ++i) {
+    const float f = static_cast<float>(i);
+    input_transforms[0][i] = identity;
+    input_transforms[0][i].translation = ozz::math::SoaFloat3::Load(
+        ozz::math::simd_float4::Load(f, 1.f, 2.f, 3.f),
+        ozz::math::simd_float4::Load1(f * 2.f),
+        ozz::math::simd_float4::zero());
+    input_transforms[1][i] = identity;
+    input_transforms[1][i].rotation = ozz::math::SoaQuaternion::Load(
+        ozz::math::simd_float4::Load1(.70710677f),
+        ozz::math::simd_float4::zero(), ozz::math::simd_float4::zero(),
+        ozz::math::simd_float4::Load1(.70710677f));
+    additive_transforms[i] = identity;
+    additive_transforms[i].translation = ozz::math::SoaFloat3::Load(
+        ozz::math::simd_float4::one(), ozz::math::simd_float4::zero(),
+        ozz::math::simd_float4::Load1(f));
+    joint_weights[i] = ozz::math::simd_float4::Load(f * .1f, .5f, 1.f, 0.f);
+    bind_poses[i] = identity;
+  }
+
+  BlendingJob::Layer layers[2];
+  layers[0].weight = .6f;
+  layers[0].transform = input_transforms[0];
+  layers[1].weight = .4f;
+  layers[1].transform = input_transforms[1];
+  layers[1].joint_weights = joint_weights;
+  BlendingJob::Layer additive_layers[1];
+  additive_layers[0].weight = .5f;
+  additive_layers[0].transform = additive_transforms;
+
+  ozz::math::SoaTransform expected[kNumSoaJoints];
+  BlendingJob job;
+  job.layers = layers;
+  job.additive_layers = additive_layers;
+  job.bind_pose = bind_poses;
+  job.output = expected;
+  ASSERT_TRUE(job.Run());
+
+  ozz::math::SoaTransform output[kNumSoaJoints];
+  job.output = output;
+
+  {  // Invalid arguments.
+    int cursor = 0;
+    EXPECT_FALSE(job.Resume(NULL, 1));
+    EXPECT_FALSE(job.Resume(&cursor, 0));
+    cursor = -1;
+    EXPECT_FALSE(job.Resume(&cursor, 1));
+    cursor = kNumSoaJoints + 1;
+    EXPECT_FALSE(job.Resume(&cursor, 1));
+    EXPECT_EQ(cursor, kNumSoaJoints + 1);
+
+    BlendingJob invalid;
+    cursor = 0;
+    EXPECT_FALSE(invalid.Resume(&cursor, 1));
+    EXPECT_EQ(cursor, 0);
+  }
+
+  // Resumes 2 soa joints at a time.
+  memset(output, 0, sizeof(output));
+  int cursor = 0;
+  ASSERT_TRUE(job.Resume(&cursor, 2));
+  EXPECT_EQ(cursor, 2);
+  EXPECT_EQ(memcmp(output, expected, sizeof(output[0]) * 2), 0);
+  EXPECT_NE(memcmp(output + 2, expected + 2, sizeof(output[0])), 0);
+  ASSERT_TRUE(job.Resume(&cursor, 2));
+  EXPECT_EQ(cursor, 4);
+  ASSERT_TRUE(job.Resume(&cursor, 2));
+  EXPECT_EQ(cursor, kNumSoaJoints);
+  EXPECT_EQ(memcmp(output, expected, sizeof(output)), 0);
+
+  // Resuming a complete job does nothing.
+  ASSERT_TRUE(job.Resume(&cursor, 2));
+  EXPECT_EQ(cursor, kNumSoaJoints);
+}
+
 TEST(AdditiveWeight, BlendingJob) {
   const ozz::math::SoaTransform identity = ozz::math::SoaTransform::identity();
 
@@ -1086,3 +1478,412 @@ TEST(AdditiveJointWeight, BlendingJob) {
                             1.f / 20.f, 1.f / 11.f, 1.f, 1.f);
   }
 }
+
+TEST(SparseAdditive, BlendingJob) {
+  const ozz::math::SoaTransform identity = ozz::math::SoaTransform::identity();
+
+  // Initialize sparse inputs, for the 2nd SoA joint only.
+  ozz::math::SoaTransform input_transforms[1] = {identity};
+  input_transforms[0].translation = ozz::math::SoaFloat3::Load(
+      ozz::math::simd_float4::Load(0.f, 1.f, 2.f, 3.f),
+      ozz::math::simd_float4::Load(4.f, 5.f, 6.f, 7.f),
+      ozz::math::simd_float4::Load(8.f, 9.f, 10.f, 11.f));
+  input_transforms[0].rotation = ozz::math::SoaQuaternion::Load(
+      ozz::math::simd_float4::Load(.70710677f, 0.f, 0.f, .382683432f),
+      ozz::math::simd_float4::Load(0.f, 0.f, .70710677f, 0.f),
+      ozz::math::simd_float4::Load(0.f, 0.f, 0.f, 0.f),
+      ozz::math::simd_float4::Load(.70710677f, 1.f, -.70710677f, .9238795f));
+  input_transforms[0].scale = ozz::math::SoaFloat3::Load(
+      ozz::math::simd_float4::Load(12.f, 13.f, 14.f, 15.f),
+      ozz::math::simd_float4::Load(16.f, 17.f, 18.f, 19.f),
+      ozz::math::simd_float4::Load(20.f, 21.f, 22.f, 23.f));
+  const int transform_indices[1] = {1};
+  ozz::math::SimdFloat4 joint_weights[1] = {
+      ozz::math::simd_float4::Load(1.f, .5f, 0.f, -1.f)};
+
+  // Initialize bind pose.
+  ozz::math::SoaTransform bind_poses[3] = {identity, identity, identity};
+
+  {  // Validity.
+    BlendingJob::Layer layers[1];
+    layers[0].weight = 1.f;
+    layers[0].transform = input_transforms;
+    layers[0].transform_indices = transform_indices;
+
+    ozz::math::SoaTransform output_transforms[3];
+
+    BlendingJob job;
+    job.additive_layers = layers;
+    job.bind_pose = bind_poses;
+    job.output = output_transforms;
+    EXPECT_TRUE(job.Validate());
+
+    // Only additive layers can be sparse.
+    job.layers = layers;
+    EXPECT_FALSE(job.Validate());
+    job.layers = ozz::Range<const BlendingJob::Layer>();
+
+    // Transform is too small.
+    layers[0].transform = ozz::Range<const ozz::math::SoaTransform>(
+        input_transforms, static_cast<size_t>(0));
+    EXPECT_FALSE(job.Validate());
+    layers[0].transform = input_transforms;
+
+    // Joint weights are too small.
+    layers[0].joint_weights = ozz::Range<const ozz::math::SimdFloat4>(
+        joint_weights, static_cast<size_t>(0));
+    EXPECT_FALSE(job.Validate());
+    layers[0].joint_weights = joint_weights;
+    EXPECT_TRUE(job.Validate());
+
+    // Joint indices can't be used along with transform indices.
+    layers[0].joint_indices = transform_indices;
+    EXPECT_FALSE(job.Validate());
+    layers[0].joint_indices = ozz::Range<const int>();
+
+    // Indices aren't sorted.
+    const int unsorted_indices[2] = {2, 1};
+    ozz::math::SoaTransform two_transforms[2] = {identity, identity};
+    ozz::math::SimdFloat4 two_weights[2] = {joint_weights[0],
+                                            joint_weights[0]};
+    layers[0].transform = two_transforms;
+    layers[0].joint_weights = two_weights;
+    layers[0].transform_indices = unsorted_indices;
+    EXPECT_FALSE(job.Validate());
+  }
+
+  {  // Only the listed joint is affected.
+    BlendingJob::Layer layers[1];
+    layers[0].transform = input_transforms;
+    layers[0].transform_indices = transform_indices;
+
+    ozz::math::SoaTransform output_transforms[3];
+
+    BlendingJob job;
+    job.additive_layers = layers;
+    job.bind_pose = bind_poses;
+    job.output = output_transforms;
+
+    layers[0].weight = 1.f;
+    EXPECT_TRUE(job.Run());
+
+    for (int i = 0; i < 3; i += 2) {
+      EXPECT_SOAFLOAT3_EQ(output_transforms[i].translation, 0.f, 0.f, 0.f, 0.f,
+                          0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+      EXPECT_SOAQUATERNION_EQ_EST(output_transforms[i].rotation, 0.f, 0.f, 0.f,
+                                  0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f,
+                                  1.f, 1.f, 1.f, 1.f);
+      EXPECT_SOAFLOAT3_EQ(output_transforms[i].scale, 1.f, 1.f, 1.f, 1.f, 1.f,
+                          1.f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f);
+    }
+    EXPECT_SOAFLOAT3_EQ(output_transforms[1].translation, 0.f, 1.f, 2.f, 3.f,
+                        4.f, 5.f, 6.f, 7.f, 8.f, 9.f, 10.f, 11.f);
+    EXPECT_SOAQUATERNION_EQ_EST(output_transforms[1].rotation, .70710677f, 0.f,
+                                0.f, .382683432f, 0.f, 0.f, -.70710677f, 0.f,
+                                0.f, 0.f, 0.f, 0.f, .70710677f, 1.f, .70710677f,
+                                .9238795f);
+    EXPECT_SOAFLOAT3_EQ(output_transforms[1].scale, 12.f, 13.f, 14.f, 15.f,
+                        16.f, 17.f, 18.f, 19.f, 20.f, 21.f, 22.f, 23.f);
+
+    // Sparse joint weights are indexed like transforms.
+    layers[0].joint_weights = joint_weights;
+    EXPECT_TRUE(job.Run());
+    EXPECT_SOAFLOAT3_EQ(output_transforms[1].translation, 0.f, .5f, 0.f, 0.f,
+                        4.f, 2.5f, 0.f, 0.f, 8.f, 4.5f, 0.f, 0.f);
+    EXPECT_SOAFLOAT3_EQ(output_transforms[2].translation, 0.f, 0.f, 0.f, 0.f,
+                        0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+
+    // Subtract layer.
+    layers[0].weight = -1.f;
+    EXPECT_TRUE(job.Run());
+    EXPECT_SOAFLOAT3_EQ(output_transforms[1].translation, -0.f, -.5f, 0.f, 0.f,
+                        -4.f, -2.5f, 0.f, 0.f, -8.f, -4.5f, 0.f, 0.f);
+    EXPECT_SOAFLOAT3_EQ(output_transforms[0].translation, 0.f, 0.f, 0.f, 0.f,
+                        0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+  }
+}
+
+TEST(ManySparseLayers, BlendingJob) {
+  const ozz::math::SoaTransform identity = ozz::math::SoaTransform::identity();
+
+  // The maximum number of sparse layers, each one adding a unit translation to
+  // the listed joints. A dense layer, adding a unit translation to all joints,
+  // is interleaved, and a last sparse layer doesn't contribute.
+  const int kNumSparse = BlendingJob::kMaxSparseLayers;
+  const int kDense = kNumSparse / 2;
+  ozz::math::SoaTransform input_transforms[5] = {identity, identity, identity,
+                                                 identity, identity};
+  for (int i = 0; i < 5; ++i) {
+    input_transforms[i].translation = ozz::math::SoaFloat3::one();
+  }
+  const int transform_indices[2] = {1, 3};
+  BlendingJob::Layer layers[kNumSparse + 2];
+  for (int i = 0; i < kNumSparse + 2; ++i) {
+    layers[i].weight = 1.f;
+    layers[i].transform = input_transforms;
+    if (i != kDense) {
+      layers[i].transform_indices = transform_indices;
+    }
+  }
+  layers[kNumSparse + 1].weight = 0.f;
+
+  ozz::math::SoaTransform bind_poses[5] = {identity, identity, identity,
+                                           identity, identity};
+  ozz::math::SoaTransform output_transforms[5];
+
+  BlendingJob job;
+  job.additive_layers = layers;
+  job.bind_pose = bind_poses;
+  job.output = output_transforms;
+
+  // Run, and resume one joint at a time, so that cursors are seeked from every
+  // joint.
+  for (int pass = 0; pass < 2; ++pass) {
+    if (pass == 0) {
+      EXPECT_TRUE(job.Run());
+    } else {
+      for (int cursor = 0; cursor < 5;) {
+        EXPECT_TRUE(job.Resume(&cursor, 1));
+      }
+    }
+    for (int i = 0; i < 5; ++i) {
+      const float t = (i == 1 || i == 3) ? kNumSparse + 1.f : 1.f;
+      EXPECT_SOAFLOAT3_EQ(output_transforms[i].translation, t, t, t, t, t, t,
+                          t, t, t, t, t, t);
+      EXPECT_SOAFLOAT3_EQ(output_transforms[i].scale, 1.f, 1.f, 1.f, 1.f, 1.f,
+                          1.f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f);
+    }
+  }
+
+  // One more contributing sparse layer exceeds the limit.
+  layers[kNumSparse + 1].weight = 1.f;
+  EXPECT_FALSE(job.Validate());
+  EXPECT_FALSE(job.Run());
+
+  // Sparse layers are counted over layers and additive layers.
+  layers[kNumSparse + 1].weight = 0.f;
+  EXPECT_TRUE(job.Validate());
+  const ozz::math::SimdFloat4 joint_weights[1] = {
+      ozz::math::simd_float4::one()};
+  const int joint_indices[1] = {2};
+  BlendingJob::Layer layer;
+  layer.weight = 1.f;
+  layer.transform = input_transforms;
+  layer.joint_weights = joint_weights;
+  layer.joint_indices = joint_indices;
+  job.layers = ozz::make_range(layer);
+  EXPECT_FALSE(job.Validate());
+}
+
+TEST(UnitAdditive, BlendingJob) {
+  const ozz::math::SoaTransform identity = ozz::math::SoaTransform::identity();
+
+  // Initialize a normalized base pose and 3 additive layers.
+  ozz::math::SoaTransform base[2] = {identity, identity};
+  ozz::math::SoaTransform additives[3][2];
+  for (int j = 0; j < 2; ++j) {
+    base[j].translation = ozz::math::SoaFloat3::Load(
+        ozz::math::simd_float4::Load(1.f, 2.f, 3.f, 4.f),
+        ozz::math::simd_float4::Load(-1.f, 0.f, 1.f, 2.f),
+        ozz::math::simd_float4::Load(5.f, 6.f, 7.f, 8.f));
+    base[j].rotation = ozz::math::SoaQuaternion::Load(
+        ozz::math::simd_float4::Load(.70710677f, 0.f, 0.f, .382683432f),
+        ozz::math::simd_float4::Load(0.f, 0.f, .70710677f, 0.f),
+        ozz::math::simd_float4::Load(0.f, 0.f, 0.f, 0.f),
+        ozz::math::simd_float4::Load(.70710677f, 1.f, .70710677f, .9238795f));
+    for (int l = 0; l < 3; ++l) {
+      const float f = static_cast<float>(l + 1);
+      additives[l][j] = identity;
+      additives[l][j].translation = ozz::math::SoaFloat3::Load(
+          ozz::math::simd_float4::Load(f, -f, 0.f, j * f),
+          ozz::math::simd_float4::Load(0.f, f, 2.f * f, 0.f),
+          ozz::math::simd_float4::Load(-f, 0.f, f, 1.f));
+      // Last layer has negative w, to test quaternion sign fix up.
+      const float s = l == 2 ? -1.f : 1.f;
+      additives[l][j].rotation = ozz::math::SoaQuaternion::Load(
+          ozz::math::simd_float4::Load(0.f, .382683432f * s, 0.f, 0.f),
+          ozz::math::simd_float4::Load(.382683432f * s, 0.f, 0.f, 0.f),
+          ozz::math::simd_float4::Load(0.f, 0.f, .382683432f * s, 0.f),
+          ozz::math::simd_float4::Load(.9238795f * s, .9238795f * s,
+                                       .9238795f * s, 1.f * s));
+      additives[l][j].scale = ozz::math::SoaFloat3::Load(
+          ozz::math::simd_float4::Load(f, 1.f, .5f, 2.f),
+          ozz::math::simd_float4::Load(1.f, f, 1.f, 1.f),
+          ozz::math::simd_float4::Load(1.f, 1.f, f, .5f));
+    }
+  }
+
+  BlendingJob::Layer layers[1];
+  layers[0].weight = 1.f;
+  layers[0].transform = base;
+
+  // Unit joint weights disable the fast path, without changing the result.
+  const ozz::math::SimdFloat4 unit_weights[2] = {
+      ozz::math::simd_float4::one(), ozz::math::simd_float4::one()};
+
+  BlendingJob::Layer additive_layers[4];
+  for (int l = 0; l < 3; ++l) {
+    additive_layers[l].weight = 1.f;
+    additive_layers[l].transform = additives[l];
+  }
+  // Non contributing layers don't disable the fast path.
+  additive_layers[3].weight = 0.f;
+
+  ozz::math::SoaTransform fast[2];
+  ozz::math::SoaTransform generic[2];
+
+  BlendingJob job;
+  job.layers = layers;
+  job.additive_layers = additive_layers;
+  job.bind_pose = base;
+  job.quality = BlendingJob::kAccurate;
+
+  job.output = fast;
+  ASSERT_TRUE(job.Run());
+
+  additive_layers[1].joint_weights = unit_weights;
+  job.output = generic;
+  ASSERT_TRUE(job.Run());
+
+  for (int j = 0; j < 2; ++j) {
+    const ozz::math::SoaFloat3& t = generic[j].translation;
+    const ozz::math::SoaQuaternion& r = generic[j].rotation;
+    const ozz::math::SoaFloat3& s = generic[j].scale;
+    float tf[3][4], rf[4][4], sf[3][4];
+    ozz::math::StorePtrU(t.x, tf[0]);
+    ozz::math::StorePtrU(t.y, tf[1]);
+    ozz::math::StorePtrU(t.z, tf[2]);
+    ozz::math::StorePtrU(r.x, rf[0]);
+    ozz::math::StorePtrU(r.y, rf[1]);
+    ozz::math::StorePtrU(r.z, rf[2]);
+    ozz::math::StorePtrU(r.w, rf[3]);
+    ozz::math::StorePtrU(s.x, sf[0]);
+    ozz::math::StorePtrU(s.y, sf[1]);
+    ozz::math::StorePtrU(s.z, sf[2]);
+    EXPECT_SOAFLOAT3_EQ(fast[j].translation, tf[0][0], tf[0][1], tf[0][2],
+                        tf[0][3], tf[1][0], tf[1][1], tf[1][2], tf[1][3],
+                        tf[2][0], tf[2][1], tf[2][2], tf[2][3]);
+    EXPECT_SOAQUATERNION_EQ_EST(fast[j].rotation, rf[0][0], rf[0][1], rf[0][2],
+                                rf[0][3], rf[1][0], rf[1][1], rf[1][2],
+                                rf[1][3], rf[2][0], rf[2][1], rf[2][2],
+                                rf[2][3], rf[3][0], rf[3][1], rf[3][2],
+                                rf[3][3]);
+    EXPECT_SOAFLOAT3_EQ_EST(fast[j].scale, sf[0][0], sf[0][1], sf[0][2],
+                            sf[0][3], sf[1][0], sf[1][1], sf[1][2], sf[1][3],
+                            sf[2][0], sf[2][1], sf[2][2], sf[2][3]);
+  }
+
+  // Translations are summed and scales multiplied.
+  EXPECT_SOAFLOAT3_EQ(fast[1].translation, 7.f, -4.f, 3.f, 10.f, -1.f, 6.f,
+                      13.f, 2.f, -1.f, 6.f, 13.f, 11.f);
+  EXPECT_SOAFLOAT3_EQ(fast[1].scale, 6.f, 1.f, .125f, 8.f, 1.f, 6.f, 1.f, 1.f,
+                      1.f, 1.f, 6.f, .125f);
+}
+
+TEST(HalfTransform, BlendingJob) {
+  const ozz::math::SoaTransform identity = ozz::math::SoaTransform::identity();
+
+  // Half and single precision layers blend the same, within half precision
+  // tolerance.
+  ozz::math::SoaTransform bind_pose[2] = {identity, identity};
+  ozz::math::SoaTransform transforms[3][2];
+  ozz::math::SoaHalfTransform half_transforms[3][2];
+  for (int l = 0; l < 3; ++l) {
+    for (int j = 0; j < 2; ++j) {
+      const float f = static_cast<float>(l + j + 1);
+      transforms[l][j].translation = ozz::math::SoaFloat3::Load(
+          ozz::math::simd_float4::Load(f, -f, .5f, 2.f),
+          ozz::math::simd_float4::Load(0.f, f * .25f, 2.f * f, -.125f),
+          ozz::math::simd_float4::Load(-f, 0.f, f, 1.f));
+      transforms[l][j].rotation = ozz::math::SoaQuaternion::Load(
+          ozz::math::simd_float4::Load(.5f, 0.f, 0.f, .6f),
+          ozz::math::simd_float4::Load(.5f, 0.f, .6f, 0.f),
+          ozz::math::simd_float4::Load(.5f, .6f, 0.f, 0.f),
+          ozz::math::simd_float4::Load(.5f, .8f, .8f, .8f));
+      transforms[l][j].scale = ozz::math::SoaFloat3::Load(
+          ozz::math::simd_float4::Load(f, 1.f, .5f, 2.f),
+          ozz::math::simd_float4::Load(1.f, f, 1.f, 1.f),
+          ozz::math::simd_float4::Load(1.f, 1.f, f, .5f));
+      half_transforms[l][j] = ozz::math::PackHalf(transforms[l][j]);
+    }
+  }
+  const ozz::math::SimdFloat4 joint_weights[2] = {
+      ozz::math::simd_float4::Load(1.f, .5f, 0.f, .25f),
+      ozz::math::simd_float4::Load(0.f, 1.f, .75f, 1.f)};
+  const int transform_indices[1] = {1};
+
+  BlendingJob::Layer layers[2];
+  layers[0].weight = .5f;
+  layers[1].weight = .75f;
+  layers[1].joint_weights = joint_weights;
+
+  BlendingJob::Layer additive_layers[2];
+  additive_layers[0].weight = .5f;
+  additive_layers[1].weight = -.25f;
+  additive_layers[1].transform_indices = transform_indices;
+
+  ozz::math::SoaTransform expected[2];
+  ozz::math::SoaTransform output[2];
+
+  BlendingJob job;
+  job.layers = layers;
+  job.additive_layers = additive_layers;
+  job.bind_pose = bind_pose;
+
+  // Single precision reference.
+  layers[0].transform = transforms[0];
+  layers[1].transform = transforms[1];
+  additive_layers[0].transform = transforms[2];
+  additive_layers[1].transform = ozz::make_range(transforms[0][0]);
+  job.output = expected;
+  ASSERT_TRUE(job.Run());
+
+  {  // Validation.
+    BlendingJob::Layer invalid_layers[2] = {layers[0], layers[1]};
+    BlendingJob invalid = job;
+    invalid.layers = invalid_layers;
+
+    // Both transforms can't be specified.
+    invalid_layers[0].half_transform = half_transforms[0];
+    EXPECT_FALSE(invalid.Validate());
+
+    // Half transforms too small.
+    invalid_layers[0].transform = ozz::Range<const ozz::math::SoaTransform>();
+    invalid_layers[0].half_transform.end = half_transforms[0] + 1;
+    EXPECT_FALSE(invalid.Validate());
+    invalid_layers[0].half_transform.end = half_transforms[0] + 2;
+    EXPECT_TRUE(invalid.Validate());
+  }
+
+  // Half precision layers.
+  layers[0].transform = ozz::Range<const ozz::math::SoaTransform>();
+  layers[0].half_transform = half_transforms[0];
+  layers[1].transform = ozz::Range<const ozz::math::SoaTransform>();
+  layers[1].half_transform = half_transforms[1];
+  additive_layers[0].transform = ozz::Range<const ozz::math::SoaTransform>();
+  additive_layers[0].half_transform = half_transforms[2];
+  additive_layers[1].transform = ozz::Range<const ozz::math::SoaTransform>();
+  additive_layers[1].half_transform = ozz::make_range(half_transforms[0][0]);
+  job.output = output;
+  ASSERT_TRUE(job.Run());
+
+  const float* expected_f = reinterpret_cast<const float*>(expected);
+  const float* output_f = reinterpret_cast<const float*>(output);
+  for (int c = 0; c < 2 * 10 * 4; ++c) {
+    EXPECT_NEAR(output_f[c], expected_f[c], 1e-3f) << "component " << c;
+  }
+
+  // Unit additive fast path also supports half precision layers.
+  additive_layers[0].weight = 1.f;
+  additive_layers[1].weight = 0.f;
+  job.output = output;
+  ASSERT_TRUE(job.Run());
+  additive_layers[0].transform = transforms[2];
+  additive_layers[0].half_transform =
+      ozz::Range<const ozz::math::SoaHalfTransform>();
+  job.output = expected;
+  ASSERT_TRUE(job.Run());
+  for (int c = 0; c < 2 * 10 * 4; ++c) {
+    EXPECT_NEAR(output_f[c], expected_f[c], 1e-3f) << "component " << c;
+  }
+}
@@ -0,0 +1,123 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#include "ozz/animation/runtime/correction_job.h"
+
+#include "gtest/gtest.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/simd_quaternion.h"
+#include "ozz/base/maths/soa_transform.h"
+
+namespace {
+// Extracts rotations of the 4 lanes of a soa transform.
+void ExtractRotations(const ozz::math::SoaTransform& _transform,
+                      ozz::math::SimdQuaternion _rotations[4]) {
+  ozz::math::Transpose4x4(&_transform.rotation.x, &_rotations->xyzw);
+}
+}  // namespace
+
+TEST(JobValidity, CorrectionJob) {
+  ozz::math::SoaTransform transforms[2];
+  const int joints[3] = {1, 7, 8};
+  const ozz::math::SimdQuaternion corrections[3] = {
+      ozz::math::SimdQuaternion::identity(),
+      ozz::math::SimdQuaternion::identity(),
+      ozz::math::SimdQuaternion::identity()};
+
+  {  // Default is valid.
+    ozz::animation::CorrectionJob job;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+
+  {  // Joint out of range.
+    ozz::animation::CorrectionJob job;
+    job.joints = joints;
+    job.corrections = corrections;
+    job.output = transforms;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+    job.joints.end--;
+    EXPECT_TRUE(job.Validate());
+  }
+
+  {  // Not enough corrections.
+    ozz::animation::CorrectionJob job;
+    job.joints = ozz::Range<const int>(joints, 2);
+    job.corrections =
+        ozz::Range<const ozz::math::SimdQuaternion>(corrections, 1);
+    job.output = transforms;
+    EXPECT_FALSE(job.Validate());
+  }
+}
+
+TEST(Apply, CorrectionJob) {
+  const int kNumSoaJoints = 3;
+  ozz::math::SoaTransform transforms[kNumSoaJoints];
+  ozz::math::SimdQuaternion expected_rotations[kNumSoaJoints * 4];
+  for (int i = 0; i < kNumSoaJoints * 4; ++i) {
+    const ozz::math::SimdFloat4 axis = ozz::math::Normalize3(
+        ozz::math::simd_float4::Load(1.f, i * .1f, -i * .2f, 0.f));
+    expected_rotations[i] = ozz::math::SimdQuaternion::FromAxisAngle(
+        axis, ozz::math::simd_float4::Load1(i * .3f));
+  }
+  for (int i = 0; i < kNumSoaJoints; ++i) {
+    transforms[i] = ozz::math::SoaTransform::identity();
+    ozz::math::Transpose4x4(&expected_rotations[i * 4].xyzw,
+                            &transforms[i].rotation.x);
+  }
+
+  // Joints aren't sorted, 5 is corrected twice and 4-5-6 share the same soa.
+  const int joints[] = {5, 6, 1, 5, 11, 4};
+  ozz::math::SimdQuaternion corrections[OZZ_ARRAY_SIZE(joints)];
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(joints); ++i) {
+    const ozz::math::SimdFloat4 axis = ozz::math::Normalize3(
+        ozz::math::simd_float4::Load(i * .5f, 1.f, .3f, 0.f));
+    corrections[i] = ozz::math::SimdQuaternion::FromAxisAngle(
+        axis, ozz::math::simd_float4::Load1(.7f - i * .2f));
+    expected_rotations[joints[i]] =
+        expected_rotations[joints[i]] * corrections[i];
+  }
+
+  ozz::animation::CorrectionJob job;
+  job.joints = joints;
+  job.corrections = corrections;
+  job.output = transforms;
+  ASSERT_TRUE(job.Run());
+
+  for (int i = 0; i < kNumSoaJoints; ++i) {
+    ozz::math::SimdQuaternion rotations[4];
+    ExtractRotations(transforms[i], rotations);
+    for (int l = 0; l < 4; ++l) {
+      const ozz::math::SimdFloat4 e = expected_rotations[i * 4 + l].xyzw;
+      EXPECT_SIMDQUATERNION_EQ_TOL(rotations[l], ozz::math::GetX(e),
+                                   ozz::math::GetY(e), ozz::math::GetZ(e),
+                                   ozz::math::GetW(e), 1e-5f);
+    }
+  }
+}
@@ -0,0 +1,319 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#include "ozz/animation/runtime/fixed_topology.h"
+
+#include "gtest/gtest.h"
+
+#include "ozz/animation/offline/raw_skeleton.h"
+#include "ozz/animation/offline/skeleton_builder.h"
+#include "ozz/animation/runtime/blending_job.h"
+#include "ozz/animation/runtime/local_to_model_job.h"
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/allocator.h"
+
+using ozz::animation::BlendingJob;
+using ozz::animation::FixedBlendingJob;
+using ozz::animation::FixedLocalToModelJob;
+using ozz::animation::LocalToModelJob;
+using ozz::animation::Skeleton;
+using ozz::animation::offline::RawSkeleton;
+using ozz::animation::offline::SkeletonBuilder;
+
+namespace {
+// Topology of the skeleton built by BuildSkeleton(), as generated by
+// ozz::animation::offline::GenerateFixedTopology().
+struct TestTopology {
+  enum { kNumJoints = 7 };
+  static uint32_t fingerprint() { return 0xd9daefd5u; }
+  template <int _Joint>
+  struct Parent;
+};
+template <>
+struct TestTopology::Parent<0> {
+  enum { kValue = -1 };
+};
+template <>
+struct TestTopology::Parent<1> {
+  enum { kValue = 0 };
+};
+template <>
+struct TestTopology::Parent<2> {
+  enum { kValue = 1 };
+};
+template <>
+struct TestTopology::Parent<3> {
+  enum { kValue = 0 };
+};
+template <>
+struct TestTopology::Parent<4> {
+  enum { kValue = 3 };
+};
+template <>
+struct TestTopology::Parent<5> {
+  enum { kValue = 3 };
+};
+template <>
+struct TestTopology::Parent<6> {
+  enum { kValue = -1 };
+};
+
+// Builds a 2 roots skeleton:
+// j0 (j1 (j2), j3 (j4, j5)), j6
+Skeleton* BuildSkeleton() {
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(2);
+  RawSkeleton::Joint& j0 = raw_skeleton.roots[0];
+  j0.name = "j0";
+  j0.children.resize(2);
+  j0.children[0].name = "j1";
+  j0.children[0].children.resize(1);
+  j0.children[0].children[0].name = "j2";
+  j0.children[1].name = "j3";
+  j0.children[1].children.resize(2);
+  j0.children[1].children[0].name = "j4";
+  j0.children[1].children[1].name = "j5";
+  raw_skeleton.roots[1].name = "j6";
+  SkeletonBuilder builder;
+  return builder(raw_skeleton);
+}
+
+// Fills _transforms with a pose that differs for every joint.
+void FillPose(float _offset, ozz::math::SoaTransform _transforms[2]) {
+  for (int i = 0; i < 2; ++i) {
+    const float f = _offset + i;
+    const ozz::math::SoaTransform transform = {
+        {ozz::math::simd_float4::Load(f, f + .1f, f + .2f, f + .3f),
+         ozz::math::simd_float4::Load(1.f, -1.f, f, -f),
+         ozz::math::simd_float4::Load(.5f, .6f, .7f, .8f)},
+        {ozz::math::simd_float4::Load(0.f, .70710677f, 0.f, .6f),
+         ozz::math::simd_float4::Load(0.f, 0.f, .70710677f, 0.f),
+         ozz::math::simd_float4::Load(0.f, 0.f, 0.f, 0.f),
+         ozz::math::simd_float4::Load(1.f, .70710677f, .70710677f, .8f)},
+        {ozz::math::simd_float4::Load(1.f, 2.f, 1.f, .5f),
+         ozz::math::simd_float4::Load(1.f, 1.f, 2.f, 1.f),
+         ozz::math::simd_float4::Load(1.f, 1.f, 1.f, 3.f)}};
+    _transforms[i] = transform;
+  }
+}
+}  // namespace
+
+TEST(Topology, FixedTopology) {
+  Skeleton* skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton != NULL);
+  EXPECT_TRUE(ozz::animation::IsFixedTopology<TestTopology>(*skeleton));
+  EXPECT_FALSE(ozz::animation::IsFixedTopology<TestTopology>(Skeleton()));
+  for (int i = 0; i < TestTopology::kNumJoints; ++i) {
+    EXPECT_EQ(skeleton->joint_parents()[i] == Skeleton::kNoParent,
+              i == 0 || i == 6);
+  }
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+TEST(JobValidity, FixedLocalToModelJob) {
+  ozz::math::SoaTransform input[2];
+  ozz::math::Float4x4 output[7];
+
+  {  // Default job is invalid.
+    const FixedLocalToModelJob<TestTopology> job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  {  // Input is too small.
+    FixedLocalToModelJob<TestTopology> job;
+    job.input = ozz::Range<const ozz::math::SoaTransform>(input, 1);
+    job.output = output;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  {  // Output is too small.
+    FixedLocalToModelJob<TestTopology> job;
+    job.input = input;
+    job.output = ozz::Range<ozz::math::Float4x4>(output, 6);
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  {  // Valid.
+    FillPose(0.f, input);
+    FixedLocalToModelJob<TestTopology> job;
+    job.input = input;
+    job.output = output;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+}
+
+TEST(LocalToModel, FixedLocalToModelJob) {
+  Skeleton* skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton != NULL);
+
+  ozz::math::SoaTransform input[2];
+  FillPose(1.f, input);
+  const ozz::math::Float4x4 root =
+      ozz::math::Float4x4::Translation(ozz::math::simd_float4::Load(
+          1.f, 2.f, 3.f, 0.f));
+
+  for (int r = 0; r < 2; ++r) {
+    ozz::math::Float4x4 expected[7];
+    LocalToModelJob job;
+    job.skeleton = skeleton;
+    job.root = r ? &root : NULL;
+    job.input = input;
+    job.output = expected;
+    ASSERT_TRUE(job.Run());
+
+    ozz::math::Float4x4 output[7];
+    FixedLocalToModelJob<TestTopology> fixed_job;
+    fixed_job.root = r ? &root : NULL;
+    fixed_job.input = input;
+    fixed_job.output = output;
+    ASSERT_TRUE(fixed_job.Run());
+
+    for (int i = 0; i < TestTopology::kNumJoints; ++i) {
+      for (int c = 0; c < 4; ++c) {
+        float e[4], o[4];
+        ozz::math::StorePtrU(expected[i].cols[c], e);
+        ozz::math::StorePtrU(output[i].cols[c], o);
+        EXPECT_FLOAT_EQ(o[0], e[0]);
+        EXPECT_FLOAT_EQ(o[1], e[1]);
+        EXPECT_FLOAT_EQ(o[2], e[2]);
+        EXPECT_FLOAT_EQ(o[3], e[3]);
+      }
+    }
+  }
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+TEST(JobValidity, FixedBlendingJob) {
+  ozz::math::SoaTransform bind_pose[2];
+  ozz::math::SoaTransform input[2];
+  ozz::math::SoaTransform output[2];
+  ozz::math::SimdFloat4 joint_weights[2];
+  BlendingJob::Layer layers[1];
+  layers[0].weight = 1.f;
+  layers[0].transform = input;
+
+  {  // Default job is invalid.
+    const FixedBlendingJob<TestTopology> job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  {  // Output is too small.
+    FixedBlendingJob<TestTopology> job;
+    job.bind_pose = bind_pose;
+    job.output = ozz::Range<ozz::math::SoaTransform>(output, 1);
+    EXPECT_FALSE(job.Validate());
+  }
+  {  // Invalid threshold.
+    FixedBlendingJob<TestTopology> job;
+    job.threshold = 0.f;
+    job.bind_pose = bind_pose;
+    job.output = output;
+    EXPECT_FALSE(job.Validate());
+  }
+  {  // Partial layers aren't supported.
+    BlendingJob::Layer partial = layers[0];
+    partial.joint_weights = joint_weights;
+    FixedBlendingJob<TestTopology> job;
+    job.layers = ozz::Range<const BlendingJob::Layer>(&partial, 1);
+    job.bind_pose = bind_pose;
+    job.output = output;
+    EXPECT_FALSE(job.Validate());
+
+    // Unless they aren't contributing.
+    partial.weight = 0.f;
+    EXPECT_TRUE(job.Validate());
+  }
+  {  // Valid.
+    FixedBlendingJob<TestTopology> job;
+    job.layers = layers;
+    job.bind_pose = bind_pose;
+    job.output = output;
+    EXPECT_TRUE(job.Validate());
+  }
+}
+
+TEST(Blend, FixedBlendingJob) {
+  ozz::math::SoaTransform bind_pose[2];
+  FillPose(0.f, bind_pose);
+  ozz::math::SoaTransform inputs[2][2];
+  FillPose(1.f, inputs[0]);
+  FillPose(2.f, inputs[1]);
+
+  BlendingJob::Layer layers[2];
+  layers[0].transform = inputs[0];
+  layers[1].transform = inputs[1];
+
+  // Tests bind pose only, bind pose blending below threshold, and normalized
+  // weights.
+  const float weights[][2] = {{0.f, 0.f}, {.05f, 0.f}, {.3f, .9f}};
+  for (size_t w = 0; w < OZZ_ARRAY_SIZE(weights); ++w) {
+    layers[0].weight = weights[w][0];
+    layers[1].weight = weights[w][1];
+
+    ozz::math::SoaTransform expected[2];
+    BlendingJob job;
+    job.layers = layers;
+    job.bind_pose = bind_pose;
+    job.output = expected;
+    ASSERT_TRUE(job.Run());
+
+    ozz::math::SoaTransform output[2];
+    FixedBlendingJob<TestTopology> fixed_job;
+    fixed_job.layers = layers;
+    fixed_job.bind_pose = bind_pose;
+    fixed_job.output = output;
+    ASSERT_TRUE(fixed_job.Run());
+
+    for (int i = 0; i < 2; ++i) {
+      const ozz::math::SoaTransform& e = expected[i];
+      const ozz::math::SoaTransform& o = output[i];
+      float ev[4], ov[4];
+      const ozz::math::SimdFloat4* ecomps[] = {
+          &e.translation.x, &e.translation.y, &e.translation.z,
+          &e.rotation.x,    &e.rotation.y,    &e.rotation.z,
+          &e.rotation.w,    &e.scale.x,       &e.scale.y,
+          &e.scale.z};
+      const ozz::math::SimdFloat4* ocomps[] = {
+          &o.translation.x, &o.translation.y, &o.translation.z,
+          &o.rotation.x,    &o.rotation.y,    &o.rotation.z,
+          &o.rotation.w,    &o.scale.x,       &o.scale.y,
+          &o.scale.z};
+      for (size_t c = 0; c < OZZ_ARRAY_SIZE(ecomps); ++c) {
+        ozz::math::StorePtrU(*ecomps[c], ev);
+        ozz::math::StorePtrU(*ocomps[c], ov);
+        for (int k = 0; k < 4; ++k) {
+          EXPECT_NEAR(ov[k], ev[k], 1e-5f);
+        }
+      }
+    }
+  }
+}
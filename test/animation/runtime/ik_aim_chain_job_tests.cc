@@ -0,0 +1,176 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#include "ozz/animation/runtime/ik_aim_chain_job.h"
+
+#include "gtest/gtest.h"
+#include "ozz/animation/runtime/ik_aim_job.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/simd_quaternion.h"
+
+TEST(JobValidity, IKAimChainJob) {
+  const ozz::math::Float4x4 joint = ozz::math::Float4x4::identity();
+  const ozz::math::Float4x4* joints[2] = {&joint, NULL};
+  const ozz::math::SimdFloat4 ups[2] = {ozz::math::simd_float4::y_axis(),
+                                        ozz::math::simd_float4::y_axis()};
+  const float weights[2] = {1.f, 1.f};
+  ozz::math::SimdQuaternion corrections[2];
+
+  {  // Default is valid, there's no joint.
+    ozz::animation::IKAimChainJob job;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+
+  {  // NULL joint.
+    ozz::animation::IKAimChainJob job;
+    job.joints = joints;
+    job.ups = ups;
+    job.weights = weights;
+    job.joint_corrections = corrections;
+    EXPECT_FALSE(job.Validate());
+    job.joints.end = job.joints.begin + 1;
+    EXPECT_TRUE(job.Validate());
+
+    // Non normalized forward.
+    job.forward = ozz::math::simd_float4::Load(1.f, 1.f, 0.f, 0.f);
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Invalid ranges.
+    joints[1] = &joint;
+    ozz::animation::IKAimChainJob job;
+    job.joints = joints;
+    job.ups = ups;
+    job.weights = weights;
+    job.joint_corrections = corrections;
+    EXPECT_TRUE(job.Validate());
+    job.ups.end = job.ups.begin + 1;
+    EXPECT_FALSE(job.Validate());
+    job.ups = ups;
+    job.weights.end = job.weights.begin + 1;
+    EXPECT_FALSE(job.Validate());
+    job.weights = weights;
+    job.joint_corrections.end = job.joint_corrections.begin + 1;
+    EXPECT_FALSE(job.Validate());
+  }
+}
+
+TEST(Chain, IKAimChainJob) {
+  // Builds a 3 joints chain, from parent to child.
+  const ozz::math::Float4x4 pelvis = ozz::math::Float4x4::FromAffine(
+      ozz::math::simd_float4::Load(0.f, 1.f, 0.f, 0.f),
+      ozz::math::SimdQuaternion::FromAxisAngle(
+          ozz::math::simd_float4::z_axis(), ozz::math::simd_float4::Load1(.3f))
+          .xyzw,
+      ozz::math::simd_float4::one());
+  const ozz::math::Float4x4 spine =
+      pelvis * ozz::math::Float4x4::FromAffine(
+                   ozz::math::simd_float4::Load(.5f, 0.f, .1f, 0.f),
+                   ozz::math::SimdQuaternion::FromAxisAngle(
+                       ozz::math::simd_float4::y_axis(),
+                       ozz::math::simd_float4::Load1(-.4f))
+                       .xyzw,
+                   ozz::math::simd_float4::one());
+  const ozz::math::Float4x4 head =
+      spine * ozz::math::Float4x4::FromAffine(
+                  ozz::math::simd_float4::Load(.3f, .1f, 0.f, 0.f),
+                  ozz::math::SimdQuaternion::FromAxisAngle(
+                      ozz::math::simd_float4::x_axis(),
+                      ozz::math::simd_float4::Load1(.7f))
+                      .xyzw,
+                  ozz::math::simd_float4::one());
+
+  // Child to parent.
+  const ozz::math::Float4x4* joints[3] = {&head, &spine, &pelvis};
+  const ozz::math::SimdFloat4 ups[3] = {ozz::math::simd_float4::y_axis(),
+                                        ozz::math::simd_float4::z_axis(),
+                                        ozz::math::simd_float4::y_axis()};
+  const float weights[3] = {.3f, .5f, 1.f};
+  ozz::math::SimdQuaternion corrections[3];
+  bool reached = false;
+
+  ozz::animation::IKAimChainJob job;
+  job.target = ozz::math::simd_float4::Load(2.f, 3.f, 1.f, 0.f);
+  job.offset = ozz::math::simd_float4::Load(.1f, .1f, 0.f, 0.f);
+  job.joints = joints;
+  job.ups = ups;
+  job.weights = weights;
+  job.joint_corrections = corrections;
+  job.reached = &reached;
+  ASSERT_TRUE(job.Run());
+  EXPECT_TRUE(reached);
+
+  // Compares with IKAimJob run joint by joint, updating model-space matrices
+  // of children joints between each step.
+  ozz::math::Float4x4 models[3] = {head, spine, pelvis};
+  ozz::math::SimdFloat4 forward = job.forward;
+  ozz::math::SimdFloat4 offset = job.offset;
+  for (int i = 0; i < 3; ++i) {
+    if (i != 0) {
+      // Forward and offset of the corrected joint, in current joint space.
+      const ozz::math::Float4x4 to_local = Invert(models[i]) * models[i - 1];
+      forward = TransformVector(to_local, forward);
+      offset = TransformPoint(to_local, offset);
+    }
+    ozz::math::SimdQuaternion correction;
+    ozz::animation::IKAimJob aim;
+    aim.target = job.target;
+    aim.pole_vector = job.pole_vector;
+    aim.forward = forward;
+    aim.offset = offset;
+    aim.up = ups[i];
+    aim.weight = weights[i];
+    aim.joint = &models[i];
+    aim.joint_correction = &correction;
+    ASSERT_TRUE(aim.Run());
+
+    EXPECT_SIMDQUATERNION_EQ_TOL(
+        corrections[i], ozz::math::GetX(correction.xyzw),
+        ozz::math::GetY(correction.xyzw), ozz::math::GetZ(correction.xyzw),
+        ozz::math::GetW(correction.xyzw), 1e-4f);
+
+    // Applies correction to the joint and its children.
+    const ozz::math::Float4x4 correction_matrix =
+        ozz::math::Float4x4::FromQuaternion(correction.xyzw);
+    const ozz::math::Float4x4 inv_joint = Invert(models[i]);
+    const ozz::math::Float4x4 corrected = models[i] * correction_matrix;
+    for (int c = 0; c < i; ++c) {
+      models[c] = corrected * (inv_joint * models[c]);
+    }
+    models[i] = corrected;
+  }
+
+  // Finally, the forward vector of the fully corrected head aims at target.
+  const ozz::math::SimdFloat4 aim_ms = TransformVector(models[0], job.forward);
+  const ozz::math::SimdFloat4 offset_ms = TransformPoint(models[0], job.offset);
+  const ozz::math::SimdFloat4 to_target =
+      ozz::math::Normalize3(job.target - offset_ms);
+  EXPECT_NEAR(ozz::math::GetX(ozz::math::Dot3(aim_ms, to_target)), 1.f, 1e-3f);
+}
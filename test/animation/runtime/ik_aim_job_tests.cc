@@ -443,8 +443,11 @@ TEST(Twist, IKAimJob) {
     EXPECT_TRUE(job.Run());
     const ozz::math::Quaternion x_mPi = ozz::math::Quaternion::FromAxisAngle(
         ozz::math::Float3::x_axis(), -ozz::math::kPi);
-    EXPECT_SIMDQUATERNION_EQ_TOL(quat, x_mPi.x, x_mPi.y, x_mPi.z, x_mPi.w,
-                                 2e-3f);
+    // w is close to 0, so the sign of the output quaternion (which represents
+    // the same rotation either way) depends on rounding.
+    const float sign = ozz::math::GetX(quat.xyzw) * x_mPi.x < 0.f ? -1.f : 1.f;
+    EXPECT_SIMDQUATERNION_EQ_TOL(quat, x_mPi.x * sign, x_mPi.y * sign,
+                                 x_mPi.z * sign, x_mPi.w * sign, 2e-3f);
   }
 
   {  // Pole y, twist pi/2
@@ -0,0 +1,226 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#include "ozz/animation/runtime/ik_ccd_job.h"
+
+#include <cmath>
+
+#include "gtest/gtest.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/simd_quaternion.h"
+
+namespace {
+// Number of joints of the test chain, including end joint.
+const int kChainLength = 6;
+
+// Builds a chain along x axis, each joint being slightly rotated around z
+// and y axis compared to its parent. _models[0] is the end joint.
+void BuildChain(ozz::math::Float4x4 _models[kChainLength]) {
+  ozz::math::Float4x4 model = ozz::math::Float4x4::identity();
+  for (int i = kChainLength - 1; i >= 0; --i) {
+    _models[i] = model;
+    const ozz::math::SimdQuaternion rotation =
+        ozz::math::SimdQuaternion::FromAxisAngle(
+            ozz::math::Normalize3(ozz::math::simd_float4::Load(0.f, .3f, 1.f,
+                                                               0.f)),
+            ozz::math::simd_float4::Load1(.2f));
+    model = model * ozz::math::Float4x4::FromAffine(
+                        ozz::math::simd_float4::x_axis(), rotation.xyzw,
+                        ozz::math::simd_float4::one());
+  }
+}
+
+// Rebuilds end joint model-space position, once corrections are applied.
+ozz::math::SimdFloat4 CorrectedEnd(
+    const ozz::math::Float4x4 _models[kChainLength],
+    const ozz::math::SimdQuaternion _corrections[kChainLength - 1]) {
+  ozz::math::Float4x4 corrected = _models[kChainLength - 1];
+  for (int i = kChainLength - 1; i > 0; --i) {
+    corrected = corrected * ozz::math::Float4x4::FromQuaternion(
+                                _corrections[i - 1].xyzw);
+    corrected = corrected * (Invert(_models[i]) * _models[i - 1]);
+  }
+  return corrected.cols[3];
+}
+}  // namespace
+
+TEST(JobValidity, IKCCDJob) {
+  ozz::math::Float4x4 models[kChainLength];
+  BuildChain(models);
+  const ozz::math::Float4x4* joints[kChainLength - 1] = {
+      &models[1], &models[2], NULL, &models[4], &models[5]};
+  ozz::math::SimdQuaternion corrections[kChainLength - 1];
+
+  {  // Default is invalid.
+    ozz::animation::IKCCDJob job;
+    EXPECT_FALSE(job.Validate());
+  }
+
+  {  // End joint only is valid.
+    ozz::animation::IKCCDJob job;
+    job.end_joint = &models[0];
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+
+  {  // NULL joint.
+    ozz::animation::IKCCDJob job;
+    job.end_joint = &models[0];
+    job.joints = joints;
+    job.joint_corrections = corrections;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+    joints[2] = &models[3];
+    EXPECT_TRUE(job.Validate());
+  }
+
+  {  // Corrections too small.
+    ozz::animation::IKCCDJob job;
+    job.end_joint = &models[0];
+    job.joints = joints;
+    job.joint_corrections = corrections;
+    job.joint_corrections.end--;
+    EXPECT_FALSE(job.Validate());
+  }
+}
+
+TEST(Reach, IKCCDJob) {
+  ozz::math::Float4x4 models[kChainLength];
+  BuildChain(models);
+  const ozz::math::Float4x4* joints[kChainLength - 1] = {
+      &models[1], &models[2], &models[3], &models[4], &models[5]};
+  ozz::math::SimdQuaternion corrections[kChainLength - 1];
+  bool reached = false;
+
+  ozz::animation::IKCCDJob job;
+  job.end_joint = &models[0];
+  job.joints = joints;
+  job.joint_corrections = corrections;
+  job.reached = &reached;
+
+  {  // Reachable target.
+    job.target = ozz::math::simd_float4::Load(2.f, 3.f, -1.f, 0.f);
+    ASSERT_TRUE(job.Run());
+    EXPECT_TRUE(reached);
+    const ozz::math::SimdFloat4 end = CorrectedEnd(models, corrections);
+    EXPECT_SIMDFLOAT3_EQ_TOL(end, 2.f, 3.f, -1.f, 2e-3f);
+  }
+
+  {  // Target behind the chain.
+    job.target = ozz::math::simd_float4::Load(-1.f, -1.f, 1.f, 0.f);
+    ASSERT_TRUE(job.Run());
+    EXPECT_TRUE(reached);
+    const ozz::math::SimdFloat4 end = CorrectedEnd(models, corrections);
+    EXPECT_SIMDFLOAT3_EQ_TOL(end, -1.f, -1.f, 1.f, 2e-3f);
+  }
+
+  {  // Target out of reach, chain gets stretched toward the target.
+    job.target = ozz::math::simd_float4::Load(0.f, 10.f, 0.f, 0.f);
+    ASSERT_TRUE(job.Run());
+    EXPECT_FALSE(reached);
+    const ozz::math::SimdFloat4 end = CorrectedEnd(models, corrections);
+    EXPECT_SIMDFLOAT3_EQ_TOL(end, 0.f, 5.f, 0.f, 1e-1f);
+  }
+
+  {  // Not enough iterations.
+    job.target = ozz::math::simd_float4::Load(2.f, 3.f, -1.f, 0.f);
+    job.max_iterations = 1;
+    job.tolerance = 1e-5f;
+    ASSERT_TRUE(job.Run());
+    EXPECT_FALSE(reached);
+    job.max_iterations = 16;
+    job.tolerance = 1e-3f;
+  }
+
+  {  // No iteration.
+    job.max_iterations = 0;
+    ASSERT_TRUE(job.Run());
+    EXPECT_FALSE(reached);
+    for (int i = 0; i < kChainLength - 1; ++i) {
+      EXPECT_SIMDQUATERNION_EQ(corrections[i], 0.f, 0.f, 0.f, 1.f);
+    }
+    job.max_iterations = 16;
+  }
+}
+
+TEST(Weight, IKCCDJob) {
+  ozz::math::Float4x4 models[kChainLength];
+  BuildChain(models);
+  const ozz::math::Float4x4* joints[kChainLength - 1] = {
+      &models[1], &models[2], &models[3], &models[4], &models[5]};
+  ozz::math::SimdQuaternion corrections[kChainLength - 1];
+  ozz::math::SimdQuaternion full_corrections[kChainLength - 1];
+  bool reached = true;
+
+  ozz::animation::IKCCDJob job;
+  job.target = ozz::math::simd_float4::Load(2.f, 3.f, -1.f, 0.f);
+  job.end_joint = &models[0];
+  job.joints = joints;
+  job.reached = &reached;
+
+  job.joint_corrections = full_corrections;
+  ASSERT_TRUE(job.Run());
+  EXPECT_TRUE(reached);
+
+  job.joint_corrections = corrections;
+
+  {  // Weight 0.
+    job.weight = 0.f;
+    ASSERT_TRUE(job.Run());
+    EXPECT_FALSE(reached);
+    for (int i = 0; i < kChainLength - 1; ++i) {
+      EXPECT_SIMDQUATERNION_EQ(corrections[i], 0.f, 0.f, 0.f, 1.f);
+    }
+  }
+
+  {  // Weight greater than 1 is clamped.
+    job.weight = 1.5f;
+    ASSERT_TRUE(job.Run());
+    EXPECT_TRUE(reached);
+    for (int i = 0; i < kChainLength - 1; ++i) {
+      EXPECT_SIMDQUATERNION_EQ_TOL(
+          corrections[i], ozz::math::GetX(full_corrections[i].xyzw),
+          ozz::math::GetY(full_corrections[i].xyzw),
+          ozz::math::GetZ(full_corrections[i].xyzw),
+          ozz::math::GetW(full_corrections[i].xyzw), 1e-5f);
+    }
+  }
+
+  {  // Half weight.
+    job.weight = .5f;
+    ASSERT_TRUE(job.Run());
+    EXPECT_FALSE(reached);
+    for (int i = 0; i < kChainLength - 1; ++i) {
+      // Half the angle of the full correction.
+      const float full_angle =
+          2.f * std::acos(ozz::math::GetW(full_corrections[i].xyzw));
+      const float angle = 2.f * std::acos(ozz::math::GetW(corrections[i].xyzw));
+      EXPECT_NEAR(angle, full_angle * .5f, 2e-2f);
+    }
+  }
+}
@@ -0,0 +1,220 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#include "ozz/animation/runtime/ik_two_bone_batch_job.h"
+
+#include <cstdlib>
+
+#include "gtest/gtest.h"
+#include "ozz/animation/runtime/ik_two_bone_job.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/simd_quaternion.h"
+
+namespace {
+float RandomFloat(float _min, float _max) {
+  return _min + (_max - _min) * std::rand() / RAND_MAX;
+}
+
+ozz::math::SimdFloat4 RandomVector(float _range) {
+  return ozz::math::simd_float4::Load(RandomFloat(-_range, _range),
+                                      RandomFloat(-_range, _range),
+                                      RandomFloat(-_range, _range), 0.f);
+}
+
+ozz::math::Float4x4 RandomMatrix(const ozz::math::Float4x4& _parent) {
+  const ozz::math::SimdQuaternion rotation =
+      ozz::math::SimdQuaternion::FromAxisAngle(
+          ozz::math::Normalize3(RandomVector(1.f) +
+                                ozz::math::simd_float4::x_axis()),
+          ozz::math::simd_float4::Load1(RandomFloat(-3.f, 3.f)));
+  return _parent * ozz::math::Float4x4::FromAffine(
+                       RandomVector(1.f) + ozz::math::simd_float4::y_axis(),
+                       rotation.xyzw, ozz::math::simd_float4::one());
+}
+}  // namespace
+
+TEST(JobValidity, IKTwoBoneBatchJob) {
+  const ozz::math::Float4x4 start = ozz::math::Float4x4::identity();
+  const ozz::math::Float4x4 mid =
+      ozz::math::Float4x4::Translation(ozz::math::simd_float4::y_axis());
+  const ozz::math::Float4x4 end = ozz::math::Float4x4::Translation(
+      ozz::math::simd_float4::x_axis() + ozz::math::simd_float4::y_axis());
+  const ozz::math::Float4x4* starts[2] = {&start, &start};
+  const ozz::math::Float4x4* mids[2] = {&mid, &mid};
+  const ozz::math::Float4x4* ends[2] = {&end, NULL};
+  const ozz::math::SimdFloat4 targets[2] = {ozz::math::simd_float4::zero(),
+                                            ozz::math::simd_float4::zero()};
+  const ozz::math::SimdFloat4 poles[2] = {ozz::math::simd_float4::y_axis(),
+                                          ozz::math::simd_float4::y_axis()};
+  const float weights[1] = {1.f};
+  ozz::math::SimdQuaternion start_corrections[2];
+  ozz::math::SimdQuaternion mid_corrections[2];
+
+  {  // Default is valid, there's no chain to solve.
+    ozz::animation::IKTwoBoneBatchJob job;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+
+  {  // Valid.
+    ozz::animation::IKTwoBoneBatchJob job;
+    job.targets = targets;
+    job.pole_vectors = poles;
+    job.start_joints = starts;
+    job.mid_joints = mids;
+    job.end_joints = ozz::Range<const ozz::math::Float4x4* const>(ends, 1);
+    job.start_joint_corrections = start_corrections;
+    job.mid_joint_corrections = mid_corrections;
+    job.targets.end = job.targets.begin + 1;
+    EXPECT_TRUE(job.Validate());
+
+    // Missing ends.
+    job.targets = targets;
+    EXPECT_FALSE(job.Validate());
+    job.end_joints = ends;
+
+    // NULL end matrix.
+    EXPECT_FALSE(job.Validate());
+    job.targets.end = job.targets.begin + 1;
+    EXPECT_TRUE(job.Validate());
+
+    // Optional weights too small.
+    job.targets = targets;
+    ends[1] = &end;
+    job.weights = weights;
+    EXPECT_FALSE(job.Validate());
+    job.weights = ozz::Range<const float>();
+    EXPECT_TRUE(job.Validate());
+
+    // Outputs too small.
+    job.mid_joint_corrections.end = job.mid_joint_corrections.begin + 1;
+    EXPECT_FALSE(job.Validate());
+    job.mid_joint_corrections = mid_corrections;
+
+    // Non normalized mid axis.
+    job.mid_axis = ozz::math::simd_float4::Load(1.f, 1.f, 0.f, 0.f);
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+}
+
+TEST(Equivalence, IKTwoBoneBatchJob) {
+  // Number of chains, not a multiple of 4.
+  const size_t kChains = 23;
+
+  ozz::math::Float4x4 starts[kChains];
+  ozz::math::Float4x4 mids[kChains];
+  ozz::math::Float4x4 ends[kChains];
+  const ozz::math::Float4x4* start_ptrs[kChains];
+  const ozz::math::Float4x4* mid_ptrs[kChains];
+  const ozz::math::Float4x4* end_ptrs[kChains];
+  ozz::math::SimdFloat4 targets[kChains];
+  ozz::math::SimdFloat4 poles[kChains];
+  float twists[kChains];
+  float weights[kChains];
+
+  std::srand(0);
+  for (size_t i = 0; i < kChains; ++i) {
+    starts[i] = RandomMatrix(ozz::math::Float4x4::identity());
+    mids[i] = RandomMatrix(starts[i]);
+    ends[i] = RandomMatrix(mids[i]);
+    start_ptrs[i] = &starts[i];
+    mid_ptrs[i] = &mids[i];
+    end_ptrs[i] = &ends[i];
+    // Some targets are out of reach.
+    targets[i] = RandomVector(4.f);
+    poles[i] = RandomVector(1.f);
+    twists[i] = RandomFloat(-1.f, 1.f);
+    // Covers weights lower than 0, in range and greater than 1.
+    weights[i] = RandomFloat(-.2f, 1.5f);
+  }
+  // Target on the start joint.
+  targets[3] = starts[3].cols[3];
+
+  for (int variant = 0; variant < 4; ++variant) {
+    const bool weighted = (variant & 1) != 0;
+    const bool twisted = (variant & 2) != 0;
+    const float soften = variant == 0 ? 1.f : .8f;
+
+    ozz::math::SimdQuaternion start_corrections[kChains];
+    ozz::math::SimdQuaternion mid_corrections[kChains];
+    bool reached[kChains];
+
+    ozz::animation::IKTwoBoneBatchJob batch;
+    batch.mid_axis = ozz::math::simd_float4::z_axis();
+    batch.soften = soften;
+    batch.targets = targets;
+    batch.pole_vectors = poles;
+    if (twisted) {
+      batch.twist_angles = twists;
+    }
+    if (weighted) {
+      batch.weights = weights;
+    }
+    batch.start_joints = start_ptrs;
+    batch.mid_joints = mid_ptrs;
+    batch.end_joints = end_ptrs;
+    batch.start_joint_corrections = start_corrections;
+    batch.mid_joint_corrections = mid_corrections;
+    batch.reached = reached;
+    ASSERT_TRUE(batch.Run());
+
+    for (size_t i = 0; i < kChains; ++i) {
+      ozz::math::SimdQuaternion start_correction;
+      ozz::math::SimdQuaternion mid_correction;
+      bool single_reached;
+
+      ozz::animation::IKTwoBoneJob job;
+      job.mid_axis = batch.mid_axis;
+      job.soften = soften;
+      job.target = targets[i];
+      job.pole_vector = poles[i];
+      job.twist_angle = twisted ? twists[i] : 0.f;
+      job.weight = weighted ? weights[i] : 1.f;
+      job.start_joint = &starts[i];
+      job.mid_joint = &mids[i];
+      job.end_joint = &ends[i];
+      job.start_joint_correction = &start_correction;
+      job.mid_joint_correction = &mid_correction;
+      job.reached = &single_reached;
+      ASSERT_TRUE(job.Run());
+
+      EXPECT_SIMDQUATERNION_EQ_TOL(
+          start_corrections[i], ozz::math::GetX(start_correction.xyzw),
+          ozz::math::GetY(start_correction.xyzw),
+          ozz::math::GetZ(start_correction.xyzw),
+          ozz::math::GetW(start_correction.xyzw), 2e-3f);
+      EXPECT_SIMDQUATERNION_EQ_TOL(
+          mid_corrections[i], ozz::math::GetX(mid_correction.xyzw),
+          ozz::math::GetY(mid_correction.xyzw),
+          ozz::math::GetZ(mid_correction.xyzw),
+          ozz::math::GetW(mid_correction.xyzw), 2e-3f);
+      EXPECT_EQ(reached[i], single_reached);
+    }
+  }
+}
@@ -253,10 +253,14 @@ TEST(StartJointCorrection, IKTwoBoneJob) {
 
       EXPECT_REACHED(job);
 
+      // Rotating by kPi around y or -y are the same rotation, so qstart sign
+      // depends on floating point rounding of the target.
       const ozz::math::Quaternion y_kPi = ozz::math::Quaternion::FromAxisAngle(
           ozz::math::Float3::y_axis(), ozz::math::kPi);
-      EXPECT_SIMDQUATERNION_EQ_TOL(qstart, y_kPi.x, y_kPi.y, y_kPi.z, y_kPi.w,
-                                   2e-3f);
+      const ozz::math::SimdQuaternion qstart_pos = {
+          ozz::math::GetY(qstart.xyzw) < 0.f ? -qstart.xyzw : qstart.xyzw};
+      EXPECT_SIMDQUATERNION_EQ_TOL(qstart_pos, y_kPi.x, y_kPi.y, y_kPi.z,
+                                   y_kPi.w, 2e-3f);
       EXPECT_SIMDQUATERNION_EQ_TOL(qmid, 0.f, 0.f, 0.f, 1.f, 2e-3f);
     }
 
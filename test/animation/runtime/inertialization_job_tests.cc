@@ -0,0 +1,191 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#include "ozz/animation/runtime/inertialization_job.h"
+
+#include "gtest/gtest.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/soa_transform.h"
+
+using ozz::animation::InertializationJob;
+using ozz::animation::SoaInertializationState;
+
+TEST(JobValidity, InertializationJob) {
+  ozz::math::SoaTransform transforms[2];
+  const ozz::math::SoaTransform sources[2] = {
+      ozz::math::SoaTransform::identity(), ozz::math::SoaTransform::identity()};
+  SoaInertializationState states[2];
+
+  {  // Default is valid.
+    InertializationJob job;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+
+  InertializationJob valid;
+  valid.dt = 1.f / 30.f;
+  valid.capture = true;
+  valid.source = sources;
+  valid.previous_source = sources;
+  valid.source_dt = 1.f / 30.f;
+  valid.states = states;
+  valid.output = transforms;
+  EXPECT_TRUE(valid.Validate());
+
+  {  // Negative dt.
+    InertializationJob job = valid;
+    job.dt = -1.f;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Invalid capture parameters.
+    InertializationJob job = valid;
+    job.duration = 0.f;
+    EXPECT_FALSE(job.Validate());
+    job = valid;
+    job.source_dt = 0.f;
+    EXPECT_FALSE(job.Validate());
+
+    // Not used if not capturing.
+    job.capture = false;
+    EXPECT_TRUE(job.Validate());
+  }
+
+  {  // Buffers too small.
+    InertializationJob job = valid;
+    job.source.end--;
+    EXPECT_FALSE(job.Validate());
+    job = valid;
+    job.previous_source.end--;
+    EXPECT_FALSE(job.Validate());
+    job = valid;
+    job.states.end--;
+    EXPECT_FALSE(job.Validate());
+    job.output.end--;
+    EXPECT_TRUE(job.Validate());
+
+    // Sources aren't used if not capturing.
+    job = valid;
+    job.capture = false;
+    job.source = ozz::Range<const ozz::math::SoaTransform>();
+    job.previous_source = ozz::Range<const ozz::math::SoaTransform>();
+    EXPECT_TRUE(job.Validate());
+  }
+}
+
+TEST(Transition, InertializationJob) {
+  // Target pose is identity. Source lane 0 is translated (and scaled) and
+  // static, lane 1 is translated and moving fast toward the target, lane 2 is
+  // rotated 90 degrees around y, and lane 3 matches the target.
+  const float kDt = 1.f / 60.f;
+  ozz::math::SoaTransform source = ozz::math::SoaTransform::identity();
+  source.translation.x = ozz::math::simd_float4::Load(1.f, 1.f, 0.f, 0.f);
+  source.scale.x = ozz::math::simd_float4::Load(2.f, 1.f, 1.f, 1.f);
+  source.rotation.y = ozz::math::simd_float4::Load(0.f, 0.f, .70710677f, 0.f);
+  source.rotation.w = ozz::math::simd_float4::Load(1.f, 1.f, .70710677f, 1.f);
+  ozz::math::SoaTransform previous_source = source;
+  previous_source.translation.x =
+      ozz::math::simd_float4::Load(1.f, 1.f + 50.f * kDt, 0.f, 0.f);
+
+  SoaInertializationState states[1];
+  ozz::math::SoaTransform pose[1] = {ozz::math::SoaTransform::identity()};
+
+  InertializationJob job;
+  job.dt = 0.f;
+  job.capture = true;
+  job.duration = .2f;
+  job.source = ozz::Range<const ozz::math::SoaTransform>(&source, 1);
+  job.previous_source =
+      ozz::Range<const ozz::math::SoaTransform>(&previous_source, 1);
+  job.source_dt = kDt;
+  job.states = states;
+  job.output = pose;
+
+  // No time has elapsed since the source pose, so output matches it.
+  ASSERT_TRUE(job.Run());
+  EXPECT_SOAFLOAT3_EQ_EST(pose[0].translation, 1.f, 1.f, 0.f, 0.f, 0.f, 0.f,
+                          0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+  EXPECT_SOAFLOAT3_EQ_EST(pose[0].scale, 2.f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f,
+                          1.f, 1.f, 1.f, 1.f, 1.f);
+  EXPECT_SOAQUATERNION_EQ_EST(pose[0].rotation, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f,
+                              .70710677f, 0.f, 0.f, 0.f, 0.f, 0.f, 1.f, 1.f,
+                              .70710677f, 1.f);
+
+  // Offsets decay over the transition duration.
+  job.capture = false;
+  job.dt = kDt;
+  float previous_x[4] = {1.f, 1.f, 0.f, 0.f};
+  float previous_angle = 1.f;
+  for (int f = 1; f <= 15; ++f) {
+    pose[0] = ozz::math::SoaTransform::identity();
+    ASSERT_TRUE(job.Run());
+
+    float x[4];
+    ozz::math::StorePtrU(pose[0].translation.x, x);
+
+    // Offsets decrease monotonically, without overshooting.
+    EXPECT_LE(x[0], previous_x[0] + 1e-6f);
+    EXPECT_GE(x[0], -1e-6f);
+    EXPECT_LE(x[1], previous_x[1] + 1e-6f);
+    EXPECT_GE(x[1], -1e-6f);
+    previous_x[0] = x[0];
+    previous_x[1] = x[1];
+
+    // Lane 1 initial velocity carries its offset toward the target faster, and
+    // shortens its decay as the source would otherwise cross the target before
+    // the end of the transition.
+    if (f == 1) {
+      EXPECT_LT(x[1], .5f);
+      EXPECT_GT(x[0], .95f);
+    }
+    if (f * kDt >= .1f) {
+      EXPECT_FLOAT_EQ(x[1], 0.f);
+    }
+
+    // Rotation keeps rotating around y, and stays normalized.
+    float ry[4];
+    ozz::math::StorePtrU(pose[0].rotation.y, ry);
+    EXPECT_LE(ry[2], previous_angle + 1e-6f);
+    previous_angle = ry[2];
+    EXPECT_SIMDINT_EQ(ozz::math::IsNormalizedEst(pose[0].rotation), -1, -1,
+                      -1, -1);
+
+    // Joint matching the target isn't affected.
+    EXPECT_FLOAT_EQ(x[3], 0.f);
+  }
+
+  // Transition is over, output is the target pose.
+  EXPECT_SOAFLOAT3_EQ(pose[0].translation, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f,
+                      0.f, 0.f, 0.f, 0.f, 0.f);
+  EXPECT_SOAFLOAT3_EQ(pose[0].scale, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f,
+                      1.f, 1.f, 1.f, 1.f);
+  EXPECT_SOAQUATERNION_EQ_EST(pose[0].rotation, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f,
+                              0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 1.f, 1.f, 1.f,
+                              1.f);
+}
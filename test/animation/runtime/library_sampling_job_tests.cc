@@ -0,0 +1,158 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#include "ozz/animation/runtime/library_sampling_job.h"
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/allocator.h"
+
+#include "ozz/animation/offline/animation_library_builder.h"
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/runtime/animation_library.h"
+
+using ozz::animation::AnimationLibrary;
+using ozz::animation::LibrarySamplingJob;
+using ozz::animation::offline::AnimationLibraryBuilder;
+using ozz::animation::offline::RawAnimation;
+
+TEST(Validate, LibrarySamplingJob) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(5);
+  AnimationLibraryBuilder builder;
+  AnimationLibrary* library =
+      builder(ozz::Range<const RawAnimation>(&raw_animation, 1));
+  ASSERT_TRUE(library != NULL);
+
+  ozz::math::SoaTransform output[2];
+
+  {  // Empty/default job.
+    LibrarySamplingJob job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Invalid clip.
+    LibrarySamplingJob job;
+    job.library = library;
+    job.clip = 1;
+    job.output = output;
+    EXPECT_FALSE(job.Validate());
+  }
+
+  {  // Output too small.
+    LibrarySamplingJob job;
+    job.library = library;
+    job.output = ozz::Range<ozz::math::SoaTransform>(output, 1);
+    EXPECT_FALSE(job.Validate());
+  }
+
+  {  // Valid job.
+    LibrarySamplingJob job;
+    job.library = library;
+    job.output = output;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+    EXPECT_SOAFLOAT3_EQ(output[1].scale, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f,
+                        1.f, 1.f, 1.f, 1.f, 1.f);
+  }
+
+  ozz::memory::default_allocator()->Delete(library);
+}
+
+TEST(Sample, LibrarySamplingJob) {
+  RawAnimation clips[2];
+  for (int c = 0; c < 2; ++c) {
+    RawAnimation& clip = clips[c];
+    clip.duration = 2.f;
+    clip.tracks.resize(2);
+    const RawAnimation::TranslationKey t0 = {.5f,
+                                             ozz::math::Float3(0.f, 1.f, 0.f)};
+    const RawAnimation::TranslationKey t1 = {
+        1.5f, ozz::math::Float3(c == 0 ? 2.f : 4.f, 1.f, 0.f)};
+    clip.tracks[0].translations.push_back(t0);
+    clip.tracks[0].translations.push_back(t1);
+    // Opposite hemisphere keys, interpolated along the shortest path.
+    const RawAnimation::RotationKey r0 = {0.f,
+                                          ozz::math::Quaternion::identity()};
+    const RawAnimation::RotationKey r1 = {
+        2.f, -ozz::math::Quaternion::FromAxisAngle(
+                 ozz::math::Float3::y_axis(), ozz::math::kPi_2)};
+    clip.tracks[1].rotations.push_back(r0);
+    clip.tracks[1].rotations.push_back(r1);
+    const RawAnimation::ScaleKey s0 = {1.f, ozz::math::Float3(2.f, 3.f, 4.f)};
+    clip.tracks[1].scales.push_back(s0);
+  }
+  AnimationLibraryBuilder builder;
+  AnimationLibrary* library = builder(clips);
+  ASSERT_TRUE(library != NULL);
+
+  ozz::math::SoaTransform output[1];
+  LibrarySamplingJob job;
+  job.library = library;
+  job.output = output;
+
+  // Before first key.
+  job.ratio = 0.f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_SOAFLOAT3_EQ(output[0].translation, 0.f, 0.f, 0.f, 0.f, 1.f, 0.f, 0.f,
+                      0.f, 0.f, 0.f, 0.f, 0.f);
+  EXPECT_SOAQUATERNION_EQ_EST(output[0].rotation, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f,
+                              0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 1.f, 1.f, 1.f,
+                              1.f);
+  EXPECT_SOAFLOAT3_EQ(output[0].scale, 1.f, 2.f, 1.f, 1.f, 1.f, 3.f, 1.f, 1.f,
+                      1.f, 4.f, 1.f, 1.f);
+
+  // Between keys.
+  job.ratio = .5f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_SOAFLOAT3_EQ(output[0].translation, 1.f, 0.f, 0.f, 0.f, 1.f, 0.f, 0.f,
+                      0.f, 0.f, 0.f, 0.f, 0.f);
+  EXPECT_SOAQUATERNION_EQ_EST(output[0].rotation, 0.f, 0.f, 0.f, 0.f, 0.f,
+                              .3826834f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 1.f,
+                              .9238795f, 1.f, 1.f);
+
+  // Second clip, after last key.
+  job.clip = 1;
+  job.ratio = 1.f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_SOAFLOAT3_EQ(output[0].translation, 4.f, 0.f, 0.f, 0.f, 1.f, 0.f, 0.f,
+                      0.f, 0.f, 0.f, 0.f, 0.f);
+  EXPECT_SOAQUATERNION_EQ_EST(output[0].rotation, 0.f, 0.f, 0.f, 0.f, 0.f,
+                              .7071068f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 1.f,
+                              .7071068f, 1.f, 1.f);
+
+  // Rotation and scale channels are shared by both clips.
+  EXPECT_EQ(library->rotations().count(), 2u);
+  EXPECT_EQ(library->scales().count(), 2u);
+
+  ozz::memory::default_allocator()->Delete(library);
+}
@@ -27,15 +27,20 @@
 
 #include "ozz/animation/runtime/local_to_model_job.h"
 
+#include <cstring>
+
 #include "gtest/gtest.h"
 
 #include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/simd_affine.h"
+#include "ozz/base/maths/soa_float4x4.h"
 #include "ozz/base/maths/soa_transform.h"
 #include "ozz/base/memory/allocator.h"
 
 #include "ozz/animation/offline/raw_skeleton.h"
 #include "ozz/animation/offline/skeleton_builder.h"
 #include "ozz/animation/runtime/skeleton.h"
+#include "ozz/animation/runtime/skeleton_utils.h"
 
 using ozz::animation::Skeleton;
 using ozz::animation::LocalToModelJob;
@@ -1085,6 +1090,594 @@ TEST(TransformationFromToExclude, LocalToModel) {
   ozz::memory::default_allocator()->Delete(skeleton);
 }
 
+TEST(IndependentSubtrees, LocalToModel) {
+  // Builds a skeleton made of a root with 3 chains of 3 joints.
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  RawSkeleton::Joint& root = raw_skeleton.roots[0];
+  root.name = "root";
+  root.transform.translation = ozz::math::Float3(0.f, 1.f, 0.f);
+  root.children.resize(3);
+  for (int i = 0; i < 3; ++i) {
+    RawSkeleton::Joint* joint = &root.children[i];
+    for (int j = 0; j < 3; ++j) {
+      joint->name = "chain";
+      joint->name += static_cast<char>('0' + i);
+      joint->name += static_cast<char>('0' + j);
+      joint->transform.translation =
+          ozz::math::Float3(static_cast<float>(i + 1), 0.f, 0.f);
+      joint->transform.rotation = ozz::math::Quaternion::FromAxisAngle(
+          ozz::math::Float3::y_axis(), static_cast<float>(j) * .1f);
+      if (j < 2) {
+        joint->children.resize(1);
+        joint = &joint->children[0];
+      }
+    }
+  }
+
+  SkeletonBuilder builder;
+  Skeleton* skeleton = builder(raw_skeleton);
+  ASSERT_TRUE(skeleton != NULL);
+  ASSERT_EQ(skeleton->num_joints(), 10);
+
+  // Reference, whole hierarchy.
+  ozz::math::Float4x4 expected_output[10];
+  LocalToModelJob job;
+  job.skeleton = skeleton;
+  job.input = skeleton->joint_bind_poses();
+  job.output = expected_output;
+  ASSERT_TRUE(job.Run());
+
+  // Updates the root first, then every chain independently.
+  ozz::math::Float4x4 output[10];
+  job.output = output;
+  job.to = 0;
+  ASSERT_TRUE(job.Run());
+
+  int roots[3];
+  ASSERT_EQ(ozz::animation::GetIndependentSubtrees(
+                *skeleton, 1, ozz::Range<int>(roots, OZZ_ARRAY_SIZE(roots))),
+            3);
+  for (int i = 2; i >= 0; --i) {  // Order doesn't matter.
+    LocalToModelJob subtree_job;
+    subtree_job.skeleton = skeleton;
+    subtree_job.from = roots[i];
+    subtree_job.input = skeleton->joint_bind_poses();
+    subtree_job.output = output;
+    ASSERT_TRUE(subtree_job.Run());
+  }
+
+  for (int i = 0; i < skeleton->num_joints(); ++i) {
+    EXPECT_EQ(std::memcmp(&output[i], &expected_output[i], sizeof(output[i])),
+              0);
+  }
+
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+TEST(SoaOutput, LocalToModel) {
+  // Builds a skeleton made of a root with 7 children, the last one having a
+  // chain of 2 children. This covers soa elements whose joints share the same
+  // parent, and ones whose joints have parents in the same soa element.
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  RawSkeleton::Joint& root = raw_skeleton.roots[0];
+  root.name = "root";
+  root.transform.translation = ozz::math::Float3(0.f, 1.f, 0.f);
+  root.children.resize(7);
+  for (int i = 0; i < 7; ++i) {
+    RawSkeleton::Joint& child = root.children[i];
+    child.name = "child";
+    child.name += static_cast<char>('0' + i);
+    child.transform.translation =
+        ozz::math::Float3(static_cast<float>(i), 0.f, 1.f);
+    child.transform.rotation = ozz::math::Quaternion::FromAxisAngle(
+        ozz::math::Float3::y_axis(), static_cast<float>(i) * .3f);
+    child.transform.scale = ozz::math::Float3(1.f, 2.f, 1.f);
+  }
+  RawSkeleton::Joint* joint = &root.children[6];
+  for (int i = 0; i < 2; ++i) {
+    joint->children.resize(1);
+    joint = &joint->children[0];
+    joint->name = "chain";
+    joint->name += static_cast<char>('0' + i);
+    joint->transform.translation = ozz::math::Float3(0.f, 0.f, 2.f);
+    joint->transform.rotation = ozz::math::Quaternion::FromAxisAngle(
+        ozz::math::Float3::x_axis(), .5f);
+  }
+
+  SkeletonBuilder builder;
+  Skeleton* skeleton = builder(raw_skeleton);
+  ASSERT_TRUE(skeleton != NULL);
+  ASSERT_EQ(skeleton->num_joints(), 10);
+
+  const ozz::math::Float4x4 root_matrix =
+      ozz::math::Float4x4::Translation(
+          ozz::math::simd_float4::Load(4.f, 3.f, 2.f, 0.f)) *
+      ozz::math::Float4x4::FromAxisAngle(ozz::math::simd_float4::z_axis(),
+                                         ozz::math::simd_float4::Load1(.2f));
+
+  // Reference aos output.
+  ozz::math::Float4x4 expected_output[10];
+  LocalToModelJob job;
+  job.skeleton = skeleton;
+  job.root = &root_matrix;
+  job.input = skeleton->joint_bind_poses();
+  job.output = expected_output;
+  ASSERT_TRUE(job.Run());
+
+  // Soa output.
+  ozz::math::SoaFloat4x4 soa_output[3];
+  job.output = ozz::Range<ozz::math::Float4x4>();
+  job.soa_output = soa_output;
+  ASSERT_TRUE(job.Validate());
+
+  // Soa output is too small.
+  job.soa_output.end = soa_output + 2;
+  EXPECT_FALSE(job.Validate());
+  job.soa_output.end = soa_output + 3;
+
+  // Partial updates aren't supported.
+  job.from = 1;
+  EXPECT_FALSE(job.Validate());
+  job.from = Skeleton::kNoParent;
+  job.to = 5;
+  EXPECT_FALSE(job.Validate());
+  job.to = Skeleton::kMaxJoints;
+
+  ASSERT_TRUE(job.Run());
+
+  for (int i = 0; i < 3; ++i) {
+    ozz::math::Float4x4 aos[4];
+    ozz::math::Transpose16x16(&soa_output[i].cols[0].x, aos->cols);
+    for (int j = 0; j < 4 && i * 4 + j < skeleton->num_joints(); ++j) {
+      const ozz::math::Float4x4& expected_matrix = expected_output[i * 4 + j];
+      for (int c = 0; c < 4; ++c) {
+        EXPECT_SIMDFLOAT_EQ(aos[j].cols[c],
+                            ozz::math::GetX(expected_matrix.cols[c]),
+                            ozz::math::GetY(expected_matrix.cols[c]),
+                            ozz::math::GetZ(expected_matrix.cols[c]),
+                            ozz::math::GetW(expected_matrix.cols[c]));
+      }
+    }
+  }
+
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+TEST(AffineOutput, LocalToModel) {
+  // Builds a skeleton made of a root with a chain of 5 scaled children.
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  RawSkeleton::Joint* joint = &raw_skeleton.roots[0];
+  joint->name = "root";
+  joint->transform.translation = ozz::math::Float3(0.f, 1.f, 0.f);
+  for (int i = 0; i < 5; ++i) {
+    joint->children.resize(1);
+    joint = &joint->children[0];
+    joint->name = "chain";
+    joint->name += static_cast<char>('0' + i);
+    joint->transform.translation =
+        ozz::math::Float3(static_cast<float>(i), 0.f, 2.f);
+    joint->transform.rotation = ozz::math::Quaternion::FromAxisAngle(
+        ozz::math::Float3::x_axis(), static_cast<float>(i) * .3f);
+    joint->transform.scale = ozz::math::Float3(1.f, 2.f, 1.f);
+  }
+
+  SkeletonBuilder builder;
+  Skeleton* skeleton = builder(raw_skeleton);
+  ASSERT_TRUE(skeleton != NULL);
+  ASSERT_EQ(skeleton->num_joints(), 6);
+
+  const ozz::math::Float4x4 root_matrix = ozz::math::Float4x4::Translation(
+      ozz::math::simd_float4::Load(4.f, 3.f, 2.f, 0.f));
+
+  // Reference aos output.
+  ozz::math::Float4x4 expected_output[6];
+  LocalToModelJob job;
+  job.skeleton = skeleton;
+  job.root = &root_matrix;
+  job.input = skeleton->joint_bind_poses();
+  job.output = expected_output;
+  ASSERT_TRUE(job.Run());
+
+  // Affine output.
+  ozz::math::Float3x4 affine_output[6];
+  job.output = ozz::Range<ozz::math::Float4x4>();
+  job.affine_output = affine_output;
+  ASSERT_TRUE(job.Validate());
+
+  // Affine output is too small.
+  job.affine_output.end = affine_output + 5;
+  EXPECT_FALSE(job.Validate());
+  job.affine_output.end = affine_output + 6;
+
+  ASSERT_TRUE(job.Run());
+
+  for (int i = 0; i < 6; ++i) {
+    const ozz::math::Float3x4 expected_affine =
+        ozz::math::ToFloat3x4(expected_output[i]);
+    for (int r = 0; r < 3; ++r) {
+      EXPECT_SIMDFLOAT_EQ(affine_output[i].rows[r],
+                          ozz::math::GetX(expected_affine.rows[r]),
+                          ozz::math::GetY(expected_affine.rows[r]),
+                          ozz::math::GetZ(expected_affine.rows[r]),
+                          ozz::math::GetW(expected_affine.rows[r]));
+    }
+  }
+
+  // Partial update, from a joint whose model-space matrix is read back from
+  // the affine output.
+  memset(affine_output + 3, 0, sizeof(affine_output[0]) * 3);
+  job.from = 2;
+  job.from_excluded = true;
+  ASSERT_TRUE(job.Run());
+  for (int i = 3; i < 6; ++i) {
+    const ozz::math::Float3x4 expected_affine =
+        ozz::math::ToFloat3x4(expected_output[i]);
+    for (int r = 0; r < 3; ++r) {
+      EXPECT_SIMDFLOAT_EQ(affine_output[i].rows[r],
+                          ozz::math::GetX(expected_affine.rows[r]),
+                          ozz::math::GetY(expected_affine.rows[r]),
+                          ozz::math::GetZ(expected_affine.rows[r]),
+                          ozz::math::GetW(expected_affine.rows[r]));
+    }
+  }
+
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+TEST(DirtyJoints, LocalToModel) {
+  // Builds a skeleton made of a root with 3 chains of 3 joints.
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  RawSkeleton::Joint& root = raw_skeleton.roots[0];
+  root.name = "root";
+  root.children.resize(3);
+  for (int i = 0; i < 3; ++i) {
+    RawSkeleton::Joint* joint = &root.children[i];
+    for (int j = 0; j < 3; ++j) {
+      if (j != 0) {
+        joint->children.resize(1);
+        joint = &joint->children[0];
+      }
+      joint->name = "joint";
+      joint->name += static_cast<char>('0' + i);
+      joint->name += static_cast<char>('0' + j);
+      joint->transform.translation = ozz::math::Float3(0.f, 1.f, 0.f);
+      joint->transform.rotation = ozz::math::Quaternion::FromAxisAngle(
+          ozz::math::Float3::z_axis(), static_cast<float>(i) * .3f);
+    }
+  }
+
+  SkeletonBuilder builder;
+  Skeleton* skeleton = builder(raw_skeleton);
+  ASSERT_TRUE(skeleton != NULL);
+  ASSERT_EQ(skeleton->num_joints(), 10);
+
+  // Joints are ordered depth-first: root, then chains [1,4[, [4,7[ and [7,10[.
+  ozz::math::SoaTransform input[3];
+  for (int i = 0; i < 3; ++i) {
+    input[i] = skeleton->joint_bind_poses()[i];
+  }
+
+  ozz::math::Float4x4 output[10];
+  LocalToModelJob job;
+  job.skeleton = skeleton;
+  job.input = input;
+  job.output = output;
+  ASSERT_TRUE(job.Run());
+
+  {  // Validates dirty joints.
+    const int unsorted[] = {3, 2};
+    const int duplicated[] = {2, 2};
+    const int out_of_range[] = {2, 10};
+    const int negative[] = {-1, 2};
+    const int valid[] = {2, 3, 5};
+    ozz::math::SoaFloat4x4 soa_output[3];
+
+    job.dirty_joints = unsorted;
+    EXPECT_FALSE(job.Validate());
+    job.dirty_joints = duplicated;
+    EXPECT_FALSE(job.Validate());
+    job.dirty_joints = out_of_range;
+    EXPECT_FALSE(job.Validate());
+    job.dirty_joints = negative;
+    EXPECT_FALSE(job.Validate());
+
+    job.dirty_joints = valid;
+    EXPECT_TRUE(job.Validate());
+    job.from = 1;
+    EXPECT_FALSE(job.Validate());
+    job.from = Skeleton::kNoParent;
+    job.to = 5;
+    EXPECT_FALSE(job.Validate());
+    job.to = Skeleton::kMaxJoints;
+    job.from_excluded = true;
+    EXPECT_FALSE(job.Validate());
+    job.from_excluded = false;
+    job.soa_output = soa_output;
+    EXPECT_FALSE(job.Validate());
+    job.soa_output = ozz::Range<ozz::math::SoaFloat4x4>();
+    EXPECT_TRUE(job.Validate());
+
+    // No dirty joint.
+    job.dirty_joints = ozz::Range<const int>(valid, static_cast<size_t>(0));
+    EXPECT_TRUE(job.Run());
+    job.dirty_joints = ozz::Range<const int>();
+  }
+
+  // Modifies joints 2 (nesting 3), 3 and 5, as ik would do.
+  input[0].translation.x = ozz::math::SetZ(input[0].translation.x,
+                                           ozz::math::simd_float4::Load1(1.f));
+  input[0].translation.x = ozz::math::SetW(input[0].translation.x,
+                                           ozz::math::simd_float4::Load1(2.f));
+  input[1].translation.x = ozz::math::SetY(input[1].translation.x,
+                                           ozz::math::simd_float4::Load1(3.f));
+
+  // Reference output.
+  ozz::math::Float4x4 expected_output[10];
+  job.output = expected_output;
+  ASSERT_TRUE(job.Run());
+
+  // Joints of the last chain aren't dirty, so they aren't updated.
+  for (int i = 7; i < 10; ++i) {
+    output[i] = ozz::math::Float4x4::identity();
+  }
+
+  const int dirty_joints[] = {2, 3, 5};
+  job.output = output;
+  job.dirty_joints = dirty_joints;
+  ASSERT_TRUE(job.Run());
+
+  for (int i = 0; i < 10; ++i) {
+    const ozz::math::Float4x4& expected =
+        i < 7 ? expected_output[i] : ozz::math::Float4x4::identity();
+    for (int c = 0; c < 4; ++c) {
+      EXPECT_SIMDFLOAT_EQ(output[i].cols[c], ozz::math::GetX(expected.cols[c]),
+                          ozz::math::GetY(expected.cols[c]),
+                          ozz::math::GetZ(expected.cols[c]),
+                          ozz::math::GetW(expected.cols[c]));
+    }
+  }
+
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+TEST(SkinningOutput, LocalToModel) {
+  // Builds a chain of 6 joints.
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  RawSkeleton::Joint* joint = &raw_skeleton.roots[0];
+  joint->name = "root";
+  for (int i = 0; i < 5; ++i) {
+    joint->children.resize(1);
+    joint = &joint->children[0];
+    joint->name = "chain";
+    joint->name += static_cast<char>('0' + i);
+    joint->transform.translation = ozz::math::Float3(0.f, 1.f, 0.f);
+    joint->transform.rotation = ozz::math::Quaternion::FromAxisAngle(
+        ozz::math::Float3::z_axis(), .2f);
+    joint->transform.scale = ozz::math::Float3(1.f, 1.5f, 1.f);
+  }
+
+  SkeletonBuilder builder;
+  Skeleton* skeleton = builder(raw_skeleton);
+  ASSERT_TRUE(skeleton != NULL);
+  ASSERT_EQ(skeleton->num_joints(), 6);
+
+  ozz::math::Float4x4 inverse_bind_poses[6];
+  for (int i = 0; i < 6; ++i) {
+    inverse_bind_poses[i] = ozz::math::Float4x4::Translation(
+        ozz::math::simd_float4::Load(0.f, -static_cast<float>(i), 0.f, 0.f));
+  }
+
+  ozz::math::Float4x4 output[6];
+  ozz::math::Float4x4 skinning_output[6];
+  LocalToModelJob job;
+  job.skeleton = skeleton;
+  job.input = skeleton->joint_bind_poses();
+  job.output = output;
+  job.skinning_output = skinning_output;
+  job.inverse_bind_poses = inverse_bind_poses;
+  EXPECT_TRUE(job.Validate());
+
+  // Validates sizes.
+  job.inverse_bind_poses.end = inverse_bind_poses + 5;
+  EXPECT_FALSE(job.Validate());
+  job.inverse_bind_poses.end = inverse_bind_poses + 6;
+  job.skinning_output.end = skinning_output + 5;
+  EXPECT_FALSE(job.Validate());
+  job.skinning_output.end = skinning_output + 6;
+
+  // Not supported with soa output.
+  ozz::math::SoaFloat4x4 soa_output[2];
+  job.soa_output = soa_output;
+  EXPECT_FALSE(job.Validate());
+  job.soa_output = ozz::Range<ozz::math::SoaFloat4x4>();
+
+  // Without remaps, skinning matrices are ordered like skeleton joints.
+  ASSERT_TRUE(job.Run());
+  for (int i = 0; i < 6; ++i) {
+    const ozz::math::Float4x4 expected = output[i] * inverse_bind_poses[i];
+    for (int c = 0; c < 4; ++c) {
+      EXPECT_SIMDFLOAT_EQ(skinning_output[i].cols[c],
+                          ozz::math::GetX(expected.cols[c]),
+                          ozz::math::GetY(expected.cols[c]),
+                          ozz::math::GetZ(expected.cols[c]),
+                          ozz::math::GetW(expected.cols[c]));
+    }
+  }
+
+  {  // Validates remaps.
+    const uint16_t unsorted[] = {3, 1};
+    const uint16_t out_of_range[] = {1, 6};
+    job.joint_remaps = unsorted;
+    EXPECT_FALSE(job.Validate());
+    job.joint_remaps = out_of_range;
+    EXPECT_FALSE(job.Validate());
+  }
+
+  // Remaps skinning matrices, with a partial update of joints [2,6[. Joint 1
+  // is remapped twice to test mesh joints sharing the same skeleton joint.
+  const uint16_t joint_remaps[] = {1, 1, 3, 5};
+  job.joint_remaps = joint_remaps;
+  ASSERT_TRUE(job.Validate());
+
+  // Too many remaps for the skinning output.
+  const uint16_t too_many_remaps[] = {0, 1, 1, 2, 3, 4, 5};
+  job.joint_remaps = too_many_remaps;
+  EXPECT_FALSE(job.Validate());
+  job.joint_remaps = joint_remaps;
+
+  for (int i = 0; i < 6; ++i) {
+    skinning_output[i] = ozz::math::Float4x4::identity();
+  }
+  job.from = 2;
+  ASSERT_TRUE(job.Run());
+  for (int i = 0; i < 6; ++i) {
+    // Only joints 3 and 5 are updated.
+    const ozz::math::Float4x4 expected =
+        (i == 2 || i == 3)
+            ? output[joint_remaps[i]] * inverse_bind_poses[i]
+            : ozz::math::Float4x4::identity();
+    for (int c = 0; c < 4; ++c) {
+      EXPECT_SIMDFLOAT_EQ(skinning_output[i].cols[c],
+                          ozz::math::GetX(expected.cols[c]),
+                          ozz::math::GetY(expected.cols[c]),
+                          ozz::math::GetZ(expected.cols[c]),
+                          ozz::math::GetW(expected.cols[c]));
+    }
+  }
+
+  // Full update, with dirty joints.
+  const int dirty_joints[] = {0};
+  job.from = Skeleton::kNoParent;
+  job.dirty_joints = dirty_joints;
+  ASSERT_TRUE(job.Run());
+  for (int i = 0; i < 4; ++i) {
+    const ozz::math::Float4x4 expected =
+        output[joint_remaps[i]] * inverse_bind_poses[i];
+    for (int c = 0; c < 4; ++c) {
+      EXPECT_SIMDFLOAT_EQ(skinning_output[i].cols[c],
+                          ozz::math::GetX(expected.cols[c]),
+                          ozz::math::GetY(expected.cols[c]),
+                          ozz::math::GetZ(expected.cols[c]),
+                          ozz::math::GetW(expected.cols[c]));
+    }
+  }
+
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+TEST(RequiredJoints, LocalToModel) {
+  // Builds a skeleton made of a root with 3 chains of 3 joints.
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  RawSkeleton::Joint& root = raw_skeleton.roots[0];
+  root.name = "root";
+  root.children.resize(3);
+  for (int i = 0; i < 3; ++i) {
+    RawSkeleton::Joint* joint = &root.children[i];
+    for (int j = 0; j < 3; ++j) {
+      if (j != 0) {
+        joint->children.resize(1);
+        joint = &joint->children[0];
+      }
+      joint->name = "joint";
+      joint->name += static_cast<char>('0' + i);
+      joint->name += static_cast<char>('0' + j);
+      joint->transform.translation = ozz::math::Float3(0.f, 1.f, 0.f);
+      joint->transform.rotation = ozz::math::Quaternion::FromAxisAngle(
+          ozz::math::Float3::z_axis(), static_cast<float>(i) * .3f);
+    }
+  }
+
+  SkeletonBuilder builder;
+  Skeleton* skeleton = builder(raw_skeleton);
+  ASSERT_TRUE(skeleton != NULL);
+  ASSERT_EQ(skeleton->num_joints(), 10);
+
+  ozz::math::SoaTransform input[3];
+  for (int i = 0; i < 3; ++i) {
+    input[i] = skeleton->joint_bind_poses()[i];
+  }
+
+  ozz::math::Float4x4 expected_output[10];
+  LocalToModelJob job;
+  job.skeleton = skeleton;
+  job.input = input;
+  job.output = expected_output;
+  ASSERT_TRUE(job.Run());
+
+  // The mesh uses joints 2 and 5, which requires joints 0, 1, 2, 4 and 5.
+  const uint16_t joint_remaps[] = {2, 5};
+  bool required[10] = {false};
+  EXPECT_EQ(ozz::animation::GetRequiredJoints(*skeleton, joint_remaps,
+                                              required),
+            5);
+  job.required_joints = required;
+  EXPECT_TRUE(job.Validate());
+
+  {  // Validates required joints.
+    LocalToModelJob invalid = job;
+    invalid.required_joints = ozz::Range<const bool>(required, 9);
+    EXPECT_FALSE(invalid.Validate());
+    ozz::math::SoaFloat4x4 soa_output[3];
+    invalid = job;
+    invalid.soa_output = soa_output;
+    EXPECT_FALSE(invalid.Validate());
+  }
+
+  ozz::math::Float4x4 inverse_bind_poses[2] = {
+      ozz::math::Float4x4::identity(), ozz::math::Float4x4::identity()};
+  job.skinning_output = ozz::Range<ozz::math::Float4x4>();
+  job.inverse_bind_poses = inverse_bind_poses;
+  job.joint_remaps = joint_remaps;
+
+  // Tests every update mode.
+  for (int mode = 0; mode < 2; ++mode) {
+    ozz::math::Float4x4 output[10];
+    ozz::math::Float4x4 skinning_output[2];
+    for (int i = 0; i < 10; ++i) {
+      output[i] = ozz::math::Float4x4::Scaling(
+          ozz::math::simd_float4::Load1(2.f));
+    }
+    job.output = output;
+    job.skinning_output = skinning_output;
+    const int dirty_joints[] = {0};
+    job.dirty_joints = mode == 0 ? ozz::Range<const int>()
+                                 : ozz::Range<const int>(dirty_joints, 1);
+    ASSERT_TRUE(job.Run());
+
+    for (int i = 0; i < 10; ++i) {
+      const ozz::math::Float4x4& expected =
+          required[i] ? expected_output[i]
+                      : ozz::math::Float4x4::Scaling(
+                            ozz::math::simd_float4::Load1(2.f));
+      for (int c = 0; c < 4; ++c) {
+        EXPECT_SIMDFLOAT_EQ(output[i].cols[c],
+                            ozz::math::GetX(expected.cols[c]),
+                            ozz::math::GetY(expected.cols[c]),
+                            ozz::math::GetZ(expected.cols[c]),
+                            ozz::math::GetW(expected.cols[c]));
+      }
+    }
+    for (int i = 0; i < 2; ++i) {
+      const ozz::math::Float4x4& expected = expected_output[joint_remaps[i]];
+      for (int c = 0; c < 4; ++c) {
+        EXPECT_SIMDFLOAT_EQ(skinning_output[i].cols[c],
+                            ozz::math::GetX(expected.cols[c]),
+                            ozz::math::GetY(expected.cols[c]),
+                            ozz::math::GetZ(expected.cols[c]),
+                            ozz::math::GetW(expected.cols[c]));
+      }
+    }
+  }
+
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
 TEST(Empty, LocalToModel) {
   Skeleton skeleton;
 
@@ -0,0 +1,210 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+#include "ozz/animation/runtime/animation_instance.h"
+#include "ozz/animation/runtime/lod_governor.h"
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/memory/allocator.h"
+
+#include "ozz/animation/offline/raw_skeleton.h"
+#include "ozz/animation/offline/skeleton_builder.h"
+#include "ozz/animation/runtime/skeleton.h"
+
+using ozz::animation::LODGovernor;
+using ozz::animation::Skeleton;
+using ozz::animation::offline::RawSkeleton;
+using ozz::animation::offline::SkeletonBuilder;
+
+namespace {
+// Builds a 8 joints skeleton, whose LOD 1 excludes 4 leaves.
+Skeleton* BuildSkeleton() {
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  RawSkeleton::Joint& root = raw_skeleton.roots[0];
+  root.name = "root";
+  root.children.resize(7);
+  const char* names[] = {"a", "b", "c", "d", "e", "f", "g"};
+  for (int i = 0; i < 7; ++i) {
+    root.children[i].name = names[i];
+  }
+  SkeletonBuilder builder;
+  builder.lods.resize(1);
+  builder.lods[0].excluded_joints.push_back("d");
+  builder.lods[0].excluded_joints.push_back("e");
+  builder.lods[0].excluded_joints.push_back("f");
+  builder.lods[0].excluded_joints.push_back("g");
+  return builder(raw_skeleton);
+}
+}  // namespace
+
+TEST(Initialize, LODGovernor) {
+  Skeleton* skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton != NULL);
+  ASSERT_EQ(skeleton->num_lods(), 2);
+  ASSERT_EQ(skeleton->lod_num_joints(1), 4);
+
+  LODGovernor governor;
+  EXPECT_EQ(governor.num_levels(), 0);
+  float priority = 1.f;
+  LODGovernor::Decision decision;
+  EXPECT_FALSE(governor.Run(ozz::Range<const float>(&priority, 1),
+                            ozz::Range<LODGovernor::Decision>(&decision, 1)));
+
+  // Invalid levels.
+  EXPECT_FALSE(governor.Initialize(
+      *skeleton, ozz::Range<const LODGovernor::Level>(), 1.f));
+  {
+    const LODGovernor::Level levels[] = {{2, 1, 0}};
+    EXPECT_FALSE(governor.Initialize(*skeleton, levels, 1.f));
+  }
+  {
+    const LODGovernor::Level levels[] = {{0, 0, 0}};
+    EXPECT_FALSE(governor.Initialize(*skeleton, levels, 1.f));
+  }
+  {
+    const LODGovernor::Level levels[] = {{0, 1, 0}};
+    EXPECT_FALSE(governor.Initialize(*skeleton, levels, -1.f));
+    EXPECT_FALSE(governor.Initialize(Skeleton(), levels, 1.f));
+  }
+
+  // Initial costs are proportional to LOD number of joints.
+  const LODGovernor::Level levels[] = {{0, 1, 4}, {1, 1, 2}, {1, 4, 0}};
+  ASSERT_TRUE(governor.Initialize(*skeleton, levels, 8.f));
+  EXPECT_EQ(governor.num_levels(), 3);
+  EXPECT_FLOAT_EQ(governor.cost(0), 8.f);
+  EXPECT_FLOAT_EQ(governor.cost(1), 4.f);
+  EXPECT_FLOAT_EQ(governor.cost(2), 4.f);
+
+  // Measures.
+  EXPECT_FALSE(governor.Measure(3, 1, 1.f));
+  EXPECT_FALSE(governor.Measure(0, 0, 1.f));
+  governor.smoothing = .5f;
+  EXPECT_TRUE(governor.Measure(0, 2, 8.f));
+  EXPECT_FLOAT_EQ(governor.cost(0), 6.f);
+  governor.smoothing = 1.f;
+  EXPECT_TRUE(governor.Measure(0, 4, 40.f));
+  EXPECT_FLOAT_EQ(governor.cost(0), 10.f);
+
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+TEST(Run, LODGovernor) {
+  Skeleton* skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton != NULL);
+
+  LODGovernor governor;
+  const LODGovernor::Level levels[] = {{0, 1, 4}, {1, 1, 2}, {1, 4, 0}};
+  ASSERT_TRUE(governor.Initialize(*skeleton, levels, 8.f));
+
+  // Costs per frame are 8, 4 and 1 per instance.
+  const float priorities[] = {1.f, 2.f, 1.f, 0.f};
+  LODGovernor::Decision decisions[4];
+
+  // Invalid arguments.
+  EXPECT_FALSE(governor.Run(priorities, ozz::Range<LODGovernor::Decision>(
+                                            decisions, 3)));
+  const float negative[] = {1.f, -1.f};
+  EXPECT_FALSE(governor.Run(negative, decisions));
+
+  // Big budget, only priority 0 instance is degraded.
+  governor.budget = 100.f;
+  ASSERT_TRUE(governor.Run(priorities, decisions));
+  EXPECT_EQ(decisions[0].level, 0);
+  EXPECT_EQ(decisions[1].level, 0);
+  EXPECT_EQ(decisions[2].level, 0);
+  EXPECT_EQ(decisions[3].level, 2);
+  EXPECT_FLOAT_EQ(governor.planned_cost(), 25.f);
+
+  // Level content.
+  EXPECT_EQ(decisions[0].lod, 0);
+  EXPECT_EQ(decisions[0].num_joints, 8);
+  EXPECT_EQ(decisions[0].skinning, 4);
+  EXPECT_EQ(decisions[0].mask.count(), 1u);
+  EXPECT_EQ(decisions[0].mask[0], 3);
+  EXPECT_TRUE(decisions[0].update);
+  EXPECT_EQ(decisions[3].lod, 1);
+  EXPECT_EQ(decisions[3].num_joints, 4);
+  EXPECT_EQ(decisions[3].skinning, 0);
+  EXPECT_EQ(decisions[3].mask[0], 1);
+
+  // Priority 1 instances are degraded first.
+  governor.budget = 17.f;
+  ASSERT_TRUE(governor.Run(priorities, decisions));
+  EXPECT_EQ(decisions[0].level, 1);
+  EXPECT_EQ(decisions[1].level, 0);
+  EXPECT_EQ(decisions[2].level, 1);
+  EXPECT_EQ(decisions[3].level, 2);
+  EXPECT_FLOAT_EQ(governor.planned_cost(), 17.f);
+
+  // Priority 2 instance is degraded a level when others are degraded 2.
+  governor.budget = 7.f;
+  ASSERT_TRUE(governor.Run(priorities, decisions));
+  EXPECT_EQ(decisions[0].level, 2);
+  EXPECT_EQ(decisions[1].level, 1);
+  EXPECT_EQ(decisions[2].level, 2);
+  EXPECT_EQ(decisions[3].level, 2);
+  EXPECT_FLOAT_EQ(governor.planned_cost(), 7.f);
+
+  // Budget can't be met.
+  governor.budget = 1.f;
+  ASSERT_TRUE(governor.Run(priorities, decisions));
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_EQ(decisions[i].level, 2);
+  }
+  EXPECT_FLOAT_EQ(governor.planned_cost(), 4.f);
+
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+TEST(UpdateInterval, LODGovernor) {
+  Skeleton* skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton != NULL);
+
+  LODGovernor governor;
+  const LODGovernor::Level levels[] = {{1, 3, 0}};
+  ASSERT_TRUE(governor.Initialize(*skeleton, levels, 1.f));
+
+  // Every instance is updated once every 3 frames, and updates are spread.
+  const float priorities[6] = {1.f, 1.f, 1.f, 1.f, 1.f, 1.f};
+  LODGovernor::Decision decisions[6];
+  int updates[6] = {0};
+  for (int frame = 0; frame < 9; ++frame) {
+    ASSERT_TRUE(governor.Run(priorities, decisions));
+    int frame_updates = 0;
+    for (int i = 0; i < 6; ++i) {
+      updates[i] += decisions[i].update;
+      frame_updates += decisions[i].update;
+    }
+    EXPECT_EQ(frame_updates, 2);
+  }
+  for (int i = 0; i < 6; ++i) {
+    EXPECT_EQ(updates[i], 3);
+  }
+
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
@@ -0,0 +1,223 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+#include "ozz/animation/runtime/animation_instance.h"
+#include "ozz/animation/runtime/memory_usage.h"
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/allocator.h"
+#include "ozz/base/memory/tracking_allocator.h"
+
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/raw_skeleton.h"
+#include "ozz/animation/offline/raw_track.h"
+#include "ozz/animation/offline/skeleton_builder.h"
+#include "ozz/animation/offline/track_builder.h"
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/animation_instance.h"
+#include "ozz/animation/runtime/sampling_job.h"
+#include "ozz/animation/runtime/skeleton.h"
+
+using ozz::animation::Animation;
+using ozz::animation::AnimationInstance;
+using ozz::animation::FloatTrack;
+using ozz::animation::MemoryUsage;
+using ozz::animation::SamplingCache;
+using ozz::animation::Skeleton;
+using ozz::animation::offline::AnimationBuilder;
+using ozz::animation::offline::RawAnimation;
+using ozz::animation::offline::RawFloatTrack;
+using ozz::animation::offline::RawSkeleton;
+using ozz::animation::offline::SkeletonBuilder;
+using ozz::animation::offline::TrackBuilder;
+
+TEST(Accumulate, MemoryUsage) {
+  MemoryUsage usage;
+  EXPECT_EQ(usage.data, 0u);
+  EXPECT_EQ(usage.metadata, 0u);
+  EXPECT_EQ(usage.total(), 0u);
+
+  MemoryUsage other;
+  other.data = 3;
+  other.metadata = 5;
+  usage += other;
+  usage += other;
+  EXPECT_EQ(usage.data, 6u);
+  EXPECT_EQ(usage.metadata, 10u);
+  EXPECT_EQ(usage.total(), 16u);
+}
+
+TEST(Animation, MemoryUsage) {
+  // Empty animation.
+  {
+    Animation animation;
+    const MemoryUsage usage = GetMemoryUsage(animation);
+    EXPECT_EQ(usage.data, 0u);
+    EXPECT_EQ(usage.total(), animation.size());
+  }
+
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.name = "anim";
+  raw_animation.tracks.resize(5);
+  const RawAnimation::TranslationKey key0 = {
+      .2f, ozz::math::Float3(1.f, 2.f, 3.f)};
+  const RawAnimation::TranslationKey key1 = {
+      .7f, ozz::math::Float3(3.f, 2.f, 1.f)};
+  raw_animation.tracks[0].translations.push_back(key0);
+  raw_animation.tracks[0].translations.push_back(key1);
+
+  AnimationBuilder builder;
+  Animation* animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+  const MemoryUsage usage = GetMemoryUsage(*animation);
+  EXPECT_EQ(usage.data,
+            animation->translations().size() + animation->rotations().size() +
+                animation->scales().size() +
+                animation->translation_values().size() +
+                animation->scale_values().size());
+  EXPECT_EQ(usage.total(), animation->size() + 5);
+  ozz::memory::default_allocator()->Delete(animation);
+
+  // Spline tangents are key data.
+  builder.spline = true;
+  animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+  const MemoryUsage spline_usage = GetMemoryUsage(*animation);
+  EXPECT_GT(spline_usage.data, usage.data);
+  EXPECT_EQ(spline_usage.metadata, usage.metadata);
+  EXPECT_EQ(spline_usage.total(), animation->size() + 5);
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+TEST(Skeleton, MemoryUsage) {
+  // Empty skeleton.
+  {
+    Skeleton skeleton;
+    const MemoryUsage usage = GetMemoryUsage(skeleton);
+    EXPECT_EQ(usage.data, 0u);
+    EXPECT_EQ(usage.metadata, sizeof(Skeleton));
+  }
+
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  raw_skeleton.roots[0].name = "root";
+  raw_skeleton.roots[0].children.resize(5);
+  for (size_t i = 0; i < 5; ++i) {
+    raw_skeleton.roots[0].children[i].name = "child";
+  }
+
+  SkeletonBuilder builder;
+  Skeleton* skeleton = builder(raw_skeleton);
+  ASSERT_TRUE(skeleton != NULL);
+  const MemoryUsage usage = GetMemoryUsage(*skeleton);
+  EXPECT_EQ(usage.data, 2 * sizeof(ozz::math::SoaTransform));
+  // Names take 5 + 5 * 6 characters.
+  EXPECT_GE(usage.metadata, sizeof(Skeleton) + 6 * sizeof(int16_t) + 35);
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+TEST(SamplingCache, MemoryUsage) {
+  ozz::memory::TrackingAllocator tracking(ozz::memory::default_allocator());
+  for (int i = 0; i < 3; ++i) {
+    const SamplingCache::Mode mode = static_cast<SamplingCache::Mode>(i);
+    SamplingCache cache(13, mode, &tracking);
+    const MemoryUsage usage = GetMemoryUsage(cache);
+    EXPECT_EQ(usage.data, tracking.stats().live_bytes);
+    EXPECT_EQ(usage.metadata, sizeof(SamplingCache));
+  }
+
+  SamplingCache empty;
+  EXPECT_EQ(GetMemoryUsage(empty).data, 0u);
+}
+
+TEST(AnimationInstance, MemoryUsage) {
+  AnimationInstance* instance = AnimationInstance::New(
+      7, 9, SamplingCache::kFull, ozz::memory::default_allocator());
+  ASSERT_TRUE(instance != NULL);
+  const MemoryUsage usage = GetMemoryUsage(*instance);
+  EXPECT_EQ(usage.total(), instance->size());
+  EXPECT_EQ(usage.metadata, sizeof(AnimationInstance));
+  AnimationInstance::Delete(instance);
+}
+
+TEST(Track, MemoryUsage) {
+  RawFloatTrack raw_track;
+  raw_track.name = "track";
+  const RawFloatTrack::Keyframe key0 = {
+      ozz::animation::offline::RawTrackInterpolation::kLinear, 0.f, 0.f};
+  const RawFloatTrack::Keyframe key1 = {
+      ozz::animation::offline::RawTrackInterpolation::kStep, 1.f, 1.f};
+  raw_track.keyframes.push_back(key0);
+  raw_track.keyframes.push_back(key1);
+
+  TrackBuilder builder;
+  FloatTrack* track = builder(raw_track);
+  ASSERT_TRUE(track != NULL);
+  const MemoryUsage usage = GetMemoryUsage(*track);
+  EXPECT_EQ(usage.data, track->ratios().size() + track->values().size() +
+                            track->steps().size());
+  EXPECT_EQ(usage.total(), track->size() + 6);
+  ozz::memory::default_allocator()->Delete(track);
+}
+
+TEST(WorkingSet, MemoryUsage) {
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  raw_skeleton.roots[0].children.resize(5);
+  Skeleton* skeleton = SkeletonBuilder()(raw_skeleton);
+  ASSERT_TRUE(skeleton != NULL);
+
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(6);
+  Animation* animation = AnimationBuilder()(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+
+  // Invalid number of layers.
+  EXPECT_EQ(ComputeWorkingSetUsage(*skeleton, *animation, 0).total(), 0u);
+
+  const size_t cache_size =
+      SamplingCache::AllocationSize(6, SamplingCache::kFull);
+  const size_t pose_size = 2 * sizeof(ozz::math::SoaTransform);
+  const size_t models_size = 6 * sizeof(ozz::math::Float4x4);
+
+  // A single layer doesn't need blending output.
+  const MemoryUsage one = ComputeWorkingSetUsage(*skeleton, *animation, 1);
+  EXPECT_EQ(one.data, cache_size + pose_size + models_size);
+  EXPECT_EQ(one.metadata, sizeof(SamplingCache));
+
+  const MemoryUsage three = ComputeWorkingSetUsage(*skeleton, *animation, 3);
+  EXPECT_EQ(three.data, 3 * (cache_size + pose_size) + pose_size + models_size);
+  EXPECT_EQ(three.metadata, 3 * sizeof(SamplingCache));
+
+  ozz::memory::default_allocator()->Delete(animation);
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
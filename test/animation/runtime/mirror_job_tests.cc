@@ -0,0 +1,258 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#include "ozz/animation/runtime/mirror_job.h"
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/allocator.h"
+
+#include "ozz/animation/offline/raw_skeleton.h"
+#include "ozz/animation/offline/skeleton_builder.h"
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/animation/runtime/skeleton_utils.h"
+
+using ozz::animation::MirrorJob;
+using ozz::animation::Skeleton;
+using ozz::animation::offline::RawSkeleton;
+using ozz::animation::offline::SkeletonBuilder;
+
+namespace {
+// Fills _pose with translations (i, 10 + i, 20 + i) and rotations
+// (.1 + i, .2 + i, .3 + i, .4 + i), where i is the joint index.
+void FillPose(ozz::math::SoaTransform* _pose, int _num_soa) {
+  for (int i = 0; i < _num_soa; ++i) {
+    const float f = static_cast<float>(i * 4);
+    const ozz::math::SimdFloat4 index =
+        ozz::math::simd_float4::Load(f, f + 1.f, f + 2.f, f + 3.f);
+    _pose[i] = ozz::math::SoaTransform::identity();
+    _pose[i].translation.x = index;
+    _pose[i].translation.y = index + ozz::math::simd_float4::Load1(10.f);
+    _pose[i].translation.z = index + ozz::math::simd_float4::Load1(20.f);
+    _pose[i].rotation.x = index + ozz::math::simd_float4::Load1(.1f);
+    _pose[i].rotation.y = index + ozz::math::simd_float4::Load1(.2f);
+    _pose[i].rotation.z = index + ozz::math::simd_float4::Load1(.3f);
+    _pose[i].rotation.w = index + ozz::math::simd_float4::Load1(.4f);
+  }
+}
+
+// Builds a symmetric skeleton: "hips" root, with "spine", "leg_l" and "leg_r"
+// children. Legs have a "foot_l" and "foot_r" child.
+Skeleton* BuildSkeleton() {
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  RawSkeleton::Joint& hips = raw_skeleton.roots[0];
+  hips.name = "hips";
+  hips.transform.translation = ozz::math::Float3(0.f, 1.f, 0.f);
+  hips.children.resize(3);
+  hips.children[0].name = "spine";
+  hips.children[0].transform.translation = ozz::math::Float3(0.f, 1.f, 0.f);
+  hips.children[0].transform.rotation =
+      ozz::math::Quaternion::FromAxisAngle(ozz::math::Float3::x_axis(), .3f);
+  const char* names[2][2] = {{"leg_l", "foot_l"}, {"leg_r", "foot_r"}};
+  for (int s = 0; s < 2; ++s) {
+    const float side = s == 0 ? 1.f : -1.f;
+    RawSkeleton::Joint& leg = hips.children[1 + s];
+    leg.name = names[s][0];
+    leg.transform.translation = ozz::math::Float3(side * .2f, -.1f, .05f);
+    leg.transform.rotation = ozz::math::Quaternion::FromAxisAngle(
+        ozz::math::Float3(side * .48f, .6f, .64f), side * .7f);
+    leg.children.resize(1);
+    RawSkeleton::Joint& foot = leg.children[0];
+    foot.name = names[s][1];
+    foot.transform.translation = ozz::math::Float3(side * .1f, -.5f, .2f);
+    foot.transform.rotation = ozz::math::Quaternion::FromAxisAngle(
+        ozz::math::Float3(0.f, .8f, .6f), side * .4f);
+    foot.transform.scale = ozz::math::Float3(1.f, 2.f, 3.f);
+  }
+  SkeletonBuilder builder;
+  return builder(raw_skeleton);
+}
+}  // namespace
+
+TEST(Validate, MirrorJob) {
+  ozz::math::SoaTransform input[2];
+  ozz::math::SoaTransform output[2];
+  const int mirror[] = {0, 2, 1, 3, 7};
+
+  {  // Empty/default job.
+    MirrorJob job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Valid job.
+    MirrorJob job;
+    job.mirror = ozz::Range<const int>(mirror, OZZ_ARRAY_SIZE(mirror));
+    job.input.begin = input;
+    job.input.end = input + 2;
+    job.output.begin = output;
+    job.output.end = output + 2;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+
+    // Output too small.
+    job.output.end = output + 1;
+    EXPECT_FALSE(job.Validate());
+
+    // In place.
+    job.output.begin = input;
+    job.output.end = input + 2;
+    EXPECT_FALSE(job.Validate());
+  }
+
+  {  // Mirror entry out of range.
+    MirrorJob job;
+    job.mirror = ozz::Range<const int>(mirror, OZZ_ARRAY_SIZE(mirror));
+    job.input.begin = input;
+    job.input.end = input + 1;
+    job.output.begin = output;
+    job.output.end = output + 2;
+    EXPECT_FALSE(job.Validate());
+  }
+}
+
+TEST(Mirror, MirrorJob) {
+  ozz::math::SoaTransform input[2];
+  FillPose(input, 2);
+  ozz::math::SoaTransform output[2];
+
+  // First block is its own mirror, second one swaps joints 4 and 6.
+  const int mirror[] = {0, 1, 2, 3, 6, 5, 4, 7};
+  MirrorJob job;
+  job.mirror = ozz::Range<const int>(mirror, OZZ_ARRAY_SIZE(mirror));
+  job.input.begin = input;
+  job.input.end = input + 2;
+  job.output.begin = output;
+  job.output.end = output + 2;
+  ASSERT_TRUE(job.Run());
+
+  // Plane of normal x negates translation x, rotation y and z.
+  EXPECT_SOAFLOAT3_EQ(output[0].translation, -0.f, -1.f, -2.f, -3.f, 10.f, 11.f,
+                      12.f, 13.f, 20.f, 21.f, 22.f, 23.f);
+  EXPECT_SOAQUATERNION_EQ_EST(output[0].rotation, .1f, 1.1f, 2.1f, 3.1f, -.2f,
+                              -1.2f, -2.2f, -3.2f, -.3f, -1.3f, -2.3f, -3.3f,
+                              .4f, 1.4f, 2.4f, 3.4f);
+  EXPECT_SOAFLOAT3_EQ(output[1].translation, -6.f, -5.f, -4.f, -7.f, 16.f, 15.f,
+                      14.f, 17.f, 26.f, 25.f, 24.f, 27.f);
+  EXPECT_SOAQUATERNION_EQ_EST(output[1].rotation, 6.1f, 5.1f, 4.1f, 7.1f,
+                              -6.2f, -5.2f, -4.2f, -7.2f, -6.3f, -5.3f, -4.3f,
+                              -7.3f, 6.4f, 5.4f, 4.4f, 7.4f);
+  EXPECT_SOAFLOAT3_EQ(output[1].scale, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f,
+                      1.f, 1.f, 1.f, 1.f);
+
+  // Plane of normal y.
+  job.axis = MirrorJob::kY;
+  ASSERT_TRUE(job.Run());
+  EXPECT_SOAFLOAT3_EQ(output[0].translation, 0.f, 1.f, 2.f, 3.f, -10.f, -11.f,
+                      -12.f, -13.f, 20.f, 21.f, 22.f, 23.f);
+  EXPECT_SOAQUATERNION_EQ_EST(output[0].rotation, -.1f, -1.1f, -2.1f, -3.1f,
+                              .2f, 1.2f, 2.2f, 3.2f, -.3f, -1.3f, -2.3f, -3.3f,
+                              .4f, 1.4f, 2.4f, 3.4f);
+
+  // Plane of normal z.
+  job.axis = MirrorJob::kZ;
+  ASSERT_TRUE(job.Run());
+  EXPECT_SOAFLOAT3_EQ(output[0].translation, 0.f, 1.f, 2.f, 3.f, 10.f, 11.f,
+                      12.f, 13.f, -20.f, -21.f, -22.f, -23.f);
+  EXPECT_SOAQUATERNION_EQ_EST(output[0].rotation, -.1f, -1.1f, -2.1f, -3.1f,
+                              -.2f, -1.2f, -2.2f, -3.2f, .3f, 1.3f, 2.3f, 3.3f,
+                              .4f, 1.4f, 2.4f, 3.4f);
+
+  // Mirroring twice restores the original pose.
+  ozz::math::SoaTransform restored[2];
+  MirrorJob back;
+  back.axis = MirrorJob::kZ;
+  back.mirror = job.mirror;
+  back.input.begin = output;
+  back.input.end = output + 2;
+  back.output.begin = restored;
+  back.output.end = restored + 2;
+  ASSERT_TRUE(back.Run());
+  EXPECT_SOAFLOAT3_EQ(restored[1].translation, 4.f, 5.f, 6.f, 7.f, 14.f, 15.f,
+                      16.f, 17.f, 24.f, 25.f, 26.f, 27.f);
+  EXPECT_SOAQUATERNION_EQ_EST(restored[1].rotation, 4.1f, 5.1f, 6.1f, 7.1f,
+                              4.2f, 5.2f, 6.2f, 7.2f, 4.3f, 5.3f, 6.3f, 7.3f,
+                              4.4f, 5.4f, 6.4f, 7.4f);
+}
+
+TEST(BuildJointMirror, MirrorJob) {
+  Skeleton* skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton != NULL);
+  ASSERT_EQ(skeleton->num_joints(), 6);
+
+  int mirror[6];
+
+  // Table too small.
+  EXPECT_EQ(ozz::animation::BuildJointMirror(*skeleton, "_l", "_r",
+                                             ozz::Range<int>(mirror, 5)),
+            -1);
+
+  // Joints are ordered depth first.
+  EXPECT_EQ(ozz::animation::BuildJointMirror(*skeleton, "_l", "_r",
+                                             ozz::Range<int>(mirror, 6)),
+            4);
+  const int expected[] = {0, 1, 4, 5, 2, 3};
+  for (int i = 0; i < 6; ++i) {
+    EXPECT_EQ(mirror[i], expected[i]);
+  }
+
+  // Unknown tokens pair no joint.
+  int identity[6];
+  EXPECT_EQ(ozz::animation::BuildJointMirror(*skeleton, "Left", "Right",
+                                             ozz::Range<int>(identity, 6)),
+            0);
+  for (int i = 0; i < 6; ++i) {
+    EXPECT_EQ(identity[i], i);
+  }
+
+  // Mirroring the symmetric bind pose leaves it unchanged.
+  ozz::math::SoaTransform output[2];
+  MirrorJob job;
+  job.mirror = ozz::Range<const int>(mirror, OZZ_ARRAY_SIZE(mirror));
+  job.input = skeleton->joint_bind_poses();
+  job.output.begin = output;
+  job.output.end = output + 2;
+  ASSERT_TRUE(job.Run());
+
+  const float* expected_floats =
+      reinterpret_cast<const float*>(skeleton->joint_bind_poses().begin);
+  const float* output_floats = reinterpret_cast<const float*>(output);
+  for (int i = 0; i < 6; ++i) {
+    const int soa = i / 4 * 40;
+    const int lane = i & 3;
+    for (int c = 0; c < 10; ++c) {
+      EXPECT_NEAR(output_floats[soa + c * 4 + lane],
+                  expected_floats[soa + c * 4 + lane], 1e-6f);
+    }
+  }
+
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
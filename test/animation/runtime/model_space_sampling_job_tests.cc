@@ -0,0 +1,253 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/model_space_sampling_job.h"
+
+#include <cstring>
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/allocator.h"
+
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/local_to_model_job.h"
+#include "ozz/animation/runtime/sampling_job.h"
+#include "ozz/animation/runtime/skeleton.h"
+
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/raw_skeleton.h"
+#include "ozz/animation/offline/skeleton_builder.h"
+
+using ozz::animation::Animation;
+using ozz::animation::LocalToModelJob;
+using ozz::animation::ModelSpaceSamplingJob;
+using ozz::animation::SamplingCache;
+using ozz::animation::SamplingJob;
+using ozz::animation::Skeleton;
+using ozz::animation::offline::AnimationBuilder;
+using ozz::animation::offline::RawAnimation;
+using ozz::animation::offline::RawSkeleton;
+using ozz::animation::offline::SkeletonBuilder;
+
+namespace {
+// Builds a 10 joints skeleton: a root (0) with 2 chains of children, 1 to 5
+// and 6 to 9.
+Skeleton* BuildSkeleton() {
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  RawSkeleton::Joint& root = raw_skeleton.roots[0];
+  root.children.resize(2);
+  RawSkeleton::Joint* joint = &root.children[0];
+  for (int i = 0; i < 4; ++i) {
+    joint->children.resize(1);
+    joint = &joint->children[0];
+  }
+  joint = &root.children[1];
+  for (int i = 0; i < 3; ++i) {
+    joint->children.resize(1);
+    joint = &joint->children[0];
+  }
+  SkeletonBuilder builder;
+  return builder(raw_skeleton);
+}
+
+// Builds an animation that moves and rotates every joint differently.
+Animation* BuildAnimation(int _num_tracks) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(_num_tracks);
+  for (int i = 0; i < _num_tracks; ++i) {
+    const float f = static_cast<float>(i);
+    const RawAnimation::TranslationKey tkeys[] = {
+        {0.f, ozz::math::Float3(f, 1.f, 0.f)},
+        {1.f, ozz::math::Float3(0.f, f, 1.f)}};
+    raw_animation.tracks[i].translations.assign(tkeys, tkeys + 2);
+    const RawAnimation::RotationKey rkey = {
+        0.f, ozz::math::Quaternion::FromAxisAngle(ozz::math::Float3::y_axis(),
+                                                  f * .1f)};
+    raw_animation.tracks[i].rotations.push_back(rkey);
+  }
+  AnimationBuilder builder;
+  return builder(raw_animation);
+}
+
+bool Equal(const ozz::math::Float4x4& _a, const ozz::math::Float4x4& _b) {
+  bool equal = true;
+  for (int i = 0; i < 4; ++i) {
+    equal &= ozz::math::AreAllTrue(ozz::math::CmpEq(_a.cols[i], _b.cols[i]));
+  }
+  return equal;
+}
+}  // namespace
+
+TEST(JobValidity, ModelSpaceSamplingJob) {
+  Skeleton* skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton != NULL);
+  ASSERT_EQ(skeleton->num_joints(), 10);
+  Animation* animation = BuildAnimation(10);
+  ASSERT_TRUE(animation != NULL);
+  Animation* small_animation = BuildAnimation(4);
+  ASSERT_TRUE(small_animation != NULL);
+
+  SamplingCache cache(10);
+  ozz::math::SoaTransform locals[3];
+  ozz::math::Float4x4 output[10];
+  const int joints[] = {3, 9};
+  const int invalid_joints[] = {3, 10};
+
+  {  // Default is invalid.
+    ModelSpaceSamplingJob job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  ModelSpaceSamplingJob valid;
+  valid.animation = animation;
+  valid.skeleton = skeleton;
+  valid.cache = &cache;
+  valid.joints = joints;
+  valid.locals = locals;
+  valid.output = output;
+  EXPECT_TRUE(valid.Validate());
+  EXPECT_TRUE(valid.Run());
+
+  {  // No target is valid.
+    ModelSpaceSamplingJob job = valid;
+    job.joints = ozz::Range<const int>();
+    EXPECT_TRUE(job.Validate());
+  }
+  {  // Missing skeleton.
+    ModelSpaceSamplingJob job = valid;
+    job.skeleton = NULL;
+    EXPECT_FALSE(job.Validate());
+  }
+  {  // Missing animation.
+    ModelSpaceSamplingJob job = valid;
+    job.animation = NULL;
+    EXPECT_FALSE(job.Validate());
+  }
+  {  // Missing cache.
+    ModelSpaceSamplingJob job = valid;
+    job.cache = NULL;
+    EXPECT_FALSE(job.Validate());
+  }
+  {  // Animation doesn't match skeleton.
+    ModelSpaceSamplingJob job = valid;
+    job.animation = small_animation;
+    EXPECT_FALSE(job.Validate());
+  }
+  {  // Invalid target joint.
+    ModelSpaceSamplingJob job = valid;
+    job.joints = invalid_joints;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  {  // Locals too small.
+    ModelSpaceSamplingJob job = valid;
+    job.locals.end = locals + 2;
+    EXPECT_FALSE(job.Validate());
+  }
+  {  // Output too small.
+    ModelSpaceSamplingJob job = valid;
+    job.output.end = output + 9;
+    EXPECT_FALSE(job.Validate());
+  }
+
+  ozz::memory::default_allocator()->Delete(skeleton);
+  ozz::memory::default_allocator()->Delete(animation);
+  ozz::memory::default_allocator()->Delete(small_animation);
+}
+
+TEST(Run, ModelSpaceSamplingJob) {
+  Skeleton* skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton != NULL);
+  Animation* animation = BuildAnimation(10);
+  ASSERT_TRUE(animation != NULL);
+
+  const ozz::math::Float4x4 root =
+      ozz::math::Float4x4::Translation(ozz::math::simd_float4::Load(
+          1.f, 2.f, 3.f, 0.f));
+
+  // Computes reference model-space matrices of the whole hierarchy.
+  SamplingCache full_cache(10);
+  ozz::math::SoaTransform full_locals[3];
+  ozz::math::Float4x4 expected[10];
+  SamplingJob sampling_job;
+  sampling_job.ratio = .3f;
+  sampling_job.animation = animation;
+  sampling_job.cache = &full_cache;
+  sampling_job.output = full_locals;
+  ASSERT_TRUE(sampling_job.Run());
+  LocalToModelJob ltm_job;
+  ltm_job.skeleton = skeleton;
+  ltm_job.root = &root;
+  ltm_job.input = full_locals;
+  ltm_job.output = expected;
+  ASSERT_TRUE(ltm_job.Run());
+
+  SamplingCache cache(10);
+  ozz::math::SoaTransform locals[3];
+  ozz::math::Float4x4 output[10];
+  std::memset(output, 0, sizeof(output));
+  const ozz::math::Float4x4 untouched = output[0];
+
+  ModelSpaceSamplingJob job;
+  job.ratio = .3f;
+  job.animation = animation;
+  job.skeleton = skeleton;
+  job.cache = &cache;
+  job.root = &root;
+  job.locals = locals;
+  job.output = output;
+
+  {  // Joint 3 only requires joints 0 to 3, aka the first soa track.
+    const int joints[] = {3};
+    job.joints = joints;
+    ASSERT_TRUE(job.Run());
+    for (int i = 0; i < 10; ++i) {
+      EXPECT_TRUE(Equal(output[i], i <= 3 ? expected[i] : untouched))
+          << "joint " << i;
+    }
+  }
+
+  {  // Adds joint 8, which requires 6 to 8 chain.
+    const int joints[] = {8, 3};
+    job.joints = joints;
+    ASSERT_TRUE(job.Run());
+    for (int i = 0; i < 10; ++i) {
+      const bool required = i <= 3 || (i >= 6 && i <= 8);
+      EXPECT_TRUE(Equal(output[i], required ? expected[i] : untouched))
+          << "joint " << i;
+    }
+  }
+
+  ozz::memory::default_allocator()->Delete(skeleton);
+  ozz::memory::default_allocator()->Delete(animation);
+}
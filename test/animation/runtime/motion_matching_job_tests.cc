@@ -0,0 +1,367 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#include "ozz/animation/runtime/motion_matching_job.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "gtest/gtest.h"
+
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/motion_database_builder.h"
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/raw_skeleton.h"
+#include "ozz/animation/offline/skeleton_builder.h"
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/motion_database.h"
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/base/io/archive.h"
+#include "ozz/base/io/stream.h"
+#include "ozz/base/memory/allocator.h"
+
+using ozz::animation::Animation;
+using ozz::animation::MotionDatabase;
+using ozz::animation::MotionMatchingJob;
+using ozz::animation::Skeleton;
+using ozz::animation::offline::AnimationBuilder;
+using ozz::animation::offline::MotionDatabaseBuilder;
+using ozz::animation::offline::RawAnimation;
+using ozz::animation::offline::RawSkeleton;
+using ozz::animation::offline::SkeletonBuilder;
+
+namespace {
+// Builds a database of 3 clips of a 3 joints skeleton, whose root moves and
+// turns at different speeds. 2 seconds clips are sampled at 30hz, so the
+// database has several blocks.
+MotionDatabase* BuildDatabase() {
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  raw_skeleton.roots[0].name = "root";
+  raw_skeleton.roots[0].children.resize(2);
+  raw_skeleton.roots[0].children[0].name = "left";
+  raw_skeleton.roots[0].children[1].name = "right";
+  Skeleton* skeleton = SkeletonBuilder()(raw_skeleton);
+
+  Animation* animations[3];
+  for (int c = 0; c < 3; ++c) {
+    RawAnimation raw;
+    raw.duration = 2.f;
+    raw.tracks.resize(3);
+    const RawAnimation::TranslationKey root_keys[] = {
+        {0.f, ozz::math::Float3::zero()},
+        {2.f, ozz::math::Float3(0.f, 0.f, 2.f * c)}};
+    raw.tracks[0].translations.assign(root_keys, root_keys + 2);
+    const RawAnimation::RotationKey root_keys_r[] = {
+        {0.f, ozz::math::Quaternion::identity()},
+        {2.f, ozz::math::Quaternion::FromAxisAngle(ozz::math::Float3::y_axis(),
+                                                   .5f * c)}};
+    raw.tracks[0].rotations.assign(root_keys_r, root_keys_r + 2);
+    for (int j = 1; j < 3; ++j) {
+      const float side = j == 1 ? 1.f : -1.f;
+      const RawAnimation::TranslationKey keys[] = {
+          {0.f, ozz::math::Float3(side, 0.f, 0.f)},
+          {1.f, ozz::math::Float3(side, 0.f, side * c * .3f)},
+          {2.f, ozz::math::Float3(side, 0.f, 0.f)}};
+      raw.tracks[j].translations.assign(keys, keys + 3);
+    }
+    animations[c] = AnimationBuilder()(raw);
+  }
+
+  MotionDatabaseBuilder builder;
+  builder.joints.push_back(1);
+  builder.joints.push_back(2);
+  const Animation* clips[] = {animations[0], animations[1], animations[2]};
+  MotionDatabase* database = builder(clips, *skeleton);
+
+  for (int c = 0; c < 3; ++c) {
+    ozz::memory::default_allocator()->Delete(animations[c]);
+  }
+  ozz::memory::default_allocator()->Delete(skeleton);
+  return database;
+}
+
+// Finds the best frame with a scalar brute force search.
+float BruteForce(const MotionDatabase& _database, const float* _query,
+                 int* _frame, const float* _weights = NULL) {
+  float best = std::numeric_limits<float>::max();
+  for (int f = 0; f < _database.num_frames(); ++f) {
+    float cost = 0.f;
+    for (int i = 0; i < _database.stride(); ++i) {
+      const float diff =
+          _query[i] - _database.features()[f * _database.stride() + i];
+      cost += diff * diff * (_weights ? _weights[i] : 1.f);
+    }
+    if (cost < best) {
+      best = cost;
+      *_frame = f;
+    }
+  }
+  return best;
+}
+}  // namespace
+
+TEST(JobValidity, MotionMatchingJob) {
+  MotionDatabase* database = BuildDatabase();
+  ASSERT_TRUE(database != NULL);
+  ozz::Vector<float>::Std query(database->stride(), 0.f);
+  int frame;
+  float cost;
+
+  {  // Default is invalid.
+    MotionMatchingJob job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Missing outputs.
+    MotionMatchingJob job;
+    job.database = database;
+    job.query = ozz::make_range(query);
+    job.frame = &frame;
+    EXPECT_FALSE(job.Validate());
+    job.frame = NULL;
+    job.cost = &cost;
+    EXPECT_FALSE(job.Validate());
+  }
+
+  {  // Query too small.
+    MotionMatchingJob job;
+    job.database = database;
+    job.query = ozz::Range<const float>(query.data(), query.size() - 1);
+    job.frame = &frame;
+    job.cost = &cost;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Weights too small.
+    MotionMatchingJob job;
+    job.database = database;
+    job.query = ozz::make_range(query);
+    job.weights = ozz::Range<const float>(query.data(), query.size() - 1);
+    job.frame = &frame;
+    job.cost = &cost;
+    EXPECT_FALSE(job.Validate());
+    job.weights = ozz::make_range(query);
+    EXPECT_TRUE(job.Validate());
+  }
+
+  {  // Valid.
+    MotionMatchingJob job;
+    job.database = database;
+    job.query = ozz::make_range(query);
+    job.frame = &frame;
+    job.cost = &cost;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+
+  ozz::memory::default_allocator()->Delete(database);
+}
+
+TEST(Search, MotionMatchingJob) {
+  MotionDatabase* database = BuildDatabase();
+  ASSERT_TRUE(database != NULL);
+  ASSERT_EQ(database->num_clips(), 3);
+  ASSERT_EQ(database->num_frames(), 3 * 61);
+  const int stride = database->stride();
+
+  ozz::Vector<float>::Std query(stride);
+  int frame = -2;
+  float cost = -1.f;
+  MotionMatchingJob job;
+  job.database = database;
+  job.query = ozz::make_range(query);
+  job.frame = &frame;
+  job.cost = &cost;
+
+  // Database frames are found with a 0 cost.
+  for (int f = 0; f < database->num_frames(); ++f) {
+    std::copy(database->features().begin + f * stride,
+              database->features().begin + (f + 1) * stride, query.begin());
+    ASSERT_TRUE(job.Run());
+    int expected = -1;
+    EXPECT_EQ(cost, BruteForce(*database, query.data(), &expected));
+    EXPECT_FLOAT_EQ(cost, 0.f);
+    EXPECT_EQ(frame, expected);
+  }
+
+  // Queries in between frames, built from raw features.
+  ozz::Vector<float>::Std raw(database->num_features());
+  for (int f = 0; f < database->num_frames() - 1; ++f) {
+    for (int i = 0; i < database->num_features(); ++i) {
+      const float a = database->features()[f * stride + i];
+      const float b = database->features()[(f + 1) * stride + i];
+      const float scale = database->scales()[i];
+      raw[i] = (a + b) * .5f / scale + database->offsets()[i] + .1f;
+    }
+    ASSERT_TRUE(database->Normalize(ozz::make_range(raw),
+                                    ozz::make_range(query)));
+    ASSERT_TRUE(job.Run());
+    int expected = -1;
+    EXPECT_FLOAT_EQ(cost, BruteForce(*database, query.data(), &expected));
+    EXPECT_EQ(frame, expected);
+  }
+
+  {  // Nothing is found below max cost.
+    job.max_cost = 0.f;
+    ASSERT_TRUE(job.Run());
+    EXPECT_EQ(frame, -1);
+    EXPECT_FLOAT_EQ(cost, 0.f);
+  }
+
+  ozz::memory::default_allocator()->Delete(database);
+}
+
+TEST(Weighted, MotionMatchingJob) {
+  MotionDatabase* database = BuildDatabase();
+  ASSERT_TRUE(database != NULL);
+  const int stride = database->stride();
+
+  // Ignores trajectory directions, and favors trajectory positions.
+  ozz::Vector<float>::Std weights(stride, 1.f);
+  const int trajectory = database->num_features() - 12;
+  for (int i = 0; i < 6; ++i) {
+    weights[trajectory + i] = 4.f;
+    weights[trajectory + 6 + i] = 0.f;
+  }
+
+  ozz::Vector<float>::Std query(stride);
+  int frame = -2;
+  float cost = -1.f;
+  int brute_frame = -2;
+  float brute_cost = -1.f;
+  MotionMatchingJob job;
+  job.database = database;
+  job.query = ozz::make_range(query);
+  job.frame = &frame;
+  job.cost = &cost;
+
+  MotionMatchingJob brute_job = job;
+  brute_job.accelerate = false;
+  brute_job.frame = &brute_frame;
+  brute_job.cost = &brute_cost;
+
+  // Pseudo random queries around database frames.
+  unsigned int seed = 1;
+  for (int q = 0; q < 200; ++q) {
+    const int f = q % database->num_frames();
+    for (int i = 0; i < database->num_features(); ++i) {
+      seed = seed * 1103515245u + 12345u;
+      const float noise = ((seed >> 16) & 0x7fff) / 32767.f - .5f;
+      query[i] = database->features()[f * stride + i] + noise;
+    }
+    for (int w = 0; w < 2; ++w) {
+      const float* w_ptr = w == 0 ? NULL : weights.data();
+      job.weights = brute_job.weights =
+          w == 0 ? ozz::Range<const float>() : ozz::make_range(weights);
+      ASSERT_TRUE(job.Run());
+      ASSERT_TRUE(brute_job.Run());
+      int expected = -1;
+      const float expected_cost =
+          BruteForce(*database, query.data(), &expected, w_ptr);
+      EXPECT_EQ(frame, brute_frame);
+      EXPECT_EQ(cost, brute_cost);
+      EXPECT_EQ(frame, expected);
+      EXPECT_NEAR(cost, expected_cost, expected_cost * 1e-5f);
+    }
+  }
+
+  ozz::memory::default_allocator()->Delete(database);
+}
+
+TEST(Normalize, MotionDatabase) {
+  MotionDatabase* database = BuildDatabase();
+  ASSERT_TRUE(database != NULL);
+
+  ozz::Vector<float>::Std raw(database->num_features(), 1.f);
+  ozz::Vector<float>::Std normalized(database->stride(), 42.f);
+  EXPECT_FALSE(database->Normalize(
+      ozz::Range<const float>(raw.data(), raw.size() - 1),
+      ozz::make_range(normalized)));
+  EXPECT_FALSE(database->Normalize(
+      ozz::make_range(raw),
+      ozz::Range<float>(normalized.data(), normalized.size() - 1)));
+  EXPECT_TRUE(
+      database->Normalize(ozz::make_range(raw), ozz::make_range(normalized)));
+  for (int i = 0; i < database->num_features(); ++i) {
+    EXPECT_FLOAT_EQ(normalized[i],
+                    (1.f - database->offsets()[i]) * database->scales()[i]);
+  }
+  for (int i = database->num_features(); i < database->stride(); ++i) {
+    EXPECT_FLOAT_EQ(normalized[i], 0.f);
+  }
+
+  ozz::memory::default_allocator()->Delete(database);
+}
+
+TEST(Serialize, MotionDatabase) {
+  MotionDatabase* o_database = BuildDatabase();
+  ASSERT_TRUE(o_database != NULL);
+
+  for (int e = 0; e < 2; ++e) {
+    ozz::Endianness endianess = e == 0 ? ozz::kBigEndian : ozz::kLittleEndian;
+    ozz::io::MemoryStream stream;
+
+    // Streams out.
+    ozz::io::OArchive o(&stream, endianess);
+    o << *o_database;
+
+    // Streams in.
+    stream.Seek(0, ozz::io::Stream::kSet);
+    ozz::io::IArchive i(&stream);
+
+    MotionDatabase i_database;
+    i >> i_database;
+
+    EXPECT_EQ(i_database.num_frames(), o_database->num_frames());
+    EXPECT_EQ(i_database.num_features(), o_database->num_features());
+    EXPECT_EQ(i_database.num_clips(), o_database->num_clips());
+    EXPECT_FLOAT_EQ(i_database.frequency(), o_database->frequency());
+    EXPECT_EQ(i_database.size(), o_database->size());
+    for (size_t j = 0; j < o_database->features().count(); ++j) {
+      EXPECT_EQ(i_database.features()[j], o_database->features()[j]);
+    }
+    for (size_t j = 0; j < o_database->bounds().count(); ++j) {
+      EXPECT_EQ(i_database.bounds()[j], o_database->bounds()[j]);
+    }
+    for (size_t j = 0; j < o_database->large_bounds().count(); ++j) {
+      EXPECT_EQ(i_database.large_bounds()[j], o_database->large_bounds()[j]);
+    }
+    for (int j = 0; j < o_database->stride(); ++j) {
+      EXPECT_EQ(i_database.offsets()[j], o_database->offsets()[j]);
+      EXPECT_EQ(i_database.scales()[j], o_database->scales()[j]);
+    }
+    for (size_t j = 0; j < o_database->clip_begins().count(); ++j) {
+      EXPECT_EQ(i_database.clip_begins()[j], o_database->clip_begins()[j]);
+    }
+  }
+
+  ozz::memory::default_allocator()->Delete(o_database);
+}
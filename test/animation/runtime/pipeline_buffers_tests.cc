@@ -0,0 +1,186 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#include "ozz/animation/runtime/pipeline_buffers.h"
+
+#include <thread>
+
+#include "gtest/gtest.h"
+
+#include "ozz/animation/runtime/pipeline_job.h"
+#include "ozz/base/maths/simd_math.h"
+
+using ozz::animation::PipelineBuffers;
+
+TEST(Sizes, PipelineBuffers) {
+  PipelineBuffers buffers(5, 3, 3);
+  EXPECT_EQ(buffers.num_buffers(), 3);
+  EXPECT_EQ(buffers.num_joints(), 5);
+  EXPECT_EQ(buffers.palette_size(), 3);
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(buffers.models(i).count(), 5u);
+    EXPECT_EQ(buffers.skinning_palette(i).count(), 3u);
+    EXPECT_EQ(buffers.frame(i), 0u);
+    EXPECT_EQ(buffers.models(i).end, buffers.skinning_palette(i).begin);
+  }
+
+  // Number of buffers is clamped.
+  buffers.Resize(5, 0, 1);
+  EXPECT_EQ(buffers.num_buffers(), 2);
+  buffers.Resize(5, 0, 10);
+  EXPECT_EQ(buffers.num_buffers(), PipelineBuffers::kMaxBuffers);
+
+  // Outputs setup.
+  ozz::animation::PipelineJob job;
+  buffers.SetupOutputs(1, &job);
+  EXPECT_EQ(job.models.begin, buffers.models(1).begin);
+  EXPECT_EQ(job.models.count(), 5u);
+  EXPECT_TRUE(job.skinning_palette.begin == NULL);
+
+  buffers.Resize(5, 2);
+  buffers.SetupOutputs(2, &job);
+  EXPECT_EQ(job.models.begin, buffers.models(2).begin);
+  EXPECT_EQ(job.skinning_palette.begin, buffers.skinning_palette(2).begin);
+  EXPECT_EQ(job.skinning_palette.count(), 2u);
+}
+
+TEST(TripleBuffering, PipelineBuffers) {
+  PipelineBuffers buffers(1, 0);
+  EXPECT_EQ(buffers.num_buffers(), 3);
+
+  // Nothing published yet.
+  EXPECT_EQ(buffers.AcquireRead(), -1);
+
+  const int w0 = buffers.BeginWrite();
+  ASSERT_GE(w0, 0);
+  EXPECT_EQ(buffers.AcquireRead(), -1);
+  buffers.EndWrite(w0);
+  EXPECT_EQ(buffers.frame(w0), 1u);
+
+  // Consumer reads frame 1 while frames 2 and 3 are written.
+  const int r0 = buffers.AcquireRead();
+  EXPECT_EQ(r0, w0);
+
+  const int w1 = buffers.BeginWrite();
+  ASSERT_GE(w1, 0);
+  EXPECT_NE(w1, r0);
+  buffers.EndWrite(w1);
+
+  const int w2 = buffers.BeginWrite();
+  ASSERT_GE(w2, 0);
+  EXPECT_NE(w2, r0);
+  EXPECT_NE(w2, w1);
+  buffers.EndWrite(w2);
+  EXPECT_EQ(buffers.frame(w2), 3u);
+
+  // Writer never blocks with 3 buffers, and skips the one being read.
+  const int w3 = buffers.BeginWrite();
+  EXPECT_EQ(w3, w1);
+  buffers.EndWrite(w3);
+
+  // Consumer gets the latest frame.
+  buffers.ReleaseRead(r0);
+  const int r1 = buffers.AcquireRead();
+  EXPECT_EQ(r1, w3);
+  EXPECT_EQ(buffers.frame(r1), 4u);
+
+  // Multiple consumers can read the same buffer.
+  const int r2 = buffers.AcquireRead();
+  EXPECT_EQ(r2, r1);
+  buffers.ReleaseRead(r1);
+  buffers.ReleaseRead(r2);
+}
+
+TEST(DoubleBuffering, PipelineBuffers) {
+  PipelineBuffers buffers(1, 0, 2);
+
+  const int w0 = buffers.BeginWrite();
+  ASSERT_GE(w0, 0);
+  buffers.EndWrite(w0);
+  const int r0 = buffers.AcquireRead();
+  EXPECT_EQ(r0, w0);
+
+  const int w1 = buffers.BeginWrite();
+  ASSERT_GE(w1, 0);
+  EXPECT_NE(w1, w0);
+  buffers.EndWrite(w1);
+
+  // Consumer still reads frame 1, and frame 2 is the latest one.
+  EXPECT_EQ(buffers.BeginWrite(), -1);
+
+  buffers.ReleaseRead(r0);
+  const int w2 = buffers.BeginWrite();
+  EXPECT_EQ(w2, w0);
+  buffers.EndWrite(w2);
+}
+
+TEST(Concurrency, PipelineBuffers) {
+  const int kNumJoints = 64;
+  const int kNumFrames = 2000;
+  PipelineBuffers buffers(kNumJoints, 0);
+
+  // Producer fills every matrix of a buffer with its frame number.
+  std::thread producer([&buffers] {
+    for (int f = 1; f <= kNumFrames; ++f) {
+      const int index = buffers.BeginWrite();
+      ASSERT_GE(index, 0);
+      const ozz::Range<ozz::math::Float4x4> models = buffers.models(index);
+      const ozz::math::SimdFloat4 value =
+          ozz::math::simd_float4::Load1(static_cast<float>(f));
+      for (size_t j = 0; j < models.count(); ++j) {
+        for (int c = 0; c < 4; ++c) {
+          models[j].cols[c] = value;
+        }
+      }
+      buffers.EndWrite(index);
+    }
+  });
+
+  // Consumer checks it never sees a partially written buffer, and that frames
+  // never go backward.
+  uint32_t last_frame = 0;
+  while (last_frame < static_cast<uint32_t>(kNumFrames)) {
+    const int index = buffers.AcquireRead();
+    if (index < 0) {
+      continue;
+    }
+    const uint32_t frame = buffers.frame(index);
+    EXPECT_GE(frame, last_frame);
+    const ozz::Range<ozz::math::Float4x4> models = buffers.models(index);
+    for (size_t j = 0; j < models.count(); ++j) {
+      for (int c = 0; c < 4; ++c) {
+        EXPECT_EQ(ozz::math::GetX(models[j].cols[c]),
+                  static_cast<float>(frame));
+      }
+    }
+    buffers.ReleaseRead(index);
+    last_frame = frame;
+  }
+
+  producer.join();
+}
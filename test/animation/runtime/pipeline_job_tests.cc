@@ -0,0 +1,424 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#include "ozz/animation/runtime/pipeline_job.h"
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/allocator.h"
+
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/raw_skeleton.h"
+#include "ozz/animation/offline/skeleton_builder.h"
+
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/blending_job.h"
+#include "ozz/animation/runtime/local_to_model_job.h"
+#include "ozz/animation/runtime/skeleton.h"
+
+using ozz::animation::Animation;
+using ozz::animation::BlendingJob;
+using ozz::animation::LocalToModelJob;
+using ozz::animation::PipelineContext;
+using ozz::animation::PipelineJob;
+using ozz::animation::SamplingCache;
+using ozz::animation::SamplingJob;
+using ozz::animation::Skeleton;
+using ozz::animation::offline::AnimationBuilder;
+using ozz::animation::offline::RawAnimation;
+using ozz::animation::offline::RawSkeleton;
+using ozz::animation::offline::SkeletonBuilder;
+
+namespace {
+// Builds a skeleton with a 4 joints chain (j0 to j3) and j4 child of j0.
+Skeleton* BuildSkeleton() {
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  RawSkeleton::Joint& root = raw_skeleton.roots[0];
+  root.name = "j0";
+  root.children.resize(2);
+  root.children[0].name = "j1";
+  root.children[0].transform.translation = ozz::math::Float3(0.f, 1.f, 0.f);
+  root.children[0].children.resize(1);
+  RawSkeleton::Joint& j2 = root.children[0].children[0];
+  j2.name = "j2";
+  j2.transform.translation = ozz::math::Float3(0.f, 1.f, 0.f);
+  j2.children.resize(1);
+  j2.children[0].name = "j3";
+  j2.children[0].transform.translation = ozz::math::Float3(1.f, 0.f, 0.f);
+  root.children[1].name = "j4";
+
+  SkeletonBuilder builder;
+  return builder(raw_skeleton);
+}
+
+// Builds an animation for the skeleton above, translating joints along
+// _offset over time.
+Animation* BuildAnimation(float _offset) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(5);
+  for (int i = 0; i < 5; ++i) {
+    const RawAnimation::TranslationKey first = {
+        0.f, ozz::math::Float3(0.f, i == 0 ? 0.f : 1.f, 0.f)};
+    const RawAnimation::TranslationKey last = {
+        1.f, ozz::math::Float3(_offset, i == 0 ? 0.f : 1.f, 0.f)};
+    raw_animation.tracks[i].translations.push_back(first);
+    raw_animation.tracks[i].translations.push_back(last);
+  }
+  const RawAnimation::RotationKey rotation = {
+      0.f, ozz::math::Quaternion::FromEuler(0.f, 0.f, .3f * _offset)};
+  raw_animation.tracks[2].rotations.push_back(rotation);
+
+  AnimationBuilder builder;
+  return builder(raw_animation);
+}
+
+void ExpectMatricesEq(const ozz::math::Float4x4* _expected,
+                      const ozz::math::Float4x4* _actual, int _count) {
+  for (int i = 0; i < _count; ++i) {
+    for (int c = 0; c < 4; ++c) {
+      float expected[4];
+      float actual[4];
+      ozz::math::StorePtrU(_expected[i].cols[c], expected);
+      ozz::math::StorePtrU(_actual[i].cols[c], actual);
+      for (int e = 0; e < 4; ++e) {
+        EXPECT_NEAR(expected[e], actual[e], 1e-4f);
+      }
+    }
+  }
+}
+
+// Skinning stage that counts calls, and checks the palette it receives.
+struct SkinningStageData {
+  const ozz::math::Float4x4* palette;
+  int calls;
+  bool result;
+};
+
+bool TestSkinningStage(void* _user_data,
+                       const ozz::Range<const ozz::math::Float4x4>& _palette) {
+  SkinningStageData* data = static_cast<SkinningStageData*>(_user_data);
+  ++data->calls;
+  EXPECT_EQ(_palette.begin, data->palette);
+  return data->result;
+}
+}  // namespace
+
+TEST(JobValidity, PipelineJob) {
+  Skeleton* skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton != NULL);
+  Animation* animation = BuildAnimation(1.f);
+  ASSERT_TRUE(animation != NULL);
+
+  SamplingCache cache0(5);
+  SamplingCache cache1(5);
+  SamplingCache small_cache(1);
+  PipelineContext context(5, 2);
+  PipelineContext small_context(5, 1);
+  ozz::math::SoaTransform locals[2];
+  ozz::math::Float4x4 models[5];
+  ozz::math::Float4x4 palette[5];
+  const ozz::math::Float4x4 inverse_bind_poses[5] = {
+      ozz::math::Float4x4::identity(), ozz::math::Float4x4::identity(),
+      ozz::math::Float4x4::identity(), ozz::math::Float4x4::identity(),
+      ozz::math::Float4x4::identity()};
+
+  PipelineJob::Layer layers[2];
+  layers[0].animation = animation;
+  layers[0].cache = &cache0;
+  layers[1].animation = animation;
+  layers[1].cache = &cache1;
+
+  {  // Default job.
+    PipelineJob job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // No layer, outputs bind pose.
+    PipelineJob job;
+    job.skeleton = skeleton;
+    job.locals = locals;
+    job.models = models;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+
+    // Outputs too small.
+    job.locals = ozz::Range<ozz::math::SoaTransform>(locals, 1);
+    EXPECT_FALSE(job.Validate());
+    job.locals = locals;
+    job.models = ozz::Range<ozz::math::Float4x4>(models, 4);
+    EXPECT_FALSE(job.Validate());
+  }
+
+  {  // Single layer, no context needed.
+    PipelineJob job;
+    job.skeleton = skeleton;
+    job.layers = ozz::Range<const PipelineJob::Layer>(layers, 1);
+    job.locals = locals;
+    job.models = models;
+    EXPECT_TRUE(job.Validate());
+
+    // Cache too small.
+    PipelineJob::Layer small_layers[1];
+    small_layers[0] = layers[0];
+    small_layers[0].cache = &small_cache;
+    job.layers = small_layers;
+    EXPECT_FALSE(job.Validate());
+
+    // Missing animation.
+    small_layers[0] = layers[0];
+    small_layers[0].animation = NULL;
+    EXPECT_FALSE(job.Validate());
+
+    // Blended because of its low weight, requires a context.
+    small_layers[0] = layers[0];
+    small_layers[0].weight = 0.f;
+    EXPECT_FALSE(job.Validate());
+    job.context = &small_context;
+    EXPECT_TRUE(job.Validate());
+  }
+
+  {  // Blended layers require a big enough context.
+    PipelineJob job;
+    job.skeleton = skeleton;
+    job.layers = layers;
+    job.locals = locals;
+    job.models = models;
+    EXPECT_FALSE(job.Validate());
+    job.context = &small_context;
+    EXPECT_FALSE(job.Validate());
+    job.context = &context;
+    EXPECT_TRUE(job.Validate());
+
+    // Invalid threshold.
+    job.threshold = 0.f;
+    EXPECT_FALSE(job.Validate());
+  }
+
+  {  // IK chains.
+    PipelineJob::TwoBoneIK iks[1];
+    PipelineJob job;
+    job.skeleton = skeleton;
+    job.locals = locals;
+    job.models = models;
+    job.two_bone_iks = iks;
+    EXPECT_FALSE(job.Validate());
+
+    iks[0].start_joint = 1;
+    iks[0].mid_joint = 2;
+    iks[0].end_joint = 3;
+    EXPECT_TRUE(job.Validate());
+
+    iks[0].end_joint = 5;
+    EXPECT_FALSE(job.Validate());
+
+    iks[0].end_joint = 1;
+    EXPECT_FALSE(job.Validate());
+
+    iks[0].end_joint = 3;
+    iks[0].mid_axis = ozz::math::simd_float4::Load(1.f, 1.f, 0.f, 0.f);
+    EXPECT_FALSE(job.Validate());
+  }
+
+  {  // Skinning.
+    SkinningStageData data = {palette, 0, true};
+    PipelineJob job;
+    job.skeleton = skeleton;
+    job.locals = locals;
+    job.models = models;
+    job.skinning_stage = &TestSkinningStage;
+    job.skinning_user_data = &data;
+    EXPECT_FALSE(job.Validate());
+
+    job.skinning_palette = palette;
+    EXPECT_FALSE(job.Validate());
+
+    job.inverse_bind_poses = inverse_bind_poses;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+    EXPECT_EQ(data.calls, 1);
+
+    data.result = false;
+    EXPECT_FALSE(job.Run());
+    EXPECT_EQ(data.calls, 2);
+  }
+
+  ozz::memory::default_allocator()->Delete(animation);
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+TEST(Equivalence, PipelineJob) {
+  Skeleton* skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton != NULL);
+  Animation* animation0 = BuildAnimation(1.f);
+  ASSERT_TRUE(animation0 != NULL);
+  Animation* animation1 = BuildAnimation(-2.f);
+  ASSERT_TRUE(animation1 != NULL);
+
+  const float ratio0 = .3f;
+  const float ratio1 = .8f;
+
+  // Computes expected results with individual jobs.
+  SamplingCache cache(5);
+  ozz::math::SoaTransform sampled0[2];
+  ozz::math::SoaTransform sampled1[2];
+  SamplingJob sampling_job;
+  sampling_job.cache = &cache;
+  sampling_job.animation = animation0;
+  sampling_job.ratio = ratio0;
+  sampling_job.output = sampled0;
+  ASSERT_TRUE(sampling_job.Run());
+  sampling_job.animation = animation1;
+  sampling_job.ratio = ratio1;
+  sampling_job.output = sampled1;
+  ASSERT_TRUE(sampling_job.Run());
+
+  ozz::math::Float4x4 expected_single[5];
+  LocalToModelJob ltm_job;
+  ltm_job.skeleton = skeleton;
+  ltm_job.input = sampled0;
+  ltm_job.output = expected_single;
+  ASSERT_TRUE(ltm_job.Run());
+
+  BlendingJob::Layer blend_layers[2];
+  blend_layers[0].weight = .3f;
+  blend_layers[0].transform = sampled0;
+  blend_layers[1].weight = .7f;
+  blend_layers[1].transform = sampled1;
+  ozz::math::SoaTransform blended[2];
+  BlendingJob blending_job;
+  blending_job.layers = blend_layers;
+  blending_job.bind_pose = skeleton->joint_bind_poses();
+  blending_job.output = blended;
+  ASSERT_TRUE(blending_job.Run());
+
+  ozz::math::Float4x4 expected_blended[5];
+  ltm_job.input = blended;
+  ltm_job.output = expected_blended;
+  ASSERT_TRUE(ltm_job.Run());
+
+  // Runs pipelines.
+  SamplingCache cache0(5);
+  SamplingCache cache1(5);
+  PipelineContext context(5, PipelineJob::kMaxLayers);
+  ozz::math::SoaTransform locals[2];
+  ozz::math::Float4x4 models[5];
+
+  PipelineJob::Layer layers[2];
+  layers[0].animation = animation0;
+  layers[0].cache = &cache0;
+  layers[0].ratio = ratio0;
+  layers[0].weight = .3f;
+  layers[1].animation = animation1;
+  layers[1].cache = &cache1;
+  layers[1].ratio = ratio1;
+  layers[1].weight = .7f;
+
+  PipelineJob job;
+  job.skeleton = skeleton;
+  job.context = &context;
+  job.locals = locals;
+  job.models = models;
+
+  job.layers = ozz::Range<const PipelineJob::Layer>(layers, 1);
+  ASSERT_TRUE(job.Run());
+  ExpectMatricesEq(expected_single, models, 5);
+
+  job.layers = layers;
+  ASSERT_TRUE(job.Run());
+  ExpectMatricesEq(expected_blended, models, 5);
+
+  ozz::memory::default_allocator()->Delete(animation0);
+  ozz::memory::default_allocator()->Delete(animation1);
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+TEST(IKAndSkinning, PipelineJob) {
+  Skeleton* skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton != NULL);
+  Animation* animation = BuildAnimation(0.f);
+  ASSERT_TRUE(animation != NULL);
+
+  SamplingCache cache(5);
+  ozz::math::SoaTransform locals[2];
+  ozz::math::Float4x4 models[5];
+  ozz::math::Float4x4 palette[5];
+  const ozz::math::Float4x4 inverse_bind_poses[5] = {
+      ozz::math::Float4x4::identity(), ozz::math::Float4x4::identity(),
+      ozz::math::Float4x4::identity(), ozz::math::Float4x4::identity(),
+      ozz::math::Float4x4::identity()};
+
+  PipelineJob::Layer layers[1];
+  layers[0].animation = animation;
+  layers[0].cache = &cache;
+
+  // Chain j1-j2-j3 is (0,1,0), (0,2,0), (1,2,0). Target is reachable.
+  PipelineJob::TwoBoneIK iks[1];
+  iks[0].start_joint = 1;
+  iks[0].mid_joint = 2;
+  iks[0].end_joint = 3;
+  iks[0].target = ozz::math::simd_float4::Load(.5f, 1.5f, .5f, 0.f);
+
+  SkinningStageData data = {palette, 0, true};
+  PipelineJob job;
+  job.skeleton = skeleton;
+  job.layers = layers;
+  job.two_bone_iks = iks;
+  job.locals = locals;
+  job.models = models;
+  job.skinning_palette = palette;
+  job.inverse_bind_poses = inverse_bind_poses;
+  job.skinning_stage = &TestSkinningStage;
+  job.skinning_user_data = &data;
+  ASSERT_TRUE(job.Run());
+  EXPECT_EQ(data.calls, 1);
+
+  // End joint reached the target.
+  EXPECT_SIMDFLOAT3_EQ_TOL(models[3].cols[3], .5f, 1.5f, .5f, 1e-3f);
+
+  // Locals were corrected, so they give the same model-space matrices.
+  ozz::math::Float4x4 expected[5];
+  LocalToModelJob ltm_job;
+  ltm_job.skeleton = skeleton;
+  ltm_job.input = locals;
+  ltm_job.output = expected;
+  ASSERT_TRUE(ltm_job.Run());
+  ExpectMatricesEq(expected, models, 5);
+
+  // Palette is up to date, with identity inverse bind poses.
+  ExpectMatricesEq(models, palette, 5);
+
+  ozz::memory::default_allocator()->Delete(animation);
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
@@ -0,0 +1,277 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/pose_encoding_job.h"
+
+#include <cmath>
+
+#include "gtest/gtest.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/soa_transform.h"
+
+namespace {
+// Builds a pose of _count soa transforms, which varies with _seed.
+void BuildPose(ozz::math::SoaTransform* _pose, int _count, float _seed) {
+  for (int i = 0; i < _count; ++i) {
+    float t[4][3];
+    float q[4][4];
+    float s[4][3];
+    for (int l = 0; l < 4; ++l) {
+      const float j = static_cast<float>(i * 4 + l);
+      t[l][0] = std::sin(j + _seed) * 10.f;
+      t[l][1] = std::cos(j * 2.f + _seed) * 3.f;
+      t[l][2] = j * .1f - _seed;
+      const float angle = j * .3f + _seed * .5f;
+      const float axis_len = std::sqrt(1.f + j * j + 4.f);
+      q[l][0] = std::sin(angle) / axis_len;
+      q[l][1] = std::sin(angle) * j / axis_len;
+      q[l][2] = std::sin(angle) * 2.f / axis_len;
+      q[l][3] = std::cos(angle);
+      s[l][0] = 1.f + j * .01f;
+      s[l][1] = 1.f;
+      s[l][2] = 1.f - _seed * .01f;
+    }
+    ozz::math::SoaTransform& transform = _pose[i];
+    transform.translation.x = ozz::math::simd_float4::Load(
+        t[0][0], t[1][0], t[2][0], t[3][0]);
+    transform.translation.y = ozz::math::simd_float4::Load(
+        t[0][1], t[1][1], t[2][1], t[3][1]);
+    transform.translation.z = ozz::math::simd_float4::Load(
+        t[0][2], t[1][2], t[2][2], t[3][2]);
+    transform.rotation.x = ozz::math::simd_float4::Load(
+        q[0][0], q[1][0], q[2][0], q[3][0]);
+    transform.rotation.y = ozz::math::simd_float4::Load(
+        q[0][1], q[1][1], q[2][1], q[3][1]);
+    transform.rotation.z = ozz::math::simd_float4::Load(
+        q[0][2], q[1][2], q[2][2], q[3][2]);
+    transform.rotation.w = ozz::math::simd_float4::Load(
+        q[0][3], q[1][3], q[2][3], q[3][3]);
+    transform.scale.x =
+        ozz::math::simd_float4::Load(s[0][0], s[1][0], s[2][0], s[3][0]);
+    transform.scale.y =
+        ozz::math::simd_float4::Load(s[0][1], s[1][1], s[2][1], s[3][1]);
+    transform.scale.z =
+        ozz::math::simd_float4::Load(s[0][2], s[1][2], s[2][2], s[3][2]);
+  }
+}
+
+// Expects _a and _b poses to match with _tolerance. Rotations are compared as
+// rotations, so q and -q are equal.
+void ExpectPoseNear(const ozz::math::SoaTransform* _a,
+                    const ozz::math::SoaTransform* _b, int _count,
+                    float _tolerance) {
+  for (int i = 0; i < _count; ++i) {
+    const ozz::math::SimdFloat4 a[10] = {
+        _a[i].translation.x, _a[i].translation.y, _a[i].translation.z,
+        _a[i].rotation.x,    _a[i].rotation.y,    _a[i].rotation.z,
+        _a[i].rotation.w,    _a[i].scale.x,       _a[i].scale.y,
+        _a[i].scale.z};
+    const ozz::math::SimdFloat4 b[10] = {
+        _b[i].translation.x, _b[i].translation.y, _b[i].translation.z,
+        _b[i].rotation.x,    _b[i].rotation.y,    _b[i].rotation.z,
+        _b[i].rotation.w,    _b[i].scale.x,       _b[i].scale.y,
+        _b[i].scale.z};
+    float fa[10][4];
+    float fb[10][4];
+    for (int c = 0; c < 10; ++c) {
+      ozz::math::StorePtrU(a[c], fa[c]);
+      ozz::math::StorePtrU(b[c], fb[c]);
+    }
+    for (int l = 0; l < 4; ++l) {
+      float dot = 0.f;
+      for (int c = 3; c < 7; ++c) {
+        dot += fa[c][l] * fb[c][l];
+      }
+      const float sign = dot < 0.f ? -1.f : 1.f;
+      for (int c = 0; c < 10; ++c) {
+        const float factor = c >= 3 && c < 7 ? sign : 1.f;
+        EXPECT_NEAR(fa[c][l], fb[c][l] * factor, _tolerance);
+      }
+    }
+  }
+}
+}  // namespace
+
+TEST(JobValidity, PoseEncodingJob) {
+  ozz::math::SoaTransform pose[2];
+  BuildPose(pose, 2, 0.f);
+  char buffer[256];
+  size_t size = 0;
+
+  {  // Default is invalid, as size is NULL.
+    ozz::animation::PoseEncodingJob job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  {  // Empty pose is valid.
+    ozz::animation::PoseEncodingJob job;
+    job.size = &size;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+    EXPECT_EQ(size, 0u);
+  }
+  {  // Reference too small.
+    ozz::animation::PoseEncodingJob job;
+    job.pose = pose;
+    job.reference = ozz::Range<const ozz::math::SoaTransform>(pose, 1);
+    job.buffer = buffer;
+    job.size = &size;
+    EXPECT_FALSE(job.Validate());
+    job.reference = pose;
+    EXPECT_TRUE(job.Validate());
+  }
+  {  // Invalid precisions.
+    ozz::animation::PoseEncodingJob job;
+    job.size = &size;
+    job.translation_precision = 0.f;
+    EXPECT_FALSE(job.Validate());
+    job.translation_precision = 1e-3f;
+    job.rotation_precision = -1.f;
+    EXPECT_FALSE(job.Validate());
+  }
+  {  // Buffer too small.
+    ozz::animation::PoseEncodingJob job;
+    job.pose = pose;
+    job.buffer = ozz::Range<char>(buffer, 4);
+    job.size = &size;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Decoding reference too small.
+    ozz::animation::PoseDecodingJob job;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+    job.output = pose;
+    job.reference = ozz::Range<const ozz::math::SoaTransform>(pose, 1);
+    EXPECT_FALSE(job.Validate());
+    job.reference = pose;
+    EXPECT_TRUE(job.Validate());
+    job.scale_precision = 0.f;
+    EXPECT_FALSE(job.Validate());
+  }
+}
+
+TEST(RoundTrip, PoseEncodingJob) {
+  const int kCount = 17;
+  ozz::math::SoaTransform pose[kCount];
+  BuildPose(pose, kCount, 1.f);
+  ozz::math::SoaTransform reference[kCount];
+  BuildPose(reference, kCount, .9f);
+
+  char buffer[4096];
+  ASSERT_LE(ozz::animation::PoseEncodingJob::MaxSize(kCount), sizeof(buffer));
+
+  for (int r = 0; r < 2; ++r) {
+    ozz::animation::PoseEncodingJob encode;
+    encode.pose = pose;
+    if (r == 1) {
+      encode.reference = reference;
+    }
+    encode.buffer = buffer;
+    size_t size = 0;
+    encode.size = &size;
+    ASSERT_TRUE(encode.Run());
+    EXPECT_GT(size, 0u);
+    EXPECT_LE(size, ozz::animation::PoseEncodingJob::MaxSize(kCount));
+
+    ozz::math::SoaTransform decoded[kCount];
+    ozz::animation::PoseDecodingJob decode;
+    decode.buffer = ozz::Range<const char>(buffer, size);
+    decode.reference = encode.reference;
+    decode.output = decoded;
+    ASSERT_TRUE(decode.Run());
+    ExpectPoseNear(pose, decoded, kCount, 2e-4f);
+
+    // Truncated buffer.
+    decode.buffer = ozz::Range<const char>(buffer, size - 1);
+    EXPECT_FALSE(decode.Run());
+  }
+}
+
+TEST(Compactness, PoseEncodingJob) {
+  const int kCount = 17;  // A 67 joints skeleton.
+  ozz::math::SoaTransform pose[kCount];
+  BuildPose(pose, kCount, 1.f);
+  char buffer[4096];
+  size_t size = 0;
+
+  ozz::animation::PoseEncodingJob encode;
+  encode.pose = pose;
+  encode.reference = pose;
+  encode.buffer = buffer;
+  encode.size = &size;
+
+  // Unchanged pose costs 5 bits per component of 4 joints.
+  ASSERT_TRUE(encode.Run());
+  EXPECT_EQ(size, static_cast<size_t>((kCount * 10 * 5 + 7) / 8));
+
+  // Previous frame delta encoding of a moving pose.
+  ozz::math::SoaTransform previous[kCount];
+  BuildPose(previous, kCount, 1.f - 1.f / 30.f);
+  encode.reference = previous;
+  ASSERT_TRUE(encode.Run());
+  EXPECT_LT(size, 1024u);
+  EXPECT_LT(size, kCount * sizeof(ozz::math::SoaTransform) / 4);
+}
+
+TEST(NoDrift, PoseEncodingJob) {
+  const int kCount = 3;
+  ozz::math::SoaTransform decoded[kCount];
+  BuildPose(decoded, kCount, 0.f);
+  ozz::math::SoaTransform previous[kCount];
+  for (int i = 0; i < kCount; ++i) {
+    previous[i] = decoded[i];
+  }
+
+  // Each frame is encoded against the previous decoded one.
+  char buffer[1024];
+  for (int f = 1; f < 100; ++f) {
+    ozz::math::SoaTransform pose[kCount];
+    BuildPose(pose, kCount, f * .05f);
+
+    ozz::animation::PoseEncodingJob encode;
+    encode.pose = pose;
+    encode.reference = previous;
+    encode.buffer = buffer;
+    size_t size = 0;
+    encode.size = &size;
+    ASSERT_TRUE(encode.Run());
+
+    ozz::animation::PoseDecodingJob decode;
+    decode.buffer = ozz::Range<const char>(buffer, size);
+    decode.reference = previous;
+    decode.output = decoded;
+    ASSERT_TRUE(decode.Run());
+    ExpectPoseNear(pose, decoded, kCount, 2e-4f);
+
+    for (int i = 0; i < kCount; ++i) {
+      previous[i] = decoded[i];
+    }
+  }
+}
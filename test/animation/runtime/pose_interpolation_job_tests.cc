@@ -0,0 +1,210 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+#include "ozz/animation/runtime/animation_instance.h"
+#include "ozz/animation/runtime/pose_interpolation_job.h"
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/soa_transform.h"
+
+using ozz::animation::BlendingJob;
+using ozz::animation::PoseInterpolationJob;
+using ozz::animation::UpdateRateScheduler;
+
+TEST(JobValidity, PoseInterpolationJob) {
+  ozz::math::SoaTransform from[2];
+  ozz::math::SoaTransform to[2];
+  ozz::math::SoaTransform output[2];
+  ozz::math::Float4x4 model_from[3];
+  ozz::math::Float4x4 model_to[3];
+  ozz::math::Float4x4 model_output[3];
+
+  {  // Default job.
+    PoseInterpolationJob job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  {  // Inputs too small.
+    PoseInterpolationJob job;
+    job.from = ozz::Range<const ozz::math::SoaTransform>(from, 1);
+    job.to = to;
+    job.output = output;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  {  // Model inputs too small.
+    PoseInterpolationJob job;
+    job.model_from = model_from;
+    job.model_to = ozz::Range<const ozz::math::Float4x4>(model_to, 2);
+    job.model_output = model_output;
+    EXPECT_FALSE(job.Validate());
+  }
+  {  // Local-space only.
+    PoseInterpolationJob job;
+    job.from = from;
+    job.to = to;
+    job.output = ozz::Range<ozz::math::SoaTransform>(output, 1);
+    EXPECT_TRUE(job.Validate());
+  }
+  {  // Model-space only.
+    PoseInterpolationJob job;
+    job.model_from = model_from;
+    job.model_to = model_to;
+    job.model_output = model_output;
+    EXPECT_TRUE(job.Validate());
+  }
+}
+
+TEST(Locals, PoseInterpolationJob) {
+  using ozz::math::simd_float4::Load;
+  const float kSqrt2_2 = .7071068f;
+
+  // Lane 0 rotates around z, lane 1 has an opposite hemisphere identity
+  // rotation, lane 2 rotates around x, lane 3 doesn't move.
+  const ozz::math::SoaTransform from = {
+      ozz::math::SoaFloat3::Load(Load(0.f, 1.f, 2.f, 3.f),
+                                 Load(0.f, 0.f, 0.f, 0.f),
+                                 Load(0.f, 0.f, 0.f, 0.f)),
+      ozz::math::SoaQuaternion::Load(
+          Load(0.f, 0.f, 0.f, 0.f), Load(0.f, 0.f, 0.f, 0.f),
+          Load(0.f, 0.f, 0.f, 0.f), Load(1.f, 1.f, 1.f, 1.f)),
+      ozz::math::SoaFloat3::one()};
+  const ozz::math::SoaTransform to = {
+      ozz::math::SoaFloat3::Load(Load(2.f, 1.f, 2.f, 3.f),
+                                 Load(4.f, 0.f, 0.f, 0.f),
+                                 Load(0.f, 0.f, 0.f, 0.f)),
+      ozz::math::SoaQuaternion::Load(
+          Load(0.f, 0.f, 1.f, 0.f), Load(0.f, 0.f, 0.f, 0.f),
+          Load(kSqrt2_2, 0.f, 0.f, 0.f), Load(kSqrt2_2, -1.f, 0.f, 1.f)),
+      ozz::math::SoaFloat3::Load(Load(3.f, 1.f, 1.f, 1.f),
+                                 Load(1.f, 1.f, 1.f, 1.f),
+                                 Load(1.f, 1.f, 1.f, 1.f))};
+  ozz::math::SoaTransform output;
+
+  PoseInterpolationJob job;
+  job.from = ozz::Range<const ozz::math::SoaTransform>(&from, 1);
+  job.to = ozz::Range<const ozz::math::SoaTransform>(&to, 1);
+  job.output = ozz::Range<ozz::math::SoaTransform>(&output, 1);
+
+  for (int q = 0; q < 3; ++q) {
+    job.quality = static_cast<BlendingJob::Quality>(q);
+
+    job.ratio = .5f;
+    ASSERT_TRUE(job.Run());
+    EXPECT_SOAFLOAT3_EQ(output.translation, 1.f, 1.f, 2.f, 3.f, 2.f, 0.f, 0.f,
+                        0.f, 0.f, 0.f, 0.f, 0.f);
+    EXPECT_SOAQUATERNION_EQ_EST(output.rotation, 0.f, 0.f, kSqrt2_2, 0.f, 0.f,
+                                0.f, 0.f, 0.f, .3826834f, 0.f, 0.f, 0.f,
+                                .9238795f, 1.f, kSqrt2_2, 1.f);
+    EXPECT_SOAFLOAT3_EQ(output.scale, 2.f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f,
+                        1.f, 1.f, 1.f, 1.f);
+
+    // Ratio is clamped.
+    job.ratio = 2.f;
+    ASSERT_TRUE(job.Run());
+    EXPECT_SOAFLOAT3_EQ(output.translation, 2.f, 1.f, 2.f, 3.f, 4.f, 0.f, 0.f,
+                        0.f, 0.f, 0.f, 0.f, 0.f);
+    EXPECT_SOAQUATERNION_EQ_EST(output.rotation, 0.f, 0.f, 1.f, 0.f, 0.f, 0.f,
+                                0.f, 0.f, kSqrt2_2, 0.f, 0.f, 0.f, kSqrt2_2,
+                                1.f, 0.f, 1.f);
+    job.ratio = -1.f;
+    ASSERT_TRUE(job.Run());
+    EXPECT_SOAFLOAT3_EQ(output.translation, 0.f, 1.f, 2.f, 3.f, 0.f, 0.f, 0.f,
+                        0.f, 0.f, 0.f, 0.f, 0.f);
+    EXPECT_SOAQUATERNION_EQ_EST(output.rotation, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f,
+                                0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 1.f, 1.f, 1.f,
+                                1.f);
+  }
+
+  // Output can be an input.
+  ozz::math::SoaTransform inout = from;
+  job.from = ozz::Range<const ozz::math::SoaTransform>(&inout, 1);
+  job.output = ozz::Range<ozz::math::SoaTransform>(&inout, 1);
+  job.ratio = .5f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_SOAFLOAT3_EQ(inout.translation, 1.f, 1.f, 2.f, 3.f, 2.f, 0.f, 0.f,
+                      0.f, 0.f, 0.f, 0.f, 0.f);
+}
+
+TEST(Models, PoseInterpolationJob) {
+  using ozz::math::simd_float4::Load;
+  const ozz::math::Float4x4 from[] = {
+      ozz::math::Float4x4::identity(),
+      ozz::math::Float4x4::Translation(Load(2.f, 4.f, 6.f, 1.f))};
+  const ozz::math::Float4x4 to[] = {
+      ozz::math::Float4x4::Scaling(Load(3.f, 3.f, 3.f, 1.f)),
+      ozz::math::Float4x4::Translation(Load(4.f, 0.f, 6.f, 1.f))};
+  ozz::math::Float4x4 output[2];
+
+  PoseInterpolationJob job;
+  job.model_from = from;
+  job.model_to = to;
+  job.model_output = output;
+  job.ratio = .5f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_FLOAT4x4_EQ(output[0], 2.f, 0.f, 0.f, 0.f, 0.f, 2.f, 0.f, 0.f, 0.f,
+                     0.f, 2.f, 0.f, 0.f, 0.f, 0.f, 1.f);
+  EXPECT_FLOAT4x4_EQ(output[1], 1.f, 0.f, 0.f, 0.f, 0.f, 1.f, 0.f, 0.f, 0.f,
+                     0.f, 1.f, 0.f, 3.f, 2.f, 6.f, 1.f);
+}
+
+TEST(Scheduler, PoseInterpolationJob) {
+  // Interval is clamped.
+  EXPECT_EQ(UpdateRateScheduler(0).interval(), 1);
+  UpdateRateScheduler every_frame;
+  EXPECT_TRUE(every_frame.full_update(3));
+  EXPECT_FLOAT_EQ(every_frame.ratio(3), 0.f);
+
+  // Full updates of 6 instances are staggered over 3 frames.
+  UpdateRateScheduler scheduler(3);
+  int updates[6] = {0};
+  for (int frame = 0; frame < 9; ++frame) {
+    EXPECT_EQ(scheduler.frame(), static_cast<unsigned int>(frame));
+    int frame_updates = 0;
+    for (int i = 0; i < 6; ++i) {
+      const bool full = scheduler.full_update(i);
+      updates[i] += full;
+      frame_updates += full;
+      EXPECT_EQ(full, scheduler.ratio(i) == 0.f);
+    }
+    EXPECT_EQ(frame_updates, 2);
+    scheduler.Advance();
+  }
+  for (int i = 0; i < 6; ++i) {
+    EXPECT_EQ(updates[i], 3);
+  }
+
+  // Ratio increases between full updates.
+  UpdateRateScheduler ratios(4);
+  EXPECT_FLOAT_EQ(ratios.ratio(0), 0.f);
+  EXPECT_FLOAT_EQ(ratios.ratio(1), .25f);
+  ratios.Advance();
+  EXPECT_FLOAT_EQ(ratios.ratio(0), .25f);
+  EXPECT_FLOAT_EQ(ratios.ratio(3), 0.f);
+}
@@ -0,0 +1,568 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#include "ozz/animation/runtime/pose_stream.h"
+
+#include <cmath>
+#include <cstring>
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/io/archive.h"
+#include "ozz/base/io/stream.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/maths/vec_float.h"
+#include "ozz/base/memory/allocator.h"
+
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/raw_skeleton.h"
+#include "ozz/animation/offline/skeleton_builder.h"
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/blending_job.h"
+#include "ozz/animation/runtime/sampling_job.h"
+#include "ozz/animation/runtime/skeleton.h"
+
+using ozz::animation::Animation;
+using ozz::animation::BlendingJob;
+using ozz::animation::PoseStream;
+using ozz::animation::PoseStreamDecodingJob;
+using ozz::animation::PoseStreamLayer;
+using ozz::animation::SamplingCache;
+using ozz::animation::SamplingJob;
+using ozz::animation::Skeleton;
+using ozz::animation::offline::AnimationBuilder;
+using ozz::animation::offline::RawAnimation;
+using ozz::animation::offline::RawSkeleton;
+using ozz::animation::offline::SkeletonBuilder;
+
+namespace {
+const int kNumJoints = 6;
+const int kNumSoaJoints = (kNumJoints + 3) / 4;
+
+// Builds a kNumJoints joints chain skeleton.
+Skeleton* BuildSkeleton() {
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  RawSkeleton::Joint* joint = &raw_skeleton.roots[0];
+  for (int i = 0; i < kNumJoints; ++i) {
+    joint->name = "joint";
+    joint->transform.translation = ozz::math::Float3(0.f, 1.f, 0.f);
+    if (i != kNumJoints - 1) {
+      joint->children.resize(1);
+      joint = &joint->children[0];
+    }
+  }
+  SkeletonBuilder builder;
+  return builder(raw_skeleton);
+}
+
+// Builds a kNumJoints tracks animation, whose translations and rotations vary
+// with _seed.
+Animation* BuildAnimation(float _seed) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(kNumJoints);
+  for (int i = 0; i < kNumJoints; ++i) {
+    RawAnimation::JointTrack& track = raw_animation.tracks[i];
+    for (int k = 0; k < 5; ++k) {
+      const float time = k * .25f;
+      const float angle = _seed + i * .2f + k * .7f;
+      const RawAnimation::TranslationKey t = {
+          time, ozz::math::Float3(std::sin(angle), _seed * k, i * .5f)};
+      track.translations.push_back(t);
+      const RawAnimation::RotationKey r = {
+          time, ozz::math::Quaternion::FromAxisAngle(
+                    ozz::math::Float3::y_axis(), angle)};
+      track.rotations.push_back(r);
+    }
+  }
+  AnimationBuilder builder;
+  return builder(raw_animation);
+}
+
+// Gets frame _frame layers of the test recording: a walk/run cross fade
+// with an evolving weight.
+int GetLayers(int _frame, PoseStreamLayer _layers[2]) {
+  const float ratio = std::fmod(_frame * .013f, 1.f);
+  const float weight = .5f + .5f * std::sin(_frame * .1f);
+  _layers[0].clip = 0;
+  _layers[0].ratio = ratio;
+  _layers[0].weight = 1.f - weight;
+  _layers[1].clip = 1;
+  _layers[1].ratio = std::fmod(ratio * 1.5f, 1.f);
+  _layers[1].weight = weight;
+  return _frame % 7 == 6 ? 1 : 2;  // Some frames have a single layer.
+}
+
+// Samples and blends _layers, the way the recording application does.
+bool ComputePose(const Skeleton& _skeleton, const Animation* const* _animations,
+                 const PoseStreamLayer* _layers, int _num_layers,
+                 ozz::math::SoaTransform* _output) {
+  SamplingCache cache(kNumJoints);
+  ozz::math::SoaTransform locals[2][kNumSoaJoints];
+  BlendingJob::Layer blend_layers[2];
+  for (int i = 0; i < _num_layers; ++i) {
+    SamplingJob sampling_job;
+    sampling_job.animation = _animations[_layers[i].clip];
+    sampling_job.cache = &cache;
+    sampling_job.ratio = _layers[i].ratio;
+    sampling_job.output = locals[i];
+    if (!sampling_job.Run()) {
+      return false;
+    }
+    blend_layers[i].weight = _layers[i].weight;
+    blend_layers[i].transform = locals[i];
+  }
+  BlendingJob blending_job;
+  blending_job.layers =
+      ozz::Range<const BlendingJob::Layer>(blend_layers, _num_layers);
+  blending_job.bind_pose = _skeleton.joint_bind_poses();
+  blending_job.output =
+      ozz::Range<ozz::math::SoaTransform>(_output, kNumSoaJoints);
+  return blending_job.Run();
+}
+
+// Records _num_frames of the test recording to _stream.
+void Record(const Skeleton& _skeleton, const Animation* const* _animations,
+            int _num_frames, PoseStream* _stream) {
+  for (int f = 0; f < _num_frames; ++f) {
+    PoseStreamLayer layers[2];
+    const int num_layers = GetLayers(f, layers);
+    const ozz::math::Float3 target(f * .1f, 1.f, -f * .2f);
+    ozz::math::SoaTransform pose[kNumSoaJoints];
+    ASSERT_TRUE(
+        ComputePose(_skeleton, _animations, layers, num_layers, pose));
+    ASSERT_TRUE(_stream->Record(
+        ozz::Range<const PoseStreamLayer>(layers, num_layers),
+        ozz::Range<const ozz::math::Float3>(&target, 1), pose));
+  }
+}
+
+// Expects _a and _b translations to match with _tolerance.
+void ExpectTranslationsNear(const ozz::math::SoaTransform* _a,
+                            const ozz::math::SoaTransform* _b, int _count,
+                            float _tolerance) {
+  for (int i = 0; i < _count; ++i) {
+    const ozz::math::SimdFloat4 a[3] = {
+        _a[i].translation.x, _a[i].translation.y, _a[i].translation.z};
+    const ozz::math::SimdFloat4 b[3] = {
+        _b[i].translation.x, _b[i].translation.y, _b[i].translation.z};
+    for (int c = 0; c < 3; ++c) {
+      float fa[4];
+      float fb[4];
+      ozz::math::StorePtrU(a[c], fa);
+      ozz::math::StorePtrU(b[c], fb);
+      for (int l = 0; l < 4; ++l) {
+        EXPECT_NEAR(fa[l], fb[l], _tolerance);
+      }
+    }
+  }
+}
+
+bool PoseEqual(const ozz::math::SoaTransform* _a,
+               const ozz::math::SoaTransform* _b, int _count) {
+  return std::memcmp(_a, _b, sizeof(*_a) * _count) == 0;
+}
+}  // namespace
+
+TEST(Settings, PoseStream) {
+  PoseStream stream;
+  EXPECT_EQ(stream.settings().snapshot_interval, 60);
+  EXPECT_EQ(stream.num_frames(), 0);
+  EXPECT_EQ(stream.num_snapshots(), 0);
+  EXPECT_EQ(stream.FindSnapshot(0), -1);
+
+  PoseStream::Settings settings;
+  settings.snapshot_interval = -1;
+  EXPECT_FALSE(stream.Reset(settings));
+  settings.snapshot_interval = 10;
+  settings.rotation_precision = 0.f;
+  EXPECT_FALSE(stream.Reset(settings));
+  EXPECT_EQ(stream.settings().snapshot_interval, 60);
+
+  settings.rotation_precision = .001f;
+  EXPECT_TRUE(stream.Reset(settings));
+  EXPECT_EQ(stream.settings().snapshot_interval, 10);
+  EXPECT_TRUE(stream.IsSnapshotFrame(0));
+  EXPECT_FALSE(stream.IsSnapshotFrame(9));
+  EXPECT_TRUE(stream.IsSnapshotFrame(20));
+
+  settings.snapshot_interval = 0;
+  EXPECT_TRUE(stream.Reset(settings));
+  EXPECT_FALSE(stream.IsSnapshotFrame(0));
+}
+
+TEST(Record, PoseStream) {
+  PoseStream stream;
+  PoseStream::Settings settings;
+  settings.snapshot_interval = 3;
+  ASSERT_TRUE(stream.Reset(settings));
+
+  ozz::math::SoaTransform pose[2] = {ozz::math::SoaTransform::identity(),
+                                     ozz::math::SoaTransform::identity()};
+  PoseStreamLayer layers[PoseStream::kMaxLayers + 1];
+  for (int i = 0; i < PoseStream::kMaxLayers + 1; ++i) {
+    layers[i].clip = i;
+    layers[i].ratio = i * .1f;
+    layers[i].weight = 1.f / (i + 1);
+  }
+  const ozz::math::Float3 targets[] = {ozz::math::Float3(1.f, 2.f, 3.f),
+                                       ozz::math::Float3(-4.f, 5.f, -6.f)};
+
+  // Snapshot frame requires a pose.
+  EXPECT_FALSE(stream.Record(ozz::Range<const PoseStreamLayer>(layers, 2),
+                             targets,
+                             ozz::Range<const ozz::math::SoaTransform>()));
+  EXPECT_EQ(stream.num_frames(), 0);
+
+  // Too many layers.
+  EXPECT_FALSE(stream.Record(layers, targets, pose));
+
+  // Invalid clip.
+  layers[0].clip = -1;
+  EXPECT_FALSE(stream.Record(ozz::Range<const PoseStreamLayer>(layers, 2),
+                             targets, pose));
+  layers[0].clip = 65536;
+  EXPECT_FALSE(stream.Record(ozz::Range<const PoseStreamLayer>(layers, 2),
+                             targets, pose));
+  layers[0].clip = 65535;
+  EXPECT_EQ(stream.num_frames(), 0);
+
+  // Valid frames.
+  EXPECT_TRUE(stream.Record(ozz::Range<const PoseStreamLayer>(layers, 2),
+                            targets, pose));
+  EXPECT_TRUE(stream.Record(
+      ozz::Range<const PoseStreamLayer>(layers, PoseStream::kMaxLayers),
+      ozz::Range<const ozz::math::Float3>(), pose));
+  // Not a snapshot frame, pose isn't needed.
+  EXPECT_TRUE(stream.Record(ozz::Range<const PoseStreamLayer>(),
+                            ozz::Range<const ozz::math::Float3>(targets, 1),
+                            ozz::Range<const ozz::math::SoaTransform>()));
+  // Snapshots must have the same size.
+  EXPECT_FALSE(stream.Record(ozz::Range<const PoseStreamLayer>(),
+                             ozz::Range<const ozz::math::Float3>(),
+                             ozz::Range<const ozz::math::SoaTransform>(
+                                 pose, 1)));
+  EXPECT_TRUE(stream.Record(ozz::Range<const PoseStreamLayer>(),
+                            ozz::Range<const ozz::math::Float3>(), pose));
+  EXPECT_EQ(stream.num_frames(), 4);
+  EXPECT_EQ(stream.num_snapshots(), 2);
+  EXPECT_EQ(stream.num_soa_transforms(), 2);
+
+  // Reads frames back.
+  PoseStreamLayer read_layers[PoseStream::kMaxLayers];
+  ozz::math::Float3 read_targets[2];
+  int num_layers = -1;
+  int num_targets = -1;
+  EXPECT_FALSE(stream.ReadFrame(-1, read_layers, &num_layers, read_targets,
+                                &num_targets));
+  EXPECT_FALSE(stream.ReadFrame(4, read_layers, &num_layers, read_targets,
+                                &num_targets));
+  EXPECT_FALSE(stream.ReadFrame(0, read_layers, NULL, read_targets,
+                                &num_targets));
+  EXPECT_FALSE(
+      stream.ReadFrame(1, ozz::Range<PoseStreamLayer>(read_layers, 2),
+                       &num_layers, read_targets, &num_targets));
+  EXPECT_FALSE(stream.ReadFrame(0, read_layers, &num_layers,
+                                ozz::Range<ozz::math::Float3>(read_targets, 1),
+                                &num_targets));
+
+  ASSERT_TRUE(stream.ReadFrame(0, read_layers, &num_layers, read_targets,
+                               &num_targets));
+  ASSERT_EQ(num_layers, 2);
+  ASSERT_EQ(num_targets, 2);
+  EXPECT_EQ(read_layers[0].clip, 65535);
+  EXPECT_EQ(read_layers[1].clip, 1);
+  EXPECT_EQ(read_layers[1].ratio, layers[1].ratio);
+  EXPECT_EQ(read_layers[1].weight, layers[1].weight);
+  EXPECT_FLOAT3_EQ(read_targets[0], 1.f, 2.f, 3.f);
+  EXPECT_FLOAT3_EQ(read_targets[1], -4.f, 5.f, -6.f);
+
+  // IK targets are optional.
+  ASSERT_TRUE(stream.ReadFrame(1, read_layers, &num_layers,
+                               ozz::Range<ozz::math::Float3>(), NULL));
+  ASSERT_EQ(num_layers, PoseStream::kMaxLayers);
+  for (int i = 1; i < PoseStream::kMaxLayers; ++i) {
+    EXPECT_EQ(read_layers[i].clip, i);
+    EXPECT_EQ(read_layers[i].ratio, layers[i].ratio);
+    EXPECT_EQ(read_layers[i].weight, layers[i].weight);
+  }
+
+  ASSERT_TRUE(stream.ReadFrame(2, read_layers, &num_layers, read_targets,
+                               &num_targets));
+  EXPECT_EQ(num_layers, 0);
+  EXPECT_EQ(num_targets, 1);
+
+  // Snapshots.
+  EXPECT_EQ(stream.FindSnapshot(-1), -1);
+  EXPECT_EQ(stream.FindSnapshot(0), 0);
+  EXPECT_EQ(stream.FindSnapshot(2), 0);
+  EXPECT_EQ(stream.FindSnapshot(3), 1);
+  EXPECT_EQ(stream.FindSnapshot(100), 1);
+  EXPECT_EQ(stream.snapshot_frame(1), 3);
+
+  ozz::math::SoaTransform read_pose[2];
+  EXPECT_FALSE(stream.ReadSnapshot(2, read_pose));
+  EXPECT_FALSE(stream.ReadSnapshot(
+      0, ozz::Range<ozz::math::SoaTransform>(read_pose, 1)));
+  EXPECT_TRUE(stream.ReadSnapshot(1, read_pose));
+  EXPECT_SOAFLOAT3_EQ(read_pose[1].translation, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f,
+                      0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+  EXPECT_SOAQUATERNION_EQ(read_pose[1].rotation, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f,
+                          0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 1.f, 1.f, 1.f, 1.f);
+
+  // Reset clears everything.
+  EXPECT_TRUE(stream.Reset(settings));
+  EXPECT_EQ(stream.num_frames(), 0);
+  EXPECT_EQ(stream.num_snapshots(), 0);
+  EXPECT_EQ(stream.num_soa_transforms(), 0);
+}
+
+TEST(JobValidity, PoseStreamDecodingJob) {
+  Skeleton* skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton != NULL);
+  Animation* walk = BuildAnimation(0.f);
+  ASSERT_TRUE(walk != NULL);
+  Animation* run = BuildAnimation(1.f);
+  ASSERT_TRUE(run != NULL);
+  const Animation* animations[2] = {walk, run};
+
+  PoseStream stream;
+  Record(*skeleton, animations, 10, &stream);
+
+  SamplingCache cache(kNumJoints);
+  ozz::math::SoaTransform scratch[2 * kNumSoaJoints];
+  ozz::math::SoaTransform output[kNumSoaJoints];
+
+  {  // Empty/default job.
+    PoseStreamDecodingJob job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  PoseStreamDecodingJob valid;
+  valid.stream = &stream;
+  valid.frame = 3;
+  valid.animations = animations;
+  valid.skeleton = skeleton;
+  valid.cache = &cache;
+  valid.scratch = scratch;
+  valid.output = output;
+  EXPECT_TRUE(valid.Validate());
+  EXPECT_TRUE(valid.Run());
+
+  {  // Invalid frames.
+    PoseStreamDecodingJob job = valid;
+    job.frame = -1;
+    EXPECT_FALSE(job.Validate());
+    job.frame = 10;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Invalid output.
+    PoseStreamDecodingJob job = valid;
+    job.output = ozz::Range<ozz::math::SoaTransform>(output, 1);
+    EXPECT_FALSE(job.Validate());
+  }
+
+  {  // Invalid skeleton and cache.
+    PoseStreamDecodingJob job = valid;
+    job.skeleton = NULL;
+    EXPECT_FALSE(job.Validate());
+    job = valid;
+    job.cache = NULL;
+    EXPECT_FALSE(job.Validate());
+  }
+
+  {  // Scratch too small, detected when running.
+    PoseStreamDecodingJob job = valid;
+    job.scratch = ozz::Range<ozz::math::SoaTransform>(scratch, kNumSoaJoints);
+    EXPECT_TRUE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Missing animation.
+    PoseStreamDecodingJob job = valid;
+    job.animations = ozz::Range<const Animation* const>(animations, 1);
+    EXPECT_TRUE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  ozz::memory::default_allocator()->Delete(walk);
+  ozz::memory::default_allocator()->Delete(run);
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+TEST(Decode, PoseStreamDecodingJob) {
+  Skeleton* skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton != NULL);
+  Animation* walk = BuildAnimation(0.f);
+  ASSERT_TRUE(walk != NULL);
+  Animation* run = BuildAnimation(1.f);
+  ASSERT_TRUE(run != NULL);
+  const Animation* animations[2] = {walk, run};
+
+  const int kNumFrames = 200;
+  PoseStream stream;
+  PoseStream::Settings settings;
+  settings.snapshot_interval = 30;
+  ASSERT_TRUE(stream.Reset(settings));
+  Record(*skeleton, animations, kNumFrames, &stream);
+  EXPECT_EQ(stream.num_frames(), kNumFrames);
+  EXPECT_EQ(stream.num_snapshots(), 7);
+
+  SamplingCache cache(kNumJoints);
+  ozz::math::SoaTransform scratch[2 * kNumSoaJoints];
+  ozz::math::SoaTransform output[kNumSoaJoints];
+  ozz::math::Float3 targets[2];
+  int num_targets = 0;
+
+  PoseStreamDecodingJob job;
+  job.stream = &stream;
+  job.animations = animations;
+  job.skeleton = skeleton;
+  job.cache = &cache;
+  job.scratch = scratch;
+  job.output = output;
+  job.ik_targets = targets;
+  job.num_ik_targets = &num_targets;
+
+  // Decodes frames in random order, as seeking does. Animation state is stored
+  // exactly, so decoded poses are bit identical.
+  for (int i = 0; i < kNumFrames; ++i) {
+    const int f = (i * 37) % kNumFrames;
+    PoseStreamLayer layers[2];
+    const int num_layers = GetLayers(f, layers);
+    ozz::math::SoaTransform expected[kNumSoaJoints];
+    ASSERT_TRUE(ComputePose(*skeleton, animations, layers, num_layers,
+                            expected));
+
+    job.frame = f;
+    job.use_snapshots = false;
+    ASSERT_TRUE(job.Run());
+    EXPECT_TRUE(PoseEqual(output, expected, kNumSoaJoints)) << "frame " << f;
+    ASSERT_EQ(num_targets, 1);
+    EXPECT_FLOAT3_EQ(targets[0], f * .1f, 1.f, -f * .2f);
+
+    // Snapshot frames are quantized.
+    job.use_snapshots = true;
+    ASSERT_TRUE(job.Run());
+    if (stream.IsSnapshotFrame(f)) {
+      ExpectTranslationsNear(output, expected, kNumSoaJoints,
+                             settings.translation_precision);
+    } else {
+      EXPECT_TRUE(PoseEqual(output, expected, kNumSoaJoints));
+    }
+  }
+
+  // Replay is much smaller than raw poses.
+  const size_t raw_size = sizeof(ozz::math::SoaTransform) * kNumSoaJoints *
+                          static_cast<size_t>(kNumFrames);
+  EXPECT_LT(stream.size() * 4, raw_size);
+
+  ozz::memory::default_allocator()->Delete(walk);
+  ozz::memory::default_allocator()->Delete(run);
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+TEST(Serialize, PoseStream) {
+  Skeleton* skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton != NULL);
+  Animation* walk = BuildAnimation(0.f);
+  ASSERT_TRUE(walk != NULL);
+  Animation* run = BuildAnimation(1.f);
+  ASSERT_TRUE(run != NULL);
+  const Animation* animations[2] = {walk, run};
+
+  PoseStream o_stream;
+  PoseStream::Settings settings;
+  settings.snapshot_interval = 8;
+  settings.translation_precision = .01f;
+  ASSERT_TRUE(o_stream.Reset(settings));
+  Record(*skeleton, animations, 20, &o_stream);
+
+  ozz::io::MemoryStream memory;
+  {
+    ozz::io::OArchive o(&memory);
+    o << o_stream;
+
+    PoseStream empty;
+    o << empty;
+  }
+
+  memory.Seek(0, ozz::io::Stream::kSet);
+  ozz::io::IArchive i(&memory);
+
+  // Loads in an already used stream.
+  PoseStream i_stream;
+  Record(*skeleton, animations, 3, &i_stream);
+  i >> i_stream;
+
+  EXPECT_EQ(i_stream.settings().snapshot_interval, 8);
+  EXPECT_FLOAT_EQ(i_stream.settings().translation_precision, .01f);
+  EXPECT_EQ(i_stream.num_frames(), 20);
+  EXPECT_EQ(i_stream.num_snapshots(), 3);
+  EXPECT_EQ(i_stream.num_soa_transforms(), kNumSoaJoints);
+  EXPECT_EQ(i_stream.size(), o_stream.size());
+
+  for (int f = 0; f < 20; ++f) {
+    PoseStreamLayer o_layers[PoseStream::kMaxLayers];
+    PoseStreamLayer i_layers[PoseStream::kMaxLayers];
+    int o_num_layers = 0;
+    int i_num_layers = 0;
+    ASSERT_TRUE(o_stream.ReadFrame(f, o_layers, &o_num_layers,
+                                   ozz::Range<ozz::math::Float3>(), NULL));
+    ASSERT_TRUE(i_stream.ReadFrame(f, i_layers, &i_num_layers,
+                                   ozz::Range<ozz::math::Float3>(), NULL));
+    ASSERT_EQ(o_num_layers, i_num_layers);
+    for (int l = 0; l < o_num_layers; ++l) {
+      EXPECT_EQ(o_layers[l].clip, i_layers[l].clip);
+      EXPECT_EQ(o_layers[l].ratio, i_layers[l].ratio);
+      EXPECT_EQ(o_layers[l].weight, i_layers[l].weight);
+    }
+  }
+  for (int s = 0; s < 3; ++s) {
+    ozz::math::SoaTransform o_pose[kNumSoaJoints];
+    ozz::math::SoaTransform i_pose[kNumSoaJoints];
+    ASSERT_TRUE(o_stream.ReadSnapshot(s, o_pose));
+    ASSERT_TRUE(i_stream.ReadSnapshot(s, i_pose));
+    EXPECT_TRUE(PoseEqual(o_pose, i_pose, kNumSoaJoints));
+  }
+
+  // Empty stream.
+  i >> i_stream;
+  EXPECT_EQ(i_stream.num_frames(), 0);
+  EXPECT_EQ(i_stream.num_snapshots(), 0);
+
+  ozz::memory::default_allocator()->Delete(walk);
+  ozz::memory::default_allocator()->Delete(run);
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
@@ -0,0 +1,250 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/remap_job.h"
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/io/archive.h"
+#include "ozz/base/io/stream.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/allocator.h"
+
+#include "ozz/animation/offline/raw_skeleton.h"
+#include "ozz/animation/offline/skeleton_builder.h"
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/animation/runtime/skeleton_utils.h"
+
+using ozz::animation::RemapJob;
+using ozz::animation::Skeleton;
+using ozz::animation::offline::RawSkeleton;
+using ozz::animation::offline::SkeletonBuilder;
+
+namespace {
+// Builds a skeleton made of a chain of 8 joints named "j0" to "j7". An extra
+// joint named "extra" is added as the first child of the root if _extra_first
+// is true, or the last one otherwise.
+Skeleton* BuildSkeleton(bool _extra, bool _extra_first) {
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  RawSkeleton::Joint& root = raw_skeleton.roots[0];
+  root.name = "j0";
+  root.children.resize(_extra ? 2 : 1);
+  if (_extra) {
+    root.children[_extra_first ? 0 : 1].name = "extra";
+  }
+  RawSkeleton::Joint* joint = &root.children[_extra && _extra_first ? 1 : 0];
+  for (int i = 1; i < 8; ++i) {
+    joint->name = "j";
+    joint->name += static_cast<char>('0' + i);
+    if (i < 7) {
+      joint->children.resize(1);
+      joint = &joint->children[0];
+    }
+  }
+  SkeletonBuilder builder;
+  return builder(raw_skeleton);
+}
+
+// Fills _pose with a translation x set to (joint index + _offset).
+void FillPose(ozz::math::SoaTransform* _pose, int _num_soa, float _offset) {
+  for (int i = 0; i < _num_soa; ++i) {
+    const float f = static_cast<float>(i * 4) + _offset;
+    _pose[i] = ozz::math::SoaTransform::identity();
+    _pose[i].translation.x =
+        ozz::math::simd_float4::Load(f, f + 1.f, f + 2.f, f + 3.f);
+  }
+}
+}  // namespace
+
+TEST(Validate, RemapJob) {
+  ozz::math::SoaTransform input[2];
+  ozz::math::SoaTransform output[2];
+  const int remap[] = {0, 1, 7, -1, 3};
+
+  {  // Empty/default job.
+    RemapJob job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Valid job.
+    RemapJob job;
+    job.remap = ozz::Range<const int>(remap, OZZ_ARRAY_SIZE(remap));
+    job.input.begin = input;
+    job.input.end = input + 2;
+    job.output.begin = output;
+    job.output.end = output + 2;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+
+    // Output too small.
+    job.output.end = output + 1;
+    EXPECT_FALSE(job.Validate());
+
+    // In place.
+    job.output.begin = input;
+    job.output.end = input + 2;
+    EXPECT_FALSE(job.Validate());
+  }
+
+  {  // Remap entry out of range.
+    RemapJob job;
+    job.remap = ozz::Range<const int>(remap, OZZ_ARRAY_SIZE(remap));
+    job.input.begin = input;
+    job.input.end = input + 1;
+    job.output.begin = output;
+    job.output.end = output + 2;
+    EXPECT_FALSE(job.Validate());
+  }
+}
+
+TEST(Remap, RemapJob) {
+  ozz::math::SoaTransform input[2];
+  FillPose(input, 2, 0.f);
+  ozz::math::SoaTransform output[2];
+  FillPose(output, 2, 100.f);
+
+  // First block is copied at once, second one is remapped per joint.
+  const int remap[] = {0, 1, 2, 3, 7, -1, 4};
+  RemapJob job;
+  job.remap = ozz::Range<const int>(remap, OZZ_ARRAY_SIZE(remap));
+  job.input.begin = input;
+  job.input.end = input + 2;
+  job.output.begin = output;
+  job.output.end = output + 2;
+  ASSERT_TRUE(job.Run());
+
+  EXPECT_SOAFLOAT3_EQ(output[0].translation, 0.f, 1.f, 2.f, 3.f, 0.f, 0.f, 0.f,
+                      0.f, 0.f, 0.f, 0.f, 0.f);
+  EXPECT_SOAFLOAT3_EQ(output[1].translation, 7.f, 105.f, 4.f, 107.f, 0.f, 0.f,
+                      0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+  EXPECT_SOAQUATERNION_EQ(output[1].rotation, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f,
+                          0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 1.f, 1.f, 1.f, 1.f);
+}
+
+TEST(BuildJointRemap, RemapJob) {
+  Skeleton* source = BuildSkeleton(false, false);
+  ASSERT_TRUE(source != NULL);
+  Skeleton* extra_last = BuildSkeleton(true, false);
+  ASSERT_TRUE(extra_last != NULL);
+  Skeleton* extra_first = BuildSkeleton(true, true);
+  ASSERT_TRUE(extra_first != NULL);
+  ASSERT_EQ(source->num_joints(), 8);
+  ASSERT_EQ(extra_last->num_joints(), 9);
+
+  int remap[9];
+
+  // Table too small.
+  EXPECT_EQ(ozz::animation::BuildJointRemap(
+                *source, *extra_last, ozz::Range<int>(remap, 8)),
+            -1);
+
+  // Extra joint last.
+  EXPECT_EQ(ozz::animation::BuildJointRemap(*source, *extra_last,
+                                            ozz::Range<int>(remap, 9)),
+            8);
+  const int expected_last[] = {0, 1, 2, 3, 4, 5, 6, 7, -1};
+  for (int i = 0; i < 9; ++i) {
+    EXPECT_EQ(remap[i], expected_last[i]);
+  }
+
+  // Extra joint first.
+  EXPECT_EQ(ozz::animation::BuildJointRemap(*source, *extra_first,
+                                            ozz::Range<int>(remap, 9)),
+            8);
+  const int expected_first[] = {0, -1, 1, 2, 3, 4, 5, 6, 7};
+  for (int i = 0; i < 9; ++i) {
+    EXPECT_EQ(remap[i], expected_first[i]);
+  }
+
+  // Remaps a source pose to the target skeleton.
+  ozz::math::SoaTransform input[2];
+  FillPose(input, 2, 0.f);
+  ozz::math::SoaTransform output[3];
+  FillPose(output, 3, 100.f);
+  RemapJob job;
+  job.remap = ozz::Range<const int>(remap, OZZ_ARRAY_SIZE(remap));
+  job.input.begin = input;
+  job.input.end = input + 2;
+  job.output.begin = output;
+  job.output.end = output + 3;
+  ASSERT_TRUE(job.Run());
+  EXPECT_SOAFLOAT3_EQ(output[0].translation, 0.f, 101.f, 1.f, 2.f, 0.f, 0.f,
+                      0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+  EXPECT_SOAFLOAT3_EQ(output[1].translation, 3.f, 4.f, 5.f, 6.f, 0.f, 0.f, 0.f,
+                      0.f, 0.f, 0.f, 0.f, 0.f);
+  EXPECT_SOAFLOAT3_EQ(output[2].translation, 7.f, 109.f, 110.f, 111.f, 0.f,
+                      0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+
+  ozz::memory::default_allocator()->Delete(source);
+  ozz::memory::default_allocator()->Delete(extra_last);
+  ozz::memory::default_allocator()->Delete(extra_first);
+}
+
+TEST(BuildJointRemapHashes, RemapJob) {
+  Skeleton* source = BuildSkeleton(false, false);
+  ASSERT_TRUE(source != NULL);
+  Skeleton* extra_first = BuildSkeleton(true, true);
+  ASSERT_TRUE(extra_first != NULL);
+
+  // Reloads source skeleton without names.
+  ozz::io::MemoryStream stream;
+  {
+    ozz::io::OArchive o(&stream);
+    o << *source;
+  }
+  stream.Seek(0, ozz::io::Stream::kSet);
+  Skeleton nameless;
+  nameless.set_load_names(false);
+  {
+    ozz::io::IArchive ia(&stream);
+    ia >> nameless;
+  }
+  ASSERT_EQ(nameless.joint_names().count(), 0u);
+
+  // Joints are matched by name hashes, both ways.
+  int remap[9];
+  EXPECT_EQ(ozz::animation::BuildJointRemap(nameless, *extra_first,
+                                            ozz::Range<int>(remap, 9)),
+            8);
+  const int expected_first[] = {0, -1, 1, 2, 3, 4, 5, 6, 7};
+  for (int i = 0; i < 9; ++i) {
+    EXPECT_EQ(remap[i], expected_first[i]);
+  }
+  EXPECT_EQ(ozz::animation::BuildJointRemap(*extra_first, nameless,
+                                            ozz::Range<int>(remap, 8)),
+            8);
+  const int expected_back[] = {0, 2, 3, 4, 5, 6, 7, 8};
+  for (int i = 0; i < 8; ++i) {
+    EXPECT_EQ(remap[i], expected_back[i]);
+  }
+
+  ozz::memory::default_allocator()->Delete(source);
+  ozz::memory::default_allocator()->Delete(extra_first);
+}
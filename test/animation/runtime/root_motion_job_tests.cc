@@ -0,0 +1,187 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/root_motion_job.h"
+
+#include "gtest/gtest.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/quaternion.h"
+#include "ozz/base/maths/vec_float.h"
+#include "ozz/base/memory/allocator.h"
+
+#include "ozz/animation/offline/raw_track.h"
+#include "ozz/animation/offline/track_builder.h"
+#include "ozz/animation/runtime/track.h"
+
+using ozz::animation::Float3Track;
+using ozz::animation::QuaternionTrack;
+using ozz::animation::RootMotionJob;
+using ozz::animation::offline::RawFloat3Track;
+using ozz::animation::offline::RawQuaternionTrack;
+using ozz::animation::offline::RawTrackInterpolation;
+using ozz::animation::offline::TrackBuilder;
+
+TEST(JobValidity, RootMotionJob) {
+  TrackBuilder builder;
+  Float3Track* translation = builder(RawFloat3Track());
+  ASSERT_TRUE(translation != NULL);
+  QuaternionTrack* rotation = builder(RawQuaternionTrack());
+  ASSERT_TRUE(rotation != NULL);
+
+  ozz::math::Float3 delta_translation;
+  ozz::math::Quaternion delta_rotation;
+
+  {  // Default is invalid.
+    RootMotionJob job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  RootMotionJob valid;
+  valid.translation = translation;
+  valid.rotation = rotation;
+  valid.delta_translation = &delta_translation;
+  valid.delta_rotation = &delta_rotation;
+  EXPECT_TRUE(valid.Validate());
+
+  {  // Empty tracks give no motion.
+    RootMotionJob job = valid;
+    job.from = .2f;
+    job.to = 3.7f;
+    ASSERT_TRUE(job.Run());
+    EXPECT_FLOAT3_EQ(delta_translation, 0.f, 0.f, 0.f);
+    EXPECT_QUATERNION_EQ(delta_rotation, 0.f, 0.f, 0.f, 1.f);
+  }
+  {
+    RootMotionJob job = valid;
+    job.translation = NULL;
+    EXPECT_FALSE(job.Validate());
+  }
+  {
+    RootMotionJob job = valid;
+    job.rotation = NULL;
+    EXPECT_FALSE(job.Validate());
+  }
+  {
+    RootMotionJob job = valid;
+    job.delta_translation = NULL;
+    EXPECT_FALSE(job.Validate());
+  }
+  {
+    RootMotionJob job = valid;
+    job.delta_rotation = NULL;
+    EXPECT_FALSE(job.Validate());
+  }
+
+  ozz::memory::default_allocator()->Delete(translation);
+  ozz::memory::default_allocator()->Delete(rotation);
+}
+
+TEST(Delta, RootMotionJob) {
+  // Root moves 1 unit along x while turning a quarter around y, every loop.
+  RawFloat3Track raw_translation;
+  const RawFloat3Track::Keyframe tkeys[] = {
+      {RawTrackInterpolation::kLinear, 0.f, ozz::math::Float3(0.f, 0.f, 0.f)},
+      {RawTrackInterpolation::kLinear, 1.f, ozz::math::Float3(1.f, 0.f, 0.f)}};
+  raw_translation.keyframes.assign(tkeys, tkeys + 2);
+  RawQuaternionTrack raw_rotation;
+  const RawQuaternionTrack::Keyframe rkeys[] = {
+      {RawTrackInterpolation::kLinear, 0.f,
+       ozz::math::Quaternion::identity()},
+      {RawTrackInterpolation::kLinear, 1.f,
+       ozz::math::Quaternion::FromAxisAngle(ozz::math::Float3::y_axis(),
+                                            ozz::math::kPi_2)}};
+  raw_rotation.keyframes.assign(rkeys, rkeys + 2);
+
+  TrackBuilder builder;
+  Float3Track* translation = builder(raw_translation);
+  ASSERT_TRUE(translation != NULL);
+  QuaternionTrack* rotation = builder(raw_rotation);
+  ASSERT_TRUE(rotation != NULL);
+
+  ozz::math::Float3 delta_translation;
+  ozz::math::Quaternion delta_rotation;
+  RootMotionJob job;
+  job.translation = translation;
+  job.rotation = rotation;
+  job.delta_translation = &delta_translation;
+  job.delta_rotation = &delta_rotation;
+
+  const float kSin45 = .70710678f;
+  const float kSin22 = .38268343f;
+  const float kCos22 = .92387953f;
+
+  {  // Within a loop.
+    job.from = 0.f;
+    job.to = .5f;
+    ASSERT_TRUE(job.Run());
+    EXPECT_FLOAT3_EQ(delta_translation, .5f, 0.f, 0.f);
+    EXPECT_QUATERNION_EQ(delta_rotation, 0.f, kSin22, 0.f, kCos22);
+
+    // Translation is expressed in root motion space at from.
+    job.from = .5f;
+    job.to = 1.f;
+    ASSERT_TRUE(job.Run());
+    EXPECT_FLOAT3_EQ(delta_translation, .5f * kSin45, 0.f, .5f * kSin45);
+    EXPECT_QUATERNION_EQ(delta_rotation, 0.f, kSin22, 0.f, kCos22);
+  }
+
+  {  // Whole loops accumulate.
+    job.from = 0.f;
+    job.to = 2.f;
+    ASSERT_TRUE(job.Run());
+    EXPECT_FLOAT3_EQ(delta_translation, 1.f, 0.f, -1.f);
+    EXPECT_QUATERNION_EQ(delta_rotation, 0.f, 1.f, 0.f, 0.f);
+  }
+
+  {  // Wraps to the next loop.
+    job.from = .5f;
+    job.to = 1.5f;
+    ASSERT_TRUE(job.Run());
+    EXPECT_FLOAT3_EQ(delta_translation, kSin45, 0.f, 0.f);
+    EXPECT_QUATERNION_EQ(delta_rotation, 0.f, kSin45, 0.f, kSin45);
+  }
+
+  {  // Backward.
+    job.from = 1.5f;
+    job.to = .5f;
+    ASSERT_TRUE(job.Run());
+    EXPECT_FLOAT3_EQ(delta_translation, 0.f, 0.f, -kSin45);
+    EXPECT_QUATERNION_EQ(delta_rotation, 0.f, -kSin45, 0.f, kSin45);
+  }
+
+  {  // No motion.
+    job.from = 1.3f;
+    job.to = 1.3f;
+    ASSERT_TRUE(job.Run());
+    EXPECT_FLOAT3_EQ(delta_translation, 0.f, 0.f, 0.f);
+    EXPECT_QUATERNION_EQ(delta_rotation, 0.f, 0.f, 0.f, 1.f);
+  }
+
+  ozz::memory::default_allocator()->Delete(translation);
+  ozz::memory::default_allocator()->Delete(rotation);
+}
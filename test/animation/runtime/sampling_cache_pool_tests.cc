@@ -0,0 +1,188 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/sampling_cache_pool.h"
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/io/archive.h"
+#include "ozz/base/io/stream.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/allocator.h"
+
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/sampling_job.h"
+
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/raw_animation.h"
+
+using ozz::animation::Animation;
+using ozz::animation::SamplingCache;
+using ozz::animation::SamplingCachePool;
+using ozz::animation::SamplingJob;
+using ozz::animation::offline::AnimationBuilder;
+using ozz::animation::offline::RawAnimation;
+
+namespace {
+Animation* BuildAnimation(float _scale, int _num_tracks = 1) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(_num_tracks);
+
+  const RawAnimation::TranslationKey tkey0 = {
+      0.f, ozz::math::Float3(0.f, 0.f, 0.f)};
+  raw_animation.tracks[0].translations.push_back(tkey0);
+  const RawAnimation::TranslationKey tkey1 = {
+      1.f, ozz::math::Float3(_scale, 0.f, 0.f)};
+  raw_animation.tracks[0].translations.push_back(tkey1);
+
+  AnimationBuilder builder;
+  return builder(raw_animation);
+}
+}  // namespace
+
+TEST(Empty, SamplingCachePool) {
+  Animation* animation = BuildAnimation(1.f);
+  ASSERT_TRUE(animation != NULL);
+
+  SamplingCachePool pool;
+  EXPECT_EQ(pool.num_caches(), 0);
+  EXPECT_EQ(pool.max_tracks(), 0);
+  EXPECT_TRUE(pool.Get(*animation) == NULL);
+
+  // No cache.
+  pool.Resize(4, 0);
+  EXPECT_TRUE(pool.Get(*animation) == NULL);
+
+  // Too many tracks.
+  Animation* big = BuildAnimation(1.f, 5);
+  ASSERT_TRUE(big != NULL);
+  pool.Resize(4, 2);
+  EXPECT_EQ(pool.max_tracks(), 4);
+  EXPECT_TRUE(pool.Get(*big) == NULL);
+  EXPECT_TRUE(pool.Get(*animation) != NULL);
+
+  ozz::memory::default_allocator()->Delete(big);
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+TEST(Reuse, SamplingCachePool) {
+  Animation* animation0 = BuildAnimation(1.f);
+  ASSERT_TRUE(animation0 != NULL);
+  Animation* animation1 = BuildAnimation(2.f);
+  ASSERT_TRUE(animation1 != NULL);
+  Animation* animation2 = BuildAnimation(3.f);
+  ASSERT_TRUE(animation2 != NULL);
+
+  SamplingCachePool pool(1, 2);
+  EXPECT_EQ(pool.num_caches(), 2);
+  EXPECT_EQ(pool.max_tracks(), 4);
+
+  // Same animation gets the same cache.
+  SamplingCache* cache0 = pool.Get(*animation0);
+  ASSERT_TRUE(cache0 != NULL);
+  EXPECT_EQ(pool.Get(*animation0), cache0);
+  EXPECT_TRUE(pool.Contains(*animation0));
+
+  // Another animation gets another cache.
+  SamplingCache* cache1 = pool.Get(*animation1);
+  ASSERT_TRUE(cache1 != NULL);
+  EXPECT_NE(cache1, cache0);
+  EXPECT_TRUE(pool.Contains(*animation1));
+
+  // Caches can be used for sampling.
+  ozz::math::SoaTransform output[1];
+  SamplingJob job;
+  job.animation = animation0;
+  job.cache = cache0;
+  job.ratio = .5f;
+  job.output.begin = output;
+  job.output.end = output + 1;
+  ASSERT_TRUE(job.Run());
+  EXPECT_SOAFLOAT3_EQ_EST(output[0].translation, .5f, 0.f, 0.f, 0.f, 0.f, 0.f,
+                          0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+
+  // Uses animation0 again, so animation1 is the least recently used one.
+  EXPECT_EQ(pool.Get(*animation0), cache0);
+  EXPECT_EQ(pool.Get(*animation2), cache1);
+  EXPECT_TRUE(pool.Contains(*animation0));
+  EXPECT_FALSE(pool.Contains(*animation1));
+  EXPECT_TRUE(pool.Contains(*animation2));
+
+  // animation1 now recycles animation0 cache.
+  EXPECT_EQ(pool.Get(*animation1), cache0);
+  EXPECT_FALSE(pool.Contains(*animation0));
+
+  // Invalidation empties the pool.
+  pool.Invalidate();
+  EXPECT_FALSE(pool.Contains(*animation1));
+  EXPECT_FALSE(pool.Contains(*animation2));
+
+  ozz::memory::default_allocator()->Delete(animation0);
+  ozz::memory::default_allocator()->Delete(animation1);
+  ozz::memory::default_allocator()->Delete(animation2);
+}
+
+TEST(Uid, SamplingCachePool) {
+  Animation empty;
+  EXPECT_EQ(empty.uid(), 0u);
+
+  Animation* animation0 = BuildAnimation(1.f);
+  ASSERT_TRUE(animation0 != NULL);
+  Animation* animation1 = BuildAnimation(1.f);
+  ASSERT_TRUE(animation1 != NULL);
+  EXPECT_NE(animation0->uid(), 0u);
+  EXPECT_NE(animation1->uid(), 0u);
+  EXPECT_NE(animation0->uid(), animation1->uid());
+
+  SamplingCachePool pool(1, 2);
+  ASSERT_TRUE(pool.Get(*animation0) != NULL);
+  EXPECT_TRUE(pool.Contains(*animation0));
+
+  // Reloading an animation at the same address changes its identifier, so
+  // the cache isn't considered warm anymore.
+  const uint32_t uid = animation0->uid();
+  ozz::io::MemoryStream stream;
+  ozz::io::OArchive o(&stream);
+  o << *animation1;
+  stream.Seek(0, ozz::io::Stream::kSet);
+  ozz::io::IArchive i(&stream);
+  i >> *animation0;
+  EXPECT_NE(animation0->uid(), 0u);
+  EXPECT_NE(animation0->uid(), uid);
+  EXPECT_NE(animation0->uid(), animation1->uid());
+  EXPECT_FALSE(pool.Contains(*animation0));
+
+  SamplingCache* cache = pool.Get(*animation0);
+  ASSERT_TRUE(cache != NULL);
+  EXPECT_TRUE(pool.Contains(*animation0));
+  EXPECT_EQ(pool.Get(*animation0), cache);
+
+  ozz::memory::default_allocator()->Delete(animation0);
+  ozz::memory::default_allocator()->Delete(animation1);
+}
@@ -27,19 +27,32 @@
 
 #include "ozz/animation/runtime/sampling_job.h"
 
+#include <cmath>
+#include <cstring>
+
 #include "gtest/gtest.h"
 
+#include "ozz/base/containers/inline_vector.h"
+#include "ozz/base/containers/vector.h"
 #include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/soa_half_transform.h"
 #include "ozz/base/maths/soa_transform.h"
 #include "ozz/base/memory/allocator.h"
+#include "ozz/base/prepared_job.h"
+#include "ozz/base/task_scheduler.h"
 
 #include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/skeleton.h"
 
 #include "ozz/animation/offline/animation_builder.h"
 #include "ozz/animation/offline/raw_animation.h"
 
 using ozz::animation::Animation;
+using ozz::animation::BatchSamplingJob;
+using ozz::animation::CacheWarmUpJob;
+using ozz::animation::GroupedSamplingJob;
 using ozz::animation::SamplingCache;
+using ozz::animation::SamplingCounters;
 using ozz::animation::SamplingJob;
 using ozz::animation::offline::AnimationBuilder;
 using ozz::animation::offline::RawAnimation;
@@ -688,3 +701,2307 @@ TEST(CacheResize, SamplingJob) {
 
   ozz::memory::default_allocator()->Delete(animation);
 }
+
+TEST(JobValidity, BatchSamplingJob) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(1);
+
+  AnimationBuilder builder;
+  Animation* animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+
+  SamplingCache cache0(1);
+  SamplingCache cache1(1);
+  SamplingCache zero_cache(0);
+  ozz::math::SoaTransform output0[1];
+  ozz::math::SoaTransform output1[1];
+
+  const float ratios[] = {0.f, .5f};
+  SamplingCache* caches[] = {&cache0, &cache1};
+  const ozz::Range<ozz::math::SoaTransform> outputs[] = {
+      ozz::Range<ozz::math::SoaTransform>(output0),
+      ozz::Range<ozz::math::SoaTransform>(output1)};
+
+  {  // Empty/default job
+    BatchSamplingJob job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Empty batch.
+    BatchSamplingJob job;
+    job.animation = animation;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+
+  {  // Invalid animation.
+    BatchSamplingJob job;
+    job.ratios = ratios;
+    job.caches = caches;
+    job.outputs = outputs;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Mismatching ranges.
+    BatchSamplingJob job;
+    job.animation = animation;
+    job.ratios = ratios;
+    job.caches = caches;
+    job.outputs = ozz::Range<const ozz::Range<ozz::math::SoaTransform> >(
+        outputs, 1);
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Invalid cache.
+    SamplingCache* null_caches[] = {&cache0, NULL};
+    BatchSamplingJob job;
+    job.animation = animation;
+    job.ratios = ratios;
+    job.caches = null_caches;
+    job.outputs = outputs;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Invalid cache size.
+    SamplingCache* small_caches[] = {&cache0, &zero_cache};
+    BatchSamplingJob job;
+    job.animation = animation;
+    job.ratios = ratios;
+    job.caches = small_caches;
+    job.outputs = outputs;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Invalid output.
+    const ozz::Range<ozz::math::SoaTransform> small_outputs[] = {
+        ozz::Range<ozz::math::SoaTransform>(output0),
+        ozz::Range<ozz::math::SoaTransform>(output1, static_cast<size_t>(0))};
+    BatchSamplingJob job;
+    job.animation = animation;
+    job.ratios = ratios;
+    job.caches = caches;
+    job.outputs = small_outputs;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Invalid grain size.
+    BatchSamplingJob job;
+    job.animation = animation;
+    job.ratios = ratios;
+    job.caches = caches;
+    job.outputs = outputs;
+    job.grain_size = 0;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Invalid prefetch distance.
+    BatchSamplingJob job;
+    job.animation = animation;
+    job.ratios = ratios;
+    job.caches = caches;
+    job.outputs = outputs;
+    job.prefetch_distance = -1;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Valid job.
+    BatchSamplingJob job;
+    job.animation = animation;
+    job.ratios = ratios;
+    job.caches = caches;
+    job.outputs = outputs;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+namespace {
+// Runs tasks in reverse order, to detect any order dependency.
+class ReverseScheduler : public ozz::TaskScheduler {
+ public:
+  ReverseScheduler() : num_tasks(0) {}
+  virtual void ParallelFor(Task _task, void* _context, int _count) {
+    for (int i = _count - 1; i >= 0; --i) {
+      _task(_context, i);
+      ++num_tasks;
+    }
+  }
+  int num_tasks;
+};
+}  // namespace
+
+TEST(Sampling, BatchSamplingJob) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(5);
+
+  const RawAnimation::TranslationKey tkey0 = {0.f,
+                                              ozz::math::Float3(0.f, 2.f, 4.f)};
+  raw_animation.tracks[0].translations.push_back(tkey0);
+  const RawAnimation::TranslationKey tkey1 = {1.f,
+                                              ozz::math::Float3(4.f, 6.f, 8.f)};
+  raw_animation.tracks[0].translations.push_back(tkey1);
+  const RawAnimation::ScaleKey skey0 = {0.f, ozz::math::Float3(1.f, 1.f, 1.f)};
+  raw_animation.tracks[4].scales.push_back(skey0);
+  const RawAnimation::ScaleKey skey1 = {1.f, ozz::math::Float3(3.f, 3.f, 3.f)};
+  raw_animation.tracks[4].scales.push_back(skey1);
+
+  AnimationBuilder builder;
+  Animation* animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+
+  // Ratios are voluntarily not sorted, and some are shared.
+  const float ratios[] = {.5f, .5f, 0.f, 1.f, 1.f, -1.f, .25f};
+  const size_t kNumInstances = OZZ_ARRAY_SIZE(ratios);
+
+  SamplingCache caches[kNumInstances];
+  SamplingCache* pcaches[kNumInstances];
+  ozz::math::SoaTransform outputs[kNumInstances][2];
+  ozz::Range<ozz::math::SoaTransform> routputs[kNumInstances];
+  for (size_t i = 0; i < kNumInstances; ++i) {
+    caches[i].Resize(5);
+    pcaches[i] = &caches[i];
+    routputs[i] = outputs[i];
+  }
+
+  BatchSamplingJob job;
+  job.animation = animation;
+  job.ratios = ratios;
+  job.caches = pcaches;
+  job.outputs = ozz::Range<const ozz::Range<ozz::math::SoaTransform> >(
+      routputs, kNumInstances);
+
+  // Runs twice, to test cache reuse, then with a scheduler. Groups of 3
+  // instances split shared ratios in separate tasks. Prefetching is enabled
+  // from the second run, with a distance that crosses groups boundaries.
+  ReverseScheduler scheduler;
+  for (int l = 0; l < 3; ++l) {
+    if (l == 1) {
+      job.prefetch_distance = 2;
+    }
+    if (l == 2) {
+      job.scheduler = &scheduler;
+      job.grain_size = 3;
+    }
+    memset(outputs, 0xde, sizeof(outputs));
+    ASSERT_TRUE(job.Validate());
+    ASSERT_TRUE(job.Run());
+
+    // Compares with a per-instance SamplingJob.
+    for (size_t i = 0; i < kNumInstances; ++i) {
+      SamplingCache cache(5);
+      ozz::math::SoaTransform expected[2];
+      SamplingJob sjob;
+      sjob.animation = animation;
+      sjob.cache = &cache;
+      sjob.ratio = ratios[i];
+      sjob.output = expected;
+      ASSERT_TRUE(sjob.Run());
+
+      for (int j = 0; j < 2; ++j) {
+        const ozz::math::SoaTransform& e = expected[j];
+        const ozz::math::SoaTransform& o = outputs[i][j];
+        EXPECT_SOAFLOAT3_EQ_EST(
+            o.translation, ozz::math::GetX(e.translation.x),
+            ozz::math::GetY(e.translation.x), ozz::math::GetZ(e.translation.x),
+            ozz::math::GetW(e.translation.x), ozz::math::GetX(e.translation.y),
+            ozz::math::GetY(e.translation.y), ozz::math::GetZ(e.translation.y),
+            ozz::math::GetW(e.translation.y), ozz::math::GetX(e.translation.z),
+            ozz::math::GetY(e.translation.z), ozz::math::GetZ(e.translation.z),
+            ozz::math::GetW(e.translation.z));
+        EXPECT_SOAFLOAT3_EQ_EST(
+            o.scale, ozz::math::GetX(e.scale.x), ozz::math::GetY(e.scale.x),
+            ozz::math::GetZ(e.scale.x), ozz::math::GetW(e.scale.x),
+            ozz::math::GetX(e.scale.y), ozz::math::GetY(e.scale.y),
+            ozz::math::GetZ(e.scale.y), ozz::math::GetW(e.scale.y),
+            ozz::math::GetX(e.scale.z), ozz::math::GetY(e.scale.z),
+            ozz::math::GetZ(e.scale.z), ozz::math::GetW(e.scale.z));
+        EXPECT_SOAQUATERNION_EQ_EST(o.rotation, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f,
+                                    0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 1.f, 1.f,
+                                    1.f, 1.f);
+      }
+    }
+  }
+
+  EXPECT_EQ(scheduler.num_tasks, 3);
+
+  // Checks some values.
+  EXPECT_SOAFLOAT3_EQ_EST(outputs[0][0].translation, 2.f, 0.f, 0.f, 0.f, 4.f,
+                          0.f, 0.f, 0.f, 6.f, 0.f, 0.f, 0.f);
+  EXPECT_SOAFLOAT3_EQ_EST(outputs[1][0].translation, 2.f, 0.f, 0.f, 0.f, 4.f,
+                          0.f, 0.f, 0.f, 6.f, 0.f, 0.f, 0.f);
+  EXPECT_SOAFLOAT3_EQ_EST(outputs[6][1].scale, 1.5f, 1.f, 1.f, 1.f, 1.5f, 1.f,
+                          1.f, 1.f, 1.5f, 1.f, 1.f, 1.f);
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+TEST(JobValidity, GroupedSamplingJob) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(1);
+
+  AnimationBuilder builder;
+  Animation* animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+
+  SamplingCache cache0(1);
+  SamplingCache cache1(1);
+  SamplingCache zero_cache(0);
+  ozz::math::SoaTransform output0[1];
+  ozz::math::SoaTransform output1[1];
+
+  const Animation* animations[] = {animation, animation};
+  const float ratios[] = {0.f, .5f};
+  SamplingCache* caches[] = {&cache0, &cache1};
+  const ozz::Range<ozz::math::SoaTransform> outputs[] = {
+      ozz::Range<ozz::math::SoaTransform>(output0),
+      ozz::Range<ozz::math::SoaTransform>(output1)};
+  int order[2];
+
+  {  // Empty/default job, which has no instance to sample.
+    GroupedSamplingJob job;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+
+  {  // Invalid animation.
+    const Animation* null_animations[] = {animation, NULL};
+    GroupedSamplingJob job;
+    job.animations = null_animations;
+    job.ratios = ratios;
+    job.caches = caches;
+    job.outputs = outputs;
+    job.order = order;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Mismatching ranges.
+    GroupedSamplingJob job;
+    job.animations = animations;
+    job.ratios = ratios;
+    job.caches = caches;
+    job.outputs = ozz::Range<const ozz::Range<ozz::math::SoaTransform> >(
+        outputs, 1);
+    job.order = order;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Invalid order.
+    GroupedSamplingJob job;
+    job.animations = animations;
+    job.ratios = ratios;
+    job.caches = caches;
+    job.outputs = outputs;
+    job.order = ozz::Range<int>(order, 1);
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Invalid cache.
+    SamplingCache* null_caches[] = {&cache0, NULL};
+    GroupedSamplingJob job;
+    job.animations = animations;
+    job.ratios = ratios;
+    job.caches = null_caches;
+    job.outputs = outputs;
+    job.order = order;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Invalid cache size.
+    SamplingCache* small_caches[] = {&cache0, &zero_cache};
+    GroupedSamplingJob job;
+    job.animations = animations;
+    job.ratios = ratios;
+    job.caches = small_caches;
+    job.outputs = outputs;
+    job.order = order;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Invalid output.
+    const ozz::Range<ozz::math::SoaTransform> small_outputs[] = {
+        ozz::Range<ozz::math::SoaTransform>(output0),
+        ozz::Range<ozz::math::SoaTransform>(output1, static_cast<size_t>(0))};
+    GroupedSamplingJob job;
+    job.animations = animations;
+    job.ratios = ratios;
+    job.caches = caches;
+    job.outputs = small_outputs;
+    job.order = order;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Invalid grain size.
+    GroupedSamplingJob job;
+    job.animations = animations;
+    job.ratios = ratios;
+    job.caches = caches;
+    job.outputs = outputs;
+    job.order = order;
+    job.grain_size = 0;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Invalid prefetch distance.
+    GroupedSamplingJob job;
+    job.animations = animations;
+    job.ratios = ratios;
+    job.caches = caches;
+    job.outputs = outputs;
+    job.order = order;
+    job.prefetch_distance = -1;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Valid job.
+    GroupedSamplingJob job;
+    job.animations = animations;
+    job.ratios = ratios;
+    job.caches = caches;
+    job.outputs = outputs;
+    job.order = order;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+TEST(Sampling, GroupedSamplingJob) {
+  // Builds 2 animations, moving the first track in opposite directions.
+  Animation* animations[2];
+  for (int a = 0; a < 2; ++a) {
+    RawAnimation raw_animation;
+    raw_animation.duration = 1.f;
+    raw_animation.tracks.resize(5);
+    const RawAnimation::TranslationKey tkey0 = {
+        0.f, ozz::math::Float3(0.f, 2.f, 4.f)};
+    raw_animation.tracks[0].translations.push_back(tkey0);
+    const RawAnimation::TranslationKey tkey1 = {
+        1.f, a == 0 ? ozz::math::Float3(4.f, 6.f, 8.f)
+                    : ozz::math::Float3(-4.f, -6.f, -8.f)};
+    raw_animation.tracks[0].translations.push_back(tkey1);
+
+    AnimationBuilder builder;
+    animations[a] = builder(raw_animation);
+    ASSERT_TRUE(animations[a] != NULL);
+  }
+
+  // Animations are interleaved, ratios are voluntarily not sorted, and some
+  // are shared.
+  const Animation* instance_animations[] = {
+      animations[1], animations[0], animations[1], animations[0],
+      animations[0], animations[1], animations[0]};
+  const float ratios[] = {.5f, .5f, 0.f, 1.f, .5f, .5f, -1.f};
+  const size_t kNumInstances = OZZ_ARRAY_SIZE(ratios);
+
+  SamplingCache caches[kNumInstances];
+  SamplingCache* pcaches[kNumInstances];
+  ozz::math::SoaTransform outputs[kNumInstances][2];
+  ozz::Range<ozz::math::SoaTransform> routputs[kNumInstances];
+  int order[kNumInstances];
+  for (size_t i = 0; i < kNumInstances; ++i) {
+    caches[i].Resize(5);
+    pcaches[i] = &caches[i];
+    routputs[i] = outputs[i];
+  }
+
+  GroupedSamplingJob job;
+  job.animations = instance_animations;
+  job.ratios = ratios;
+  job.caches = pcaches;
+  job.outputs = ozz::Range<const ozz::Range<ozz::math::SoaTransform> >(
+      routputs, kNumInstances);
+  job.order = order;
+
+  // Runs twice, to test cache reuse, then with a scheduler. Prefetching is
+  // enabled from the second run.
+  ReverseScheduler scheduler;
+  for (int l = 0; l < 3; ++l) {
+    if (l == 1) {
+      job.prefetch_distance = 2;
+    }
+    if (l == 2) {
+      job.scheduler = &scheduler;
+      job.grain_size = 3;
+    }
+    memset(outputs, 0xde, sizeof(outputs));
+    ASSERT_TRUE(job.Validate());
+    ASSERT_TRUE(job.Run());
+
+    // Instances are sorted by animation, then ratio.
+    for (size_t i = 1; i < kNumInstances; ++i) {
+      const int p = order[i - 1];
+      const int c = order[i];
+      EXPECT_TRUE(instance_animations[p] < instance_animations[c] ||
+                  (instance_animations[p] == instance_animations[c] &&
+                   ratios[p] <= ratios[c]));
+    }
+
+    // Compares with a per-instance SamplingJob.
+    for (size_t i = 0; i < kNumInstances; ++i) {
+      SamplingCache cache(5);
+      ozz::math::SoaTransform expected[2];
+      SamplingJob sjob;
+      sjob.animation = instance_animations[i];
+      sjob.cache = &cache;
+      sjob.ratio = ratios[i];
+      sjob.output = expected;
+      ASSERT_TRUE(sjob.Run());
+
+      for (int j = 0; j < 2; ++j) {
+        const ozz::math::SoaTransform& e = expected[j];
+        const ozz::math::SoaTransform& o = outputs[i][j];
+        EXPECT_SOAFLOAT3_EQ_EST(
+            o.translation, ozz::math::GetX(e.translation.x),
+            ozz::math::GetY(e.translation.x), ozz::math::GetZ(e.translation.x),
+            ozz::math::GetW(e.translation.x), ozz::math::GetX(e.translation.y),
+            ozz::math::GetY(e.translation.y), ozz::math::GetZ(e.translation.y),
+            ozz::math::GetW(e.translation.y), ozz::math::GetX(e.translation.z),
+            ozz::math::GetY(e.translation.z), ozz::math::GetZ(e.translation.z),
+            ozz::math::GetW(e.translation.z));
+      }
+    }
+  }
+
+  EXPECT_EQ(scheduler.num_tasks, 3);
+
+  // Checks some values.
+  EXPECT_SOAFLOAT3_EQ_EST(outputs[3][0].translation, 4.f, 0.f, 0.f, 0.f, 6.f,
+                          0.f, 0.f, 0.f, 8.f, 0.f, 0.f, 0.f);
+  EXPECT_SOAFLOAT3_EQ_EST(outputs[1][0].translation, 2.f, 0.f, 0.f, 0.f, 4.f,
+                          0.f, 0.f, 0.f, 6.f, 0.f, 0.f, 0.f);
+
+  ozz::memory::default_allocator()->Delete(animations[0]);
+  ozz::memory::default_allocator()->Delete(animations[1]);
+}
+
+TEST(JobValidity, CacheWarmUpJob) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(5);
+
+  AnimationBuilder builder;
+  Animation* animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+
+  SamplingCache cache(5);
+  SamplingCache small_cache(1);
+
+  {  // Empty/default job
+    CacheWarmUpJob job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Invalid cache.
+    CacheWarmUpJob job;
+    job.animation = animation;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Invalid animation.
+    CacheWarmUpJob job;
+    job.cache = &cache;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Invalid cache size.
+    CacheWarmUpJob job;
+    job.animation = animation;
+    job.cache = &small_cache;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Source is cache.
+    CacheWarmUpJob job;
+    job.animation = animation;
+    job.cache = &cache;
+    job.source = &cache;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Valid job.
+    CacheWarmUpJob job;
+    job.animation = animation;
+    job.cache = &cache;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+
+  {  // Valid job with a source.
+    CacheWarmUpJob job;
+    job.animation = animation;
+    job.cache = &cache;
+    job.source = &small_cache;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+TEST(WarmUp, SamplingJob) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(6);
+
+  // Moves first and last tracks with many keys.
+  for (int i = 0; i <= 20; ++i) {
+    const float t = i / 20.f;
+    const RawAnimation::TranslationKey tkey = {
+        t, ozz::math::Float3(t * 10.f, t * t, -t)};
+    raw_animation.tracks[0].translations.push_back(tkey);
+    const RawAnimation::ScaleKey skey = {t,
+                                         ozz::math::Float3(1.f + t, 1.f, 2.f)};
+    raw_animation.tracks[5].scales.push_back(skey);
+  }
+
+  const SamplingCache::Mode modes[] = {SamplingCache::kFull,
+                                       SamplingCache::kCompact};
+  for (size_t m = 0; m < OZZ_ARRAY_SIZE(modes); ++m) {
+    AnimationBuilder builder;
+    Animation* animation = builder(raw_animation);
+    ASSERT_TRUE(animation != NULL);
+
+    // Samples with a cold cache as a reference.
+    const float kRatio = .63f;
+    ozz::math::SoaTransform expected[2];
+    SamplingCache cold_cache(6, modes[m]);
+    SamplingJob job;
+    job.animation = animation;
+    job.cache = &cold_cache;
+    job.ratio = kRatio;
+    job.output = expected;
+    ASSERT_TRUE(job.Run());
+
+    // Warms up a cache.
+    SamplingCache warm_cache(6, modes[m]);
+    CacheWarmUpJob warm_job;
+    warm_job.animation = animation;
+    warm_job.ratio = kRatio;
+    warm_job.cache = &warm_cache;
+    ASSERT_TRUE(warm_job.Run());
+
+    ozz::math::SoaTransform output[2];
+    memset(output, 0xde, sizeof(output));
+    job.cache = &warm_cache;
+    job.output = output;
+    ASSERT_TRUE(job.Run());
+    EXPECT_EQ(memcmp(output, expected, sizeof(output)), 0);
+
+    // Warms up a cache from a source that's behind.
+    SamplingCache source_cache(6, modes[m]);
+    job.cache = &source_cache;
+    job.ratio = .2f;
+    ASSERT_TRUE(job.Run());
+
+    SamplingCache cloned_cache(8, modes[m]);
+    warm_job.source = &source_cache;
+    warm_job.cache = &cloned_cache;
+    ASSERT_TRUE(warm_job.Run());
+
+    memset(output, 0xde, sizeof(output));
+    job.cache = &cloned_cache;
+    job.ratio = kRatio;
+    ASSERT_TRUE(job.Run());
+    EXPECT_EQ(memcmp(output, expected, sizeof(output)), 0);
+
+    // Source ahead of ratio is ignored.
+    job.cache = &source_cache;
+    job.ratio = .9f;
+    ASSERT_TRUE(job.Run());
+    ASSERT_TRUE(warm_job.Run());
+
+    memset(output, 0xde, sizeof(output));
+    job.cache = &cloned_cache;
+    job.ratio = kRatio;
+    ASSERT_TRUE(job.Run());
+    EXPECT_EQ(memcmp(output, expected, sizeof(output)), 0);
+
+    ozz::memory::default_allocator()->Delete(animation);
+  }
+}
+
+TEST(CopyFrom, SamplingCache) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(6);
+  for (int i = 0; i <= 4; ++i) {
+    const float t = i / 4.f;
+    const RawAnimation::TranslationKey tkey = {
+        t, ozz::math::Float3(t, -t, t * 2.f)};
+    raw_animation.tracks[4].translations.push_back(tkey);
+  }
+
+  AnimationBuilder builder;
+  Animation* animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+
+  SamplingCache cache(6);
+  SamplingCache invalid_cache(6);
+  SamplingCache small_cache(4);
+  SamplingCache compact_cache(6, SamplingCache::kCompact);
+
+  ozz::math::SoaTransform expected[2];
+  SamplingJob job;
+  job.animation = animation;
+  job.cache = &cache;
+  job.ratio = .4f;
+  job.output = expected;
+  ASSERT_TRUE(job.Run());
+
+  // Copies to itself.
+  EXPECT_TRUE(cache.CopyFrom(cache));
+
+  // Copies to a too small cache.
+  EXPECT_FALSE(small_cache.CopyFrom(cache));
+
+  // Copies to a cache with a different mode.
+  EXPECT_FALSE(compact_cache.CopyFrom(cache));
+
+  // Copies an invalid cache.
+  SamplingCache copy(6);
+  EXPECT_TRUE(copy.CopyFrom(invalid_cache));
+
+  // Copies a valid cache, then continues sampling forward with both.
+  EXPECT_TRUE(copy.CopyFrom(cache));
+  job.ratio = .8f;
+  ASSERT_TRUE(job.Run());
+
+  ozz::math::SoaTransform output[2];
+  memset(output, 0xde, sizeof(output));
+  job.cache = &copy;
+  job.output = output;
+  ASSERT_TRUE(job.Run());
+  EXPECT_EQ(memcmp(output, expected, sizeof(output)), 0);
+
+  // Invalidating copy doesn't affect cache.
+  EXPECT_TRUE(copy.CopyFrom(invalid_cache));
+  job.cache = &cache;
+  ASSERT_TRUE(job.Run());
+  EXPECT_EQ(memcmp(output, expected, sizeof(output)), 0);
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+TEST(SeekPoints, SamplingJob) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 2.f;
+  raw_animation.tracks.resize(9);
+
+  // Fills tracks with keys at different rates.
+  for (int i = 0; i < 9; ++i) {
+    RawAnimation::JointTrack& track = raw_animation.tracks[i];
+    const float period = .02f * (i + 1);
+    for (float t = 0.f; t <= raw_animation.duration; t += period) {
+      const float v = static_cast<float>(i) + t;
+      const RawAnimation::TranslationKey tkey = {
+          t, ozz::math::Float3(v, -v, v * 2.f)};
+      track.translations.push_back(tkey);
+      const RawAnimation::RotationKey rkey = {
+          t, ozz::math::Quaternion::FromAxisAngle(ozz::math::Float3::y_axis(),
+                                                  v)};
+      track.rotations.push_back(rkey);
+      if (i & 1) {
+        const RawAnimation::ScaleKey skey = {
+            t, ozz::math::Float3(1.f + v, 1.f, 1.f - v)};
+        track.scales.push_back(skey);
+      }
+    }
+  }
+
+  AnimationBuilder builder;
+  Animation* animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+  EXPECT_EQ(animation->num_seek_points(), 0);
+
+  builder.seek_interval = .3f;
+  Animation* seek_animation = builder(raw_animation);
+  ASSERT_TRUE(seek_animation != NULL);
+  EXPECT_EQ(seek_animation->num_seek_points(), 6);
+  EXPECT_EQ(seek_animation->seek_keys().count(),
+            static_cast<size_t>(seek_animation->num_seek_points() *
+                                seek_animation->seek_point_stride()));
+  EXPECT_GT(seek_animation->size(), animation->size());
+
+  SamplingCache cache(9);
+  SamplingCache seek_cache(9);
+  ozz::math::SoaTransform output[3];
+  ozz::math::SoaTransform seek_output[3];
+
+  SamplingJob job;
+  job.animation = animation;
+  job.cache = &cache;
+  job.output = output;
+
+  SamplingJob seek_job;
+  seek_job.animation = seek_animation;
+  seek_job.cache = &seek_cache;
+  seek_job.output = seek_output;
+
+  // Plays forward, backward, scrubs and jumps. Results must be the same.
+  const float ratios[] = {0.f,  .01f, .02f, .5f,  .49f, .1f, .11f, .9f,
+                          .95f, 1.f,  .2f,  .15f, .16f, .3f, .31f, .31f,
+                          .0f,  .99f, .4f,  .45f, .05f, 1.f, .75f};
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(ratios); ++i) {
+    job.ratio = ratios[i];
+    seek_job.ratio = ratios[i];
+    ASSERT_TRUE(job.Run());
+    ASSERT_TRUE(seek_job.Run());
+    EXPECT_EQ(memcmp(output, seek_output, sizeof(output)), 0)
+        << "Ratio " << ratios[i];
+  }
+
+  ozz::memory::default_allocator()->Delete(animation);
+  ozz::memory::default_allocator()->Delete(seek_animation);
+}
+
+TEST(RangedPrecision, SamplingJob) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(2);
+
+  // Large magnitude values, with a small range of variation. Half precision
+  // floats would only have a .5 precision at this magnitude.
+  const RawAnimation::TranslationKey tkey0 = {
+      0.f, ozz::math::Float3(1000.1f, -2000.2f, 4000.3f)};
+  raw_animation.tracks[0].translations.push_back(tkey0);
+  const RawAnimation::TranslationKey tkey1 = {
+      1.f, ozz::math::Float3(1001.f, -2001.f, 4001.f)};
+  raw_animation.tracks[0].translations.push_back(tkey1);
+
+  const RawAnimation::ScaleKey skey0 = {0.f,
+                                        ozz::math::Float3(100.01f, 1.f, 1.f)};
+  raw_animation.tracks[1].scales.push_back(skey0);
+  const RawAnimation::ScaleKey skey1 = {1.f,
+                                        ozz::math::Float3(100.02f, 1.f, 2.f)};
+  raw_animation.tracks[1].scales.push_back(skey1);
+
+  AnimationBuilder builder;
+  Animation* animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+
+  SamplingCache cache(2);
+  ozz::math::SoaTransform output[1];
+
+  SamplingJob job;
+  job.animation = animation;
+  job.cache = &cache;
+  job.output = output;
+
+  job.ratio = 0.f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_SOAFLOAT3_EQ_EST(output[0].translation, 1000.1f, 0.f, 0.f, 0.f,
+                          -2000.2f, 0.f, 0.f, 0.f, 4000.3f, 0.f, 0.f, 0.f);
+  EXPECT_SOAFLOAT3_EQ_EST(output[0].scale, 1.f, 100.01f, 1.f, 1.f, 1.f, 1.f,
+                          1.f, 1.f, 1.f, 1.f, 1.f, 1.f);
+
+  job.ratio = 1.f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_SOAFLOAT3_EQ_EST(output[0].translation, 1001.f, 0.f, 0.f, 0.f,
+                          -2001.f, 0.f, 0.f, 0.f, 4001.f, 0.f, 0.f, 0.f);
+  EXPECT_SOAFLOAT3_EQ_EST(output[0].scale, 1.f, 100.02f, 1.f, 1.f, 1.f, 1.f,
+                          1.f, 1.f, 1.f, 2.f, 1.f, 1.f);
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+TEST(QuantizedRatio, SamplingJob) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(1);
+
+  // Keys of a track whose frame doesn't fit 16 bits frame indices are stored
+  // as float key times, so none is lost.
+  const RawAnimation::TranslationKey tkey0 = {
+      0.f, ozz::math::Float3(0.f, 0.f, 0.f)};
+  raw_animation.tracks[0].translations.push_back(tkey0);
+  const RawAnimation::TranslationKey tkey1 = {
+      1e-6f, ozz::math::Float3(10.f, 0.f, 0.f)};
+  raw_animation.tracks[0].translations.push_back(tkey1);
+
+  AnimationBuilder builder;
+  {
+    Animation* animation = builder(raw_animation);
+    ASSERT_TRUE(animation != NULL);
+    EXPECT_TRUE(animation->has_key_times());
+
+    SamplingCache cache(1);
+    ozz::math::SoaTransform output[1];
+    SamplingJob job;
+    job.animation = animation;
+    job.cache = &cache;
+    job.output = output;
+    job.ratio = 1e-6f;
+    ASSERT_TRUE(job.Run());
+    EXPECT_SOAFLOAT3_EQ_EST(output[0].translation, 10.f, 0.f, 0.f, 0.f, 0.f,
+                            0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+    ozz::memory::default_allocator()->Delete(animation);
+  }
+
+  // Keys closer than a frame to the beginning and the end of the animation
+  // share their frame with the keys the builder adds there, which have the
+  // same value.
+  raw_animation.tracks[0].translations.clear();
+  const RawAnimation::TranslationKey tkey2 = {
+      1e-6f, ozz::math::Float3(0.f, 0.f, 0.f)};
+  raw_animation.tracks[0].translations.push_back(tkey2);
+  const RawAnimation::TranslationKey tkey3 = {
+      .5f, ozz::math::Float3(1.f, 0.f, 0.f)};
+  raw_animation.tracks[0].translations.push_back(tkey3);
+  const RawAnimation::TranslationKey tkey4 = {
+      1.f - 1e-6f, ozz::math::Float3(2.f, 0.f, 0.f)};
+  raw_animation.tracks[0].translations.push_back(tkey4);
+
+  Animation* animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+  EXPECT_EQ(animation->num_frames(), 65535);
+
+  SamplingCache cache(1);
+  ozz::math::SoaTransform output[1];
+
+  SamplingJob job;
+  job.animation = animation;
+  job.cache = &cache;
+  job.output = output;
+
+  job.ratio = 0.f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_SOAFLOAT3_EQ_EST(output[0].translation, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f,
+                          0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+
+  job.ratio = .25f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_SOAFLOAT3_EQ_EST(output[0].translation, .5f, 0.f, 0.f, 0.f, 0.f, 0.f,
+                          0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+
+  job.ratio = .5f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_SOAFLOAT3_EQ_EST(output[0].translation, 1.f, 0.f, 0.f, 0.f, 0.f, 0.f,
+                          0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+
+  job.ratio = .75f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_SOAFLOAT3_EQ_EST(output[0].translation, 1.5f, 0.f, 0.f, 0.f, 0.f, 0.f,
+                          0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+
+  job.ratio = 1.f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_SOAFLOAT3_EQ_EST(output[0].translation, 2.f, 0.f, 0.f, 0.f, 0.f, 0.f,
+                          0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+TEST(Mask, SamplingJob) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(5);  // 2 soa tracks.
+
+  const RawAnimation::TranslationKey tkey00 = {
+      0.f, ozz::math::Float3(0.f, 0.f, 0.f)};
+  raw_animation.tracks[0].translations.push_back(tkey00);
+  const RawAnimation::TranslationKey tkey01 = {
+      1.f, ozz::math::Float3(2.f, 0.f, 0.f)};
+  raw_animation.tracks[0].translations.push_back(tkey01);
+
+  const RawAnimation::TranslationKey tkey40 = {
+      0.f, ozz::math::Float3(0.f, 0.f, 0.f)};
+  raw_animation.tracks[4].translations.push_back(tkey40);
+  const RawAnimation::TranslationKey tkey41 = {
+      .5f, ozz::math::Float3(0.f, 4.f, 0.f)};
+  raw_animation.tracks[4].translations.push_back(tkey41);
+  const RawAnimation::TranslationKey tkey42 = {
+      1.f, ozz::math::Float3(0.f, 8.f, 0.f)};
+  raw_animation.tracks[4].translations.push_back(tkey42);
+
+  AnimationBuilder builder;
+  Animation* animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+
+  SamplingCache cache(5);
+  ozz::math::SoaTransform output[2];
+
+  {  // Mask too small.
+    SamplingJob job;
+    job.animation = animation;
+    job.cache = &cache;
+    job.output = output;
+    const uint8_t mask[1] = {1};
+    job.mask.begin = mask;
+    job.mask.end = mask;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  const uint8_t mask[1] = {1};  // Only samples first soa track.
+
+  SamplingJob job;
+  job.animation = animation;
+  job.cache = &cache;
+  job.output = output;
+  job.mask = mask;
+
+  // Masked out soa tracks output is left unchanged.
+  memset(output, 0, sizeof(output));
+  job.ratio = .25f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_SOAFLOAT3_EQ_EST(output[0].translation, .5f, 0.f, 0.f, 0.f, 0.f, 0.f,
+                          0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+  EXPECT_SOAFLOAT3_EQ(output[1].translation, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f,
+                      0.f, 0.f, 0.f, 0.f, 0.f);
+  EXPECT_SOAFLOAT3_EQ(output[1].scale, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f,
+                      0.f, 0.f, 0.f, 0.f);
+
+  // Advances with the mask, so that keys of masked out track are updated.
+  job.ratio = .75f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_SOAFLOAT3_EQ_EST(output[0].translation, 1.5f, 0.f, 0.f, 0.f, 0.f, 0.f,
+                          0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+  EXPECT_SOAFLOAT3_EQ(output[1].translation, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f,
+                      0.f, 0.f, 0.f, 0.f, 0.f);
+
+  // Unmasks all tracks, second soa track is restored.
+  const uint8_t all[1] = {0xff};
+  job.mask = all;
+  ASSERT_TRUE(job.Run());
+  EXPECT_SOAFLOAT3_EQ_EST(output[0].translation, 1.5f, 0.f, 0.f, 0.f, 0.f, 0.f,
+                          0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+  EXPECT_SOAFLOAT3_EQ_EST(output[1].translation, 0.f, 0.f, 0.f, 0.f, 6.f, 0.f,
+                          0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+  EXPECT_SOAFLOAT3_EQ_EST(output[1].scale, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f,
+                          1.f, 1.f, 1.f, 1.f, 1.f);
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+TEST(Counters, SamplingJob) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(5);  // 2 soa tracks.
+
+  const RawAnimation::TranslationKey tkey00 = {
+      0.f, ozz::math::Float3(0.f, 0.f, 0.f)};
+  raw_animation.tracks[0].translations.push_back(tkey00);
+  const RawAnimation::TranslationKey tkey01 = {
+      1.f, ozz::math::Float3(2.f, 0.f, 0.f)};
+  raw_animation.tracks[0].translations.push_back(tkey01);
+
+  const RawAnimation::TranslationKey tkey40 = {
+      0.f, ozz::math::Float3(0.f, 0.f, 0.f)};
+  raw_animation.tracks[4].translations.push_back(tkey40);
+  const RawAnimation::TranslationKey tkey41 = {
+      .5f, ozz::math::Float3(0.f, 4.f, 0.f)};
+  raw_animation.tracks[4].translations.push_back(tkey41);
+  const RawAnimation::TranslationKey tkey42 = {
+      1.f, ozz::math::Float3(0.f, 8.f, 0.f)};
+  raw_animation.tracks[4].translations.push_back(tkey42);
+
+  AnimationBuilder builder;
+  Animation* animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+
+  SamplingCache cache(5);
+  ozz::math::SoaTransform output[2];
+  SamplingCounters counters;
+  EXPECT_EQ(counters.samples, 0);
+
+  SamplingJob job;
+  job.animation = animation;
+  job.cache = &cache;
+  job.output = output;
+
+  // Nothing is counted by default.
+  ASSERT_TRUE(job.Run());
+  cache.Invalidate();
+  job.counters = &counters;
+
+  // First sample seeds the cache, and decompresses all soa entries:
+  // 6 constant and 2 * 2 animated translations, 8 constant rotations and
+  // scales.
+  ASSERT_TRUE(job.Run());
+  EXPECT_EQ(counters.samples, 1);
+  EXPECT_EQ(counters.invalidations, 1);
+  EXPECT_EQ(counters.seeks, 0);
+  EXPECT_EQ(counters.keys_scanned, 26);
+  EXPECT_EQ(counters.decompressed, 6);
+
+  // Same ratio, nothing to scan or decompress.
+  ASSERT_TRUE(job.Run());
+  EXPECT_EQ(counters.samples, 2);
+  EXPECT_EQ(counters.invalidations, 1);
+  EXPECT_EQ(counters.keys_scanned, 26);
+  EXPECT_EQ(counters.decompressed, 6);
+
+  // Crosses track 4 second key.
+  job.ratio = .75f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_EQ(counters.samples, 3);
+  EXPECT_EQ(counters.invalidations, 1);
+  EXPECT_EQ(counters.keys_scanned, 27);
+  EXPECT_EQ(counters.decompressed, 7);
+
+  // Backward, cache is invalidated. Only masked soa entries are decompressed.
+  const uint8_t mask[1] = {1};
+  job.mask = mask;
+  job.ratio = .25f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_EQ(counters.samples, 4);
+  EXPECT_EQ(counters.invalidations, 2);
+  EXPECT_EQ(counters.keys_scanned, 53);
+  EXPECT_EQ(counters.decompressed, 10);
+
+  // Aggregates.
+  SamplingCounters all[2];
+  all[0] = counters;
+  all[1] = counters;
+  all[1].seeks = 3;
+  const SamplingCounters aggregated =
+      ozz::animation::Aggregate(ozz::Range<const SamplingCounters>(all));
+  EXPECT_EQ(aggregated.samples, 8);
+  EXPECT_EQ(aggregated.keys_scanned, 106);
+  EXPECT_EQ(aggregated.decompressed, 20);
+  EXPECT_EQ(aggregated.invalidations, 4);
+  EXPECT_EQ(aggregated.seeks, 3);
+
+  counters.Reset();
+  EXPECT_EQ(counters.samples, 0);
+  EXPECT_EQ(counters.keys_scanned, 0);
+  EXPECT_EQ(counters.decompressed, 0);
+  EXPECT_EQ(counters.invalidations, 0);
+  EXPECT_EQ(counters.seeks, 0);
+
+  {  // Batch per-instance counters.
+    SamplingCache caches[3];
+    SamplingCache* cache_ptrs[3] = {&caches[0], &caches[1], &caches[2]};
+    for (int i = 0; i < 3; ++i) {
+      caches[i].Resize(5);
+    }
+    ozz::math::SoaTransform outputs[3][2];
+    const ozz::Range<ozz::math::SoaTransform> output_ranges[3] = {
+        outputs[0], outputs[1], outputs[2]};
+    const float ratios[3] = {.1f, .1f, .75f};
+    SamplingCounters instance_counters[3];
+
+    BatchSamplingJob batch;
+    batch.animation = animation;
+    batch.ratios = ratios;
+    batch.caches = cache_ptrs;
+    batch.outputs = output_ranges;
+    batch.counters =
+        ozz::Range<SamplingCounters>(instance_counters, instance_counters + 2);
+    EXPECT_FALSE(batch.Validate());
+    batch.counters = instance_counters;
+    ASSERT_TRUE(batch.Run());
+
+    // Second instance shares first one output.
+    EXPECT_EQ(instance_counters[0].samples, 1);
+    EXPECT_EQ(instance_counters[1].samples, 0);
+    EXPECT_EQ(instance_counters[2].samples, 1);
+    EXPECT_EQ(instance_counters[0].keys_scanned, 26);
+    EXPECT_EQ(instance_counters[2].keys_scanned, 27);
+  }
+
+  {  // Warm up.
+    CacheWarmUpJob warm_up;
+    warm_up.animation = animation;
+    warm_up.cache = &cache;
+    warm_up.counters = &counters;
+    warm_up.ratio = 0.f;
+    ASSERT_TRUE(warm_up.Run());
+    EXPECT_EQ(counters.samples, 1);
+    EXPECT_EQ(counters.invalidations, 1);
+    EXPECT_EQ(counters.keys_scanned, 26);
+    EXPECT_EQ(counters.decompressed, 6);
+  }
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+TEST(Loop, SamplingJob) {
+  // Track 0 only has a first and a last key, track 4 has 3 keys. Other tracks
+  // are constant.
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(5);  // 2 soa tracks.
+  const RawAnimation::TranslationKey t00 = {0.f,
+                                            ozz::math::Float3(0.f, 0.f, 0.f)};
+  raw_animation.tracks[0].translations.push_back(t00);
+  const RawAnimation::TranslationKey t01 = {1.f,
+                                            ozz::math::Float3(2.f, 0.f, 0.f)};
+  raw_animation.tracks[0].translations.push_back(t01);
+  for (int i = 0; i < 3; ++i) {
+    const RawAnimation::TranslationKey key = {
+        i * .5f, ozz::math::Float3(0.f, i * 4.f, i * 1.f)};
+    raw_animation.tracks[4].translations.push_back(key);
+  }
+
+  for (int spline = 0; spline < 2; ++spline) {
+    AnimationBuilder builder;
+    builder.spline = spline != 0;
+    builder.seek_interval = .25f;
+    Animation* animation = builder(raw_animation);
+    ASSERT_TRUE(animation != NULL);
+
+    const SamplingCache::Mode modes[] = {
+        spline ? SamplingCache::kSpline : SamplingCache::kFull,
+        SamplingCache::kCompact};
+    for (int m = 0; m < (spline ? 1 : 2); ++m) {
+      SamplingCache cache(5, modes[m]);
+      SamplingCache reference_cache(5, modes[m]);
+      ozz::math::SoaTransform output[2];
+      ozz::math::SoaTransform expected[2];
+
+      SamplingJob job;
+      job.animation = animation;
+      job.cache = &cache;
+      job.output = output;
+      job.loop = true;
+
+      SamplingJob reference;
+      reference.animation = animation;
+      reference.cache = &reference_cache;
+      reference.output = expected;
+
+      // Plays a few cycles, including wraps landing after seek points. Output
+      // must match a cache sampled from scratch.
+      const float ratios[] = {0.f, .3f, .6f, .9f, .2f, .7f, 1.f,
+                              .1f, .55f, .05f, 0.f, .8f, .6f};
+      for (size_t r = 0; r < OZZ_ARRAY_SIZE(ratios); ++r) {
+        job.ratio = ratios[r];
+        ASSERT_TRUE(job.Run());
+        reference_cache.Invalidate();
+        reference.ratio = ratios[r];
+        ASSERT_TRUE(reference.Run());
+        EXPECT_EQ(std::memcmp(output, expected, sizeof(output)), 0)
+            << "ratio " << ratios[r] << ", mode " << modes[m];
+      }
+    }
+    ozz::memory::default_allocator()->Delete(animation);
+  }
+
+  {  // Counters.
+    AnimationBuilder builder;
+    Animation* animation = builder(raw_animation);
+    ASSERT_TRUE(animation != NULL);
+
+    SamplingCache cache(5);
+    ozz::math::SoaTransform output[2];
+    SamplingCounters counters;
+
+    SamplingJob job;
+    job.animation = animation;
+    job.cache = &cache;
+    job.output = output;
+    job.counters = &counters;
+    job.loop = true;
+    job.ratio = .75f;
+    ASSERT_TRUE(job.Run());
+    EXPECT_EQ(counters.invalidations, 1);
+    EXPECT_EQ(counters.wraps, 0);
+    EXPECT_EQ(counters.decompressed, 6);
+
+    // Wraps: only track 4 translations keys changed.
+    job.ratio = .25f;
+    ASSERT_TRUE(job.Run());
+    EXPECT_EQ(counters.invalidations, 1);
+    EXPECT_EQ(counters.wraps, 1);
+    EXPECT_EQ(counters.decompressed, 7);
+
+    // Without loop mode, the cache is invalidated.
+    job.loop = false;
+    job.ratio = .75f;
+    ASSERT_TRUE(job.Run());
+    job.ratio = .25f;
+    ASSERT_TRUE(job.Run());
+    EXPECT_EQ(counters.invalidations, 2);
+    EXPECT_EQ(counters.wraps, 1);
+    EXPECT_EQ(counters.decompressed, 14);
+
+    // An animation change still invalidates in loop mode.
+    Animation* other = builder(raw_animation);
+    ASSERT_TRUE(other != NULL);
+    job.loop = true;
+    job.animation = other;
+    job.ratio = .1f;
+    ASSERT_TRUE(job.Run());
+    EXPECT_EQ(counters.invalidations, 3);
+    EXPECT_EQ(counters.wraps, 1);
+
+    ozz::memory::default_allocator()->Delete(other);
+    ozz::memory::default_allocator()->Delete(animation);
+  }
+}
+
+namespace {
+// Samples _animation at _ratio from scratch, with a cache of _mode.
+void SampleFromScratch(const Animation& _animation, SamplingCache::Mode _mode,
+                       float _ratio, ozz::math::SoaTransform* _output) {
+  SamplingCache cache(_animation.num_tracks(), _mode);
+  SamplingJob job;
+  job.animation = &_animation;
+  job.cache = &cache;
+  job.quality = SamplingJob::kAccurate;
+  job.ratio = _ratio;
+  job.output = ozz::Range<ozz::math::SoaTransform>(_output, 1);
+  ASSERT_TRUE(job.Run());
+}
+}  // namespace
+
+TEST(Velocities, SamplingJob) {
+  // Track 0 translates, then stops. Track 1 rotates 90 degrees around z. Other
+  // tracks are constant.
+  RawAnimation raw_animation;
+  raw_animation.duration = 2.f;
+  raw_animation.tracks.resize(4);
+  const RawAnimation::TranslationKey t0 = {0.f,
+                                           ozz::math::Float3(0.f, 0.f, 0.f)};
+  const RawAnimation::TranslationKey t1 = {1.f,
+                                           ozz::math::Float3(2.f, 4.f, 0.f)};
+  const RawAnimation::TranslationKey t2 = {2.f,
+                                           ozz::math::Float3(2.f, 4.f, 0.f)};
+  raw_animation.tracks[0].translations.push_back(t0);
+  raw_animation.tracks[0].translations.push_back(t1);
+  raw_animation.tracks[0].translations.push_back(t2);
+  const RawAnimation::RotationKey r0 = {0.f,
+                                        ozz::math::Quaternion::identity()};
+  const RawAnimation::RotationKey r1 = {
+      2.f, ozz::math::Quaternion::FromAxisAngle(ozz::math::Float3::z_axis(),
+                                                ozz::math::kPi_2)};
+  raw_animation.tracks[1].rotations.push_back(r0);
+  raw_animation.tracks[1].rotations.push_back(r1);
+
+  {  // Validation.
+    AnimationBuilder builder;
+    Animation* animation = builder(raw_animation);
+    ASSERT_TRUE(animation != NULL);
+    SamplingCache cache(4);
+    ozz::math::SoaTransform output[1];
+    ozz::math::SoaFloat3 velocities[1];
+    SamplingJob job;
+    job.animation = animation;
+    job.cache = &cache;
+    job.output = output;
+    job.linear_velocities = velocities;
+    EXPECT_TRUE(job.Validate());
+    job.angular_velocities =
+        ozz::Range<ozz::math::SoaFloat3>(velocities, velocities);
+    EXPECT_FALSE(job.Validate());
+    ozz::memory::default_allocator()->Delete(animation);
+  }
+
+  for (int spline = 0; spline < 2; ++spline) {
+    AnimationBuilder builder;
+    builder.spline = spline != 0;
+    Animation* animation = builder(raw_animation);
+    ASSERT_TRUE(animation != NULL);
+
+    const SamplingCache::Mode modes[] = {
+        spline ? SamplingCache::kSpline : SamplingCache::kFull,
+        SamplingCache::kCompact};
+    for (int m = 0; m < (spline ? 1 : 2); ++m) {
+      SamplingCache cache(4, modes[m]);
+      ozz::math::SoaTransform output[1];
+      ozz::math::SoaFloat3 linear[1];
+      ozz::math::SoaFloat3 angular[1];
+      SamplingJob job;
+      job.animation = animation;
+      job.cache = &cache;
+      job.quality = SamplingJob::kAccurate;
+      job.output = output;
+      job.linear_velocities = linear;
+      job.angular_velocities = angular;
+
+      // Velocities match central finite differences of sampled poses.
+      const float ratios[] = {.1f, .3f, .6f, .85f};
+      for (size_t r = 0; r < OZZ_ARRAY_SIZE(ratios); ++r) {
+        job.ratio = ratios[r];
+        ASSERT_TRUE(job.Run());
+
+        const float h = 1e-3f;  // In seconds.
+        ozz::math::SoaTransform before[1], after[1];
+        SampleFromScratch(*animation, modes[m], ratios[r] - h / 2.f, before);
+        SampleFromScratch(*animation, modes[m], ratios[r] + h / 2.f, after);
+        const ozz::math::SimdFloat4 inv_2h =
+            ozz::math::simd_float4::Load1(1.f / (2.f * h));
+        const ozz::math::SoaFloat3 expected_linear =
+            (after[0].translation - before[0].translation) * inv_2h;
+        const ozz::math::SoaQuaternion& q = output[0].rotation;
+        const ozz::math::SoaQuaternion dq = {
+            (after[0].rotation.x - before[0].rotation.x) * inv_2h,
+            (after[0].rotation.y - before[0].rotation.y) * inv_2h,
+            (after[0].rotation.z - before[0].rotation.z) * inv_2h,
+            (after[0].rotation.w - before[0].rotation.w) * inv_2h};
+        const ozz::math::SoaQuaternion w = dq * Conjugate(q);
+        const ozz::math::SimdFloat4 two = ozz::math::simd_float4::Load1(2.f);
+        const ozz::math::SoaFloat3 expected_angular = {w.x * two, w.y * two,
+                                                       w.z * two};
+
+        const ozz::math::SoaFloat3* values[2] = {linear, angular};
+        const ozz::math::SoaFloat3* expected[2] = {&expected_linear,
+                                                   &expected_angular};
+        for (int v = 0; v < 2; ++v) {
+          float actual_f[3][4], expected_f[3][4];
+          const ozz::math::SimdFloat4* a = &values[v]->x;
+          const ozz::math::SimdFloat4* e = &expected[v]->x;
+          for (int c = 0; c < 3; ++c) {
+            ozz::math::StorePtrU(a[c], actual_f[c]);
+            ozz::math::StorePtrU(e[c], expected_f[c]);
+            for (int l = 0; l < 4; ++l) {
+              EXPECT_NEAR(actual_f[c][l], expected_f[c][l], 2e-2f)
+                  << "ratio " << ratios[r] << ", mode " << modes[m]
+                  << ", velocity " << v << ", component " << c << ", lane "
+                  << l;
+            }
+          }
+        }
+      }
+    }
+    ozz::memory::default_allocator()->Delete(animation);
+  }
+
+  {  // Analytic linear values.
+    AnimationBuilder builder;
+    Animation* animation = builder(raw_animation);
+    ASSERT_TRUE(animation != NULL);
+    SamplingCache cache(4);
+    ozz::math::SoaTransform output[1];
+    ozz::math::SoaFloat3 linear[1];
+    ozz::math::SoaFloat3 angular[1];
+    SamplingJob job;
+    job.animation = animation;
+    job.cache = &cache;
+    job.output = output;
+    job.linear_velocities = linear;
+    job.angular_velocities = angular;
+
+    job.ratio = .25f;
+    ASSERT_TRUE(job.Run());
+    EXPECT_SOAFLOAT3_EQ_EST(linear[0], 2.f, 0.f, 0.f, 0.f, 4.f, 0.f, 0.f, 0.f,
+                            0.f, 0.f, 0.f, 0.f);
+
+    // Nlerp angular velocity is the fastest half way, where it's
+    // 2 * tan(pi / 8) radian per second, instead of slerp constant pi / 4.
+    job.ratio = .5f;
+    ASSERT_TRUE(job.Run());
+    EXPECT_SOAFLOAT3_EQ_EST(angular[0], 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f,
+                            0.f, .8284271f, 0.f, 0.f);
+
+    job.ratio = .75f;
+    ASSERT_TRUE(job.Run());
+    EXPECT_SOAFLOAT3_EQ_EST(linear[0], 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f,
+                            0.f, 0.f, 0.f, 0.f);
+    ozz::memory::default_allocator()->Delete(animation);
+  }
+}
+
+namespace {
+// Counts output tracks whose translation and rotation don't match the ones
+// built by MaxTracks test, at _ratio. Only soa tracks in [_begin,_end[ are
+// tested.
+int CountMaxTracksErrors(const ozz::math::SoaTransform* _output, int _begin,
+                         int _end, float _ratio) {
+  int errors = 0;
+  for (int i = _begin; i < _end; ++i) {
+    float tx[4], ty[4], tz[4], ry[4];
+    ozz::math::StorePtrU(_output[i].translation.x, tx);
+    ozz::math::StorePtrU(_output[i].translation.y, ty);
+    ozz::math::StorePtrU(_output[i].translation.z, tz);
+    ozz::math::StorePtrU(_output[i].rotation.y, ry);
+    for (int j = 0; j < 4; ++j) {
+      const int track = i * 4 + j;
+      // Rotations are normalized-lerped from identity to 90 degrees.
+      const float k = .70710677f * _ratio;
+      const float w = 1.f - _ratio + k;
+      const float expected_ry =
+          (track & 1) ? k / std::sqrt(w * w + k * k) : 0.f;
+      errors += tx[j] != static_cast<float>(track % 16) ||
+                ty[j] != static_cast<float>(track / 1024) ||
+                std::abs(tz[j] - _ratio) > 1e-3f ||
+                std::abs(ry[j] - expected_ry) > 2e-3f;
+    }
+  }
+  return errors;
+}
+}  // namespace
+
+TEST(MaxTracks, SamplingJob) {
+  // Every track of an animation with the maximum number of tracks gets its own
+  // keys, so that key track indices and cache outdated flags are tested at
+  // scale.
+  const int kNumTracks = ozz::animation::Skeleton::kMaxJoints;
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(kNumTracks);
+  for (int i = 0; i < kNumTracks; ++i) {
+    RawAnimation::JointTrack& track = raw_animation.tracks[i];
+    const float x = static_cast<float>(i % 16);
+    const float y = static_cast<float>(i / 1024);
+    const RawAnimation::TranslationKey tkey0 = {0.f,
+                                                ozz::math::Float3(x, y, 0.f)};
+    track.translations.push_back(tkey0);
+    const RawAnimation::TranslationKey tkey1 = {1.f,
+                                                ozz::math::Float3(x, y, 1.f)};
+    track.translations.push_back(tkey1);
+    if (i & 1) {  // Odd tracks rotate by 90 degrees around y.
+      const RawAnimation::RotationKey rkey0 = {
+          0.f, ozz::math::Quaternion::identity()};
+      track.rotations.push_back(rkey0);
+      const RawAnimation::RotationKey rkey1 = {
+          1.f, ozz::math::Quaternion::FromAxisAngle(ozz::math::Float3::y_axis(),
+                                                    ozz::math::kPi_2)};
+      track.rotations.push_back(rkey1);
+    }
+  }
+
+  AnimationBuilder builder;
+  Animation* animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+  const int num_soa_tracks = animation->num_soa_tracks();
+  ozz::Vector<ozz::math::SoaTransform>::Std output(num_soa_tracks);
+
+  const SamplingCache::Mode modes[] = {SamplingCache::kFull,
+                                       SamplingCache::kCompact};
+  for (size_t m = 0; m < OZZ_ARRAY_SIZE(modes); ++m) {
+    SamplingCache cache(kNumTracks, modes[m]);
+    SamplingJob job;
+    job.animation = animation;
+    job.cache = &cache;
+    job.output = make_range(output);
+
+    // Forward, then backward which invalidates the cache.
+    const float ratios[] = {.5f, 1.f, .25f, 0.f};
+    for (size_t r = 0; r < OZZ_ARRAY_SIZE(ratios); ++r) {
+      job.ratio = ratios[r];
+      ASSERT_TRUE(job.Run());
+      EXPECT_EQ(CountMaxTracksErrors(array_begin(output), 0, num_soa_tracks,
+                                     job.ratio),
+                0);
+    }
+  }
+
+  {  // Only samples the last soa track.
+    ozz::Vector<uint8_t>::Std mask((num_soa_tracks + 7) / 8, 0);
+    mask.back() = 1 << ((num_soa_tracks - 1) % 8);
+    memset(array_begin(output), 0,
+           output.size() * sizeof(ozz::math::SoaTransform));
+
+    SamplingCache cache(kNumTracks);
+    SamplingJob job;
+    job.animation = animation;
+    job.cache = &cache;
+    job.output = make_range(output);
+    job.mask = make_range(mask);
+    job.ratio = .5f;
+    ASSERT_TRUE(job.Run());
+    EXPECT_EQ(CountMaxTracksErrors(array_begin(output), num_soa_tracks - 1,
+                                   num_soa_tracks, .5f),
+              0);
+    EXPECT_SOAFLOAT3_EQ(output[0].translation, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f,
+                        0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+  }
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+TEST(Compact, SamplingJob) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 2.f;
+  raw_animation.tracks.resize(7);
+
+  // Fills some tracks with animated and constant keys.
+  for (int i = 0; i < 6; ++i) {
+    RawAnimation::JointTrack& track = raw_animation.tracks[i];
+    for (int k = 0; k < 2 + i; ++k) {
+      const float f = static_cast<float>(k + i);
+      const float time = raw_animation.duration * k / (1 + i);
+      const RawAnimation::TranslationKey tkey = {
+          time, ozz::math::Float3(f, -f * 2.f, 100.f + f)};
+      track.translations.push_back(tkey);
+      const RawAnimation::RotationKey rkey = {
+          time,
+          ozz::math::Quaternion::FromAxisAngle(ozz::math::Float3::y_axis(),
+                                               f * .7f)};
+      track.rotations.push_back(rkey);
+      if (i & 1) {  // Constant scales for even tracks.
+        const RawAnimation::ScaleKey skey = {time,
+                                             ozz::math::Float3(1.f, f, 2.f)};
+        track.scales.push_back(skey);
+      }
+    }
+  }
+
+  AnimationBuilder builder;
+  builder.seek_interval = .5f;
+  Animation* animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+
+  SamplingCache full_cache(7);
+  EXPECT_FALSE(full_cache.compact());
+  SamplingCache compact_cache(7, SamplingCache::kCompact);
+  EXPECT_TRUE(compact_cache.compact());
+  EXPECT_EQ(compact_cache.max_tracks(), 8);
+
+  ozz::math::SoaTransform full_output[2];
+  ozz::math::SoaTransform compact_output[2];
+
+  SamplingJob full_job;
+  full_job.animation = animation;
+  full_job.cache = &full_cache;
+  full_job.output = full_output;
+
+  SamplingJob compact_job;
+  compact_job.animation = animation;
+  compact_job.cache = &compact_cache;
+  compact_job.output = compact_output;
+
+  // Samples forward, backward and jumps.
+  const float ratios[] = {0.f,  .1f,  .2f, .21f, .6f, .35f, .9f,
+                          .99f, 1.f, .05f, .75f, .5f, 0.f};
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(ratios); ++i) {
+    full_job.ratio = ratios[i];
+    ASSERT_TRUE(full_job.Run());
+    compact_job.ratio = ratios[i];
+    ASSERT_TRUE(compact_job.Run());
+
+    // Compares all soa components (10 SimdFloat4 per SoaTransform). Both modes
+    // use estimated reciprocals of different values, hence the tolerance.
+    const float* full = reinterpret_cast<const float*>(full_output);
+    const float* compact = reinterpret_cast<const float*>(compact_output);
+    const size_t count = OZZ_ARRAY_SIZE(full_output) * 10 * 4;
+    for (size_t c = 0; c < count; ++c) {
+      EXPECT_NEAR(full[c], compact[c], 2e-3f) << "ratio " << ratios[i];
+    }
+  }
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+TEST(Spline, SamplingJob) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(5);
+
+  // A sinusoide, sampled every quarter.
+  const float values[] = {0.f, 1.f, 0.f, -1.f, 0.f};
+  for (int i = 0; i < 5; ++i) {
+    const RawAnimation::TranslationKey key = {
+        i * .25f, ozz::math::Float3(values[i], 0.f, 0.f)};
+    raw_animation.tracks[4].translations.push_back(key);
+  }
+
+  AnimationBuilder builder;
+  Animation* linear = builder(raw_animation);
+  ASSERT_TRUE(linear != NULL);
+  EXPECT_FALSE(linear->spline());
+  EXPECT_TRUE(linear->translation_tangents().begin == NULL);
+
+  builder.spline = true;
+  Animation* spline = builder(raw_animation);
+  ASSERT_TRUE(spline != NULL);
+  EXPECT_TRUE(spline->spline());
+  EXPECT_TRUE(spline->translation_tangents().begin != NULL);
+
+  SamplingCache full_cache(5);
+  SamplingCache compact_cache(5, SamplingCache::kCompact);
+  SamplingCache spline_cache(5, SamplingCache::kSpline);
+  EXPECT_EQ(spline_cache.mode(), SamplingCache::kSpline);
+  EXPECT_FALSE(spline_cache.compact());
+
+  ozz::math::SoaTransform output[2];
+  SamplingJob job;
+  job.output = output;
+
+  // Only spline caches can sample spline animations.
+  job.animation = spline;
+  job.cache = &full_cache;
+  EXPECT_FALSE(job.Validate());
+  job.cache = &compact_cache;
+  EXPECT_FALSE(job.Validate());
+  job.cache = &spline_cache;
+  EXPECT_TRUE(job.Validate());
+
+  // Spline caches can sample linear animations.
+  job.animation = linear;
+  job.ratio = .125f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_SOAFLOAT3_EQ_EST(output[1].translation, .5f, 0.f, 0.f, 0.f, 0.f, 0.f,
+                          0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+
+  // Tangents are 4 at the first key, 0 at the second one.
+  job.animation = spline;
+  const struct {
+    float ratio;
+    float value;
+  } expected[] = {{0.f, 0.f},    {.125f, .625f}, {.25f, 1.f},  {.375f, .625f},
+                  {.5f, 0.f},    {.625f, -.625f}, {.75f, -1.f}, {.875f, -.625f},
+                  {1.f, 0.f}};
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(expected); ++i) {
+    job.ratio = expected[i].ratio;
+    ASSERT_TRUE(job.Run());
+    EXPECT_NEAR(ozz::math::GetX(output[1].translation.x), expected[i].value,
+                2e-3f)
+        << " ratio " << expected[i].ratio;
+    EXPECT_SOAQUATERNION_EQ_EST(output[1].rotation, 0.f, 0.f, 0.f, 0.f, 0.f,
+                                0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 1.f, 1.f,
+                                1.f, 1.f);
+    EXPECT_SOAFLOAT3_EQ_EST(output[1].scale, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f,
+                            1.f, 1.f, 1.f, 1.f, 1.f);
+  }
+
+  ozz::memory::default_allocator()->Delete(linear);
+  ozz::memory::default_allocator()->Delete(spline);
+}
+
+TEST(Quality, SamplingJob) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(8);  // 2 soa tracks.
+
+  // Rotates by 90 degrees around x.
+  for (int i = 0; i < 8; ++i) {
+    const RawAnimation::RotationKey key0 = {0.f,
+                                            ozz::math::Quaternion::identity()};
+    raw_animation.tracks[i].rotations.push_back(key0);
+    const RawAnimation::RotationKey key1 = {
+        1.f, ozz::math::Quaternion(.70710677f, 0.f, 0.f, .70710677f)};
+    raw_animation.tracks[i].rotations.push_back(key1);
+  }
+
+  AnimationBuilder builder;
+  Animation* animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+
+  SamplingCache cache(8);
+  ozz::math::SoaTransform output[2];
+
+  SamplingJob job;
+  job.animation = animation;
+  job.cache = &cache;
+  job.output = output;
+  job.ratio = .5f;
+  EXPECT_EQ(job.quality, SamplingJob::kStandard);
+
+  const SamplingJob::Quality qualities[] = {
+      SamplingJob::kFast, SamplingJob::kStandard, SamplingJob::kAccurate};
+  for (size_t q = 0; q < OZZ_ARRAY_SIZE(qualities); ++q) {
+    job.quality = qualities[q];
+    ASSERT_TRUE(job.Run());
+    for (int i = 0; i < 2; ++i) {
+      EXPECT_SOAQUATERNION_EQ_EST(output[i].rotation, .3826834f, .3826834f,
+                                  .3826834f, .3826834f, 0.f, 0.f, 0.f, 0.f,
+                                  0.f, 0.f, 0.f, 0.f, .9238795f, .9238795f,
+                                  .9238795f, .9238795f);
+    }
+  }
+
+  // Accurate quality rotations are normalized with full precision.
+  for (int i = 0; i < 2; ++i) {
+    EXPECT_TRUE(ozz::math::AreAllTrue(IsNormalized(output[i].rotation)));
+  }
+
+  // Batch sampling quality is standard by default.
+  BatchSamplingJob batch_job;
+  EXPECT_EQ(batch_job.quality, SamplingJob::kStandard);
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+TEST(Incremental, SamplingJob) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(5);
+
+  // First soa track moves until .5, then stays still. Second one is constant.
+  const RawAnimation::TranslationKey tkeys[] = {
+      {0.f, ozz::math::Float3(0.f, 0.f, 0.f)},
+      {.5f, ozz::math::Float3(1.f, 0.f, 0.f)},
+      {1.f, ozz::math::Float3(1.f, 0.f, 0.f)}};
+  raw_animation.tracks[0].translations.assign(tkeys, tkeys + 3);
+  const RawAnimation::TranslationKey ckey = {
+      0.f, ozz::math::Float3(0.f, 2.f, 0.f)};
+  raw_animation.tracks[4].translations.push_back(ckey);
+
+  AnimationBuilder builder;
+  Animation* animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+
+  const SamplingCache::Mode modes[] = {SamplingCache::kFull,
+                                       SamplingCache::kCompact,
+                                       SamplingCache::kSpline};
+  for (size_t m = 0; m < OZZ_ARRAY_SIZE(modes); ++m) {
+    SamplingCache cache(5, modes[m]);
+    ozz::math::SoaTransform output[2];
+    uint8_t changed[1] = {0xff};
+
+    SamplingJob job;
+    job.animation = animation;
+    job.cache = &cache;
+    job.output = output;
+    job.changed = changed;
+
+    {  // Changed buffer too small.
+      SamplingJob invalid = job;
+      invalid.changed.end = changed;
+      EXPECT_FALSE(invalid.Validate());
+    }
+
+    // Everything changes on the first run.
+    job.ratio = 0.f;
+    ASSERT_TRUE(job.Run());
+    EXPECT_EQ(changed[0], 3);
+    EXPECT_SOAFLOAT3_EQ_EST(output[1].translation, 0.f, 0.f, 0.f, 0.f, 2.f, 0.f,
+                            0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+
+    // Constant soa track isn't sampled again.
+    job.ratio = .2f;
+    ASSERT_TRUE(job.Run());
+    EXPECT_EQ(changed[0], 1);
+    EXPECT_SOAFLOAT3_EQ_EST(output[0].translation, .4f, 0.f, 0.f, 0.f, 0.f,
+                            0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+    EXPECT_SOAFLOAT3_EQ_EST(output[1].translation, 0.f, 0.f, 0.f, 0.f, 2.f, 0.f,
+                            0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+
+    // First soa track reaches its last interval.
+    job.ratio = .6f;
+    ASSERT_TRUE(job.Run());
+    EXPECT_EQ(changed[0], 1);
+    EXPECT_SOAFLOAT3_EQ_EST(output[0].translation, 1.f, 0.f, 0.f, 0.f, 0.f,
+                            0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+
+    // Nothing changes anymore, output is left untouched.
+    output[0].translation.x = ozz::math::simd_float4::Load1(46.f);
+    job.ratio = .8f;
+    ASSERT_TRUE(job.Run());
+    EXPECT_EQ(changed[0], 0);
+    EXPECT_SOAFLOAT1_EQ(output[0].translation.x, 46.f, 46.f, 46.f, 46.f);
+
+    // A non incremental run resets steady tracks, as output can be any
+    // buffer.
+    job.changed = ozz::Range<uint8_t>();
+    job.ratio = .85f;
+    ASSERT_TRUE(job.Run());
+    EXPECT_SOAFLOAT1_EQ(output[0].translation.x, 1.f, 0.f, 0.f, 0.f);
+    job.changed = changed;
+    job.ratio = .9f;
+    ASSERT_TRUE(job.Run());
+    EXPECT_EQ(changed[0], 3);
+
+    // Masked out soa tracks aren't reported as changed.
+    const uint8_t mask[1] = {2};
+    job.mask = mask;
+    cache.Invalidate();
+    job.ratio = 0.f;
+    ASSERT_TRUE(job.Run());
+    EXPECT_EQ(changed[0], 2);
+    job.mask = ozz::Range<const uint8_t>();
+  }
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+TEST(HalfOutput, SamplingJob) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(13);
+
+  // Fills tracks with animated keys, so that the 8 wide kernel path is used.
+  for (int i = 0; i < 13; ++i) {
+    RawAnimation::JointTrack& track = raw_animation.tracks[i];
+    for (int k = 0; k < 2 + i % 3; ++k) {
+      const float f = static_cast<float>(k + i);
+      const float time = k / (1.f + i % 3);
+      const RawAnimation::TranslationKey tkey = {
+          time, ozz::math::Float3(f * .1f, -f * .2f, 10.f + f)};
+      track.translations.push_back(tkey);
+      const RawAnimation::RotationKey rkey = {
+          time,
+          ozz::math::Quaternion::FromAxisAngle(ozz::math::Float3::x_axis(),
+                                               f * .3f)};
+      track.rotations.push_back(rkey);
+      const RawAnimation::ScaleKey skey = {
+          time, ozz::math::Float3(1.f, 1.f + f * .1f, 2.f)};
+      track.scales.push_back(skey);
+    }
+  }
+
+  AnimationBuilder builder;
+  Animation* linear = builder(raw_animation);
+  ASSERT_TRUE(linear != NULL);
+  builder.spline = true;
+  Animation* spline = builder(raw_animation);
+  ASSERT_TRUE(spline != NULL);
+
+  {  // Validation.
+    SamplingCache cache(13);
+    ozz::math::SoaTransform output[4];
+    ozz::math::SoaHalfTransform half_output[4];
+    SamplingJob job;
+    job.animation = linear;
+    job.cache = &cache;
+    job.half_output = half_output;
+    EXPECT_TRUE(job.Validate());
+
+    // Both outputs can't be specified.
+    job.output = output;
+    EXPECT_FALSE(job.Validate());
+    job.output = ozz::Range<ozz::math::SoaTransform>();
+
+    // Half output too small.
+    job.half_output.end = half_output + 3;
+    EXPECT_FALSE(job.Validate());
+  }
+
+  const SamplingCache::Mode modes[] = {SamplingCache::kFull,
+                                       SamplingCache::kCompact,
+                                       SamplingCache::kSpline};
+  for (size_t m = 0; m < OZZ_ARRAY_SIZE(modes); ++m) {
+    SamplingCache cache(13, modes[m]);
+    SamplingCache half_cache(13, modes[m]);
+    ozz::math::SoaTransform output[4];
+    ozz::math::SoaHalfTransform half_output[4];
+
+    SamplingJob job;
+    job.animation = modes[m] == SamplingCache::kSpline ? spline : linear;
+    job.cache = &cache;
+    job.output = output;
+
+    SamplingJob half_job = job;
+    half_job.cache = &half_cache;
+    half_job.output = ozz::Range<ozz::math::SoaTransform>();
+    half_job.half_output = half_output;
+
+    // Masked out soa tracks are left unchanged.
+    const uint8_t mask[1] = {0xd};
+    half_job.mask = mask;
+    half_output[1] =
+        ozz::math::PackHalf(ozz::math::SoaTransform::identity());
+
+    const float ratios[] = {0.f, .1f, .33f, .5f, .7f, 1.f};
+    for (size_t r = 0; r < OZZ_ARRAY_SIZE(ratios); ++r) {
+      job.ratio = ratios[r];
+      ASSERT_TRUE(job.Run());
+      half_job.ratio = ratios[r];
+      ASSERT_TRUE(half_job.Run());
+
+      // Half output is the full precision one, converted to half.
+      for (int i = 0; i < 4; ++i) {
+        if (i == 1) {
+          continue;
+        }
+        const ozz::math::SoaTransform half =
+            ozz::math::UnpackHalf(half_output[i]);
+        const float* expected = reinterpret_cast<const float*>(&output[i]);
+        const float* actual = reinterpret_cast<const float*>(&half);
+        for (int c = 0; c < 10 * 4; ++c) {
+          EXPECT_NEAR(actual[c], expected[c],
+                      std::fabs(expected[c]) * 1e-3f + 1e-4f)
+              << "mode " << m << " ratio " << ratios[r];
+        }
+      }
+      EXPECT_SOAFLOAT3_EQ(ozz::math::UnpackHalf(half_output[1]).translation,
+                          0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f,
+                          0.f, 0.f);
+    }
+  }
+
+  ozz::memory::default_allocator()->Delete(linear);
+  ozz::memory::default_allocator()->Delete(spline);
+}
+
+TEST(Prepared, SamplingJob) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(1);
+  const RawAnimation::TranslationKey tkeys[] = {
+      {0.f, ozz::math::Float3(0.f, 0.f, 0.f)},
+      {1.f, ozz::math::Float3(2.f, 0.f, 0.f)}};
+  raw_animation.tracks[0].translations.assign(tkeys, tkeys + 2);
+
+  AnimationBuilder builder;
+  Animation* animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+
+  SamplingCache cache(1);
+  ozz::math::SoaTransform output[1];
+
+  SamplingJob job;
+  job.animation = animation;
+  job.cache = &cache;
+
+  // Invalid jobs aren't run.
+  ozz::PreparedJob<SamplingJob> prepared(job);
+  EXPECT_FALSE(prepared.valid());
+  EXPECT_FALSE(prepared.Run());
+
+  // Ratio isn't validated, so it can be updated without preparing again.
+  prepared.job().output = output;
+  ASSERT_TRUE(prepared.Prepare());
+  const float ratios[] = {0.f, .25f, .5f, 2.f};
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(ratios); ++i) {
+    prepared.job().ratio = ratios[i];
+    ASSERT_TRUE(prepared.Run());
+    const float x = ozz::math::Min(ratios[i], 1.f) * 2.f;
+    EXPECT_SOAFLOAT3_EQ_EST(output[0].translation, x, 0.f, 0.f, 0.f, 0.f, 0.f,
+                            0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+  }
+
+  // Same as an unchecked run.
+  job.output = output;
+  job.ratio = .75f;
+  job.RunUnchecked();
+  EXPECT_SOAFLOAT3_EQ_EST(output[0].translation, 1.5f, 0.f, 0.f, 0.f, 0.f,
+                          0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+TEST(NoAllocation, SamplingJob) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(5);
+  const RawAnimation::TranslationKey key = {
+      .5f, ozz::math::Float3(1.f, 2.f, 3.f)};
+  raw_animation.tracks[4].translations.push_back(key);
+
+  AnimationBuilder builder;
+  Animation* animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+
+  // All runtime buffers are allocated out of the frame scope, or inline.
+  SamplingCache cache(animation->num_tracks());
+  ozz::InlineVector<ozz::math::SoaTransform, 2> output(2);
+
+  {
+    // Sampling a frame doesn't allocate.
+    ozz::memory::ScopedNoAllocation no_allocation;
+    for (float ratio = 0.f; ratio <= 1.f; ratio += .1f) {
+      SamplingJob job;
+      job.animation = animation;
+      job.cache = &cache;
+      job.ratio = ratio;
+      job.output = make_range(output);
+      ASSERT_TRUE(job.Run());
+    }
+    EXPECT_TRUE(output.is_inline());
+  }
+  EXPECT_SOAFLOAT3_EQ_EST(output[1].translation, 1.f, 0.f, 0.f, 0.f, 2.f, 0.f,
+                          0.f, 0.f, 3.f, 0.f, 0.f, 0.f);
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+TEST(Step, SamplingJob) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(6);
+
+  // Tracks 1 and 5 are step tracks, spread over both soa tracks, the others
+  // are linear.
+  for (int i = 0; i < 6; ++i) {
+    RawAnimation::JointTrack& track = raw_animation.tracks[i];
+    track.step = i == 1 || i == 5;
+    for (int k = 0; k < 3; ++k) {
+      const float f = static_cast<float>(k);
+      const RawAnimation::TranslationKey tkey = {
+          k * .5f, ozz::math::Float3(f, 0.f, 0.f)};
+      track.translations.push_back(tkey);
+      const RawAnimation::RotationKey rkey = {
+          k * .5f, ozz::math::Quaternion::FromAxisAngle(
+                       ozz::math::Float3::y_axis(), f * .5f)};
+      track.rotations.push_back(rkey);
+      const RawAnimation::ScaleKey skey = {
+          k * .5f, ozz::math::Float3(1.f + f, 1.f, 1.f)};
+      track.scales.push_back(skey);
+    }
+  }
+
+  AnimationBuilder builder;
+  Animation* linear = builder(raw_animation);
+  ASSERT_TRUE(linear != NULL);
+  builder.spline = true;
+  Animation* spline = builder(raw_animation);
+  ASSERT_TRUE(spline != NULL);
+
+  SamplingCache full_cache(6);
+  SamplingCache compact_cache(6, SamplingCache::kCompact);
+  SamplingCache spline_cache(6, SamplingCache::kSpline);
+  struct {
+    const Animation* animation;
+    SamplingCache* cache;
+  } cases[] = {{linear, &full_cache},
+               {linear, &compact_cache},
+               {spline, &spline_cache}};
+
+  // Expected x translation of linear and step tracks. The last key is output
+  // at the end of the animation, whatever the sampling order.
+  const struct {
+    float ratio;
+    float linear;
+    float step;
+  } expected[] = {{0.f, 0.f, 0.f},    {.25f, .5f, 0.f},   {.49f, .98f, 0.f},
+                  {.51f, 1.02f, 1.f}, {.75f, 1.5f, 1.f},  {1.f, 2.f, 2.f},
+                  {.25f, .5f, 0.f},   {.99f, 1.98f, 1.f}, {1.f, 2.f, 2.f},
+                  {.99f, 1.98f, 1.f}};
+
+  for (size_t c = 0; c < OZZ_ARRAY_SIZE(cases); ++c) {
+    ozz::math::SoaTransform output[2];
+    SamplingJob job;
+    job.animation = cases[c].animation;
+    job.cache = cases[c].cache;
+    job.output = output;
+
+    for (size_t i = 0; i < OZZ_ARRAY_SIZE(expected); ++i) {
+      job.ratio = expected[i].ratio;
+      ASSERT_TRUE(job.Run());
+
+      float x[8];
+      float sx[8];
+      float ry[8];
+      ozz::math::StorePtrU(output[0].translation.x, x);
+      ozz::math::StorePtrU(output[1].translation.x, x + 4);
+      ozz::math::StorePtrU(output[0].scale.x, sx);
+      ozz::math::StorePtrU(output[1].scale.x, sx + 4);
+      ozz::math::StorePtrU(output[0].rotation.y, ry);
+      ozz::math::StorePtrU(output[1].rotation.y, ry + 4);
+      for (int t = 0; t < 6; ++t) {
+        const float value =
+            (t == 1 || t == 5) ? expected[i].step : expected[i].linear;
+        EXPECT_NEAR(x[t], value, 2e-3f)
+            << "case " << c << " ratio " << expected[i].ratio << " track "
+            << t;
+        EXPECT_NEAR(sx[t], 1.f + value, 2e-3f)
+            << "case " << c << " ratio " << expected[i].ratio << " track "
+            << t;
+        if (t == 1 || t == 5) {
+          EXPECT_NEAR(ry[t], std::sin(value * .25f), 2e-3f)
+              << "case " << c << " ratio " << expected[i].ratio;
+        }
+      }
+    }
+  }
+
+  ozz::memory::default_allocator()->Delete(linear);
+  ozz::memory::default_allocator()->Delete(spline);
+}
+
+TEST(Scatter, SamplingJob) {
+  // Sparse animation keying joints 9 and 10 of a 12 joints skeleton, so only
+  // the third soa joint is stored.
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(12);
+  const RawAnimation::TranslationKey key = {0.f,
+                                            ozz::math::Float3(1.f, 2.f, 3.f)};
+  raw_animation.tracks[9].translations.push_back(key);
+  raw_animation.tracks[10].translations.push_back(key);
+
+  AnimationBuilder builder;
+  builder.sparse = true;
+  Animation* animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+  ASSERT_TRUE(animation->sparse());
+  SamplingCache cache(animation->num_tracks());
+
+  const ozz::math::SoaTransform identity = ozz::math::SoaTransform::identity();
+  ozz::math::SoaTransform output[3];
+  ozz::math::SoaFloat3 velocities[3];
+
+  SamplingJob job;
+  job.animation = animation;
+  job.cache = &cache;
+
+  {  // Scattered output must cover the last soa joint.
+    job.scatter = true;
+    job.output.begin = output;
+    job.output.end = output + 2;
+    EXPECT_FALSE(job.Validate());
+    job.output = output;
+    EXPECT_TRUE(job.Validate());
+
+    // Velocities aren't scattered.
+    job.linear_velocities = velocities;
+    EXPECT_FALSE(job.Validate());
+    job.linear_velocities = ozz::Range<ozz::math::SoaFloat3>();
+  }
+
+  {  // Without scattering, output matches animation soa tracks.
+    job.scatter = false;
+    job.output.begin = output;
+    job.output.end = output + 1;
+    ASSERT_TRUE(job.Run());
+    EXPECT_SOAFLOAT3_EQ_EST(output[0].translation, 0.f, 1.f, 1.f, 0.f, 0.f,
+                            2.f, 2.f, 0.f, 0.f, 3.f, 3.f, 0.f);
+  }
+
+  {  // Scattering leaves other soa joints untouched.
+    output[0] = identity;
+    output[1] = identity;
+    output[2] = identity;
+    output[0].translation.x = ozz::math::simd_float4::Load1(7.f);
+    job.scatter = true;
+    job.output = output;
+    ASSERT_TRUE(job.Run());
+    EXPECT_SOAFLOAT3_EQ_EST(output[0].translation, 7.f, 7.f, 7.f, 7.f, 0.f,
+                            0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+    EXPECT_SOAFLOAT3_EQ_EST(output[1].translation, 0.f, 0.f, 0.f, 0.f, 0.f,
+                            0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+    EXPECT_SOAFLOAT3_EQ_EST(output[2].translation, 0.f, 1.f, 1.f, 0.f, 0.f,
+                            2.f, 2.f, 0.f, 0.f, 3.f, 3.f, 0.f);
+  }
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+TEST(PrecisionLod, SamplingJob) {
+  // Smooth translation and rotation tracks, with many keys.
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(6);
+  for (int i = 0; i < 6; ++i) {
+    RawAnimation::JointTrack& track = raw_animation.tracks[i];
+    for (int k = 0; k <= 60; ++k) {
+      const float time = k / 60.f;
+      const float phase = ozz::math::k2Pi * time + i;
+      const RawAnimation::TranslationKey tkey = {
+          time, ozz::math::Float3(.1f * std::sin(phase), i * 1.f, 0.f)};
+      track.translations.push_back(tkey);
+      const RawAnimation::RotationKey rkey = {
+          time, ozz::math::Quaternion::FromAxisAngle(
+                    ozz::math::Float3::y_axis(), .5f * std::cos(phase))};
+      track.rotations.push_back(rkey);
+    }
+  }
+
+  AnimationBuilder builder;
+  Animation* reference = builder(raw_animation);
+  ASSERT_TRUE(reference != NULL);
+  builder.precision_lods = 4;
+  Animation* animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+  ASSERT_TRUE(animation->has_precision_lods());
+
+  SamplingCache reference_cache(6);
+  SamplingCache cache(6);
+  SamplingCache compact_cache(6, SamplingCache::kCompact);
+
+  ozz::math::SoaTransform reference_output[2];
+  SamplingJob reference_job;
+  reference_job.animation = reference;
+  reference_job.cache = &reference_cache;
+  reference_job.output = reference_output;
+
+  ozz::math::SoaTransform output[2];
+  SamplingCounters counters;
+  SamplingJob job;
+  job.animation = animation;
+  job.output = output;
+  job.counters = &counters;
+
+  job.precision_lod = -1;
+  job.cache = &cache;
+  EXPECT_FALSE(job.Validate());
+
+  // Samples forward, then backward, at every precision lod. Lod 5 is coarser
+  // than the coarsest built one, hence the same as lod 4. Sampled values stay
+  // within lod tolerance of the reference, which is 8mm and 8mrad for lod 4.
+  int decompressed[6] = {0};
+  for (int lod = 0; lod <= 5; ++lod) {
+    job.precision_lod = lod;
+    const float tolerance =
+        (lod == 0 ? 0.f : 1e-3f * (1 << (ozz::math::Min(lod, 4) - 1))) + 2e-4f;
+    for (int c = 0; c < 2; ++c) {
+      job.cache = c == 0 ? &cache : &compact_cache;
+      job.cache->Invalidate();
+      counters.Reset();
+      for (int f = 0; f <= 130; ++f) {
+        const float ratio = f <= 100 ? f / 100.f : (130 - f) / 30.f;
+        reference_job.ratio = ratio;
+        ASSERT_TRUE(reference_job.Run());
+        job.ratio = ratio;
+        ASSERT_TRUE(job.Run());
+        for (int s = 0; s < 2; ++s) {
+          float x[4], rx[4], ry[4], rry[4];
+          ozz::math::StorePtrU(output[s].translation.x, x);
+          ozz::math::StorePtrU(reference_output[s].translation.x, rx);
+          ozz::math::StorePtrU(output[s].rotation.y, ry);
+          ozz::math::StorePtrU(reference_output[s].rotation.y, rry);
+          for (int t = 0; t < 4; ++t) {
+            EXPECT_NEAR(x[t], rx[t], tolerance)
+                << "lod " << lod << " ratio " << ratio;
+            EXPECT_NEAR(ry[t], rry[t], tolerance)
+                << "lod " << lod << " ratio " << ratio;
+          }
+        }
+      }
+      if (c == 0) {
+        decompressed[lod] = counters.decompressed;
+      }
+    }
+  }
+
+  // Coarser lods decompress less soa entries.
+  for (int lod = 1; lod <= 4; ++lod) {
+    EXPECT_LT(decompressed[lod], decompressed[lod - 1]);
+  }
+  EXPECT_EQ(decompressed[5], decompressed[4]);
+
+  // Lod can change without invalidating the cache.
+  job.cache = &cache;
+  job.cache->Invalidate();
+  for (int f = 0; f <= 100; ++f) {
+    job.precision_lod = (f / 7) % 5;
+    job.ratio = reference_job.ratio = f / 100.f;
+    ASSERT_TRUE(reference_job.Run());
+    ASSERT_TRUE(job.Run());
+    for (int s = 0; s < 2; ++s) {
+      float x[4], rx[4];
+      ozz::math::StorePtrU(output[s].translation.x, x);
+      ozz::math::StorePtrU(reference_output[s].translation.x, rx);
+      for (int t = 0; t < 4; ++t) {
+        EXPECT_NEAR(x[t], rx[t], 2e-2f) << "ratio " << job.ratio;
+      }
+    }
+  }
+
+  // Precision lod has no effect on animations without precision lods.
+  float lod0_x[4], lod3_x[4];
+  reference_job.ratio = .51f;
+  ASSERT_TRUE(reference_job.Run());
+  ozz::math::StorePtrU(reference_output[0].translation.x, lod0_x);
+  reference_job.precision_lod = 3;
+  reference_cache.Invalidate();
+  ASSERT_TRUE(reference_job.Run());
+  ozz::math::StorePtrU(reference_output[0].translation.x, lod3_x);
+  for (int t = 0; t < 4; ++t) {
+    EXPECT_FLOAT_EQ(lod3_x[t], lod0_x[t]);
+  }
+
+  ozz::memory::default_allocator()->Delete(reference);
+  ozz::memory::default_allocator()->Delete(animation);
+}
@@ -0,0 +1,233 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#include "ozz/animation/runtime/segmented_sampling_job.h"
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/allocator.h"
+
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/sampling_job.h"
+
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/raw_animation_utils.h"
+
+using ozz::animation::Animation;
+using ozz::animation::SamplingCache;
+using ozz::animation::SamplingJob;
+using ozz::animation::SegmentedSamplingJob;
+using ozz::animation::offline::AnimationBuilder;
+using ozz::animation::offline::RawAnimation;
+
+namespace {
+void BuildRawAnimation(RawAnimation* _raw) {
+  _raw->duration = 3.f;
+  _raw->tracks.resize(2);
+
+  const RawAnimation::TranslationKey tkeys[] = {
+      {0.f, ozz::math::Float3(0.f, 0.f, 0.f)},
+      {.5f, ozz::math::Float3(1.f, 2.f, 0.f)},
+      {2.2f, ozz::math::Float3(-1.f, 0.f, 4.f)},
+      {3.f, ozz::math::Float3(0.f, 1.f, 0.f)}};
+  _raw->tracks[0].translations.assign(tkeys, tkeys + OZZ_ARRAY_SIZE(tkeys));
+
+  const RawAnimation::RotationKey rkeys[] = {
+      {0.f, ozz::math::Quaternion(0.f, 0.f, 0.f, 1.f)},
+      {1.7f, ozz::math::Quaternion(0.f, .70710677f, 0.f, .70710677f)}};
+  _raw->tracks[1].rotations.assign(rkeys, rkeys + OZZ_ARRAY_SIZE(rkeys));
+
+  const RawAnimation::ScaleKey skey = {1.f, ozz::math::Float3(2.f, 2.f, 2.f)};
+  _raw->tracks[1].scales.push_back(skey);
+}
+}  // namespace
+
+TEST(Split, SegmentedSamplingJob) {
+  RawAnimation raw;
+  BuildRawAnimation(&raw);
+
+  ozz::Vector<RawAnimation>::Std segments;
+  EXPECT_FALSE(ozz::animation::offline::SplitAnimation(raw, 0.f, &segments));
+  EXPECT_FALSE(ozz::animation::offline::SplitAnimation(raw, 1.f, NULL));
+
+  ASSERT_TRUE(ozz::animation::offline::SplitAnimation(raw, 1.2f, &segments));
+  ASSERT_EQ(segments.size(), 3u);
+  EXPECT_FLOAT_EQ(segments[0].duration, 1.2f);
+  EXPECT_FLOAT_EQ(segments[1].duration, 1.2f);
+  EXPECT_FLOAT_EQ(segments[2].duration, .6f);
+  for (size_t i = 0; i < segments.size(); ++i) {
+    EXPECT_TRUE(segments[i].Validate());
+    ASSERT_EQ(segments[i].num_tracks(), 2);
+    // Identity tracks remain identity.
+    EXPECT_TRUE(segments[i].tracks[0].rotations.empty());
+  }
+
+  // Bound keys are interpolated, inner keys are shifted.
+  const RawAnimation::JointTrack::Translations& translations =
+      segments[1].tracks[0].translations;
+  ASSERT_EQ(translations.size(), 3u);
+  EXPECT_FLOAT_EQ(translations[0].time, 0.f);
+  EXPECT_FLOAT_EQ(translations[0].value.x, 1.f - 2.f * .7f / 1.7f);
+  EXPECT_FLOAT_EQ(translations[1].time, 1.f);
+  EXPECT_FLOAT_EQ(translations[1].value.x, -1.f);
+  EXPECT_FLOAT_EQ(translations[2].time, 1.2f);
+  EXPECT_FLOAT_EQ(translations[2].value.x, -.75f);
+
+  // A single constant key remains a single key.
+  EXPECT_EQ(segments[2].tracks[1].scales.size(), 1u);
+
+  // Invalid intervals.
+  RawAnimation segment;
+  using ozz::animation::offline::ExtractSegment;
+  EXPECT_FALSE(ExtractSegment(raw, 1.f, 1.f, &segment));
+  EXPECT_FALSE(ExtractSegment(raw, -1.f, 1.f, &segment));
+  EXPECT_FALSE(ExtractSegment(raw, 1.f, 4.f, &segment));
+  EXPECT_TRUE(ExtractSegment(raw, 1.f, 3.f, &segment));
+}
+
+TEST(Validate, SegmentedSamplingJob) {
+  RawAnimation raw;
+  BuildRawAnimation(&raw);
+  ozz::Vector<RawAnimation>::Std raw_segments;
+  ASSERT_TRUE(
+      ozz::animation::offline::SplitAnimation(raw, 1.f, &raw_segments));
+  ASSERT_EQ(raw_segments.size(), 3u);
+
+  AnimationBuilder builder;
+  Animation* animation = builder(raw_segments[1]);
+  ASSERT_TRUE(animation != NULL);
+
+  SamplingCache cache(2);
+  ozz::math::SoaTransform output[1];
+
+  // Only the second segment is resident.
+  const Animation* segments[] = {NULL, animation, NULL};
+
+  {  // Default job.
+    SegmentedSamplingJob job;
+    EXPECT_EQ(job.segment(), -1);
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  SegmentedSamplingJob job;
+  job.duration = 3.f;
+  job.segment_duration = 1.f;
+  job.segments = segments;
+  job.cache = &cache;
+  job.output = output;
+
+  job.ratio = 0.f;
+  EXPECT_EQ(job.segment(), 0);
+  EXPECT_FALSE(job.Validate());
+  EXPECT_FALSE(job.Run());
+
+  job.ratio = .5f;
+  EXPECT_EQ(job.segment(), 1);
+  EXPECT_TRUE(job.Validate());
+  EXPECT_TRUE(job.Run());
+
+  job.ratio = 1.f;
+  EXPECT_EQ(job.segment(), 2);
+  EXPECT_FALSE(job.Validate());
+
+  job.ratio = 2.f;  // Clamped.
+  EXPECT_EQ(job.segment(), 2);
+
+  job.ratio = .5f;
+  job.cache = NULL;
+  EXPECT_FALSE(job.Validate());
+  job.cache = &cache;
+
+  job.output.end = job.output.begin;
+  EXPECT_FALSE(job.Validate());
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+TEST(Sample, SegmentedSamplingJob) {
+  RawAnimation raw;
+  BuildRawAnimation(&raw);
+  ozz::Vector<RawAnimation>::Std raw_segments;
+  ASSERT_TRUE(
+      ozz::animation::offline::SplitAnimation(raw, .7f, &raw_segments));
+
+  AnimationBuilder builder;
+  Animation* full = builder(raw);
+  ASSERT_TRUE(full != NULL);
+  Animation* segments[5] = {NULL};
+  ASSERT_EQ(raw_segments.size(), OZZ_ARRAY_SIZE(segments));
+  for (size_t i = 0; i < raw_segments.size(); ++i) {
+    segments[i] = builder(raw_segments[i]);
+    ASSERT_TRUE(segments[i] != NULL);
+  }
+
+  SamplingCache full_cache(2);
+  SamplingCache segmented_cache(2);
+  ozz::math::SoaTransform full_output[1];
+  ozz::math::SoaTransform segmented_output[1];
+
+  SamplingJob full_job;
+  full_job.animation = full;
+  full_job.cache = &full_cache;
+  full_job.output = full_output;
+
+  SegmentedSamplingJob segmented_job;
+  segmented_job.duration = raw.duration;
+  segmented_job.segment_duration = .7f;
+  segmented_job.segments.begin = segments;
+  segmented_job.segments.end = segments + OZZ_ARRAY_SIZE(segments);
+  segmented_job.cache = &segmented_cache;
+  segmented_job.output = segmented_output;
+
+  // Forward, then backward.
+  for (int i = 0; i <= 200; ++i) {
+    const float ratio = i <= 100 ? i / 100.f : (200 - i) / 100.f;
+    full_job.ratio = ratio;
+    segmented_job.ratio = ratio;
+    ASSERT_TRUE(full_job.Run());
+    ASSERT_TRUE(segmented_job.Run());
+
+    const float* expected = reinterpret_cast<const float*>(full_output);
+    const float* actual = reinterpret_cast<const float*>(segmented_output);
+    for (size_t j = 0; j < OZZ_ARRAY_SIZE(full_output) * 10 * 4; ++j) {
+      // Nlerp isn't linear, so rotations in between segment bounds can differ
+      // a bit more.
+      const bool rotation = j % 40 >= 12 && j % 40 < 28;
+      EXPECT_NEAR(expected[j], actual[j], rotation ? 1e-2f : 2e-3f)
+          << " ratio " << ratio;
+    }
+  }
+
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(segments); ++i) {
+    ozz::memory::default_allocator()->Delete(segments[i]);
+  }
+  ozz::memory::default_allocator()->Delete(full);
+}
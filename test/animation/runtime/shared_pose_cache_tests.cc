@@ -0,0 +1,179 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/shared_pose_cache.h"
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/allocator.h"
+
+#include "ozz/animation/runtime/animation.h"
+
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/raw_animation.h"
+
+using ozz::animation::Animation;
+using ozz::animation::SharedPoseCache;
+using ozz::animation::offline::AnimationBuilder;
+using ozz::animation::offline::RawAnimation;
+
+namespace {
+Animation* BuildAnimation(float _scale) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(1);
+
+  const RawAnimation::TranslationKey tkey0 = {
+      0.f, ozz::math::Float3(0.f, 0.f, 0.f)};
+  raw_animation.tracks[0].translations.push_back(tkey0);
+  const RawAnimation::TranslationKey tkey1 = {
+      1.f, ozz::math::Float3(_scale, 0.f, 0.f)};
+  raw_animation.tracks[0].translations.push_back(tkey1);
+
+  AnimationBuilder builder;
+  return builder(raw_animation);
+}
+}  // namespace
+
+TEST(Empty, SharedPoseCache) {
+  Animation* animation = BuildAnimation(1.f);
+  ASSERT_TRUE(animation != NULL);
+
+  SharedPoseCache cache;
+  EXPECT_EQ(cache.max_poses(), 0);
+  EXPECT_EQ(cache.max_tracks(), 0);
+  EXPECT_TRUE(cache.Acquire(*animation, 0.f).begin == NULL);
+
+  // Too small.
+  cache.Resize(0, 2);
+  EXPECT_TRUE(cache.Acquire(*animation, 0.f).begin == NULL);
+
+  // No pose.
+  cache.Resize(4, 0);
+  EXPECT_TRUE(cache.Acquire(*animation, 0.f).begin == NULL);
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+TEST(Share, SharedPoseCache) {
+  Animation* animation0 = BuildAnimation(1.f);
+  ASSERT_TRUE(animation0 != NULL);
+  Animation* animation1 = BuildAnimation(2.f);
+  ASSERT_TRUE(animation1 != NULL);
+
+  SharedPoseCache cache(1, 2);
+  EXPECT_EQ(cache.max_poses(), 2);
+  EXPECT_EQ(cache.max_tracks(), 4);
+  EXPECT_EQ(cache.num_acquired_poses(), 0);
+
+  // Same animation and ratio share the same pose.
+  const ozz::Range<const ozz::math::SoaTransform> p0 =
+      cache.Acquire(*animation0, .5f);
+  ASSERT_TRUE(p0.begin != NULL);
+  EXPECT_EQ(p0.count(), 1u);
+  EXPECT_SOAFLOAT3_EQ_EST(p0.begin->translation, .5f, 0.f, 0.f, 0.f, 0.f, 0.f,
+                          0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+  const ozz::Range<const ozz::math::SoaTransform> p0b =
+      cache.Acquire(*animation0, .5f);
+  EXPECT_EQ(p0b.begin, p0.begin);
+  EXPECT_EQ(cache.num_acquired_poses(), 1);
+
+  // Another animation uses another pose.
+  const ozz::Range<const ozz::math::SoaTransform> p1 =
+      cache.Acquire(*animation1, .5f);
+  ASSERT_TRUE(p1.begin != NULL);
+  EXPECT_NE(p1.begin, p0.begin);
+  EXPECT_SOAFLOAT3_EQ_EST(p1.begin->translation, 1.f, 0.f, 0.f, 0.f, 0.f, 0.f,
+                          0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+  EXPECT_EQ(cache.num_acquired_poses(), 2);
+
+  // All poses are referenced.
+  EXPECT_TRUE(cache.Acquire(*animation0, .75f).begin == NULL);
+
+  // Releases second animation pose, that can be recycled.
+  cache.Release(p1);
+  EXPECT_EQ(cache.num_acquired_poses(), 1);
+  const ozz::Range<const ozz::math::SoaTransform> p2 =
+      cache.Acquire(*animation0, .75f);
+  ASSERT_TRUE(p2.begin != NULL);
+  EXPECT_EQ(p2.begin, p1.begin);
+  EXPECT_SOAFLOAT3_EQ_EST(p2.begin->translation, .75f, 0.f, 0.f, 0.f, 0.f,
+                          0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+
+  // First pose is still referenced once.
+  cache.Release(p0);
+  EXPECT_EQ(cache.num_acquired_poses(), 2);
+  EXPECT_SOAFLOAT3_EQ_EST(p0b.begin->translation, .5f, 0.f, 0.f, 0.f, 0.f, 0.f,
+                          0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+  cache.Release(p0b);
+  cache.Release(p2);
+  EXPECT_EQ(cache.num_acquired_poses(), 0);
+
+  // Unreferenced poses are still found.
+  const ozz::Range<const ozz::math::SoaTransform> p3 =
+      cache.Acquire(*animation0, .5f);
+  EXPECT_EQ(p3.begin, p0.begin);
+  cache.Release(p3);
+
+  ozz::memory::default_allocator()->Delete(animation0);
+  ozz::memory::default_allocator()->Delete(animation1);
+}
+
+TEST(Quantization, SharedPoseCache) {
+  Animation* animation = BuildAnimation(1.f);
+  ASSERT_TRUE(animation != NULL);
+
+  SharedPoseCache cache(1, 4);
+  cache.set_ratio_steps(10);
+  EXPECT_EQ(cache.ratio_steps(), 10);
+
+  // Close ratios share the same quantized pose.
+  const ozz::Range<const ozz::math::SoaTransform> p0 =
+      cache.Acquire(*animation, .51f);
+  const ozz::Range<const ozz::math::SoaTransform> p1 =
+      cache.Acquire(*animation, .49f);
+  ASSERT_TRUE(p0.begin != NULL);
+  EXPECT_EQ(p0.begin, p1.begin);
+  EXPECT_SOAFLOAT3_EQ_EST(p0.begin->translation, .5f, 0.f, 0.f, 0.f, 0.f, 0.f,
+                          0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+
+  const ozz::Range<const ozz::math::SoaTransform> p2 =
+      cache.Acquire(*animation, .56f);
+  ASSERT_TRUE(p2.begin != NULL);
+  EXPECT_NE(p2.begin, p0.begin);
+  EXPECT_SOAFLOAT3_EQ_EST(p2.begin->translation, .6f, 0.f, 0.f, 0.f, 0.f, 0.f,
+                          0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+  EXPECT_EQ(cache.num_acquired_poses(), 2);
+
+  // Invalidation drops all poses.
+  cache.Invalidate();
+  EXPECT_EQ(cache.num_acquired_poses(), 0);
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
@@ -84,8 +84,11 @@ TEST(Filled, SkeletonSerialize) {
     EXPECT_EQ(raw_skeleton.num_joints(), 3);
 
     SkeletonBuilder builder;
+    builder.lods.resize(1);
+    builder.lods[0].excluded_joints.push_back("j0");
     o_skeleton = builder(raw_skeleton);
     ASSERT_TRUE(o_skeleton != NULL);
+    EXPECT_EQ(o_skeleton->num_lods(), 2);
   }
 
   for (int e = 0; e < 2; ++e) {
@@ -105,9 +108,21 @@ TEST(Filled, SkeletonSerialize) {
 
     // Compares skeletons.
     EXPECT_EQ(o_skeleton->num_joints(), i_skeleton.num_joints());
+    EXPECT_EQ(o_skeleton->num_lods(), i_skeleton.num_lods());
+    for (int i = 0; i < i_skeleton.num_lods(); ++i) {
+      EXPECT_EQ(i_skeleton.lod_num_joints(i), o_skeleton->lod_num_joints(i));
+    }
     for (int i = 0; i < i_skeleton.num_joints(); ++i) {
+      EXPECT_EQ(i_skeleton.joint_lods().begin[i],
+                o_skeleton->joint_lods().begin[i]);
       EXPECT_EQ(i_skeleton.joint_parents().begin[i],
                 o_skeleton->joint_parents().begin[i]);
+      EXPECT_EQ(i_skeleton.joint_subtree_ends().begin[i],
+                o_skeleton->joint_subtree_ends().begin[i]);
+      EXPECT_EQ(i_skeleton.joint_depths().begin[i],
+                o_skeleton->joint_depths().begin[i]);
+      EXPECT_EQ(i_skeleton.joint_child_counts().begin[i],
+                o_skeleton->joint_child_counts().begin[i]);
       EXPECT_STREQ(i_skeleton.joint_names()[i], o_skeleton->joint_names()[i]);
     }
     for (int i = 0; i < (i_skeleton.num_joints() + 3) / 4; ++i) {
@@ -178,3 +193,94 @@ TEST(AlreadyInitialized, SkeletonSerialize) {
   ozz::memory::default_allocator()->Delete(o_skeleton[0]);
   ozz::memory::default_allocator()->Delete(o_skeleton[1]);
 }
+
+TEST(SkipNames, SkeletonSerialize) {
+  Skeleton* o_skeleton = NULL;
+  /* Builds output skeleton.
+   4 joints
+
+     *
+     |
+    root
+    / \
+   j0 j1
+       |
+       j2
+  */
+  {
+    RawSkeleton raw_skeleton;
+    raw_skeleton.roots.resize(1);
+    RawSkeleton::Joint& root = raw_skeleton.roots[0];
+    root.name = "root";
+
+    root.children.resize(2);
+    root.children[0].name = "j0";
+    root.children[1].name = "j1";
+    root.children[1].children.resize(1);
+    root.children[1].children[0].name = "j2";
+
+    SkeletonBuilder builder;
+    o_skeleton = builder(raw_skeleton);
+    ASSERT_TRUE(o_skeleton != NULL);
+  }
+
+  // Joints are found by name or hash.
+  EXPECT_EQ(o_skeleton->joint_name_hashes().count(), 4u);
+  for (int i = 0; i < o_skeleton->num_joints(); ++i) {
+    const char* name = o_skeleton->joint_names()[i];
+    EXPECT_EQ(o_skeleton->joint_name_hashes()[i],
+              Skeleton::HashJointName(name));
+    EXPECT_EQ(o_skeleton->FindJoint(name), i);
+    EXPECT_EQ(o_skeleton->FindJointByHash(Skeleton::HashJointName(name)), i);
+  }
+  EXPECT_EQ(o_skeleton->FindJoint("j3"), -1);
+  EXPECT_EQ(o_skeleton->FindJoint(""), -1);
+
+  ozz::io::MemoryStream stream;
+  {
+    ozz::io::OArchive o(&stream);
+    o << *o_skeleton;
+  }
+
+  // Streams in without names.
+  stream.Seek(0, ozz::io::Stream::kSet);
+  Skeleton i_skeleton;
+  EXPECT_TRUE(i_skeleton.load_names());
+  i_skeleton.set_load_names(false);
+  {
+    ozz::io::IArchive ia(&stream);
+    ia >> i_skeleton;
+  }
+  ASSERT_EQ(i_skeleton.num_joints(), o_skeleton->num_joints());
+  EXPECT_EQ(i_skeleton.joint_names().count(), 0u);
+  for (int i = 0; i < i_skeleton.num_joints(); ++i) {
+    EXPECT_EQ(i_skeleton.joint_parents()[i], o_skeleton->joint_parents()[i]);
+    EXPECT_EQ(i_skeleton.joint_name_hashes()[i],
+              o_skeleton->joint_name_hashes()[i]);
+    EXPECT_EQ(i_skeleton.FindJoint(o_skeleton->joint_names()[i]), i);
+  }
+  EXPECT_EQ(i_skeleton.FindJoint("j3"), -1);
+
+  // A skeleton loaded without names can't be written flat.
+  EXPECT_FALSE(i_skeleton.WriteFlat(NULL, 0));
+
+  // Names are written empty.
+  ozz::io::MemoryStream empty_stream;
+  {
+    ozz::io::OArchive o(&empty_stream);
+    o << i_skeleton;
+  }
+  empty_stream.Seek(0, ozz::io::Stream::kSet);
+  Skeleton e_skeleton;
+  {
+    ozz::io::IArchive ia(&empty_stream);
+    ia >> e_skeleton;
+  }
+  ASSERT_EQ(e_skeleton.num_joints(), 4);
+  for (int i = 0; i < e_skeleton.num_joints(); ++i) {
+    EXPECT_STREQ(e_skeleton.joint_names()[i], "");
+    EXPECT_EQ(e_skeleton.joint_parents()[i], o_skeleton->joint_parents()[i]);
+  }
+
+  ozz::memory::default_allocator()->Delete(o_skeleton);
+}
@@ -25,6 +25,8 @@
 //                                                                            //
 //----------------------------------------------------------------------------//
 
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/raw_animation.h"
 #include "ozz/animation/offline/raw_skeleton.h"
 #include "ozz/animation/offline/skeleton_builder.h"
 
@@ -35,11 +37,15 @@
 #include "ozz/base/gtest_helper.h"
 #include "ozz/base/maths/gtest_math_helper.h"
 
+#include "ozz/animation/runtime/animation.h"
 #include "ozz/animation/runtime/skeleton.h"
 #include "ozz/animation/runtime/skeleton_utils.h"
 #include "ozz/base/memory/allocator.h"
 
+using ozz::animation::Animation;
 using ozz::animation::Skeleton;
+using ozz::animation::offline::AnimationBuilder;
+using ozz::animation::offline::RawAnimation;
 using ozz::animation::offline::RawSkeleton;
 using ozz::animation::offline::SkeletonBuilder;
 
@@ -418,3 +424,281 @@ TEST(IsLeaf, SkeletonUtils) {
 
   ozz::memory::default_allocator()->Delete(skeleton);
 }
+
+TEST(IndependentSubtrees, SkeletonUtils) {
+  // Builds the skeleton
+  /*
+   8 joints
+         *
+       /   \
+     j0    j7
+    /  \
+   j1  j3
+    |  / \
+   j2 j4 j6
+       |
+      j5
+  */
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(2);
+  RawSkeleton::Joint& j0 = raw_skeleton.roots[0];
+  j0.name = "j0";
+  raw_skeleton.roots[1].name = "j7";
+  j0.children.resize(2);
+  j0.children[0].name = "j1";
+  j0.children[1].name = "j3";
+  j0.children[0].children.resize(1);
+  j0.children[0].children[0].name = "j2";
+  j0.children[1].children.resize(2);
+  j0.children[1].children[0].name = "j4";
+  j0.children[1].children[1].name = "j6";
+  j0.children[1].children[0].children.resize(1);
+  j0.children[1].children[0].children[0].name = "j5";
+
+  SkeletonBuilder builder;
+  Skeleton* skeleton = builder(raw_skeleton);
+  ASSERT_TRUE(skeleton != NULL);
+  ASSERT_EQ(skeleton->num_joints(), 8);
+
+  // Subtree ends.
+  const int16_t expected_ends[8] = {7, 3, 3, 7, 6, 6, 7, 8};
+  for (int i = 0; i < 8; ++i) {
+    EXPECT_EQ(skeleton->joint_subtree_ends()[i], expected_ends[i]);
+  }
+
+  // Depths, child counts and levels.
+  const int16_t expected_depths[8] = {0, 1, 2, 1, 2, 3, 2, 0};
+  const int16_t expected_child_counts[8] = {2, 1, 0, 2, 1, 0, 0, 0};
+  for (int i = 0; i < 8; ++i) {
+    EXPECT_EQ(skeleton->joint_depths()[i], expected_depths[i]);
+    EXPECT_EQ(skeleton->joint_child_counts()[i], expected_child_counts[i]);
+    EXPECT_EQ(ozz::animation::IsLeaf(*skeleton, i),
+              expected_child_counts[i] == 0);
+  }
+  ASSERT_EQ(skeleton->num_levels(), 4);
+  const int16_t expected_levels[8] = {0, 7, 1, 3, 2, 4, 6, 5};
+  const int expected_level_sizes[4] = {2, 2, 3, 1};
+  int level_begin = 0;
+  for (int level = 0; level < 4; ++level) {
+    const ozz::Range<const int16_t> joints = skeleton->level_joints(level);
+    ASSERT_EQ(static_cast<int>(joints.count()), expected_level_sizes[level]);
+    for (size_t i = 0; i < joints.count(); ++i) {
+      EXPECT_EQ(joints[i], expected_levels[level_begin + i]);
+      EXPECT_EQ(skeleton->joint_depths()[joints[i]], level);
+    }
+    level_begin += expected_level_sizes[level];
+  }
+
+  int roots[3];
+  const ozz::Range<int> roots_range(roots, OZZ_ARRAY_SIZE(roots));
+
+  // Whole skeleton.
+  EXPECT_EQ(ozz::animation::GetIndependentSubtrees(*skeleton, 0, roots_range),
+            2);
+  EXPECT_EQ(roots[0], 0);
+  EXPECT_EQ(roots[1], 7);
+
+  // After j1 subtree.
+  EXPECT_EQ(ozz::animation::GetIndependentSubtrees(*skeleton, 3, roots_range),
+            2);
+  EXPECT_EQ(roots[0], 3);
+  EXPECT_EQ(roots[1], 7);
+
+  // After j3.
+  EXPECT_EQ(ozz::animation::GetIndependentSubtrees(*skeleton, 4, roots_range),
+            3);
+  EXPECT_EQ(roots[0], 4);
+  EXPECT_EQ(roots[1], 6);
+  EXPECT_EQ(roots[2], 7);
+
+  // Roots range too small.
+  EXPECT_EQ(ozz::animation::GetIndependentSubtrees(
+                *skeleton, 2, ozz::Range<int>(roots, 1)),
+            3);
+  EXPECT_EQ(roots[0], 2);
+
+  // After the last joint.
+  EXPECT_EQ(ozz::animation::GetIndependentSubtrees(*skeleton, 8, roots_range),
+            0);
+
+  // Required joints.
+  bool required[8] = {false};
+  const ozz::Range<bool> required_range(required, OZZ_ARRAY_SIZE(required));
+  const uint16_t mesh0[] = {2, 5};
+  EXPECT_EQ(ozz::animation::GetRequiredJoints(*skeleton, mesh0,
+                                              required_range),
+            6);
+  const bool expected0[8] = {true, true, true, true, true, true, false, false};
+  EXPECT_EQ(memcmp(required, expected0, sizeof(required)), 0);
+
+  // Accumulates a second mesh.
+  const uint16_t mesh1[] = {4, 6, 7};
+  EXPECT_EQ(ozz::animation::GetRequiredJoints(*skeleton, mesh1,
+                                              required_range),
+            2);
+  const bool expected1[8] = {true, true, true, true, true, true, true, true};
+  EXPECT_EQ(memcmp(required, expected1, sizeof(required)), 0);
+
+  // Invalid joint and output size.
+  const uint16_t invalid[] = {8};
+  EXPECT_EQ(ozz::animation::GetRequiredJoints(*skeleton, invalid,
+                                              required_range),
+            -1);
+  EXPECT_EQ(ozz::animation::GetRequiredJoints(
+                *skeleton, mesh0, ozz::Range<bool>(required, 7)),
+            -1);
+
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+TEST(LODs, SkeletonUtils) {
+  // 7 joints, root has a chain of 4 joints and 2 leaves:
+  // root - a - a1 - a2 - a3
+  //     |- b
+  //     |- c
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  RawSkeleton::Joint& root = raw_skeleton.roots[0];
+  root.name = "root";
+  root.children.resize(3);
+  root.children[0].name = "a";
+  root.children[0].children.resize(1);
+  root.children[0].children[0].name = "a1";
+  root.children[0].children[0].children.resize(1);
+  root.children[0].children[0].children[0].name = "a2";
+  root.children[0].children[0].children[0].children.resize(1);
+  root.children[0].children[0].children[0].children[0].name = "a3";
+  root.children[1].name = "b";
+  root.children[2].name = "c";
+  ASSERT_TRUE(raw_skeleton.Validate());
+
+  // LOD 1 removes a2 and b.
+  SkeletonBuilder builder;
+  builder.lods.resize(1);
+  builder.lods[0].excluded_joints.push_back("a2");
+  builder.lods[0].excluded_joints.push_back("b");
+  Skeleton* skeleton = builder(raw_skeleton);
+  ASSERT_TRUE(skeleton != NULL);
+  ASSERT_EQ(skeleton->num_joints(), 7);
+  ASSERT_EQ(skeleton->num_lods(), 2);
+
+  // Joints are root, a, a1, a2, a3, c, b.
+  EXPECT_EQ(skeleton->lod_num_joints(1), 6);
+
+  bool required[7];
+  EXPECT_EQ(ozz::animation::GetLODJoints(
+                *skeleton, 0, ozz::Range<bool>(required, 6)),
+            -1);
+  EXPECT_EQ(ozz::animation::GetLODJoints(*skeleton, -1, required), -1);
+  EXPECT_EQ(ozz::animation::GetLODJoints(*skeleton, 2, required), -1);
+
+  EXPECT_EQ(ozz::animation::GetLODJoints(*skeleton, 0, required), 7);
+  for (int i = 0; i < 7; ++i) {
+    EXPECT_TRUE(required[i]);
+  }
+  EXPECT_EQ(ozz::animation::GetLODJoints(*skeleton, 1, required), 4);
+  const bool expected_required[7] = {true,  true, true, false,
+                                     false, true, false};
+  for (int i = 0; i < 7; ++i) {
+    EXPECT_EQ(required[i], expected_required[i]);
+  }
+
+  // 2 soa joints.
+  uint8_t mask[2] = {0xff, 0xff};
+  EXPECT_EQ(ozz::animation::GetLODSamplingMask(
+                *skeleton, 0, ozz::Range<uint8_t>(mask, size_t(0))),
+            -1);
+  EXPECT_EQ(ozz::animation::GetLODSamplingMask(*skeleton, 2, mask), -1);
+  EXPECT_EQ(ozz::animation::GetLODSamplingMask(*skeleton, 0, mask), 2);
+  EXPECT_EQ(mask[0], 3);
+  EXPECT_EQ(mask[1], 0xff);
+  EXPECT_EQ(ozz::animation::GetLODSamplingMask(*skeleton, 1, mask), 2);
+  EXPECT_EQ(mask[0], 3);
+
+  // LOD 1 also removes c, so second soa joint is empty.
+  builder.lods[0].excluded_joints.push_back("c");
+  ASSERT_TRUE(builder(raw_skeleton, skeleton));
+  EXPECT_EQ(skeleton->lod_num_joints(1), 3);
+  EXPECT_EQ(ozz::animation::GetLODSamplingMask(*skeleton, 1, mask), 1);
+  EXPECT_EQ(mask[0], 1);
+  EXPECT_EQ(ozz::animation::GetLODSamplingMask(*skeleton, 0, mask), 2);
+  EXPECT_EQ(mask[0], 3);
+
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+TEST(Compatibility, SkeletonUtils) {
+  SkeletonBuilder skeleton_builder;
+
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  raw_skeleton.roots[0].name = "root";
+  raw_skeleton.roots[0].children.resize(2);
+  raw_skeleton.roots[0].children[0].name = "left";
+  raw_skeleton.roots[0].children[1].name = "right";
+  Skeleton* skeleton = skeleton_builder(raw_skeleton);
+  ASSERT_TRUE(skeleton != NULL);
+
+  // Fingerprint depends on names and hierarchy only.
+  raw_skeleton.roots[0].children[0].transform.translation =
+      ozz::math::Float3::x_axis();
+  Skeleton* moved = skeleton_builder(raw_skeleton);
+  ASSERT_TRUE(moved != NULL);
+  raw_skeleton.roots[0].children[0].name = "other";
+  Skeleton* renamed = skeleton_builder(raw_skeleton);
+  ASSERT_TRUE(renamed != NULL);
+  RawSkeleton raw_chain;  // Same names, but "right" is a child of "left".
+  raw_chain.roots.resize(1);
+  raw_chain.roots[0].name = "root";
+  raw_chain.roots[0].children.resize(1);
+  raw_chain.roots[0].children[0].name = "left";
+  raw_chain.roots[0].children[0].children.resize(1);
+  raw_chain.roots[0].children[0].children[0].name = "right";
+  Skeleton* reparented = skeleton_builder(raw_chain);
+  ASSERT_TRUE(reparented != NULL);
+  ASSERT_EQ(reparented->num_joints(), 3);
+
+  EXPECT_NE(skeleton->fingerprint(), 0u);
+  EXPECT_EQ(skeleton->fingerprint(), moved->fingerprint());
+  EXPECT_NE(skeleton->fingerprint(), renamed->fingerprint());
+  EXPECT_NE(skeleton->fingerprint(), reparented->fingerprint());
+
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(3);
+
+  AnimationBuilder animation_builder;
+  Animation* unknown = animation_builder(raw_animation);
+  ASSERT_TRUE(unknown != NULL);
+  EXPECT_EQ(unknown->skeleton_fingerprint(), 0u);
+
+  animation_builder.bounds_skeleton = skeleton;
+  Animation* animation = animation_builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+  EXPECT_EQ(animation->skeleton_fingerprint(), skeleton->fingerprint());
+
+  // The skeleton must match animation tracks, even without bounds.
+  RawAnimation mismatching = raw_animation;
+  mismatching.tracks.resize(2);
+  EXPECT_TRUE(!animation_builder(mismatching));
+
+  // Animations whose skeleton is unknown only need to match joints count.
+  animation_builder.bounds_skeleton = NULL;
+  Animation* smaller = animation_builder(mismatching);
+  ASSERT_TRUE(smaller != NULL);
+
+  EXPECT_TRUE(IsCompatible(*skeleton, *animation));
+  EXPECT_TRUE(IsCompatible(*moved, *animation));
+  EXPECT_FALSE(IsCompatible(*renamed, *animation));
+  EXPECT_FALSE(IsCompatible(*reparented, *animation));
+  EXPECT_TRUE(IsCompatible(*renamed, *unknown));
+  EXPECT_FALSE(IsCompatible(*skeleton, *smaller));
+
+  ozz::memory::default_allocator()->Delete(smaller);
+  ozz::memory::default_allocator()->Delete(animation);
+  ozz::memory::default_allocator()->Delete(unknown);
+  ozz::memory::default_allocator()->Delete(reparented);
+  ozz::memory::default_allocator()->Delete(renamed);
+  ozz::memory::default_allocator()->Delete(moved);
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
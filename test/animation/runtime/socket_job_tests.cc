@@ -0,0 +1,149 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#include "ozz/animation/runtime/socket_job.h"
+
+#include "gtest/gtest.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/simd_math.h"
+
+using ozz::animation::SocketJob;
+
+TEST(JobValidity, SocketJob) {
+  const ozz::math::Float4x4 matrices[3] = {ozz::math::Float4x4::identity(),
+                                           ozz::math::Float4x4::identity(),
+                                           ozz::math::Float4x4::identity()};
+  const ozz::Range<const ozz::math::Float4x4> models[2] = {
+      ozz::Range<const ozz::math::Float4x4>(matrices, 3),
+      ozz::Range<const ozz::math::Float4x4>(matrices, 1)};
+  const SocketJob::Socket sockets[2] = {{0, 2}, {1, 0}};
+  ozz::math::Float4x4 output[2];
+
+  {  // Default is valid.
+    SocketJob job;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+
+  SocketJob valid;
+  valid.sockets = sockets;
+  valid.offsets = ozz::Range<const ozz::math::Float4x4>(matrices, 2);
+  valid.models = models;
+  valid.output = output;
+  EXPECT_TRUE(valid.Validate());
+  EXPECT_TRUE(valid.Run());
+
+  {  // Optional transforms.
+    SocketJob job = valid;
+    job.transforms = ozz::Range<const ozz::math::Float4x4>(matrices, 2);
+    EXPECT_TRUE(job.Validate());
+    job.transforms = ozz::Range<const ozz::math::Float4x4>(matrices, 1);
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Offsets and output too small.
+    SocketJob job = valid;
+    job.offsets = ozz::Range<const ozz::math::Float4x4>(matrices, 1);
+    EXPECT_FALSE(job.Validate());
+    job = valid;
+    job.output = ozz::Range<ozz::math::Float4x4>(output, 1);
+    EXPECT_FALSE(job.Validate());
+  }
+
+  {  // Character out of range.
+    SocketJob job = valid;
+    job.models = ozz::Range<const ozz::Range<const ozz::math::Float4x4> >(
+        models, 1);
+    EXPECT_FALSE(job.Validate());
+
+    const SocketJob::Socket negative[1] = {{-1, 0}};
+    job = valid;
+    job.sockets = negative;
+    EXPECT_FALSE(job.Validate());
+  }
+
+  {  // Joint out of range.
+    const SocketJob::Socket invalid[2] = {{0, 2}, {1, 1}};
+    SocketJob job = valid;
+    job.sockets = invalid;
+    EXPECT_FALSE(job.Validate());
+
+    const SocketJob::Socket negative[1] = {{0, -1}};
+    job.sockets = negative;
+    EXPECT_FALSE(job.Validate());
+  }
+}
+
+TEST(Evaluate, SocketJob) {
+  // 2 characters of 2 joints.
+  const ozz::math::Float4x4 matrices[2][2] = {
+      {ozz::math::Float4x4::Translation(
+           ozz::math::simd_float4::Load(1.f, 2.f, 3.f, 0.f)),
+       ozz::math::Float4x4::FromAxisAngle(
+           ozz::math::simd_float4::y_axis(),
+           ozz::math::simd_float4::Load1(ozz::math::kPi_2))},
+      {ozz::math::Float4x4::Scaling(
+           ozz::math::simd_float4::Load(2.f, 2.f, 2.f, 1.f)),
+       ozz::math::Float4x4::identity()}};
+  const ozz::Range<const ozz::math::Float4x4> models[2] = {matrices[0],
+                                                          matrices[1]};
+  const ozz::math::Float4x4 transforms[2] = {
+      ozz::math::Float4x4::identity(),
+      ozz::math::Float4x4::Translation(
+          ozz::math::simd_float4::Load(0.f, 0.f, 10.f, 0.f))};
+
+  const SocketJob::Socket sockets[3] = {{0, 0}, {0, 1}, {1, 0}};
+  const ozz::math::Float4x4 offset = ozz::math::Float4x4::Translation(
+      ozz::math::simd_float4::Load(0.f, 0.f, 1.f, 0.f));
+  const ozz::math::Float4x4 offsets[3] = {offset, offset, offset};
+  ozz::math::Float4x4 output[3];
+
+  SocketJob job;
+  job.sockets = sockets;
+  job.offsets = offsets;
+  job.models = models;
+  job.output = output;
+
+  // Model-space.
+  ASSERT_TRUE(job.Run());
+  EXPECT_FLOAT4x4_EQ(output[0], 1.f, 0.f, 0.f, 0.f, 0.f, 1.f, 0.f, 0.f, 0.f,
+                     0.f, 1.f, 0.f, 1.f, 2.f, 4.f, 1.f);
+  EXPECT_FLOAT4x4_EQ(output[1], 0.f, 0.f, -1.f, 0.f, 0.f, 1.f, 0.f, 0.f, 1.f,
+                     0.f, 0.f, 0.f, 1.f, 0.f, 0.f, 1.f);
+  EXPECT_FLOAT4x4_EQ(output[2], 2.f, 0.f, 0.f, 0.f, 0.f, 2.f, 0.f, 0.f, 0.f,
+                     0.f, 2.f, 0.f, 0.f, 0.f, 2.f, 1.f);
+
+  // World-space.
+  job.transforms = transforms;
+  ASSERT_TRUE(job.Run());
+  EXPECT_FLOAT4x4_EQ(output[0], 1.f, 0.f, 0.f, 0.f, 0.f, 1.f, 0.f, 0.f, 0.f,
+                     0.f, 1.f, 0.f, 1.f, 2.f, 4.f, 1.f);
+  EXPECT_FLOAT4x4_EQ(output[2], 2.f, 0.f, 0.f, 0.f, 0.f, 2.f, 0.f, 0.f, 0.f,
+                     0.f, 2.f, 0.f, 0.f, 0.f, 12.f, 1.f);
+}
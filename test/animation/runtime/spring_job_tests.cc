@@ -0,0 +1,205 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#include "ozz/animation/runtime/spring_job.h"
+
+#include <cmath>
+
+#include "gtest/gtest.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/soa_transform.h"
+
+using ozz::animation::SoaSpringState;
+using ozz::animation::SpringJob;
+
+TEST(JobValidity, SpringJob) {
+  ozz::math::SoaTransform transforms[2];
+  const ozz::math::SimdFloat4 params[2] = {ozz::math::simd_float4::one(),
+                                           ozz::math::simd_float4::one()};
+  SoaSpringState states[2];
+
+  {  // Default is valid.
+    SpringJob job;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+
+  SpringJob valid;
+  valid.dt = 1.f / 30.f;
+  valid.stiffness = params;
+  valid.damping = params;
+  valid.states = states;
+  valid.output = transforms;
+  EXPECT_TRUE(valid.Validate());
+
+  {  // Negative dt.
+    SpringJob job = valid;
+    job.dt = -1.f;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Buffers too small.
+    SpringJob job = valid;
+    job.stiffness.end--;
+    EXPECT_FALSE(job.Validate());
+    job = valid;
+    job.damping.end--;
+    EXPECT_FALSE(job.Validate());
+    job = valid;
+    job.states.end--;
+    EXPECT_FALSE(job.Validate());
+    job.output.end--;
+    EXPECT_TRUE(job.Validate());
+  }
+}
+
+TEST(Simulate, SpringJob) {
+  // Lane 0 is critically damped, lane 1 under damped, lane 2 stiff and lane 3
+  // isn't simulated.
+  const ozz::math::SimdFloat4 stiffness[1] = {
+      ozz::math::simd_float4::Load(100.f, 100.f, 10000.f, 0.f)};
+  const ozz::math::SimdFloat4 damping[1] = {
+      ozz::math::simd_float4::Load(20.f, 2.f, 200.f, 20.f)};
+  SoaSpringState states[1];
+  ozz::math::SoaTransform pose[1] = {ozz::math::SoaTransform::identity()};
+
+  SpringJob job;
+  job.dt = 1.f / 60.f;
+  job.reset = true;
+  job.stiffness = stiffness;
+  job.damping = damping;
+  job.states = states;
+  job.output = pose;
+
+  // Reset outputs animated pose.
+  ASSERT_TRUE(job.Run());
+  EXPECT_SOAFLOAT3_EQ(pose[0].translation, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f,
+                      0.f, 0.f, 0.f, 0.f, 0.f);
+  job.reset = false;
+
+  // Target moves to x = 1, and rotates 90 degrees around y.
+  const ozz::math::SimdFloat4 one = ozz::math::simd_float4::one();
+  const ozz::math::SimdFloat4 half_sqrt2 =
+      ozz::math::simd_float4::Load1(.70710677f);
+  ozz::math::SoaTransform target = ozz::math::SoaTransform::identity();
+  target.translation.x = one;
+  target.rotation.y = half_sqrt2;
+  target.rotation.w = half_sqrt2;
+
+  float max_x[4] = {0.f, 0.f, 0.f, 0.f};
+  for (int f = 0; f < 120; ++f) {
+    pose[0] = target;
+    ASSERT_TRUE(job.Run());
+
+    float x[4];
+    ozz::math::StorePtrU(pose[0].translation.x, x);
+    for (int l = 0; l < 4; ++l) {
+      max_x[l] = x[l] > max_x[l] ? x[l] : max_x[l];
+    }
+    if (f == 0) {
+      // Simulated joints lag behind the animation, stiffer ones less.
+      EXPECT_GT(x[0], 0.f);
+      EXPECT_LT(x[0], .1f);
+      EXPECT_GT(x[2], .3f);
+      EXPECT_LT(x[2], 1.f);
+      // Non simulated lane follows animation.
+      EXPECT_FLOAT_EQ(x[3], 1.f);
+    }
+    // Rotations are kept normalized.
+    EXPECT_SIMDINT_EQ(ozz::math::IsNormalizedEst(pose[0].rotation), -1, -1,
+                      -1, -1);
+  }
+
+  // Critical damping doesn't overshoot, under damping does.
+  EXPECT_LE(max_x[0], 1.f + 1e-5f);
+  EXPECT_GT(max_x[1], 1.1f);
+
+  // Springs converged.
+  for (int f = 0; f < 600; ++f) {
+    pose[0] = target;
+    ASSERT_TRUE(job.Run());
+  }
+  EXPECT_SOAFLOAT3_EQ_EST(pose[0].translation, 1.f, 1.f, 1.f, 1.f, 0.f, 0.f,
+                          0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+  EXPECT_SOAQUATERNION_EQ_EST(pose[0].rotation, 0.f, 0.f, 0.f, 0.f,
+                              .70710677f, .70710677f, .70710677f, .70710677f,
+                              0.f, 0.f, 0.f, 0.f, .70710677f, .70710677f,
+                              .70710677f, .70710677f);
+
+  // Opposed quaternion target is the same rotation, which doesn't excite
+  // springs.
+  pose[0] = target;
+  pose[0].rotation = -target.rotation;
+  ASSERT_TRUE(job.Run());
+  EXPECT_SOAQUATERNION_EQ_EST(pose[0].rotation, 0.f, 0.f, 0.f, 0.f,
+                              .70710677f, .70710677f, .70710677f, -.70710677f,
+                              0.f, 0.f, 0.f, 0.f, .70710677f, .70710677f,
+                              .70710677f, -.70710677f);
+
+  // Reset snaps back to animation.
+  pose[0] = ozz::math::SoaTransform::identity();
+  job.reset = true;
+  ASSERT_TRUE(job.Run());
+  EXPECT_SOAFLOAT3_EQ(pose[0].translation, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f,
+                      0.f, 0.f, 0.f, 0.f, 0.f);
+  EXPECT_SOAFLOAT3_EQ(states[0].velocity, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f,
+                      0.f, 0.f, 0.f, 0.f, 0.f);
+}
+
+TEST(Stability, SpringJob) {
+  // Very stiff springs with a big time step remain stable: oscillations
+  // around the target don't grow.
+  const ozz::math::SimdFloat4 stiffness[1] = {
+      ozz::math::simd_float4::Load1(1e6f)};
+  const ozz::math::SimdFloat4 damping[1] = {
+      ozz::math::simd_float4::Load1(0.f)};
+  SoaSpringState states[1];
+  ozz::math::SoaTransform pose[1] = {ozz::math::SoaTransform::identity()};
+
+  SpringJob job;
+  job.dt = .5f;
+  job.reset = true;
+  job.stiffness = stiffness;
+  job.damping = damping;
+  job.states = states;
+  job.output = pose;
+  ASSERT_TRUE(job.Run());
+  job.reset = false;
+
+  for (int f = 0; f < 100; ++f) {
+    pose[0] = ozz::math::SoaTransform::identity();
+    pose[0].translation.y = ozz::math::simd_float4::Load1(10.f);
+    ASSERT_TRUE(job.Run());
+    float y[4];
+    ozz::math::StorePtrU(pose[0].translation.y, y);
+    for (int l = 0; l < 4; ++l) {
+      EXPECT_TRUE(std::abs(y[l] - 10.f) <= 10.f);
+    }
+  }
+}
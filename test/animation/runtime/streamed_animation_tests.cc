@@ -0,0 +1,189 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#include "ozz/animation/runtime/streamed_animation.h"
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/io/archive.h"
+#include "ozz/base/io/stream.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/allocator.h"
+
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/sampling_job.h"
+#include "ozz/animation/runtime/segmented_sampling_job.h"
+
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/raw_animation_utils.h"
+
+using ozz::animation::Animation;
+using ozz::animation::SamplingCache;
+using ozz::animation::SegmentedSamplingJob;
+using ozz::animation::StreamedAnimation;
+using ozz::animation::offline::AnimationBuilder;
+using ozz::animation::offline::RawAnimation;
+
+namespace {
+// Writes a 4s animation, split in 1s segments, to _stream.
+void WriteAnimation(ozz::io::Stream* _stream) {
+  RawAnimation raw;
+  raw.duration = 4.f;
+  raw.tracks.resize(1);
+  const RawAnimation::TranslationKey tkeys[] = {
+      {0.f, ozz::math::Float3(0.f, 0.f, 0.f)},
+      {4.f, ozz::math::Float3(4.f, 0.f, 0.f)}};
+  raw.tracks[0].translations.assign(tkeys, tkeys + OZZ_ARRAY_SIZE(tkeys));
+
+  ozz::Vector<RawAnimation>::Std raw_segments;
+  ASSERT_TRUE(
+      ozz::animation::offline::SplitAnimation(raw, 1.f, &raw_segments));
+  ASSERT_EQ(raw_segments.size(), 4u);
+
+  AnimationBuilder builder;
+  Animation* segments[4];
+  for (size_t i = 0; i < raw_segments.size(); ++i) {
+    segments[i] = builder(raw_segments[i]);
+    ASSERT_TRUE(segments[i] != NULL);
+  }
+
+  ozz::io::OArchive o(_stream);
+  const Animation* invalid[] = {segments[0], NULL};
+  EXPECT_FALSE(StreamedAnimation::Save(o, 4.f, 1.f, invalid));
+  _stream->Seek(0, ozz::io::Stream::kSet);
+
+  ozz::io::OArchive o2(_stream);
+  const Animation* const* begin = segments;
+  EXPECT_TRUE(StreamedAnimation::Save(
+      o2, 4.f, 1.f,
+      ozz::Range<const Animation* const>(begin, OZZ_ARRAY_SIZE(segments))));
+
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(segments); ++i) {
+    ozz::memory::default_allocator()->Delete(segments[i]);
+  }
+}
+}  // namespace
+
+TEST(Open, StreamedAnimation) {
+  StreamedAnimation streamed;
+  EXPECT_FALSE(streamed.opened());
+  EXPECT_FALSE(streamed.Update(0.f));
+  EXPECT_FALSE(streamed.Prefetch());
+  EXPECT_EQ(streamed.num_segments(), 0);
+  EXPECT_TRUE(streamed.segments().begin == NULL);
+
+  ozz::io::MemoryStream stream;
+  EXPECT_FALSE(streamed.Open(NULL));
+
+  {  // Not a streamed animation.
+    ozz::io::OArchive o(&stream);
+    o << 46.f;
+    stream.Seek(0, ozz::io::Stream::kSet);
+    EXPECT_FALSE(streamed.Open(&stream));
+  }
+
+  stream.Seek(0, ozz::io::Stream::kSet);
+  WriteAnimation(&stream);
+
+  stream.Seek(0, ozz::io::Stream::kSet);
+  EXPECT_FALSE(streamed.Open(&stream, 0));
+
+  stream.Seek(0, ozz::io::Stream::kSet);
+  ASSERT_TRUE(streamed.Open(&stream, 2));
+  EXPECT_TRUE(streamed.opened());
+  EXPECT_FLOAT_EQ(streamed.duration(), 4.f);
+  EXPECT_FLOAT_EQ(streamed.segment_duration(), 1.f);
+  EXPECT_EQ(streamed.num_segments(), 4);
+  EXPECT_EQ(streamed.window_size(), 2);
+  EXPECT_EQ(streamed.num_resident_segments(), 0);
+
+  streamed.Close();
+  EXPECT_FALSE(streamed.opened());
+  EXPECT_EQ(streamed.num_segments(), 0);
+}
+
+TEST(Stream, StreamedAnimation) {
+  ozz::io::MemoryStream stream;
+  WriteAnimation(&stream);
+  stream.Seek(0, ozz::io::Stream::kSet);
+
+  StreamedAnimation streamed;
+  ASSERT_TRUE(streamed.Open(&stream, 2));
+
+  SamplingCache cache(1);
+  ozz::math::SoaTransform output[1];
+  SegmentedSamplingJob job;
+  job.duration = streamed.duration();
+  job.segment_duration = streamed.segment_duration();
+  job.cache = &cache;
+  job.output = output;
+
+  // Nothing to prefetch before the first update.
+  EXPECT_FALSE(streamed.Prefetch());
+
+  // Only the required segment is loaded by Update().
+  ASSERT_TRUE(streamed.Update(.1f));
+  EXPECT_EQ(streamed.num_resident_segments(), 1);
+  EXPECT_TRUE(streamed.segments().begin[0] != NULL);
+
+  job.ratio = .1f;
+  job.segments = streamed.segments();
+  ASSERT_TRUE(job.Run());
+  EXPECT_NEAR(ozz::math::GetX(output[0].translation.x), .4f, 1e-3f);
+
+  // Next segment is prefetched.
+  EXPECT_TRUE(streamed.Prefetch());
+  EXPECT_EQ(streamed.num_resident_segments(), 2);
+  EXPECT_TRUE(streamed.segments().begin[1] != NULL);
+  EXPECT_FALSE(streamed.Prefetch());
+
+  // Moving to next segment doesn't load anything, first one is unloaded.
+  ASSERT_TRUE(streamed.Update(.3f));
+  EXPECT_EQ(streamed.num_resident_segments(), 1);
+  EXPECT_TRUE(streamed.segments().begin[0] == NULL);
+  EXPECT_TRUE(streamed.Prefetch());
+  EXPECT_TRUE(streamed.segments().begin[2] != NULL);
+
+  job.ratio = .3f;
+  job.segments = streamed.segments();
+  ASSERT_TRUE(job.Run());
+  EXPECT_NEAR(ozz::math::GetX(output[0].translation.x), 1.2f, 1e-3f);
+
+  // Seeks to last segment, window wraps to the first one.
+  ASSERT_TRUE(streamed.Update(.9f));
+  EXPECT_EQ(streamed.num_resident_segments(), 1);
+  EXPECT_TRUE(streamed.Prefetch());
+  EXPECT_TRUE(streamed.segments().begin[0] != NULL);
+  EXPECT_TRUE(streamed.segments().begin[3] != NULL);
+
+  job.ratio = .9f;
+  job.segments = streamed.segments();
+  ASSERT_TRUE(job.Run());
+  EXPECT_NEAR(ozz::math::GetX(output[0].translation.x), 3.6f, 1e-3f);
+}
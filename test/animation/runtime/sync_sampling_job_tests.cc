@@ -0,0 +1,209 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/sync_sampling_job.h"
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/allocator.h"
+
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/raw_animation_utils.h"
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/sampling_job.h"
+
+using ozz::animation::Animation;
+using ozz::animation::SamplingCache;
+using ozz::animation::SyncSamplingJob;
+using ozz::animation::offline::AnimationBuilder;
+using ozz::animation::offline::RawAnimation;
+using ozz::animation::offline::RawFloatTrack;
+using ozz::animation::offline::RawTrackInterpolation;
+
+namespace {
+// Builds a 1 track animation whose translation x goes from 0 to 1 over
+// _duration, with _num_markers markers at _markers times.
+Animation* BuildAnimation(float _duration, const float* _markers,
+                          int _num_markers) {
+  RawAnimation raw_animation;
+  raw_animation.duration = _duration;
+  raw_animation.tracks.resize(1);
+  const RawAnimation::TranslationKey t0 = {0.f,
+                                           ozz::math::Float3(0.f, 0.f, 0.f)};
+  raw_animation.tracks[0].translations.push_back(t0);
+  const RawAnimation::TranslationKey t1 = {_duration,
+                                           ozz::math::Float3(1.f, 0.f, 0.f)};
+  raw_animation.tracks[0].translations.push_back(t1);
+  raw_animation.sync_markers.assign(_markers, _markers + _num_markers);
+
+  AnimationBuilder builder;
+  return builder(raw_animation);
+}
+}  // namespace
+
+TEST(Markers, SyncSamplingJob) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 2.f;
+  EXPECT_TRUE(raw_animation.Validate());
+
+  // Markers must be sorted and within animation duration.
+  raw_animation.sync_markers.push_back(1.f);
+  raw_animation.sync_markers.push_back(.5f);
+  EXPECT_FALSE(raw_animation.Validate());
+  raw_animation.sync_markers[1] = 3.f;
+  EXPECT_FALSE(raw_animation.Validate());
+  raw_animation.sync_markers[1] = 1.5f;
+  EXPECT_TRUE(raw_animation.Validate());
+
+  // Builder converts them to ratios.
+  AnimationBuilder builder;
+  Animation* animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+  ASSERT_EQ(animation->num_sync_markers(), 2);
+  EXPECT_FLOAT_EQ(animation->sync_ratios()[0], .5f);
+  EXPECT_FLOAT_EQ(animation->sync_ratios()[1], .75f);
+  ozz::memory::default_allocator()->Delete(animation);
+
+  // Extracts markers from a contact track.
+  RawFloatTrack track;
+  const RawFloatTrack::Keyframe keys[] = {
+      {RawTrackInterpolation::kLinear, 0.f, 0.f},
+      {RawTrackInterpolation::kStep, .5f, 1.f},
+      {RawTrackInterpolation::kStep, .6f, 0.f},
+      {RawTrackInterpolation::kLinear, .8f, 1.f},
+      {RawTrackInterpolation::kLinear, 1.f, 1.f}};
+  track.keyframes.assign(keys, keys + OZZ_ARRAY_SIZE(keys));
+  EXPECT_TRUE(
+      ozz::animation::offline::ExtractSyncMarkers(track, .5f, &raw_animation));
+  ASSERT_EQ(raw_animation.sync_markers.size(), 2u);
+  EXPECT_FLOAT_EQ(raw_animation.sync_markers[0], .5f);
+  EXPECT_FLOAT_EQ(raw_animation.sync_markers[1], 1.6f);
+  EXPECT_TRUE(raw_animation.Validate());
+}
+
+TEST(Phase, SyncSamplingJob) {
+  // No marker, ratio is phase.
+  Animation* none = BuildAnimation(1.f, NULL, 0);
+  ASSERT_TRUE(none != NULL);
+  EXPECT_FLOAT_EQ(ozz::animation::PhaseToRatio(*none, .3f), .3f);
+  EXPECT_FLOAT_EQ(ozz::animation::PhaseToRatio(*none, 1.3f), .3f);
+  EXPECT_FLOAT_EQ(ozz::animation::PhaseToRatio(*none, -.25f), .75f);
+  EXPECT_FLOAT_EQ(ozz::animation::RatioToPhase(*none, .3f), .3f);
+
+  // Markers at ratios .2 and .7.
+  const float markers[] = {.2f, .7f};
+  Animation* walk = BuildAnimation(1.f, markers, 2);
+  ASSERT_TRUE(walk != NULL);
+  const float expected[][2] = {{0.f, .2f},  {.25f, .45f}, {.5f, .7f},
+                               {.75f, .95f}, {.9f, .1f},  {1.f, .2f}};
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(expected); ++i) {
+    EXPECT_NEAR(ozz::animation::PhaseToRatio(*walk, expected[i][0]),
+                expected[i][1], 1e-5f);
+    EXPECT_NEAR(ozz::animation::RatioToPhase(*walk, expected[i][1]),
+                ozz::animation::PhaseToRatio(*none, expected[i][0]), 1e-5f);
+  }
+
+  ozz::memory::default_allocator()->Delete(none);
+  ozz::memory::default_allocator()->Delete(walk);
+}
+
+TEST(Sampling, SyncSamplingJob) {
+  const float walk_markers[] = {.2f, .7f};
+  Animation* walk = BuildAnimation(1.f, walk_markers, 2);
+  ASSERT_TRUE(walk != NULL);
+  const float run_markers[] = {0.f, .3f};
+  Animation* run = BuildAnimation(.5f, run_markers, 2);
+  ASSERT_TRUE(run != NULL);
+  const float other_markers[] = {0.f};
+  Animation* other = BuildAnimation(.5f, other_markers, 1);
+  ASSERT_TRUE(other != NULL);
+
+  SamplingCache walk_cache(1);
+  SamplingCache run_cache(1);
+  ozz::math::SoaTransform walk_output[1];
+  ozz::math::SoaTransform run_output[1];
+
+  SyncSamplingJob::Layer layers[2];
+  layers[0].animation = walk;
+  layers[0].cache = &walk_cache;
+  layers[0].weight = .5f;
+  layers[0].output.begin = walk_output;
+  layers[0].output.end = walk_output + 1;
+  layers[1].animation = run;
+  layers[1].cache = &run_cache;
+  layers[1].weight = .5f;
+  layers[1].output.begin = run_output;
+  layers[1].output.end = run_output + 1;
+
+  SyncSamplingJob job;
+  EXPECT_TRUE(job.Validate());  // No layer.
+  EXPECT_FLOAT_EQ(job.CycleDuration(), 0.f);
+
+  job.layers = ozz::Range<const SyncSamplingJob::Layer>(layers, 2);
+  EXPECT_TRUE(job.Validate());
+  EXPECT_FLOAT_EQ(job.CycleDuration(), .75f);
+
+  // Sampled at matched phases.
+  job.phase = .75f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_SOAFLOAT3_EQ_EST(walk_output[0].translation, .95f, 0.f, 0.f, 0.f, 0.f,
+                          0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+  EXPECT_SOAFLOAT3_EQ_EST(run_output[0].translation, .8f, 0.f, 0.f, 0.f, 0.f,
+                          0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+
+  // Null weight layers aren't sampled.
+  layers[1].weight = 0.f;
+  EXPECT_FLOAT_EQ(job.CycleDuration(), 1.f);
+  job.phase = .25f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_SOAFLOAT3_EQ_EST(walk_output[0].translation, .45f, 0.f, 0.f, 0.f, 0.f,
+                          0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+  EXPECT_SOAFLOAT3_EQ_EST(run_output[0].translation, .8f, 0.f, 0.f, 0.f, 0.f,
+                          0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+
+  // Invalid weight.
+  layers[1].weight = -1.f;
+  EXPECT_FALSE(job.Validate());
+  layers[1].weight = 1.f;
+
+  // Mismatching markers.
+  layers[1].animation = other;
+  EXPECT_FALSE(job.Validate());
+  EXPECT_FALSE(job.Run());
+
+  // Missing cache.
+  layers[1].animation = run;
+  layers[1].cache = NULL;
+  EXPECT_FALSE(job.Validate());
+
+  ozz::memory::default_allocator()->Delete(walk);
+  ozz::memory::default_allocator()->Delete(run);
+  ozz::memory::default_allocator()->Delete(other);
+}
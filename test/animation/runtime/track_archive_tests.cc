@@ -27,6 +27,8 @@
 
 #include "ozz/animation/runtime/track.h"
 
+#include "ozz/animation/runtime/quantized_track.h"
+
 #include "gtest/gtest.h"
 #include "ozz/base/maths/gtest_math_helper.h"
 
@@ -35,6 +37,7 @@
 #include "ozz/base/memory/allocator.h"
 
 #include "ozz/animation/runtime/track_sampling_job.h"
+#include "ozz/animation/runtime/track_set.h"
 
 #include "ozz/animation/offline/raw_track.h"
 #include "ozz/animation/offline/track_builder.h"
@@ -467,3 +470,126 @@ TEST(AlreadyInitialized, TrackSerialize) {
     ASSERT_TRUE(i_track.size() > size);
   }
 }
+
+TEST(TrackSet, TrackSerialize) {
+  // Builds a valid track set.
+  ozz::animation::TrackSet* o_set = NULL;
+  {
+    TrackBuilder builder;
+    ozz::animation::offline::RawTrackSet raw_set;
+    raw_set.name = "test name";
+    raw_set.channels.resize(2);
+
+    const RawFloatTrack::Keyframe key0 = {RawTrackInterpolation::kStep, .5f,
+                                          46.f};
+    raw_set.channels[0].keyframes.push_back(key0);
+    const RawFloatTrack::Keyframe key1 = {RawTrackInterpolation::kLinear, .7f,
+                                          0.f};
+    raw_set.channels[0].keyframes.push_back(key1);
+    const RawFloatTrack::Keyframe key2 = {RawTrackInterpolation::kLinear, .2f,
+                                          2.f};
+    raw_set.channels[1].keyframes.push_back(key2);
+
+    o_set = builder(raw_set);
+    ASSERT_TRUE(o_set != NULL);
+  }
+
+  for (int e = 0; e < 2; ++e) {
+    ozz::Endianness endianess = e == 0 ? ozz::kBigEndian : ozz::kLittleEndian;
+    ozz::io::MemoryStream stream;
+
+    // Streams out.
+    ozz::io::OArchive o(&stream, endianess);
+    o << *o_set;
+
+    // Streams in.
+    stream.Seek(0, ozz::io::Stream::kSet);
+    ozz::io::IArchive i(&stream);
+
+    ozz::animation::TrackSet i_set;
+    i >> i_set;
+
+    EXPECT_EQ(o_set->size(), i_set.size());
+    EXPECT_STREQ(o_set->name(), i_set.name());
+    EXPECT_EQ(i_set.num_channels(), 2);
+    ASSERT_EQ(o_set->num_keys(), i_set.num_keys());
+
+    // Samples and compares the two track sets.
+    ozz::animation::TrackSetSamplingJob sampling;
+    sampling.track_set = &i_set;
+    float results[2];
+    sampling.results = results;
+
+    sampling.ratio = 0.f;
+    ASSERT_TRUE(sampling.Run());
+    EXPECT_FLOAT_EQ(results[0], 46.f);
+    EXPECT_FLOAT_EQ(results[1], 2.f);
+
+    sampling.ratio = .6f;
+    ASSERT_TRUE(sampling.Run());
+    EXPECT_FLOAT_EQ(results[0], 46.f);
+    EXPECT_FLOAT_EQ(results[1], 2.f);
+
+    sampling.ratio = .85f;
+    ASSERT_TRUE(sampling.Run());
+    EXPECT_FLOAT_EQ(results[0], 0.f);
+    EXPECT_FLOAT_EQ(results[1], 2.f);
+  }
+  ozz::memory::default_allocator()->Delete(o_set);
+}
+
+TEST(Quantized, TrackSerialize) {
+  for (int size = 1; size <= 2; ++size) {
+    // Builds a valid track, with 8 or 16 bits values.
+    ozz::animation::QuantizedFloat3Track* o_track = NULL;
+    {
+      TrackBuilder builder;
+      builder.tolerance = size == 1 ? 1.f : 1e-3f;
+      RawFloat3Track raw_track;
+      raw_track.name = "quantized";
+
+      const RawFloat3Track::Keyframe key0 = {RawTrackInterpolation::kLinear,
+                                             0.f, ozz::math::Float3(0.f)};
+      raw_track.keyframes.push_back(key0);
+      const RawFloat3Track::Keyframe key1 = {
+          RawTrackInterpolation::kStep, .5f,
+          ozz::math::Float3(46.f, -10.f, 1.f)};
+      raw_track.keyframes.push_back(key1);
+      const RawFloat3Track::Keyframe key2 = {
+          RawTrackInterpolation::kLinear, .7f,
+          ozz::math::Float3(20.f, 10.f, 1.f)};
+      raw_track.keyframes.push_back(key2);
+
+      o_track = builder.Quantize(raw_track);
+      ASSERT_TRUE(o_track != NULL);
+      EXPECT_EQ(o_track->value_size(), size);
+    }
+
+    for (int e = 0; e < 2; ++e) {
+      ozz::Endianness endianess = e == 0 ? ozz::kBigEndian : ozz::kLittleEndian;
+      ozz::io::MemoryStream stream;
+
+      // Streams out.
+      ozz::io::OArchive o(&stream, endianess);
+      o << *o_track;
+
+      // Streams in.
+      stream.Seek(0, ozz::io::Stream::kSet);
+      ozz::io::IArchive i(&stream);
+
+      ozz::animation::QuantizedFloat3Track i_track;
+      i >> i_track;
+
+      EXPECT_EQ(o_track->size(), i_track.size());
+      EXPECT_STREQ(o_track->name(), i_track.name());
+      EXPECT_EQ(o_track->value_size(), i_track.value_size());
+      ASSERT_EQ(o_track->ratios().count(), i_track.ratios().count());
+      for (size_t k = 0; k < i_track.ratios().count(); ++k) {
+        EXPECT_EQ(o_track->ratios()[k], i_track.ratios()[k]);
+        const ozz::math::Float3 o_value = o_track->value(k);
+        EXPECT_FLOAT3_EQ(i_track.value(k), o_value.x, o_value.y, o_value.z);
+      }
+    }
+    ozz::memory::default_allocator()->Delete(o_track);
+  }
+}
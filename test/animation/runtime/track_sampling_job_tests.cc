@@ -36,6 +36,7 @@
 #include "ozz/animation/offline/track_builder.h"
 
 #include "ozz/animation/runtime/track.h"
+#include "ozz/animation/runtime/track_set.h"
 
 using ozz::animation::FloatTrack;
 using ozz::animation::FloatTrackSamplingJob;
@@ -475,3 +476,275 @@ TEST(Quaternion, TrackSamplingJob) {
 
   ozz::memory::default_allocator()->Delete(track);
 }
+
+TEST(Batch, TrackSamplingJob) {
+  TrackBuilder builder;
+
+  // Builds tracks with different numbers of keyframes and interpolations.
+  const int kNumTracks = 4;
+  FloatTrack* tracks[kNumTracks];
+  for (int t = 0; t < kNumTracks; ++t) {
+    RawFloatTrack raw_track;
+    const int num_keys = t * 7;
+    for (int k = 0; k < num_keys; ++k) {
+      const RawFloatTrack::Keyframe key = {
+          k % 3 == 0 ? RawTrackInterpolation::kStep
+                     : RawTrackInterpolation::kLinear,
+          static_cast<float>(k) / num_keys, static_cast<float>(k * t % 5)};
+      raw_track.keyframes.push_back(key);
+    }
+    tracks[t] = builder(raw_track);
+    ASSERT_TRUE(tracks[t] != NULL);
+  }
+  FloatTrack default_track;
+  const FloatTrack* const const_tracks[kNumTracks + 1] = {
+      tracks[0], tracks[1], tracks[2], tracks[3], &default_track};
+
+  float results[kNumTracks + 1];
+  int cursors[kNumTracks + 1] = {0};
+
+  {  // Validity.
+    ozz::animation::FloatTrackBatchSamplingJob job;
+    EXPECT_TRUE(job.Validate());  // No track.
+    job.tracks = const_tracks;
+    EXPECT_FALSE(job.Validate());
+    job.results = ozz::Range<float>(results, kNumTracks);
+    EXPECT_FALSE(job.Validate());
+    job.results = results;
+    EXPECT_TRUE(job.Validate());
+    job.cursors = ozz::Range<int>(cursors, kNumTracks);
+    EXPECT_FALSE(job.Validate());
+    job.cursors = cursors;
+    EXPECT_TRUE(job.Validate());
+    const FloatTrack* const null_tracks[1] = {NULL};
+    job.tracks = null_tracks;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  // Forward and backward playback, seeks and out of bounds ratios.
+  const float ratios[] = {0.f,  .01f, .02f, .05f, .1f,  .2f,  .21f, .5f,
+                          .49f, .3f,  .9f,  1.f,  1.2f, .95f, -1.f, .66f,
+                          .0f,  .7f,  .71f, .72f, .1f,  1.f,  0.f};
+
+  for (int cached = 0; cached < 2; ++cached) {
+    ozz::animation::FloatTrackBatchSamplingJob job;
+    job.tracks = const_tracks;
+    job.results = results;
+    if (cached) {
+      job.cursors = cursors;
+    }
+    for (size_t r = 0; r < OZZ_ARRAY_SIZE(ratios); ++r) {
+      job.ratio = ratios[r];
+      ASSERT_TRUE(job.Run());
+      for (int t = 0; t < kNumTracks + 1; ++t) {
+        float expected;
+        FloatTrackSamplingJob reference;
+        reference.ratio = ratios[r];
+        reference.track = const_tracks[t];
+        reference.result = &expected;
+        ASSERT_TRUE(reference.Run());
+        EXPECT_FLOAT_EQ(results[t], expected);
+      }
+    }
+  }
+
+  for (int t = 0; t < kNumTracks; ++t) {
+    ozz::memory::default_allocator()->Delete(tracks[t]);
+  }
+}
+
+TEST(TrackSet, TrackSamplingJob) {
+  TrackBuilder builder;
+
+  // Builds channels with different keyframes and interpolations, both as
+  // independent tracks and as a track set.
+  const int kNumChannels = 5;
+  ozz::animation::offline::RawTrackSet raw_set;
+  raw_set.channels.resize(kNumChannels);
+  FloatTrack* tracks[kNumChannels];
+  for (int c = 0; c < kNumChannels; ++c) {
+    RawFloatTrack& raw_track = raw_set.channels[c];
+    const int num_keys = c * 3;
+    for (int k = 0; k < num_keys; ++k) {
+      const RawFloatTrack::Keyframe key = {
+          k % 2 == 0 ? RawTrackInterpolation::kStep
+                     : RawTrackInterpolation::kLinear,
+          static_cast<float>(k + 1) / (num_keys + 1),
+          static_cast<float>(k * c % 7)};
+      raw_track.keyframes.push_back(key);
+    }
+    tracks[c] = builder(raw_track);
+    ASSERT_TRUE(tracks[c] != NULL);
+  }
+  ozz::animation::TrackSet* set = builder(raw_set);
+  ASSERT_TRUE(set != NULL);
+  ASSERT_EQ(set->num_channels(), kNumChannels);
+
+  float results[kNumChannels];
+  int cursor = 0;
+
+  {  // Validity.
+    ozz::animation::TrackSetSamplingJob job;
+    EXPECT_FALSE(job.Validate());
+    job.track_set = set;
+    EXPECT_FALSE(job.Validate());
+    job.results = ozz::Range<float>(results, kNumChannels - 1);
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+    job.results = results;
+    EXPECT_TRUE(job.Validate());
+    job.cursor = &cursor;
+    EXPECT_TRUE(job.Validate());
+  }
+
+  {  // Default track set.
+    ozz::animation::TrackSet default_set;
+    ozz::animation::TrackSetSamplingJob job;
+    job.track_set = &default_set;
+    EXPECT_TRUE(job.Run());
+  }
+
+  // Forward and backward playback, seeks and out of bounds ratios.
+  const float ratios[] = {0.f,  .01f, .02f, .05f, .1f,  .2f,  .21f, .5f,
+                          .49f, .3f,  .9f,  1.f,  1.2f, .95f, -1.f, .66f,
+                          .0f,  .7f,  .71f, .72f, .1f,  1.f,  0.f};
+
+  for (int cached = 0; cached < 2; ++cached) {
+    ozz::animation::TrackSetSamplingJob job;
+    job.track_set = set;
+    job.results = results;
+    if (cached) {
+      job.cursor = &cursor;
+    }
+    for (size_t r = 0; r < OZZ_ARRAY_SIZE(ratios); ++r) {
+      job.ratio = ratios[r];
+      ASSERT_TRUE(job.Run());
+      for (int c = 0; c < kNumChannels; ++c) {
+        FloatTrackSamplingJob track_job;
+        track_job.ratio = ratios[r];
+        track_job.track = tracks[c];
+        float expected;
+        track_job.result = &expected;
+        ASSERT_TRUE(track_job.Run());
+        EXPECT_FLOAT_EQ(results[c], expected);
+      }
+    }
+  }
+
+  for (int c = 0; c < kNumChannels; ++c) {
+    ozz::memory::default_allocator()->Delete(tracks[c]);
+  }
+  ozz::memory::default_allocator()->Delete(set);
+}
+
+TEST(Soa, TrackSamplingJob) {
+  TrackBuilder builder;
+
+  // Builds 3 tracks of each type, 4th lane is NULL.
+  ozz::animation::Float3Track* float3_tracks[3];
+  ozz::animation::QuaternionTrack* quat_tracks[3];
+  for (int t = 0; t < 3; ++t) {
+    ozz::animation::offline::RawFloat3Track raw_float3;
+    ozz::animation::offline::RawQuaternionTrack raw_quat;
+    const int num_keys = t * 4;
+    for (int k = 0; k < num_keys; ++k) {
+      const RawTrackInterpolation::Value interp =
+          k % 3 == 0 ? RawTrackInterpolation::kStep
+                     : RawTrackInterpolation::kLinear;
+      const float ratio = static_cast<float>(k) / num_keys;
+      const float value = static_cast<float>(k * (t + 1) % 5);
+      const ozz::animation::offline::RawFloat3Track::Keyframe f3_key = {
+          interp, ratio, ozz::math::Float3(value, -value, 2.f * value)};
+      raw_float3.keyframes.push_back(f3_key);
+      const ozz::animation::offline::RawQuaternionTrack::Keyframe q_key = {
+          interp, ratio,
+          ozz::math::Quaternion::FromAxisAngle(ozz::math::Float3::y_axis(),
+                                               value)};
+      raw_quat.keyframes.push_back(q_key);
+    }
+    float3_tracks[t] = builder(raw_float3);
+    ASSERT_TRUE(float3_tracks[t] != NULL);
+    quat_tracks[t] = builder(raw_quat);
+    ASSERT_TRUE(quat_tracks[t] != NULL);
+  }
+
+  ozz::math::SoaFloat3 float3_result;
+  ozz::math::SoaQuaternion quat_result;
+  int cursors[4] = {0};
+
+  {  // Validity.
+    ozz::animation::Float3TrackSoaSamplingJob job;
+    EXPECT_FALSE(job.Validate());
+    job.result = &float3_result;
+    EXPECT_TRUE(job.Validate());
+    job.cursors = ozz::Range<int>(cursors, 3);
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+    job.cursors = cursors;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());  // All lanes are NULL.
+  }
+
+  const float ratios[] = {0.f, .1f, .2f, .26f, .5f, .4f, .9f, 1.f, 2.f, -1.f};
+
+  for (int cached = 0; cached < 2; ++cached) {
+    ozz::animation::Float3TrackSoaSamplingJob float3_job;
+    ozz::animation::QuaternionTrackSoaSamplingJob quat_job;
+    for (int t = 0; t < 3; ++t) {
+      float3_job.tracks[t] = float3_tracks[t];
+      quat_job.tracks[t] = quat_tracks[t];
+    }
+    float3_job.result = &float3_result;
+    quat_job.result = &quat_result;
+    int quat_cursors[4] = {0};
+    if (cached) {
+      float3_job.cursors = cursors;
+      quat_job.cursors = quat_cursors;
+    }
+
+    for (size_t r = 0; r < OZZ_ARRAY_SIZE(ratios); ++r) {
+      float3_job.ratio = quat_job.ratio = ratios[r];
+      ASSERT_TRUE(float3_job.Run());
+      ASSERT_TRUE(quat_job.Run());
+
+      float x[4], y[4], z[4], w[4];
+      ozz::math::StorePtrU(float3_result.x, x);
+      ozz::math::StorePtrU(float3_result.y, y);
+      ozz::math::StorePtrU(float3_result.z, z);
+      EXPECT_FLOAT3_EQ(ozz::math::Float3(x[3], y[3], z[3]), 0.f, 0.f, 0.f);
+      for (int t = 0; t < 3; ++t) {
+        ozz::animation::Float3TrackSamplingJob job;
+        job.ratio = ratios[r];
+        job.track = float3_tracks[t];
+        ozz::math::Float3 expected;
+        job.result = &expected;
+        ASSERT_TRUE(job.Run());
+        EXPECT_FLOAT3_EQ(ozz::math::Float3(x[t], y[t], z[t]), expected.x,
+                         expected.y, expected.z);
+      }
+
+      ozz::math::StorePtrU(quat_result.x, x);
+      ozz::math::StorePtrU(quat_result.y, y);
+      ozz::math::StorePtrU(quat_result.z, z);
+      ozz::math::StorePtrU(quat_result.w, w);
+      EXPECT_QUATERNION_EQ(ozz::math::Quaternion(x[3], y[3], z[3], w[3]), 0.f,
+                           0.f, 0.f, 1.f);
+      for (int t = 0; t < 3; ++t) {
+        ozz::animation::QuaternionTrackSamplingJob job;
+        job.ratio = ratios[r];
+        job.track = quat_tracks[t];
+        ozz::math::Quaternion expected;
+        job.result = &expected;
+        ASSERT_TRUE(job.Run());
+        EXPECT_QUATERNION_EQ(ozz::math::Quaternion(x[t], y[t], z[t], w[t]),
+                             expected.x, expected.y, expected.z, expected.w);
+      }
+    }
+  }
+
+  for (int t = 0; t < 3; ++t) {
+    ozz::memory::default_allocator()->Delete(float3_tracks[t]);
+    ozz::memory::default_allocator()->Delete(quat_tracks[t]);
+  }
+}
@@ -360,6 +360,62 @@ size_t CountEdges(TrackTriggeringJob::Iterator _begin,
   return count;
 }
 
+void TestEdgesIndex(const ozz::animation::FloatTrack& _track, float _threshold,
+                    const TrackTriggeringJob::Edge* _expected, size_t _size) {
+  // Computes edge index.
+  ozz::Vector<TrackTriggeringJob::Edge>::Std edges(_track.ratios().count());
+  EXPECT_EQ(ozz::animation::ComputeTrackEdges(
+                _track, _threshold, ozz::Range<TrackTriggeringJob::Edge>()),
+            edges.empty() ? 0 : -1);
+  if (edges.empty()) {
+    return;
+  }
+  const int num_edges = ozz::animation::ComputeTrackEdges(
+      _track, _threshold, ozz::make_range(edges));
+  ASSERT_EQ(static_cast<size_t>(num_edges), _size);
+  for (int i = 0; i < num_edges; ++i) {
+    EXPECT_FLOAT_EQ(edges[i].ratio, _expected[i].ratio);
+    EXPECT_EQ(edges[i].rising, _expected[i].rising);
+  }
+
+  // Indexed and non indexed iterations must output the same edges, in any
+  // direction and for any range.
+  const float ranges[][2] = {{0.f, 1.f},
+                             {1.f, 2.f},
+                             {0.f, 3.f},
+                             {-2.3f, 7.6f},
+                             {.3f, .3f},
+                             {-.5f, .5f},
+                             {_expected[0].ratio, _expected[_size - 1].ratio},
+                             {_expected[0].ratio, 5.f + _expected[1].ratio},
+                             {nexttowardf(_expected[0].ratio, 1.f), 1.f},
+                             {0.f, 1000.f}};
+  for (size_t r = 0; r < OZZ_ARRAY_SIZE(ranges) * 2; ++r) {
+    TrackTriggeringJob job;
+    job.track = &_track;
+    job.threshold = _threshold;
+    job.from = ranges[r / 2][r & 1];
+    job.to = ranges[r / 2][1 - (r & 1)];
+    TrackTriggeringJob::Iterator iterator;
+    job.iterator = &iterator;
+    ASSERT_TRUE(job.Run());
+
+    TrackTriggeringJob indexed_job = job;
+    indexed_job.edges = ozz::Range<const TrackTriggeringJob::Edge>(
+        &edges[0], static_cast<size_t>(num_edges));
+    TrackTriggeringJob::Iterator indexed_iterator;
+    indexed_job.iterator = &indexed_iterator;
+    ASSERT_TRUE(indexed_job.Run());
+
+    for (; iterator != job.end(); ++iterator, ++indexed_iterator) {
+      ASSERT_TRUE(indexed_iterator != indexed_job.end());
+      EXPECT_EQ(iterator->ratio, indexed_iterator->ratio);
+      EXPECT_EQ(iterator->rising, indexed_iterator->rising);
+    }
+    EXPECT_TRUE(indexed_iterator == indexed_job.end());
+  }
+}
+
 void TestEdgesExpectationBackward(TrackTriggeringJob::Iterator _fw_iterator,
                                   const TrackTriggeringJob& _fw_job) {
   // Compute forward edges;
@@ -932,6 +988,9 @@ void TestEdgesExpectation(
       }
     }
   }
+
+  TestEdgesIndex(*track, _threshold, _expected, _size);
+
   ozz::memory::default_allocator()->Delete(track);
 }
 
@@ -1418,3 +1477,90 @@ TEST(LinearThreshold, TrackEdgeTriggerJob) {
 
   ozz::memory::default_allocator()->Delete(track);
 }
+
+TEST(Batch, TrackEdgeTriggerJob) {
+  // Builds a square step track, rising at .5 and falling at 1.
+  ozz::animation::offline::RawFloatTrack raw_track;
+  const RawFloatTrack::Keyframe key0 = {RawTrackInterpolation::kStep, 0.f,
+                                        0.f};
+  raw_track.keyframes.push_back(key0);
+  const RawFloatTrack::Keyframe key1 = {RawTrackInterpolation::kStep, .5f,
+                                        2.f};
+  raw_track.keyframes.push_back(key1);
+  const RawFloatTrack::Keyframe key2 = {RawTrackInterpolation::kStep, 1.f,
+                                        0.f};
+  raw_track.keyframes.push_back(key2);
+  FloatTrack* track = TrackBuilder()(raw_track);
+  ASSERT_TRUE(track != NULL);
+
+  TrackTriggeringJob::Edge edges[3];
+  const int num_edges = ozz::animation::ComputeTrackEdges(*track, 1.f, edges);
+  ASSERT_EQ(num_edges, 2);
+
+  typedef ozz::animation::TrackBatchTriggeringJob::Query Query;
+  Query queries[4] = {{track, 0.f, 1.f, 1.f},
+                      {track, .2f, .2f, 1.f},
+                      {track, 2.f, -1.f, 1.f},
+                      {track, 0.f, 10.f, 1.f}};
+  queries[3].edges =
+      ozz::Range<const TrackTriggeringJob::Edge>(edges, num_edges);
+
+  ozz::animation::TrackBatchTriggeringJob::Event events[32];
+  size_t num_events = 0;
+
+  {  // Validity.
+    ozz::animation::TrackBatchTriggeringJob job;
+    EXPECT_FALSE(job.Validate());
+    job.num_events = &num_events;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+    EXPECT_EQ(num_events, 0u);
+
+    Query null_query = {NULL, 0.f, 1.f, 0.f};
+    job.queries = ozz::Range<const Query>(&null_query, 1);
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Runs all queries.
+    ozz::animation::TrackBatchTriggeringJob job;
+    job.queries = queries;
+    job.events = events;
+    job.num_events = &num_events;
+    ASSERT_TRUE(job.Run());
+    ASSERT_EQ(num_events, 2u + 0u + 6u + 20u);
+
+    // Compares with individual jobs.
+    size_t e = 0;
+    for (int q = 0; q < 4; ++q) {
+      TrackTriggeringJob single;
+      single.track = queries[q].track;
+      single.from = queries[q].from;
+      single.to = queries[q].to;
+      single.threshold = queries[q].threshold;
+      TrackTriggeringJob::Iterator iterator;
+      single.iterator = &iterator;
+      ASSERT_TRUE(single.Run());
+      for (; iterator != single.end(); ++iterator, ++e) {
+        ASSERT_LT(e, num_events);
+        EXPECT_EQ(events[e].query, q);
+        EXPECT_FLOAT_EQ(events[e].ratio, iterator->ratio);
+        EXPECT_EQ(events[e].rising, iterator->rising);
+      }
+    }
+    EXPECT_EQ(e, num_events);
+  }
+
+  {  // Events buffer is too small.
+    ozz::animation::TrackBatchTriggeringJob job;
+    job.queries = queries;
+    job.events = ozz::Range<ozz::animation::TrackBatchTriggeringJob::Event>(
+        events, 5);
+    job.num_events = &num_events;
+    EXPECT_FALSE(job.Run());
+    EXPECT_EQ(num_events, 5u);
+    EXPECT_EQ(events[4].query, 2);
+  }
+
+  ozz::memory::default_allocator()->Delete(track);
+}
@@ -0,0 +1,180 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/uniform_sampling_job.h"
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/io/archive.h"
+#include "ozz/base/io/stream.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/allocator.h"
+
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/uniform_animation_builder.h"
+#include "ozz/animation/runtime/uniform_animation.h"
+
+using ozz::animation::UniformAnimation;
+using ozz::animation::UniformSamplingJob;
+using ozz::animation::offline::RawAnimation;
+using ozz::animation::offline::UniformAnimationBuilder;
+
+namespace {
+UniformAnimation* BuildAnimation() {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(2);
+
+  const RawAnimation::TranslationKey t0 = {0.f,
+                                           ozz::math::Float3(0.f, 0.f, 0.f)};
+  raw_animation.tracks[0].translations.push_back(t0);
+  const RawAnimation::TranslationKey t1 = {1.f,
+                                           ozz::math::Float3(4.f, 0.f, 0.f)};
+  raw_animation.tracks[0].translations.push_back(t1);
+
+  const RawAnimation::ScaleKey s0 = {0.f, ozz::math::Float3(1.f, 1.f, 1.f)};
+  raw_animation.tracks[1].scales.push_back(s0);
+  const RawAnimation::ScaleKey s1 = {.5f, ozz::math::Float3(3.f, 1.f, 1.f)};
+  raw_animation.tracks[1].scales.push_back(s1);
+
+  UniformAnimationBuilder builder;
+  builder.frequency = 2.f;
+  return builder(raw_animation);
+}
+}  // namespace
+
+TEST(Validate, UniformSamplingJob) {
+  UniformAnimation* animation = BuildAnimation();
+  ASSERT_TRUE(animation != NULL);
+
+  ozz::math::SoaTransform output[1];
+
+  {  // Empty/default job.
+    UniformSamplingJob job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Invalid output.
+    UniformSamplingJob job;
+    job.animation = animation;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Valid job.
+    UniformSamplingJob job;
+    job.animation = animation;
+    job.output.begin = output;
+    job.output.end = output + 1;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+
+  {  // Valid job with an empty animation.
+    UniformAnimation empty;
+    UniformSamplingJob job;
+    job.animation = &empty;
+    job.output.begin = output;
+    job.output.end = output + 1;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+TEST(Sampling, UniformSamplingJob) {
+  UniformAnimation* animation = BuildAnimation();
+  ASSERT_TRUE(animation != NULL);
+  EXPECT_EQ(animation->num_frames(), 3);
+
+  ozz::math::SoaTransform output[1];
+  UniformSamplingJob job;
+  job.animation = animation;
+  job.output.begin = output;
+  job.output.end = output + 1;
+
+  struct {
+    float ratio;
+    float translation;
+    float scale;
+  } samples[] = {{-.2f, 0.f, 1.f}, {0.f, 0.f, 1.f},  {.25f, 1.f, 2.f},
+                  {.5f, 2.f, 3.f},  {.75f, 3.f, 3.f}, {1.f, 4.f, 3.f},
+                  {1.2f, 4.f, 3.f}, {.1f, .4f, 1.4f}};
+
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(samples); ++i) {
+    job.ratio = samples[i].ratio;
+    ASSERT_TRUE(job.Run());
+    EXPECT_SOAFLOAT3_EQ_EST(output[0].translation, samples[i].translation,
+                            0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f,
+                            0.f);
+    EXPECT_SOAQUATERNION_EQ_EST(output[0].rotation, 0.f, 0.f, 0.f, 0.f, 0.f,
+                                0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 1.f, 1.f,
+                                1.f, 1.f);
+    EXPECT_SOAFLOAT3_EQ_EST(output[0].scale, 1.f, samples[i].scale, 1.f, 1.f,
+                            1.f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f);
+  }
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+TEST(Serialize, UniformSamplingJob) {
+  UniformAnimation* animation = BuildAnimation();
+  ASSERT_TRUE(animation != NULL);
+
+  ozz::io::MemoryStream stream;
+  ozz::io::OArchive o(&stream);
+  o << *animation;
+
+  stream.Seek(0, ozz::io::Stream::kSet);
+  ozz::io::IArchive i(&stream);
+  ASSERT_TRUE(i.TestTag<UniformAnimation>());
+  UniformAnimation loaded;
+  i >> loaded;
+
+  EXPECT_FLOAT_EQ(loaded.duration(), animation->duration());
+  EXPECT_EQ(loaded.num_tracks(), animation->num_tracks());
+  EXPECT_EQ(loaded.num_frames(), animation->num_frames());
+  EXPECT_STREQ(loaded.name(), animation->name());
+  ASSERT_EQ(loaded.frames().count(), animation->frames().count());
+
+  ozz::math::SoaTransform output[1];
+  UniformSamplingJob job;
+  job.animation = &loaded;
+  job.output.begin = output;
+  job.output.end = output + 1;
+  job.ratio = .25f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_SOAFLOAT3_EQ_EST(output[0].translation, 1.f, 0.f, 0.f, 0.f, 0.f, 0.f,
+                          0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+  EXPECT_SOAFLOAT3_EQ_EST(output[0].scale, 1.f, 2.f, 1.f, 1.f, 1.f, 1.f, 1.f,
+                          1.f, 1.f, 1.f, 1.f, 1.f);
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
@@ -0,0 +1,167 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/base/containers/aligned_vector.h"
+
+#include <utility>
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/gtest_helper.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/allocator.h"
+#include "ozz/base/memory/tracking_allocator.h"
+
+TEST(Alignment, AlignedVector) {
+  ozz::AlignedVector<char, 64> chars;
+  EXPECT_EQ(chars.alignment(), 64u);
+  chars.resize(3, 'a');
+  EXPECT_TRUE(ozz::math::IsAligned(chars.data(), 64));
+  chars.resize(1000);
+  EXPECT_TRUE(ozz::math::IsAligned(chars.data(), 64));
+  EXPECT_EQ(chars[0], 'a');
+  EXPECT_EQ(chars[2], 'a');
+  EXPECT_EQ(chars[3], 0);
+
+  // Type alignment prevails if it's higher.
+  ozz::AlignedVector<ozz::math::SoaTransform, 4> transforms;
+  EXPECT_EQ(transforms.alignment(), OZZ_ALIGN_OF(ozz::math::SoaTransform));
+  transforms.resize_uninitialized(7);
+  EXPECT_TRUE(ozz::math::IsAligned(transforms.data(), 16));
+
+  ozz::AlignedVector<ozz::math::Float4x4, 32> matrices;
+  matrices.resize(5, ozz::math::Float4x4::identity());
+  EXPECT_TRUE(ozz::math::IsAligned(matrices.data(), 32));
+  EXPECT_SIMDFLOAT_EQ(matrices[4].cols[0], 1.f, 0.f, 0.f, 0.f);
+}
+
+TEST(Resize, AlignedVector) {
+  ozz::memory::TrackingAllocator tracking(ozz::memory::default_allocator());
+  {
+    ozz::AlignedVector<int> vector(&tracking);
+    EXPECT_TRUE(vector.empty());
+    EXPECT_TRUE(vector.data() == NULL);
+    EXPECT_EQ(vector.allocator(), &tracking);
+
+    vector.resize(4, 46);
+    EXPECT_EQ(vector.size(), 4u);
+    EXPECT_EQ(vector[3], 46);
+    EXPECT_EQ(tracking.stats().live_count, 1u);
+
+    // Shrinking and growing back within capacity doesn't reallocate, nor
+    // initialize elements.
+    const int* data = vector.data();
+    vector.resize_uninitialized(1);
+    vector.resize_uninitialized(4);
+    EXPECT_EQ(vector.data(), data);
+    EXPECT_EQ(vector[3], 46);
+    EXPECT_EQ(tracking.stats().allocation_count, 1u);
+
+    // Growing preserves content.
+    vector.resize_uninitialized(100);
+    EXPECT_EQ(vector[0], 46);
+    EXPECT_EQ(vector[3], 46);
+    EXPECT_EQ(tracking.stats().live_count, 1u);
+
+    vector.clear();
+    EXPECT_TRUE(vector.empty());
+    EXPECT_EQ(vector.capacity(), 100u);
+    vector.shrink_to_fit();
+    EXPECT_EQ(vector.capacity(), 0u);
+    EXPECT_EQ(tracking.stats().live_count, 0u);
+
+    for (int i = 0; i < 20; ++i) {
+      vector.push_back(i);
+    }
+    vector.push_back(vector[19]);
+    EXPECT_EQ(vector.size(), 21u);
+    EXPECT_EQ(vector[20], 19);
+    vector.pop_back();
+    EXPECT_EQ(vector.size(), 20u);
+
+    int sum = 0;
+    for (ozz::AlignedVector<int>::const_iterator it = vector.begin();
+         it != vector.end(); ++it) {
+      sum += *it;
+    }
+    EXPECT_EQ(sum, 190);
+
+    EXPECT_ASSERTION(vector[20], "Index out of range");
+  }
+  EXPECT_EQ(tracking.stats().live_count, 0u);
+}
+
+TEST(Copy, AlignedVector) {
+  ozz::AlignedVector<float> vector;
+  vector.resize(3, 46.f);
+
+  ozz::AlignedVector<float> copy(vector);
+  EXPECT_EQ(copy.size(), 3u);
+  EXPECT_NE(copy.data(), vector.data());
+  EXPECT_EQ(copy[2], 46.f);
+
+  ozz::AlignedVector<float> assigned;
+  assigned.resize(10);
+  assigned = vector;
+  EXPECT_EQ(assigned.size(), 3u);
+  EXPECT_EQ(assigned[0], 46.f);
+
+  ozz::AlignedVector<float> swapped;
+  swapped.swap(assigned);
+  EXPECT_EQ(swapped.size(), 3u);
+  EXPECT_EQ(assigned.size(), 0u);
+
+#if __cplusplus >= 201103L
+  const float* data = swapped.data();
+  ozz::AlignedVector<float> moved(std::move(swapped));
+  EXPECT_EQ(moved.data(), data);
+  EXPECT_EQ(swapped.size(), 0u);
+  EXPECT_TRUE(swapped.data() == NULL);
+
+  vector = std::move(moved);
+  EXPECT_EQ(vector.data(), data);
+  EXPECT_EQ(vector.size(), 3u);
+#endif  // __cplusplus
+}
+
+TEST(Range, AlignedVector) {
+  ozz::AlignedVector<ozz::math::SoaTransform> vector;
+  ozz::Range<ozz::math::SoaTransform> empty = make_range(vector);
+  EXPECT_EQ(empty.count(), 0u);
+
+  vector.resize(5, ozz::math::SoaTransform::identity());
+  ozz::Range<ozz::math::SoaTransform> range = make_range(vector);
+  EXPECT_EQ(range.begin, vector.data());
+  EXPECT_EQ(range.count(), 5u);
+
+  const ozz::AlignedVector<ozz::math::SoaTransform>& cvector = vector;
+  ozz::Range<const ozz::math::SoaTransform> crange = make_range(cvector);
+  EXPECT_EQ(crange.count(), 5u);
+}
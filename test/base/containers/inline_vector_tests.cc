@@ -0,0 +1,148 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/base/containers/inline_vector.h"
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/gtest_helper.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/allocator.h"
+
+TEST(Inline, InlineVector) {
+  ozz::InlineVector<int, 4> vector;
+  EXPECT_TRUE(vector.empty());
+  EXPECT_EQ(vector.size(), 0u);
+  EXPECT_EQ(vector.capacity(), 4u);
+  EXPECT_TRUE(vector.is_inline());
+
+  {
+    // Filling inline capacity doesn't allocate.
+    ozz::memory::ScopedNoAllocation no_allocation;
+    for (int i = 0; i < 4; ++i) {
+      vector.push_back(i);
+    }
+    EXPECT_EQ(vector.size(), 4u);
+    EXPECT_TRUE(vector.is_inline());
+    for (int i = 0; i < 4; ++i) {
+      EXPECT_EQ(vector[i], i);
+    }
+    vector.pop_back();
+    EXPECT_EQ(vector.size(), 3u);
+    vector.resize(4, 46);
+    EXPECT_EQ(vector[3], 46);
+
+    vector.clear();
+    EXPECT_TRUE(vector.empty());
+    EXPECT_EQ(vector.capacity(), 4u);
+  }
+
+  EXPECT_ASSERTION(vector[0], "Index out of range");
+  EXPECT_ASSERTION(vector.pop_back(), "Vector is empty");
+}
+
+TEST(Overflow, InlineVector) {
+  ozz::InlineVector<int, 2> vector;
+  for (int i = 0; i < 5; ++i) {
+    vector.push_back(i);
+  }
+  EXPECT_FALSE(vector.is_inline());
+  EXPECT_EQ(vector.size(), 5u);
+  EXPECT_GE(vector.capacity(), 5u);
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_EQ(vector[i], i);
+  }
+
+  // Pushes an element from the vector itself while reallocating.
+  vector.resize(vector.capacity());
+  vector.push_back(vector[1]);
+  EXPECT_EQ(vector[vector.size() - 1], 1);
+
+  // Copies to an inline vector.
+  ozz::InlineVector<int, 2> copy(vector);
+  EXPECT_EQ(copy.size(), vector.size());
+  EXPECT_EQ(copy[4], 4);
+
+  copy.resize(1);
+  EXPECT_EQ(copy.size(), 1u);
+  vector = copy;
+  EXPECT_EQ(vector.size(), 1u);
+  EXPECT_EQ(vector[0], 0);
+
+  // Overflowing within a ScopedNoAllocation asserts.
+  ozz::InlineVector<int, 2> inlined(2);
+  EXPECT_TRUE(inlined.is_inline());
+  EXPECT_ASSERTION(
+      {
+        ozz::memory::ScopedNoAllocation no_allocation;
+        inlined.resize(3);
+      },
+      "ScopedNoAllocation");
+}
+
+namespace {
+// Counts live instances, to test construction/destruction balance.
+struct Counted {
+  Counted() { ++count; }
+  Counted(const Counted&) { ++count; }
+  ~Counted() { --count; }
+  static int count;
+};
+int Counted::count = 0;
+}  // namespace
+
+TEST(Lifetime, InlineVector) {
+  {
+    ozz::InlineVector<Counted, 3> vector(2);
+    EXPECT_EQ(Counted::count, 2);
+    vector.resize(7);
+    EXPECT_EQ(Counted::count, 7);
+    vector.resize(1);
+    EXPECT_EQ(Counted::count, 1);
+    vector.push_back(Counted());
+    EXPECT_EQ(Counted::count, 2);
+  }
+  EXPECT_EQ(Counted::count, 0);
+}
+
+TEST(SoaTransform, InlineVector) {
+  ozz::InlineVector<ozz::math::SoaTransform, 8> vector(3);
+  EXPECT_TRUE(vector.is_inline());
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(vector.data()) & 0xf, 0u);
+
+  vector.resize(9);
+  EXPECT_FALSE(vector.is_inline());
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(vector.data()) & 0xf, 0u);
+
+  ozz::Range<ozz::math::SoaTransform> range = make_range(vector);
+  EXPECT_EQ(range.count(), 9u);
+  EXPECT_EQ(range.begin, vector.data());
+
+  const ozz::InlineVector<ozz::math::SoaTransform, 8>& cvector = vector;
+  ozz::Range<const ozz::math::SoaTransform> crange = make_range(cvector);
+  EXPECT_EQ(crange.count(), 9u);
+}
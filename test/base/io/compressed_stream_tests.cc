@@ -0,0 +1,260 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/base/io/compressed_stream.h"
+
+#include <cstring>
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/io/archive.h"
+#include "ozz/base/io/stream.h"
+
+namespace {
+// Fills _buffer with _size bytes of data, repetitive if _compressible.
+void FillBuffer(char* _buffer, size_t _size, bool _compressible) {
+  uint32_t seed = 46;
+  for (size_t i = 0; i < _size; ++i) {
+    seed = seed * 1103515245u + 12345u;
+    _buffer[i] = _compressible ? static_cast<char>((i / 7) % 13)
+                               : static_cast<char>(seed >> 16);
+  }
+}
+
+void TestBlock(const char* _src, size_t _size) {
+  ozz::Vector<char>::Std packed(
+      ozz::io::CompressedStream::CompressBound(_size));
+  const size_t packed_size = ozz::io::CompressedStream::CompressBlock(
+      _src, _size, &packed[0], packed.size());
+  ASSERT_NE(packed_size, 0u);
+  ozz::Vector<char>::Std unpacked(_size + 1);
+  EXPECT_TRUE(ozz::io::CompressedStream::DecompressBlock(
+      &packed[0], packed_size, &unpacked[0], _size));
+  EXPECT_EQ(std::memcmp(_src, &unpacked[0], _size), 0);
+
+  // Decompressed size must match exactly.
+  EXPECT_FALSE(ozz::io::CompressedStream::DecompressBlock(
+      &packed[0], packed_size, &unpacked[0], _size + 1));
+  if (_size > 0) {
+    EXPECT_FALSE(ozz::io::CompressedStream::DecompressBlock(
+        &packed[0], packed_size, &unpacked[0], _size - 1));
+    // Truncated input.
+    EXPECT_FALSE(ozz::io::CompressedStream::DecompressBlock(
+        &packed[0], packed_size - 1, &unpacked[0], _size));
+  }
+}
+}  // namespace
+
+TEST(Block, CompressedStream) {
+  char buffer[10000];
+  FillBuffer(buffer, sizeof(buffer), true);
+
+  TestBlock(buffer, 0);
+  TestBlock(buffer, 1);
+  TestBlock(buffer, 12);
+  TestBlock(buffer, 13);
+  TestBlock(buffer, sizeof(buffer));
+
+  // Long runs of a single byte overlap matches.
+  std::memset(buffer, 46, sizeof(buffer));
+  TestBlock(buffer, sizeof(buffer));
+
+  FillBuffer(buffer, sizeof(buffer), false);
+  TestBlock(buffer, sizeof(buffer));
+
+  // Compressible data compresses.
+  FillBuffer(buffer, sizeof(buffer), true);
+  char packed[sizeof(buffer)];
+  const size_t packed_size = ozz::io::CompressedStream::CompressBlock(
+      buffer, sizeof(buffer), packed, sizeof(packed));
+  EXPECT_NE(packed_size, 0u);
+  EXPECT_LT(packed_size, sizeof(buffer) / 4);
+
+  // Output too small.
+  EXPECT_EQ(ozz::io::CompressedStream::CompressBlock(buffer, sizeof(buffer),
+                                                     packed, packed_size - 1),
+            0u);
+
+  // Invalid match offset.
+  const unsigned char corrupted[] = {0x10, 'a', 0x02, 0x00, 0x00};
+  char out[16];
+  EXPECT_FALSE(ozz::io::CompressedStream::DecompressBlock(
+      corrupted, sizeof(corrupted), out, 5));
+}
+
+TEST(Error, CompressedStream) {
+  {  // Invalid streams.
+    ozz::io::CompressedStream compress(NULL,
+                                       ozz::io::CompressedStream::kCompress);
+    EXPECT_FALSE(compress.opened());
+    ozz::io::File file("root_that_does_not_exist:/file.ozz", "rb");
+    ozz::io::CompressedStream decompress(
+        &file, ozz::io::CompressedStream::kDecompress);
+    EXPECT_FALSE(decompress.opened());
+    EXPECT_FALSE(ozz::io::CompressedStream::IsCompressed(NULL));
+    EXPECT_FALSE(ozz::io::CompressedStream::IsCompressed(&file));
+  }
+  {  // Not a compressed stream.
+    ozz::io::MemoryStream stream;
+    const char content[] = "not a compressed stream";
+    stream.Write(content, sizeof(content));
+    stream.Seek(0, ozz::io::Stream::kSet);
+    EXPECT_FALSE(ozz::io::CompressedStream::IsCompressed(&stream));
+    EXPECT_EQ(stream.Tell(), 0);
+    ozz::io::CompressedStream decompress(
+        &stream, ozz::io::CompressedStream::kDecompress);
+    EXPECT_FALSE(decompress.opened());
+  }
+  {  // Truncated frame.
+    ozz::io::MemoryStream stream;
+    {
+      ozz::io::CompressedStream compress(
+          &stream, ozz::io::CompressedStream::kCompress);
+      const char content[] = "truncated content";
+      EXPECT_EQ(compress.Write(content, sizeof(content)), sizeof(content));
+    }
+    ozz::io::MemoryStream truncated;
+    char buffer[256];
+    stream.Seek(0, ozz::io::Stream::kSet);
+    const size_t size = stream.Read(buffer, sizeof(buffer));
+    truncated.Write(buffer, size - 1);
+    truncated.Seek(0, ozz::io::Stream::kSet);
+    EXPECT_TRUE(ozz::io::CompressedStream::IsCompressed(&truncated));
+    ozz::io::CompressedStream decompress(
+        &truncated, ozz::io::CompressedStream::kDecompress);
+    EXPECT_FALSE(decompress.opened());
+  }
+}
+
+TEST(Stream, CompressedStream) {
+  const size_t kSize = 5000;
+  char content[kSize];
+  for (int c = 0; c < 2; ++c) {
+    FillBuffer(content, kSize, c == 0);
+
+    ozz::io::MemoryStream stream;
+    {
+      ozz::io::CompressedStream compress(
+          &stream, ozz::io::CompressedStream::kCompress, 1000);
+      ASSERT_TRUE(compress.opened());
+      EXPECT_EQ(compress.mode(), ozz::io::CompressedStream::kCompress);
+      EXPECT_EQ(compress.block_size(), 1000);
+
+      // Write only mode.
+      char buffer[16];
+      EXPECT_EQ(compress.Read(buffer, sizeof(buffer)), 0u);
+
+      // Writes in uneven chunks.
+      EXPECT_EQ(compress.Write(content, 1), 1u);
+      EXPECT_EQ(compress.Write(content + 1, 1500), 1500u);
+      EXPECT_EQ(compress.Write(content + 1501, kSize - 1501), kSize - 1501);
+      EXPECT_EQ(compress.Tell(), static_cast<int64_t>(kSize));
+      EXPECT_EQ(compress.Size(), kSize);
+
+      // Seeking is only supported to current position.
+      EXPECT_EQ(compress.Seek(0, ozz::io::Stream::kCurrent), 0);
+      EXPECT_NE(compress.Seek(0, ozz::io::Stream::kSet), 0);
+
+      EXPECT_TRUE(compress.Close());
+      EXPECT_FALSE(compress.opened());
+      EXPECT_EQ(compress.Write(content, 1), 0u);
+    }
+    if (c == 0) {
+      EXPECT_LT(stream.Size(), kSize / 4);
+    } else {
+      // Incompressible blocks are stored raw.
+      EXPECT_LT(stream.Size(), kSize + 100);
+    }
+
+    // Some data after the frame.
+    const int trailer = 46;
+    stream.Write(&trailer, sizeof(trailer));
+
+    stream.Seek(0, ozz::io::Stream::kSet);
+    EXPECT_TRUE(ozz::io::CompressedStream::IsCompressed(&stream));
+    ozz::io::CompressedStream decompress(
+        &stream, ozz::io::CompressedStream::kDecompress);
+    ASSERT_TRUE(decompress.opened());
+    EXPECT_EQ(decompress.mode(), ozz::io::CompressedStream::kDecompress);
+    EXPECT_EQ(decompress.block_size(), 1000);
+    EXPECT_EQ(decompress.Size(), kSize);
+    EXPECT_EQ(decompress.Tell(), 0);
+
+    // Read only mode.
+    EXPECT_EQ(decompress.Write(content, 1), 0u);
+
+    // Sequential reading, across blocks.
+    char read[kSize + 10];
+    EXPECT_EQ(decompress.Read(read, 1), 1u);
+    EXPECT_EQ(decompress.Read(read + 1, 2500), 2500u);
+    EXPECT_EQ(decompress.Read(read + 2501, sizeof(read) - 2501),
+              kSize - 2501);
+    EXPECT_EQ(std::memcmp(read, content, kSize), 0);
+    EXPECT_EQ(decompress.Tell(), static_cast<int64_t>(kSize));
+    EXPECT_EQ(decompress.Read(read, 1), 0u);
+
+    // Random access.
+    EXPECT_EQ(decompress.Seek(-1000, ozz::io::Stream::kEnd), 0);
+    EXPECT_EQ(decompress.Read(read, 10), 10u);
+    EXPECT_EQ(std::memcmp(read, content + kSize - 1000, 10), 0);
+    EXPECT_EQ(decompress.Seek(1995, ozz::io::Stream::kSet), 0);
+    EXPECT_EQ(decompress.Read(read, 10), 10u);
+    EXPECT_EQ(std::memcmp(read, content + 1995, 10), 0);
+    EXPECT_EQ(decompress.Seek(-1005, ozz::io::Stream::kCurrent), 0);
+    EXPECT_EQ(decompress.Tell(), 1000);
+    EXPECT_EQ(decompress.Read(read, 1), 1u);
+    EXPECT_EQ(read[0], content[1000]);
+
+    // Invalid seeks.
+    EXPECT_NE(decompress.Seek(-1, ozz::io::Stream::kSet), 0);
+    EXPECT_NE(decompress.Seek(1, ozz::io::Stream::kEnd), 0);
+    EXPECT_EQ(decompress.Tell(), 1001);
+  }
+}
+
+TEST(Archive, CompressedStream) {
+  ozz::io::MemoryStream stream;
+  {
+    ozz::io::CompressedStream compress(&stream,
+                                       ozz::io::CompressedStream::kCompress);
+    ozz::io::OArchive o(&compress, ozz::GetNativeEndianness());
+    for (int i = 0; i < 1000; ++i) {
+      o << i;
+    }
+  }
+  stream.Seek(0, ozz::io::Stream::kSet);
+  ozz::io::CompressedStream decompress(&stream,
+                                       ozz::io::CompressedStream::kDecompress);
+  ASSERT_TRUE(decompress.opened());
+  ozz::io::IArchive i(&decompress);
+  for (int v = 0; v < 1000; ++v) {
+    int read;
+    i >> read;
+    EXPECT_EQ(read, v);
+  }
+}
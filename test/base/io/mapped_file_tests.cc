@@ -0,0 +1,107 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/base/io/mapped_file.h"
+
+#include <cstring>
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/io/archive.h"
+#include "ozz/base/io/stream.h"
+#include "ozz/base/maths/math_ex.h"
+
+TEST(Error, MappedFile) {
+  ozz::io::MappedFile file("root_that_does_not_exist:/file.bin");
+  EXPECT_FALSE(file.opened());
+  EXPECT_FALSE(file.mapped());
+  EXPECT_TRUE(file.data() == NULL);
+  EXPECT_EQ(file.size(), 0u);
+
+  {  // Empty files can't be mapped.
+    ozz::io::File empty("empty.bin", "wb");
+    ASSERT_TRUE(empty.opened());
+  }
+  ozz::io::MappedFile empty("empty.bin");
+  EXPECT_FALSE(empty.opened());
+}
+
+TEST(Content, MappedFile) {
+  char content[1000];
+  for (size_t i = 0; i < sizeof(content); ++i) {
+    content[i] = static_cast<char>(i * 7);
+  }
+  {
+    ozz::io::File file("mapped.bin", "wb");
+    ASSERT_TRUE(file.opened());
+    ASSERT_EQ(file.Write(content, sizeof(content)), sizeof(content));
+  }
+
+  ozz::io::MappedFile file("mapped.bin");
+  ASSERT_TRUE(file.opened());
+  EXPECT_EQ(file.size(), sizeof(content));
+  EXPECT_TRUE(ozz::math::IsAligned(file.data(), 16));
+  EXPECT_EQ(std::memcmp(file.data(), content, sizeof(content)), 0);
+
+  file.Close();
+  EXPECT_FALSE(file.opened());
+  EXPECT_FALSE(file.mapped());
+  EXPECT_TRUE(file.data() == NULL);
+  EXPECT_EQ(file.size(), 0u);
+
+  // Can be closed twice.
+  file.Close();
+}
+
+TEST(Stream, MappedFile) {
+  {
+    ozz::io::MappedFileStream stream("root_that_does_not_exist:/file.bin");
+    EXPECT_FALSE(stream.opened());
+  }
+
+  {  // Writes an archive to a file.
+    ozz::io::File file("mapped.ozz", "wb");
+    ASSERT_TRUE(file.opened());
+    ozz::io::OArchive archive(&file);
+    const int32_t values[] = {46, 69, 93};
+    archive << ozz::io::MakeArray(values);
+  }
+
+  // Reads it back from the mapped file.
+  ozz::io::MappedFileStream stream("mapped.ozz");
+  ASSERT_TRUE(stream.opened());
+  ASSERT_TRUE(stream.file().opened());
+  EXPECT_EQ(stream.Size(), stream.file().size());
+  ozz::io::IArchive archive(&stream);
+  int32_t values[3];
+  archive >> ozz::io::MakeArray(values);
+  EXPECT_EQ(values[0], 46);
+  EXPECT_EQ(values[1], 69);
+  EXPECT_EQ(values[2], 93);
+  EXPECT_EQ(stream.Tell(), static_cast<int64_t>(stream.Size()));
+  EXPECT_EQ(stream.Write(values, sizeof(values)), 0u);
+}
@@ -0,0 +1,244 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/base/io/pack.h"
+
+#include <cstring>
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/io/archive.h"
+#include "ozz/base/io/mapped_file.h"
+#include "ozz/base/io/stream.h"
+#include "ozz/base/maths/math_ex.h"
+
+namespace {
+struct PackValue {
+  explicit PackValue(int32_t _i = 0) : i(_i) {}
+  void Save(ozz::io::OArchive& _archive) const { _archive << i; }
+  void Load(ozz::io::IArchive& _archive, uint32_t _version) {
+    EXPECT_EQ(_version, 3u);
+    _archive >> i;
+  }
+  int32_t i;
+};
+
+struct OtherValue {
+  void Save(ozz::io::OArchive&) const {}
+  void Load(ozz::io::IArchive&, uint32_t) {}
+};
+}  // namespace
+
+namespace ozz {
+namespace io {
+OZZ_IO_TYPE_VERSION(3, PackValue)
+OZZ_IO_TYPE_TAG("pack-value", PackValue)
+OZZ_IO_TYPE_NOT_VERSIONABLE(OtherValue)
+OZZ_IO_TYPE_TAG("other-value", OtherValue)
+}  // namespace io
+}  // namespace ozz
+
+TEST(Error, Pack) {
+  {  // Empty stream.
+    ozz::io::MemoryStream stream;
+    ozz::io::PackReader reader;
+    EXPECT_FALSE(reader.Open(&stream));
+    EXPECT_FALSE(reader.opened());
+  }
+  {  // Not a pack.
+    ozz::io::MemoryStream stream;
+    {
+      ozz::io::OArchive o(&stream, ozz::GetNativeEndianness());
+      o << PackValue(46);
+    }
+    stream.Seek(0, ozz::io::Stream::kSet);
+    ozz::io::PackReader reader;
+    EXPECT_FALSE(reader.Open(&stream));
+  }
+  {  // Not finalized.
+    ozz::io::MemoryStream stream;
+    {
+      ozz::io::PackWriter writer(&stream);
+      EXPECT_TRUE(writer.Add("value", PackValue(46)));
+    }
+    stream.Seek(0, ozz::io::Stream::kSet);
+    ozz::io::PackReader reader;
+    EXPECT_FALSE(reader.Open(&stream));
+  }
+  {  // Invalid names.
+    ozz::io::MemoryStream stream;
+    ozz::io::PackWriter writer(&stream);
+    EXPECT_FALSE(writer.Add(NULL, PackValue(46)));
+    EXPECT_FALSE(writer.Add("", PackValue(46)));
+    EXPECT_TRUE(writer.Add("value", PackValue(46)));
+    EXPECT_FALSE(writer.Add("value", PackValue(47)));
+    EXPECT_EQ(writer.num_entries(), 1);
+    EXPECT_TRUE(writer.Finalize());
+
+    // Can't add or finalize twice.
+    EXPECT_FALSE(writer.Add("other", PackValue(47)));
+    EXPECT_FALSE(writer.Finalize());
+  }
+}
+
+TEST(Empty, Pack) {
+  ozz::io::MemoryStream stream;
+  {
+    ozz::io::PackWriter writer(&stream);
+    EXPECT_TRUE(writer.Finalize());
+  }
+  stream.Seek(0, ozz::io::Stream::kSet);
+  ozz::io::PackReader reader;
+  ASSERT_TRUE(reader.Open(&stream));
+  EXPECT_EQ(reader.num_entries(), 0);
+  EXPECT_EQ(reader.Find("value"), -1);
+  PackValue value;
+  EXPECT_FALSE(reader.Load(0, &value));
+  EXPECT_FALSE(reader.Load("value", &value));
+}
+
+TEST(Load, Pack) {
+  for (int e = 0; e < 2; ++e) {
+    const ozz::Endianness endianness =
+        e == 0 ? ozz::kBigEndian : ozz::kLittleEndian;
+    ozz::io::MemoryStream stream;
+
+    // Pack doesn't need to start at the beginning of the stream.
+    const char prefix[] = "prefix";
+    stream.Write(prefix, sizeof(prefix));
+
+    const char* names[] = {"zeta", "alpha", "mu", "beta"};
+    const char binary[] = "binary content";
+    {
+      ozz::io::PackWriter writer(&stream, endianness);
+      for (int i = 0; i < 4; ++i) {
+        EXPECT_TRUE(writer.Add(names[i], PackValue(i * 10)));
+      }
+      EXPECT_TRUE(writer.AddBinary("binary", binary, sizeof(binary)));
+      EXPECT_EQ(writer.num_entries(), 5);
+      EXPECT_TRUE(writer.Finalize());
+    }
+    const int64_t end = stream.Tell();
+
+    ASSERT_EQ(stream.Seek(sizeof(prefix), ozz::io::Stream::kSet), 0);
+    ozz::io::PackReader reader;
+    ASSERT_TRUE(reader.Open(&stream));
+    EXPECT_TRUE(reader.opened());
+    ASSERT_EQ(reader.num_entries(), 5);
+
+    // Table of contents.
+    for (int i = 0; i < 4; ++i) {
+      EXPECT_STREQ(reader.name(i), names[i]);
+      EXPECT_EQ(reader.Find(names[i]), i);
+    }
+    EXPECT_STREQ(reader.name(4), "binary");
+    EXPECT_EQ(reader.Find("binary"), 4);
+    EXPECT_EQ(reader.Find("gamma"), -1);
+    EXPECT_EQ(reader.Find(NULL), -1);
+    for (int i = 0; i < reader.num_entries(); ++i) {
+      EXPECT_TRUE(ozz::math::IsAligned(reader.offset(i),
+                                       ozz::io::PackWriter::kAlignment));
+      EXPECT_TRUE(reader.offset(i) + reader.size(i) <=
+                  static_cast<uint64_t>(end));
+    }
+    EXPECT_EQ(reader.size(4), sizeof(binary));
+
+    // Binary payload.
+    ASSERT_EQ(stream.Seek(sizeof(prefix) + reader.offset(4),
+                          ozz::io::Stream::kSet),
+              0);
+    char read_binary[sizeof(binary)];
+    EXPECT_EQ(stream.Read(read_binary, sizeof(read_binary)),
+              sizeof(read_binary));
+    EXPECT_STREQ(read_binary, binary);
+
+    // Random access, by index and name.
+    for (int i = 3; i >= 0; --i) {
+      PackValue value(-1);
+      EXPECT_TRUE(reader.Load(i, &value));
+      EXPECT_EQ(value.i, i * 10);
+      PackValue named(-1);
+      EXPECT_TRUE(reader.Load(names[i], &named));
+      EXPECT_EQ(named.i, i * 10);
+    }
+
+    // Invalid accesses.
+    PackValue value(-1);
+    EXPECT_FALSE(reader.Load(-1, &value));
+    EXPECT_FALSE(reader.Load(5, &value));
+    EXPECT_FALSE(reader.Load("gamma", &value));
+    EXPECT_EQ(value.i, -1);
+
+    // Type mismatch.
+    OtherValue other;
+    EXPECT_FALSE(reader.Load(0, &other));
+    EXPECT_FALSE(reader.Load("binary", &value));
+
+    // Batch.
+    const int indices[] = {3, 0, 2, 5, 1};
+    PackValue values[5];
+    EXPECT_EQ(reader.Load(ozz::Range<const int>(indices),
+                          ozz::Range<PackValue>(values)),
+              4);
+    EXPECT_EQ(values[0].i, 30);
+    EXPECT_EQ(values[1].i, 0);
+    EXPECT_EQ(values[2].i, 20);
+    EXPECT_EQ(values[3].i, 0);
+    EXPECT_EQ(values[4].i, 10);
+
+    // Too small output.
+    EXPECT_EQ(reader.Load(ozz::Range<const int>(indices),
+                          ozz::Range<PackValue>(values, 2)),
+              0);
+
+    reader.Close();
+    EXPECT_FALSE(reader.opened());
+    EXPECT_EQ(reader.num_entries(), 0);
+    EXPECT_FALSE(reader.Load(0, &value));
+  }
+}
+
+TEST(MappedFile, Pack) {
+  {
+    ozz::io::File file("test.pack", "wb");
+    ASSERT_TRUE(file.opened());
+    ozz::io::PackWriter writer(&file);
+    EXPECT_TRUE(writer.Add("first", PackValue(46)));
+    EXPECT_TRUE(writer.Add("second", PackValue(93)));
+    EXPECT_TRUE(writer.Finalize());
+  }
+  ozz::io::MappedFileStream stream("test.pack");
+  ASSERT_TRUE(stream.opened());
+  ozz::io::PackReader reader;
+  ASSERT_TRUE(reader.Open(&stream));
+  EXPECT_EQ(reader.num_entries(), 2);
+  PackValue value;
+  EXPECT_TRUE(reader.Load("second", &value));
+  EXPECT_EQ(value.i, 93);
+  EXPECT_TRUE(reader.Load("first", &value));
+  EXPECT_EQ(value.i, 46);
+}
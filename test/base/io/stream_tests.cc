@@ -135,7 +135,7 @@ void TestSeek(ozz::io::Stream* _stream) {
 }
 
 void TestTooBigStream(ozz::io::Stream* _stream) {
-  const int max_size = std::numeric_limits<int>::max();
+  const int64_t max_size = std::numeric_limits<ptrdiff_t>::max();
   ASSERT_TRUE(_stream->opened());
   EXPECT_EQ(_stream->Seek(0, ozz::io::Stream::kSet), 0);
   EXPECT_EQ(_stream->Tell(), 0);
@@ -152,11 +152,26 @@ void TestTooBigStream(ozz::io::Stream* _stream) {
   EXPECT_EQ(_stream->Seek(1, ozz::io::Stream::kSet), 0);
   EXPECT_EQ(_stream->Tell(), 1);
   char c;
-  EXPECT_EQ(_stream->Write(&c, max_size), 0u);
-  EXPECT_EQ(_stream->Read(&c, max_size), 0u);
+  EXPECT_EQ(_stream->Write(&c, static_cast<size_t>(max_size)), 0u);
+  EXPECT_EQ(_stream->Read(&c, static_cast<size_t>(max_size)), 0u);
   EXPECT_EQ(_stream->Size(), 0u);
 }
 
+void TestLargeSeek(ozz::io::Stream* _stream) {
+  // Seeks beyond 32 bits offsets, without writing.
+  const int64_t large = int64_t(5) << 30;
+  ASSERT_TRUE(_stream->opened());
+  EXPECT_EQ(_stream->Seek(large, ozz::io::Stream::kSet), 0);
+  EXPECT_EQ(_stream->Tell(), large);
+  EXPECT_EQ(_stream->Seek(large, ozz::io::Stream::kCurrent), 0);
+  EXPECT_EQ(_stream->Tell(), large * 2);
+  EXPECT_EQ(_stream->Seek(-large, ozz::io::Stream::kCurrent), 0);
+  EXPECT_EQ(_stream->Tell(), large);
+  EXPECT_EQ(_stream->Size(), 0u);
+  EXPECT_EQ(_stream->Seek(-large, ozz::io::Stream::kEnd), -1);
+  EXPECT_EQ(_stream->Tell(), large);
+}
+
 TEST(File, Stream) {
   {
     ozz::io::File file(NULL);
@@ -168,6 +183,10 @@ TEST(File, Stream) {
     EXPECT_TRUE(file.opened());
     TestSeek(&file);
   }
+  {
+    ozz::io::File file("large.bin", "w+b");
+    TestLargeSeek(&file);
+  }
   { EXPECT_TRUE(ozz::io::File::Exist("test.bin")); }
 }
 
@@ -184,4 +203,45 @@ TEST(MemoryStream, Stream) {
     ozz::io::MemoryStream stream;
     TestTooBigStream(&stream);
   }
+  if (sizeof(size_t) >= sizeof(int64_t)) {
+    ozz::io::MemoryStream stream;
+    TestLargeSeek(&stream);
+  }
+}
+
+TEST(ExternalMemoryStream, Stream) {
+  {
+    ozz::io::ExternalMemoryStream stream(NULL, 0);
+    EXPECT_FALSE(stream.opened());
+  }
+
+  const char buffer[] = {'o', 'z', 'z', 0, 46};
+  ozz::io::ExternalMemoryStream stream(buffer, sizeof(buffer));
+  ASSERT_TRUE(stream.opened());
+  EXPECT_EQ(stream.data(), buffer);
+  EXPECT_EQ(stream.Size(), sizeof(buffer));
+  EXPECT_EQ(stream.Tell(), 0);
+
+  // Reads.
+  char read[4];
+  EXPECT_EQ(stream.Read(read, 4), 4u);
+  EXPECT_STREQ(read, "ozz");
+  EXPECT_EQ(stream.Tell(), 4);
+  EXPECT_EQ(stream.Read(read, 4), 1u);
+  EXPECT_EQ(read[0], 46);
+  EXPECT_EQ(stream.Read(read, 4), 0u);
+
+  // Writing is not allowed.
+  EXPECT_EQ(stream.Write(read, 1), 0u);
+  EXPECT_EQ(stream.Size(), sizeof(buffer));
+
+  // Seeks.
+  EXPECT_EQ(stream.Seek(-1, ozz::io::Stream::kEnd), 0);
+  EXPECT_EQ(stream.Tell(), 4);
+  EXPECT_EQ(stream.Seek(-5, ozz::io::Stream::kCurrent), -1);
+  EXPECT_EQ(stream.Seek(1, ozz::io::Stream::kSet), 0);
+  EXPECT_EQ(stream.Read(read, 2), 2u);
+  EXPECT_EQ(read[0], 'z');
+  EXPECT_EQ(stream.Seek(46, ozz::io::Stream::kEnd), 0);
+  EXPECT_EQ(stream.Read(read, 1), 0u);
 }
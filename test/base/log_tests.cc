@@ -27,6 +27,8 @@
 
 #include "ozz/base/log.h"
 
+#include <string>
+
 #include "gtest/gtest.h"
 #include "ozz/base/gtest_helper.h"
 
@@ -54,3 +56,67 @@ TEST(Log, Silent) { TestLogLevel(ozz::log::kSilent); }
 TEST(Log, Standard) { TestLogLevel(ozz::log::kStandard); }
 
 TEST(Log, Verbose) { TestLogLevel(ozz::log::kVerbose); }
+
+int Evaluate(int* _count) { return ++*_count; }
+
+void LogVMacro(int* _count) { OZZ_LOGV << "logv" << Evaluate(_count); }
+void LogMacro(int* _count) { OZZ_LOG << "log" << Evaluate(_count); }
+void OutMacro(int* _count) { OZZ_LOG_OUT << "out" << Evaluate(_count); }
+void ErrMacro(int* _count) { OZZ_LOG_ERR << "err" << Evaluate(_count); }
+
+void TestLogMacros(ozz::log::Level _level) {
+  ozz::log::SetLevel(_level);
+
+  // Logged expressions are only evaluated if level is enabled.
+  int count = 0;
+  EXPECT_LOG_LOGV(LogVMacro(&count), "logv1");
+  EXPECT_EQ(count, ozz::log::IsEnabled(ozz::log::kVerbose) ? 1 : 0);
+
+  count = 0;
+  EXPECT_LOG_LOG(LogMacro(&count), "log1");
+  EXPECT_LOG_OUT(OutMacro(&count), "out2");
+  EXPECT_LOG_ERR(ErrMacro(&count), "err3");
+  EXPECT_EQ(count, ozz::log::IsEnabled(ozz::log::kStandard) ? 3 : 0);
+
+  // Macros are single statements.
+  if (count == 46)
+    OZZ_LOG << "never" << std::endl;
+  else
+    count = 46;
+  EXPECT_EQ(count, 46);
+}
+
+TEST(LogMacros, Silent) { TestLogMacros(ozz::log::kSilent); }
+
+TEST(LogMacros, Standard) { TestLogMacros(ozz::log::kStandard); }
+
+TEST(LogMacros, Verbose) { TestLogMacros(ozz::log::kVerbose); }
+
+void LogLines() {
+  ozz::log::Out out;
+  for (int i = 0; i < 3; ++i) {
+    out << "line" << i << std::endl;
+  }
+}
+
+TEST(Log, Buffering) {
+  ozz::log::SetLevel(ozz::log::kStandard);
+
+  // Logs longer than loggers buffer are written entirely.
+  std::string big;
+  for (int i = 0; i < 1000; ++i) {
+    big += static_cast<char>('a' + i % 26);
+  }
+  EXPECT_LOG_OUT(ozz::log::Out() << big << "end", (big + "end").c_str());
+
+  // Logs are written when logger is destroyed, even without being flushed.
+  EXPECT_LOG_OUT(ozz::log::Out() << "no" << ' ' << "flush", "no flush");
+
+  // A logger can be used for multiple lines.
+  EXPECT_LOG_OUT(LogLines(), "line0\nline1\nline2\n");
+
+  // Disabled loggers don't format.
+  ozz::log::LogV logv;
+  logv << "silent";
+  EXPECT_FALSE(logv.stream().good());
+}
@@ -0,0 +1,139 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/base/maths/box_utils.h"
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/maths/gtest_math_helper.h"
+
+using ozz::math::Box;
+using ozz::math::Float3;
+using ozz::math::Float4x4;
+
+namespace {
+Float4x4 Translation(float _x, float _y, float _z) {
+  return Float4x4::Translation(ozz::math::simd_float4::Load(_x, _y, _z, 1.f));
+}
+}  // namespace
+
+TEST(ComputeBounds, ozz_math) {
+  // Empty range.
+  EXPECT_FALSE(
+      ozz::math::ComputeBounds(ozz::Range<const Float4x4>()).is_valid());
+
+  // Single matrix.
+  const Float4x4 single[] = {Translation(1.f, 2.f, 3.f)};
+  const Box single_box = ozz::math::ComputeBounds(single);
+  EXPECT_FLOAT3_EQ(single_box.min, 1.f, 2.f, 3.f);
+  EXPECT_FLOAT3_EQ(single_box.max, 1.f, 2.f, 3.f);
+
+  // Extremums located at every accumulator and remainder position.
+  Float4x4 matrices[11];
+  for (int i = 0; i < 11; ++i) {
+    for (int j = 0; j < 11; ++j) {
+      matrices[j] = Translation(0.f, 0.f, 0.f);
+    }
+    matrices[i] = Translation(-1.f - i, 2.f + i, 0.f);
+    const Box box = ozz::math::ComputeBounds(matrices);
+    EXPECT_FLOAT3_EQ(box.min, -1.f - i, 0.f, 0.f);
+    EXPECT_FLOAT3_EQ(box.max, 0.f, 2.f + i, 0.f);
+  }
+
+  // Rotation and scale are ignored.
+  const Float4x4 scaled[] = {
+      Float4x4::Scaling(ozz::math::simd_float4::Load(5.f, 5.f, 5.f, 1.f)) *
+      Translation(1.f, -1.f, 0.f)};
+  const Box scaled_box = ozz::math::ComputeBounds(scaled);
+  EXPECT_FLOAT3_EQ(scaled_box.min, 5.f, -5.f, 0.f);
+  EXPECT_FLOAT3_EQ(scaled_box.max, 5.f, -5.f, 0.f);
+}
+
+TEST(ComputeBoundsBatch, ozz_math) {
+  const Float4x4 matrices[] = {
+      Translation(0.f, 0.f, 0.f), Translation(1.f, 1.f, 1.f),
+      Translation(2.f, 2.f, 2.f), Translation(-1.f, 5.f, 3.f),
+      Translation(4.f, 4.f, 4.f), Translation(3.f, 3.f, 3.f)};
+
+  Box boxes[3];
+  EXPECT_FALSE(ozz::math::ComputeBounds(matrices, 3, boxes));
+  EXPECT_FALSE(boxes[0].is_valid());
+
+  EXPECT_TRUE(ozz::math::ComputeBounds(matrices, 2, boxes));
+  EXPECT_FLOAT3_EQ(boxes[0].min, 0.f, 0.f, 0.f);
+  EXPECT_FLOAT3_EQ(boxes[0].max, 1.f, 1.f, 1.f);
+  EXPECT_FLOAT3_EQ(boxes[1].min, -1.f, 2.f, 2.f);
+  EXPECT_FLOAT3_EQ(boxes[1].max, 2.f, 5.f, 3.f);
+  EXPECT_FLOAT3_EQ(boxes[2].min, 3.f, 3.f, 3.f);
+  EXPECT_FLOAT3_EQ(boxes[2].max, 4.f, 4.f, 4.f);
+
+  // Empty poses.
+  EXPECT_TRUE(ozz::math::ComputeBounds(ozz::Range<const Float4x4>(), 0,
+                                       ozz::Range<Box>(boxes, 1)));
+  EXPECT_FALSE(boxes[0].is_valid());
+}
+
+TEST(TestFrustum, ozz_math) {
+  // An orthographic projection, which frustum is the [-1,1] cube, translated
+  // to x = 10.
+  const ozz::math::Frustum frustum = ozz::math::Frustum::FromMatrix(
+      Translation(-10.f, 0.f, 0.f));
+
+  const Box boxes[] = {
+      Box(Float3(9.f, -.5f, -.5f), Float3(11.f, .5f, .5f)),  // Inside.
+      Box(Float3(-1.f, -1.f, -1.f), Float3(1.f, 1.f, 1.f)),  // Outside left.
+      Box(Float3(10.5f, 0.f, 0.f), Float3(12.f, 1.f, 1.f)),  // Intersects.
+      Box(Float3(9.f, 1.1f, 0.f), Float3(10.f, 2.f, 1.f)),   // Above.
+      Box(Float3(9.f, 0.f, -3.f), Float3(10.f, 1.f, -2.f)),  // Behind.
+      Box(Float3(0.f, -5.f, -5.f), Float3(20.f, 5.f, 5.f)),  // Contains.
+      Box(Float3(10.f, 0.f, 0.f), Float3(10.f, 0.f, 0.f)),   // A point.
+      Box(Float3(12.f, 0.f, 0.f), Float3(13.f, 0.f, 0.f))};  // Outside right.
+  const bool expected[] = {true, false, true, false, false, true, true, false};
+
+  // Every count, so that incomplete soa batches are tested.
+  for (size_t count = 0; count <= OZZ_ARRAY_SIZE(boxes); ++count) {
+    bool visible[OZZ_ARRAY_SIZE(boxes) + 1];
+    for (size_t i = 0; i < OZZ_ARRAY_SIZE(visible); ++i) {
+      visible[i] = !expected[i % OZZ_ARRAY_SIZE(expected)];
+    }
+    EXPECT_TRUE(ozz::math::TestFrustum(
+        frustum, ozz::Range<const Box>(boxes, count),
+        ozz::Range<bool>(visible, count)));
+    for (size_t i = 0; i < count; ++i) {
+      EXPECT_EQ(visible[i], expected[i]);
+    }
+    // Untouched.
+    for (size_t i = count; i < OZZ_ARRAY_SIZE(visible); ++i) {
+      EXPECT_EQ(visible[i], !expected[i % OZZ_ARRAY_SIZE(expected)]);
+    }
+  }
+
+  // Output too small.
+  bool visible[2] = {false, false};
+  EXPECT_FALSE(ozz::math::TestFrustum(frustum, boxes, visible));
+  EXPECT_FALSE(visible[0]);
+}
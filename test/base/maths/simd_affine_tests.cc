@@ -0,0 +1,72 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#include "ozz/base/maths/simd_affine.h"
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/math_constant.h"
+
+using ozz::math::DualQuaternion;
+using ozz::math::Float3x4;
+using ozz::math::Float4x4;
+using ozz::math::SimdFloat4;
+
+TEST(Float3x4, ozz_simd_math) {
+  const Float4x4 m =
+      Float4x4::Translation(ozz::math::simd_float4::Load(1.f, 2.f, 3.f, 0.f)) *
+      Float4x4::FromAxisAngle(ozz::math::simd_float4::z_axis(),
+                              ozz::math::simd_float4::Load1(ozz::math::kPi_2));
+
+  const Float3x4 affine = ozz::math::ToFloat3x4(m);
+  EXPECT_SIMDFLOAT_EQ(affine.rows[0], 0.f, -1.f, 0.f, 1.f);
+  EXPECT_SIMDFLOAT_EQ(affine.rows[1], 1.f, 0.f, 0.f, 2.f);
+  EXPECT_SIMDFLOAT_EQ(affine.rows[2], 0.f, 0.f, 1.f, 3.f);
+
+  const Float4x4 back = ozz::math::ToFloat4x4(affine);
+  EXPECT_FLOAT4x4_EQ(back, 0.f, 1.f, 0.f, 0.f, -1.f, 0.f, 0.f, 0.f, 0.f, 0.f,
+                     1.f, 0.f, 1.f, 2.f, 3.f, 1.f);
+}
+
+TEST(DualQuaternion, ozz_simd_math) {
+  const Float4x4 identity =
+      ozz::math::ToFloat4x4(ozz::math::ToFloat3x4(Float4x4::identity()));
+  const DualQuaternion dq_identity = ozz::math::ToDualQuaternion(identity);
+  EXPECT_SIMDQUATERNION_EQ(dq_identity.real, 0.f, 0.f, 0.f, 1.f);
+  EXPECT_SIMDQUATERNION_EQ(dq_identity.dual, 0.f, 0.f, 0.f, 0.f);
+
+  const Float4x4 m =
+      Float4x4::Translation(ozz::math::simd_float4::Load(1.f, 2.f, 3.f, 0.f)) *
+      Float4x4::FromAxisAngle(ozz::math::simd_float4::z_axis(),
+                              ozz::math::simd_float4::Load1(ozz::math::kPi_2));
+  const DualQuaternion dq = ozz::math::ToDualQuaternion(m);
+  EXPECT_SIMDQUATERNION_EQ(dq.real, 0.f, 0.f, .70710677f, .70710677f);
+  EXPECT_SIMDQUATERNION_EQ(dq.dual, 1.06066017f, .35355339f, 1.06066017f,
+                           -1.06066017f);
+}
@@ -228,6 +228,12 @@ TEST(Float4x4ColumnMultiply, ozz_simd_math) {
   EXPECT_FLOAT4x4_EQ(column_multiply, 0.f, -2.f, -6.f, -12.f, -4.f, -10.f,
                      -18.f, -28.f, -8.f, -18.f, -30.f, -44.f, -12.f, -26.f,
                      -42.f, -60.f);
+
+  const Float4x4 column_multiply_add =
+      ozz::math::ColumnMultiplyAdd(m0, v, Float4x4::identity());
+  EXPECT_FLOAT4x4_EQ(column_multiply_add, 1.f, -2.f, -6.f, -12.f, -4.f, -9.f,
+                     -18.f, -28.f, -8.f, -18.f, -29.f, -44.f, -12.f, -26.f,
+                     -42.f, -59.f);
 }
 
 TEST(Float4x4Rotate, ozz_simd_math) {
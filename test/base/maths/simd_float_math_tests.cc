@@ -48,6 +48,16 @@ TEST(Name, ozz_simd_math) {
   EXPECT_TRUE(ozz::math::SimdImplementationName() != NULL);
 }
 
+TEST(CpuSupportsAvx2Fma, ozz_simd_math) {
+  // Detection result is stable.
+  EXPECT_EQ(ozz::math::CpuSupportsAvx2Fma(), ozz::math::CpuSupportsAvx2Fma());
+#if defined(OZZ_SIMD_AVX2) && defined(OZZ_SIMD_FMA)
+  EXPECT_TRUE(ozz::math::CpuSupportsAvx2Fma());
+#elif !defined(OZZ_SIMD_AVX2_DISPATCH)
+  EXPECT_FALSE(ozz::math::CpuSupportsAvx2Fma());
+#endif
+}
+
 TEST(LoadFloat, ozz_simd_math) {
   const SimdFloat4 fX = ozz::math::simd_float4::LoadX(15.f);
   EXPECT_SIMDFLOAT_EQ(fX, 15.f, 0.f, 0.f, 0.f);
@@ -835,3 +845,36 @@ TEST(SimdHalf, ozz_simd_math) {
     }
   }
 }
+
+TEST(BatchHalf, ozz_simd_math) {
+  // Count isn't a multiple of 8 nor 4, to test all conversion paths.
+  const size_t kCount = 19;
+  float floats[kCount];
+  for (size_t i = 0; i < kCount; ++i) {
+    floats[i] = (static_cast<float>(i) - 9.f) * 1.37f;
+  }
+  floats[0] = 65604.f;
+  floats[1] = -std::numeric_limits<float>::infinity();
+  floats[2] = -0.f;
+
+  uint16_t halves[kCount];
+  ozz::math::FloatToHalf(floats, kCount, halves);
+  for (size_t i = 0; i < kCount; ++i) {
+    EXPECT_EQ(halves[i], ozz::math::FloatToHalf(floats[i]));
+  }
+
+  float back[kCount];
+  ozz::math::HalfToFloat(halves, kCount, back);
+  for (size_t i = 0; i < kCount; ++i) {
+    EXPECT_EQ(back[i], ozz::math::HalfToFloat(halves[i]));
+  }
+  EXPECT_EQ(back[0], std::numeric_limits<float>::infinity());
+  EXPECT_EQ(back[1], -std::numeric_limits<float>::infinity());
+  for (size_t i = 2; i < kCount; ++i) {
+    EXPECT_NEAR(back[i], floats[i], 1e-2f);
+  }
+
+  // Empty conversion doesn't touch outputs.
+  ozz::math::FloatToHalf(floats, 0, NULL);
+  ozz::math::HalfToFloat(halves, 0, NULL);
+}
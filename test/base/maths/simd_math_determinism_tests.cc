@@ -0,0 +1,305 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include <stdint.h>
+#include <cmath>
+#include <cstring>
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/soa_quaternion.h"
+
+// These tests are only built when OZZ_BUILD_SIMD_DETERMINISTIC is defined.
+// They compare simd results, bit to bit, with scalar expressions written in
+// the canonical operation order every simd implementation must respect. As
+// scalar code is compiled with the same floating point settings on any
+// platform, matching them guarantees implementations are identical.
+
+using ozz::math::Float4x4;
+using ozz::math::SimdFloat4;
+
+namespace {
+
+uint32_t Bits(float _f) {
+  uint32_t bits;
+  std::memcpy(&bits, &_f, sizeof(bits));
+  return bits;
+}
+
+#define EXPECT_SIMDFLOAT_BITS_EQ(_expected, _x, _y, _z, _w)                   \
+  do {                                                                        \
+    OZZ_ALIGN(16) float f[4];                                                 \
+    ozz::math::StorePtr(_expected, f);                                        \
+    EXPECT_EQ(Bits(f[0]), Bits(_x));                                          \
+    EXPECT_EQ(Bits(f[1]), Bits(_y));                                          \
+    EXPECT_EQ(Bits(f[2]), Bits(_z));                                          \
+    EXPECT_EQ(Bits(f[3]), Bits(_w));                                          \
+  } while (void(0), 0)
+
+#define EXPECT_SIMDFLOAT_X_BITS_EQ(_expected, _x)                             \
+  EXPECT_EQ(Bits(ozz::math::GetX(_expected)), Bits(_x))
+
+// Deterministic pseudo random values, spread over a few orders of magnitude
+// and signs so that rounding differences can't remain hidden.
+class Generator {
+ public:
+  Generator() : seed_(0x2545f491u) {}
+  float Next() {
+    seed_ = seed_ * 1664525u + 1013904223u;
+    const float mantissa = static_cast<float>(seed_ >> 8) / 16777216.f;
+    const float scale = kScales[(seed_ >> 2) & 3];
+    return (seed_ & 1) ? mantissa * scale : -mantissa * scale;
+  }
+
+ private:
+  static const float kScales[4];
+  uint32_t seed_;
+};
+const float Generator::kScales[4] = {.01f, 1.f, 3.3f, 1000.f};
+
+const int kIterations = 1024;
+}  // namespace
+
+TEST(Arithmetic, SimdDeterminism) {
+  Generator gen;
+  for (int i = 0; i < kIterations; ++i) {
+    const float a[4] = {gen.Next(), gen.Next(), gen.Next(), gen.Next()};
+    const float b[4] = {gen.Next(), gen.Next(), gen.Next(), gen.Next()};
+    const float c[4] = {gen.Next(), gen.Next(), gen.Next(), gen.Next()};
+    const SimdFloat4 va = ozz::math::simd_float4::LoadPtrU(a);
+    const SimdFloat4 vb = ozz::math::simd_float4::LoadPtrU(b);
+    const SimdFloat4 vc = ozz::math::simd_float4::LoadPtrU(c);
+
+    EXPECT_SIMDFLOAT_BITS_EQ(va * vb, a[0] * b[0], a[1] * b[1], a[2] * b[2],
+                             a[3] * b[3]);
+    EXPECT_SIMDFLOAT_BITS_EQ(va / vb, a[0] / b[0], a[1] / b[1], a[2] / b[2],
+                             a[3] / b[3]);
+    EXPECT_SIMDFLOAT_BITS_EQ(ozz::math::MAdd(va, vb, vc), a[0] * b[0] + c[0],
+                             a[1] * b[1] + c[1], a[2] * b[2] + c[2],
+                             a[3] * b[3] + c[3]);
+    EXPECT_SIMDFLOAT_BITS_EQ(ozz::math::MSub(va, vb, vc), a[0] * b[0] - c[0],
+                             a[1] * b[1] - c[1], a[2] * b[2] - c[2],
+                             a[3] * b[3] - c[3]);
+    EXPECT_SIMDFLOAT_BITS_EQ(ozz::math::NMAdd(va, vb, vc), c[0] - a[0] * b[0],
+                             c[1] - a[1] * b[1], c[2] - a[2] * b[2],
+                             c[3] - a[3] * b[3]);
+    EXPECT_SIMDFLOAT_BITS_EQ(ozz::math::NMSub(va, vb, vc),
+                             -(a[0] * b[0]) - c[0], -(a[1] * b[1]) - c[1],
+                             -(a[2] * b[2]) - c[2], -(a[3] * b[3]) - c[3]);
+    EXPECT_SIMDFLOAT_BITS_EQ(ozz::math::Lerp(va, vb, vc),
+                             c[0] * (b[0] - a[0]) + a[0],
+                             c[1] * (b[1] - a[1]) + a[1],
+                             c[2] * (b[2] - a[2]) + a[2],
+                             c[3] * (b[3] - a[3]) + a[3]);
+  }
+}
+
+TEST(Horizontal, SimdDeterminism) {
+  Generator gen;
+  for (int i = 0; i < kIterations; ++i) {
+    const float a[4] = {gen.Next(), gen.Next(), gen.Next(), gen.Next()};
+    const float b[4] = {gen.Next(), gen.Next(), gen.Next(), gen.Next()};
+    const SimdFloat4 va = ozz::math::simd_float4::LoadPtrU(a);
+    const SimdFloat4 vb = ozz::math::simd_float4::LoadPtrU(b);
+
+    EXPECT_SIMDFLOAT_X_BITS_EQ(ozz::math::HAdd2(va), a[0] + a[1]);
+    EXPECT_SIMDFLOAT_X_BITS_EQ(ozz::math::HAdd3(va), (a[0] + a[1]) + a[2]);
+    EXPECT_SIMDFLOAT_X_BITS_EQ(ozz::math::HAdd4(va),
+                               (a[0] + a[2]) + (a[1] + a[3]));
+
+    const float ab[4] = {a[0] * b[0], a[1] * b[1], a[2] * b[2], a[3] * b[3]};
+    EXPECT_SIMDFLOAT_X_BITS_EQ(ozz::math::Dot2(va, vb), ab[0] + ab[1]);
+    EXPECT_SIMDFLOAT_X_BITS_EQ(ozz::math::Dot3(va, vb),
+                               (ab[0] + ab[1]) + ab[2]);
+    EXPECT_SIMDFLOAT_X_BITS_EQ(ozz::math::Dot4(va, vb),
+                               (ab[0] + ab[2]) + (ab[1] + ab[3]));
+
+    const float aa[4] = {a[0] * a[0], a[1] * a[1], a[2] * a[2], a[3] * a[3]};
+    const float len2 = aa[0] + aa[1];
+    const float len3 = (aa[0] + aa[1]) + aa[2];
+    const float len4 = (aa[0] + aa[2]) + (aa[1] + aa[3]);
+    EXPECT_SIMDFLOAT_X_BITS_EQ(ozz::math::Length2Sqr(va), len2);
+    EXPECT_SIMDFLOAT_X_BITS_EQ(ozz::math::Length3Sqr(va), len3);
+    EXPECT_SIMDFLOAT_X_BITS_EQ(ozz::math::Length4Sqr(va), len4);
+    EXPECT_SIMDFLOAT_X_BITS_EQ(ozz::math::Length2(va), std::sqrt(len2));
+    EXPECT_SIMDFLOAT_X_BITS_EQ(ozz::math::Length3(va), std::sqrt(len3));
+    EXPECT_SIMDFLOAT_X_BITS_EQ(ozz::math::Length4(va), std::sqrt(len4));
+
+    const float inv3 = 1.f / std::sqrt(len3);
+    const float inv4 = 1.f / std::sqrt(len4);
+    EXPECT_SIMDFLOAT_BITS_EQ(ozz::math::Normalize3(va), a[0] * inv3,
+                             a[1] * inv3, a[2] * inv3, a[3]);
+    EXPECT_SIMDFLOAT_BITS_EQ(ozz::math::NormalizeEst3(va), a[0] * inv3,
+                             a[1] * inv3, a[2] * inv3, a[3]);
+    EXPECT_SIMDFLOAT_BITS_EQ(ozz::math::Normalize4(va), a[0] * inv4,
+                             a[1] * inv4, a[2] * inv4, a[3] * inv4);
+    EXPECT_SIMDFLOAT_BITS_EQ(ozz::math::NormalizeEst4(va), a[0] * inv4,
+                             a[1] * inv4, a[2] * inv4, a[3] * inv4);
+  }
+}
+
+TEST(Estimates, SimdDeterminism) {
+  Generator gen;
+  for (int i = 0; i < kIterations; ++i) {
+    const float a[4] = {std::abs(gen.Next()), std::abs(gen.Next()),
+                        std::abs(gen.Next()), std::abs(gen.Next())};
+    const SimdFloat4 va = ozz::math::simd_float4::LoadPtrU(a);
+
+    const float rcp[4] = {1.f / a[0], 1.f / a[1], 1.f / a[2], 1.f / a[3]};
+    EXPECT_SIMDFLOAT_BITS_EQ(ozz::math::RcpEst(va), rcp[0], rcp[1], rcp[2],
+                             rcp[3]);
+    EXPECT_SIMDFLOAT_BITS_EQ(ozz::math::RcpEstNR(va), rcp[0], rcp[1], rcp[2],
+                             rcp[3]);
+    EXPECT_SIMDFLOAT_X_BITS_EQ(ozz::math::RcpEstX(va), rcp[0]);
+    EXPECT_SIMDFLOAT_X_BITS_EQ(ozz::math::RcpEstXNR(va), rcp[0]);
+
+    const float sqrt[4] = {std::sqrt(a[0]), std::sqrt(a[1]), std::sqrt(a[2]),
+                           std::sqrt(a[3])};
+    EXPECT_SIMDFLOAT_BITS_EQ(ozz::math::Sqrt(va), sqrt[0], sqrt[1], sqrt[2],
+                             sqrt[3]);
+    EXPECT_SIMDFLOAT_X_BITS_EQ(ozz::math::SqrtX(va), sqrt[0]);
+
+    const float rsqrt[4] = {1.f / sqrt[0], 1.f / sqrt[1], 1.f / sqrt[2],
+                            1.f / sqrt[3]};
+    EXPECT_SIMDFLOAT_BITS_EQ(ozz::math::RSqrtEst(va), rsqrt[0], rsqrt[1],
+                             rsqrt[2], rsqrt[3]);
+    EXPECT_SIMDFLOAT_BITS_EQ(ozz::math::RSqrtEstNR(va), rsqrt[0], rsqrt[1],
+                             rsqrt[2], rsqrt[3]);
+    EXPECT_SIMDFLOAT_X_BITS_EQ(ozz::math::RSqrtEstX(va), rsqrt[0]);
+    EXPECT_SIMDFLOAT_X_BITS_EQ(ozz::math::RSqrtEstXNR(va), rsqrt[0]);
+  }
+}
+
+TEST(Float4x4, SimdDeterminism) {
+  Generator gen;
+  for (int i = 0; i < kIterations; ++i) {
+    float m[4][4];
+    float n[4][4];
+    for (int c = 0; c < 4; ++c) {
+      for (int r = 0; r < 4; ++r) {
+        m[c][r] = gen.Next();
+        n[c][r] = gen.Next();
+      }
+    }
+    const Float4x4 vm = {{ozz::math::simd_float4::LoadPtrU(m[0]),
+                          ozz::math::simd_float4::LoadPtrU(m[1]),
+                          ozz::math::simd_float4::LoadPtrU(m[2]),
+                          ozz::math::simd_float4::LoadPtrU(m[3])}};
+    const Float4x4 vn = {{ozz::math::simd_float4::LoadPtrU(n[0]),
+                          ozz::math::simd_float4::LoadPtrU(n[1]),
+                          ozz::math::simd_float4::LoadPtrU(n[2]),
+                          ozz::math::simd_float4::LoadPtrU(n[3])}};
+    const float* v = n[0];
+    const SimdFloat4 vv = vn.cols[0];
+
+    float mv[4], point[4], vector[4];
+    for (int r = 0; r < 4; ++r) {
+      mv[r] = (m[0][r] * v[0] + m[1][r] * v[1]) +
+              (m[2][r] * v[2] + m[3][r] * v[3]);
+      point[r] = (m[0][r] * v[0] + m[1][r] * v[1]) + (m[2][r] * v[2] + m[3][r]);
+      vector[r] = (m[0][r] * v[0] + m[2][r] * v[2]) + m[1][r] * v[1];
+    }
+    EXPECT_SIMDFLOAT_BITS_EQ(vm * vv, mv[0], mv[1], mv[2], mv[3]);
+    EXPECT_SIMDFLOAT_BITS_EQ(ozz::math::TransformPoint(vm, vv), point[0],
+                             point[1], point[2], point[3]);
+    EXPECT_SIMDFLOAT_BITS_EQ(ozz::math::TransformVector(vm, vv), vector[0],
+                             vector[1], vector[2], vector[3]);
+
+    const Float4x4 mn = vm * vn;
+    for (int c = 0; c < 4; ++c) {
+      float col[4];
+      for (int r = 0; r < 4; ++r) {
+        col[r] = (m[0][r] * n[c][0] + m[1][r] * n[c][1]) +
+                 (m[2][r] * n[c][2] + m[3][r] * n[c][3]);
+      }
+      EXPECT_SIMDFLOAT_BITS_EQ(mn.cols[c], col[0], col[1], col[2], col[3]);
+    }
+  }
+}
+
+TEST(SoaQuaternion, SimdDeterminism) {
+  Generator gen;
+  for (int i = 0; i < kIterations; ++i) {
+    float a[4][4];
+    float b[4][4];
+    float f[4];
+    for (int c = 0; c < 4; ++c) {
+      f[c] = std::abs(gen.Next()) / 1000.f;
+      for (int r = 0; r < 4; ++r) {
+        a[c][r] = gen.Next();
+        b[c][r] = gen.Next();
+      }
+    }
+    const ozz::math::SoaQuaternion qa = {
+        ozz::math::simd_float4::LoadPtrU(a[0]),
+        ozz::math::simd_float4::LoadPtrU(a[1]),
+        ozz::math::simd_float4::LoadPtrU(a[2]),
+        ozz::math::simd_float4::LoadPtrU(a[3])};
+    const ozz::math::SoaQuaternion qb = {
+        ozz::math::simd_float4::LoadPtrU(b[0]),
+        ozz::math::simd_float4::LoadPtrU(b[1]),
+        ozz::math::simd_float4::LoadPtrU(b[2]),
+        ozz::math::simd_float4::LoadPtrU(b[3])};
+    const SimdFloat4 vf = ozz::math::simd_float4::LoadPtrU(f);
+
+    // Soa quaternion functions process lanes independently, with component
+    // sums ordered x, y, z, w. Estimated normalization is exact in
+    // deterministic mode.
+    float lerp[4][4], norm[4][4];
+    for (int l = 0; l < 4; ++l) {
+      for (int c = 0; c < 4; ++c) {
+        lerp[c][l] = f[l] * (b[c][l] - a[c][l]) + a[c][l];
+      }
+      const float len2 = ((lerp[0][l] * lerp[0][l] + lerp[1][l] * lerp[1][l]) +
+                          lerp[2][l] * lerp[2][l]) +
+                         lerp[3][l] * lerp[3][l];
+      const float inv_len = 1.f / std::sqrt(len2);
+      for (int c = 0; c < 4; ++c) {
+        norm[c][l] = lerp[c][l] * inv_len;
+      }
+    }
+    const ozz::math::SoaQuaternion nlerp = NLerp(qa, qb, vf);
+    const ozz::math::SoaQuaternion nlerp_est = NLerpEst(qa, qb, vf);
+    EXPECT_SIMDFLOAT_BITS_EQ(nlerp.x, norm[0][0], norm[0][1], norm[0][2],
+                             norm[0][3]);
+    EXPECT_SIMDFLOAT_BITS_EQ(nlerp.y, norm[1][0], norm[1][1], norm[1][2],
+                             norm[1][3]);
+    EXPECT_SIMDFLOAT_BITS_EQ(nlerp.z, norm[2][0], norm[2][1], norm[2][2],
+                             norm[2][3]);
+    EXPECT_SIMDFLOAT_BITS_EQ(nlerp.w, norm[3][0], norm[3][1], norm[3][2],
+                             norm[3][3]);
+    EXPECT_SIMDFLOAT_BITS_EQ(nlerp_est.x, norm[0][0], norm[0][1], norm[0][2],
+                             norm[0][3]);
+    EXPECT_SIMDFLOAT_BITS_EQ(nlerp_est.y, norm[1][0], norm[1][1], norm[1][2],
+                             norm[1][3]);
+    EXPECT_SIMDFLOAT_BITS_EQ(nlerp_est.z, norm[2][0], norm[2][1], norm[2][2],
+                             norm[2][3]);
+    EXPECT_SIMDFLOAT_BITS_EQ(nlerp_est.w, norm[3][0], norm[3][1], norm[3][2],
+                             norm[3][3]);
+  }
+}
@@ -0,0 +1,91 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/base/maths/soa_half_transform.h"
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/gtest_helper.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+
+using ozz::math::SoaHalfTransform;
+using ozz::math::SoaTransform;
+
+TEST(SoaHalfTransformSize, ozz_soa_math) {
+  EXPECT_EQ(sizeof(SoaHalfTransform) * 2, sizeof(SoaTransform));
+}
+
+TEST(SoaHalfTransformExact, ozz_soa_math) {
+  // Values are all representable as halves.
+  const SoaTransform transform = {
+      {ozz::math::simd_float4::Load(0.f, 1.f, -2.f, .5f),
+       ozz::math::simd_float4::Load(-.25f, 1024.f, 3.f, -4.f),
+       ozz::math::simd_float4::Load(5.f, -6.f, .125f, 65504.f)},
+      {ozz::math::simd_float4::Load(0.f, .5f, -.5f, 1.f),
+       ozz::math::simd_float4::Load(.25f, 0.f, .5f, 0.f),
+       ozz::math::simd_float4::Load(-.75f, .5f, .5f, 0.f),
+       ozz::math::simd_float4::Load(.5f, -.5f, -.5f, 0.f)},
+      {ozz::math::simd_float4::Load(1.f, 2.f, 3.f, 4.f),
+       ozz::math::simd_float4::Load(-1.f, -2.f, -3.f, -4.f),
+       ozz::math::simd_float4::Load(.5f, 8.f, 16.f, 0.f)}};
+  const SoaTransform unpacked =
+      ozz::math::UnpackHalf(ozz::math::PackHalf(transform));
+  EXPECT_SOAFLOAT3_EQ(unpacked.translation, 0.f, 1.f, -2.f, .5f, -.25f,
+                      1024.f, 3.f, -4.f, 5.f, -6.f, .125f, 65504.f);
+  EXPECT_SOAQUATERNION_EQ(unpacked.rotation, 0.f, .5f, -.5f, 1.f, .25f, 0.f,
+                          .5f, 0.f, -.75f, .5f, .5f, 0.f, .5f, -.5f, -.5f,
+                          0.f);
+  EXPECT_SOAFLOAT3_EQ(unpacked.scale, 1.f, 2.f, 3.f, 4.f, -1.f, -2.f, -3.f,
+                      -4.f, .5f, 8.f, 16.f, 0.f);
+}
+
+TEST(SoaHalfTransformPrecision, ozz_soa_math) {
+  const SoaTransform transform = {
+      {ozz::math::simd_float4::Load(.1f, -1.3f, 1.234f, -.001f),
+       ozz::math::simd_float4::Load(.2f, .26f, -1.468f, .002f),
+       ozz::math::simd_float4::Load(.3f, -.39f, .3702f, -.003f)},
+      {ozz::math::simd_float4::Load(.70710677f, 0.f, .1f, -.3f),
+       ozz::math::simd_float4::Load(0.f, .70710677f, .2f, .4f),
+       ozz::math::simd_float4::Load(0.f, 0.f, .3f, -.5f),
+       ozz::math::simd_float4::Load(.70710677f, .70710677f, .9273618f,
+                                    .70710677f)},
+      {ozz::math::simd_float4::Load(1.1f, .9f, 1.f, 1.93f),
+       ozz::math::simd_float4::Load(1.2f, .8f, 1.f, 1.92f),
+       ozz::math::simd_float4::Load(1.3f, .7f, 1.f, 1.91f)}};
+  const SoaTransform unpacked =
+      ozz::math::UnpackHalf(ozz::math::PackHalf(transform));
+
+  // Error is below half precision spacing, which is 2^-10 in [1,2[.
+  EXPECT_SOAFLOAT3_EQ_EST(unpacked.translation, .1f, -1.3f, 1.234f, -.001f,
+                          .2f, .26f, -1.468f, .002f, .3f, -.39f, .3702f,
+                          -.003f);
+  EXPECT_SOAQUATERNION_EQ_EST(unpacked.rotation, .70710677f, 0.f, .1f, -.3f,
+                              0.f, .70710677f, .2f, .4f, 0.f, 0.f, .3f, -.5f,
+                              .70710677f, .70710677f, .9273618f, .70710677f);
+  EXPECT_SOAFLOAT3_EQ_EST(unpacked.scale, 1.1f, .9f, 1.f, 1.93f, 1.2f, .8f, 1.f,
+                          1.92f, 1.3f, .7f, 1.f, 1.91f);
+}
@@ -108,6 +108,19 @@ TEST(SoaQuaternionArithmetic, ozz_soa_math) {
                               1.f, .763762f, .74627789f);
   EXPECT_TRUE(ozz::math::AreAllTrue(IsNormalizedEst(normalize_est)));
 
+  const SoaQuaternion normalize_est0 = ozz::math::NormalizeEstNR<0>(denorm);
+  EXPECT_SOAQUATERNION_EQ_EST(normalize_est0, .033389f, 0.f, .1091089f,
+                              .1492555f, .267112f, 0.f, .3273268f, .348263f,
+                              .53422445f, 0.f, .545544f, .547270f, .80133667f,
+                              1.f, .763762f, .74627789f);
+
+  const SoaQuaternion normalize_est2 = ozz::math::NormalizeEstNR<2>(denorm);
+  EXPECT_SOAQUATERNION_EQ(normalize_est2, .033389f, 0.f, .1091089f, .1492555f,
+                          .267112f, 0.f, .3273268f, .348263f, .53422445f, 0.f,
+                          .545544f, .547270f, .80133667f, 1.f, .763762f,
+                          .74627789f);
+  EXPECT_TRUE(ozz::math::AreAllTrue(IsNormalized(normalize_est2)));
+
   const SoaQuaternion lerp_0 = Lerp(a, b, ozz::math::simd_float4::zero());
   EXPECT_SOAQUATERNION_EQ(lerp_0, .70710677f, 0.f, 0.f, .382683432f, 0.f, 0.f,
                           .70710677f, 0.f, 0.f, 0.f, 0.f, 0.f, .70710677f, 1.f,
@@ -163,4 +176,20 @@ TEST(SoaQuaternionArithmetic, ozz_soa_math) {
                               0.f, 0.f, .70710677f, .70710677f, .70710677f,
                               .97047764f);
   EXPECT_TRUE(ozz::math::AreAllTrue(IsNormalizedEst(nlerp_est_m)));
+
+  const SoaQuaternion nlerp_exact_m =
+      ozz::math::NLerp<ozz::math::ExactNormalization>(
+          a, b, ozz::math::simd_float4::Load(0.f, 1.f, 1.f, .2f));
+  EXPECT_SOAQUATERNION_EQ(nlerp_exact_m, .70710677f, .70710677f, 0.f,
+                          .24119100f, 0.f, 0.f, .70710677f, 0.f, 0.f, 0.f, 0.f,
+                          0.f, .70710677f, .70710677f, .70710677f, .97047764f);
+  EXPECT_TRUE(ozz::math::AreAllTrue(IsNormalized(nlerp_exact_m)));
+
+  const SoaQuaternion nlerp_est0_m =
+      ozz::math::NLerp<ozz::math::EstimatedNormalization<0> >(
+          a, b, ozz::math::simd_float4::Load(0.f, 1.f, 1.f, .2f));
+  EXPECT_SOAQUATERNION_EQ_EST(nlerp_est0_m, .70710677f, .70710677f, 0.f,
+                              .24119100f, 0.f, 0.f, .70710677f, 0.f, 0.f, 0.f,
+                              0.f, 0.f, .70710677f, .70710677f, .70710677f,
+                              .97047764f);
 }
@@ -0,0 +1,116 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/base/maths/soa_transform_utils.h"
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/gtest_helper.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/maths/transform.h"
+
+using ozz::math::SoaTransform;
+using ozz::math::Transform;
+
+TEST(PackSoaTransforms, ozz_soa_math) {
+  Transform transforms[5];
+  for (int i = 0; i < 5; ++i) {
+    const float f = static_cast<float>(i);
+    const Transform transform = {ozz::math::Float3(f, f + 10.f, f + 20.f),
+                                 ozz::math::Quaternion(f, f + 1.f, f + 2.f,
+                                                       f + 3.f),
+                                 ozz::math::Float3(f + 30.f, f + 40.f, 1.f)};
+    transforms[i] = transform;
+  }
+
+  // Output too small.
+  SoaTransform soa_transforms[2];
+  EXPECT_FALSE(ozz::math::PackSoaTransforms(
+      transforms,
+      ozz::Range<SoaTransform>(soa_transforms, 1)));
+
+  EXPECT_TRUE(ozz::math::PackSoaTransforms(transforms,
+                                           soa_transforms));
+  EXPECT_SOAFLOAT3_EQ(soa_transforms[0].translation, 0.f, 1.f, 2.f, 3.f, 10.f,
+                      11.f, 12.f, 13.f, 20.f, 21.f, 22.f, 23.f);
+  EXPECT_SOAQUATERNION_EQ(soa_transforms[0].rotation, 0.f, 1.f, 2.f, 3.f, 1.f,
+                          2.f, 3.f, 4.f, 2.f, 3.f, 4.f, 5.f, 3.f, 4.f, 5.f,
+                          6.f);
+  EXPECT_SOAFLOAT3_EQ(soa_transforms[0].scale, 30.f, 31.f, 32.f, 33.f, 40.f,
+                      41.f, 42.f, 43.f, 1.f, 1.f, 1.f, 1.f);
+
+  // Remaining lanes are set to identity.
+  EXPECT_SOAFLOAT3_EQ(soa_transforms[1].translation, 4.f, 0.f, 0.f, 0.f, 14.f,
+                      0.f, 0.f, 0.f, 24.f, 0.f, 0.f, 0.f);
+  EXPECT_SOAQUATERNION_EQ(soa_transforms[1].rotation, 4.f, 0.f, 0.f, 0.f, 5.f,
+                          0.f, 0.f, 0.f, 6.f, 0.f, 0.f, 0.f, 7.f, 1.f, 1.f,
+                          1.f);
+  EXPECT_SOAFLOAT3_EQ(soa_transforms[1].scale, 34.f, 1.f, 1.f, 1.f, 44.f, 1.f,
+                      1.f, 1.f, 1.f, 1.f, 1.f, 1.f);
+
+  // Empty input.
+  EXPECT_TRUE(ozz::math::PackSoaTransforms(ozz::Range<const Transform>(),
+                                           ozz::Range<SoaTransform>()));
+}
+
+TEST(UnpackSoaTransforms, ozz_soa_math) {
+  Transform transforms[6];
+  for (int i = 0; i < 6; ++i) {
+    const float f = static_cast<float>(i);
+    const Transform transform = {ozz::math::Float3(f, -f, f * 2.f),
+                                 ozz::math::Quaternion(f, f + 1.f, f + 2.f,
+                                                       f + 3.f),
+                                 ozz::math::Float3(f + 1.f, 1.f, -f)};
+    transforms[i] = transform;
+  }
+  SoaTransform soa_transforms[2];
+  ASSERT_TRUE(ozz::math::PackSoaTransforms(transforms,
+                                           soa_transforms));
+
+  // Output is too big.
+  Transform unpacked[9];
+  EXPECT_FALSE(ozz::math::UnpackSoaTransforms(soa_transforms,
+                                              unpacked));
+
+  // Unpacks 5 transforms, last one is left unchanged.
+  unpacked[5] = Transform::identity();
+  EXPECT_TRUE(ozz::math::UnpackSoaTransforms(
+      soa_transforms, ozz::Range<Transform>(unpacked, 5)));
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_FLOAT3_EQ(unpacked[i].translation, transforms[i].translation.x,
+                     transforms[i].translation.y, transforms[i].translation.z);
+    EXPECT_QUATERNION_EQ(unpacked[i].rotation, transforms[i].rotation.x,
+                         transforms[i].rotation.y, transforms[i].rotation.z,
+                         transforms[i].rotation.w);
+    EXPECT_FLOAT3_EQ(unpacked[i].scale, transforms[i].scale.x,
+                     transforms[i].scale.y, transforms[i].scale.z);
+  }
+  EXPECT_FLOAT3_EQ(unpacked[5].translation, 0.f, 0.f, 0.f);
+  EXPECT_QUATERNION_EQ(unpacked[5].rotation, 0.f, 0.f, 0.f, 1.f);
+  EXPECT_FLOAT3_EQ(unpacked[5].scale, 1.f, 1.f, 1.f);
+}
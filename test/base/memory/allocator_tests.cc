@@ -29,6 +29,7 @@
 
 #include "gtest/gtest.h"
 
+#include "ozz/base/gtest_helper.h"
 #include "ozz/base/maths/math_ex.h"
 
 TEST(Allocate, Memory) {
@@ -178,3 +179,48 @@ TEST(AllocatorOverride, Memory) {
 
   EXPECT_EQ(ozz::memory::SetDefaulAllocator(previous), current);
 }
+
+TEST(ThreadScratchAllocator, Memory) {
+  // Defaults to the default allocator.
+  EXPECT_EQ(ozz::memory::thread_scratch_allocator(),
+            ozz::memory::default_allocator());
+
+  TestAllocator test_allocator;
+  EXPECT_TRUE(ozz::memory::SetThreadScratchAllocator(&test_allocator) == NULL);
+  EXPECT_EQ(ozz::memory::thread_scratch_allocator(), &test_allocator);
+
+  void* alloc = ozz::memory::thread_scratch_allocator()->Allocate(1, 1);
+  EXPECT_EQ(alloc, test_allocator.hard_coded_address());
+
+  // Default allocator isn't affected.
+  EXPECT_NE(ozz::memory::default_allocator(), &test_allocator);
+
+  // Restores default.
+  EXPECT_EQ(ozz::memory::SetThreadScratchAllocator(NULL), &test_allocator);
+  EXPECT_EQ(ozz::memory::thread_scratch_allocator(),
+            ozz::memory::default_allocator());
+}
+
+TEST(NoAllocation, Memory) {
+  EXPECT_TRUE(ozz::memory::allocations_allowed());
+  {
+    ozz::memory::ScopedNoAllocation no_allocation;
+    EXPECT_FALSE(ozz::memory::allocations_allowed());
+    {
+      ozz::memory::ScopedNoAllocation nested;
+      EXPECT_FALSE(ozz::memory::allocations_allowed());
+    }
+    EXPECT_FALSE(ozz::memory::allocations_allowed());
+
+    EXPECT_ASSERTION(ozz::memory::default_allocator(), "ScopedNoAllocation");
+    EXPECT_ASSERTION(ozz::memory::thread_scratch_allocator(),
+                     "ScopedNoAllocation");
+
+    // A dedicated scratch allocator is still allowed.
+    TestAllocator test_allocator;
+    ozz::memory::SetThreadScratchAllocator(&test_allocator);
+    EXPECT_EQ(ozz::memory::thread_scratch_allocator(), &test_allocator);
+    ozz::memory::SetThreadScratchAllocator(NULL);
+  }
+  EXPECT_TRUE(ozz::memory::allocations_allowed());
+}
@@ -0,0 +1,102 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+#include "ozz/base/memory/large_page_allocator.h"
+
+#include <cstring>
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/maths/math_ex.h"
+
+using ozz::memory::LargePageAllocator;
+
+TEST(Allocate, LargePageAllocator) {
+  LargePageAllocator allocator(1 << 20);
+  EXPECT_EQ(allocator.mapped_bytes(), 0u);
+
+  // Blocks are allocated from the same region.
+  void* p0 = allocator.Allocate(12, 64);
+  ASSERT_TRUE(p0 != NULL);
+  EXPECT_TRUE(ozz::math::IsAligned(p0, 64));
+  memset(p0, 0xf, 12);
+  const size_t mapped = allocator.mapped_bytes();
+  EXPECT_GE(mapped, 1u << 20);
+  EXPECT_LE(allocator.large_page_bytes(), mapped);
+
+  void* p1 = allocator.Allocate(1000, 4);
+  ASSERT_TRUE(p1 != NULL);
+  EXPECT_TRUE(p1 > p0);
+  memset(p1, 0xf, 1000);
+  EXPECT_EQ(allocator.mapped_bytes(), mapped);
+
+  // A block bigger than the region size gets its own region, released on
+  // deallocation.
+  const size_t big_size = mapped + 1;
+  char* big = reinterpret_cast<char*>(allocator.Allocate(big_size, 16));
+  ASSERT_TRUE(big != NULL);
+  big[0] = 1;
+  big[big_size - 1] = 2;
+  EXPECT_GT(allocator.mapped_bytes(), mapped + big_size);
+  allocator.Deallocate(big);
+  EXPECT_EQ(allocator.mapped_bytes(), mapped);
+
+  // Fills the region, which maps a new one.
+  void* blocks[64];
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(blocks); ++i) {
+    blocks[i] = allocator.Allocate(mapped / 16, 16);
+    ASSERT_TRUE(blocks[i] != NULL);
+    memset(blocks[i], 0, mapped / 16);
+  }
+  EXPECT_GT(allocator.mapped_bytes(), mapped);
+
+  // Full regions are unmapped once empty.
+  allocator.Deallocate(p0);
+  allocator.Deallocate(p1);
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(blocks); ++i) {
+    allocator.Deallocate(blocks[i]);
+  }
+  EXPECT_EQ(allocator.mapped_bytes(), mapped);
+
+  // NULL is supported.
+  allocator.Deallocate(NULL);
+}
+
+TEST(Reallocate, LargePageAllocator) {
+  LargePageAllocator allocator;
+
+  char* p = reinterpret_cast<char*>(allocator.Reallocate(NULL, 12, 4));
+  ASSERT_TRUE(p != NULL);
+  for (int i = 0; i < 12; ++i) {
+    p[i] = static_cast<char>(i);
+  }
+  p = reinterpret_cast<char*>(allocator.Reallocate(p, 5000, 16));
+  ASSERT_TRUE(p != NULL);
+  for (int i = 0; i < 12; ++i) {
+    EXPECT_EQ(p[i], i);
+  }
+  allocator.Deallocate(p);
+}
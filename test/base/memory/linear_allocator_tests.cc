@@ -0,0 +1,142 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/base/memory/linear_allocator.h"
+
+#include <cstring>
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/maths/math_ex.h"
+
+TEST(Allocate, LinearAllocator) {
+  ozz::memory::LinearAllocator allocator(1024);
+  EXPECT_EQ(allocator.capacity(), 1024u);
+  EXPECT_EQ(allocator.used(), 0u);
+
+  void* p0 = allocator.Allocate(12, 4);
+  ASSERT_TRUE(p0 != NULL);
+  EXPECT_TRUE(ozz::math::IsAligned(p0, 4));
+  memset(p0, 0xaa, 12);
+
+  void* p1 = allocator.Allocate(46, 64);
+  ASSERT_TRUE(p1 != NULL);
+  EXPECT_TRUE(ozz::math::IsAligned(p1, 64));
+  EXPECT_TRUE(p1 > p0);
+  memset(p1, 0xbb, 46);
+
+  // Allocating 0 byte gives a valid pointer.
+  void* p2 = allocator.Allocate(0, 4);
+  EXPECT_TRUE(p2 != NULL);
+
+  // Exhausted.
+  EXPECT_TRUE(allocator.Allocate(1024, 4) == NULL);
+  const size_t used = allocator.used();
+  EXPECT_TRUE(allocator.Allocate(allocator.capacity() - used, 1) == NULL);
+
+  // Reset releases everything.
+  allocator.Reset();
+  EXPECT_EQ(allocator.used(), 0u);
+  void* p3 = allocator.Allocate(12, 4);
+  EXPECT_EQ(p3, p0);
+}
+
+TEST(Deallocate, LinearAllocator) {
+  char buffer[256];
+  ozz::memory::LinearAllocator allocator(buffer, sizeof(buffer));
+  EXPECT_EQ(allocator.capacity(), sizeof(buffer));
+
+  // Freeing of a NULL pointer is valid.
+  allocator.Deallocate(NULL);
+
+  void* p0 = allocator.Allocate(16, 8);
+  ASSERT_TRUE(p0 != NULL);
+  const size_t used0 = allocator.used();
+  void* p1 = allocator.Allocate(16, 8);
+  ASSERT_TRUE(p1 != NULL);
+
+  // Not the last block, nothing's released.
+  const size_t used1 = allocator.used();
+  allocator.Deallocate(p0);
+  EXPECT_EQ(allocator.used(), used1);
+
+  // Last block is released.
+  allocator.Deallocate(p1);
+  EXPECT_EQ(allocator.used(), used0);
+  EXPECT_EQ(allocator.Allocate(16, 8), p1);
+}
+
+TEST(Reallocate, LinearAllocator) {
+  ozz::memory::LinearAllocator allocator(1024);
+
+  // Reallocating NULL pointer is valid
+  char* p0 = reinterpret_cast<char*>(allocator.Reallocate(NULL, 8, 4));
+  ASSERT_TRUE(p0 != NULL);
+  memcpy(p0, "ozz-anim", 8);
+
+  // Last block grows in place.
+  char* p1 = reinterpret_cast<char*>(allocator.Reallocate(p0, 16, 4));
+  EXPECT_EQ(p1, p0);
+  memcpy(p1 + 8, "ation!!", 8);
+
+  // Not the last block anymore, so content is copied to a new block.
+  void* other = allocator.Allocate(4, 4);
+  ASSERT_TRUE(other != NULL);
+  char* p2 = reinterpret_cast<char*>(allocator.Reallocate(p1, 32, 4));
+  ASSERT_TRUE(p2 != NULL);
+  EXPECT_TRUE(p2 != p1);
+  EXPECT_STREQ(p2, "ozz-animation!!");
+
+  // Buffer exhausted, block is unchanged.
+  EXPECT_TRUE(allocator.Reallocate(p2, 2048, 4) == NULL);
+  EXPECT_STREQ(p2, "ozz-animation!!");
+}
+
+struct Pod {
+  Pod() : i(46) {}
+  explicit Pod(int _i) : i(_i) {}
+  int i;
+};
+
+TEST(NewDelete, LinearAllocator) {
+  ozz::memory::LinearAllocator allocator(64);
+
+  Pod* p0 = allocator.New<Pod>();
+  ASSERT_TRUE(p0 != NULL);
+  EXPECT_EQ(p0->i, 46);
+
+  Pod* p1 = allocator.New<Pod>(69);
+  ASSERT_TRUE(p1 != NULL);
+  EXPECT_EQ(p1->i, 69);
+
+  // Objects are allocated from the linear allocator buffer.
+  EXPECT_TRUE(allocator.used() >= 2 * sizeof(Pod));
+
+  allocator.Delete(p1);
+  allocator.Delete(p0);
+  EXPECT_EQ(allocator.used(), 0u);
+}
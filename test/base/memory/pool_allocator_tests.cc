@@ -0,0 +1,91 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/base/memory/pool_allocator.h"
+
+#include <cstring>
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/maths/math_ex.h"
+
+TEST(Allocate, PoolAllocator) {
+  ozz::memory::PoolAllocator allocator(24, 3, 16);
+  EXPECT_EQ(allocator.block_size(), 24u);
+  EXPECT_EQ(allocator.block_count(), 3u);
+  EXPECT_EQ(allocator.allocated_count(), 0u);
+
+  void* p0 = allocator.Allocate(24, 16);
+  ASSERT_TRUE(p0 != NULL);
+  EXPECT_TRUE(ozz::math::IsAligned(p0, 16));
+  memset(p0, 0xaa, 24);
+  void* p1 = allocator.Allocate(1, 4);
+  ASSERT_TRUE(p1 != NULL);
+  EXPECT_TRUE(ozz::math::IsAligned(p1, 16));
+  memset(p1, 0xbb, 24);
+  EXPECT_EQ(allocator.allocated_count(), 2u);
+
+  // Too big or too aligned.
+  EXPECT_TRUE(allocator.Allocate(25, 4) == NULL);
+  EXPECT_TRUE(allocator.Allocate(4, 32) == NULL);
+
+  void* p2 = allocator.Allocate(0, 4);
+  ASSERT_TRUE(p2 != NULL);
+  EXPECT_TRUE(p2 != p0 && p2 != p1);
+
+  // Exhausted.
+  EXPECT_TRUE(allocator.Allocate(4, 4) == NULL);
+
+  // Freeing of a NULL pointer is valid.
+  allocator.Deallocate(NULL);
+
+  // Released blocks are reused.
+  allocator.Deallocate(p1);
+  EXPECT_EQ(allocator.allocated_count(), 2u);
+  EXPECT_EQ(allocator.Allocate(4, 4), p1);
+
+  allocator.Deallocate(p0);
+  allocator.Deallocate(p1);
+  allocator.Deallocate(p2);
+  EXPECT_EQ(allocator.allocated_count(), 0u);
+}
+
+TEST(Reallocate, PoolAllocator) {
+  ozz::memory::PoolAllocator allocator(16, 2, 4);
+
+  // Reallocating NULL pointer is valid
+  void* p0 = allocator.Reallocate(NULL, 8, 4);
+  ASSERT_TRUE(p0 != NULL);
+
+  // Fits in a block.
+  EXPECT_EQ(allocator.Reallocate(p0, 16, 4), p0);
+
+  // Doesn't fit.
+  EXPECT_TRUE(allocator.Reallocate(p0, 17, 4) == NULL);
+
+  allocator.Deallocate(p0);
+}
@@ -0,0 +1,181 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+#include "ozz/base/memory/thread_caching_allocator.h"
+
+#include <cstring>
+#if __cplusplus >= 201103L
+#include <thread>
+#include <vector>
+#endif  // __cplusplus
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/memory/tracking_allocator.h"
+
+using ozz::memory::ThreadCachingAllocator;
+
+TEST(Alignment, ThreadCachingAllocator) {
+  ozz::memory::TrackingAllocator tracking(ozz::memory::default_allocator());
+  ThreadCachingAllocator allocator(&tracking);
+
+  const size_t sizes[] = {0, 1, 15, 16, 17, 100, 4096, 4097, 10000};
+  const size_t alignments[] = {1, 4, 16, 64, 256};
+  for (size_t s = 0; s < OZZ_ARRAY_SIZE(sizes); ++s) {
+    for (size_t a = 0; a < OZZ_ARRAY_SIZE(alignments); ++a) {
+      void* p = allocator.Allocate(sizes[s], alignments[a]);
+      ASSERT_TRUE(p != NULL);
+      EXPECT_TRUE(ozz::math::IsAligned(p, alignments[a]));
+      EXPECT_TRUE(
+          ozz::math::IsAligned(p, ThreadCachingAllocator::kMinAlignment));
+      memset(p, 0xf, sizes[s]);
+      allocator.Deallocate(p);
+    }
+  }
+
+  // NULL is supported.
+  allocator.Deallocate(NULL);
+}
+
+TEST(Cache, ThreadCachingAllocator) {
+  ozz::memory::TrackingAllocator tracking(ozz::memory::default_allocator());
+  {
+    ThreadCachingAllocator allocator(&tracking);
+    const size_t base_count = tracking.stats().live_count;
+
+    void* p0 = allocator.Allocate(24, 4);
+    ASSERT_TRUE(p0 != NULL);
+    EXPECT_EQ(tracking.stats().live_count, base_count + 1);
+    allocator.Deallocate(p0);
+
+#if __cplusplus >= 201103L
+    // Block is cached, and reused by the next allocation of the same class.
+    EXPECT_EQ(allocator.cached_count(), 1u);
+    EXPECT_EQ(tracking.stats().live_count, base_count + 1);
+    void* p1 = allocator.Allocate(32, 16);
+    EXPECT_EQ(p1, p0);
+    EXPECT_EQ(allocator.cached_count(), 0u);
+
+    // Different class, or bigger alignment, doesn't reuse the block.
+    allocator.Deallocate(p1);
+    void* p2 = allocator.Allocate(33, 16);
+    EXPECT_NE(p2, p0);
+    void* p3 = allocator.Allocate(24, 32);
+    EXPECT_NE(p3, p0);
+    allocator.Deallocate(p2);
+    allocator.Deallocate(p3);
+
+    // Big blocks aren't cached.
+    void* p4 =
+        allocator.Allocate(ThreadCachingAllocator::kMaxCachedSize + 1, 4);
+    allocator.Deallocate(p4);
+    EXPECT_EQ(allocator.cached_count(), 2u);
+
+    // Trimming releases cached blocks.
+    allocator.Trim();
+    EXPECT_EQ(allocator.cached_count(), 0u);
+#endif  // __cplusplus
+    EXPECT_EQ(tracking.stats().live_count, base_count);
+
+    // Cache is bounded.
+    void* blocks[ThreadCachingAllocator::kMaxCachedBlocks + 10];
+    for (size_t i = 0; i < OZZ_ARRAY_SIZE(blocks); ++i) {
+      blocks[i] = allocator.Allocate(64, 16);
+    }
+    for (size_t i = 0; i < OZZ_ARRAY_SIZE(blocks); ++i) {
+      allocator.Deallocate(blocks[i]);
+    }
+    EXPECT_LE(allocator.cached_count(),
+              static_cast<size_t>(ThreadCachingAllocator::kMaxCachedBlocks));
+  }
+  // Destruction releases everything.
+  EXPECT_EQ(tracking.stats().live_count, 0u);
+}
+
+TEST(Reallocate, ThreadCachingAllocator) {
+  ThreadCachingAllocator allocator(ozz::memory::default_allocator());
+
+  char* p = reinterpret_cast<char*>(allocator.Reallocate(NULL, 12, 4));
+  ASSERT_TRUE(p != NULL);
+  for (int i = 0; i < 12; ++i) {
+    p[i] = static_cast<char>(i);
+  }
+  p = reinterpret_cast<char*>(allocator.Reallocate(p, 5000, 16));
+  ASSERT_TRUE(p != NULL);
+  for (int i = 0; i < 12; ++i) {
+    EXPECT_EQ(p[i], i);
+  }
+  p = reinterpret_cast<char*>(allocator.Reallocate(p, 4, 16));
+  ASSERT_TRUE(p != NULL);
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_EQ(p[i], i);
+  }
+  allocator.Deallocate(p);
+}
+
+#if __cplusplus >= 201103L
+TEST(Threading, ThreadCachingAllocator) {
+  ozz::memory::TrackingAllocator tracking(ozz::memory::default_allocator());
+  {
+    ThreadCachingAllocator allocator(&tracking);
+
+    // Threads allocate, and deallocate blocks allocated by other threads.
+    const int kNumThreads = 8;
+    const int kNumBlocks = 1000;
+    std::vector<void*> blocks(kNumThreads * kNumBlocks);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kNumThreads; ++t) {
+      threads.emplace_back([&allocator, &blocks, t]() {
+        for (int i = 0; i < kNumBlocks; ++i) {
+          const size_t size = 1 + (i * 37) % 8000;
+          void* p = allocator.Allocate(size, 16);
+          memset(p, t, size);
+          void* q = allocator.Allocate(size, 16);
+          allocator.Deallocate(p);
+          blocks[t * kNumBlocks + i] = q;
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    threads.clear();
+    for (int t = 0; t < kNumThreads; ++t) {
+      threads.emplace_back([&allocator, &blocks, t]() {
+        const int other = (t + 1) % kNumThreads;
+        for (int i = 0; i < kNumBlocks; ++i) {
+          allocator.Deallocate(blocks[other * kNumBlocks + i]);
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }
+  EXPECT_EQ(tracking.stats().live_count, 0u);
+}
+#endif  // __cplusplus
@@ -0,0 +1,128 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/base/memory/tracking_allocator.h"
+
+#include <cstring>
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/maths/math_ex.h"
+
+TEST(Stats, TrackingAllocator) {
+  ozz::memory::TrackingAllocator allocator(ozz::memory::default_allocator());
+  ozz::memory::AllocationStats stats = allocator.stats();
+  EXPECT_EQ(stats.live_bytes, 0u);
+  EXPECT_EQ(stats.peak_bytes, 0u);
+  EXPECT_EQ(stats.live_count, 0u);
+  EXPECT_EQ(stats.allocation_count, 0u);
+
+  void* p0 = allocator.Allocate(12, 64);
+  ASSERT_TRUE(p0 != NULL);
+  EXPECT_TRUE(ozz::math::IsAligned(p0, 64));
+  memset(p0, 0, 12);
+  void* p1 = allocator.Allocate(20, 4);
+  ASSERT_TRUE(p1 != NULL);
+  memset(p1, 0, 20);
+
+  stats = allocator.stats();
+  EXPECT_EQ(stats.live_bytes, 32u);
+  EXPECT_EQ(stats.peak_bytes, 32u);
+  EXPECT_EQ(stats.live_count, 2u);
+  EXPECT_EQ(stats.allocation_count, 2u);
+
+  allocator.Deallocate(p0);
+  stats = allocator.stats();
+  EXPECT_EQ(stats.live_bytes, 20u);
+  EXPECT_EQ(stats.peak_bytes, 32u);
+  EXPECT_EQ(stats.live_count, 1u);
+  EXPECT_EQ(stats.allocation_count, 2u);
+
+  // Reallocation preserves content.
+  memcpy(p1, "ozz", 4);
+  p1 = allocator.Reallocate(p1, 46, 16);
+  ASSERT_TRUE(p1 != NULL);
+  EXPECT_TRUE(ozz::math::IsAligned(p1, 16));
+  EXPECT_STREQ(reinterpret_cast<char*>(p1), "ozz");
+  stats = allocator.stats();
+  EXPECT_EQ(stats.live_bytes, 46u);
+  EXPECT_EQ(stats.peak_bytes, 66u);
+  EXPECT_EQ(stats.live_count, 1u);
+  EXPECT_EQ(stats.allocation_count, 3u);
+
+  // Resets counters.
+  allocator.ResetCounters();
+  stats = allocator.stats();
+  EXPECT_EQ(stats.live_bytes, 46u);
+  EXPECT_EQ(stats.peak_bytes, 46u);
+  EXPECT_EQ(stats.live_count, 1u);
+  EXPECT_EQ(stats.allocation_count, 0u);
+
+  allocator.Deallocate(p1);
+  allocator.Deallocate(NULL);
+  stats = allocator.stats();
+  EXPECT_EQ(stats.live_bytes, 0u);
+  EXPECT_EQ(stats.live_count, 0u);
+}
+
+TEST(Tags, TrackingAllocator) {
+  ozz::memory::TrackingAllocator allocator(ozz::memory::default_allocator());
+
+  EXPECT_EQ(ozz::memory::allocation_tag(), ozz::memory::kTagUntagged);
+  void* untagged = allocator.Allocate(10, 4);
+  void* animation;
+  void* cache;
+  {
+    ozz::memory::ScopedAllocationTag tag(ozz::memory::kTagAnimation);
+    EXPECT_EQ(ozz::memory::allocation_tag(), ozz::memory::kTagAnimation);
+    animation = allocator.Allocate(20, 4);
+    {
+      ozz::memory::ScopedAllocationTag nested(
+          ozz::memory::kTagSamplingCache);
+      cache = allocator.Allocate(30, 4);
+    }
+    EXPECT_EQ(ozz::memory::allocation_tag(), ozz::memory::kTagAnimation);
+  }
+  EXPECT_EQ(ozz::memory::allocation_tag(), ozz::memory::kTagUntagged);
+
+  EXPECT_EQ(allocator.stats().live_bytes, 60u);
+  EXPECT_EQ(allocator.stats(ozz::memory::kTagUntagged).live_bytes, 10u);
+  EXPECT_EQ(allocator.stats(ozz::memory::kTagAnimation).live_bytes, 20u);
+  EXPECT_EQ(allocator.stats(ozz::memory::kTagSamplingCache).live_bytes, 30u);
+  EXPECT_EQ(allocator.stats(ozz::memory::kTagSkeleton).live_bytes, 0u);
+
+  // Deallocation is accounted to the allocation tag, whatever the current
+  // one.
+  allocator.Deallocate(animation);
+  EXPECT_EQ(allocator.stats(ozz::memory::kTagAnimation).live_bytes, 0u);
+  EXPECT_EQ(allocator.stats(ozz::memory::kTagAnimation).peak_bytes, 20u);
+  EXPECT_EQ(allocator.stats(ozz::memory::kTagAnimation).allocation_count, 1u);
+
+  allocator.Deallocate(untagged);
+  allocator.Deallocate(cache);
+  EXPECT_EQ(allocator.stats().live_bytes, 0u);
+}
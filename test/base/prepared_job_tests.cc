@@ -0,0 +1,93 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/base/prepared_job.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+// A job that counts its validations and runs.
+struct CountingJob {
+  CountingJob() : valid(true), validations(NULL), runs(NULL) {}
+
+  bool Validate() const {
+    ++*validations;
+    return valid;
+  }
+
+  void RunUnchecked() const { ++*runs; }
+
+  bool valid;
+  int* validations;
+  int* runs;
+};
+}  // namespace
+
+TEST(Validity, PreparedJob) {
+  int validations = 0;
+  int runs = 0;
+  CountingJob job;
+  job.validations = &validations;
+  job.runs = &runs;
+
+  // Default prepared job is invalid.
+  ozz::PreparedJob<CountingJob> prepared;
+  EXPECT_FALSE(prepared.valid());
+  EXPECT_FALSE(prepared.Run());
+
+  job.valid = false;
+  EXPECT_FALSE(prepared.Prepare(job));
+  EXPECT_FALSE(prepared.valid());
+  EXPECT_FALSE(prepared.Run());
+  EXPECT_EQ(validations, 1);
+  EXPECT_EQ(runs, 0);
+
+  // Preparing again validates the modified job.
+  prepared.job().valid = true;
+  EXPECT_TRUE(prepared.Prepare());
+  EXPECT_TRUE(prepared.valid());
+  EXPECT_EQ(validations, 2);
+}
+
+TEST(Run, PreparedJob) {
+  int validations = 0;
+  int runs = 0;
+  CountingJob job;
+  job.validations = &validations;
+  job.runs = &runs;
+
+  const ozz::PreparedJob<CountingJob> prepared(job);
+  EXPECT_TRUE(prepared.valid());
+  EXPECT_EQ(validations, 1);
+
+  // Runs don't validate the job again.
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_TRUE(prepared.Run());
+  }
+  EXPECT_EQ(validations, 1);
+  EXPECT_EQ(runs, 10);
+}
@@ -0,0 +1,113 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+// Forces zones macros, whatever the library build configuration.
+#ifndef OZZ_BUILD_PROFILE
+#define OZZ_BUILD_PROFILE
+#endif  // OZZ_BUILD_PROFILE
+
+#include "ozz/base/profile.h"
+
+#include <string>
+
+#include "gtest/gtest.h"
+
+namespace {
+// Records begun and ended zones.
+struct Recorder {
+  std::string events;
+  int depth;
+  int max_depth;
+};
+
+void Begin(const char* _name, void* _user_data) {
+  Recorder* recorder = static_cast<Recorder*>(_user_data);
+  recorder->events += std::string("+") + _name;
+  ++recorder->depth;
+  if (recorder->depth > recorder->max_depth) {
+    recorder->max_depth = recorder->depth;
+  }
+}
+
+void End(const char* _name, void* _user_data) {
+  Recorder* recorder = static_cast<Recorder*>(_user_data);
+  recorder->events += std::string("-") + _name;
+  --recorder->depth;
+}
+
+void Nested() {
+  OZZ_PROFILE_ZONE("a");
+  {
+    OZZ_PROFILE_ZONE("b");
+    OZZ_PROFILE_ZONE("c");
+  }
+  OZZ_PROFILE_ZONE("d");
+}
+}  // namespace
+
+TEST(Callbacks, Profile) {
+  // No callback by default.
+  const ozz::profile::Callbacks& defaults = ozz::profile::GetCallbacks();
+  EXPECT_TRUE(defaults.begin == NULL);
+  EXPECT_TRUE(defaults.end == NULL);
+  EXPECT_TRUE(defaults.user_data == NULL);
+
+  // Zones do nothing without callbacks.
+  Nested();
+
+  Recorder recorder = {std::string(), 0, 0};
+  ozz::profile::Callbacks callbacks;
+  callbacks.begin = &Begin;
+  callbacks.end = &End;
+  callbacks.user_data = &recorder;
+  const ozz::profile::Callbacks previous =
+      ozz::profile::SetCallbacks(callbacks);
+  EXPECT_TRUE(previous.begin == NULL);
+  EXPECT_TRUE(ozz::profile::GetCallbacks().begin == &Begin);
+
+  Nested();
+  EXPECT_STREQ(recorder.events.c_str(), "+a+b+c-c-b+d-d-a");
+  EXPECT_EQ(recorder.depth, 0);
+  EXPECT_EQ(recorder.max_depth, 3);
+
+  // Begin callback only.
+  recorder.events.clear();
+  callbacks.end = NULL;
+  ozz::profile::SetCallbacks(callbacks);
+  {
+    const ozz::profile::Zone zone("z");
+    EXPECT_STREQ(recorder.events.c_str(), "+z");
+  }
+  EXPECT_STREQ(recorder.events.c_str(), "+z");
+
+  // Restores defaults.
+  const ozz::profile::Callbacks restored = ozz::profile::SetCallbacks(previous);
+  EXPECT_TRUE(restored.begin == &Begin);
+  EXPECT_TRUE(restored.end == NULL);
+  EXPECT_TRUE(ozz::profile::GetCallbacks().begin == NULL);
+}
@@ -0,0 +1,172 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#include "ozz/base/task_scheduler.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+// Runs tasks in reverse order, to detect any order dependency.
+class ReverseScheduler : public ozz::TaskScheduler {
+ public:
+  ReverseScheduler() : num_calls(0), num_tasks(0) {}
+  virtual void ParallelFor(Task _task, void* _context, int _count) {
+    ++num_calls;
+    for (int i = _count - 1; i >= 0; --i) {
+      _task(_context, i);
+      ++num_tasks;
+    }
+  }
+  int num_calls;
+  int num_tasks;
+};
+
+// Increments _index element of _context int array.
+void Increment(void* _context, int _index) {
+  ++static_cast<int*>(_context)[_index];
+}
+
+// Fake job, that counts how many times it's run.
+struct CountJob {
+  CountJob() : valid(true), count(0) {}
+  bool Validate() const { return valid; }
+  bool Run() const {
+    if (!Validate()) {
+      return false;
+    }
+    ++count;
+    return true;
+  }
+  bool valid;
+  mutable int count;
+};
+}  // namespace
+
+TEST(ParallelFor, TaskScheduler) {
+  int values[7] = {0};
+
+  // Sequential.
+  ozz::ParallelFor(NULL, &Increment, values, 7);
+  for (int i = 0; i < 7; ++i) {
+    EXPECT_EQ(values[i], 1);
+  }
+
+  // Scheduled.
+  ReverseScheduler scheduler;
+  ozz::ParallelFor(&scheduler, &Increment, values, 7);
+  EXPECT_EQ(scheduler.num_calls, 1);
+  EXPECT_EQ(scheduler.num_tasks, 7);
+  for (int i = 0; i < 7; ++i) {
+    EXPECT_EQ(values[i], 2);
+  }
+
+  // Nothing to run.
+  ozz::ParallelFor(&scheduler, &Increment, values, 0);
+  ozz::ParallelFor(&scheduler, &Increment, values, -1);
+  EXPECT_EQ(scheduler.num_calls, 1);
+}
+
+TEST(TaskGroup, TaskScheduler) {
+  int a[1] = {0};
+  int b[1] = {0};
+
+  ReverseScheduler scheduler;
+  {
+    ozz::TaskGroup group(&scheduler);
+    group.Wait();  // Empty group.
+    EXPECT_EQ(scheduler.num_calls, 0);
+
+    group.Add(&Increment, a);
+    group.Add(&Increment, b);
+    group.Add(&Increment, b);
+    EXPECT_EQ(group.size(), 3);
+    EXPECT_EQ(a[0], 0);
+    EXPECT_EQ(b[0], 0);
+
+    group.Wait();
+    EXPECT_EQ(group.size(), 0);
+    EXPECT_EQ(scheduler.num_calls, 1);
+    EXPECT_EQ(scheduler.num_tasks, 3);
+    EXPECT_EQ(a[0], 1);
+    EXPECT_EQ(b[0], 2);
+
+    // Pending tasks are run on destruction.
+    group.Add(&Increment, a);
+  }
+  EXPECT_EQ(scheduler.num_calls, 2);
+  EXPECT_EQ(a[0], 2);
+
+  {  // Sequential.
+    ozz::TaskGroup group(NULL);
+    group.Add(&Increment, a);
+    group.Wait();
+    EXPECT_EQ(a[0], 3);
+  }
+}
+
+TEST(RunJobs, TaskScheduler) {
+  CountJob jobs[5];
+  ReverseScheduler scheduler;
+
+  // Invalid grain size.
+  EXPECT_FALSE(ozz::RunJobs(ozz::Range<CountJob>(jobs), &scheduler, 0));
+  EXPECT_EQ(scheduler.num_calls, 0);
+
+  // Empty range.
+  EXPECT_TRUE(ozz::RunJobs(ozz::Range<CountJob>(), &scheduler));
+  EXPECT_EQ(scheduler.num_calls, 0);
+
+  // Sequential.
+  EXPECT_TRUE(ozz::RunJobs(ozz::Range<CountJob>(jobs), NULL));
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_EQ(jobs[i].count, 1);
+  }
+
+  // Scheduled, one task per group of 2 jobs.
+  EXPECT_TRUE(ozz::RunJobs(ozz::Range<CountJob>(jobs), &scheduler, 2));
+  EXPECT_EQ(scheduler.num_tasks, 3);
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_EQ(jobs[i].count, 2);
+  }
+
+  // Const jobs.
+  const ozz::Range<const CountJob> const_jobs(jobs);
+  EXPECT_TRUE(ozz::RunJobs(const_jobs, &scheduler, 8));
+  EXPECT_EQ(scheduler.num_tasks, 4);
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_EQ(jobs[i].count, 3);
+  }
+
+  // No job is run if any is invalid.
+  jobs[3].valid = false;
+  EXPECT_FALSE(ozz::RunJobs(ozz::Range<CountJob>(jobs), &scheduler));
+  EXPECT_EQ(scheduler.num_tasks, 4);
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_EQ(jobs[i].count, 3);
+  }
+}
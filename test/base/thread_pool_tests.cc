@@ -0,0 +1,216 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#include "ozz/base/thread_pool.h"
+
+#include <atomic>
+
+#include "gtest/gtest.h"
+
+namespace {
+// Counts how many times each task is run.
+struct CountContext {
+  std::atomic<int> counts[1024];
+};
+
+void Count(void* _context, int _index) {
+  ++static_cast<CountContext*>(_context)->counts[_index];
+}
+
+// Runs a task whose cost depends on its index, so that threads have to steal
+// tasks from each other.
+struct UnbalancedContext {
+  std::atomic<int> counts[256];
+  volatile float sinks[256];
+};
+
+void Unbalanced(void* _context, int _index) {
+  UnbalancedContext* context = static_cast<UnbalancedContext*>(_context);
+  float sum = 0.f;
+  const int iterations = _index < 16 ? 20000 : 10;
+  for (int i = 0; i < iterations; ++i) {
+    sum += static_cast<float>(i) * .5f;
+  }
+  context->sinks[_index] = sum;
+  ++context->counts[_index];
+}
+}  // namespace
+
+TEST(NumThreads, ThreadPool) {
+  {
+    ozz::ThreadPool pool(1);
+    EXPECT_EQ(pool.num_threads(), 1);
+  }
+  {
+    ozz::ThreadPool pool(-1);
+    EXPECT_GE(pool.num_threads(), 1);
+  }
+  {
+    ozz::ThreadPool pool(ozz::ThreadPool::kMaxThreads + 10);
+    EXPECT_GE(pool.num_threads(), 1);
+    EXPECT_LE(pool.num_threads(), ozz::ThreadPool::kMaxThreads);
+  }
+  {  // Pool can be destroyed without having run anything.
+    ozz::ThreadPool pool(4);
+    EXPECT_GE(pool.num_threads(), 1);
+    EXPECT_EQ(pool.num_steals(), 0);
+  }
+}
+
+TEST(ParallelFor, ThreadPool) {
+  const int num_threads[] = {1, 2, 4, 7};
+  const int counts[] = {0, 1, 2, 3, 7, 64, 1000, 1024};
+  for (size_t t = 0; t < OZZ_ARRAY_SIZE(num_threads); ++t) {
+    ozz::ThreadPool pool(num_threads[t]);
+    for (size_t c = 0; c < OZZ_ARRAY_SIZE(counts); ++c) {
+      CountContext context;
+      for (int i = 0; i < 1024; ++i) {
+        context.counts[i] = 0;
+      }
+
+      // Successive calls reuse the same threads.
+      const int kLoops = 20;
+      for (int l = 0; l < kLoops; ++l) {
+        pool.ParallelFor(&Count, &context, counts[c]);
+      }
+
+      // Every task was run exactly once per call.
+      for (int i = 0; i < 1024; ++i) {
+        EXPECT_EQ(context.counts[i].load(), i < counts[c] ? kLoops : 0);
+      }
+    }
+  }
+}
+
+TEST(WorkStealing, ThreadPool) {
+  ozz::ThreadPool pool(4);
+  UnbalancedContext context;
+  for (int i = 0; i < 256; ++i) {
+    context.counts[i] = 0;
+  }
+
+  for (int l = 0; l < 10; ++l) {
+    pool.ParallelFor(&Unbalanced, &context, 256);
+  }
+  for (int i = 0; i < 256; ++i) {
+    EXPECT_EQ(context.counts[i].load(), 10);
+  }
+
+  // Steals can only happen with more than one thread, but are never
+  // guaranteed as threads can be scheduled in any order.
+  if (pool.num_threads() == 1) {
+    EXPECT_EQ(pool.num_steals(), 0);
+  }
+}
+
+TEST(ParallelForHelper, ThreadPool) {
+  ozz::ThreadPool pool(3);
+  CountContext context;
+  for (int i = 0; i < 1024; ++i) {
+    context.counts[i] = 0;
+  }
+
+  ozz::ParallelFor(&pool, &Count, &context, 100);
+  for (int i = 0; i < 1024; ++i) {
+    EXPECT_EQ(context.counts[i].load(), i < 100 ? 1 : 0);
+  }
+}
+
+namespace {
+// Records worker threads initialization.
+struct InitContext {
+  std::atomic<int> counts[ozz::ThreadPool::kMaxThreads];
+};
+
+void Init(void* _user_data, int _thread_index) {
+  ++static_cast<InitContext*>(_user_data)->counts[_thread_index];
+}
+}  // namespace
+
+TEST(ThreadInit, ThreadPool) {
+  InitContext init;
+  for (int i = 0; i < ozz::ThreadPool::kMaxThreads; ++i) {
+    init.counts[i] = 0;
+  }
+  int num_threads;
+  {
+    ozz::ThreadPool pool(4, &Init, &init);
+    num_threads = pool.num_threads();
+
+    // Threads are initialized before they run any task.
+    CountContext context;
+    for (int i = 0; i < 1024; ++i) {
+      context.counts[i] = 0;
+    }
+    pool.ParallelFor(&Count, &context, 64);
+    for (int i = 0; i < 1024; ++i) {
+      EXPECT_EQ(context.counts[i].load(), i < 64 ? 1 : 0);
+    }
+  }
+
+  // Every worker thread was initialized once, the calling thread never.
+  for (int i = 0; i < ozz::ThreadPool::kMaxThreads; ++i) {
+    EXPECT_EQ(init.counts[i].load(), i > 0 && i < num_threads ? 1 : 0);
+  }
+}
+
+namespace {
+// Dispatches partition _index of a CountContext to its own pool.
+struct PartitionContext {
+  ozz::ThreadPool* pools[2];
+  CountContext* counts[2];
+};
+
+void RunPartition(void* _context, int _index) {
+  PartitionContext* context = static_cast<PartitionContext*>(_context);
+  context->pools[_index]->ParallelFor(&Count, context->counts[_index], 100);
+}
+}  // namespace
+
+TEST(Partitions, ThreadPool) {
+  // A pool per partition, dispatched from the tasks of another pool.
+  ozz::ThreadPool launcher(2);
+  ozz::ThreadPool pool0(2);
+  ozz::ThreadPool pool1(3);
+
+  CountContext counts0, counts1;
+  for (int i = 0; i < 1024; ++i) {
+    counts0.counts[i] = 0;
+    counts1.counts[i] = 0;
+  }
+  PartitionContext context = {{&pool0, &pool1}, {&counts0, &counts1}};
+
+  const int kLoops = 10;
+  for (int l = 0; l < kLoops; ++l) {
+    launcher.ParallelFor(&RunPartition, &context, 2);
+  }
+  for (int i = 0; i < 1024; ++i) {
+    EXPECT_EQ(counts0.counts[i].load(), i < 100 ? kLoops : 0);
+    EXPECT_EQ(counts1.counts[i].load(), i < 100 ? kLoops : 0);
+  }
+}
@@ -0,0 +1,654 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/geometry/offline/skinned_mesh_builder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/geometry/offline/raw_skinned_mesh.h"
+#include "ozz/geometry/runtime/skinning_job.h"
+
+using ozz::geometry::SkinningJob;
+using ozz::geometry::offline::RawSkinnedMesh;
+using ozz::geometry::offline::SkinnedMesh;
+using ozz::geometry::offline::SkinnedMeshBuilder;
+
+namespace {
+
+// Builds a _size x _size vertices grid, skinned to 4 joints along x axis.
+// Vertices close to joints boundaries are influenced by 2 joints, and a few
+// ones by 3. Triangles are shuffled, to defeat vertex cache.
+void BuildGrid(int _size, RawSkinnedMesh* _mesh) {
+  _mesh->influences_count = 4;
+  for (int y = 0; y < _size; ++y) {
+    for (int x = 0; x < _size; ++x) {
+      const float fx = static_cast<float>(x) / (_size - 1);
+      const float fy = static_cast<float>(y) / (_size - 1);
+      _mesh->positions.push_back(ozz::math::Float3(fx, fy, 0.f));
+      _mesh->normals.push_back(ozz::math::Float3(0.f, 0.f, 1.f));
+      _mesh->tangents.push_back(
+          ozz::math::Float4(1.f, 0.f, 0.f, x % 2 ? 1.f : -1.f));
+      _mesh->uvs.push_back(ozz::math::Float2(fx, fy));
+      for (int c = 0; c < 4; ++c) {
+        _mesh->colors.push_back(static_cast<uint8_t>(x + y + c));
+      }
+
+      // Influences, stored in unsorted order with 0 weights padding.
+      const float joint = fx * 3.99f;
+      const uint16_t dominant = static_cast<uint16_t>(joint);
+      const float blend = joint - dominant;
+      const uint16_t indices[4] = {0, dominant,
+                                   static_cast<uint16_t>((dominant + 1) % 4),
+                                   static_cast<uint16_t>((dominant + 2) % 4)};
+      float weights[4] = {0.f, 1.f, 0.f, 0.f};
+      if (blend > .7f) {
+        weights[1] = 2.f - blend;  // Not normalized.
+        weights[2] = blend;
+        if (y % 4 == 0) {
+          weights[3] = .1f;
+        }
+      }
+      for (int i = 0; i < 4; ++i) {
+        _mesh->joint_indices.push_back(indices[i]);
+        _mesh->joint_weights.push_back(weights[i]);
+      }
+    }
+  }
+  for (int y = 0; y < _size - 1; ++y) {
+    for (int x = 0; x < _size - 1; ++x) {
+      const uint32_t i = y * _size + x;
+      const uint32_t quad[6] = {i, i + 1, i + _size, i + 1, i + 1 + _size,
+                                i + _size};
+      _mesh->triangle_indices.insert(_mesh->triangle_indices.end(), quad,
+                                     quad + 6);
+    }
+  }
+
+  // Shuffles triangles, with a deterministic permutation.
+  const int triangle_count = _mesh->triangle_count();
+  for (int t = 0; t < triangle_count; ++t) {
+    const int other = (t * 7919) % triangle_count;
+    for (int c = 0; c < 3; ++c) {
+      std::swap(_mesh->triangle_indices[t * 3 + c],
+                _mesh->triangle_indices[other * 3 + c]);
+    }
+  }
+}
+
+// Computes the average number of vertex cache misses per triangle, with a
+// FIFO cache of _cache_size vertices.
+float ComputeAcmr(const ozz::Vector<uint32_t>::Std& _indices,
+                  size_t _cache_size) {
+  ozz::Vector<uint32_t>::Std cache;
+  int misses = 0;
+  for (size_t i = 0; i < _indices.size(); ++i) {
+    if (std::find(cache.begin(), cache.end(), _indices[i]) == cache.end()) {
+      ++misses;
+      cache.push_back(_indices[i]);
+      if (cache.size() > _cache_size) {
+        cache.erase(cache.begin());
+      }
+    }
+  }
+  return misses * 3.f / _indices.size();
+}
+
+// Returns triangles (with their vertices in original indexing) sorted, so they
+// can be compared.
+ozz::Vector<uint32_t>::Std SortedTriangles(
+    const ozz::Vector<uint32_t>::Std& _indices,
+    const ozz::Vector<uint32_t>::Std* _remap) {
+  typedef ozz::Vector<ozz::Vector<uint32_t>::Std>::Std Triangles;
+  Triangles triangles;
+  for (size_t i = 0; i < _indices.size(); i += 3) {
+    ozz::Vector<uint32_t>::Std triangle;
+    for (size_t c = 0; c < 3; ++c) {
+      triangle.push_back(_remap ? (*_remap)[_indices[i + c]] : _indices[i + c]);
+    }
+    // Rotates triangle so that winding is preserved.
+    std::rotate(triangle.begin(),
+                std::min_element(triangle.begin(), triangle.end()),
+                triangle.end());
+    triangles.push_back(triangle);
+  }
+  std::sort(triangles.begin(), triangles.end());
+  ozz::Vector<uint32_t>::Std sorted;
+  for (size_t i = 0; i < triangles.size(); ++i) {
+    sorted.insert(sorted.end(), triangles[i].begin(), triangles[i].end());
+  }
+  return sorted;
+}
+
+template <typename _T>
+_T Read(const ozz::Vector<uint8_t>::Std& _stream, size_t _offset) {
+  _T value;
+  std::memcpy(&value, &_stream[_offset], sizeof(_T));
+  return value;
+}
+
+// Skins _mesh with _matrices to float outputs.
+void SkinMesh(const SkinnedMesh& _mesh, const ozz::math::Float4x4* _matrices,
+              ozz::Vector<float>::Std* _positions,
+              ozz::Vector<float>::Std* _normals) {
+  SkinningJob job;
+  job.vertex_count = _mesh.vertex_count;
+  job.influences_count = _mesh.influences_count;
+  job.influences_buckets = ozz::make_range(_mesh.influences_buckets);
+  job.joint_matrices = ozz::Range<const ozz::math::Float4x4>(_matrices, 4);
+  const uint8_t* indices = &_mesh.joint_indices[0];
+  if (_mesh.joint_indices_stride == _mesh.influences_count * 2u) {
+    job.joint_indices = ozz::Range<const uint16_t>(
+        reinterpret_cast<const uint16_t*>(indices),
+        _mesh.joint_indices.size() / 2);
+  } else {
+    job.joint_indices_u8 =
+        ozz::Range<const uint8_t>(indices, _mesh.joint_indices.size());
+  }
+  job.joint_indices_stride = _mesh.joint_indices_stride;
+  const uint8_t* weights = &_mesh.joint_weights[0];
+  const size_t weight_size =
+      _mesh.joint_weights_stride / (_mesh.influences_count - 1);
+  if (weight_size == 4) {
+    job.joint_weights = ozz::Range<const float>(
+        reinterpret_cast<const float*>(weights),
+        _mesh.joint_weights.size() / 4);
+  } else if (weight_size == 2) {
+    job.joint_weights_u16 = ozz::Range<const uint16_t>(
+        reinterpret_cast<const uint16_t*>(weights),
+        _mesh.joint_weights.size() / 2);
+  } else {
+    job.joint_weights_u8 =
+        ozz::Range<const uint8_t>(weights, _mesh.joint_weights.size());
+  }
+  job.joint_weights_stride = _mesh.joint_weights_stride;
+
+  const size_t positions_stride = _mesh.positions.size() / _mesh.vertex_count;
+  job.in_positions = ozz::Range<const float>(
+      reinterpret_cast<const float*>(&_mesh.positions[0]),
+      _mesh.positions.size() / 4);
+  job.in_positions_stride = positions_stride;
+  job.in_positions_format = _mesh.positions_format;
+  const size_t normals_stride = _mesh.normals.size() / _mesh.vertex_count;
+  job.in_normals = ozz::Range<const float>(
+      reinterpret_cast<const float*>(&_mesh.normals[0]),
+      _mesh.normals.size() / 4);
+  job.in_normals_stride = normals_stride;
+  job.in_normals_format = _mesh.normals_format;
+
+  _positions->resize(_mesh.vertex_count * 3);
+  _normals->resize(_mesh.vertex_count * 3);
+  job.out_positions = ozz::make_range(*_positions);
+  job.out_positions_stride = 3 * sizeof(float);
+  job.out_normals = ozz::make_range(*_normals);
+  job.out_normals_stride = 3 * sizeof(float);
+  ASSERT_TRUE(job.Run());
+}
+}  // namespace
+
+TEST(Validate, RawSkinnedMesh) {
+  {  // Default is valid.
+    RawSkinnedMesh mesh;
+    EXPECT_TRUE(mesh.Validate());
+    EXPECT_EQ(mesh.vertex_count(), 0);
+    EXPECT_EQ(mesh.triangle_count(), 0);
+  }
+
+  RawSkinnedMesh valid;
+  BuildGrid(4, &valid);
+  EXPECT_TRUE(valid.Validate());
+  EXPECT_EQ(valid.vertex_count(), 16);
+  EXPECT_EQ(valid.triangle_count(), 18);
+
+  {  // Invalid influences count.
+    RawSkinnedMesh mesh = valid;
+    mesh.influences_count = 0;
+    EXPECT_FALSE(mesh.Validate());
+  }
+  {  // Attributes count mismatch.
+    RawSkinnedMesh mesh = valid;
+    mesh.normals.pop_back();
+    EXPECT_FALSE(mesh.Validate());
+    mesh.normals.clear();
+    EXPECT_FALSE(mesh.Validate());  // Tangents without normals.
+    mesh.tangents.clear();
+    EXPECT_TRUE(mesh.Validate());
+    mesh.uvs.pop_back();
+    EXPECT_FALSE(mesh.Validate());
+    mesh.uvs.clear();
+    EXPECT_TRUE(mesh.Validate());
+    mesh.colors.pop_back();
+    EXPECT_FALSE(mesh.Validate());
+  }
+  {  // Skinning data mismatch.
+    RawSkinnedMesh mesh = valid;
+    mesh.joint_indices.pop_back();
+    EXPECT_FALSE(mesh.Validate());
+  }
+  {
+    RawSkinnedMesh mesh = valid;
+    mesh.influences_count = 2;
+    EXPECT_FALSE(mesh.Validate());
+  }
+  {  // Invalid weights.
+    RawSkinnedMesh mesh = valid;
+    mesh.joint_weights[2] = -1.f;
+    EXPECT_FALSE(mesh.Validate());
+    for (int i = 0; i < 4; ++i) {
+      mesh.joint_weights[i] = 0.f;
+    }
+    EXPECT_FALSE(mesh.Validate());
+  }
+  {  // Invalid triangles.
+    RawSkinnedMesh mesh = valid;
+    mesh.triangle_indices.pop_back();
+    EXPECT_FALSE(mesh.Validate());
+    mesh.triangle_indices.push_back(16);
+    EXPECT_FALSE(mesh.Validate());
+  }
+}
+
+TEST(Error, SkinnedMeshBuilder) {
+  RawSkinnedMesh raw;
+  BuildGrid(4, &raw);
+  SkinnedMesh output;
+
+  {  // No output.
+    SkinnedMeshBuilder builder;
+    EXPECT_FALSE(builder(raw, NULL));
+  }
+  {  // Invalid input.
+    SkinnedMeshBuilder builder;
+    RawSkinnedMesh invalid = raw;
+    invalid.influences_count = 0;
+    EXPECT_FALSE(builder(invalid, &output));
+    EXPECT_EQ(output.vertex_count, 0);
+  }
+  {  // Unsupported positions format.
+    SkinnedMeshBuilder builder;
+    builder.positions_format = SkinningJob::kSnorm16x3;
+    EXPECT_FALSE(builder(raw, &output));
+    builder.positions_format = SkinningJob::kHalf3;
+    EXPECT_TRUE(builder(raw, &output));
+  }
+  {  // Invalid vertex cache size.
+    SkinnedMeshBuilder builder;
+    builder.vertex_cache_size = 3;
+    EXPECT_FALSE(builder(raw, &output));
+    builder.optimize_vertex_cache = false;
+    EXPECT_TRUE(builder(raw, &output));
+  }
+  {  // 8 bits joint indices overflow.
+    SkinnedMeshBuilder builder;
+    builder.joint_indices_format = SkinnedMeshBuilder::kIndicesUint8;
+    EXPECT_TRUE(builder(raw, &output));
+
+    RawSkinnedMesh overflow = raw;
+    overflow.joint_indices[1] = 256;
+    EXPECT_FALSE(builder(overflow, &output));
+
+    // Unused influences don't matter.
+    overflow.joint_indices[1] = 0;
+    overflow.joint_indices[0] = 256;
+    EXPECT_TRUE(builder(overflow, &output));
+  }
+  {  // Too many influences for compact formats.
+    RawSkinnedMesh many;
+    many.influences_count = SkinningJob::kMaxCompactInfluences + 1;
+    many.positions.resize(1, ozz::math::Float3(0.f));
+    many.joint_indices.resize(many.influences_count, 0);
+    many.joint_weights.resize(many.influences_count, 1.f);
+
+    SkinnedMeshBuilder builder;
+    EXPECT_TRUE(builder(many, &output));
+    builder.joint_weights_format = SkinnedMeshBuilder::kWeightsUnorm16;
+    EXPECT_FALSE(builder(many, &output));
+    builder.max_influences = SkinningJob::kMaxCompactInfluences;
+    EXPECT_TRUE(builder(many, &output));
+  }
+}
+
+TEST(Empty, SkinnedMeshBuilder) {
+  SkinnedMeshBuilder builder;
+  RawSkinnedMesh raw;
+  SkinnedMesh output;
+  ASSERT_TRUE(builder(raw, &output));
+  EXPECT_EQ(output.vertex_count, 0);
+  EXPECT_EQ(output.influences_count, 1);
+  ASSERT_EQ(output.influences_buckets.size(), 1u);
+  EXPECT_EQ(output.influences_buckets[0], 0);
+  EXPECT_TRUE(output.positions.empty());
+  EXPECT_TRUE(output.normals.empty());
+  EXPECT_TRUE(output.joint_indices.empty());
+  EXPECT_TRUE(output.joint_weights.empty());
+  EXPECT_TRUE(output.triangle_indices.empty());
+}
+
+TEST(Influences, SkinnedMeshBuilder) {
+  RawSkinnedMesh raw;
+  BuildGrid(16, &raw);
+
+  SkinnedMeshBuilder builder;
+  SkinnedMesh output;
+  ASSERT_TRUE(builder(raw, &output));
+
+  EXPECT_EQ(output.vertex_count, 256);
+  EXPECT_EQ(output.influences_count, 3);
+  ASSERT_EQ(output.influences_buckets.size(), 3u);
+  EXPECT_EQ(output.influences_buckets[0] + output.influences_buckets[1] +
+                output.influences_buckets[2],
+            256);
+  EXPECT_EQ(output.joint_indices_stride, 3 * sizeof(uint16_t));
+  EXPECT_EQ(output.joint_weights_stride, 2 * sizeof(float));
+  ASSERT_EQ(output.vertex_remap.size(), 256u);
+
+  // Vertices are sorted by bucket, then by dominant joint. Influences are
+  // sorted by decreasing weight and normalized.
+  int vertex = 0;
+  for (int b = 0; b < 3; ++b) {
+    int previous_joint = 0;
+    for (int i = 0; i < output.influences_buckets[b]; ++i, ++vertex) {
+      const size_t src = output.vertex_remap[vertex] * 4;
+      const uint16_t dominant =
+          Read<uint16_t>(output.joint_indices, vertex * 3 * 2);
+      EXPECT_GE(dominant, previous_joint);
+      previous_joint = dominant;
+      EXPECT_EQ(dominant, raw.joint_indices[src + 1]);
+
+      float sum = 0.f;
+      for (int j = 0; j < b + 1; ++j) {
+        if (j < b) {
+          const float weight =
+              Read<float>(output.joint_weights, (vertex * 2 + j) * 4);
+          EXPECT_GT(weight, 0.f);
+          sum += weight;
+        }
+        EXPECT_EQ(Read<uint16_t>(output.joint_indices, (vertex * 3 + j) * 2),
+                  raw.joint_indices[src + j + 1]);
+      }
+      const float raw_sum = raw.joint_weights[src + 1] +
+                            raw.joint_weights[src + 2] +
+                            raw.joint_weights[src + 3];
+      EXPECT_NEAR(1.f - sum, raw.joint_weights[src + b + 1] / raw_sum, 1e-6f);
+    }
+  }
+
+  {  // Limits influences.
+    SkinnedMeshBuilder limited = builder;
+    limited.max_influences = 2;
+    SkinnedMesh limited_output;
+    ASSERT_TRUE(limited(raw, &limited_output));
+    EXPECT_EQ(limited_output.influences_count, 2);
+    ASSERT_EQ(limited_output.influences_buckets.size(), 2u);
+    EXPECT_EQ(limited_output.influences_buckets[0],
+              output.influences_buckets[0]);
+    EXPECT_EQ(limited_output.influences_buckets[1],
+              output.influences_buckets[1] + output.influences_buckets[2]);
+  }
+
+  {  // Merges small buckets.
+    SkinnedMeshBuilder merging = builder;
+    merging.min_bucket_size = output.influences_buckets[1] + 1;
+    SkinnedMesh merged_output;
+    ASSERT_TRUE(merging(raw, &merged_output));
+    ASSERT_EQ(merged_output.influences_buckets.size(), 3u);
+    EXPECT_EQ(merged_output.influences_buckets[0],
+              output.influences_buckets[0]);
+    EXPECT_EQ(merged_output.influences_buckets[1], 0);
+    EXPECT_EQ(merged_output.influences_buckets[2],
+              output.influences_buckets[1] + output.influences_buckets[2]);
+
+    // Moved vertices have a 0 weight extra influence.
+    int moved = 0;
+    for (int i = merged_output.influences_buckets[0]; i < 256; ++i) {
+      const float weight0 =
+          Read<float>(merged_output.joint_weights, (i * 2 + 0) * 4);
+      const float weight1 =
+          Read<float>(merged_output.joint_weights, (i * 2 + 1) * 4);
+      moved += std::abs(weight0 + weight1 - 1.f) < 1e-6f;
+    }
+    EXPECT_EQ(moved, output.influences_buckets[1]);
+  }
+}
+
+TEST(RigidRanges, SkinnedMeshBuilder) {
+  RawSkinnedMesh raw;
+  BuildGrid(16, &raw);
+
+  SkinnedMeshBuilder builder;
+  SkinnedMesh output;
+  ASSERT_TRUE(builder(raw, &output));
+
+  // Every joint binds enough single influence vertices to get a rigid range,
+  // which all together cover the single influence bucket.
+  ASSERT_EQ(output.rigid_ranges.size(), 4u);
+  int vertex = 0;
+  for (size_t r = 0; r < output.rigid_ranges.size(); ++r) {
+    const SkinningJob::RigidRange& range = output.rigid_ranges[r];
+    EXPECT_EQ(range.joint, static_cast<int>(r));
+    EXPECT_GE(range.vertex_count, builder.min_rigid_range_size);
+    for (int i = 0; i < range.vertex_count; ++i, ++vertex) {
+      EXPECT_EQ(Read<uint16_t>(output.joint_indices, vertex * 3 * 2),
+                range.joint);
+    }
+  }
+  EXPECT_EQ(vertex, output.influences_buckets[0]);
+
+  {  // Small ranges are skinned with the generic code path, after rigid
+     // ranges.
+    // Vertices are distributed with a 3.99 scale, so the last joint binds
+    // less vertices than the others.
+    SkinnedMeshBuilder min_size = builder;
+    min_size.min_rigid_range_size = output.rigid_ranges[3].vertex_count + 1;
+    SkinnedMesh min_size_output;
+    ASSERT_TRUE(min_size(raw, &min_size_output));
+    ASSERT_EQ(min_size_output.rigid_ranges.size(), 3u);
+    EXPECT_EQ(min_size_output.rigid_ranges[2].joint, 2);
+    EXPECT_EQ(min_size_output.influences_buckets[0],
+              output.influences_buckets[0]);
+    int rigid = 0;
+    for (size_t r = 0; r < min_size_output.rigid_ranges.size(); ++r) {
+      rigid += min_size_output.rigid_ranges[r].vertex_count;
+    }
+    EXPECT_EQ(rigid, output.influences_buckets[0] -
+                         output.rigid_ranges[3].vertex_count);
+    EXPECT_EQ(Read<uint16_t>(min_size_output.joint_indices, rigid * 3 * 2),
+              3);
+  }
+
+  {  // Disabled.
+    SkinnedMeshBuilder disabled = builder;
+    disabled.min_rigid_range_size = 0;
+    SkinnedMesh disabled_output;
+    ASSERT_TRUE(disabled(raw, &disabled_output));
+    EXPECT_TRUE(disabled_output.rigid_ranges.empty());
+    disabled.min_rigid_range_size = builder.min_rigid_range_size;
+    disabled.sort_by_joint = false;
+    ASSERT_TRUE(disabled(raw, &disabled_output));
+    EXPECT_TRUE(disabled_output.rigid_ranges.empty());
+    disabled.min_rigid_range_size = -1;
+    EXPECT_FALSE(disabled(raw, &disabled_output));
+  }
+
+  {  // Output is ready for the SkinningJob.
+    const ozz::math::Float4x4 matrices[4] = {
+        ozz::math::Float4x4::identity(), ozz::math::Float4x4::identity(),
+        ozz::math::Float4x4::identity(), ozz::math::Float4x4::identity()};
+    ozz::Vector<float>::Std out_positions(output.vertex_count * 3);
+    SkinningJob job;
+    job.vertex_count = output.vertex_count;
+    job.influences_count = output.influences_count;
+    job.influences_buckets = make_range(output.influences_buckets);
+    job.rigid_ranges = make_range(output.rigid_ranges);
+    job.joint_matrices = matrices;
+    job.joint_indices = ozz::Range<const uint16_t>(
+        reinterpret_cast<const uint16_t*>(array_begin(output.joint_indices)),
+        reinterpret_cast<const uint16_t*>(array_end(output.joint_indices)));
+    job.joint_indices_stride = output.joint_indices_stride;
+    job.joint_weights = ozz::Range<const float>(
+        reinterpret_cast<const float*>(array_begin(output.joint_weights)),
+        reinterpret_cast<const float*>(array_end(output.joint_weights)));
+    job.joint_weights_stride = output.joint_weights_stride;
+    job.in_positions = ozz::Range<const float>(
+        reinterpret_cast<const float*>(array_begin(output.positions)),
+        reinterpret_cast<const float*>(array_end(output.positions)));
+    job.in_positions_stride = sizeof(float) * 3;
+    job.out_positions = make_range(out_positions);
+    job.out_positions_stride = sizeof(float) * 3;
+    ASSERT_TRUE(job.Run());
+    for (int i = 0; i < output.vertex_count; ++i) {
+      const ozz::math::Float3& expected = raw.positions[output.vertex_remap[i]];
+      EXPECT_NEAR(out_positions[i * 3 + 0], expected.x, 1e-5f);
+      EXPECT_NEAR(out_positions[i * 3 + 1], expected.y, 1e-5f);
+      EXPECT_NEAR(out_positions[i * 3 + 2], expected.z, 1e-5f);
+    }
+  }
+}
+
+TEST(VertexCache, SkinnedMeshBuilder) {
+  RawSkinnedMesh raw;
+  BuildGrid(32, &raw);
+  const float raw_acmr = ComputeAcmr(raw.triangle_indices, 16);
+
+  SkinnedMeshBuilder builder;
+  SkinnedMesh optimized;
+  ASSERT_TRUE(builder(raw, &optimized));
+  const float optimized_acmr = ComputeAcmr(optimized.triangle_indices, 16);
+  EXPECT_LT(optimized_acmr, raw_acmr * .5f);
+  EXPECT_LT(optimized_acmr, 1.f);
+
+  // Triangles are the same, with the same winding.
+  EXPECT_TRUE(SortedTriangles(raw.triangle_indices, NULL) ==
+              SortedTriangles(optimized.triangle_indices,
+                              &optimized.vertex_remap));
+
+  // Without vertex cache optimization, triangles order is preserved.
+  builder.optimize_vertex_cache = false;
+  SkinnedMesh unoptimized;
+  ASSERT_TRUE(builder(raw, &unoptimized));
+  ASSERT_EQ(unoptimized.triangle_indices.size(), raw.triangle_indices.size());
+  for (size_t i = 0; i < raw.triangle_indices.size(); ++i) {
+    EXPECT_EQ(unoptimized.vertex_remap[unoptimized.triangle_indices[i]],
+              raw.triangle_indices[i]);
+  }
+
+  // Without joint sorting, vertices are sorted by first use within buckets.
+  builder.optimize_vertex_cache = true;
+  builder.sort_by_joint = false;
+  SkinnedMesh first_use;
+  ASSERT_TRUE(builder(raw, &first_use));
+  EXPECT_TRUE(optimized.triangle_indices.size() ==
+              first_use.triangle_indices.size());
+  uint32_t next = 0;
+  for (size_t i = 0; i < first_use.triangle_indices.size(); ++i) {
+    const uint32_t index = first_use.triangle_indices[i];
+    if (index >= static_cast<uint32_t>(first_use.influences_buckets[0])) {
+      continue;
+    }
+    EXPECT_LE(index, next);
+    next = std::max(next, index + 1);
+  }
+}
+
+TEST(Formats, SkinnedMeshBuilder) {
+  RawSkinnedMesh raw;
+  BuildGrid(8, &raw);
+
+  const ozz::math::Float4x4 matrices[4] = {
+      ozz::math::Float4x4::identity(),
+      ozz::math::Float4x4::Translation(
+          ozz::math::simd_float4::Load(0.f, 1.f, 0.f, 0.f)),
+      ozz::math::Float4x4::FromAxisAngle(
+          ozz::math::simd_float4::z_axis(),
+          ozz::math::simd_float4::Load1(.5f)),
+      ozz::math::Float4x4::Scaling(
+          ozz::math::simd_float4::Load(.5f, 1.f, 1.f, 0.f))};
+
+  SkinnedMeshBuilder builder;
+  SkinnedMesh reference;
+  ASSERT_TRUE(builder(raw, &reference));
+  ozz::Vector<float>::Std reference_positions, reference_normals;
+  SkinMesh(reference, matrices, &reference_positions, &reference_normals);
+
+  builder.positions_format = SkinningJob::kHalf3;
+  builder.normals_format = SkinningJob::kSnorm16x3;
+  builder.tangents_format = SkinningJob::kSnorm10x3_2;
+  builder.joint_indices_format = SkinnedMeshBuilder::kIndicesUint8;
+  builder.joint_weights_format = SkinnedMeshBuilder::kWeightsUnorm8;
+  SkinnedMesh compact;
+  ASSERT_TRUE(builder(raw, &compact));
+
+  // Vertices order doesn't depend on formats.
+  EXPECT_TRUE(compact.vertex_remap == reference.vertex_remap);
+  EXPECT_TRUE(compact.triangle_indices == reference.triangle_indices);
+
+  EXPECT_EQ(compact.positions.size(), 64u * 6u);
+  EXPECT_EQ(compact.normals.size(), 64u * 6u);
+  EXPECT_EQ(compact.tangents.size(), 64u * 4u);
+  EXPECT_EQ(compact.joint_indices_stride, 3u);
+  EXPECT_EQ(compact.joint_weights_stride, 2u);
+  EXPECT_EQ(compact.joint_indices.size(), 64u * 3u);
+  EXPECT_EQ(compact.joint_weights.size(), 64u * 2u);
+
+  // Tangents handedness is packed in w.
+  for (int i = 0; i < compact.vertex_count; ++i) {
+    const uint32_t packed = Read<uint32_t>(compact.tangents, i * 4);
+    const float w = raw.tangents[compact.vertex_remap[i]].w;
+    EXPECT_EQ(packed >> 30, w < 0.f ? 3u : 1u);
+    EXPECT_EQ(packed & 0x3ff, 511u);
+  }
+
+  // Uvs and colors are reordered.
+  for (int i = 0; i < compact.vertex_count; ++i) {
+    const uint32_t src = compact.vertex_remap[i];
+    EXPECT_EQ(compact.uvs[i].x, raw.uvs[src].x);
+    EXPECT_EQ(compact.uvs[i].y, raw.uvs[src].y);
+    EXPECT_EQ(compact.colors[i * 4 + 3], raw.colors[src * 4 + 3]);
+  }
+
+  // Compact mesh skins like the reference one, within quantization precision.
+  ozz::Vector<float>::Std compact_positions, compact_normals;
+  SkinMesh(compact, matrices, &compact_positions, &compact_normals);
+  for (size_t i = 0; i < reference_positions.size(); ++i) {
+    EXPECT_NEAR(compact_positions[i], reference_positions[i], 5e-3f);
+    EXPECT_NEAR(compact_normals[i], reference_normals[i], 5e-3f);
+  }
+
+  // 16 bits weights are more accurate.
+  builder.joint_weights_format = SkinnedMeshBuilder::kWeightsUnorm16;
+  ASSERT_TRUE(builder(raw, &compact));
+  EXPECT_EQ(compact.joint_weights_stride, 4u);
+  SkinMesh(compact, matrices, &compact_positions, &compact_normals);
+  for (size_t i = 0; i < reference_positions.size(); ++i) {
+    EXPECT_NEAR(compact_positions[i], reference_positions[i], 1e-3f);
+  }
+}
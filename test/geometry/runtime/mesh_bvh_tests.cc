@@ -0,0 +1,314 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#include "ozz/geometry/runtime/mesh_bvh.h"
+
+#include <cstdlib>
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/maths/simd_math.h"
+
+using ozz::geometry::MeshBvh;
+using ozz::geometry::MeshBvhHit;
+
+namespace {
+// Builds a wavy grid of _size * _size quads in xz plane, split in 2 triangles
+// each.
+void BuildGrid(int _size, ozz::Vector<float>::Std* _positions,
+               ozz::Vector<uint16_t>::Std* _indices) {
+  const int row = _size + 1;
+  for (int z = 0; z < row; ++z) {
+    for (int x = 0; x < row; ++x) {
+      _positions->push_back(static_cast<float>(x));
+      _positions->push_back(((x + z) % 3) * .1f);
+      _positions->push_back(static_cast<float>(z));
+    }
+  }
+  for (int z = 0; z < _size; ++z) {
+    for (int x = 0; x < _size; ++x) {
+      const uint16_t i = static_cast<uint16_t>(z * row + x);
+      const uint16_t quad[6] = {
+          i, static_cast<uint16_t>(i + row), static_cast<uint16_t>(i + 1),
+          static_cast<uint16_t>(i + 1), static_cast<uint16_t>(i + row),
+          static_cast<uint16_t>(i + row + 1)};
+      _indices->insert(_indices->end(), quad, quad + 6);
+    }
+  }
+}
+
+// Brute force ray cast, used as a reference. Every triangle is tested with a
+// single triangle hierarchy, so only hierarchy traversal is compared.
+bool BruteRaycast(const ozz::math::Float3& _origin,
+                  const ozz::math::Float3& _direction,
+                  const ozz::Vector<float>::Std& _positions,
+                  const ozz::Vector<uint16_t>::Std& _indices, float* _distance,
+                  int* _triangle) {
+  bool hit = false;
+  for (size_t t = 0; t < _indices.size(); t += 3) {
+    const float* p0 = &_positions[_indices[t + 0] * 3];
+    const float* p1 = &_positions[_indices[t + 1] * 3];
+    const float* p2 = &_positions[_indices[t + 2] * 3];
+    const uint16_t triangle[3] = {0, 1, 2};
+    const float vertices[9] = {p0[0], p0[1], p0[2], p1[0], p1[1],
+                               p1[2], p2[0], p2[1], p2[2]};
+    MeshBvh single;
+    EXPECT_TRUE(single.Build(triangle, vertices, sizeof(float) * 3));
+    MeshBvhHit single_hit;
+    if (single.Raycast(_origin, _direction, vertices, sizeof(float) * 3,
+                       hit ? *_distance : 1e30f, &single_hit)) {
+      *_distance = single_hit.distance;
+      *_triangle = static_cast<int>(t / 3);
+      hit = true;
+    }
+  }
+  return hit;
+}
+
+float RandomFloat(float _min, float _max) {
+  return _min + (_max - _min) * std::rand() / static_cast<float>(RAND_MAX);
+}
+}  // namespace
+
+TEST(Build, MeshBvh) {
+  const float positions[] = {0.f, 0.f, 0.f, 1.f, 0.f, 0.f, 0.f, 0.f, 1.f};
+  const size_t kStride = sizeof(float) * 3;
+
+  MeshBvh bvh;
+  EXPECT_FALSE(bvh.bounds().is_valid());
+  EXPECT_EQ(bvh.num_triangles(), 0);
+
+  {  // Not a multiple of 3 indices.
+    const uint16_t indices[] = {0, 1};
+    EXPECT_FALSE(bvh.Build(indices, positions, kStride));
+  }
+  {  // Index out of range.
+    const uint16_t indices[] = {0, 1, 3};
+    EXPECT_FALSE(bvh.Build(indices, positions, kStride));
+  }
+  {  // Stride too small.
+    const uint16_t indices[] = {0, 1, 2};
+    EXPECT_FALSE(bvh.Build(indices, positions, kStride - 1));
+  }
+  {  // Empty.
+    EXPECT_TRUE(bvh.Build(ozz::Range<const uint16_t>(), positions, kStride));
+    EXPECT_EQ(bvh.num_nodes(), 0);
+    EXPECT_FALSE(bvh.bounds().is_valid());
+    MeshBvhHit hit;
+    EXPECT_FALSE(bvh.Raycast(ozz::math::Float3(.1f, 1.f, .1f),
+                             ozz::math::Float3(0.f, -1.f, 0.f), positions,
+                             kStride, 1e30f, &hit));
+    int triangles[1];
+    EXPECT_EQ(bvh.Overlap(ozz::math::Box(ozz::math::Float3(-1.f),
+                                         ozz::math::Float3(1.f)),
+                          triangles),
+              0);
+  }
+  {  // Single triangle.
+    const uint16_t indices[] = {0, 1, 2};
+    ASSERT_TRUE(bvh.Build(indices, positions, kStride));
+    EXPECT_EQ(bvh.num_triangles(), 1);
+    EXPECT_EQ(bvh.num_nodes(), 1);
+    EXPECT_FLOAT_EQ(bvh.bounds().max.x, 1.f);
+    EXPECT_FLOAT_EQ(bvh.bounds().max.z, 1.f);
+
+    MeshBvhHit hit;
+    ASSERT_TRUE(bvh.Raycast(ozz::math::Float3(.1f, 2.f, .1f),
+                            ozz::math::Float3(0.f, -2.f, 0.f), positions,
+                            kStride, 1e30f, &hit));
+    EXPECT_FLOAT_EQ(hit.distance, 1.f);
+    EXPECT_EQ(hit.triangle, 0);
+    EXPECT_FLOAT_EQ(hit.point.y, 0.f);
+    EXPECT_FLOAT_EQ(hit.normal.y, -1.f);
+
+    // Too far.
+    EXPECT_FALSE(bvh.Raycast(ozz::math::Float3(.1f, 2.f, .1f),
+                             ozz::math::Float3(0.f, -2.f, 0.f), positions,
+                             kStride, .5f, &hit));
+    // Missed.
+    EXPECT_FALSE(bvh.Raycast(ozz::math::Float3(.9f, 2.f, .9f),
+                             ozz::math::Float3(0.f, -2.f, 0.f), positions,
+                             kStride, 1e30f, &hit));
+    // Behind.
+    EXPECT_FALSE(bvh.Raycast(ozz::math::Float3(.1f, 2.f, .1f),
+                             ozz::math::Float3(0.f, 1.f, 0.f), positions,
+                             kStride, 1e30f, &hit));
+  }
+}
+
+TEST(Raycast, MeshBvh) {
+  ozz::Vector<float>::Std positions;
+  ozz::Vector<uint16_t>::Std indices;
+  BuildGrid(16, &positions, &indices);
+  const size_t kStride = sizeof(float) * 3;
+
+  MeshBvh bvh;
+  ASSERT_TRUE(bvh.Build(ozz::make_range(indices), ozz::make_range(positions),
+                        kStride));
+  EXPECT_EQ(bvh.num_triangles(), 16 * 16 * 2);
+  EXPECT_FLOAT_EQ(bvh.bounds().min.x, 0.f);
+  EXPECT_FLOAT_EQ(bvh.bounds().max.x, 16.f);
+  EXPECT_FLOAT_EQ(bvh.bounds().max.y, .2f);
+
+  // Compares with brute force, for random rays.
+  std::srand(0);
+  for (int i = 0; i < 200; ++i) {
+    const ozz::math::Float3 origin(RandomFloat(-4.f, 20.f),
+                                   RandomFloat(-4.f, 4.f),
+                                   RandomFloat(-4.f, 20.f));
+    const ozz::math::Float3 target(RandomFloat(0.f, 16.f), .1f,
+                                   RandomFloat(0.f, 16.f));
+    const ozz::math::Float3 direction = target - origin;
+
+    float expected_distance = 0.f;
+    int expected_triangle = -1;
+    const bool expected = BruteRaycast(origin, direction, positions, indices,
+                                       &expected_distance, &expected_triangle);
+    MeshBvhHit hit;
+    ASSERT_EQ(bvh.Raycast(origin, direction, ozz::make_range(positions),
+                          kStride, 1e30f, &hit),
+              expected);
+    if (expected) {
+      EXPECT_NEAR(hit.distance, expected_distance, 1e-5f);
+    }
+  }
+
+  // Refits to translated positions.
+  for (size_t i = 1; i < positions.size(); i += 3) {
+    positions[i] += 5.f;
+  }
+  EXPECT_FALSE(bvh.Refit(ozz::Range<const float>(&positions[0], 3), kStride));
+  ASSERT_TRUE(bvh.Refit(ozz::make_range(positions), kStride));
+  EXPECT_FLOAT_EQ(bvh.bounds().min.y, 5.f);
+  EXPECT_FLOAT_EQ(bvh.bounds().max.y, 5.2f);
+  MeshBvhHit hit;
+  ASSERT_TRUE(bvh.Raycast(ozz::math::Float3(3.5f, 10.f, 7.5f),
+                          ozz::math::Float3(0.f, -1.f, 0.f),
+                          ozz::make_range(positions), kStride, 1e30f, &hit));
+  EXPECT_NEAR(hit.point.y, 5.1f, .11f);
+  EXPECT_NEAR(hit.point.x, 3.5f, 1e-5f);
+
+  // Overlap finds the triangles of the quads around a point.
+  int triangles[64];
+  const int found = bvh.Overlap(
+      ozz::math::Box(ozz::math::Float3(7.5f, 0.f, 7.5f),
+                     ozz::math::Float3(8.5f, 10.f, 8.5f)),
+      triangles);
+  EXPECT_GE(found, 8);
+  EXPECT_LE(found, 64);
+  bool found_quad = false;
+  for (int i = 0; i < found; ++i) {
+    found_quad |= triangles[i] == (7 * 16 + 7) * 2;
+  }
+  EXPECT_TRUE(found_quad);
+
+  // Overlap reports more triangles than capacity.
+  EXPECT_EQ(bvh.Overlap(bvh.bounds(), ozz::Range<int>(triangles, 2)),
+            16 * 16 * 2);
+}
+
+TEST(JointRefit, MeshBvh) {
+  ozz::Vector<float>::Std positions;
+  ozz::Vector<uint16_t>::Std indices;
+  BuildGrid(8, &positions, &indices);
+  const size_t kStride = sizeof(float) * 3;
+  const int vertex_count = static_cast<int>(positions.size() / 3);
+
+  // Vertices with x < 4 are influenced by joint 0, others by joint 0 and 1.
+  ozz::Vector<uint16_t>::Std joints;
+  for (int i = 0; i < vertex_count; ++i) {
+    joints.push_back(0);
+    joints.push_back(positions[i * 3] < 4.f ? 0 : 1);
+  }
+
+  MeshBvh bvh;
+  EXPECT_FALSE(bvh.SetupJointRefit(ozz::make_range(joints),
+                                   sizeof(uint16_t) * 2, 2));
+  ASSERT_TRUE(bvh.Build(ozz::make_range(indices), ozz::make_range(positions),
+                        kStride));
+  EXPECT_FALSE(bvh.joint_refit());
+  EXPECT_FALSE(bvh.SetupJointRefit(ozz::make_range(joints),
+                                   sizeof(uint16_t) * 2, 0));
+  EXPECT_FALSE(bvh.SetupJointRefit(
+      ozz::Range<const uint16_t>(&joints[0], 4), sizeof(uint16_t) * 2, 2));
+  ASSERT_TRUE(bvh.SetupJointRefit(ozz::make_range(joints),
+                                  sizeof(uint16_t) * 2, 2));
+  EXPECT_TRUE(bvh.joint_refit());
+
+  // Joint 0 is translated, joint 1 is rotated.
+  const ozz::math::Float4x4 matrices[2] = {
+      ozz::math::Float4x4::Translation(
+          ozz::math::simd_float4::Load(0.f, 2.f, 0.f, 0.f)),
+      ozz::math::Float4x4::FromAxisAngle(
+          ozz::math::simd_float4::y_axis(),
+          ozz::math::simd_float4::Load1(.7f))};
+  EXPECT_FALSE(bvh.Refit(ozz::Range<const ozz::math::Float4x4>(matrices, 1)));
+  ASSERT_TRUE(bvh.Refit(matrices));
+  const ozz::math::Box conservative = bvh.bounds();
+
+  // Skins vertices with both joints weighted .5, and checks every vertex is
+  // enclosed by conservative bounds.
+  ozz::Vector<float>::Std skinned(positions.size());
+  for (int i = 0; i < vertex_count; ++i) {
+    const ozz::math::SimdFloat4 p =
+        ozz::math::simd_float4::Load3PtrU(&positions[i * 3]);
+    ozz::math::SimdFloat4 s = ozz::math::TransformPoint(matrices[0], p);
+    if (joints[i * 2 + 1] == 1) {
+      s = (s + ozz::math::TransformPoint(matrices[1], p)) *
+          ozz::math::simd_float4::Load1(.5f);
+    }
+    ozz::math::Store3PtrU(s, &skinned[i * 3]);
+    const ozz::math::Float3 v(skinned[i * 3], skinned[i * 3 + 1],
+                              skinned[i * 3 + 2]);
+    EXPECT_TRUE(conservative.is_inside(v));
+  }
+
+  // Conservative bounds contain exact ones, and both find the same hit.
+  ozz::math::Box exact;
+  MeshBvhHit conservative_hit;
+  const ozz::math::Float3 origin(2.5f, 10.f, 2.5f);
+  const ozz::math::Float3 direction(0.f, -1.f, 0.f);
+  ASSERT_TRUE(bvh.Raycast(origin, direction, ozz::make_range(skinned),
+                          kStride, 1e30f, &conservative_hit));
+  ASSERT_TRUE(bvh.Refit(ozz::make_range(skinned), kStride));
+  exact = bvh.bounds();
+  EXPECT_TRUE(conservative.is_inside(exact.min));
+  EXPECT_TRUE(conservative.is_inside(exact.max));
+  MeshBvhHit exact_hit;
+  ASSERT_TRUE(bvh.Raycast(origin, direction, ozz::make_range(skinned),
+                          kStride, 1e30f, &exact_hit));
+  EXPECT_EQ(exact_hit.triangle, conservative_hit.triangle);
+  EXPECT_FLOAT_EQ(exact_hit.distance, conservative_hit.distance);
+  EXPECT_NEAR(exact_hit.point.y, 2.1f, .11f);
+
+  // Rebuilding resets joint refit.
+  ASSERT_TRUE(bvh.Build(ozz::make_range(indices), ozz::make_range(positions),
+                        kStride));
+  EXPECT_FALSE(bvh.joint_refit());
+  EXPECT_FALSE(bvh.Refit(matrices));
+}
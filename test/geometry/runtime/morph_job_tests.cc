@@ -0,0 +1,221 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#include "ozz/geometry/runtime/morph_job.h"
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/simd_math.h"
+
+using ozz::geometry::MorphDeltaBlock;
+using ozz::geometry::MorphJob;
+using ozz::geometry::MorphTarget;
+
+namespace {
+// Sets block _lane delta.
+void SetMorphDelta(MorphDeltaBlock* _block, int _lane, int _vertex,
+                   float _x, float _y, float _z) {
+  float positions[3][4];
+  float normals[3][4];
+  for (int i = 0; i < 3; ++i) {
+    ozz::math::StorePtrU(_block->positions[i], positions[i]);
+    ozz::math::StorePtrU(_block->normals[i], normals[i]);
+  }
+  positions[0][_lane] = _x;
+  positions[1][_lane] = _y;
+  positions[2][_lane] = _z;
+  normals[0][_lane] = _z;
+  normals[1][_lane] = _y;
+  normals[2][_lane] = _x;
+  for (int i = 0; i < 3; ++i) {
+    _block->positions[i] = ozz::math::simd_float4::LoadPtrU(positions[i]);
+    _block->normals[i] = ozz::math::simd_float4::LoadPtrU(normals[i]);
+  }
+  _block->vertices[_lane] = _vertex;
+}
+
+// Initializes a block with zero deltas for vertex _vertex.
+void InitMorphBlock(MorphDeltaBlock* _block, int _vertex) {
+  for (int i = 0; i < 3; ++i) {
+    _block->positions[i] = ozz::math::simd_float4::zero();
+    _block->normals[i] = ozz::math::simd_float4::zero();
+  }
+  for (int i = 0; i < 4; ++i) {
+    _block->vertices[i] = _vertex;
+  }
+}
+}  // namespace
+
+TEST(JobValidity, MorphJob) {
+  const float in[6] = {0.f};
+  float out[6];
+  MorphTarget targets[2];
+  const float weights[2] = {0.f};
+
+  {  // Default job.
+    MorphJob job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  {  // Valid job.
+    MorphJob job;
+    job.vertex_count = 2;
+    job.targets = targets;
+    job.weights = weights;
+    job.in_positions = in;
+    job.in_positions_stride = sizeof(float) * 3;
+    job.out_positions = out;
+    job.out_positions_stride = sizeof(float) * 3;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+
+    MorphJob invalid = job;
+    invalid.vertex_count = 3;
+    EXPECT_FALSE(invalid.Validate());
+    invalid = job;
+    invalid.vertex_count = -1;
+    EXPECT_FALSE(invalid.Validate());
+    invalid = job;
+    invalid.first_vertex = -1;
+    EXPECT_FALSE(invalid.Validate());
+    invalid = job;
+    invalid.weights = ozz::Range<const float>(weights, 1);
+    EXPECT_FALSE(invalid.Validate());
+    invalid = job;
+    invalid.out_positions = ozz::Range<float>();
+    EXPECT_FALSE(invalid.Validate());
+    invalid = job;
+    invalid.in_normals = in;
+    invalid.in_normals_stride = sizeof(float) * 3;
+    EXPECT_FALSE(invalid.Validate());
+    invalid.out_normals = out;
+    invalid.out_normals_stride = sizeof(float) * 3;
+    EXPECT_TRUE(invalid.Validate());
+
+    // No vertex, no target.
+    MorphJob empty;
+    empty.in_positions = in;
+    empty.out_positions = out;
+    EXPECT_TRUE(empty.Validate());
+    EXPECT_TRUE(empty.Run());
+  }
+}
+
+TEST(JobResult, MorphJob) {
+  const int kVertexCount = 7;
+  float in_positions[kVertexCount][3];
+  float in_normals[kVertexCount][3];
+  for (int i = 0; i < kVertexCount; ++i) {
+    for (int c = 0; c < 3; ++c) {
+      in_positions[i][c] = static_cast<float>(i * 3 + c);
+      in_normals[i][c] = c == 1 ? 1.f : 0.f;
+    }
+  }
+
+  // Target 0 moves vertices 1, 2, 4, 5 and 6, the last block being padded.
+  MorphDeltaBlock blocks0[2];
+  InitMorphBlock(&blocks0[0], 1);
+  SetMorphDelta(&blocks0[0], 0, 1, 1.f, 0.f, 0.f);
+  SetMorphDelta(&blocks0[0], 1, 2, 0.f, 2.f, 0.f);
+  SetMorphDelta(&blocks0[0], 2, 4, 0.f, 0.f, 3.f);
+  SetMorphDelta(&blocks0[0], 3, 5, 1.f, 1.f, 1.f);
+  InitMorphBlock(&blocks0[1], 6);
+  SetMorphDelta(&blocks0[1], 0, 6, -1.f, -2.f, -3.f);
+
+  // Target 1 moves vertex 2.
+  MorphDeltaBlock blocks1[1];
+  InitMorphBlock(&blocks1[0], 2);
+  SetMorphDelta(&blocks1[0], 0, 2, 10.f, 20.f, 30.f);
+
+  MorphTarget targets[2];
+  targets[0].blocks = blocks0;
+  targets[1].blocks = blocks1;
+  float weights[2] = {.5f, 0.f};
+
+  float out_positions[kVertexCount][3];
+  float out_normals[kVertexCount][3];
+
+  MorphJob job;
+  job.vertex_count = kVertexCount;
+  job.targets = targets;
+  job.weights = weights;
+  job.in_positions = ozz::Range<const float>(in_positions[0], kVertexCount * 3);
+  job.in_positions_stride = sizeof(float) * 3;
+  job.in_normals = ozz::Range<const float>(in_normals[0], kVertexCount * 3);
+  job.in_normals_stride = sizeof(float) * 3;
+  job.out_positions = ozz::Range<float>(out_positions[0], kVertexCount * 3);
+  job.out_positions_stride = sizeof(float) * 3;
+  job.out_normals = ozz::Range<float>(out_normals[0], kVertexCount * 3);
+  job.out_normals_stride = sizeof(float) * 3;
+  ASSERT_TRUE(job.Run());
+
+  EXPECT_FLOAT_EQ(out_positions[0][0], 0.f);
+  EXPECT_FLOAT_EQ(out_positions[1][0], 3.5f);
+  EXPECT_FLOAT_EQ(out_positions[2][1], 8.f);
+  EXPECT_FLOAT_EQ(out_positions[3][2], 11.f);
+  EXPECT_FLOAT_EQ(out_positions[4][2], 15.5f);
+  EXPECT_FLOAT_EQ(out_positions[5][1], 16.5f);
+  EXPECT_FLOAT_EQ(out_positions[6][0], 17.5f);
+  EXPECT_FLOAT_EQ(out_positions[6][2], 18.5f);
+  EXPECT_FLOAT_EQ(out_normals[0][1], 1.f);
+  EXPECT_FLOAT_EQ(out_normals[1][2], .5f);
+  EXPECT_FLOAT_EQ(out_normals[4][0], 1.5f);
+  EXPECT_FLOAT_EQ(out_normals[6][0], -1.5f);
+
+  // Both targets.
+  weights[1] = 1.f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_FLOAT_EQ(out_positions[2][0], 16.f);
+  EXPECT_FLOAT_EQ(out_positions[2][1], 28.f);
+  EXPECT_FLOAT_EQ(out_positions[2][2], 38.f);
+  EXPECT_FLOAT_EQ(out_positions[1][0], 3.5f);
+
+  // By chunks of vertices, in place.
+  float chunked[kVertexCount][3];
+  memcpy(chunked, in_positions, sizeof(chunked));
+  for (int first = 0; first < kVertexCount; first += 2) {
+    MorphJob chunk;
+    chunk.first_vertex = first;
+    chunk.vertex_count = first + 2 <= kVertexCount ? 2 : kVertexCount - first;
+    chunk.targets = targets;
+    chunk.weights = weights;
+    chunk.in_positions =
+        ozz::Range<const float>(chunked[first], chunk.vertex_count * 3);
+    chunk.in_positions_stride = sizeof(float) * 3;
+    chunk.out_positions = ozz::Range<float>(chunked[first],
+                                            chunk.vertex_count * 3);
+    chunk.out_positions_stride = sizeof(float) * 3;
+    ASSERT_TRUE(chunk.Run());
+  }
+  for (int i = 0; i < kVertexCount; ++i) {
+    for (int c = 0; c < 3; ++c) {
+      EXPECT_FLOAT_EQ(chunked[i][c], out_positions[i][c]);
+    }
+  }
+}
@@ -0,0 +1,278 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2019 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+
+#include "ozz/geometry/runtime/parallel_skinning_job.h"
+
+#include <cstring>
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/memory/allocator.h"
+
+using ozz::geometry::ParallelSkinningJob;
+using ozz::geometry::SkinningJob;
+using ozz::geometry::TaskScheduler;
+
+namespace {
+// Runs tasks in reverse order, to ensure chunks don't depend on each other.
+class ReverseScheduler : public TaskScheduler {
+ public:
+  ReverseScheduler() : num_tasks(0) {}
+  virtual void ParallelFor(Task _task, void* _context, int _count) {
+    for (int i = _count - 1; i >= 0; --i) {
+      _task(_context, i);
+      ++num_tasks;
+    }
+  }
+  int num_tasks;
+};
+
+struct VertexIn {
+  uint16_t indices[2];
+  float weight;
+  float pos[3];
+  float normal[3];
+};
+
+struct VertexOut {
+  float pos[3];
+  float normal[3];
+};
+}  // namespace
+
+TEST(JobValidity, ParallelSkinningJob) {
+  ParallelSkinningJob job;
+  EXPECT_FALSE(job.Validate());
+  EXPECT_FALSE(job.Run());
+  EXPECT_EQ(job.NumChunks(), 0);
+
+  SkinningJob chunk;
+  EXPECT_FALSE(job.GetChunk(0, &chunk));
+
+  const ozz::math::Float4x4 matrices[1] = {ozz::math::Float4x4::identity()};
+  const uint16_t joint_indices[1] = {0};
+  const float in_positions[3] = {1.f, 2.f, 3.f};
+  float out_positions[3];
+  job.job.vertex_count = 1;
+  job.job.influences_count = 1;
+  job.job.joint_matrices = matrices;
+  job.job.joint_indices = joint_indices;
+  job.job.joint_indices_stride = sizeof(uint16_t);
+  job.job.in_positions = in_positions;
+  job.job.in_positions_stride = sizeof(float) * 3;
+  job.job.out_positions = out_positions;
+  job.job.out_positions_stride = sizeof(float) * 3;
+  EXPECT_TRUE(job.Validate());
+  EXPECT_EQ(job.NumChunks(), 1);
+  EXPECT_FALSE(job.GetChunk(1, &chunk));
+  EXPECT_FALSE(job.GetChunk(0, NULL));
+  EXPECT_TRUE(job.GetChunk(0, &chunk));
+  EXPECT_EQ(chunk.vertex_count, 1);
+
+  // Influence buckets can't be split.
+  const int buckets[1] = {1};
+  job.job.influences_buckets = buckets;
+  EXPECT_TRUE(job.job.Validate());
+  EXPECT_FALSE(job.Validate());
+  job.job.influences_buckets = ozz::Range<const int>();
+
+  // Neither can rigid ranges.
+  const SkinningJob::RigidRange ranges[1] = {{0, 1}};
+  job.job.rigid_ranges = ranges;
+  EXPECT_TRUE(job.job.Validate());
+  EXPECT_FALSE(job.Validate());
+  job.job.rigid_ranges = ozz::Range<const SkinningJob::RigidRange>();
+
+  job.chunk_size = 0;
+  EXPECT_FALSE(job.Validate());
+  EXPECT_FALSE(job.Run());
+
+  // No vertex.
+  job.chunk_size = 16;
+  job.job.vertex_count = 0;
+  EXPECT_TRUE(job.Validate());
+  EXPECT_EQ(job.NumChunks(), 0);
+  EXPECT_TRUE(job.Run());
+}
+
+TEST(Chunks, ParallelSkinningJob) {
+  const int kVertexCount = 1001;
+  const ozz::math::Float4x4 matrices[2] = {
+      ozz::math::Float4x4::Translation(
+          ozz::math::simd_float4::Load(1.f, 2.f, 3.f, 0.f)),
+      ozz::math::Float4x4::Scaling(
+          ozz::math::simd_float4::Load(2.f, 3.f, 4.f, 0.f))};
+
+  VertexIn* in =
+      static_cast<VertexIn*>(ozz::memory::default_allocator()->Allocate(
+          sizeof(VertexIn) * kVertexCount, OZZ_ALIGN_OF(VertexIn)));
+  for (int i = 0; i < kVertexCount; ++i) {
+    in[i].indices[0] = static_cast<uint16_t>(i % 2);
+    in[i].indices[1] = static_cast<uint16_t>((i + 1) % 2);
+    in[i].weight = static_cast<float>(i % 10) * .1f;
+    for (int j = 0; j < 3; ++j) {
+      in[i].pos[j] = static_cast<float>(i + j);
+      in[i].normal[j] = j == i % 3 ? 1.f : 0.f;
+    }
+  }
+
+  // Outputs are offset from cache line alignment, to test the first chunk
+  // absorbs misaligned vertices.
+  const size_t out_size = sizeof(VertexOut) * kVertexCount;
+  char* buffers = static_cast<char*>(
+      ozz::memory::default_allocator()->Allocate(out_size * 2 + 64, 64));
+  VertexOut* expected = reinterpret_cast<VertexOut*>(buffers + 8);
+  VertexOut* out = reinterpret_cast<VertexOut*>(buffers + 8 + out_size + 56);
+
+  SkinningJob skinning_job;
+  skinning_job.vertex_count = kVertexCount;
+  skinning_job.influences_count = 2;
+  skinning_job.joint_matrices = matrices;
+  skinning_job.joint_indices = ozz::Range<const uint16_t>(
+      in[0].indices, reinterpret_cast<const uint16_t*>(in + kVertexCount));
+  skinning_job.joint_indices_stride = sizeof(VertexIn);
+  skinning_job.joint_weights = ozz::Range<const float>(
+      &in[0].weight, reinterpret_cast<const float*>(in + kVertexCount));
+  skinning_job.joint_weights_stride = sizeof(VertexIn);
+  skinning_job.in_positions = ozz::Range<const float>(
+      in[0].pos, reinterpret_cast<const float*>(in + kVertexCount));
+  skinning_job.in_positions_stride = sizeof(VertexIn);
+  skinning_job.in_normals = ozz::Range<const float>(
+      in[0].normal, reinterpret_cast<const float*>(in + kVertexCount));
+  skinning_job.in_normals_stride = sizeof(VertexIn);
+  skinning_job.out_positions = ozz::Range<float>(
+      expected[0].pos, reinterpret_cast<float*>(expected + kVertexCount));
+  skinning_job.out_positions_stride = sizeof(VertexOut);
+  skinning_job.out_normals = ozz::Range<float>(
+      expected[0].normal, reinterpret_cast<float*>(expected + kVertexCount));
+  skinning_job.out_normals_stride = sizeof(VertexOut);
+  ASSERT_TRUE(skinning_job.Run());
+
+  ParallelSkinningJob job;
+  job.job = skinning_job;
+  job.job.out_positions = ozz::Range<float>(
+      out[0].pos, reinterpret_cast<float*>(out + kVertexCount));
+  job.job.out_normals = ozz::Range<float>(
+      out[0].normal, reinterpret_cast<float*>(out + kVertexCount));
+  job.chunk_size = 100;
+  ASSERT_TRUE(job.Validate());
+
+  // Chunks are contiguous, at least chunk_size large (but the last one), and
+  // start on cache lines (but the first one).
+  const int num_chunks = job.NumChunks();
+  ASSERT_GT(num_chunks, 1);
+  int vertex_count = 0;
+  for (int i = 0; i < num_chunks; ++i) {
+    SkinningJob chunk;
+    ASSERT_TRUE(job.GetChunk(i, &chunk));
+    EXPECT_TRUE(chunk.Validate());
+    EXPECT_TRUE(chunk.out_positions.begin == out[vertex_count].pos);
+    EXPECT_TRUE(chunk.out_normals.begin == out[vertex_count].normal);
+    EXPECT_TRUE(chunk.in_positions.begin == in[vertex_count].pos);
+    EXPECT_EQ(chunk.morph_first_vertex, vertex_count);
+    if (i != 0) {
+      EXPECT_EQ(reinterpret_cast<uintptr_t>(chunk.out_positions.begin) % 64,
+                0u);
+    }
+    if (i != num_chunks - 1) {
+      EXPECT_GE(chunk.vertex_count, job.chunk_size);
+    }
+    vertex_count += chunk.vertex_count;
+  }
+  EXPECT_EQ(vertex_count, kVertexCount);
+
+  // Runs with a scheduler.
+  ReverseScheduler scheduler;
+  job.scheduler = &scheduler;
+  ASSERT_TRUE(job.Run());
+  EXPECT_EQ(scheduler.num_tasks, num_chunks);
+  for (int i = 0; i < kVertexCount; ++i) {
+    for (int j = 0; j < 3; ++j) {
+      EXPECT_FLOAT_EQ(out[i].pos[j], expected[i].pos[j]);
+      EXPECT_FLOAT_EQ(out[i].normal[j], expected[i].normal[j]);
+    }
+  }
+
+  // Runs without scheduler.
+  std::memset(out, 0, out_size);
+  job.scheduler = NULL;
+  ASSERT_TRUE(job.Run());
+  for (int i = 0; i < kVertexCount; ++i) {
+    for (int j = 0; j < 3; ++j) {
+      EXPECT_FLOAT_EQ(out[i].pos[j], expected[i].pos[j]);
+      EXPECT_FLOAT_EQ(out[i].normal[j], expected[i].normal[j]);
+    }
+  }
+
+  {  // Invalid resume arguments.
+    int cursor = 0;
+    EXPECT_FALSE(job.Resume(NULL, 1));
+    EXPECT_FALSE(job.Resume(&cursor, 0));
+    cursor = -1;
+    EXPECT_FALSE(job.Resume(&cursor, 1));
+    cursor = num_chunks + 1;
+    EXPECT_FALSE(job.Resume(&cursor, 1));
+    EXPECT_EQ(cursor, num_chunks + 1);
+  }
+
+  // Resumes 3 chunks at a time, with and without scheduler.
+  for (int l = 0; l < 2; ++l) {
+    std::memset(out, 0, out_size);
+    scheduler.num_tasks = 0;
+    job.scheduler = l == 0 ? NULL : &scheduler;
+    int cursor = 0;
+    int slices = 0;
+    while (cursor != num_chunks) {
+      ASSERT_TRUE(job.Resume(&cursor, 3));
+      ++slices;
+
+      // Only chunks up to the cursor were skinned.
+      SkinningJob chunk;
+      if (cursor < num_chunks) {
+        ASSERT_TRUE(job.GetChunk(cursor, &chunk));
+        EXPECT_EQ(out[chunk.morph_first_vertex].pos[0], 0.f);
+      }
+    }
+    EXPECT_EQ(slices, (num_chunks + 2) / 3);
+    EXPECT_EQ(scheduler.num_tasks, l == 0 ? 0 : num_chunks);
+    for (int i = 0; i < kVertexCount; ++i) {
+      for (int j = 0; j < 3; ++j) {
+        EXPECT_FLOAT_EQ(out[i].pos[j], expected[i].pos[j]);
+        EXPECT_FLOAT_EQ(out[i].normal[j], expected[i].normal[j]);
+      }
+    }
+
+    // Resuming a complete job does nothing.
+    ASSERT_TRUE(job.Resume(&cursor, 3));
+    EXPECT_EQ(cursor, num_chunks);
+  }
+
+  ozz::memory::default_allocator()->Deallocate(buffers);
+  ozz::memory::default_allocator()->Deallocate(in);
+}
@@ -27,12 +27,19 @@
 
 #include "ozz/geometry/runtime/skinning_job.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
 #include "gtest/gtest.h"
 
 #include "ozz/base/containers/vector.h"
 #include "ozz/base/log.h"
 #include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/math_constant.h"
+#include "ozz/base/maths/simd_affine.h"
 #include "ozz/base/maths/simd_math.h"
+#include "ozz/geometry/runtime/morph_job.h"
 
 using ozz::geometry::SkinningJob;
 
@@ -1128,6 +1135,1134 @@ struct BenchVertexOut {
   float tangents[3];
 };
 
+namespace {
+// Computes the reference skinning of a 3 components point (_w = 1) or vector
+// (_w = 0) _in, with weighted matrices.
+void SkinReference(const ozz::math::Float4x4* _matrices,
+                   const uint16_t* _indices, const float* _weights,
+                   int _influences, const float* _in, float _w, float* _out) {
+  float matrix[4][4] = {{0.f}};
+  float wsum = 0.f;
+  for (int j = 0; j < _influences; ++j) {
+    const float w = j != _influences - 1 ? _weights[j] : 1.f - wsum;
+    wsum += w;
+    for (int c = 0; c < 4; ++c) {
+      float col[4];
+      ozz::math::StorePtrU(_matrices[_indices[j]].cols[c], col);
+      for (int r = 0; r < 4; ++r) {
+        matrix[c][r] += col[r] * w;
+      }
+    }
+  }
+  for (int r = 0; r < 3; ++r) {
+    _out[r] = matrix[0][r] * _in[0] + matrix[1][r] * _in[1] +
+              matrix[2][r] * _in[2] + matrix[3][r] * _w;
+  }
+}
+}  // namespace
+
+TEST(BatchResult, SkinningJob) {
+  // Uses a number of vertices that isn't a multiple of the number of vertices
+  // that can be processed at once by wide skinning implementations.
+  const int kVertexCount = 19;
+  const int kMaxInfluences = 6;
+  const int kJointCount = 5;
+
+  ozz::math::Float4x4 matrices[kJointCount];
+  ozz::math::Float4x4 it_matrices[kJointCount];
+  for (int i = 0; i < kJointCount; ++i) {
+    const float f = static_cast<float>(i);
+    matrices[i] =
+        ozz::math::Float4x4::Translation(
+            ozz::math::simd_float4::Load(f, 1.f - f, 2.f * f, 0.f)) *
+        ozz::math::Float4x4::FromEuler(
+            ozz::math::simd_float4::Load(.1f * f, .7f, -.3f * f, 0.f)) *
+        ozz::math::Float4x4::Scaling(
+            ozz::math::simd_float4::Load(1.f, 1.f + f, 2.f, 0.f));
+    it_matrices[i] = Transpose(Invert(matrices[i]));
+  }
+
+  struct VertexIn {
+    uint16_t indices[kMaxInfluences];
+    float weights[kMaxInfluences - 1];
+    float pos[3];
+    float normal[3];
+    float tangent[3];
+  };
+  struct VertexOut {
+    float pos[3];
+    float normal[3];
+    float tangent[3];
+  };
+  VertexIn in[kVertexCount];
+  for (int i = 0; i < kVertexCount; ++i) {
+    for (int j = 0; j < kMaxInfluences; ++j) {
+      in[i].indices[j] = static_cast<uint16_t>((i + j * 3) % kJointCount);
+    }
+    for (int j = 0; j < kMaxInfluences - 1; ++j) {
+      in[i].weights[j] = .1f + .02f * j + .001f * i;
+    }
+    for (int j = 0; j < 3; ++j) {
+      in[i].pos[j] = static_cast<float>(i * 3 + j) * .5f;
+      in[i].normal[j] = j == i % 3 ? 1.f : 0.f;
+      in[i].tangent[j] = j == (i + 1) % 3 ? 1.f : 0.f;
+    }
+  }
+
+  for (int influences = 1; influences <= kMaxInfluences; ++influences) {
+    for (int it = 0; it < 2; ++it) {
+      VertexOut out[kVertexCount];
+
+      SkinningJob job;
+      job.vertex_count = kVertexCount;
+      job.influences_count = influences;
+      job.joint_matrices = matrices;
+      if (it) {
+        job.joint_inverse_transpose_matrices = it_matrices;
+      }
+      job.joint_indices = ozz::Range<const uint16_t>(
+          in[0].indices,
+          reinterpret_cast<const uint16_t*>(in + kVertexCount));
+      job.joint_indices_stride = sizeof(VertexIn);
+      job.joint_weights = ozz::Range<const float>(
+          in[0].weights, reinterpret_cast<const float*>(in + kVertexCount));
+      job.joint_weights_stride = sizeof(VertexIn);
+      job.in_positions = ozz::Range<const float>(
+          in[0].pos, reinterpret_cast<const float*>(in + kVertexCount));
+      job.in_positions_stride = sizeof(VertexIn);
+      job.in_normals = ozz::Range<const float>(
+          in[0].normal, reinterpret_cast<const float*>(in + kVertexCount));
+      job.in_normals_stride = sizeof(VertexIn);
+      job.in_tangents = ozz::Range<const float>(
+          in[0].tangent, reinterpret_cast<const float*>(in + kVertexCount));
+      job.in_tangents_stride = sizeof(VertexIn);
+      job.out_positions = ozz::Range<float>(
+          out[0].pos, reinterpret_cast<float*>(out + kVertexCount));
+      job.out_positions_stride = sizeof(VertexOut);
+      job.out_normals = ozz::Range<float>(
+          out[0].normal, reinterpret_cast<float*>(out + kVertexCount));
+      job.out_normals_stride = sizeof(VertexOut);
+      job.out_tangents = ozz::Range<float>(
+          out[0].tangent, reinterpret_cast<float*>(out + kVertexCount));
+      job.out_tangents_stride = sizeof(VertexOut);
+      ASSERT_TRUE(job.Run());
+
+      const ozz::math::Float4x4* vectors_matrices =
+          it ? it_matrices : matrices;
+      for (int i = 0; i < kVertexCount; ++i) {
+        float pos[3];
+        float normal[3];
+        float tangent[3];
+        SkinReference(matrices, in[i].indices, in[i].weights, influences,
+                      in[i].pos, 1.f, pos);
+        SkinReference(vectors_matrices, in[i].indices, in[i].weights,
+                      influences, in[i].normal, 0.f, normal);
+        SkinReference(vectors_matrices, in[i].indices, in[i].weights,
+                      influences, in[i].tangent, 0.f, tangent);
+        for (int j = 0; j < 3; ++j) {
+          EXPECT_NEAR(out[i].pos[j], pos[j], 1e-4f);
+          EXPECT_NEAR(out[i].normal[j], normal[j], 1e-4f);
+          EXPECT_NEAR(out[i].tangent[j], tangent[j], 1e-4f);
+        }
+      }
+    }
+  }
+}
+
+TEST(CompactInput, SkinningJob) {
+  // Uses enough vertices to require multiple decoding batches.
+  const int kVertexCount = 601;
+  const int kInfluences = 4;
+  const int kJointCount = 7;
+
+  ozz::math::Float4x4 matrices[kJointCount];
+  for (int i = 0; i < kJointCount; ++i) {
+    const float f = static_cast<float>(i);
+    matrices[i] = ozz::math::Float4x4::Translation(
+                      ozz::math::simd_float4::Load(f, -f, 2.f * f, 0.f)) *
+                  ozz::math::Float4x4::FromEuler(
+                      ozz::math::simd_float4::Load(.2f * f, -.4f, .1f, 0.f));
+  }
+
+  ozz::Vector<uint16_t>::Std indices(kVertexCount * kInfluences);
+  ozz::Vector<uint8_t>::Std indices_u8(kVertexCount * kInfluences);
+  ozz::Vector<float>::Std weights(kVertexCount * (kInfluences - 1));
+  ozz::Vector<uint8_t>::Std weights_u8(kVertexCount * (kInfluences - 1));
+  ozz::Vector<uint16_t>::Std weights_u16(kVertexCount * (kInfluences - 1));
+  ozz::Vector<float>::Std weights_from_u8(kVertexCount * (kInfluences - 1));
+  ozz::Vector<float>::Std weights_from_u16(kVertexCount * (kInfluences - 1));
+  ozz::Vector<float>::Std in_positions(kVertexCount * 3);
+  for (int i = 0; i < kVertexCount; ++i) {
+    for (int j = 0; j < kInfluences; ++j) {
+      const int index = (i * 3 + j) % kJointCount;
+      indices[i * kInfluences + j] = static_cast<uint16_t>(index);
+      indices_u8[i * kInfluences + j] = static_cast<uint8_t>(index);
+    }
+    for (int j = 0; j < kInfluences - 1; ++j) {
+      const int w = i * (kInfluences - 1) + j;
+      weights_u8[w] = static_cast<uint8_t>((i + j * 20) % 80);
+      weights_u16[w] = static_cast<uint16_t>((i * 51 + j * 5000) % 20000);
+      weights_from_u8[w] = weights_u8[w] / 255.f;
+      weights_from_u16[w] = weights_u16[w] / 65535.f;
+      weights[w] = weights_from_u8[w];
+    }
+    for (int j = 0; j < 3; ++j) {
+      in_positions[i * 3 + j] = static_cast<float>(i + j) * .1f;
+    }
+  }
+  ozz::Vector<float>::Std out_positions(kVertexCount * 3);
+  ozz::Vector<float>::Std expected_positions(kVertexCount * 3);
+
+  SkinningJob base_job;
+  base_job.vertex_count = kVertexCount;
+  base_job.influences_count = kInfluences;
+  base_job.joint_matrices = matrices;
+  base_job.joint_indices = make_range(indices);
+  base_job.joint_indices_stride = sizeof(uint16_t) * kInfluences;
+  base_job.joint_weights = make_range(weights);
+  base_job.joint_weights_stride = sizeof(float) * (kInfluences - 1);
+  base_job.in_positions = make_range(in_positions);
+  base_job.in_positions_stride = sizeof(float) * 3;
+  base_job.out_positions = make_range(expected_positions);
+  base_job.out_positions_stride = sizeof(float) * 3;
+
+  {  // Validates formats.
+    SkinningJob job = base_job;
+    job.joint_indices_u8 = make_range(indices_u8);
+    EXPECT_FALSE(job.Validate());
+    job.joint_indices = ozz::Range<const uint16_t>();
+    EXPECT_FALSE(job.Validate());  // Stride is too big for 8 bits indices.
+    job.joint_indices_stride = sizeof(uint8_t) * kInfluences;
+    EXPECT_TRUE(job.Validate());
+    job.joint_weights_u8 = make_range(weights_u8);
+    EXPECT_FALSE(job.Validate());
+    job.joint_weights = ozz::Range<const float>();
+    EXPECT_FALSE(job.Validate());  // Stride is too big for 8 bits weights.
+    job.joint_weights_stride = sizeof(uint8_t) * (kInfluences - 1);
+    EXPECT_TRUE(job.Validate());
+    job.joint_weights_u16 = make_range(weights_u16);
+    EXPECT_FALSE(job.Validate());
+    job.joint_weights_u16 = ozz::Range<const uint16_t>();
+
+    // Too many influences for compact formats.
+    job.vertex_count = 1;
+    job.influences_count = SkinningJob::kMaxCompactInfluences + 1;
+    EXPECT_FALSE(job.Validate());
+    job.influences_count = SkinningJob::kMaxCompactInfluences;
+    EXPECT_TRUE(job.Validate());
+  }
+
+  // Compares 8 bits indices and 8 bits weights with float weights.
+  {
+    ASSERT_TRUE(base_job.Run());
+
+    SkinningJob job = base_job;
+    job.joint_indices = ozz::Range<const uint16_t>();
+    job.joint_indices_u8 = make_range(indices_u8);
+    job.joint_indices_stride = sizeof(uint8_t) * kInfluences;
+    job.joint_weights = ozz::Range<const float>();
+    job.joint_weights_u8 = make_range(weights_u8);
+    job.joint_weights_stride = sizeof(uint8_t) * (kInfluences - 1);
+    job.out_positions = make_range(out_positions);
+    ASSERT_TRUE(job.Run());
+    for (int i = 0; i < kVertexCount * 3; ++i) {
+      EXPECT_NEAR(out_positions[i], expected_positions[i], 1e-4f);
+    }
+  }
+
+  // Compares 16 bits indices and 16 bits weights with float weights.
+  {
+    SkinningJob expected_job = base_job;
+    expected_job.joint_weights = make_range(weights_from_u16);
+    ASSERT_TRUE(expected_job.Run());
+
+    SkinningJob job = base_job;
+    job.joint_weights = ozz::Range<const float>();
+    job.joint_weights_u16 = make_range(weights_u16);
+    job.joint_weights_stride = sizeof(uint16_t) * (kInfluences - 1);
+    job.out_positions = make_range(out_positions);
+    ASSERT_TRUE(job.Run());
+    for (int i = 0; i < kVertexCount * 3; ++i) {
+      EXPECT_NEAR(out_positions[i], expected_positions[i], 1e-4f);
+    }
+  }
+}
+
+namespace {
+// Packs normalized vector _v in kSnorm10x3_2 format, with _w bits.
+uint32_t PackSnorm10x3_2(const float* _v, uint32_t _w) {
+  uint32_t packed = _w << 30;
+  for (int i = 0; i < 3; ++i) {
+    const int value = static_cast<int>(std::floor(_v[i] * 511.f + .5f));
+    packed |= (value & 0x3ff) << (i * 10);
+  }
+  return packed;
+}
+
+// Unpacks kSnorm10x3_2 _packed to _v, and returns w bits.
+uint32_t UnpackSnorm10x3_2(uint32_t _packed, float* _v) {
+  for (int i = 0; i < 3; ++i) {
+    const int value = static_cast<int>(_packed << (22 - i * 10)) >> 22;
+    _v[i] = std::max(value / 511.f, -1.f);
+  }
+  return _packed >> 30;
+}
+}  // namespace
+
+TEST(VertexFormats, SkinningJob) {
+  // Uses enough vertices to require multiple conversion batches.
+  const int kVertexCount = 301;
+  const ozz::math::Float4x4 matrices[2] = {
+      ozz::math::Float4x4::FromEuler(
+          ozz::math::simd_float4::Load(.5f, -.2f, .3f, 0.f)),
+      ozz::math::Float4x4::Translation(
+          ozz::math::simd_float4::Load(1.f, 2.f, 3.f, 0.f)) *
+          ozz::math::Float4x4::FromEuler(
+              ozz::math::simd_float4::Load(-.1f, .7f, 0.f, 0.f))};
+
+  struct GpuVertex {
+    uint16_t position[3];
+    int16_t normal[3];
+    uint32_t tangent;
+  };
+
+  ozz::Vector<uint16_t>::Std indices(kVertexCount * 2);
+  ozz::Vector<float>::Std weights(kVertexCount);
+  ozz::Vector<float>::Std positions(kVertexCount * 3);
+  ozz::Vector<float>::Std normals(kVertexCount * 3);
+  ozz::Vector<float>::Std tangents(kVertexCount * 3);
+  ozz::Vector<GpuVertex>::Std in_gpu(kVertexCount);
+  for (int i = 0; i < kVertexCount; ++i) {
+    indices[i * 2 + 0] = static_cast<uint16_t>(i % 2);
+    indices[i * 2 + 1] = static_cast<uint16_t>((i + 1) % 2);
+    weights[i] = static_cast<float>(i % 11) / 10.f;
+
+    // Builds normals and tangents, and quantizes them so that the reference
+    // float inputs are the same as the gpu ones.
+    const float angle = static_cast<float>(i) * .1f;
+    const float normal[3] = {std::cos(angle), std::sin(angle), 0.f};
+    const float tangent[3] = {0.f, std::cos(angle), std::sin(angle)};
+    GpuVertex& gpu = in_gpu[i];
+    for (int j = 0; j < 3; ++j) {
+      gpu.position[j] = ozz::math::FloatToHalf(static_cast<float>(i + j) * .1f);
+      positions[i * 3 + j] = ozz::math::HalfToFloat(gpu.position[j]);
+      gpu.normal[j] = static_cast<int16_t>(
+          std::floor(normal[j] * 32767.f + .5f));
+      normals[i * 3 + j] = gpu.normal[j] / 32767.f;
+    }
+    gpu.tangent = PackSnorm10x3_2(tangent, i % 4);
+    UnpackSnorm10x3_2(gpu.tangent, &tangents[i * 3]);
+  }
+
+  SkinningJob base_job;
+  base_job.vertex_count = kVertexCount;
+  base_job.influences_count = 2;
+  base_job.joint_matrices = matrices;
+  base_job.joint_indices = make_range(indices);
+  base_job.joint_indices_stride = sizeof(uint16_t) * 2;
+  base_job.joint_weights = make_range(weights);
+  base_job.joint_weights_stride = sizeof(float);
+
+  // Reference float skinning.
+  ozz::Vector<float>::Std expected_positions(kVertexCount * 3);
+  ozz::Vector<float>::Std expected_normals(kVertexCount * 3);
+  ozz::Vector<float>::Std expected_tangents(kVertexCount * 3);
+  {
+    SkinningJob job = base_job;
+    job.in_positions = make_range(positions);
+    job.in_positions_stride = sizeof(float) * 3;
+    job.in_normals = make_range(normals);
+    job.in_normals_stride = sizeof(float) * 3;
+    job.in_tangents = make_range(tangents);
+    job.in_tangents_stride = sizeof(float) * 3;
+    job.out_positions = make_range(expected_positions);
+    job.out_positions_stride = sizeof(float) * 3;
+    job.out_normals = make_range(expected_normals);
+    job.out_normals_stride = sizeof(float) * 3;
+    job.out_tangents = make_range(expected_tangents);
+    job.out_tangents_stride = sizeof(float) * 3;
+    ASSERT_TRUE(job.Run());
+  }
+
+  // Skins from gpu vertices to gpu vertices.
+  ozz::Vector<GpuVertex>::Std out_gpu(kVertexCount);
+  const float* in_begin = reinterpret_cast<const float*>(array_begin(in_gpu));
+  const float* in_end = reinterpret_cast<const float*>(array_end(in_gpu));
+  float* out_begin = reinterpret_cast<float*>(array_begin(out_gpu));
+  float* out_end = reinterpret_cast<float*>(array_end(out_gpu));
+
+  SkinningJob job = base_job;
+  job.in_positions = ozz::Range<const float>(in_begin, in_end);
+  job.in_positions_stride = sizeof(GpuVertex);
+  job.in_positions_format = SkinningJob::kHalf3;
+  job.in_normals = ozz::Range<const float>(
+      reinterpret_cast<const float*>(in_gpu[0].normal), in_end);
+  job.in_normals_stride = sizeof(GpuVertex);
+  job.in_normals_format = SkinningJob::kSnorm16x3;
+  job.in_tangents = ozz::Range<const float>(
+      reinterpret_cast<const float*>(&in_gpu[0].tangent), in_end);
+  job.in_tangents_stride = sizeof(GpuVertex);
+  job.in_tangents_format = SkinningJob::kSnorm10x3_2;
+  job.out_positions = ozz::Range<float>(out_begin, out_end);
+  job.out_positions_stride = sizeof(GpuVertex);
+  job.out_positions_format = SkinningJob::kHalf3;
+  job.out_normals = ozz::Range<float>(
+      reinterpret_cast<float*>(out_gpu[0].normal), out_end);
+  job.out_normals_stride = sizeof(GpuVertex);
+  job.out_normals_format = SkinningJob::kSnorm16x3;
+  job.out_tangents = ozz::Range<float>(
+      reinterpret_cast<float*>(&out_gpu[0].tangent), out_end);
+  job.out_tangents_stride = sizeof(GpuVertex);
+  job.out_tangents_format = SkinningJob::kSnorm10x3_2;
+  ASSERT_TRUE(job.Validate());
+
+  {  // Positions aren't normalized.
+    SkinningJob invalid = job;
+    invalid.in_positions_format = SkinningJob::kSnorm16x3;
+    EXPECT_FALSE(invalid.Validate());
+    invalid = job;
+    invalid.out_positions_format = SkinningJob::kSnorm10x3_2;
+    EXPECT_FALSE(invalid.Validate());
+  }
+  {  // Buffers are too small for float format.
+    SkinningJob invalid = job;
+    invalid.in_positions_format = SkinningJob::kFloat3;
+    invalid.in_positions_stride = sizeof(float) * 3;
+    invalid.in_positions.end =
+        invalid.in_positions.begin + (kVertexCount * 3 - 1);
+    EXPECT_FALSE(invalid.Validate());
+  }
+
+  ASSERT_TRUE(job.Run());
+  for (int i = 0; i < kVertexCount; ++i) {
+    const GpuVertex& gpu = out_gpu[i];
+    float tangent[3];
+    EXPECT_EQ(UnpackSnorm10x3_2(gpu.tangent, tangent),
+              static_cast<uint32_t>(i % 4));
+    for (int j = 0; j < 3; ++j) {
+      const float position = ozz::math::HalfToFloat(gpu.position[j]);
+      EXPECT_NEAR(position, expected_positions[i * 3 + j],
+                  std::fabs(expected_positions[i * 3 + j]) * 1e-3f + 1e-3f);
+      EXPECT_NEAR(gpu.normal[j] / 32767.f, expected_normals[i * 3 + j],
+                  1e-4f);
+      EXPECT_NEAR(tangent[j], expected_tangents[i * 3 + j], 2e-3f);
+    }
+  }
+
+  // Converts gpu tangents to float, without w.
+  ozz::Vector<float>::Std out_tangents(kVertexCount * 3);
+  job.out_tangents = make_range(out_tangents);
+  job.out_tangents_stride = sizeof(float) * 3;
+  job.out_tangents_format = SkinningJob::kFloat3;
+  ASSERT_TRUE(job.Run());
+  for (int i = 0; i < kVertexCount * 3; ++i) {
+    EXPECT_NEAR(out_tangents[i], expected_tangents[i], 1e-5f);
+  }
+
+  // Outputs tangents as kSnorm10x3_2 from float inputs, w is 0.
+  job.in_tangents = make_range(tangents);
+  job.in_tangents_stride = sizeof(float) * 3;
+  job.in_tangents_format = SkinningJob::kFloat3;
+  job.out_tangents = ozz::Range<float>(
+      reinterpret_cast<float*>(&out_gpu[0].tangent), out_end);
+  job.out_tangents_stride = sizeof(GpuVertex);
+  job.out_tangents_format = SkinningJob::kSnorm10x3_2;
+  ASSERT_TRUE(job.Run());
+  for (int i = 0; i < kVertexCount; ++i) {
+    float tangent[3];
+    EXPECT_EQ(UnpackSnorm10x3_2(out_gpu[i].tangent, tangent), 0u);
+    for (int j = 0; j < 3; ++j) {
+      EXPECT_NEAR(tangent[j], expected_tangents[i * 3 + j], 2e-3f);
+    }
+  }
+}
+
+TEST(DualQuaternion, SkinningJob) {
+  // Rigid joint transformations.
+  const ozz::math::Float4x4 matrices[3] = {
+      ozz::math::Float4x4::identity(),
+      ozz::math::Float4x4::Translation(
+          ozz::math::simd_float4::Load(1.f, 2.f, 3.f, 0.f)) *
+          ozz::math::Float4x4::FromEuler(
+              ozz::math::simd_float4::Load(.5f, -.2f, .3f, 0.f)),
+      ozz::math::Float4x4::FromAxisAngle(ozz::math::simd_float4::x_axis(),
+                                         ozz::math::simd_float4::Load1(
+                                             ozz::math::kPi * .9f))};
+  ozz::math::DualQuaternion dqs[3];
+  for (int i = 0; i < 3; ++i) {
+    dqs[i] = ozz::math::ToDualQuaternion(matrices[i]);
+  }
+
+  const uint16_t joint_indices[8] = {1, 1, 2, 2, 0, 2, 2, 0};
+  const float joint_weights[4] = {.3f, .5f, .5f, .5f};
+  const float in_positions[12] = {1.f, 2.f, 3.f, 0.f, 1.f, 0.f,
+                                  0.f, 1.f, 0.f, 0.f, 1.f, 0.f};
+  const float in_normals[12] = {1.f, 0.f, 0.f, 0.f, 0.f, 1.f,
+                                0.f, 1.f, 0.f, 0.f, 0.f, 1.f};
+  float out_positions[12];
+  float out_normals[12];
+  float out_tangents[12];
+  float expected_positions[12];
+  float expected_normals[12];
+
+  SkinningJob job;
+  job.vertex_count = 4;
+  job.influences_count = 2;
+  job.joint_dual_quaternions = dqs;
+  job.joint_indices = joint_indices;
+  job.joint_indices_stride = sizeof(uint16_t) * 2;
+  job.joint_weights = joint_weights;
+  job.joint_weights_stride = sizeof(float);
+  job.in_positions = in_positions;
+  job.in_positions_stride = sizeof(float) * 3;
+  job.out_positions = out_positions;
+  job.out_positions_stride = sizeof(float) * 3;
+  job.in_normals = in_normals;
+  job.in_normals_stride = sizeof(float) * 3;
+  job.out_normals = out_normals;
+  job.out_normals_stride = sizeof(float) * 3;
+  job.in_tangents = in_normals;
+  job.in_tangents_stride = sizeof(float) * 3;
+  job.out_tangents = out_tangents;
+  job.out_tangents_stride = sizeof(float) * 3;
+  EXPECT_TRUE(job.Validate());
+
+  {  // Matrices and dual quaternions are exclusive.
+    SkinningJob invalid = job;
+    invalid.joint_matrices = matrices;
+    EXPECT_FALSE(invalid.Validate());
+    invalid.joint_dual_quaternions =
+        ozz::Range<const ozz::math::DualQuaternion>();
+    EXPECT_TRUE(invalid.Validate());
+    invalid = job;
+    invalid.joint_inverse_transpose_matrices = matrices;
+    EXPECT_FALSE(invalid.Validate());
+  }
+
+  ASSERT_TRUE(job.Run());
+
+  // Matrices skinning reference.
+  SkinningJob reference = job;
+  reference.joint_dual_quaternions =
+      ozz::Range<const ozz::math::DualQuaternion>();
+  reference.joint_matrices = matrices;
+  reference.out_positions = expected_positions;
+  reference.out_normals = expected_normals;
+  reference.in_tangents = ozz::Range<const float>();
+  reference.out_tangents = ozz::Range<float>();
+  ASSERT_TRUE(reference.Run());
+
+  // First 2 vertices are influenced by a single joint, so dual quaternion and
+  // matrices skinning match.
+  for (int i = 0; i < 6; ++i) {
+    EXPECT_NEAR(out_positions[i], expected_positions[i], 1e-5f);
+    EXPECT_NEAR(out_normals[i], expected_normals[i], 1e-5f);
+    EXPECT_NEAR(out_tangents[i], expected_normals[i], 1e-5f);
+  }
+
+  // Last 2 vertices are blended between identity and a nearly half turn
+  // twist. Linear blending collapses the vertex toward the axis, where dual
+  // quaternion skinning preserves its distance to the axis.
+  for (int v = 2; v < 4; ++v) {
+    const float* p = out_positions + v * 3;
+    const float* e = expected_positions + v * 3;
+    EXPECT_NEAR(std::sqrt(p[1] * p[1] + p[2] * p[2]), 1.f, 1e-5f);
+    EXPECT_LT(std::sqrt(e[1] * e[1] + e[2] * e[2]), .2f);
+    const float* n = out_normals + v * 3;
+    EXPECT_NEAR(std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]), 1.f,
+                1e-5f);
+  }
+
+  // Vertex 2 and 3 have opposite influence orders, which doesn't change the
+  // result.
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_NEAR(out_positions[6 + i], out_positions[9 + i], 1e-5f);
+  }
+
+  // Negating a dual quaternion represents the same transformation.
+  float negated_positions[12];
+  ozz::math::DualQuaternion negated_dqs[3];
+  for (int i = 0; i < 3; ++i) {
+    negated_dqs[i] = dqs[i];
+    if (i == 2) {
+      negated_dqs[i].real.xyzw = -dqs[i].real.xyzw;
+      negated_dqs[i].dual.xyzw = -dqs[i].dual.xyzw;
+    }
+  }
+  job.joint_dual_quaternions = negated_dqs;
+  job.out_positions = negated_positions;
+  ASSERT_TRUE(job.Run());
+  for (int i = 0; i < 12; ++i) {
+    EXPECT_NEAR(negated_positions[i], out_positions[i], 1e-5f);
+  }
+
+  // Any number of influences.
+  for (int influences = 1; influences <= 6; ++influences) {
+    uint16_t indices[6] = {1, 1, 1, 1, 1, 1};
+    float weights[5] = {.1f, .2f, .1f, .2f, .1f};
+    float out[3];
+    SkinningJob n_job;
+    n_job.vertex_count = 1;
+    n_job.influences_count = influences;
+    n_job.joint_dual_quaternions = dqs;
+    n_job.joint_indices = indices;
+    n_job.joint_weights = weights;
+    n_job.in_positions = ozz::Range<const float>(in_positions, 3);
+    n_job.out_positions = out;
+    ASSERT_TRUE(n_job.Run());
+    for (int i = 0; i < 3; ++i) {
+      EXPECT_NEAR(out[i], expected_positions[i], 1e-5f);
+    }
+  }
+}
+
+TEST(InfluencesBuckets, SkinningJob) {
+  const int kVertexCount = 21;
+  const int kMaxInfluences = 5;
+  const int kJointCount = 4;
+
+  ozz::math::Float4x4 matrices[kJointCount];
+  for (int i = 0; i < kJointCount; ++i) {
+    const float f = static_cast<float>(i);
+    matrices[i] =
+        ozz::math::Float4x4::Translation(
+            ozz::math::simd_float4::Load(f, -f, 1.f + f, 0.f)) *
+        ozz::math::Float4x4::FromEuler(
+            ozz::math::simd_float4::Load(.2f * f, -.4f, .1f * f, 0.f));
+  }
+
+  // Vertices are sorted by influences count: 3 vertices with 1 influence,
+  // none with 2, 9 with 3, 1 with 4 and 8 with 5.
+  const int buckets[kMaxInfluences] = {3, 0, 9, 1, 8};
+  struct VertexIn {
+    uint16_t indices[kMaxInfluences];
+    uint8_t indices_u8[kMaxInfluences];
+    float weights[kMaxInfluences - 1];
+    float pos[3];
+    float normal[3];
+  };
+  VertexIn in[kVertexCount];
+  int influences[kVertexCount];
+  for (int b = 0, i = 0; b < kMaxInfluences; ++b) {
+    for (int v = 0; v < buckets[b]; ++v, ++i) {
+      influences[i] = b + 1;
+    }
+  }
+  for (int i = 0; i < kVertexCount; ++i) {
+    for (int j = 0; j < kMaxInfluences; ++j) {
+      in[i].indices[j] = static_cast<uint16_t>((i + j) % kJointCount);
+      in[i].indices_u8[j] = static_cast<uint8_t>(in[i].indices[j]);
+    }
+    for (int j = 0; j < kMaxInfluences - 1; ++j) {
+      // Weights of unused influences are garbage.
+      in[i].weights[j] = j < influences[i] - 1 ? .15f : 1e3f;
+    }
+    for (int c = 0; c < 3; ++c) {
+      in[i].pos[c] = static_cast<float>(i + c) * .1f;
+      in[i].normal[c] = c == i % 3 ? 1.f : 0.f;
+    }
+  }
+
+  float out_positions[kVertexCount][3];
+  float out_normals[kVertexCount][3];
+
+  SkinningJob job;
+  job.vertex_count = kVertexCount;
+  job.influences_count = kMaxInfluences;
+  job.influences_buckets = buckets;
+  job.joint_matrices = matrices;
+  job.joint_indices = ozz::Range<const uint16_t>(
+      in[0].indices, reinterpret_cast<const uint16_t*>(in + kVertexCount));
+  job.joint_indices_stride = sizeof(VertexIn);
+  job.joint_weights = ozz::Range<const float>(
+      in[0].weights, reinterpret_cast<const float*>(in + kVertexCount));
+  job.joint_weights_stride = sizeof(VertexIn);
+  job.in_positions = ozz::Range<const float>(
+      in[0].pos, reinterpret_cast<const float*>(in + kVertexCount));
+  job.in_positions_stride = sizeof(VertexIn);
+  job.in_normals = ozz::Range<const float>(
+      in[0].normal, reinterpret_cast<const float*>(in + kVertexCount));
+  job.in_normals_stride = sizeof(VertexIn);
+  job.out_positions = ozz::Range<float>(out_positions[0], kVertexCount * 3);
+  job.out_positions_stride = sizeof(float) * 3;
+  job.out_normals = ozz::Range<float>(out_normals[0], kVertexCount * 3);
+  job.out_normals_stride = sizeof(float) * 3;
+  EXPECT_TRUE(job.Validate());
+
+  {  // Buckets must partition vertices.
+    SkinningJob invalid = job;
+    invalid.vertex_count = kVertexCount - 1;
+    EXPECT_FALSE(invalid.Validate());
+    invalid = job;
+    invalid.influences_count = kMaxInfluences - 1;
+    EXPECT_FALSE(invalid.Validate());
+    const int negative[2] = {kVertexCount + 1, -1};
+    invalid = job;
+    invalid.influences_buckets = negative;
+    EXPECT_FALSE(invalid.Validate());
+    const int empty[2] = {0, 0};
+    invalid = job;
+    invalid.vertex_count = 0;
+    invalid.influences_buckets = empty;
+    EXPECT_TRUE(invalid.Validate());
+    EXPECT_TRUE(invalid.Run());
+  }
+
+  for (int compact = 0; compact < 2; ++compact) {
+    SkinningJob run = job;
+    if (compact) {
+      run.joint_indices = ozz::Range<const uint16_t>();
+      run.joint_indices_u8 = ozz::Range<const uint8_t>(
+          in[0].indices_u8,
+          reinterpret_cast<const uint8_t*>(in + kVertexCount));
+    }
+    memset(out_positions, 0, sizeof(out_positions));
+    memset(out_normals, 0, sizeof(out_normals));
+    ASSERT_TRUE(run.Run());
+
+    for (int i = 0; i < kVertexCount; ++i) {
+      float expected_pos[3];
+      float expected_normal[3];
+      SkinReference(matrices, in[i].indices, in[i].weights, influences[i],
+                    in[i].pos, 1.f, expected_pos);
+      SkinReference(matrices, in[i].indices, in[i].weights, influences[i],
+                    in[i].normal, 0.f, expected_normal);
+      for (int c = 0; c < 3; ++c) {
+        EXPECT_NEAR(out_positions[i][c], expected_pos[c], 1e-4f);
+        EXPECT_NEAR(out_normals[i][c], expected_normal[c], 1e-4f);
+      }
+    }
+  }
+}
+
+TEST(RigidRanges, SkinningJob) {
+  const int kVertexCount = 23;
+  const int kJointCount = 4;
+
+  ozz::math::Float4x4 matrices[kJointCount];
+  ozz::math::Float4x4 it_matrices[kJointCount];
+  for (int i = 0; i < kJointCount; ++i) {
+    const float f = static_cast<float>(i);
+    matrices[i] =
+        ozz::math::Float4x4::Translation(
+            ozz::math::simd_float4::Load(f, -f, 1.f + f, 0.f)) *
+        ozz::math::Float4x4::FromEuler(
+            ozz::math::simd_float4::Load(.2f * f, -.4f, .1f * f, 0.f)) *
+        ozz::math::Float4x4::Scaling(
+            ozz::math::simd_float4::Load(1.f + f, 1.f, 2.f, 0.f));
+    it_matrices[i] = Transpose(Invert(matrices[i]));
+  }
+
+  // The first 15 vertices have a single influence, 12 of them are rigid
+  // ranges bound to joints 2 and 3. The 8 last vertices have 2 influences.
+  const int buckets[2] = {15, 8};
+  const SkinningJob::RigidRange ranges[3] = {{2, 5}, {0, 0}, {3, 7}};
+  struct VertexIn {
+    uint16_t indices[2];
+    float weights[1];
+    float pos[3];
+    float normal[3];
+    float tangent[3];
+  };
+  VertexIn in[kVertexCount];
+  int influences[kVertexCount];
+  for (int i = 0; i < kVertexCount; ++i) {
+    influences[i] = i < buckets[0] ? 1 : 2;
+    for (int j = 0; j < 2; ++j) {
+      in[i].indices[j] = static_cast<uint16_t>((i + j) % kJointCount);
+    }
+    if (i < 5) {
+      in[i].indices[0] = 2;
+    } else if (i < 12) {
+      in[i].indices[0] = 3;
+    }
+    in[i].weights[0] = .3f;
+    for (int c = 0; c < 3; ++c) {
+      in[i].pos[c] = static_cast<float>(i + c) * .1f;
+      in[i].normal[c] = c == i % 3 ? 1.f : 0.f;
+      in[i].tangent[c] = c == (i + 1) % 3 ? 1.f : 0.f;
+    }
+  }
+
+  float out_positions[kVertexCount][3];
+  float out_normals[kVertexCount][3];
+  float out_tangents[kVertexCount][3];
+
+  SkinningJob job;
+  job.vertex_count = kVertexCount;
+  job.influences_count = 2;
+  job.influences_buckets = buckets;
+  job.rigid_ranges = ranges;
+  job.joint_matrices = matrices;
+  job.joint_indices = ozz::Range<const uint16_t>(
+      in[0].indices, reinterpret_cast<const uint16_t*>(in + kVertexCount));
+  job.joint_indices_stride = sizeof(VertexIn);
+  job.joint_weights = ozz::Range<const float>(
+      in[0].weights, reinterpret_cast<const float*>(in + kVertexCount));
+  job.joint_weights_stride = sizeof(VertexIn);
+  job.in_positions = ozz::Range<const float>(
+      in[0].pos, reinterpret_cast<const float*>(in + kVertexCount));
+  job.in_positions_stride = sizeof(VertexIn);
+  job.out_positions = ozz::Range<float>(out_positions[0], kVertexCount * 3);
+  job.out_positions_stride = sizeof(float) * 3;
+  EXPECT_TRUE(job.Validate());
+
+  {  // Rigid ranges must cover single influence vertices only.
+    SkinningJob invalid = job;
+    const SkinningJob::RigidRange big[2] = {{2, 5}, {3, 11}};
+    invalid.rigid_ranges = big;
+    EXPECT_FALSE(invalid.Validate());
+    const SkinningJob::RigidRange negative[1] = {{2, -1}};
+    invalid.rigid_ranges = negative;
+    EXPECT_FALSE(invalid.Validate());
+    const SkinningJob::RigidRange joint[1] = {{kJointCount, 1}};
+    invalid.rigid_ranges = joint;
+    EXPECT_FALSE(invalid.Validate());
+    invalid = job;
+    invalid.influences_buckets = ozz::Range<const int>();
+    EXPECT_FALSE(invalid.Validate());
+    invalid.influences_count = 1;
+    EXPECT_TRUE(invalid.Validate());
+  }
+
+  for (int variant = 0; variant < 6; ++variant) {
+    SkinningJob run = job;
+    const bool normals = variant >= 1;
+    const bool tangents = variant >= 2;
+    const bool it = variant == 3;
+    if (normals) {
+      run.in_normals = ozz::Range<const float>(
+          in[0].normal, reinterpret_cast<const float*>(in + kVertexCount));
+      run.in_normals_stride = sizeof(VertexIn);
+      run.out_normals = ozz::Range<float>(out_normals[0], kVertexCount * 3);
+      run.out_normals_stride = sizeof(float) * 3;
+    }
+    if (tangents) {
+      run.in_tangents = ozz::Range<const float>(
+          in[0].tangent, reinterpret_cast<const float*>(in + kVertexCount));
+      run.in_tangents_stride = sizeof(VertexIn);
+      run.out_tangents = ozz::Range<float>(out_tangents[0], kVertexCount * 3);
+      run.out_tangents_stride = sizeof(float) * 3;
+    }
+    if (it) {
+      run.joint_inverse_transpose_matrices = it_matrices;
+    }
+    if (variant == 4) {
+      // Batched path.
+      run.streaming_output = true;
+    }
+    if (variant == 5) {
+      // Without buckets, only single influence vertices.
+      run.influences_buckets = ozz::Range<const int>();
+      run.influences_count = 1;
+      run.vertex_count = buckets[0];
+    }
+    memset(out_positions, 0, sizeof(out_positions));
+    memset(out_normals, 0, sizeof(out_normals));
+    memset(out_tangents, 0, sizeof(out_tangents));
+    ASSERT_TRUE(run.Run());
+
+    for (int i = 0; i < run.vertex_count; ++i) {
+      float expected[3];
+      SkinReference(matrices, in[i].indices, in[i].weights, influences[i],
+                    in[i].pos, 1.f, expected);
+      for (int c = 0; c < 3; ++c) {
+        EXPECT_NEAR(out_positions[i][c], expected[c], 1e-4f)
+            << "variant " << variant << " vertex " << i;
+      }
+      const ozz::math::Float4x4* vectors = it ? it_matrices : matrices;
+      if (normals) {
+        SkinReference(vectors, in[i].indices, in[i].weights, influences[i],
+                      in[i].normal, 0.f, expected);
+        for (int c = 0; c < 3; ++c) {
+          EXPECT_NEAR(out_normals[i][c], expected[c], 1e-4f)
+              << "variant " << variant << " vertex " << i;
+        }
+      }
+      if (tangents) {
+        SkinReference(vectors, in[i].indices, in[i].weights, influences[i],
+                      in[i].tangent, 0.f, expected);
+        for (int c = 0; c < 3; ++c) {
+          EXPECT_NEAR(out_tangents[i][c], expected[c], 1e-4f)
+              << "variant " << variant << " vertex " << i;
+        }
+      }
+    }
+  }
+}
+
+TEST(StreamingOutput, SkinningJob) {
+  const int kVertexCount = 150;  // More than a batch.
+  const int kInfluences = 3;
+  const int kJointCount = 3;
+
+  ozz::math::Float4x4 matrices[kJointCount];
+  for (int i = 0; i < kJointCount; ++i) {
+    const float f = static_cast<float>(i);
+    matrices[i] =
+        ozz::math::Float4x4::Translation(
+            ozz::math::simd_float4::Load(f, 2.f, -f, 0.f)) *
+        ozz::math::Float4x4::FromEuler(
+            ozz::math::simd_float4::Load(.3f * f, .1f, -.2f, 0.f));
+  }
+
+  struct VertexIn {
+    uint16_t indices[kInfluences];
+    float weights[kInfluences - 1];
+    float pos[3];
+    float normal[3];
+    float tangent[3];
+  };
+  VertexIn in[kVertexCount];
+  for (int i = 0; i < kVertexCount; ++i) {
+    for (int j = 0; j < kInfluences; ++j) {
+      in[i].indices[j] = static_cast<uint16_t>((i + j) % kJointCount);
+    }
+    in[i].weights[0] = .2f;
+    in[i].weights[1] = .5f;
+    const float f = static_cast<float>(i) * .01f;
+    const float pos[3] = {f, 1.f - f, .5f};
+    const float normal[3] = {.6f, 0.f, .8f};
+    const float tangent[3] = {0.f, 1.f, 0.f};
+    memcpy(in[i].pos, pos, sizeof(pos));
+    memcpy(in[i].normal, normal, sizeof(normal));
+    memcpy(in[i].tangent, tangent, sizeof(tangent));
+  }
+
+  // Interleaved gpu like output record, with padding that mustn't be written.
+  struct VertexOut {
+    float pos[3];
+    uint32_t normal;
+    uint16_t tangent[3];
+    uint16_t padding;
+  };
+
+  VertexOut expected[kVertexCount];
+  VertexOut out[kVertexCount];
+  memset(expected, 0xab, sizeof(expected));
+  memset(out, 0xab, sizeof(out));
+
+  SkinningJob job;
+  job.vertex_count = kVertexCount;
+  job.influences_count = kInfluences;
+  job.joint_matrices = matrices;
+  job.joint_indices = ozz::Range<const uint16_t>(
+      in[0].indices, reinterpret_cast<const uint16_t*>(in + kVertexCount));
+  job.joint_indices_stride = sizeof(VertexIn);
+  job.joint_weights = ozz::Range<const float>(
+      in[0].weights, reinterpret_cast<const float*>(in + kVertexCount));
+  job.joint_weights_stride = sizeof(VertexIn);
+  job.in_positions = ozz::Range<const float>(
+      in[0].pos, reinterpret_cast<const float*>(in + kVertexCount));
+  job.in_positions_stride = sizeof(VertexIn);
+  job.in_normals = ozz::Range<const float>(
+      in[0].normal, reinterpret_cast<const float*>(in + kVertexCount));
+  job.in_normals_stride = sizeof(VertexIn);
+  job.in_tangents = ozz::Range<const float>(
+      in[0].tangent, reinterpret_cast<const float*>(in + kVertexCount));
+  job.in_tangents_stride = sizeof(VertexIn);
+  job.out_positions = ozz::Range<float>(
+      expected[0].pos, reinterpret_cast<float*>(expected + kVertexCount));
+  job.out_positions_stride = sizeof(VertexOut);
+  job.out_normals = ozz::Range<float>(
+      reinterpret_cast<float*>(&expected[0].normal),
+      reinterpret_cast<float*>(expected + kVertexCount));
+  job.out_normals_stride = sizeof(VertexOut);
+  job.out_normals_format = SkinningJob::kSnorm10x3_2;
+  job.out_tangents = ozz::Range<float>(
+      reinterpret_cast<float*>(expected[0].tangent),
+      reinterpret_cast<float*>(expected + kVertexCount));
+  job.out_tangents_stride = sizeof(VertexOut);
+  job.out_tangents_format = SkinningJob::kHalf3;
+  EXPECT_FALSE(job.streaming_output);
+  ASSERT_TRUE(job.Run());
+
+  // Streamed outputs are the same, whatever the formats.
+  for (int tangents = 0; tangents < 2; ++tangents) {
+    SkinningJob streamed = job;
+    streamed.streaming_output = true;
+    streamed.out_positions = ozz::Range<float>(
+        out[0].pos, reinterpret_cast<float*>(out + kVertexCount));
+    streamed.out_normals =
+        ozz::Range<float>(reinterpret_cast<float*>(&out[0].normal),
+                          reinterpret_cast<float*>(out + kVertexCount));
+    streamed.out_tangents =
+        ozz::Range<float>(reinterpret_cast<float*>(out[0].tangent),
+                          reinterpret_cast<float*>(out + kVertexCount));
+    if (!tangents) {
+      streamed.in_tangents = ozz::Range<const float>();
+      streamed.out_tangents = ozz::Range<float>();
+    }
+    ASSERT_TRUE(streamed.Run());
+    for (int i = 0; i < kVertexCount; ++i) {
+      EXPECT_EQ(memcmp(out[i].pos, expected[i].pos, sizeof(out[i].pos)), 0);
+      EXPECT_EQ(out[i].normal, expected[i].normal);
+      EXPECT_EQ(out[i].padding, 0xabab);
+      if (tangents) {
+        EXPECT_EQ(memcmp(out[i].tangent, expected[i].tangent,
+                         sizeof(out[i].tangent)),
+                  0);
+      } else {
+        EXPECT_EQ(out[i].tangent[0], 0xabab);
+      }
+    }
+  }
+
+  // Float outputs.
+  job.out_normals_format = SkinningJob::kFloat3;
+  job.out_tangents_format = SkinningJob::kFloat3;
+  float expected_floats[kVertexCount][9];
+  float out_floats[kVertexCount][9];
+  job.out_positions = ozz::Range<float>(expected_floats[0], kVertexCount * 9);
+  job.out_normals = ozz::Range<float>(expected_floats[0] + 3,
+                                      kVertexCount * 9 - 3);
+  job.out_tangents = ozz::Range<float>(expected_floats[0] + 6,
+                                       kVertexCount * 9 - 6);
+  job.out_positions_stride = sizeof(float) * 9;
+  job.out_normals_stride = sizeof(float) * 9;
+  job.out_tangents_stride = sizeof(float) * 9;
+  ASSERT_TRUE(job.Run());
+
+  job.streaming_output = true;
+  job.out_positions = ozz::Range<float>(out_floats[0], kVertexCount * 9);
+  job.out_normals = ozz::Range<float>(out_floats[0] + 3, kVertexCount * 9 - 3);
+  job.out_tangents =
+      ozz::Range<float>(out_floats[0] + 6, kVertexCount * 9 - 6);
+  ASSERT_TRUE(job.Run());
+  EXPECT_EQ(memcmp(out_floats, expected_floats, sizeof(out_floats)), 0);
+}
+
+TEST(Morph, SkinningJob) {
+  const int kVertexCount = 150;  // More than a batch.
+  const int kJointCount = 2;
+
+  ozz::math::Float4x4 matrices[kJointCount] = {
+      ozz::math::Float4x4::Translation(
+          ozz::math::simd_float4::Load(1.f, 2.f, 3.f, 0.f)),
+      ozz::math::Float4x4::FromEuler(
+          ozz::math::simd_float4::Load(.3f, -.2f, .6f, 0.f))};
+
+  uint16_t indices[kVertexCount][2];
+  float weights[kVertexCount];
+  float in_positions[kVertexCount][3];
+  float in_normals[kVertexCount][3];
+  for (int i = 0; i < kVertexCount; ++i) {
+    indices[i][0] = 0;
+    indices[i][1] = 1;
+    weights[i] = static_cast<float>(i % 10) * .1f;
+    for (int c = 0; c < 3; ++c) {
+      in_positions[i][c] = static_cast<float>(i + c) * .1f;
+      in_normals[i][c] = c == i % 3 ? 1.f : 0.f;
+    }
+  }
+
+  // A sparse target moving every 7th vertex, so that blocks overlap batches.
+  ozz::geometry::MorphDeltaBlock blocks[6];
+  int vertex = 0;
+  for (int b = 0; b < 6; ++b) {
+    for (int i = 0; i < 4; ++i, vertex += 7) {
+      blocks[b].vertices[i] = vertex;
+    }
+    for (int c = 0; c < 3; ++c) {
+      blocks[b].positions[c] = ozz::math::simd_float4::Load(
+          1.f, static_cast<float>(c), -1.f, static_cast<float>(b));
+      blocks[b].normals[c] = ozz::math::simd_float4::Load(
+          .1f, 0.f, -.2f, static_cast<float>(c) * .1f);
+    }
+  }
+  ozz::geometry::MorphTarget target;
+  target.blocks = blocks;
+  const float morph_weights[1] = {.75f};
+
+  // Morphs, and then skins, in 2 passes.
+  float morphed_positions[kVertexCount][3];
+  float morphed_normals[kVertexCount][3];
+  ozz::geometry::MorphJob morph;
+  morph.vertex_count = kVertexCount;
+  morph.targets = ozz::Range<const ozz::geometry::MorphTarget>(&target, 1);
+  morph.weights = morph_weights;
+  morph.in_positions =
+      ozz::Range<const float>(in_positions[0], kVertexCount * 3);
+  morph.in_positions_stride = sizeof(float) * 3;
+  morph.in_normals = ozz::Range<const float>(in_normals[0], kVertexCount * 3);
+  morph.in_normals_stride = sizeof(float) * 3;
+  morph.out_positions =
+      ozz::Range<float>(morphed_positions[0], kVertexCount * 3);
+  morph.out_positions_stride = sizeof(float) * 3;
+  morph.out_normals = ozz::Range<float>(morphed_normals[0], kVertexCount * 3);
+  morph.out_normals_stride = sizeof(float) * 3;
+  ASSERT_TRUE(morph.Run());
+
+  float expected_positions[kVertexCount][3];
+  float expected_normals[kVertexCount][3];
+  SkinningJob job;
+  job.vertex_count = kVertexCount;
+  job.influences_count = 2;
+  job.joint_matrices = matrices;
+  job.joint_indices = ozz::Range<const uint16_t>(indices[0], kVertexCount * 2);
+  job.joint_indices_stride = sizeof(uint16_t) * 2;
+  job.joint_weights = weights;
+  job.joint_weights_stride = sizeof(float);
+  job.in_positions =
+      ozz::Range<const float>(morphed_positions[0], kVertexCount * 3);
+  job.in_positions_stride = sizeof(float) * 3;
+  job.in_normals =
+      ozz::Range<const float>(morphed_normals[0], kVertexCount * 3);
+  job.in_normals_stride = sizeof(float) * 3;
+  job.out_positions =
+      ozz::Range<float>(expected_positions[0], kVertexCount * 3);
+  job.out_positions_stride = sizeof(float) * 3;
+  job.out_normals = ozz::Range<float>(expected_normals[0], kVertexCount * 3);
+  job.out_normals_stride = sizeof(float) * 3;
+  ASSERT_TRUE(job.Run());
+
+  // Fused morphing and skinning.
+  float out_positions[kVertexCount][3];
+  float out_normals[kVertexCount][3];
+  job.in_positions = ozz::Range<const float>(in_positions[0], kVertexCount * 3);
+  job.in_normals = ozz::Range<const float>(in_normals[0], kVertexCount * 3);
+  job.out_positions = ozz::Range<float>(out_positions[0], kVertexCount * 3);
+  job.out_normals = ozz::Range<float>(out_normals[0], kVertexCount * 3);
+  job.morph_targets = morph.targets;
+  job.morph_weights = morph_weights;
+  EXPECT_TRUE(job.Validate());
+
+  {  // Invalid morph setups.
+    SkinningJob invalid = job;
+    invalid.morph_weights = ozz::Range<const float>();
+    EXPECT_FALSE(invalid.Validate());
+    invalid = job;
+    invalid.morph_first_vertex = -1;
+    EXPECT_FALSE(invalid.Validate());
+  }
+
+  ASSERT_TRUE(job.Run());
+  for (int i = 0; i < kVertexCount; ++i) {
+    for (int c = 0; c < 3; ++c) {
+      EXPECT_NEAR(out_positions[i][c], expected_positions[i][c], 1e-5f);
+      EXPECT_NEAR(out_normals[i][c], expected_normals[i][c], 1e-5f);
+    }
+  }
+
+  // Sub range of the mesh.
+  const int kFirst = 20;
+  job.vertex_count = kVertexCount - kFirst;
+  job.morph_first_vertex = kFirst;
+  job.joint_indices.begin = indices[kFirst];
+  job.joint_weights.begin = weights + kFirst;
+  job.in_positions.begin = in_positions[kFirst];
+  job.in_normals.begin = in_normals[kFirst];
+  job.out_positions.begin = out_positions[kFirst];
+  job.out_normals.begin = out_normals[kFirst];
+  memset(out_positions, 0, sizeof(out_positions));
+  ASSERT_TRUE(job.Run());
+  for (int i = kFirst; i < kVertexCount; ++i) {
+    for (int c = 0; c < 3; ++c) {
+      EXPECT_NEAR(out_positions[i][c], expected_positions[i][c], 1e-5f);
+    }
+  }
+}
+
 TEST(Benchmark, SkinningJob) {
   const int vertex_count = 10000;
   const int joint_count = 100;